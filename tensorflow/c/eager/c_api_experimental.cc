@@ -21,6 +21,7 @@ limitations under the License.
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/inlined_vector.h"
 #include "absl/strings/match.h"
 #include "absl/time/time.h"
 #include "tensorflow/c/c_api.h"
@@ -36,6 +37,8 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/composite_device.h"
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/common_runtime/eager/eager_operation.h"
+#include "tensorflow/core/common_runtime/eager/execute.h"
+#include "tensorflow/core/common_runtime/eager/tensor_handle.h"
 #include "tensorflow/core/distributed_runtime/coordination/coordination_service_error_util.h"
 #include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/framework/graph_debug_info.pb.h"
@@ -638,6 +641,45 @@ TFE_Executor* TFE_ContextGetExecutorForThread(TFE_Context* ctx) {
   return new TFE_Executor(&tensorflow::unwrap(ctx)->Executor());
 }
 
+struct TFE_ResolvedOp {
+  std::unique_ptr<tensorflow::ResolvedEagerOp> op;
+};
+
+TFE_ResolvedOp* TFE_NewResolvedOp(TFE_Op* op, TF_Status* status) {
+  std::unique_ptr<tensorflow::ResolvedEagerOp> resolved_op;
+  status->status = tensorflow::ResolvedEagerOp::Create(
+      tensorflow::OperationFromInterface(tensorflow::unwrap(op)),
+      &resolved_op);
+  if (!status->status.ok()) return nullptr;
+  return new TFE_ResolvedOp{std::move(resolved_op)};
+}
+
+void TFE_DeleteResolvedOp(TFE_ResolvedOp* op) { delete op; }
+
+void TFE_ResolvedOpExecute(TFE_ResolvedOp* op, TFE_TensorHandle** inputs,
+                           int num_inputs, TFE_TensorHandle** retvals,
+                           int* num_retvals, TF_Status* status) {
+  absl::InlinedVector<tensorflow::TensorHandle*, 4> handles;
+  handles.reserve(num_inputs);
+  for (int i = 0; i < num_inputs; ++i) {
+    tensorflow::ImmediateExecutionTensorHandle* handle =
+        tensorflow::unwrap(inputs[i]);
+    if (!tensorflow::TensorHandle::classof(handle)) {
+      status->status = tensorflow::errors::InvalidArgument(
+          "Input #", i, " of ", op->op->name(), " is not a local tensor");
+      return;
+    }
+    handles.push_back(tensorflow::TensorHandleFromInterface(handle));
+  }
+  std::vector<tensorflow::TensorHandle*> outputs(*num_retvals);
+  status->status = op->op->Execute(handles, outputs.data(), num_retvals);
+  if (!status->status.ok()) return;
+  for (int i = 0; i < *num_retvals; ++i) {
+    retvals[i] = tensorflow::wrap(
+        static_cast<tensorflow::ImmediateExecutionTensorHandle*>(outputs[i]));
+  }
+}
+
 void TFE_HostAddressSpace(TFE_Context* ctx, TF_Buffer* buf) {
   auto address_space = tensorflow::DeviceNameUtils::AddressSpace(
       tensorflow::unwrap(ctx)->HostCPUParsedName());
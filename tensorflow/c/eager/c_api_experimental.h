@@ -393,6 +393,35 @@ TF_CAPI_EXPORT extern void TFE_ContextSetExecutorForThread(TFE_Context*,
 TF_CAPI_EXPORT extern TFE_Executor* TFE_ContextGetExecutorForThread(
     TFE_Context*);
 
+// -----------------------------------------------------------------------------
+// Resolved op APIs.
+
+// A local primitive op bound to its kernel and devices once, for hot loops that
+// execute the same op with the same attributes on inputs from the same devices
+// repeatedly. Executing it skips the attribute hashing, kernel cache lookup and
+// placement of TFE_Execute.
+typedef struct TFE_ResolvedOp TFE_ResolvedOp;
+
+// Places `op` and resolves its kernel for its current inputs, attributes and
+// device, without executing it. Only synchronous execution of local primitive
+// ops is supported; other ops return an Unimplemented error, and must be run
+// with TFE_Execute. `op` may be deleted afterwards. The resolved op must not
+// outlive the context of `op`.
+TF_CAPI_EXPORT extern TFE_ResolvedOp* TFE_NewResolvedOp(TFE_Op* op,
+                                                        TF_Status* status);
+
+TF_CAPI_EXPORT extern void TFE_DeleteResolvedOp(TFE_ResolvedOp* op);
+
+// Executes `op` with `inputs`, which must have the types and be on the devices
+// the op was resolved for; an InvalidArgument error is returned otherwise.
+// `retvals` and `num_retvals` are handled as in TFE_Execute.
+TF_CAPI_EXPORT extern void TFE_ResolvedOpExecute(TFE_ResolvedOp* op,
+                                                 TFE_TensorHandle** inputs,
+                                                 int num_inputs,
+                                                 TFE_TensorHandle** retvals,
+                                                 int* num_retvals,
+                                                 TF_Status* status);
+
 // -----------------------------------------------------------------------------
 // Dynamic cluster API.
 
@@ -22,6 +22,8 @@ limitations under the License.
 #include "tensorflow/c/eager/c_api_experimental.h"
 #include "tensorflow/c/eager/tfe_tensorhandle_internal.h"
 #include "tensorflow/c/tf_status_internal.h"
+#include "tensorflow/c/tf_tensor.h"
+#include "tensorflow/c/tf_tensor_helper.h"
 #include "tensorflow/core/common_runtime/eager/tensor_handle.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_reference.h"
@@ -149,6 +151,8 @@ absl::optional<std::string> DeviceNameFromDlContext(const DLDevice& ctx,
                                                     TF_Status* status) {
   switch (ctx.device_type) {
     case DLDeviceType::kDLCPU:
+    // Pinned host memory is accessible to the CPU as any other host memory.
+    case DLDeviceType::kDLCUDAHost:
       return "CPU:0";
     case DLDeviceType::kDLCUDA:
       return absl::StrCat("GPU:", ctx.device_id);
@@ -277,45 +281,28 @@ bool IsValidStrideCompactRowMajorData(int64_t* shape_arr, int64_t* stride_arr,
   }
   return valid;
 }
-}  // namespace
 
-void TFE_CallDLManagedTensorDeleter(void* dlm_ptr) {
-  DLManagedTensor* dlMTensor = static_cast<DLManagedTensor*>(dlm_ptr);
-  if (dlMTensor->deleter != nullptr) {
-    dlMTensor->deleter(dlMTensor);
-  }
-}
-
-void* TFE_HandleToDLPack(TFE_TensorHandle* h, TF_Status* status) {
-  auto tf_dlm_context = GetDlContext(h, status);
-  if (!status->status.ok()) {
-    return nullptr;
-  }
-
-  auto* tf_dlm_data = TFE_TensorHandleDevicePointer(h, status);
-  if (!status->status.ok()) {
-    return nullptr;
-  }
-
-  const Tensor* tensor = GetTensorFromHandle(h, status);
-  TF_DataType data_type = static_cast<TF_DataType>(tensor->dtype());
+// Converts `tensor`, whose data is `data` on `device`, to DLPack.
+void* ToDLPack(const Tensor& tensor, DLDevice device, void* data,
+               TF_Status* status) {
+  TF_DataType data_type = static_cast<TF_DataType>(tensor.dtype());
 
   auto tf_dlm_type = GetDlDataType(data_type, status);
   if (!status->status.ok()) {
     return nullptr;
   }
 
-  TensorReference tensor_ref(*tensor);  // This will call buf_->Ref()
+  TensorReference tensor_ref(tensor);  // This will call buf_->Ref()
   auto* tf_dlm_tensor_ctx = new TfDlManagedTensorCtx(tensor_ref);
   tf_dlm_tensor_ctx->reference = tensor_ref;
 
   DLManagedTensor* dlm_tensor = &tf_dlm_tensor_ctx->tensor;
   dlm_tensor->manager_ctx = tf_dlm_tensor_ctx;
   dlm_tensor->deleter = &DLManagedTensorDeleter;
-  dlm_tensor->dl_tensor.device = tf_dlm_context;
-  int ndim = tensor->dims();
+  dlm_tensor->dl_tensor.device = device;
+  int ndim = tensor.dims();
   dlm_tensor->dl_tensor.ndim = ndim;
-  dlm_tensor->dl_tensor.data = tf_dlm_data;
+  dlm_tensor->dl_tensor.data = data;
   dlm_tensor->dl_tensor.dtype = tf_dlm_type;
 
   std::vector<int64_t>* shape_arr = &tf_dlm_tensor_ctx->shape;
@@ -323,7 +310,7 @@ void* TFE_HandleToDLPack(TFE_TensorHandle* h, TF_Status* status) {
   shape_arr->resize(ndim);
   stride_arr->resize(ndim, 1);
   for (int i = 0; i < ndim; i++) {
-    (*shape_arr)[i] = tensor->dim_size(i);
+    (*shape_arr)[i] = tensor.dim_size(i);
   }
   for (int i = ndim - 2; i >= 0; --i) {
     (*stride_arr)[i] = (*shape_arr)[i + 1] * (*stride_arr)[i + 1];
@@ -342,6 +329,63 @@ void* TFE_HandleToDLPack(TFE_TensorHandle* h, TF_Status* status) {
   return static_cast<void*>(dlm_tensor);
 }
 
+// Validates `dl_tensor` as a compact row-major tensor of a TF data type, and
+// returns its data type, the address of its first element and its byte size.
+Status ParseDLTensor(const DLTensor& dl_tensor, TF_DataType* dtype,
+                     void** data, size_t* total_bytes) {
+  TF_RETURN_IF_ERROR(TfDataTypeFormDlDataType(dl_tensor.dtype, dtype));
+  if (dl_tensor.strides != nullptr &&
+      !IsValidStrideCompactRowMajorData(dl_tensor.shape, dl_tensor.strides,
+                                        dl_tensor.ndim)) {
+    return tensorflow::errors::InvalidArgument(
+        "Invalid strides array from DLPack");
+  }
+  // A nonzero byte_offset is how the slices of an exporter's buffer are
+  // shared, so it is applied to the data pointer rather than copied.
+  *data = static_cast<char*>(dl_tensor.data) + dl_tensor.byte_offset;
+  *total_bytes = dl_tensor.dtype.bits / 8;
+  for (int i = 0; i < dl_tensor.ndim; i++) {
+    *total_bytes *= dl_tensor.shape[i];
+  }
+  return absl::OkStatus();
+}
+}  // namespace
+
+void TFE_CallDLManagedTensorDeleter(void* dlm_ptr) {
+  DLManagedTensor* dlMTensor = static_cast<DLManagedTensor*>(dlm_ptr);
+  if (dlMTensor->deleter != nullptr) {
+    dlMTensor->deleter(dlMTensor);
+  }
+}
+
+void* TFE_HandleToDLPack(TFE_TensorHandle* h, TF_Status* status) {
+  auto tf_dlm_context = GetDlContext(h, status);
+  if (!status->status.ok()) {
+    return nullptr;
+  }
+
+  auto* tf_dlm_data = TFE_TensorHandleDevicePointer(h, status);
+  if (!status->status.ok()) {
+    return nullptr;
+  }
+
+  const Tensor* tensor = GetTensorFromHandle(h, status);
+  if (!status->status.ok()) {
+    return nullptr;
+  }
+  return ToDLPack(*tensor, tf_dlm_context, tf_dlm_data, status);
+}
+
+void* TF_TensorToDLPack(TF_Tensor* t, TF_Status* status) {
+  Tensor tensor;
+  status->status = TF_TensorToTensor(t, &tensor);
+  if (!status->status.ok()) {
+    return nullptr;
+  }
+  // TF_Tensors are always in host memory.
+  return ToDLPack(tensor, {kDLCPU, 0}, TF_TensorData(t), status);
+}
+
 TFE_TensorHandle* TFE_HandleFromDLPack(void* dlm, TF_Status* status,
                                        TFE_Context* ctx) {
   DLManagedTensor* dlmt = static_cast<DLManagedTensor*>(dlm);
@@ -354,40 +398,41 @@ TFE_TensorHandle* TFE_HandleFromDLPack(void* dlm, TF_Status* status,
     return nullptr;
   }
   TF_DataType dtype;
-  Status s = TfDataTypeFormDlDataType(dl_tensor->dtype, &dtype);
-  if (!s.ok()) {
-    status->status = std::move(s);
+  void* data;
+  size_t total_bytes;
+  status->status = ParseDLTensor(*dl_tensor, &dtype, &data, &total_bytes);
+  if (!status->status.ok()) {
     return nullptr;
   }
-  int num_dims = dl_tensor->ndim;
-  const int64_t* dims = dl_tensor->shape;
-  void* data = dl_tensor->data;
 
-  if (dl_tensor->byte_offset != 0) {
-    status->status = tensorflow::errors::InvalidArgument(
-        "Unsupported byte_offset (", dl_tensor->byte_offset,
-        ") from DLPack, must be zero");
-    return nullptr;
-  }
+  TFE_TensorHandle* handle = TFE_NewTensorHandleFromDeviceMemory(
+      ctx, device_name.value().c_str(), dtype, dl_tensor->shape,
+      dl_tensor->ndim, data, total_bytes, &DeallocatorWrapperFunc, dlmt,
+      status);
 
-  size_t total_bytes = dl_tensor->dtype.bits / 8;
-  for (int i = 0; i < num_dims; i++) {
-    total_bytes *= dims[i];
-  }
+  return handle;
+}
 
-  if (dl_tensor->strides != nullptr &&
-      !IsValidStrideCompactRowMajorData(dl_tensor->shape, dl_tensor->strides,
-                                        num_dims)) {
+TF_Tensor* TF_TensorFromDLPack(void* dlm, TF_Status* status) {
+  DLManagedTensor* dlmt = static_cast<DLManagedTensor*>(dlm);
+  DLTensor* dl_tensor = &dlmt->dl_tensor;
+  if (dl_tensor->device.device_type != DLDeviceType::kDLCPU &&
+      dl_tensor->device.device_type != DLDeviceType::kDLCUDAHost) {
     status->status = tensorflow::errors::InvalidArgument(
-        "Invalid strides array from DLPack");
+        "TF_Tensors can only wrap DLPack tensors in host memory");
     return nullptr;
   }
-
-  TFE_TensorHandle* handle = TFE_NewTensorHandleFromDeviceMemory(
-      ctx, device_name.value().c_str(), dtype, dims, num_dims, data,
-      total_bytes, &DeallocatorWrapperFunc, dlmt, status);
-
-  return handle;
+  TF_DataType dtype;
+  void* data;
+  size_t total_bytes;
+  status->status = ParseDLTensor(*dl_tensor, &dtype, &data, &total_bytes);
+  if (!status->status.ok()) {
+    return nullptr;
+  }
+  // TF_NewTensor only copies the data which isn't aligned to
+  // TF_TensorDefaultAlignment(), and then calls the deleter right away.
+  return TF_NewTensor(dtype, dl_tensor->shape, dl_tensor->ndim, data,
+                      total_bytes, &DeallocatorWrapperFunc, dlmt);
 }
 
 }  // namespace tensorflow
@@ -17,6 +17,7 @@ limitations under the License.
 #define TENSORFLOW_C_EAGER_DLPACK_H_
 
 #include "tensorflow/c/eager/c_api.h"
+#include "tensorflow/c/tf_tensor.h"
 
 namespace tensorflow {
 
@@ -28,11 +29,25 @@ const char* const kDlTensorCapsuleName = "dltensor";
 TF_CAPI_EXPORT extern void* TFE_HandleToDLPack(TFE_TensorHandle* h,
                                                TF_Status* status);
 
-// Converts DLPack (DLManagedTensor*) to eager tensor handle.
+// Converts DLPack (DLManagedTensor*) to eager tensor handle. The handle shares
+// the memory of the DLPack tensor, which may start at a nonzero byte_offset,
+// and calls its deleter when it is destroyed.
 TF_CAPI_EXPORT extern TFE_TensorHandle* TFE_HandleFromDLPack(void* dlm,
                                                              TF_Status* status,
                                                              TFE_Context* ctx);
 
+// Converts a TF_Tensor, such as an output of TF_SessionRun, to DLPack
+// (DLManagedTensor*) without copying its data. The DLPack tensor keeps a
+// reference to the buffer of `t`, so `t` may be deleted before it.
+TF_CAPI_EXPORT extern void* TF_TensorToDLPack(TF_Tensor* t, TF_Status* status);
+
+// Converts DLPack (DLManagedTensor*) in host memory to a TF_Tensor, such as an
+// input of TF_SessionRun. The data is shared, unless its address isn't a
+// multiple of TF_TensorDefaultAlignment(), in which case it is copied and the
+// deleter of `dlm` is called right away.
+TF_CAPI_EXPORT extern TF_Tensor* TF_TensorFromDLPack(void* dlm,
+                                                     TF_Status* status);
+
 // Calls the destructor of DLManagedTensor, used in the destructor of PyCapsule.
 TF_CAPI_EXPORT extern void TFE_CallDLManagedTensorDeleter(void* dlm_ptr);
 }  // namespace tensorflow
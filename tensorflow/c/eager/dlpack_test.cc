@@ -20,6 +20,7 @@ limitations under the License.
 #include "absl/strings/str_join.h"
 #include "include/dlpack/dlpack.h"  // from @dlpack
 #include "tensorflow/c/eager/c_api.h"
+#include "tensorflow/c/tf_tensor.h"
 #include "tensorflow/core/platform/test.h"
 
 namespace tensorflow {
@@ -109,5 +110,105 @@ TEST(DLPack, HandleFromDLPackStrides) {
   TF_DeleteStatus(status);
 }
 
+TEST(DLPack, HandleFromDLPackByteOffset) {
+  TF_Status* status = TF_NewStatus();
+  TFE_ContextOptions* opts = TFE_NewContextOptions();
+  TFE_Context* ctx = TFE_NewContext(opts, status);
+  ASSERT_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+  TFE_DeleteContextOptions(opts);
+
+  alignas(64) float data[32];
+  for (int i = 0; i < 32; ++i) {
+    data[i] = i;
+  }
+  std::vector<int64_t> shape = {4};
+  DLManagedTensor dlm_in = {};
+  DLTensor* dltensor_in = &dlm_in.dl_tensor;
+  dltensor_in->data = data;
+  dltensor_in->byte_offset = 16 * sizeof(float);
+  dltensor_in->device = {kDLCPU, 0};
+  dltensor_in->ndim = 1;
+  dltensor_in->dtype = {kDLFloat, 32, 1};
+  dltensor_in->shape = shape.data();
+  TFE_TensorHandle* handle = TFE_HandleFromDLPack(&dlm_in, status, ctx);
+  ASSERT_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+
+  TF_Tensor* t = TFE_TensorHandleResolve(handle, status);
+  ASSERT_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+  const float* values = static_cast<const float*>(TF_TensorData(t));
+  EXPECT_EQ(values, data + 16);
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_EQ(values[i], 16 + i);
+  }
+
+  TF_DeleteTensor(t);
+  TFE_DeleteTensorHandle(handle);
+  TFE_DeleteContext(ctx);
+  TF_DeleteStatus(status);
+}
+
+TEST(DLPack, TensorToDLPackSharesTheBuffer) {
+  TF_Status* status = TF_NewStatus();
+  const int64_t dims[] = {2, 3};
+  TF_Tensor* t = TF_AllocateTensor(TF_INT32, dims, 2, 6 * sizeof(int32_t));
+  int32_t* values = static_cast<int32_t*>(TF_TensorData(t));
+  for (int i = 0; i < 6; ++i) {
+    values[i] = i;
+  }
+
+  auto* dlm = static_cast<DLManagedTensor*>(TF_TensorToDLPack(t, status));
+  ASSERT_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+  // The DLPack tensor keeps the buffer alive.
+  TF_DeleteTensor(t);
+  const DLTensor* dltensor = &dlm->dl_tensor;
+  EXPECT_EQ(dltensor->device.device_type, kDLCPU);
+  EXPECT_EQ(dltensor->dtype.code, kDLInt);
+  EXPECT_EQ(dltensor->dtype.bits, 32);
+  ASSERT_EQ(dltensor->ndim, 2);
+  EXPECT_EQ(dltensor->shape[0], 2);
+  EXPECT_EQ(dltensor->shape[1], 3);
+  EXPECT_EQ(dltensor->data, values);
+  for (int i = 0; i < 6; ++i) {
+    EXPECT_EQ(static_cast<const int32_t*>(dltensor->data)[i], i);
+  }
+
+  TFE_CallDLManagedTensorDeleter(dlm);
+  TF_DeleteStatus(status);
+}
+
+TEST(DLPack, TensorFromDLPackSharesTheBuffer) {
+  TF_Status* status = TF_NewStatus();
+  alignas(64) float data[32] = {};
+  data[16] = 7;
+  std::vector<int64_t> shape = {2, 2};
+  // The deleter is called once the TF_Tensor is deleted.
+  static bool deleted;
+  deleted = false;
+  DLManagedTensor dlm = {};
+  dlm.deleter = [](DLManagedTensor*) { deleted = true; };
+  DLTensor* dltensor = &dlm.dl_tensor;
+  dltensor->data = data;
+  dltensor->byte_offset = 16 * sizeof(float);
+  dltensor->device = {kDLCPU, 0};
+  dltensor->ndim = 2;
+  dltensor->dtype = {kDLFloat, 32, 1};
+  dltensor->shape = shape.data();
+
+  TF_Tensor* t = TF_TensorFromDLPack(&dlm, status);
+  ASSERT_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+  EXPECT_EQ(TF_TensorType(t), TF_FLOAT);
+  EXPECT_EQ(TF_NumDims(t), 2);
+  EXPECT_EQ(TF_TensorByteSize(t), 4 * sizeof(float));
+  EXPECT_EQ(TF_TensorData(t), data + 16);
+  EXPECT_FALSE(deleted);
+  TF_DeleteTensor(t);
+  EXPECT_TRUE(deleted);
+
+  dltensor->device = {kDLCUDA, 0};
+  EXPECT_EQ(TF_TensorFromDLPack(&dlm, status), nullptr);
+  EXPECT_EQ(TF_INVALID_ARGUMENT, TF_GetCode(status));
+  TF_DeleteStatus(status);
+}
+
 }  // namespace
 }  // namespace tensorflow
@@ -15,14 +15,18 @@ limitations under the License.
 
 #include "tensorflow/cc/saved_model/loader.h"
 
+#include <atomic>
 #include <memory>
+#include <optional>
 #include <string>
 #include <unordered_set>
 #include <utility>
+#include <vector>
 
 #include "absl/status/status.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_join.h"
+#include "absl/strings/string_view.h"
 #include "tensorflow/cc/saved_model/constants.h"
 #include "tensorflow/cc/saved_model/fingerprinting.h"
 #include "tensorflow/cc/saved_model/loader_util.h"
@@ -43,7 +47,9 @@ limitations under the License.
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/file_system_helper.h"
+#include "tensorflow/core/platform/notification.h"
 #include "tensorflow/core/platform/statusor.h"
+#include "tensorflow/core/platform/threadpool.h"
 #include "tensorflow/core/protobuf/meta_graph.pb.h"
 #include "tensorflow/core/protobuf/saver.pb.h"
 #include "tensorflow/core/public/session.h"
@@ -178,54 +184,80 @@ void AddAssetsTensorsToInputs(const StringPiece export_dir,
 // right after ReleaseCallable returns.
 //
 // However, the resource manager state remains.
+//
+// The callable is made by Prepare(), which prunes and optimizes the subgraph
+// and instantiates its kernels, so that it can be done ahead of the run, or
+// concurrently with other runs.
+class PreparedRun {
+ public:
+  explicit PreparedRun(Session* session) : session_(session) {}
+
+  ~PreparedRun() {
+    // Be sure to call ReleaseCallable() regardless of the outcome of
+    // RunCallable().
+    if (callable_handle_.has_value()) {
+      session_->ReleaseCallable(*callable_handle_).IgnoreError();
+    }
+  }
+
+  Status Prepare(const RunOptions& run_options,
+                 const std::vector<std::pair<string, Tensor>>& inputs,
+                 const std::vector<string>& output_tensor_names,
+                 const std::vector<string>& target_node_names) {
+    CallableOptions callable_options;
+    *callable_options.mutable_run_options() = run_options;
+    for (const auto& input : inputs) {
+      const string& name = input.first;
+      const Tensor& tensor = input.second;
+      callable_options.add_feed(name);
+      feed_tensors_.push_back(tensor);
+    }
+    for (const string& output_tensor_name : output_tensor_names) {
+      callable_options.add_fetch(output_tensor_name);
+    }
+    for (const string& target_node_name : target_node_names) {
+      callable_options.add_target(target_node_name);
+    }
+
+    Session::CallableHandle callable_handle;
+    TF_RETURN_IF_ERROR(
+        session_->MakeCallable(callable_options, &callable_handle));
+    callable_handle_ = callable_handle;
+    return absl::OkStatus();
+  }
+
+  // REQUIRES: Prepare() returned OK.
+  Status Run(std::vector<Tensor>* outputs, RunMetadata* run_metadata) {
+    return session_->RunCallable(*callable_handle_, feed_tensors_, outputs,
+                                 run_metadata);
+  }
+
+ private:
+  Session* const session_;
+  std::optional<Session::CallableHandle> callable_handle_;
+  std::vector<Tensor> feed_tensors_;
+};
+
 Status RunOnce(const RunOptions& run_options,
                const std::vector<std::pair<string, Tensor>>& inputs,
                const std::vector<string>& output_tensor_names,
                const std::vector<string>& target_node_names,
                std::vector<Tensor>* outputs, RunMetadata* run_metadata,
                Session* session) {
-  CallableOptions callable_options;
-  std::vector<Tensor> feed_tensors;
-  *callable_options.mutable_run_options() = run_options;
-  for (const auto& input : inputs) {
-    const string& name = input.first;
-    const Tensor& tensor = input.second;
-    callable_options.add_feed(name);
-    feed_tensors.push_back(tensor);
-  }
-  for (const string& output_tensor_name : output_tensor_names) {
-    callable_options.add_fetch(output_tensor_name);
-  }
-  for (const string& target_node_name : target_node_names) {
-    callable_options.add_target(target_node_name);
-  }
-
-  Session::CallableHandle callable_handle;
-  TF_RETURN_IF_ERROR(session->MakeCallable(callable_options, &callable_handle));
-  const Status run_status = session->RunCallable(callable_handle, feed_tensors,
-                                                 outputs, run_metadata);
-  // Be sure to call ReleaseCallable() regardless of the outcome of
-  // RunCallable().
-  session->ReleaseCallable(callable_handle).IgnoreError();
-  return run_status;
+  PreparedRun run(session);
+  TF_RETURN_IF_ERROR(
+      run.Prepare(run_options, inputs, output_tensor_names, target_node_names));
+  return run.Run(outputs, run_metadata);
 }
 
-// RunInitOp will return OK if the initialization op was run successfully.
-// An empty init_op_name indicates that there are no init ops to run.
-Status RunInitOp(const RunOptions& run_options, const string& export_dir,
-                 const MetaGraphDef& meta_graph_def,
-                 const std::vector<AssetFileDef>& asset_file_defs,
-                 Session* session, const string& init_op_name) {
-  if (!init_op_name.empty()) {
-    LOG(INFO) << "Running initialization op on SavedModel bundle at path: "
-              << export_dir;
-    std::vector<std::pair<string, Tensor>> inputs;
-    AddAssetsTensorsToInputs(export_dir, asset_file_defs, &inputs);
-    RunMetadata run_metadata;
-    return RunOnce(run_options, inputs, {}, {init_op_name},
-                   nullptr /* outputs */, &run_metadata, session);
-  }
-  return absl::OkStatus();
+// Prepares the run of the initialization op in `init_run`, ahead of the
+// restore of the variables it reads.
+Status PrepareInitOp(const RunOptions& run_options, const string& export_dir,
+                     const std::vector<AssetFileDef>& asset_file_defs,
+                     const string& init_op_name, PreparedRun* init_run) {
+  std::vector<std::pair<string, Tensor>> inputs;
+  AddAssetsTensorsToInputs(export_dir, asset_file_defs, &inputs);
+  return init_run->Prepare(run_options, inputs, {}, {init_op_name});
 }
 
 Status RunRestore(const RunOptions& run_options, const string& export_dir,
@@ -268,6 +300,65 @@ Status RunRestore(const RunOptions& run_options, const string& export_dir,
                  nullptr /* outputs */, &run_metadata, session);
 }
 
+// Reads the variables data files of a local SavedModel in the background,
+// while the graph is imported and its restore prepared, so that the restore
+// mostly finds them in the page cache instead of waiting for the disk. The
+// remote files, which aren't cached, aren't read. Stops reading when
+// destroyed.
+class VariablesPrefetcher {
+ public:
+  explicit VariablesPrefetcher(const string& export_dir) {
+    absl::string_view scheme, host, path;
+    io::ParseURI(export_dir, &scheme, &host, &path);
+    if (!scheme.empty() && scheme != "file") return;
+    const string pattern =
+        io::JoinPath(export_dir, kSavedModelVariablesDirectory,
+                     absl::StrCat(kSavedModelVariablesFilename, ".data-*"));
+    std::vector<string> filenames;
+    if (!Env::Default()->GetMatchingPaths(pattern, &filenames).ok() ||
+        filenames.empty()) {
+      return;
+    }
+    thread_pool_ = std::make_unique<thread::ThreadPool>(
+        Env::Default(), "saved_model_prefetch", kNumPrefetchThreads);
+    for (const string& filename : filenames) {
+      uint64 size;
+      std::unique_ptr<RandomAccessFile> file;
+      if (!Env::Default()->GetFileSize(filename, &size).ok() ||
+          !Env::Default()->NewRandomAccessFile(filename, &file).ok()) {
+        continue;
+      }
+      std::shared_ptr<RandomAccessFile> shared_file = std::move(file);
+      for (uint64 offset = 0; offset < size; offset += kPrefetchChunkSize) {
+        thread_pool_->Schedule(
+            [this, shared_file, offset]() { Read(*shared_file, offset); });
+      }
+    }
+  }
+
+  ~VariablesPrefetcher() {
+    cancelled_ = true;
+    // Waits for the pending reads, which return right away.
+    thread_pool_.reset();
+  }
+
+ private:
+  static constexpr int kNumPrefetchThreads = 4;
+  static constexpr size_t kPrefetchChunkSize = 8 << 20;
+
+  void Read(const RandomAccessFile& file, uint64 offset) {
+    if (cancelled_) return;
+    std::unique_ptr<char[]> scratch(new char[kPrefetchChunkSize]);
+    absl::string_view result;
+    // The last chunk is short, and the read errors are reported by the
+    // restore.
+    file.Read(offset, kPrefetchChunkSize, &result, scratch.get()).IgnoreError();
+  }
+
+  std::atomic<bool> cancelled_{false};
+  std::unique_ptr<thread::ThreadPool> thread_pool_;
+};
+
 }  // namespace
 
 SavedModelBundleInterface::~SavedModelBundleInterface() = default;
@@ -297,12 +388,19 @@ Status LoadSavedModelInternal(const SessionOptions& session_options,
                               const string& export_dir,
                               const std::unordered_set<string>& tags,
                               SavedModelBundle* const bundle) {
+  VariablesPrefetcher prefetcher(export_dir);
+  const uint64 read_start_microseconds = Env::Default()->NowMicros();
   TF_RETURN_IF_ERROR(ReadMetaGraphDefFromSavedModel(export_dir, tags,
                                                     &bundle->meta_graph_def));
   TF_RETURN_IF_ERROR(
       ReadSavedModelDebugInfoIfPresent(export_dir, &bundle->debug_info));
+  metrics::SavedModelLoadPhaseDuration("read_meta_graph")
+      .Add(GetLatencyMicroseconds(read_start_microseconds));
+  const uint64 create_start_microseconds = Env::Default()->NowMicros();
   TF_RETURN_IF_ERROR(LoadMetagraphIntoSession(
       session_options, bundle->meta_graph_def, &bundle->session));
+  metrics::SavedModelLoadPhaseDuration("create_session")
+      .Add(GetLatencyMicroseconds(create_start_microseconds));
   TF_RETURN_IF_ERROR(RestoreSession(run_options, bundle->meta_graph_def,
                                     export_dir, &bundle->session));
   return absl::OkStatus();
@@ -424,13 +522,20 @@ Status LoadSavedModelInternal(const SessionOptions& session_options,
                               const string& export_dir,
                               const std::unordered_set<string>& tags,
                               SavedModelBundleLite* const bundle) {
+  VariablesPrefetcher prefetcher(export_dir);
+  const uint64 read_start_microseconds = Env::Default()->NowMicros();
   MetaGraphDef meta_graph_def;
   TF_RETURN_IF_ERROR(
       ReadMetaGraphDefFromSavedModel(export_dir, tags, &meta_graph_def));
+  metrics::SavedModelLoadPhaseDuration("read_meta_graph")
+      .Add(GetLatencyMicroseconds(read_start_microseconds));
+  const uint64 create_start_microseconds = Env::Default()->NowMicros();
   std::unique_ptr<Session> session;
   TF_RETURN_IF_ERROR(LoadGraphDefIntoSession(
       session_options, std::move(*meta_graph_def.mutable_graph_def()),
       &session));
+  metrics::SavedModelLoadPhaseDuration("create_session")
+      .Add(GetLatencyMicroseconds(create_start_microseconds));
   TF_RETURN_IF_ERROR(
       RestoreSession(run_options, meta_graph_def, export_dir, &session));
   *bundle = SavedModelBundleLite(
@@ -489,11 +594,33 @@ Status RestoreSession(const RunOptions& run_options,
   const uint64 read_start_microseconds = Env::Default()->NowMicros();
   std::vector<AssetFileDef> asset_file_defs;
   TF_RETURN_IF_ERROR(internal::GetAssetFileDefs(meta_graph, &asset_file_defs));
+  string init_op_name;
+  TF_RETURN_IF_ERROR(
+      internal::GetInitOp(export_dir, meta_graph, &init_op_name));
+
+  // The restore is mostly I/O-bound, and the optimization of the subgraph of
+  // the init op CPU-bound, so the init op is prepared while the variables are
+  // restored. An empty init_op_name indicates that there are no init ops to
+  // run.
+  PreparedRun init_run(session->get());
+  Status init_prepare_status;
+  Notification init_prepared;
+  if (init_op_name.empty()) {
+    init_prepared.Notify();
+  } else {
+    Env::Default()->SchedClosure([&]() {
+      init_prepare_status = PrepareInitOp(run_options, export_dir,
+                                          asset_file_defs, init_op_name,
+                                          &init_run);
+      init_prepared.Notify();
+    });
+  }
+  Status restore_status;
   if (meta_graph.has_saver_def()) {
-    TF_RETURN_IF_ERROR(RunRestore(run_options, export_dir,
-                                  meta_graph.saver_def().restore_op_name(),
-                                  meta_graph.saver_def().filename_tensor_name(),
-                                  asset_file_defs, session->get()));
+    restore_status = RunRestore(run_options, export_dir,
+                                meta_graph.saver_def().restore_op_name(),
+                                meta_graph.saver_def().filename_tensor_name(),
+                                asset_file_defs, session->get());
   }
   // Record walltime spent in restoring graph from disk, but postpone metric
   // increments until graph init finishes.
@@ -501,16 +628,24 @@ Status RestoreSession(const RunOptions& run_options,
       GetLatencyMicroseconds(read_start_microseconds);
 
   const uint64 graph_init_start_microseconds = Env::Default()->NowMicros();
-  string init_op_name;
-  TF_RETURN_IF_ERROR(
-      internal::GetInitOp(export_dir, meta_graph, &init_op_name));
-  TF_RETURN_IF_ERROR(RunInitOp(run_options, export_dir, meta_graph,
-                               asset_file_defs, session->get(), init_op_name));
+  init_prepared.WaitForNotification();
+  TF_RETURN_IF_ERROR(restore_status);
+  TF_RETURN_IF_ERROR(init_prepare_status);
+  if (!init_op_name.empty()) {
+    LOG(INFO) << "Running initialization op on SavedModel bundle at path: "
+              << export_dir;
+    RunMetadata run_metadata;
+    TF_RETURN_IF_ERROR(init_run.Run(nullptr /* outputs */, &run_metadata));
+  }
+  const uint64 graph_init_walltime =
+      GetLatencyMicroseconds(graph_init_start_microseconds);
   load_latency_by_stage->GetCell(export_dir, "restore_graph")
       ->Add(restore_graph_walltime);
   // Record wall time spent in init op.
   load_latency_by_stage->GetCell(export_dir, "init_graph")
-      ->Add(GetLatencyMicroseconds(graph_init_start_microseconds));
+      ->Add(graph_init_walltime);
+  metrics::SavedModelLoadPhaseDuration("restore").Add(restore_graph_walltime);
+  metrics::SavedModelLoadPhaseDuration("init").Add(graph_init_walltime);
   return absl::OkStatus();
 }
 
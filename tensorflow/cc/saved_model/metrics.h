@@ -105,6 +105,12 @@ ParseSavedModelPathAndSingleprint(std::string path_and_singleprint);
 // found when loading the SavedModel.
 monitoring::GaugeCell<std::string>& SavedModelFoundFingerprintOnLoad();
 
+// Returns "/tensorflow/core/saved_model/load/phase_durations" cell belonging to
+// field `phase`, one of "read_meta_graph", "create_session", "restore" and
+// "init", which describes how long that phase of a SavedModel load took in
+// microseconds.
+monitoring::SamplerCell& SavedModelLoadPhaseDuration(absl::string_view phase);
+
 // Returns "/tensorflow/core/checkpoint/read/read_durations" cell belonging to
 // field `api_label`.
 monitoring::SamplerCell& CheckpointReadDuration(absl::string_view api_label);
@@ -53,6 +53,13 @@ TEST(MetricsTest, TestSavedModelRead) {
   EXPECT_EQ(SavedModelReadCount("2").value(), 2);
 }
 
+TEST(MetricsTest, TestSavedModelLoadPhase) {
+  EXPECT_EQ(SavedModelLoadPhaseDuration("restore").value().num(), 0);
+  SavedModelLoadPhaseDuration("restore").Add(100);
+  EXPECT_EQ(SavedModelLoadPhaseDuration("restore").value().num(), 1);
+  EXPECT_EQ(SavedModelLoadPhaseDuration("init").value().num(), 0);
+}
+
 TEST(MetricsTest, TestCheckpointRead) {
   EXPECT_EQ(CheckpointReadDuration("foo").value().num(), 0);
   CheckpointReadDuration("foo").Add(100);
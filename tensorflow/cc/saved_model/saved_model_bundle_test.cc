@@ -384,6 +384,27 @@ TEST_F(LoaderTest, UpdateMetricsV1) {
   EXPECT_EQ(metrics::SavedModelReadApi(kCCLoadLabel).value(), api_count + 1);
 }
 
+TEST_F(LoaderTest, UpdatePhaseMetrics) {
+  SavedModelBundle bundle;
+  SessionOptions session_options;
+  RunOptions run_options;
+
+  const int64_t restore_count =
+      metrics::SavedModelLoadPhaseDuration("restore").value().num();
+  const int64_t init_count =
+      metrics::SavedModelLoadPhaseDuration("init").value().num();
+  const string export_dir =
+      io::JoinPath(testing::TensorFlowSrcRoot(), kTestDataInitOpV2);
+  TF_ASSERT_OK(LoadSavedModel(session_options, run_options, export_dir,
+                              {kSavedModelTagServe}, &bundle));
+  CheckSavedModelBundle(export_dir, bundle);
+
+  EXPECT_EQ(metrics::SavedModelLoadPhaseDuration("restore").value().num(),
+            restore_count + 1);
+  EXPECT_EQ(metrics::SavedModelLoadPhaseDuration("init").value().num(),
+            init_count + 1);
+}
+
 TEST_F(LoaderTest, UpdateFingerprintMetrics) {
   SavedModelBundle bundle;
   SessionOptions session_options;
@@ -0,0 +1,101 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/aot/batch_dispatcher.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/compiler/tf2xla/xla_compiled_cpu_function.h"
+
+namespace tensorflow {
+namespace tfcompile {
+
+namespace {
+
+// The instances of the calling thread, keyed by the id of their dispatcher
+// and the index of their variant.
+using ThreadInstances =
+    std::map<std::pair<int64_t, int>, std::unique_ptr<XlaCompiledCpuFunction>>;
+
+ThreadInstances& GetThreadInstances() {
+  thread_local ThreadInstances instances;
+  return instances;
+}
+
+int64_t NextDispatcherId() {
+  static std::atomic<int64_t> next_id(0);
+  return next_id.fetch_add(1);
+}
+
+}  // namespace
+
+BatchDispatcher::BatchDispatcher(const Eigen::ThreadPoolDevice* pool)
+    : pool_(pool), id_(NextDispatcherId()) {}
+
+BatchDispatcher::~BatchDispatcher() {
+  // The instances of the other threads are released when the threads exit.
+  ThreadInstances& instances = GetThreadInstances();
+  instances.erase(instances.lower_bound({id_, 0}),
+                  instances.lower_bound({id_ + 1, 0}));
+}
+
+void BatchDispatcher::AddVariant(
+    int64_t batch_size, const XlaCompiledCpuFunction::StaticData& static_data) {
+  auto it = std::upper_bound(
+      variants_.begin(), variants_.end(), batch_size,
+      [](int64_t size, const auto& variant) { return size < variant.first; });
+  variants_.insert(it, {batch_size, &static_data});
+}
+
+int BatchDispatcher::GetVariantIndex(int64_t batch_size) const {
+  auto it = std::lower_bound(
+      variants_.begin(), variants_.end(), batch_size,
+      [](const auto& variant, int64_t size) { return variant.first < size; });
+  return it == variants_.end() ? -1 : it - variants_.begin();
+}
+
+int64_t BatchDispatcher::GetVariantBatchSize(int64_t batch_size) const {
+  const int index = GetVariantIndex(batch_size);
+  return index < 0 ? -1 : variants_[index].first;
+}
+
+XlaCompiledCpuFunction* BatchDispatcher::GetFunction(int64_t batch_size) {
+  const int index = GetVariantIndex(batch_size);
+  if (index < 0) return nullptr;
+  std::unique_ptr<XlaCompiledCpuFunction>& instance =
+      GetThreadInstances()[{id_, index}];
+  if (instance == nullptr) {
+    instance =
+        std::make_unique<XlaCompiledCpuFunction>(*variants_[index].second);
+    instance->set_thread_pool(pool_);
+  }
+  return instance.get();
+}
+
+std::vector<int64_t> BatchDispatcher::GetBatchSizes() const {
+  std::vector<int64_t> batch_sizes;
+  batch_sizes.reserve(variants_.size());
+  for (const auto& variant : variants_) batch_sizes.push_back(variant.first);
+  return batch_sizes;
+}
+
+}  // namespace tfcompile
+}  // namespace tensorflow
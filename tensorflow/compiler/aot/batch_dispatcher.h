@@ -0,0 +1,103 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_AOT_BATCH_DISPATCHER_H_
+#define TENSORFLOW_COMPILER_AOT_BATCH_DISPATCHER_H_
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/compiler/tf2xla/xla_compiled_cpu_function.h"
+
+namespace tensorflow {
+namespace tfcompile {
+
+// BatchDispatcher serves a model compiled by tfcompile for several batch
+// sizes, see --batch_size, from concurrent threads.
+//
+// A request of batch size n runs on the variant of the smallest batch size
+// >= n, the caller padding the inputs to that batch size. Each thread runs
+// its own instance of the variants, whose buffers are allocated at the first
+// request of the thread and reused by its following requests, so that the
+// threads don't contend for the buffers. The instances use the intra-op
+// thread pool passed to the constructor.
+//
+// Usage example:
+//
+//   BatchDispatcher dispatcher(&device);
+//   dispatcher.AddVariant<MyModelBatch1>();
+//   dispatcher.AddVariant<MyModelBatch8>();
+//
+//   // On each serving thread:
+//   XlaCompiledCpuFunction* function = dispatcher.GetFunction(batch_size);
+//   const int64_t padded_batch_size =
+//       dispatcher.GetVariantBatchSize(batch_size);
+//   ... copy the padded inputs to function->arg_data(i) ...
+//   function->Run();
+//
+// The variants must all be added before the first GetFunction call.
+class BatchDispatcher {
+ public:
+  explicit BatchDispatcher(const Eigen::ThreadPoolDevice* pool = nullptr);
+  ~BatchDispatcher();
+
+  BatchDispatcher(const BatchDispatcher&) = delete;
+  BatchDispatcher& operator=(const BatchDispatcher&) = delete;
+
+  // Adds the variant generated by tfcompile as the class T.
+  template <typename T>
+  void AddVariant() {
+    AddVariant(T::kBatchSize, T::StaticData());
+  }
+
+  // Adds the variant compiled for `batch_size` with `static_data`, which must
+  // outlive the threads calling GetFunction, as the static data of the
+  // generated classes do.
+  void AddVariant(int64_t batch_size,
+                  const XlaCompiledCpuFunction::StaticData& static_data);
+
+  // Returns the batch size of the variant running the requests of
+  // `batch_size`, or -1 if `batch_size` exceeds the batch sizes of all the
+  // variants.
+  int64_t GetVariantBatchSize(int64_t batch_size) const;
+
+  // Returns the instance of the calling thread of the variant running the
+  // requests of `batch_size`, or nullptr if there is none. The instance is
+  // owned by the dispatcher and valid until the thread exits or the
+  // dispatcher is destroyed, whichever comes first.
+  XlaCompiledCpuFunction* GetFunction(int64_t batch_size);
+
+  // Returns the batch sizes of the variants, in increasing order.
+  std::vector<int64_t> GetBatchSizes() const;
+
+ private:
+  // Returns the index of the variant running the requests of `batch_size`, or
+  // -1.
+  int GetVariantIndex(int64_t batch_size) const;
+
+  const Eigen::ThreadPoolDevice* const pool_;
+  // Identifies the dispatcher among the instances of the threads.
+  const int64_t id_;
+  // The batch sizes and the static data of the variants, sorted by batch
+  // sizes.
+  std::vector<std::pair<int64_t, const XlaCompiledCpuFunction::StaticData*>>
+      variants_;
+};
+
+}  // namespace tfcompile
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_COMPILER_AOT_BATCH_DISPATCHER_H_
@@ -0,0 +1,75 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/aot/batch_dispatcher.h"
+
+#include <cstdint>
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+#include "tensorflow/compiler/aot/test_graph_tfadd.h"
+#include "tensorflow/compiler/tf2xla/xla_compiled_cpu_function.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace tfcompile {
+namespace {
+
+// The variants all run the test graph, registered under different batch sizes.
+void AddVariants(BatchDispatcher* dispatcher) {
+  dispatcher->AddVariant(4, AddComp::StaticData());
+  dispatcher->AddVariant(1, AddComp::StaticData());
+}
+
+TEST(BatchDispatcher, SelectsSmallestVariant) {
+  BatchDispatcher dispatcher;
+  AddVariants(&dispatcher);
+  EXPECT_EQ(dispatcher.GetBatchSizes(), std::vector<int64_t>({1, 4}));
+  EXPECT_EQ(dispatcher.GetVariantBatchSize(1), 1);
+  EXPECT_EQ(dispatcher.GetVariantBatchSize(2), 4);
+  EXPECT_EQ(dispatcher.GetVariantBatchSize(4), 4);
+  EXPECT_EQ(dispatcher.GetVariantBatchSize(5), -1);
+  EXPECT_EQ(dispatcher.GetFunction(5), nullptr);
+  EXPECT_NE(dispatcher.GetFunction(1), dispatcher.GetFunction(4));
+  EXPECT_EQ(dispatcher.GetFunction(2), dispatcher.GetFunction(3));
+}
+
+TEST(BatchDispatcher, RunsTheInstanceOfEachThread) {
+  BatchDispatcher dispatcher;
+  AddVariants(&dispatcher);
+  XlaCompiledCpuFunction* function = dispatcher.GetFunction(1);
+  ASSERT_NE(function, nullptr);
+  EXPECT_EQ(dispatcher.GetFunction(1), function);
+
+  XlaCompiledCpuFunction* other_function = nullptr;
+  std::thread thread([&] {
+    other_function = dispatcher.GetFunction(1);
+    *static_cast<int32*>(other_function->arg_data(0)) = 1;
+    *static_cast<int32*>(other_function->arg_data(1)) = 2;
+    EXPECT_TRUE(other_function->Run());
+    EXPECT_EQ(*static_cast<int32*>(other_function->result_data(0)), 3);
+  });
+  thread.join();
+  EXPECT_NE(other_function, function);
+
+  *static_cast<int32*>(function->arg_data(0)) = 10;
+  *static_cast<int32*>(function->arg_data(1)) = 20;
+  EXPECT_TRUE(function->Run());
+  EXPECT_EQ(*static_cast<int32*>(function->result_data(0)), 30);
+}
+
+}  // namespace
+}  // namespace tfcompile
+}  // namespace tensorflow
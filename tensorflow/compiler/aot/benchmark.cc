@@ -108,6 +108,27 @@ void DumpStatsToStdout(const Stats& stats) {
   }
 }
 
+void DumpLatencyCurveToStdout(
+    const std::vector<std::pair<int64_t, Stats>>& stats_per_batch_size) {
+  printf("%10s %12s %12s %12s %12s %16s\n", "batch_size", "mean_us",
+         "median_us", "p90_us", "p99_us", "median_us/example");
+  for (const auto& batch_size_and_stats : stats_per_batch_size) {
+    const int64_t batch_size = batch_size_and_stats.first;
+    std::vector<int64_t> sorted_us(batch_size_and_stats.second.per_iter_us);
+    if (sorted_us.empty()) continue;
+    std::sort(sorted_us.begin(), sorted_us.end());
+    const size_t count_us = sorted_us.size();
+    double sum_us = 0;
+    for (const int64_t us : sorted_us) sum_us += us;
+    const double median_us = sorted_us[count_us / 2];
+    printf("%10lld %12.3f %12.3f %12.3f %12.3f %16.3f\n",
+           static_cast<long long>(batch_size), sum_us / count_us,  // NOLINT
+           median_us, static_cast<double>(sorted_us[count_us * 9 / 10]),
+           static_cast<double>(sorted_us[count_us * 99 / 100]),
+           median_us / std::max<int64_t>(batch_size, 1));
+  }
+}
+
 void Benchmark(const Options& options, const BenchmarkFn& fn, Stats* stats) {
   // If neither max_seconds or max_iters is set, stop at kDefaultMicros.
   const int64_t max_us = (options.max_micros <= 0 && options.max_iters <= 0)
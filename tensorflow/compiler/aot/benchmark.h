@@ -26,6 +26,7 @@ limitations under the License.
 
 #include <functional>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "tensorflow/core/platform/types.h"
@@ -56,6 +57,12 @@ struct Stats {
 // form.
 void DumpStatsToStdout(const Stats& stats);
 
+// DumpLatencyCurveToStdout printfs to stdout a line per batch size with the
+// latency percentiles of its stats, and the median latency per example, to
+// pick the batch sizes compiled with --batch_size.
+void DumpLatencyCurveToStdout(
+    const std::vector<std::pair<int64_t, Stats>>& stats_per_batch_size);
+
 // BenchmarkFn is the signature of the function generated by tfcompile.
 typedef std::function<void()> BenchmarkFn;
 
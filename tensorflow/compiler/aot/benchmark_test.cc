@@ -15,6 +15,10 @@ limitations under the License.
 
 #include "tensorflow/compiler/aot/benchmark.h"
 
+#include <cstdint>
+#include <utility>
+#include <vector>
+
 #include "tensorflow/compiler/aot/test_graph_tfadd.h"
 #include "tensorflow/core/platform/test.h"
 
@@ -40,6 +44,19 @@ TEST(Benchmark, Benchmark) {
   EXPECT_EQ(stats5.per_iter_us.size(), 5);
 }
 
+TEST(Benchmark, DumpLatencyCurveToStdout) {
+  AddComp add;
+
+  Options options;
+  options.max_iters = 10;
+  std::vector<std::pair<int64_t, Stats>> stats_per_batch_size(2);
+  stats_per_batch_size[0].first = 1;
+  Benchmark(options, [&] { add.Run(); }, &stats_per_batch_size[0].second);
+  // Batch sizes without stats are skipped.
+  stats_per_batch_size[1].first = 4;
+  DumpLatencyCurveToStdout(stats_per_batch_size);
+}
+
 }  // namespace
 }  // namespace benchmark
 }  // namespace tfcompile
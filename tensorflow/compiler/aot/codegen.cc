@@ -641,6 +641,9 @@ class {{CLASS}} final : public tensorflow::XlaCompiledCpuFunction {
   // Number of variables for the compiled computation.
   static constexpr size_t kNumVariables = {{VARIABLE_NUM}};
 
+  // Batch size the computation was compiled for with --batch_size, or 0.
+  static constexpr int64_t kBatchSize = {{BATCH_SIZE}};
+
   // Byte size of each argument buffer. There are kNumArgs entries.
   static const ::int64_t ArgSize(::tensorflow::int32 index) {
     return BufferInfos()[ArgIndexToBufferIndex()[index]].size();
@@ -681,6 +684,13 @@ class {{CLASS}} final : public tensorflow::XlaCompiledCpuFunction {
   {{CLASS}}(const {{CLASS}}&) = delete;
   {{CLASS}}& operator=(const {{CLASS}}&) = delete;
 
+  // Returns the instance of the calling thread, whose buffers are allocated
+  // once and reused by all the runs of the thread.
+  static {{CLASS}}& ThreadLocalInstance() {
+    thread_local {{CLASS}} computation;
+    return computation;
+  }
+
   // Arg methods for managing input buffers. Buffers are in row-major order.
   // There is a set of methods for each positional argument, with the following
   // general form:
@@ -812,6 +822,7 @@ class {{CLASS}} final : public tensorflow::XlaCompiledCpuFunction {
       {"{{ARG_NUM}}", absl::StrCat(arg_index_table.size())},
       {"{{ARG_SHAPE_INFOS}}", arg_shape_infos},
       {"{{VARIABLE_NUM}}", absl::StrCat(config.variable_size())},
+      {"{{BATCH_SIZE}}", absl::StrCat(opts.batch_size)},
       {"{{ARG_INDEX_TABLE}}", absl::StrJoin(arg_index_table, ", ")},
       {"{{RESULT_NUM}}", absl::StrCat(result_index_table.size())},
       {"{{RESULT_INDEX_TABLE}}", absl::StrJoin(result_index_table, ", ")},
@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_COMPILER_AOT_CODEGEN_H_
 #define TENSORFLOW_COMPILER_AOT_CODEGEN_H_
 
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -51,6 +52,9 @@ struct CodegenOpts {
 
   // If true, sets this executable as an XLA Runtime one.
   bool use_xla_runtime = false;
+
+  // The batch size the graph was compiled for, see --batch_size, or 0.
+  int64_t batch_size = 0;
 };
 
 // Describes a generated metadata object file.
@@ -15,13 +15,18 @@ limitations under the License.
 
 #include "tensorflow/compiler/aot/compile.h"
 
+#include <algorithm>
+#include <cstdint>
 #include <memory>
+#include <set>
 #include <string>
 #include <utility>
 #include <vector>
 
 #include "absl/base/call_once.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_join.h"
+#include "absl/strings/str_split.h"
 #include "llvm-c/Target.h"
 #include "llvm/Support/ManagedStatic.h"
 #include "tensorflow/compiler/aot/codegen.h"
@@ -170,6 +175,28 @@ Status CompileGraph(GraphDef graph_def, const tf2xla::Config& config,
   return CompileXla(client, computation, aot_opts, compile_result);
 }
 
+Status SetBatchSize(int64_t batch_size, absl::string_view batched_feeds,
+                    tf2xla::Config* config) {
+  std::set<string> feed_names = absl::StrSplit(batched_feeds, ',',
+                                               absl::SkipEmpty());
+  const bool batch_all_feeds = feed_names.empty();
+  for (tf2xla::Feed& feed : *config->mutable_feed()) {
+    const string& node_name = feed.id().node_name();
+    if (!batch_all_feeds && feed_names.erase(node_name) == 0) continue;
+    if (feed.shape().dim_size() == 0) {
+      if (batch_all_feeds) continue;
+      return errors::InvalidArgument("The batched feed ", node_name,
+                                     " is a scalar");
+    }
+    feed.mutable_shape()->mutable_dim(0)->set_size(batch_size);
+  }
+  if (!feed_names.empty()) {
+    return errors::InvalidArgument("Unknown batched feeds ",
+                                   absl::StrJoin(feed_names, ","));
+  }
+  return absl::OkStatus();
+}
+
 static Status ReadProtoFile(const string& fname, protobuf::Message* proto) {
   if (absl::EndsWith(fname, ".pbtxt")) {
     return ReadTextProto(Env::Default(), fname, proto);
@@ -252,6 +279,10 @@ Status Main(const MainFlags& flags) {
     return errors::InvalidArgument("Must specify --config");
   }
   TF_RETURN_IF_ERROR(ReadProtoFile(flags.config, &config));
+  if (flags.batch_size > 0) {
+    TF_RETURN_IF_ERROR(
+        SetBatchSize(flags.batch_size, flags.batched_feeds, &config));
+  }
   TF_RETURN_IF_ERROR(ValidateConfig(config));
   if (flags.dump_fetch_nodes) {
     std::set<string> nodes;
@@ -287,6 +318,7 @@ Status Main(const MainFlags& flags) {
   codegen_opts.gen_name_to_index = flags.gen_name_to_index;
   codegen_opts.gen_program_shape = flags.gen_program_shape;
   codegen_opts.target_triple = flags.target_triple;
+  codegen_opts.batch_size = std::max<int64_t>(flags.batch_size, 0);
   // Set the XLA Runtime bit if this is an HloLowering.
   if (!flags.mlir_components.empty() && flags.mlir_components != "None") {
     for (auto component : absl::StrSplit(flags.mlir_components, ',')) {
@@ -16,9 +16,11 @@ limitations under the License.
 #ifndef TENSORFLOW_COMPILER_AOT_COMPILE_H_
 #define TENSORFLOW_COMPILER_AOT_COMPILE_H_
 
+#include <cstdint>
 #include <memory>
 #include <string>
 
+#include "absl/strings/string_view.h"
 #include "tensorflow/compiler/aot/flags.h"
 #include "tensorflow/compiler/tf2xla/tf2xla.pb.h"
 #include "xla/service/cpu/cpu_compiler.h"
@@ -46,6 +48,13 @@ struct CompileResult {
 Status CompileGraph(GraphDef graph_def, const tf2xla::Config& config,
                     const MainFlags& flags, CompileResult* compile_result);
 
+// Replaces the first dimension of the shape of the feeds of `config` by
+// `batch_size`, to compile a variant of the graph for this batch size.
+// `batched_feeds` is a comma separated list of the node names of the batched
+// feeds. If empty, all the feeds but the scalars are batched.
+Status SetBatchSize(int64_t batch_size, absl::string_view batched_feeds,
+                    tf2xla::Config* config);
+
 // The full compilation method, for reuse in a library setting.
 Status Main(const MainFlags& flags);
 
@@ -66,6 +66,13 @@ void AppendMainFlags(std::vector<Flag>* flag_list, MainFlags* flags) {
        "namespaces may precede the class name, separated by double-colons.  "
        "The class will be generated in the given namespace(s), or if no "
        "namespaces are given, within the global namespace."},
+      {"batch_size", &flags->batch_size,
+       "If positive, the first dimension of the shape of the batched feeds is "
+       "replaced by this batch size, to compile a variant of the graph for "
+       "this batch size."},
+      {"batched_feeds", &flags->batched_feeds,
+       "Comma separated list of the node names of the feeds batched by "
+       "--batch_size.  If empty, all the feeds but the scalars are batched."},
       {"out_function_object", &flags->out_function_object,
        "Output object file containing the generated function for the "
        "TensorFlow model."},
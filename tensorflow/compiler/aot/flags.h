@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_COMPILER_AOT_FLAGS_H_
 #define TENSORFLOW_COMPILER_AOT_FLAGS_H_
 
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -43,6 +44,8 @@ struct MainFlags {
   string out_session_module;
   string mlir_components;
   bool experimental_quantize = false;
+  int64_t batch_size = 0;
+  string batched_feeds;
 
   // Sanitizer pass options
   bool sanitize_dataflow = false;
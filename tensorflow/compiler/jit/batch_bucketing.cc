@@ -0,0 +1,62 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/jit/batch_bucketing.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_split.h"
+#include "absl/strings/string_view.h"
+
+namespace tensorflow {
+
+absl::StatusOr<BatchBuckets> BatchBuckets::Parse(absl::string_view spec) {
+  BatchBuckets buckets;
+  if (spec.empty()) return buckets;
+  if (spec == "pow2") {
+    buckets.powers_of_two_ = true;
+    return buckets;
+  }
+  for (absl::string_view size_string : absl::StrSplit(spec, ',')) {
+    int64_t size;
+    if (!absl::SimpleAtoi(size_string, &size) || size <= 0 ||
+        (!buckets.sizes_.empty() && size <= buckets.sizes_.back())) {
+      return absl::InvalidArgumentError(
+          absl::StrCat("Invalid batch buckets \"", spec,
+                       "\": expected \"pow2\" or increasing positive sizes."));
+    }
+    buckets.sizes_.push_back(size);
+  }
+  return buckets;
+}
+
+int64_t BatchBuckets::GetBucket(int64_t size) const {
+  if (powers_of_two_) {
+    int64_t bucket = 1;
+    while (bucket < size && bucket <= INT64_MAX / 2) bucket *= 2;
+    return std::max(bucket, size);
+  }
+  auto it = std::lower_bound(sizes_.begin(), sizes_.end(), size);
+  return it == sizes_.end() ? size : *it;
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,50 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_JIT_BATCH_BUCKETING_H_
+#define TENSORFLOW_COMPILER_JIT_BATCH_BUCKETING_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+
+namespace tensorflow {
+
+// The sizes the first dimension of the inputs of a cluster is padded to, so
+// that the cluster is compiled once per bucket instead of once per batch size.
+class BatchBuckets {
+ public:
+  BatchBuckets() = default;
+
+  // Parses `spec`: empty to disable the bucketing, "pow2" for the powers of
+  // two, or a comma separated list of increasing sizes.
+  static absl::StatusOr<BatchBuckets> Parse(absl::string_view spec);
+
+  bool enabled() const { return powers_of_two_ || !sizes_.empty(); }
+
+  // Returns the smallest bucket not smaller than `size`, or `size` if it is
+  // larger than all the buckets.
+  int64_t GetBucket(int64_t size) const;
+
+ private:
+  bool powers_of_two_ = false;
+  std::vector<int64_t> sizes_;
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_COMPILER_JIT_BATCH_BUCKETING_H_
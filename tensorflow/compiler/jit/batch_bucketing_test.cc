@@ -0,0 +1,65 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/jit/batch_bucketing.h"
+
+#include <gtest/gtest.h>
+#include "tensorflow/core/platform/status_matchers.h"
+#include "tensorflow/core/platform/statusor.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+using ::tensorflow::testing::StatusIs;
+
+TEST(BatchBucketsTest, Disabled) {
+  TF_ASSERT_OK_AND_ASSIGN(BatchBuckets buckets, BatchBuckets::Parse(""));
+  EXPECT_FALSE(buckets.enabled());
+  EXPECT_EQ(buckets.GetBucket(5), 5);
+}
+
+TEST(BatchBucketsTest, PowersOfTwo) {
+  TF_ASSERT_OK_AND_ASSIGN(BatchBuckets buckets, BatchBuckets::Parse("pow2"));
+  EXPECT_TRUE(buckets.enabled());
+  EXPECT_EQ(buckets.GetBucket(1), 1);
+  EXPECT_EQ(buckets.GetBucket(5), 8);
+  EXPECT_EQ(buckets.GetBucket(64), 64);
+  EXPECT_EQ(buckets.GetBucket(65), 128);
+}
+
+TEST(BatchBucketsTest, Sizes) {
+  TF_ASSERT_OK_AND_ASSIGN(BatchBuckets buckets,
+                          BatchBuckets::Parse("8,24,100"));
+  EXPECT_TRUE(buckets.enabled());
+  EXPECT_EQ(buckets.GetBucket(1), 8);
+  EXPECT_EQ(buckets.GetBucket(8), 8);
+  EXPECT_EQ(buckets.GetBucket(9), 24);
+  EXPECT_EQ(buckets.GetBucket(100), 100);
+  // Larger than all the buckets.
+  EXPECT_EQ(buckets.GetBucket(101), 101);
+}
+
+TEST(BatchBucketsTest, InvalidSizes) {
+  EXPECT_THAT(BatchBuckets::Parse("8,a"),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+  EXPECT_THAT(BatchBuckets::Parse("8,8"),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+  EXPECT_THAT(BatchBuckets::Parse("0,8"),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -0,0 +1,119 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/jit/cluster_speedup.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_set.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
+#include "absl/strings/str_split.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/fingerprint.h"
+#include "tensorflow/core/platform/mutex.h"
+
+namespace tensorflow {
+
+std::string GetClusterFingerprint(absl::Span<const std::string> node_names) {
+  std::vector<std::string> sorted_node_names(node_names.begin(),
+                                             node_names.end());
+  std::sort(sorted_node_names.begin(), sorted_node_names.end());
+  return absl::StrCat(
+      absl::Hex(Fingerprint64(absl::StrJoin(sorted_node_names, ",")),
+                absl::kZeroPad16));
+}
+
+void ClusterSpeedupTracker::RecordTfRun(const std::string& cluster,
+                                        int64_t micros) {
+  mutex_lock lock(mu_);
+  Samples& samples = samples_[cluster];
+  ++samples.num_tf_runs;
+  samples.tf_micros += micros;
+}
+
+bool ClusterSpeedupTracker::RecordXlaRun(const std::string& cluster,
+                                         int64_t micros) {
+  mutex_lock lock(mu_);
+  Samples& samples = samples_[cluster];
+  ++samples.num_xla_runs;
+  samples.xla_micros += micros;
+  if (slow_clusters_.contains(cluster) ||
+      samples.num_tf_runs < min_samples_ ||
+      samples.num_xla_runs < min_samples_) {
+    return false;
+  }
+  // Compares the averages.
+  if (samples.xla_micros * samples.num_tf_runs <=
+      samples.tf_micros * samples.num_xla_runs) {
+    return false;
+  }
+  slow_clusters_.insert(cluster);
+  return true;
+}
+
+bool ClusterSpeedupTracker::IsSlow(const std::string& cluster) const {
+  mutex_lock lock(mu_);
+  return slow_clusters_.contains(cluster);
+}
+
+std::vector<std::string> ClusterSpeedupTracker::GetSlowClusters() const {
+  mutex_lock lock(mu_);
+  std::vector<std::string> slow_clusters(slow_clusters_.begin(),
+                                         slow_clusters_.end());
+  std::sort(slow_clusters.begin(), slow_clusters.end());
+  return slow_clusters;
+}
+
+/*static*/ ClusterSpeedupTracker* ClusterSpeedupTracker::Global() {
+  static ClusterSpeedupTracker* tracker =
+      new ClusterSpeedupTracker(/*min_samples=*/5);
+  return tracker;
+}
+
+absl::Status ReadDeclusterList(Env* env, const std::string& path,
+                               absl::flat_hash_set<std::string>* clusters) {
+  if (env->FileExists(path).code() == absl::StatusCode::kNotFound) {
+    return absl::OkStatus();
+  }
+  std::string contents;
+  TF_RETURN_IF_ERROR(ReadFileToString(env, path, &contents));
+  for (absl::string_view cluster :
+       absl::StrSplit(contents, '\n', absl::SkipWhitespace())) {
+    clusters->insert(std::string(cluster));
+  }
+  return absl::OkStatus();
+}
+
+absl::Status AddToDeclusterList(Env* env, const std::string& path,
+                                absl::Span<const std::string> clusters) {
+  absl::flat_hash_set<std::string> all_clusters;
+  TF_RETURN_IF_ERROR(ReadDeclusterList(env, path, &all_clusters));
+  all_clusters.insert(clusters.begin(), clusters.end());
+  std::vector<std::string> sorted_clusters(all_clusters.begin(),
+                                           all_clusters.end());
+  std::sort(sorted_clusters.begin(), sorted_clusters.end());
+  return WriteStringToFile(
+      env, path, absl::StrCat(absl::StrJoin(sorted_clusters, "\n"), "\n"));
+}
+
+}  // namespace tensorflow
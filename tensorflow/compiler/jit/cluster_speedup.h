@@ -0,0 +1,86 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_JIT_CLUSTER_SPEEDUP_H_
+#define TENSORFLOW_COMPILER_JIT_CLUSTER_SPEEDUP_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/status/status.h"
+#include "absl/types/span.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+
+// Returns a key identifying a cluster from the names of its nodes, stable
+// across the processes running the same graph.
+std::string GetClusterFingerprint(absl::Span<const std::string> node_names);
+
+// Compares the times of the executions of the clusters compiled with XLA to
+// the times of their TF fallback, sampled on the same steps, to find the
+// clusters slower under XLA.
+class ClusterSpeedupTracker {
+ public:
+  // A cluster is slow once it has at least `min_samples` samples and its
+  // average XLA time is larger than its average TF time.
+  explicit ClusterSpeedupTracker(int64_t min_samples)
+      : min_samples_(min_samples) {}
+
+  // Records the time of an execution of the TF fallback of `cluster`.
+  void RecordTfRun(const std::string& cluster, int64_t micros);
+
+  // Records the time of an execution of `cluster` compiled with XLA. Returns
+  // true if this sample makes the cluster slow.
+  bool RecordXlaRun(const std::string& cluster, int64_t micros);
+
+  bool IsSlow(const std::string& cluster) const;
+
+  // Returns the slow clusters, sorted.
+  std::vector<std::string> GetSlowClusters() const;
+
+  static ClusterSpeedupTracker* Global();
+
+ private:
+  struct Samples {
+    int64_t num_tf_runs = 0;
+    int64_t tf_micros = 0;
+    int64_t num_xla_runs = 0;
+    int64_t xla_micros = 0;
+  };
+
+  const int64_t min_samples_;
+  mutable mutex mu_;
+  absl::flat_hash_map<std::string, Samples> samples_ TF_GUARDED_BY(mu_);
+  absl::flat_hash_set<std::string> slow_clusters_ TF_GUARDED_BY(mu_);
+};
+
+// Reads the clusters, one per line, of the decluster list `path` into
+// `clusters`. A missing file is an empty list.
+absl::Status ReadDeclusterList(Env* env, const std::string& path,
+                               absl::flat_hash_set<std::string>* clusters);
+
+// Adds `clusters` to the decluster list `path`.
+absl::Status AddToDeclusterList(Env* env, const std::string& path,
+                                absl::Span<const std::string> clusters);
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_COMPILER_JIT_CLUSTER_SPEEDUP_H_
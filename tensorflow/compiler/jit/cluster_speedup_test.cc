@@ -0,0 +1,79 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/jit/cluster_speedup.h"
+
+#include <string>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "absl/container/flat_hash_set.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/status_matchers.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+using ::testing::UnorderedElementsAre;
+
+TEST(ClusterSpeedupTest, FingerprintIgnoresTheOrderOfTheNodes) {
+  EXPECT_EQ(GetClusterFingerprint({"a", "b", "c"}),
+            GetClusterFingerprint({"c", "a", "b"}));
+  EXPECT_NE(GetClusterFingerprint({"a", "b"}),
+            GetClusterFingerprint({"a", "b", "c"}));
+}
+
+TEST(ClusterSpeedupTest, FindsTheClustersSlowerUnderXla) {
+  ClusterSpeedupTracker tracker(/*min_samples=*/2);
+  tracker.RecordTfRun("fast", 100);
+  tracker.RecordTfRun("slow", 100);
+  EXPECT_FALSE(tracker.RecordXlaRun("fast", 50));
+  EXPECT_FALSE(tracker.RecordXlaRun("slow", 150));
+
+  // Not enough samples yet.
+  EXPECT_FALSE(tracker.IsSlow("slow"));
+
+  tracker.RecordTfRun("fast", 100);
+  tracker.RecordTfRun("slow", 100);
+  EXPECT_FALSE(tracker.RecordXlaRun("fast", 60));
+  EXPECT_TRUE(tracker.RecordXlaRun("slow", 150));
+  EXPECT_FALSE(tracker.RecordXlaRun("slow", 150));
+
+  EXPECT_FALSE(tracker.IsSlow("fast"));
+  EXPECT_TRUE(tracker.IsSlow("slow"));
+  EXPECT_THAT(tracker.GetSlowClusters(), ElementsAre("slow"));
+}
+
+TEST(ClusterSpeedupTest, AddsToTheDeclusterList) {
+  Env* env = Env::Default();
+  const std::string path =
+      io::JoinPath(testing::TmpDir(), "decluster_list.txt");
+  absl::flat_hash_set<std::string> clusters;
+  TF_ASSERT_OK(ReadDeclusterList(env, path, &clusters));
+  EXPECT_THAT(clusters, IsEmpty());
+
+  TF_ASSERT_OK(AddToDeclusterList(env, path, {"b", "a"}));
+  TF_ASSERT_OK(AddToDeclusterList(env, path, {"c", "a"}));
+  TF_ASSERT_OK(ReadDeclusterList(env, path, &clusters));
+  EXPECT_THAT(clusters, UnorderedElementsAre("a", "b", "c"));
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -16,6 +16,8 @@ limitations under the License.
 #ifndef TENSORFLOW_COMPILER_JIT_DEVICE_COMPILER_H_
 #define TENSORFLOW_COMPILER_JIT_DEVICE_COMPILER_H_
 
+#include <algorithm>
+#include <cstdint>
 #include <memory>
 #include <numeric>
 #include <optional>
@@ -92,7 +94,10 @@ class DeviceCompiler : public ResourceBase {
   // and `out_executable`.  If `compile_mode` is `kStrict` then the compilation
   // cache always attempts the compilation on a cache miss. If compilation mode
   // is 'kAsync' compilation of the cluster happens in the background while the
-  // fallback path executes.
+  // fallback path executes. At most
+  // `tf_xla_max_concurrent_async_compilations` asynchronous compilations run
+  // at a time; the others are queued and the clusters executed the most are
+  // compiled first.
   //
   // The result of compilation is written to `*out_compilation_result`, which
   // must be non-null. If `out_executable` is non-null, also builds an
@@ -160,6 +165,27 @@ class DeviceCompiler : public ResourceBase {
                              OpKernelContext* ctx,
                              DeviceCompilationProfiler* profiler);
 
+  // An asynchronous compilation waiting for a compiler thread.
+  struct PendingAsyncCompilation {
+    DeviceCompilationClusterSignature signature;
+    XlaCompiler::CompileOptions compile_options;
+    XlaCompiler::Options options;
+    std::vector<XlaCompiler::Argument> args;
+    NameAttrList function;
+    CompileScope scope;
+    OpKernelContext* ctx;
+    DeviceCompilationProfiler* profiler;
+  };
+
+  // Schedules the pending asynchronous compilations of the clusters with the
+  // most executions, while fewer than `max_concurrent_async_compilations_` are
+  // running.
+  void StartPendingAsyncCompilations()
+      TF_EXCLUSIVE_LOCKS_REQUIRED(async_compilations_mu_);
+
+  // Compiles `compilation` and updates the cache, on a compiler thread.
+  void RunAsyncCompilation(const PendingAsyncCompilation& compilation);
+
   std::unique_ptr<DeviceExecutablePersistor<ExecutableType, ClientType>>
       persistor_;
   std::unique_ptr<DeviceCompilerClient<ExecutableType, ClientType>>
@@ -169,6 +195,13 @@ class DeviceCompiler : public ResourceBase {
   // Pool of threads for asynchronous compilations.
   std::unique_ptr<thread::ThreadPool> async_compiler_threads_;
 
+  const int64_t max_concurrent_async_compilations_;
+  mutex async_compilations_mu_;
+  std::vector<PendingAsyncCompilation> pending_async_compilations_
+      TF_GUARDED_BY(async_compilations_mu_);
+  int64_t num_running_async_compilations_
+      TF_GUARDED_BY(async_compilations_mu_) = 0;
+
   mutex cluster_mutexes_mu_;
   absl::flat_hash_map<DeviceCompilationClusterSignature, std::unique_ptr<mutex>,
                       DeviceCompilationClusterSignature::Hash>
@@ -190,6 +223,13 @@ inline void LogOnceXlaCompiledFirstCluster() {
   });
 }
 
+inline int64_t GetMaxConcurrentAsyncCompilations() {
+  const int64_t flag =
+      GetXlaOpsCommonFlags()->tf_xla_max_concurrent_async_compilations;
+  return flag <= 0 ? kNumAsyncDeviceCompilerThreads
+                   : std::min(flag, kNumAsyncDeviceCompilerThreads);
+}
+
 template <typename ExecutableType>
 inline Status EligibleToPersist(DeviceCompileState compile_state,
                                 const ExecutableType* executable) {
@@ -212,7 +252,9 @@ DeviceCompiler<ExecutableType, ClientType>::DeviceCompiler(
     std::unique_ptr<DeviceCompilerClient<ExecutableType, ClientType>>
         compiler_client)
     : persistor_(std::move(persistor)),
-      compiler_client_(std::move(compiler_client)) {
+      compiler_client_(std::move(compiler_client)),
+      max_concurrent_async_compilations_(
+          device_compiler_internal::GetMaxConcurrentAsyncCompilations()) {
   cache_ = std::make_unique<DeviceCompilationCache<ExecutableType>>();
   async_compiler_threads_ = std::make_unique<tensorflow::thread::ThreadPool>(
       tensorflow::Env::Default(), "async_compiler_threads",
@@ -224,6 +266,16 @@ DeviceCompiler<ExecutableType, ClientType>::~DeviceCompiler() {
   // Since programs are owned by the cache, ensure any use of our programs have
   // completed by waiting for all stream executors to complete.
   compiler_client_->WaitForProgramsToFinish();
+  // Drop the compilations that haven't started, so that the running ones don't
+  // schedule them on the threads being destroyed.
+  {
+    mutex_lock lock(async_compilations_mu_);
+    for (const PendingAsyncCompilation& compilation :
+         pending_async_compilations_) {
+      compilation.profiler->DecrementOngoingAsyncCompilations();
+    }
+    pending_async_compilations_.clear();
+  }
   // Wait for all outstanding compilations to finish.
   // Resetting the pointer explicitly in the top level destructor.
   // Without this, the pointer would be reset when the AsyncCompilationState
@@ -366,34 +418,72 @@ Status DeviceCompiler<ExecutableType, ClientType>::CompileAsynchronous(
   // updates the async compilation state!
 
   // When the ThreadPool for the compilation cache is destroyed, it waits for
-  // compilations to have finished. This means that both 'entry' and 'this' will
-  // be alive for the duration of the compilation.
-  // !!Pay attention when additional variables must be captured by this lambda!!
-  // All values are captured by value. Make sure that all pointer values (like
-  // entry) do not get freed until the lambda has finished.
-  const std::string& function_name = function.name();
-  async_compiler_threads_->Schedule([=] {
-    VLOG(2) << "Starting asynchronous compilation of cluster " << function_name
-            << '.';
-    // We don't need to lock mu, but do it anyway to satisfy thread safety
-    // analysis.
-    mutex mu;
-    mutex_lock lock(mu);
-    auto cache_value = typename DeviceCompilationCache<ExecutableType>::Value();
-    auto s = CompileStrict(signature, compile_options, options, args, function,
-                           cache_value, scope, ctx, profiler, &mu);
-    VLOG(2) << "Finished asynchronous compililation of cluster "
-            << function_name << '.';
-    profiler->DecrementOngoingAsyncCompilations();
-    // Update compilation status in cache.
-    if (!s.ok()) {
-      cache_->Store(signature, std::nullopt, s.status(), std::nullopt,
-                    std::nullopt);
-    }
-  });
+  // compilations to have finished, and the destructor drops the pending ones.
+  // This means that 'this' will be alive for the duration of the compilation.
+  // All values are copied into the pending compilation. Make sure that all
+  // pointer values (like profiler) do not get freed until it has finished.
+  mutex_lock lock(async_compilations_mu_);
+  pending_async_compilations_.push_back({signature, compile_options, options,
+                                         args, function, scope, ctx,
+                                         profiler});
+  StartPendingAsyncCompilations();
   return absl::OkStatus();
 }
 
+template <typename ExecutableType, typename ClientType>
+void DeviceCompiler<ExecutableType,
+                    ClientType>::StartPendingAsyncCompilations() {
+  while (num_running_async_compilations_ < max_concurrent_async_compilations_ &&
+         !pending_async_compilations_.empty()) {
+    // The hottest cluster first, the oldest request among equally hot ones.
+    auto hottest = pending_async_compilations_.begin();
+    int64_t hottest_execution_count = -1;
+    for (auto it = pending_async_compilations_.begin();
+         it != pending_async_compilations_.end(); ++it) {
+      auto stats = it->profiler->GetCompileStats(it->function);
+      const int64_t execution_count = stats.ok() ? stats->execution_count : 0;
+      if (execution_count > hottest_execution_count) {
+        hottest = it;
+        hottest_execution_count = execution_count;
+      }
+    }
+    PendingAsyncCompilation compilation = std::move(*hottest);
+    pending_async_compilations_.erase(hottest);
+    ++num_running_async_compilations_;
+    async_compiler_threads_->Schedule([this, compilation] {
+      RunAsyncCompilation(compilation);
+      mutex_lock lock(async_compilations_mu_);
+      --num_running_async_compilations_;
+      StartPendingAsyncCompilations();
+    });
+  }
+}
+
+template <typename ExecutableType, typename ClientType>
+void DeviceCompiler<ExecutableType, ClientType>::RunAsyncCompilation(
+    const PendingAsyncCompilation& compilation) {
+  const std::string& function_name = compilation.function.name();
+  VLOG(2) << "Starting asynchronous compilation of cluster " << function_name
+          << '.';
+  // We don't need to lock mu, but do it anyway to satisfy thread safety
+  // analysis.
+  mutex mu;
+  mutex_lock lock(mu);
+  auto cache_value = typename DeviceCompilationCache<ExecutableType>::Value();
+  auto s = CompileStrict(compilation.signature, compilation.compile_options,
+                         compilation.options, compilation.args,
+                         compilation.function, cache_value, compilation.scope,
+                         compilation.ctx, compilation.profiler, &mu);
+  VLOG(2) << "Finished asynchronous compililation of cluster " << function_name
+          << '.';
+  compilation.profiler->DecrementOngoingAsyncCompilations();
+  // Update compilation status in cache.
+  if (!s.ok()) {
+    cache_->Store(compilation.signature, std::nullopt, s.status(),
+                  std::nullopt, std::nullopt);
+  }
+}
+
 template <typename ExecutableType, typename ClientType>
 Status DeviceCompiler<ExecutableType, ClientType>::CompileImpl(
     const XlaCompiler::CompileOptions& compile_options,
@@ -466,8 +556,22 @@ Status DeviceCompiler<ExecutableType, ClientType>::CompileImpl(
 
   if (state == DeviceCompileState::kUncompiled) {
     XLA_SCOPED_LOGGING_TIMER("Compilation of XLA executable");
-    if (!profiler->ShouldCompileCluster(function, compile_mode,
-                                        current_request_count)) {
+    // Loading a persisted executable only lowers the cluster to HLO, which is
+    // cheap enough to do right away, whatever the profitability heuristics of
+    // `compile_mode` would decide.
+    const bool persisted =
+        persistor_ != nullptr &&
+        persistor_->HasPersistedExecutable(
+            DeviceCompilationClusterSignature::Hash()(signature));
+    if (persisted) {
+      VLOG(2) << "Loading persisted executable for signature: "
+              << human_signature;
+      TF_ASSIGN_OR_RETURN(
+          cache_value,
+          CompileStrict(signature, compile_options, options, args, function,
+                        cache_value, scope, ctx, profiler, cluster_mutex));
+    } else if (!profiler->ShouldCompileCluster(function, compile_mode,
+                                               current_request_count)) {
       VLOG(2) << "Not compiling for signature: " << human_signature;
       return absl::OkStatus();
     } else if (compile_mode == DeviceCompileMode::kAsync) {
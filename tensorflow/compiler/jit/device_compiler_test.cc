@@ -29,6 +29,7 @@ limitations under the License.
 #include "tensorflow/cc/ops/math_ops.h"
 #include "tensorflow/compiler/jit/device_compilation_cluster_signature.h"
 #include "tensorflow/compiler/jit/device_compiler_client.h"
+#include "tensorflow/compiler/jit/flags.h"
 #include "tensorflow/compiler/jit/tests/device_compiler_test_helper.h"
 #include "tensorflow/compiler/jit/xla_device_compiler_client.h"
 #include "xla/client/client_library.h"
@@ -318,6 +319,58 @@ TEST_F(DeviceCompilerTest, CompileAsyncSuccess) {
   EXPECT_TRUE(cache_value->compilation_status.ok());
 }
 
+TEST_F(DeviceCompilerTest, CompileAsyncCompilesHottestClusterFirst) {
+  for (const char* name : {"bar", "baz"}) {
+    TF_ASSERT_OK_AND_ASSIGN(auto fdef, SampleFuntionAddXY(name));
+    TF_ASSERT_OK(flib_def_->AddFunctionDef(fdef));
+  }
+  // A compiler running one asynchronous compilation at a time.
+  GetXlaOpsCommonFlags()->tf_xla_max_concurrent_async_compilations = 1;
+  auto xla_device_compiler = CreateXlaDeviceCompiler();
+  core::ScopedUnref xla_device_compiler_ref(xla_device_compiler);
+  GetXlaOpsCommonFlags()->tf_xla_max_concurrent_async_compilations = 0;
+
+  XlaCompiler::Options options = GetDefaultXlaOptions();
+  auto args = SampleArgsForAddXY();
+  NameAttrList foo, bar, baz;
+  foo.set_name("foo");
+  bar.set_name("bar");
+  baz.set_name("baz");
+
+  // The compilation of "foo" doesn't finish before "bar" and "baz" are queued.
+  Notification queued;
+  Notification done;
+  std::vector<std::string> compiled;
+  EXPECT_CALL(*mock_profiler_, ShouldCompileCluster(_, _, _))
+      .WillRepeatedly(Return(true));
+  EXPECT_CALL(*mock_profiler_, RegisterCompilation(_, _, false))
+      .WillRepeatedly([&](const NameAttrList& function, int64_t, bool) {
+        if (function.name() == "foo") queued.WaitForNotification();
+        compiled.push_back(function.name());
+        if (compiled.size() == 3) done.Notify();
+        return absl::OkStatus();
+      });
+
+  // "baz" is executed more often than "bar".
+  for (int i = 0; i < 3; ++i) mock_profiler_->RegisterExecution(baz);
+
+  const XlaCompiler::CompilationResult* compilation_result = nullptr;
+  xla::LocalExecutable* xla_executable = nullptr;
+  for (const NameAttrList& fn : {foo, bar, baz}) {
+    TF_EXPECT_OK(xla_device_compiler->CompileIfNeeded(
+        options, fn, args, XlaCompiler::CompileOptions{},
+        DeviceCompileMode::kAsync, mock_profiler_, &compilation_result,
+        &xla_executable));
+    // The fallback path runs while the compilation is pending.
+    EXPECT_TRUE(compilation_result == nullptr);
+    EXPECT_TRUE(xla_executable == nullptr);
+  }
+  queued.Notify();
+
+  done.WaitForNotification();
+  EXPECT_THAT(compiled, testing::ElementsAre("foo", "baz", "bar"));
+}
+
 TEST_F(DeviceCompilerTest, CompilePersistentCacheEnabled) {
   auto xla_device_compiler =
       CreateXlaDeviceCompiler(/*enable_persistence=*/true);
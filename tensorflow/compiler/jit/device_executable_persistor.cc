@@ -15,14 +15,41 @@ limitations under the License.
 
 #include "tensorflow/compiler/jit/device_executable_persistor.h"
 
+#include <algorithm>
+#include <cstdint>
+#include <optional>
 #include <string>
+#include <utility>
+#include <vector>
 
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/match.h"
+#include "absl/strings/numbers.h"
 #include "absl/strings/str_cat.h"
+#include "absl/strings/str_split.h"
+#include "absl/strings/string_view.h"
+#include "absl/strings/strip.h"
+#include "tensorflow/compiler/jit/xla_compilation_cache.pb.h"
+#include "xla/debug_options_flags.h"
+#include "xla/xla.pb.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/fingerprint.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/public/version.h"
 
 namespace tensorflow {
+namespace {
+
+constexpr char kXlaSerializedCacheKeySeparator[] = "__";
+constexpr char kXlaSerializedCacheFileExtension[] = ".pb";
+
+}  // namespace
 
 std::string XlaSerializedCacheKeyToFileName(const XlaSerializedCacheKey& key) {
-  static constexpr char kXlaSerializedCacheKeySeparator[] = "__";
   return absl::StrCat(
       key.prefix(), key.prefix().empty() ? "" : kXlaSerializedCacheKeySeparator,
       key.signature_fingerprint(), kXlaSerializedCacheKeySeparator,
@@ -31,7 +58,166 @@ std::string XlaSerializedCacheKeyToFileName(const XlaSerializedCacheKey& key) {
       key.compiled_using_pjrt()
           ? absl::StrCat(kXlaSerializedCacheKeySeparator, "pjrt")
           : "",
-      ".pb");
+      key.compiler_fingerprint() != 0
+          ? absl::StrCat(kXlaSerializedCacheKeySeparator,
+                         key.compiler_fingerprint())
+          : "",
+      kXlaSerializedCacheFileExtension);
+}
+
+uint64 XlaPersistentCacheCompilerFingerprint() {
+  static const uint64 fingerprint = [] {
+    uint64 fingerprint = Fingerprint64(
+        absl::StrCat(TF_VERSION_STRING, "/", TF_GRAPH_DEF_VERSION));
+    fingerprint = FingerprintCat64(
+        fingerprint, DeterministicProtoHash64(xla::GetDebugOptionsFromFlags()));
+    // Zero means "not tracked".
+    return fingerprint == 0 ? 1 : fingerprint;
+  }();
+  return fingerprint;
+}
+
+XlaPersistentCacheDirectory::XlaPersistentCacheDirectory(
+    std::string directory, std::string prefix, std::string device_type,
+    uint64 compiler_fingerprint)
+    : directory_(std::move(directory)),
+      prefix_(std::move(prefix)),
+      device_type_(std::move(device_type)),
+      compiler_fingerprint_(compiler_fingerprint) {}
+
+std::optional<uint64> XlaPersistentCacheDirectory::ParseSignatureFingerprint(
+    absl::string_view file_name) const {
+  // See `XlaSerializedCacheKeyToFileName()` for the format.
+  if (!absl::ConsumeSuffix(&file_name, kXlaSerializedCacheFileExtension)) {
+    return std::nullopt;
+  }
+  if (!prefix_.empty() &&
+      !absl::ConsumePrefix(
+          &file_name, absl::StrCat(prefix_, kXlaSerializedCacheKeySeparator))) {
+    return std::nullopt;
+  }
+  std::vector<absl::string_view> parts =
+      absl::StrSplit(file_name, kXlaSerializedCacheKeySeparator);
+  // signature, cluster, device type, [pjrt], [compiler fingerprint].
+  if (parts.size() < 3 || parts[2] != device_type_) return std::nullopt;
+  size_t next = 3;
+  if (next < parts.size() && parts[next] == "pjrt") ++next;
+  uint64 compiler_fingerprint = 0;
+  if (next < parts.size() &&
+      !absl::SimpleAtoi(parts[next++], &compiler_fingerprint)) {
+    return std::nullopt;
+  }
+  if (next != parts.size() || compiler_fingerprint != compiler_fingerprint_) {
+    return std::nullopt;
+  }
+  uint64 signature_fingerprint;
+  if (!absl::SimpleAtoi(parts[0], &signature_fingerprint)) return std::nullopt;
+  return signature_fingerprint;
+}
+
+absl::StatusOr<std::vector<XlaPersistentCacheDirectory::EntryFile>>
+XlaPersistentCacheDirectory::ListEntryFiles() const {
+  Env* env = Env::Default();
+  std::vector<EntryFile> entries;
+  if (!env->IsDirectory(directory_).ok()) return entries;
+
+  std::vector<std::string> children;
+  TF_RETURN_IF_ERROR(env->GetChildren(directory_, &children));
+  for (std::string& child : children) {
+    // Skips the temporary files of in-flight writes, and files of other
+    // caches sharing the directory.
+    if (!absl::EndsWith(child, kXlaSerializedCacheFileExtension) ||
+        !absl::StartsWith(child, prefix_)) {
+      continue;
+    }
+    FileStatistics stat;
+    // The file may have been evicted by another process in the meantime.
+    if (!env->Stat(io::JoinPath(directory_, child), &stat).ok()) continue;
+    entries.push_back({std::move(child), stat.length, stat.mtime_nsec});
+  }
+  std::sort(entries.begin(), entries.end(),
+            [](const EntryFile& a, const EntryFile& b) {
+              return a.mtime_nsec > b.mtime_nsec;
+            });
+  return entries;
+}
+
+bool XlaPersistentCacheDirectory::HasSignature(uint64 signature_fingerprint) {
+  mutex_lock lock(mu_);
+  if (!index_loaded_) {
+    index_loaded_ = true;
+    absl::StatusOr<std::vector<EntryFile>> entries = ListEntryFiles();
+    if (!entries.ok()) {
+      VLOG(1) << "Failed to list XLA persistent cache at " << directory_
+              << ": " << entries.status();
+    } else {
+      for (const EntryFile& entry : *entries) {
+        if (std::optional<uint64> signature =
+                ParseSignatureFingerprint(entry.name)) {
+          signatures_.insert(*signature);
+        }
+      }
+    }
+  }
+  return signatures_.contains(signature_fingerprint);
+}
+
+void XlaPersistentCacheDirectory::AddEntry(const XlaSerializedCacheKey& key) {
+  mutex_lock lock(mu_);
+  signatures_.insert(key.signature_fingerprint());
+}
+
+void XlaPersistentCacheDirectory::Prewarm(int64_t max_entries) {
+  absl::StatusOr<std::vector<EntryFile>> entries = ListEntryFiles();
+  if (!entries.ok()) {
+    LOG(WARNING) << "Failed to prewarm XLA persistent cache at " << directory_
+                 << ": " << entries.status();
+    return;
+  }
+  int64_t num_read = 0;
+  for (const EntryFile& file : *entries) {
+    if (num_read >= max_entries) break;
+    if (!ParseSignatureFingerprint(file.name).has_value()) continue;
+    XlaSerializedCacheEntry entry;
+    Status status = ReadTextOrBinaryProto(
+        Env::Default(), io::JoinPath(directory_, file.name), &entry);
+    if (!status.ok()) {
+      VLOG(1) << "Failed to prewarm XLA persistent cache entry " << file.name
+              << ": " << status;
+      continue;
+    }
+    ++num_read;
+    mutex_lock lock(mu_);
+    signatures_.insert(entry.key().signature_fingerprint());
+    prewarmed_.emplace(file.name, std::move(entry));
+  }
+  VLOG(1) << "Prewarmed " << num_read << " entries of XLA persistent cache at "
+          << directory_;
+}
+
+std::optional<XlaSerializedCacheEntry>
+XlaPersistentCacheDirectory::TakePrewarmedEntry(const std::string& file_name) {
+  mutex_lock lock(mu_);
+  auto it = prewarmed_.find(file_name);
+  if (it == prewarmed_.end()) return std::nullopt;
+  std::optional<XlaSerializedCacheEntry> entry = std::move(it->second);
+  prewarmed_.erase(it);
+  return entry;
+}
+
+Status XlaPersistentCacheDirectory::EvictToSize(int64_t max_bytes) {
+  TF_ASSIGN_OR_RETURN(std::vector<EntryFile> entries, ListEntryFiles());
+  int64_t total_bytes = 0;
+  for (const EntryFile& entry : entries) {
+    total_bytes += entry.length;
+    if (total_bytes <= max_bytes) continue;
+    Status status = Env::Default()->DeleteFile(io::JoinPath(directory_,
+                                                            entry.name));
+    // Another process may be evicting concurrently.
+    if (!status.ok() && !absl::IsNotFound(status)) return status;
+    VLOG(1) << "Evicted XLA persistent cache entry " << entry.name;
+  }
+  return absl::OkStatus();
 }
 
 }  // namespace tensorflow
@@ -16,9 +16,14 @@ limitations under the License.
 #ifndef TENSORFLOW_COMPILER_JIT_DEVICE_EXECUTABLE_PERSISTOR_H_
 #define TENSORFLOW_COMPILER_JIT_DEVICE_EXECUTABLE_PERSISTOR_H_
 
+#include <cstdint>
+#include <memory>
 #include <optional>
 #include <string>
+#include <vector>
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/log/log.h"
 #include "absl/status/status.h"
 #include "tensorflow/compiler/jit/xla_compilation_cache.pb.h"
@@ -29,6 +34,8 @@ limitations under the License.
 #include "xla/util.h"
 #include "tensorflow/core/framework/device.h"
 #include "tensorflow/core/lib/strings/proto_serialization.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/path.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/statusor.h"
@@ -39,6 +46,73 @@ namespace tensorflow {
 // Returns the persisted compilation cache file name for the given key.
 std::string XlaSerializedCacheKeyToFileName(const XlaSerializedCacheKey& key);
 
+// Returns a fingerprint of the TF/XLA build and of the XLA flags that affect
+// code generation, for use as `XlaSerializedCacheKey::compiler_fingerprint`.
+uint64 XlaPersistentCacheCompilerFingerprint();
+
+// Bookkeeping for a persistent compilation cache directory, which may be
+// shared by several processes. Entries are content-addressed by their file
+// name (see `XlaSerializedCacheKeyToFileName()`) and never modified once
+// written, so concurrent readers only have to tolerate entries that are
+// evicted under them.
+//
+// Thread-safe.
+class XlaPersistentCacheDirectory {
+ public:
+  XlaPersistentCacheDirectory(std::string directory, std::string prefix,
+                              std::string device_type,
+                              uint64 compiler_fingerprint);
+
+  // Returns true if an entry for `signature_fingerprint` (with the device
+  // type and compiler fingerprint given at construction) exists. The
+  // directory is listed on the first call, and entries written by other
+  // processes after that are not seen, so the result is only a hint.
+  bool HasSignature(uint64 signature_fingerprint);
+
+  // Records that the entry for `key` was written by this process.
+  void AddEntry(const XlaSerializedCacheKey& key);
+
+  // Reads the `max_entries` most recently written entries of this cache into
+  // memory, so that a later `TakePrewarmedEntry()` does not touch the disk.
+  void Prewarm(int64_t max_entries);
+
+  // Returns the entry stored in `file_name` if it was read by `Prewarm()`,
+  // and releases it from memory.
+  std::optional<XlaSerializedCacheEntry> TakePrewarmedEntry(
+      const std::string& file_name);
+
+  // Deletes the least recently written entries of this cache until the
+  // remaining entries take at most `max_bytes`.
+  Status EvictToSize(int64_t max_bytes);
+
+ private:
+  struct EntryFile {
+    std::string name;
+    int64_t length;
+    int64_t mtime_nsec;
+  };
+
+  // Returns the entry files of this cache (i.e. with its prefix), most
+  // recently written first.
+  absl::StatusOr<std::vector<EntryFile>> ListEntryFiles() const;
+
+  // Returns the signature fingerprint encoded in `file_name`, if the file
+  // holds an entry for this device type and compiler.
+  std::optional<uint64> ParseSignatureFingerprint(
+      absl::string_view file_name) const;
+
+  const std::string directory_;
+  const std::string prefix_;
+  const std::string device_type_;
+  const uint64 compiler_fingerprint_;
+
+  mutex mu_;
+  bool index_loaded_ TF_GUARDED_BY(mu_) = false;
+  absl::flat_hash_set<uint64> signatures_ TF_GUARDED_BY(mu_);
+  absl::flat_hash_map<std::string, XlaSerializedCacheEntry> prewarmed_
+      TF_GUARDED_BY(mu_);
+};
+
 // Offers a way to persist and/or load compiled `ExecutableType`s along with the
 // corresponding HLO (`CompilationResult`) to/from `persistent_cache_directory`
 // (if one was provided during construction) on disk  using `ClientType`.
@@ -78,6 +152,19 @@ class DeviceExecutablePersistor {
 
     // Cache is read-only if set to true.
     bool persistent_cache_directory_read_only = false;
+
+    // Stored in the key of every entry. Entries written with a different
+    // fingerprint are neither loaded nor overwritten. See
+    // `XlaPersistentCacheCompilerFingerprint()`.
+    uint64 compiler_fingerprint = 0;
+
+    // If positive, the least recently written entries are evicted when the
+    // entries in `persistent_cache_directory` exceed this many bytes.
+    int64_t persistent_cache_max_bytes = 0;
+
+    // Number of the most recently written entries that a background thread
+    // reads into memory on construction.
+    int64_t persistent_cache_prewarm_entries = 0;
   };
 
   DeviceExecutablePersistor(const Config& config,
@@ -114,6 +201,13 @@ class DeviceExecutablePersistor {
     return persistent_cache_directory_;
   }
 
+  // Returns true if an executable for `signature_hash` was persisted, in
+  // which case `TryToLoadExecutable()` is expected to be much cheaper than a
+  // compilation. See `XlaPersistentCacheDirectory::HasSignature()`.
+  bool HasPersistedExecutable(uint64 signature_hash) const {
+    return directory_ != nullptr && directory_->HasSignature(signature_hash);
+  }
+
  private:
   // Returns a cache key proto that identifies an entry in the compilation
   // cache.
@@ -159,6 +253,15 @@ class DeviceExecutablePersistor {
   // Cache is read-only if set to true.
   const bool persistent_cache_directory_read_only_;
 
+  const uint64 compiler_fingerprint_;
+  const int64_t persistent_cache_max_bytes_;
+
+  // Null if persistence is not enabled.
+  std::unique_ptr<XlaPersistentCacheDirectory> directory_;
+  // Reads entries into `directory_` in the background. Declared after
+  // `directory_` so that it is joined first.
+  std::unique_ptr<Thread> prewarm_thread_;
+
   DeviceExecutablePersistor(const DeviceExecutablePersistor&) = delete;
   void operator=(const DeviceExecutablePersistor&) = delete;
 };
@@ -172,7 +275,22 @@ DeviceExecutablePersistor<ExecutableType, ClientType>::
       persistence_prefix_(config.persistence_prefix),
       persistent_cache_directory_(config.persistent_cache_directory),
       persistent_cache_directory_read_only_(
-          config.persistent_cache_directory_read_only) {}
+          config.persistent_cache_directory_read_only),
+      compiler_fingerprint_(config.compiler_fingerprint),
+      persistent_cache_max_bytes_(config.persistent_cache_max_bytes) {
+  if (persistent_cache_directory_.empty()) return;
+  directory_ = std::make_unique<XlaPersistentCacheDirectory>(
+      persistent_cache_directory_, persistence_prefix_,
+      device_type_.type_string(), compiler_fingerprint_);
+  if (config.persistent_cache_prewarm_entries > 0) {
+    prewarm_thread_.reset(Env::Default()->StartThread(
+        {}, "xla_persistent_cache_prewarm",
+        [directory = directory_.get(),
+         num_entries = config.persistent_cache_prewarm_entries]() {
+          directory->Prewarm(num_entries);
+        }));
+  }
+}
 
 template <typename ExecutableType, typename ClientType>
 std::string DeviceExecutablePersistor<ExecutableType, ClientType>::GetFilePath(
@@ -192,6 +310,7 @@ DeviceExecutablePersistor<ExecutableType, ClientType>::BuildSerializedCacheKey(
   key.set_device_type(device_type().type_string());
   key.set_prefix(persistence_prefix());
   key.set_compiled_using_pjrt(compiled_using_pjrt);
+  key.set_compiler_fingerprint(compiler_fingerprint_);
   return key;
 }
 
@@ -216,6 +335,12 @@ template <typename ExecutableType, typename ClientType>
 absl::StatusOr<std::optional<XlaSerializedCacheEntry>>
 DeviceExecutablePersistor<ExecutableType, ClientType>::TryToReadSerializedEntry(
     const XlaSerializedCacheKey& key) const {
+  if (directory_ != nullptr) {
+    std::optional<XlaSerializedCacheEntry> entry =
+        directory_->TakePrewarmedEntry(XlaSerializedCacheKeyToFileName(key));
+    if (entry.has_value()) return std::move(entry);
+  }
+
   Env* env = Env::Default();
   const std::string file_path = GetFilePath(key);
   if (!env->FileExists(file_path).ok()) {
@@ -223,8 +348,13 @@ DeviceExecutablePersistor<ExecutableType, ClientType>::TryToReadSerializedEntry(
   }
 
   XlaSerializedCacheEntry entry;
-  TF_RETURN_IF_ERROR(ReadTextOrBinaryProto(env, file_path, &entry));
-  return std::optional<XlaSerializedCacheEntry>(entry);
+  Status status = ReadTextOrBinaryProto(env, file_path, &entry);
+  // Another process may have evicted the entry since it was found.
+  if (absl::IsNotFound(status)) {
+    return absl::StatusOr<std::optional<XlaSerializedCacheEntry>>(std::nullopt);
+  }
+  TF_RETURN_IF_ERROR(status);
+  return std::optional<XlaSerializedCacheEntry>(std::move(entry));
 }
 
 template <typename ExecutableType, typename ClientType>
@@ -294,7 +424,20 @@ DeviceExecutablePersistor<ExecutableType, ClientType>::SaveSerializedEntry(
         "Could not create a unique file inside ", persistent_cache_directory_));
   }
   TF_RETURN_IF_ERROR(WriteBinaryProto(env, temp_path, entry));
-  return env->RenameFile(temp_path, GetFilePath(entry.key()));
+  TF_RETURN_IF_ERROR(env->RenameFile(temp_path, GetFilePath(entry.key())));
+  directory_->AddEntry(entry.key());
+
+  if (persistent_cache_max_bytes_ > 0) {
+    // The entry is persisted at this point, so a failure to evict is not a
+    // failure to persist.
+    Status status = directory_->EvictToSize(persistent_cache_max_bytes_);
+    if (!status.ok()) {
+      LOG_EVERY_POW_2(WARNING)
+          << "Failed to evict entries of XLA persistent cache at "
+          << persistent_cache_directory_ << ": " << status;
+    }
+  }
+  return absl::OkStatus();
 }
 
 template <typename ExecutableType, typename ClientType>
@@ -18,6 +18,7 @@ limitations under the License.
 #include <stdlib.h>
 
 #include <memory>
+#include <optional>
 #include <string>
 #include <utility>
 #include <vector>
@@ -631,5 +632,152 @@ TEST_F(DeviceExecutionPersistorTest, PersistPjRtAndXlaExecutables) {
   EXPECT_EQ(entry.executable(), serialized_xla_executable_);
 }
 
+TEST_F(DeviceExecutionPersistorTest, PersistedSignaturesAreIndexed) {
+  const std::string cache_dir = io::JoinPath(cache_dir_, "indexed");
+  XlaDeviceExecutablePersistor::Config config(
+      /*persistent_cache_directory=*/cache_dir,
+      /*disable_strict_signature_checks=*/false,
+      /*persistence_prefix=*/"xla");
+  XlaDeviceExecutablePersistor persistor(config,
+                                         DefaultXlaOptions().device_type);
+  EXPECT_FALSE(persistor.HasPersistedExecutable(/*signature_hash=*/123));
+
+  MockXlaCompilerClient mock_client;
+  EXPECT_CALL(mock_client, SerializeExecutable(_))
+      .WillOnce(Return(serialized_xla_executable_));
+  TF_ASSERT_OK_AND_ASSIGN(auto executable, BuildSampleExecutable());
+  TF_ASSERT_OK(persistor.TryToPersistExecutable(
+      /*signature_hash=*/123, "signature_string", DefaultXlaOptions(),
+      compilation_result_add_, *executable, &mock_client));
+  EXPECT_TRUE(persistor.HasPersistedExecutable(/*signature_hash=*/123));
+
+  // A new persistor, e.g. of a later process, finds the entry on disk.
+  XlaDeviceExecutablePersistor new_persistor(config,
+                                             DefaultXlaOptions().device_type);
+  EXPECT_TRUE(new_persistor.HasPersistedExecutable(/*signature_hash=*/123));
+  EXPECT_FALSE(new_persistor.HasPersistedExecutable(/*signature_hash=*/456));
+
+  // But not one for another device type.
+  XlaDeviceExecutablePersistor gpu_persistor(config,
+                                             DeviceType(DEVICE_GPU_XLA_JIT));
+  EXPECT_FALSE(gpu_persistor.HasPersistedExecutable(/*signature_hash=*/123));
+}
+
+TEST_F(DeviceExecutionPersistorTest, CompilerFingerprintMismatch) {
+  const std::string cache_dir = io::JoinPath(cache_dir_, "fingerprint");
+  XlaDeviceExecutablePersistor::Config config(
+      /*persistent_cache_directory=*/cache_dir,
+      /*disable_strict_signature_checks=*/false,
+      /*persistence_prefix=*/"xla");
+  config.compiler_fingerprint = 1;
+  XlaDeviceExecutablePersistor persistor(config,
+                                         DefaultXlaOptions().device_type);
+
+  MockXlaCompilerClient mock_client;
+  EXPECT_CALL(mock_client, SerializeExecutable(_))
+      .WillOnce(Return(serialized_xla_executable_));
+  TF_ASSERT_OK_AND_ASSIGN(auto executable, BuildSampleExecutable());
+  TF_ASSERT_OK(persistor.TryToPersistExecutable(
+      /*signature_hash=*/123, "signature_string", DefaultXlaOptions(),
+      compilation_result_add_, *executable, &mock_client));
+
+  auto key =
+      CreateCacheKey(/*signature_hash=*/123, compilation_result_add_,
+                     persistor.device_type(), persistor.persistence_prefix());
+  key.set_compiler_fingerprint(1);
+  TF_ASSERT_OK(Env::Default()->FileExists(
+      io::JoinPath(cache_dir, XlaSerializedCacheKeyToFileName(key))));
+
+  // An executable built by another compiler is neither found nor loaded.
+  config.compiler_fingerprint = 2;
+  XlaDeviceExecutablePersistor other_persistor(config,
+                                               DefaultXlaOptions().device_type);
+  EXPECT_FALSE(other_persistor.HasPersistedExecutable(/*signature_hash=*/123));
+  auto loaded_executable = other_persistor.TryToLoadExecutable(
+      /*signature_hash=*/123, "signature_string", DefaultXlaOptions(),
+      compilation_result_add_, &mock_client);
+  EXPECT_FALSE(loaded_executable.has_value());
+}
+
+TEST_F(DeviceExecutionPersistorTest, EvictsLeastRecentlyWrittenEntries) {
+  const std::string cache_dir = io::JoinPath(cache_dir_, "evict");
+  XlaDeviceExecutablePersistor::Config config(
+      /*persistent_cache_directory=*/cache_dir,
+      /*disable_strict_signature_checks=*/false,
+      /*persistence_prefix=*/"xla");
+  XlaDeviceExecutablePersistor persistor(config,
+                                         DefaultXlaOptions().device_type);
+
+  MockXlaCompilerClient mock_client;
+  EXPECT_CALL(mock_client, SerializeExecutable(_))
+      .WillRepeatedly(Return(serialized_xla_executable_));
+  TF_ASSERT_OK_AND_ASSIGN(auto executable, BuildSampleExecutable());
+  TF_ASSERT_OK(persistor.TryToPersistExecutable(
+      /*signature_hash=*/1, "signature_string", DefaultXlaOptions(),
+      compilation_result_add_, *executable, &mock_client));
+
+  auto first_key =
+      CreateCacheKey(/*signature_hash=*/1, compilation_result_add_,
+                     persistor.device_type(), persistor.persistence_prefix());
+  const std::string first_path = GetFilePath(first_key, cache_dir);
+  uint64 entry_size;
+  TF_ASSERT_OK(Env::Default()->GetFileSize(first_path, &entry_size));
+
+  // Some file systems only record modification times with a resolution of a
+  // second.
+  Env::Default()->SleepForMicroseconds(1100 * 1000);
+
+  // Room for a single entry.
+  config.persistent_cache_max_bytes = entry_size + entry_size / 2;
+  XlaDeviceExecutablePersistor bounded_persistor(
+      config, DefaultXlaOptions().device_type);
+  TF_ASSERT_OK(bounded_persistor.TryToPersistExecutable(
+      /*signature_hash=*/2, "signature_string", DefaultXlaOptions(),
+      compilation_result_add_, *executable, &mock_client));
+
+  auto second_key =
+      CreateCacheKey(/*signature_hash=*/2, compilation_result_add_,
+                     persistor.device_type(), persistor.persistence_prefix());
+  EXPECT_TRUE(absl::IsNotFound(Env::Default()->FileExists(first_path)));
+  TF_EXPECT_OK(
+      Env::Default()->FileExists(GetFilePath(second_key, cache_dir)));
+}
+
+TEST_F(DeviceExecutionPersistorTest, PrewarmedEntriesAreServedFromMemory) {
+  const std::string cache_dir = io::JoinPath(cache_dir_, "prewarm");
+  XlaDeviceExecutablePersistor::Config config(
+      /*persistent_cache_directory=*/cache_dir,
+      /*disable_strict_signature_checks=*/false,
+      /*persistence_prefix=*/"xla");
+  XlaDeviceExecutablePersistor persistor(config,
+                                         DefaultXlaOptions().device_type);
+
+  MockXlaCompilerClient mock_client;
+  EXPECT_CALL(mock_client, SerializeExecutable(_))
+      .WillOnce(Return(serialized_xla_executable_));
+  TF_ASSERT_OK_AND_ASSIGN(auto executable, BuildSampleExecutable());
+  TF_ASSERT_OK(persistor.TryToPersistExecutable(
+      /*signature_hash=*/123, "signature_string", DefaultXlaOptions(),
+      compilation_result_add_, *executable, &mock_client));
+
+  auto key =
+      CreateCacheKey(/*signature_hash=*/123, compilation_result_add_,
+                     persistor.device_type(), persistor.persistence_prefix());
+  const std::string file_name = XlaSerializedCacheKeyToFileName(key);
+
+  XlaPersistentCacheDirectory directory(
+      cache_dir, "xla", persistor.device_type().type_string(),
+      /*compiler_fingerprint=*/0);
+  directory.Prewarm(/*max_entries=*/1);
+  TF_ASSERT_OK(Env::Default()->DeleteFile(io::JoinPath(cache_dir, file_name)));
+
+  std::optional<XlaSerializedCacheEntry> entry =
+      directory.TakePrewarmedEntry(file_name);
+  ASSERT_TRUE(entry.has_value());
+  EXPECT_EQ(entry->executable(), serialized_xla_executable_);
+  // Entries are released from memory once taken.
+  EXPECT_FALSE(directory.TakePrewarmedEntry(file_name).has_value());
+}
+
 }  // namespace
 }  // namespace tensorflow
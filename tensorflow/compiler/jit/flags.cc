@@ -175,6 +175,20 @@ void AppendMarkForCompilationPassFlagsInternal(std::vector<Flag>* flag_list) {
            &mark_for_compilation_flags->tf_xla_persistent_cache_prefix,
            "Specifies the persistance cache prefix. Default is "
            "\"xla_compile_cache\""),
+      Flag("tf_xla_persistent_cache_max_bytes",
+           &mark_for_compilation_flags->tf_xla_persistent_cache_max_bytes,
+           "If positive, the least recently written entries of the persistent "
+           "cache are deleted once the cache directory grows past this many "
+           "bytes. Defaults to 0 (unbounded)."),
+      Flag("tf_xla_persistent_cache_prewarm_entries",
+           &mark_for_compilation_flags->tf_xla_persistent_cache_prewarm_entries,
+           "Number of the most recently written persistent cache entries that "
+           "are read into memory in the background at startup. Defaults to 0."),
+      Flag("tf_xla_tpu_persistent_cache_directory",
+           &mark_for_compilation_flags->tf_xla_tpu_persistent_cache_directory,
+           "If non-empty, the programs compiled by the TPU compile ops are "
+           "saved to and loaded from the specified file system directory "
+           "path, which can be shared by several jobs. Empty by default."),
       Flag("tf_xla_sparse_core_disable_table_stacking",
            &sparse_core_flags->tf_xla_sparse_core_disable_table_stacking,
            "Disable table stacking for all the tables passed to the SparseCore"
@@ -245,6 +259,9 @@ void AllocateAndParseFlags() {
   mark_for_compilation_flags->tf_xla_disable_strict_signature_checks = false;
   mark_for_compilation_flags->tf_xla_persistent_cache_prefix =
       "xla_compile_cache";
+  mark_for_compilation_flags->tf_xla_persistent_cache_max_bytes = 0;
+  mark_for_compilation_flags->tf_xla_persistent_cache_prewarm_entries = 0;
+  mark_for_compilation_flags->tf_xla_tpu_persistent_cache_directory = "";
 
   device_flags = new XlaDeviceFlags;
   device_flags->tf_xla_compile_on_demand = false;
@@ -263,6 +280,10 @@ void AllocateAndParseFlags() {
   ops_flags = new XlaOpsCommonFlags;
   ops_flags->tf_xla_always_defer_compilation = false;
   ops_flags->tf_xla_async_compilation = false;
+  ops_flags->tf_xla_max_concurrent_async_compilations = 0;
+  ops_flags->tf_xla_launch_batch_buckets = "";
+  ops_flags->tf_xla_cluster_speedup_sampling_period = 0;
+  ops_flags->tf_xla_decluster_list_file = "";
   ops_flags->tf_xla_use_device_api.enabled_for_xla_launch_ = true;
   ops_flags->tf_xla_use_device_api.enabled_for_compile_on_demand_ = true;
   ops_flags->tf_xla_use_device_api.enabled_for_compile_and_run_ = true;
@@ -334,6 +355,30 @@ void AllocateAndParseFlags() {
             "When lazy compilation is enabled, asynchronous compilation starts "
             "the cluster compilation in the background, and the fallback path "
             "is executed until the compilation has finished."),
+       Flag("tf_xla_max_concurrent_async_compilations",
+            &ops_flags->tf_xla_max_concurrent_async_compilations,
+            "The maximum number of asynchronous compilations running at the "
+            "same time. The other ones are queued, and the clusters executed "
+            "the most are compiled first. Zero or negative means one per "
+            "compiler thread."),
+       Flag("tf_xla_launch_batch_buckets",
+            &ops_flags->tf_xla_launch_batch_buckets,
+            "The sizes to which the first dimension of the inputs of the "
+            "XlaLaunch clusters is padded, to compile a cluster once per "
+            "bucket: \"pow2\" or increasing sizes separated by commas. Only "
+            "for functions whose examples are independent along the first "
+            "dimension. Empty disables the padding."),
+       Flag("tf_xla_cluster_speedup_sampling_period",
+            &ops_flags->tf_xla_cluster_speedup_sampling_period,
+            "If positive, one in this many executions of a compiled cluster "
+            "also runs its TF fallback to compare their times. The clusters "
+            "slower under XLA aren't compiled anymore and are added to "
+            "--tf_xla_decluster_list_file. Zero disables the sampling."),
+       Flag("tf_xla_decluster_list_file",
+            &ops_flags->tf_xla_decluster_list_file,
+            "The file listing the clusters found slower under XLA, which are "
+            "declustered when the graph is compiled again. Empty disables "
+            "it."),
        Flag("tf_xla_use_device_api_for_xla_launch",
             &ops_flags->tf_xla_use_device_api.enabled_for_xla_launch_,
             "If true, uses Device API (PjRt) for single device compilation and "
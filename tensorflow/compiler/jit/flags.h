@@ -111,6 +111,21 @@ struct MarkForCompilationPassFlags {
 
   // Specifies the persistance cache prefix. Default is "xla_compile_cache"
   string tf_xla_persistent_cache_prefix;
+
+  // If positive, the least recently written entries of the persistent cache
+  // are deleted once the entries in the cache directory exceed this many
+  // bytes. Defaults to 0 (unbounded).
+  int64_t tf_xla_persistent_cache_max_bytes;
+
+  // Number of the most recently written entries of the persistent cache that
+  // are read into memory by a background thread at startup. Defaults to 0.
+  int64_t tf_xla_persistent_cache_prewarm_entries;
+
+  // If non-empty, the programs compiled by the TPU compile ops are saved to
+  // and loaded from the specified file system directory path, which can be
+  // shared by several jobs. The directory should be specific to a TPU runtime
+  // release. `tf_xla_persistent_cache_read_only` applies to it too.
+  std::string tf_xla_tpu_persistent_cache_directory;
 };
 
 // Flags associated with XLA Sparse Core.
@@ -151,6 +166,26 @@ struct XlaOpsCommonFlags {
   // If true, _XlaCompile compiles the cluster asynchronously with respect to
   // the main execution. The fallback path is taken while compilation happens.
   bool tf_xla_async_compilation;
+  // The maximum number of asynchronous compilations running at the same time,
+  // the others wait in a queue ordered by the number of executions of their
+  // clusters. Zero or negative means one per compiler thread.
+  int32 tf_xla_max_concurrent_async_compilations;
+
+  // The sizes of the first dimension to which the inputs of the XlaLaunch
+  // clusters are padded with zeros, so that a cluster is compiled once per
+  // bucket instead of once per batch size: "pow2" for the powers of two, or
+  // increasing sizes separated by commas. Empty disables the padding. Only for
+  // functions whose examples are independent along the first dimension.
+  std::string tf_xla_launch_batch_buckets;
+
+  // If positive, one in this many executions of a cluster compiled by
+  // _XlaCompile also runs its TF fallback, and both are timed. A cluster found
+  // slower under XLA isn't compiled anymore, and is added to
+  // `tf_xla_decluster_list_file`. Zero disables the sampling.
+  int32 tf_xla_cluster_speedup_sampling_period;
+  // The file listing the clusters slower under XLA, which are declustered by
+  // PartiallyDeclusterPass. Empty disables it.
+  std::string tf_xla_decluster_list_file;
 
   class PjRtForSingleDeviceCompilationRollout {
    public:
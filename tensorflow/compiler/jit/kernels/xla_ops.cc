@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow/compiler/jit/kernels/xla_ops.h"
 
+#include <cstdint>
+#include <cstring>
 #include <functional>
 #include <map>
 #include <memory>
@@ -30,6 +32,9 @@ limitations under the License.
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "absl/types/optional.h"
+#include "absl/types/span.h"
+#include "tensorflow/compiler/jit/batch_bucketing.h"
+#include "tensorflow/compiler/jit/cluster_speedup.h"
 #include "tensorflow/compiler/jit/device_compilation_profiler.h"
 #include "tensorflow/compiler/jit/device_compiler.h"
 #include "tensorflow/compiler/jit/encapsulate_subgraphs_pass.h"
@@ -54,6 +59,7 @@ limitations under the License.
 #include "xla/service/gpu/gpu_executable_run_options.h"
 #include "xla/tsl/concurrency/async_value_ref.h"
 #include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/framework/node_def_util.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/op_requires.h"
@@ -92,6 +98,18 @@ auto* xla_launch_counter = monitoring::Counter<1>::New(
     "/tensorflow/core/xla_launch_counter",
     "The number of times a XlaLaunch is called.", "device");
 
+auto* xla_launch_batch_counter = monitoring::Counter<1>::New(
+    "/tensorflow/core/xla_launch_batch_counter",
+    "The number of examples run by the XlaLaunch clusters whose batch is "
+    "padded to a bucket.",
+    "cluster");
+
+auto* xla_launch_padded_batch_counter = monitoring::Counter<1>::New(
+    "/tensorflow/core/xla_launch_padded_batch_counter",
+    "The number of padding examples run by the XlaLaunch clusters whose batch "
+    "is padded to a bucket.",
+    "cluster");
+
 // A closure describing how to run a compiled version of a TensorFlow function.
 //
 // It may seem unusual to stick the resource variable snapshots in this class.
@@ -125,12 +143,20 @@ class ExecutableClosure {
   }
   int num_constant_args() const { return num_constant_args_; }
 
+  // The fingerprint of the cluster if the time of this execution is compared
+  // to the time of its TF fallback, or empty.
+  const std::string& sampled_cluster() const { return sampled_cluster_; }
+  void set_sampled_cluster(std::string sampled_cluster) {
+    sampled_cluster_ = std::move(sampled_cluster);
+  }
+
  private:
   ClientType* client_;
   ExecutableType* executable_;
   const XlaCompiler::CompilationResult* compilation_result_;
   ResourceVarsSnapshot resource_var_snapshots_;
   int num_constant_args_;
+  std::string sampled_cluster_;
 
   ExecutableClosure(const ExecutableClosure&) = delete;
   void operator=(const ExecutableClosure&) = delete;
@@ -205,6 +231,161 @@ XlaComputationLaunchContext GetLaunchContext(
   return launch_context;
 }
 
+// Returns the size of the first dimension shared by the `inputs` of a cluster,
+// or nullopt if the cluster can't be padded to a batch bucket: if it has
+// constant or resource inputs, or inputs that don't share their first
+// dimension.
+std::optional<int64_t> GetBucketableBatchSize(
+    absl::Span<const Tensor* const> inputs, absl::Span<const int> constants,
+    absl::Span<const int> resources) {
+  if (inputs.empty() || !constants.empty() || !resources.empty()) {
+    return std::nullopt;
+  }
+  const int64_t batch_size =
+      inputs[0]->dims() > 0 ? inputs[0]->dim_size(0) : 0;
+  for (const Tensor* input : inputs) {
+    if (input->dims() == 0 || input->NumElements() == 0 ||
+        !DataTypeCanUseMemcpy(input->dtype()) ||
+        input->dim_size(0) != batch_size) {
+      return std::nullopt;
+    }
+  }
+  return batch_size;
+}
+
+// Returns whether all the outputs of `compilation_result` are batched along
+// their first dimension, i.e. can be sliced back to the unpadded batch.
+bool HasBatchedOutputs(const XlaCompiler::CompilationResult& compilation_result,
+                       int64_t padded_batch_size) {
+  if (!compilation_result.resource_updates.empty()) return false;
+  for (const XlaCompiler::OutputDescription& output :
+       compilation_result.outputs) {
+    if (output.is_constant || output.is_tensor_list ||
+        output.type == DT_RESOURCE || output.shape.dims() == 0 ||
+        output.shape.dim_size(0) != padded_batch_size) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Returns a copy of `input` padded with zeros along its first dimension to
+// `padded_batch_size`, on the stream of `ctx` if any.
+absl::StatusOr<Tensor> PadBatch(OpKernelContext* ctx, const Tensor& input,
+                                int64_t padded_batch_size) {
+  TensorShape padded_shape = input.shape();
+  padded_shape.set_dim(0, padded_batch_size);
+  Tensor padded;
+  TF_RETURN_IF_ERROR(
+      ctx->allocate_temp(input.dtype(), padded_shape, &padded));
+  const uint64_t input_bytes = input.TotalBytes();
+  const uint64_t padding_bytes = padded.TotalBytes() - input_bytes;
+  char* padded_data = const_cast<char*>(padded.tensor_data().data());
+  se::Stream* stream = GetStream(ctx);
+  if (stream == nullptr) {
+    std::memcpy(padded_data, input.tensor_data().data(), input_bytes);
+    std::memset(padded_data + input_bytes, 0, padding_bytes);
+    return padded;
+  }
+  se::DeviceMemoryBase input_memory(
+      const_cast<char*>(input.tensor_data().data()), input_bytes);
+  se::DeviceMemoryBase padded_memory(padded_data, padded.TotalBytes());
+  se::DeviceMemoryBase padding_memory =
+      padded_memory.GetByteSlice(input_bytes, padding_bytes);
+  TF_RETURN_IF_ERROR(stream->Memcpy(&padded_memory, input_memory, input_bytes));
+  TF_RETURN_IF_ERROR(stream->MemZero(&padding_memory, padding_bytes));
+  return padded;
+}
+
+// Replaces the outputs of `ctx`, computed for a batch padded to a bucket, with
+// their first `batch_size` examples.
+void SliceBatchedOutputs(OpKernelContext* ctx, int64_t batch_size) {
+  for (int i = 0; i < ctx->num_outputs(); ++i) {
+    std::unique_ptr<Tensor> padded_output(ctx->release_output(i).tensor);
+    if (padded_output == nullptr) continue;
+    ctx->set_output(i, padded_output->Slice(0, batch_size));
+  }
+}
+
+// Returns the fingerprint of the cluster `function`, see
+// `GetClusterFingerprint`, or an empty string if it isn't found or has
+// stateful ops. Sampling runs the cluster twice, the stateful ops would see
+// their side effects repeated.
+std::string GetFunctionClusterFingerprint(const FunctionLibraryRuntime* flr,
+                                          const NameAttrList& function) {
+  if (flr == nullptr) return "";
+  const FunctionLibraryDefinition* flib_def =
+      flr->GetFunctionLibraryDefinition();
+  const FunctionDef* fdef = flib_def->Find(function.name());
+  if (fdef == nullptr) return "";
+  std::vector<std::string> node_names;
+  node_names.reserve(fdef->node_def_size());
+  for (const NodeDef& node : fdef->node_def()) {
+    const OpDef* op_def;
+    if (!flib_def->LookUpOpDef(node.op(), &op_def).ok() ||
+        op_def->is_stateful()) {
+      VLOG(2) << "The cluster " << function.name()
+              << " isn't sampled, it has the stateful or unknown op "
+              << node.name();
+      return "";
+    }
+    node_names.push_back(node.name());
+  }
+  return GetClusterFingerprint(node_names);
+}
+
+// Returns the time since `start_micros`, after waiting for the computations
+// enqueued on the stream of `ctx` if any.
+absl::StatusOr<int64_t> GetElapsedMicros(OpKernelContext* ctx,
+                                         uint64_t start_micros) {
+  if (se::Stream* stream = GetStream(ctx)) {
+    TF_RETURN_IF_ERROR(stream->BlockHostUntilDone());
+  }
+  return Env::Default()->NowMicros() - start_micros;
+}
+
+// Runs `function`, the TF fallback of a cluster, on the inputs of `ctx` and
+// returns its time. The outputs are discarded.
+absl::StatusOr<int64_t> TimeFallbackRun(OpKernelContext* ctx,
+                                        const NameAttrList& function) {
+  FunctionLibraryRuntime* flr = ctx->function_library();
+  FunctionLibraryRuntime::Handle handle;
+  TF_RETURN_IF_ERROR(flr->Instantiate(
+      function.name(), AttrSlice(&function.attr()), &handle));
+  std::vector<Tensor> args;
+  args.reserve(ctx->num_inputs());
+  for (int i = 0; i < ctx->num_inputs(); ++i) {
+    args.push_back(ctx->input(i));
+  }
+  FunctionLibraryRuntime::Options opts;
+  opts.step_id = ctx->step_id();
+  opts.rendezvous = ctx->rendezvous();
+  opts.cancellation_manager = ctx->cancellation_manager();
+  opts.step_container = ctx->step_container();
+  opts.runner = ctx->runner();
+  std::vector<Tensor> rets;
+  const uint64_t start_micros = Env::Default()->NowMicros();
+  TF_RETURN_IF_ERROR(flr->RunSync(std::move(opts), handle, args, &rets));
+  return GetElapsedMicros(ctx, start_micros);
+}
+
+// Records the time of the XLA execution of `cluster` and adds it to the
+// decluster list once it is found slower than its TF fallback.
+void RecordXlaRun(const std::string& cluster, int64_t micros) {
+  if (!ClusterSpeedupTracker::Global()->RecordXlaRun(cluster, micros)) {
+    return;
+  }
+  LOG(WARNING) << "The XLA cluster " << cluster
+               << " is slower than its TF fallback, it is no longer compiled.";
+  const std::string& path = GetXlaOpsCommonFlags()->tf_xla_decluster_list_file;
+  if (path.empty()) return;
+  Status status = AddToDeclusterList(Env::Default(), path, {cluster});
+  if (!status.ok()) {
+    LOG(ERROR) << "Failed to add the cluster " << cluster
+               << " to the decluster list " << path << ": " << status;
+  }
+}
+
 Status GetTaskName(const std::string_view device_name, std::string* task_name) {
   string ignored;
   if (!DeviceNameUtils::SplitDeviceName(device_name, task_name, &ignored)) {
@@ -480,7 +661,12 @@ XlaLocalLaunchBase::XlaLocalLaunchBase(OpKernelConstruction* ctx,
       resources_(resources),
       function_(function),
       platform_info_(XlaPlatformInfoFromDevice(ctx->device())),
-      has_ref_vars_(has_ref_vars) {}
+      has_ref_vars_(has_ref_vars) {
+  absl::StatusOr<BatchBuckets> batch_buckets = BatchBuckets::Parse(
+      GetXlaOpsCommonFlags()->tf_xla_launch_batch_buckets);
+  OP_REQUIRES_OK(ctx, batch_buckets.status());
+  batch_buckets_ = *std::move(batch_buckets);
+}
 
 void XlaLocalLaunchBase::ComputeAsync(OpKernelContext* ctx, DoneCallback done) {
   VLOG(1) << "XlaLocalLaunchOpBase::Compute "
@@ -526,6 +712,21 @@ void XlaLocalLaunchBase::ComputeAsync(OpKernelContext* ctx, DoneCallback done) {
   bool use_pjrt = GetXlaOpsCommonFlags()
                       ->tf_xla_use_device_api.IsEnabledInXlaLaunchForDevice(
                           platform_info_.device_type());
+
+  // The parameters padded along their first dimension to the bucket of their
+  // batch size, so that the cluster is compiled once per bucket. The outputs
+  // are sliced back to the batch size.
+  int64_t batch_size = 0;
+  int64_t padded_batch_size = 0;
+  if (batch_buckets_.enabled() && !use_pjrt &&
+      !platform_info_.is_on_xla_device() && !batch_bucketing_disabled_) {
+    std::optional<int64_t> bucketable_batch_size =
+        GetBucketableBatchSize(inputs, constants_, resources_);
+    if (bucketable_batch_size.has_value()) {
+      batch_size = *bucketable_batch_size;
+      padded_batch_size = batch_buckets_.GetBucket(batch_size);
+    }
+  }
   if (use_pjrt) {
     VLOG(2) << "Compiling using PJRT";
     Status status = CompileToPjRtLoadedExecutable(
@@ -569,16 +770,54 @@ void XlaLocalLaunchBase::ComputeAsync(OpKernelContext* ctx, DoneCallback done) {
     return;
   }
 
-  Status status = CompileToLocalExecutable(
-      ctx, function_, /*has_ref_vars=*/has_ref_vars_, platform_info_,
-      xla_compiler_args, DeviceCompileMode::kStrict,
-      /*may_alias_resource_update=*/true, &client, &compilation_result,
-      &executable);
-  OP_REQUIRES_OK_ASYNC(ctx, status, done);
+  auto padded_inputs = std::make_shared<std::vector<Tensor>>();
+  if (padded_batch_size > batch_size) {
+    std::vector<XlaCompiler::Argument> padded_xla_compiler_args =
+        xla_compiler_args;
+    for (XlaCompiler::Argument& arg : padded_xla_compiler_args) {
+      TensorShape padded_shape = absl::get<TensorShape>(arg.shape);
+      padded_shape.set_dim(0, padded_batch_size);
+      arg.shape = padded_shape;
+    }
+    Status status = CompileToLocalExecutable(
+        ctx, function_, /*has_ref_vars=*/has_ref_vars_, platform_info_,
+        padded_xla_compiler_args, DeviceCompileMode::kStrict,
+        /*may_alias_resource_update=*/true, &client, &compilation_result,
+        &executable);
+    OP_REQUIRES_OK_ASYNC(ctx, status, done);
+    if (HasBatchedOutputs(*compilation_result, padded_batch_size)) {
+      padded_inputs->reserve(inputs.size());
+      for (const Tensor* input : inputs) {
+        absl::StatusOr<Tensor> padded_input =
+            PadBatch(ctx, *input, padded_batch_size);
+        OP_REQUIRES_OK_ASYNC(ctx, padded_input.status(), done);
+        padded_inputs->push_back(*std::move(padded_input));
+      }
+      const std::string& cluster = function_.name();
+      xla_launch_batch_counter->GetCell(cluster)->IncrementBy(batch_size);
+      xla_launch_padded_batch_counter->GetCell(cluster)->IncrementBy(
+          padded_batch_size - batch_size);
+    } else {
+      // Some outputs don't depend on the batch: padding changes them.
+      VLOG(1) << "Not padding the batch of the cluster " << function_.name()
+              << " whose outputs aren't batched.";
+      batch_bucketing_disabled_ = true;
+    }
+  }
+
+  if (padded_inputs->empty()) {
+    Status status = CompileToLocalExecutable(
+        ctx, function_, /*has_ref_vars=*/has_ref_vars_, platform_info_,
+        xla_compiler_args, DeviceCompileMode::kStrict,
+        /*may_alias_resource_update=*/true, &client, &compilation_result,
+        &executable);
+    OP_REQUIRES_OK_ASYNC(ctx, status, done);
+  }
 
   // Continuation of the execution, may be run in a different thread.
   auto run_xla_cluster = [ctx, client, executable, compilation_result, done,
-                          inputs, resources = resources_]() {
+                          inputs, resources = resources_, padded_inputs,
+                          batch_size]() {
     // Separate scope so that VariableInfo locks are released before done is
     // called.
     {
@@ -595,6 +834,10 @@ void XlaLocalLaunchBase::ComputeAsync(OpKernelContext* ctx, DoneCallback done) {
       for (int i = 0; i < resources.size(); i++) {
         resource_var_ptrs[resources[i]] = variable_infos[i].var()->tensor();
       }
+      // The padded inputs are read instead of the inputs of `ctx`.
+      for (int i = 0; i < padded_inputs->size(); i++) {
+        resource_var_ptrs[i] = &(*padded_inputs)[i];
+      }
 
       std::shared_ptr<se::DeviceMemoryAllocator> allocator =
           GetAllocator(ctx->device(), GetStream(ctx), platform_info);
@@ -640,6 +883,7 @@ void XlaLocalLaunchBase::ComputeAsync(OpKernelContext* ctx, DoneCallback done) {
               /*missing_ctx_input_prefix=*/0, absl::MakeSpan(variable_infos),
               input_output_alias, resource_var_ptrs),
           done);
+      if (!padded_inputs->empty()) SliceBatchedOutputs(ctx, batch_size);
       VLOG(1) << "Done";
     }
     done();
@@ -731,7 +975,16 @@ XlaCompileOp::XlaCompileOp(OpKernelConstruction* ctx)
       function_(FunctionAttr(ctx)),
       platform_info_(XlaPlatformInfoFromDevice(ctx->device())),
       must_compile_(MustCompileAttr(ctx)),
-      has_ref_vars_(HasRefVars(ctx)) {}
+      has_ref_vars_(HasRefVars(ctx)) {
+  // The TF fallback is run on the inputs of the op: the clusters with
+  // must-be-constant inputs, in host memory, with resources, which may be
+  // updated, or with stateful ops aren't sampled.
+  if (!must_compile_ && constants_.empty() && resources_.empty() &&
+      GetXlaOpsCommonFlags()->tf_xla_cluster_speedup_sampling_period > 0) {
+    cluster_fingerprint_ =
+        GetFunctionClusterFingerprint(ctx->function_library(), function_);
+  }
+}
 
 void XlaCompileOp::Compute(OpKernelContext* ctx) {
   VLOG(3) << "XlaCompileOp " << def().name()
@@ -764,7 +1017,9 @@ void XlaCompileOp::Compute(OpKernelContext* ctx) {
               platform_info_.device_type());
 
   if (GetXlaOpsCommonFlags()->tf_xla_always_defer_compilation ||
-      cannot_compile_cluster) {
+      cannot_compile_cluster ||
+      (!cluster_fingerprint_.empty() &&
+       ClusterSpeedupTracker::Global()->IsSlow(cluster_fingerprint_))) {
     executable = nullptr;
   } else {
     auto args_and_variables_snapshot = GetXlaCompilerArgsAndSnapshotVariables(
@@ -837,10 +1092,21 @@ void XlaCompileOp::Compute(OpKernelContext* ctx) {
     compilation_key.flat<tstring>()(0) = key;
     VLOG(2) << "Compiled with PJRT. compilation_key: " << key;
   } else {
+    XlaExecutableClosure closure(client, executable, kernel,
+                                 std::move(variables_snapshot),
+                                 constants_.size());
+    const int64_t sampling_period =
+        GetXlaOpsCommonFlags()->tf_xla_cluster_speedup_sampling_period;
+    if (!cluster_fingerprint_.empty() &&
+        ++num_compiled_executions_ % sampling_period == 0) {
+      absl::StatusOr<int64_t> fallback_micros = TimeFallbackRun(ctx, function_);
+      OP_REQUIRES_OK(ctx, fallback_micros.status());
+      ClusterSpeedupTracker::Global()->RecordTfRun(cluster_fingerprint_,
+                                                   *fallback_micros);
+      closure.set_sampled_cluster(cluster_fingerprint_);
+    }
     XlaExecutableClosureStore::KeyT key =
-        XlaExecutableClosureStore::Global()->Produce(XlaExecutableClosure(
-            client, executable, kernel, std::move(variables_snapshot),
-            constants_.size()));
+        XlaExecutableClosureStore::Global()->Produce(std::move(closure));
     compilation_key.flat<tstring>()(0) = key;
     VLOG(2) << "Compiled with XLA. compilation_key: " << key;
   }
@@ -904,6 +1170,7 @@ void XlaRunOp::Compute(OpKernelContext* ctx) {
 
   XlaExecutableClosure closure =
       XlaExecutableClosureStore::Global()->Consume(key);
+  const uint64_t start_micros = Env::Default()->NowMicros();
   std::shared_ptr<se::DeviceMemoryAllocator> allocator =
       GetAllocator(ctx->device(), GetStream(ctx), platform_info_);
   XlaComputationLaunchContext launch_context =
@@ -969,6 +1236,12 @@ void XlaRunOp::Compute(OpKernelContext* ctx) {
           ctx, closure.compilation_result(), execution_output->ConsumeResult(),
           /*missing_ctx_input_prefix=*/closure.num_constant_args(),
           absl::MakeSpan(*variable_infos), input_output_alias, snapshot_ptrs));
+
+  if (!closure.sampled_cluster().empty()) {
+    absl::StatusOr<int64_t> micros = GetElapsedMicros(ctx, start_micros);
+    OP_REQUIRES_OK(ctx, micros.status());
+    RecordXlaRun(closure.sampled_cluster(), *micros);
+  }
 }
 
 XlaMergeOp::XlaMergeOp(OpKernelConstruction* ctx) : OpKernel(ctx) {}
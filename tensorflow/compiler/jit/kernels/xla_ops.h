@@ -17,7 +17,10 @@ limitations under the License.
 #define TENSORFLOW_COMPILER_JIT_KERNELS_XLA_OPS_H_
 
 #include <atomic>
+#include <cstdint>
+#include <string>
 
+#include "tensorflow/compiler/jit/batch_bucketing.h"
 #include "tensorflow/compiler/jit/device_compiler.h"
 #include "tensorflow/compiler/jit/xla_device.h"
 #include "tensorflow/compiler/jit/xla_launch_util.h"
@@ -66,6 +69,11 @@ class XlaLocalLaunchBase : public AsyncOpKernel {
   const XlaPlatformInfo platform_info_;
 
   bool has_ref_vars_;
+
+  // The buckets of the batch sizes, see `tf_xla_launch_batch_buckets`.
+  BatchBuckets batch_buckets_;
+  // Set once the outputs of the cluster are found not to be batched.
+  std::atomic<bool> batch_bucketing_disabled_ = false;
 };
 
 // XlaLocalLaunchOp is used to replace a region of the TensorFlow graph
@@ -116,6 +124,12 @@ class XlaCompileOp : public OpKernel {
       false;
 
   mutex cannot_compile_cluster_mu_;
+
+  // The fingerprint of the cluster if its XLA executions are sampled to be
+  // compared to its TF fallback, see `tf_xla_cluster_speedup_sampling_period`,
+  // or empty.
+  std::string cluster_fingerprint_;
+  std::atomic<int64_t> num_compiled_executions_ = 0;
 };
 
 class XlaRunOp : public OpKernel {
@@ -1918,8 +1918,12 @@ Status MarkForCompilationPass::Run(
   debug_options.ignore_resource_variable_checks =
       flags->tf_xla_disable_resource_variable_safety_checks_for_debugging;
   debug_options.ignore_xla_compile_attr = false;
+  // Executables are persisted by cluster signature, which includes the
+  // cluster name, so they can only be found again by a later run if the name
+  // is stable.
   debug_options.deterministic_cluster_names =
-      flags->tf_xla_deterministic_cluster_names;
+      flags->tf_xla_deterministic_cluster_names ||
+      !flags->tf_xla_persistent_cache_directory.empty();
   debug_options.max_cluster_size = flags->tf_xla_max_cluster_size;
   debug_options.min_cluster_size = flags->tf_xla_min_cluster_size;
   debug_options.fuel = GetPointerToFuel(flags->tf_xla_clustering_fuel);
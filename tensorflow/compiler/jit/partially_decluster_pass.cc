@@ -16,9 +16,12 @@ limitations under the License.
 #include "tensorflow/compiler/jit/partially_decluster_pass.h"
 
 #include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/strings/str_cat.h"
+#include "tensorflow/compiler/jit/cluster_speedup.h"
 #include "tensorflow/compiler/jit/device_util.h"
+#include "tensorflow/compiler/jit/flags.h"
 #include "tensorflow/compiler/jit/xla_cluster_util.h"
 #include "tensorflow/compiler/tf2xla/const_analysis.h"
 #include "tensorflow/compiler/tf2xla/xla_op_registry.h"
@@ -400,6 +403,50 @@ Status PartiallyDeclusterGraph(Graph* graph) {
   return absl::OkStatus();
 }
 }  // namespace decluster_root_shape_consumers
+
+namespace decluster_slow_clusters {
+
+// Declusters the clusters of the decluster list, found slower under XLA than
+// their TF fallback by the _XlaCompile kernels, see
+// `tf_xla_cluster_speedup_sampling_period`.
+Status PartiallyDeclusterGraph(Graph* graph, Env* env) {
+  const std::string& path = GetXlaOpsCommonFlags()->tf_xla_decluster_list_file;
+  if (path.empty()) {
+    return absl::OkStatus();
+  }
+  absl::flat_hash_set<std::string> slow_clusters;
+  TF_RETURN_IF_ERROR(ReadDeclusterList(env, path, &slow_clusters));
+  if (slow_clusters.empty()) {
+    return absl::OkStatus();
+  }
+
+  // The nodes of the clusters, named as in the functions of the clusters.
+  absl::flat_hash_map<std::string, std::vector<Node*>> clusters;
+  for (Node* n : graph->op_nodes()) {
+    std::optional<absl::string_view> cluster = GetXlaClusterForNode(*n);
+    if (cluster.has_value()) {
+      clusters[std::string(*cluster)].push_back(n);
+    }
+  }
+
+  for (const auto& [cluster, nodes] : clusters) {
+    std::vector<std::string> node_names;
+    node_names.reserve(nodes.size());
+    for (const Node* n : nodes) {
+      node_names.push_back(n->name());
+    }
+    if (!slow_clusters.contains(GetClusterFingerprint(node_names))) {
+      continue;
+    }
+    VLOG(2) << "Declustering " << cluster
+            << " because it is slower than its TF fallback";
+    for (Node* n : nodes) {
+      RemoveFromXlaCluster(n);
+    }
+  }
+  return absl::OkStatus();
+}
+}  // namespace decluster_slow_clusters
 }  // namespace
 
 Status PartiallyDeclusterPass::Run(
@@ -430,6 +477,10 @@ Status PartiallyDeclusterPass::Run(
   TF_RETURN_IF_ERROR(
       decluster_root_shape_consumers::PartiallyDeclusterGraph(graph));
 
+  // Runs last, to see the clusters encapsulated into functions.
+  TF_RETURN_IF_ERROR(decluster_slow_clusters::PartiallyDeclusterGraph(
+      graph, options.session_options->env));
+
   return absl::OkStatus();
 }
 }  // namespace tensorflow
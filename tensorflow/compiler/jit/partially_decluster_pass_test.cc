@@ -23,7 +23,9 @@ limitations under the License.
 #include "tensorflow/cc/ops/function_ops.h"
 #include "tensorflow/cc/ops/sendrecv_ops.h"
 #include "tensorflow/cc/ops/standard_ops.h"
+#include "tensorflow/compiler/jit/cluster_speedup.h"
 #include "tensorflow/compiler/jit/defs.h"
+#include "tensorflow/compiler/jit/flags.h"
 #include "tensorflow/compiler/jit/test_util.h"
 #include "tensorflow/compiler/jit/xla_cluster_util.h"
 #include "tensorflow/compiler/tf2xla/cc/ops/xla_ops.h"
@@ -38,6 +40,8 @@ limitations under the License.
 #include "tensorflow/core/graph/algorithm.h"
 #include "tensorflow/core/graph/graph_def_builder.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/path.h"
 #include "tensorflow/core/platform/test.h"
 
 namespace tensorflow {
@@ -466,6 +470,43 @@ TEST(PartiallyDeclusterPassTest, MetadataOpsDontStartClusters) {
   EXPECT_EQ(GetXlaClusterForNode(*n_e), std::nullopt);
 }
 
+TEST(PartiallyDeclusterPassTest, DeclustersSlowClusters) {
+  tensorflow::Scope root = tensorflow::Scope::NewRootScope();
+  tensorflow::Scope in_cluster_0 = root.WithXlaCluster("cluster_0");
+  tensorflow::Scope in_cluster_1 = root.WithXlaCluster("cluster_1");
+
+  Output a = ops::Placeholder(root.WithOpName("a"), DT_FLOAT);
+  Output b = ops::Neg(in_cluster_0.WithOpName("b"), a);
+  Output c = ops::Neg(in_cluster_0.WithOpName("c"), b);
+  Output d = ops::Relu(root.WithOpName("d"), c);
+  Output e = ops::Neg(in_cluster_1.WithOpName("e"), d);
+  (void)ops::Neg(in_cluster_1.WithOpName("f"), e);
+
+  auto graph = std::make_unique<Graph>(OpRegistry::Global());
+  TF_ASSERT_OK(root.ToGraph(graph.get()));
+
+  const std::string path =
+      io::JoinPath(testing::TmpDir(), "slow_clusters.txt");
+  TF_ASSERT_OK(AddToDeclusterList(Env::Default(), path,
+                                  {GetClusterFingerprint({"c", "b"})}));
+  XlaOpsCommonFlags* flags = GetXlaOpsCommonFlags();
+  flags->tf_xla_decluster_list_file = path;
+  Status status = PartiallyDecluster(&graph);
+  flags->tf_xla_decluster_list_file = "";
+  TF_ASSERT_OK(status);
+
+  for (const char* name : {"b", "c"}) {
+    Node* n = FindNodeByName(*graph, name);
+    ASSERT_NE(n, nullptr);
+    EXPECT_EQ(GetXlaClusterForNode(*n), std::nullopt);
+  }
+  for (const char* name : {"e", "f"}) {
+    Node* n = FindNodeByName(*graph, name);
+    ASSERT_NE(n, nullptr);
+    EXPECT_EQ(GetXlaClusterForNode(*n), "cluster_1");
+  }
+}
+
 TEST(PartiallyDeclusterPassTest, MetaConsumersArentDeclustered) {
   tensorflow::Scope root = tensorflow::Scope::NewRootScope();
   tensorflow::Scope in_cluster_and = root.WithXlaCluster("cluster_0");
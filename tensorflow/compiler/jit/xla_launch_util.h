@@ -179,7 +179,8 @@ class XlaComputationLaunchContext {
                             Device* device);
 
   // Add all inputs within `ctx` as XLA arguments (returned by arguments()).
-  // `variables` is a map from TensorFlow argument number to resource variable.
+  // `variables` is a map from TensorFlow argument number to resource variable,
+  // or to a tensor read instead of the input of `ctx` if it isn't a resource.
   //
   // Assumes that the first `missing_ctx_input_prefix` inputs to the kernel are
   // missing and adjusts input indices accordingly.  All elements in kernel's
@@ -59,6 +59,17 @@ using XlaDeviceExecutablePersistor =
 using PjRtDeviceExecutablePersistor =
     DeviceExecutablePersistor<xla::PjRtLoadedExecutable, xla::PjRtClient>;
 
+// Applies the flags that tune the persistent cache, if one is used.
+template <typename PersistorConfig>
+void ConfigurePersistentCache(PersistorConfig* config) {
+  if (config->persistent_cache_directory.empty()) return;
+  const MarkForCompilationPassFlags* flags = GetMarkForCompilationPassFlags();
+  config->compiler_fingerprint = XlaPersistentCacheCompilerFingerprint();
+  config->persistent_cache_max_bytes = flags->tf_xla_persistent_cache_max_bytes;
+  config->persistent_cache_prewarm_entries =
+      flags->tf_xla_persistent_cache_prewarm_entries;
+}
+
 XlaDeviceCompiler* CreateXlaDeviceCompiler(
     const XlaDeviceExecutablePersistor::Config& persistor_config,
     DeviceType compilation_device_type, xla::LocalClient* local_client) {
@@ -78,6 +89,7 @@ PjRtDeviceCompiler* CreatePjRtDeviceCompiler(DeviceType compilation_device_type,
       GetMarkForCompilationPassFlags()->tf_xla_disable_strict_signature_checks,
       GetMarkForCompilationPassFlags()->tf_xla_persistent_cache_prefix,
       GetMarkForCompilationPassFlags()->tf_xla_persistent_cache_read_only);
+  ConfigurePersistentCache(&persistor_config);
 
   return new PjRtDeviceCompiler(
       std::make_unique<PjRtDeviceExecutablePersistor>(
@@ -225,6 +237,7 @@ Status BuildXlaDeviceCompiler(DeviceBase* device, FunctionLibraryRuntime* flr,
       GetMarkForCompilationPassFlags()->tf_xla_disable_strict_signature_checks,
       GetMarkForCompilationPassFlags()->tf_xla_persistent_cache_prefix,
       GetMarkForCompilationPassFlags()->tf_xla_persistent_cache_read_only);
+  ConfigurePersistentCache(&persistor_config);
 
   if (platform_info.xla_device_metadata()) {
     *xla_device_compiler = CreateXlaDeviceCompiler(
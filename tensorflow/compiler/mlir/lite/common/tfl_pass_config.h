@@ -87,6 +87,9 @@ struct PassConfig {
   // have side effects e.g. reduced flatbuffer size. Only certain type
   // conversions are supported.
   bool reduce_type_precision = false;
+  // Whether to fuse chains of elementwise float ops into FusedElementwise
+  // custom ops.
+  bool fuse_elementwise_chains = false;
   // Whether to consider this model a quantized model with quantize/dequantize
   // ops and to convert kernels to quantized kernels wherever appropriate.
   quant::QDQConversionMode qdq_conversion_mode =
@@ -125,6 +128,8 @@ inline llvm::raw_ostream& operator<<(llvm::raw_ostream& os,
             << "\nlegalize_custom_tensor_list_ops: "
             << pass_config.legalize_custom_tensor_list_ops
             << "\nreduce_type_precision: " << pass_config.reduce_type_precision
+            << "\nfuse_elementwise_chains: "
+            << pass_config.fuse_elementwise_chains
             << "\nconvert_qdq_format: "
             << GetQDQQuantModeString(pass_config.qdq_conversion_mode) << "\n";
 }
@@ -541,6 +541,22 @@ struct SignatureDefData {
   uint32_t subgraph_index;
 };
 
+// Returns the data of `attr` if its raw storage already has the layout of a
+// TFLite buffer, so that it can be exported without converting `attr` to a
+// tensor first. The data is owned by the MLIR context.
+std::optional<absl::string_view> GetRawBufferData(mlir::ElementsAttr attr) {
+  auto dense_attr = mlir::dyn_cast<mlir::DenseIntOrFPElementsAttr>(attr);
+  if (!dense_attr || dense_attr.isSplat()) return std::nullopt;
+  // The i1 values are bit-packed in the raw storage.
+  mlir::Type element_type = dense_attr.getElementType();
+  if (!element_type.isIntOrFloat() ||
+      element_type.getIntOrFloatBitWidth() % 8 != 0) {
+    return std::nullopt;
+  }
+  llvm::ArrayRef<char> raw_data = dense_attr.getRawData();
+  return absl::string_view(raw_data.data(), raw_data.size());
+}
+
 // Translates an MLIR module in TFLite dialect to TFLite FlatBuffer.
 class Translator {
  public:
@@ -606,6 +622,13 @@ class Translator {
   std::optional<BufferOffset<tflite::Buffer>> BuildBuffer(
       Value value, bool can_be_deduplicated, int& index);
 
+  // Returns the index of a buffer built earlier with the same data as
+  // `data`, or records `index` as the buffer of `data` and returns
+  // std::nullopt. The identical attributes already share their buffer, this
+  // also shares it between the constants of different types with the same
+  // data, e.g. tied weights that were reshaped or quantized the same way.
+  std::optional<int> FindBufferWithSameData(absl::string_view data, int index);
+
   // Build TFLite tensor from the given type. This function is for tfl.lstm
   // intermediates, which should have UniformQuantizedType.
   std::optional<BufferOffset<tflite::Tensor>> BuildTensorFromType(
@@ -832,7 +855,10 @@ class Translator {
   // Maps buffer data to corresponding buffer index
   // in the idx map, the value is a pair of offset and size
   absl::flat_hash_map<int, std::pair<uint64_t, uint64_t>> buffer_idx_map_;
-  absl::flat_hash_map<int, std::string> buffer_data_map_;
+  // Maps buffer index to the buffer data appended after the FlatBuffer. The
+  // large constants reference the raw data of their attribute instead of
+  // owning a copy of it.
+  absl::flat_hash_map<int, absl::Cord> buffer_data_map_;
   bool buffer_data_exported_ = false;
 
   // Maps custom options data to corresponding node
@@ -896,6 +922,11 @@ class Translator {
   // Map from mlir constant attribute to the buffer index. This is used to
   // deduplicate the buffers in the flatbuffer.
   llvm::DenseMap<mlir::ElementsAttr, int> const_attribute_to_buffer_map_;
+
+  // Map from the fingerprint of the data of the deduplicable buffers to their
+  // index.
+  absl::flat_hash_map<tsl::Fprint128, int, tsl::Fprint128Hasher>
+      buffer_fingerprint_to_index_;
 };
 
 bool Translator::EstimateArithmeticCount(int64_t* count) {
@@ -971,6 +1002,16 @@ std::optional<BufferOffset<tflite::Buffer>> Translator::BuildBuffer(
       data.emplace_back(static_cast<uint8_t>(*(v.getRawData())));
     }
     auto packed_buffer = tflite::PackInt4ValuesDensely(data);
+    if (can_be_deduplicated) {
+      if (std::optional<int> buffer_index = FindBufferWithSameData(
+              absl::string_view(
+                  reinterpret_cast<const char*>(packed_buffer.data()),
+                  packed_buffer.size()),
+              index)) {
+        index = *buffer_index;
+        return empty_buffer_;
+      }
+    }
     if (use_buffer_offset_) {
       buffer_data_map_[index] =
           std::string(packed_buffer.begin(), packed_buffer.end());
@@ -986,6 +1027,27 @@ std::optional<BufferOffset<tflite::Buffer>> Translator::BuildBuffer(
     }
   }
 
+  if (std::optional<absl::string_view> raw_data = GetRawBufferData(attr)) {
+    if (can_be_deduplicated) {
+      if (std::optional<int> buffer_index =
+              FindBufferWithSameData(*raw_data, index)) {
+        index = *buffer_index;
+        return empty_buffer_;
+      }
+    }
+    if (use_buffer_offset_) {
+      buffer_data_map_[index] = absl::MakeCordFromExternal(*raw_data, [] {});
+      return tflite::CreateBuffer(builder_, 0, 1, 1);
+    }
+    if (IsModelBiggerThan2GB(raw_data->size())) {
+      require_use_buffer_offset_ = true;
+      return empty_buffer_;
+    }
+    auto buffer_data = builder_.CreateVector(
+        reinterpret_cast<const uint8_t*>(raw_data->data()), raw_data->size());
+    return tflite::CreateBuffer(builder_, buffer_data);
+  }
+
   tensorflow::Tensor tensor;
   auto status = tensorflow::ConvertToTensor(attr, &tensor);
   if (!status.ok()) {
@@ -1011,6 +1073,14 @@ std::optional<BufferOffset<tflite::Buffer>> Translator::BuildBuffer(
     }
     char* tensor_buffer;
     int bytes = dynamic_buffer.WriteToBuffer(&tensor_buffer);
+    if (can_be_deduplicated) {
+      if (std::optional<int> buffer_index = FindBufferWithSameData(
+              absl::string_view(tensor_buffer, bytes), index)) {
+        free(tensor_buffer);
+        index = *buffer_index;
+        return empty_buffer_;
+      }
+    }
     if (use_buffer_offset_) {
       std::vector<uint8_t> buffer_data(tensor_buffer, tensor_buffer + bytes);
       free(tensor_buffer);
@@ -1030,6 +1100,13 @@ std::optional<BufferOffset<tflite::Buffer>> Translator::BuildBuffer(
   }
 
   absl::string_view tensor_data = tensor.tensor_data();
+  if (can_be_deduplicated) {
+    if (std::optional<int> buffer_index =
+            FindBufferWithSameData(tensor_data, index)) {
+      index = *buffer_index;
+      return empty_buffer_;
+    }
+  }
   if (use_buffer_offset_) {
     buffer_data_map_[index] = std::string(tensor_data);
     return tflite::CreateBuffer(builder_, 0, 1, 1);
@@ -1045,6 +1122,14 @@ std::optional<BufferOffset<tflite::Buffer>> Translator::BuildBuffer(
   }
 }
 
+std::optional<int> Translator::FindBufferWithSameData(absl::string_view data,
+                                                      int index) {
+  auto [it, inserted] = buffer_fingerprint_to_index_.try_emplace(
+      tsl::Fingerprint128(data), index);
+  if (inserted) return std::nullopt;
+  return it->second;
+}
+
 int32_t Translator::UnnamedRegionToSubgraph(
     mlir::Region* region, const tflite::BuiltinOperator op_code) {
   int32_t subgraph_index = subgraphs_.size();
@@ -3637,11 +3722,11 @@ void Translator::AppendBufferData(absl::Cord& result) {
 
   auto it = buffer_data_map_.begin();
   while (it != buffer_data_map_.end()) {
-    std::string buffer = it->second;
+    absl::Cord buffer = std::move(it->second);
     int64_t index = it->first;
     int64_t offset = result.size();
     int64_t size = buffer.size();
-    uint64_t hash = tsl::Fingerprint64(buffer);
+    uint64_t hash = tsl::Fingerprint64(buffer.Flatten());
     if (hashcode_to_pos.find(hash) == hashcode_to_pos.end()) {
       hashcode_to_pos[hash] = std::make_pair(offset, size);
       buffer_idx_map_[index] = std::make_pair(offset, size);
@@ -0,0 +1,61 @@
+// RUN: tf-opt %s -tfl-fuse-elementwise-chains -split-input-file | FileCheck %s
+
+// CHECK-LABEL: fuseGelu
+func.func @fuseGelu(%arg0: tensor<1x128x768xf32>) -> tensor<1x128x768xf32> {
+  %cst = arith.constant dense<0.707106769> : tensor<f32>
+  %cst_0 = arith.constant dense<1.0> : tensor<f32>
+  %cst_1 = arith.constant dense<0.5> : tensor<f32>
+  %0 = tfl.mul(%arg0, %cst) {fused_activation_function = "NONE"} : (tensor<1x128x768xf32>, tensor<f32>) -> tensor<1x128x768xf32>
+  %1 = "tfl.tanh"(%0) : (tensor<1x128x768xf32>) -> tensor<1x128x768xf32>
+  %2 = tfl.add(%1, %cst_0) {fused_activation_function = "NONE"} : (tensor<1x128x768xf32>, tensor<f32>) -> tensor<1x128x768xf32>
+  %3 = tfl.mul(%arg0, %cst_1) {fused_activation_function = "NONE"} : (tensor<1x128x768xf32>, tensor<f32>) -> tensor<1x128x768xf32>
+  %4 = tfl.mul %2, %3 {fused_activation_function = "RELU"} : tensor<1x128x768xf32>
+  func.return %4 : tensor<1x128x768xf32>
+}
+
+// CHECK-NOT: tfl.mul
+// CHECK-NOT: tfl.tanh
+// CHECK: %[[FUSED:.*]] = "tfl.custom"(%arg0) <{custom_code = "FusedElementwise", custom_option = #tfl<const_bytes : "0x{{.*}}">}> : (tensor<1x128x768xf32>) -> tensor<1x128x768xf32>
+// CHECK: return %[[FUSED]]
+
+// -----
+
+// CHECK-LABEL: keepShortChains
+func.func @keepShortChains(%arg0: tensor<4xf32>, %arg1: tensor<4xf32>) -> tensor<4xf32> {
+  %0 = tfl.add %arg0, %arg1 {fused_activation_function = "NONE"} : tensor<4xf32>
+  %1 = "tfl.tanh"(%0) : (tensor<4xf32>) -> tensor<4xf32>
+  func.return %1 : tensor<4xf32>
+}
+
+// CHECK: tfl.add
+// CHECK: tfl.tanh
+// CHECK-NOT: tfl.custom
+
+// -----
+
+// CHECK-LABEL: keepIntermediateResultsUsedOutsideTheChain
+func.func @keepIntermediateResultsUsedOutsideTheChain(%arg0: tensor<4xf32>, %arg1: tensor<4xf32>) -> (tensor<4xf32>, tensor<4xf32>) {
+  %0 = tfl.add %arg0, %arg1 {fused_activation_function = "NONE"} : tensor<4xf32>
+  %1 = "tfl.abs"(%0) : (tensor<4xf32>) -> tensor<4xf32>
+  %2 = "tfl.tanh"(%1) : (tensor<4xf32>) -> tensor<4xf32>
+  %3 = "tfl.logistic"(%2) : (tensor<4xf32>) -> tensor<4xf32>
+  func.return %0, %3 : tensor<4xf32>, tensor<4xf32>
+}
+
+// CHECK: %[[ADD:.*]] = tfl.add %arg0, %arg1
+// CHECK: %[[FUSED:.*]] = "tfl.custom"(%[[ADD]]) <{custom_code = "FusedElementwise"
+// CHECK: return %[[ADD]], %[[FUSED]]
+
+// -----
+
+// CHECK-LABEL: keepBroadcastsOfNonScalars
+func.func @keepBroadcastsOfNonScalars(%arg0: tensor<2x4xf32>, %arg1: tensor<4xf32>) -> tensor<2x4xf32> {
+  %0 = tfl.add(%arg0, %arg1) {fused_activation_function = "NONE"} : (tensor<2x4xf32>, tensor<4xf32>) -> tensor<2x4xf32>
+  %1 = "tfl.abs"(%0) : (tensor<2x4xf32>) -> tensor<2x4xf32>
+  %2 = "tfl.tanh"(%1) : (tensor<2x4xf32>) -> tensor<2x4xf32>
+  %3 = "tfl.logistic"(%2) : (tensor<2x4xf32>) -> tensor<2x4xf32>
+  func.return %3 : tensor<2x4xf32>
+}
+
+// CHECK: %[[ADD:.*]] = tfl.add(%arg0, %arg1)
+// CHECK: "tfl.custom"(%[[ADD]]) <{custom_code = "FusedElementwise"
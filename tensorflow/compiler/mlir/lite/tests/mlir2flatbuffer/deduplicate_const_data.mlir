@@ -0,0 +1,21 @@
+// RUN: flatbuffer_translate -mlir-to-tflite-flatbuffer %s -o - | flatbuffer_to_string - | FileCheck %s
+
+// The constants have different shapes but the same data, so they share their
+// buffer.
+func.func @main(%arg0: tensor<3x2xf32>, %arg1: tensor<6xf32>) -> (tensor<3x2xf32>, tensor<6xf32>) attributes {tf.entry_function = {inputs = "x,y", outputs = "a,b"}} {
+  %0 = "tfl.pseudo_const" () {value = dense<[[1.0, 2.0], [3.0, 4.0], [5.0, 6.0]]> : tensor<3x2xf32>} : () -> tensor<3x2xf32>
+  %1 = "tfl.pseudo_const" () {value = dense<[1.0, 2.0, 3.0, 4.0, 5.0, 6.0]> : tensor<6xf32>} : () -> tensor<6xf32>
+  %2 = "tfl.add" (%0, %arg0) {fused_activation_function = "NONE"} : (tensor<3x2xf32>, tensor<3x2xf32>) -> tensor<3x2xf32>
+  %3 = "tfl.add" (%1, %arg1) {fused_activation_function = "NONE"} : (tensor<6xf32>, tensor<6xf32>) -> tensor<6xf32>
+  func.return %2, %3 : tensor<3x2xf32>, tensor<6xf32>
+}
+
+// CHECK:          shape: [ 3, 2 ],
+// CHECK-NEXT:     buffer: [[BUFFER:[0-9]+]],
+// CHECK-NEXT:     name: "tfl.pseudo_const",
+// CHECK:          shape: [ 6 ],
+// CHECK-NEXT:     buffer: [[BUFFER]],
+// CHECK-NEXT:     name: "tfl.pseudo_const1",
+// CHECK:        buffers: [
+// CHECK-COUNT-1:  data: [ 0, 0, 128, 63, 0, 0, 0, 64, 0, 0, 64, 64, 0, 0, 128, 64, 0, 0, 160, 64, 0, 0, 192, 64 ]
+// CHECK-NOT:      data: [ 0, 0, 128, 63, 0, 0, 0, 64, 0, 0, 64, 64, 0, 0, 128, 64, 0, 0, 160, 64, 0, 0, 192, 64 ]
@@ -181,3 +181,15 @@ func.func @FoldReshape(%arg0: tensor<4xi32>, %arg1: tensor<1x48x80x16x!quant.uni
   // CHECK{LITERAL}: "tfl.pseudo_qconst"() <{qtype = tensor<1x2x2x16x!quant.uniform<i8<-127:127>:f32, 0.022395913056501255>>, value = dense<[[[[12, -60, -51, -59, -62, 33, 53, 17, -31, 50, 27, 7, -19, -34, -14, -26], [47, -84, -32, -36, -102, -8, -8, 35, -33, 59, 95, 40, -25, -30, -55, 25]], [[4, -41, -61, 12, -23, 48, 40, 15, -39, 52, 81, -62, -24, 17, -7, -52], [40, -70, -45, 32, -43, 2, -30, 34, -35, 58, 77, -28, -30, 37, -47, -5]]]]> : tensor<1x2x2x16xi8>}> : () -> tensor<1x2x2x16x!quant.uniform<i8<-127:127>:f32, 0.022395913056501255>>
   // CHECK-NEXT: "tfl.transpose_conv"
 }
+
+// CHECK-LABEL: FoldDequantizeQuantizeChain
+func.func @FoldDequantizeQuantizeChain(%arg0: tensor<2x!quant.uniform<i8:f32, 1.0>>) -> (tensor<2x!quant.uniform<i8:f32, 1.0>>, tensor<2x!quant.uniform<i8:f32, 2.0>>) {
+  %0 = "tfl.dequantize"(%arg0) : (tensor<2x!quant.uniform<i8:f32, 1.0>>) -> tensor<2xf32>
+  %1 = "tfl.quantize"(%0) {qtype = tensor<2x!quant.uniform<i8:f32, 1.0>>} : (tensor<2xf32>) -> tensor<2x!quant.uniform<i8:f32, 1.0>>
+  %2 = "tfl.quantize"(%0) {qtype = tensor<2x!quant.uniform<i8:f32, 2.0>>} : (tensor<2xf32>) -> tensor<2x!quant.uniform<i8:f32, 2.0>>
+  func.return %1, %2 : tensor<2x!quant.uniform<i8:f32, 1.0>>, tensor<2x!quant.uniform<i8:f32, 2.0>>
+
+  // CHECK-NEXT: %[[dq:.*]] = "tfl.dequantize"(%arg0)
+  // CHECK-NEXT: %[[q:.*]] = "tfl.quantize"(%[[dq]]) <{qtype = tensor<2x!quant.uniform<i8:f32, 2.000000e+00>>}>
+  // CHECK-NEXT: return %arg0, %[[q]]
+}
@@ -543,13 +543,21 @@ void AddPostVariableFreezingTFToTFLConversionPasses(
                    .RunAndRewriteDynamicRangeQuantizationPasses()) {
       AddDynamicRangeQuantizationPasses(pass_config, *pass_manager);
     }
-    pass_manager->addPass(mlir::createCanonicalizerPass());
+    // Nested in the functions so that they are canonicalized in parallel.
+    pass_manager->addNestedPass<mlir::func::FuncOp>(
+        mlir::createCanonicalizerPass());
 
     if (pass_config.reduce_type_precision ||
         toco_flags.reduce_type_precision()) {
       pass_manager->addPass(mlir::TFL::CreateReduceTypePrecisionPass());
     }
 
+    if (pass_config.fuse_elementwise_chains ||
+        toco_flags.fuse_elementwise_chains()) {
+      pass_manager->addNestedPass<mlir::func::FuncOp>(
+          mlir::TFL::CreateFuseElementwiseChainsPass());
+    }
+
     // This pass should be always at the end of the model
     // conversion (even after quantization). Some TFL ops like unidirectional
     // sequence lstm will have stateful operands and some optimization passes
@@ -229,6 +229,7 @@ int main(int argc, char **argv) {
   pass_config.enable_hlo_to_tf_conversion = enable_hlo_to_tf_conversion;
   pass_config.disable_hlo_to_tfl_conversion = disable_hlo_to_tfl_conversion;
   pass_config.reduce_type_precision = reduce_type_precision;
+  pass_config.fuse_elementwise_chains = fuse_elementwise_chains;
 
   toco::TocoFlags toco_flags;
   toco_flags.set_force_select_tf_ops(!emit_builtin_tflite_ops);
@@ -241,6 +242,8 @@ int main(int argc, char **argv) {
   toco_flags.set_legalize_custom_tensor_list_ops(
       legalize_custom_tensor_list_ops);
   toco_flags.set_reduce_type_precision(reduce_type_precision);
+  toco_flags.set_fuse_elementwise_chains(fuse_elementwise_chains);
+  toco_flags.mutable_debug_options()->set_enable_timing(enable_timing);
   // Read list of user select ops.
   llvm::SmallVector<llvm::StringRef, 2> user_ops;
   (llvm::StringRef(select_user_tf_ops))
@@ -211,3 +211,16 @@ opt<bool> reduce_type_precision(
                    "within the reduced precision range. This could have side "
                    "effects triggered by downstream packing algorithms."),
     llvm::cl::init(false));
+
+// NOLINTNEXTLINE
+opt<bool> fuse_elementwise_chains(
+    "fuse-elementwise-chains",
+    llvm::cl::desc("Fuse chains of elementwise float ops into FusedElementwise "
+                   "custom ops."),
+    llvm::cl::init(false));
+
+// NOLINTNEXTLINE
+opt<bool> enable_timing(
+    "enable-timing",
+    llvm::cl::desc("Report the execution time of each pass of the conversion."),
+    llvm::cl::init(false));
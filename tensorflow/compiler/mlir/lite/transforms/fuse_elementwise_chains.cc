@@ -0,0 +1,302 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// This transformation pass fuses chains of elementwise float ops into
+// FusedElementwise custom ops. The TFLite kernel of the custom op computes the
+// whole chain tile by tile in a single pass over its inputs, instead of
+// writing and reading back an intermediate tensor for every op of the chain.
+//
+// The custom options of the op describe the chain as a program, in the format
+// of tensorflow/lite/kernels/fused_elementwise_program.h.
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "flatbuffers/flexbuffers.h"  // from @flatbuffers
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/DenseSet.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SetVector.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Casting.h"
+#include "mlir/Dialect/Func/IR/FuncOps.h"  // from @llvm-project
+#include "mlir/IR/Attributes.h"  // from @llvm-project
+#include "mlir/IR/Block.h"  // from @llvm-project
+#include "mlir/IR/Builders.h"  // from @llvm-project
+#include "mlir/IR/BuiltinAttributes.h"  // from @llvm-project
+#include "mlir/IR/BuiltinTypes.h"  // from @llvm-project
+#include "mlir/IR/Location.h"  // from @llvm-project
+#include "mlir/IR/Matchers.h"  // from @llvm-project
+#include "mlir/IR/Operation.h"  // from @llvm-project
+#include "mlir/IR/Value.h"  // from @llvm-project
+#include "mlir/Pass/Pass.h"  // from @llvm-project
+#include "mlir/Support/LLVM.h"  // from @llvm-project
+#include "tensorflow/compiler/mlir/lite/ir/tfl_ops.h"
+#include "tensorflow/compiler/mlir/lite/transforms/passes.h"
+
+namespace mlir {
+namespace TFL {
+namespace {
+
+#define GEN_PASS_DEF_FUSEELEMENTWISECHAINSPASS
+#include "tensorflow/compiler/mlir/lite/transforms/passes.h.inc"
+
+constexpr char kFusedElementwise[] = "FusedElementwise";
+
+// Returns the op code of `op` in the program of a FusedElementwise op, if it
+// is an elementwise op the kernel supports.
+std::optional<StringRef> GetOpCode(Operation* op) {
+  if (isa<AddOp>(op)) return StringRef("ADD");
+  if (isa<SubOp>(op)) return StringRef("SUB");
+  if (isa<MulOp>(op)) return StringRef("MUL");
+  if (isa<DivOp>(op)) return StringRef("DIV");
+  if (isa<MaximumOp>(op)) return StringRef("MAXIMUM");
+  if (isa<MinimumOp>(op)) return StringRef("MINIMUM");
+  if (isa<SquaredDifferenceOp>(op)) return StringRef("SQUARED_DIFFERENCE");
+  if (isa<AbsOp>(op)) return StringRef("ABS");
+  if (isa<ExpOp>(op)) return StringRef("EXP");
+  if (isa<LogisticOp>(op)) return StringRef("LOGISTIC");
+  if (isa<NegOp>(op)) return StringRef("NEG");
+  if (isa<ReluOp>(op)) return StringRef("RELU");
+  if (isa<Relu6Op>(op)) return StringRef("RELU6");
+  if (isa<Relu1Op>(op)) return StringRef("RELU_N1_TO_1");
+  if (isa<RsqrtOp>(op)) return StringRef("RSQRT");
+  if (isa<SqrtOp>(op)) return StringRef("SQRT");
+  if (isa<SquareOp>(op)) return StringRef("SQUARE");
+  if (isa<TanhOp>(op)) return StringRef("TANH");
+  return std::nullopt;
+}
+
+// Returns the op code of the instruction computing the fused activation
+// function of `op`, "" if it has none, or nullopt if it isn't supported.
+std::optional<StringRef> GetActivationOpCode(Operation* op) {
+  auto activation =
+      op->getAttrOfType<StringAttr>("fused_activation_function");
+  if (!activation || activation.getValue() == "NONE") return StringRef("");
+  if (activation.getValue() == "RELU") return StringRef("RELU");
+  if (activation.getValue() == "RELU6") return StringRef("RELU6");
+  if (activation.getValue() == "RELU_N1_TO_1") {
+    return StringRef("RELU_N1_TO_1");
+  }
+  return std::nullopt;
+}
+
+bool IsStaticF32(Type type) {
+  auto tensor_type = dyn_cast<RankedTensorType>(type);
+  return tensor_type && tensor_type.hasStaticShape() &&
+         tensor_type.getElementType().isF32();
+}
+
+// Returns the value of `value` if it is a splat float constant, inlined in
+// the program instead of being an input of the op.
+std::optional<float> GetScalarConstant(Value value) {
+  DenseFPElementsAttr attr;
+  if (!matchPattern(value, m_Constant(&attr)) || !attr.isSplat()) {
+    return std::nullopt;
+  }
+  return attr.getSplatValue<APFloat>().convertToFloat();
+}
+
+class FuseElementwiseChainsPass
+    : public impl::FuseElementwiseChainsPassBase<FuseElementwiseChainsPass> {
+ public:
+  MLIR_DEFINE_EXPLICIT_INTERNAL_INLINE_TYPE_ID(FuseElementwiseChainsPass)
+
+  void runOnOperation() override;
+
+ private:
+  // Returns whether `op` can be computed by a FusedElementwise op whose
+  // output has the type `type`.
+  bool IsFusible(Operation* op, RankedTensorType type) const;
+
+  // Returns the ops of the chain ending at `root`, in program order.
+  SmallVector<Operation*> GrowChain(Operation* root) const;
+
+  // Replaces the ops of `chain` by a FusedElementwise op, if the chain is
+  // long enough.
+  void FuseChain(ArrayRef<Operation*> chain) const;
+};
+
+bool FuseElementwiseChainsPass::IsFusible(Operation* op,
+                                          RankedTensorType type) const {
+  if (op->getNumResults() != 1 || op->getResult(0).getType() != type ||
+      !GetOpCode(op) || !GetActivationOpCode(op)) {
+    return false;
+  }
+  // The operands are broadcast by the kernel only if they have one element.
+  for (Value operand : op->getOperands()) {
+    if (!IsStaticF32(operand.getType())) return false;
+    auto operand_type = cast<RankedTensorType>(operand.getType());
+    if (operand_type != type && (operand_type.getNumElements() != 1 ||
+                                 operand_type.getRank() > type.getRank())) {
+      return false;
+    }
+  }
+  return true;
+}
+
+SmallVector<Operation*> FuseElementwiseChainsPass::GrowChain(
+    Operation* root) const {
+  auto type = cast<RankedTensorType>(root->getResult(0).getType());
+  llvm::SetVector<Operation*> chain;
+  chain.insert(root);
+  // An op is added to the chain when all its users are in the chain, so that
+  // the intermediate results don't need to be materialized. Adding an op may
+  // make another one eligible, so this iterates to a fixpoint.
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for (int i = 0; i < chain.size(); ++i) {
+      for (Value operand : chain[i]->getOperands()) {
+        Operation* def = operand.getDefiningOp();
+        if (def == nullptr || chain.contains(def) ||
+            def->getBlock() != root->getBlock() || !IsFusible(def, type)) {
+          continue;
+        }
+        if (llvm::all_of(def->getUsers(), [&](Operation* user) {
+              return chain.contains(user);
+            })) {
+          chain.insert(def);
+          changed = true;
+        }
+      }
+    }
+  }
+  SmallVector<Operation*> ops(chain.begin(), chain.end());
+  llvm::sort(ops, [](Operation* a, Operation* b) {
+    return a->isBeforeInBlock(b);
+  });
+  return ops;
+}
+
+void FuseElementwiseChainsPass::FuseChain(ArrayRef<Operation*> chain) const {
+  Operation* root = chain.back();
+  auto type = cast<RankedTensorType>(root->getResult(0).getType());
+  llvm::DenseSet<Operation*> in_chain(chain.begin(), chain.end());
+
+  // The values of the program are the inputs, then the constants, then the
+  // results of the instructions.
+  llvm::SetVector<Value> inputs;
+  llvm::SetVector<Value> constant_values;
+  std::vector<float> constants;
+  int num_instructions = 0;
+  for (Operation* op : chain) {
+    for (Value operand : op->getOperands()) {
+      Operation* def = operand.getDefiningOp();
+      if (def != nullptr && in_chain.count(def)) continue;
+      if (std::optional<float> constant = GetScalarConstant(operand)) {
+        if (constant_values.insert(operand)) constants.push_back(*constant);
+      } else {
+        inputs.insert(operand);
+      }
+    }
+    num_instructions += GetActivationOpCode(op)->empty() ? 1 : 2;
+  }
+  if (num_instructions < min_num_ops_) return;
+  // The output of the kernel has the shape of its inputs that aren't
+  // broadcast.
+  if (llvm::none_of(inputs, [&](Value input) {
+        return input.getType() == type;
+      })) {
+    return;
+  }
+
+  llvm::DenseMap<Value, int> value_index;
+  int next_value = 0;
+  for (Value input : inputs) value_index[input] = next_value++;
+  for (Value constant : constant_values) value_index[constant] = next_value++;
+
+  std::vector<std::string> ops;
+  std::vector<int> lhs;
+  std::vector<int> rhs;
+  for (Operation* op : chain) {
+    ops.push_back(GetOpCode(op)->str());
+    lhs.push_back(value_index.lookup(op->getOperand(0)));
+    rhs.push_back(op->getNumOperands() > 1
+                      ? value_index.lookup(op->getOperand(1))
+                      : -1);
+    int result = next_value++;
+    if (StringRef activation = *GetActivationOpCode(op); !activation.empty()) {
+      ops.push_back(activation.str());
+      lhs.push_back(result);
+      rhs.push_back(-1);
+      result = next_value++;
+    }
+    value_index[op->getResult(0)] = result;
+  }
+  flexbuffers::Builder fbb;
+  fbb.Map([&]() {
+    fbb.Vector("constants", [&]() {
+      for (float constant : constants) fbb.Float(constant);
+    });
+    fbb.Vector("ops", [&]() {
+      for (const std::string& op : ops) fbb.String(op);
+    });
+    fbb.Vector("lhs", [&]() {
+      for (int operand : lhs) fbb.Int(operand);
+    });
+    fbb.Vector("rhs", [&]() {
+      for (int operand : rhs) fbb.Int(operand);
+    });
+  });
+  fbb.Finish();
+  const std::vector<uint8_t>& options = fbb.GetBuffer();
+
+  OpBuilder builder(root);
+  SmallVector<Location> locations;
+  for (Operation* op : chain) locations.push_back(op->getLoc());
+  auto custom_option = ConstBytesAttr::get(
+      builder.getContext(),
+      StringRef(reinterpret_cast<const char*>(options.data()),
+                options.size()));
+  auto fused = builder.create<CustomOp>(
+      builder.getFusedLoc(locations), TypeRange{type},
+      inputs.getArrayRef(), kFusedElementwise, custom_option);
+  root->getResult(0).replaceAllUsesWith(fused.getResult(0));
+  for (Operation* op : llvm::reverse(chain)) op->erase();
+}
+
+void FuseElementwiseChainsPass::runOnOperation() {
+  func::FuncOp func = getOperation();
+  // The chains grow backward from their last op, so the ops are visited in
+  // reverse program order.
+  SmallVector<Operation*> candidates;
+  func.walk([&](Operation* op) {
+    if (op->getNumResults() == 1 && IsStaticF32(op->getResult(0).getType()) &&
+        IsFusible(op, cast<RankedTensorType>(op->getResult(0).getType()))) {
+      candidates.push_back(op);
+    }
+  });
+  llvm::DenseSet<Operation*> fused;
+  for (Operation* root : llvm::reverse(candidates)) {
+    if (fused.count(root)) continue;
+    SmallVector<Operation*> chain = GrowChain(root);
+    fused.insert(chain.begin(), chain.end());
+    FuseChain(chain);
+  }
+}
+
+}  // namespace
+
+std::unique_ptr<OperationPass<func::FuncOp>>
+CreateFuseElementwiseChainsPass() {
+  return std::make_unique<FuseElementwiseChainsPass>();
+}
+
+}  // namespace TFL
+}  // namespace mlir
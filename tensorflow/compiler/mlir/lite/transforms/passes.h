@@ -241,6 +241,11 @@ std::unique_ptr<OperationPass<ModuleOp>> CreateReduceTypePrecisionPass();
 // so redudant ones may be grouped and removed.
 std::unique_ptr<OperationPass<ModuleOp>> CreatePushTransposeThroughEwisePass();
 
+// Creates a pass that fuses chains of elementwise float ops into
+// FusedElementwise custom ops, computed in a single pass over their inputs.
+std::unique_ptr<OperationPass<func::FuncOp>>
+CreateFuseElementwiseChainsPass();
+
 // Creates a pass that brings operations into the same order as graph_info.cc.
 std::unique_ptr<OperationPass<func::FuncOp>>
 CreatePartitionedTopologicalSortPass();
@@ -0,0 +1,55 @@
+// RUN: tf-opt %s -tf-fuse-elementwise-chains | FileCheck %s
+
+// CHECK-LABEL: fuseChain
+func.func @fuseChain(%arg0: tensor<4x8xf32>, %arg1: tensor<4x8xf32>) -> tensor<4x8xf32> {
+  // CHECK: %[[FUSED:.*]] = "tf._FusedElementwise"(%arg0, %arg1)
+  // CHECK-SAME: constants = [5.000000e-01 : f32]
+  // CHECK-SAME: lhs = [0, 3, 4, 0, 5]
+  // CHECK-SAME: op_names = ["Mul", "AddV2", "Tanh", "Relu", "Sub"]
+  // CHECK-SAME: rhs = [2, 1, -1, -1, 6]
+  // CHECK-NOT: "tf.Tanh"
+  // CHECK: return %[[FUSED]]
+  %cst = "tf.Const"() {value = dense<5.000000e-01> : tensor<f32>} : () -> tensor<f32>
+  %0 = "tf.Mul"(%arg0, %cst) : (tensor<4x8xf32>, tensor<f32>) -> tensor<4x8xf32>
+  %1 = "tf.AddV2"(%0, %arg1) : (tensor<4x8xf32>, tensor<4x8xf32>) -> tensor<4x8xf32>
+  %2 = "tf.Tanh"(%1) : (tensor<4x8xf32>) -> tensor<4x8xf32>
+  %3 = "tf.Relu"(%arg0) : (tensor<4x8xf32>) -> tensor<4x8xf32>
+  %4 = "tf.Sub"(%2, %3) : (tensor<4x8xf32>, tensor<4x8xf32>) -> tensor<4x8xf32>
+  func.return %4 : tensor<4x8xf32>
+}
+
+// The intermediate result used outside of the chain is materialized.
+// CHECK-LABEL: splitChainAtExternalUse
+func.func @splitChainAtExternalUse(%arg0: tensor<16xf32>, %arg1: tensor<16xf32>) -> (tensor<16xf32>, tensor<16xf32>) {
+  // CHECK: %[[ADD:.*]] = "tf.AddV2"(%arg0, %arg1)
+  // CHECK: %[[FUSED:.*]] = "tf._FusedElementwise"(%[[ADD]])
+  // CHECK-SAME: op_names = ["Exp", "Sigmoid"]
+  // CHECK: return %[[FUSED]], %[[ADD]]
+  %0 = "tf.AddV2"(%arg0, %arg1) : (tensor<16xf32>, tensor<16xf32>) -> tensor<16xf32>
+  %1 = "tf.Exp"(%0) : (tensor<16xf32>) -> tensor<16xf32>
+  %2 = "tf.Sigmoid"(%1) : (tensor<16xf32>) -> tensor<16xf32>
+  func.return %2, %0 : tensor<16xf32>, tensor<16xf32>
+}
+
+// CHECK-LABEL: skipDynamicShapes
+func.func @skipDynamicShapes(%arg0: tensor<?xf32>) -> tensor<?xf32> {
+  // CHECK-NOT: tf._FusedElementwise
+  %0 = "tf.Exp"(%arg0) : (tensor<?xf32>) -> tensor<?xf32>
+  %1 = "tf.Tanh"(%0) : (tensor<?xf32>) -> tensor<?xf32>
+  func.return %1 : tensor<?xf32>
+}
+
+// CHECK-LABEL: skipGpuOps
+func.func @skipGpuOps(%arg0: tensor<16xf32>) -> tensor<16xf32> {
+  // CHECK-NOT: tf._FusedElementwise
+  %0 = "tf.Exp"(%arg0) {device = "/job:localhost/replica:0/task:0/device:GPU:0"} : (tensor<16xf32>) -> tensor<16xf32>
+  %1 = "tf.Tanh"(%0) {device = "/job:localhost/replica:0/task:0/device:GPU:0"} : (tensor<16xf32>) -> tensor<16xf32>
+  func.return %1 : tensor<16xf32>
+}
+
+// CHECK-LABEL: skipSingleOps
+func.func @skipSingleOps(%arg0: tensor<16xf32>) -> tensor<16xf32> {
+  // CHECK-NOT: tf._FusedElementwise
+  %0 = "tf.Exp"(%arg0) : (tensor<16xf32>) -> tensor<16xf32>
+  func.return %0 : tensor<16xf32>
+}
@@ -0,0 +1,256 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// This transformation pass fuses chains of elementwise float ops into
+// _FusedElementwise ops. The CPU kernel of the op computes the whole chain
+// tile by tile in a single pass over its inputs, instead of writing and
+// reading back an intermediate tensor for every op of the chain.
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/DenseSet.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SetVector.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringRef.h"
+#include "mlir/Dialect/Func/IR/FuncOps.h"  // from @llvm-project
+#include "mlir/IR/Attributes.h"  // from @llvm-project
+#include "mlir/IR/Builders.h"  // from @llvm-project
+#include "mlir/IR/BuiltinAttributes.h"  // from @llvm-project
+#include "mlir/IR/BuiltinTypes.h"  // from @llvm-project
+#include "mlir/IR/Location.h"  // from @llvm-project
+#include "mlir/IR/Matchers.h"  // from @llvm-project
+#include "mlir/IR/Operation.h"  // from @llvm-project
+#include "mlir/IR/Value.h"  // from @llvm-project
+#include "mlir/Pass/Pass.h"  // from @llvm-project
+#include "mlir/Support/LLVM.h"  // from @llvm-project
+#include "tensorflow/compiler/mlir/tensorflow/ir/tf_ops.h"
+#include "tensorflow/compiler/mlir/tensorflow/transforms/passes.h"
+#include "tensorflow/core/util/device_name_utils.h"
+
+namespace mlir {
+namespace TF {
+namespace {
+
+#define GEN_PASS_DEF_FUSEELEMENTWISECHAINSPASS
+#include "tensorflow/compiler/mlir/tensorflow/transforms/tf_passes.h.inc"
+
+constexpr char kDeviceAttr[] = "device";
+
+// Returns whether `op` is an elementwise op the kernel of _FusedElementwise
+// supports.
+bool IsSupportedOp(Operation* op) {
+  return isa<AddOp, AddV2Op, SubOp, MulOp, RealDivOp, MaximumOp, MinimumOp,
+             SquaredDifferenceOp, AbsOp, ExpOp, SigmoidOp, NegOp, ReluOp,
+             Relu6Op, RsqrtOp, SqrtOp, SquareOp, TanhOp>(op);
+}
+
+// Returns whether `op` is placed on the CPU or isn't placed yet, as
+// _FusedElementwise only has a CPU kernel.
+bool IsOnCpu(Operation* op) {
+  auto device = op->getAttrOfType<StringAttr>(kDeviceAttr);
+  if (!device || device.getValue().empty()) return true;
+  tensorflow::DeviceNameUtils::ParsedName parsed_name;
+  return tensorflow::DeviceNameUtils::ParseFullName(device.str(),
+                                                    &parsed_name) &&
+         (!parsed_name.has_type || parsed_name.type == "CPU");
+}
+
+bool IsStaticF32(Type type) {
+  auto tensor_type = dyn_cast<RankedTensorType>(type);
+  return tensor_type && tensor_type.hasStaticShape() &&
+         tensor_type.getElementType().isF32();
+}
+
+// Returns the value of `value` if it is a splat float constant, inlined in
+// the program instead of being an argument of the op.
+std::optional<float> GetScalarConstant(Value value) {
+  DenseFPElementsAttr attr;
+  if (!matchPattern(value, m_Constant(&attr)) || !attr.isSplat()) {
+    return std::nullopt;
+  }
+  return attr.getSplatValue<APFloat>().convertToFloat();
+}
+
+class FuseElementwiseChainsPass
+    : public impl::FuseElementwiseChainsPassBase<FuseElementwiseChainsPass> {
+ public:
+  void runOnOperation() override;
+
+ private:
+  // Returns whether `op` can be computed by a _FusedElementwise op whose
+  // output has the type `type`, on the device `device`.
+  bool IsFusible(Operation* op, RankedTensorType type,
+                 StringAttr device) const;
+
+  // Returns the ops of the chain ending at `root`, in program order.
+  SmallVector<Operation*> GrowChain(Operation* root) const;
+
+  // Replaces the ops of `chain` by a _FusedElementwise op, if the chain is
+  // long enough.
+  void FuseChain(ArrayRef<Operation*> chain) const;
+};
+
+bool FuseElementwiseChainsPass::IsFusible(Operation* op, RankedTensorType type,
+                                          StringAttr device) const {
+  if (op->getNumResults() != 1 || op->getResult(0).getType() != type ||
+      !IsSupportedOp(op) || !IsOnCpu(op) ||
+      op->getAttrOfType<StringAttr>(kDeviceAttr) != device) {
+    return false;
+  }
+  // The operands are broadcast by the kernel only if they have one element.
+  for (Value operand : op->getOperands()) {
+    if (!IsStaticF32(operand.getType())) return false;
+    auto operand_type = cast<RankedTensorType>(operand.getType());
+    if (operand_type != type && (operand_type.getNumElements() != 1 ||
+                                 operand_type.getRank() > type.getRank())) {
+      return false;
+    }
+  }
+  return true;
+}
+
+SmallVector<Operation*> FuseElementwiseChainsPass::GrowChain(
+    Operation* root) const {
+  auto type = cast<RankedTensorType>(root->getResult(0).getType());
+  auto device = root->getAttrOfType<StringAttr>(kDeviceAttr);
+  llvm::SetVector<Operation*> chain;
+  chain.insert(root);
+  // An op is added to the chain when all its users are in the chain, so that
+  // the intermediate results don't need to be materialized. Adding an op may
+  // make another one eligible, so this iterates to a fixpoint.
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for (int i = 0; i < chain.size(); ++i) {
+      for (Value operand : chain[i]->getOperands()) {
+        Operation* def = operand.getDefiningOp();
+        if (def == nullptr || chain.contains(def) ||
+            def->getBlock() != root->getBlock() ||
+            !IsFusible(def, type, device)) {
+          continue;
+        }
+        if (llvm::all_of(def->getUsers(), [&](Operation* user) {
+              return chain.contains(user);
+            })) {
+          chain.insert(def);
+          changed = true;
+        }
+      }
+    }
+  }
+  SmallVector<Operation*> ops(chain.begin(), chain.end());
+  llvm::sort(ops, [](Operation* a, Operation* b) {
+    return a->isBeforeInBlock(b);
+  });
+  return ops;
+}
+
+void FuseElementwiseChainsPass::FuseChain(ArrayRef<Operation*> chain) const {
+  if (chain.size() < min_num_ops_) return;
+  Operation* root = chain.back();
+  auto type = cast<RankedTensorType>(root->getResult(0).getType());
+  llvm::DenseSet<Operation*> in_chain(chain.begin(), chain.end());
+
+  // The values of the program are the arguments, then the constants, then
+  // the results of the instructions.
+  llvm::SetVector<Value> args;
+  llvm::SetVector<Value> constant_values;
+  SmallVector<float> constants;
+  for (Operation* op : chain) {
+    for (Value operand : op->getOperands()) {
+      Operation* def = operand.getDefiningOp();
+      if (def != nullptr && in_chain.count(def)) continue;
+      if (std::optional<float> constant = GetScalarConstant(operand)) {
+        if (constant_values.insert(operand)) constants.push_back(*constant);
+      } else {
+        args.insert(operand);
+      }
+    }
+  }
+  // The output of the kernel has the shape of its arguments that aren't
+  // broadcast.
+  if (llvm::none_of(args, [&](Value arg) { return arg.getType() == type; })) {
+    return;
+  }
+
+  llvm::DenseMap<Value, int64_t> value_index;
+  int64_t next_value = 0;
+  for (Value arg : args) value_index[arg] = next_value++;
+  for (Value constant : constant_values) value_index[constant] = next_value++;
+
+  OpBuilder builder(root);
+  SmallVector<Attribute> op_names;
+  SmallVector<int64_t> lhs;
+  SmallVector<int64_t> rhs;
+  SmallVector<Location> locations;
+  for (Operation* op : chain) {
+    op_names.push_back(builder.getStringAttr(op->getName().stripDialect()));
+    lhs.push_back(value_index.lookup(op->getOperand(0)));
+    rhs.push_back(op->getNumOperands() > 1
+                      ? value_index.lookup(op->getOperand(1))
+                      : -1);
+    value_index[op->getResult(0)] = next_value++;
+    locations.push_back(op->getLoc());
+  }
+
+  SmallVector<NamedAttribute> attrs = {
+      builder.getNamedAttr("constants", builder.getF32ArrayAttr(constants)),
+      builder.getNamedAttr("op_names", builder.getArrayAttr(op_names)),
+      builder.getNamedAttr("lhs", builder.getI64ArrayAttr(lhs)),
+      builder.getNamedAttr("rhs", builder.getI64ArrayAttr(rhs)),
+  };
+  if (auto device = root->getAttrOfType<StringAttr>(kDeviceAttr)) {
+    attrs.push_back(builder.getNamedAttr(kDeviceAttr, device));
+  }
+  auto fused = builder.create<_FusedElementwiseOp>(
+      builder.getFusedLoc(locations), type, args.getArrayRef(), attrs);
+  root->getResult(0).replaceAllUsesWith(fused.getResult());
+  for (Operation* op : llvm::reverse(chain)) op->erase();
+}
+
+void FuseElementwiseChainsPass::runOnOperation() {
+  func::FuncOp func = getOperation();
+  // The chains grow backward from their last op, so the ops are visited in
+  // reverse program order.
+  SmallVector<Operation*> candidates;
+  func.walk([&](Operation* op) {
+    if (op->getNumResults() == 1 && IsStaticF32(op->getResult(0).getType()) &&
+        IsFusible(op, cast<RankedTensorType>(op->getResult(0).getType()),
+                  op->getAttrOfType<StringAttr>(kDeviceAttr))) {
+      candidates.push_back(op);
+    }
+  });
+  llvm::DenseSet<Operation*> fused;
+  for (Operation* root : llvm::reverse(candidates)) {
+    if (fused.count(root)) continue;
+    SmallVector<Operation*> chain = GrowChain(root);
+    fused.insert(chain.begin(), chain.end());
+    FuseChain(chain);
+  }
+}
+
+}  // namespace
+
+std::unique_ptr<OperationPass<func::FuncOp>> CreateFuseElementwiseChainsPass() {
+  return std::make_unique<FuseElementwiseChainsPass>();
+}
+
+}  // namespace TF
+}  // namespace mlir
@@ -25,6 +25,10 @@ limitations under the License.
 #include "tensorflow/compiler/mlir/tensorflow/transforms/passes.h"
 #include "tensorflow/compiler/mlir/tensorflow/utils/dump_mlir_util.h"
 #include "tensorflow/compiler/mlir/tensorflow/utils/error_util.h"
+#include "tensorflow/core/common_runtime/device_set.h"
+#include "tensorflow/core/framework/device.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace mlir {
 namespace TF {
@@ -73,5 +77,56 @@ Status MlirGraphOptimizationPass::Run(
   return diag_handler.ConsumeStatus();
 }
 
+::tensorflow::MlirOptimizationPassState
+MlirCpuElementwiseFusionPass::GetPassState(
+    const ::tensorflow::DeviceSet* device_set, const ConfigProto& config_proto,
+    const Graph& graph,
+    const tensorflow::FunctionLibraryDefinition& function_library) const {
+  static const bool enabled = [] {
+    bool enabled = false;
+    auto status = ::tensorflow::ReadBoolFromEnvVar(
+        "TF_MLIR_ENABLE_CPU_ELEMENTWISE_FUSION", /*default_val=*/false,
+        &enabled);
+    if (!status.ok()) LOG(ERROR) << status;
+    return enabled;
+  }();
+  if (!enabled || device_set == nullptr) {
+    return ::tensorflow::MlirOptimizationPassState::Disabled;
+  }
+  // _FusedElementwise only has a CPU kernel, which the ops placed on other
+  // devices later would have to copy their tensors to.
+  for (const ::tensorflow::Device* device : device_set->devices()) {
+    if (device->device_type() != ::tensorflow::DEVICE_CPU) {
+      return ::tensorflow::MlirOptimizationPassState::Disabled;
+    }
+  }
+  // The graph is left unchanged if the pass fails.
+  return ::tensorflow::MlirOptimizationPassState::FallbackEnabled;
+}
+
+Status MlirCpuElementwiseFusionPass::Run(
+    const std::string& function_name, const ConfigProto& config_proto,
+    ModuleOp module, const Graph& graph,
+    const tensorflow::FunctionLibraryDefinition& function_library) {
+  VLOG(1) << "Run MLIR CPU Elementwise Fusion Pass";
+  PassManager pm(module.getContext());
+  ::tensorflow::applyTensorflowAndCLOptions(pm);
+
+  // The chains are fused within the islands, with the static shapes given by
+  // shape inference.
+  pm.addNestedPass<func::FuncOp>(
+      tf_executor::CreateTFExecutorIslandCoarseningPass());
+  pm.addPass(CreateTFShapeInferencePass());
+  pm.addNestedPass<func::FuncOp>(CreateFuseElementwiseChainsPass());
+
+  // Prepare IR for exporting.
+  pm.addPass(CreateBreakUpIslandsPass());
+
+  StatusScopedDiagnosticHandler diag_handler(module.getContext());
+  LogicalResult result = pm.run(module);
+  (void)result;
+  return diag_handler.ConsumeStatus();
+}
+
 }  // namespace TF
 }  // namespace mlir
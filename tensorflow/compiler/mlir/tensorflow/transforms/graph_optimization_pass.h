@@ -47,6 +47,28 @@ class MlirGraphOptimizationPass : public ::tensorflow::MlirOptimizationPass {
       const tensorflow::FunctionLibraryDefinition& function_library) override;
 };
 
+// Fuses the chains of elementwise ops of CPU-only graphs into
+// _FusedElementwise ops, computed by a single kernel of the TF runtime, for
+// the inference graphs that can't be compiled with XLA. The other ops stay
+// unchanged. Enabled with TF_MLIR_ENABLE_CPU_ELEMENTWISE_FUSION=true.
+class MlirCpuElementwiseFusionPass : public ::tensorflow::MlirOptimizationPass {
+ public:
+  llvm::StringRef name() const override { return "cpu_elementwise_fusion"; }
+
+  ::tensorflow::MlirOptimizationPassState GetPassState(
+      const ::tensorflow::DeviceSet* device_set,
+      const ::tensorflow::ConfigProto& config_proto,
+      const tensorflow::Graph& graph,
+      const tensorflow::FunctionLibraryDefinition& function_library)
+      const override;
+
+  ::tensorflow::Status Run(
+      const std::string& function_name,
+      const ::tensorflow::ConfigProto& config_proto, ModuleOp module,
+      const ::tensorflow::Graph& graph,
+      const tensorflow::FunctionLibraryDefinition& function_library) override;
+};
+
 }  // namespace TF
 }  // namespace mlir
 
@@ -20,6 +20,7 @@ limitations under the License.
 namespace tensorflow {
 namespace {
 constexpr int kMlirGraphOptimizationPriority = 0;
+constexpr int kMlirCpuElementwiseFusionPriority = 1;
 }
 
 static mlir_pass_registration::MlirOptimizationPassRegistration
@@ -27,4 +28,9 @@ static mlir_pass_registration::MlirOptimizationPassRegistration
         kMlirGraphOptimizationPriority,
         std::make_unique<mlir::TF::MlirGraphOptimizationPass>());
 
+static mlir_pass_registration::MlirOptimizationPassRegistration
+    register_mlir_cpu_elementwise_fusion_pass(
+        kMlirCpuElementwiseFusionPriority,
+        std::make_unique<mlir::TF::MlirCpuElementwiseFusionPass>());
+
 }  // namespace tensorflow
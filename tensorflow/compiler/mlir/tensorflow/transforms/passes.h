@@ -244,6 +244,10 @@ std::unique_ptr<Pass> CreateLegalizeTFGToTFEPass();
 // future these fusions may be codegen'd automatically.
 std::unique_ptr<OperationPass<func::FuncOp>> CreateFusedKernelMatcherPass();
 
+// Fuses chains of elementwise float ops into _FusedElementwise ops, computed
+// by a CPU kernel in a single pass over their inputs.
+std::unique_ptr<OperationPass<func::FuncOp>> CreateFuseElementwiseChainsPass();
+
 // Creates function pass to select device index/fold tf.DeviceIndex.
 std::unique_ptr<OperationPass<func::FuncOp>> CreateDeviceIndexSelectorPass();
 
@@ -622,6 +626,7 @@ enum MoveTransposeDirection { kBegin, kEnd };
 #define GEN_PASS_DECL_FUNCTIONALCONTROLFLOWTOCFGPASS
 #define GEN_PASS_DECL_FUNCTIONALCONTROLFLOWTOREGIONSPASS
 #define GEN_PASS_DECL_FUNCTIONALTOEXECUTORDIALECTCONVERSIONPASS
+#define GEN_PASS_DECL_FUSEELEMENTWISECHAINSPASS
 #define GEN_PASS_DECL_FUSEDKERNELMATCHERPASS
 #define GEN_PASS_DECL_GROUPBYDIALECTPASS
 #define GEN_PASS_DECL_GUARANTEEALLFUNCSONEUSEPASS
@@ -15,7 +15,12 @@ limitations under the License.
 
 #include "tensorflow/compiler/tf2tensorrt/common/utils.h"
 
+#include <string>
 #include <tuple>
+#include <utility>
+
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/util/env_var.h"
 
 #if GOOGLE_CUDA && GOOGLE_TENSORRT
 #include "absl/base/call_once.h"
@@ -52,6 +57,19 @@ std::tuple<int, int, int> GetLoadedTensorRTVersion() {
 #endif
 }
 
+std::string GetTrtPersistentCacheDir() {
+  static const std::string* dir = [] {
+    std::string value;
+    Status status = ReadStringFromEnvVar("TF_TRT_PERSISTENT_CACHE_DIR",
+                                         /*default_val=*/"", &value);
+    if (!status.ok()) {
+      LOG(ERROR) << status;
+    }
+    return new std::string(std::move(value));
+  }();
+  return *dir;
+}
+
 }  // namespace tensorrt
 }  // namespace tensorflow
 
@@ -17,6 +17,7 @@ limitations under the License.
 #define TENSORFLOW_COMPILER_TF2TENSORRT_COMMON_UTILS_H_
 
 #include <numeric>
+#include <string>
 #include <tuple>
 
 #include "absl/strings/str_join.h"
@@ -31,6 +32,11 @@ std::tuple<int, int, int> GetLinkedTensorRTVersion();
 // Returns the runtime time TensorRT library version information
 // {Maj, Min, Patch}.
 std::tuple<int, int, int> GetLoadedTensorRTVersion();
+
+// Returns the directory where the engines and the timing cache built at
+// runtime are persisted, set by the TF_TRT_PERSISTENT_CACHE_DIR environment
+// variable, or an empty string if they aren't persisted.
+std::string GetTrtPersistentCacheDir();
 }  // namespace tensorrt
 }  // namespace tensorflow
 
@@ -1372,6 +1372,16 @@ Status Converter::BuildCudaEngine(
 #if IS_TRT_VERSION_GE(8, 0, 0, 0)
     TimingCacheRegistry* registry = GetTimingCacheRegistry();
 
+    // Starts from the timing cache of the previous processes, if persisted.
+    const string timing_cache_path = GetTimingCacheFilePath();
+    if (!timing_cache_path.empty()) {
+      Status status =
+          registry->ReadFromFile("default_cache", timing_cache_path);
+      if (!status.ok()) {
+        LOG(WARNING) << "failed to read the timing cache "
+                     << timing_cache_path << ": " << status.message();
+      }
+    }
     auto cache = registry->LookUp("default_cache", builder_config.get());
     if (!cache.ok()) {
       LOG(WARNING) << "failed to create a timing cache: "
@@ -1453,6 +1463,15 @@ Status Converter::BuildCudaEngine(
   // Write back the new timing cache results to the registry.
   if (timing_cache) {
     GetTimingCacheRegistry()->Upsert("default_cache", timing_cache.get());
+    const string timing_cache_path = GetTimingCacheFilePath();
+    if (!timing_cache_path.empty()) {
+      Status status = GetTimingCacheRegistry()->WriteToFile(
+          "default_cache", timing_cache_path);
+      if (!status.ok()) {
+        LOG(WARNING) << "failed to write the timing cache "
+                     << timing_cache_path << ": " << status.message();
+      }
+    }
   }
 
   return OkStatus();
@@ -16,10 +16,15 @@ limitations under the License.
 
 #include "tensorflow/compiler/tf2tensorrt/convert/timing_cache.h"
 
+#include <string>
 #include <unordered_map>
 
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
 #include "tensorflow/compiler/tf2tensorrt/common/utils.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/path.h"
 #include "third_party/tensorrt/NvInfer.h"
 
 namespace tensorflow {
@@ -74,11 +79,53 @@ void TimingCacheRegistry::Upsert(const string& name, TimingCache* cache) {
 #endif  // IS_TRT_VERSION_GE(8, 0, 0, 0)
 }
 
+Status TimingCacheRegistry::ReadFromFile(const string& name,
+                                         const string& path) {
+  Env* env = Env::Default();
+  {
+    mutex_lock scoped_lock(mu_);
+    if (map_.find(name) != map_.end()) return OkStatus();
+  }
+  if (!env->FileExists(path).ok()) return OkStatus();
+  string data;
+  TF_RETURN_IF_ERROR(ReadFileToString(env, path, &data));
+  mutex_lock scoped_lock(mu_);
+  map_.emplace(name, SerializedTimingCache(data.begin(), data.end()));
+  return OkStatus();
+}
+
+Status TimingCacheRegistry::WriteToFile(const string& name,
+                                        const string& path) {
+  string data;
+  {
+    mutex_lock scoped_lock(mu_);
+    auto it = map_.find(name);
+    if (it == map_.end()) return OkStatus();
+    data.assign(it->second.begin(), it->second.end());
+  }
+  // Writes a temporary file first, replacing the file atomically for the
+  // other processes reading it.
+  Env* env = Env::Default();
+  string tmp_path = path;
+  if (!env->CreateUniqueFileName(&tmp_path, ".tmp")) {
+    return errors::Internal("Failed to create a temporary file for ", path);
+  }
+  TF_RETURN_IF_ERROR(WriteStringToFile(env, tmp_path, data));
+  return env->RenameFile(tmp_path, path);
+}
+
 TimingCacheRegistry* GetTimingCacheRegistry() {
   static TimingCacheRegistry* registry = new TimingCacheRegistry();
   return registry;
 }
 
+string GetTimingCacheFilePath() {
+  const string dir = GetTrtPersistentCacheDir();
+  if (dir.empty()) return "";
+  const string version = absl::StrJoin(GetLoadedTensorRTVersion(), ".");
+  return io::JoinPath(dir, absl::StrCat("timing_cache_trt", version, ".bin"));
+}
+
 }  // namespace convert
 }  // namespace tensorrt
 }  // namespace tensorflow
@@ -53,6 +53,14 @@ class TimingCacheRegistry {
   StatusOr<TimingCachePtr> LookUp(const string& name,
                                   nvinfer1::IBuilderConfig* builder_config);
 
+  // Reads the serialized timing cache `name` from the file `path`, unless the
+  // registry already has it or the file doesn't exist. Used to share the
+  // timing cache across processes.
+  Status ReadFromFile(const string& name, const string& path);
+
+  // Writes the serialized timing cache `name`, if any, to the file `path`.
+  Status WriteToFile(const string& name, const string& path);
+
  private:
   using SerializedTimingCache = std::vector<uint8_t>;
 
@@ -62,6 +70,10 @@ class TimingCacheRegistry {
 
 TimingCacheRegistry* GetTimingCacheRegistry();
 
+// Returns the file persisting the timing cache of the loaded TensorRT version
+// in `GetTrtPersistentCacheDir()`, or an empty string if it isn't persisted.
+string GetTimingCacheFilePath();
+
 }  // namespace convert
 }  // namespace tensorrt
 }  // namespace tensorflow
@@ -13,7 +13,10 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 #include <algorithm>
+#include <cstdint>
 #include <memory>
+#include <string>
+#include <utility>
 #include <vector>
 
 #include "absl/memory/memory.h"
@@ -42,10 +45,12 @@ limitations under the License.
 #include "tensorflow/core/lib/core/refcount.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/stream_executor.h"
 #include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/threadpool.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/profiler/lib/traceme.h"
 #include "tensorflow/core/util/env_var.h"
@@ -132,6 +137,62 @@ class AsyncHelper : public core::RefCounted {
   AsyncOpKernel::DoneCallback done_;
 };
 
+// Whether the engines for new input shapes are built in the background, while
+// the native segment runs, instead of blocking the TRTEngineOp.
+bool BuildEnginesInBackground() {
+  static const bool value = [] {
+    bool value;
+    Status status = ReadBoolFromEnvVar("TF_TRT_BUILD_ENGINES_IN_BACKGROUND",
+                                       /*default_val=*/false, &value);
+    if (!status.ok()) {
+      LOG(ERROR) << status;
+    }
+    return value;
+  }();
+  return value;
+}
+
+// Returns the maximum number of optimization profiles learned from the input
+// shapes of the inference calls in dynamic shape mode, or 0 if the profiles
+// of the build phase are kept. The engine for the learned profiles is built in
+// the background and replaces the running one.
+int64_t GetMaxLearnedProfiles() {
+  static const int64_t value = [] {
+    int64_t value;
+    Status status = ReadInt64FromEnvVar("TF_TRT_MAX_LEARNED_PROFILES",
+                                        /*default_val=*/0, &value);
+    if (!status.ok()) {
+      LOG(ERROR) << status;
+    }
+    return value;
+  }();
+  return value;
+}
+
+// Returns the number of inference calls between two updates of the learned
+// optimization profiles.
+int64_t GetProfileLearningPeriod() {
+  static const int64_t value = [] {
+    int64_t value;
+    Status status = ReadInt64FromEnvVar("TF_TRT_PROFILE_LEARNING_PERIOD",
+                                        /*default_val=*/1000, &value);
+    if (!status.ok()) {
+      LOG(ERROR) << status;
+    }
+    return value;
+  }();
+  return value;
+}
+
+// Returns the thread pool building the engines in the background. A single
+// thread, as building an engine already uses the whole GPU.
+thread::ThreadPool* GetEngineBuildThreadPool() {
+  static thread::ThreadPool* thread_pool =
+      new thread::ThreadPool(Env::Default(), "tf_trt_engine_build",
+                             /*num_threads=*/1);
+  return thread_pool;
+}
+
 }  // end anonymous namespace
 
 //  This OP can construct TRTEngine on the fly and if construction of engine
@@ -140,6 +201,8 @@ class TRTEngineOp : public AsyncOpKernel {
  public:
   explicit TRTEngineOp(OpKernelConstruction* context);
 
+  ~TRTEngineOp() override;
+
   void ComputeAsync(OpKernelContext* context,
                     AsyncOpKernel::DoneCallback done) override;
 
@@ -188,13 +251,34 @@ class TRTEngineOp : public AsyncOpKernel {
       const std::vector<TensorShape>& input_concrete_shapes,
       OpKernelContext* ctx, TRTEngineCacheResource* cache_resource);
 
-  // Builds and returns a cuda engine for the input shapes. If building the
-  // engine fails, enters a dummy entry into the cache_resource cache so we
-  // don't continually try to build the same failing engine.
+  // Builds and returns a cuda engine for the input shapes and the
+  // optimization `profiles` on the device `device_name`, or reads it from the
+  // persistent cache if it was built by a previous process, see
+  // TF_TRT_PERSISTENT_CACHE_DIR. `ctx` may be null if the segment has no
+  // resource inputs.
   StatusOr<TrtUniquePtrType<nvinfer1::ICudaEngine>> BuildEngine(
       const std::vector<TensorShape>& input_concrete_shapes, int batch_size,
       bool use_calibration, TRTInt8Calibrator* calibrator,
-      TRTEngineCacheResource* cache_resource, OpKernelContext* ctx);
+      TRTEngineCacheResource* cache_resource,
+      TrtShapeOptimizationProfile* profiles, OpKernelContext* ctx,
+      const string& device_name);
+
+  // Schedules building the engine for the input shapes in the background,
+  // unless it is already being built. The engine is added to the cache once
+  // built.
+  void BuildEngineInBackground(
+      const std::vector<TensorShape>& input_concrete_shapes, int batch_size,
+      const string& device_name, TRTEngineCacheResource* cache_resource)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(engine_mutex_);
+
+  // Records the input shapes to learn the optimization profiles, see
+  // TF_TRT_MAX_LEARNED_PROFILES. When the learned profiles change, schedules
+  // building the engine for them in the background, which then replaces the
+  // engine in the cache.
+  void LearnProfilesInBackground(
+      const std::vector<TensorShape>& input_concrete_shapes, int batch_size,
+      const string& device_name, TRTEngineCacheResource* cache_resource)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(engine_mutex_);
 
   // Verify that the input shapes are consistent and can be handled by this op.
   Status VerifyInputShapes(const std::vector<TensorShape>& shapes);
@@ -251,6 +335,11 @@ class TRTEngineOp : public AsyncOpKernel {
   mutex engine_mutex_;
   FunctionLibraryRuntime::Handle native_execution_func_handle_;
 
+  // The number of engines being built in the background, which read the
+  // members of the op.
+  int num_background_builds_ TF_GUARDED_BY(engine_mutex_) = 0;
+  condition_variable background_builds_cv_;
+
   // The finalized calibrator for inference.
   std::unique_ptr<TRTInt8Calibrator> calibrator_;
 
@@ -800,6 +889,13 @@ Status TRTEngineOp::VerifyInputShapes(
   return OkStatus();
 }
 
+TRTEngineOp::~TRTEngineOp() {
+  mutex_lock lock(engine_mutex_);
+  while (num_background_builds_ > 0) {
+    background_builds_cv_.wait(lock);
+  }
+}
+
 static bool AllowEngineNativeSegmentExecution() {
   bool value;
   Status status =
@@ -1087,15 +1183,17 @@ Status TRTEngineOp::GetEngineCacheResource(OpKernelContext* ctx,
 StatusOr<TrtUniquePtrType<nvinfer1::ICudaEngine>> TRTEngineOp::BuildEngine(
     const std::vector<TensorShape>& input_concrete_shapes, int batch_size,
     bool use_calibration, TRTInt8Calibrator* calibrator,
-    TRTEngineCacheResource* cache_resource, OpKernelContext* ctx) {
+    TRTEngineCacheResource* cache_resource,
+    TrtShapeOptimizationProfile* profiles, OpKernelContext* ctx,
+    const string& device_name) {
   tensorflow::profiler::TraceMe activity(
       "TRTEngineOp::BuildEngine", tensorflow::profiler::TraceMeLevel::kInfo);
   TRT_ENSURE(cache_resource);
-  TRT_ENSURE(ctx);
+  TRT_ENSURE(profiles);
   // Use concrete shapes for implicit batch mode and partial shapes for
   // explicit batch mode.
   bool use_concrete_shapes =
-      use_implicit_batch_ || cache_resource->profiles_.IsStaticCompatible();
+      use_implicit_batch_ || profiles->IsStaticCompatible();
   const std::vector<PartialTensorShape>& conversion_input_shapes =
       use_concrete_shapes
           ? std::vector<PartialTensorShape>(input_concrete_shapes.begin(),
@@ -1105,11 +1203,42 @@ StatusOr<TrtUniquePtrType<nvinfer1::ICudaEngine>> TRTEngineOp::BuildEngine(
   VLOG(1) << "Building a new TensorRT engine for " << name()
           << " with input shapes: " << DebugString(conversion_input_shapes);
 
-  std::unordered_map<string, tensorflow::DeviceProperties> device_map;
   DeviceNameUtils::ParsedName full_parsed_name;
-  DeviceNameUtils::ParseFullName(ctx->device()->name(), &full_parsed_name);
-  device_map.emplace(ctx->device()->name(),
-                     grappler::GetDeviceInfo(full_parsed_name));
+  DeviceNameUtils::ParseFullName(device_name, &full_parsed_name);
+  const DeviceProperties device = grappler::GetDeviceInfo(full_parsed_name);
+
+  // The engines calibrated at runtime depend on the calibration data, they
+  // aren't persisted.
+  const string engine_path =
+      use_calibration && calibrator != nullptr
+          ? ""
+          : GetEngineFilePath(
+                segment_graph_def_,
+                StrCat(static_cast<int>(precision_mode_), ",", batch_size, ",",
+                       workspace_size_, ",", use_calibration, ",",
+                       use_implicit_batch_, ",", use_explicit_precision_, ",",
+                       use_concrete_shapes ? "" : profiles->DebugString()),
+                conversion_input_shapes, device);
+  if (!engine_path.empty()) {
+    StatusOr<TrtUniquePtrType<nvinfer1::ICudaEngine>> engine =
+        ReadEngineFromFile(engine_path, cache_resource->allocator_.get(),
+                           &logger);
+    if (!engine.ok()) {
+      LOG_FIRST_FEW_WARNING_WITH_PREFIX << "Reading the engine " << engine_path
+                                        << " failed: " << engine.status();
+    } else if (*engine != nullptr) {
+      VLOG(1) << "Read the engine of " << name() << " from " << engine_path;
+      if (!use_implicit_batch_) {
+        profiles->clear();
+        TF_RETURN_IF_ERROR(profiles->RestoreProfiles(
+            engine->get(), input_concrete_shapes.size()));
+      }
+      return std::move(*engine);
+    }
+  }
+
+  std::unordered_map<string, tensorflow::DeviceProperties> device_map;
+  device_map.emplace(device_name, device);
   tensorflow::grappler::VirtualCluster cluster(device_map);
 
   TrtUniquePtrType<nvinfer1::ICudaEngine> engine;
@@ -1117,22 +1246,141 @@ StatusOr<TrtUniquePtrType<nvinfer1::ICudaEngine>> TRTEngineOp::BuildEngine(
       segment_graph_def_, ctx, precision_mode_, batch_size, workspace_size_,
       conversion_input_shapes, &logger, cache_resource->allocator_.get(),
       calibrator, &engine, use_calibration, use_implicit_batch_, nullptr,
-      &cache_resource->profiles_, name(), use_explicit_precision_, &cluster,
-      ctx->device()->name());
+      profiles, name(), use_explicit_precision_, &cluster, device_name);
   if (!status.ok()) {
     LOG_FIRST_FEW_WARNING_WITH_PREFIX
         << "Engine creation for " << name() << " failed. "
         << "The native segment will be used instead. "
         << "Reason: " << status;
-    // Store an empty engine in the cache for these input shapes so we don't try
-    // to build the same failing engine again.
-    cache_resource->cache_.emplace(input_concrete_shapes,
-                                   std::make_unique<EngineContext>());
     return status;
   }
+  if (!engine_path.empty()) {
+    Status write_status = WriteEngineToFile(engine.get(), engine_path);
+    if (!write_status.ok()) {
+      LOG_FIRST_FEW_WARNING_WITH_PREFIX << "Writing the engine " << engine_path
+                                        << " failed: " << write_status;
+    }
+  }
   return engine;
 }
 
+void TRTEngineOp::BuildEngineInBackground(
+    const std::vector<TensorShape>& input_concrete_shapes, int batch_size,
+    const string& device_name, TRTEngineCacheResource* cache_resource) {
+  const string key = TensorShapeUtils::ShapeListString(input_concrete_shapes);
+  if (!cache_resource->pending_builds_.insert(key).second) {
+    return;
+  }
+  VLOG(1) << "Building a new TensorRT engine for " << name() << " with input "
+          << "shapes " << key << " in the background";
+  ++num_background_builds_;
+  cache_resource->Ref();
+  GetEngineBuildThreadPool()->Schedule([this, input_concrete_shapes,
+                                        batch_size, device_name,
+                                        cache_resource, key] {
+    core::ScopedUnref unref_cache_resource(cache_resource);
+    StatusOr<TrtUniquePtrType<nvinfer1::ICudaEngine>> result =
+        BuildEngine(input_concrete_shapes, batch_size,
+                    /*use_calibration=*/false, /*calibrator=*/nullptr,
+                    cache_resource, &cache_resource->profiles_,
+                    /*ctx=*/nullptr, device_name);
+    mutex_lock lock(engine_mutex_);
+    std::vector<ExecutionContext> exec_contexts;
+    Status status = result.status();
+    if (status.ok()) {
+      status = cache_resource->profiles_.CreateExecutionContexts(
+          result->get(), &exec_contexts);
+    }
+    if (status.ok()) {
+      cache_resource->cache_.emplace(
+          input_concrete_shapes,
+          std::make_unique<EngineContext>(std::move(*result),
+                                          std::move(exec_contexts)));
+      VLOG(1) << "Added new engine to cache of " << name()
+              << ". Cache size: " << cache_resource->cache_.size();
+    } else {
+      // Store an empty engine in the cache for these input shapes so we don't
+      // try to build the same failing engine again.
+      cache_resource->cache_.emplace(input_concrete_shapes,
+                                     std::make_unique<EngineContext>());
+    }
+    cache_resource->pending_builds_.erase(key);
+    if (--num_background_builds_ == 0) {
+      background_builds_cv_.notify_all();
+    }
+  });
+}
+
+void TRTEngineOp::LearnProfilesInBackground(
+    const std::vector<TensorShape>& input_concrete_shapes, int batch_size,
+    const string& device_name, TRTEngineCacheResource* cache_resource) {
+  const bool has_resource_inputs =
+      input_partial_shapes_.size() != input_partial_shapes_filtered_.size();
+  if (!allow_build_at_runtime_ || use_calibration_ || has_resource_inputs) {
+    return;
+  }
+  TrtShapeOptimizationProfile& profiles = cache_resource->profiles_;
+  profiles.RecordShape(input_concrete_shapes);
+  if (cache_resource->learning_profiles_ ||
+      profiles.GetNumRecordedShapes() < GetProfileLearningPeriod()) {
+    return;
+  }
+  std::vector<OptimizationProfileConfig> learned_profiles =
+      profiles.LearnProfiles(input_partial_shapes_, GetMaxLearnedProfiles());
+  if (learned_profiles.empty() || profiles.HasProfiles(learned_profiles)) {
+    return;
+  }
+  VLOG(1) << "Building a new TensorRT engine for " << name() << " with "
+          << learned_profiles.size() << " learned profiles in the background";
+  // The engine is built with a copy of the profiles, the running engine keeps
+  // using the current ones.
+  auto new_profiles = std::make_shared<TrtShapeOptimizationProfile>(profiles);
+  new_profiles->SetProfiles(std::move(learned_profiles));
+  cache_resource->learning_profiles_ = true;
+  ++num_background_builds_;
+  cache_resource->Ref();
+  GetEngineBuildThreadPool()->Schedule([this, input_concrete_shapes,
+                                        batch_size, device_name,
+                                        cache_resource, new_profiles] {
+    core::ScopedUnref unref_cache_resource(cache_resource);
+    StatusOr<TrtUniquePtrType<nvinfer1::ICudaEngine>> result = BuildEngine(
+        input_concrete_shapes, batch_size, /*use_calibration=*/false,
+        /*calibrator=*/nullptr, cache_resource, new_profiles.get(),
+        /*ctx=*/nullptr, device_name);
+    mutex_lock lock(engine_mutex_);
+    std::vector<ExecutionContext> exec_contexts;
+    Status status = result.status();
+    if (status.ok()) {
+      status =
+          new_profiles->CreateExecutionContexts(result->get(), &exec_contexts);
+    }
+    if (status.ok()) {
+      auto engine_context = std::make_unique<EngineContext>(
+          std::move(*result), std::move(exec_contexts));
+      auto& cache = cache_resource->cache_;
+      if (cache.size() == 0) {
+        cache.emplace(input_concrete_shapes, std::move(engine_context));
+      } else {
+        cache_resource->replaced_engines_.push_back(
+            std::move(cache.begin()->second));
+        cache.begin()->second = std::move(engine_context);
+      }
+      cache_resource->profiles_.CopyProfiles(*new_profiles);
+      VLOG(1) << "Replaced the engine of " << name()
+              << " by the engine built for the learned profiles "
+              << new_profiles->DebugString();
+    } else {
+      LOG_FIRST_FEW_WARNING_WITH_PREFIX
+          << "Building the engine for the learned profiles of " << name()
+          << " failed, keeping the current engine. Reason: " << status;
+    }
+    cache_resource->learning_profiles_ = false;
+    if (--num_background_builds_ == 0) {
+      background_builds_cv_.notify_all();
+    }
+  });
+}
+
 StatusOr<std::pair<EngineContext*, int>> TRTEngineOp::GetEngine(
     const std::vector<TensorShape>& input_concrete_shapes, OpKernelContext* ctx,
     TRTEngineCacheResource* cache_res) {
@@ -1218,10 +1466,14 @@ StatusOr<std::pair<EngineContext*, int>> TRTEngineOp::GetEngine(
                                             << "Reason: " << status;
         }
       }
-      auto result = BuildEngine(input_concrete_shapes, batch_size,
-                                /*use_calibration=*/false,
-                                /*calibrator=*/nullptr, cache_res, ctx);
+      auto result = BuildEngine(
+          input_concrete_shapes, batch_size, /*use_calibration=*/false,
+          /*calibrator=*/nullptr, cache_res, &cache_res->profiles_, ctx,
+          ctx->device()->name());
       if (!result.ok()) {
+        // Store an empty engine in the cache so we don't try to build the
+        // same failing engine again.
+        cache.emplace(input_concrete_shapes, std::make_unique<EngineContext>());
         return std::pair<EngineContext*, int>(&empty_context, 0);
       }
       static_engine = std::move(result.value());
@@ -1261,6 +1513,10 @@ StatusOr<std::pair<EngineContext*, int>> TRTEngineOp::GetEngine(
 
   int profile_id = -1;
   if (!use_implicit_batch_) {
+    if (has_dynamic_shape_input_ && GetMaxLearnedProfiles() > 0) {
+      LearnProfilesInBackground(input_concrete_shapes, batch_size,
+                                ctx->device()->name(), cache_res);
+    }
     profile_id = cache_res->profiles_.GetProfileNumber(input_concrete_shapes);
     // Since all profiles are already created at this point, finding no
     // compatible profiles results in falling back to native TF.
@@ -1290,12 +1546,29 @@ StatusOr<std::pair<EngineContext*, int>> TRTEngineOp::GetEngine(
       return std::pair<EngineContext*, int>(&empty_context, 0);
     }
 
+    // The native segment runs while the engine is built in the background.
+    // Only in implicit batch mode, where the engines of the other shapes keep
+    // running: in explicit batch mode the engine is built for the shared
+    // optimization profiles.
+    const bool has_resource_inputs =
+        input_partial_shapes_.size() != input_partial_shapes_filtered_.size();
+    if (BuildEnginesInBackground() && use_implicit_batch_ &&
+        !use_calibration_ && !has_resource_inputs) {
+      BuildEngineInBackground(input_concrete_shapes, batch_size,
+                              ctx->device()->name(), cache_res);
+      return std::pair<EngineContext*, int>(&empty_context, 0);
+    }
+
     // Up to this point, calibrator_ can never be empty, since otherwise it
     // means calibration_mode_ is true and this path won't get executed.
-    auto result =
-        BuildEngine(input_concrete_shapes, batch_size, use_calibration_,
-                    calibrator_.get(), cache_res, ctx);
+    auto result = BuildEngine(input_concrete_shapes, batch_size,
+                              use_calibration_, calibrator_.get(), cache_res,
+                              &cache_res->profiles_, ctx,
+                              ctx->device()->name());
     if (!result.ok()) {
+      // Store an empty engine in the cache for these input shapes so we don't
+      // try to build the same failing engine again.
+      cache.emplace(input_concrete_shapes, std::make_unique<EngineContext>());
       return std::pair<EngineContext*, int>(&empty_context, 0);
     }
     TrtUniquePtrType<nvinfer1::ICudaEngine> engine = std::move(result.value());
@@ -16,12 +16,21 @@ limitations under the License.
 #include "tensorflow/compiler/tf2tensorrt/utils/trt_lru_cache.h"
 
 #include <sstream>
+#include <string>
+#include <vector>
 
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
+#include "tensorflow/compiler/tf2tensorrt/common/utils.h"
 #include "tensorflow/compiler/tf2tensorrt/utils/trt_allocator.h"
 #include "tensorflow/core/framework/device_base.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/fingerprint.h"
 #include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/path.h"
 
 #if GOOGLE_CUDA && GOOGLE_TENSORRT
 #include "third_party/tensorrt/NvInfer.h"
@@ -137,6 +146,71 @@ EngineContext* TRTEngineCacheResource::GetEngineContext(const int profile_id) {
   return cache_.begin()->second.get();
 }
 
+string GetEngineFilePath(const GraphDef& segment,
+                         absl::string_view build_options,
+                         const std::vector<PartialTensorShape>& input_shapes,
+                         const DeviceProperties& device) {
+  const string dir = GetTrtPersistentCacheDir();
+  if (dir.empty()) return "";
+  string serialized_segment;
+  SerializeToStringDeterministic(segment, &serialized_segment);
+  const auto architecture = device.environment().find("architecture");
+  const string key = absl::StrCat(
+      serialized_segment, "|", build_options, "|",
+      absl::StrJoin(input_shapes, ";",
+                    [](string* out, const PartialTensorShape& shape) {
+                      absl::StrAppend(out, shape.DebugString());
+                    }),
+      "|", absl::StrJoin(GetLoadedTensorRTVersion(), "."), "|", device.model(),
+      "|",
+      architecture == device.environment().end() ? "" : architecture->second);
+  return io::JoinPath(
+      dir, absl::StrCat("engine_", absl::Hex(Fingerprint64(key),
+                                             absl::kZeroPad16),
+                        ".plan"));
+}
+
+Status WriteEngineToFile(nvinfer1::ICudaEngine* engine, const string& path) {
+  TrtUniquePtrType<nvinfer1::IHostMemory> serialized(engine->serialize());
+  if (serialized == nullptr) {
+    return errors::Internal("Failed to serialize the engine ", path);
+  }
+  // Writes a temporary file first, replacing the file atomically for the
+  // other processes reading it.
+  Env* env = Env::Default();
+  string tmp_path = path;
+  if (!env->CreateUniqueFileName(&tmp_path, ".tmp")) {
+    return errors::Internal("Failed to create a temporary file for ", path);
+  }
+  TF_RETURN_IF_ERROR(WriteStringToFile(
+      env, tmp_path,
+      absl::string_view(static_cast<const char*>(serialized->data()),
+                        serialized->size())));
+  return env->RenameFile(tmp_path, path);
+}
+
+StatusOr<TrtUniquePtrType<nvinfer1::ICudaEngine>> ReadEngineFromFile(
+    const string& path, nvinfer1::IGpuAllocator* allocator,
+    nvinfer1::ILogger* logger) {
+  Env* env = Env::Default();
+  if (!env->FileExists(path).ok()) {
+    return TrtUniquePtrType<nvinfer1::ICudaEngine>();
+  }
+  string serialized_engine;
+  TF_RETURN_IF_ERROR(ReadFileToString(env, path, &serialized_engine));
+  TrtUniquePtrType<nvinfer1::IRuntime> runtime(
+      nvinfer1::createInferRuntime(*logger));
+  runtime->setGpuAllocator(allocator);
+  // Needed to deserialize the engines containing plugins.
+  MaybeInitializeTrtPlugins(logger);
+  TrtUniquePtrType<nvinfer1::ICudaEngine> engine(runtime->deserializeCudaEngine(
+      serialized_engine.data(), serialized_engine.size(), nullptr));
+  if (engine == nullptr) {
+    return errors::Internal("Failed to deserialize the engine ", path);
+  }
+  return engine;
+}
+
 }  // namespace tensorrt
 }  // namespace tensorflow
 
@@ -17,8 +17,14 @@ limitations under the License.
 #define TENSORFLOW_COMPILER_TF2TENSORRT_UTILS_TRT_LRU_CACHE_H_
 
 #include <list>
+#include <memory>
+#include <string>
 #include <thread>
 #include <unordered_map>
+#include <vector>
+
+#include "absl/container/flat_hash_set.h"
+#include "absl/strings/string_view.h"
 
 #include "tensorflow/compiler/tf2tensorrt/convert/utils.h"
 #include "tensorflow/compiler/tf2tensorrt/utils/trt_allocator.h"
@@ -26,8 +32,12 @@ limitations under the License.
 #include "tensorflow/compiler/tf2tensorrt/utils/trt_int8_calibrator.h"
 #include "tensorflow/compiler/tf2tensorrt/utils/trt_logger.h"
 #include "tensorflow/compiler/tf2tensorrt/utils/trt_shape_optimization_profiles.h"
+#include "tensorflow/core/framework/graph.pb.h"
 #include "tensorflow/core/framework/resource_mgr.h"
+#include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/platform/statusor.h"
+#include "tensorflow/core/protobuf/device_properties.pb.h"
 
 #if GOOGLE_CUDA && GOOGLE_TENSORRT
 #include "third_party/tensorrt/NvInfer.h"
@@ -251,8 +261,40 @@ class TRTEngineCacheResource : public ResourceBase {
   // generation and engine build. During runtime the list of profiles is used to
   // look up a matching profile for the input data.
   TrtShapeOptimizationProfile profiles_;
+
+  // The input shapes, see `TensorShapeUtils::ShapeListString`, of the engines
+  // being built in the background, to build each of them once. Guarded like
+  // `cache_`.
+  absl::flat_hash_set<string> pending_builds_;
+
+  // Whether an engine is being built in the background for the optimization
+  // profiles learned from the input shapes. Guarded like `cache_`.
+  bool learning_profiles_ = false;
+
+  // The engines replaced by the engines built for the learned profiles. The
+  // inference calls which looked them up may still be running them.
+  std::vector<std::unique_ptr<EngineContext>> replaced_engines_;
 };
 
+// Returns the path of the file persisting the engine of `segment` built for
+// `input_shapes` on `device` with the loaded TensorRT version, in
+// `GetTrtPersistentCacheDir()`. `build_options` identifies the other options
+// of the build, e.g. its precision. Returns an empty string if the engines
+// aren't persisted.
+string GetEngineFilePath(const GraphDef& segment,
+                         absl::string_view build_options,
+                         const std::vector<PartialTensorShape>& input_shapes,
+                         const DeviceProperties& device);
+
+// Writes the serialized `engine` to the file `path`.
+Status WriteEngineToFile(nvinfer1::ICudaEngine* engine, const string& path);
+
+// Reads the engine serialized in the file `path`. Returns a null engine if the
+// file doesn't exist.
+StatusOr<TrtUniquePtrType<nvinfer1::ICudaEngine>> ReadEngineFromFile(
+    const string& path, nvinfer1::IGpuAllocator* allocator,
+    nvinfer1::ILogger* logger);
+
 #endif  // GOOGLE_CUDA && GOOGLE_TENSORRT
 
 }  // namespace tensorrt
@@ -15,7 +15,16 @@ limitations under the License.
 
 #include "tensorflow/compiler/tf2tensorrt/utils/trt_lru_cache.h"
 
+#include <stdlib.h>
+
+#include <string>
+
+#include "absl/strings/match.h"
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/platform/path.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/protobuf/device_properties.pb.h"
 
 namespace tensorflow {
 namespace tensorrt {
@@ -53,5 +62,33 @@ TEST(LRUCacheTest, Basic) {
   EXPECT_EQ(cache.count(40), 1);
 }
 
+#if GOOGLE_CUDA && GOOGLE_TENSORRT
+TEST(EngineFilePathTest, DependsOnTheSegmentTheShapesAndTheDevice) {
+  const string dir = io::JoinPath(testing::TmpDir(), "tf_trt_cache");
+  setenv("TF_TRT_PERSISTENT_CACHE_DIR", dir.c_str(), /*overwrite=*/1);
+  GraphDef segment;
+  segment.add_node()->set_name("a");
+  DeviceProperties device;
+  device.set_model("Tesla T4");
+  (*device.mutable_environment())["architecture"] = "7.5";
+  const PartialTensorShape shape({1, 2});
+
+  const string path = GetEngineFilePath(segment, "FP32", {shape}, device);
+  EXPECT_TRUE(absl::StartsWith(path, io::JoinPath(dir, "engine_")));
+  EXPECT_EQ(GetEngineFilePath(segment, "FP32", {shape}, device), path);
+  EXPECT_NE(GetEngineFilePath(segment, "FP16", {shape}, device), path);
+  EXPECT_NE(GetEngineFilePath(segment, "FP32", {PartialTensorShape({1, 3})},
+                              device),
+            path);
+
+  DeviceProperties other_device = device;
+  other_device.set_model("A100");
+  EXPECT_NE(GetEngineFilePath(segment, "FP32", {shape}, other_device), path);
+
+  segment.add_node()->set_name("b");
+  EXPECT_NE(GetEngineFilePath(segment, "FP32", {shape}, device), path);
+}
+#endif  // GOOGLE_CUDA && GOOGLE_TENSORRT
+
 }  // namespace tensorrt
 }  // namespace tensorflow
@@ -16,9 +16,12 @@ limitations under the License.
 #include "tensorflow/compiler/tf2tensorrt/utils/trt_shape_optimization_profiles.h"
 
 #include <algorithm>
+#include <cmath>
 #include <functional>
+#include <utility>
 
 #include "absl/algorithm/container.h"
+#include "absl/strings/str_join.h"
 #include "tensorflow/compiler/tf2tensorrt/common/utils.h"
 #include "tensorflow/compiler/tf2tensorrt/convert/utils.h"
 #include "tensorflow/core/platform/stream_executor.h"
@@ -240,18 +243,24 @@ void FixShapeValueProfile(OptimizationProfileConfig* prof,
   }
 }
 
+// Checks whether lhs and rhs hold the same dimensions.
+bool DimVecsEqual(const std::vector<nvinfer1::Dims>& lhs,
+                  const std::vector<nvinfer1::Dims>& rhs) {
+  bool ret = lhs.size() == rhs.size();
+  for (int i = 0; ret && i < lhs.size(); i++) {
+    ret &= lhs[i].nbDims == rhs[i].nbDims;
+    for (int j = 0; ret && j < lhs[i].nbDims; j++) {
+      ret &= (lhs[i].d[j] == rhs[i].d[j]);
+    }
+  }
+  return ret;
+}
+
 // Checks whether rhs is already contained in values.
 bool AlreadyCollected(const std::vector<std::vector<nvinfer1::Dims>>& values,
                       const std::vector<nvinfer1::Dims>& rhs) {
   for (auto& lhs : values) {
-    bool ret = lhs.size() == rhs.size();
-    for (int i = 0; ret && i < lhs.size(); i++) {
-      ret &= lhs[i].nbDims == rhs[i].nbDims;
-      for (int j = 0; ret && j < lhs[i].nbDims; j++) {
-        ret &= (lhs[i].d[j] == rhs[i].d[j]);
-      }
-    }
-    if (ret) return true;
+    if (DimVecsEqual(lhs, rhs)) return true;
   }
   return false;
 }
@@ -317,18 +326,23 @@ void TrtShapeOptimizationProfile::InitProfiles(
   // that here we can have false positives. The shape tensor mask will be
   // updated once the network is constructed.
   SetShapeTensorMask(input_partial_shapes);
-  if (input_partial_shapes.size() > 0) {
-    for (OptimizationProfileConfig& prof : profiles_) {
-      // TODO: Remove this when the bug is fixed.
+  EnforceProfilesCompatibility(input_partial_shapes, &profiles_);
+}
+
+void TrtShapeOptimizationProfile::EnforceProfilesCompatibility(
+    const std::vector<PartialTensorShape>& input_partial_shapes,
+    std::vector<OptimizationProfileConfig>* profiles) const {
+  if (input_partial_shapes.empty()) return;
+  for (OptimizationProfileConfig& prof : *profiles) {
+    // TODO: Remove this when the bug is fixed.
 #if !IS_TRT_VERSION_GE(8, 0, 0, 0)
-      FixShapeValueProfile(&prof, is_shape_tensor_);
+    FixShapeValueProfile(&prof, is_shape_tensor_);
 #endif
-      for (int i = 0; i < input_partial_shapes.size(); i++) {
-        auto network_input = input_partial_shapes[i];
-        EnforceCompatibility(&prof.min[i], network_input);
-        EnforceCompatibility(&prof.opt[i], network_input);
-        EnforceCompatibility(&prof.max[i], network_input);
-      }
+    for (int i = 0; i < input_partial_shapes.size(); i++) {
+      auto network_input = input_partial_shapes[i];
+      EnforceCompatibility(&prof.min[i], network_input);
+      EnforceCompatibility(&prof.opt[i], network_input);
+      EnforceCompatibility(&prof.max[i], network_input);
     }
   }
 }
@@ -656,6 +670,198 @@ int TrtShapeOptimizationProfile::GetNumProfiles() const {
   return profiles_.size();
 }
 
+string TrtShapeOptimizationProfile::DebugString() const {
+  return absl::StrJoin(profiles_, ", ",
+                       [](string* out, const OptimizationProfileConfig& prof) {
+                         absl::StrAppend(out, prof.DebugString());
+                       });
+}
+
+// The maximum number of distinct shapes recorded to learn the profiles. The
+// least frequent shape is forgotten to record a new one.
+constexpr int kMaxRecordedShapes = 64;
+
+void TrtShapeOptimizationProfile::RecordShape(
+    const std::vector<TensorShape>& shapes) {
+  std::vector<nvinfer1::Dims> dimvec = GetDimVec(shapes);
+  for (int i = 0; i < shapes.size(); i++) {
+    if (i < actual_shape_values_.size() && i < is_shape_tensor_.size() &&
+        is_shape_tensor_[i]) {
+      dimvec.push_back(actual_shape_values_[i]);
+    } else {
+      dimvec.push_back(nvinfer1::Dims{0, {}});
+    }
+  }
+  num_recorded_shapes_++;
+  for (auto& entry : shape_histogram_) {
+    if (DimVecsEqual(entry.first, dimvec)) {
+      entry.second++;
+      return;
+    }
+  }
+  if (shape_histogram_.size() >= kMaxRecordedShapes) {
+    shape_histogram_.erase(absl::c_min_element(
+        shape_histogram_,
+        [](const auto& a, const auto& b) { return a.second < b.second; }));
+  }
+  shape_histogram_.emplace_back(std::move(dimvec), 1);
+}
+
+// A group of recorded shapes covered by a single learned profile.
+struct RecordedShapeGroup {
+  std::vector<nvinfer1::Dims> min;
+  std::vector<nvinfer1::Dims> max;
+  // The index of the most frequent shape of the group in the histogram, the
+  // opt dimensions of the profile.
+  int opt;
+  // The indices of the shapes of the group in the histogram.
+  std::vector<int> shapes;
+  int64_t count;
+  // The number of calls of the group weighted by the distance of their shapes
+  // to the opt dimensions.
+  double cost;
+};
+
+// Returns the cost of running the shapes of `group` with a profile optimized
+// for the shape `opt`: the distance between the number of elements of their
+// inputs, on a log scale, weighted by their number of calls.
+double GetRecordedShapeGroupCost(
+    const RecordedShapeGroup& group, int opt,
+    const std::vector<std::vector<double>>& log_num_elements,
+    const std::vector<int64_t>& counts) {
+  double cost = 0;
+  for (int shape : group.shapes) {
+    for (int i = 0; i < log_num_elements[shape].size(); i++) {
+      cost += counts[shape] *
+              std::abs(log_num_elements[shape][i] - log_num_elements[opt][i]);
+    }
+  }
+  return cost;
+}
+
+std::vector<OptimizationProfileConfig>
+TrtShapeOptimizationProfile::LearnProfiles(
+    const std::vector<PartialTensorShape>& input_partial_shapes,
+    int max_profiles) {
+  std::vector<RecordedShapeGroup> groups;
+  std::vector<std::vector<double>> log_num_elements;
+  std::vector<int64_t> counts;
+  for (int i = 0; i < shape_histogram_.size(); i++) {
+    const std::vector<nvinfer1::Dims>& dimvec = shape_histogram_[i].first;
+    // The execution tensors come first, followed by the shape values.
+    std::vector<double> log_n(dimvec.size() / 2);
+    for (int j = 0; j < log_n.size(); j++) {
+      for (int k = 0; k < dimvec[j].nbDims; k++) {
+        log_n[j] += std::log(std::max<int64_t>(dimvec[j].d[k], 1));
+      }
+    }
+    log_num_elements.push_back(std::move(log_n));
+    counts.push_back(shape_histogram_[i].second);
+    groups.push_back(
+        {dimvec, dimvec, i, {i}, shape_histogram_[i].second, /*cost=*/0});
+  }
+
+  // Greedily merges the two groups whose merge increases the cost the least.
+  while (static_cast<int>(groups.size()) > max_profiles) {
+    int best_a = -1;
+    int best_b = -1;
+    RecordedShapeGroup best_group;
+    for (int a = 0; a < groups.size(); a++) {
+      for (int b = a + 1; b < groups.size(); b++) {
+        RecordedShapeGroup group = groups[a];
+        if (!ShapeProfileBinaryOp(&group.min, groups[b].min,
+                                  [](int x, int y) { return std::min(x, y); })
+                 .ok() ||
+            !ShapeProfileBinaryOp(&group.max, groups[b].max,
+                                  [](int x, int y) { return std::max(x, y); })
+                 .ok()) {
+          // The shapes have different ranks.
+          continue;
+        }
+        if (counts[groups[b].opt] > counts[group.opt]) {
+          group.opt = groups[b].opt;
+        }
+        group.shapes.insert(group.shapes.end(), groups[b].shapes.begin(),
+                            groups[b].shapes.end());
+        group.count += groups[b].count;
+        group.cost = GetRecordedShapeGroupCost(group, group.opt,
+                                               log_num_elements, counts);
+        if (best_a == -1 ||
+            group.cost - groups[a].cost - groups[b].cost <
+                best_group.cost - groups[best_a].cost - groups[best_b].cost) {
+          best_a = a;
+          best_b = b;
+          best_group = std::move(group);
+        }
+      }
+    }
+    if (best_a == -1) break;
+    groups[best_a] = std::move(best_group);
+    groups.erase(groups.begin() + best_b);
+  }
+
+  // The most frequent profiles come first, GetProfileNumber returns the first
+  // one including the input shapes.
+  absl::c_stable_sort(groups, [](const RecordedShapeGroup& a,
+                                 const RecordedShapeGroup& b) {
+    return a.count > b.count;
+  });
+  if (static_cast<int>(groups.size()) > max_profiles) {
+    groups.resize(std::max(max_profiles, 0));
+  }
+  std::vector<OptimizationProfileConfig> profiles;
+  for (const RecordedShapeGroup& group : groups) {
+    VLOG(2) << "Learned optimization profile config with min="
+            << DebugString(group.min)
+            << ", opt=" << DebugString(shape_histogram_[group.opt].first)
+            << ", max=" << DebugString(group.max) << " for " << group.count
+            << " calls";
+    profiles.push_back(OptimizationProfileConfig{
+        group.min, shape_histogram_[group.opt].first, group.max});
+  }
+  EnforceProfilesCompatibility(input_partial_shapes, &profiles);
+
+  for (auto& entry : shape_histogram_) {
+    entry.second /= 2;
+  }
+  shape_histogram_.erase(
+      std::remove_if(shape_histogram_.begin(), shape_histogram_.end(),
+                     [](const auto& entry) { return entry.second == 0; }),
+      shape_histogram_.end());
+  num_recorded_shapes_ = 0;
+  return profiles;
+}
+
+bool TrtShapeOptimizationProfile::HasProfiles(
+    const std::vector<OptimizationProfileConfig>& profiles) const {
+  if (profiles.size() != profiles_.size()) return false;
+  for (int i = 0; i < profiles.size(); i++) {
+    if (!DimVecsEqual(profiles[i].min, profiles_[i].min) ||
+        !DimVecsEqual(profiles[i].opt, profiles_[i].opt) ||
+        !DimVecsEqual(profiles[i].max, profiles_[i].max)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void TrtShapeOptimizationProfile::SetProfiles(
+    std::vector<OptimizationProfileConfig> profiles) {
+  profiles_ = std::move(profiles);
+  // The profiles are ranges, the engine can't be static.
+  strategy_ = ProfileStrategy::kRangeOptimal;
+}
+
+void TrtShapeOptimizationProfile::CopyProfiles(
+    const TrtShapeOptimizationProfile& other) {
+  profiles_ = other.profiles_;
+  strategy_ = other.strategy_;
+  need_profiles_ = other.need_profiles_;
+  has_shape_tensor_ = other.has_shape_tensor_;
+  is_shape_tensor_ = other.is_shape_tensor_;
+  is_pruned_input_ = other.is_pruned_input_;
+}
+
 }  // namespace tensorrt
 }  // namespace tensorflow
 #endif  // GOOGLE_CUDA && GOOGLE_TENSORRT
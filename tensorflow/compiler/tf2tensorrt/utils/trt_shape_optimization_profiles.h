@@ -16,9 +16,11 @@ limitations under the License.
 #ifndef TENSORFLOW_COMPILER_TF2TENSORRT_UTILS_TRT_SHAPE_OPTIMIZATION_PROFILES_H_
 #define TENSORFLOW_COMPILER_TF2TENSORRT_UTILS_TRT_SHAPE_OPTIMIZATION_PROFILES_H_
 
+#include <cstdint>
 #include <list>
 #include <string>
 #include <unordered_set>
+#include <utility>
 #include <vector>
 
 #include "tensorflow/compiler/tf2tensorrt/common/datavec.h"
@@ -257,6 +259,39 @@ class TrtShapeOptimizationProfile {
   // Returns number of created profiles.
   int GetNumProfiles() const;
 
+  // Returns the min/opt/max dimensions of the created profiles.
+  string DebugString() const;
+
+  // Records the input shapes of an inference call, and the shape values
+  // collected by CollectShapeValues, to learn the profiles from the shapes of
+  // the traffic (see LearnProfiles).
+  void RecordShape(const std::vector<TensorShape>& shapes);
+
+  // Returns the number of shapes recorded since the profiles were last learned.
+  int64_t GetNumRecordedShapes() const { return num_recorded_shapes_; }
+
+  // Returns at most max_profiles profiles covering the recorded shapes. The
+  // recorded shapes are grouped so that the traffic runs with profiles whose
+  // opt dimensions are close to its shapes, each profile being optimized for
+  // the most frequent shape of its group. If the shapes can't be merged into
+  // max_profiles groups, e.g. as they have different ranks, only the most
+  // frequent groups get a profile. The counts of the recorded shapes are then
+  // halved, so that the shapes of the past traffic fade away.
+  std::vector<OptimizationProfileConfig> LearnProfiles(
+      const std::vector<PartialTensorShape>& input_partial_shapes,
+      int max_profiles);
+
+  // Whether the profiles are the given ones.
+  bool HasProfiles(
+      const std::vector<OptimizationProfileConfig>& profiles) const;
+
+  // Replaces the profiles, e.g. by the learned ones, to build a new engine.
+  void SetProfiles(std::vector<OptimizationProfileConfig> profiles);
+
+  // Copies the profiles of `other`, and the masks of the inputs set when
+  // building its engine, to run the engine built with `other`.
+  void CopyProfiles(const TrtShapeOptimizationProfile& other);
+
   bool HasShape() const { return !input_shapes_.empty(); }
   bool NeedProfiles() const { return need_profiles_; }
 
@@ -324,11 +359,25 @@ class TrtShapeOptimizationProfile {
   // Optimization profile generation strategy.
   ProfileStrategy strategy_;
 
+  // The number of inference calls with each of the input shapes recorded by
+  // RecordShape. The shapes are concatenated with the shape values like the
+  // dimensions of the profiles.
+  std::vector<std::pair<std::vector<nvinfer1::Dims>, int64_t>>
+      shape_histogram_;
+
+  // The number of shapes recorded since the profiles were last learned.
+  int64_t num_recorded_shapes_ = 0;
+
   // Adds optimization profiles to the builder config.
   Status AddProfiles(nvinfer1::IBuilder* builder,
                      nvinfer1::IBuilderConfig* config,
                      const nvinfer1::INetworkDefinition* network);
 
+  // Makes the profiles compatible with the network inputs.
+  void EnforceProfilesCompatibility(
+      const std::vector<PartialTensorShape>& input_partial_shapes,
+      std::vector<OptimizationProfileConfig>* profiles) const;
+
   void SetShapeTensorMask(const nvinfer1::ICudaEngine* engine, int n_inputs);
   void SetShapeTensorMask(
       const std::vector<PartialTensorShape>& input_partial_shapes);
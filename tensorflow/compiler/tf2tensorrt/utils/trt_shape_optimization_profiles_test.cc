@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <string.h>
 
+#include <utility>
 #include <vector>
 
 #include "absl/memory/memory.h"
@@ -250,6 +251,61 @@ TEST_P(TrtShapeOptimizationProfileTest, Dynamic) {
   CheckProfile(unseen_shapes, &profile, has_prof, false);
 }
 
+TEST_P(TrtShapeOptimizationProfileTest, LearnedProfiles) {
+  // The learned profiles do not depend on strategies, we test only once.
+  if (strategy_ != ProfileStrategy::kRange) return;
+
+  nvinfer1::Dims3 dims(-1, -1, 10);
+  DefineNetwork(network_.get(), dims);
+
+  TrtShapeOptimizationProfile profile;
+  std::vector<bool> input_mask(2, true);
+  profile.SetInputMask(input_mask);
+
+  // The number of inference calls with each input shape.
+  std::vector<std::pair<nvinfer1::Dims3, int>> traffic{
+      {nvinfer1::Dims3(2, 2, 10), 50},
+      {nvinfer1::Dims3(3, 3, 10), 10},
+      {nvinfer1::Dims3(16, 16, 10), 40},
+      {nvinfer1::Dims3(15, 15, 10), 5},
+  };
+  for (const auto& shape_and_count : traffic) {
+    std::vector<nvinfer1::Dims3> dim_vec(2, shape_and_count.first);
+    for (int i = 0; i < shape_and_count.second; i++) {
+      profile.RecordShape(DimVecToShapeVec(dim_vec));
+    }
+  }
+  EXPECT_EQ(profile.GetNumRecordedShapes(), 105);
+
+  std::vector<PartialTensorShape> input_partial_shapes;
+  TF_CHECK_OK(GetNetworkInputShapes(network_.get(), &input_partial_shapes));
+  std::vector<OptimizationProfileConfig> learned_profiles =
+      profile.LearnProfiles(input_partial_shapes, /*max_profiles=*/2);
+  ASSERT_EQ(learned_profiles.size(), 2);
+  EXPECT_EQ(profile.GetNumRecordedShapes(), 0);
+  EXPECT_FALSE(profile.HasProfiles(learned_profiles));
+  profile.SetProfiles(learned_profiles);
+  EXPECT_TRUE(profile.HasProfiles(learned_profiles));
+  EXPECT_FALSE(profile.IsStaticCompatible());
+
+  TF_CHECK_OK(profile.ConfigureBuilder(builder_.get(), builder_config_.get(),
+                                       network_.get()));
+  engine = TrtUniquePtrType<nvinfer1::ICudaEngine>(
+      builder_->buildEngineWithConfig(*network_.get(), *builder_config_.get()));
+  ASSERT_NE(nullptr, engine);
+  TF_CHECK_OK(profile.CreateExecutionContexts(engine.get(), &exec_contexts_));
+  EXPECT_EQ(exec_contexts_.size(), 2);
+
+  // Each profile is optimized for the most frequent shape of its group.
+  for (const auto& shape_and_count : traffic) {
+    std::vector<nvinfer1::Dims3> dim_vec(2, shape_and_count.first);
+    const bool is_most_frequent = shape_and_count.second >= 40;
+    CheckProfile(dim_vec, &profile, true, is_most_frequent);
+  }
+  CheckProfile({nvinfer1::Dims3(9, 9, 10), nvinfer1::Dims3(9, 9, 10)},
+               &profile, false, false);
+}
+
 }  // namespace tensorrt
 }  // namespace tensorflow
 
@@ -0,0 +1,319 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/backup_reducer.h"
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/collective_rma_local.h"
+#include "tensorflow/core/common_runtime/collective_util.h"
+#include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/common_runtime/dma_helper.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/cancellation.h"
+#include "tensorflow/core/framework/metrics.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/notification.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/blocking_counter.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace {
+// The member that gathers the contributions and distributes the result.
+constexpr int kLeaderRank = 0;
+
+// Returns a CancellationManager that is cancelled with `parent`, if any, and
+// can also be cancelled on its own.
+std::unique_ptr<CancellationManager> ChildCancellationManager(
+    CancellationManager* parent) {
+  if (parent == nullptr) return std::make_unique<CancellationManager>();
+  return std::make_unique<CancellationManager>(parent);
+}
+}  // namespace
+
+Status BackupReducer::InitializeCollectiveParams(
+    CollectiveParams* col_params) {
+  if (col_params->instance.type != REDUCTION_COLLECTIVE ||
+      col_params->instance.impl_details.collective_name != "BackupReduce") {
+    return errors::Internal("Unexpected collective ",
+                            col_params->instance.impl_details.collective_name,
+                            " for BackupReducer");
+  }
+  if (col_params->group.device_type != DEVICE_CPU) {
+    return errors::Unimplemented("BackupReduce only supports CPU devices, got ",
+                                 col_params->group.device_type.type_string());
+  }
+  const int group_size = col_params->group.group_size;
+  const int num_backup_workers =
+      col_params->instance.impl_details.num_backup_workers;
+  if (num_backup_workers <= 0 || num_backup_workers >= group_size) {
+    return errors::InvalidArgument(
+        "BackupReduce requires between 1 and group_size - 1 backup workers, "
+        "got ",
+        num_backup_workers, " for a group of size ", group_size);
+  }
+  return absl::OkStatus();
+}
+
+Status BackupReducer::InitializeCollectiveContext(
+    std::shared_ptr<CollectiveContext> col_ctx) {
+  DCHECK(col_ctx->dev_mgr);
+  col_ctx_ = col_ctx;
+  col_params_ = col_ctx->col_params.get();
+  return collective_util::InitializeDeviceAndLocality(
+      col_ctx->dev_mgr, col_ctx->device_name, &col_ctx->device,
+      &col_ctx->device_locality);
+}
+
+void BackupReducer::Run(StatusCallback done) {
+  CHECK(col_ctx_);
+  CHECK(col_params_);
+  // Like `RingReducer`, this does not require non-overlapping collectives.
+  col_ctx_->col_exec->UnblockDependencies(*col_params_);
+  Status s =
+      col_params_->default_rank == kLeaderRank ? RunLeader() : RunMember();
+  if (!s.ok()) StartAbort(s);
+  done(s);
+}
+
+// Note that this function is blocking and must not run in any thread
+// which cannot be blocked.
+Status BackupReducer::RunLeader() {
+  const int group_size = col_params_->group.group_size;
+  const int num_required =
+      group_size - col_params_->instance.impl_details.num_backup_workers;
+  const auto& members = col_params_->group.members;
+  const AllocatorAttributes attr = col_ctx_->op_ctx->output_alloc_attr(0);
+  Allocator* allocator = col_ctx_->device->GetAllocator(attr);
+  TF_RETURN_IF_ERROR(CopyLocal(col_ctx_->input, col_ctx_->output));
+
+  std::vector<Tensor> contributions(group_size);
+  std::vector<bool> used(group_size, false);
+  used[kLeaderRank] = true;
+  mutex mu;
+  condition_variable cv;
+  Status status;
+  int num_used = 1;
+  int num_pending = group_size - 1;
+  // Set once the contributions to reduce are known.  Receives that complete
+  // afterwards are ignored.
+  bool closed = num_used >= num_required;
+  std::unique_ptr<CancellationManager> late_cm =
+      ChildCancellationManager(col_ctx_->op_ctx->cancellation_manager());
+  for (int rank = 0; rank < group_size; ++rank) {
+    if (rank == kLeaderRank) continue;
+    contributions[rank] = Tensor(allocator, col_ctx_->output->dtype(),
+                                 col_ctx_->output->shape());
+    const CollGroupMember& peer = members[rank];
+    col_ctx_->col_exec->remote_access()->RecvFromPeer(
+        peer.device.name(), peer.task, peer.is_local, ContributionKey(rank),
+        col_ctx_->device, col_ctx_->op_ctx->op_device_context(), attr,
+        &contributions[rank], col_ctx_->device_locality,
+        0 /*dev_to_dev_stream_index*/, late_cm.get(),
+        [&, rank](const Status& s) {
+          mutex_lock l(mu);
+          if (!closed) {
+            if (s.ok()) {
+              used[rank] = true;
+              closed = ++num_used >= num_required;
+            } else {
+              status.Update(s);
+              closed = true;
+            }
+          }
+          --num_pending;
+          cv.notify_all();
+        });
+  }
+  {
+    mutex_lock l(mu);
+    while (!closed) cv.wait(l);
+  }
+  late_cm->StartCancel();
+  {
+    mutex_lock l(mu);
+    while (num_pending > 0) cv.wait(l);
+    TF_RETURN_IF_ERROR(status);
+  }
+
+  for (int rank = 0; rank < group_size; ++rank) {
+    if (rank == kLeaderRank) continue;
+    if (used[rank]) {
+      TF_RETURN_IF_ERROR(collective_util::ComputeBinOp(
+          col_ctx_->op_ctx, col_ctx_->op_params, col_ctx_->device,
+          col_params_->merge_op, col_ctx_->output, &contributions[rank]));
+    } else {
+      VLOG(1) << "BackupReduce " << col_ctx_->exec_key
+              << " dropped the contribution of " << members[rank].device.name();
+      metrics::RecordCollectiveBackupDroppedContribution(members[rank].task);
+    }
+  }
+  contributions.clear();
+  if (col_params_->final_op) {
+    std::unique_ptr<CollectiveAdapter> ca(
+        MakeCollectiveAdapter(col_ctx_->output, 1, allocator));
+    Tensor divisor = ca->Scalar(num_used);
+    TF_RETURN_IF_ERROR(collective_util::ComputeBinOp(
+        col_ctx_->op_ctx, col_ctx_->op_params, col_ctx_->device,
+        col_params_->final_op, col_ctx_->output, &divisor));
+  }
+
+  // Members that contributed are waiting for the result.  The others get a
+  // copy that is released once they fetch it or when the step's rendezvous
+  // is cleaned up.
+  std::shared_ptr<Tensor> late_result;
+  if (num_used < group_size) {
+    late_result = std::make_shared<Tensor>(
+        allocator, col_ctx_->output->dtype(), col_ctx_->output->shape());
+    TF_RETURN_IF_ERROR(CopyLocal(col_ctx_->output, late_result.get()));
+  }
+  BlockingCounter pending_sends(num_used - 1);
+  for (int rank = 0; rank < group_size; ++rank) {
+    if (rank == kLeaderRank) continue;
+    const CollGroupMember& peer = members[rank];
+    if (used[rank]) {
+      col_ctx_->col_exec->remote_access()->PostToPeer(
+          peer.device.name(), peer.task, ResultKey(rank), col_ctx_->device,
+          col_ctx_->op_ctx->op_device_context(), attr, col_ctx_->output,
+          col_ctx_->device_locality, col_ctx_->op_ctx->cancellation_manager(),
+          [&](const Status& s) {
+            {
+              mutex_lock l(mu);
+              status.Update(s);
+            }
+            pending_sends.DecrementCount();
+          });
+    } else {
+      // Neither the op's device context nor its cancellation manager outlive
+      // this collective.  Neither is needed on CPU.
+      string key = ResultKey(rank);
+      col_ctx_->col_exec->remote_access()->PostToPeer(
+          peer.device.name(), peer.task, key, col_ctx_->device,
+          /*from_device_ctx=*/nullptr, attr, late_result.get(),
+          col_ctx_->device_locality, /*cancellation_manager=*/nullptr,
+          [late_result, key](const Status& s) {
+            if (!s.ok()) {
+              VLOG(1) << "BackupReduce result " << key
+                      << " was not fetched: " << s;
+            }
+          });
+    }
+  }
+  pending_sends.Wait();
+  mutex_lock l(mu);
+  return status;
+}
+
+// Note that this function is blocking and must not run in any thread
+// which cannot be blocked.
+Status BackupReducer::RunMember() {
+  const int rank = col_params_->default_rank;
+  const CollGroupMember& leader = col_params_->group.members[kLeaderRank];
+  const AllocatorAttributes attr = col_ctx_->op_ctx->output_alloc_attr(0);
+  // The result is received into a temporary, since the output may share its
+  // buffer with the input still being sent.
+  Tensor result(col_ctx_->device->GetAllocator(attr),
+                col_ctx_->output->dtype(), col_ctx_->output->shape());
+  std::unique_ptr<CancellationManager> send_cm =
+      ChildCancellationManager(col_ctx_->op_ctx->cancellation_manager());
+  mutex mu;
+  Status status;
+  bool received = false;
+  BlockingCounter pending(2);
+  col_ctx_->col_exec->remote_access()->PostToPeer(
+      leader.device.name(), leader.task, ContributionKey(rank),
+      col_ctx_->device, col_ctx_->op_ctx->op_device_context(), attr,
+      col_ctx_->input, col_ctx_->device_locality, send_cm.get(),
+      [&](const Status& s) {
+        {
+          mutex_lock l(mu);
+          // A contribution the leader left out is cancelled below.
+          if (!received || !errors::IsCancelled(s)) status.Update(s);
+        }
+        pending.DecrementCount();
+      });
+  col_ctx_->col_exec->remote_access()->RecvFromPeer(
+      leader.device.name(), leader.task, leader.is_local, ResultKey(rank),
+      col_ctx_->device, col_ctx_->op_ctx->op_device_context(), attr, &result,
+      col_ctx_->device_locality, 0 /*dev_to_dev_stream_index*/,
+      col_ctx_->op_ctx->cancellation_manager(), [&](const Status& s) {
+        {
+          mutex_lock l(mu);
+          status.Update(s);
+          received = s.ok();
+        }
+        // The leader no longer needs this contribution if it has not been
+        // picked up yet.
+        if (s.ok()) send_cm->StartCancel();
+        pending.DecrementCount();
+      });
+  pending.Wait();
+  {
+    mutex_lock l(mu);
+    TF_RETURN_IF_ERROR(status);
+  }
+  return CopyLocal(&result, col_ctx_->output);
+}
+
+Status BackupReducer::CopyLocal(const Tensor* src, Tensor* dst) {
+  if (src == dst || DMAHelper::base(src) == DMAHelper::base(dst)) {
+    return absl::OkStatus();
+  }
+  Notification note;
+  Status status;
+  CollectiveRemoteAccessLocal::MemCpyAsync(
+      col_ctx_->op_ctx->op_device_context(),
+      col_ctx_->op_ctx->op_device_context(), col_ctx_->device,
+      col_ctx_->device, col_ctx_->op_ctx->output_alloc_attr(0),
+      col_ctx_->op_ctx->output_alloc_attr(0), src, dst,
+      0 /*dev_to_dev_stream_index*/, [&note, &status](const Status& s) {
+        status.Update(s);
+        note.Notify();
+      });
+  note.WaitForNotification();
+  return status;
+}
+
+void BackupReducer::StartAbort(const Status& s) {
+  LOG(ERROR) << "Aborting BackupReduce with " << s;
+  // Aborting the executor cancels the outstanding transfers of all devices,
+  // unless this is a cancellation that is doing so already.
+  if (col_ctx_->op_ctx->cancellation_manager() == nullptr ||
+      (!col_ctx_->op_ctx->cancellation_manager()->IsCancelled() &&
+       !col_ctx_->op_ctx->cancellation_manager()->IsCancelling())) {
+    col_ctx_->col_exec->StartAbort(s);
+  }
+}
+
+string BackupReducer::ContributionKey(int rank) const {
+  return strings::StrCat(col_ctx_->exec_key, ":contribution:", rank);
+}
+
+string BackupReducer::ResultKey(int rank) const {
+  return strings::StrCat(col_ctx_->exec_key, ":result:", rank);
+}
+
+namespace {
+REGISTER_COLLECTIVE(BackupReduce, BackupReducer);
+}  // namespace
+
+}  // namespace tensorflow
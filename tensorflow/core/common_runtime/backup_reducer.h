@@ -0,0 +1,77 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_BACKUP_REDUCER_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_BACKUP_REDUCER_H_
+
+#include <memory>
+#include <string>
+
+#include "tensorflow/core/common_runtime/base_collective_executor.h"
+#include "tensorflow/core/framework/collective.h"
+#include "tensorflow/core/framework/tensor.h"
+
+namespace tensorflow {
+
+// Implementation of collective all-reduce with backup workers: the reduction
+// completes once all but `num_backup_workers` members have contributed, so
+// that a few stragglers do not hold up every member.
+//
+// The member with rank 0 gathers the contributions of the others.  Once
+// enough have arrived it cancels the receives of the late ones, reduces the
+// contributions it has, applies the final op with the number of
+// contributions as divisor, and sends the result back to every member.
+// Members still waiting for their contribution to be picked up cancel the
+// send when the result arrives.  The result for a straggler is a copy that
+// stays posted after the reducer has finished, so that rank 0 does not wait
+// for it either.  Dropped contributions are counted by task in the
+// /tensorflow/core/collective_backup_dropped_contributions metric.
+//
+// Since the result flows through rank 0, it must not be a straggler itself
+// for backup workers to help.  Only CPU devices are supported.
+class BackupReducer : public CollectiveImplementationInterface {
+ public:
+  BackupReducer() = default;
+  ~BackupReducer() override = default;
+
+  // Verifies the device type and the number of backup workers.
+  Status InitializeCollectiveParams(CollectiveParams* col_params) override;
+
+  // Initializes members of CollectiveContext not yet initialized, i.e. device
+  // and device_locality.  Also saves the CollectiveContext in this object.
+  Status InitializeCollectiveContext(
+      std::shared_ptr<CollectiveContext> col_ctx) override;
+
+  // Begins execution of the all-reduce.
+  // Must be called in a blockable thread.
+  void Run(StatusCallback done) override;
+
+ private:
+  // Gathers and reduces the contributions, and sends back the result.
+  Status RunLeader();
+  // Sends this member's contribution and receives the result.
+  Status RunMember();
+  // Copies `src` to `dst` on this device, unless they share a buffer.
+  Status CopyLocal(const Tensor* src, Tensor* dst);
+  void StartAbort(const Status& s);
+
+  string ContributionKey(int rank) const;
+  string ResultKey(int rank) const;
+
+  std::shared_ptr<CollectiveContext> col_ctx_;
+  const CollectiveParams* col_params_ = nullptr;  // Not owned
+};
+
+}  // namespace tensorflow
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_BACKUP_REDUCER_H_
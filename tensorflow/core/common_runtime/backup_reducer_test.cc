@@ -0,0 +1,158 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/backup_reducer.h"
+
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/collective_test_util.h"
+#include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/common_runtime/process_util.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/monitoring/cell_reader.h"
+#include "tensorflow/core/platform/blocking_counter.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/public/version.h"
+
+namespace tensorflow {
+namespace {
+
+using ::tensorflow::monitoring::testing::CellReader;
+
+constexpr int64_t kNumElements = 1001;
+
+std::unique_ptr<OpKernel> GetBinOp(const string& op, Device* device) {
+  NodeDef node_def;
+  TF_CHECK_OK(NodeDefBuilder(strings::StrCat(op, "_node"), op)
+                  .Attr("T", DT_FLOAT)
+                  .Input(FakeInput(DT_FLOAT))
+                  .Input(FakeInput(DT_FLOAT))
+                  .Finalize(&node_def));
+  Status status;
+  std::unique_ptr<OpKernel> k = CreateOpKernel(
+      DEVICE_CPU, device, device->GetAllocator(AllocatorAttributes()),
+      node_def, TF_GRAPH_DEF_VERSION, &status);
+  TF_CHECK_OK(status);
+  return k;
+}
+
+// Runs a mean all-reduce with `num_backup_workers` where rank `r` contributes
+// `i + r` at element `i`, and starts `delay_micros` late if it is `straggler`.
+// Returns the status and output of every rank.
+std::vector<Status> RunMeanReduce(CollectiveTestEnv* test_env,
+                                  int num_backup_workers, int straggler,
+                                  int64_t delay_micros,
+                                  std::vector<Tensor>* outputs) {
+  const int group_size =
+      test_env->num_workers * test_env->num_devices_per_worker;
+  outputs->clear();
+  for (int rank = 0; rank < group_size; ++rank) {
+    Tensor t(DT_FLOAT, TensorShape({kNumElements}));
+    auto flat = t.flat<float>();
+    for (int64_t i = 0; i < kNumElements; ++i) {
+      flat(i) = static_cast<float>(i + rank);
+    }
+    outputs->push_back(std::move(t));
+  }
+  std::vector<Status> statuses(group_size);
+  BlockingCounter counter(group_size);
+  for (int rank = 0; rank < group_size; ++rank) {
+    SchedClosure([test_env, rank, num_backup_workers, straggler, delay_micros,
+                  outputs, &statuses, &counter]() {
+      if (rank == straggler) {
+        Env::Default()->SleepForMicroseconds(delay_micros);
+      }
+      auto col_params = CreateCollectiveParams(
+          *test_env, rank, "BackupReduce", REDUCTION_COLLECTIVE, DT_FLOAT,
+          TensorShape({kNumElements}));
+      col_params->instance.impl_details.num_backup_workers =
+          num_backup_workers;
+      Device* device = nullptr;
+      TF_CHECK_OK(test_env->device_mgr->LookupDevice(
+          col_params->group.members[rank].device.name(), &device));
+      std::unique_ptr<OpKernel> merge_op = GetBinOp("Add", device);
+      std::unique_ptr<OpKernel> final_op = GetBinOp("Div", device);
+      col_params->merge_op = merge_op.get();
+      col_params->final_op = final_op.get();
+      Tensor* tensor = &(*outputs)[rank];
+      statuses[rank] = RunCollective(test_env, col_params.get(), device,
+                                     tensor, tensor);
+      counter.DecrementCount();
+    });
+  }
+  counter.Wait();
+  return statuses;
+}
+
+TEST(BackupReducerTest, DropsStraggler) {
+  CellReader<int64_t> dropped(
+      "/tensorflow/core/collective_backup_dropped_contributions");
+  std::unique_ptr<CollectiveTestEnv> test_env =
+      CreateCollectiveTestEnv(/*num_workers=*/2, /*num_devices_per_worker=*/2,
+                              DEVICE_CPU);
+  std::vector<Tensor> outputs;
+  std::vector<Status> statuses =
+      RunMeanReduce(test_env.get(), /*num_backup_workers=*/1, /*straggler=*/3,
+                    /*delay_micros=*/500 * 1000, &outputs);
+  // The mean of the contributions of ranks 0, 1 and 2.
+  Tensor expected(DT_FLOAT, TensorShape({kNumElements}));
+  auto flat = expected.flat<float>();
+  for (int64_t i = 0; i < kNumElements; ++i) {
+    flat(i) = static_cast<float>(i + 1);
+  }
+  for (int rank = 0; rank < outputs.size(); ++rank) {
+    TF_ASSERT_OK(statuses[rank]) << "rank " << rank;
+    test::ExpectTensorEqual<float>(outputs[rank], expected);
+  }
+  EXPECT_EQ(dropped.Delta("/job:worker/replica:0/task:1"), 1);
+}
+
+TEST(BackupReducerTest, SameResultOnEveryMember) {
+  std::unique_ptr<CollectiveTestEnv> test_env =
+      CreateCollectiveTestEnv(/*num_workers=*/1, /*num_devices_per_worker=*/4,
+                              DEVICE_CPU);
+  std::vector<Tensor> outputs;
+  std::vector<Status> statuses =
+      RunMeanReduce(test_env.get(), /*num_backup_workers=*/2,
+                    /*straggler=*/-1, /*delay_micros=*/0, &outputs);
+  for (int rank = 0; rank < outputs.size(); ++rank) {
+    TF_ASSERT_OK(statuses[rank]) << "rank " << rank;
+    test::ExpectTensorEqual<float>(outputs[rank], outputs[0]);
+  }
+}
+
+TEST(BackupReducerTest, TooManyBackupWorkers) {
+  std::unique_ptr<CollectiveTestEnv> test_env =
+      CreateCollectiveTestEnv(/*num_workers=*/1, /*num_devices_per_worker=*/2,
+                              DEVICE_CPU);
+  std::vector<Tensor> outputs;
+  std::vector<Status> statuses =
+      RunMeanReduce(test_env.get(), /*num_backup_workers=*/2,
+                    /*straggler=*/-1, /*delay_micros=*/0, &outputs);
+  for (const Status& status : statuses) {
+    EXPECT_TRUE(errors::IsInvalidArgument(status)) << status;
+  }
+}
+
+}  // namespace
+}  // namespace tensorflow
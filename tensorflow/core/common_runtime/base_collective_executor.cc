@@ -272,6 +272,25 @@ void BaseCollectiveExecutor::ExecuteAsync(OpKernelContext* ctx,
                                           const CollectiveParams* col_params,
                                           const string& exec_key,
                                           StatusCallback done) {
+  Tensor* output = ctx->mutable_output(0);
+  const Tensor* input =
+      (col_params->instance.type == REDUCTION_COLLECTIVE ||
+       col_params->instance.type == GATHER_COLLECTIVE ||
+       col_params->instance.type == PERMUTE_COLLECTIVE ||
+       col_params->instance.type == ALL_TO_ALL_COLLECTIVE ||
+       col_params->instance.type == REDUCE_SCATTER_COLLECTIVE ||
+       (col_params->instance.type == BROADCAST_COLLECTIVE &&
+        col_params->is_source))
+          ? &ctx->input(0)
+          : nullptr;
+  ExecuteAsync(ctx, col_params, exec_key, input, output, std::move(done));
+}
+
+void BaseCollectiveExecutor::ExecuteAsync(OpKernelContext* ctx,
+                                          const CollectiveParams* col_params,
+                                          const string& exec_key,
+                                          const Tensor* input, Tensor* output,
+                                          StatusCallback done) {
   // See CompleteParamsAsync() how done() and the timeout callback interacts.
   const auto is_callback_called = std::make_shared<std::atomic<bool>>(false);
   auto done_safe = [this, done, ctx, is_callback_called](const Status& s) {
@@ -301,17 +320,6 @@ void BaseCollectiveExecutor::ExecuteAsync(OpKernelContext* ctx,
         });
   }
 
-  Tensor* output = ctx->mutable_output(0);
-  const Tensor* input =
-      (col_params->instance.type == REDUCTION_COLLECTIVE ||
-       col_params->instance.type == GATHER_COLLECTIVE ||
-       col_params->instance.type == PERMUTE_COLLECTIVE ||
-       col_params->instance.type == ALL_TO_ALL_COLLECTIVE ||
-       col_params->instance.type == REDUCE_SCATTER_COLLECTIVE ||
-       (col_params->instance.type == BROADCAST_COLLECTIVE &&
-        col_params->is_source))
-          ? &ctx->input(0)
-          : nullptr;
   CollectiveImplementationInterface* col_impl = nullptr;
   Status status = CreateCollective(*col_params, &col_impl);
   if (!status.ok()) {
@@ -0,0 +1,92 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/branch_profile.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+
+BranchProfile* BranchProfile::Global() {
+  static BranchProfile* const profile = new BranchProfile();
+  return profile;
+}
+
+bool BranchProfile::RecordingEnabled() {
+  static const bool enabled = [] {
+    bool enabled;
+    TF_CHECK_OK(
+        ReadBoolFromEnvVar("TF_RECORD_BRANCH_PROFILE", false, &enabled));
+    return enabled;
+  }();
+  return enabled;
+}
+
+std::string BranchProfile::Key(absl::string_view node_name,
+                               absl::Span<const std::string> branches) {
+  return absl::StrCat(node_name, ";", absl::StrJoin(branches, ";"));
+}
+
+void BranchProfile::Record(const std::string& key, int branch,
+                           int num_branches) {
+  if (branch < 0 || branch >= num_branches) return;
+  mutex_lock l(mu_);
+  std::vector<int64_t>& counts = counts_[key];
+  if (counts.size() != static_cast<size_t>(num_branches)) {
+    counts.assign(num_branches, 0);
+  }
+  ++counts[branch];
+}
+
+std::vector<int64_t> BranchProfile::Counts(const std::string& key) const {
+  tf_shared_lock l(mu_);
+  auto it = counts_.find(key);
+  if (it == counts_.end()) return {};
+  return it->second;
+}
+
+int64_t BranchProfile::NumExecutions(const std::string& key) const {
+  const std::vector<int64_t> counts = Counts(key);
+  return std::accumulate(counts.begin(), counts.end(), int64_t{0});
+}
+
+std::optional<int> BranchProfile::DominantBranch(const std::string& key,
+                                                 int64_t min_samples,
+                                                 double min_ratio) const {
+  const std::vector<int64_t> counts = Counts(key);
+  const int64_t total =
+      std::accumulate(counts.begin(), counts.end(), int64_t{0});
+  if (total == 0 || total < min_samples) return std::nullopt;
+  const auto dominant = std::max_element(counts.begin(), counts.end());
+  if (*dominant < min_ratio * total) return std::nullopt;
+  return static_cast<int>(dominant - counts.begin());
+}
+
+void BranchProfile::Clear() {
+  mutex_lock l(mu_);
+  counts_.clear();
+}
+
+}  // namespace tensorflow
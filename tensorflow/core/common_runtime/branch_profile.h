@@ -0,0 +1,78 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_BRANCH_PROFILE_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_BRANCH_PROFILE_H_
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+
+// Thread-safe.
+// Counts how many times each branch of the If and Case nodes was taken at
+// runtime, so that graph optimizations can specialize the control flow for the
+// branches that are taken almost every time. Branch 0 of an If node is its
+// then branch, and branch 1 its else branch.
+class BranchProfile {
+ public:
+  BranchProfile() = default;
+
+  // Returns the process-wide profile. The If and Case kernels only record to
+  // it if the TF_RECORD_BRANCH_PROFILE environment variable is true.
+  static BranchProfile* Global();
+  static bool RecordingEnabled();
+
+  // Returns the key of the node named `node_name` whose branch functions are
+  // named `branches`. The function names tell apart the nodes with the same
+  // name in different function bodies.
+  static std::string Key(absl::string_view node_name,
+                         absl::Span<const std::string> branches);
+
+  // Adds one execution of `branch` out of `num_branches`.
+  void Record(const std::string& key, int branch, int num_branches);
+
+  // Returns the number of times each branch was taken, or an empty vector if
+  // the node was never executed.
+  std::vector<int64_t> Counts(const std::string& key) const;
+
+  // Returns the number of times the node was executed.
+  int64_t NumExecutions(const std::string& key) const;
+
+  // Returns the branch taken at least `min_ratio` of the times, if the node
+  // was executed at least `min_samples` times.
+  std::optional<int> DominantBranch(const std::string& key,
+                                    int64_t min_samples,
+                                    double min_ratio) const;
+
+  void Clear();
+
+ private:
+  mutable mutex mu_;
+  absl::flat_hash_map<std::string, std::vector<int64_t>> counts_
+      TF_GUARDED_BY(mu_);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_BRANCH_PROFILE_H_
@@ -0,0 +1,62 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/branch_profile.h"
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+TEST(BranchProfileTest, CountsBranches) {
+  BranchProfile profile;
+  const std::string key = BranchProfile::Key("cond", {"then", "else"});
+  EXPECT_TRUE(profile.Counts(key).empty());
+
+  for (int i = 0; i < 3; ++i) profile.Record(key, 0, 2);
+  profile.Record(key, 1, 2);
+  // Out of range branches are ignored.
+  profile.Record(key, 2, 2);
+  EXPECT_EQ(profile.Counts(key), std::vector<int64_t>({3, 1}));
+  EXPECT_EQ(profile.NumExecutions(key), 4);
+
+  // The branch function names are part of the key.
+  EXPECT_TRUE(
+      profile.Counts(BranchProfile::Key("cond", {"then", "other"})).empty());
+
+  profile.Clear();
+  EXPECT_TRUE(profile.Counts(key).empty());
+}
+
+TEST(BranchProfileTest, DominantBranch) {
+  BranchProfile profile;
+  const std::string key = BranchProfile::Key("case", {"b0", "b1", "b2"});
+  for (int i = 0; i < 98; ++i) profile.Record(key, 2, 3);
+  profile.Record(key, 0, 3);
+  profile.Record(key, 1, 3);
+
+  EXPECT_EQ(profile.DominantBranch(key, 100, 0.95), std::optional<int>(2));
+  EXPECT_EQ(profile.DominantBranch(key, 100, 0.99), std::nullopt);
+  EXPECT_EQ(profile.DominantBranch(key, 1000, 0.95), std::nullopt);
+  EXPECT_EQ(profile.DominantBranch("unknown", 0, 0.5), std::nullopt);
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -48,6 +48,12 @@ string BuildGraphOptions::DebugString() const {
       break;
   }
   strings::StrAppend(&rv, "\ncollective_order: ", collective_order_str);
+  if (!feed_shapes.empty()) {
+    strings::StrAppend(&rv, "\nFeed shapes: ");
+    for (const auto& shape : feed_shapes) {
+      strings::StrAppend(&rv, shape.DebugString(), ", ");
+    }
+  }
   return rv;
 }
 
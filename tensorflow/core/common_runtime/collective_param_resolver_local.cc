@@ -699,6 +699,20 @@ void CollectiveParamResolverLocal::AssignCollectiveType(CollectiveParams* cp) {
       CollectiveRegistry::LookupParamResolverInstance("NcclReduce", &col_impl)
           .ok();
   cp->instance.impl_details.collective_name = GetCollectiveName(cp, use_nccl);
+  // The two-level all-reduce only pays off when the group spans tasks, and
+  // needs the same number of devices in each of them.
+  if (!use_nccl && cp->instance.type == REDUCTION_COLLECTIVE &&
+      cp->instance.impl_details.communication_hint == "hierarchical" &&
+      cp->group.device_type == DEVICE_CPU && cp->group.num_tasks > 1 &&
+      cp->group.same_num_devices_per_task) {
+    cp->instance.impl_details.collective_name = "HierarchicalRingReduce";
+  }
+  // Backup workers need a reduction that can finish without every member.
+  if (!use_nccl && cp->instance.type == REDUCTION_COLLECTIVE &&
+      cp->instance.impl_details.num_backup_workers > 0 &&
+      cp->group.device_type == DEVICE_CPU) {
+    cp->instance.impl_details.collective_name = "BackupReduce";
+  }
   VLOG(1) << "AssignCollectiveType "
           << cp->instance.impl_details.collective_name;
 }
@@ -77,6 +77,10 @@ class CollectiveParamResolverLocalTest : public ::testing::Test {
     EXPECT_EQ(actual_device_order, expected_device_order);
   }
 
+  void AssignCollectiveType(CollectiveParams* cp) {
+    prl_->AssignCollectiveType(cp);
+  }
+
   DeviceAttributes GetDeviceAttributes(const string& device_name) {
     Device* device = nullptr;
     TF_CHECK_OK(device_mgr_->LookupDevice(device_name, &device));
@@ -160,6 +164,31 @@ TEST_F(CollectiveParamResolverLocalTest, CompleteDefaultRanking) {
                             });
 }
 
+TEST_F(CollectiveParamResolverLocalTest, HierarchicalReductionNeedsEvenTasks) {
+  auto* cp = new CollectiveParams();
+  core::ScopedUnref unref(cp);
+  cp->group.group_size = 4;
+  cp->group.device_type = DeviceType("CPU");
+  cp->group.num_tasks = 2;
+  cp->instance.type = REDUCTION_COLLECTIVE;
+  cp->instance.impl_details.communication_hint = "hierarchical";
+
+  cp->group.num_devices_per_task = {{"/job:worker/replica:0/task:0", 2},
+                                    {"/job:worker/replica:0/task:1", 2}};
+  cp->group.same_num_devices_per_task = true;
+  AssignCollectiveType(cp);
+  EXPECT_EQ(cp->instance.impl_details.collective_name,
+            "HierarchicalRingReduce");
+
+  // The group size is a multiple of the number of tasks, but the devices
+  // can't be split evenly across them.
+  cp->group.num_devices_per_task = {{"/job:worker/replica:0/task:0", 1},
+                                    {"/job:worker/replica:0/task:1", 3}};
+  cp->group.same_num_devices_per_task = false;
+  AssignCollectiveType(cp);
+  EXPECT_EQ(cp->instance.impl_details.collective_name, "RingReduce");
+}
+
 TEST_F(CollectiveParamResolverLocalTest, CompleteParamsReduction1Task) {
   CollectiveParams* cps[NUM_DEVS];
   Status statuses[NUM_DEVS];
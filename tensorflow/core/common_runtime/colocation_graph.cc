@@ -62,6 +62,9 @@ namespace {
 const StringPiece kColocationAttrNameStringPiece(kColocationAttrName);
 const StringPiece kColocationGroupPrefixStringPiece(kColocationGroupPrefix);
 
+// The attr that selects the kernel registered with a label.
+constexpr char kKernelLabelAttr[] = "_kernel";
+
 // Using absl::StrJoin with lambda does not work in tf-lite builds.
 std::vector<string> DevicesToString(const std::vector<Device*> devices) {
   std::vector<string> v;
@@ -164,16 +167,16 @@ bool HasHostMemoryOutType(const Node& node) {
 }  // namespace
 
 Status Member::SetParentAndSupportedDevices(
-    const Node& node, const std::vector<DeviceType>& types,
-    const DeviceNameUtils::ParsedName* local_address_spec) {
+    const Node& node,
+    const PrioritizedDeviceTypeVector& supported_device_types) {
   int id = node.id();
   if (id < 0) {
     return errors::Internal("Placer should not be creating a Member for node: ",
                             node.DebugString());
   }
   parent_ = id;
-  return SupportedDeviceTypesForNode(
-      types, node.def(), &supported_device_types_, local_address_spec);
+  supported_device_types_ = supported_device_types;
+  return absl::OkStatus();
 }
 
 Status Member::SetAssignedDeviceName(const string& device_name) {
@@ -1491,9 +1494,48 @@ Status ColocationGraph::InitializeMemberWithAssignedDevice(
                           node_type);
 }
 
+Status ColocationGraph::GetSupportedDeviceTypes(
+    const Node& node, PrioritizedDeviceTypeVector* supported_device_types) {
+  auto [attrs_it, inserted] =
+      kernel_constraint_attrs_.try_emplace(node.type_string());
+  if (inserted) {
+    std::set<string> attr_names = {kKernelLabelAttr};
+    for (const KernelDef& kernel_def :
+         GetRegisteredKernelsForOp(node.type_string()).kernel()) {
+      for (const auto& constraint : kernel_def.constraint()) {
+        attr_names.insert(constraint.name());
+      }
+    }
+    attrs_it->second.assign(attr_names.begin(), attr_names.end());
+  }
+  // The requested device matters when no kernel is registered for the op.
+  string key =
+      strings::StrCat(node.type_string(), ";", node.requested_device());
+  for (const string& attr_name : attrs_it->second) {
+    const AttrValue* attr_value = node.attrs().Find(attr_name);
+    strings::StrAppend(&key, ";", attr_name, "=",
+                       attr_value == nullptr ? "?"
+                                             : attr_value->SerializeAsString());
+  }
+
+  auto it = supported_device_types_.find(key);
+  if (it != supported_device_types_.end()) {
+    *supported_device_types = it->second;
+    return absl::OkStatus();
+  }
+  supported_device_types->clear();
+  TF_RETURN_IF_ERROR(SupportedDeviceTypesForNode(device_types_, node.def(),
+                                                 supported_device_types,
+                                                 &local_address_spec_));
+  supported_device_types_.emplace(std::move(key), *supported_device_types);
+  return absl::OkStatus();
+}
+
 Status ColocationGraph::InitializeMember(const Node& node, Member* member) {
-  TF_RETURN_IF_ERROR(member->SetParentAndSupportedDevices(
-      node, device_types_, &local_address_spec_));
+  PrioritizedDeviceTypeVector supported_device_types;
+  TF_RETURN_IF_ERROR(GetSupportedDeviceTypes(node, &supported_device_types));
+  TF_RETURN_IF_ERROR(
+      member->SetParentAndSupportedDevices(node, supported_device_types));
 
   if (node.has_assigned_device_name()) {
     TF_RETURN_IF_ERROR(InitializeMemberWithAssignedDevice(
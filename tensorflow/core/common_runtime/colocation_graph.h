@@ -16,9 +16,11 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_COMMON_RUNTIME_COLOCATION_GRAPH_H_
 #define TENSORFLOW_CORE_COMMON_RUNTIME_COLOCATION_GRAPH_H_
 
+#include <string>
 #include <unordered_map>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/strings/str_join.h"
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/common_runtime/inspecting_placer.h"
@@ -37,9 +39,11 @@ class Member {
  public:
   Member() = default;
 
+  // Makes `node` its own parent, supported by `supported_device_types`, as
+  // computed by SupportedDeviceTypesForNode.
   Status SetParentAndSupportedDevices(
-      const Node& node, const std::vector<DeviceType>& types,
-      const DeviceNameUtils::ParsedName* local_address_spec);
+      const Node& node,
+      const PrioritizedDeviceTypeVector& supported_device_types);
 
   const DeviceNameUtils::ParsedName& requested_device_name() const {
     return requested_device_name_;
@@ -362,6 +366,12 @@ class ColocationGraph {
 
   Status InitializeMember(const Node& node, Member* member);
 
+  // Returns the device types supported by the kernels registered for `node`,
+  // see SupportedDeviceTypesForNode. Large graphs have many nodes with the
+  // same op and kernel constraint attrs, so the results are cached by them.
+  Status GetSupportedDeviceTypes(
+      const Node& node, PrioritizedDeviceTypeVector* supported_device_types);
+
   // Returns the root node of the disjoint tree to which the node with the
   // given id is connected.
   // FindRoot should be called only for debugging or after the members have
@@ -384,6 +394,14 @@ class ColocationGraph {
   const bool allow_soft_placement_;
   const bool log_device_placement_;
 
+  // Map from op type to the names of the attrs its registered kernels are
+  // constrained on, including the kernel label.
+  absl::flat_hash_map<string, std::vector<string>> kernel_constraint_attrs_;
+  // Map from the op, requested device and kernel constraint attrs of nodes to
+  // their supported device types.
+  absl::flat_hash_map<string, PrioritizedDeviceTypeVector>
+      supported_device_types_;
+
   ColocationGraph(const ColocationGraph&) = delete;
   void operator=(const ColocationGraph&) = delete;
 };
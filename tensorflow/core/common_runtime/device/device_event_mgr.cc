@@ -15,10 +15,14 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/device/device_event_mgr.h"
 
+#include <algorithm>
+#include <cstdint>
 #include <functional>
 #include <memory>
 #include <utility>
+#include <vector>
 
+#include "tensorflow/core/lib/monitoring/sampler.h"
 #include "tensorflow/core/platform/stacktrace.h"
 #include "tensorflow/core/platform/stream_executor.h"
 #include "tensorflow/core/protobuf/config.pb.h"
@@ -33,6 +37,24 @@ namespace {
 //  - Should EventMgrs be shared between devices on a machine with multiple
 //  devices of the same type?
 static const int kNumThreads = 2;
+
+// The polling loop backs off up to this many times polling_active_delay_usecs
+// while the events it waits on don't complete, e.g. behind a long kernel.
+static const int kMaxPollingDelayFactor = 16;
+
+auto* event_completion_latency = monitoring::Sampler<0>::New(
+    {"/tensorflow/core/device_event_mgr/event_completion_latency",
+     "Microseconds between recording an event on a stream and the EventMgr "
+     "finding it completed."},
+    // Power of 2 with bucket count 20 (~1 second).
+    {monitoring::Buckets::Exponential(1, 2, 20)});
+
+// Runs the callbacks of the events of a stream that completed together.
+void RunCallbacks(std::vector<std::function<void()>>& callbacks) {
+  for (std::function<void()>& callback : callbacks) {
+    callback();
+  }
+}
 }  // namespace
 
 namespace device_event_mgr {
@@ -109,8 +131,8 @@ EventMgr::~EventMgr() {
   StopPollingLoop();
 
   for (auto& [stream, stream_callbacks] : callbacks_) {
-    for (auto& [event, callback] : stream_callbacks) {
-      threadpool_.Schedule(std::move(callback));
+    for (PendingCallback& pending : stream_callbacks) {
+      threadpool_.Schedule(std::move(pending.callback));
     }
   }
   // The threadpool's destructor will block waiting for all outstanding
@@ -142,8 +164,14 @@ void EventMgr::StopPollingLoop() {
 // A polling loop to detect completion of device events.
 //
 // While one or more events is outstanding, poll for completed events.  When no
-// events are outstanding, we sleep until one is enqueued.
+// events are outstanding, we sleep until one is enqueued.  The delay between
+// the polls doubles every time a poll finds no completed event and is reset
+// once one does, so that the loop doesn't spin while the device is busy with
+// long kernels but retires the events quickly under a stream of small ones.
 void EventMgr::PollLoop() {
+  const int64_t max_delay_usecs =
+      int64_t{kMaxPollingDelayFactor} * polling_active_delay_usecs_;
+  int64_t delay_usecs = polling_active_delay_usecs_;
   while (true) {
     bool events_still_pending;
     {
@@ -153,13 +181,18 @@ void EventMgr::PollLoop() {
       }
       if (callbacks_.empty()) {
         events_pending_.wait(l);
+        delay_usecs = polling_active_delay_usecs_;
+      }
+      if (PollEvents(/*stream=*/nullptr) > 0) {  // poll all streams
+        delay_usecs = polling_active_delay_usecs_;
+      } else {
+        delay_usecs = std::min(2 * delay_usecs, max_delay_usecs);
       }
-      PollEvents(/*stream=*/nullptr);  // poll all streams
       events_still_pending = !callbacks_.empty();
     }
 
     if (events_still_pending) {
-      Env::Default()->SleepForMicroseconds(polling_active_delay_usecs_);
+      Env::Default()->SleepForMicroseconds(delay_usecs);
     }
   }
   polling_stopped_->Notify();
@@ -180,7 +213,8 @@ void EventMgr::EnqueueCallback(se::Stream* stream, std::function<void()> func) {
   stream->RecordEvent(e.get()).IgnoreError();
 
   bool was_empty = callbacks_.empty();
-  callbacks_[stream].push_back({std::move(e), std::move(func)});
+  callbacks_[stream].push_back(
+      {std::move(e), std::move(func), Env::Default()->NowMicros()});
 
   // Wake up the polling thread if it was sleeping.
   if (was_empty) {
@@ -195,7 +229,7 @@ void EventMgr::EnqueueCallback(se::Stream* stream, std::function<void()> func) {
 // spikes of up to several hundred outstanding.  (If GPUKernelTracker
 // is used to cap pending kernels there should never be more than
 // that many.)
-void EventMgr::PollEvents(se::Stream* stream /*=nullptr*/) {
+int EventMgr::PollEvents(se::Stream* stream /*=nullptr*/) {
   VLOG(2) << "PollEvents with one or more callbacks pending on "
           << callbacks_.size() << " streams and " << free_events_.size()
           << " unused event objects.";
@@ -204,13 +238,18 @@ void EventMgr::PollEvents(se::Stream* stream /*=nullptr*/) {
   //
   // `stream_it` should be an iterator into callbacks_.  Modifies stream_it so
   // it points to the next element of callbacks_.
+  int num_completed = 0;
+  uint64 now_micros = 0;
   auto poll_events_for_stream_it =
       [&](auto& stream_it) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
         auto& stream_callbacks = stream_it->second;
 
+        // The callbacks of the completed events, which are scheduled as one
+        // closure rather than one each.
+        std::vector<std::function<void()>> completed;
         auto it = stream_callbacks.begin();
         while (it != stream_callbacks.end()) {
-          auto& [event, callback] = *it;
+          auto& [event, callback, enqueue_micros] = *it;
 
           se::Event::Status s = event->PollForStatus();
           bool keep_looping = true;
@@ -227,8 +266,14 @@ void EventMgr::PollEvents(se::Stream* stream /*=nullptr*/) {
               keep_looping = false;
               break;
             case se::Event::Status::kComplete:
+              if (now_micros == 0) {
+                now_micros = Env::Default()->NowMicros();
+              }
+              event_completion_latency->GetCell()->Add(
+                  now_micros > enqueue_micros ? now_micros - enqueue_micros
+                                              : 0);
               free_events_.push_back(std::move(event));
-              threadpool_.Schedule(std::move(callback));
+              completed.push_back(std::move(callback));
               // std::deque::erase() does invalidate iterators, so we can't
               // erase `it` here.  Instead, we'll wait until the end of the loop
               // over stream_callbacks and erase all of the completed events at
@@ -245,6 +290,15 @@ void EventMgr::PollEvents(se::Stream* stream /*=nullptr*/) {
         // Erase all completed events from stream_callbacks.
         stream_callbacks.erase(stream_callbacks.begin(), it);
 
+        num_completed += completed.size();
+        if (completed.size() == 1) {
+          threadpool_.Schedule(std::move(completed.front()));
+        } else if (!completed.empty()) {
+          threadpool_.Schedule([completed = std::move(completed)]() mutable {
+            RunCallbacks(completed);
+          });
+        }
+
         if (stream_callbacks.empty()) {
           // absl::flat_hash_map::erase doesn't invalidate iterators, so this is
           // safe.
@@ -266,6 +320,7 @@ void EventMgr::PollEvents(se::Stream* stream /*=nullptr*/) {
       poll_events_for_stream_it(stream_it);
     }
   }
+  return num_completed;
 }
 
 EventMgrFactory* EventMgrFactory::Singleton() {
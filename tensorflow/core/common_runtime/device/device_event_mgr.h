@@ -94,12 +94,15 @@ class EventMgr {
   // to check whether pending events have recorded, and then retire them.
   //
   // If `stream` is not null, we only poll events for that stream.  Otherwise we
-  // poll events for all streams.
-  void PollEvents(se::Stream* stream = nullptr)
+  // poll events for all streams.  The callbacks of the completed events of a
+  // stream are scheduled together, as a single closure.  Returns the number of
+  // completed events.
+  int PollEvents(se::Stream* stream = nullptr)
       TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
   // An internal polling loop that runs at a low frequency to clear straggler
-  // Events.
+  // Events.  The delay between the polls grows while they find no completed
+  // events, up to kMaxPollingDelayFactor times polling_active_delay_usecs_.
   void PollLoop();
 
   // Setup/Teardown functions for the polling loop.
@@ -109,11 +112,17 @@ class EventMgr {
   // A stack of unused events
   std::vector<std::unique_ptr<se::Event>> free_events_ TF_GUARDED_BY(mu_);
 
+  // A callback waiting on its event to complete.
+  struct PendingCallback {
+    std::unique_ptr<se::Event> event;
+    std::function<void()> callback;
+    // When the event was recorded, for the completion latency metric.
+    uint64 enqueue_micros;
+  };
+
   // Callbacks waiting on their events to complete.
-  absl::flat_hash_map<
-      se::Stream*,
-      std::deque<std::pair<std::unique_ptr<se::Event>, std::function<void()>>>>
-      callbacks_ TF_GUARDED_BY(mu_);
+  absl::flat_hash_map<se::Stream*, std::deque<PendingCallback>> callbacks_
+      TF_GUARDED_BY(mu_);
 
   bool stop_polling_ TF_GUARDED_BY(mu_);
   std::unique_ptr<Notification> polling_stopped_;
@@ -18,6 +18,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/device/device_event_mgr.h"
 
 #include <atomic>
+#include <vector>
 
 #include "xla/stream_executor/gpu/gpu_init.h"
 #include "xla/tsl/framework/device_id.h"
@@ -29,6 +30,7 @@ limitations under the License.
 #include "tensorflow/core/framework/node_def_builder.h"
 #include "tensorflow/core/lib/core/notification.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/blocking_counter.h"
 #include "tensorflow/core/platform/stream_executor.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/test_benchmark.h"
@@ -134,6 +136,37 @@ TEST(EventMgr, WarnIfInCallback) {
   note.WaitForNotification();
   EXPECT_TRUE(hit);
 }
+
+// Tests that the callbacks of the events completed together on a stream run
+// in the order they were enqueued.
+TEST(EventMgr, BatchedCallbacksRunInOrder) {
+  auto stream_exec = se::GPUMachineManager()->ExecutorForDevice(0).value();
+  TEST_EventMgr em(stream_exec, GPUOptions());
+  TEST_EventMgrHelper th(&em);
+  TF_ASSERT_OK_AND_ASSIGN(auto stream, stream_exec->CreateStream());
+  constexpr int kNumCallbacks = 100;
+  mutex mu;
+  std::vector<int> order;
+  BlockingCounter counter(kNumCallbacks);
+  for (int i = 0; i < kNumCallbacks; ++i) {
+    em.ThenExecute(stream.get(), [i, &mu, &order, &counter]() {
+      {
+        mutex_lock l(mu);
+        order.push_back(i);
+      }
+      counter.DecrementCount();
+    });
+  }
+  TF_ASSERT_OK(stream->BlockHostUntilDone());
+  th.PollEvents();
+  counter.Wait();
+  EXPECT_EQ(0, th.queue_size());
+  mutex_lock l(mu);
+  ASSERT_EQ(kNumCallbacks, order.size());
+  for (int i = 0; i < kNumCallbacks; ++i) {
+    EXPECT_EQ(i, order[i]);
+  }
+}
 }  // namespace
 
 // Provides access to private resources of BaseGPUDevice.
@@ -17,6 +17,8 @@ limitations under the License.
 
 #include <algorithm>
 #include <atomic>
+#include <cstring>
+#include <numeric>
 #include <string>
 #include <vector>
 
@@ -695,6 +697,15 @@ Status DirectSession::RunInternal(
         new StepStatsCollector(run_metadata->mutable_step_stats()));
     args.stats_collector = run_state.collector.get();
   }
+  // Records the op statistics of the sampled steps when the step ends.
+  std::unique_ptr<OpStatsSampler> op_stats_sampler;
+  const int32_t op_stats_sampling_period =
+      options_.config.experimental().op_stats_sampling_period();
+  if (args.stats_collector == nullptr && op_stats_sampling_period > 0 &&
+      executor_step_count % op_stats_sampling_period == 0) {
+    op_stats_sampler = std::make_unique<OpStatsSampler>();
+    args.stats_collector = op_stats_sampler.get();
+  }
 
   std::unique_ptr<DeviceProfilerSession> device_profiler_session;
   if (run_options.trace_level() >= RunOptions::HARDWARE_TRACE) {
@@ -876,6 +887,12 @@ Status DirectSession::Run(const RunOptions& run_options,
   RunStateArgs run_state_args(run_options.debug_options());
   run_state_args.collective_graph_key =
       run_options.experimental().collective_graph_key();
+  if (options_.config.experimental().max_shape_specializations() > 0) {
+    run_state_args.feed_shapes.reserve(inputs.size());
+    for (const auto& it : inputs) {
+      run_state_args.feed_shapes.push_back(it.second.shape());
+    }
+  }
 
   TF_RETURN_IF_ERROR(GetOrCreateExecutors(input_tensor_names, output_names,
                                           target_nodes, &executors_and_keys,
@@ -1321,6 +1338,7 @@ Status DirectSession::CreateExecutors(
   BuildGraphOptions options;
   options.callable_options = callable_options;
   options.use_function_convention = !run_state_args->is_partial_run;
+  options.feed_shapes = run_state_args->feed_shapes;
   options.collective_graph_key =
       callable_options.run_options().experimental().collective_graph_key();
   if (options_.config.experimental()
@@ -1502,11 +1520,25 @@ Status DirectSession::GetOrCreateExecutors(
         run_state_args->debug_options.debug_tensor_watch_opts());
   }
 
+  // Executors specialized for the feed shapes are cached under the shapes too.
+  if (run_state_args->is_partial_run) {
+    run_state_args->feed_shapes.clear();
+  }
+  const auto join_shapes = [](const std::vector<TensorShape>& shapes) {
+    if (shapes.empty()) return string();
+    return strings::StrCat(
+        "/", absl::StrJoin(shapes, ",",
+                           [](string* out, const TensorShape& shape) {
+                             strings::StrAppend(out, shape.DebugString());
+                           }));
+  };
+
   // Fast lookup path, no sorting.
   const string key = strings::StrCat(
       absl::StrJoin(inputs, ","), "->", absl::StrJoin(outputs, ","), "/",
       absl::StrJoin(target_nodes, ","), "/", run_state_args->is_partial_run,
-      "/", debug_tensor_watches_summary);
+      "/", debug_tensor_watches_summary,
+      join_shapes(run_state_args->feed_shapes));
   // Set the handle, if it's needed to log memory or for partial run.
   if (handle_name_counter_value >= 0) {
     run_state_args->handle =
@@ -1536,10 +1568,24 @@ Status DirectSession::GetOrCreateExecutors(
   std::vector<string> tn_sorted(target_nodes.begin(), target_nodes.end());
   std::sort(tn_sorted.begin(), tn_sorted.end());
 
-  const string sorted_key = strings::StrCat(
+  std::vector<TensorShape> feed_shapes_sorted;
+  if (!run_state_args->feed_shapes.empty()) {
+    std::vector<int> input_order(inputs.size());
+    std::iota(input_order.begin(), input_order.end(), 0);
+    std::sort(input_order.begin(), input_order.end(),
+              [&inputs](int a, int b) { return inputs[a] < inputs[b]; });
+    feed_shapes_sorted.reserve(inputs.size());
+    for (int i : input_order) {
+      feed_shapes_sorted.push_back(run_state_args->feed_shapes[i]);
+    }
+  }
+
+  const string generic_sorted_key = strings::StrCat(
       absl::StrJoin(inputs_sorted, ","), "->",
       absl::StrJoin(outputs_sorted, ","), "/", absl::StrJoin(tn_sorted, ","),
       "/", run_state_args->is_partial_run, "/", debug_tensor_watches_summary);
+  const string sorted_key =
+      strings::StrCat(generic_sorted_key, join_shapes(feed_shapes_sorted));
   // Set the handle, if its needed to log memory or for partial run.
   if (handle_name_counter_value >= 0) {
     run_state_args->handle =
@@ -1556,6 +1602,25 @@ Status DirectSession::GetOrCreateExecutors(
     }
   }
 
+  // Past the maximum number of specializations, fall back to the generic
+  // executors.
+  if (!feed_shapes_sorted.empty()) {
+    bool specialize;
+    {
+      mutex_lock l(executor_lock_);
+      specialize = num_shape_specializations_[generic_sorted_key] <
+                   options_.config.experimental().max_shape_specializations();
+    }
+    if (!specialize) {
+      VLOG(1) << "Not specializing the executors for the feed shapes"
+              << join_shapes(feed_shapes_sorted);
+      run_state_args->feed_shapes.clear();
+      return GetOrCreateExecutors(inputs, outputs, target_nodes,
+                                  executors_and_keys, run_state_args);
+    }
+    run_state_args->feed_shapes = std::move(feed_shapes_sorted);
+  }
+
   // Nothing found, so create the executors and store in the cache.
   // The executor_lock_ is intentionally released while executors are
   // being created.
@@ -1591,6 +1656,9 @@ Status DirectSession::GetOrCreateExecutors(
       sorted_key, std::shared_ptr<ExecutorsAndKeys>(std::move(ek)));
   if (insert_result.second) {
     functions_.push_back(std::move(func_info));
+    if (!run_state_args->feed_shapes.empty()) {
+      ++num_shape_specializations_[generic_sorted_key];
+    }
   }
 
   // Insert the value under the original key, so the fast path lookup will work
@@ -1893,7 +1961,10 @@ class DirectSession::RunCallableCallFrame : public CallFrameInterface {
       : session_(session),
         executors_and_keys_(executors_and_keys),
         feed_tensors_(feed_tensors),
-        fetch_tensors_(fetch_tensors) {}
+        fetch_tensors_(fetch_tensors),
+        fetch_into_bound_tensors_(
+            executors_and_keys->callable_options.fetch_into_bound_tensors() &&
+            executors_and_keys->callable_options.fetch_devices().empty()) {}
 
   size_t num_args() const override {
     return executors_and_keys_->input_types.size();
@@ -1915,15 +1986,30 @@ class DirectSession::RunCallableCallFrame : public CallFrameInterface {
     if (index > fetch_tensors_->size()) {
       return errors::Internal("RetVal index out of bounds: ", index);
     }
-    (*fetch_tensors_)[index] = val;
+    Tensor* fetch = &(*fetch_tensors_)[index];
+    if (fetch_into_bound_tensors_ && IsBoundTo(*fetch, val)) {
+      if (fetch->data() != val.data()) {
+        std::memcpy(fetch->data(), val.data(), val.TotalBytes());
+      }
+      return absl::OkStatus();
+    }
+    *fetch = val;
     return absl::OkStatus();
   }
 
  private:
+  // Returns whether `val` can be written into the caller's tensor `fetch`.
+  static bool IsBoundTo(const Tensor& fetch, const Tensor& val) {
+    return fetch.IsInitialized() && fetch.dtype() == val.dtype() &&
+           DataTypeCanUseMemcpy(val.dtype()) && fetch.shape() == val.shape() &&
+           fetch.RefCountIsOne();
+  }
+
   DirectSession* const session_;                   // Not owned.
   ExecutorsAndKeys* const executors_and_keys_;     // Not owned.
   const std::vector<Tensor>* const feed_tensors_;  // Not owned.
   std::vector<Tensor>* const fetch_tensors_;       // Not owned.
+  const bool fetch_into_bound_tensors_;
 };
 
 ::tensorflow::Status DirectSession::RunCallable(
@@ -176,6 +176,11 @@ class DirectSession : public Session {
     CallableOptions callable_options;
 
     int64_t collective_graph_key = BuildGraphOptions::kNoCollectiveGraphKey;
+    // If not empty, the shapes of the fed tensors, in the order of the inputs
+    // passed to GetOrCreateExecutors(). The executors are then specialized for
+    // these shapes if ConfigProto.Experimental.max_shape_specializations
+    // allows it.
+    std::vector<TensorShape> feed_shapes;
   };
 
   // A FunctionInfo object is created for every unique set of feeds/fetches.
@@ -236,6 +241,11 @@ class DirectSession : public Session {
     std::unique_ptr<Graph> graph;
     const DebugOptions& debug_options;
     int64_t collective_graph_key = BuildGraphOptions::kNoCollectiveGraphKey;
+    // If not empty, the shapes of the fed tensors, in the order of the inputs
+    // passed to GetOrCreateExecutors(). The executors are then specialized for
+    // these shapes if ConfigProto.Experimental.max_shape_specializations
+    // allows it.
+    std::vector<TensorShape> feed_shapes;
   };
 
   // Retrieves an already existing set of executors to run 'inputs' and
@@ -366,6 +376,10 @@ class DirectSession : public Session {
   // same ExecutorsAndKey object.
   std::unordered_map<string, std::shared_ptr<ExecutorsAndKeys>> executors_
       TF_GUARDED_BY(executor_lock_);
+  // The number of executors specialized for feed shapes, keyed by the
+  // signature of the generic executors.
+  std::unordered_map<string, int> num_shape_specializations_
+      TF_GUARDED_BY(executor_lock_);
 
   class RunCallableCallFrame;
   struct Callable {
@@ -30,6 +30,8 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/device_factory.h"
 #include "tensorflow/core/common_runtime/device_mgr.h"
 #include "tensorflow/core/common_runtime/function_testlib.h"
+#include "tensorflow/core/common_runtime/process_state.h"
+#include "tensorflow/core/common_runtime/step_arena_allocator.h"
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/device_factory.h"
 #include "tensorflow/core/framework/graph.pb.h"
@@ -46,6 +48,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/lib/monitoring/cell_reader.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/platform/protobuf.h"
 #include "tensorflow/core/platform/stacktrace.h"
@@ -68,6 +71,8 @@ limitations under the License.
 namespace tensorflow {
 namespace {
 
+using ::tensorflow::monitoring::testing::CellReader;
+
 CallableOptions MakeCallableOptions(absl::Span<const string> feeds,
                                     absl::Span<const string> fetches,
                                     absl::Span<const string> targets) {
@@ -201,6 +206,52 @@ TEST_F(DirectSessionMinusAXTest, RunSimpleNetwork_Callable) {
   }
 }
 
+TEST_F(DirectSessionMinusAXTest, RunSimpleNetwork_CallableBoundFetches) {
+  Initialize({3, 2, -1, 0});
+  auto session = CreateSession();
+  ASSERT_TRUE(session != nullptr);
+  TF_ASSERT_OK(session->Create(def_));
+
+  CallableOptions callable_options =
+      MakeCallableOptions({x_ + ":0"}, {y_ + ":0"}, {});
+  callable_options.set_fetch_into_bound_tensors(true);
+  Session::CallableHandle handle;
+  TF_ASSERT_OK(session->MakeCallable(callable_options, &handle));
+
+  // The fetched values are written into the bound tensor.
+  std::vector<Tensor> outputs = {Tensor(DT_FLOAT, TensorShape({2, 1}))};
+  const void* bound_data = outputs[0].data();
+  Tensor x(DT_FLOAT, TensorShape({2, 1}));
+  test::FillValues<float>(&x, {1, 2});
+  TF_ASSERT_OK(session->RunCallable(handle, {x}, &outputs, nullptr));
+  ASSERT_EQ(1, outputs.size());
+  EXPECT_EQ(bound_data, outputs[0].data());
+  test::ExpectTensorEqual<float>(
+      test::AsTensor<float>({7, -1}, TensorShape({2, 1})), outputs[0]);
+
+  test::FillValues<float>(&x, {2, 0});
+  TF_ASSERT_OK(session->RunCallable(handle, {x}, &outputs, nullptr));
+  EXPECT_EQ(bound_data, outputs[0].data());
+  test::ExpectTensorEqual<float>(
+      test::AsTensor<float>({6, -2}, TensorShape({2, 1})), outputs[0]);
+
+  // A tensor with another shape, or shared with the caller, is replaced.
+  outputs = {Tensor(DT_FLOAT, TensorShape({2}))};
+  TF_ASSERT_OK(session->RunCallable(handle, {x}, &outputs, nullptr));
+  EXPECT_EQ(TensorShape({2, 1}), outputs[0].shape());
+
+  Tensor shared(DT_FLOAT, TensorShape({2, 1}));
+  test::FillValues<float>(&shared, {0, 0});
+  outputs = {shared};
+  TF_ASSERT_OK(session->RunCallable(handle, {x}, &outputs, nullptr));
+  test::ExpectTensorEqual<float>(
+      test::AsTensor<float>({6, -2}, TensorShape({2, 1})), outputs[0]);
+  test::ExpectTensorEqual<float>(
+      test::AsTensor<float>({0, 0}, TensorShape({2, 1})), shared);
+
+  TF_ASSERT_OK(session->ReleaseCallable(handle));
+}
+
 TEST_F(DirectSessionMinusAXTest, RunSimpleNetwork_OptimizeForStaticGraph) {
   Initialize({3, 2, -1, 0});
   SessionOptions options(DefaultSessionOptions());
@@ -739,6 +790,27 @@ TEST_F(DirectSessionMinusAXTest, RunSimpleNetworkWithOpts) {
   EXPECT_EQ(run_metadata.step_stats().dev_stats_size(), 2);
 }
 
+TEST_F(DirectSessionMinusAXTest, SampleOpStats) {
+  Initialize({3, 2, -1, 0});
+  SessionOptions options = DefaultSessionOptions();
+  options.config.mutable_experimental()->set_op_stats_sampling_period(2);
+  std::unique_ptr<Session> session(NewSession(options));
+  ASSERT_TRUE(session != nullptr);
+  TF_ASSERT_OK(session->Create(def_));
+
+  // x is fed, so that the MatMul isn't constant folded.
+  Tensor x(DT_FLOAT, TensorShape({2, 1}));
+  test::FillValues<float>(&x, {1, 1});
+  CellReader<int64_t> op_count("/tensorflow/core/sampled_op_count");
+  for (int i = 0; i < 4; ++i) {
+    std::vector<Tensor> outputs;
+    TF_ASSERT_OK(session->Run({{x_, x}}, {y_ + ":0"}, {}, &outputs));
+    EXPECT_FLOAT_EQ(5.0, outputs[0].matrix<float>()(0, 0));
+  }
+  // One in two steps is sampled.
+  EXPECT_EQ(op_count.Delta("MatMul"), 2);
+}
+
 TEST_F(DirectSessionMinusAXTest, RunSimpleNetworkWithOpts_Callable) {
   Initialize({3, 2, -1, 0});
   auto session = CreateSession();
@@ -838,6 +910,66 @@ TEST(DirectSessionTest, KeepsStateAcrossRunsOfSession) {
   EXPECT_EQ(20.0, outputs[0].flat<float>()(0));
 }
 
+TEST(DirectSessionTest, StepArenaKeepsPersistentTensorsOutOfSlabs) {
+  setenv("TF_CPU_STEP_ARENA_MB", "1", /*overwrite=*/1);
+  constexpr int kNumElements = 64 * 1024;
+  constexpr int kNumSteps = 10;
+  const string device = "/job:localhost/replica:0/task:0/cpu:0";
+
+  GraphDef def;
+  Graph g(OpRegistry::Global());
+  Node* var = test::graph::Var(&g, DT_FLOAT, TensorShape({kNumElements}));
+  var->set_assigned_device_name(device);
+  Tensor ones(DT_FLOAT, TensorShape({kNumElements}));
+  ones.flat<float>().setConstant(1.0);
+  Node* ones_node = test::graph::Constant(&g, ones);
+  ones_node->set_assigned_device_name(device);
+  // The variable keeps the output of `twos` alive for the whole session.
+  Node* twos = test::graph::Binary(&g, "Add", ones_node, ones_node);
+  twos->set_assigned_device_name(device);
+  Node* init = test::graph::Assign(&g, var, twos);
+  init->set_assigned_device_name(device);
+  // `square` is only used within the step; `neg` is fetched and kept alive.
+  Node* square = test::graph::Binary(&g, "Mul", var, var);
+  square->set_assigned_device_name(device);
+  Node* neg = test::graph::Unary(&g, "Neg", square);
+  neg->set_assigned_device_name(device);
+  g.ToGraphDef(&def);
+
+  auto session = CreateSession();
+  ASSERT_TRUE(session != nullptr);
+  TF_ASSERT_OK(session->Create(def));
+
+  StepArenaAllocator* arena = StepArenaAllocator::GetOrCreate(
+      ProcessState::singleton()->GetCPUAllocator(port::kNUMANoAffinity),
+      size_t{1} << 20);
+  const int64_t arena_allocations = arena->num_arena_allocations();
+  const int64_t fallback_allocations = arena->num_fallback_allocations();
+
+  std::vector<Tensor> outputs;
+  TF_ASSERT_OK(session->Run({}, {}, {init->name()}, &outputs));
+  std::vector<Tensor> kept;
+  for (int step = 0; step < kNumSteps; ++step) {
+    TF_ASSERT_OK(session->Run({}, {neg->name() + ":0"}, {}, &outputs));
+    ASSERT_EQ(outputs.size(), 1);
+    kept.push_back(outputs[0]);
+  }
+  unsetenv("TF_CPU_STEP_ARENA_MB");
+
+  // Only `square` is served from the arena, and since neither the variable nor
+  // the fetched outputs pin a slab it never runs out of space.
+  EXPECT_GE(arena->num_arena_allocations() - arena_allocations, kNumSteps);
+  EXPECT_EQ(arena->num_fallback_allocations(), fallback_allocations);
+  for (const Tensor& t : kept) {
+    EXPECT_EQ(t.flat<float>()(0), -4.0);
+    EXPECT_EQ(t.flat<float>()(kNumElements - 1), -4.0);
+  }
+
+  TF_ASSERT_OK(session->Run({}, {var->name() + ":0"}, {}, &outputs));
+  ASSERT_EQ(outputs.size(), 1);
+  EXPECT_EQ(outputs[0].flat<float>()(0), 2.0);
+}
+
 TEST(DirectSessionTest, MultipleFeedTest) {
   GraphDef def;
   Graph g(OpRegistry::Global());
@@ -2358,6 +2490,74 @@ class FakeFactory : public DeviceFactory {
 REGISTER_LOCAL_DEVICE_FACTORY("APU", FakeFactory<'A'>);
 REGISTER_LOCAL_DEVICE_FACTORY("ZPU", FakeFactory<'Z'>);
 
+TEST(DirectSessionTest, SpecializesForFeedShapes) {
+  GraphDef def;
+  QCHECK(protobuf::TextFormat::ParseFromString(R"EOF(
+node {
+  name: "x"
+  op: "Placeholder"
+  attr { key: "dtype" value { type: DT_FLOAT } }
+  attr { key: "shape" value { shape { unknown_rank: true } } }
+}
+node {
+  name: "shape"
+  op: "Shape"
+  input: "x"
+  attr { key: "T" value { type: DT_FLOAT } }
+  attr { key: "out_type" value { type: DT_INT32 } }
+}
+node {
+  name: "y"
+  op: "Identity"
+  input: "shape"
+  attr { key: "T" value { type: DT_INT32 } }
+}
+versions {
+  producer: 26
+}
+  )EOF",
+                                               &def));
+
+  SessionOptions options = DefaultSessionOptions();
+  options.config.mutable_experimental()->set_max_shape_specializations(1);
+  options.config.mutable_graph_options()
+      ->mutable_rewrite_options()
+      ->set_min_graph_nodes(-1);
+  std::unique_ptr<Session> session(NewSession(options));
+  TF_ASSERT_OK(session->Create(def));
+
+  RunOptions run_options;
+  run_options.set_output_partition_graphs(true);
+  const auto runs_shape_op = [](const RunMetadata& run_metadata) {
+    for (const GraphDef& graph : run_metadata.partition_graphs()) {
+      for (const NodeDef& node : graph.node()) {
+        if (node.op() == "Shape") return true;
+      }
+    }
+    return false;
+  };
+
+  // The first shape signature gets specialized executors, in which the shape
+  // is folded.
+  std::vector<Tensor> outputs;
+  RunMetadata run_metadata;
+  TF_ASSERT_OK(session->Run(run_options, {{"x", Tensor(DT_FLOAT, {2, 3})}},
+                            {"y"}, {}, &outputs, &run_metadata));
+  test::ExpectTensorEqual<int32>(outputs[0], test::AsTensor<int32>({2, 3}));
+  EXPECT_FALSE(runs_shape_op(run_metadata));
+
+  // Other signatures use the generic executors.
+  run_metadata.Clear();
+  TF_ASSERT_OK(session->Run(run_options, {{"x", Tensor(DT_FLOAT, {4})}},
+                            {"y"}, {}, &outputs, &run_metadata));
+  test::ExpectTensorEqual<int32>(outputs[0], test::AsTensor<int32>({4}));
+  EXPECT_TRUE(runs_shape_op(run_metadata));
+
+  TF_ASSERT_OK(session->Run({{"x", Tensor(DT_FLOAT, {2, 3})}}, {"y"}, {},
+                            &outputs));
+  test::ExpectTensorEqual<int32>(outputs[0], test::AsTensor<int32>({2, 3}));
+}
+
 TEST(DirectSessionTest, FeedsAndFetchesGoToCpu) {
   auto session = CreateSession();
 
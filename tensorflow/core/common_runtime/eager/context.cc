@@ -623,6 +623,7 @@ EagerContext::~EagerContext() {
   // (executors, thread pool). It's safer to run their destructors early.
   custom_device_op_handler_.Clear();
 
+  operation_pool_->Close();
   ClearCachesAndThreadExecutors();
   std::unordered_map<std::thread::id, EagerExecutor*> executors_copy;
   {
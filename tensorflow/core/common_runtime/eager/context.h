@@ -79,6 +79,8 @@ namespace eager {
 class RemoteMgr;
 }  // namespace eager
 
+class EagerOperation;
+
 // Check the value of the environment variable,
 // `TF_REMOTE_HANDLE_SKIP_WAIT_FOR_READY` from its cached copy in memory and if
 // not cached, reads from the environment variable.
@@ -134,8 +136,33 @@ class EagerContext : public ImmediateExecutionContext, public core::RefCounted {
   ImmediateExecutionTensorHandle* CopyTensorHandleToDevice(
       ImmediateExecutionTensorHandle* handle, const char* device_name,
       Status* status) override;
+  // Returns a pooled EagerOperation released earlier if there is one, or a new
+  // one otherwise.
   ImmediateExecutionOperation* CreateOperation() override;
 
+  // Released EagerOperations that CreateOperation reuses, so that eager ops
+  // don't allocate a new EagerOperation, and its attributes and inputs, each.
+  // The operations created by CreateOperation hold a reference to the pool
+  // instead of the context, so an operation that outlives the context, e.g.
+  // one cached by another thread, does not keep the context alive.
+  class OperationPool : public core::RefCounted {
+   public:
+    // Returns a released operation, or nullptr if there is none.
+    EagerOperation* Get();
+    // Keeps the cleared `op` for reuse. Returns false, leaving `op` to the
+    // caller, if the pool is full or closed.
+    bool Put(EagerOperation* op);
+    // Deletes the pooled operations. The operations released afterwards are
+    // not pooled. Called when the context is destroyed.
+    void Close();
+
+   private:
+    static constexpr size_t kMaxPooledOperations = 64;
+    mutex mu_;
+    bool closed_ TF_GUARDED_BY(mu_) = false;
+    std::vector<EagerOperation*> operations_ TF_GUARDED_BY(mu_);
+  };
+
   // This is a virtual helper function to convert TFRT TensorHandle to
   // tensorflow::TensorHandle. In current runtime EagerContext, just forward
   // the input since the input tensor handle is already a
@@ -799,6 +826,9 @@ class EagerContext : public ImmediateExecutionContext, public core::RefCounted {
   std::unique_ptr<ScopedStepContainer> step_container_
       TF_GUARDED_BY(metadata_mu_);
 
+  // Shared with the operations created by CreateOperation.
+  const core::RefCountPtr<OperationPool> operation_pool_{new OperationPool};
+
   EagerExecutor default_executor_;
   mutable mutex executor_map_mu_;
   // Not owned.
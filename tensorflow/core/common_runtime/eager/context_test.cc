@@ -35,6 +35,8 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/monitoring/cell_reader.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/refcount.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/test.h"
@@ -357,6 +359,56 @@ TEST_F(EagerContextTest, XlaCompileDeviceType) {
   retvals[0] = nullptr;
 }
 
+TEST_F(EagerContextTest, ReusesReleasedOperations) {
+  InitContext(SessionOptions(), DEVICE_PLACEMENT_EXPLICIT);
+  monitoring::testing::CellReader<int64_t> pool_counter(
+      "/tensorflow/core/eager_operation_pool");
+
+  ImmediateExecutionOperation* op = context()->CreateOperation();
+  TF_ASSERT_OK(
+      op->Reset("Mul", "/job:localhost/replica:0/task:0/device:CPU:0"));
+  Tensor tensor = test::AsScalar<int64_t>(3);
+  auto input = core::RefCountPtr<ImmediateExecutionTensorHandle>(
+      context()->CreateLocalHandleFromTFTensor(
+          tensor, context()->HostCPUName().c_str()));
+  TF_ASSERT_OK(op->AddInput(input.get()));
+  TF_ASSERT_OK(op->AddInput(input.get()));
+  EXPECT_EQ(input->RefCount(), 3);
+  op->Release();
+  // The released operation no longer holds its inputs.
+  EXPECT_EQ(input->RefCount(), 1);
+
+  auto reused_op = ImmediateOpPtr(context()->CreateOperation());
+  EXPECT_EQ(reused_op.get(), op);
+  EXPECT_TRUE(reused_op->GetInputs().empty());
+  TF_ASSERT_OK(reused_op->Reset("Identity", nullptr));
+  EXPECT_EQ(reused_op->Name(), "Identity");
+  EXPECT_EQ(pool_counter.Delta("miss"), 1);
+  EXPECT_EQ(pool_counter.Delta("hit"), 1);
+}
+
+TEST_F(EagerContextTest, OperationCachedOnAnotherThreadOutlivesContext) {
+  InitContext(SessionOptions(), DEVICE_PLACEMENT_EXPLICIT);
+  // Python caches an operation per context and thread, and only releases it
+  // when the thread exits.
+  ImmediateExecutionOperation* op = nullptr;
+  std::unique_ptr<Thread> thread(Env::Default()->StartThread(
+      ThreadOptions(), "create_operation", [this, &op]() {
+        op = context()->CreateOperation();
+        TF_ASSERT_OK(op->Reset("Identity", nullptr));
+      }));
+  thread.reset();
+  ASSERT_NE(op, nullptr);
+  // The cached operation does not keep the context alive.
+  EXPECT_EQ(context()->RefCount(), 1);
+  context_.reset();
+
+  // Deletes the operation rather than returning it to the destroyed context.
+  thread.reset(Env::Default()->StartThread(ThreadOptions(), "release_operation",
+                                           [op]() { op->Release(); }));
+  thread.reset();
+}
+
 TEST_F(EagerContextTest, LocalRendezvousCreation) {
   InitContext(SessionOptions(), DEVICE_PLACEMENT_EXPLICIT);
   auto rendezvous_creator = context()->RendezvousFactory();
@@ -23,7 +23,9 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/eager/execute.h"
 #include "tensorflow/core/common_runtime/eager/placement_utils.h"
 #include "tensorflow/core/common_runtime/eager/tensor_handle.h"
+#include "tensorflow/core/lib/monitoring/counter.h"
 #include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/mutex.h"
 
 namespace {
 
@@ -31,6 +33,12 @@ bool IsCPU(tensorflow::Device* d) {
   return d == nullptr || d->tensorflow_accelerator_device_info() == nullptr;
 }
 
+auto* eager_operation_pool_counter = tensorflow::monitoring::Counter<1>::New(
+    "/tensorflow/core/eager_operation_pool",
+    "The number of EagerOperations created, by whether a pooled one was "
+    "reused (hit) or a new one was allocated (miss).",
+    "result");
+
 }  // namespace
 
 namespace tensorflow {
@@ -150,7 +158,45 @@ ImmediateExecutionTensorHandle* EagerContext::CreateLocalHandleFromTFTensor(
 // depends on EagerContext. Thus, the context build target can't depend on
 // EagerOperation.
 ImmediateExecutionOperation* EagerContext::CreateOperation() {
-  return new EagerOperation(this);
+  static auto* const hits = eager_operation_pool_counter->GetCell("hit");
+  static auto* const misses = eager_operation_pool_counter->GetCell("miss");
+  if (EagerOperation* op = operation_pool_->Get()) {
+    hits->IncrementBy(1);
+    return op;
+  }
+  misses->IncrementBy(1);
+  auto* op = new EagerOperation(this);
+  op->pool_ = operation_pool_.GetNewRef();
+  return op;
+}
+
+EagerOperation* EagerContext::OperationPool::Get() {
+  mutex_lock l(mu_);
+  if (operations_.empty()) return nullptr;
+  EagerOperation* op = operations_.back();
+  operations_.pop_back();
+  return op;
+}
+
+bool EagerContext::OperationPool::Put(EagerOperation* op) {
+  mutex_lock l(mu_);
+  if (closed_ || operations_.size() >= kMaxPooledOperations) return false;
+  operations_.push_back(op);
+  return true;
+}
+
+void EagerContext::OperationPool::Close() {
+  std::vector<EagerOperation*> operations;
+  {
+    mutex_lock l(mu_);
+    closed_ = true;
+    operations.swap(operations_);
+  }
+  // Each pooled operation holds a reference to this pool, which the caller
+  // keeps alive.
+  for (EagerOperation* op : operations) {
+    delete op;
+  }
 }
 
 // TODO(b/152902651): Once we move many execute.cc functions into
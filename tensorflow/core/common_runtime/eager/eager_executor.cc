@@ -15,10 +15,13 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/eager/eager_executor.h"
 
+#include <algorithm>
+#include <cstdint>
 #include <forward_list>
 #include <functional>
 #include <memory>
 #include <utility>
+#include <vector>
 
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/gtl/cleanup.h"
@@ -32,6 +35,13 @@ bool IsAsyncWaitForRemoteFunctionEnabled() {
                                  true, &enabled));
   return enabled;
 }
+
+int64_t MaxBatchSize() {
+  int64_t max_batch_size;
+  TF_CHECK_OK(ReadInt64FromEnvVar("TF_EAGER_ASYNC_MAX_BATCH_SIZE", 64,
+                                  &max_batch_size));
+  return std::max<int64_t>(max_batch_size, 1);
+}
 }  // namespace
 
 EagerExecutor::EagerExecutor(bool async, bool enable_streaming_enqueue,
@@ -46,7 +56,8 @@ EagerExecutor::EagerExecutor(bool async, bool enable_streaming_enqueue,
       enable_async_wait_for_remote_function_(
           IsAsyncWaitForRemoteFunctionEnabled()),
       enable_streaming_enqueue_(enable_streaming_enqueue),
-      in_flight_nodes_limit_(in_flight_nodes_limit) {
+      in_flight_nodes_limit_(in_flight_nodes_limit),
+      max_batch_size_(MaxBatchSize()) {
   if (async && in_flight_nodes_limit_ > 0) {
     VLOG(4) << "EagerExecutor InFlightNodes limit is set to "
             << in_flight_nodes_limit_;
@@ -160,7 +171,7 @@ Status EagerExecutor::AddOrExecute(std::unique_ptr<EagerNode> node) {
     } else {
       status = status_;
       if (status.ok()) {
-        node_queue_.push(std::move(item));
+        node_queue_.push_back(std::move(item));
         // If there were no previous nodes pending, wake the run thread to
         // start processing requests again.
         if (node_queue_.size() == 1) {
@@ -256,7 +267,7 @@ void EagerExecutor::NodeDone(const core::RefCountPtr<NodeItem>& item,
     if (from_queue) {
       // Since this was from the async queue, pop it from the front of the queue
       DCHECK(!node_queue_.empty() && item.get() == node_queue_.front().get());
-      node_queue_.pop();
+      node_queue_.pop_front();
     } else if (async) {
       // If it is an Async node then we will find the node in the unfinished
       // nodes list. However we only notify if we are at the front of the list
@@ -290,7 +301,7 @@ void EagerExecutor::NodeDone(const core::RefCountPtr<NodeItem>& item,
       }
       while (!node_queue_.empty()) {
         items_to_destroy.push_front(std::move(node_queue_.front()));
-        node_queue_.pop();
+        node_queue_.pop_front();
       }
       for (auto& it : unfinished_nodes_) {
         items_to_destroy.push_front(std::move(it.second));
@@ -348,30 +359,82 @@ void EagerExecutor::Run() {
   auto thread_exited_notifier =
       gtl::MakeCleanup([this] { thread_exited_notification_.Notify(); });
   while (true) {
-    core::RefCountPtr<NodeItem> curr_item;
+    std::vector<core::RefCountPtr<NodeItem>> items;
     {
       tensorflow::mutex_lock l(node_queue_mutex_);
       while (node_queue_.empty() || !status_.ok()) {
         if (state_ == ExecutorState::kShutDown) return;
         nodes_pending_.wait(l);
       }
-      // Obtain raw pointer since we don't want to remove from the queue until
-      // the node has been run. Otherwise, WaitForAllPendingNodes can return
+      // Obtain raw pointers since we don't want to remove from the queue until
+      // the nodes have been run. Otherwise, WaitForAllPendingNodes can return
       // too early.
       // Note, we don't std::move from the here because the front of the queue
       // will then contain a nullptr. This can be a problem in
       // WaitForAllPendingNodes where we get the top EagerNode pointer
       // and register a notification for its completion.
-      curr_item.reset(node_queue_.front().get());
-      curr_item->Ref();
+      // Async nodes are moved to unfinished_nodes_ when they are scheduled, so
+      // they are always run on their own.
+      for (const auto& item : node_queue_) {
+        const bool async = item->node->AsAsync() != nullptr;
+        if (!items.empty() &&
+            (async || items.size() >= static_cast<size_t>(max_batch_size_))) {
+          break;
+        }
+        item->Ref();
+        items.emplace_back(item.get());
+        if (async) break;
+      }
     }
-    Status status = RunItem(std::move(curr_item), /*from_queue=*/true);
+    if (items.size() > 1) {
+      RunBatch(std::move(items));
+      continue;
+    }
+    Status status = RunItem(std::move(items.front()), /*from_queue=*/true);
     if (!status.ok()) {
       VLOG(1) << "Failed to run item: " << status;
     }
   }
 }
 
+void EagerExecutor::RunBatch(std::vector<core::RefCountPtr<NodeItem>> items) {
+  size_t num_done = 0;
+  Status status;
+  for (; num_done < items.size(); ++num_done) {
+    // If an async node failed meanwhile the rest of the items were aborted.
+    if (!ok()) return;
+    const core::RefCountPtr<NodeItem>& item = items[num_done];
+    DVLOG(3) << "Running Node: [id " << item->id << "] "
+             << item->node->DebugString();
+    status = item->node->Run();
+    if (!status.ok()) break;
+  }
+  if (num_done > 0) {
+    BatchDone(absl::MakeConstSpan(items.data(), num_done));
+  }
+  if (!status.ok()) {
+    VLOG(1) << "Failed to run item: " << status;
+    NodeDone(items[num_done], status, /*from_queue=*/true);
+  }
+}
+
+void EagerExecutor::BatchDone(
+    absl::Span<const core::RefCountPtr<NodeItem>> items) {
+  DVLOG(3) << "Nodes Done: [id " << items.front()->id << " to "
+           << items.back()->id << "]";
+  mutex_lock l(node_queue_mutex_);
+  if (!status_.ok()) return;
+  for (const core::RefCountPtr<NodeItem>& item : items) {
+    DCHECK(!node_queue_.empty() && item.get() == node_queue_.front().get());
+    DCHECK(item->state != NodeState::kDONE);
+    item->state = NodeState::kDONE;
+    node_queue_.pop_front();
+  }
+  NotifyWaiters(items.front()->id);
+  // Notify AddOrExecute() some nodes have been done.
+  nodes_done_.notify_all();
+}
+
 Status EagerExecutor::RunItem(core::RefCountPtr<NodeItem> item,
                               bool from_queue) {
   DVLOG(3) << "Running Node: [id " << item->id << "] "
@@ -434,7 +497,7 @@ Status EagerExecutor::MoveToUnfinished(core::RefCountPtr<NodeItem> item,
 
   if (from_queue) {
     DCHECK(!node_queue_.empty() && item.get() == node_queue_.front().get());
-    node_queue_.pop();
+    node_queue_.pop_front();
   }
 
   DVLOG(3) << "Add Node: [id " << item->id << "] to unfinished map.";
@@ -18,15 +18,16 @@ limitations under the License.
 #include <algorithm>
 #include <atomic>
 #include <cstddef>
+#include <deque>
 #include <functional>
 #include <map>
 #include <memory>
-#include <queue>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/types/span.h"
 #include "tensorflow/core/common_runtime/device_factory.h"
 #include "tensorflow/core/common_runtime/function.h"
 #include "tensorflow/core/common_runtime/rendezvous_mgr.h"
@@ -202,14 +203,22 @@ class EagerExecutor {
 
   void NodeDone(const core::RefCountPtr<NodeItem>& item, const Status& status,
                 bool from_queue);
+  // Like NodeDone for `items`, the successfully run synchronous items at the
+  // front of the queue, but takes node_queue_mutex_ only once.
+  void BatchDone(absl::Span<const core::RefCountPtr<NodeItem>> items);
   void NotifyWaiters(uint64 id) TF_EXCLUSIVE_LOCKS_REQUIRED(node_queue_mutex_);
 
   // Starts execution of pending EagerNodes. This function loops till executor
   // state_ is set to kShutDown. If any errors are encountered, these are set
   // inside `status_`. The loop blocks anytime there are no pending nodes, or if
-  // `status_` is not ok.
+  // `status_` is not ok. Consecutive synchronous nodes at the front of the
+  // queue are taken and run as one batch, up to `max_batch_size_` at a time.
   void Run();
 
+  // Runs `items`, consecutive synchronous items at the front of the queue, in
+  // order, stopping at the first failure.
+  void RunBatch(std::vector<core::RefCountPtr<NodeItem>> items);
+
   Status RunItem(core::RefCountPtr<NodeItem> item, bool from_queue);
   Status MoveToUnfinished(core::RefCountPtr<NodeItem> item, bool from_queue);
 
@@ -230,7 +239,7 @@ class EagerExecutor {
   condition_variable nodes_done_ TF_GUARDED_BY(node_queue_mutex_);
 
   // Queue of pending NodeItems. Ordered by NodeItem::id.
-  std::queue<core::RefCountPtr<NodeItem>> node_queue_
+  std::deque<core::RefCountPtr<NodeItem>> node_queue_
       TF_GUARDED_BY(node_queue_mutex_);
 
   // Ordered by NodeItem::id.
@@ -277,6 +286,10 @@ class EagerExecutor {
   // async nodes reach this number, enqueuing to the eager async queue is
   // blocked.
   const int64_t in_flight_nodes_limit_;
+
+  // Maximum number of synchronous nodes the executor thread takes from the
+  // queue at a time in async mode.
+  const int64_t max_batch_size_;
 };
 
 inline bool EagerExecutor::Async() const { return thread_ != nullptr; }
@@ -16,6 +16,7 @@ limitations under the License.
 
 #include <memory>
 #include <utility>
+#include <vector>
 
 #include "xla/tsl/lib/core/status_test_util.h"
 #include "tensorflow/core/platform/status.h"
@@ -213,6 +214,55 @@ TEST(EagerExecutorTest, TestAsyncExecutorWithEagerNode) {
   ASSERT_EQ(state->read_state(), TestState::State::kSuccess);
 }
 
+TEST(EagerExecutorTest, TestAsyncExecutorWithManyEagerNodes) {
+  auto async_executor = std::make_unique<EagerExecutor>(
+      /*async=*/true, /*enable_streaming_enqueue=*/true);
+
+  std::vector<std::unique_ptr<TestState>> states(200);
+  for (int i = 0; i < states.size(); ++i) {
+    states[i] = std::make_unique<TestState>();
+    if (i % 50 == 0) {
+      TF_ASSERT_OK(async_executor->AddOrExecute(
+          std::make_unique<TestAsyncEagerNode>(states[i].get())));
+    } else {
+      TF_ASSERT_OK(async_executor->AddOrExecute(
+          std::make_unique<TestEagerNode>(states[i].get())));
+    }
+  }
+  TF_ASSERT_OK(async_executor->WaitForAllPendingNodes());
+  for (const auto& state : states) {
+    ASSERT_EQ(state->read_state(), TestState::State::kSuccess);
+  }
+}
+
+TEST(EagerExecutorTest, TestAsyncExecutorFailRunWithManyEagerNodes) {
+  auto async_executor = std::make_unique<EagerExecutor>(
+      /*async=*/true, /*enable_streaming_enqueue=*/true);
+
+  std::vector<std::unique_ptr<TestState>> states(10);
+  for (int i = 0; i < states.size(); ++i) {
+    states[i] = std::make_unique<TestState>();
+    // The nodes added after the failure may be rejected, depending on whether
+    // the failing node has already run.
+    async_executor
+        ->AddOrExecute(std::make_unique<TestEagerNode>(
+            states[i].get(), absl::OkStatus(),
+            i == 5 ? errors::Internal("test") : absl::OkStatus()))
+        .IgnoreError();
+  }
+  ASSERT_EQ(async_executor->WaitForAllPendingNodes().code(),
+            tensorflow::error::INTERNAL);
+  for (int i = 0; i < states.size(); ++i) {
+    if (i < 5) {
+      EXPECT_EQ(states[i]->read_state(), TestState::State::kSuccess);
+    } else if (i == 5) {
+      EXPECT_EQ(states[i]->read_state(), TestState::State::kFailure);
+    } else {
+      EXPECT_EQ(states[i]->read_state(), TestState::State::kNotRun);
+    }
+  }
+}
+
 TEST(EagerExecutorTest, TestAsyncExecutorFailPrepare) {
   auto async_executor = std::make_unique<EagerExecutor>(
       /*async=*/true, /*enable_streaming_enqueue=*/true);
@@ -48,6 +48,18 @@ void EagerOperation::Clear() {
   ClearInferenceState();
 }
 
+void EagerOperation::Release() {
+  if (pool_ != nullptr) {
+    Clear();
+    // Reset() only overwrites the function params when new ones are given, so
+    // they must not leak into the next user of the pooled operation.
+    eager_func_params_.reset();
+    // Once pooled, this may be reused by another thread right away.
+    if (pool_->Put(this)) return;
+  }
+  delete this;
+}
+
 Status EagerOperation::SetAttrValue(const char* attr_name,
                                     const AttrValue& value) {
   MutableAttrs()->Set(attr_name, value);
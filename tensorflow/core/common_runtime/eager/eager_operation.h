@@ -50,7 +50,10 @@ class EagerOperation : public ImmediateExecutionOperation {
     }
   }
 
-  void Release() override { delete this; }
+  // Returns this to the pool of the context if it was created by
+  // EagerContext::CreateOperation and the context is alive, or deletes it
+  // otherwise.
+  void Release() override;
 
   void Clear() override;
   Status Reset(const char* op, const char* raw_device_name) override {
@@ -270,7 +273,12 @@ class EagerOperation : public ImmediateExecutionOperation {
   void InferMixedTypeInputListAttrs(const OpDef::ArgDef& input_def,
                                     const std::vector<DataType>& dtypes);
 
+  friend class EagerContext;  // Sets `pool_`.
+
   tensorflow::EagerContext& ctx_;
+  // The pool of `ctx_` if this was created by EagerContext::CreateOperation,
+  // which Release() returns this to.
+  core::RefCountPtr<EagerContext::OperationPool> pool_;
   const char* op_name_ = nullptr;
   AttrBuilder attrs_;
   const AttrTypeMap* attr_types_;
@@ -18,6 +18,7 @@ limitations under the License.
 #include <algorithm>
 #include <cstddef>
 #include <functional>
+#include <limits>
 #include <memory>
 #include <optional>
 #include <queue>
@@ -67,6 +68,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/eager/copy_to_device_node.h"
 #include "tensorflow/core/common_runtime/eager/execute_node.h"
 #include "tensorflow/core/common_runtime/eager/kernel_and_device.h"
+#include "tensorflow/core/common_runtime/eager/placement_utils.h"
 #include "tensorflow/core/common_runtime/eager/tensor_handle.h"
 #include "tensorflow/core/framework/dataset.h"
 #include "tensorflow/core/framework/function.h"
@@ -2234,6 +2236,142 @@ Status EagerExecute(EagerOperation* op, TensorHandle** retvals,
   return DoEagerExecute(op, retvals, num_retvals);
 }
 
+Status ResolvedEagerOp::Create(EagerOperation* op,
+                               std::unique_ptr<ResolvedEagerOp>* resolved_op) {
+  EagerContext& ctx = op->EagerContext();
+  TF_RETURN_IF_ERROR(op->Executor().status());
+  if (!op->IsLocal() || op->is_function() || op->Executor().Async() ||
+      ctx.RunEagerOpAsFunction() ||
+      std::holds_alternative<CustomDevice*>(op->Device())) {
+    return errors::Unimplemented(
+        "Only local primitive ops executed synchronously can be resolved, "
+        "but got ",
+        op->Name());
+  }
+  for (ImmediateExecutionTensorHandle* handle : op->GetInputs()) {
+    if (!TensorHandle::classof(handle) ||
+        down_cast<TensorHandle*>(handle)->Type() == TensorHandle::PACKED) {
+      return errors::Unimplemented(
+          "Only ops with local inputs can be resolved, but got ", op->Name());
+    }
+    TF_RETURN_IF_ERROR(down_cast<TensorHandle*>(handle)->WaitUnknownDevice());
+  }
+
+  // Same placement as EagerOperation::Execute.
+  Device* device = std::get<Device*>(op->Device());
+  if (device == nullptr) {
+    TF_RETURN_IF_ERROR(eager::MaybePinToResourceDevice(&device, *op));
+  }
+  if (device == nullptr && ctx.PinSmallOpsToCPU()) {
+    bool pin_to_cpu;
+    TF_RETURN_IF_ERROR(eager::MaybePinSmallOpsToCpu(
+        &pin_to_cpu, op->Name(), op->GetInputs(), ctx.HostCPU()->name()));
+    if (pin_to_cpu) device = ctx.HostCPU();
+  }
+  if (device != nullptr) op->SetDevice(device);
+
+  // Ops that are rewritten run as other ops, which are not resolved.
+  std::unique_ptr<EagerOperation> out_op;
+  TF_RETURN_IF_ERROR(EagerOpRewriteRegistry::Global()->RunRewrite(
+      EagerOpRewriteRegistry::PRE_EXECUTION, op, &out_op));
+  if (out_op == nullptr) {
+    TF_RETURN_IF_ERROR(MaybePackInputTensor(op));
+  }
+  core::RefCountPtr<KernelAndDevice> kernel;
+  int num_outputs = std::numeric_limits<int>::max();
+  if (out_op == nullptr) {
+    TF_RETURN_IF_ERROR(
+        GetOrCreateKernelAndDevice(op, nullptr, &num_outputs, &kernel));
+    TF_RETURN_IF_ERROR(EagerOpRewriteRegistry::Global()->RunRewrite(
+        EagerOpRewriteRegistry::POST_PLACEMENT, op, &out_op));
+  }
+  if (out_op != nullptr) {
+    return errors::Unimplemented("Rewritten ops can not be resolved, but got ",
+                                 op->Name());
+  }
+  const int num_inputs = op->Inputs().size();
+  if (kernel->num_inputs() != num_inputs) {
+    return errors::InvalidArgument("expected ", kernel->num_inputs(),
+                                   " inputs, got ", num_inputs);
+  }
+
+  resolved_op->reset(new ResolvedEagerOp(&ctx, op->Name(), std::move(kernel)));
+  return absl::OkStatus();
+}
+
+Status ResolvedEagerOp::Execute(absl::Span<TensorHandle* const> inputs,
+                                TensorHandle** retvals, int* num_retvals) {
+  tsl::profiler::TraceMe activity(
+      [&] { return absl::StrCat("ResolvedEagerOp::Execute: ", name_); },
+      tsl::profiler::TraceMeLevel::kInfo);
+  const int num_outputs = kernel_->num_outputs();
+  if (num_outputs > *num_retvals) {
+    return errors::InvalidArgument("Expecting ", num_outputs,
+                                   " outputs, but *num_retvals is ",
+                                   *num_retvals);
+  }
+  const int num_inputs = inputs.size();
+  if (num_inputs != kernel_->num_inputs()) {
+    return errors::InvalidArgument("expected ", kernel_->num_inputs(),
+                                   " inputs, got ", num_inputs);
+  }
+  for (int i = 0; i < num_inputs; ++i) {
+    TensorHandle* handle = inputs[i];
+    TF_RETURN_IF_ERROR(handle->WaitUnknownDevice());
+    if (handle->dtype != kernel_->input_dtypes()[i]) {
+      return errors::InvalidArgument(
+          "cannot compute ", name_, " as input #", i, "(zero-based)",
+          " was expected to be a ",
+          DataTypeString(kernel_->input_dtypes()[i]), " tensor but is a ",
+          DataTypeString(handle->dtype), " tensor");
+    }
+    Device* handle_device = handle->DeviceOrHostCPU(*ctx_);
+    if (handle->Type() == TensorHandle::PACKED ||
+        handle_device != kernel_->InputDevice(i)) {
+      return errors::InvalidArgument(
+          "cannot compute ", name_, " as input #", i, "(zero-based)",
+          " was resolved to be on ",
+          DeviceNameOrUnspecified(kernel_->InputDevice(i)),
+          " but is actually on ", DeviceNameOrUnspecified(handle_device));
+    }
+  }
+
+  EagerExecutor& executor = ctx_->Executor();
+  if (executor.Async()) {
+    return errors::Unimplemented(
+        "Resolved ops can not be executed asynchronously: ", name_);
+  }
+  // In sync mode, always clear error to maintain the same behavior as
+  // EagerExecute.
+  executor.ClearError();
+  GraphCollector* graph_collector = nullptr;
+  if (ctx_->ShouldStoreGraphs()) {
+    graph_collector = ctx_->GetGraphCollector();
+  }
+  for (int i = 0; i < num_outputs; ++i) {
+    retvals[i] = nullptr;
+  }
+  const absl::InlinedVector<TensorHandle*, 4> op_inputs(inputs.begin(),
+                                                         inputs.end());
+  const std::optional<EagerFunctionParams> eager_func_params;
+  ExecuteNode node(ctx_, op_inputs, eager_func_params, kernel_,
+                   graph_collector, /*cancellation_manager=*/nullptr,
+                   {retvals, static_cast<size_t>(num_outputs)},
+                   /*stack_trace=*/std::nullopt);
+  Status s = executor.SyncExecute(&node);
+  if (!s.ok()) {
+    for (int i = 0; i < num_outputs; ++i) {
+      if (retvals[i] != nullptr) {
+        retvals[i]->Unref();
+        retvals[i] = nullptr;
+      }
+    }
+    return s;
+  }
+  *num_retvals = num_outputs;
+  return absl::OkStatus();
+}
+
 namespace {
 
 Status LocalEagerCopyToDevice(TensorHandle* h, EagerContext* ctx,
@@ -15,6 +15,9 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_COMMON_RUNTIME_EAGER_EXECUTE_H_
 #define TENSORFLOW_CORE_COMMON_RUNTIME_EAGER_EXECUTE_H_
 
+#include <memory>
+#include <utility>
+
 #include "absl/container/inlined_vector.h"
 #include "absl/types/span.h"
 #include "tensorflow/core/common_runtime/device.h"
@@ -85,6 +88,41 @@ Status EagerCopyToDevice(TensorHandle* h, EagerContext* ctx,
 void EagerLocalExecuteAsync(EagerOperation* op, TensorHandle** retvals,
                             int* num_retvals, StatusCallback done);
 
+// A local primitive op bound once to its kernel, device and input devices, for
+// call sites that execute the same op with the same attributes on inputs from
+// the same devices repeatedly. Executing it skips the attribute fingerprinting,
+// kernel cache lookup, placement and rewrites of EagerExecute.
+//
+// Only supports synchronous execution. Must not outlive the EagerContext.
+class ResolvedEagerOp {
+ public:
+  // Places `op` and resolves its kernel as EagerExecute would for its current
+  // inputs and attributes, without executing it. Returns Unimplemented for ops
+  // that need remote, asynchronous, function or custom device execution.
+  static Status Create(EagerOperation* op,
+                       std::unique_ptr<ResolvedEagerOp>* resolved_op);
+
+  // Executes the op with `inputs`, which must have the types and be on the
+  // devices the op was resolved for; nothing is copied. 'retvals' and
+  // '*num_retvals' are handled as in EagerExecute.
+  Status Execute(absl::Span<TensorHandle* const> inputs,
+                 TensorHandle** retvals, int* num_retvals);
+
+  const string& name() const { return name_; }
+  int num_inputs() const { return kernel_->num_inputs(); }
+  int num_outputs() const { return kernel_->num_outputs(); }
+  Device* device() const { return kernel_->device(); }
+
+ private:
+  ResolvedEagerOp(EagerContext* ctx, const string& name,
+                  core::RefCountPtr<KernelAndDevice> kernel)
+      : ctx_(ctx), name_(name), kernel_(std::move(kernel)) {}
+
+  EagerContext* const ctx_;
+  const string name_;
+  const core::RefCountPtr<KernelAndDevice> kernel_;
+};
+
 }  // namespace tensorflow
 
 #endif  // TENSORFLOW_CORE_COMMON_RUNTIME_EAGER_EXECUTE_H_
@@ -428,5 +428,64 @@ TEST(ExecuteTest, MultipleNestedCompiledFunction) {
   ctx->Unref();
 }
 
+TEST(ExecuteTest, ResolvedEagerOp) {
+  StaticDeviceMgr device_mgr(
+      DeviceFactory::NewDevice("CPU", {}, "/job:localhost/replica:0/task:0"));
+  auto ctx = new EagerContext(
+      SessionOptions(),
+      tensorflow::ContextDevicePlacementPolicy::DEVICE_PLACEMENT_EXPLICIT,
+      false, &device_mgr, false, nullptr, nullptr);
+
+  const auto create_handle = [&](Tensor tensor) {
+    return core::RefCountPtr<TensorHandle>(TensorHandleFromInterface(
+        ctx->CreateLocalHandleFromTFTensor(tensor,
+                                           ctx->HostCPUName().c_str())));
+  };
+  auto x = create_handle(test::AsScalar<int64_t>(3));
+  auto y = create_handle(test::AsScalar<int64_t>(2));
+
+  auto op = std::make_unique<EagerOperation>(ctx);
+  TF_ASSERT_OK(op->Reset(/*op=*/"Mul", /*raw_device_name=*/nullptr));
+  TF_ASSERT_OK(op->AddInput(x.get()));
+  TF_ASSERT_OK(op->AddInput(y.get()));
+  std::unique_ptr<ResolvedEagerOp> resolved_op;
+  TF_ASSERT_OK(ResolvedEagerOp::Create(op.get(), &resolved_op));
+  op.reset();
+  EXPECT_EQ(resolved_op->num_inputs(), 2);
+  EXPECT_EQ(resolved_op->num_outputs(), 1);
+  EXPECT_EQ(resolved_op->device(), ctx->HostCPU());
+
+  // The resolved op can be executed repeatedly with different inputs.
+  for (int64_t value : {1, 4}) {
+    auto z = create_handle(test::AsScalar<int64_t>(value));
+    std::vector<TensorHandle*> retvals(1);
+    int num_retvals = retvals.size();
+    std::vector<TensorHandle*> inputs = {x.get(), z.get()};
+    TF_ASSERT_OK(resolved_op->Execute(inputs, retvals.data(), &num_retvals));
+    ASSERT_EQ(num_retvals, 1);
+    const Tensor* result;
+    TF_ASSERT_OK(retvals[0]->Tensor(&result));
+    test::ExpectTensorEqual<int64_t>(*result,
+                                     test::AsScalar<int64_t>(3 * value));
+    retvals[0]->Unref();
+  }
+
+  // Inputs must have the resolved types.
+  auto f = create_handle(test::AsScalar<float>(1.0));
+  std::vector<TensorHandle*> retvals(1);
+  int num_retvals = retvals.size();
+  std::vector<TensorHandle*> inputs = {x.get(), f.get()};
+  EXPECT_EQ(
+      resolved_op->Execute(inputs, retvals.data(), &num_retvals).code(),
+      absl::StatusCode::kInvalidArgument);
+  inputs.pop_back();
+  EXPECT_EQ(
+      resolved_op->Execute(inputs, retvals.data(), &num_retvals).code(),
+      absl::StatusCode::kInvalidArgument);
+
+  resolved_op.reset();
+  ctx->Unref();
+}
+
 }  // namespace
 }  // namespace tensorflow
@@ -32,10 +32,12 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/graph_view.h"
 #include "tensorflow/core/common_runtime/immutable_executor_state.h"
 #include "tensorflow/core/common_runtime/pending_counts.h"
+#include "tensorflow/core/common_runtime/perf_counters.h"
 #include "tensorflow/core/common_runtime/propagator_state.h"
 #include "tensorflow/core/common_runtime/renamed_device.h"
 #include "tensorflow/core/common_runtime/simple_propagator_state.h"
 #include "tensorflow/core/common_runtime/step_stats_collector.h"
+#include "tensorflow/core/common_runtime/work_stealing_queue.h"
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/cancellation.h"
 #include "tensorflow/core/framework/collective.h"
@@ -62,6 +64,7 @@ limitations under the License.
 #include "tensorflow/core/lib/gtl/manual_constructor.h"
 #include "tensorflow/core/lib/hash/hash.h"
 #include "tensorflow/core/platform/context.h"
+#include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/logging.h"
@@ -147,7 +150,12 @@ typedef gtl::InlinedVector<AllocatorAttributes, 4> AllocatorAttributeVec;
 
 class ExecutorImpl : public Executor {
  public:
-  explicit ExecutorImpl(const LocalExecutorParams& p) : immutable_state_(p) {}
+  // If `use_work_stealing` is true, ready expensive nodes are queued in
+  // per-worker deques that are drained by a bounded number of long-running
+  // closures, instead of each being dispatched to the runner individually.
+  explicit ExecutorImpl(const LocalExecutorParams& p,
+                        bool use_work_stealing = false)
+      : immutable_state_(p), use_work_stealing_(use_work_stealing) {}
 
   Status Initialize(const Graph& graph) {
     TF_RETURN_IF_ERROR(immutable_state_.Initialize(graph));
@@ -225,6 +233,11 @@ class ExecutorImpl : public Executor {
 
   ImmutableExecutorState immutable_state_;
   KernelStats kernel_stats_;
+  const bool use_work_stealing_;
+
+  // The per-step state of finished steps, reused by later steps.
+  PropagatorState::StatePool propagator_state_pool_;
+  SimplePropagatorState::StatePool simple_propagator_state_pool_;
 
   ExecutorImpl(const ExecutorImpl&) = delete;
   void operator=(const ExecutorImpl&) = delete;
@@ -284,7 +297,9 @@ class ExecutorState {
  public:
   ExecutorState(const Executor::Args& args,
                 const ImmutableExecutorState& immutable_state_,
-                ExecutorImpl::KernelStats* kernel_stats_);
+                ExecutorImpl::KernelStats* kernel_stats_,
+                bool use_work_stealing,
+                typename PropagatorStateType::StatePool* state_pool);
   ~ExecutorState();
 
   void RunAsync(Executor::DoneCallback done);
@@ -340,6 +355,13 @@ class ExecutorState {
   // REQUIRES: `!ready->empty()`.
   void ScheduleReady(TaggedNodeSeq* ready, TaggedNodeReadyQueue* inline_ready);
 
+  // Work-stealing mode only. Adds the nodes in [begin, end) to the stealable
+  // ready queues and starts as many workers as needed to drain them, up to
+  // `max_stealing_workers_`. Nodes produced on a worker thread are pushed to
+  // that worker's own deque so that they preferably run on the same thread.
+  void ScheduleStealable(const TaggedNode* begin, const TaggedNode* end,
+                         int64_t scheduled_nsec);
+
   // A wrapper for runner_ to keep track of the pending queue length. Op
   // execution should dispatch work using this function instead of using runner_
   // directly.
@@ -350,6 +372,33 @@ class ExecutorState {
   void Finish();
   void ScheduleFinish();
 
+  // A node waiting in the work-stealing ready queues.
+  struct StealableNode {
+    TaggedNode tagged_node;
+    int64_t scheduled_nsec;
+  };
+  typedef WorkStealingQueueSet<StealableNode> StealableReadyQueues;
+
+  // Drains `queues` on the current thread as worker `worker_id`. Must be
+  // started only after `queues->TryAddWorker()` returned true.
+  //
+  // NOTE: `state` may be deleted as soon as the last outstanding node has been
+  // processed, so `queues` is kept alive separately and `state` is only
+  // dereferenced after a node has been popped (which implies that the step has
+  // not completed yet).
+  static void RunStealingWorker(ExecutorState* state,
+                                std::shared_ptr<StealableReadyQueues> queues,
+                                int worker_id, int max_workers);
+
+  // The worker id of the stealing worker running on the current thread, and
+  // the queue set it drains, or nullptr if the current thread is not a
+  // stealing worker.
+  struct CurrentStealingWorker {
+    const StealableReadyQueues* queues = nullptr;
+    int worker_id = 0;
+  };
+  static thread_local CurrentStealingWorker current_stealing_worker_;
+
   // Contains the device context assigned by the device at the beginning of a
   // step.
   DeviceContext* device_context_ = nullptr;
@@ -401,6 +450,13 @@ class ExecutorState {
 
   PropagatorStateType propagator_;
 
+  // Non-null iff this step runs in work-stealing mode. Shared with the
+  // stealing workers, which may outlive this `ExecutorState`.
+  std::shared_ptr<StealableReadyQueues> stealable_ready_;
+  int max_stealing_workers_ = 0;
+  // Used to spread nodes scheduled from non-worker threads over the queues.
+  std::atomic<int> next_stealing_queue_{0};
+
   // Invoked when the execution finishes.
   Executor::DoneCallback done_cb_;
 
@@ -419,7 +475,8 @@ class ExecutorState {
 template <class PropagatorStateType>
 ExecutorState<PropagatorStateType>::ExecutorState(
     const Executor::Args& args, const ImmutableExecutorState& immutable_state,
-    ExecutorImpl::KernelStats* kernel_stats)
+    ExecutorImpl::KernelStats* kernel_stats, bool use_work_stealing,
+    typename PropagatorStateType::StatePool* state_pool)
     : vlog_(VLOG_IS_ON(1)),
       log_memory_(LogMemory::IsEnabled()),
       step_id_(args.step_id),
@@ -448,15 +505,29 @@ ExecutorState<PropagatorStateType>::ExecutorState(
       runner_(args.runner),
       sync_on_finish_(args.sync_on_finish),
       run_all_kernels_inline_(args.run_all_kernels_inline),
-      propagator_(immutable_state, step_id_, vlog_),
+      propagator_(immutable_state, step_id_, vlog_, state_pool),
       num_outstanding_ops_(0) {
   if (args.user_intra_op_threadpool != nullptr) {
     Device* device = immutable_state_.params().device;
     user_device_ = RenamedDevice::NewRenamedDevice(
         device->name(), device, false, false, args.user_intra_op_threadpool);
   }
+  if (use_work_stealing && !run_all_kernels_inline_) {
+    max_stealing_workers_ =
+        (session_config_ != nullptr &&
+         session_config_->inter_op_parallelism_threads() > 0)
+            ? session_config_->inter_op_parallelism_threads()
+            : port::MaxParallelism();
+    max_stealing_workers_ = std::max(max_stealing_workers_, 1);
+    stealable_ready_ =
+        std::make_shared<StealableReadyQueues>(max_stealing_workers_);
+  }
 }
 
+template <class PropagatorStateType>
+thread_local typename ExecutorState<PropagatorStateType>::CurrentStealingWorker
+    ExecutorState<PropagatorStateType>::current_stealing_worker_;
+
 template <class PropagatorStateType>
 ExecutorState<PropagatorStateType>::~ExecutorState() {
   if (device_context_) {
@@ -603,7 +674,26 @@ Status ExecutorState<PropagatorStateType>::ProcessSync(
               ctx, /*verbose=*/tsl::profiler::TfOpDetailsEnabled());
         },
         tsl::profiler::GetTFTraceMeLevel(is_expensive));
+    // The hardware counters are only read when the TraceMe records them.
+    PerfCounters::Values start_counters;
+    const bool read_counters =
+        PerfCounters::Enabled() &&
+        tsl::profiler::TraceMe::Active(
+            tsl::profiler::GetTFTraceMeLevel(is_expensive)) &&
+        PerfCounters::Read(&start_counters);
     device->Compute(op_kernel, &ctx);
+    PerfCounters::Values end_counters;
+    if (read_counters && PerfCounters::Read(&end_counters)) {
+      activity.AppendMetadata([&] {
+        const PerfCounters::Values counters =
+            PerfCounters::Delta(start_counters, end_counters);
+        return tsl::profiler::TraceMeEncode(
+            {{"cpu_cycles", counters.cycles},
+             {"cpu_instructions", counters.instructions},
+             {"llc_misses", counters.llc_misses},
+             {"dram_bytes", counters.dram_bytes()}});
+      });
+    }
   } else if (kernel_stats_->HasExpensiveMarker(item)) {
     KernelTimer timer;
     device->Compute(op_kernel, &ctx);
@@ -1301,11 +1391,35 @@ void ExecutorState<PropagatorStateType>::ScheduleReady(
   } else {
     const TaggedNode* curr_expensive_node = nullptr;
     TaggedNodeSeq expensive_nodes;
-    if (inline_ready == nullptr) {
-      // Schedule to run all the ready ops in thread pool.
+    if (inline_ready == nullptr && stealable_ready_) {
+      ScheduleStealable(ready->data(), ready->data() + ready->size(),
+                        scheduled_nsec);
+    } else if (inline_ready == nullptr) {
+      // Schedule to run all the ready ops in thread pool. The inexpensive ops
+      // are run in chunks by a closure each, as a graph can start with a very
+      // large number of them, e.g. the variables and the constants of the
+      // initialization of a model with many variables.
+      TaggedNodeSeq inexpensive_nodes;
       for (auto& tagged_node : *ready) {
-        RunTask([=]() { Process(tagged_node, scheduled_nsec); },
-                /*sample_rate=*/ready->size());
+        const NodeItem& item = *tagged_node.node_item;
+        if (tagged_node.get_is_dead() || !kernel_stats_->IsExpensive(item)) {
+          inexpensive_nodes.push_back(tagged_node);
+        } else {
+          RunTask([=]() { Process(tagged_node, scheduled_nsec); },
+                  /*sample_rate=*/ready->size());
+        }
+      }
+      auto it = inexpensive_nodes.begin();
+      while (it < inexpensive_nodes.end()) {
+        auto end = it;
+        std::advance(end, std::min<int64_t>(kInlineScheduleReadyThreshold,
+                                            inexpensive_nodes.end() - it));
+        RunTask([this, ready_chunk = TaggedNodeSeq(it, end), scheduled_nsec]() {
+          for (auto& tagged_node : ready_chunk) {
+            Process(tagged_node, scheduled_nsec);
+          }
+        });
+        it = end;
       }
     } else {
       for (auto& tagged_node : *ready) {
@@ -1331,7 +1445,11 @@ void ExecutorState<PropagatorStateType>::ScheduleReady(
       }
     }
     if (!expensive_nodes.empty()) {
-      if (expensive_nodes.size() < kInlineScheduleReadyThreshold) {
+      if (stealable_ready_) {
+        ScheduleStealable(expensive_nodes.data(),
+                          expensive_nodes.data() + expensive_nodes.size(),
+                          scheduled_nsec);
+      } else if (expensive_nodes.size() < kInlineScheduleReadyThreshold) {
         for (auto& tagged_node : expensive_nodes) {
           RunTask(std::bind(&ExecutorState::Process, this, tagged_node,
                             scheduled_nsec),
@@ -1375,6 +1493,66 @@ void ExecutorState<PropagatorStateType>::ScheduleReady(
   ready->clear();
 }
 
+template <class PropagatorStateType>
+void ExecutorState<PropagatorStateType>::ScheduleStealable(
+    const TaggedNode* begin, const TaggedNode* end, int64_t scheduled_nsec) {
+  // Once the nodes are queued, other workers may run them to completion and
+  // finish the step before this method returns. Hold an extra outstanding op
+  // so that `this` stays alive until the new workers have been started.
+  num_outstanding_ops_.fetch_add(1, std::memory_order_relaxed);
+
+  const CurrentStealingWorker& current = current_stealing_worker_;
+  const int num_nodes = end - begin;
+  if (current.queues == stealable_ready_.get()) {
+    // Keep the continuation local to this worker. Idle workers will steal from
+    // the front of this queue.
+    for (const TaggedNode* it = begin; it != end; ++it) {
+      stealable_ready_->Push(current.worker_id, {*it, scheduled_nsec});
+    }
+  } else {
+    int queue_id = next_stealing_queue_.fetch_add(num_nodes,
+                                                  std::memory_order_relaxed);
+    for (const TaggedNode* it = begin; it != end; ++it) {
+      stealable_ready_->Push(queue_id++, {*it, scheduled_nsec});
+    }
+  }
+
+  // Start at most one new worker per newly ready node. A worker that finds
+  // its own queue empty steals from the others, so the new workers need not
+  // be tied to the queues that the nodes were pushed to.
+  std::shared_ptr<StealableReadyQueues> queues = stealable_ready_;
+  const int max_workers = max_stealing_workers_;
+  for (int i = 0; i < num_nodes; ++i) {
+    if (!queues->TryAddWorker(max_workers)) break;
+    const int worker_id =
+        next_stealing_queue_.fetch_add(1, std::memory_order_relaxed);
+    RunTask(
+        [this, queues, worker_id, max_workers]() {
+          RunStealingWorker(this, queues, worker_id, max_workers);
+        },
+        /*sample_rate=*/num_nodes);
+  }
+
+  if (num_outstanding_ops_.fetch_sub(1) == 1) ScheduleFinish();
+}
+
+template <class PropagatorStateType>
+void ExecutorState<PropagatorStateType>::RunStealingWorker(
+    ExecutorState* state, std::shared_ptr<StealableReadyQueues> queues,
+    int worker_id, int max_workers) {
+  tsl::profiler::TraceMe activity("ExecutorState::RunStealingWorker",
+                                  tsl::profiler::GetTFTraceMeLevel(
+                                      /*is_expensive=*/false));
+  CurrentStealingWorker saved = current_stealing_worker_;
+  current_stealing_worker_ = {queues.get(), worker_id};
+  do {
+    while (absl::optional<StealableNode> node = queues->Pop(worker_id)) {
+      state->Process(node->tagged_node, node->scheduled_nsec);
+    }
+  } while (!queues->RemoveWorker(max_workers));
+  current_stealing_worker_ = saved;
+}
+
 template <class PropagatorStateType>
 void ExecutorState<PropagatorStateType>::ScheduleFinish() {
   // Checks condition to decide if needs to invoke Finish(). If there are
@@ -1513,24 +1691,31 @@ void ExecutorState<PropagatorStateType>::Finish() {
 
 void ExecutorImpl::RunAsyncInternal(const Args& args, DoneCallback done) {
   if (OpOrderDeterminismRequired()) {
-    (new ExecutorState<OrderedPropagatorState>(args, immutable_state_,
-                                               &kernel_stats_))
+    (new ExecutorState<OrderedPropagatorState>(
+         args, immutable_state_, &kernel_stats_, use_work_stealing_,
+         &propagator_state_pool_))
         ->RunAsync(std::move(done));
   } else if (immutable_state_.requires_control_flow_support()) {
-    (new ExecutorState<PropagatorState>(args, immutable_state_, &kernel_stats_))
+    (new ExecutorState<PropagatorState>(args, immutable_state_, &kernel_stats_,
+                                        use_work_stealing_,
+                                        &propagator_state_pool_))
         ->RunAsync(std::move(done));
   } else {
-    (new ExecutorState<SimplePropagatorState>(args, immutable_state_,
-                                              &kernel_stats_))
+    (new ExecutorState<SimplePropagatorState>(
+         args, immutable_state_, &kernel_stats_, use_work_stealing_,
+         &simple_propagator_state_pool_))
         ->RunAsync(std::move(done));
   }
 }
 
 }  // namespace
 
-Status NewLocalExecutor(const LocalExecutorParams& params, const Graph& graph,
-                        Executor** executor) {
-  ExecutorImpl* impl = new ExecutorImpl(params);
+namespace {
+
+Status NewLocalExecutorImpl(const LocalExecutorParams& params,
+                            const Graph& graph, bool use_work_stealing,
+                            Executor** executor) {
+  ExecutorImpl* impl = new ExecutorImpl(params, use_work_stealing);
   const Status s = impl->Initialize(graph);
   if (s.ok()) {
     *executor = impl;
@@ -1540,6 +1725,14 @@ Status NewLocalExecutor(const LocalExecutorParams& params, const Graph& graph,
   return s;
 }
 
+}  // namespace
+
+Status NewLocalExecutor(const LocalExecutorParams& params, const Graph& graph,
+                        Executor** executor) {
+  return NewLocalExecutorImpl(params, graph, /*use_work_stealing=*/false,
+                              executor);
+}
+
 Status CreateNonCachedKernel(Device* device, FunctionLibraryRuntime* flib,
                              const std::shared_ptr<const NodeProperties>& props,
                              int graph_def_version, OpKernel** kernel) {
@@ -1575,6 +1768,28 @@ class DefaultExecutorRegistrar {
 };
 static DefaultExecutorRegistrar registrar;
 
+// Registers the work-stealing variant of the default executor. Select it with
+// `ConfigProto.experimental.executor_type = "WORK_STEALING"`.
+class WorkStealingExecutorRegistrar {
+ public:
+  WorkStealingExecutorRegistrar() {
+    ExecutorFactory::Register("WORK_STEALING", new Factory);
+  }
+
+ private:
+  class Factory : public ExecutorFactory {
+    Status NewExecutor(const LocalExecutorParams& params, const Graph& graph,
+                       std::unique_ptr<Executor>* out_executor) override {
+      Executor* ret = nullptr;
+      TF_RETURN_IF_ERROR(NewLocalExecutorImpl(
+          params, graph, /*use_work_stealing=*/true, &ret));
+      out_executor->reset(ret);
+      return absl::OkStatus();
+    }
+  };
+};
+static WorkStealingExecutorRegistrar work_stealing_registrar;
+
 }  // namespace
 
 }  // namespace tensorflow
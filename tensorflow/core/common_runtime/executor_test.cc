@@ -25,6 +25,7 @@ limitations under the License.
 #include "tensorflow/cc/ops/standard_ops.h"
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/common_runtime/device_factory.h"
+#include "tensorflow/core/common_runtime/executor_factory.h"
 #include "tensorflow/core/common_runtime/graph_constructor.h"
 #include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
 #include "tensorflow/core/common_runtime/lower_functional_ops.h"
@@ -76,8 +77,11 @@ class ExecutorTest : public ::testing::Test {
     delete exec_;
   }
 
-  // Resets executor_ with a new executor based on a graph 'gdef'.
-  void Create(std::unique_ptr<const Graph> graph) {
+  // Resets executor_ with a new executor based on a graph 'gdef'. If
+  // `executor_type` is non-empty, the executor is created through the
+  // `ExecutorFactory` registered under that name.
+  void Create(std::unique_ptr<const Graph> graph,
+              const string& executor_type = "") {
     const int version = graph->versions().producer();
     LocalExecutorParams params;
     params.device = device_.get();
@@ -92,7 +96,13 @@ class ExecutorTest : public ::testing::Test {
     };
     rendez_ = NewLocalRendezvous();
     delete exec_;
-    TF_CHECK_OK(NewLocalExecutor(params, *graph, &exec_));
+    if (executor_type.empty()) {
+      TF_CHECK_OK(NewLocalExecutor(params, *graph, &exec_));
+    } else {
+      std::unique_ptr<Executor> executor;
+      TF_CHECK_OK(NewExecutor(executor_type, params, *graph, &executor));
+      exec_ = executor.release();
+    }
     runner_ = [this](std::function<void()> fn) { thread_pool_->Schedule(fn); };
   }
 
@@ -185,6 +195,30 @@ TEST_F(ExecutorTest, SimpleAdd) {
   EXPECT_EQ(2.0, V(out));  // out = 1.0 + 1.0 = 2.0
 }
 
+TEST_F(ExecutorTest, RepeatedSteps) {
+  // c = a + b, run for several steps, which reuse the state of the previous
+  // ones.
+  auto g = std::make_unique<Graph>(OpRegistry::Global());
+  auto in0 = test::graph::Recv(g.get(), "a", "float", ALICE, 1, BOB);
+  auto in1 = test::graph::Recv(g.get(), "b", "float", ALICE, 1, BOB);
+  auto tmp = test::graph::Add(g.get(), in0, in1);
+  test::graph::Send(g.get(), tmp, "c", BOB, 1, ALICE);
+  Create(std::move(g));
+  Rendezvous::Args args;
+  for (int step = 0; step < 4; ++step) {
+    TF_ASSERT_OK(rendez_->Send(Key(ALICE, kIncarnation, BOB, "a"), args,
+                               V(step), false));
+    TF_ASSERT_OK(rendez_->Send(Key(ALICE, kIncarnation, BOB, "b"), args,
+                               V(1.0), false));
+    TF_ASSERT_OK(Run(rendez_));
+    Tensor out = V(-1);
+    bool is_dead = false;
+    TF_ASSERT_OK(rendez_->Recv(Key(BOB, kIncarnation, ALICE, "c"), args, &out,
+                               &is_dead));
+    EXPECT_EQ(step + 1.0, V(out));
+  }
+}
+
 TEST_F(ExecutorTest, SelfAdd) {
   // v0 <- a
   // v1 = v0 + v0
@@ -265,6 +299,23 @@ TEST_F(ExecutorTest, RandomTree) {
   EXPECT_EQ(4096.0, V(out));
 }
 
+TEST_F(ExecutorTest, RandomTreeWorkStealing) {
+  auto g = std::make_unique<Graph>(OpRegistry::Global());
+  BuildTree(4096, g.get());
+  Create(std::move(g), "WORK_STEALING");
+  for (int iters = 0; iters < 4; ++iters) {
+    Rendezvous::Args args;
+    TF_ASSERT_OK(rendez_->Send(Key(ALICE, kIncarnation, BOB, "a"), args,
+                               V(1.0), false));
+    TF_ASSERT_OK(Run(rendez_));
+    Tensor out = V(-1);
+    bool is_dead = false;
+    TF_ASSERT_OK(rendez_->Recv(Key(BOB, kIncarnation, ALICE, "b"), args, &out,
+                               &is_dead));
+    EXPECT_EQ(4096.0, V(out));
+  }
+}
+
 void BuildConcurrentAddAssign(Graph* g) {
   auto one = test::graph::Constant(g, V(1.0));
   // A variable holds one float.
@@ -339,6 +390,32 @@ TEST_F(ExecutorTest, SimpleSwitchDead) {
   EXPECT_TRUE(is_dead);
 }
 
+TEST_F(ExecutorTest, RepeatedStepsWithControlFlow) {
+  // The output of the switch is live in the even steps and dead in the odd
+  // ones, which reuse the state of the previous steps.
+  auto g = std::make_unique<Graph>(OpRegistry::Global());
+  auto in0 = test::graph::Recv(g.get(), "a", "float", ALICE, 1, BOB);
+  auto in1 = test::graph::Recv(g.get(), "p", "bool", ALICE, 1, BOB);
+  auto tmp = test::graph::Switch(g.get(), in0, in1);
+  test::graph::Send(g.get(), tmp, "c", BOB, 1, ALICE);
+  Create(std::move(g));
+  Rendezvous::Args args;
+  for (int step = 0; step < 4; ++step) {
+    const bool live = step % 2 == 0;
+    TF_ASSERT_OK(rendez_->Send(Key(ALICE, kIncarnation, BOB, "a"), args,
+                               V(step), false));
+    TF_ASSERT_OK(rendez_->Send(Key(ALICE, kIncarnation, BOB, "p"), args,
+                               VB(!live), false));
+    TF_ASSERT_OK(Run(rendez_));
+    Tensor out = V(-1);
+    bool is_dead = false;
+    TF_ASSERT_OK(rendez_->Recv(Key(BOB, kIncarnation, ALICE, "c"), args, &out,
+                               &is_dead));
+    EXPECT_EQ(!live, is_dead);
+    if (live) EXPECT_EQ(step, V(out));
+  }
+}
+
 TEST_F(ExecutorTest, Abort) {
   // e = a + b + c + d
   auto g = std::make_unique<Graph>(OpRegistry::Global());
@@ -439,6 +516,33 @@ TEST_F(ExecutorTest, NoInputTensors) {
   TF_ASSERT_OK(Run(rendez_));
 }
 
+TEST_F(ExecutorTest, ManyInexpensiveRootNodes) {
+  // out = c_0 + ... + c_n, with more constants than the executor runs in a
+  // single closure.
+  auto g = std::make_unique<Graph>(OpRegistry::Global());
+  std::vector<Node*> nodes;
+  for (int i = 0; i < 2000; ++i) {
+    nodes.push_back(test::graph::Constant(g.get(), V(1.0)));
+  }
+  while (nodes.size() > 1) {
+    std::vector<Node*> sums;
+    for (int i = 0; i + 1 < nodes.size(); i += 2) {
+      sums.push_back(test::graph::Add(g.get(), nodes[i], nodes[i + 1]));
+    }
+    if (nodes.size() % 2 == 1) sums.push_back(nodes.back());
+    nodes = std::move(sums);
+  }
+  test::graph::Send(g.get(), nodes[0], "out", BOB, kIncarnation, ALICE);
+  FixupSourceAndSinkEdges(g.get());
+  Create(std::move(g));
+  TF_ASSERT_OK(Run(rendez_));
+  Tensor out = V(-1);
+  bool is_dead = false;
+  TF_ASSERT_OK(rendez_->Recv(Key(BOB, kIncarnation, ALICE, "out"),
+                             Rendezvous::Args(), &out, &is_dead));
+  EXPECT_EQ(2000.0, V(out));
+}
+
 // Create a graph that is 'depth' deep. At each level, fan-in and fan-out a
 // maximum of 'width' nodes. All nodes are no-ops and all dependencies are
 // control dependencies.
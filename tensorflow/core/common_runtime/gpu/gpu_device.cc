@@ -99,6 +99,7 @@ limitations under the License.
 #ifdef TF_GPU_USE_PJRT
 #include "tensorflow/core/tfrt/common/pjrt_util.h"
 #endif  // TF_GPU_USE_PJRT
+#include "tensorflow/core/util/autotune_maps/autotune_serialize.h"
 #include "tensorflow/core/util/device_name_utils.h"
 #include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/stream_executor_util.h"
@@ -574,6 +575,16 @@ Status BaseGPUDevice::Init(const SessionOptions& options) {
       options.config.gpu_options().experimental().kernel_tracker_max_pending());
   timestamped_allocator_ =
       options.config.gpu_options().experimental().timestamped_allocator();
+  if (timestamped_allocator_ &&
+      GPUProcessState::singleton()->GPUAllocatorCounter(tf_device_id_) ==
+          nullptr) {
+    // Allocations made for the other streams would be handed memory that
+    // kernels queued on the compute stream may still use, so keep
+    // synchronizing those streams with the compute stream instead.
+    LOG(WARNING) << "Ignoring timestamped_allocator for " << name()
+                 << ", as its GPU allocator does not support it.";
+    timestamped_allocator_ = false;
+  }
   pending_cap_ = tracker_params.max_pending;
   if (timestamped_allocator_ ||
       (tracker_params.max_interval > 0 || tracker_params.max_bytes > 0 ||
@@ -1411,6 +1422,10 @@ Status BaseGPUDeviceFactory::CreateDevices(
   if (iter != options.config.device_count().end()) {
     num_gpus_to_use = iter->second;
   }
+  if (num_gpus_to_use > 0) {
+    // Reuses the autotune results of the other processes, if configured.
+    MaybeShareAutotuneMapsThroughFile();
+  }
   const auto& gpu_options = options.config.gpu_options();
   bool populate_pjrt_gpu_client_creation_info =
       gpu_options.experimental().populate_pjrt_gpu_client_creation_info();
@@ -27,6 +27,7 @@ limitations under the License.
 #include "xla/tsl/framework/device_id.h"
 #include "xla/tsl/lib/core/status_test_util.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_process_state.h"
+#include "tensorflow/core/common_runtime/gpu/gpu_util.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/random.h"
@@ -189,6 +190,38 @@ TEST_F(GPUDeviceTest, DISABLED_ON_GPU_ROCM(CudaMallocAsync)) {
   EXPECT_EQ(status.code(), error::OK);
 }
 
+TEST_F(GPUDeviceTest,
+       DISABLED_ON_GPU_ROCM(CudaMallocAsyncIgnoresTimestampedAllocator)) {
+#ifndef GOOGLE_CUDA
+  return;
+#elif CUDA_VERSION < 11020
+  LOG(INFO) << "CUDA toolkit too old, skipping this test: " << CUDA_VERSION;
+  return;
+#else
+  int driverVersion;
+  cuDriverGetVersion(&driverVersion);
+  if (driverVersion < 11020) {
+    LOG(INFO) << "Driver version too old, skipping this test: "
+              << driverVersion;
+    return;
+  }
+#endif
+
+  SessionOptions opts = MakeSessionOptions("0", 0, 1, {}, {}, {}, 0,
+                                           /*use_cuda_malloc_async=*/true);
+  opts.config.mutable_gpu_options()
+      ->mutable_experimental()
+      ->set_timestamped_allocator(true);
+  std::vector<std::unique_ptr<Device>> devices;
+  TF_ASSERT_OK(DeviceFactory::GetFactory("GPU")->CreateDevices(
+      opts, kDeviceNamePrefix, &devices));
+  ASSERT_THAT(devices, SizeIs(1));
+  // cudaMallocAsync does not honor the safe frontier, so the device must not
+  // report one, which would let copies skip the synchronization with the
+  // compute stream.
+  EXPECT_EQ(devices[0]->SafeAllocFrontier(0), 0);
+}
+
 TEST_F(GPUDeviceTest, DISABLED_ON_GPU_ROCM(CudaMallocAsyncPreallocate)) {
   SessionOptions opts = MakeSessionOptions("0", 0, 1, {}, {}, {}, 0,
                                            /*use_cuda_malloc_async=*/true);
@@ -612,6 +645,54 @@ TEST_F(GPUDeviceTest, CopyTensorInSameDevice) {
   }
 }
 
+TEST_F(GPUDeviceTest, CopyCPUTensorsToGPU) {
+  SessionOptions opts = MakeSessionOptions("0");
+  std::vector<std::unique_ptr<Device>> devices;
+  TF_ASSERT_OK(DeviceFactory::GetFactory("GPU")->CreateDevices(
+      opts, kDeviceNamePrefix, &devices));
+  Device* device = devices[0].get();
+  auto* device_info = device->tensorflow_accelerator_device_info();
+  CHECK(device_info);
+  DeviceContext* device_context = device_info->default_context;
+  Allocator* allocator = device->GetAllocator(AllocatorAttributes());
+
+  // With at most 32 bytes batched, the tensors of 4 and 7 elements are copied
+  // together and the one of 10 elements on its own.
+  const std::vector<int> num_elements = {4, 10, 0, 7};
+  std::vector<Tensor> cpu_tensors;
+  for (int i = 0; i < num_elements.size(); ++i) {
+    cpu_tensors.emplace_back(cpu_allocator(), DT_FLOAT,
+                             TensorShape({num_elements[i]}));
+    InitCPUTensor(&cpu_tensors.back(), num_elements[i], i + 1);
+  }
+  std::vector<Tensor> gpu_tensors;
+  Notification note;
+  GPUUtil::CopyCPUTensorsToGPU(
+      cpu_tensors, device_context, device, allocator, &gpu_tensors,
+      [&note](const Status& s) {
+        TF_ASSERT_OK(s);
+        note.Notify();
+      },
+      /*sync_dst_compute=*/true, /*max_batched_bytes=*/32);
+  note.WaitForNotification();
+
+  ASSERT_THAT(gpu_tensors, SizeIs(num_elements.size()));
+  EXPECT_EQ(DMAHelper::buffer(&gpu_tensors[0])->root_buffer(),
+            DMAHelper::buffer(&gpu_tensors[3])->root_buffer());
+  EXPECT_NE(DMAHelper::buffer(&gpu_tensors[0])->root_buffer(),
+            DMAHelper::buffer(&gpu_tensors[1])->root_buffer());
+  for (int i = 0; i < num_elements.size(); ++i) {
+    EXPECT_EQ(gpu_tensors[i].shape(), cpu_tensors[i].shape());
+    Tensor output_cpu_tensor(cpu_allocator(), DT_FLOAT,
+                             TensorShape({num_elements[i]}));
+    CopyGPUToCPU(&gpu_tensors[i], &output_cpu_tensor, device, device_context);
+    auto output = output_cpu_tensor.tensor<float, 1>();
+    for (int j = 0; j < num_elements[i]; ++j) {
+      EXPECT_EQ(i + 1, output(j)) << " for tensor " << i << " index " << j;
+    }
+  }
+}
+
 TEST_F(GPUDeviceTest, DeviceDetails) {
   DeviceFactory* factory = DeviceFactory::GetFactory("GPU");
   std::vector<string> devices;
@@ -176,12 +176,6 @@ Allocator* GPUProcessState::GetGPUAllocator(
         }());
     Allocator* gpu_allocator = gpu_bfc_allocator.get();
 
-    SharedCounter* timing_counter = nullptr;
-    if (options.experimental().timestamped_allocator()) {
-      timing_counter = new SharedCounter;
-      gpu_bfc_allocator->SetTimingCounter(timing_counter);
-    }
-
     // If true, checks for memory overwrites by writing
     // distinctive patterns on both ends of allocated memory.
     if (UseCudaMemoryGuardAllocator()) {
@@ -211,6 +205,16 @@ Allocator* GPUProcessState::GetGPUAllocator(
 #endif
     }
 
+    // Only the BFC allocator defers the reuse of the memory freed on the
+    // compute stream until the safe frontier passes it. The other allocators
+    // get no counter, so that the device keeps synchronizing the other streams
+    // with the compute stream before they write to newly allocated memory.
+    SharedCounter* timing_counter = nullptr;
+    if (options.experimental().timestamped_allocator() && gpu_bfc_allocator) {
+      timing_counter = new SharedCounter;
+      gpu_bfc_allocator->SetTimingCounter(timing_counter);
+    }
+
     Allocator* recording_allocator = nullptr;
     if (process_state_->ProcessState::FLAGS_brain_gpu_record_mem_types) {
       ProcessState::MemDesc md;
@@ -67,6 +67,26 @@ TEST(GpuServingDeviceSelector, Basic) {
   EXPECT_EQ(reservation.device_index(), 0);
 }
 
+TEST(GpuServingDeviceSelector, LeastLoadedPolicy) {
+  GpuServingDeviceSelector selector(
+      /*num_devices=*/2, std::make_unique<tsl::LeastLoadedPolicy>());
+
+  const std::string program_fingerprint = "TensorFlow";
+  tsl::DeviceReservation reservation0 =
+      selector.ReserveDevice(program_fingerprint);
+  EXPECT_EQ(reservation0.device_index(), 0);
+  tsl::DeviceReservation reservation1 =
+      selector.ReserveDevice(program_fingerprint);
+  EXPECT_EQ(reservation1.device_index(), 1);
+
+  // The device 1 is idle once its program completes, so it is selected
+  // instead of the next device in round-robin order.
+  reservation1.reset();
+  tsl::DeviceReservation reservation2 =
+      selector.ReserveDevice(program_fingerprint);
+  EXPECT_EQ(reservation2.device_index(), 1);
+}
+
 TEST(GpuServingDeviceSelector, DefaultPolicyOnlyEnqueueCall) {
   ServingDeviceSelectorTestHelper helper;
   auto policy = std::make_unique<tsl::RoundRobinPolicy>();
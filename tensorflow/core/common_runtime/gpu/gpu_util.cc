@@ -16,11 +16,14 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/gpu/gpu_util.h"
 
 #include <algorithm>
+#include <cstdint>
 #include <cstring>
 #include <memory>
 #include <utility>
+#include <vector>
 
 #include "absl/status/status.h"
+#include "absl/types/span.h"
 
 // TODO(b/282059652): Merge google internal and open-source code path once TF
 // dependency issue is resolved.
@@ -55,6 +58,7 @@ limitations under the License.
 #include "tensorflow/core/platform/stream_executor.h"
 #include "tensorflow/core/platform/tensor_coding.h"
 #include "tensorflow/core/profiler/lib/scoped_annotation.h"
+#include "tensorflow/core/util/reffed_status_callback.h"
 #include "tensorflow/core/util/util.h"
 #include "tsl/profiler/lib/traceme.h"
 
@@ -315,6 +319,130 @@ bool NeedStaging(const Tensor* tensor) {
   return tensor->GetMemoryType() == AllocatorMemoryType::kHostPageable;
 }
 
+// Sets `*stream` to the stream copying the host tensors to `gpu_device`.
+// Unless that is the compute stream `recv_stream` itself, it waits for it if
+// `sync_dst_compute` is true.
+Status GetHostToDeviceStream(Device* gpu_device,
+                             const DeviceContext* device_context,
+                             se::Stream* recv_stream, bool sync_dst_compute,
+                             se::Stream** stream) {
+  if (gpu_device->merge_host_to_device_stream()) {
+    *stream = recv_stream;
+    return absl::OkStatus();
+  }
+  *stream = static_cast<const GPUDeviceContext*>(device_context)
+                ->host_to_device_stream();
+  if (*stream == nullptr) {
+    return absl::AbortedError("No send gpu copy-out-stream is available.");
+  }
+  // Wait for the recv-stream to make sure the buffer is truly available.
+  if (sync_dst_compute) {
+    return (*stream)->WaitFor(recv_stream);
+  }
+  return absl::OkStatus();
+}
+
+// An alias to the `size` bytes at `offset` in the buffer `buf`, which holds a
+// ref of the root buffer of `buf`.
+class SubBufferView : public TensorBuffer {
+ public:
+  SubBufferView(TensorBuffer* buf, int64_t offset, int64_t size)
+      : TensorBuffer(buf->base<char>() + offset),
+        root_(buf->root_buffer()),
+        size_(size) {
+    root_->Ref();
+  }
+
+  size_t size() const override { return size_; }
+  TensorBuffer* root_buffer() override { return root_; }
+  bool GetAllocatedBytes(size_t* out_bytes) const override {
+    return root_->GetAllocatedBytes(out_bytes);
+  }
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    root_->FillAllocationDescription(proto);
+  }
+
+ private:
+  ~SubBufferView() override { root_->Unref(); }
+
+  TensorBuffer* root_;
+  const int64_t size_;
+};
+
+// Copies the tensors of `cpu_tensors` whose offset in `offsets` isn't -1 with
+// a single copy of `batch_bytes` bytes, and sets their `gpu_tensors` to views
+// of the device buffer.  Takes a ref of `status_cb` until the copy completed.
+Status CopyBatchedCPUTensorsToGPU(absl::Span<const Tensor> cpu_tensors,
+                                  absl::Span<const int64_t> offsets,
+                                  int64_t batch_bytes,
+                                  const DeviceContext* device_context,
+                                  Device* gpu_device, Allocator* gpu_allocator,
+                                  bool sync_dst_compute,
+                                  std::vector<Tensor>* gpu_tensors,
+                                  ReffedStatusCallback* status_cb) {
+  Tensor batch(gpu_allocator, DT_INT8, TensorShape({batch_bytes}));
+  if (!batch.IsInitialized()) {
+    return errors::ResourceExhausted("Failed to allocate ", batch_bytes,
+                                     " bytes for a batched CPU->GPU copy.");
+  }
+  const DeviceBase::AcceleratorDeviceInfo* dev_info = nullptr;
+  se::Stream* recv_stream = nullptr;
+  TF_RETURN_IF_ERROR(PrepareCopy(gpu_device, device_context, batch,
+                                 /*dst=*/nullptr, &dev_info, &recv_stream));
+  se::Stream* recv_host_to_device_stream = nullptr;
+  TF_RETURN_IF_ERROR(GetHostToDeviceStream(gpu_device, device_context,
+                                           recv_stream, sync_dst_compute,
+                                           &recv_host_to_device_stream));
+
+  Allocator* host_memory_allocator = device_context->host_memory_allocator();
+  char* staging_buffer = static_cast<char*>(host_memory_allocator->AllocateRaw(
+      Allocator::kAllocatorAlignment, batch_bytes));
+  if (staging_buffer == nullptr) {
+    return errors::ResourceExhausted("Failed to allocate ", batch_bytes,
+                                     " bytes of pinned memory for a batched "
+                                     "CPU->GPU copy.");
+  }
+  {
+    tsl::profiler::TraceMe trace_me("Packing CPU tensors to pinned memory");
+    for (int i = 0; i < cpu_tensors.size(); ++i) {
+      if (offsets[i] >= 0) {
+        std::memcpy(staging_buffer + offsets[i], GetBase(&cpu_tensors[i]),
+                    cpu_tensors[i].TotalBytes());
+      }
+    }
+  }
+  DeviceMemoryBase gpu_dst_ptr(GetBase(&batch), batch_bytes);
+  Status s = recv_host_to_device_stream->Memcpy(&gpu_dst_ptr, staging_buffer,
+                                                batch_bytes);
+  if (!s.ok()) {
+    host_memory_allocator->DeallocateRaw(staging_buffer);
+    return s;
+  }
+
+  TensorBuffer* batch_buffer = DMAHelper::buffer(&batch);
+  for (int i = 0; i < cpu_tensors.size(); ++i) {
+    if (offsets[i] >= 0) {
+      const Tensor& cpu_tensor = cpu_tensors[i];
+      (*gpu_tensors)[i] = Tensor(
+          cpu_tensor.dtype(), cpu_tensor.shape(),
+          core::RefCountPtr<TensorBuffer>(new SubBufferView(
+              batch_buffer, offsets[i], cpu_tensor.TotalBytes())));
+    }
+  }
+  status_cb->Ref();
+  dev_info->event_mgr->ThenExecute(
+      recv_host_to_device_stream,
+      [recv_host_to_device_stream, staging_buffer, host_memory_allocator,
+       status_cb]() {
+        host_memory_allocator->DeallocateRaw(staging_buffer);
+        if (!recv_host_to_device_stream->ok()) {
+          LOG(FATAL) << "CPU->GPU Memcpy failed";  // Crash OK
+        }
+        status_cb->Unref();
+      });
+  return absl::OkStatus();
+}
+
 }  // namespace
 
 void GPUUtil::CopyGPUTensorToCPU(Device* gpu_device,
@@ -414,24 +542,11 @@ void GPUUtil::CopyCPUTensorToGPU(const Tensor* cpu_tensor,
   const bool merge_host_to_device_stream =
       gpu_device->merge_host_to_device_stream();
   se::Stream* recv_host_to_device_stream = nullptr;
-  if (merge_host_to_device_stream) {
-    recv_host_to_device_stream = recv_stream;
-  } else {
-    recv_host_to_device_stream =
-        static_cast<const GPUDeviceContext*>(device_context)
-            ->host_to_device_stream();
-    if (recv_host_to_device_stream == nullptr) {
-      done(absl::AbortedError("No send gpu copy-out-stream is available."));
-      return;
-    }
-    // Wait for the recv-stream to make sure the buffer is truly available.
-    if (sync_dst_compute) {
-      s = recv_host_to_device_stream->WaitFor(recv_stream);
-      if (!s.ok()) {
-        done(s);
-        return;
-      }
-    }
+  s = GetHostToDeviceStream(gpu_device, device_context, recv_stream,
+                            sync_dst_compute, &recv_host_to_device_stream);
+  if (!s.ok()) {
+    done(s);
+    return;
   }
 
   const int64_t total_bytes = cpu_tensor->TotalBytes();
@@ -514,6 +629,79 @@ void GPUUtil::CopyCPUTensorToGPU(const Tensor* cpu_tensor,
       });
 }
 
+/*static*/
+void GPUUtil::CopyCPUTensorsToGPU(absl::Span<const Tensor> cpu_tensors,
+                                  const DeviceContext* device_context,
+                                  Device* gpu_device, Allocator* gpu_allocator,
+                                  std::vector<Tensor>* gpu_tensors,
+                                  StatusCallback done, bool sync_dst_compute,
+                                  int64_t max_batched_bytes) {
+  VLOG(1) << "CopyCPUTensorsToGPU";
+  // The offsets of the batched tensors in the staging and device buffers, or
+  // -1 for the tensors copied one by one.
+  std::vector<int64_t> offsets(cpu_tensors.size(), -1);
+  int64_t batch_bytes = 0;
+  int num_batched = 0;
+  if (device_context != nullptr &&
+      device_context->host_memory_allocator() != nullptr) {
+    for (int i = 0; i < cpu_tensors.size(); ++i) {
+      const int64_t total_bytes = cpu_tensors[i].TotalBytes();
+      if (total_bytes > 0 && total_bytes <= max_batched_bytes &&
+          DMAHelper::CanUseDMA(&cpu_tensors[i])) {
+        offsets[i] = batch_bytes;
+        // Keeps the tensors aligned as if they were allocated one by one.
+        batch_bytes += (total_bytes + Allocator::kAllocatorAlignment - 1) /
+                       Allocator::kAllocatorAlignment *
+                       Allocator::kAllocatorAlignment;
+        ++num_batched;
+      }
+    }
+  }
+  if (num_batched < 2) {
+    std::fill(offsets.begin(), offsets.end(), -1);
+  }
+
+  gpu_tensors->assign(cpu_tensors.size(), Tensor());
+  // `done` is called once the copies dropped their refs, and this one.
+  auto* status_cb = new ReffedStatusCallback(std::move(done));
+  core::ScopedUnref status_cb_unref(status_cb);
+  if (num_batched >= 2) {
+    Status s = CopyBatchedCPUTensorsToGPU(
+        cpu_tensors, offsets, batch_bytes, device_context, gpu_device,
+        gpu_allocator, sync_dst_compute, gpu_tensors, status_cb);
+    if (!s.ok()) {
+      status_cb->UpdateStatus(s);
+      return;
+    }
+  }
+  for (int i = 0; i < cpu_tensors.size(); ++i) {
+    if (offsets[i] >= 0) continue;
+    const Tensor& cpu_tensor = cpu_tensors[i];
+    if (!DMAHelper::CanUseDMA(&cpu_tensor)) {
+      status_cb->UpdateStatus(
+          errors::Internal("GPU copy from non-DMA ",
+                           DataTypeString(cpu_tensor.dtype()), " tensor"));
+      return;
+    }
+    Tensor& gpu_tensor = (*gpu_tensors)[i];
+    gpu_tensor = Tensor(gpu_allocator, cpu_tensor.dtype(), cpu_tensor.shape());
+    if (!gpu_tensor.IsInitialized()) {
+      status_cb->UpdateStatus(errors::ResourceExhausted(
+          "Failed to allocate ", cpu_tensor.TotalBytes(),
+          " bytes for a CPU->GPU copy."));
+      return;
+    }
+    status_cb->Ref();
+    CopyCPUTensorToGPU(
+        &cpu_tensor, device_context, gpu_device, &gpu_tensor,
+        [status_cb](const Status& s) {
+          status_cb->UpdateStatus(s);
+          status_cb->Unref();
+        },
+        sync_dst_compute);
+  }
+}
+
 Status GPUUtil::Sync(Device* gpu_device) {
   VLOG(1) << "GPUUtil::Sync";
   auto* dev_info = gpu_device->tensorflow_accelerator_device_info();
@@ -16,6 +16,10 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_UTIL_H_
 #define TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_UTIL_H_
 
+#include <cstdint>
+#include <vector>
+
+#include "absl/types/span.h"
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/common_runtime/dma_helper.h"
 #include "tensorflow/core/framework/tensor.h"
@@ -90,6 +94,23 @@ class GPUUtil {
                                  Device* gpu_device, Tensor* gpu_tensor,
                                  StatusCallback done, bool sync_dst_compute);
 
+  // The size up to which CopyCPUTensorsToGPU() batches the tensors.
+  static constexpr int64_t kMaxBatchedCopyBytes = 64 << 10;
+
+  // Copies the host tensors `cpu_tensors` to `gpu_device`, into the tensors
+  // allocated with `gpu_allocator` that are assigned to `*gpu_tensors` before
+  // returning.  The tensors of at most `max_batched_bytes` bytes are packed
+  // into a single pinned staging buffer and transferred with one copy into a
+  // single device buffer, of which their device tensors are views; that
+  // buffer is freed once all of them are.  The other tensors are copied by
+  // CopyCPUTensorToGPU().  `done` is called once all the copies completed.
+  static void CopyCPUTensorsToGPU(
+      absl::Span<const Tensor> cpu_tensors,
+      const DeviceContext* device_context, Device* gpu_device,
+      Allocator* gpu_allocator, std::vector<Tensor>* gpu_tensors,
+      StatusCallback done, bool sync_dst_compute,
+      int64_t max_batched_bytes = kMaxBatchedCopyBytes);
+
   static void DeviceToDeviceCopy(
       DeviceContext* send_dev_context, DeviceContext* recv_dev_context,
       Device* src, Device* dst, AllocatorAttributes src_alloc_attr,
@@ -27,6 +27,7 @@ limitations under the License.
 #include "absl/algorithm/container.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
+#include "absl/strings/match.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
 #include "tensorflow/core/common_runtime/shape_refiner.h"
@@ -48,6 +49,7 @@ limitations under the License.
 #include "tensorflow/core/lib/gtl/flatmap.h"
 #include "tensorflow/core/lib/gtl/flatset.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
 #include "tensorflow/core/lib/strings/scanner.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/platform/errors.h"
@@ -247,6 +249,9 @@ class GraphConstructor {
   Status MakeEdge(Node* src, int output_index, Node* dst, int input_index);
   Status ValidateShape(Node* node);
   Status ModifyNodeDefForImport(NodeDef* node_def);
+  // Like ValidateNodeDef(), but skips the validation of nodes whose op, number
+  // of inputs and attrs are the same as those of an already validated node.
+  Status ValidateNodeDefCached(const NodeDef& node_def, const OpDef& op_def);
   // Modifies node_def's inputs according to opts_.input_map.
   // input_already_exists is a pre-initialized vector of length
   // node_def->input_size(). This function will mark inputs that are remapped to
@@ -406,6 +411,11 @@ class GraphConstructor {
   };
   std::vector<EdgeInfo> back_edges_;
 
+  // The signatures, as returned by ValidationSignature(), of the nodes that
+  // passed ValidateNodeDef(). Large graphs typically have many nodes with the
+  // same op and attrs, which then only need to be validated once.
+  absl::flat_hash_set<std::string> validated_signatures_;
+
   GraphConstructor(const GraphConstructor&) = delete;
   void operator=(const GraphConstructor&) = delete;
 };
@@ -863,11 +873,62 @@ Status GraphConstructor::ValidateShape(Node* node) {
   return absl::OkStatus();
 }
 
+// Returns the parts of `node_def` that the result of ValidateNodeDef() depends
+// on: the op, the number of data inputs and the attrs not starting with "_".
+// Only the type of tensor-valued attrs is checked, so their values are left
+// out. Returns an empty string if the control inputs of `node_def` are
+// malformed, in which case it must be validated on its own.
+std::string ValidationSignature(const NodeDef& node_def) {
+  std::string signature = node_def.op();
+  bool seen_control = false;
+  int num_inputs = 0;
+  for (const std::string& input : node_def.input()) {
+    if (absl::StartsWith(input, "^")) {
+      if (input.find(':') != std::string::npos) return "";
+      seen_control = true;
+    } else if (seen_control) {
+      return "";
+    } else {
+      ++num_inputs;
+    }
+  }
+  absl::StrAppend(&signature, "#", num_inputs);
+
+  std::vector<std::pair<absl::string_view, std::string>> attrs;
+  attrs.reserve(node_def.attr_size());
+  for (const auto& [name, value] : node_def.attr()) {
+    if (absl::StartsWith(name, "_")) continue;
+    std::string serialized;
+    if (value.value_case() == AttrValue::kTensor) {
+      serialized = "<tensor>";
+    } else if (!SerializeToStringDeterministic(value, &serialized)) {
+      return "";
+    }
+    attrs.emplace_back(name, std::move(serialized));
+  }
+  std::sort(attrs.begin(), attrs.end());
+  for (const auto& [name, serialized] : attrs) {
+    absl::StrAppend(&signature, ";", name.size(), ":", name, "=",
+                    serialized.size(), ":", serialized);
+  }
+  return signature;
+}
+
+Status GraphConstructor::ValidateNodeDefCached(const NodeDef& node_def,
+                                               const OpDef& op_def) {
+  std::string signature = ValidationSignature(node_def);
+  if (signature.empty()) return ValidateNodeDef(node_def, op_def);
+  if (validated_signatures_.contains(signature)) return absl::OkStatus();
+  TF_RETURN_IF_ERROR(ValidateNodeDef(node_def, op_def));
+  validated_signatures_.insert(std::move(signature));
+  return absl::OkStatus();
+}
+
 Status GraphConstructor::ModifyNodeDefForImport(NodeDef* node_def) {
   const OpDef* op_def;
   TF_RETURN_IF_ERROR(g_->op_registry()->LookUpOpDef(node_def->op(), &op_def));
   AddDefaultsToNodeDef(*op_def, node_def);
-  TF_RETURN_IF_ERROR(ValidateNodeDef(*node_def, *op_def));
+  TF_RETURN_IF_ERROR(ValidateNodeDefCached(*node_def, *op_def));
   if (versions()) {
     TF_RETURN_IF_ERROR(CheckOpDeprecation(*op_def, versions()->producer()));
   }
@@ -1305,7 +1366,7 @@ Status GraphConstructor::Convert() {
         AddDefaultsToNodeDef(*op_def, &node_def);
       }
       if (opts_.validate_nodes) {
-        TF_RETURN_IF_ERROR(ValidateNodeDef(node_def, *op_def));
+        TF_RETURN_IF_ERROR(ValidateNodeDefCached(node_def, *op_def));
       }
     }
 
@@ -925,6 +925,37 @@ TEST_F(GraphConstructorTest, Error_ControlEdgeBeforeRealInput) {
       {"Node 't2': Control dependencies must come after regular dependencies"});
 }
 
+TEST_F(GraphConstructorTest, ImportGraphDef_ValidatesNodesWithSameOp) {
+  ImportGraphDefOptions opts;
+  ExpectOK(
+      "node { name: 'a' op: 'TestParams' }"
+      "node { name: 'b' op: 'TestOneInputOneOutput' input: [ 'a' ]"
+      "       attr { key: 'T' value { type: DT_FLOAT } } }"
+      "node { name: 'c' op: 'TestOneInputOneOutput' input: [ 'b', '^a' ]"
+      "       attr { key: 'T' value { type: DT_FLOAT } } }",
+      opts);
+  EXPECT_TRUE(HasNode("c"));
+
+  // Nodes with the same op as an already validated node are still validated
+  // if their attrs or number of inputs differ.
+  opts.prefix = "import1";
+  ExpectError(
+      "node { name: 'a' op: 'TestParams' }"
+      "node { name: 'b' op: 'TestOneInputOneOutput' input: [ 'a' ]"
+      "       attr { key: 'T' value { type: DT_FLOAT } } }"
+      "node { name: 'c' op: 'TestOneInputOneOutput' input: [ 'a' ]"
+      "       attr { key: 'T' value { type: DT_INT32 } } }",
+      opts, {"Value for attr 'T' of int32 is not in the list of allowed"});
+  opts.prefix = "import2";
+  ExpectError(
+      "node { name: 'a' op: 'TestParams' }"
+      "node { name: 'b' op: 'TestOneInputOneOutput' input: [ 'a' ]"
+      "       attr { key: 'T' value { type: DT_FLOAT } } }"
+      "node { name: 'c' op: 'TestOneInputOneOutput' input: [ 'a', 'b' ]"
+      "       attr { key: 'T' value { type: DT_FLOAT } } }",
+      opts, {"do not match 2 inputs specified"});
+}
+
 TEST_F(GraphConstructorTest, ImportGraphDef) {
   GraphDef def;
   ImportGraphDefOptions opts;
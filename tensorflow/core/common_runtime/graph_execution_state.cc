@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/graph_execution_state.h"
 
+#include <algorithm>
 #include <memory>
 #include <set>
 #include <string>
@@ -22,6 +23,7 @@ limitations under the License.
 #include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/memory/memory.h"
 #include "absl/strings/str_join.h"
@@ -503,6 +505,49 @@ Status GetFeedShapeAndTypeFromAttribute(const NodeDef& node,
   return absl::OkStatus();
 }
 
+#ifndef IS_MOBILE_PLATFORM
+// Gives the fed placeholders of `item` the concrete shapes in
+// `options.feed_shapes`. The placeholders are no longer treated as feeds by
+// Grappler, so that their shapes are trusted and e.g. the shape computations
+// depending on them can be folded, but they are still preserved.
+void SpecializeForFeedShapes(const BuildGraphOptions& options,
+                             grappler::GrapplerItem* item) {
+  DCHECK_EQ(options.feed_shapes.size(), options.callable_options.feed_size());
+  absl::flat_hash_map<string, const TensorShape*> feed_shapes;
+  for (int i = 0; i < options.callable_options.feed_size(); ++i) {
+    const SafeTensorId feed(ParseTensorName(options.callable_options.feed(i)));
+    if (feed.index() == 0) {
+      feed_shapes[feed.node()] = &options.feed_shapes[i];
+    }
+  }
+  absl::flat_hash_set<string> specialized;
+  for (NodeDef& node : *item->graph.mutable_node()) {
+    auto it = feed_shapes.find(node.name());
+    // A fed PlaceholderWithDefault can't stop being a feed, since it could be
+    // folded into its default value otherwise.
+    if (it == feed_shapes.end() ||
+        (node.op() != "Placeholder" && node.op() != "PlaceholderV2")) {
+      continue;
+    }
+    PartialTensorShape shape;
+    if (!GetNodeAttr(node, "shape", &shape).ok() ||
+        !shape.IsCompatibleWith(*it->second)) {
+      continue;
+    }
+    it->second->AsProto((*node.mutable_attr())["shape"].mutable_shape());
+    specialized.insert(node.name());
+    item->keep_ops.push_back(node.name());
+  }
+  item->feed.erase(
+      std::remove_if(item->feed.begin(), item->feed.end(),
+                     [&](const std::pair<string, Tensor>& feed) {
+                       return specialized.contains(feed.first);
+                     }),
+      item->feed.end());
+  VLOG(2) << "Specialized " << specialized.size() << " feeds for their shapes";
+}
+#endif  // IS_MOBILE_PLATFORM
+
 }  // namespace
 
 Status GraphExecutionState::PruneGraph(
@@ -799,6 +844,9 @@ Status GraphExecutionState::OptimizeGraph(
     if (flib_def) {
       *item.graph.mutable_library() = flib_def->ToProto();
     }
+    if (!options.feed_shapes.empty()) {
+      SpecializeForFeedShapes(options, &item);
+    }
 
     // Construct a virtual cluster and find the cpu_device, which the
     // ConstantFolding optimizer will use for partial evaluation of the graph.
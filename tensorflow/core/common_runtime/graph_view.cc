@@ -22,7 +22,9 @@ limitations under the License.
 #include <unordered_map>
 #include <vector>
 
+#include "absl/container/flat_hash_set.h"
 #include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/common_runtime/step_arena_allocator.h"
 #include "tensorflow/core/framework/node_def_util.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor.h"
@@ -416,12 +418,61 @@ Status InferAllocAttr(const Node* n, const Node* dst,
   }
   return s;
 }
+
+// Returns true if `n` may return one of its input buffers as an output
+// without going through `OpKernelContext::forward_input()`, which would check
+// the allocator attributes of both.
+bool MayPassThroughInput(const Node* n) {
+  static const auto* const kPassThroughOps =
+      new absl::flat_hash_set<std::string>(
+          {"Bitcast", "BroadcastTo", "CheckNumerics", "Concat", "ConcatV2",
+           "EnsureShape", "ExpandDims", "IdentityN", "Pack",
+           "PlaceholderWithDefault", "PreventGradient", "Reshape", "Reverse",
+           "ReverseV2", "Slice", "Snapshot", "Split", "SplitV", "Squeeze",
+           "StopGradient", "StridedSlice", "Tile", "Transpose", "Unpack"});
+  return n->IsIdentity() || n->IsControlFlow() || n->IsFunctionCall() ||
+         kPassThroughOps->contains(n->type_string());
+}
+
+// Returns, indexed by node id, whether an output of the node may be kept
+// alive past the end of the step: it is produced by a stateful node, or it
+// reaches a stateful node, a _Retval or a _Send either directly or through
+// nodes that may pass their input buffers through.
+std::vector<bool> OutputsMayOutliveStep(const Graph* g) {
+  std::vector<bool> outlives(g->num_node_ids(), false);
+  std::vector<const Node*> ready;
+  for (const Node* n : g->nodes()) {
+    if (n->op_def().is_stateful() || n->IsRetval() || n->IsSend()) {
+      outlives[n->id()] = true;
+      ready.push_back(n);
+    }
+  }
+  while (!ready.empty()) {
+    const Node* n = ready.back();
+    ready.pop_back();
+    for (const Edge* e : n->in_edges()) {
+      if (e->IsControlEdge() || outlives[e->src()->id()]) continue;
+      outlives[e->src()->id()] = true;
+      if (MayPassThroughInput(e->src())) ready.push_back(e->src());
+    }
+  }
+  return outlives;
+}
 }  // namespace
 
 Status GraphView::SetAllocAttrs(const Graph* g, const Device* device) {
   Status s;
   const DeviceNameUtils::ParsedName& local_dev_name = device->parsed_name();
 
+  // Only a CPU device with a step arena, see ThreadPoolDevice::GetAllocator(),
+  // uses the step-scoped attributes. Leave them unset elsewhere since they
+  // also prevent some inputs from being forwarded.
+  std::vector<bool> outputs_may_outlive_step;
+  if (device->device_type() == DEVICE_CPU &&
+      StepArenaAllocator::SlabBytesFromEnv() > 0) {
+    outputs_may_outlive_step = OutputsMayOutliveStep(g);
+  }
+
   std::vector<const Node*> scoped_allocator_instances;
   for (const Node* n : g->nodes()) {
     NodeItem* item = node(n->id());
@@ -452,6 +503,13 @@ Status GraphView::SetAllocAttrs(const Graph* g, const Device* device) {
         h.set_on_host(on_host);
         attrs[out].Merge(h);
       }
+      if (!outputs_may_outlive_step.empty()) {
+        if (outputs_may_outlive_step[n->id()]) {
+          StepArenaAllocator::MarkOutlivesStep(&attrs[out]);
+        } else {
+          StepArenaAllocator::MarkStepScoped(&attrs[out]);
+        }
+      }
     }
   }
   SetScopedAllocatorAttrs(scoped_allocator_instances);
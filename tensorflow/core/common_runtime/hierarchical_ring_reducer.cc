@@ -0,0 +1,361 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/hierarchical_ring_reducer.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "tensorflow/core/common_runtime/collective_rma_local.h"
+#include "tensorflow/core/common_runtime/collective_util.h"
+#include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/common_runtime/dma_helper.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/notification.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/blocking_counter.h"
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/profiler/lib/traceme.h"
+
+namespace tensorflow {
+namespace {
+// Tensors are split into pipeline segments so that each chunk is at most
+// this large.
+constexpr int64_t kMaxChunkSizeBytes = 1024 * 1024;
+// Upper bound on the number of pipeline segments.
+constexpr int kMaxNumSegments = 8;
+
+int Mod(int a, int n) { return ((a % n) + n) % n; }
+}  // namespace
+
+Status HierarchicalRingReducer::InitializeCollectiveParams(
+    CollectiveParams* col_params) {
+  if (col_params->instance.type != REDUCTION_COLLECTIVE ||
+      col_params->instance.impl_details.collective_name !=
+          "HierarchicalRingReduce") {
+    return errors::Internal("Unexpected collective ",
+                            col_params->instance.impl_details.collective_name,
+                            " for HierarchicalRingReducer");
+  }
+  if (col_params->group.device_type != DEVICE_CPU) {
+    return errors::Unimplemented(
+        "HierarchicalRingReduce only supports CPU devices, got ",
+        col_params->group.device_type.type_string());
+  }
+  const int group_size = col_params->group.group_size;
+  const int num_tasks = col_params->group.num_tasks;
+  if (num_tasks <= 0 || group_size % num_tasks != 0) {
+    return errors::InvalidArgument(
+        "HierarchicalRingReduce requires the same number of devices in each "
+        "task, got ",
+        group_size, " devices in ", num_tasks, " tasks");
+  }
+  // Precondition: members are sorted so that all devices in the same task
+  // are adjacent.
+  const int devices_per_task = group_size / num_tasks;
+  for (int di = 0; di < group_size; ++di) {
+    const string& task_name =
+        col_params->group.members[di - (di % devices_per_task)].task;
+    if (col_params->group.members[di].task != task_name) {
+      return errors::InvalidArgument(
+          "HierarchicalRingReduce requires the same number of devices in each "
+          "task, but device ",
+          col_params->group.members[di].device.name(), " is not in task ",
+          task_name);
+    }
+  }
+  return absl::OkStatus();
+}
+
+Status HierarchicalRingReducer::InitializeCollectiveContext(
+    std::shared_ptr<CollectiveContext> col_ctx) {
+  DCHECK(col_ctx->dev_mgr);
+  col_ctx_ = col_ctx;
+  col_params_ = col_ctx->col_params.get();
+  return collective_util::InitializeDeviceAndLocality(
+      col_ctx->dev_mgr, col_ctx->device_name, &col_ctx->device,
+      &col_ctx->device_locality);
+}
+
+void HierarchicalRingReducer::Run(StatusCallback done) {
+  CHECK(col_ctx_);
+  CHECK(col_params_);
+  // Like `RingReducer`, this does not require non-overlapping collectives.
+  col_ctx_->col_exec->UnblockDependencies(*col_params_);
+
+  const int group_size = col_params_->group.group_size;
+  num_tasks_ = col_params_->group.num_tasks;
+  devices_per_task_ = group_size / num_tasks_;
+  task_idx_ = col_params_->default_rank / devices_per_task_;
+  local_idx_ = col_params_->default_rank % devices_per_task_;
+
+  // Start by copying input to output if they're not already the same, i.e. if
+  // we're not computing in-place on the input tensor.
+  if ((col_ctx_->input != col_ctx_->output) &&
+      (DMAHelper::base(col_ctx_->input) != DMAHelper::base(col_ctx_->output))) {
+    Notification note;
+    Status status;
+    CollectiveRemoteAccessLocal::MemCpyAsync(
+        col_ctx_->op_ctx->op_device_context(),
+        col_ctx_->op_ctx->op_device_context(), col_ctx_->device,
+        col_ctx_->device, col_ctx_->op_ctx->input_alloc_attr(0),
+        col_ctx_->op_ctx->output_alloc_attr(0), col_ctx_->input,
+        col_ctx_->output, 0 /*dev_to_dev_stream_index*/,
+        [&note, &status](const Status& s) {
+          status.Update(s);
+          note.Notify();
+        });
+    note.WaitForNotification();
+    if (!status.ok()) {
+      done(status);
+      return;
+    }
+  }
+
+  // Every device computes the same number of segments, since it depends
+  // only on the shape, data type and group.
+  const int64_t tensor_bytes = col_ctx_->output->TotalBytes();
+  const int64_t bytes_per_segment =
+      static_cast<int64_t>(group_size) * kMaxChunkSizeBytes;
+  num_segments_ = static_cast<int>(std::min<int64_t>(
+      std::max<int64_t>(
+          1, (tensor_bytes + bytes_per_segment - 1) / bytes_per_segment),
+      kMaxNumSegments));
+
+  AllocatorAttributes attr = col_ctx_->op_ctx->output_alloc_attr(0);
+  ca_.reset(MakeCollectiveAdapter(col_ctx_->output,
+                                  num_segments_ * group_size,
+                                  col_ctx_->device->GetAllocator(attr)));
+  if (col_params_->final_op) {
+    group_size_tensor_ = ca_->Scalar(group_size);
+  }
+
+  Status s = RunAsyncParts();
+  if (s.ok()) {
+    // Recover the output from the adaptor.
+    ca_->ConsumeFinalValue(col_ctx_->output);
+  }
+  ca_.reset();
+  done(s);
+}
+
+// Note that this function is blocking and must not run in any thread
+// which cannot be blocked.
+Status HierarchicalRingReducer::RunAsyncParts() {
+  const int num_reduce_steps = (devices_per_task_ - 1) + (num_tasks_ - 1);
+  const int steps_per_segment = 2 * num_reduce_steps;
+  if (num_reduce_steps == 0) {
+    for (int segment = 0; segment < num_segments_; ++segment) {
+      TF_RETURN_IF_ERROR(Finalize(ChunkIndex(segment, 0, 0)));
+    }
+    return absl::OkStatus();
+  }
+  // Segment `s` executes step `tick - s` of its schedule, so consecutive
+  // segments are one step apart and their transfers are issued together.
+  const int num_ticks = steps_per_segment + num_segments_ - 1;
+  for (int tick = 0; tick < num_ticks; ++tick) {
+    tsl::profiler::TraceMe activity(
+        [&] { return strings::StrCat("HierarchicalRingReduce:", tick); },
+        tsl::profiler::TraceMeLevel::kInfo);
+    std::vector<Transfer> sends;
+    std::vector<Transfer> recvs;
+    for (int segment = 0; segment < num_segments_; ++segment) {
+      const int step = tick - segment;
+      if (step >= 0 && step < steps_per_segment) {
+        AddStepTransfers(segment, step, &sends, &recvs);
+      }
+    }
+    TF_RETURN_IF_ERROR(ExecuteTransfers(&sends, &recvs));
+    for (Transfer& recv : recvs) {
+      if (recv.reduce) {
+        Tensor chunk = ca_->ChunkAlias(recv.chunk_idx);
+        TF_RETURN_IF_ERROR(collective_util::ComputeBinOp(
+            col_ctx_->op_ctx, col_ctx_->op_params, col_ctx_->device,
+            col_params_->merge_op, &chunk, &recv.tensor));
+      }
+      if (recv.finalize) {
+        TF_RETURN_IF_ERROR(Finalize(recv.chunk_idx));
+      }
+    }
+  }
+  return absl::OkStatus();
+}
+
+void HierarchicalRingReducer::AddStepTransfers(int segment, int step,
+                                               std::vector<Transfer>* sends,
+                                               std::vector<Transfer>* recvs) {
+  const int l = local_idx_;
+  const int t = task_idx_;
+  const int local_steps = devices_per_task_ - 1;
+  const int task_steps = num_tasks_ - 1;
+  const int next_local = Rank(t, Mod(l + 1, devices_per_task_));
+  const int prev_local = Rank(t, Mod(l - 1, devices_per_task_));
+  const int next_task = Rank(Mod(t + 1, num_tasks_), l);
+  const int prev_task = Rank(Mod(t - 1, num_tasks_), l);
+  // After the intra-task reduce-scatter this device owns shard `l + 1`.
+  const int owned_shard = Mod(l + 1, devices_per_task_);
+  // The chunks received in the last reduce-scatter step hold the full
+  // reduction.
+  const bool finalize = (step == local_steps + task_steps - 1);
+  int k = step;
+  if (k < local_steps) {
+    // Intra-task reduce-scatter of whole shards.
+    for (int sub = 0; sub < num_tasks_; ++sub) {
+      AddExchange(step, ChunkIndex(segment, Mod(l - k, devices_per_task_), sub),
+                  next_local,
+                  ChunkIndex(segment, Mod(l - k - 1, devices_per_task_), sub),
+                  prev_local, /*reduce=*/true, finalize, sends, recvs);
+    }
+    return;
+  }
+  k -= local_steps;
+  if (k < task_steps) {
+    // Cross-task reduce-scatter of the chunks of the owned shard.
+    AddExchange(step, ChunkIndex(segment, owned_shard, Mod(t - k, num_tasks_)),
+                next_task,
+                ChunkIndex(segment, owned_shard, Mod(t - k - 1, num_tasks_)),
+                prev_task, /*reduce=*/true, finalize, sends, recvs);
+    return;
+  }
+  k -= task_steps;
+  if (k < task_steps) {
+    // Cross-task all-gather of the chunks of the owned shard.
+    AddExchange(
+        step, ChunkIndex(segment, owned_shard, Mod(t + 1 - k, num_tasks_)),
+        next_task, ChunkIndex(segment, owned_shard, Mod(t - k, num_tasks_)),
+        prev_task, /*reduce=*/false, /*finalize=*/false, sends, recvs);
+    return;
+  }
+  k -= task_steps;
+  // Intra-task all-gather of whole shards.
+  for (int sub = 0; sub < num_tasks_; ++sub) {
+    AddExchange(step,
+                ChunkIndex(segment, Mod(l + 1 - k, devices_per_task_), sub),
+                next_local,
+                ChunkIndex(segment, Mod(l - k, devices_per_task_), sub),
+                prev_local, /*reduce=*/false, /*finalize=*/false, sends,
+                recvs);
+  }
+}
+
+void HierarchicalRingReducer::AddExchange(int step, int send_chunk,
+                                          int send_to, int recv_chunk,
+                                          int recv_from, bool reduce,
+                                          bool finalize,
+                                          std::vector<Transfer>* sends,
+                                          std::vector<Transfer>* recvs) {
+  // Keys name the step, the chunk and the sending rank.  Each device sends
+  // in step `s` the chunk its successor expects to receive in step `s`.
+  Transfer send;
+  send.chunk_idx = send_chunk;
+  send.peer_rank = send_to;
+  send.key = strings::StrCat(col_ctx_->exec_key, ":", step, ":", send_chunk,
+                             ":", col_params_->default_rank);
+  sends->push_back(std::move(send));
+  Transfer recv;
+  recv.chunk_idx = recv_chunk;
+  recv.peer_rank = recv_from;
+  recv.key = strings::StrCat(col_ctx_->exec_key, ":", step, ":", recv_chunk,
+                             ":", recv_from);
+  recv.reduce = reduce;
+  recv.finalize = finalize;
+  recvs->push_back(std::move(recv));
+}
+
+Status HierarchicalRingReducer::ExecuteTransfers(
+    std::vector<Transfer>* sends, std::vector<Transfer>* recvs) {
+  // Chunks with no bytes (possible for tiny tensors) are skipped by every
+  // device alike.
+  auto is_empty = [this](const Transfer& t) {
+    return ca_->ChunkBytes(t.chunk_idx) == 0;
+  };
+  sends->erase(std::remove_if(sends->begin(), sends->end(), is_empty),
+               sends->end());
+  recvs->erase(std::remove_if(recvs->begin(), recvs->end(), is_empty),
+               recvs->end());
+  if (sends->empty() && recvs->empty()) return absl::OkStatus();
+
+  BlockingCounter pending(sends->size() + recvs->size());
+  auto on_done = [this, &pending](const Status& s) {
+    if (!s.ok()) StartAbort(s);
+    pending.DecrementCount();
+  };
+  const auto& members = col_params_->group.members;
+  for (Transfer& send : *sends) {
+    send.tensor = ca_->ChunkAlias(send.chunk_idx);
+    const CollGroupMember& peer = members[send.peer_rank];
+    col_ctx_->col_exec->remote_access()->PostToPeer(
+        peer.device.name(), peer.task, send.key, col_ctx_->device,
+        col_ctx_->op_ctx->op_device_context(),
+        col_ctx_->op_ctx->output_alloc_attr(0), &send.tensor,
+        col_ctx_->device_locality, col_ctx_->op_ctx->cancellation_manager(),
+        on_done);
+  }
+  for (Transfer& recv : *recvs) {
+    recv.tensor = recv.reduce ? ca_->TempChunk(recv.chunk_idx)
+                              : ca_->ChunkAlias(recv.chunk_idx);
+    const CollGroupMember& peer = members[recv.peer_rank];
+    col_ctx_->col_exec->remote_access()->RecvFromPeer(
+        peer.device.name(), peer.task, peer.is_local, recv.key,
+        col_ctx_->device, col_ctx_->op_ctx->op_device_context(),
+        col_ctx_->op_ctx->output_alloc_attr(0), &recv.tensor,
+        col_ctx_->device_locality, 0 /*dev_to_dev_stream_index*/,
+        col_ctx_->op_ctx->cancellation_manager(), on_done);
+  }
+  pending.Wait();
+  mutex_lock l(status_mu_);
+  return status_;
+}
+
+Status HierarchicalRingReducer::Finalize(int chunk_idx) {
+  if (col_params_->final_op == nullptr || ca_->ChunkBytes(chunk_idx) == 0) {
+    return absl::OkStatus();
+  }
+  Tensor chunk = ca_->ChunkAlias(chunk_idx);
+  return collective_util::ComputeBinOp(
+      col_ctx_->op_ctx, col_ctx_->op_params, col_ctx_->device,
+      col_params_->final_op, &chunk, &group_size_tensor_);
+}
+
+void HierarchicalRingReducer::StartAbort(const Status& s) {
+  bool abort_started = false;
+  {
+    mutex_lock l(status_mu_);
+    if (status_.ok()) {
+      LOG(ERROR) << "Aborting HierarchicalRingReduce with " << s;
+      abort_started = true;
+      status_.Update(s);
+    }
+  }
+  // Aborting the executor cancels the outstanding transfers of all devices,
+  // unless this is a cancellation that is doing so already.
+  if (abort_started) {
+    if (col_ctx_->op_ctx->cancellation_manager() == nullptr ||
+        (!col_ctx_->op_ctx->cancellation_manager()->IsCancelled() &&
+         !col_ctx_->op_ctx->cancellation_manager()->IsCancelling())) {
+      col_ctx_->col_exec->StartAbort(s);
+    }
+  }
+}
+
+namespace {
+REGISTER_COLLECTIVE(HierarchicalRingReduce, HierarchicalRingReducer);
+}  // namespace
+
+}  // namespace tensorflow
@@ -0,0 +1,111 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_HIERARCHICAL_RING_REDUCER_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_HIERARCHICAL_RING_REDUCER_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/base_collective_executor.h"
+#include "tensorflow/core/framework/collective.h"
+#include "tensorflow/core/framework/tensor.h"
+
+namespace tensorflow {
+
+// Two-level implementation of collective all-reduce for groups whose devices
+// are spread over several tasks, each task contributing the same number of
+// devices.
+//
+// With L devices per task and T tasks the tensor is split into L shards of
+// T chunks each.  The algorithm runs
+//  1. a ring reduce-scatter of the shards among the devices of each task,
+//  2. a ring all-reduce of the shard each device now owns, across the T
+//     devices with the same index within their task, and
+//  3. a ring all-gather of the shards among the devices of each task.
+// Only 1/L of the tensor crosses task boundaries from each device, and the
+// cross-task exchanges run with T - 1 hops instead of the L * T - 1 of a flat
+// ring.  Large tensors are further split into segments whose schedules are
+// staggered by one step, so that the intra-task phases of one segment overlap
+// with the cross-task phases of another.
+class HierarchicalRingReducer : public CollectiveImplementationInterface {
+ public:
+  HierarchicalRingReducer() = default;
+  ~HierarchicalRingReducer() override = default;
+
+  // Verifies that devices are grouped by task with the same number of
+  // devices per task.
+  Status InitializeCollectiveParams(CollectiveParams* col_params) override;
+
+  // Initializes members of CollectiveContext not yet initialized, i.e. device
+  // and device_locality.  Also saves the CollectiveContext in this object.
+  Status InitializeCollectiveContext(
+      std::shared_ptr<CollectiveContext> col_ctx) override;
+
+  // Begins async execution of the hierarchical all-reduce.
+  // Must be called in a blockable thread.
+  void Run(StatusCallback done) override;
+
+ private:
+  // A chunk exchanged with a peer in one step of a segment's schedule.
+  struct Transfer {
+    int chunk_idx;
+    int peer_rank;
+    string key;
+    Tensor tensor;
+    // For receives: whether `tensor` is a temporary to be merged into the
+    // chunk, and whether the chunk is fully reduced afterwards.
+    bool reduce = false;
+    bool finalize = false;
+  };
+
+  Status RunAsyncParts();
+  // Appends the sends and receives of `step` for `segment` to `sends` and
+  // `recvs`.
+  void AddStepTransfers(int segment, int step, std::vector<Transfer>* sends,
+                        std::vector<Transfer>* recvs);
+  // Sends `send_chunk` to rank `send_to` while receiving `recv_chunk` from
+  // rank `recv_from`.
+  void AddExchange(int step, int send_chunk, int send_to, int recv_chunk,
+                   int recv_from, bool reduce, bool finalize,
+                   std::vector<Transfer>* sends, std::vector<Transfer>* recvs);
+  // Issues all transfers and waits for them to complete.
+  Status ExecuteTransfers(std::vector<Transfer>* sends,
+                          std::vector<Transfer>* recvs);
+  Status Finalize(int chunk_idx);
+  void StartAbort(const Status& s);
+
+  int ChunkIndex(int segment, int shard, int sub) const {
+    return (segment * devices_per_task_ + shard) * num_tasks_ + sub;
+  }
+  int Rank(int task, int local) const {
+    return task * devices_per_task_ + local;
+  }
+
+  std::shared_ptr<CollectiveContext> col_ctx_;
+  const CollectiveParams* col_params_ = nullptr;  // Not owned
+  std::unique_ptr<CollectiveAdapter> ca_;
+  Tensor group_size_tensor_;
+  int num_tasks_ = 0;
+  int devices_per_task_ = 0;
+  int task_idx_ = 0;
+  int local_idx_ = 0;
+  int num_segments_ = 0;
+  mutex status_mu_;
+  Status status_ TF_GUARDED_BY(status_mu_);
+};
+
+}  // namespace tensorflow
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_HIERARCHICAL_RING_REDUCER_H_
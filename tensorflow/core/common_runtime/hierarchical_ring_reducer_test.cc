@@ -0,0 +1,145 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/hierarchical_ring_reducer.h"
+
+#include <memory>
+#include <tuple>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/collective_test_util.h"
+#include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/common_runtime/process_util.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/blocking_counter.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/public/version.h"
+
+namespace tensorflow {
+namespace {
+
+std::unique_ptr<OpKernel> GetBinOp(const string& op, Device* device) {
+  NodeDef node_def;
+  TF_CHECK_OK(NodeDefBuilder(strings::StrCat(op, "_node"), op)
+                  .Attr("T", DT_FLOAT)
+                  .Input(FakeInput(DT_FLOAT))
+                  .Input(FakeInput(DT_FLOAT))
+                  .Finalize(&node_def));
+  Status status;
+  std::unique_ptr<OpKernel> k = CreateOpKernel(
+      DEVICE_CPU, device, device->GetAllocator(AllocatorAttributes()),
+      node_def, TF_GRAPH_DEF_VERSION, &status);
+  TF_CHECK_OK(status);
+  return k;
+}
+
+// Runs a mean all-reduce where rank `r` contributes `i + r` at element `i`,
+// and returns the status and output of every rank.
+std::vector<Status> RunMeanReduce(CollectiveTestEnv* test_env,
+                                  int64_t num_elements,
+                                  std::vector<Tensor>* outputs) {
+  const int group_size =
+      test_env->num_workers * test_env->num_devices_per_worker;
+  outputs->clear();
+  for (int rank = 0; rank < group_size; ++rank) {
+    Tensor t(DT_FLOAT, TensorShape({num_elements}));
+    auto flat = t.flat<float>();
+    for (int64_t i = 0; i < num_elements; ++i) {
+      flat(i) = static_cast<float>(i + rank);
+    }
+    outputs->push_back(std::move(t));
+  }
+  std::vector<Status> statuses(group_size);
+  BlockingCounter counter(group_size);
+  for (int rank = 0; rank < group_size; ++rank) {
+    SchedClosure([test_env, rank, num_elements, outputs, &statuses,
+                  &counter]() {
+      auto col_params = CreateCollectiveParams(
+          *test_env, rank, "HierarchicalRingReduce", REDUCTION_COLLECTIVE,
+          DT_FLOAT, TensorShape({num_elements}));
+      Device* device = nullptr;
+      TF_CHECK_OK(test_env->device_mgr->LookupDevice(
+          col_params->group.members[rank].device.name(), &device));
+      std::unique_ptr<OpKernel> merge_op = GetBinOp("Add", device);
+      std::unique_ptr<OpKernel> final_op = GetBinOp("Div", device);
+      col_params->merge_op = merge_op.get();
+      col_params->final_op = final_op.get();
+      Tensor* tensor = &(*outputs)[rank];
+      statuses[rank] = RunCollective(test_env, col_params.get(), device,
+                                     tensor, tensor);
+      counter.DecrementCount();
+    });
+  }
+  counter.Wait();
+  return statuses;
+}
+
+void ExpectMean(const Tensor& output, int group_size) {
+  Tensor expected(DT_FLOAT, output.shape());
+  auto flat = expected.flat<float>();
+  for (int64_t i = 0; i < flat.size(); ++i) {
+    flat(i) = static_cast<float>(i) + (group_size - 1) / 2.0f;
+  }
+  test::ExpectTensorEqual<float>(output, expected);
+}
+
+class HierarchicalRingReducerTest
+    : public ::testing::TestWithParam<
+          std::tuple</*num_workers=*/int, /*num_devices_per_worker=*/int,
+                     /*num_elements=*/int64_t>> {};
+
+TEST_P(HierarchicalRingReducerTest, Mean) {
+  const auto [num_workers, num_devices, num_elements] = GetParam();
+  std::unique_ptr<CollectiveTestEnv> test_env =
+      CreateCollectiveTestEnv(num_workers, num_devices, DEVICE_CPU);
+  std::vector<Tensor> outputs;
+  std::vector<Status> statuses =
+      RunMeanReduce(test_env.get(), num_elements, &outputs);
+  for (int rank = 0; rank < outputs.size(); ++rank) {
+    TF_ASSERT_OK(statuses[rank]) << "rank " << rank;
+    ExpectMean(outputs[rank], num_workers * num_devices);
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    Shapes, HierarchicalRingReducerTest,
+    ::testing::Values(std::make_tuple(1, 1, 8), std::make_tuple(1, 3, 1001),
+                      std::make_tuple(3, 1, 1001), std::make_tuple(2, 2, 16),
+                      std::make_tuple(2, 3, 1001), std::make_tuple(3, 2, 5),
+                      // Large enough to be split into pipeline segments.
+                      std::make_tuple(2, 2, 5 * 1024 * 1024 / 4 + 7)));
+
+TEST(HierarchicalRingReducerFailureTest, PropagatesErrors) {
+  std::unique_ptr<CollectiveTestEnv> test_env =
+      CreateCollectiveTestEnv(/*num_workers=*/2, /*num_devices_per_worker=*/2,
+                              DEVICE_CPU);
+  test_env->remote_access->set_fail_after(3);
+  std::vector<Tensor> outputs;
+  std::vector<Status> statuses =
+      RunMeanReduce(test_env.get(), /*num_elements=*/1001, &outputs);
+  int num_failures = 0;
+  for (const Status& status : statuses) {
+    if (!status.ok()) ++num_failures;
+  }
+  EXPECT_GT(num_failures, 0);
+}
+
+}  // namespace
+}  // namespace tensorflow
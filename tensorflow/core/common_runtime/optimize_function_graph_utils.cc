@@ -36,6 +36,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/function_utils.h"
 #include "tensorflow/core/common_runtime/local_device.h"
 #include "tensorflow/core/common_runtime/optimization_registry.h"
+#include "tensorflow/core/common_runtime/optimized_function_graph_cache.h"
 #include "tensorflow/core/common_runtime/optimized_function_graph_info.h"
 #include "tensorflow/core/common_runtime/partitioning_utils.h"
 #include "tensorflow/core/common_runtime/placer.h"
@@ -49,6 +50,7 @@ limitations under the License.
 #include "tensorflow/core/graph/graph.h"
 #include "tensorflow/core/graph/graph_node_util.h"
 #include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/fingerprint.h"
 #include "tensorflow/core/platform/refcount.h"
 #include "tensorflow/core/util/debug_data_dumper.h"
 #include "tsl/platform/env.h"
@@ -257,6 +259,26 @@ string GetFileCacheName(const string& dir_name, const string& function_name,
                       fdef->node_def_size());
 }
 
+// Gets the full path name of the file cache, named by the fingerprint of
+// everything the optimized graph depends on (see
+// OptimizedFunctionGraphCache::Key), so that the cache stays valid across
+// process restarts and is never stale.
+string GetFingerprintFileCacheName(
+    const string& dir_name, const string& function_name, AttrSlice attrs,
+    const FunctionLibraryRuntime::InstantiateOptions& options,
+    const DeviceSet& dev_set, const FunctionLibraryDefinition& lib_def,
+    const std::vector<CompositeDevice*>& composite_devices) {
+  // The key of `options.lib_def` is its address, which differs across runs;
+  // its content is part of the key through `lib_def`.
+  FunctionLibraryRuntime::InstantiateOptions stable_options = options;
+  stable_options.lib_def = nullptr;
+  const string key =
+      OptimizedFunctionGraphCache::Key(function_name, attrs, stable_options,
+                                       dev_set, lib_def, composite_devices);
+  return absl::StrCat(dir_name, "/", function_name, "_",
+                      absl::Hex(Fingerprint64(key), absl::kZeroPad16));
+}
+
 // Generates graph and return information given the input function name,
 // attributes and function definition.
 Status GetGraphAndArgRets(const string& function_name, AttrSlice attrs,
@@ -659,14 +681,16 @@ OptimizeFunctionGraphOrReadFromFileCache(
     const DeviceSet& dev_set, const FunctionLibraryDefinition* input_lib_def,
     const std::vector<CompositeDevice*>& composite_devices, Device* cpu_device,
     Device* default_device, Env* env,
-    absl::Duration caching_threshold_duration) {
+    absl::Duration caching_threshold_duration, const string& cache_dir) {
   // There are 3 scenarios in this codepath:
   // (1) This function is not eligible for caching.
   // (2) This function is eligible for caching and its cache exists.
   // (3) This function is eligible for caching and its cache does not exist.
 
-  // Get the caching directory from Env variable.
-  const string dir_name = absl::StrCat(getenv(kGraphCachingEnvVariableName));
+  // Get the caching directory from the arguments or the Env variable.
+  const string dir_name =
+      cache_dir.empty() ? absl::StrCat(getenv(kGraphCachingEnvVariableName))
+                        : cache_dir;
 
   // Scenario (1): Not eligible for caching. Run the optimization passes.
   if (dir_name.empty() || options.is_component_function) {
@@ -686,7 +710,12 @@ OptimizeFunctionGraphOrReadFromFileCache(
         "Failed to find function ", function_name,
         " in function library: ", lib_def->ToProto().DebugString()));
   }
-  const string file_name = GetFileCacheName(dir_name, function_name, fdef);
+  const string file_name =
+      cache_dir.empty()
+          ? GetFileCacheName(dir_name, function_name, fdef)
+          : GetFingerprintFileCacheName(dir_name, function_name, attrs,
+                                        options, dev_set, *lib_def,
+                                        composite_devices);
 
   // Scenario (2): File cache exists for this function; restore from the cache.
   if (env->FileExists(file_name).ok()) {
@@ -67,6 +67,10 @@ absl::StatusOr<OptimizedFunctionGraphInfo> OptimizeFunctionGraph(
 // the file cache if existent. If cache loading fails, it goes ahead and runs
 // the graph optimization passes. Returns error if running the optimization
 // passes fails.
+// The file cache is in `cache_dir` if it is not empty, where the files are
+// named by the fingerprint of the function, its library, the options and the
+// devices. Otherwise it is in the directory given by the TF_GRAPH_CACHING env
+// variable, where the files are named by the function name and size.
 absl::StatusOr<OptimizedFunctionGraphInfo>
 OptimizeFunctionGraphOrReadFromFileCache(
     const string& function_name, AttrSlice attrs,
@@ -74,7 +78,8 @@ OptimizeFunctionGraphOrReadFromFileCache(
     const DeviceSet& dev_set, const FunctionLibraryDefinition* input_lib_def,
     const std::vector<CompositeDevice*>& composite_devices, Device* cpu_device,
     Device* default_device, Env* env,
-    absl::Duration caching_threshold_duration = kCachingThresholdDuration);
+    absl::Duration caching_threshold_duration = kCachingThresholdDuration,
+    const string& cache_dir = "");
 
 // Pre-processes, partitions and post-optimizes the input graph; returns
 // subgraph result (maps from device name to the subgraph); returns error if any
@@ -28,6 +28,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/function_testlib.h"
 #include "tensorflow/core/common_runtime/optimized_function_graph_info.h"
 #include "tensorflow/core/framework/metrics.h"
+#include "tensorflow/core/platform/path.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/public/session_options.h"
 #include "tsl/platform/env.h"
@@ -246,5 +247,60 @@ TEST(OptimizeFunctionGraphTest, OptimizeFunctionGraphAndWriteToCache) {
   ASSERT_TRUE(empty_file_list.empty());
 }
 
+TEST(OptimizeFunctionGraphTest, WriteToFingerprintFileCache) {
+  Env* env = Env::Default();
+  const string cache_dir =
+      io::JoinPath(testing::TmpDir(), "fingerprint_cache_directory");
+  TF_ASSERT_OK(env->RecursivelyCreateDir(cache_dir));
+
+  FunctionLibraryRuntime::InstantiateOptions opts;
+  opts.is_multi_device_function = true;
+  FunctionDefLibrary proto;
+  *(proto.add_function()) = test::function::FindDevice();
+  auto lib_def =
+      std::make_unique<FunctionLibraryDefinition>(OpRegistry::Global(), proto);
+  std::vector<std::unique_ptr<Device>> devices;
+  CreateCpuDeviceList(kDevicePrefix, 2, devices);
+  DeviceSet device_set;
+  for (const auto& device : devices) {
+    device_set.AddDevice(device.get());
+  }
+
+  const auto optimize = [&]() {
+    return OptimizeFunctionGraphOrReadFromFileCache(
+        "FindDevice", {}, opts, device_set, lib_def.get(),
+        /*composite_devices=*/{}, devices[0].get(), devices[1].get(),
+        Env::Default(), /*caching_threshold_duration=*/absl::ZeroDuration(),
+        cache_dir);
+  };
+  const auto num_cache_files = [&]() {
+    std::vector<string> file_list;
+    TF_CHECK_OK(env->GetMatchingPaths(
+        io::JoinPath(cache_dir, "FindDevice_*"), &file_list));
+    return file_list.size();
+  };
+
+  TF_ASSERT_OK(optimize().status());
+  EXPECT_EQ(num_cache_files(), 1);
+
+  // The same function is read from its file.
+  absl::StatusOr<OptimizedFunctionGraphInfo> optimized_info = optimize();
+  TF_ASSERT_OK(optimized_info.status());
+  EXPECT_EQ(optimized_info->name, "FindDevice");
+  EXPECT_EQ(optimized_info->num_return_nodes, 1);
+  EXPECT_EQ(num_cache_files(), 1);
+
+  // A changed function with the same name gets a file of its own.
+  FunctionDef fdef = test::function::FindDevice();
+  fdef.mutable_signature()->set_description("changed");
+  TF_ASSERT_OK(lib_def->ReplaceFunction("FindDevice", fdef));
+  TF_ASSERT_OK(optimize().status());
+  EXPECT_EQ(num_cache_files(), 2);
+
+  int64_t undeleted_files, undeleted_dirs;
+  TF_EXPECT_OK(
+      env->DeleteRecursively(cache_dir, &undeleted_files, &undeleted_dirs));
+}
+
 }  // namespace
 }  // namespace tensorflow
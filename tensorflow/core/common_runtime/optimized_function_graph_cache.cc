@@ -0,0 +1,113 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/optimized_function_graph_cache.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
+#include "tensorflow/core/framework/device.h"
+#include "tensorflow/core/framework/function.pb.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+
+OptimizedFunctionGraphCache* OptimizedFunctionGraphCache::Global() {
+  static OptimizedFunctionGraphCache* const cache =
+      []() -> OptimizedFunctionGraphCache* {
+    int64_t max_entries;
+    TF_CHECK_OK(ReadInt64FromEnvVar("TF_FUNCTION_GRAPH_CACHE_MAX_ENTRIES", 0,
+                                    &max_entries));
+    if (max_entries <= 0) return nullptr;
+    return new OptimizedFunctionGraphCache(max_entries);
+  }();
+  return cache;
+}
+
+std::string OptimizedFunctionGraphCache::Key(
+    const std::string& function_name, AttrSlice attrs,
+    const FunctionLibraryRuntime::InstantiateOptions& options,
+    const DeviceSet& dev_set, const FunctionLibraryDefinition& lib_def,
+    const std::vector<CompositeDevice*>& composite_devices) {
+  const FunctionDef* fdef = lib_def.Find(function_name);
+  if (fdef == nullptr) return "";
+  FunctionDefLibrary library = lib_def.ReachableDefinitions(*fdef).ToProto();
+  *library.add_function() = *fdef;
+
+  std::vector<std::string> device_names;
+  device_names.reserve(dev_set.devices().size() + composite_devices.size());
+  for (const Device* device : dev_set.devices()) {
+    device_names.push_back(device->name());
+  }
+  for (const CompositeDevice* device : composite_devices) {
+    device_names.push_back(
+        absl::StrCat(device->name(), "=",
+                     absl::StrJoin(*device->underlying_devices(), "+")));
+  }
+  std::sort(device_names.begin(), device_names.end());
+
+  return absl::StrCat(Canonicalize(function_name, attrs, options), ";",
+                      DeterministicProtoHash64(library), ";",
+                      absl::StrJoin(device_names, ","));
+}
+
+std::optional<OptimizedFunctionGraphInfo> OptimizedFunctionGraphCache::Lookup(
+    const std::string& key) {
+  std::shared_ptr<const OptimizedFunctionGraph> entry;
+  {
+    tf_shared_lock l(mu_);
+    auto it = entries_.find(key);
+    if (it == entries_.end()) return std::nullopt;
+    entry = it->second;
+  }
+  OptimizedFunctionGraph proto = *entry;
+  absl::StatusOr<OptimizedFunctionGraphInfo> info =
+      OptimizedFunctionGraphInfo::FromProto(std::move(proto));
+  if (!info.ok()) {
+    LOG(WARNING) << "Failed to restore the cached optimized graph of "
+                 << entry->name() << ": " << info.status();
+    return std::nullopt;
+  }
+  return std::move(info).value();
+}
+
+void OptimizedFunctionGraphCache::Insert(
+    const std::string& key, const OptimizedFunctionGraphInfo& info) {
+  auto entry = std::make_shared<const OptimizedFunctionGraph>(
+      OptimizedFunctionGraphInfo::ToProto(info));
+  mutex_lock l(mu_);
+  if (!entries_.try_emplace(key, std::move(entry)).second) return;
+  insertion_order_.push_back(key);
+  while (insertion_order_.size() > static_cast<size_t>(max_entries_)) {
+    entries_.erase(insertion_order_.front());
+    insertion_order_.pop_front();
+  }
+}
+
+int64_t OptimizedFunctionGraphCache::size() const {
+  tf_shared_lock l(mu_);
+  return entries_.size();
+}
+
+}  // namespace tensorflow
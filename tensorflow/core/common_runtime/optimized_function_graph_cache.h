@@ -0,0 +1,86 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_OPTIMIZED_FUNCTION_GRAPH_CACHE_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_OPTIMIZED_FUNCTION_GRAPH_CACHE_H_
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/common_runtime/composite_device.h"
+#include "tensorflow/core/common_runtime/device_set.h"
+#include "tensorflow/core/common_runtime/optimized_function_graph_info.h"
+#include "tensorflow/core/framework/function.h"
+#include "tensorflow/core/framework/optimized_function_graph.pb.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+
+// Thread-safe.
+// An in-memory cache of the optimized graphs of multi-device functions, keyed
+// by everything the graph optimizations depend on: the function and its
+// reachable library, the instantiation attributes and options, and the names
+// of the devices. ProcessFunctionLibraryRuntimes instantiating the same
+// function on the same devices, e.g. the sessions or eager contexts of the
+// tenants of a model server, then run the graph optimization passes once.
+//
+// The entries are immutable and shared; every lookup returns its own copy to
+// partition and instantiate, since the executors and kernels belong to the
+// devices of each runtime. When the cache is full, the oldest entry is evicted.
+class OptimizedFunctionGraphCache {
+ public:
+  explicit OptimizedFunctionGraphCache(int64_t max_entries)
+      : max_entries_(max_entries) {}
+
+  // Returns the process-wide cache, holding up to the number of entries given
+  // by the TF_FUNCTION_GRAPH_CACHE_MAX_ENTRIES environment variable, or
+  // nullptr if it is not positive (the default).
+  static OptimizedFunctionGraphCache* Global();
+
+  // Returns the key of the optimized graph of `function_name`, or an empty
+  // string if the function can't be found in `lib_def`.
+  static std::string Key(
+      const std::string& function_name, AttrSlice attrs,
+      const FunctionLibraryRuntime::InstantiateOptions& options,
+      const DeviceSet& dev_set, const FunctionLibraryDefinition& lib_def,
+      const std::vector<CompositeDevice*>& composite_devices);
+
+  // Returns a copy of the optimized graph cached under `key`, if any.
+  std::optional<OptimizedFunctionGraphInfo> Lookup(const std::string& key);
+
+  void Insert(const std::string& key, const OptimizedFunctionGraphInfo& info);
+
+  int64_t size() const;
+
+ private:
+  const int64_t max_entries_;
+
+  mutable mutex mu_;
+  absl::flat_hash_map<std::string,
+                      std::shared_ptr<const OptimizedFunctionGraph>>
+      entries_ TF_GUARDED_BY(mu_);
+  // The keys of `entries_`, oldest first.
+  std::deque<std::string> insertion_order_ TF_GUARDED_BY(mu_);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_OPTIMIZED_FUNCTION_GRAPH_CACHE_H_
@@ -0,0 +1,119 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/optimized_function_graph_cache.h"
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "xla/tsl/lib/core/status_test_util.h"
+#include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/common_runtime/device_factory.h"
+#include "tensorflow/core/common_runtime/device_set.h"
+#include "tensorflow/core/common_runtime/function_testlib.h"
+#include "tensorflow/core/common_runtime/optimize_function_graph_utils.h"
+#include "tensorflow/core/common_runtime/optimized_function_graph_info.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/public/session_options.h"
+#include "tsl/platform/env.h"
+
+namespace tensorflow {
+namespace {
+
+class OptimizedFunctionGraphCacheTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    SessionOptions options;
+    (*options.config.mutable_device_count())["CPU"] = 2;
+    TF_ASSERT_OK(DeviceFactory::AddDevices(options, "/job:a/replica:0/task:0",
+                                           &devices_));
+    for (const auto& device : devices_) {
+      device_set_.AddDevice(device.get());
+    }
+    FunctionDefLibrary proto;
+    *proto.add_function() = test::function::FindDevice();
+    lib_def_ = std::make_unique<FunctionLibraryDefinition>(
+        OpRegistry::Global(), proto);
+    opts_.is_multi_device_function = true;
+  }
+
+  std::string Key(const FunctionLibraryRuntime::InstantiateOptions& opts) {
+    return OptimizedFunctionGraphCache::Key("FindDevice", {}, opts, device_set_,
+                                            *lib_def_,
+                                            /*composite_devices=*/{});
+  }
+
+  std::vector<std::unique_ptr<Device>> devices_;
+  DeviceSet device_set_;
+  std::unique_ptr<FunctionLibraryDefinition> lib_def_;
+  FunctionLibraryRuntime::InstantiateOptions opts_;
+};
+
+TEST_F(OptimizedFunctionGraphCacheTest, Key) {
+  const std::string key = Key(opts_);
+  EXPECT_FALSE(key.empty());
+  EXPECT_EQ(Key(opts_), key);
+
+  FunctionLibraryRuntime::InstantiateOptions other_opts = opts_;
+  other_opts.target = devices_[1]->name();
+  EXPECT_NE(Key(other_opts), key);
+
+  // The key depends on the function definition, not just its name.
+  FunctionDef fdef = test::function::FindDevice();
+  fdef.mutable_signature()->set_description("changed");
+  TF_ASSERT_OK(lib_def_->ReplaceFunction("FindDevice", fdef));
+  EXPECT_NE(Key(opts_), key);
+
+  EXPECT_EQ(OptimizedFunctionGraphCache::Key("Missing", {}, opts_, device_set_,
+                                             *lib_def_,
+                                             /*composite_devices=*/{}),
+            "");
+}
+
+TEST_F(OptimizedFunctionGraphCacheTest, LookupReturnsCopies) {
+  absl::StatusOr<OptimizedFunctionGraphInfo> info = OptimizeFunctionGraph(
+      "FindDevice", {}, opts_, device_set_, lib_def_.get(),
+      /*composite_devices=*/{}, devices_[0].get(), devices_[0].get(),
+      Env::Default(), OptimizedFunctionGraph::JIT);
+  TF_ASSERT_OK(info.status());
+
+  OptimizedFunctionGraphCache cache(/*max_entries=*/1);
+  const std::string key = Key(opts_);
+  EXPECT_FALSE(cache.Lookup(key).has_value());
+  cache.Insert(key, *info);
+  EXPECT_EQ(cache.size(), 1);
+
+  for (int i = 0; i < 2; ++i) {
+    std::optional<OptimizedFunctionGraphInfo> cached = cache.Lookup(key);
+    ASSERT_TRUE(cached.has_value());
+    EXPECT_EQ(cached->name, "FindDevice");
+    EXPECT_EQ(cached->num_return_nodes, info->num_return_nodes);
+    EXPECT_EQ(cached->ret_types, info->ret_types);
+    EXPECT_EQ(cached->function_graph->num_op_nodes(),
+              info->function_graph->num_op_nodes());
+  }
+
+  // The oldest entry is evicted when the cache is full.
+  cache.Insert("other", *info);
+  EXPECT_EQ(cache.size(), 1);
+  EXPECT_FALSE(cache.Lookup(key).has_value());
+  EXPECT_TRUE(cache.Lookup("other").has_value());
+}
+
+}  // namespace
+}  // namespace tensorflow
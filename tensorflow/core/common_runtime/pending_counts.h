@@ -99,6 +99,12 @@ class PendingCounts {
 
   ~PendingCounts() { delete[] bytes_; }
 
+  // Resets the counts to those of `other`, which must have the same layout.
+  void CopyFrom(const PendingCounts& other) {
+    DCHECK_EQ(num_bytes_, other.num_bytes_);
+    memcpy(bytes_, other.bytes_, num_bytes_);
+  }
+
   void set_initial_count(Handle h, size_t pending_count) {
     if (h.is_large_) {
       std::atomic<LargeCounts>* c_ptr = Large(h);
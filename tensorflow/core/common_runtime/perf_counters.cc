@@ -0,0 +1,128 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/perf_counters.h"
+
+#include <cstdint>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#endif
+
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+namespace {
+
+#if defined(__linux__)
+// Opens the counter `config` of the user space of the calling thread, in the
+// group of `group_fd` if it isn't -1.
+int OpenCounter(uint64_t config, int group_fd) {
+  struct perf_event_attr attr;
+  memset(&attr, 0, sizeof(attr));
+  attr.type = PERF_TYPE_HARDWARE;
+  attr.size = sizeof(attr);
+  attr.config = config;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  attr.read_format = PERF_FORMAT_GROUP;
+  return syscall(SYS_perf_event_open, &attr, /*pid=*/0, /*cpu=*/-1, group_fd,
+                 /*flags=*/0);
+}
+
+// The counters of a thread, in a group led by the cycles so that a single
+// read(2) returns them all.
+class ThreadCounters {
+ public:
+  ThreadCounters() {
+    cycles_fd_ = OpenCounter(PERF_COUNT_HW_CPU_CYCLES, /*group_fd=*/-1);
+    if (cycles_fd_ >= 0) {
+      instructions_fd_ = OpenCounter(PERF_COUNT_HW_INSTRUCTIONS, cycles_fd_);
+      llc_misses_fd_ = OpenCounter(PERF_COUNT_HW_CACHE_MISSES, cycles_fd_);
+    }
+    if (cycles_fd_ < 0 || instructions_fd_ < 0 || llc_misses_fd_ < 0) {
+      LOG_FIRST_N(WARNING, 1) << "Cannot open the hardware counters: "
+                              << strerror(errno);
+      Close();
+    }
+  }
+
+  ~ThreadCounters() { Close(); }
+
+  bool Read(PerfCounters::Values* values) {
+    if (cycles_fd_ < 0) return false;
+    // The number of counters, then their values in the order of the group.
+    uint64_t buffer[4];
+    if (read(cycles_fd_, buffer, sizeof(buffer)) != sizeof(buffer) ||
+        buffer[0] != 3) {
+      return false;
+    }
+    values->cycles = buffer[1];
+    values->instructions = buffer[2];
+    values->llc_misses = buffer[3];
+    return true;
+  }
+
+ private:
+  void Close() {
+    for (int* fd : {&llc_misses_fd_, &instructions_fd_, &cycles_fd_}) {
+      if (*fd >= 0) close(*fd);
+      *fd = -1;
+    }
+  }
+
+  int cycles_fd_ = -1;
+  int instructions_fd_ = -1;
+  int llc_misses_fd_ = -1;
+};
+#endif  // defined(__linux__)
+
+}  // namespace
+
+bool PerfCounters::Enabled() {
+  static const bool enabled = [] {
+    bool enabled;
+    TF_CHECK_OK(
+        ReadBoolFromEnvVar("TF_PROFILER_PERF_COUNTERS", false, &enabled));
+    return enabled;
+  }();
+  return enabled;
+}
+
+bool PerfCounters::Read(Values* values) {
+#if defined(__linux__)
+  thread_local ThreadCounters counters;
+  return counters.Read(values);
+#else
+  return false;
+#endif
+}
+
+PerfCounters::Values PerfCounters::Delta(const Values& start,
+                                         const Values& end) {
+  Values delta;
+  delta.cycles = end.cycles - start.cycles;
+  delta.instructions = end.instructions - start.instructions;
+  delta.llc_misses = end.llc_misses - start.llc_misses;
+  return delta;
+}
+
+}  // namespace tensorflow
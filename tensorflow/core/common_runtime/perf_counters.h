@@ -0,0 +1,60 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_PERF_COUNTERS_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_PERF_COUNTERS_H_
+
+#include <cstdint>
+
+namespace tensorflow {
+
+// The hardware counters of the calling thread, read with perf_event_open(2)
+// around the computation of the kernels when TF_PROFILER_PERF_COUNTERS is set.
+// The executor records their deltas in the TraceMe of the ops, which become
+// stats of the events of the host XPlane and tell the memory-bound kernels
+// from the compute-bound ones.
+//
+// Only the calling thread is counted: the work a kernel shards over the other
+// worker threads isn't.
+class PerfCounters {
+ public:
+  // The size of the cache lines, which approximates the bytes read from the
+  // DRAM by a miss of the last level cache.
+  static constexpr uint64_t kCacheLineSize = 64;
+
+  struct Values {
+    uint64_t cycles = 0;
+    uint64_t instructions = 0;
+    uint64_t llc_misses = 0;
+
+    uint64_t dram_bytes() const { return llc_misses * kCacheLineSize; }
+  };
+
+  // Returns whether the counters are enabled by the TF_PROFILER_PERF_COUNTERS
+  // environment variable.
+  static bool Enabled();
+
+  // Reads the counters of the calling thread, which are opened by its first
+  // call. Returns false if they can't be opened, e.g. outside of Linux or when
+  // perf_event_paranoid forbids it.
+  static bool Read(Values* values);
+
+  // Returns the counts from `start` to `end`.
+  static Values Delta(const Values& start, const Values& end);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_PERF_COUNTERS_H_
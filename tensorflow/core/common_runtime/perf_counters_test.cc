@@ -0,0 +1,47 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/perf_counters.h"
+
+#include <cstdint>
+#include <vector>
+
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+TEST(PerfCountersTest, CountsTheWorkOfTheThread) {
+  PerfCounters::Values start;
+  if (!PerfCounters::Read(&start)) {
+    GTEST_SKIP() << "The hardware counters are unavailable.";
+  }
+  // Streams over a buffer larger than the last level caches.
+  std::vector<int64_t> buffer(32 << 20);
+  int64_t sum = 0;
+  for (int64_t& value : buffer) sum += ++value;
+  PerfCounters::Values end;
+  ASSERT_TRUE(PerfCounters::Read(&end));
+  EXPECT_GT(sum, 0);
+
+  const PerfCounters::Values delta = PerfCounters::Delta(start, end);
+  EXPECT_GT(delta.cycles, 0);
+  EXPECT_GE(delta.instructions, buffer.size());
+  EXPECT_EQ(delta.dram_bytes(),
+            delta.llc_misses * PerfCounters::kCacheLineSize);
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -42,6 +42,7 @@ limitations under the License.
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
 #include "tensorflow/core/protobuf/config.pb.h"
 #include "tensorflow/core/protobuf/error_codes.pb.h"
 #include "tensorflow/core/protobuf/rewriter_config.pb.h"
@@ -3234,5 +3235,46 @@ TEST_F(PlacerTest, IdentityDoesntMatchWithMultipleOutput) {
   EXPECT_EQ(identity2->assigned_device_name().c_str(), task0_device);
 }
 
+// Places a synthetic graph of `state.range(0)` nodes, made of chains of
+// TestRelu and TestAdd nodes fed by TestInput nodes, on a FakeCPU and a
+// FakeGPU device.
+void BM_PlaceLargeGraph(::testing::benchmark::State& state) {
+  const int num_nodes = state.range(0);
+  constexpr int kChainLength = 100;
+  GraphDef graph_def;
+  {
+    GraphDefBuilder b(GraphDefBuilder::kFailImmediately);
+    Node* node = nullptr;
+    for (int i = 0; i < num_nodes; ++i) {
+      if (i % kChainLength == 0) {
+        node = ops::SourceOp("TestInput", b.opts());
+      } else if (i % 2 == 0) {
+        node = ops::UnaryOp("TestRelu", ops::NodeOut(node, 0), b.opts());
+      } else {
+        node = ops::BinaryOp("TestAdd", ops::NodeOut(node, 0),
+                             ops::NodeOut(node, 0), b.opts());
+      }
+    }
+    TF_CHECK_OK(b.ToGraphDef(&graph_def));
+  }
+  std::unique_ptr<Device> cpu = FakeDevice::MakeCPU(kFullCPU);
+  std::unique_ptr<Device> gpu = FakeDevice::MakeGPU(kFullGPU);
+  DeviceSet devices;
+  devices.AddDevice(cpu.get());
+  devices.AddDevice(gpu.get());
+
+  for (auto s : state) {
+    state.PauseTiming();
+    Graph graph(OpRegistry::Global());
+    TF_CHECK_OK(ConvertGraphDefToGraph(GraphConstructorOptions(), graph_def,
+                                       &graph));
+    state.ResumeTiming();
+    Placer placer(&graph, "", &graph.flib_def(), &devices);
+    TF_CHECK_OK(placer.Run());
+  }
+  state.SetItemsProcessed(state.iterations() * num_nodes);
+}
+BENCHMARK(BM_PlaceLargeGraph)->Arg(1 << 10)->Arg(1 << 14)->Arg(1 << 19);
+
 }  // namespace
 }  // namespace tensorflow
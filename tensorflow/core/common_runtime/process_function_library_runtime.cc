@@ -37,6 +37,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/int32_fulltype.h"
 #include "tensorflow/core/common_runtime/optimization_registry.h"
 #include "tensorflow/core/common_runtime/optimize_function_graph_utils.h"
+#include "tensorflow/core/common_runtime/optimized_function_graph_cache.h"
 #include "tensorflow/core/common_runtime/partitioning_utils.h"
 #include "tensorflow/core/common_runtime/placer.h"
 #include "tensorflow/core/common_runtime/rendezvous_util.h"
@@ -573,14 +574,39 @@ Status ProcessFunctionLibraryRuntime::InstantiateMultiDevice(
     }
   }
 
-  absl::StatusOr<OptimizedFunctionGraphInfo> optimized_graph_info =
-      (!optimized_graph_proto.has_value() ||
-       !optimized_graph_proto.value().ok())
-          ? OptimizeFunctionGraphOrReadFromFileCache(
-                function_name, attrs, options, *dev_set, lib_def_,
-                composite_devices, cpu_device, default_device, env_)
-          : OptimizedFunctionGraphInfo::FromProto(
-                std::move(optimized_graph_proto.value().value()));
+  absl::StatusOr<OptimizedFunctionGraphInfo> optimized_graph_info;
+  if (optimized_graph_proto.has_value() && optimized_graph_proto->ok()) {
+    optimized_graph_info = OptimizedFunctionGraphInfo::FromProto(
+        std::move(optimized_graph_proto.value().value()));
+  } else {
+    // Other runtimes in this process may have optimized the same function for
+    // the same devices already.
+    OptimizedFunctionGraphCache* cache =
+        options.is_component_function ? nullptr
+                                      : OptimizedFunctionGraphCache::Global();
+    std::string cache_key;
+    if (cache != nullptr) {
+      cache_key = OptimizedFunctionGraphCache::Key(
+          function_name, attrs, options, *dev_set,
+          options.lib_def != nullptr ? *options.lib_def : *lib_def_,
+          composite_devices);
+    }
+    std::optional<OptimizedFunctionGraphInfo> cached_graph_info;
+    if (!cache_key.empty()) cached_graph_info = cache->Lookup(cache_key);
+    if (cached_graph_info.has_value()) {
+      VLOG(1) << "Reusing the optimized graph of MultiDevice function \""
+              << function_name << "\" from the in-memory cache.";
+      optimized_graph_info = std::move(cached_graph_info).value();
+    } else {
+      optimized_graph_info = OptimizeFunctionGraphOrReadFromFileCache(
+          function_name, attrs, options, *dev_set, lib_def_, composite_devices,
+          cpu_device, default_device, env_, kCachingThresholdDuration,
+          config_ ? config_->experimental().function_graph_cache_dir() : "");
+      if (optimized_graph_info.ok() && !cache_key.empty()) {
+        cache->Insert(cache_key, *optimized_graph_info);
+      }
+    }
+  }
   if (!optimized_graph_info.ok()) return optimized_graph_info.status();
 
   // Resets the library registration correctly.
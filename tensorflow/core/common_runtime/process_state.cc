@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/process_state.h"
 
+#include <algorithm>
 #include <atomic>
 #include <cstring>
 #include <vector>
@@ -22,6 +23,7 @@ limitations under the License.
 #include "absl/base/call_once.h"
 #include "tensorflow/core/common_runtime/bfc_allocator.h"
 #include "tensorflow/core/common_runtime/pool_allocator.h"
+#include "tensorflow/core/common_runtime/size_class_allocator.h"
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/log_memory.h"
 #include "tensorflow/core/framework/tracking_allocator.h"
@@ -73,7 +75,8 @@ Allocator* ProcessState::GetCPUAllocator(int numa_node) {
   while (cpu_allocators_.size() <= static_cast<size_t>(numa_node)) {
     // If visitors have been defined we need an Allocator built from
     // a SubAllocator.  Prefer BFCAllocator, but fall back to PoolAllocator
-    // depending on env var setting.
+    // depending on env var setting. TF_CPU_ALLOCATOR_USE_SIZE_CLASSES selects
+    // a SizeClassAllocator, which scales better with concurrent sessions.
     const bool alloc_visitors_defined =
         (!cpu_alloc_visitors_.empty() || !cpu_free_visitors_.empty());
     bool use_bfc_allocator = false;
@@ -82,9 +85,16 @@ Allocator* ProcessState::GetCPUAllocator(int numa_node) {
     if (!status.ok()) {
       LOG(ERROR) << "GetCPUAllocator: " << status.message();
     }
+    bool use_size_class_allocator = false;
+    status = ReadBoolFromEnvVar("TF_CPU_ALLOCATOR_USE_SIZE_CLASSES", false,
+                                &use_size_class_allocator);
+    if (!status.ok()) {
+      LOG(ERROR) << "GetCPUAllocator: " << status.message();
+    }
     Allocator* allocator = nullptr;
     SubAllocator* sub_allocator =
-        (numa_enabled_ || alloc_visitors_defined || use_bfc_allocator)
+        (numa_enabled_ || alloc_visitors_defined || use_bfc_allocator ||
+         use_size_class_allocator)
             ? new BasicCPUAllocator(
                   numa_enabled_ ? numa_node : port::kNUMANoAffinity,
                   cpu_alloc_visitors_, cpu_free_visitors_)
@@ -109,6 +119,21 @@ Allocator* ProcessState::GetCPUAllocator(int numa_node) {
 
       VLOG(2) << "Using BFCAllocator with memory limit of "
               << cpu_mem_limit_in_mb << " MB for ProcessState CPU allocator";
+    } else if (use_size_class_allocator) {
+      SizeClassAllocator::Options allocator_opts;
+      int64_t cache_mb = allocator_opts.max_cached_bytes >> 20;
+      Status status = ReadInt64FromEnvVar(
+          "TF_CPU_SIZE_CLASS_ALLOCATOR_CACHE_MB", cache_mb, &cache_mb);
+      if (!status.ok()) {
+        LOG(ERROR) << "GetCPUAllocator: " << status.message();
+      }
+      allocator_opts.max_cached_bytes = std::max<int64_t>(cache_mb, 0) << 20;
+      allocator = new SizeClassAllocator(
+          sub_allocator, allocator_opts,
+          strings::StrCat("cpu_size_class_", cpu_allocators_.size()));
+      VLOG(2) << "Using SizeClassAllocator for ProcessState CPU allocator "
+              << "numa_enabled_=" << numa_enabled_
+              << " numa_node=" << numa_node;
     } else if (sub_allocator) {
       DCHECK(sub_allocator);
       allocator =
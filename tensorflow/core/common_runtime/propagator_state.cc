@@ -26,7 +26,8 @@ limitations under the License.
 namespace tensorflow {
 
 PropagatorState::PropagatorState(const ImmutableExecutorState& immutable_state,
-                                 int64_t step_id, bool vlog)
+                                 int64_t step_id, bool vlog,
+                                 StatePool* state_pool)
     : immutable_state_(immutable_state),
       step_id_(step_id),
       vlog_(vlog || VLOG_IS_ON(1)) {
@@ -37,10 +38,17 @@ PropagatorState::PropagatorState(const ImmutableExecutorState& immutable_state,
   root_frame_->frame_id = 0;  // must be 0
   root_frame_->InitializeFrameInfo(immutable_state_.get_root_frame_info());
 
-  // Initialize iteration 0.
-  root_frame_->SetIteration(
-      0, new PropagatorState::IterationState(0, root_frame_->pending_counts,
-                                             root_frame_->total_input_tensors));
+  // Initialize iteration 0, reusing that of a finished step if possible.
+  IterationState* root_iter = nullptr;
+  if (state_pool != nullptr) {
+    root_frame_->state_pool = state_pool;
+    root_iter = state_pool->Get(*root_frame_->pending_counts);
+  }
+  if (root_iter == nullptr) {
+    root_iter = new PropagatorState::IterationState(
+        0, root_frame_->pending_counts, root_frame_->total_input_tensors);
+  }
+  root_frame_->SetIteration(0, root_iter);
 
   outstanding_frames_.emplace(root_frame_->frame_id, root_frame_);
 }
@@ -748,6 +756,14 @@ bool PropagatorState::FrameState::IsIterationDone(IterationState* iter_state) {
   return false;
 }
 
+void PropagatorState::FrameState::DeleteIteration(IterationState* iter_state) {
+  if (state_pool != nullptr && iter_state->iter_num == 0) {
+    state_pool->Release(iter_state, total_input_tensors);
+  } else {
+    delete iter_state;
+  }
+}
+
 PropagatorState::IterationState*
 PropagatorState::FrameState::IncrementIteration(TaggedNodeSeq* ready) {
   iteration_count++;
@@ -775,7 +791,7 @@ bool PropagatorState::FrameState::CleanupIterations(IterationState* iter_state,
                                                     TaggedNodeSeq* ready) {
   int64_t curr_iter = iter_state->iter_num;
   while (curr_iter <= iteration_count && IsIterationDone(iter_state)) {
-    delete iter_state;
+    DeleteIteration(iter_state);
     SetIteration(curr_iter, nullptr);
     --num_outstanding_iterations;
     ++curr_iter;
@@ -896,4 +912,37 @@ bool PropagatorState::FrameState::IsFrameDone()
   return (num_pending_inputs == 0 && num_outstanding_iterations == 0);
 }
 
+PropagatorState::StatePool::~StatePool() {
+  for (IterationState* iter_state : iteration_states_) delete iter_state;
+}
+
+PropagatorState::IterationState* PropagatorState::StatePool::Get(
+    const PendingCounts& pending_counts) {
+  IterationState* iter_state;
+  {
+    mutex_lock l(mu_);
+    if (iteration_states_.empty()) return nullptr;
+    iter_state = iteration_states_.back();
+    iteration_states_.pop_back();
+  }
+  iter_state->Reset(pending_counts);
+  return iter_state;
+}
+
+void PropagatorState::StatePool::Release(IterationState* iter_state,
+                                         int total_input_tensors) {
+  // Release the tensors of the step now, as deleting the iteration would.
+  for (int i = 0; i < total_input_tensors; ++i) {
+    iter_state->input_tensors[i] = Entry();
+  }
+  {
+    mutex_lock l(mu_);
+    if (iteration_states_.size() < kMaxSize) {
+      iteration_states_.push_back(iter_state);
+      return;
+    }
+  }
+  delete iter_state;
+}
+
 }  // namespace tensorflow
@@ -46,8 +46,12 @@ typedef gtl::InlinedVector<AllocatorAttributes, 4> AllocatorAttributeVec;
 // adding them to a `TaggedNodeSeq`.
 class PropagatorState {
  public:
+  class StatePool;
+
+  // If `state_pool` is not nullptr, it must only be used by the steps of the
+  // executor of `immutable_state`, and outlive this.
   PropagatorState(const ImmutableExecutorState& immutable_state,
-                  int64_t step_id, bool vlog);
+                  int64_t step_id, bool vlog, StatePool* state_pool = nullptr);
   ~PropagatorState();
 
  private:
@@ -206,6 +210,15 @@ class PropagatorState {
       return counts.adjust_for_activation_atomic(h, increment_dead);
     }
 
+    // Resets iteration 0 of a frame to its initial state, once its input
+    // tensors have been cleared.
+    void Reset(const PendingCounts& pending_counts) {
+      DCHECK_EQ(iter_num, 0);
+      outstanding_ops = 0;
+      outstanding_frame_count = 0;
+      counts.CopyFrom(pending_counts);
+    }
+
     ~IterationState() { delete[] input_tensors; }
 
    private:
@@ -312,6 +325,10 @@ class PropagatorState {
     int total_input_tensors = 0;
     std::vector<const NodeItem*>* nodes = nullptr;
 
+    // If not nullptr, the pool that iteration 0 is released to instead of being
+    // deleted. Only set for the root frame.
+    StatePool* state_pool = nullptr;
+
     // Lock ordering: ExecutorState.mu_ < mu < iter_mu;
     // during structured traversal: parent_frame->mu < mu.
     mutex mu;
@@ -414,9 +431,13 @@ class PropagatorState {
       }
     }
 
+    // Deletes `iter_state`, or releases it to `state_pool` if it is
+    // iteration 0 and the pool is set.
+    void DeleteIteration(IterationState* iter_state);
+
     ~FrameState() {
       for (size_t i = 0; i < iterations.size(); ++i) {
-        delete iterations[i];
+        if (iterations[i] != nullptr) DeleteIteration(iterations[i]);
         iterations[i] = nullptr;
       }
     }
@@ -550,6 +571,36 @@ class PropagatorState {
   void operator=(const PropagatorState&) = delete;
 };
 
+// Thread-safe.
+// A pool of the root iteration states of finished steps. The pending counts
+// and input tensors of the root frame are most of the per-step state, so the
+// later steps of the same executor reset and reuse them instead of allocating
+// new ones.
+class PropagatorState::StatePool {
+ public:
+  StatePool() = default;
+  ~StatePool();
+
+  // Returns a pooled iteration state reset to `pending_counts`, or nullptr if
+  // the pool is empty.
+  IterationState* Get(const PendingCounts& pending_counts);
+
+  // Clears the first `total_input_tensors` input tensors of `iter_state` and
+  // pools it, or deletes it if the pool is full.
+  void Release(IterationState* iter_state, int total_input_tensors);
+
+ private:
+  // The maximum number of pooled iteration states, which bounds the memory
+  // held by the pool to that of as many concurrent steps.
+  static constexpr int kMaxSize = 8;
+
+  mutex mu_;
+  std::vector<IterationState*> iteration_states_ TF_GUARDED_BY(mu_);
+
+  StatePool(const StatePool&) = delete;
+  void operator=(const StatePool&) = delete;
+};
+
 inline int64_t PropagatorState::TaggedNode::get_iter_num() const {
   return input_iter->iter_num;
 }
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/rendezvous_mgr.h"
 
+#include <algorithm>
 #include <unordered_set>
 
 #include "tensorflow/core/common_runtime/copy_tensor.h"
@@ -35,6 +36,11 @@ limitations under the License.
 namespace tensorflow {
 
 namespace {
+// The minimum number of the lock-striped buckets of the table of an intra
+// process rendezvous. The graphs with many Send/Recv pairs on a single device
+// would otherwise contend on the lock of a single bucket.
+constexpr int kMinNumShards = 8;
+
 void SameWorkerRecvDone(const DeviceMgr* device_mgr,
                         const Rendezvous::ParsedKey& parsed,
                         const Rendezvous::Args& send_args,
@@ -169,7 +175,8 @@ void IntraProcessRecvAsyncImpl(const DeviceMgr* device_mgr,
 RefCountedIntraProcessRendezvous::RefCountedIntraProcessRendezvous(
     const DeviceMgr* device_mgr)
     : device_mgr_(device_mgr),
-      local_(this, /* num_shards= */ device_mgr->NumDevices()) {}
+      local_(this, /* num_shards= */ std::max(device_mgr->NumDevices(),
+                                              kMinNumShards)) {}
 
 RefCountedIntraProcessRendezvous::~RefCountedIntraProcessRendezvous() {
   VLOG(5) << "Destructor of IntraProcessRendezvous: " << this;
@@ -394,6 +394,29 @@ string RingAlg::RingField::DebugString() const {
   return rv;
 }
 
+namespace {
+// Casts `from` into the same-shaped tensor `to`, one of which must be float32
+// and the other bfloat16 or half.
+void CastChunk(const Tensor& from, Tensor* to) {
+  if (from.dtype() == DT_FLOAT) {
+    if (to->dtype() == DT_BFLOAT16) {
+      to->flat<bfloat16>() = from.flat<float>().cast<bfloat16>();
+    } else {
+      DCHECK_EQ(to->dtype(), DT_HALF);
+      to->flat<Eigen::half>() = from.flat<float>().cast<Eigen::half>();
+    }
+  } else {
+    DCHECK_EQ(to->dtype(), DT_FLOAT);
+    if (from.dtype() == DT_BFLOAT16) {
+      to->flat<float>() = from.flat<bfloat16>().cast<float>();
+    } else {
+      DCHECK_EQ(from.dtype(), DT_HALF);
+      to->flat<float>() = from.flat<Eigen::half>().cast<float>();
+    }
+  }
+}
+}  // namespace
+
 void RingAlg::DispatchSend(RingField* rf, const StatusCallback& done) {
   DCHECK(rf->do_send);
   string send_buf_key = RingAlgBufKey(name_, col_ctx_->exec_key,
@@ -404,11 +427,24 @@ void RingAlg::DispatchSend(RingField* rf, const StatusCallback& done) {
   int send_to_rank = (rf->rank + 1) % group_size_;
   int send_to_dev_idx = col_params_->instance.impl_details
                             .subdiv_permutations[rf->subdiv_idx][send_to_rank];
+  Tensor* send_tensor = &rf->chunk;
+  if (wire_dtype_ != DT_INVALID) {
+    rf->wire_chunk = Tensor(col_ctx_->device->GetAllocator(
+                                col_ctx_->op_ctx->output_alloc_attr(0)),
+                            wire_dtype_, rf->chunk.shape());
+    CastChunk(rf->chunk, &rf->wire_chunk);
+    if (rf->second_pass) {
+      // Round the local copy of the final value the same way as the copies
+      // the other ranks receive, so that all ranks end up bitwise identical.
+      CastChunk(rf->wire_chunk, &rf->chunk);
+    }
+    send_tensor = &rf->wire_chunk;
+  }
   col_ctx_->col_exec->remote_access()->PostToPeer(
       col_params_->group.members[send_to_dev_idx].device.name(),
       col_params_->group.members[send_to_dev_idx].task, send_buf_key,
       col_ctx_->device, col_ctx_->op_ctx->op_device_context(),
-      col_ctx_->op_ctx->output_alloc_attr(0), &rf->chunk,
+      col_ctx_->op_ctx->output_alloc_attr(0), send_tensor,
       col_ctx_->device_locality, col_ctx_->op_ctx->cancellation_manager(),
       done);
 }
@@ -424,14 +460,32 @@ void RingAlg::DispatchRecv(RingField* rf, const StatusCallback& done) {
   Tensor* dst_tensor = (!rf->second_pass && (col_params_->merge_op != nullptr))
                            ? &rf->tmp_chunk
                            : &rf->chunk;
+  if (wire_dtype_ == DT_INVALID) {
+    col_ctx_->col_exec->remote_access()->RecvFromPeer(
+        col_params_->group.members[rf->recv_dev_idx].device.name(),
+        col_params_->group.members[rf->recv_dev_idx].task,
+        col_params_->group.members[rf->recv_dev_idx].is_local, recv_buf_key,
+        col_ctx_->device, col_ctx_->op_ctx->op_device_context(),
+        col_ctx_->op_ctx->output_alloc_attr(0), dst_tensor,
+        col_ctx_->device_locality, rf->subdiv_idx,
+        col_ctx_->op_ctx->cancellation_manager(), done);
+    return;
+  }
+  rf->wire_chunk = Tensor(
+      col_ctx_->device->GetAllocator(col_ctx_->op_ctx->output_alloc_attr(0)),
+      wire_dtype_, dst_tensor->shape());
   col_ctx_->col_exec->remote_access()->RecvFromPeer(
       col_params_->group.members[rf->recv_dev_idx].device.name(),
       col_params_->group.members[rf->recv_dev_idx].task,
       col_params_->group.members[rf->recv_dev_idx].is_local, recv_buf_key,
       col_ctx_->device, col_ctx_->op_ctx->op_device_context(),
-      col_ctx_->op_ctx->output_alloc_attr(0), dst_tensor,
+      col_ctx_->op_ctx->output_alloc_attr(0), &rf->wire_chunk,
       col_ctx_->device_locality, rf->subdiv_idx,
-      col_ctx_->op_ctx->cancellation_manager(), done);
+      col_ctx_->op_ctx->cancellation_manager(),
+      [rf, dst_tensor, done](const Status& s) {
+        if (s.ok()) CastChunk(rf->wire_chunk, dst_tensor);
+        done(s);
+      });
 }
 
 string RingAlg::FieldState() {
@@ -75,6 +75,7 @@ class RingAlg : public CollectiveImplementationInterface {
     bool is_final = false;  // is the last field in the pass for this rank
     Tensor chunk;           // alias to field values
     Tensor tmp_chunk;
+    Tensor wire_chunk;      // chunk cast to wire_dtype_ while in transit
     Status status;
     string DebugString() const;
   };
@@ -111,6 +112,8 @@ class RingAlg : public CollectiveImplementationInterface {
   Tensor group_size_tensor_;
   Notification group_size_tensor_ready_;
   std::unique_ptr<CollectiveAdapter> ca_;
+  // If not DT_INVALID, chunks are cast to this type for sends and receives.
+  DataType wire_dtype_ = DT_INVALID;
   mutex status_mu_;
   Status status_ TF_GUARDED_BY(status_mu_);
   std::vector<RingField> rfv_;
@@ -65,6 +65,21 @@ void RingReducer::Run(StatusCallback done) {
       col_params_->instance.impl_details.subdiv_permutations.size());
   CHECK_GT(num_subdivs_, 0);
 
+  const string& compression = col_params_->instance.impl_details.compression;
+  if (!compression.empty() && compression != "none") {
+    // Compressed chunks are cast on the host, so only float32 reductions on
+    // CPU devices are compressed; everything else falls back to full width.
+    if (col_params_->instance.data_type == DT_FLOAT &&
+        col_params_->group.device_type == DEVICE_CPU) {
+      wire_dtype_ = (compression == "fp16") ? DT_HALF : DT_BFLOAT16;
+    } else {
+      VLOG(1) << "RingReducer ignoring compression " << compression
+              << " for dtype "
+              << DataTypeString(col_params_->instance.data_type) << " on "
+              << col_params_->group.device_type;
+    }
+  }
+
   if (VLOG_IS_ON(1)) {
     string buf;
     for (int r = 0; r < col_params_->group.members.size(); ++r) {
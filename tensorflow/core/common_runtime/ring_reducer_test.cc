@@ -427,6 +427,39 @@ DEF_TEST(INT64, CPU, 2, 8, 3, 4095, 0)
 DEF_TEST(FLOAT, CPU, 2, 8, 1, 9408, 1)
 DEF_TEST(FLOAT, CPU, 2, 8, 1, 9408, 7)
 DEF_TEST(FLOAT, CPU, 2, 8, 2, 9408, 11)
+
+TEST_F(RingReducerTest, CompressedChunks) {
+  const int kNumWorkers = 2;
+  const int kNumDevices = 4;
+  const int kTensorLen = 1001;
+  for (const char* compression : {"bf16", "fp16"}) {
+    instances_.clear();
+    Init(kNumWorkers, kNumDevices, DT_FLOAT, TensorShape({kTensorLen}),
+         DEVICE_CPU, /*num_subdivs=*/2, /*fail_after=*/0);
+    std::vector<float> expected(kTensorLen);
+    for (int di = 0; di < static_cast<int>(instances_.size()); ++di) {
+      instances_[di]->col_params_->instance.impl_details.compression =
+          compression;
+      instances_[di]->InitTensor([&expected, di](Tensor* t) {
+        for (size_t i = 0; i < t->NumElements(); ++i) {
+          float value = 0.01f * (di + 1) * i;
+          t->flat<float>()(i) = value;
+          expected[i] += value / (kNumWorkers * kNumDevices);
+        }
+      });
+    }
+    Reduce(/*fail_after=*/0);
+    for (int di = 0; di < static_cast<int>(instances_.size()); ++di) {
+      TF_EXPECT_OK(instances_[di]->status_);
+      // Every rank must see the same rounded result ...
+      test::ExpectTensorEqual<float>(instances_[0]->tensor(),
+                                     instances_[di]->tensor());
+    }
+    // ... within the precision of the wire format of the exact mean.
+    test::ExpectClose(test::AsTensor<float>(expected), instances_[0]->tensor(),
+                      /*atol=*/1e-2, /*rtol=*/2e-2);
+  }
+}
 #endif
 
 #if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
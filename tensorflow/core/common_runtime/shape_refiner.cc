@@ -22,11 +22,14 @@ limitations under the License.
 #include <vector>
 
 #include "absl/container/flat_hash_set.h"
+#include "absl/strings/str_cat.h"
+#include "absl/types/span.h"
 #include "tensorflow/core/common_runtime/eval_const_tensor.h"
 #include "tensorflow/core/common_runtime/function_utils.h"
 #include "tensorflow/core/common_runtime/graph_constructor.h"
 #include "tensorflow/core/framework/bounds_check.h"
 #include "tensorflow/core/framework/common_shape_fns.h"
+#include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/framework/node_def.pb.h"
 #include "tensorflow/core/framework/shape_inference.h"
 #include "tensorflow/core/framework/tensor.h"
@@ -64,8 +67,109 @@ namespace {
 constexpr char kArgOp[] = "_Arg";
 constexpr char kRetvalOp[] = "_Retval";
 
+// Appends `s` to `key`, prefixed with its length so that it can't be confused
+// with the next parts of the key.
+void AppendToKey(absl::string_view s, std::string* key) {
+  absl::StrAppend(key, s.size(), ":", s);
+}
+
+// Returns the key of the shapes inferred for a call to the function `fname`
+// with `attributes`, with the input shapes of `outer_context` and the known
+// input tensors `input_tensors`.
+std::string FunctionCallKey(const std::string& fname, AttrSlice attributes,
+                            int graph_def_version,
+                            absl::Span<const Tensor* const> input_tensors,
+                            InferenceContext* outer_context) {
+  std::string key;
+  AppendToKey(Canonicalize(fname, attributes), &key);
+  absl::StrAppend(&key, graph_def_version, ";");
+  for (int i = 0; i < outer_context->num_inputs(); ++i) {
+    ShapeHandle input = outer_context->input(i);
+    absl::StrAppend(&key, i, "=", input.SameHandle(ShapeHandle())
+                                      ? "-"
+                                      : outer_context->DebugString(input));
+    const std::vector<ShapeAndType>* resource =
+        outer_context->input_handle_shapes_and_types(i);
+    if (resource) {
+      for (const ShapeAndType& shape_and_type : *resource) {
+        absl::StrAppend(&key, "&", outer_context->DebugString(shape_and_type));
+        AppendToKey(shape_and_type.type.SerializeAsString(), &key);
+      }
+    }
+    if (i < input_tensors.size() && input_tensors[i] != nullptr) {
+      TensorProto proto;
+      input_tensors[i]->AsProtoTensorContent(&proto);
+      absl::StrAppend(&key, "#");
+      AppendToKey(proto.SerializeAsString(), &key);
+    }
+    absl::StrAppend(&key, ";");
+  }
+  return key;
+}
+
 }  // namespace
 
+ShapeRefiner::FunctionCallShapes ShapeRefiner::GetFunctionCallShapes(
+    InferenceContext* outer_context) {
+  FunctionCallShapes shapes;
+  for (int i = 0; i < outer_context->num_outputs(); ++i) {
+    ShapeHandle output = outer_context->output(i);
+    if (output.SameHandle(ShapeHandle())) {
+      shapes.output_shapes.emplace_back();
+    } else {
+      outer_context->ShapeHandleToProto(
+          output, &shapes.output_shapes.emplace_back().emplace());
+    }
+    const std::vector<ShapeAndType>* resource =
+        outer_context->output_handle_shapes_and_types(i);
+    auto& shapes_and_types =
+        shapes.output_handle_shapes_and_types.emplace_back();
+    if (resource) {
+      shapes_and_types.emplace();
+      for (const ShapeAndType& shape_and_type : *resource) {
+        auto& cached = shapes_and_types->emplace_back();
+        outer_context->ShapeHandleToProto(shape_and_type.shape, &cached.shape);
+        cached.dtype = shape_and_type.dtype;
+        cached.type = shape_and_type.type;
+      }
+    }
+  }
+  for (int i = 0; i < outer_context->num_inputs(); ++i) {
+    if (outer_context->requested_input_tensor(i)) {
+      shapes.requested_input_tensors.push_back(i);
+    }
+  }
+  return shapes;
+}
+
+Status ShapeRefiner::SetFunctionCallShapes(const FunctionCallShapes& shapes,
+                                           InferenceContext* outer_context) {
+  for (int i = 0; i < shapes.output_shapes.size(); ++i) {
+    if (shapes.output_shapes[i].has_value()) {
+      ShapeHandle handle;
+      TF_RETURN_IF_ERROR(
+          outer_context->MakeShapeFromShapeProto(*shapes.output_shapes[i],
+                                                 &handle));
+      outer_context->set_output(i, handle);
+    }
+    if (shapes.output_handle_shapes_and_types[i].has_value()) {
+      std::vector<ShapeAndType> shapes_and_types;
+      for (const auto& cached : *shapes.output_handle_shapes_and_types[i]) {
+        ShapeHandle handle;
+        TF_RETURN_IF_ERROR(
+            outer_context->MakeShapeFromShapeProto(cached.shape, &handle));
+        shapes_and_types.push_back(
+            ShapeAndType(handle, cached.dtype, cached.type));
+      }
+      outer_context->set_output_handle_shapes_and_types(i, shapes_and_types);
+    }
+  }
+  for (int i : shapes.requested_input_tensors) {
+    outer_context->request_input_tensor(i);
+  }
+  return absl::OkStatus();
+}
+
 // Runs shape inference for the given node using the given ShapeRefiner.
 // The node must be a sub-node of a function node and the outer_context is
 // the inference context of that function node in the outer graph.
@@ -158,11 +262,23 @@ Status ShapeRefiner::InferShapesForFunctionSubNode(
 // NOTE: Recursive user-defined functions are not supported.
 // Maybe we won't support recursive functions at all in TF, because of
 // other maintainability issues.
-Status ShapeRefiner::InferShapesForFunction(const FunctionDef* function_def,
-                                            AttrSlice attributes,
-                                            InferenceContext* outer_context) {
-  const Graph* graph;
+Status ShapeRefiner::InferShapesForFunction(
+    const FunctionDef* function_def, AttrSlice attributes,
+    absl::Span<const Tensor* const> input_tensors,
+    InferenceContext* outer_context) {
   const string& fname = function_def->signature().name();
+  const std::string key =
+      FunctionCallKey(fname, attributes, graph_def_version_, input_tensors,
+                      outer_context);
+  auto cached = function_call_shapes_.find(key);
+  if (cached != function_call_shapes_.end() &&
+      cached->second.output_shapes.size() == outer_context->num_outputs()) {
+    VLOG(4) << "Reusing the shapes inferred for a call to function \""
+            << fname << "\".";
+    return SetFunctionCallShapes(cached->second, outer_context);
+  }
+
+  const Graph* graph;
   auto it = functions_.find(fname);
   if (it != functions_.end()) {
     graph = it->second.get();
@@ -205,7 +321,9 @@ Status ShapeRefiner::InferShapesForFunction(const FunctionDef* function_def,
     node_to_context_.erase(node);
   }
 
-  return inference_status;
+  TF_RETURN_IF_ERROR(inference_status);
+  function_call_shapes_[key] = GetFunctionCallShapes(outer_context);
+  return absl::OkStatus();
 }
 
 Status ShapeRefiner::AddNode(const Node* node) {
@@ -745,7 +863,7 @@ Status ShapeRefiner::RunShapeFn(const Node* node,
           VLOG(4) << "Running shape inference for function \""
                   << function.name() << "\".";
           Status function_inference_status = InferShapesForFunction(
-              function_def, AttrSlice(&function.attr()), c);
+              function_def, AttrSlice(&function.attr()), input_tensors, c);
           const_tensor_map_ = const_tensor_map_copy;
           VLOG(4) << "Shape inference for function \"" << function.name()
                   << "\" returned status " << function_inference_status << ".";
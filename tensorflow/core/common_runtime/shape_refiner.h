@@ -16,14 +16,19 @@ limitations under the License.
 #define TENSORFLOW_CORE_COMMON_RUNTIME_SHAPE_REFINER_H_
 
 #include <memory>
+#include <optional>
 #include <string>
 #include <utility>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/types/span.h"
 #include "tensorflow/core/common_runtime/graph_runner.h"
 #include "tensorflow/core/framework/function.pb.h"
+#include "tensorflow/core/framework/full_type.pb.h"
 #include "tensorflow/core/framework/shape_inference.h"
+#include "tensorflow/core/framework/tensor_shape.pb.h"
+#include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/graph/graph.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/platform/macros.h"
@@ -101,7 +106,8 @@ class ShapeRefiner {
   // Without function library, function inference always yields unknown shapes.
   // With this enabled, shape inference can take more time since it descends
   // into all function calls. It doesn't do inference once for each function
-  // definition, but once for each function call.
+  // definition, but once for each distinct function call: the calls with the
+  // same attributes, input shapes and known input tensors reuse its results.
   // The function library must outlive the shape refiner.
   void set_function_library_for_shape_inference(
       const tensorflow::FunctionLibraryDefinition* lib) {
@@ -139,8 +145,14 @@ class ShapeRefiner {
   //
   // On success:
   // - outer_context will contain output shapes inferred from input shapes
+  //
+  // `input_tensors` are the known tensors of the inputs of outer_context.  The
+  // results are cached per function, attributes, input shapes and tensors, so
+  // that the repeated calls of a function don't infer the shapes of its body
+  // again.
   Status InferShapesForFunction(
       const FunctionDef* function_def, AttrSlice attributes,
+      absl::Span<const Tensor* const> input_tensors,
       shape_inference::InferenceContext* outer_context);
 
   // Performs shape inference for a node inside a function.
@@ -283,6 +295,39 @@ class ShapeRefiner {
   // are refined.
   absl::flat_hash_map<std::string, std::unique_ptr<const Graph>> functions_;
 
+  // What the shape inference of a function body set in the context of the
+  // call op.
+  struct FunctionCallShapes {
+    struct ShapeAndTypeProto {
+      TensorShapeProto shape;
+      DataType dtype;
+      FullTypeDef type;
+    };
+
+    // The shape of each output, or nullopt if it wasn't set.
+    std::vector<std::optional<TensorShapeProto>> output_shapes;
+    // The shapes and types of the resources of each output, if set.
+    std::vector<std::optional<std::vector<ShapeAndTypeProto>>>
+        output_handle_shapes_and_types;
+    // The inputs whose tensors were requested.
+    std::vector<int> requested_input_tensors;
+  };
+
+  // Returns what the shape inference of a function body set in
+  // `outer_context`.
+  static FunctionCallShapes GetFunctionCallShapes(
+      shape_inference::InferenceContext* outer_context);
+
+  // Sets `shapes` in `outer_context`, as the shape inference of the function
+  // body did.
+  static Status SetFunctionCallShapes(
+      const FunctionCallShapes& shapes,
+      shape_inference::InferenceContext* outer_context);
+
+  // Cache of the shapes inferred for the function calls, keyed by the
+  // function, its attributes, the input shapes and the known input tensors.
+  absl::flat_hash_map<std::string, FunctionCallShapes> function_call_shapes_;
+
   ShapeRefiner(const ShapeRefiner&) = delete;
   void operator=(const ShapeRefiner&) = delete;
 };
@@ -59,6 +59,10 @@ class ShapeRefinerTest : public ::testing::Test {
     return ShapeRefiner::IsUpdatedShapesOrTypes(c, existing, updated);
   }
 
+  static size_t NumCachedFunctionCalls(const ShapeRefiner& m) {
+    return m.function_call_shapes_.size();
+  }
+
   static constexpr int64_t kMaxTensorSize = ShapeRefiner::kMaxTensorSize;
 
   void TestStridedSlice(const PartialTensorShape& input_shape, int begin,
@@ -1527,6 +1531,35 @@ TEST_F(ShapeRefinerTest, ChainedFunctionShapeInferenceWithMultipleInputs) {
   EXPECT_SHAPE("[3,3]", m, wxplusb16, 0);
 }
 
+TEST_F(ShapeRefinerTest, FunctionShapeInferenceIsCachedPerInputShapes) {
+  FunctionDefLibrary f_lib_proto;
+  *(f_lib_proto.add_function()) = test::function::XTimesTwo();
+  FunctionLibraryDefinition f_lib(OpRegistry::Global(), f_lib_proto);
+
+  Scope root = Scope::NewRootScope();
+  TF_ASSERT_OK(root.graph()->AddFunctionLibrary(f_lib_proto));
+  auto x = ops::Const(root, {{1.0f, 2.0f}});
+  auto y = ops::Const(root, {3.0f, 4.0f, 5.0f});
+  auto x2 = test::function::Call(&root, "x2", "XTimesTwo", {x});
+  auto y2 = test::function::Call(&root, "y2", "XTimesTwo", {y});
+  auto x2_again = test::function::Call(&root, "x2_again", "XTimesTwo", {x});
+
+  ShapeRefiner m(TF_GRAPH_DEF_VERSION, &f_lib);
+  m.set_function_library_for_shape_inference(&f_lib);
+
+  TF_ASSERT_OK(m.AddNode(x.node()));
+  TF_ASSERT_OK(m.AddNode(y.node()));
+  TF_ASSERT_OK(m.AddNode(x2.node()));
+  TF_ASSERT_OK(m.AddNode(y2.node()));
+  EXPECT_EQ(2, NumCachedFunctionCalls(m));
+  TF_ASSERT_OK(m.AddNode(x2_again.node()));
+  EXPECT_EQ(2, NumCachedFunctionCalls(m));
+
+  EXPECT_SHAPE("[1,2]", m, x2, 0);
+  EXPECT_SHAPE("[3]", m, y2, 0);
+  EXPECT_SHAPE("[1,2]", m, x2_again, 0);
+}
+
 TEST_F(ShapeRefinerTest, FunctionShapeInferenceWorksForResourceHandles) {
   FunctionDefLibrary f_lib_proto;
   *(f_lib_proto.add_function()) = test::function::Swap();
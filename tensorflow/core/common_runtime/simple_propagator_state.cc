@@ -23,27 +23,37 @@ limitations under the License.
 namespace tensorflow {
 
 SimplePropagatorState::SimplePropagatorState(
-    const ImmutableExecutorState& immutable_state, int64_t step_id, bool vlog)
+    const ImmutableExecutorState& immutable_state, int64_t step_id, bool vlog,
+    StatePool* state_pool)
     : SimplePropagatorState(immutable_state, step_id,
-                            immutable_state.get_root_frame_info(), vlog) {}
+                            immutable_state.get_root_frame_info(), vlog,
+                            state_pool) {}
 
 SimplePropagatorState::SimplePropagatorState(
     const ImmutableExecutorState& immutable_state, int64_t step_id,
-    const ImmutableExecutorState::FrameInfo& finfo, bool vlog)
+    const ImmutableExecutorState::FrameInfo& finfo, bool vlog,
+    StatePool* state_pool)
     : immutable_state_(immutable_state),
       step_id_(step_id),
       vlog_(vlog || VLOG_IS_ON(1)),
-      input_tensors_(finfo.total_inputs),
-      pending_(
-          new std::atomic<int32>[immutable_state.graph_view().num_nodes()]),
+      state_pool_(state_pool),
       active_(vlog_ ? new std::vector<bool>(
                           immutable_state.graph_view().num_nodes())
                     : nullptr),
       nodes_(finfo.nodes.get()) {
+  if (state_pool_ == nullptr || !state_pool_->Get(&input_tensors_, &pending_)) {
+    input_tensors_.resize(finfo.total_inputs);
+    pending_.reset(
+        new std::atomic<int32>[immutable_state.graph_view().num_nodes()]);
+  }
   immutable_state_.copy_pending_counts(pending_.get());
 }
 
-SimplePropagatorState::~SimplePropagatorState() {}
+SimplePropagatorState::~SimplePropagatorState() {
+  if (state_pool_ != nullptr) {
+    state_pool_->Release(std::move(input_tensors_), std::move(pending_));
+  }
+}
 
 void SimplePropagatorState::ActivateRoots(
     gtl::ArraySlice<const NodeItem*> roots, TaggedNodeSeq* ready) {
@@ -134,4 +144,26 @@ void SimplePropagatorState::DumpState() {
   LOG(WARNING) << "    Total bytes " << total_bytes;
 }
 
+bool SimplePropagatorState::StatePool::Get(
+    std::vector<Entry>* input_tensors,
+    std::unique_ptr<std::atomic<int32>[]>* pending) {
+  mutex_lock l(mu_);
+  if (buffers_.empty()) return false;
+  *input_tensors = std::move(buffers_.back().input_tensors);
+  *pending = std::move(buffers_.back().pending);
+  buffers_.pop_back();
+  return true;
+}
+
+void SimplePropagatorState::StatePool::Release(
+    std::vector<Entry> input_tensors,
+    std::unique_ptr<std::atomic<int32>[]> pending) {
+  // Release the tensors of the step now, as deleting the buffers would.
+  for (Entry& entry : input_tensors) entry = Entry();
+  mutex_lock l(mu_);
+  if (buffers_.size() < kMaxSize) {
+    buffers_.push_back({std::move(input_tensors), std::move(pending)});
+  }
+}
+
 }  // namespace tensorflow
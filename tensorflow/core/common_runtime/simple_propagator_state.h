@@ -15,6 +15,8 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_COMMON_RUNTIME_SIMPLE_PROPAGATOR_STATE_H_
 #define TENSORFLOW_CORE_COMMON_RUNTIME_SIMPLE_PROPAGATOR_STATE_H_
 
+#include <atomic>
+#include <memory>
 #include <vector>
 
 #include "tensorflow/core/common_runtime/entry.h"
@@ -46,8 +48,13 @@ namespace tensorflow {
 // dispatches `TaggedNode`s by adding them to a `TaggedNodeSeq`.
 class SimplePropagatorState {
  public:
+  class StatePool;
+
+  // If `state_pool` is not nullptr, it must only be used by the steps of the
+  // executor of `immutable_state`, and outlive this.
   SimplePropagatorState(const ImmutableExecutorState& immutable_state,
-                        int64_t step_id, bool vlog);
+                        int64_t step_id, bool vlog,
+                        StatePool* state_pool = nullptr);
   ~SimplePropagatorState();
 
   // A `TaggedNode` corresponds to a single invocation of a node's kernel,
@@ -159,11 +166,12 @@ class SimplePropagatorState {
   SimplePropagatorState(const ImmutableExecutorState& immutable_state_,
                         int64_t step_id,
                         const ImmutableExecutorState::FrameInfo& finfo,
-                        bool vlog);
+                        bool vlog, StatePool* state_pool);
 
   const ImmutableExecutorState& immutable_state_;
   const int64_t step_id_;
   const bool vlog_;
+  StatePool* const state_pool_;
 
   // The i-th node's j-th input is stored at
   // `input_tensors[impl_->nodes[i].input_start + j]`.
@@ -185,6 +193,41 @@ class SimplePropagatorState {
   const std::vector<const NodeItem*>* const nodes_;
 };
 
+// Thread-safe.
+// A pool of the input tensors and pending counts of finished steps, which the
+// later steps of the same executor reuse instead of allocating new ones.
+class SimplePropagatorState::StatePool {
+ public:
+  StatePool() = default;
+
+  // Moves pooled buffers into `input_tensors` and `pending`, and returns true,
+  // or returns false if the pool is empty. The pooled input tensors are
+  // cleared, and the pending counts must be reset by the caller.
+  bool Get(std::vector<Entry>* input_tensors,
+           std::unique_ptr<std::atomic<int32>[]>* pending);
+
+  // Clears `input_tensors` and pools them along with `pending`, unless the
+  // pool is full.
+  void Release(std::vector<Entry> input_tensors,
+               std::unique_ptr<std::atomic<int32>[]> pending);
+
+ private:
+  // The maximum number of pooled buffers, which bounds the memory held by the
+  // pool to that of as many concurrent steps.
+  static constexpr int kMaxSize = 8;
+
+  struct Buffers {
+    std::vector<Entry> input_tensors;
+    std::unique_ptr<std::atomic<int32>[]> pending;
+  };
+
+  mutex mu_;
+  std::vector<Buffers> buffers_ TF_GUARDED_BY(mu_);
+
+  StatePool(const StatePool&) = delete;
+  void operator=(const StatePool&) = delete;
+};
+
 }  // namespace tensorflow
 
 #endif  // TENSORFLOW_CORE_COMMON_RUNTIME_SIMPLE_PROPAGATOR_STATE_H_
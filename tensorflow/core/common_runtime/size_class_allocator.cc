@@ -0,0 +1,295 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/size_class_allocator.h"
+
+#include <algorithm>
+#include <functional>
+#include <thread>  // NOLINT
+#include <utility>
+
+#include "tensorflow/core/lib/core/bits.h"
+#include "tensorflow/core/lib/monitoring/counter.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+namespace {
+
+auto* size_class_allocator_requests = monitoring::Counter<2>::New(
+    "/tensorflow/core/size_class_allocator/requests",
+    "The number of requests to a SizeClassAllocator, by whether they were "
+    "served from a cached buffer.",
+    "allocator", "result");
+
+auto* size_class_allocator_wasted_bytes = monitoring::Counter<1>::New(
+    "/tensorflow/core/size_class_allocator/wasted_bytes",
+    "The number of bytes allocated by a SizeClassAllocator beyond the "
+    "requested ones, by rounding the requests up to their size class.",
+    "allocator");
+
+constexpr size_t kHeaderBytes = Allocator::kAllocatorAlignment;
+constexpr size_t kMinClassBytes = Allocator::kAllocatorAlignment;
+constexpr int kMinClassLog2 = 6;
+static_assert(size_t{1} << kMinClassLog2 == kMinClassBytes);
+// The size classes per power of two.
+constexpr int kClassesPerLog2 = 4;
+// The size class of the buffers allocated directly by the sub-allocator.
+constexpr int kLargeClass = -1;
+
+void UpdateMax(std::atomic<int64_t>* max, int64_t value) {
+  int64_t current = max->load(std::memory_order_relaxed);
+  while (current < value &&
+         !max->compare_exchange_weak(current, value,
+                                     std::memory_order_relaxed)) {
+  }
+}
+
+// Stored in the `kHeaderBytes` before each returned buffer.
+struct Header {
+  // The start of the memory allocated by the sub-allocator.
+  void* base;
+  size_t block_bytes;
+  size_t requested_bytes;
+  // The size class of the buffer, or kLargeClass.
+  int size_class;
+};
+static_assert(sizeof(Header) <= kHeaderBytes);
+
+Header* GetHeader(const void* ptr) {
+  return reinterpret_cast<Header*>(
+      static_cast<char*>(const_cast<void*>(ptr)) - kHeaderBytes);
+}
+
+}  // namespace
+
+SizeClassAllocator::SizeClassAllocator(SubAllocator* sub_allocator,
+                                       const Options& options,
+                                       std::string name)
+    : name_(std::move(name)),
+      options_(options),
+      num_classes_(
+          SizeClass(std::max(options.max_class_bytes, kMinClassBytes)) + 1),
+      num_shards_(std::max(options.num_shards, 1)),
+      max_shard_cached_bytes_(options.max_cached_bytes / num_shards_),
+      sub_allocator_(sub_allocator),
+      shards_(new Shard[num_shards_]) {
+  for (int i = 0; i < num_shards_; ++i) {
+    mutex_lock l(shards_[i].mu);
+    shards_[i].free_lists.resize(num_classes_);
+  }
+}
+
+SizeClassAllocator::~SizeClassAllocator() { ReleaseCachedBuffers(); }
+
+int SizeClassAllocator::SizeClass(size_t num_bytes) {
+  if (num_bytes <= kMinClassBytes) return 0;
+  const int log2 = Log2Floor64(num_bytes - 1);
+  const size_t sub_class = (num_bytes - 1) >> (log2 - 2);
+  return (log2 - kMinClassLog2) * kClassesPerLog2 +
+         static_cast<int>(sub_class - kClassesPerLog2) + 1;
+}
+
+size_t SizeClassAllocator::SizeClassBytes(int size_class) {
+  if (size_class == 0) return kMinClassBytes;
+  const int log2 = (size_class - 1) / kClassesPerLog2 + kMinClassLog2;
+  const size_t sub_class = (size_class - 1) % kClassesPerLog2 + kClassesPerLog2;
+  return (sub_class + 1) << (log2 - 2);
+}
+
+SizeClassAllocator::Shard* SizeClassAllocator::HomeShard() {
+  static thread_local const size_t thread_hash =
+      std::hash<std::thread::id>()(std::this_thread::get_id());
+  return &shards_[thread_hash % num_shards_];
+}
+
+void* SizeClassAllocator::TakeCached(int size_class) {
+  const size_t class_bytes = SizeClassBytes(size_class);
+  auto take = [&](Shard* shard) TF_EXCLUSIVE_LOCKS_REQUIRED(shard->mu) {
+    std::vector<void*>& free_list = shard->free_lists[size_class];
+    if (free_list.empty()) return static_cast<void*>(nullptr);
+    void* ptr = free_list.back();
+    free_list.pop_back();
+    shard->cached_bytes -= class_bytes;
+    return ptr;
+  };
+
+  Shard* home = HomeShard();
+  {
+    mutex_lock l(home->mu);
+    if (void* ptr = take(home)) return ptr;
+  }
+  // Buffers freed by other threads end up in their shards. Look into those
+  // that are not busy before allocating a new buffer.
+  for (int i = 0; i < num_shards_; ++i) {
+    Shard* shard = &shards_[i];
+    if (shard == home || !shard->mu.try_lock()) continue;
+    void* ptr = take(shard);
+    shard->mu.unlock();
+    if (ptr != nullptr) return ptr;
+  }
+  return nullptr;
+}
+
+void* SizeClassAllocator::AllocateRaw(size_t alignment, size_t num_bytes) {
+  if (alignment > kAllocatorAlignment ||
+      num_bytes > options_.max_class_bytes) {
+    return AllocateLarge(alignment, num_bytes);
+  }
+
+  const int size_class = SizeClass(num_bytes);
+  const size_t class_bytes = SizeClassBytes(size_class);
+  void* ptr = TakeCached(size_class);
+  if (ptr != nullptr) {
+    num_cache_hits_.fetch_add(1, std::memory_order_relaxed);
+    cached_bytes_.fetch_sub(class_bytes, std::memory_order_relaxed);
+    size_class_allocator_requests->GetCell(name_, "hit")->IncrementBy(1);
+  } else {
+    num_cache_misses_.fetch_add(1, std::memory_order_relaxed);
+    size_class_allocator_requests->GetCell(name_, "miss")->IncrementBy(1);
+    size_t bytes_received;
+    void* base = sub_allocator_->Alloc(
+        kAllocatorAlignment, kHeaderBytes + class_bytes, &bytes_received);
+    if (base == nullptr) return nullptr;
+    ptr = static_cast<char*>(base) + kHeaderBytes;
+    Header* header = GetHeader(ptr);
+    header->base = base;
+    header->block_bytes = kHeaderBytes + class_bytes;
+    header->size_class = size_class;
+  }
+
+  Header* header = GetHeader(ptr);
+  header->requested_bytes = num_bytes;
+  size_class_allocator_wasted_bytes->GetCell(name_)->IncrementBy(class_bytes -
+                                                                 num_bytes);
+  class_requested_bytes_.fetch_add(num_bytes, std::memory_order_relaxed);
+  class_allocated_bytes_.fetch_add(class_bytes, std::memory_order_relaxed);
+  RecordAllocation(class_bytes);
+  return ptr;
+}
+
+void* SizeClassAllocator::AllocateLarge(size_t alignment, size_t num_bytes) {
+  // The buffer must be aligned, and preceded by room for its header.
+  const size_t offset = std::max(alignment, kHeaderBytes);
+  size_t bytes_received;
+  void* base = sub_allocator_->Alloc(std::max(alignment, kAllocatorAlignment),
+                                     offset + num_bytes, &bytes_received);
+  if (base == nullptr) return nullptr;
+  void* ptr = static_cast<char*>(base) + offset;
+  Header* header = GetHeader(ptr);
+  header->base = base;
+  header->block_bytes = offset + num_bytes;
+  header->requested_bytes = num_bytes;
+  header->size_class = kLargeClass;
+  RecordAllocation(num_bytes);
+  return ptr;
+}
+
+void SizeClassAllocator::DeallocateRaw(void* ptr) {
+  if (ptr == nullptr) return;
+  Header* header = GetHeader(ptr);
+  RecordDeallocation(AllocatedSize(ptr));
+  if (header->size_class == kLargeClass) {
+    sub_allocator_->Free(header->base, header->block_bytes);
+    return;
+  }
+
+  const size_t class_bytes = SizeClassBytes(header->size_class);
+  class_requested_bytes_.fetch_sub(header->requested_bytes,
+                                   std::memory_order_relaxed);
+  class_allocated_bytes_.fetch_sub(class_bytes, std::memory_order_relaxed);
+  Shard* shard = HomeShard();
+  {
+    mutex_lock l(shard->mu);
+    if (shard->cached_bytes + class_bytes <= max_shard_cached_bytes_) {
+      shard->free_lists[header->size_class].push_back(ptr);
+      shard->cached_bytes += class_bytes;
+      cached_bytes_.fetch_add(class_bytes, std::memory_order_relaxed);
+      return;
+    }
+  }
+  sub_allocator_->Free(header->base, header->block_bytes);
+}
+
+void SizeClassAllocator::ReleaseCachedBuffers() {
+  for (int i = 0; i < num_shards_; ++i) {
+    Shard& shard = shards_[i];
+    std::vector<std::vector<void*>> free_lists(num_classes_);
+    {
+      mutex_lock l(shard.mu);
+      std::swap(free_lists, shard.free_lists);
+      cached_bytes_.fetch_sub(shard.cached_bytes, std::memory_order_relaxed);
+      shard.cached_bytes = 0;
+    }
+    for (const std::vector<void*>& free_list : free_lists) {
+      for (void* ptr : free_list) {
+        Header* header = GetHeader(ptr);
+        sub_allocator_->Free(header->base, header->block_bytes);
+      }
+    }
+  }
+}
+
+size_t SizeClassAllocator::RequestedSize(const void* ptr) const {
+  return GetHeader(ptr)->requested_bytes;
+}
+
+size_t SizeClassAllocator::AllocatedSize(const void* ptr) const {
+  const Header* header = GetHeader(ptr);
+  if (header->size_class == kLargeClass) return header->requested_bytes;
+  return SizeClassBytes(header->size_class);
+}
+
+void SizeClassAllocator::RecordAllocation(int64_t allocated_bytes) {
+  num_allocs_.fetch_add(1, std::memory_order_relaxed);
+  const int64_t bytes_in_use =
+      bytes_in_use_.fetch_add(allocated_bytes, std::memory_order_relaxed) +
+      allocated_bytes;
+  UpdateMax(&peak_bytes_in_use_, bytes_in_use);
+  UpdateMax(&largest_alloc_size_, allocated_bytes);
+}
+
+void SizeClassAllocator::RecordDeallocation(int64_t allocated_bytes) {
+  bytes_in_use_.fetch_sub(allocated_bytes, std::memory_order_relaxed);
+}
+
+double SizeClassAllocator::InternalFragmentation() const {
+  const int64_t allocated_bytes =
+      class_allocated_bytes_.load(std::memory_order_relaxed);
+  if (allocated_bytes <= 0) return 0.0;
+  const int64_t requested_bytes =
+      class_requested_bytes_.load(std::memory_order_relaxed);
+  return 1.0 - static_cast<double>(requested_bytes) / allocated_bytes;
+}
+
+absl::optional<AllocatorStats> SizeClassAllocator::GetStats() {
+  AllocatorStats stats;
+  stats.num_allocs = num_allocs_.load(std::memory_order_relaxed);
+  stats.bytes_in_use = bytes_in_use_.load(std::memory_order_relaxed);
+  stats.peak_bytes_in_use = peak_bytes_in_use_.load(std::memory_order_relaxed);
+  stats.largest_alloc_size =
+      largest_alloc_size_.load(std::memory_order_relaxed);
+  stats.bytes_reserved = cached_bytes_.load(std::memory_order_relaxed);
+  return stats;
+}
+
+bool SizeClassAllocator::ClearStats() {
+  num_allocs_.store(0, std::memory_order_relaxed);
+  peak_bytes_in_use_.store(bytes_in_use_.load(std::memory_order_relaxed),
+                           std::memory_order_relaxed);
+  largest_alloc_size_.store(0, std::memory_order_relaxed);
+  return true;
+}
+
+}  // namespace tensorflow
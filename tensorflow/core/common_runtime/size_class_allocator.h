@@ -0,0 +1,144 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_SIZE_CLASS_ALLOCATOR_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_SIZE_CLASS_ALLOCATOR_H_
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// A CPU allocator that rounds requests up to a size class and caches the
+// freed buffers of each class for later requests of the same class, spread
+// over a number of shards so that concurrent sessions rarely contend on a
+// lock. Each thread allocates from and frees to its own shard, and only
+// looks into the other shards when its own has no buffer of the right class.
+// Requests larger than the largest class, or with an alignment above
+// `Allocator::kAllocatorAlignment`, go straight to the sub-allocator.
+//
+// There are four size classes per power of two, so the rounding wastes less
+// than 25% of a buffer. Each buffer is preceded by a header of
+// `kAllocatorAlignment` bytes that records its size class.
+//
+// The memory comes from a SubAllocator, e.g. a BasicCPUAllocator bound to a
+// NUMA node. Use one SizeClassAllocator per node to keep the cached buffers
+// local to it.
+//
+// Thread-safe.
+class SizeClassAllocator : public Allocator {
+ public:
+  struct Options {
+    // Requests up to this size are rounded up to a size class and cached.
+    size_t max_class_bytes = 1 << 20;
+    // The maximum total size of the cached buffers. Buffers freed beyond it
+    // are returned to the sub-allocator.
+    size_t max_cached_bytes = 256 << 20;
+    // The number of shards the cached buffers are spread over.
+    int num_shards = 16;
+  };
+
+  // Takes ownership of `sub_allocator`.
+  SizeClassAllocator(SubAllocator* sub_allocator, const Options& options,
+                     std::string name);
+  ~SizeClassAllocator() override;
+
+  std::string Name() override { return name_; }
+
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override;
+  void DeallocateRaw(void* ptr) override;
+
+  bool TracksAllocationSizes() const override { return true; }
+  size_t RequestedSize(const void* ptr) const override;
+  size_t AllocatedSize(const void* ptr) const override;
+
+  absl::optional<AllocatorStats> GetStats() override;
+  bool ClearStats() override;
+
+  AllocatorMemoryType GetMemoryType() const override {
+    return sub_allocator_->GetMemoryType();
+  }
+
+  // Returns all the cached buffers to the sub-allocator.
+  void ReleaseCachedBuffers();
+
+  // The number of size-class requests served from a cached buffer, or with a
+  // new buffer from the sub-allocator.
+  int64_t num_cache_hits() const {
+    return num_cache_hits_.load(std::memory_order_relaxed);
+  }
+  int64_t num_cache_misses() const {
+    return num_cache_misses_.load(std::memory_order_relaxed);
+  }
+
+  // The fraction of the size-class buffers in use that is wasted by rounding
+  // the requests up to their size class.
+  double InternalFragmentation() const;
+
+  // Returns the index of the size class of `num_bytes`, and the size of the
+  // buffers of a size class.
+  static int SizeClass(size_t num_bytes);
+  static size_t SizeClassBytes(int size_class);
+
+ private:
+  struct alignas(64) Shard {
+    mutex mu;
+    // The cached buffers of each size class.
+    std::vector<std::vector<void*>> free_lists TF_GUARDED_BY(mu);
+    size_t cached_bytes TF_GUARDED_BY(mu) = 0;
+  };
+
+  // Returns the shard of the calling thread.
+  Shard* HomeShard();
+  // Returns a cached buffer of `size_class`, or nullptr.
+  void* TakeCached(int size_class);
+
+  void* AllocateLarge(size_t alignment, size_t num_bytes);
+  void RecordAllocation(int64_t allocated_bytes);
+  void RecordDeallocation(int64_t allocated_bytes);
+
+  const std::string name_;
+  const Options options_;
+  const int num_classes_;
+  const int num_shards_;
+  const size_t max_shard_cached_bytes_;
+  std::unique_ptr<SubAllocator> sub_allocator_;
+  std::unique_ptr<Shard[]> shards_;
+
+  std::atomic<int64_t> num_cache_hits_{0};
+  std::atomic<int64_t> num_cache_misses_{0};
+  std::atomic<int64_t> num_allocs_{0};
+  std::atomic<int64_t> bytes_in_use_{0};
+  std::atomic<int64_t> peak_bytes_in_use_{0};
+  std::atomic<int64_t> largest_alloc_size_{0};
+  std::atomic<int64_t> cached_bytes_{0};
+  // The requested and allocated bytes of the size-class buffers in use.
+  std::atomic<int64_t> class_requested_bytes_{0};
+  std::atomic<int64_t> class_allocated_bytes_{0};
+
+  SizeClassAllocator(const SizeClassAllocator&) = delete;
+  void operator=(const SizeClassAllocator&) = delete;
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_SIZE_CLASS_ALLOCATOR_H_
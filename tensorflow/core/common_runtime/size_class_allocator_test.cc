@@ -0,0 +1,165 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/size_class_allocator.h"
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/pool_allocator.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/numa.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/threadpool.h"
+
+namespace tensorflow {
+namespace {
+
+SizeClassAllocator::Options SmallOptions() {
+  SizeClassAllocator::Options options;
+  options.max_class_bytes = 1 << 16;
+  options.max_cached_bytes = 1 << 20;
+  options.num_shards = 4;
+  return options;
+}
+
+SubAllocator* NewSubAllocator() {
+  return new BasicCPUAllocator(port::kNUMANoAffinity, {}, {});
+}
+
+TEST(SizeClassAllocatorTest, SizeClasses) {
+  size_t previous_bytes = 0;
+  for (size_t num_bytes = 1; num_bytes <= (1 << 20); ++num_bytes) {
+    const int size_class = SizeClassAllocator::SizeClass(num_bytes);
+    const size_t class_bytes = SizeClassAllocator::SizeClassBytes(size_class);
+    ASSERT_GE(class_bytes, num_bytes);
+    // The next smaller class is too small.
+    if (size_class > 0) {
+      ASSERT_LT(SizeClassAllocator::SizeClassBytes(size_class - 1), num_bytes);
+    }
+    if (num_bytes > 64) ASSERT_LT(class_bytes - num_bytes, num_bytes / 4 + 1);
+    ASSERT_GE(class_bytes, previous_bytes);
+    previous_bytes = class_bytes;
+  }
+  EXPECT_EQ(SizeClassAllocator::SizeClassBytes(0), 64);
+  EXPECT_EQ(SizeClassAllocator::SizeClassBytes(1), 80);
+  EXPECT_EQ(SizeClassAllocator::SizeClass(897),
+            SizeClassAllocator::SizeClass(1024));
+}
+
+TEST(SizeClassAllocatorTest, ReusesFreedBuffers) {
+  SizeClassAllocator allocator(NewSubAllocator(), SmallOptions(), "test");
+  void* p1 = allocator.AllocateRaw(Allocator::kAllocatorAlignment, 1000);
+  ASSERT_NE(p1, nullptr);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(p1) % Allocator::kAllocatorAlignment,
+            0);
+  EXPECT_EQ(allocator.RequestedSize(p1), 1000);
+  EXPECT_EQ(allocator.AllocatedSize(p1), 1024);
+  memset(p1, 0, 1000);
+  allocator.DeallocateRaw(p1);
+  EXPECT_EQ(allocator.num_cache_misses(), 1);
+
+  // A request of the same size class gets the freed buffer back.
+  void* p2 = allocator.AllocateRaw(Allocator::kAllocatorAlignment, 1020);
+  EXPECT_EQ(p2, p1);
+  EXPECT_EQ(allocator.num_cache_hits(), 1);
+  EXPECT_EQ(allocator.RequestedSize(p2), 1020);
+
+  // A request of another size class does not.
+  void* p3 = allocator.AllocateRaw(Allocator::kAllocatorAlignment, 2000);
+  EXPECT_NE(p3, p1);
+  EXPECT_EQ(allocator.num_cache_misses(), 2);
+
+  auto stats = allocator.GetStats();
+  ASSERT_TRUE(stats.has_value());
+  EXPECT_EQ(stats->num_allocs, 3);
+  EXPECT_EQ(stats->bytes_in_use, 1024 + 2048);
+  EXPECT_EQ(stats->bytes_reserved, 0);
+  EXPECT_NEAR(allocator.InternalFragmentation(),
+              1.0 - (1020.0 + 2000.0) / (1024 + 2048), 1e-9);
+
+  allocator.DeallocateRaw(p2);
+  allocator.DeallocateRaw(p3);
+  stats = allocator.GetStats();
+  EXPECT_EQ(stats->bytes_in_use, 0);
+  EXPECT_EQ(stats->bytes_reserved, 1024 + 2048);
+  EXPECT_EQ(stats->peak_bytes_in_use, 1024 + 2048);
+
+  allocator.ReleaseCachedBuffers();
+  EXPECT_EQ(allocator.GetStats()->bytes_reserved, 0);
+}
+
+TEST(SizeClassAllocatorTest, LargeAndOveralignedAllocations) {
+  SizeClassAllocator allocator(NewSubAllocator(), SmallOptions(), "test");
+  void* large = allocator.AllocateRaw(Allocator::kAllocatorAlignment, 1 << 17);
+  ASSERT_NE(large, nullptr);
+  EXPECT_EQ(allocator.AllocatedSize(large), 1 << 17);
+  memset(large, 0, 1 << 17);
+
+  void* aligned = allocator.AllocateRaw(4096, 100);
+  ASSERT_NE(aligned, nullptr);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(aligned) % 4096, 0);
+  EXPECT_EQ(allocator.RequestedSize(aligned), 100);
+
+  // Neither is served from nor returned to the cache.
+  allocator.DeallocateRaw(large);
+  allocator.DeallocateRaw(aligned);
+  EXPECT_EQ(allocator.num_cache_hits() + allocator.num_cache_misses(), 0);
+  EXPECT_EQ(allocator.GetStats()->bytes_reserved, 0);
+}
+
+TEST(SizeClassAllocatorTest, LimitsCachedBytes) {
+  SizeClassAllocator::Options options = SmallOptions();
+  options.max_cached_bytes = 4 * 4096;
+  options.num_shards = 1;
+  SizeClassAllocator allocator(NewSubAllocator(), options, "test");
+  std::vector<void*> ptrs;
+  for (int i = 0; i < 8; ++i) {
+    ptrs.push_back(allocator.AllocateRaw(Allocator::kAllocatorAlignment, 4096));
+  }
+  for (void* ptr : ptrs) allocator.DeallocateRaw(ptr);
+  EXPECT_EQ(allocator.GetStats()->bytes_reserved, 4 * 4096);
+}
+
+TEST(SizeClassAllocatorTest, ConcurrentAllocations) {
+  SizeClassAllocator allocator(NewSubAllocator(), SmallOptions(), "test");
+  {
+    thread::ThreadPool pool(Env::Default(), "test", 8);
+    for (int t = 0; t < 8; ++t) {
+      pool.Schedule([&allocator, t]() {
+        std::vector<void*> ptrs;
+        for (int i = 0; i < 1000; ++i) {
+          const size_t num_bytes = 1 + (i * 37 + t) % 10000;
+          char* ptr = static_cast<char*>(
+              allocator.AllocateRaw(Allocator::kAllocatorAlignment, num_bytes));
+          CHECK(ptr != nullptr);
+          memset(ptr, t, num_bytes);
+          ptrs.push_back(ptr);
+          if (ptrs.size() > 16) {
+            allocator.DeallocateRaw(ptrs.front());
+            ptrs.erase(ptrs.begin());
+          }
+        }
+        for (void* ptr : ptrs) allocator.DeallocateRaw(ptr);
+      });
+    }
+  }
+  EXPECT_EQ(allocator.GetStats()->bytes_in_use, 0);
+  EXPECT_GT(allocator.num_cache_hits(), 0);
+}
+
+}  // namespace
+}  // namespace tensorflow
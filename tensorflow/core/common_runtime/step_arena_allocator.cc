@@ -0,0 +1,127 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/step_arena_allocator.h"
+
+#include <utility>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+
+StepArenaAllocator::StepArenaAllocator(Allocator* base, size_t slab_bytes)
+    : base_(base), slab_bytes_(slab_bytes) {
+  CHECK_LE(slab_bytes_, kOffsetMask);
+  for (Slab& slab : slabs_) {
+    slab.base = static_cast<char*>(
+        base_->AllocateRaw(Allocator::kAllocatorAlignment, slab_bytes_));
+  }
+}
+
+StepArenaAllocator::~StepArenaAllocator() {
+  for (Slab& slab : slabs_) {
+    const uint64 state = slab.state.load(std::memory_order_acquire);
+    CHECK_EQ(state >> kOffsetBits, 0)
+        << "StepArenaAllocator destroyed with live allocations";
+    if (slab.base != nullptr) base_->DeallocateRaw(slab.base);
+  }
+}
+
+StepArenaAllocator* StepArenaAllocator::GetOrCreate(Allocator* base,
+                                                    size_t slab_bytes) {
+  static mutex* mu = new mutex;
+  static auto* arenas =
+      new absl::flat_hash_map<std::pair<Allocator*, size_t>,
+                              StepArenaAllocator*>;
+  mutex_lock l(*mu);
+  StepArenaAllocator*& arena = (*arenas)[{base, slab_bytes}];
+  if (arena == nullptr) {
+    arena = new StepArenaAllocator(base, slab_bytes);
+  }
+  return arena;
+}
+
+size_t StepArenaAllocator::SlabBytesFromEnv() {
+  int64_t step_arena_mb = 0;
+  TF_CHECK_OK(ReadInt64FromEnvVar("TF_CPU_STEP_ARENA_MB", 0, &step_arena_mb));
+  return step_arena_mb > 0 ? static_cast<size_t>(step_arena_mb) << 20 : 0;
+}
+
+void* StepArenaAllocator::TryAllocate(Slab* slab, size_t num_bytes) {
+  if (slab->base == nullptr) return nullptr;
+  uint64 state = slab->state.load(std::memory_order_relaxed);
+  while (true) {
+    const uint64 offset = state & kOffsetMask;
+    if (offset + num_bytes > slab_bytes_) return nullptr;
+    if (slab->state.compare_exchange_weak(state, state + kOneLive + num_bytes,
+                                          std::memory_order_acq_rel)) {
+      return slab->base + offset;
+    }
+  }
+}
+
+void* StepArenaAllocator::AllocateRaw(size_t alignment, size_t num_bytes) {
+  return AllocateRaw(alignment, num_bytes, AllocationAttributes());
+}
+
+void* StepArenaAllocator::AllocateRaw(
+    size_t alignment, size_t num_bytes,
+    const AllocationAttributes& allocation_attr) {
+  if (num_bytes > 0 && num_bytes <= slab_bytes_ &&
+      alignment <= Allocator::kAllocatorAlignment) {
+    // Keep every allocation aligned to `kAllocatorAlignment`; the slabs
+    // themselves are aligned to it.
+    const size_t rounded_bytes =
+        (num_bytes + Allocator::kAllocatorAlignment - 1) &
+        ~(Allocator::kAllocatorAlignment - 1);
+    const int current = current_slab_.load(std::memory_order_relaxed);
+    for (int i = 0; i < kNumSlabs; ++i) {
+      const int index = (current + i) % kNumSlabs;
+      if (void* ptr = TryAllocate(&slabs_[index], rounded_bytes)) {
+        if (index != current) {
+          current_slab_.store(index, std::memory_order_relaxed);
+        }
+        num_arena_allocations_.fetch_add(1, std::memory_order_relaxed);
+        return ptr;
+      }
+    }
+  }
+  num_fallback_allocations_.fetch_add(1, std::memory_order_relaxed);
+  return base_->AllocateRaw(alignment, num_bytes, allocation_attr);
+}
+
+void StepArenaAllocator::DeallocateRaw(void* ptr) {
+  for (Slab& slab : slabs_) {
+    if (!Contains(slab, ptr)) continue;
+    const uint64 prev =
+        slab.state.fetch_sub(kOneLive, std::memory_order_acq_rel);
+    DCHECK_GT(prev >> kOffsetBits, 0);
+    if ((prev >> kOffsetBits) == 1) {
+      // This was the last live allocation: rewind the bump pointer. If another
+      // allocation raced with us, the CAS fails and the slab is rewound the
+      // next time its live count drops to zero.
+      uint64 expected = prev - kOneLive;
+      slab.state.compare_exchange_strong(expected, 0,
+                                         std::memory_order_acq_rel);
+    }
+    return;
+  }
+  base_->DeallocateRaw(ptr);
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,140 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_STEP_ARENA_ALLOCATOR_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_STEP_ARENA_ALLOCATOR_H_
+
+#include <atomic>
+#include <string>
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// An allocator that serves the short-lived intermediate tensors of a step from
+// preallocated slabs with a lock-free bump pointer, and falls back to a
+// `base` allocator for everything that does not fit.
+//
+// Each slab counts its live allocations. When the count drops to zero, which
+// for a graph whose intermediates are all released at the end of the step
+// happens once per step, the bump pointer is reset and the slab is reused by
+// the next step. No memory is reused *within* a step: the executor may run
+// ready nodes in a different order every step, so an offset plan recorded in
+// one step is not safe to replay in the next.
+//
+// A tensor that outlives the step (e.g. a variable or a fetched output) pins
+// the slab it was allocated from, so devices only send allocations marked with
+// `MarkStepScoped()` here. The executor marks the outputs of nodes whose
+// tensors are not retained by a stateful node, returned from the graph or
+// sent to another device. The allocator alternates between two slabs so that
+// a tensor that is misclassified, or a marked tensor that the next step
+// starts before releasing, does not force every allocation to `base`.
+//
+// Thread-safe.
+class StepArenaAllocator : public Allocator {
+ public:
+  // `base` is not owned and must outlive this allocator. Each of the two slabs
+  // is `slab_bytes` large.
+  StepArenaAllocator(Allocator* base, size_t slab_bytes);
+  ~StepArenaAllocator() override;
+
+  // Returns a process-lifetime arena wrapping `base`, creating it on first
+  // use. Tensors allocated by a device may outlive the device, so the
+  // allocator that frees them must never be destroyed.
+  static StepArenaAllocator* GetOrCreate(Allocator* base, size_t slab_bytes);
+
+  // Returns the slab size requested with TF_CPU_STEP_ARENA_MB, or 0 if the
+  // arena is disabled.
+  static size_t SlabBytesFromEnv();
+
+  // The executor marks every output of a graph on a device with an arena as
+  // either step-scoped or outliving the step. These are device-specific bits
+  // of `AllocatorAttributes::value` (see allocator.h). Because they are
+  // distinct bits, `OpKernelContext::forward_input()` does not forward the
+  // buffer of a step-scoped input to an output that outlives the step.
+  static void MarkStepScoped(AllocatorAttributes* attr) {
+    attr->value |= kStepScopedAttr;
+  }
+  static void MarkOutlivesStep(AllocatorAttributes* attr) {
+    attr->value |= kOutlivesStepAttr;
+  }
+  static bool IsStepScoped(AllocatorAttributes attr) {
+    return (attr.value & kStepScopedAttr) != 0;
+  }
+
+  std::string Name() override { return "step_arena"; }
+
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override;
+  void* AllocateRaw(size_t alignment, size_t num_bytes,
+                    const AllocationAttributes& allocation_attr) override;
+  void DeallocateRaw(void* ptr) override;
+
+  absl::optional<AllocatorStats> GetStats() override {
+    return base_->GetStats();
+  }
+  AllocatorMemoryType GetMemoryType() const override {
+    return base_->GetMemoryType();
+  }
+
+  // Number of allocations served from a slab or by the base allocator.
+  int64_t num_arena_allocations() const {
+    return num_arena_allocations_.load(std::memory_order_relaxed);
+  }
+  int64_t num_fallback_allocations() const {
+    return num_fallback_allocations_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  static constexpr int kNumSlabs = 2;
+  static constexpr uint32 kStepScopedAttr = 1u << 24;
+  static constexpr uint32 kOutlivesStepAttr = 1u << 25;
+
+  // The state of a slab is packed into a single word so that allocation,
+  // deallocation and reset are each a single atomic operation: the upper
+  // bits count live allocations and the lower `kOffsetBits` hold the bump
+  // offset.
+  static constexpr int kOffsetBits = 40;
+  static constexpr uint64 kOffsetMask = (uint64{1} << kOffsetBits) - 1;
+  static constexpr uint64 kOneLive = uint64{1} << kOffsetBits;
+
+  struct alignas(64) Slab {
+    char* base = nullptr;
+    std::atomic<uint64> state{0};
+  };
+
+  // Returns a pointer to `num_bytes` in `slab`, or nullptr if it is full.
+  void* TryAllocate(Slab* slab, size_t num_bytes);
+  bool Contains(const Slab& slab, const void* ptr) const {
+    return slab.base != nullptr && ptr >= slab.base &&
+           ptr < slab.base + slab_bytes_;
+  }
+
+  Allocator* const base_;  // Not owned.
+  const size_t slab_bytes_;
+  Slab slabs_[kNumSlabs];
+  // Index of the slab that allocations are tried first.
+  std::atomic<int> current_slab_{0};
+
+  std::atomic<int64_t> num_arena_allocations_{0};
+  std::atomic<int64_t> num_fallback_allocations_{0};
+
+  StepArenaAllocator(const StepArenaAllocator&) = delete;
+  void operator=(const StepArenaAllocator&) = delete;
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_STEP_ARENA_ALLOCATOR_H_
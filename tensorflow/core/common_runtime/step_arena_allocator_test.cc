@@ -0,0 +1,127 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/step_arena_allocator.h"
+
+#include <cstdint>
+#include <vector>
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+constexpr size_t kSlabBytes = 1 << 16;
+
+TEST(StepArenaAllocatorTest, ServesFromSlabAndRewinds) {
+  StepArenaAllocator arena(cpu_allocator(), kSlabBytes);
+  void* first = arena.AllocateRaw(Allocator::kAllocatorAlignment, 100);
+  void* second = arena.AllocateRaw(Allocator::kAllocatorAlignment, 100);
+  ASSERT_NE(first, nullptr);
+  ASSERT_NE(second, nullptr);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(first) % Allocator::kAllocatorAlignment,
+            0);
+  EXPECT_EQ(
+      reinterpret_cast<uintptr_t>(second) % Allocator::kAllocatorAlignment, 0);
+  EXPECT_EQ(static_cast<char*>(second) - static_cast<char*>(first),
+            2 * Allocator::kAllocatorAlignment);
+  arena.DeallocateRaw(first);
+  arena.DeallocateRaw(second);
+
+  // All allocations of the "step" are gone, so the next step starts over at
+  // the beginning of the slab.
+  void* third = arena.AllocateRaw(Allocator::kAllocatorAlignment, 100);
+  EXPECT_EQ(third, first);
+  arena.DeallocateRaw(third);
+
+  EXPECT_EQ(arena.num_arena_allocations(), 3);
+  EXPECT_EQ(arena.num_fallback_allocations(), 0);
+}
+
+TEST(StepArenaAllocatorTest, FallsBackWhenFull) {
+  StepArenaAllocator arena(cpu_allocator(), kSlabBytes);
+  // Too large for any slab.
+  void* large = arena.AllocateRaw(Allocator::kAllocatorAlignment,
+                                  kSlabBytes + 1);
+  ASSERT_NE(large, nullptr);
+  EXPECT_EQ(arena.num_fallback_allocations(), 1);
+
+  // Fill both slabs, then spill to the base allocator.
+  std::vector<void*> ptrs;
+  for (int i = 0; i < 3; ++i) {
+    ptrs.push_back(
+        arena.AllocateRaw(Allocator::kAllocatorAlignment, kSlabBytes));
+    ASSERT_NE(ptrs.back(), nullptr);
+  }
+  EXPECT_EQ(arena.num_arena_allocations(), 2);
+  EXPECT_EQ(arena.num_fallback_allocations(), 2);
+
+  for (void* ptr : ptrs) arena.DeallocateRaw(ptr);
+  arena.DeallocateRaw(large);
+}
+
+TEST(StepArenaAllocatorTest, PinnedSlabDoesNotBlockOtherSlab) {
+  StepArenaAllocator arena(cpu_allocator(), kSlabBytes);
+  // A long-lived allocation pins the first slab.
+  void* pinned = arena.AllocateRaw(Allocator::kAllocatorAlignment, 64);
+  for (int step = 0; step < 10; ++step) {
+    void* a = arena.AllocateRaw(Allocator::kAllocatorAlignment,
+                                kSlabBytes / 2);
+    void* b = arena.AllocateRaw(Allocator::kAllocatorAlignment,
+                                kSlabBytes / 2);
+    arena.DeallocateRaw(a);
+    arena.DeallocateRaw(b);
+  }
+  EXPECT_EQ(arena.num_fallback_allocations(), 0);
+  arena.DeallocateRaw(pinned);
+}
+
+TEST(StepArenaAllocatorTest, BacksTensors) {
+  StepArenaAllocator arena(cpu_allocator(), kSlabBytes);
+  for (int step = 0; step < 3; ++step) {
+    Tensor t(&arena, DT_FLOAT, TensorShape({16, 16}));
+    t.flat<float>().setConstant(step);
+    EXPECT_EQ(t.flat<float>()(255), step);
+  }
+  EXPECT_EQ(arena.num_arena_allocations(), 3);
+}
+
+TEST(StepArenaAllocatorTest, StepScopedInputIsNotForwardedPastTheStep) {
+  AllocatorAttributes step_scoped;
+  StepArenaAllocator::MarkStepScoped(&step_scoped);
+  AllocatorAttributes outlives_step;
+  StepArenaAllocator::MarkOutlivesStep(&outlives_step);
+  EXPECT_TRUE(StepArenaAllocator::IsStepScoped(step_scoped));
+  EXPECT_FALSE(StepArenaAllocator::IsStepScoped(outlives_step));
+  EXPECT_FALSE(StepArenaAllocator::IsStepScoped(AllocatorAttributes()));
+
+  // `OpKernelContext::forward_input()` only forwards an input to an output
+  // whose attributes are equal or less restrictive.
+  EXPECT_FALSE(outlives_step.IsEqualOrLessRestrictiveThan(step_scoped));
+  EXPECT_TRUE(step_scoped.IsEqualOrLessRestrictiveThan(step_scoped));
+}
+
+TEST(StepArenaAllocatorTest, GetOrCreateReturnsSameInstance) {
+  StepArenaAllocator* a =
+      StepArenaAllocator::GetOrCreate(cpu_allocator(), kSlabBytes);
+  StepArenaAllocator* b =
+      StepArenaAllocator::GetOrCreate(cpu_allocator(), kSlabBytes);
+  EXPECT_EQ(a, b);
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -18,6 +18,7 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/costmodel_manager.h"
 #include "tensorflow/core/framework/allocation_description.pb.h"
+#include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_description.pb.h"
@@ -558,4 +559,62 @@ void StepStatsCollector::FinalizeInternal() {
     }
   }
 }
+
+namespace {
+
+// The statistics of a node sampled by OpStatsSampler, which only measure its
+// compute time.
+class SampledNodeExecStats : public NodeExecStatsInterface {
+ public:
+  SampledNodeExecStats(const NodeDef* node, OpStatsSampler* sampler)
+      : node_(node), sampler_(sampler) {}
+
+  void Done(const string& device) override {
+    sampler_->Record(node_->op(), compute_end_nanos_ - compute_start_nanos_);
+    delete this;
+  }
+
+  void RecordExecutorStarted() override {}
+  void RecordComputeStarted() override {
+    compute_start_nanos_ = Env::Default()->NowNanos();
+  }
+  void RecordComputeEnded() override {
+    compute_end_nanos_ = Env::Default()->NowNanos();
+  }
+  void RecordExecutorEnded() override {}
+  bool TrackAllocations() const override { return false; }
+  void SetMemory(OpKernelContext* ctx) override {}
+  void SetOutput(int slot, const Tensor* tensor) override {}
+  void SetScheduled(int64_t nanos) override {}
+
+ private:
+  const NodeDef* const node_;  // Not owned.
+  OpStatsSampler* const sampler_;  // Not owned.
+  int64_t compute_start_nanos_ = 0;
+  int64_t compute_end_nanos_ = 0;
+};
+
+}  // namespace
+
+OpStatsSampler::~OpStatsSampler() {
+  mutex_lock l(mu_);
+  for (const auto& op_stats : op_stats_) {
+    metrics::RecordSampledOpStats(
+        op_stats.first, op_stats.second.count,
+        op_stats.second.compute_time_nanos / EnvTime::kMicrosToNanos);
+  }
+}
+
+NodeExecStatsInterface* OpStatsSampler::CreateNodeExecStats(
+    const NodeDef* node) {
+  return new SampledNodeExecStats(node, this);
+}
+
+void OpStatsSampler::Record(const string& op, int64_t compute_time_nanos) {
+  mutex_lock l(mu_);
+  OpStats& op_stats = op_stats_[op];
+  ++op_stats.count;
+  op_stats.compute_time_nanos += compute_time_nanos;
+}
+
 }  // namespace tensorflow
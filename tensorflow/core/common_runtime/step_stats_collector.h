@@ -19,6 +19,7 @@ limitations under the License.
 #include <unordered_map>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/step_stats.pb.h"
 #include "tensorflow/core/framework/tracking_allocator.h"
@@ -203,6 +204,35 @@ class StepStatsCollector : public StepStatsCollectorInterface {
   uint64 collected_nodes_ TF_GUARDED_BY(mu_) = 0;
 };
 
+// OpStatsSampler aggregates the compute time of the ops of a step by op type,
+// and adds it to the "/tensorflow/core/sampled_op_*" metrics when destroyed.
+// Unlike StepStatsCollector, it keeps no per-node statistics, timeline labels
+// or allocations, so that a session can keep collecting it on a sample of its
+// steps in production (see `ConfigProto.Experimental.op_stats_sampling_period`)
+// instead of on-demand traces.
+class OpStatsSampler : public StepStatsCollectorInterface {
+ public:
+  OpStatsSampler() = default;
+  ~OpStatsSampler() override;
+
+  NodeExecStatsInterface* CreateNodeExecStats(const NodeDef* node) override;
+  string ReportAllocsOnResourceExhausted(absl::string_view err) override {
+    return "";
+  }
+
+  // Adds an execution of an op of type `op` to the statistics of the step.
+  void Record(const string& op, int64_t compute_time_nanos);
+
+ private:
+  struct OpStats {
+    int64_t count = 0;
+    int64_t compute_time_nanos = 0;
+  };
+
+  mutex mu_;
+  absl::flat_hash_map<string, OpStats> op_stats_ TF_GUARDED_BY(mu_);
+};
+
 }  // namespace tensorflow
 
 #endif  // TENSORFLOW_CORE_COMMON_RUNTIME_STEP_STATS_COLLECTOR_H_
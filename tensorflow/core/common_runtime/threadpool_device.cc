@@ -31,6 +31,7 @@ info. It does not have any negative impact on performance. */
 #include "tensorflow/core/common_runtime/local_device.h"
 #include "tensorflow/core/common_runtime/scoped_allocator.h"
 #include "tensorflow/core/common_runtime/scoped_allocator_mgr.h"
+#include "tensorflow/core/common_runtime/step_arena_allocator.h"
 #include "tensorflow/core/common_runtime/threadpool_device.h"
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/allocator_registry.h"
@@ -61,6 +62,12 @@ ThreadPoolDevice::ThreadPoolDevice(const SessionOptions& options,
                                name, DEVICE_CPU, memory_limit, locality)),
       allocator_(allocator),
       scoped_allocator_mgr_(new ScopedAllocatorMgr(name)) {
+  const size_t step_arena_bytes = StepArenaAllocator::SlabBytesFromEnv();
+  if (step_arena_bytes > 0) {
+    step_allocator_ =
+        StepArenaAllocator::GetOrCreate(allocator_, step_arena_bytes);
+  }
+
   auto s = NodeFileWriter::GetNodeFileWriterIfEnabled(name, env());
   if (!s.ok()) {
     LOG(ERROR) << s.status();
@@ -104,6 +111,9 @@ ThreadPoolDevice::ThreadPoolDevice(const SessionOptions& options,
 ThreadPoolDevice::~ThreadPoolDevice() {}
 
 Allocator* ThreadPoolDevice::GetAllocator(AllocatorAttributes attr) {
+  if (step_allocator_ != nullptr && StepArenaAllocator::IsStepScoped(attr)) {
+    return step_allocator_;
+  }
   return allocator_;
 }
 
@@ -54,6 +54,11 @@ class ThreadPoolDevice : public LocalDevice {
   void LogOutputs(OpKernel* op_kernel, OpKernelContext* context);
 
   Allocator* allocator_;  // Not owned
+  // If non-null, returned by `GetAllocator()` for allocations the executor
+  // marked as step-scoped, so that they are served from a slab instead of
+  // `allocator_`. Enabled by setting TF_CPU_STEP_ARENA_MB to the size of each
+  // slab. Not owned.
+  Allocator* step_allocator_ = nullptr;
   std::unique_ptr<ScopedAllocatorMgr> scoped_allocator_mgr_;
   NodeFileWriter* node_file_writer_ = nullptr;  // not owned
 };
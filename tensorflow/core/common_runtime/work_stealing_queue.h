@@ -0,0 +1,150 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_WORK_STEALING_QUEUE_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_WORK_STEALING_QUEUE_H_
+
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <utility>
+
+#include "absl/types/optional.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+
+// A fixed set of double-ended queues, one per worker, that supports work
+// stealing.
+//
+// A worker pushes and pops at the back of its own queue, so the most recently
+// produced item (typically a successor of the node it just ran, whose inputs
+// are still in cache) is consumed first. When its own queue is empty, a worker
+// steals from the front of the other queues, i.e. the oldest items.
+//
+// The set also tracks how many workers are currently draining it, so that a
+// producer only needs to start a new worker when fewer than `max_workers` are
+// active. See `TryAddWorker()` and `RemoveWorker()` for the protocol.
+//
+// Each queue is guarded by its own mutex. Critical sections are a handful of
+// instructions and contention is spread over `num_queues` locks, which in
+// practice is cheaper than a single shared threadpool queue.
+template <typename T>
+class WorkStealingQueueSet {
+ public:
+  explicit WorkStealingQueueSet(int num_queues)
+      : num_queues_(num_queues), queues_(new Queue[num_queues]) {
+    DCHECK_GT(num_queues, 0);
+  }
+
+  WorkStealingQueueSet(const WorkStealingQueueSet&) = delete;
+  void operator=(const WorkStealingQueueSet&) = delete;
+
+  int num_queues() const { return num_queues_; }
+
+  // Returns an approximation of the number of items in all queues.
+  int64_t size() const { return size_.load(std::memory_order_acquire); }
+
+  // Adds `item` to the back of the queue owned by worker `queue_id`.
+  void Push(int queue_id, T item) {
+    Queue& q = queues_[queue_id % num_queues_];
+    {
+      mutex_lock l(q.mu);
+      q.items.push_back(std::move(item));
+    }
+    size_.fetch_add(1, std::memory_order_release);
+  }
+
+  // Removes and returns an item for worker `queue_id`. Items are taken from
+  // the back of the worker's own queue first, and otherwise stolen from the
+  // front of the other queues. Returns `absl::nullopt` if all queues are
+  // empty.
+  absl::optional<T> Pop(int queue_id) {
+    if (size_.load(std::memory_order_acquire) == 0) return absl::nullopt;
+    const int own = queue_id % num_queues_;
+    {
+      Queue& q = queues_[own];
+      mutex_lock l(q.mu);
+      if (!q.items.empty()) {
+        T item = std::move(q.items.back());
+        q.items.pop_back();
+        size_.fetch_sub(1, std::memory_order_release);
+        return item;
+      }
+    }
+    for (int i = 1; i < num_queues_; ++i) {
+      Queue& q = queues_[(own + i) % num_queues_];
+      mutex_lock l(q.mu);
+      if (!q.items.empty()) {
+        T item = std::move(q.items.front());
+        q.items.pop_front();
+        size_.fetch_sub(1, std::memory_order_release);
+        return item;
+      }
+    }
+    return absl::nullopt;
+  }
+
+  // Registers a new worker if fewer than `max_workers` are active. Returns
+  // true if the caller is now responsible for running a worker that drains
+  // the set.
+  bool TryAddWorker(int max_workers) {
+    int n = num_workers_.load(std::memory_order_relaxed);
+    while (n < max_workers) {
+      if (num_workers_.compare_exchange_weak(n, n + 1,
+                                             std::memory_order_acq_rel)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // Unregisters a worker whose `Pop()` returned `absl::nullopt`. Returns true
+  // if the worker may exit. Returns false if items were pushed concurrently
+  // and the worker has been re-registered to process them; in that case the
+  // caller must continue draining the set.
+  //
+  // Because a producer only starts a worker when `TryAddWorker()` succeeds,
+  // the re-check here guarantees that no item is left in the set without an
+  // active worker.
+  bool RemoveWorker(int max_workers) {
+    num_workers_.fetch_sub(1, std::memory_order_acq_rel);
+    if (size_.load(std::memory_order_acquire) == 0) return true;
+    return !TryAddWorker(max_workers);
+  }
+
+  // Returns the number of workers currently registered.
+  int num_workers() const {
+    return num_workers_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  // Aligned to avoid false sharing between adjacent queues.
+  struct alignas(64) Queue {
+    mutex mu;
+    std::deque<T> items TF_GUARDED_BY(mu);
+  };
+
+  const int num_queues_;
+  std::unique_ptr<Queue[]> queues_;
+  alignas(64) std::atomic<int64_t> size_{0};
+  alignas(64) std::atomic<int> num_workers_{0};
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_WORK_STEALING_QUEUE_H_
@@ -0,0 +1,111 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/work_stealing_queue.h"
+
+#include <atomic>
+#include <vector>
+
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+TEST(WorkStealingQueueSet, OwnQueueIsLifo) {
+  WorkStealingQueueSet<int> queues(2);
+  queues.Push(0, 1);
+  queues.Push(0, 2);
+  queues.Push(0, 3);
+  EXPECT_EQ(queues.size(), 3);
+  EXPECT_EQ(*queues.Pop(0), 3);
+  EXPECT_EQ(*queues.Pop(0), 2);
+  EXPECT_EQ(*queues.Pop(0), 1);
+  EXPECT_FALSE(queues.Pop(0).has_value());
+  EXPECT_EQ(queues.size(), 0);
+}
+
+TEST(WorkStealingQueueSet, StealIsFifo) {
+  WorkStealingQueueSet<int> queues(3);
+  queues.Push(1, 1);
+  queues.Push(1, 2);
+  queues.Push(1, 3);
+  // Worker 0 has nothing of its own and steals the oldest items of worker 1.
+  EXPECT_EQ(*queues.Pop(0), 1);
+  EXPECT_EQ(*queues.Pop(2), 2);
+  EXPECT_EQ(*queues.Pop(1), 3);
+  EXPECT_FALSE(queues.Pop(1).has_value());
+}
+
+TEST(WorkStealingQueueSet, QueueIdWrapsAround) {
+  WorkStealingQueueSet<int> queues(2);
+  queues.Push(5, 7);
+  EXPECT_EQ(*queues.Pop(1), 7);
+}
+
+TEST(WorkStealingQueueSet, WorkerRegistration) {
+  WorkStealingQueueSet<int> queues(2);
+  EXPECT_TRUE(queues.TryAddWorker(2));
+  EXPECT_TRUE(queues.TryAddWorker(2));
+  EXPECT_FALSE(queues.TryAddWorker(2));
+  EXPECT_EQ(queues.num_workers(), 2);
+
+  // Nothing is queued, so the worker may exit.
+  EXPECT_TRUE(queues.RemoveWorker(2));
+  EXPECT_EQ(queues.num_workers(), 1);
+
+  // An item is pending, so the worker is re-registered to process it.
+  queues.Push(0, 1);
+  EXPECT_FALSE(queues.RemoveWorker(2));
+  EXPECT_EQ(queues.num_workers(), 1);
+  EXPECT_EQ(*queues.Pop(0), 1);
+  EXPECT_TRUE(queues.RemoveWorker(2));
+  EXPECT_EQ(queues.num_workers(), 0);
+}
+
+TEST(WorkStealingQueueSet, ConcurrentProducersAndWorkers) {
+  constexpr int kNumWorkers = 4;
+  constexpr int kNumItems = 10000;
+  WorkStealingQueueSet<int> queues(kNumWorkers);
+  std::atomic<int64_t> sum{0};
+  std::atomic<int> processed{0};
+  {
+    thread::ThreadPool pool(Env::Default(), "test", kNumWorkers + 1);
+    std::function<void(int)> maybe_start_worker;
+    maybe_start_worker = [&](int worker_id) {
+      if (!queues.TryAddWorker(kNumWorkers)) return;
+      pool.Schedule([&, worker_id]() {
+        do {
+          while (absl::optional<int> item = queues.Pop(worker_id)) {
+            sum += *item;
+            ++processed;
+          }
+        } while (!queues.RemoveWorker(kNumWorkers));
+      });
+    };
+    for (int i = 0; i < kNumItems; ++i) {
+      queues.Push(i, i);
+      maybe_start_worker(i);
+    }
+  }
+  EXPECT_EQ(processed, kNumItems);
+  EXPECT_EQ(sum, static_cast<int64_t>(kNumItems) * (kNumItems - 1) / 2);
+  EXPECT_EQ(queues.size(), 0);
+  EXPECT_EQ(queues.num_workers(), 0);
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -0,0 +1,255 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/data/bottleneck_analysis.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/framework/model.h"
+#include "tensorflow/core/platform/mutex.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+constexpr double kNanosPerSecond = 1e9;
+
+// Returns the parameter `name` of `node`, or nullptr if it has none. The
+// tunable parameters come first, as their shared state holds the value set by
+// the autotuning.
+std::shared_ptr<model::Parameter> FindTunableParameter(
+    const model::Node& node, const std::string& name) {
+  for (const auto& pair : node.CollectNodeTunableParameters()) {
+    if (pair.second->name == name) return pair.second;
+  }
+  return nullptr;
+}
+
+// Returns the current value of the parameter `name` of `node`, or
+// `default_value` if it has none.
+double ParameterValueOr(const model::Node& node, const std::string& name,
+                        double default_value) {
+  if (std::shared_ptr<model::Parameter> parameter =
+          FindTunableParameter(node, name)) {
+    double value;
+    if (parameter->state->mu != nullptr) {
+      mutex_lock l(*parameter->state->mu);
+      value = parameter->state->value;
+    } else {
+      value = parameter->state->value;
+    }
+    if (value > 0) return value;
+  }
+  return node.ParameterValue(name).value_or(default_value);
+}
+
+// Adds the synchronous nodes under `node` to `stage_nodes` and the
+// asynchronous ones, which head the next stages, to `heads`.
+void CollectStageNodes(const std::shared_ptr<model::Node>& node,
+                       std::vector<std::shared_ptr<model::Node>>* stage_nodes,
+                       std::vector<std::shared_ptr<model::Node>>* heads) {
+  for (const std::shared_ptr<model::Node>& input : node->inputs()) {
+    if (input->IsAsync()) {
+      heads->push_back(input);
+    } else {
+      stage_nodes->push_back(input);
+      CollectStageNodes(input, stage_nodes, heads);
+    }
+  }
+}
+
+PipelineStage AnalyzeStage(
+    const std::shared_ptr<model::Node>& head,
+    const std::vector<std::shared_ptr<model::Node>>& nodes,
+    int64_t num_output_elements) {
+  PipelineStage stage;
+  stage.name = head->long_name();
+  stage.parallelism = ParameterValueOr(*head, model::kParallelism, 1);
+  // The nodes producing several elements per element of the head, e.g. the
+  // inputs of a batch, spend their per-element time several times.
+  const double num_head_elements = head->num_elements();
+  for (const std::shared_ptr<model::Node>& node : nodes) {
+    if (node->num_elements() == 0) continue;
+    const double time_ns = node->SelfProcessingTime() * node->num_elements() /
+                           num_head_elements;
+    stage.time_per_element_ns += time_ns;
+    stage.node_fractions.push_back({node->long_name(), time_ns});
+  }
+  for (auto& node_fraction : stage.node_fractions) {
+    node_fraction.second = stage.time_per_element_ns > 0
+                               ? node_fraction.second /
+                                     stage.time_per_element_ns
+                               : 0;
+  }
+  std::sort(stage.node_fractions.begin(), stage.node_fractions.end(),
+            [](const auto& a, const auto& b) { return a.second > b.second; });
+  // The ceiling in elements of the head per second, then in elements of the
+  // output of the pipeline.
+  stage.throughput_ceiling =
+      stage.time_per_element_ns > 0
+          ? stage.parallelism * kNanosPerSecond / stage.time_per_element_ns *
+                num_output_elements / num_head_elements
+          : std::numeric_limits<double>::infinity();
+  if (head->IsAsync()) {
+    const double buffer_size =
+        ParameterValueOr(*head, model::kBufferSize, stage.parallelism);
+    stage.buffer_occupancy = head->buffered_elements() / buffer_size;
+  }
+  return stage;
+}
+
+// Suggests the changes lifting the ceiling of the bounding stage to the one of
+// the next stage, or doubling it when it is the only stage.
+void SuggestChanges(const model::Model& model,
+                    const std::vector<std::shared_ptr<model::Node>>& heads,
+                    BottleneckReport* report) {
+  const PipelineStage& bounding = report->bounding_stage();
+  if (std::isinf(bounding.throughput_ceiling)) return;
+  double target = 2 * bounding.throughput_ceiling;
+  if (report->stages.size() > 1 &&
+      !std::isinf(report->stages[1].throughput_ceiling)) {
+    target = report->stages[1].throughput_ceiling;
+  }
+  const std::shared_ptr<model::Node>& head = heads.front();
+  if (head->ParameterValue(model::kParallelism).ok()) {
+    PipelineSuggestion suggestion;
+    suggestion.node = bounding.name;
+    suggestion.parameter = model::kParallelism;
+    suggestion.current_value = bounding.parallelism;
+    suggestion.suggested_value = std::ceil(
+        bounding.parallelism * target / bounding.throughput_ceiling);
+    std::shared_ptr<model::Parameter> parameter =
+        FindTunableParameter(*head, model::kParallelism);
+    suggestion.message =
+        parameter != nullptr && suggestion.suggested_value > parameter->max
+            ? absl::StrCat("The autotuned parallelism can't exceed ",
+                           parameter->max,
+                           ": give the pipeline more CPU cores.")
+            : absl::StrCat("Increase the parallelism to ",
+                           suggestion.suggested_value, ".");
+    report->suggestions.push_back(std::move(suggestion));
+  } else if (head == model.output() && !head->IsAsync()) {
+    PipelineSuggestion suggestion;
+    suggestion.node = bounding.name;
+    suggestion.message =
+        "The consumer of the iterator computes the bounding stage: prefetch "
+        "the output of the pipeline to compute it in the background.";
+    report->suggestions.push_back(std::move(suggestion));
+  } else if (!bounding.node_fractions.empty()) {
+    PipelineSuggestion suggestion;
+    suggestion.node = bounding.node_fractions.front().first;
+    suggestion.message =
+        absl::StrCat("The single thread of ", bounding.name,
+                     " runs this node: make it parallel, e.g. with "
+                     "num_parallel_calls.");
+    report->suggestions.push_back(std::move(suggestion));
+  }
+  // The buffers which ran empty while their stage keeps up with the bounding
+  // one absorb the variations of the processing times if they are larger.
+  for (int i = 1; i < heads.size(); ++i) {
+    const std::shared_ptr<model::Node>& node = heads[i];
+    if (!node->IsAsync() ||
+        node->buffered_elements_low() > node->buffered_elements_high() ||
+        node->buffered_elements_low() > 0) {
+      continue;
+    }
+    absl::StatusOr<double> buffer_size =
+        node->ParameterValue(model::kBufferSize);
+    if (!buffer_size.ok()) continue;
+    const double current_value =
+        ParameterValueOr(*node, model::kBufferSize, *buffer_size);
+    PipelineSuggestion suggestion;
+    suggestion.node = node->long_name();
+    suggestion.parameter = model::kBufferSize;
+    suggestion.current_value = current_value;
+    suggestion.suggested_value = 2 * current_value;
+    suggestion.message = absl::StrCat(
+        "The buffer ran empty: increase its size to ",
+        suggestion.suggested_value, ".");
+    report->suggestions.push_back(std::move(suggestion));
+  }
+}
+
+}  // namespace
+
+std::string BottleneckReport::DebugString() const {
+  std::string result;
+  for (const PipelineStage& stage : stages) {
+    absl::StrAppend(&result, stage.name, ": ceiling ", stage.throughput_ceiling,
+                    " elements/s, parallelism ", stage.parallelism, ", ",
+                    stage.time_per_element_ns, " ns per element");
+    if (stage.buffer_occupancy >= 0) {
+      absl::StrAppend(&result, ", buffer occupancy ", stage.buffer_occupancy);
+    }
+    absl::StrAppend(&result, "\n");
+    for (const auto& node_fraction : stage.node_fractions) {
+      absl::StrAppend(&result, "  ", node_fraction.first, ": ",
+                      node_fraction.second, "\n");
+    }
+  }
+  for (const PipelineSuggestion& suggestion : suggestions) {
+    absl::StrAppend(&result, suggestion.node, ": ", suggestion.message, "\n");
+  }
+  return result;
+}
+
+absl::StatusOr<BottleneckReport> AnalyzeBottleneck(const model::Model& model) {
+  std::shared_ptr<model::Node> output = model.output();
+  if (output == nullptr || output->num_elements() == 0) {
+    return absl::FailedPreconditionError(
+        "The pipeline hasn't produced an element yet.");
+  }
+  BottleneckReport report;
+  std::vector<std::shared_ptr<model::Node>> heads = {output};
+  std::vector<std::shared_ptr<model::Node>> stage_heads;
+  for (int i = 0; i < heads.size(); ++i) {
+    std::shared_ptr<model::Node> head = heads[i];
+    if (head->num_elements() == 0) continue;
+    std::vector<std::shared_ptr<model::Node>> nodes = {head};
+    CollectStageNodes(head, &nodes, &heads);
+    report.stages.push_back(
+        AnalyzeStage(head, nodes, output->num_elements()));
+    stage_heads.push_back(head);
+  }
+  // Sorts the stages and their heads together.
+  std::vector<int> order(report.stages.size());
+  for (int i = 0; i < order.size(); ++i) order[i] = i;
+  std::stable_sort(order.begin(), order.end(), [&](int a, int b) {
+    return report.stages[a].throughput_ceiling <
+           report.stages[b].throughput_ceiling;
+  });
+  std::vector<PipelineStage> stages;
+  std::vector<std::shared_ptr<model::Node>> sorted_heads;
+  for (int i : order) {
+    stages.push_back(std::move(report.stages[i]));
+    sorted_heads.push_back(stage_heads[i]);
+  }
+  report.stages = std::move(stages);
+  SuggestChanges(model, sorted_heads, &report);
+  return report;
+}
+
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,82 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_DATA_BOTTLENECK_ANALYSIS_H_
+#define TENSORFLOW_CORE_DATA_BOTTLENECK_ANALYSIS_H_
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/status/statusor.h"
+#include "tensorflow/core/framework/model.h"
+
+namespace tensorflow {
+namespace data {
+
+// The nodes of the model computed by the same threads: an asynchronous node,
+// or the output node run by the consumer of the iterator, and the synchronous
+// nodes under it, which are run by the threads of the asynchronous node.
+struct PipelineStage {
+  // The long name of the node heading the stage.
+  std::string name;
+  // The number of threads of the stage, from its `parallelism` parameter.
+  double parallelism = 1;
+  // The processing time of the stage per element of its head, in nanoseconds.
+  double time_per_element_ns = 0;
+  // The elements per second the output of the pipeline can't exceed because
+  // of this stage, or infinity if the stage hasn't recorded processing time.
+  double throughput_ceiling = 0;
+  // The number of elements buffered by the head over its buffer size, or -1
+  // if the head has no buffer.
+  double buffer_occupancy = -1;
+  // The long names of the nodes of the stage with the fraction of the time of
+  // the stage they take, in decreasing order of fraction.
+  std::vector<std::pair<std::string, double>> node_fractions;
+};
+
+// A change of the pipeline which raises its throughput.
+struct PipelineSuggestion {
+  // The long name of the node to change.
+  std::string node;
+  // The parameter of the node to change, if any.
+  std::string parameter;
+  double current_value = 0;
+  double suggested_value = 0;
+  std::string message;
+};
+
+struct BottleneckReport {
+  // The stages of the pipeline, in increasing order of throughput ceiling:
+  // the first one sets the throughput of the pipeline.
+  std::vector<PipelineStage> stages;
+  std::vector<PipelineSuggestion> suggestions;
+
+  const PipelineStage& bounding_stage() const { return stages.front(); }
+
+  std::string DebugString() const;
+};
+
+// Analyzes the live `model` of an iterator: computes the throughput ceiling
+// of each of its stages from the processing times and parallelism its nodes
+// recorded, and suggests the parallelism and buffer size changes lifting the
+// bounding one. Returns FailedPrecondition if the pipeline hasn't produced an
+// element yet.
+absl::StatusOr<BottleneckReport> AnalyzeBottleneck(const model::Model& model);
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_BOTTLENECK_ANALYSIS_H_
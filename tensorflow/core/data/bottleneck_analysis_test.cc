@@ -0,0 +1,144 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/data/bottleneck_analysis.h"
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+#include "tensorflow/core/framework/model.h"
+#include "tensorflow/core/platform/test.h"
+#include "tsl/platform/status_matchers.h"
+#include "tsl/platform/statusor.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+using ::testing::DoubleNear;
+using ::testing::ElementsAre;
+using ::testing::Pair;
+using ::tsl::testing::StatusIs;
+
+// Records `num_elements` produced by `node` in `time_per_element_ns` each.
+void RecordElements(model::Node* node, int num_elements,
+                    int64_t time_per_element_ns) {
+  for (int i = 0; i < num_elements; ++i) {
+    node->add_processing_time(time_per_element_ns);
+    node->record_element();
+  }
+}
+
+class BottleneckAnalysisTest : public ::testing::Test {
+ protected:
+  // Builds Map <- Prefetch <- ParallelMap <- Source, the parallel map having a
+  // parallelism of 2.
+  void SetUp() override {
+    model_.AddNode(
+        [](model::Node::Args args) {
+          return model::MakeKnownRatioNode(std::move(args), /*ratio=*/1);
+        },
+        "Map", nullptr, &map_);
+    model_.AddNode(
+        [](model::Node::Args args) {
+          return model::MakeAsyncKnownRatioNode(
+              std::move(args), /*ratio=*/1,
+              {model::MakeParameter(
+                  model::kBufferSize,
+                  std::make_shared<model::SharedState>(2, nullptr, nullptr),
+                  /*min=*/1, /*max=*/8)});
+        },
+        "Prefetch", map_, &prefetch_);
+    model_.AddNode(
+        [](model::Node::Args args) {
+          return model::MakeAsyncKnownRatioNode(
+              std::move(args), /*ratio=*/1,
+              {model::MakeParameter(
+                  model::kParallelism,
+                  std::make_shared<model::SharedState>(2, nullptr, nullptr),
+                  /*min=*/1, /*max=*/8)});
+        },
+        "ParallelMap", prefetch_, &parallel_map_);
+    model_.AddNode(
+        [](model::Node::Args args) {
+          return model::MakeSourceNode(std::move(args));
+        },
+        "Source", parallel_map_, &source_);
+  }
+
+  model::Model model_;
+  std::shared_ptr<model::Node> map_;
+  std::shared_ptr<model::Node> prefetch_;
+  std::shared_ptr<model::Node> parallel_map_;
+  std::shared_ptr<model::Node> source_;
+};
+
+TEST_F(BottleneckAnalysisTest, FailsWithoutElements) {
+  EXPECT_THAT(AnalyzeBottleneck(model_),
+              StatusIs(absl::StatusCode::kFailedPrecondition));
+}
+
+TEST_F(BottleneckAnalysisTest, FindsTheBoundingStage) {
+  RecordElements(map_.get(), 10, /*time_per_element_ns=*/100);
+  RecordElements(prefetch_.get(), 10, /*time_per_element_ns=*/10);
+  RecordElements(parallel_map_.get(), 10, /*time_per_element_ns=*/2000);
+  RecordElements(source_.get(), 10, /*time_per_element_ns=*/500);
+  // The buffer of the prefetch ran empty.
+  prefetch_->record_buffer_event(/*bytes_delta=*/8, /*elements_delta=*/1);
+  prefetch_->record_buffer_event(/*bytes_delta=*/-8, /*elements_delta=*/-1);
+
+  TF_ASSERT_OK_AND_ASSIGN(BottleneckReport report, AnalyzeBottleneck(model_));
+  ASSERT_EQ(report.stages.size(), 3);
+  const PipelineStage& bounding = report.bounding_stage();
+  EXPECT_EQ(bounding.name, parallel_map_->long_name());
+  EXPECT_EQ(bounding.parallelism, 2);
+  EXPECT_EQ(bounding.time_per_element_ns, 2500);
+  EXPECT_EQ(bounding.throughput_ceiling, 2e9 / 2500);
+  EXPECT_THAT(
+      bounding.node_fractions,
+      ElementsAre(Pair(parallel_map_->long_name(), DoubleNear(0.8, 1e-9)),
+                  Pair(source_->long_name(), DoubleNear(0.2, 1e-9))));
+  EXPECT_EQ(report.stages[1].name, map_->long_name());
+  EXPECT_EQ(report.stages[1].buffer_occupancy, -1);
+  EXPECT_EQ(report.stages[2].name, prefetch_->long_name());
+  EXPECT_EQ(report.stages[2].buffer_occupancy, 0);
+
+  ASSERT_EQ(report.suggestions.size(), 2);
+  // The parallel map reaches the ceiling of the map with 25 threads.
+  EXPECT_EQ(report.suggestions[0].node, parallel_map_->long_name());
+  EXPECT_EQ(report.suggestions[0].parameter, model::kParallelism);
+  EXPECT_EQ(report.suggestions[0].current_value, 2);
+  EXPECT_EQ(report.suggestions[0].suggested_value, 25);
+  EXPECT_EQ(report.suggestions[1].node, prefetch_->long_name());
+  EXPECT_EQ(report.suggestions[1].parameter, model::kBufferSize);
+  EXPECT_EQ(report.suggestions[1].suggested_value, 4);
+}
+
+TEST_F(BottleneckAnalysisTest, SuggestsPrefetchingTheConsumerStage) {
+  RecordElements(map_.get(), 10, /*time_per_element_ns=*/10000);
+  RecordElements(prefetch_.get(), 10, /*time_per_element_ns=*/10);
+  RecordElements(parallel_map_.get(), 10, /*time_per_element_ns=*/10);
+
+  TF_ASSERT_OK_AND_ASSIGN(BottleneckReport report, AnalyzeBottleneck(model_));
+  EXPECT_EQ(report.bounding_stage().name, map_->long_name());
+  ASSERT_FALSE(report.suggestions.empty());
+  EXPECT_EQ(report.suggestions[0].node, map_->long_name());
+  EXPECT_TRUE(report.suggestions[0].parameter.empty());
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
@@ -14,18 +14,24 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/data/compression_utils.h"
 
+#include <cstdint>
 #include <limits>
+#include <memory>
 #include <string>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
 #include "tensorflow/core/common_runtime/dma_helper.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/framework/variant_op_registry.h"
+#include "tensorflow/core/platform/coding.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/snappy.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 namespace data {
@@ -36,6 +42,22 @@ namespace {
 // version.
 constexpr int kCompressedElementVersion = 0;
 
+// The version of elements compressed with `CompressionCodec::kColumnar`, whose
+// components are compressed separately.
+constexpr int kColumnarCompressedElementVersion = 1;
+
+// Integer tensors are delta encoded if that shrinks them by at least this
+// factor.
+constexpr int64_t kMinDeltaVarintRatio = 2;
+
+// String tensors are dictionary encoded if each of their values is repeated at
+// least this many times on average.
+constexpr int64_t kMinDictionaryRepeats = 2;
+
+// Estimated cost, in cycles, of uncompressing a compressed byte. Used to
+// decide how many threads to uncompress the components of an element on.
+constexpr int64_t kUncompressCostPerByte = 10;
+
 }  // namespace
 
 class Iov {
@@ -61,8 +83,10 @@ class Iov {
   size_t num_bytes_;
 };
 
-Status CompressElement(const std::vector<Tensor>& element,
-                       CompressedElement* out) {
+namespace {
+
+Status CompressElementSnappy(const std::vector<Tensor>& element,
+                             CompressedElement* out) {
   // First pass: preprocess the non`memcpy`able tensors.
   size_t num_string_tensors = 0;
   size_t num_string_tensor_strings = 0;
@@ -135,12 +159,8 @@ Status CompressElement(const std::vector<Tensor>& element,
   return absl::OkStatus();
 }
 
-Status UncompressElement(const CompressedElement& compressed,
-                         std::vector<Tensor>* out) {
-  if (compressed.version() != kCompressedElementVersion) {
-    return errors::Internal("Unsupported compressed element version: ",
-                            compressed.version());
-  }
+Status UncompressElementSnappy(const CompressedElement& compressed,
+                               std::vector<Tensor>* out) {
   int num_components = compressed.component_metadata_size();
   out->clear();
   out->reserve(num_components);
@@ -231,6 +251,490 @@ Status UncompressElement(const CompressedElement& compressed,
   return absl::OkStatus();
 }
 
+// Groups the bytes of the `n` `Width`-byte values at `src` by significance:
+// `dst` holds the first byte of every value, then the second byte, etc. The
+// width is a template parameter so that the loops vectorize.
+template <int Width>
+void ShuffleBytes(const char* src, int64_t n, char* dst) {
+  for (int b = 0; b < Width; ++b) {
+    char* plane = dst + b * n;
+    for (int64_t i = 0; i < n; ++i) {
+      plane[i] = src[i * Width + b];
+    }
+  }
+}
+
+// Inverts `ShuffleBytes`.
+template <int Width>
+void UnshuffleBytes(const char* src, int64_t n, char* dst) {
+  for (int64_t i = 0; i < n; ++i) {
+    for (int b = 0; b < Width; ++b) {
+      dst[i * Width + b] = src[b * n + i];
+    }
+  }
+}
+
+void ShuffleBytes(const char* src, int64_t n, int width, char* dst) {
+  switch (width) {
+    case 2:
+      return ShuffleBytes<2>(src, n, dst);
+    case 4:
+      return ShuffleBytes<4>(src, n, dst);
+    case 8:
+      return ShuffleBytes<8>(src, n, dst);
+    case 16:
+      return ShuffleBytes<16>(src, n, dst);
+  }
+  for (int b = 0; b < width; ++b) {
+    for (int64_t i = 0; i < n; ++i) {
+      dst[b * n + i] = src[i * width + b];
+    }
+  }
+}
+
+void UnshuffleBytes(const char* src, int64_t n, int width, char* dst) {
+  switch (width) {
+    case 2:
+      return UnshuffleBytes<2>(src, n, dst);
+    case 4:
+      return UnshuffleBytes<4>(src, n, dst);
+    case 8:
+      return UnshuffleBytes<8>(src, n, dst);
+    case 16:
+      return UnshuffleBytes<16>(src, n, dst);
+  }
+  for (int64_t i = 0; i < n; ++i) {
+    for (int b = 0; b < width; ++b) {
+      dst[i * width + b] = src[b * n + i];
+    }
+  }
+}
+
+// Encodes the values of `tensor` as zigzag varints of the differences between
+// consecutive values. Returns false if the encoding exceeds `max_bytes`.
+template <typename T>
+bool DeltaVarintEncode(const Tensor& tensor, size_t max_bytes,
+                       std::string* out) {
+  const auto values = tensor.flat<T>();
+  out->resize(max_bytes + core::kMaxVarint64Bytes);
+  char* pos = out->data();
+  const char* limit = pos + max_bytes;
+  uint64_t previous = 0;
+  for (int64_t i = 0; i < values.size(); ++i) {
+    if (pos > limit) {
+      return false;
+    }
+    // Wraps around on overflow, which decoding undoes.
+    const uint64_t value = static_cast<uint64_t>(int64_t{values(i)});
+    const int64_t delta = static_cast<int64_t>(value - previous);
+    pos = core::EncodeVarint64(pos, (static_cast<uint64_t>(delta) << 1) ^
+                                        static_cast<uint64_t>(delta >> 63));
+    previous = value;
+  }
+  if (pos > limit) {
+    return false;
+  }
+  out->resize(pos - out->data());
+  return true;
+}
+
+template <typename T>
+Status DeltaVarintDecode(absl::string_view data, Tensor* tensor) {
+  auto values = tensor->flat<T>();
+  const char* pos = data.data();
+  const char* limit = pos + data.size();
+  uint64_t previous = 0;
+  for (int64_t i = 0; i < values.size(); ++i) {
+    uint64_t zigzag;
+    pos = core::GetVarint64Ptr(pos, limit, &zigzag);
+    if (pos == nullptr) {
+      return errors::Internal("Delta-encoded component is truncated.");
+    }
+    previous += (zigzag >> 1) ^ (0 - (zigzag & 1));
+    values(i) = static_cast<T>(static_cast<int64_t>(previous));
+  }
+  if (pos != limit) {
+    return errors::Internal("Delta-encoded component has ", limit - pos,
+                            " trailing bytes.");
+  }
+  return absl::OkStatus();
+}
+
+// Encodes the values of the string tensor `tensor` as the number of distinct
+// values, the length-prefixed distinct values, and the index of each value in
+// the distinct values, all as varints. Returns false if the values are repeated
+// less than `kMinDictionaryRepeats` times on average.
+bool DictionaryEncode(const Tensor& tensor, std::string* out) {
+  const auto values = tensor.flat<tstring>();
+  const int64_t max_entries = values.size() / kMinDictionaryRepeats;
+  absl::flat_hash_map<absl::string_view, uint64_t> ids;
+  std::vector<absl::string_view> dictionary;
+  std::string indices;
+  for (int64_t i = 0; i < values.size(); ++i) {
+    auto [it, inserted] = ids.try_emplace(
+        absl::string_view(values(i).data(), values(i).size()),
+        dictionary.size());
+    if (inserted) {
+      if (dictionary.size() == max_entries) {
+        return false;
+      }
+      dictionary.push_back(it->first);
+    }
+    core::PutVarint64(&indices, it->second);
+  }
+  core::PutVarint64(out, dictionary.size());
+  for (absl::string_view entry : dictionary) {
+    core::PutVarint64(out, entry.size());
+    out->append(entry.data(), entry.size());
+  }
+  out->append(indices);
+  return true;
+}
+
+Status DictionaryDecode(absl::string_view data, Tensor* tensor) {
+  const Status corrupted =
+      errors::Internal("Dictionary-encoded component is corrupted.");
+  uint64_t num_entries;
+  if (!core::GetVarint64(&data, &num_entries) || num_entries > data.size()) {
+    return corrupted;
+  }
+  std::vector<absl::string_view> dictionary;
+  dictionary.reserve(num_entries);
+  for (uint64_t i = 0; i < num_entries; ++i) {
+    uint64_t size;
+    if (!core::GetVarint64(&data, &size) || size > data.size()) {
+      return corrupted;
+    }
+    dictionary.push_back(data.substr(0, size));
+    data.remove_prefix(size);
+  }
+  auto values = tensor->flat<tstring>();
+  for (int64_t i = 0; i < values.size(); ++i) {
+    uint64_t id;
+    if (!core::GetVarint64(&data, &id) || id >= dictionary.size()) {
+      return corrupted;
+    }
+    values(i).assign(dictionary[id].data(), dictionary[id].size());
+  }
+  if (!data.empty()) {
+    return corrupted;
+  }
+  return absl::OkStatus();
+}
+
+Status SnappyCompress(const char* data, size_t size, std::string* out) {
+  if (size > kuint32max) {
+    return errors::OutOfRange("Encountered dataset element component of size ",
+                              size, ", exceeding the 4GB Snappy limit.");
+  }
+  if (!port::Snappy_Compress(data, size, out)) {
+    return errors::Internal("Failed to compress using snappy.");
+  }
+  return absl::OkStatus();
+}
+
+Status SnappyUncompress(absl::string_view data, char* out, size_t size) {
+  size_t uncompressed_size;
+  if (!port::Snappy_GetUncompressedLength(data.data(), data.size(),
+                                          &uncompressed_size)) {
+    return errors::Internal(
+        "Could not get snappy uncompressed length. Compressed data size: ",
+        data.size());
+  }
+  if (uncompressed_size != size) {
+    return errors::Internal("Uncompressed size mismatch. Snappy expects ",
+                            uncompressed_size,
+                            " whereas the tensor metadata suggests ", size);
+  }
+  if (!port::Snappy_Uncompress(data.data(), data.size(), out)) {
+    return errors::Internal("Failed to perform snappy decompression.");
+  }
+  return absl::OkStatus();
+}
+
+Status CompressStringComponent(const Tensor& component,
+                               CompressedComponentMetadata* metadata,
+                               std::string* out) {
+  std::string stream;
+  if (component.NumElements() >= kMinDictionaryRepeats &&
+      DictionaryEncode(component, &stream)) {
+    metadata->set_codec(CompressedComponentMetadata::CODEC_DICTIONARY);
+    metadata->add_uncompressed_bytes(stream.size());
+    return SnappyCompress(stream.data(), stream.size(), out);
+  }
+  metadata->set_codec(CompressedComponentMetadata::CODEC_SNAPPY);
+  const auto values = component.flat<tstring>();
+  Iov iov(values.size());
+  for (int64_t i = 0; i < values.size(); ++i) {
+    iov.Add(const_cast<char*>(values(i).data()), values(i).size());
+    metadata->add_uncompressed_bytes(values(i).size());
+  }
+  if (iov.NumBytes() > kuint32max) {
+    return errors::OutOfRange("Encountered dataset element component of size ",
+                              iov.NumBytes(),
+                              ", exceeding the 4GB Snappy limit.");
+  }
+  if (!port::Snappy_CompressFromIOVec(iov.Data(), iov.NumBytes(), out)) {
+    return errors::Internal("Failed to compress using snappy.");
+  }
+  return absl::OkStatus();
+}
+
+Status CompressComponent(const Tensor& component,
+                         CompressedComponentMetadata* metadata,
+                         std::string* out) {
+  metadata->set_dtype(component.dtype());
+  component.shape().AsProto(metadata->mutable_tensor_shape());
+  if (component.dtype() == DT_STRING) {
+    return CompressStringComponent(component, metadata, out);
+  }
+  metadata->set_codec(CompressedComponentMetadata::CODEC_SNAPPY);
+  if (!DataTypeCanUseMemcpy(component.dtype())) {
+    TensorProto proto;
+    component.AsProtoTensorContent(&proto);
+    const std::string serialized = proto.SerializeAsString();
+    metadata->add_uncompressed_bytes(serialized.size());
+    return SnappyCompress(serialized.data(), serialized.size(), out);
+  }
+  const TensorBuffer* buffer = DMAHelper::buffer(&component);
+  const size_t size = buffer ? buffer->size() : 0;
+  metadata->add_uncompressed_bytes(size);
+  if (size == 0) {
+    return absl::OkStatus();
+  }
+  const char* data = static_cast<const char*>(buffer->data());
+  if (component.dtype() == DT_INT64 || component.dtype() == DT_INT32) {
+    const size_t max_bytes = size / kMinDeltaVarintRatio;
+    const bool encoded =
+        component.dtype() == DT_INT64
+            ? DeltaVarintEncode<int64_t>(component, max_bytes, out)
+            : DeltaVarintEncode<int32_t>(component, max_bytes, out);
+    if (encoded) {
+      metadata->set_codec(CompressedComponentMetadata::CODEC_DELTA_VARINT);
+      return absl::OkStatus();
+    }
+  }
+  const int width = DataTypeSize(component.dtype());
+  if (width > 1 && size / width > 1) {
+    std::unique_ptr<char[]> shuffled(new char[size]);
+    ShuffleBytes(data, size / width, width, shuffled.get());
+    metadata->set_codec(CompressedComponentMetadata::CODEC_SHUFFLE_SNAPPY);
+    return SnappyCompress(shuffled.get(), size, out);
+  }
+  return SnappyCompress(data, size, out);
+}
+
+// Uncompresses `data` into `out`, which for string and `memcpy`able dtypes
+// has already been allocated with the dtype and shape in `metadata`.
+Status UncompressComponent(const CompressedComponentMetadata& metadata,
+                           absl::string_view data, Tensor* out) {
+  if (metadata.dtype() == DT_STRING &&
+      metadata.codec() == CompressedComponentMetadata::CODEC_SNAPPY) {
+    auto values = out->flat<tstring>();
+    if (metadata.uncompressed_bytes_size() != values.size()) {
+      return errors::Internal("Expected ", values.size(),
+                              " string sizes, but got ",
+                              metadata.uncompressed_bytes_size());
+    }
+    Iov iov(values.size());
+    for (int64_t i = 0; i < values.size(); ++i) {
+      values(i).resize_uninitialized(metadata.uncompressed_bytes(i));
+      iov.Add(values(i).mdata(), metadata.uncompressed_bytes(i));
+    }
+    size_t uncompressed_size;
+    if (!port::Snappy_GetUncompressedLength(data.data(), data.size(),
+                                            &uncompressed_size) ||
+        uncompressed_size != iov.NumBytes()) {
+      return errors::Internal("Uncompressed size mismatch. The tensor metadata "
+                              "suggests ",
+                              iov.NumBytes(), " bytes.");
+    }
+    if (!port::Snappy_UncompressToIOVec(data.data(), data.size(), iov.Data(),
+                                        iov.NumPieces())) {
+      return errors::Internal("Failed to perform snappy decompression.");
+    }
+    return absl::OkStatus();
+  }
+
+  if (metadata.uncompressed_bytes_size() != 1) {
+    return errors::Internal("Expected a single uncompressed size, but got ",
+                            metadata.uncompressed_bytes_size());
+  }
+  const size_t uncompressed_bytes = metadata.uncompressed_bytes(0);
+  if (metadata.codec() == CompressedComponentMetadata::CODEC_DICTIONARY) {
+    if (metadata.dtype() != DT_STRING) {
+      return errors::Internal("Dictionary-encoded component has dtype ",
+                              DataTypeString(metadata.dtype()));
+    }
+    std::string stream(uncompressed_bytes, '\0');
+    TF_RETURN_IF_ERROR(
+        SnappyUncompress(data, stream.data(), uncompressed_bytes));
+    return DictionaryDecode(stream, out);
+  }
+  if (!DataTypeCanUseMemcpy(metadata.dtype())) {
+    if (metadata.codec() != CompressedComponentMetadata::CODEC_SNAPPY) {
+      return errors::Internal("Unsupported codec ", metadata.codec(),
+                              " for dtype ", DataTypeString(metadata.dtype()));
+    }
+    tstring serialized;
+    serialized.resize_uninitialized(uncompressed_bytes);
+    TF_RETURN_IF_ERROR(
+        SnappyUncompress(data, serialized.mdata(), uncompressed_bytes));
+    TensorProto proto;
+    if (!proto.ParseFromArray(serialized.data(), serialized.size())) {
+      return errors::Internal("Could not parse TensorProto");
+    }
+    if (!out->FromProto(proto)) {
+      return errors::Internal("Could not parse Tensor");
+    }
+    return absl::OkStatus();
+  }
+
+  TensorBuffer* buffer = DMAHelper::buffer(out);
+  const size_t size = buffer ? buffer->size() : 0;
+  if (size != uncompressed_bytes) {
+    return errors::Internal("Uncompressed size mismatch. The tensor shape "
+                            "suggests ",
+                            size, " bytes whereas the metadata suggests ",
+                            uncompressed_bytes);
+  }
+  if (size == 0) {
+    return absl::OkStatus();
+  }
+  char* tensor_data = static_cast<char*>(buffer->data());
+  switch (metadata.codec()) {
+    case CompressedComponentMetadata::CODEC_SNAPPY:
+      return SnappyUncompress(data, tensor_data, size);
+    case CompressedComponentMetadata::CODEC_SHUFFLE_SNAPPY: {
+      const int width = DataTypeSize(metadata.dtype());
+      if (width == 0) {
+        return errors::Internal("Can not unshuffle dtype ",
+                                DataTypeString(metadata.dtype()));
+      }
+      std::unique_ptr<char[]> shuffled(new char[size]);
+      TF_RETURN_IF_ERROR(SnappyUncompress(data, shuffled.get(), size));
+      UnshuffleBytes(shuffled.get(), size / width, width, tensor_data);
+      return absl::OkStatus();
+    }
+    case CompressedComponentMetadata::CODEC_DELTA_VARINT:
+      if (metadata.dtype() == DT_INT64) {
+        return DeltaVarintDecode<int64_t>(data, out);
+      }
+      if (metadata.dtype() == DT_INT32) {
+        return DeltaVarintDecode<int32_t>(data, out);
+      }
+      break;
+    default:
+      break;
+  }
+  return errors::Internal("Unsupported codec ", metadata.codec(),
+                          " for dtype ", DataTypeString(metadata.dtype()));
+}
+
+Status CompressElementColumnar(const std::vector<Tensor>& element,
+                               CompressedElement* out) {
+  std::string* data = out->mutable_data();
+  std::string component_data;
+  for (const Tensor& component : element) {
+    CompressedComponentMetadata* metadata = out->add_component_metadata();
+    component_data.clear();
+    TF_RETURN_IF_ERROR(CompressComponent(component, metadata, &component_data));
+    metadata->set_compressed_bytes(component_data.size());
+    data->append(component_data);
+  }
+  out->set_version(kColumnarCompressedElementVersion);
+  VLOG(3) << "Compressed element with " << element.size()
+          << " components to " << data->size() << " bytes";
+  return absl::OkStatus();
+}
+
+Status UncompressElementColumnar(const CompressedElement& compressed,
+                                 std::vector<Tensor>* out,
+                                 thread::ThreadPool* thread_pool) {
+  const int num_components = compressed.component_metadata_size();
+  out->clear();
+  out->reserve(num_components);
+  std::vector<absl::string_view> component_data;
+  component_data.reserve(num_components);
+  absl::string_view data = compressed.data();
+  for (const auto& metadata : compressed.component_metadata()) {
+    if (metadata.compressed_bytes() > data.size()) {
+      return errors::Internal("Compressed element is truncated: component ",
+                              component_data.size(), " expects ",
+                              metadata.compressed_bytes(), " bytes, but only ",
+                              data.size(), " remain.");
+    }
+    component_data.push_back(data.substr(0, metadata.compressed_bytes()));
+    data.remove_prefix(metadata.compressed_bytes());
+    if (metadata.dtype() == DT_STRING ||
+        DataTypeCanUseMemcpy(metadata.dtype())) {
+      out->emplace_back(metadata.dtype(), metadata.tensor_shape());
+    } else {
+      out->emplace_back();
+    }
+  }
+  if (!data.empty()) {
+    return errors::Internal("Compressed element has ", data.size(),
+                            " trailing bytes.");
+  }
+
+  std::vector<Status> statuses(num_components);
+  auto uncompress = [&](int64_t start, int64_t limit) {
+    for (int64_t i = start; i < limit; ++i) {
+      statuses[i] = UncompressComponent(compressed.component_metadata(i),
+                                        component_data[i], &(*out)[i]);
+    }
+  };
+  if (thread_pool == nullptr || num_components < 2) {
+    uncompress(0, num_components);
+  } else {
+    Shard(thread_pool->NumThreads(), thread_pool, num_components,
+          compressed.data().size() / num_components * kUncompressCostPerByte,
+          uncompress);
+  }
+  for (const Status& status : statuses) {
+    TF_RETURN_IF_ERROR(status);
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace
+
+Status CompressElement(const std::vector<Tensor>& element,
+                       CompressedElement* out) {
+  return CompressElement(element, CompressionCodec::kSnappy, out);
+}
+
+Status CompressElement(const std::vector<Tensor>& element,
+                       CompressionCodec codec, CompressedElement* out) {
+  switch (codec) {
+    case CompressionCodec::kSnappy:
+      return CompressElementSnappy(element, out);
+    case CompressionCodec::kColumnar:
+      return CompressElementColumnar(element, out);
+  }
+  return errors::InvalidArgument("Unknown compression codec ",
+                                 static_cast<int>(codec));
+}
+
+Status UncompressElement(const CompressedElement& compressed,
+                         std::vector<Tensor>* out) {
+  return UncompressElement(compressed, out, /*thread_pool=*/nullptr);
+}
+
+Status UncompressElement(const CompressedElement& compressed,
+                         std::vector<Tensor>* out,
+                         thread::ThreadPool* thread_pool) {
+  switch (compressed.version()) {
+    case kCompressedElementVersion:
+      return UncompressElementSnappy(compressed, out);
+    case kColumnarCompressedElementVersion:
+      return UncompressElementColumnar(compressed, out, thread_pool);
+  }
+  return errors::Internal("Unsupported compressed element version: ",
+                          compressed.version());
+}
+
 REGISTER_UNARY_VARIANT_DECODE_FUNCTION(CompressedElement,
                                        "tensorflow.data.CompressedElement");
 
@@ -20,22 +20,48 @@ limitations under the License.
 #include "tensorflow/core/framework/dataset.pb.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/threadpool.h"
 
 namespace tensorflow {
 namespace data {
 
+// How `CompressElement` encodes the components of an element.
+enum class CompressionCodec {
+  // A single Snappy stream over the bytes of all components.
+  kSnappy,
+  // Each component is compressed separately, with a codec chosen from its
+  // dtype and contents:
+  // - floating point and other multi-byte tensors are byte-shuffled, so that
+  //   bytes of the same significance are adjacent, then Snappy-compressed;
+  // - int32 and int64 tensors whose consecutive values are close, such as
+  //   sorted ids, are encoded as zigzag varints of their differences;
+  // - string tensors with repeated values are dictionary encoded;
+  // - all other tensors are Snappy-compressed.
+  // Components can then be uncompressed in parallel.
+  kColumnar,
+};
+
 // Compresses the components of `element` into the `CompressedElement` proto.
 //
 // In addition to writing the actual compressed bytes, `Compress` fills
 // out the per-component metadata for the `CompressedElement`.
 //
-// Returns an error if the uncompressed size of the element exceeds 4GB.
+// Returns an error if the uncompressed size of the element exceeds 4GB, or,
+// for `CompressionCodec::kColumnar`, if the size of a component does.
 Status CompressElement(const std::vector<Tensor>& element,
                        CompressedElement* out);
+Status CompressElement(const std::vector<Tensor>& element,
+                       CompressionCodec codec, CompressedElement* out);
 
 // Uncompresses a `CompressedElement` into a vector of tensor components.
+//
+// If `thread_pool` is not null, the components of elements compressed with
+// `CompressionCodec::kColumnar` are uncompressed in parallel on it.
 Status UncompressElement(const CompressedElement& compressed,
                          std::vector<Tensor>* out);
+Status UncompressElement(const CompressedElement& compressed,
+                         std::vector<Tensor>* out,
+                         thread::ThreadPool* thread_pool);
 
 }  // namespace data
 }  // namespace tensorflow
@@ -14,12 +14,17 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/data/compression_utils.h"
 
+#include <cstdint>
+#include <limits>
 #include <string>
 #include <vector>
 
+#include "absl/strings/str_cat.h"
 #include "tensorflow/core/data/dataset_test_base.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/threadpool.h"
 #include "tensorflow/core/protobuf/error_codes.pb.h"
 #include "tsl/platform/status_matchers.h"
 
@@ -98,15 +103,126 @@ TEST_P(ParameterizedCompressionUtilsTest, VersionMismatch) {
   CompressedElement compressed;
   TF_ASSERT_OK(CompressElement(element, &compressed));
 
-  compressed.set_version(1);
+  compressed.set_version(2);
   std::vector<Tensor> round_trip_element;
   EXPECT_THAT(UncompressElement(compressed, &round_trip_element),
               StatusIs(error::INTERNAL));
 }
 
+TEST_P(ParameterizedCompressionUtilsTest, ColumnarRoundTrip) {
+  std::vector<Tensor> element = GetParam();
+  CompressedElement compressed;
+  TF_ASSERT_OK(
+      CompressElement(element, CompressionCodec::kColumnar, &compressed));
+  EXPECT_EQ(1, compressed.version());
+  std::vector<Tensor> round_trip_element;
+  TF_ASSERT_OK(UncompressElement(compressed, &round_trip_element));
+  TF_EXPECT_OK(
+      ExpectEqual(element, round_trip_element, /*compare_order=*/true));
+
+  thread::ThreadPool thread_pool(Env::Default(), "uncompress", 4);
+  TF_ASSERT_OK(
+      UncompressElement(compressed, &round_trip_element, &thread_pool));
+  TF_EXPECT_OK(
+      ExpectEqual(element, round_trip_element, /*compare_order=*/true));
+}
+
 INSTANTIATE_TEST_SUITE_P(Instantiation, ParameterizedCompressionUtilsTest,
                          ::testing::ValuesIn(TestCases()));
 
+std::vector<CompressedComponentMetadata::Codec> ColumnarCodecs(
+    const std::vector<Tensor>& element) {
+  CompressedElement compressed;
+  TF_CHECK_OK(
+      CompressElement(element, CompressionCodec::kColumnar, &compressed));
+  std::vector<CompressedComponentMetadata::Codec> codecs;
+  for (const auto& metadata : compressed.component_metadata()) {
+    codecs.push_back(metadata.codec());
+  }
+  return codecs;
+}
+
+TEST(CompressionUtilsTest, ColumnarCodecs) {
+  std::vector<int64_t> sorted_ids(1000);
+  std::vector<int64_t> random_ids(1000);
+  std::vector<float> floats(1000);
+  std::vector<tstring> repeated_strings(1000);
+  std::vector<tstring> distinct_strings(1000);
+  uint64_t state = 1;
+  for (int i = 0; i < 1000; ++i) {
+    state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+    sorted_ids[i] = 1000000 + 3 * i;
+    random_ids[i] = static_cast<int64_t>(state);
+    floats[i] = 0.25f * i;
+    repeated_strings[i] = i % 2 ? "even" : "odd";
+    distinct_strings[i] = absl::StrCat("string_", i);
+  }
+  std::vector<Tensor> element = {
+      CreateTensor<int64_t>(TensorShape{1000}, sorted_ids),
+      CreateTensor<int64_t>(TensorShape{1000}, random_ids),
+      CreateTensor<float>(TensorShape{10, 100}, floats),
+      CreateTensor<tstring>(TensorShape{1000}, repeated_strings),
+      CreateTensor<tstring>(TensorShape{1000}, distinct_strings),
+      CreateTensor<bool>(TensorShape{2}, {true, false})};
+  EXPECT_THAT(ColumnarCodecs(element),
+              ::testing::ElementsAre(
+                  CompressedComponentMetadata::CODEC_DELTA_VARINT,
+                  CompressedComponentMetadata::CODEC_SHUFFLE_SNAPPY,
+                  CompressedComponentMetadata::CODEC_SHUFFLE_SNAPPY,
+                  CompressedComponentMetadata::CODEC_DICTIONARY,
+                  CompressedComponentMetadata::CODEC_SNAPPY,
+                  CompressedComponentMetadata::CODEC_SNAPPY));
+
+  CompressedElement columnar;
+  TF_ASSERT_OK(
+      CompressElement(element, CompressionCodec::kColumnar, &columnar));
+  CompressedElement snappy;
+  TF_ASSERT_OK(CompressElement(element, &snappy));
+  EXPECT_LT(columnar.data().size(), snappy.data().size());
+  std::vector<Tensor> round_trip_element;
+  TF_ASSERT_OK(UncompressElement(columnar, &round_trip_element));
+  ASSERT_EQ(round_trip_element.size(), element.size());
+  for (int i = 0; i < element.size(); ++i) {
+    test::ExpectEqual(round_trip_element[i], element[i]);
+  }
+}
+
+TEST(CompressionUtilsTest, ColumnarDeltaVarintOverflow) {
+  std::vector<int64_t> int64s(32, 0);
+  int64s[0] = std::numeric_limits<int64_t>::min();
+  int64s[1] = std::numeric_limits<int64_t>::max();
+  int64s[2] = -1;
+  std::vector<int32_t> int32s(32, 7);
+  int32s[0] = std::numeric_limits<int32_t>::max();
+  int32s[1] = std::numeric_limits<int32_t>::min();
+  std::vector<Tensor> element = {
+      CreateTensor<int64_t>(TensorShape{32}, int64s),
+      CreateTensor<int32_t>(TensorShape{32}, int32s)};
+  EXPECT_THAT(ColumnarCodecs(element),
+              ::testing::Each(CompressedComponentMetadata::CODEC_DELTA_VARINT));
+
+  CompressedElement compressed;
+  TF_ASSERT_OK(
+      CompressElement(element, CompressionCodec::kColumnar, &compressed));
+  std::vector<Tensor> round_trip_element;
+  TF_ASSERT_OK(UncompressElement(compressed, &round_trip_element));
+  ASSERT_EQ(round_trip_element.size(), 2);
+  test::ExpectEqual(round_trip_element[0], element[0]);
+  test::ExpectEqual(round_trip_element[1], element[1]);
+}
+
+TEST(CompressionUtilsTest, ColumnarTruncated) {
+  std::vector<Tensor> element = {CreateTensor<float>(TensorShape{128}),
+                                 CreateTensor<int64_t>(TensorShape{128})};
+  CompressedElement compressed;
+  TF_ASSERT_OK(
+      CompressElement(element, CompressionCodec::kColumnar, &compressed));
+  compressed.mutable_data()->pop_back();
+  std::vector<Tensor> round_trip_element;
+  EXPECT_THAT(UncompressElement(compressed, &round_trip_element),
+              StatusIs(error::INTERNAL));
+}
+
 }  // namespace
 }  // namespace data
 }  // namespace tensorflow
@@ -793,6 +793,24 @@ Status CopyBatch(AnyContext ctx,
   const size_t num_tuple_components = batch_elements.at(0).size();
   out_tensors->reserve(num_tuple_components);
   const int64_t num_batch_elements = batch_elements.size();
+  if (num_batch_elements == 1) {
+    // The components of a batch of one element only gain a leading dimension
+    // of size 1, so they share the buffers of the element instead of copying
+    // them.
+    for (size_t component_index = 0; component_index < num_tuple_components;
+         ++component_index) {
+      const Tensor& element = batch_elements[0][component_index];
+      TensorShape batch_component_shape({1});
+      batch_component_shape.AppendShape(element.shape());
+      Tensor batch_component;
+      if (!batch_component.CopyFrom(element, batch_component_shape)) {
+        return errors::Internal("Failed to batch component ", component_index,
+                                " of shape ", element.shape().DebugString());
+      }
+      out_tensors->push_back(std::move(batch_component));
+    }
+    return absl::OkStatus();
+  }
   for (size_t component_index = 0; component_index < num_tuple_components;
        ++component_index) {
     const Tensor& first_element = batch_elements.at(0)[component_index];
@@ -998,6 +1016,14 @@ REGISTER_DATASET_EXPERIMENT("allow_small_function_optimizations",
                             RandomJobSamplePercentage<0>, AllTasks);
 REGISTER_DATASET_EXPERIMENT("autotune_buffer_optimization",
                             RandomJobSamplePercentage<0>, IndependentHostTasks);
+REGISTER_DATASET_EXPERIMENT("autotune_cycle_length",
+                            RandomJobSamplePercentage<0>, AllTasks);
+REGISTER_DATASET_EXPERIMENT("autotune_shared_cpu_budget",
+                            RandomJobSamplePercentage<0>, AllTasks);
+REGISTER_DATASET_EXPERIMENT("pinned_prefetch_buffer",
+                            RandomJobSamplePercentage<0>, AllTasks);
+REGISTER_DATASET_EXPERIMENT("bounded_directed_interleave",
+                            RandomJobSamplePercentage<0>, AllTasks);
 REGISTER_DATASET_EXPERIMENT(kFilterParallelizationOpt,
                             RandomJobSamplePercentage<0>, AllTasks);
 REGISTER_DATASET_EXPERIMENT("min_outer_interleave_parallelism",
@@ -283,7 +283,7 @@ Status ProcessBatch(int64_t batch_size, int64_t num_elements,
 //
 // The `batch_elements` argument contains the individual elements to copy into a
 // batch. The `parallel_copy` argument indicates whether to parallelize the
-// copy.
+// copy. A batch of a single element shares the buffers of the element.
 // The `out_tensors` argument will be used to store the resulting batch (one for
 // each component of the input).
 Status CopyBatch(AnyContext ctx,
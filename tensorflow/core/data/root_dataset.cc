@@ -26,6 +26,8 @@ limitations under the License.
 #include "tensorflow/core/data/dataset_utils.h"
 #include "tensorflow/core/data/name_utils.h"
 #include "tensorflow/core/data/rewrite_utils.h"
+#include "tensorflow/core/data/unbounded_thread_pool.h"
+#include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/dataset.h"
 #include "tensorflow/core/framework/dataset_options.pb.h"
 #include "tensorflow/core/framework/metrics.h"
@@ -34,6 +36,7 @@ limitations under the License.
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/host_info.h"
 #include "tensorflow/core/platform/mem.h"
+#include "tensorflow/core/platform/numa.h"
 #include "tensorflow/core/platform/refcount.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/stringprintf.h"
@@ -56,6 +59,7 @@ constexpr char kPrivateThreadpoolSize[] = "threadpool_size";
 constexpr char kRamBudget[] = "ram_budget_megabytes";
 constexpr char kRamUsage[] = "ram_usage_megabytes";
 constexpr char kMaxBufferBytes[] = "max_buffered_megabytes";
+constexpr char kNumaNode[] = "numa_node";
 constexpr char kWarmStart[] = "warm_start";
 
 // If value `x` matches `y`, returns default value `z`. Otherwise, return `x`.
@@ -72,6 +76,18 @@ void SetRootDatasetParams(const Options& options, RootDataset::Params* params) {
     params->private_threadpool_size =
         options.threading_options().private_threadpool_size();
   }
+  if (options.threading_options().optional_numa_node_case() ==
+      ThreadingOptions::kNumaNode) {
+    const int numa_node = options.threading_options().numa_node();
+    if (port::NUMAEnabled() && numa_node >= 0 &&
+        numa_node < port::NUMANumNodes()) {
+      params->numa_node = numa_node;
+    } else {
+      LOG(WARNING) << "Ignoring tf.data NUMA node " << numa_node
+                   << ": NUMA is not supported, or the host has fewer NUMA "
+                   << "nodes (" << port::NUMANumNodes() << ").";
+    }
+  }
   params->autotune = ShouldUseAutotuning(options);
   params->autotune_algorithm = model::AutotuneAlgorithm::DEFAULT;
   auto experiments = GetExperiments();
@@ -135,6 +151,10 @@ void AddTraceMetadata(const RootDataset::Params& params, const Options& options,
                                     params.private_threadpool_size, 0,
                                     port::MaxParallelism())))));
   }
+  if (params.numa_node != port::kNUMANoAffinity) {
+    trace_metadata->push_back(std::make_pair(
+        kNumaNode, strings::Printf("%d", params.numa_node)));
+  }
   auto experiments = GetExperiments();
   if (!experiments.empty()) {
     trace_metadata->push_back(
@@ -179,14 +199,23 @@ class RootDataset::Iterator : public DatasetIterator<RootDataset> {
           value_or_default(dataset()->params_.max_intra_op_parallelism, 0,
                            port::MaxParallelism());
     }
+    const int numa_node = dataset()->params_.numa_node;
+    ThreadOptions thread_options;
+    thread_options.numa_node = numa_node;
     if (dataset()->params_.private_threadpool_size >= 0) {
       threadpool_size_ =
           value_or_default(dataset()->params_.private_threadpool_size, 0,
-                           port::MaxParallelism());
+                           port::MaxParallelism(numa_node));
       thread_pool_ = std::make_unique<thread::ThreadPool>(
-          Env::Default(), ThreadOptions{}, "data_private_threadpool",
+          Env::Default(), thread_options, "data_private_threadpool",
           threadpool_size_);
     }
+    if (numa_node != port::kNUMANoAffinity) {
+      // Background threads started through the iterator context, e.g. by
+      // `prefetch` and `map`, run on the NUMA node too.
+      numa_thread_pool_ = std::make_unique<UnboundedThreadPool>(
+          Env::Default(), "tf_data_numa_thread", thread_options);
+    }
     cancellation_manager_ = std::make_unique<CancellationManager>();
   }
 
@@ -207,6 +236,9 @@ class RootDataset::Iterator : public DatasetIterator<RootDataset> {
       } else {
         model_ = std::make_shared<model::Model>();
         ctx->SetModel(model_);
+        if (GetExperiments().contains("autotune_shared_cpu_budget")) {
+          model_->SetCpuBudgetManager(model::CpuBudgetManager::Global());
+        }
       }
 
       absl::flat_hash_set<string> experiments = GetExperiments();
@@ -336,6 +368,20 @@ class RootDataset::Iterator : public DatasetIterator<RootDataset> {
       params.runner =
           RunnerWithMaxParallelism(params.runner, max_intra_op_parallelism_);
     }
+    if (numa_thread_pool_) {
+      params.thread_factory = numa_thread_pool_->get_thread_factory();
+      params.thread_pool = numa_thread_pool_.get();
+      // Memory shared with accelerators keeps coming from the device
+      // allocator, which may pin it for DMA.
+      const int numa_node = dataset()->params_.numa_node;
+      params.allocator_getter = [getter = std::move(params.allocator_getter),
+                                 numa_node](AllocatorAttributes attrs) {
+        if (attrs.gpu_compatible() && getter) {
+          return getter(attrs);
+        }
+        return cpu_allocator(numa_node);
+      };
+    }
     params.options = &dataset()->options();
     return params;
   }
@@ -378,6 +424,7 @@ class RootDataset::Iterator : public DatasetIterator<RootDataset> {
   int64_t max_intra_op_parallelism_;
   int64_t threadpool_size_;
   std::unique_ptr<thread::ThreadPool> thread_pool_;
+  std::unique_ptr<UnboundedThreadPool> numa_thread_pool_;
 
   // The end time of the previous `GetNextInternal` call.
   uint64_t end_time_usec_ TF_GUARDED_BY(mu_) = 0;
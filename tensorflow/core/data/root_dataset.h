@@ -23,6 +23,7 @@ limitations under the License.
 #include "tensorflow/core/framework/dataset.h"
 #include "tensorflow/core/framework/model.pb.h"
 #include "tensorflow/core/platform/mem.h"
+#include "tensorflow/core/platform/numa.h"
 #include "tensorflow/core/platform/refcount.h"
 
 namespace tensorflow {
@@ -40,6 +41,7 @@ class RootDataset : public DatasetBase {
     int64_t autotune_ram_budget_from_options;
     int64_t max_intra_op_parallelism = 1;
     int64_t private_threadpool_size = 0;
+    int numa_node = port::kNUMANoAffinity;
 
     int64_t ComputeInitialAutotuneRamBudget() const {
       if (autotune_ram_budget_from_options > 0) {
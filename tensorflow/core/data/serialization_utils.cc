@@ -159,6 +159,23 @@ Status UpdateCheckpointElements(
   return absl::OkStatus();
 }
 
+Status WriteVariantTensorData(const std::vector<const VariantTensorData*>& data,
+                              IteratorStateWriter* writer) {
+  for (const VariantTensorData* d : data) {
+    string metadata;
+    d->get_metadata(&metadata);
+    auto keys = str_util::Split(metadata, kDelimiter, str_util::SkipEmpty());
+    if (keys.empty() || keys.size() != d->tensors_size() + 1) {
+      return errors::Internal("Invalid iterator state metadata: ", metadata);
+    }
+    for (size_t i = 1; i < keys.size(); ++i) {
+      TF_RETURN_IF_ERROR(
+          writer->WriteTensor(keys[0], keys[i], d->tensors(i - 1)));
+    }
+  }
+  return absl::OkStatus();
+}
+
 VariantTensorDataReader::VariantTensorDataReader(
     const std::vector<const tensorflow::VariantTensorData*>& data) {
   for (const auto& d : data) {
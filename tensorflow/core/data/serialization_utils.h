@@ -59,6 +59,12 @@ Status UpdateCheckpointElements(
     const std::vector<std::vector<Tensor>>& elements,
     const absl::flat_hash_set<int64_t>& checkpoint_indices);
 
+// Copies the iterator state in `data`, as built by a `VariantTensorDataWriter`,
+// to `writer`. This can be used to checkpoint an iterator whose state has been
+// saved earlier, without restoring the iterator.
+Status WriteVariantTensorData(const std::vector<const VariantTensorData*>& data,
+                              IteratorStateWriter* writer);
+
 // Helper class for reading data from a vector of VariantTensorData objects.
 class VariantTensorDataReader : public IteratorStateReader {
  public:
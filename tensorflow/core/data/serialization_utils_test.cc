@@ -101,6 +101,32 @@ TEST(SerializationUtilsTest, VariantTensorDataRoundtrip) {
   EXPECT_EQ(input_tensor.flat<float>()(0), val_tensor.flat<float>()(0));
 }
 
+TEST(SerializationUtilsTest, WriteVariantTensorData) {
+  VariantTensorDataWriter writer;
+  TF_ASSERT_OK(writer.WriteScalar(full_name("Int64"), 24));
+  TF_ASSERT_OK(writer.WriteScalar("Iterator", "String", "abc"));
+  Tensor input_tensor(DT_FLOAT, {1});
+  input_tensor.flat<float>()(0) = 2.0f;
+  TF_ASSERT_OK(writer.WriteTensor(full_name("Tensor"), input_tensor));
+  std::vector<const VariantTensorData*> data;
+  writer.GetData(&data);
+
+  VariantTensorDataWriter copy_writer;
+  TF_ASSERT_OK(WriteVariantTensorData(data, &copy_writer));
+  std::vector<const VariantTensorData*> copy;
+  copy_writer.GetData(&copy);
+  VariantTensorDataReader reader(copy);
+  int64_t val_int64;
+  TF_ASSERT_OK(reader.ReadScalar(full_name("Int64"), &val_int64));
+  EXPECT_EQ(val_int64, 24);
+  tstring val_string;
+  TF_ASSERT_OK(reader.ReadScalar("Iterator", "String", &val_string));
+  EXPECT_EQ(val_string, "abc");
+  Tensor val_tensor;
+  TF_ASSERT_OK(reader.ReadTensor(full_name("Tensor"), &val_tensor));
+  EXPECT_EQ(input_tensor.flat<float>()(0), val_tensor.flat<float>()(0));
+}
+
 TEST(SerializationUtilsTest, VariantTensorDataNonExistentKey) {
   VariantTensorData data;
   strings::StrAppend(&data.metadata_, "key1", "@@");
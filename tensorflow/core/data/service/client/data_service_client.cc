@@ -37,6 +37,7 @@ limitations under the License.
 #include "tensorflow/core/data/service/common.pb.h"
 #include "tensorflow/core/data/service/dispatcher_client.h"
 #include "tensorflow/core/data/service/grpc_util.h"
+#include "tensorflow/core/data/service/shm_data_transfer.h"
 #include "tensorflow/core/data/service/worker_client.h"
 #include "tensorflow/core/data/service/worker_impl.h"
 #include "tensorflow/core/data/utils.h"
@@ -150,6 +151,10 @@ absl::StatusOr<GetNextResult> DataServiceClient::GetNext(
     ctx_ = context_factory();
   }
   EnsureThreadsStarted();
+  ++get_next_calls_;
+  if (!ResultReady() && !Finished() && !tasks_.empty()) {
+    ++buffer_empty_get_next_calls_;
+  }
   std::shared_ptr<Result> result;
   do {
     while (!ResultReady() && !Finished() && !cancelled_ && status_.ok()) {
@@ -390,6 +395,17 @@ DataServiceClient::CreateWorkerClient(const TaskInfo& task_info) {
     return CreateDataServiceWorkerClient(params_.protocol, info,
                                          accelerator_device_info_, allocator_);
   }
+  // Workers on this host that serve the shared-memory transfer protocol skip
+  // the serialization of the elements.
+  if (params_.data_transfer_protocol.empty() &&
+      IsLocalAddress(task_info.worker_address())) {
+    absl::StatusOr<DataTransferServerInfo> transfer_server =
+        GetTransferServer(kShmTransferProtocol, task_info);
+    if (transfer_server.ok()) {
+      return CreateAlternativeWorkerClientWithGrpcFallback(*transfer_server,
+                                                           task_info);
+    }
+  }
   if (!params_.data_transfer_protocol.empty()) {
     TF_ASSIGN_OR_RETURN(
         DataTransferServerInfo transfer_server,
@@ -459,6 +475,10 @@ void DataServiceClient::Heartbeat() TF_LOCKS_EXCLUDED(mu_) {
     mutex_lock l(mu_);
     double target_processing_time_nsec = ctx_->GetTargetProcessingTimeNsec();
     req.set_target_processing_time_nsec(target_processing_time_nsec);
+    req.set_get_next_calls(get_next_calls_);
+    req.set_buffer_empty_get_next_calls(buffer_empty_get_next_calls_);
+    get_next_calls_ = 0;
+    buffer_empty_get_next_calls_ = 0;
   }
   ClientHeartbeatResponse resp;
   Status s = dispatcher_->ClientHeartbeat(req, resp);
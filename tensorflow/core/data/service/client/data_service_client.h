@@ -252,6 +252,11 @@ class DataServiceClient {
   Allocator* allocator_;
 
   int64_t get_next_index_ TF_GUARDED_BY(mu_) = 0;
+  // Number of `GetNext` calls since the last heartbeat, and of those which
+  // found no element ready to return. Reported to the dispatcher to detect
+  // starved consumers.
+  int64_t get_next_calls_ TF_GUARDED_BY(mu_) = 0;
+  int64_t buffer_empty_get_next_calls_ TF_GUARDED_BY(mu_) = 0;
 
   bool iteration_finished_ TF_GUARDED_BY(mu_) = false;
   bool should_finish_iteration_ TF_GUARDED_BY(mu_) = true;
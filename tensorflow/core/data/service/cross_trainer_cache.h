@@ -15,6 +15,9 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DATA_SERVICE_CROSS_TRAINER_CACHE_H_
 #define TENSORFLOW_CORE_DATA_SERVICE_CROSS_TRAINER_CACHE_H_
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>  // NOLINT(build/c++11)
 #include <cstddef>
 #include <deque>
 #include <functional>
@@ -24,6 +27,7 @@ limitations under the License.
 #include <utility>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/time/time.h"
 #include "tensorflow/core/data/service/byte_size.h"
 #include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/platform/errors.h"
@@ -46,6 +50,17 @@ namespace data {
 // collected when the cache becomes full. Consequently, trainers read from a
 // sliding window through the dataset and may not read the full dataset.
 //
+// If a positive `straggler_timeout` is given, the cache instead tracks the
+// position of every trainer and only evicts elements that all trainers have
+// read. When the cache is full, the trainer extending it waits for the slowest
+// trainers. A trainer which holds back eviction for longer than
+// `straggler_timeout` is a straggler: it stops holding back eviction, and
+// skips the evicted elements like in the default mode, until it catches up
+// with the newest element and rejoins the group.
+//
+// Cache hits only take a shared lock, so trainers reading near the head of the
+// cache don't serialize on each other.
+//
 // The `CrossTrainerCache` class is thread-safe.
 //
 // Example usage:
@@ -98,9 +113,14 @@ class CrossTrainerCache {
   // Creates a `CrossTrainerCache` with `max_cache_size_bytes` of memory budget.
   // The cache should be able to hold at least one element, i.e.:
   // REQUIRES: `max_cache_size_bytes >= max(GetElementSizeBytes(*))`
+  //
+  // If `straggler_timeout` is positive, elements are only evicted once all
+  // trainers have read them, or once the trainers which haven't have held back
+  // eviction for `straggler_timeout`.
   explicit CrossTrainerCache(
       size_t max_cache_size_bytes,
-      std::unique_ptr<CachableSequence<ElementType>> cachable_sequence);
+      std::unique_ptr<CachableSequence<ElementType>> cachable_sequence,
+      absl::Duration straggler_timeout = absl::ZeroDuration());
   virtual ~CrossTrainerCache() = default;
   CrossTrainerCache(const CrossTrainerCache&) = delete;
   CrossTrainerCache& operator=(const CrossTrainerCache&) = delete;
@@ -126,28 +146,56 @@ class CrossTrainerCache {
     bool cache_hit;
   };
 
+  // The position of a trainer. Only the trainer advances it, but several
+  // threads may read for the same trainer, so it is updated atomically to
+  // allow reads under a shared lock.
+  struct TrainerState {
+    // Absolute index of the next element to read. The actual index to use with
+    // `cache_` would be `max(next_index, cache_start_index_) -
+    // cache_start_index_`.
+    std::atomic<size_t> next_index{0};
+    // True if the trainer fell behind and doesn't hold back eviction.
+    std::atomic<bool> straggler{false};
+  };
+
+  // Returns the next element if it is cached for `trainer_id`, holding only a
+  // shared lock. Returns nullptr if the trainer is unknown, or if the cache
+  // needs to be extended.
+  StatusOr<std::shared_ptr<const ElementType>> TryGetCachedElement(
+      const std::string& trainer_id);
+
   // Returns the next element and metrics about this query.
   StatusOr<CacheQueryResult> GetCacheQueryResult(const std::string& trainer_id);
 
-  // Returns true if element is ready for `trainer_id`. An element is ready if
+  // Returns the state of `trainer_id`, registering the trainer at the start of
+  // the cache if it hasn't read from the cache before.
+  TrainerState& GetTrainerState(const std::string& trainer_id);
+
+  // Returns true if element is ready for `trainer`. An element is ready if
   // other trainers have read the data and the data remains in the cache. If the
   // data is not ready, one of the trainers need to extend the cache.
-  bool IsElementReady(const std::string& trainer_id);
+  bool IsElementReady(const TrainerState& trainer) const;
 
-  // Returns the absolute element index relative to the dataset (not relative to
-  // the cached elements).
-  size_t GetElementIndex(const std::string& trainer_id);
-
-  // Returns the next element for `trainer_id`.
-  StatusOr<std::shared_ptr<const ElementType>> GetElement(
-      const std::string& trainer_id);
+  // Claims the next element for `trainer`, if it is cached, and returns it.
+  // Returns nullptr if the cache needs to be extended.
+  std::shared_ptr<const ElementType> ClaimElement(TrainerState& trainer);
 
   // Reads a new element and writes it into the cache.
   Status ExtendCache();
 
   // Frees old elements to keep the cache size below `max_cache_size_bytes_`.
   // `new_element_size_bytes` is the size of the new element being inserted.
-  void FreeSpace(size_t new_element_size_bytes);
+  // With a positive `straggler_timeout_`, it may wait for trainers to read the
+  // oldest elements.
+  Status FreeSpace(size_t new_element_size_bytes, mutex_lock& l);
+
+  // Returns true if the oldest cached element may be evicted, i.e. no trainer
+  // is waiting to read it, or the cache doesn't track trainers.
+  bool CanEvictFront() const;
+
+  // Marks the trainers which haven't read the oldest cached element as
+  // stragglers.
+  void MarkStragglers();
 
   // Records the cache hit rate and cache size.
   void RecordMetrics(const CacheQueryResult& result);
@@ -155,6 +203,9 @@ class CrossTrainerCache {
   // Maximum cache size in bytes.
   const size_t max_cache_size_bytes_;
 
+  // How long trainers may hold back eviction. Zero if eviction is size-based.
+  const absl::Duration straggler_timeout_;
+
   // The element sequence over which the sliding window cache operates.
   std::unique_ptr<CachableSequence<ElementType>> cachable_sequence_;
 
@@ -173,18 +224,22 @@ class CrossTrainerCache {
   // True if one thread is extending the cache.
   bool extending_cache_ TF_GUARDED_BY(mu_) = false;
 
-  // Maps trainer IDs to element indices. The indices are absolute indices
-  // within the dataset. The actual index to use with `cache_` would be
-  // `trainer_to_element_index_map_[trainer_id] - cache_start_index_`.
-  absl::flat_hash_map<std::string, size_t> trainer_to_element_index_map_
+  // True if the thread extending the cache waits for trainers to read the
+  // oldest element.
+  bool waiting_for_trainers_ TF_GUARDED_BY(mu_) = false;
+
+  // Maps trainer IDs to their positions.
+  absl::flat_hash_map<std::string, std::unique_ptr<TrainerState>> trainers_
       TF_GUARDED_BY(mu_);
 };
 
 template <class ElementType>
 CrossTrainerCache<ElementType>::CrossTrainerCache(
     size_t max_cache_size_bytes,
-    std::unique_ptr<CachableSequence<ElementType>> cachable_sequence)
+    std::unique_ptr<CachableSequence<ElementType>> cachable_sequence,
+    absl::Duration straggler_timeout)
     : max_cache_size_bytes_(max_cache_size_bytes),
+      straggler_timeout_(straggler_timeout),
       cachable_sequence_(std::move(cachable_sequence)) {
   DCHECK_GT(max_cache_size_bytes, 0)
       << "CrossTrainerCache size must be greater than 0.";
@@ -201,11 +256,29 @@ CrossTrainerCache<ElementType>::Get(const std::string& trainer_id)
         "tf.data service cross-trainer cache requires a non-empty trainer ID.");
   }
 
-  TF_ASSIGN_OR_RETURN(CacheQueryResult result, GetCacheQueryResult(trainer_id));
+  TF_ASSIGN_OR_RETURN(std::shared_ptr<const ElementType> cached_element,
+                      TryGetCachedElement(trainer_id));
+  CacheQueryResult result{cached_element, /*cache_hit=*/true};
+  if (cached_element == nullptr) {
+    TF_ASSIGN_OR_RETURN(result, GetCacheQueryResult(trainer_id));
+  }
   RecordMetrics(result);
   return result.element;
 }
 
+template <class ElementType>
+StatusOr<std::shared_ptr<const ElementType>>
+CrossTrainerCache<ElementType>::TryGetCachedElement(
+    const std::string& trainer_id) TF_LOCKS_EXCLUDED(mu_) {
+  tf_shared_lock l(mu_);
+  TF_RETURN_IF_ERROR(status_);
+  auto it = trainers_.find(trainer_id);
+  if (it == trainers_.end()) {
+    return std::shared_ptr<const ElementType>();
+  }
+  return ClaimElement(*it->second);
+}
+
 template <class ElementType>
 StatusOr<typename CrossTrainerCache<ElementType>::CacheQueryResult>
 CrossTrainerCache<ElementType>::GetCacheQueryResult(
@@ -215,11 +288,13 @@ CrossTrainerCache<ElementType>::GetCacheQueryResult(
     {
       mutex_lock l(mu_);
       TF_RETURN_IF_ERROR(status_);
-      if (IsElementReady(trainer_id)) {
-        TF_ASSIGN_OR_RETURN(std::shared_ptr<const ElementType> element,
-                            GetElement(trainer_id));
-        return CacheQueryResult{element,
-                                /*is_cache_hit=*/!should_extend_cache};
+      TrainerState& trainer = GetTrainerState(trainer_id);
+      if (IsElementReady(trainer)) {
+        std::shared_ptr<const ElementType> element = ClaimElement(trainer);
+        if (element != nullptr) {
+          return CacheQueryResult{element,
+                                  /*is_cache_hit=*/!should_extend_cache};
+        }
       }
 
       // Extends the cache or waits for another thread to extend the cache. When
@@ -245,36 +320,51 @@ CrossTrainerCache<ElementType>::GetCacheQueryResult(
 }
 
 template <class ElementType>
-bool CrossTrainerCache<ElementType>::IsElementReady(
-    const std::string& trainer_id) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
-  return GetElementIndex(trainer_id) < cache_start_index_ + cache_.size();
-}
-
-template <class ElementType>
-StatusOr<std::shared_ptr<const ElementType>>
-CrossTrainerCache<ElementType>::GetElement(const std::string& trainer_id)
+typename CrossTrainerCache<ElementType>::TrainerState&
+CrossTrainerCache<ElementType>::GetTrainerState(const std::string& trainer_id)
     TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
-  size_t element_index = GetElementIndex(trainer_id);
-  if (element_index >= std::numeric_limits<size_t>::max()) {
-    return errors::Internal(
-        "tf.data service caching element index exceeds integer limit. Got ",
-        element_index);
+  std::unique_ptr<TrainerState>& trainer = trainers_[trainer_id];
+  if (trainer == nullptr) {
+    trainer = std::make_unique<TrainerState>();
+    trainer->next_index = cache_start_index_;
   }
+  return *trainer;
+}
 
-  std::shared_ptr<const ElementType> result =
-      cache_[element_index - cache_start_index_];
-  trainer_to_element_index_map_[trainer_id] = element_index + 1;
-  return result;
+template <class ElementType>
+bool CrossTrainerCache<ElementType>::IsElementReady(
+    const TrainerState& trainer) const TF_SHARED_LOCKS_REQUIRED(mu_) {
+  return std::max(trainer.next_index.load(), cache_start_index_) <
+         cache_start_index_ + cache_.size();
 }
 
 template <class ElementType>
-size_t CrossTrainerCache<ElementType>::GetElementIndex(
-    const std::string& trainer_id) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
-  size_t element_index = trainer_to_element_index_map_[trainer_id];
-  if (element_index < cache_start_index_) {
-    element_index = cache_start_index_;
+std::shared_ptr<const ElementType>
+CrossTrainerCache<ElementType>::ClaimElement(TrainerState& trainer)
+    TF_SHARED_LOCKS_REQUIRED(mu_) {
+  const size_t cache_end_index = cache_start_index_ + cache_.size();
+  size_t next_index = trainer.next_index.load();
+  while (true) {
+    const size_t element_index = std::max(next_index, cache_start_index_);
+    if (element_index >= cache_end_index) {
+      return nullptr;
+    }
+    // On failure, `next_index` is updated to the index another thread of the
+    // same trainer moved to.
+    if (!trainer.next_index.compare_exchange_weak(next_index,
+                                                  element_index + 1)) {
+      continue;
+    }
+    if (trainer.straggler && element_index + 1 == cache_end_index) {
+      VLOG(2) << "A straggler caught up with the tf.data service cross-trainer "
+              << "cache.";
+      trainer.straggler = false;
+    }
+    if (waiting_for_trainers_ && element_index == cache_start_index_) {
+      cv_.notify_all();
+    }
+    return cache_[element_index - cache_start_index_];
   }
-  return element_index;
 }
 
 template <class ElementType>
@@ -291,29 +381,75 @@ Status CrossTrainerCache<ElementType>::ExtendCache() TF_LOCKS_EXCLUDED(mu_) {
 
   mutex_lock l(mu_);
   TF_RETURN_IF_ERROR(status_);
-  FreeSpace(new_element_size_bytes);
+  TF_RETURN_IF_ERROR(FreeSpace(new_element_size_bytes, l));
   cache_.push_back(std::make_shared<ElementType>(std::move(element)));
   cache_size_bytes_ += new_element_size_bytes;
   return absl::OkStatus();
 }
 
 template <class ElementType>
-void CrossTrainerCache<ElementType>::FreeSpace(size_t new_element_size_bytes)
+Status CrossTrainerCache<ElementType>::FreeSpace(size_t new_element_size_bytes,
+                                                 mutex_lock& l)
     TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
   size_t num_elements_discarded = 0;
+  absl::Time wait_start = absl::Now();
   while (!cache_.empty() &&
          cache_size_bytes_ + new_element_size_bytes > max_cache_size_bytes_) {
+    if (!CanEvictFront()) {
+      const absl::Duration remaining =
+          wait_start + straggler_timeout_ - absl::Now();
+      if (remaining <= absl::ZeroDuration()) {
+        MarkStragglers();
+        continue;
+      }
+      waiting_for_trainers_ = true;
+      cv_.wait_for(
+          l, std::chrono::microseconds(absl::ToInt64Microseconds(remaining)));
+      waiting_for_trainers_ = false;
+      TF_RETURN_IF_ERROR(status_);
+      continue;
+    }
     size_t free_bytes =
         cachable_sequence_->GetElementSizeBytes(*cache_.front());
     cache_.pop_front();
     cache_size_bytes_ -= free_bytes;
     ++cache_start_index_;
     ++num_elements_discarded;
+    wait_start = absl::Now();
   }
 
   VLOG(3) << "Freed " << num_elements_discarded << " element(s) from "
           << "tf.data service cross-trainer cache. Memory usage: "
           << ByteSize::Bytes(cache_size_bytes_) << ".";
+  return absl::OkStatus();
+}
+
+template <class ElementType>
+bool CrossTrainerCache<ElementType>::CanEvictFront() const
+    TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  if (straggler_timeout_ <= absl::ZeroDuration()) {
+    return true;
+  }
+  for (const auto& [trainer_id, trainer] : trainers_) {
+    if (!trainer->straggler && trainer->next_index <= cache_start_index_) {
+      return false;
+    }
+  }
+  return true;
+}
+
+template <class ElementType>
+void CrossTrainerCache<ElementType>::MarkStragglers()
+    TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  for (const auto& [trainer_id, trainer] : trainers_) {
+    if (!trainer->straggler && trainer->next_index <= cache_start_index_) {
+      LOG(INFO) << "Trainer " << trainer_id << " has not read from the "
+                << "tf.data service cross-trainer cache for "
+                << straggler_timeout_ << ". It will skip elements until it "
+                << "catches up with the other trainers.";
+      trainer->straggler = true;
+    }
+  }
 }
 
 template <class ElementType>
@@ -332,7 +468,7 @@ void CrossTrainerCache<ElementType>::Cancel(Status status)
 template <class ElementType>
 bool CrossTrainerCache<ElementType>::IsCancelled() const
     TF_LOCKS_EXCLUDED(mu_) {
-  mutex_lock l(mu_);
+  tf_shared_lock l(mu_);
   return !status_.ok();
 }
 
@@ -342,7 +478,7 @@ void CrossTrainerCache<ElementType>::RecordMetrics(
   metrics::RecordTFDataServiceCrossTrainerCacheQuery(result.cache_hit);
   size_t cache_size_bytes = 0;
   {
-    mutex_lock l(mu_);
+    tf_shared_lock l(mu_);
     cache_size_bytes = cache_size_bytes_;
   }
   metrics::RecordTFDataServiceCrossTrainerCacheSizeBytes(cache_size_bytes);
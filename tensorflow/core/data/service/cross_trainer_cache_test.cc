@@ -235,6 +235,94 @@ TEST(CrossTrainerCacheTest, AlternateTrainerExtendsCache) {
   EXPECT_THAT(cache.Get("Trainer 3"), IsOkAndHolds(Pointee(Gt(5))));
 }
 
+TEST(CrossTrainerCacheTest, TrackedTrainersDoNotSkipData) {
+  const size_t num_elements_to_read = 100;
+  CrossTrainerCache<int64_t> cache(
+      /*max_cache_size_bytes=*/5 * sizeof(int64_t),
+      std::make_unique<InfiniteRange>(),
+      /*straggler_timeout=*/absl::Minutes(10));
+  EXPECT_THAT(cache.Get("Fast trainer"), IsOkAndHolds(Pointee(0)));
+  EXPECT_THAT(cache.Get("Slow trainer"), IsOkAndHolds(Pointee(0)));
+
+  std::vector<int64_t> fast_result, slow_result;
+  {
+    std::unique_ptr<Thread> fast_trainer =
+        absl::WrapUnique(Env::Default()->StartThread(
+            /*thread_options=*/{}, /*name=*/"fast_trainer",
+            [&cache, &fast_result, num_elements_to_read]() {
+              for (size_t i = 1; i < num_elements_to_read; ++i) {
+                TF_ASSERT_OK_AND_ASSIGN(std::shared_ptr<const int64_t> next,
+                                        cache.Get("Fast trainer"));
+                fast_result.push_back(*next);
+              }
+            }));
+    std::unique_ptr<Thread> slow_trainer =
+        absl::WrapUnique(Env::Default()->StartThread(
+            /*thread_options=*/{}, /*name=*/"slow_trainer",
+            [&cache, &slow_result, num_elements_to_read]() {
+              for (size_t i = 1; i < num_elements_to_read; ++i) {
+                Env::Default()->SleepForMicroseconds(500);
+                TF_ASSERT_OK_AND_ASSIGN(std::shared_ptr<const int64_t> next,
+                                        cache.Get("Slow trainer"));
+                slow_result.push_back(*next);
+              }
+            }));
+  }
+
+  // The fast trainer waits for the slow trainer instead of evicting elements
+  // it hasn't read.
+  std::vector<int64_t> expected = GetRange(num_elements_to_read);
+  expected.erase(expected.begin());
+  EXPECT_EQ(fast_result, expected);
+  EXPECT_EQ(slow_result, expected);
+}
+
+TEST(CrossTrainerCacheTest, StragglersSkipData) {
+  CrossTrainerCache<int64_t> cache(
+      /*max_cache_size_bytes=*/5 * sizeof(int64_t),
+      std::make_unique<InfiniteRange>(),
+      /*straggler_timeout=*/absl::Milliseconds(10));
+  EXPECT_THAT(cache.Get("Fast trainer"), IsOkAndHolds(Pointee(0)));
+  EXPECT_THAT(cache.Get("Straggler"), IsOkAndHolds(Pointee(0)));
+
+  // The straggler holds back eviction for 10ms, then is left behind.
+  for (int i = 1; i < 20; ++i) {
+    EXPECT_THAT(cache.Get("Fast trainer"), IsOkAndHolds(Pointee(i)));
+  }
+  // When 19 is cached, 14 must have been discarded.
+  EXPECT_THAT(cache.Get("Straggler"), IsOkAndHolds(Pointee(15)));
+  for (int i = 16; i < 20; ++i) {
+    EXPECT_THAT(cache.Get("Straggler"), IsOkAndHolds(Pointee(i)));
+  }
+
+  // The straggler has caught up and rejoined the group.
+  for (int i = 20; i < 30; ++i) {
+    EXPECT_THAT(cache.Get("Fast trainer"), IsOkAndHolds(Pointee(i)));
+    EXPECT_THAT(cache.Get("Straggler"), IsOkAndHolds(Pointee(i)));
+  }
+}
+
+TEST(CrossTrainerCacheTest, CancelWhileWaitingForTrainers) {
+  CrossTrainerCache<int64_t> cache(
+      /*max_cache_size_bytes=*/sizeof(int64_t),
+      std::make_unique<InfiniteRange>(),
+      /*straggler_timeout=*/absl::Hours(1));
+  EXPECT_THAT(cache.Get("Trainer 1"), IsOkAndHolds(Pointee(0)));
+  EXPECT_THAT(cache.Get("Trainer 2"), IsOkAndHolds(Pointee(0)));
+  EXPECT_THAT(cache.Get("Trainer 1"), IsOkAndHolds(Pointee(1)));
+
+  // Trainer 1 waits for trainer 2 to read 1 before it can evict it.
+  std::unique_ptr<Thread> reader_thread =
+      absl::WrapUnique(Env::Default()->StartThread(
+          /*thread_options=*/{}, /*name=*/"reader_thread", [&cache]() {
+            EXPECT_THAT(cache.Get("Trainer 1"),
+                        StatusIs(error::CANCELLED, HasSubstr("Cancelled")));
+          }));
+  Env::Default()->SleepForMicroseconds(10000);
+  cache.Cancel(errors::Cancelled("Cancelled"));
+  reader_thread.reset();
+}
+
 TEST(CrossTrainerCacheTest, CacheHitMetrics) {
   CellReader<int64_t> cell_reader(
       "/tensorflow/data/service/cross_trainer_cache_queries");
@@ -62,9 +62,9 @@ class DataServiceDispatcherClient : public DataServiceClientBase {
   Status GetDatasetDef(const std::string& dataset_id, DatasetDef& dataset_def);
 
   // Gets the next split for the specified iteration id, repetition, and split
-  // provider index.
+  // provider index. `task_id` is the task requesting the split.
   Status GetSplit(int64_t iteration_id, int64_t repetition,
-                  int64_t split_provider_index, Tensor& split,
+                  int64_t split_provider_index, int64_t task_id, Tensor& split,
                   bool& end_of_splits);
 
   // Gets the next split for the specified source of a stream of the snapshot in
@@ -57,6 +57,7 @@ limitations under the License.
 #include "tensorflow/core/data/service/utils.h"
 #include "tensorflow/core/data/service/validate_utils.h"
 #include "tensorflow/core/data/service/worker.grpc.pb.h"
+#include "tensorflow/core/data/service/worker_orchestrator.h"
 #include "tensorflow/core/data/snapshot_utils.h"
 #include "tensorflow/core/data/standalone.h"
 #include "tensorflow/core/data/utils.h"
@@ -104,6 +105,9 @@ constexpr absl::Duration kDefaultIterationGcCheckInterval = absl::Minutes(10);
 constexpr absl::Duration kDefaultIterationGcTimeout = absl::Minutes(5);
 constexpr absl::Duration kDefaultClientTimeout = absl::Minutes(5);
 constexpr absl::Duration kDefaultWorkerTimeout = absl::Minutes(10);
+constexpr int64_t kDefaultMinWorkers = 1;
+constexpr absl::Duration kDefaultAutoScalingCooldown = absl::Minutes(2);
+constexpr absl::Duration kAutoScalingCheckInterval = absl::Seconds(30);
 
 constexpr std::array<const char*, 8> kNodeNameSharingOps = {
     "HashTable",
@@ -183,6 +187,13 @@ DispatcherConfig ApplyConfigDefaults(const DispatcherConfig& config) {
     new_config.set_worker_max_concurrent_snapshots(
         kDefaultWorkerMaxConcurrentSnapshots);
   }
+  if (new_config.min_workers() == 0) {
+    new_config.set_min_workers(kDefaultMinWorkers);
+  }
+  if (new_config.auto_scaling_cooldown_ms() == 0) {
+    new_config.set_auto_scaling_cooldown_ms(
+        absl::ToInt64Milliseconds(kDefaultAutoScalingCooldown));
+  }
   return new_config;
 }
 }  // namespace
@@ -212,7 +223,16 @@ DataServiceDispatcherImpl::~DataServiceDispatcherImpl() {
 
 Status DataServiceDispatcherImpl::Start() {
   mutex_lock l(mu_);
-  if (config_.job_gc_timeout_ms() >= 0) {
+  if (!config_.worker_orchestrator().empty()) {
+    TF_RETURN_IF_ERROR(WorkerOrchestrator::Build(
+        config_.worker_orchestrator(), config_, &worker_orchestrator_));
+    WorkerScalingPolicy::Options options;
+    options.min_workers = config_.min_workers();
+    options.max_workers = config_.max_workers();
+    options.cooldown = absl::Milliseconds(config_.auto_scaling_cooldown_ms());
+    worker_scaling_policy_ = std::make_unique<WorkerScalingPolicy>(options);
+  }
+  if (config_.job_gc_timeout_ms() >= 0 || worker_orchestrator_) {
     maintenance_thread_ = absl::WrapUnique(env_->StartThread(
         {}, "maintenance-thread", [&] { MaintenanceThread(); }));
   }
@@ -375,7 +395,8 @@ Status DataServiceDispatcherImpl::FindNewTasks(
   }
   for (const auto& iteration : state_.ListIterations()) {
     if (!assigned_iteration_ids.contains(iteration->iteration_id) &&
-        iteration->IsRoundRobin() && !iteration->finished) {
+        iteration->IsRoundRobin() && !iteration->finished &&
+        !IsWorkerDrained(worker_address)) {
       VLOG(1) << "Creating pending task for reconnected worker "
               << worker_address;
       TF_RETURN_IF_ERROR(CreatePendingTask(iteration, worker_address));
@@ -452,6 +473,10 @@ Status DataServiceDispatcherImpl::WorkerHeartbeat(
       TF_RETURN_IF_ERROR(Apply(update));
       TF_RETURN_IF_ERROR(CreateTasksForWorker(worker_address));
       TF_RETURN_IF_ERROR(state_.TasksForWorker(worker_address, assigned_tasks));
+    } else if (removed_workers_.erase(worker_address)) {
+      VLOG(1) << "Drained worker " << worker_address << " rejoined";
+      TF_RETURN_IF_ERROR(CreateTasksForWorker(worker_address));
+      TF_RETURN_IF_ERROR(state_.TasksForWorker(worker_address, assigned_tasks));
     }
     absl::flat_hash_set<int64_t> current_tasks;
     current_tasks.insert(request->current_tasks().cbegin(),
@@ -459,8 +484,10 @@ Status DataServiceDispatcherImpl::WorkerHeartbeat(
     const std::vector<ActiveTask> active_tasks(request->active_tasks().begin(),
                                                request->active_tasks().end());
     // TODO(b/249286501): Skip this if the user does not enable auto-scaling.
-    ReportProcessingTimesFromActiveTasks(active_tasks,
-                                         request->worker_address());
+    if (!IsWorkerDrained(worker_address)) {
+      ReportProcessingTimesFromActiveTasks(active_tasks,
+                                           request->worker_address());
+    }
     TF_RETURN_IF_ERROR(
         FindTasksToDelete(current_tasks, assigned_tasks, response));
     TF_RETURN_IF_ERROR(
@@ -549,6 +576,14 @@ Status DataServiceDispatcherImpl::GetSplit(const GetSplitRequest* request,
           "Cannot get split for iteration ", iteration_id,
           ", since it is not a distributed_epoch iteration.");
     }
+    std::shared_ptr<const Task> task;
+    if (state_.TaskFromId(request->task_id(), task).ok() &&
+        IsWorkerDrained(task->worker_address)) {
+      response->set_end_of_splits(true);
+      VLOG(3) << "Returning end_of_splits since task " << task->task_id
+              << " is on draining worker " << task->worker_address;
+      return absl::OkStatus();
+    }
     current_repetition =
         iteration->distributed_epoch_state.value().repetitions[provider_index];
     if (request->repetition() < current_repetition) {
@@ -907,8 +942,15 @@ Status DataServiceDispatcherImpl::CreateTasksForWorker(
     const std::string& worker_address) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
   std::vector<std::shared_ptr<const Iteration>> iterations =
       state_.ListIterations();
+  std::vector<std::shared_ptr<const Task>> existing_tasks;
+  TF_RETURN_IF_ERROR(state_.TasksForWorker(worker_address, existing_tasks));
+  absl::flat_hash_set<int64_t> existing_iteration_ids;
+  for (const auto& task : existing_tasks) {
+    existing_iteration_ids.insert(task->iteration->iteration_id);
+  }
   for (const auto& iteration : iterations) {
-    if (iteration->finished) {
+    if (iteration->finished ||
+        existing_iteration_ids.contains(iteration->iteration_id)) {
       continue;
     }
     if (iteration->job->num_consumers.has_value()) {
@@ -943,7 +985,12 @@ Status DataServiceDispatcherImpl::CreateTasksForIteration(
   std::vector<std::shared_ptr<const Worker>> workers = state_.ListWorkers();
   tasks.clear();
   tasks.reserve(workers.size());
+  const bool static_sharding =
+      IsStaticShard(iteration->job->processing_mode);
   for (const auto& worker : workers) {
+    if (!static_sharding && IsWorkerDrained(worker->address)) {
+      continue;
+    }
     std::shared_ptr<const Task> task;
     TF_RETURN_IF_ERROR(CreateTask(iteration, worker->address, task));
     tasks.push_back(task);
@@ -1085,6 +1132,8 @@ Status DataServiceDispatcherImpl::ClientHeartbeat(
         "Consider configuring the dispatcher with a higher "
         "`iteration_gc_timeout_ms`.");
   }
+  get_next_calls_ += request->get_next_calls();
+  buffer_empty_get_next_calls_ += request->buffer_empty_get_next_calls();
   if (request->optional_current_round_case() ==
       ClientHeartbeatRequest::kCurrentRound) {
     round_robin_rounds_[request->iteration_client_id()] =
@@ -1286,7 +1335,9 @@ Status DataServiceDispatcherImpl::DisableCompressionAtRuntime(
   mutex_lock l(mu_);
   TF_RETURN_IF_ERROR(state_.DatasetFromId(request->dataset_id(), dataset));
   if (dataset->metadata.compression() !=
-      DataServiceMetadata::COMPRESSION_SNAPPY) {
+          DataServiceMetadata::COMPRESSION_SNAPPY &&
+      dataset->metadata.compression() !=
+          DataServiceMetadata::COMPRESSION_COLUMNAR) {
     response->set_no_compression_to_disable(true);
     return absl::OkStatus();
   }
@@ -1394,30 +1445,38 @@ void DataServiceDispatcherImpl::MaintenanceThread() {
     if (cancelled_) {
       return;
     }
-    {
-      Status s = ReleaseMissingClients();
-      if (!s.ok()) {
-        LOG(WARNING) << "Error releasing missing clients: " << s;
+    if (config_.job_gc_timeout_ms() >= 0) {
+      {
+        Status s = ReleaseMissingClients();
+        if (!s.ok()) {
+          LOG(WARNING) << "Error releasing missing clients: " << s;
+        }
       }
-    }
-    {
-      Status s = auto_scaler_.UpdateOptimalNumberOfWorkersMetric(
-          state_.GetNumberOfRegisteredWorkers());
-      if (!s.ok()) {
-        VLOG(1) << "Error updating the optimal number of workers metric "
-                   "in tf.data service AutoScaler: "
-                << s;
+      {
+        Status s = auto_scaler_.UpdateOptimalNumberOfWorkersMetric(
+            state_.GetNumberOfRegisteredWorkers());
+        if (!s.ok()) {
+          VLOG(1) << "Error updating the optimal number of workers metric "
+                     "in tf.data service AutoScaler: "
+                  << s;
+        }
       }
-    }
-    {
-      Status s = GcOldIterations();
-      if (!s.ok()) {
-        LOG(WARNING) << "Error garbage collecting old iterations: " << s;
+      {
+        Status s = GcOldIterations();
+        if (!s.ok()) {
+          LOG(WARNING) << "Error garbage collecting old iterations: " << s;
+        }
       }
     }
     DetectMissingWorkers();
+    absl::Duration check_interval =
+        absl::Milliseconds(config_.job_gc_check_interval_ms());
+    if (worker_orchestrator_) {
+      ScaleWorkers();
+      check_interval = std::min(check_interval, kAutoScalingCheckInterval);
+    }
     next_check_micros =
-        env_->NowMicros() + (config_.job_gc_check_interval_ms() * 1000);
+        env_->NowMicros() + absl::ToInt64Microseconds(check_interval);
   }
 }
 
@@ -1491,6 +1550,10 @@ void DataServiceDispatcherImpl::DetectMissingWorkers()
         it->second + absl::Milliseconds(config_.worker_timeout_ms())) {
       LOG(INFO) << "Lost worker " << it->first << " due to timeout";
       RemoveWorkerFromAutoScaler(it->first);
+      if (draining_workers_.erase(it->first) ||
+          drained_workers_.erase(it->first)) {
+        removed_workers_.insert(it->first);
+      }
 
       latest_worker_heartbeats_time_.erase(it++);
     } else {
@@ -1499,6 +1562,129 @@ void DataServiceDispatcherImpl::DetectMissingWorkers()
   }
 }
 
+void DataServiceDispatcherImpl::ScaleWorkers()
+    TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  RemoveDrainedWorkers();
+  int64_t current_workers = 0;
+  for (const auto& [worker_address, unused] : latest_worker_heartbeats_time_) {
+    if (!IsWorkerDrained(worker_address)) {
+      ++current_workers;
+    }
+  }
+  const int64_t delta = worker_scaling_policy_->GetWorkerDelta(
+      current_workers, auto_scaler_.GetOptimalNumberOfWorkers(),
+      get_next_calls_, buffer_empty_get_next_calls_,
+      absl::FromUnixMicros(env_->NowMicros()));
+  get_next_calls_ = 0;
+  buffer_empty_get_next_calls_ = 0;
+  if (delta > 0) {
+    Status s = worker_orchestrator_->AddWorkers(delta);
+    if (!s.ok()) {
+      LOG(WARNING) << "Failed to add " << delta << " tf.data service workers: "
+                   << s;
+    }
+  } else if (delta < 0) {
+    Status s = DrainWorkers(-delta);
+    if (!s.ok()) {
+      LOG(WARNING) << "Failed to drain " << -delta
+                   << " tf.data service workers: " << s;
+    }
+  }
+}
+
+Status DataServiceDispatcherImpl::DrainWorkers(int64_t num_workers)
+    TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  const absl::Time now = absl::FromUnixMicros(env_->NowMicros());
+  int64_t num_draining = 0;
+  for (const auto& worker : state_.ListWorkers()) {
+    if (num_draining == num_workers) {
+      break;
+    }
+    const std::string& worker_address = worker->address;
+    if (!latest_worker_heartbeats_time_.contains(worker_address) ||
+        IsWorkerDrained(worker_address) || !CanDrainWorker(worker_address)) {
+      continue;
+    }
+    RemoveWorkerFromAutoScaler(worker_address);
+    std::vector<std::shared_ptr<const Task>> tasks;
+    TF_RETURN_IF_ERROR(state_.TasksForWorker(worker_address, tasks));
+    for (const auto& task : tasks) {
+      // Other workers produce the same data, so clients can stop reading from
+      // this task right away. Tasks of dynamic sharding iterations finish once
+      // `GetSplit` stops returning splits to them.
+      if (!task->finished && IsNoShard(task->iteration->job->processing_mode)) {
+        Update update;
+        update.mutable_remove_task()->set_task_id(task->task_id);
+        TF_RETURN_IF_ERROR(Apply(update));
+      }
+    }
+    LOG(INFO) << "Draining tf.data service worker " << worker_address;
+    draining_workers_[worker_address] = now;
+    ++num_draining;
+  }
+  if (num_draining < num_workers) {
+    VLOG(1) << "Only " << num_draining << " of " << num_workers
+            << " tf.data service workers can be drained without restarting "
+               "iterations";
+  }
+  return absl::OkStatus();
+}
+
+bool DataServiceDispatcherImpl::CanDrainWorker(
+    const std::string& worker_address) const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  std::vector<std::shared_ptr<const Task>> tasks;
+  if (!state_.TasksForWorker(worker_address, tasks).ok()) {
+    return false;
+  }
+  for (const auto& task : tasks) {
+    if (task->finished) {
+      continue;
+    }
+    if (task->iteration->IsRoundRobin() ||
+        IsStaticShard(task->iteration->job->processing_mode)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void DataServiceDispatcherImpl::RemoveDrainedWorkers()
+    TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  const absl::Time now = absl::FromUnixMicros(env_->NowMicros());
+  for (auto it = draining_workers_.begin(); it != draining_workers_.end();) {
+    const std::string& worker_address = it->first;
+    std::vector<std::shared_ptr<const Task>> tasks;
+    bool finished = true;
+    if (state_.TasksForWorker(worker_address, tasks).ok()) {
+      finished = absl::c_all_of(
+          tasks, [](const auto& task) { return task->finished; });
+    }
+    if (!finished &&
+        now < it->second + absl::Milliseconds(config_.worker_timeout_ms())) {
+      ++it;
+      continue;
+    }
+    if (!finished) {
+      LOG(WARNING) << "tf.data service worker " << worker_address
+                   << " did not finish its tasks while draining. Removing it "
+                      "anyway.";
+    }
+    Status s = worker_orchestrator_->RemoveWorker(worker_address);
+    if (!s.ok()) {
+      LOG(WARNING) << "Failed to remove tf.data service worker "
+                   << worker_address << ": " << s;
+    }
+    drained_workers_.insert(worker_address);
+    draining_workers_.erase(it++);
+  }
+}
+
+bool DataServiceDispatcherImpl::IsWorkerDrained(
+    const std::string& worker_address) const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  return draining_workers_.contains(worker_address) ||
+         drained_workers_.contains(worker_address);
+}
+
 Status DataServiceDispatcherImpl::GcOldIterations()
     TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
   std::vector<std::shared_ptr<const Iteration>> iterations =
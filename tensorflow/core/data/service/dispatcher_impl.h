@@ -35,6 +35,7 @@ limitations under the License.
 #include "tensorflow/core/data/service/snapshot/snapshot_manager.h"
 #include "tensorflow/core/data/service/task_remover.h"
 #include "tensorflow/core/data/service/worker.grpc.pb.h"
+#include "tensorflow/core/data/service/worker_orchestrator.h"
 #include "tensorflow/core/framework/dataset.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/macros.h"
@@ -194,7 +195,8 @@ class DataServiceDispatcherImpl {
 
  private:
   // A thread which periodically checks for iterations to clean up, clients to
-  // release, workers to consider missing, and snapshot streams to reassign.
+  // release, workers to consider missing, snapshot streams to reassign, and
+  // workers to add or drain.
   void MaintenanceThread();
 
   // Restores split providers from the state in `iteration` and stores them in
@@ -332,6 +334,26 @@ class DataServiceDispatcherImpl {
   // Checks for workers that haven't heartbeated recently and alerts the
   // snapshot managers.
   void DetectMissingWorkers() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Asks `worker_orchestrator_` to add workers, or starts draining workers,
+  // when `worker_scaling_policy_` decides to.
+  void ScaleWorkers() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Starts draining up to `num_workers` workers: their tasks of no-sharding
+  // iterations are removed, and their tasks of dynamic-sharding iterations get
+  // no more splits. Workers running tasks for statically sharded or
+  // coordinated-read iterations are never drained, since their data can't be
+  // moved to other workers.
+  Status DrainWorkers(int64_t num_workers) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Returns true if the worker can be drained without restarting iterations.
+  bool CanDrainWorker(const std::string& worker_address) const
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Asks `worker_orchestrator_` to remove the draining workers which have
+  // finished their tasks, or which have been draining for longer than the
+  // worker timeout.
+  void RemoveDrainedWorkers() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Returns true if the worker is draining or drained, in which case it gets no
+  // new tasks or splits.
+  bool IsWorkerDrained(const std::string& worker_address) const
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
   // Scans for old iterations and marks them as finished.
   Status GcOldIterations() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
   // Returns true if an iteration should be garbage collected.
@@ -380,6 +402,25 @@ class DataServiceDispatcherImpl {
   absl::flat_hash_map<std::string, absl::Time> latest_worker_heartbeats_time_
       TF_GUARDED_BY(mu_);
 
+  // Adds and removes workers when a `worker_orchestrator` is configured.
+  std::unique_ptr<WorkerOrchestrator> worker_orchestrator_ TF_GUARDED_BY(mu_);
+  std::unique_ptr<WorkerScalingPolicy> worker_scaling_policy_
+      TF_GUARDED_BY(mu_);
+  // Client `GetNext` calls, and calls which found an empty buffer, reported
+  // since the last scaling decision.
+  int64_t get_next_calls_ TF_GUARDED_BY(mu_) = 0;
+  int64_t buffer_empty_get_next_calls_ TF_GUARDED_BY(mu_) = 0;
+  // Map from the address of each worker being drained to the time draining
+  // started.
+  absl::flat_hash_map<std::string, absl::Time> draining_workers_
+      TF_GUARDED_BY(mu_);
+  // Workers which `worker_orchestrator_` was asked to remove, but which are
+  // still heartbeating.
+  absl::flat_hash_set<std::string> drained_workers_ TF_GUARDED_BY(mu_);
+  // Drained workers which stopped heartbeating. If a worker comes back at one
+  // of these addresses, it gets tasks again.
+  absl::flat_hash_set<std::string> removed_workers_ TF_GUARDED_BY(mu_);
+
   // TODO(mpcallanan): Don't recover completed snapshots.
   // TODO(mpcallanan): Garbage collect completed snapshots.
   // A manager for each snapshot resumed or started during the lifetime of this
@@ -30,6 +30,7 @@ limitations under the License.
 #include "tensorflow/core/data/service/grpc_dispatcher_impl.h"
 #include "tensorflow/core/data/service/grpc_util.h"
 #include "tensorflow/core/data/service/grpc_worker_impl.h"
+#include "tensorflow/core/data/service/shm_data_transfer.h"
 #include "tensorflow/core/data/service/worker_client.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/str_util.h"
@@ -179,7 +180,11 @@ WorkerGrpcDataServer::WorkerGrpcDataServer(
                          std::move(options)),
       config_(config) {}
 
-WorkerGrpcDataServer::~WorkerGrpcDataServer() { delete service_; }
+WorkerGrpcDataServer::~WorkerGrpcDataServer() {
+  // The transfer server calls into `service_`.
+  shm_transfer_server_.reset();
+  delete service_;
+}
 
 void WorkerGrpcDataServer::AddDataServiceToBuilder(
     ::grpc::ServerBuilder& builder) {
@@ -232,6 +237,33 @@ void WorkerGrpcDataServer::MaybeStartAlternativeDataTransferServer(
   transfer_servers.push_back(alternative_transfer_server);
 }
 
+void WorkerGrpcDataServer::MaybeStartShmDataTransferServer(
+    std::vector<DataTransferServerInfo>& transfer_servers) {
+  if (!ShmTransferEnabled() ||
+      config_.data_transfer_protocol() == kShmTransferProtocol) {
+    return;
+  }
+  Status s = DataTransferServer::Build(
+      kShmTransferProtocol, service_->get_element_getter(),
+      &shm_transfer_server_);
+  if (s.ok()) {
+    s = shm_transfer_server_->Start(config_);
+  }
+  if (!s.ok()) {
+    LOG(ERROR) << "failed to start " << kShmTransferProtocol
+               << " server for worker " << config_.worker_address() << ": "
+               << s;
+    shm_transfer_server_.reset();
+    return;
+  }
+  // The server only listens on the loopback interface.
+  DataTransferServerInfo shm_transfer_server;
+  shm_transfer_server.set_protocol(kShmTransferProtocol);
+  shm_transfer_server.set_address(
+      absl::StrCat("localhost:", shm_transfer_server_->Port()));
+  transfer_servers.push_back(shm_transfer_server);
+}
+
 Status WorkerGrpcDataServer::StartServiceInternal() {
   std::string base_address = config_.worker_address();
   if (base_address.empty()) {
@@ -245,11 +277,15 @@ Status WorkerGrpcDataServer::StartServiceInternal() {
   grpc_transfer_server.set_address(worker_address);
   std::vector<DataTransferServerInfo> transfer_servers = {grpc_transfer_server};
   MaybeStartAlternativeDataTransferServer(transfer_servers);
+  MaybeStartShmDataTransferServer(transfer_servers);
   TF_RETURN_IF_ERROR(service_->Start(worker_address, transfer_servers));
   return absl::OkStatus();
 }
 
-void WorkerGrpcDataServer::StopServiceInternal() { service_->Stop(); }
+void WorkerGrpcDataServer::StopServiceInternal() {
+  service_->Stop();
+  shm_transfer_server_.reset();
+}
 
 Status WorkerGrpcDataServer::NumTasks(int* num_tasks) {
   GetWorkerTasksRequest req;
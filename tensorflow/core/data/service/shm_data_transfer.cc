@@ -0,0 +1,771 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/shm_data_transfer.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/memory/memory.h"
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "absl/strings/strip.h"
+#include "tensorflow/core/data/service/data_transfer.h"
+#include "tensorflow/core/data/service/shm_data_transfer.pb.h"
+#include "tensorflow/core/data/service/worker.pb.h"
+#include "tensorflow/core/framework/allocation_description.pb.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/dataset.pb.h"
+#include "tensorflow/core/framework/metrics.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/framework/variant.h"
+#include "tensorflow/core/lib/random/random.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/host_info.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/protobuf.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/strcat.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/protobuf/service_config.pb.h"
+#include "tensorflow/core/util/env_var.h"
+
+#if !defined(PLATFORM_WINDOWS)
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif  // !defined(PLATFORM_WINDOWS)
+
+namespace tensorflow {
+namespace data {
+
+bool ShmTransferEnabled() {
+  bool enabled = false;
+  Status s = ReadBoolFromEnvVar("TF_DATA_SERVICE_SHM_TRANSFER",
+                                /*default_val=*/false, &enabled);
+  if (!s.ok()) {
+    LOG(WARNING) << s;
+  }
+  return enabled;
+}
+
+bool IsLocalAddress(absl::string_view address) {
+  absl::string_view host = address.substr(0, address.rfind(':'));
+  if (absl::ConsumePrefix(&host, "[")) {
+    absl::ConsumeSuffix(&host, "]");
+  }
+  return host == "localhost" || host == "127.0.0.1" || host == "::1" ||
+         host == port::Hostname();
+}
+
+#if !defined(PLATFORM_WINDOWS)
+namespace {
+
+// Default number and size of the slots of a client. The memory of a slot is
+// only committed once an element is written to it.
+constexpr int64_t kDefaultNumSlots = 8;
+constexpr int64_t kDefaultSlotBytes = 64 << 20;
+
+// The largest messages read by the server, which are handshakes and requests,
+// and by the client, whose responses may hold an element inline. A corrupted
+// or malicious frame length must not make either allocate more.
+constexpr uint64_t kMaxRequestBytes = 1 << 20;
+constexpr uint64_t kMaxResponseBytes = std::numeric_limits<int32_t>::max();
+
+// Reads or writes exactly `size` bytes of a socket.
+Status ReadFully(int fd, char* data, size_t size) {
+  while (size > 0) {
+    const ssize_t n = read(fd, data, size);
+    if (n == 0) {
+      return errors::Unavailable("Shared-memory transfer connection closed.");
+    }
+    if (n < 0) {
+      if (errno == EINTR) continue;
+      return errors::IOError("Failed to read from transfer socket", errno);
+    }
+    data += n;
+    size -= n;
+  }
+  return absl::OkStatus();
+}
+
+Status WriteFully(int fd, const char* data, size_t size) {
+  while (size > 0) {
+    const ssize_t n = send(fd, data, size, MSG_NOSIGNAL);
+    if (n < 0) {
+      if (errno == EINTR) continue;
+      return errors::IOError("Failed to write to transfer socket", errno);
+    }
+    data += n;
+    size -= n;
+  }
+  return absl::OkStatus();
+}
+
+// Messages are framed by their length as a 64-bit integer in host byte order,
+// since both ends run on the same host.
+Status WriteMessage(int fd, const protobuf::Message& message) {
+  std::string serialized;
+  if (!message.SerializeToString(&serialized)) {
+    return errors::Internal("Failed to serialize ", message.GetTypeName());
+  }
+  const uint64_t size = serialized.size();
+  TF_RETURN_IF_ERROR(
+      WriteFully(fd, reinterpret_cast<const char*>(&size), sizeof(size)));
+  return WriteFully(fd, serialized.data(), serialized.size());
+}
+
+Status ReadMessage(int fd, uint64_t max_size, protobuf::Message* message) {
+  uint64_t size = 0;
+  TF_RETURN_IF_ERROR(
+      ReadFully(fd, reinterpret_cast<char*>(&size), sizeof(size)));
+  if (size > max_size) {
+    return errors::DataLoss("Shared-memory transfer message of ", size,
+                            " bytes for ", message->GetTypeName(),
+                            " exceeds the limit of ", max_size, " bytes.");
+  }
+  std::string serialized(size, '\0');
+  TF_RETURN_IF_ERROR(ReadFully(fd, serialized.data(), size));
+  if (!message->ParseFromString(serialized)) {
+    return errors::DataLoss("Failed to parse ", message->GetTypeName());
+  }
+  return absl::OkStatus();
+}
+
+// Prefix of the names of the shared memory objects created by clients. The
+// server only opens objects with this prefix, so that a local process cannot
+// make it write to any other shared memory object of its user.
+constexpr absl::string_view kRingNamePrefix = "/tf_data_shm_";
+
+int64_t RoundUp(int64_t value, int64_t multiple) {
+  return (value + multiple - 1) / multiple * multiple;
+}
+
+// A ring of slots in a POSIX shared memory object.
+class ShmRing {
+ public:
+  // Creates a new shared memory object. It is unlinked by `Unlink()` or the
+  // destructor, whichever comes first.
+  static Status Create(int64_t num_slots, int64_t slot_bytes,
+                       std::unique_ptr<ShmRing>* out) {
+    const std::string name =
+        strings::StrCat(kRingNamePrefix, getpid(), "_",
+                        strings::Hex(random::New64()));
+    const int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0) {
+      return errors::IOError(absl::StrCat("Failed to create ", name), errno);
+    }
+    std::unique_ptr<ShmRing> ring(new ShmRing(name, num_slots, slot_bytes));
+    ring->linked_ = true;
+    if (ftruncate(fd, ring->size()) != 0) {
+      const int error = errno;
+      close(fd);
+      return errors::IOError(absl::StrCat("Failed to resize ", name), error);
+    }
+    TF_RETURN_IF_ERROR(ring->Map(fd));
+    *out = std::move(ring);
+    return absl::OkStatus();
+  }
+
+  // Maps an existing shared memory object.
+  static Status Open(const ShmTransferHandshake& handshake,
+                     std::unique_ptr<ShmRing>* out) {
+    const std::string& name = handshake.ring_name();
+    if (!absl::StartsWith(name, kRingNamePrefix) ||
+        name.find('/', 1) != std::string::npos) {
+      return errors::InvalidArgument("Invalid shared memory object name ",
+                                     name, ".");
+    }
+    if (handshake.num_slots() <= 0 || handshake.slot_bytes() <= 0 ||
+        handshake.num_slots() >
+            std::numeric_limits<int64_t>::max() / handshake.slot_bytes()) {
+      return errors::InvalidArgument("Invalid ring of ", handshake.num_slots(),
+                                     " slots of ", handshake.slot_bytes(),
+                                     " bytes.");
+    }
+    const int fd = shm_open(name.c_str(), O_RDWR, 0600);
+    if (fd < 0) {
+      return errors::IOError(absl::StrCat("Failed to open ", name), errno);
+    }
+    std::unique_ptr<ShmRing> ring(
+        new ShmRing(name, handshake.num_slots(), handshake.slot_bytes()));
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < ring->size()) {
+      close(fd);
+      return errors::InvalidArgument(name, " is smaller than ", ring->size(),
+                                     " bytes.");
+    }
+    TF_RETURN_IF_ERROR(ring->Map(fd));
+    *out = std::move(ring);
+    return absl::OkStatus();
+  }
+
+  ~ShmRing() {
+    if (base_ != nullptr) {
+      munmap(base_, size());
+    }
+    Unlink();
+  }
+
+  // Removes the name of the shared memory object. The memory stays mapped
+  // until both ends have destroyed their ring.
+  void Unlink() {
+    if (linked_) {
+      shm_unlink(name_.c_str());
+      linked_ = false;
+    }
+  }
+
+  const std::string& name() const { return name_; }
+  int64_t num_slots() const { return num_slots_; }
+  int64_t slot_bytes() const { return slot_bytes_; }
+  int64_t size() const { return num_slots_ * slot_bytes_; }
+  char* slot(int64_t index) const { return base_ + index * slot_bytes_; }
+
+ private:
+  ShmRing(std::string name, int64_t num_slots, int64_t slot_bytes)
+      : name_(std::move(name)),
+        num_slots_(num_slots),
+        slot_bytes_(slot_bytes) {}
+
+  Status Map(int fd) {
+    void* base =
+        mmap(nullptr, size(), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    const int error = errno;
+    close(fd);
+    if (base == MAP_FAILED) {
+      return errors::IOError(absl::StrCat("Failed to map ", name_), error);
+    }
+    base_ = static_cast<char*>(base);
+    return absl::OkStatus();
+  }
+
+  const std::string name_;
+  const int64_t num_slots_;
+  const int64_t slot_bytes_;
+  char* base_ = nullptr;
+  bool linked_ = false;
+};
+
+// Tracks the slots of a client ring that are not aliased by any tensor.
+class SlotPool {
+ public:
+  explicit SlotPool(std::unique_ptr<ShmRing> ring) : ring_(std::move(ring)) {
+    for (int64_t i = ring_->num_slots() - 1; i >= 0; --i) {
+      free_slots_.push_back(i);
+    }
+  }
+
+  ShmRing& ring() const { return *ring_; }
+
+  // Returns a free slot, or -1 if all slots are in use.
+  int64_t TryAcquire() {
+    mutex_lock l(mu_);
+    if (free_slots_.empty()) {
+      return -1;
+    }
+    const int64_t slot = free_slots_.back();
+    free_slots_.pop_back();
+    return slot;
+  }
+
+  void Release(int64_t slot) {
+    mutex_lock l(mu_);
+    free_slots_.push_back(slot);
+  }
+
+ private:
+  const std::unique_ptr<ShmRing> ring_;
+  mutex mu_;
+  std::vector<int64_t> free_slots_ TF_GUARDED_BY(mu_);
+};
+
+// Holds a slot until all the tensors of the element in it are destroyed.
+class SlotLease {
+ public:
+  SlotLease(std::shared_ptr<SlotPool> pool, int64_t slot)
+      : pool_(std::move(pool)), slot_(slot) {}
+  ~SlotLease() { pool_->Release(slot_); }
+
+  char* data() const { return pool_->ring().slot(slot_); }
+
+ private:
+  const std::shared_ptr<SlotPool> pool_;
+  const int64_t slot_;
+};
+
+// A tensor buffer aliasing a component in a slot.
+class ShmTensorBuffer : public TensorBuffer {
+ public:
+  ShmTensorBuffer(std::shared_ptr<SlotLease> lease, uint64_t offset,
+                  size_t size)
+      : TensorBuffer(lease->data() + offset),
+        lease_(std::move(lease)),
+        size_(size) {}
+
+  size_t size() const override { return size_; }
+  TensorBuffer* root_buffer() override { return this; }
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(size_);
+    proto->set_allocator_name("shm_data_transfer");
+  }
+  bool OwnsMemory() const override { return false; }
+
+ private:
+  const std::shared_ptr<SlotLease> lease_;
+  const size_t size_;
+};
+
+// Writes `components` to `slot` and describes them in `response`. Returns
+// false, without writing anything, if they can not be written to the slot.
+bool WriteToSlot(const std::vector<Tensor>& components, char* slot,
+                 int64_t slot_bytes, ShmTransferResponse& response) {
+  uint64_t end = 0;
+  for (const Tensor& component : components) {
+    if (!DataTypeCanUseMemcpy(component.dtype())) {
+      return false;
+    }
+    end = RoundUp(end, Allocator::kAllocatorAlignment) +
+          component.tensor_data().size();
+  }
+  if (end > slot_bytes) {
+    return false;
+  }
+  uint64_t offset = 0;
+  for (const Tensor& component : components) {
+    const absl::string_view data = component.tensor_data();
+    offset = RoundUp(offset, Allocator::kAllocatorAlignment);
+    std::memcpy(slot + offset, data.data(), data.size());
+    ShmTransferResponse::Component* descriptor = response.add_components();
+    descriptor->set_dtype(component.dtype());
+    component.shape().AsProto(descriptor->mutable_shape());
+    descriptor->set_offset(offset);
+    descriptor->set_size(data.size());
+    offset += data.size();
+  }
+  return true;
+}
+
+// Same as the gRPC worker: moves a compressed element as is, and serializes
+// other elements as TensorProtos.
+Status MoveElementToResponse(std::vector<Tensor>&& element,
+                             GetElementResponse& resp) {
+  if (element.size() != 1 || element[0].dtype() != DT_VARIANT ||
+      !TensorShapeUtils::IsScalar(element[0].shape())) {
+    for (const auto& component : element) {
+      UncompressedElement* uncompressed = resp.mutable_uncompressed();
+      component.AsProtoTensorContent(uncompressed->add_components());
+    }
+    return absl::OkStatus();
+  }
+  Variant& variant = element[0].scalar<Variant>()();
+  CompressedElement* compressed = variant.get<CompressedElement>();
+  if (compressed == nullptr) {
+    return errors::FailedPrecondition(
+        "Expected dataset to produce a CompressedElement variant tensor, but "
+        "it produced ",
+        variant.TypeName());
+  }
+  *resp.mutable_compressed() = *compressed;
+  return absl::OkStatus();
+}
+
+class ShmDataTransferServer : public DataTransferServer {
+ public:
+  explicit ShmDataTransferServer(GetElementT get_element)
+      : get_element_(std::move(get_element)) {}
+
+  ~ShmDataTransferServer() override {
+    {
+      mutex_lock l(mu_);
+      cancelled_ = true;
+      if (listen_fd_ >= 0) {
+        shutdown(listen_fd_, SHUT_RDWR);
+      }
+      for (int fd : connection_fds_) {
+        shutdown(fd, SHUT_RDWR);
+      }
+    }
+    // Joins the threads, the connection ones outside of `mu_`, which they
+    // acquire as they exit.
+    accept_thread_.reset();
+    absl::flat_hash_map<int64_t, std::unique_ptr<Thread>> connection_threads;
+    {
+      mutex_lock l(mu_);
+      connection_threads.swap(connection_threads_);
+    }
+    connection_threads.clear();
+    if (listen_fd_ >= 0) {
+      close(listen_fd_);
+    }
+  }
+
+  Status Start(const experimental::WorkerConfig& config) override {
+    // Only clients on this host may connect.
+    listen_fd_ = socket(AF_INET, SOCK_STREAM, 0);
+    if (listen_fd_ < 0) {
+      return errors::IOError("Failed to create transfer socket", errno);
+    }
+    sockaddr_in addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0;
+    socklen_t addr_len = sizeof(addr);
+    if (bind(listen_fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) !=
+            0 ||
+        listen(listen_fd_, SOMAXCONN) != 0 ||
+        getsockname(listen_fd_, reinterpret_cast<sockaddr*>(&addr),
+                    &addr_len) != 0) {
+      return errors::IOError("Failed to listen on transfer socket", errno);
+    }
+    port_ = ntohs(addr.sin_port);
+    accept_thread_ = absl::WrapUnique(Env::Default()->StartThread(
+        {}, "tf_data_shm_transfer_accept", [this]() { AcceptLoop(); }));
+    return absl::OkStatus();
+  }
+
+  int Port() const override { return port_; }
+
+ private:
+  void AcceptLoop() {
+    while (true) {
+      const int fd = accept(listen_fd_, nullptr, nullptr);
+      const int accept_errno = errno;
+      // The threads of the closed connections, joined once `mu_` is released.
+      std::vector<std::unique_ptr<Thread>> finished_threads;
+      {
+        mutex_lock l(mu_);
+        if (cancelled_) {
+          if (fd >= 0) close(fd);
+          return;
+        }
+        if (fd < 0) {
+          if (accept_errno == EINTR || accept_errno == ECONNABORTED) continue;
+          LOG(ERROR) << errors::IOError("Failed to accept transfer connection",
+                                        accept_errno);
+          return;
+        }
+        for (int64_t id : finished_connections_) {
+          auto it = connection_threads_.find(id);
+          finished_threads.push_back(std::move(it->second));
+          connection_threads_.erase(it);
+        }
+        finished_connections_.clear();
+        const int64_t id = next_connection_id_++;
+        connection_fds_.push_back(fd);
+        connection_threads_[id] = absl::WrapUnique(Env::Default()->StartThread(
+            {}, "tf_data_shm_transfer_connection", [this, fd, id]() {
+              Status s = Serve(fd);
+              VLOG(2) << "Shared-memory transfer connection closed: " << s;
+              mutex_lock l(mu_);
+              connection_fds_.erase(std::find(connection_fds_.begin(),
+                                              connection_fds_.end(), fd));
+              close(fd);
+              finished_connections_.push_back(id);
+            }));
+      }
+    }
+  }
+
+  // Serves the requests of a connection until it is closed.
+  Status Serve(int fd) {
+    ShmTransferHandshake handshake;
+    TF_RETURN_IF_ERROR(ReadMessage(fd, kMaxRequestBytes, &handshake));
+    std::unique_ptr<ShmRing> ring;
+    Status s = ShmRing::Open(handshake, &ring);
+    ShmTransferResponse handshake_response;
+    handshake_response.set_status_code(static_cast<int32_t>(s.code()));
+    handshake_response.set_status_message(std::string(s.message()));
+    TF_RETURN_IF_ERROR(WriteMessage(fd, handshake_response));
+    TF_RETURN_IF_ERROR(s);
+
+    while (true) {
+      ShmTransferRequest request;
+      TF_RETURN_IF_ERROR(ReadMessage(fd, kMaxRequestBytes, &request));
+      ShmTransferResponse response;
+      s = HandleRequest(*ring, request, response);
+      if (!s.ok()) {
+        response.Clear();
+        response.set_status_code(static_cast<int32_t>(s.code()));
+        response.set_status_message(std::string(s.message()));
+      }
+      TF_RETURN_IF_ERROR(WriteMessage(fd, response));
+    }
+  }
+
+  Status HandleRequest(const ShmRing& ring, const ShmTransferRequest& request,
+                       ShmTransferResponse& response) {
+    GetElementResult result;
+    TF_RETURN_IF_ERROR(get_element_(&request.request(), &result));
+    GetElementResponse& element = *response.mutable_response();
+    element.set_element_index(result.element_index);
+    element.set_end_of_sequence(result.end_of_sequence);
+    element.set_skip_task(result.skip);
+    if (result.end_of_sequence || result.skip) {
+      return absl::OkStatus();
+    }
+    if (request.slot() >= 0 && request.slot() < ring.num_slots() &&
+        WriteToSlot(result.components, ring.slot(request.slot()),
+                    ring.slot_bytes(), response)) {
+      return absl::OkStatus();
+    }
+    return MoveElementToResponse(std::move(result.components), element);
+  }
+
+  const GetElementT get_element_;
+  int listen_fd_ = -1;
+  int port_ = 0;
+  std::unique_ptr<Thread> accept_thread_;
+
+  mutex mu_;
+  bool cancelled_ TF_GUARDED_BY(mu_) = false;
+  std::vector<int> connection_fds_ TF_GUARDED_BY(mu_);
+  // The threads serving the connections, by connection id. A thread adds its
+  // id to `finished_connections_` as it exits, and is joined when the next
+  // connection is accepted.
+  absl::flat_hash_map<int64_t, std::unique_ptr<Thread>> connection_threads_
+      TF_GUARDED_BY(mu_);
+  std::vector<int64_t> finished_connections_ TF_GUARDED_BY(mu_);
+  int64_t next_connection_id_ TF_GUARDED_BY(mu_) = 0;
+};
+
+class ShmDataTransferClient : public DataTransferClient {
+ public:
+  ~ShmDataTransferClient() override {
+    if (fd_ >= 0) {
+      close(fd_);
+    }
+  }
+
+  static Status Create(const std::string& address,
+                       std::unique_ptr<DataTransferClient>* out) {
+    int64_t num_slots = 0;
+    int64_t slot_bytes = 0;
+    TF_RETURN_IF_ERROR(ReadInt64FromEnvVar("TF_DATA_SERVICE_SHM_NUM_SLOTS",
+                                           kDefaultNumSlots, &num_slots));
+    TF_RETURN_IF_ERROR(ReadInt64FromEnvVar("TF_DATA_SERVICE_SHM_SLOT_BYTES",
+                                           kDefaultSlotBytes, &slot_bytes));
+    slot_bytes = RoundUp(slot_bytes, getpagesize());
+    std::unique_ptr<ShmRing> ring;
+    TF_RETURN_IF_ERROR(ShmRing::Create(num_slots, slot_bytes, &ring));
+
+    auto client = absl::WrapUnique(new ShmDataTransferClient());
+    TF_RETURN_IF_ERROR(client->Connect(address));
+    ShmTransferHandshake handshake;
+    handshake.set_ring_name(ring->name());
+    handshake.set_num_slots(ring->num_slots());
+    handshake.set_slot_bytes(ring->slot_bytes());
+    TF_RETURN_IF_ERROR(WriteMessage(client->fd_, handshake));
+    ShmTransferResponse response;
+    TF_RETURN_IF_ERROR(ReadMessage(client->fd_, kMaxResponseBytes, &response));
+    TF_RETURN_IF_ERROR(ToStatus(response));
+    // Both ends have mapped the ring, so it outlives the processes only as
+    // long as they do.
+    ring->Unlink();
+    client->slots_ = std::make_shared<SlotPool>(std::move(ring));
+    VLOG(2) << "Create ShmDataTransferClient for worker " << address << ".";
+    *out = std::move(client);
+    return absl::OkStatus();
+  }
+
+  Status GetElement(const GetElementRequest& req,
+                    GetElementResult& result) override {
+    VLOG(3) << "GetElement for task " << req.task_id()
+            << " from shared-memory worker server.";
+    mutex_lock l(mu_);
+    if (cancelled_) {
+      return errors::Cancelled("Client was cancelled.");
+    }
+    ShmTransferRequest request;
+    *request.mutable_request() = req;
+    request.set_slot(slots_->TryAcquire());
+    // Releases the slot unless the element is written to it.
+    std::shared_ptr<SlotLease> lease;
+    if (request.slot() >= 0) {
+      lease = std::make_shared<SlotLease>(slots_, request.slot());
+    }
+    int64_t start_time_us = env_->NowMicros();
+    ShmTransferResponse response;
+    Status s = WriteMessage(fd_, request);
+    if (s.ok()) {
+      s = ReadMessage(fd_, kMaxResponseBytes, &response);
+    }
+    if (!s.ok() && cancelled_) {
+      return errors::Cancelled("Client was cancelled.");
+    }
+    TF_RETURN_IF_ERROR(s);
+    int64_t end_time_us = env_->NowMicros();
+    TF_RETURN_IF_ERROR(ToStatus(response));
+    metrics::RecordTFDataServiceGetElementDuration(kShmTransferProtocol,
+                                                   end_time_us - start_time_us);
+
+    GetElementResponse& element = *response.mutable_response();
+    result.element_index = element.element_index();
+    result.end_of_sequence = element.end_of_sequence();
+    result.skip = element.skip_task();
+    if (response.components_size() > 0) {
+      if (lease == nullptr) {
+        return errors::Internal(
+            "The server wrote an element without a free slot.");
+      }
+      for (const ShmTransferResponse::Component& component :
+           response.components()) {
+        TF_RETURN_IF_ERROR(AppendComponent(component, lease, result));
+      }
+      return absl::OkStatus();
+    }
+    switch (element.element_case()) {
+      case GetElementResponse::kCompressed: {
+        Tensor tensor(DT_VARIANT, TensorShape{});
+        tensor.scalar<Variant>()() = std::move(*element.mutable_compressed());
+        result.components.push_back(tensor);
+        break;
+      }
+      case GetElementResponse::kUncompressed:
+        for (const auto& component : element.uncompressed().components()) {
+          result.components.emplace_back();
+          if (!result.components.back().FromProto(component)) {
+            return errors::Internal("Failed to parse tensor.");
+          }
+        }
+        break;
+      case GetElementResponse::ELEMENT_NOT_SET:
+        break;
+    }
+    return absl::OkStatus();
+  }
+
+  void TryCancel() override {
+    VLOG(2) << "Cancel ShmDataTransferClient.";
+    cancelled_ = true;
+    // Unblocks an outstanding request.
+    shutdown(fd_, SHUT_RDWR);
+  }
+
+ private:
+  ShmDataTransferClient() = default;
+
+  static Status ToStatus(const ShmTransferResponse& response) {
+    return Status(static_cast<absl::StatusCode>(response.status_code()),
+                  response.status_message());
+  }
+
+  Status Connect(const std::string& address) {
+    const size_t colon = address.rfind(':');
+    if (colon == std::string::npos) {
+      return errors::InvalidArgument("Invalid transfer server address ",
+                                     address);
+    }
+    const std::string host = address.substr(0, colon);
+    const std::string port = address.substr(colon + 1);
+    addrinfo hints;
+    std::memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* addrs = nullptr;
+    if (const int error =
+            getaddrinfo(host.c_str(), port.c_str(), &hints, &addrs);
+        error != 0) {
+      return errors::Unavailable("Failed to resolve ", address, ": ",
+                                 gai_strerror(error));
+    }
+    int connect_errno = 0;
+    for (addrinfo* addr = addrs; addr != nullptr; addr = addr->ai_next) {
+      fd_ = socket(addr->ai_family, addr->ai_socktype, addr->ai_protocol);
+      if (fd_ < 0) continue;
+      if (connect(fd_, addr->ai_addr, addr->ai_addrlen) == 0) break;
+      connect_errno = errno;
+      close(fd_);
+      fd_ = -1;
+    }
+    freeaddrinfo(addrs);
+    if (fd_ < 0) {
+      return errors::IOError(absl::StrCat("Failed to connect to ", address),
+                             connect_errno);
+    }
+    return absl::OkStatus();
+  }
+
+  Status AppendComponent(const ShmTransferResponse::Component& component,
+                         const std::shared_ptr<SlotLease>& lease,
+                         GetElementResult& result) {
+    TensorShape shape;
+    TF_RETURN_IF_ERROR(
+        TensorShape::BuildTensorShape(component.shape(), &shape));
+    if (component.offset() + component.size() > slots_->ring().slot_bytes() ||
+        shape.num_elements() * DataTypeSize(component.dtype()) !=
+            component.size()) {
+      return errors::DataLoss("Invalid component of ", component.size(),
+                              " bytes at offset ", component.offset());
+    }
+    if (component.size() == 0) {
+      result.components.emplace_back(component.dtype(), shape);
+      return absl::OkStatus();
+    }
+    auto* buffer =
+        new ShmTensorBuffer(lease, component.offset(), component.size());
+    result.components.emplace_back(component.dtype(), shape, buffer);
+    buffer->Unref();
+    return absl::OkStatus();
+  }
+
+  // Serializes the requests on the connection.
+  mutex mu_;
+  int fd_ = -1;
+  std::atomic<bool> cancelled_ = false;
+  std::shared_ptr<SlotPool> slots_;
+};
+
+class ShmTransferRegistrar {
+ public:
+  ShmTransferRegistrar() {
+    DataTransferServer::Register(
+        kShmTransferProtocol,
+        [](DataTransferServer::GetElementT get_element,
+           std::shared_ptr<DataTransferServer>* out) {
+          *out =
+              std::make_shared<ShmDataTransferServer>(std::move(get_element));
+          return absl::OkStatus();
+        });
+    DataTransferClient::Register(
+        kShmTransferProtocol, [](DataTransferClient::Config config,
+                                 std::unique_ptr<DataTransferClient>* out) {
+          return ShmDataTransferClient::Create(config.address, out);
+        });
+  }
+};
+static ShmTransferRegistrar shm_transfer_registrar;
+
+}  // namespace
+#endif  // !defined(PLATFORM_WINDOWS)
+
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,52 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_DATA_SERVICE_SHM_DATA_TRANSFER_H_
+#define TENSORFLOW_CORE_DATA_SERVICE_SHM_DATA_TRANSFER_H_
+
+#include "absl/strings/string_view.h"
+
+namespace tensorflow {
+namespace data {
+
+// A data transfer protocol for tf.data service workers running on the same
+// host as the trainer, but in a different process.
+//
+// Each client creates a POSIX shared memory object holding a ring of
+// fixed-size slots and shares its name with the server when it connects to
+// the server's loopback socket. Each GetElement request carries a free slot;
+// the server copies the components of the element into the slot and responds
+// with a descriptor of their dtypes, shapes and offsets. The client wraps the
+// components in tensors that alias the slot, without deserializing or copying
+// them, and the slot is reused once all these tensors are destroyed.
+//
+// Elements the server can not write to a slot, because the client has no free
+// slot, they do not fit, or they hold strings or variants, are sent inline in
+// the socket response as a `GetElementResponse`.
+//
+// The protocol is only available on POSIX platforms.
+constexpr const char kShmTransferProtocol[] = "shm";
+
+// Returns whether workers should start a shared-memory transfer server, as
+// set by the TF_DATA_SERVICE_SHM_TRANSFER environment variable.
+bool ShmTransferEnabled();
+
+// Returns whether `address`, of the form host:port, refers to this host.
+bool IsLocalAddress(absl::string_view address);
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_SERVICE_SHM_DATA_TRANSFER_H_
@@ -0,0 +1,295 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/shm_data_transfer.h"
+
+#include <netinet/in.h>
+#include <stdlib.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/data/service/data_transfer.h"
+#include "tensorflow/core/data/service/shm_data_transfer.pb.h"
+#include "tensorflow/core/data/service/worker.pb.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_description.pb.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/host_info.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/tstring.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+// Serves the elements of `elements` in order, then end of sequence.
+class TestServer {
+ public:
+  explicit TestServer(std::vector<std::vector<Tensor>> elements)
+      : elements_(std::move(elements)) {}
+
+  Status Start() {
+    TF_RETURN_IF_ERROR(DataTransferServer::Build(
+        kShmTransferProtocol,
+        [this](const GetElementRequest* request, GetElementResult* result) {
+          if (!status_.ok()) {
+            return status_;
+          }
+          result->element_index = next_;
+          if (next_ == elements_.size()) {
+            result->end_of_sequence = true;
+          } else {
+            result->components = elements_[next_++];
+          }
+          return absl::OkStatus();
+        },
+        &server_));
+    return server_->Start(/*config=*/{});
+  }
+
+  Status NewClient(std::unique_ptr<DataTransferClient>* client) {
+    return DataTransferClient::Build(
+        kShmTransferProtocol,
+        {"grpc", absl::StrCat("localhost:", server_->Port()),
+         /*accelerator_device_info=*/nullptr, /*allocator=*/nullptr},
+        client);
+  }
+
+  void set_status(Status status) { status_ = status; }
+
+  int port() const { return server_->Port(); }
+
+ private:
+  const std::vector<std::vector<Tensor>> elements_;
+  int64_t next_ = 0;
+  Status status_;
+  std::shared_ptr<DataTransferServer> server_;
+};
+
+// Connects to the server at `port`, sends `handshake` and returns the status
+// the server responds with.
+Status Handshake(int port, const ShmTransferHandshake& handshake) {
+  const int fd = socket(AF_INET, SOCK_STREAM, 0);
+  if (fd < 0) return errors::IOError("socket", errno);
+  sockaddr_in addr = {};
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  addr.sin_port = htons(port);
+  if (connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+    close(fd);
+    return errors::IOError("connect", errno);
+  }
+  const std::string request = handshake.SerializeAsString();
+  const uint64_t request_size = request.size();
+  uint64_t response_size = 0;
+  std::string response_bytes;
+  Status s;
+  if (write(fd, &request_size, sizeof(request_size)) !=
+          static_cast<ssize_t>(sizeof(request_size)) ||
+      write(fd, request.data(), request.size()) !=
+          static_cast<ssize_t>(request.size()) ||
+      read(fd, &response_size, sizeof(response_size)) !=
+          static_cast<ssize_t>(sizeof(response_size))) {
+    s = errors::Unavailable("Handshake failed");
+  } else {
+    response_bytes.resize(response_size);
+    if (read(fd, response_bytes.data(), response_size) !=
+        static_cast<ssize_t>(response_size)) {
+      s = errors::Unavailable("Handshake response truncated");
+    }
+  }
+  close(fd);
+  TF_RETURN_IF_ERROR(s);
+  ShmTransferResponse response;
+  if (!response.ParseFromString(response_bytes)) {
+    return errors::DataLoss("Failed to parse the handshake response");
+  }
+  return Status(static_cast<absl::StatusCode>(response.status_code()),
+                response.status_message());
+}
+
+std::string AllocatorName(const Tensor& tensor) {
+  TensorDescription description;
+  tensor.FillDescription(&description);
+  return description.allocation_description().allocator_name();
+}
+
+TEST(ShmDataTransferTest, TransfersElementsThroughSlots) {
+  TestServer server({{test::AsTensor<int64_t>({1, 2, 3}),
+                      test::AsTensor<float>({0.5}, {1, 1})},
+                     {test::AsScalar<int32_t>(7)}});
+  TF_ASSERT_OK(server.Start());
+  std::unique_ptr<DataTransferClient> client;
+  TF_ASSERT_OK(server.NewClient(&client));
+
+  GetElementResult first;
+  TF_ASSERT_OK(client->GetElement(GetElementRequest(), first));
+  ASSERT_EQ(first.components.size(), 2);
+  test::ExpectEqual(first.components[0], test::AsTensor<int64_t>({1, 2, 3}));
+  test::ExpectEqual(first.components[1],
+                    test::AsTensor<float>({0.5}, {1, 1}));
+  EXPECT_EQ(AllocatorName(first.components[0]), "shm_data_transfer");
+
+  GetElementResult second;
+  TF_ASSERT_OK(client->GetElement(GetElementRequest(), second));
+  ASSERT_EQ(second.components.size(), 1);
+  test::ExpectEqual(second.components[0], test::AsScalar<int32_t>(7));
+  EXPECT_EQ(second.element_index, 1);
+
+  GetElementResult end;
+  TF_ASSERT_OK(client->GetElement(GetElementRequest(), end));
+  EXPECT_TRUE(end.end_of_sequence);
+  EXPECT_TRUE(end.components.empty());
+}
+
+TEST(ShmDataTransferTest, SendsStringsInline) {
+  TestServer server({{test::AsTensor<tstring>({"a", "b"})}});
+  TF_ASSERT_OK(server.Start());
+  std::unique_ptr<DataTransferClient> client;
+  TF_ASSERT_OK(server.NewClient(&client));
+
+  GetElementResult result;
+  TF_ASSERT_OK(client->GetElement(GetElementRequest(), result));
+  ASSERT_EQ(result.components.size(), 1);
+  test::ExpectEqual(result.components[0],
+                    test::AsTensor<tstring>({"a", "b"}));
+  EXPECT_NE(AllocatorName(result.components[0]), "shm_data_transfer");
+}
+
+TEST(ShmDataTransferTest, ReusesSlotsOnceReleased) {
+  setenv("TF_DATA_SERVICE_SHM_NUM_SLOTS", "1", /*overwrite=*/1);
+  TestServer server({{test::AsScalar<int64_t>(0)},
+                     {test::AsScalar<int64_t>(1)},
+                     {test::AsScalar<int64_t>(2)}});
+  TF_ASSERT_OK(server.Start());
+  std::unique_ptr<DataTransferClient> client;
+  TF_ASSERT_OK(server.NewClient(&client));
+  unsetenv("TF_DATA_SERVICE_SHM_NUM_SLOTS");
+
+  auto first = std::make_unique<GetElementResult>();
+  TF_ASSERT_OK(client->GetElement(GetElementRequest(), *first));
+  EXPECT_EQ(AllocatorName(first->components[0]), "shm_data_transfer");
+
+  // The only slot is held by `first`.
+  GetElementResult second;
+  TF_ASSERT_OK(client->GetElement(GetElementRequest(), second));
+  test::ExpectEqual(second.components[0], test::AsScalar<int64_t>(1));
+  EXPECT_NE(AllocatorName(second.components[0]), "shm_data_transfer");
+
+  test::ExpectEqual(first->components[0], test::AsScalar<int64_t>(0));
+  first.reset();
+  GetElementResult third;
+  TF_ASSERT_OK(client->GetElement(GetElementRequest(), third));
+  test::ExpectEqual(third.components[0], test::AsScalar<int64_t>(2));
+  EXPECT_EQ(AllocatorName(third.components[0]), "shm_data_transfer");
+}
+
+TEST(ShmDataTransferTest, ReturnsServerErrors) {
+  TestServer server({});
+  server.set_status(errors::NotFound("No task"));
+  TF_ASSERT_OK(server.Start());
+  std::unique_ptr<DataTransferClient> client;
+  TF_ASSERT_OK(server.NewClient(&client));
+
+  GetElementResult result;
+  Status s = client->GetElement(GetElementRequest(), result);
+  EXPECT_TRUE(errors::IsNotFound(s)) << s;
+}
+
+TEST(ShmDataTransferTest, Cancel) {
+  TestServer server({});
+  TF_ASSERT_OK(server.Start());
+  std::unique_ptr<DataTransferClient> client;
+  TF_ASSERT_OK(server.NewClient(&client));
+  client->TryCancel();
+
+  GetElementResult result;
+  EXPECT_TRUE(
+      errors::IsCancelled(client->GetElement(GetElementRequest(), result)));
+}
+
+TEST(ShmDataTransferTest, ClosesConnectionsWithOversizedFrames) {
+  TestServer server({{test::AsScalar<int64_t>(0)}});
+  TF_ASSERT_OK(server.Start());
+
+  const int fd = socket(AF_INET, SOCK_STREAM, 0);
+  ASSERT_GE(fd, 0);
+  sockaddr_in addr = {};
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  addr.sin_port = htons(server.port());
+  ASSERT_EQ(connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)), 0);
+  // The server must not try to allocate the frame.
+  const uint64_t size = uint64_t{1} << 40;
+  ASSERT_EQ(write(fd, &size, sizeof(size)),
+            static_cast<ssize_t>(sizeof(size)));
+  char byte;
+  EXPECT_EQ(read(fd, &byte, 1), 0);
+  close(fd);
+
+  // The next connection is still served, and joins the closed one.
+  std::unique_ptr<DataTransferClient> client;
+  TF_ASSERT_OK(server.NewClient(&client));
+  GetElementResult result;
+  TF_ASSERT_OK(client->GetElement(GetElementRequest(), result));
+  test::ExpectEqual(result.components[0], test::AsScalar<int64_t>(0));
+}
+
+TEST(ShmDataTransferTest, RejectsForeignSharedMemoryObjects) {
+  TestServer server({{test::AsScalar<int64_t>(0)}});
+  TF_ASSERT_OK(server.Start());
+
+  ShmTransferHandshake handshake;
+  handshake.set_num_slots(1);
+  handshake.set_slot_bytes(getpagesize());
+  for (const char* name :
+       {"/some_other_object", "tf_data_shm_1", "/tf_data_shm_/../x"}) {
+    handshake.set_ring_name(name);
+    Status s = Handshake(server.port(), handshake);
+    EXPECT_TRUE(errors::IsInvalidArgument(s)) << name << ": " << s;
+  }
+}
+
+TEST(ShmDataTransferTest, RejectsOverflowingRingSizes) {
+  TestServer server({{test::AsScalar<int64_t>(0)}});
+  TF_ASSERT_OK(server.Start());
+
+  ShmTransferHandshake handshake;
+  handshake.set_ring_name("/tf_data_shm_overflow");
+  handshake.set_num_slots(int64_t{1} << 40);
+  handshake.set_slot_bytes(int64_t{1} << 40);
+  Status s = Handshake(server.port(), handshake);
+  EXPECT_TRUE(errors::IsInvalidArgument(s)) << s;
+}
+
+TEST(ShmDataTransferTest, IsLocalAddress) {
+  EXPECT_TRUE(IsLocalAddress("localhost:1234"));
+  EXPECT_TRUE(IsLocalAddress("127.0.0.1:1234"));
+  EXPECT_TRUE(IsLocalAddress("[::1]:1234"));
+  EXPECT_TRUE(IsLocalAddress(absl::StrCat(port::Hostname(), ":1234")));
+  EXPECT_FALSE(IsLocalAddress("remote-host-name.invalid:1234"));
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
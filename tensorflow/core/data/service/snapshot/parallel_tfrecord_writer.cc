@@ -29,8 +29,9 @@ limitations under the License.
 #include "absl/strings/str_cat.h"
 #include "absl/synchronization/mutex.h"
 #include "tensorflow/core/data/service/byte_size.h"
-#include "tensorflow/core/data/service/snapshot/utils.h"
 #include "tensorflow/core/data/snapshot_utils.h"
+#include "tensorflow/core/framework/metrics.h"
+#include "tensorflow/core/framework/model.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tsl/platform/env.h"
 #include "tsl/platform/errors.h"
@@ -42,18 +43,35 @@ limitations under the License.
 
 namespace tensorflow {
 namespace data {
+namespace {
 
-ParallelTFRecordWriter::ParallelTFRecordWriter(const std::string& file_prefix,
-                                               const std::string& compression,
-                                               tsl::Env* env,
-                                               ByteSize max_file_size,
-                                               int64_t num_write_threads,
-                                               int64_t buffer_size)
+// RAM budget for serialized records if the caller does not provide a
+// `RamBudgetManager`.
+constexpr ByteSize kDefaultSerializedBufferSize = ByteSize::GB(1);
+
+}  // namespace
+
+ParallelTFRecordWriter::ParallelTFRecordWriter(
+    const std::string& file_prefix, const std::string& compression,
+    tsl::Env* env, ByteSize max_file_size, int64_t num_write_threads,
+    int64_t buffer_size, int64_t num_serialization_threads,
+    std::shared_ptr<model::RamBudgetManager> ram_budget_manager)
     : env_(env),
       file_prefix_(file_prefix),
       compression_(compression),
       max_file_size_(max_file_size),
-      buffer_size_(buffer_size) {
+      buffer_size_(buffer_size),
+      ram_budget_manager_(
+          ram_budget_manager != nullptr
+              ? std::move(ram_budget_manager)
+              : std::make_shared<model::RamBudgetManager>(
+                    kDefaultSerializedBufferSize.ToUnsignedBytes())) {
+  serialization_thread_pool_ = std::make_unique<tsl::thread::ThreadPool>(
+      env_, tsl::ThreadOptions{}, "serialize_tfrecord_thread",
+      num_serialization_threads);
+  for (int64_t i = 0; i < num_serialization_threads; ++i) {
+    serialization_thread_pool_->Schedule([this]() { SerializeRecords(); });
+  }
   thread_pool_ = std::make_unique<tsl::thread::ThreadPool>(
       env_, tsl::ThreadOptions{}, "write_tfrecord_thread", num_write_threads);
   for (int64_t i = 0; i < num_write_threads; ++i) {
@@ -81,7 +99,7 @@ absl::Status ParallelTFRecordWriter::Write(std::vector<Tensor> record)
   }
 
   buffer_.push_back(std::move(record));
-  ready_to_pop_.Signal();
+  ready_to_serialize_.Signal();
   return absl::OkStatus();
 }
 
@@ -91,15 +109,108 @@ ParallelTFRecordWriter::Finalize() ABSL_LOCKS_EXCLUDED(mu_) {
     absl::MutexLock l(&mu_);
     finalized_ = true;
     ready_to_push_.SignalAll();
+    ready_to_serialize_.SignalAll();
     ready_to_pop_.SignalAll();
   }
 
+  serialization_thread_pool_.reset();
   thread_pool_.reset();
   absl::MutexLock l(&mu_);
+  // Records left behind if the writer failed.
+  for (const SerializedRecord& record : serialized_buffer_) {
+    if (record.allocated) {
+      ram_budget_manager_->RequestBufferBytes(
+          -static_cast<int64_t>(record.size.ToUnsignedBytes()));
+    }
+  }
+  serialized_buffer_.clear();
   TF_RETURN_IF_ERROR(status_);
   return file_stats_;
 }
 
+void ParallelTFRecordWriter::SerializeRecords() {
+  while (true) {
+    absl::StatusOr<bool> serialized = SerializeRecord();
+    if (!serialized.ok()) {
+      UpdateStatus(serialized.status());
+    }
+    if (!serialized.ok() || !*serialized) {
+      break;
+    }
+  }
+  absl::MutexLock l(&mu_);
+  // The write threads may be waiting for the last serialized records.
+  ready_to_pop_.SignalAll();
+}
+
+absl::StatusOr<bool> ParallelTFRecordWriter::SerializeRecord()
+    ABSL_LOCKS_EXCLUDED(mu_) {
+  std::vector<Tensor> record;
+  {
+    absl::MutexLock l(&mu_);
+    while (status_.ok() && !finalized_ && buffer_.empty()) {
+      ready_to_serialize_.Wait(&mu_);
+    }
+    TF_RETURN_IF_ERROR(status_);
+    if (buffer_.empty()) {
+      return false;
+    }
+    record = std::move(buffer_.front());
+    buffer_.pop_front();
+    ++num_serializing_;
+    ready_to_push_.SignalAll();
+  }
+
+  const int64_t start_us = env_->NowMicros();
+  SerializedRecord serialized_record;
+  serialized_record.tensors.resize(record.size());
+  absl::Status status;
+  {
+    tsl::profiler::TraceMe activity("SerializeTFRecord",
+                                    tsl::profiler::TraceMeLevel::kInfo);
+    for (size_t i = 0; i < record.size() && status.ok(); ++i) {
+      status = snapshot_util::TFRecordWriter::SerializeTensor(
+          record[i], file_prefix_, &serialized_record.tensors[i]);
+      serialized_record.size +=
+          ByteSize::Bytes(serialized_record.tensors[i].size());
+    }
+  }
+  metrics::RecordTFDataServiceSnapshotStageDuration(
+      "serialize", env_->NowMicros() - start_us);
+  if (status.ok()) {
+    status = PushSerializedRecord(std::move(serialized_record));
+  }
+
+  absl::MutexLock l(&mu_);
+  --num_serializing_;
+  ready_to_pop_.SignalAll();
+  TF_RETURN_IF_ERROR(status);
+  return true;
+}
+
+absl::Status ParallelTFRecordWriter::PushSerializedRecord(
+    SerializedRecord record) ABSL_LOCKS_EXCLUDED(mu_) {
+  const int64_t bytes = record.size.ToUnsignedBytes();
+  absl::MutexLock l(&mu_);
+  // Always accepts a record if nothing is buffered, so the writer makes
+  // progress even if the budget is smaller than a record.
+  record.allocated = ram_budget_manager_->RequestBufferBytes(bytes);
+  while (!record.allocated && status_.ok() && !serialized_buffer_.empty()) {
+    ready_to_push_serialized_.Wait(&mu_);
+    record.allocated = ram_budget_manager_->RequestBufferBytes(bytes);
+  }
+  if (!status_.ok()) {
+    if (record.allocated) {
+      ram_budget_manager_->RequestBufferBytes(-bytes);
+    }
+    return status_;
+  }
+  record.enqueued_us = env_->NowMicros();
+  serialized_buffer_.push_back(std::move(record));
+  ready_to_pop_.Signal();
+  return absl::OkStatus();
+}
+
 void ParallelTFRecordWriter::WriteFiles() {
   while (HasNext()) {
     UpdateStatus(WriteFile());
@@ -111,7 +222,11 @@ bool ParallelTFRecordWriter::HasNext() const ABSL_LOCKS_EXCLUDED(mu_) {
   if (!status_.ok()) {
     return false;
   }
-  return !finalized_ || !buffer_.empty();
+  return MoreSerializedRecords() || !serialized_buffer_.empty();
+}
+
+bool ParallelTFRecordWriter::MoreSerializedRecords() const {
+  return !finalized_ || !buffer_.empty() || num_serializing_ > 0;
 }
 
 absl::Status ParallelTFRecordWriter::WriteFile() ABSL_LOCKS_EXCLUDED(mu_) {
@@ -138,38 +253,51 @@ bool ParallelTFRecordWriter::ShouldWriteFile(const std::string& filename) const
 
 absl::Status ParallelTFRecordWriter::WriteRecord(
     const std::string& filename, snapshot_util::TFRecordWriter& writer) {
-  TF_ASSIGN_OR_RETURN(std::optional<std::vector<Tensor>> record,
+  TF_ASSIGN_OR_RETURN(std::optional<SerializedRecord> record,
                       GetNextRecord(filename));
   if (!record.has_value()) {
     return absl::OkStatus();
   }
 
-  tsl::profiler::TraceMe activity("WriteTFRecord",
-                                  tsl::profiler::TraceMeLevel::kInfo);
-  TF_RETURN_IF_ERROR(writer.WriteTensors(*std::move(record)));
+  const int64_t start_us = env_->NowMicros();
+  metrics::RecordTFDataServiceSnapshotStageDuration(
+      "queue", start_us - record->enqueued_us);
+  {
+    tsl::profiler::TraceMe activity("WriteTFRecord",
+                                    tsl::profiler::TraceMeLevel::kInfo);
+    TF_RETURN_IF_ERROR(
+        writer.WriteSerializedTensors(std::move(record->tensors)));
+  }
+  metrics::RecordTFDataServiceSnapshotStageDuration(
+      "write", env_->NowMicros() - start_us);
   return absl::OkStatus();
 }
 
-absl::StatusOr<std::optional<std::vector<Tensor>>>
+absl::StatusOr<std::optional<ParallelTFRecordWriter::SerializedRecord>>
 ParallelTFRecordWriter::GetNextRecord(const std::string& filename)
     ABSL_LOCKS_EXCLUDED(mu_) {
   absl::MutexLock l(&mu_);
-  while (status_.ok() && !finalized_ && buffer_.empty()) {
+  while (status_.ok() && MoreSerializedRecords() &&
+         serialized_buffer_.empty()) {
     ready_to_pop_.Wait(&mu_);
   }
   TF_RETURN_IF_ERROR(status_);
-  if (buffer_.empty()) {
+  if (serialized_buffer_.empty()) {
     return std::nullopt;
   }
 
-  std::vector<Tensor> record = std::move(buffer_.front());
-  ByteSize estimated_size = EstimatedSize(record);
-  LOG_EVERY_N_SEC(INFO, 1) << "Writing TFRecord of " << estimated_size
+  SerializedRecord record = std::move(serialized_buffer_.front());
+  serialized_buffer_.pop_front();
+  LOG_EVERY_N_SEC(INFO, 1) << "Writing TFRecord of " << record.size
                            << " to file " << filename << "*.";
   ++file_stats_[filename].num_records;
-  file_stats_[filename].estimated_size += estimated_size;
-  buffer_.pop_front();
-  ready_to_push_.SignalAll();
+  file_stats_[filename].estimated_size += record.size;
+  if (record.allocated) {
+    ram_budget_manager_->RequestBufferBytes(
+        -static_cast<int64_t>(record.size.ToUnsignedBytes()));
+    record.allocated = false;
+  }
+  ready_to_push_serialized_.SignalAll();
   return record;
 }
 
@@ -207,6 +335,8 @@ void ParallelTFRecordWriter::UpdateStatus(absl::Status status)
   absl::MutexLock l(&mu_);
   status_.Update(std::move(status));
   ready_to_push_.SignalAll();
+  ready_to_serialize_.SignalAll();
+  ready_to_push_serialized_.SignalAll();
   ready_to_pop_.SignalAll();
 }
 }  // namespace data
@@ -29,6 +29,7 @@ limitations under the License.
 #include "absl/synchronization/mutex.h"
 #include "tensorflow/core/data/service/byte_size.h"
 #include "tensorflow/core/data/snapshot_utils.h"
+#include "tensorflow/core/framework/model.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tsl/platform/env.h"
 #include "tsl/platform/threadpool.h"
@@ -40,6 +41,13 @@ namespace data {
 // waiting for the file writes, and it writes one shard of file per thread.
 // Returns the file names when writes are finished. This class is thread-safe.
 //
+// Writes are pipelined in two stages running on separate thread pools: the
+// serialization threads convert records to serialized tensor protos, and the
+// write threads compress and write the serialized records to files. Records
+// waiting for the write threads are accounted for in `ram_budget_manager`;
+// when it runs out of budget, serialization blocks until the write threads
+// catch up.
+//
 // Usage example:
 //
 // ParallelTFRecordWriter writer(
@@ -60,7 +68,10 @@ class ParallelTFRecordWriter {
                                   const std::string& compression, tsl::Env* env,
                                   ByteSize max_file_size = ByteSize::GB(6),
                                   int64_t num_write_threads = 2,
-                                  int64_t buffer_size = 1);
+                                  int64_t buffer_size = 1,
+                                  int64_t num_serialization_threads = 2,
+                                  std::shared_ptr<model::RamBudgetManager>
+                                      ram_budget_manager = nullptr);
   virtual ~ParallelTFRecordWriter();
   ParallelTFRecordWriter(const ParallelTFRecordWriter&) = delete;
   ParallelTFRecordWriter& operator=(const ParallelTFRecordWriter&) = delete;
@@ -85,12 +96,36 @@ class ParallelTFRecordWriter {
   absl::StatusOr<FileToStatsMap> Finalize();
 
  private:
+  // A record converted to serialized tensor protos.
+  struct SerializedRecord {
+    std::vector<std::string> tensors;
+    ByteSize size;
+    // Whether `size` bytes were allocated from `ram_budget_manager_`.
+    bool allocated = false;
+    // When the record was added to `serialized_buffer_`.
+    int64_t enqueued_us = 0;
+  };
+
+  // Run by a thread to serialize buffered records.
+  void SerializeRecords();
+
+  // Serializes the next record in `buffer_`. Returns false if there are no
+  // more records to serialize.
+  absl::StatusOr<bool> SerializeRecord();
+
+  // Adds `record` to `serialized_buffer_`, blocking while there is no RAM
+  // budget left for it and the write threads have records to catch up on.
+  absl::Status PushSerializedRecord(SerializedRecord record);
+
   // Run by a thread to write buffered records to sharded files.
   void WriteFiles();
 
   // Whether there are more records to be written.
   bool HasNext() const;
 
+  // Whether records may still be added to `serialized_buffer_`.
+  bool MoreSerializedRecords() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
   // Writes a new file.
   absl::Status WriteFile();
 
@@ -101,9 +136,9 @@ class ParallelTFRecordWriter {
   absl::Status WriteRecord(const std::string& filename,
                            snapshot_util::TFRecordWriter& writer);
 
-  // Gets the next record from the buffer to write. Returns `std::nullopt` if
-  // there are no more records to write.
-  absl::StatusOr<std::optional<std::vector<Tensor>>> GetNextRecord(
+  // Gets the next serialized record to write. Returns `std::nullopt` if there
+  // are no more records to write.
+  absl::StatusOr<std::optional<SerializedRecord>> GetNextRecord(
       const std::string& filename);
 
   // Deletes the file if it's empty.
@@ -120,9 +155,12 @@ class ParallelTFRecordWriter {
   const std::string compression_;
   const ByteSize max_file_size_;
   const int64_t buffer_size_;
+  const std::shared_ptr<model::RamBudgetManager> ram_budget_manager_;
 
   mutable absl::Mutex mu_;
   mutable absl::CondVar ready_to_push_;
+  mutable absl::CondVar ready_to_serialize_;
+  mutable absl::CondVar ready_to_push_serialized_;
   mutable absl::CondVar ready_to_pop_;
 
   bool finalized_ ABSL_GUARDED_BY(mu_) = false;
@@ -131,10 +169,18 @@ class ParallelTFRecordWriter {
   // A map from absolute paths to the number of records in the files.
   FileToStatsMap file_stats_ ABSL_GUARDED_BY(mu_);
 
-  // Buffer to hold the records to be written. The size should be bounded by
+  // Buffer to hold the records to be serialized. The size should be bounded by
   // `buffer_size_`.
   std::deque<std::vector<Tensor>> buffer_ ABSL_GUARDED_BY(mu_);
 
+  // Buffer to hold the serialized records to be written. The size is bounded
+  // by `ram_budget_manager_`.
+  std::deque<SerializedRecord> serialized_buffer_ ABSL_GUARDED_BY(mu_);
+
+  // Number of records being serialized.
+  int64_t num_serializing_ ABSL_GUARDED_BY(mu_) = 0;
+
+  std::unique_ptr<tsl::thread::ThreadPool> serialization_thread_pool_;
   std::unique_ptr<tsl::thread::ThreadPool> thread_pool_;
 };
 
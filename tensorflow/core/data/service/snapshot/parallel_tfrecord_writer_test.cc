@@ -33,6 +33,7 @@ limitations under the License.
 #include "xla/tsl/lib/core/status_test_util.h"
 #include "tensorflow/core/data/service/byte_size.h"
 #include "tensorflow/core/data/snapshot_utils.h"
+#include "tensorflow/core/framework/model.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tsl/lib/io/compression.h"
 #include "tsl/platform/env.h"
@@ -271,6 +272,30 @@ INSTANTIATE_TEST_SUITE_P(ParallelTFRecordWriterParams,
                                                tsl::io::compression::kSnappy,
                                                tsl::io::compression::kZlib)));
 
+TEST(ParallelTFRecordWriterTest, BoundedByRamBudget) {
+  TF_ASSERT_OK_AND_ASSIGN(std::string test_dir, TestDir());
+  // The smaller budgets fit at most one serialized record, so serialization
+  // has to wait for the write threads.
+  for (int64_t budget : {0, 16, 1 << 20}) {
+    auto ram_budget_manager = std::make_shared<model::RamBudgetManager>(budget);
+    ParallelTFRecordWriter parallel_tfrecord_writer(
+        absl::StrCat(test_dir, "/", budget), tsl::io::compression::kNone,
+        tsl::Env::Default(), ByteSize::Bytes(100), /*num_write_threads=*/2,
+        /*buffer_size=*/10, /*num_serialization_threads=*/3,
+        ram_budget_manager);
+    RangeIterator range_iterator(100);
+    TF_ASSERT_OK_AND_ASSIGN(
+        ParallelTFRecordWriter::FileToStatsMap file_stats,
+        WriteRecords(parallel_tfrecord_writer, range_iterator));
+
+    const auto [files, stats] = Unzip(file_stats);
+    EXPECT_THAT(ReadRecords<int64_t>(files, tsl::io::compression::kNone),
+                IsOkAndHolds(UnorderedElementsAreArray(Range(100))));
+    // All buffered bytes have been returned to the budget.
+    EXPECT_EQ(ram_budget_manager->AvailableModelRam(), budget);
+  }
+}
+
 TEST(ParallelTFRecordWriterTest, WriteNoRecord) {
   TF_ASSERT_OK_AND_ASSIGN(std::string test_dir, TestDir());
   ParallelTFRecordWriter parallel_tfrecord_writer(
@@ -176,9 +176,10 @@ absl::Status SnapshotStreamWriter::WriteChunks() {
   std::string chunks_prefix = tsl::io::JoinPath(
       params_.UncommittedChunksDirectory(),
       absl::StrCat("chunk_", chunk_index_, kFileShardDelimiter));
-  ParallelTFRecordWriter writer(TranslateFileName(chunks_prefix),
-                                params_.compression, params_.env,
-                                params_.max_chunk_size);
+  ParallelTFRecordWriter writer(
+      TranslateFileName(chunks_prefix), params_.compression, params_.env,
+      params_.max_chunk_size, /*num_write_threads=*/2, /*buffer_size=*/1,
+      /*num_serialization_threads=*/2, params_.ram_budget_manager);
   do {
     TF_RETURN_IF_ERROR(WriteRecord(writer));
   } while (ShouldWriteRecord());
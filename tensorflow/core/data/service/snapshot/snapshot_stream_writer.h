@@ -35,6 +35,7 @@ limitations under the License.
 #include "tensorflow/core/data/service/task_runner.h"
 #include "tensorflow/core/data/service/worker.pb.h"
 #include "tensorflow/core/data/snapshot_utils.h"
+#include "tensorflow/core/framework/model.h"
 #include "tensorflow/core/protobuf/service_config.pb.h"
 #include "tsl/platform/env.h"
 #include "tsl/platform/mutex.h"
@@ -73,6 +74,10 @@ struct SnapshotWriterParams {
   // snapshot. Used only for unit testing.
   bool test_only_keep_temp_files = false;
 
+  // Accounts for the serialized records buffered by the chunk writers. If
+  // null, each chunk writer uses its own budget.
+  std::shared_ptr<model::RamBudgetManager> ram_budget_manager = nullptr;
+
   std::string StreamDirectory() const {
     return tensorflow::data::StreamDirectory(snapshot_path, stream_index);
   }
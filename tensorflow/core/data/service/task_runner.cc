@@ -100,8 +100,10 @@ Status TaskRunner::Create(const experimental::WorkerConfig& worker_config,
         worker_config.cross_trainer_cache_size_bytes() > 0
             ? worker_config.cross_trainer_cache_size_bytes()
             : kDefaultCrossTrainerCacheSizeBytes;
-    out = std::make_unique<CachingTaskRunner>(std::move(iterator),
-                                              max_cache_size_bytes);
+    out = std::make_unique<CachingTaskRunner>(
+        std::move(iterator), max_cache_size_bytes,
+        absl::Milliseconds(
+            worker_config.cross_trainer_cache_straggler_timeout_ms()));
   } else {
     out = std::make_unique<FirstComeFirstServedTaskRunner>(std::move(iterator));
   }
@@ -178,10 +180,12 @@ std::shared_ptr<model::Model> FirstComeFirstServedTaskRunner::model() const {
 }
 
 CachingTaskRunner::CachingTaskRunner(std::unique_ptr<TaskIterator> iterator,
-                                     size_t max_cache_size_bytes)
+                                     size_t max_cache_size_bytes,
+                                     absl::Duration straggler_timeout)
     : fcfs_task_runner_(std::move(iterator)),
       cache_(max_cache_size_bytes,
-             std::make_unique<GetElementResultSequence>(fcfs_task_runner_)) {
+             std::make_unique<GetElementResultSequence>(fcfs_task_runner_),
+             straggler_timeout) {
   LOG(INFO) << "Initialized tf.data service cross-trainer cache with "
             << ByteSize::Bytes(max_cache_size_bytes) << " of memory.";
 }
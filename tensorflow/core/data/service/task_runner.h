@@ -19,6 +19,7 @@ limitations under the License.
 #include <optional>
 #include <vector>
 
+#include "absl/time/time.h"
 #include "tensorflow/core/data/service/common.pb.h"
 #include "tensorflow/core/data/service/cross_trainer_cache.h"
 #include "tensorflow/core/data/service/data_transfer.h"
@@ -150,11 +151,14 @@ class FirstComeFirstServedTaskRunner : public TaskRunner {
 // and caches elements in a sliding-window `CrossTrainerCache`. The cache has a
 // bounded size and progresses when a trainer that has consumed all elements in
 // the cache. Trainers read from a sliding window of the dataset and may not
-// read the full dataset.
+// read the full dataset. If `straggler_timeout` is positive, elements are only
+// evicted once all trainers have read them, unless the trainers which haven't
+// have fallen behind for `straggler_timeout`.
 class CachingTaskRunner : public TaskRunner {
  public:
-  explicit CachingTaskRunner(std::unique_ptr<TaskIterator> iterator,
-                             size_t max_cache_size_bytes);
+  explicit CachingTaskRunner(
+      std::unique_ptr<TaskIterator> iterator, size_t max_cache_size_bytes,
+      absl::Duration straggler_timeout = absl::ZeroDuration());
   ~CachingTaskRunner() override;
 
   // Gets the next element from the cross-trainer cache, blocking if the data is
@@ -57,6 +57,7 @@ limitations under the License.
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/host_info.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mem.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/statusor.h"
 #include "tensorflow/core/platform/thread_annotations.h"
@@ -76,6 +77,9 @@ namespace {
 constexpr absl::Duration kRetryInterval = absl::Seconds(5);
 constexpr absl::Duration kDefaultHeartBeatInterval = absl::Seconds(30);
 constexpr absl::Duration kDefaultDispatcherTimeout = absl::Hours(1);
+// Fraction of the available RAM the snapshot writers may use to buffer
+// serialized records.
+constexpr double kSnapshotRamBudgetShare = 0.1;
 
 using WorkerConfig = experimental::WorkerConfig;
 
@@ -159,7 +163,10 @@ LocalWorkers::AddressToWorkerMap* LocalWorkers::local_workers_ =
     new AddressToWorkerMap();
 
 DataServiceWorkerImpl::DataServiceWorkerImpl(const WorkerConfig& config)
-    : config_(ApplyWorkerDefaults(config)), worker_uid_(port::JobUid()) {
+    : config_(ApplyWorkerDefaults(config)),
+      worker_uid_(port::JobUid()),
+      snapshot_ram_budget_manager_(std::make_shared<model::RamBudgetManager>(
+          kSnapshotRamBudgetShare * port::AvailableRam())) {
   metrics::RecordTFDataServiceWorkerCreated();
 }
 
@@ -451,7 +458,8 @@ DataServiceWorkerImpl::MakeDatasetIterator(standalone::Dataset& dataset,
     for (int i = 0; i < task_def.num_split_providers(); ++i) {
       split_providers.push_back(std::make_unique<DataServiceSplitProvider>(
           config_.dispatcher_address(), config_.protocol(),
-          task_def.iteration_id(), i, config_.dispatcher_timeout_ms()));
+          task_def.iteration_id(), task_def.task_id(), i,
+          config_.dispatcher_timeout_ms()));
     }
     TF_RETURN_IF_ERROR(
         dataset.MakeIterator(std::move(split_providers), &iterator));
@@ -743,15 +751,16 @@ Status DataServiceWorkerImpl::UpdateSnapshotWriters(
         &dataset_def));
     TF_ASSIGN_OR_RETURN(std::unique_ptr<StandaloneTaskIterator> iterator,
                         MakeSnapshotTaskIterator(snapshot_task, dataset_def));
+    SnapshotWriterParams writer_params{
+        snapshot_task.base_path(), snapshot_task.stream_index(),
+        snapshot_task.metadata().compression(), Env::Default(),
+        ByteSize::Bytes(config_.snapshot_max_chunk_size_bytes())};
+    writer_params.ram_budget_manager = snapshot_ram_budget_manager_;
     mutex_lock l(mu_);
     snapshot_writers_.emplace(
         snapshot_task_key,
-        std::make_unique<SnapshotStreamWriter>(
-            SnapshotWriterParams{
-                snapshot_task.base_path(), snapshot_task.stream_index(),
-                snapshot_task.metadata().compression(), Env::Default(),
-                ByteSize::Bytes(config_.snapshot_max_chunk_size_bytes())},
-            std::move(iterator)));
+        std::make_unique<SnapshotStreamWriter>(writer_params,
+                                               std::move(iterator)));
   }
 
   // Cancel writers for snapshots that are no longer assigned by the dispatcher.
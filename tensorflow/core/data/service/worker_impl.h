@@ -34,6 +34,7 @@ limitations under the License.
 #include "tensorflow/core/data/service/worker.pb.h"
 #include "tensorflow/core/data/standalone.h"
 #include "tensorflow/core/framework/cancellation.h"
+#include "tensorflow/core/framework/model.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/status.h"
@@ -204,6 +205,9 @@ class DataServiceWorkerImpl {
   absl::flat_hash_map<SnapshotTask, std::unique_ptr<SnapshotStreamWriter>,
                       absl::Hash<SnapshotTask>>
       snapshot_writers_ TF_GUARDED_BY(mu_);
+  // Shared by the snapshot writers to bound the serialized records they
+  // buffer before writing them to files.
+  const std::shared_ptr<model::RamBudgetManager> snapshot_ram_budget_manager_;
 
   // A thread for notifying the dispatcher when tasks complete.
   std::unique_ptr<Thread> task_completion_thread_;
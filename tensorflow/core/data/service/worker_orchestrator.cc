@@ -0,0 +1,120 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/worker_orchestrator.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/strings/str_join.h"
+#include "absl/time/time.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/protobuf/service_config.pb.h"
+
+namespace tensorflow {
+namespace data {
+
+namespace {
+mutex* get_lock() {
+  static mutex lock(LINKER_INITIALIZED);
+  return &lock;
+}
+
+using WorkerOrchestratorFactories =
+    std::unordered_map<std::string, WorkerOrchestrator::FactoryT>;
+WorkerOrchestratorFactories& worker_orchestrator_factories() {
+  static auto& factories = *new WorkerOrchestratorFactories();
+  return factories;
+}
+}  // namespace
+
+void WorkerOrchestrator::Register(const std::string& name, FactoryT factory) {
+  mutex_lock l(*get_lock());
+  if (!worker_orchestrator_factories().insert({name, factory}).second) {
+    LOG(ERROR)
+        << "Two worker orchestrator factories are being registered with name "
+        << name << ". Which one gets used is undefined.";
+  }
+}
+
+absl::Status WorkerOrchestrator::Build(
+    const std::string& name, const experimental::DispatcherConfig& config,
+    std::unique_ptr<WorkerOrchestrator>* out) {
+  mutex_lock l(*get_lock());
+  auto it = worker_orchestrator_factories().find(name);
+  if (it != worker_orchestrator_factories().end()) {
+    return it->second(config, out);
+  }
+
+  std::vector<std::string> available_names;
+  for (const auto& factory : worker_orchestrator_factories()) {
+    available_names.push_back(factory.first);
+  }
+
+  return errors::NotFound(
+      "No worker orchestrator factory has been registered for name ", name,
+      ". The available names are: [ ", absl::StrJoin(available_names, ", "),
+      " ]");
+}
+
+int64_t WorkerScalingPolicy::GetWorkerDelta(
+    int64_t current_workers, std::optional<int64_t> optimal_workers,
+    int64_t get_next_calls, int64_t buffer_empty_get_next_calls,
+    absl::Time now) {
+  if (last_scaling_time_.has_value() &&
+      now < *last_scaling_time_ + options_.cooldown) {
+    return 0;
+  }
+  const bool starved =
+      get_next_calls > 0 &&
+      buffer_empty_get_next_calls >
+          options_.starvation_threshold * get_next_calls;
+  int64_t target_workers = current_workers;
+  if (starved) {
+    target_workers =
+        std::max(current_workers + 1, optimal_workers.value_or(0));
+  } else if (optimal_workers.has_value() &&
+             std::abs(*optimal_workers - current_workers) >
+                 options_.tolerance * current_workers) {
+    target_workers = *optimal_workers;
+  }
+  const int64_t delta = Clamp(target_workers) - current_workers;
+  if (delta != 0) {
+    VLOG(1) << "Scaling tf.data service from " << current_workers << " to "
+            << current_workers + delta << " workers. Optimal number of "
+            << "workers: " << optimal_workers.value_or(-1)
+            << "; starved consumers: " << starved;
+    last_scaling_time_ = now;
+  }
+  return delta;
+}
+
+int64_t WorkerScalingPolicy::Clamp(int64_t num_workers) const {
+  if (options_.max_workers > 0) {
+    num_workers = std::min(num_workers, options_.max_workers);
+  }
+  return std::max(num_workers, options_.min_workers);
+}
+
+}  // namespace data
+}  // namespace tensorflow
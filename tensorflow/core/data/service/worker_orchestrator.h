@@ -0,0 +1,110 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DATA_SERVICE_WORKER_ORCHESTRATOR_H_
+#define TENSORFLOW_CORE_DATA_SERVICE_WORKER_ORCHESTRATOR_H_
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+
+#include "absl/status/status.h"
+#include "absl/time/time.h"
+#include "tensorflow/core/protobuf/service_config.pb.h"
+
+namespace tensorflow {
+namespace data {
+
+// Hook through which the dispatcher asks the cluster manager running the
+// tf.data service to add or remove workers. Implementations are registered
+// under a name, and the dispatcher uses the one named by
+// `DispatcherConfig.worker_orchestrator`.
+//
+// Workers are removed in two steps. The dispatcher first drains a worker: it
+// stops assigning new tasks and splits to it, and lets its tasks finish. Only
+// then does it call `RemoveWorker`, so that removing workers does not restart
+// iterations.
+class WorkerOrchestrator {
+ public:
+  using FactoryT = std::function<absl::Status(
+      const experimental::DispatcherConfig&,
+      std::unique_ptr<WorkerOrchestrator>*)>;
+  virtual ~WorkerOrchestrator() = default;
+
+  // Asks for `num_workers` more workers. The new workers join the cluster by
+  // heartbeating to the dispatcher, like any other worker.
+  virtual absl::Status AddWorkers(int64_t num_workers) = 0;
+
+  // Asks for the drained worker at `worker_address` to be shut down.
+  virtual absl::Status RemoveWorker(const std::string& worker_address) = 0;
+
+  // Registers a WorkerOrchestrator factory under `name`.
+  static void Register(const std::string& name, FactoryT factory);
+
+  // Builds a WorkerOrchestrator from the factory registered under `name`.
+  static absl::Status Build(const std::string& name,
+                            const experimental::DispatcherConfig& config,
+                            std::unique_ptr<WorkerOrchestrator>* out);
+};
+
+// Decides when to add or drain workers, from the optimal number of workers
+// estimated by `MultipleIterationsAutoScaler` and from how often consumers
+// find their buffers empty.
+//
+// * When consumers are starved, i.e. more than `starvation_threshold` of their
+//   requests found an empty buffer, it scales up to the estimate, or by one
+//   worker if the estimate is not above the current number of workers.
+// * When consumers are not starved, it scales to the estimate only if the
+//   estimate differs from the current number of workers by more than
+//   `tolerance` of it, so that noisy estimates don't cause churn.
+// * It makes no decision within `cooldown` of its previous one, to let added
+//   workers start and drained workers finish before re-estimating.
+// * It keeps the number of workers within [min_workers, max_workers].
+//
+// WorkerScalingPolicy is not thread-safe.
+class WorkerScalingPolicy {
+ public:
+  struct Options {
+    int64_t min_workers = 1;
+    // 0 for no limit.
+    int64_t max_workers = 0;
+    absl::Duration cooldown = absl::Minutes(2);
+    double tolerance = 0.2;
+    double starvation_threshold = 0.1;
+  };
+
+  explicit WorkerScalingPolicy(const Options& options) : options_(options) {}
+
+  // Returns the number of workers to add, if positive, or to drain, if
+  // negative. `get_next_calls` and `buffer_empty_get_next_calls` are the
+  // number of consumer requests, and of requests that found an empty buffer,
+  // since the previous call.
+  int64_t GetWorkerDelta(int64_t current_workers,
+                         std::optional<int64_t> optimal_workers,
+                         int64_t get_next_calls,
+                         int64_t buffer_empty_get_next_calls, absl::Time now);
+
+ private:
+  int64_t Clamp(int64_t num_workers) const;
+
+  const Options options_;
+  std::optional<absl::Time> last_scaling_time_;
+};
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_SERVICE_WORKER_ORCHESTRATOR_H_
@@ -0,0 +1,146 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/worker_orchestrator.h"
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+
+#include "absl/status/status.h"
+#include "absl/time/time.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/protobuf/service_config.pb.h"
+#include "tsl/platform/status_matchers.h"
+#include "tsl/protobuf/error_codes.pb.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+using ::tsl::testing::IsOk;
+using ::tsl::testing::StatusIs;
+
+class CountingOrchestrator : public WorkerOrchestrator {
+ public:
+  absl::Status AddWorkers(int64_t num_workers) override {
+    added_ += num_workers;
+    return absl::OkStatus();
+  }
+  absl::Status RemoveWorker(const std::string& worker_address) override {
+    return absl::OkStatus();
+  }
+  int64_t added() const { return added_; }
+
+ private:
+  int64_t added_ = 0;
+};
+
+WorkerScalingPolicy::Options TestOptions() {
+  WorkerScalingPolicy::Options options;
+  options.min_workers = 1;
+  options.max_workers = 100;
+  options.cooldown = absl::Minutes(1);
+  options.tolerance = 0.2;
+  options.starvation_threshold = 0.1;
+  return options;
+}
+
+TEST(WorkerOrchestratorTest, Build) {
+  WorkerOrchestrator::Register(
+      "counting", [](const experimental::DispatcherConfig& config,
+                     std::unique_ptr<WorkerOrchestrator>* out) {
+        *out = std::make_unique<CountingOrchestrator>();
+        return absl::OkStatus();
+      });
+  std::unique_ptr<WorkerOrchestrator> orchestrator;
+  EXPECT_THAT(WorkerOrchestrator::Build(
+                  "counting", experimental::DispatcherConfig(), &orchestrator),
+              IsOk());
+  EXPECT_THAT(orchestrator->AddWorkers(2), IsOk());
+  EXPECT_EQ(static_cast<CountingOrchestrator*>(orchestrator.get())->added(), 2);
+}
+
+TEST(WorkerOrchestratorTest, BuildUnknown) {
+  std::unique_ptr<WorkerOrchestrator> orchestrator;
+  EXPECT_THAT(WorkerOrchestrator::Build(
+                  "unknown", experimental::DispatcherConfig(), &orchestrator),
+              StatusIs(error::NOT_FOUND));
+}
+
+TEST(WorkerScalingPolicyTest, ScalesToEstimateBeyondTolerance) {
+  const absl::Time now = absl::Now();
+  WorkerScalingPolicy policy(TestOptions());
+  EXPECT_EQ(policy.GetWorkerDelta(10, 15, /*get_next_calls=*/100,
+                                  /*buffer_empty_get_next_calls=*/0, now),
+            5);
+  WorkerScalingPolicy down_policy(TestOptions());
+  EXPECT_EQ(down_policy.GetWorkerDelta(10, 5, 100, 0, now), -5);
+}
+
+TEST(WorkerScalingPolicyTest, IgnoresEstimateWithinTolerance) {
+  const absl::Time now = absl::Now();
+  WorkerScalingPolicy policy(TestOptions());
+  EXPECT_EQ(policy.GetWorkerDelta(10, 12, 100, 0, now), 0);
+  EXPECT_EQ(policy.GetWorkerDelta(10, 8, 100, 0, now), 0);
+  EXPECT_EQ(policy.GetWorkerDelta(10, std::nullopt, 100, 0, now), 0);
+}
+
+TEST(WorkerScalingPolicyTest, ScalesUpWhenStarved) {
+  const absl::Time now = absl::Now();
+  WorkerScalingPolicy policy(TestOptions());
+  // The estimate says to scale down, but consumers wait for the workers.
+  EXPECT_EQ(policy.GetWorkerDelta(10, 5, 100, 20, now), 1);
+  WorkerScalingPolicy estimate_policy(TestOptions());
+  EXPECT_EQ(estimate_policy.GetWorkerDelta(10, 20, 100, 20, now), 10);
+  WorkerScalingPolicy no_estimate_policy(TestOptions());
+  EXPECT_EQ(no_estimate_policy.GetWorkerDelta(10, std::nullopt, 100, 20, now),
+            1);
+}
+
+TEST(WorkerScalingPolicyTest, Cooldown) {
+  const absl::Time now = absl::Now();
+  WorkerScalingPolicy policy(TestOptions());
+  EXPECT_EQ(policy.GetWorkerDelta(10, 15, 100, 0, now), 5);
+  EXPECT_EQ(policy.GetWorkerDelta(15, 30, 100, 0, now + absl::Seconds(30)), 0);
+  EXPECT_EQ(policy.GetWorkerDelta(15, 30, 100, 0, now + absl::Minutes(1)), 15);
+}
+
+TEST(WorkerScalingPolicyTest, NoCooldownWithoutScaling) {
+  const absl::Time now = absl::Now();
+  WorkerScalingPolicy policy(TestOptions());
+  EXPECT_EQ(policy.GetWorkerDelta(10, 11, 100, 0, now), 0);
+  EXPECT_EQ(policy.GetWorkerDelta(10, 15, 100, 0, now + absl::Seconds(1)), 5);
+}
+
+TEST(WorkerScalingPolicyTest, Bounds) {
+  const absl::Time now = absl::Now();
+  WorkerScalingPolicy::Options options = TestOptions();
+  options.min_workers = 4;
+  options.max_workers = 12;
+  WorkerScalingPolicy up_policy(options);
+  EXPECT_EQ(up_policy.GetWorkerDelta(10, 50, 100, 0, now), 2);
+  WorkerScalingPolicy down_policy(options);
+  EXPECT_EQ(down_policy.GetWorkerDelta(10, 1, 100, 0, now), -6);
+  WorkerScalingPolicy starved_policy(options);
+  EXPECT_EQ(starved_policy.GetWorkerDelta(12, std::nullopt, 100, 50, now), 0);
+  WorkerScalingPolicy min_policy(options);
+  EXPECT_EQ(min_policy.GetWorkerDelta(0, std::nullopt, 0, 0, now), 4);
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
@@ -177,6 +177,30 @@ Status TFRecordWriter::WriteTensors(const std::vector<Tensor>& tensors) {
   return absl::OkStatus();
 }
 
+Status TFRecordWriter::SerializeTensor(const Tensor& tensor,
+                                       const std::string& filename,
+                                       std::string* serialized) {
+  TensorProto proto;
+  tensor.AsProtoTensorContent(&proto);
+  if (!proto.SerializeToString(serialized)) {
+    return errors::DataLoss(ProtoSerializationErrorMessage(proto, filename));
+  }
+  return absl::OkStatus();
+}
+
+Status TFRecordWriter::WriteSerializedTensors(
+    std::vector<std::string> serialized) {
+  for (std::string& record : serialized) {
+#if defined(TF_CORD_SUPPORT)
+    TF_RETURN_IF_ERROR(
+        record_writer_->WriteRecord(absl::Cord(std::move(record))));
+#else   // TF_CORD_SUPPORT
+    TF_RETURN_IF_ERROR(record_writer_->WriteRecord(record));
+#endif  // TF_CORD_SUPPORT
+  }
+  return absl::OkStatus();
+}
+
 Status TFRecordWriter::Sync() {
   TF_RETURN_IF_ERROR(record_writer_->Flush());
   return dest_->Flush();
@@ -115,6 +115,16 @@ class TFRecordWriter : public Writer {
 
   Status WriteTensors(const std::vector<Tensor>& tensors) override;
 
+  // Serializes `tensor` into the record format written by `WriteTensors`, so
+  // that serialization can run ahead of the file write, e.g. on another thread.
+  // `filename` is only used in error messages.
+  static Status SerializeTensor(const Tensor& tensor,
+                                const std::string& filename,
+                                std::string* serialized);
+
+  // Writes records produced by `SerializeTensor`.
+  Status WriteSerializedTensors(std::vector<std::string> serialized);
+
   Status Sync() override;
 
   Status Close() override;
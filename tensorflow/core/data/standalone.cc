@@ -135,6 +135,158 @@ Status Iterator::Restore(const std::vector<Tensor>& saved_iterator) {
 
 std::shared_ptr<model::Model> Iterator::model() const { return ctx_->model(); }
 
+Status Iterator::GetNextN(int64_t max_elements,
+                          std::vector<std::vector<Tensor>>* outputs,
+                          bool* end_of_input) {
+  outputs->clear();
+  *end_of_input = false;
+  if (!pending_status_.ok()) {
+    return std::exchange(pending_status_, absl::OkStatus());
+  }
+  while (static_cast<int64_t>(outputs->size()) < max_elements) {
+    std::vector<Tensor> element;
+    Status s = GetNext(&element, end_of_input);
+    if (!s.ok()) {
+      // The elements already produced aren't lost: the error is returned by
+      // the next call instead.
+      if (outputs->empty()) return s;
+      *end_of_input = false;
+      pending_status_ = std::move(s);
+      break;
+    }
+    if (*end_of_input) {
+      break;
+    }
+    outputs->push_back(std::move(element));
+  }
+  return absl::OkStatus();
+}
+
+Status Iterator::MakeConsumerGroup(int num_consumers, int64_t buffer_size,
+                                   std::unique_ptr<ConsumerGroup>* result) {
+  if (num_consumers <= 0) {
+    return errors::InvalidArgument(
+        "The number of consumers must be positive, got ", num_consumers, ".");
+  }
+  if (buffer_size <= 0) {
+    return errors::InvalidArgument(
+        "The buffer size of the consumers must be positive, got ", buffer_size,
+        ".");
+  }
+  *result =
+      absl::WrapUnique(new ConsumerGroup(this, num_consumers, buffer_size));
+  return absl::OkStatus();
+}
+
+ConsumerGroup::ConsumerGroup(Iterator* iterator, int num_consumers,
+                             int64_t buffer_size)
+    : iterator_(iterator),
+      num_consumers_(num_consumers),
+      buffer_size_(buffer_size),
+      queues_(num_consumers) {
+  prefetch_thread_ = absl::WrapUnique(Env::Default()->StartThread(
+      ThreadOptions(), "tf_data_standalone_consumer_group",
+      [this]() { PrefetchLoop(); }));
+}
+
+ConsumerGroup::~ConsumerGroup() {
+  {
+    mutex_lock l(mu_);
+    cancelled_ = true;
+    cond_var_.notify_all();
+  }
+  // Joins the prefetch thread.
+  prefetch_thread_.reset();
+}
+
+Status ConsumerGroup::GetNext(int consumer_index, std::vector<Tensor>* outputs,
+                              bool* end_of_input) {
+  std::vector<std::vector<Tensor>> elements;
+  TF_RETURN_IF_ERROR(
+      GetNextN(consumer_index, /*max_elements=*/1, &elements, end_of_input));
+  if (!elements.empty()) {
+    *outputs = std::move(elements[0]);
+  }
+  return absl::OkStatus();
+}
+
+Status ConsumerGroup::GetNextN(int consumer_index, int64_t max_elements,
+                               std::vector<std::vector<Tensor>>* outputs,
+                               bool* end_of_input) {
+  if (consumer_index < 0 || consumer_index >= num_consumers_) {
+    return errors::InvalidArgument("Consumer index ", consumer_index,
+                                   " is out of range [0, ", num_consumers_,
+                                   ").");
+  }
+  outputs->clear();
+  *end_of_input = false;
+  mutex_lock l(mu_);
+  std::deque<std::vector<Tensor>>& queue = queues_[consumer_index];
+  while (static_cast<int64_t>(outputs->size()) < max_elements) {
+    while (queue.empty() && !end_of_input_ && status_.ok()) {
+      cond_var_.wait(l);
+    }
+    if (queue.empty()) {
+      // Like the end of input, the error is returned by the next call if some
+      // elements were collected.
+      if (!status_.ok()) {
+        if (outputs->empty()) return status_;
+      } else {
+        *end_of_input = true;
+      }
+      break;
+    }
+    // Takes all the prefetched elements needed at once, so that the prefetch
+    // thread is woken up once per call.
+    while (!queue.empty() && outputs->size() < max_elements) {
+      outputs->push_back(std::move(queue.front()));
+      queue.pop_front();
+    }
+    cond_var_.notify_all();
+  }
+  return absl::OkStatus();
+}
+
+void ConsumerGroup::PrefetchLoop() {
+  while (true) {
+    {
+      mutex_lock l(mu_);
+      while (!cancelled_ && !HasRoom()) {
+        cond_var_.wait(l);
+      }
+      if (cancelled_) {
+        return;
+      }
+    }
+    std::vector<Tensor> element;
+    bool end_of_input = false;
+    Status s = iterator_->GetNext(&element, &end_of_input);
+    mutex_lock l(mu_);
+    if (!s.ok() || end_of_input) {
+      status_ = s;
+      end_of_input_ = end_of_input;
+      cond_var_.notify_all();
+      return;
+    }
+    // Only this thread adds elements to the queues, so one still has room.
+    while (queues_[next_queue_].size() >= buffer_size_) {
+      next_queue_ = (next_queue_ + 1) % num_consumers_;
+    }
+    queues_[next_queue_].push_back(std::move(element));
+    next_queue_ = (next_queue_ + 1) % num_consumers_;
+    cond_var_.notify_all();
+  }
+}
+
+bool ConsumerGroup::HasRoom() const {
+  for (const auto& queue : queues_) {
+    if (queue.size() < buffer_size_) {
+      return true;
+    }
+  }
+  return false;
+}
+
 Status Dataset::FromGraph(Params params, const GraphDef& graph_def,
                           std::unique_ptr<Dataset>* result) {
   Graph graph(OpRegistry::Global());
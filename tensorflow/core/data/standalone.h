@@ -15,6 +15,8 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DATA_STANDALONE_H_
 #define TENSORFLOW_CORE_DATA_STANDALONE_H_
 
+#include <cstdint>
+#include <deque>
 #include <functional>
 #include <memory>
 #include <optional>
@@ -32,6 +34,9 @@ limitations under the License.
 #include "tensorflow/core/framework/resource_mgr.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
 #include "tensorflow/core/public/session_options.h"
 #include "tsl/platform/status.h"
 #include "tsl/platform/statusor.h"
@@ -73,7 +78,20 @@ namespace standalone {
 //     if (!s.ok()) { /* error handling */ }
 //     if (!end_of_input) { /* output handling */ }
 //   }
+//
+// To consume an iterator from several threads, create a `ConsumerGroup` and
+// give each thread its own consumer index:
+//
+//   std::unique_ptr<tensorflow::data::standalone::ConsumerGroup> group;
+//   s = iterator->MakeConsumerGroup(/*num_consumers=*/4,
+//                                   /*buffer_size=*/16, &group);
+//   if (!s.ok()) { /* error handling */ }
+//
+//   // On the thread of consumer `i`:
+//   std::vector<std::vector<tensorflow::Tensor>> elements;
+//   s = group->GetNextN(i, /*max_elements=*/32, &elements, &end_of_input);
 
+class ConsumerGroup;
 class Dataset;
 
 // Represents an execution of an input pipeline that can be used to enumerate
@@ -86,6 +104,21 @@ class Iterator {
   // indication of whether the end of the input pipeline has been reached.
   Status GetNext(std::vector<Tensor>* outputs, bool* end_of_input);
 
+  // Returns the next `max_elements` elements of the input pipeline in
+  // `outputs`. Fewer elements are returned only if the end of the input
+  // pipeline has been reached, in which case `end_of_input` is set to true, or
+  // if producing the next one failed after some were collected, in which case
+  // the error is returned by the next call.
+  Status GetNextN(int64_t max_elements,
+                  std::vector<std::vector<Tensor>>* outputs,
+                  bool* end_of_input);
+
+  // Creates a group of `num_consumers` consumers of the elements of this
+  // iterator, each prefetching up to `buffer_size` elements. The iterator must
+  // outlive the group, and must not be used otherwise while the group exists.
+  Status MakeConsumerGroup(int num_consumers, int64_t buffer_size,
+                           std::unique_ptr<ConsumerGroup>* result);
+
   // Saves a checkpoint of the iterator. Returns Tensors that can be called with
   // `Restore()`.
   absl::StatusOr<std::vector<Tensor>> Save();
@@ -107,6 +140,69 @@ class Iterator {
   std::unique_ptr<IteratorContext> ctx_;
   std::unique_ptr<SerializationContext> serialization_ctx_;
   std::shared_ptr<TfDatazMetricsCollector> tf_dataz_metrics_collector_;
+  // The error `GetNextN()` hit after collecting some elements, returned by the
+  // next call.
+  Status pending_status_;
+};
+
+// Distributes the elements of an `Iterator` to several consumer threads.
+//
+// A background thread reads the elements from the iterator and adds each one
+// to the prefetch queue of a single consumer, round robin over the queues that
+// have room. The consumers then don't contend on the iterator, and a slow
+// consumer doesn't hold back the others. The elements prefetched by the group
+// aren't part of the checkpoints of the iterator.
+//
+// All the methods are thread-safe. Elements are returned to consumer
+// `consumer_index` in the order the iterator produced them.
+class ConsumerGroup {
+ public:
+  ~ConsumerGroup();
+
+  int num_consumers() const { return num_consumers_; }
+
+  // Returns the next element of consumer `consumer_index` (if there is one)
+  // and an indication of whether the end of the input pipeline has been
+  // reached. Blocks until an element has been prefetched for the consumer.
+  Status GetNext(int consumer_index, std::vector<Tensor>* outputs,
+                 bool* end_of_input);
+
+  // Returns the next `max_elements` elements of consumer `consumer_index` in
+  // `outputs`. Fewer elements are returned only if the end of the input
+  // pipeline has been reached, in which case `end_of_input` is set to true, or
+  // if the iterator failed.
+  //
+  // An error of the iterator is returned to every consumer once its queue is
+  // drained, by the first call that collects no element.
+  Status GetNextN(int consumer_index, int64_t max_elements,
+                  std::vector<std::vector<Tensor>>* outputs,
+                  bool* end_of_input);
+
+ private:
+  friend class Iterator;
+
+  ConsumerGroup(Iterator* iterator, int num_consumers, int64_t buffer_size);
+
+  // Reads the elements of `iterator_` into the queues of the consumers until
+  // the end of input, an error, or the destruction of the group.
+  void PrefetchLoop();
+
+  // Returns whether the queue of a consumer has room for an element.
+  bool HasRoom() const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  Iterator* const iterator_;  // Not owned.
+  const int num_consumers_;
+  const int64_t buffer_size_;
+
+  mutex mu_;
+  condition_variable cond_var_;
+  std::vector<std::deque<std::vector<Tensor>>> queues_ TF_GUARDED_BY(mu_);
+  // The queue the next element is added to, if it has room.
+  int next_queue_ TF_GUARDED_BY(mu_) = 0;
+  bool end_of_input_ TF_GUARDED_BY(mu_) = false;
+  Status status_ TF_GUARDED_BY(mu_);
+  bool cancelled_ TF_GUARDED_BY(mu_) = false;
+  std::unique_ptr<Thread> prefetch_thread_;
 };
 
 // Represents an input pipeline as a collection of data sources and a logical
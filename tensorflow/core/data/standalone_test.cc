@@ -15,14 +15,19 @@ limitations under the License.
 
 #include "tensorflow/core/data/standalone.h"
 
+#include <algorithm>
 #include <memory>
 #include <optional>
 #include <vector>
 
+#include "absl/memory/memory.h"
 #include "xla/tsl/lib/core/status_test_util.h"
 #include "tensorflow/core/framework/graph.pb.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
 
 namespace tensorflow {
 namespace data {
@@ -116,6 +121,126 @@ constexpr const char* const kRangeGraphProto = R"pb(
   versions { producer: 96 }
 )pb";
 
+// range(10).apply(assert_cardinality(3)), which fails on the 4th element.
+constexpr const char* const kAssertCardinalityGraphProto = R"pb(
+  node {
+    name: "Const/_0"
+    op: "Const"
+    attr {
+      key: "dtype"
+      value { type: DT_INT64 }
+    }
+    attr {
+      key: "value"
+      value {
+        tensor {
+          dtype: DT_INT64
+          tensor_shape {}
+          int64_val: 0
+        }
+      }
+    }
+  }
+  node {
+    name: "Const/_1"
+    op: "Const"
+    attr {
+      key: "dtype"
+      value { type: DT_INT64 }
+    }
+    attr {
+      key: "value"
+      value {
+        tensor {
+          dtype: DT_INT64
+          tensor_shape {}
+          int64_val: 10
+        }
+      }
+    }
+  }
+  node {
+    name: "Const/_2"
+    op: "Const"
+    attr {
+      key: "dtype"
+      value { type: DT_INT64 }
+    }
+    attr {
+      key: "value"
+      value {
+        tensor {
+          dtype: DT_INT64
+          tensor_shape {}
+          int64_val: 1
+        }
+      }
+    }
+  }
+  node {
+    name: "RangeDataset/_3"
+    op: "RangeDataset"
+    input: "Const/_0"
+    input: "Const/_1"
+    input: "Const/_2"
+    attr {
+      key: "output_shapes"
+      value { list { shape {} } }
+    }
+    attr {
+      key: "output_types"
+      value { list { type: DT_INT64 } }
+    }
+  }
+  node {
+    name: "Const/_4"
+    op: "Const"
+    attr {
+      key: "dtype"
+      value { type: DT_INT64 }
+    }
+    attr {
+      key: "value"
+      value {
+        tensor {
+          dtype: DT_INT64
+          tensor_shape {}
+          int64_val: 3
+        }
+      }
+    }
+  }
+  node {
+    name: "AssertCardinalityDataset/_5"
+    op: "AssertCardinalityDataset"
+    input: "RangeDataset/_3"
+    input: "Const/_4"
+    attr {
+      key: "output_shapes"
+      value { list { shape {} } }
+    }
+    attr {
+      key: "output_types"
+      value { list { type: DT_INT64 } }
+    }
+  }
+  node {
+    name: "dataset"
+    op: "_Retval"
+    input: "AssertCardinalityDataset/_5"
+    attr {
+      key: "T"
+      value { type: DT_VARIANT }
+    }
+    attr {
+      key: "index"
+      value { i: 0 }
+    }
+  }
+  library {}
+  versions { producer: 96 }
+)pb";
+
 // range(10).map(lambda x: x*x)
 constexpr const char* const kMapGraphProto = R"pb(
   node {
@@ -574,6 +699,130 @@ TEST(NoAutotune, Standalone) {
   EXPECT_EQ(iterator->model(), nullptr);
 }
 
+TEST(GetNextN, Standalone) {
+  GraphDef graph_def;
+  protobuf::TextFormat::ParseFromString(kRangeGraphProto, &graph_def);
+  std::unique_ptr<Dataset> dataset;
+  TF_ASSERT_OK(Dataset::FromGraph({}, graph_def, &dataset));
+  std::unique_ptr<Iterator> iterator;
+  TF_ASSERT_OK(dataset->MakeIterator(&iterator));
+
+  std::vector<std::vector<Tensor>> elements;
+  bool end_of_input = false;
+  TF_ASSERT_OK(iterator->GetNextN(4, &elements, &end_of_input));
+  EXPECT_FALSE(end_of_input);
+  ASSERT_EQ(elements.size(), 4);
+  EXPECT_EQ(elements[3][0].scalar<int64_t>()(), 3);
+
+  TF_ASSERT_OK(iterator->GetNextN(8, &elements, &end_of_input));
+  EXPECT_TRUE(end_of_input);
+  ASSERT_EQ(elements.size(), 6);
+  EXPECT_EQ(elements[0][0].scalar<int64_t>()(), 4);
+  EXPECT_EQ(elements[5][0].scalar<int64_t>()(), 9);
+}
+
+TEST(GetNextN, ReturnsElementsBeforeError) {
+  GraphDef graph_def;
+  protobuf::TextFormat::ParseFromString(kAssertCardinalityGraphProto,
+                                        &graph_def);
+  std::unique_ptr<Dataset> dataset;
+  TF_ASSERT_OK(Dataset::FromGraph({}, graph_def, &dataset));
+  std::unique_ptr<Iterator> iterator;
+  TF_ASSERT_OK(dataset->MakeIterator(&iterator));
+
+  std::vector<std::vector<Tensor>> elements;
+  bool end_of_input = false;
+  TF_ASSERT_OK(iterator->GetNextN(8, &elements, &end_of_input));
+  EXPECT_FALSE(end_of_input);
+  ASSERT_EQ(elements.size(), 3);
+  EXPECT_EQ(elements[2][0].scalar<int64_t>()(), 2);
+
+  // The error is returned once the elements before it were.
+  EXPECT_TRUE(errors::IsFailedPrecondition(
+      iterator->GetNextN(8, &elements, &end_of_input)));
+  EXPECT_TRUE(elements.empty());
+}
+
+TEST(ConsumerGroup, Standalone) {
+  GraphDef graph_def;
+  protobuf::TextFormat::ParseFromString(kMapGraphProto, &graph_def);
+  std::unique_ptr<Dataset> dataset;
+  TF_ASSERT_OK(Dataset::FromGraph({}, graph_def, &dataset));
+  std::unique_ptr<Iterator> iterator;
+  TF_ASSERT_OK(dataset->MakeIterator(&iterator));
+  std::unique_ptr<ConsumerGroup> group;
+  TF_ASSERT_OK(iterator->MakeConsumerGroup(/*num_consumers=*/3,
+                                           /*buffer_size=*/2, &group));
+
+  std::vector<std::vector<int64_t>> consumer_outputs(group->num_consumers());
+  {
+    std::vector<std::unique_ptr<Thread>> threads;
+    for (int i = 0; i < group->num_consumers(); ++i) {
+      threads.push_back(absl::WrapUnique(Env::Default()->StartThread(
+          ThreadOptions(), "consumer", [&group, &consumer_outputs, i]() {
+            bool end_of_input = false;
+            while (!end_of_input) {
+              std::vector<std::vector<Tensor>> elements;
+              TF_EXPECT_OK(group->GetNextN(i, 2, &elements, &end_of_input));
+              for (const auto& element : elements) {
+                consumer_outputs[i].push_back(element[0].scalar<int64_t>()());
+              }
+            }
+          })));
+    }
+  }
+
+  std::vector<int64_t> outputs;
+  for (const auto& consumer_output : consumer_outputs) {
+    // Each consumer receives its elements in order.
+    EXPECT_TRUE(std::is_sorted(consumer_output.begin(), consumer_output.end()));
+    outputs.insert(outputs.end(), consumer_output.begin(),
+                   consumer_output.end());
+  }
+  std::sort(outputs.begin(), outputs.end());
+  EXPECT_EQ(outputs,
+            std::vector<int64_t>({0, 1, 4, 9, 16, 25, 36, 49, 64, 81}));
+}
+
+TEST(ConsumerGroup, InvalidArguments) {
+  GraphDef graph_def;
+  protobuf::TextFormat::ParseFromString(kRangeGraphProto, &graph_def);
+  std::unique_ptr<Dataset> dataset;
+  TF_ASSERT_OK(Dataset::FromGraph({}, graph_def, &dataset));
+  std::unique_ptr<Iterator> iterator;
+  TF_ASSERT_OK(dataset->MakeIterator(&iterator));
+  std::unique_ptr<ConsumerGroup> group;
+  EXPECT_EQ(iterator->MakeConsumerGroup(0, 1, &group).code(),
+            absl::StatusCode::kInvalidArgument);
+  EXPECT_EQ(iterator->MakeConsumerGroup(1, 0, &group).code(),
+            absl::StatusCode::kInvalidArgument);
+
+  TF_ASSERT_OK(iterator->MakeConsumerGroup(1, 1, &group));
+  std::vector<Tensor> outputs;
+  bool end_of_input = false;
+  EXPECT_EQ(group->GetNext(1, &outputs, &end_of_input).code(),
+            absl::StatusCode::kInvalidArgument);
+}
+
+// Creates an iterator over range(10).map(lambda x: x*x) and drains it.
+static void BM_StandaloneMap(benchmark::State& state) {
+  GraphDef graph_def;
+  protobuf::TextFormat::ParseFromString(kMapGraphProto, &graph_def);
+  std::unique_ptr<Dataset> dataset;
+  TF_CHECK_OK(Dataset::FromGraph({}, graph_def, &dataset));
+  for (auto s : state) {
+    std::unique_ptr<Iterator> iterator;
+    TF_CHECK_OK(dataset->MakeIterator(&iterator));
+    bool end_of_input = false;
+    while (!end_of_input) {
+      std::vector<tensorflow::Tensor> outputs;
+      TF_CHECK_OK(iterator->GetNext(&outputs, &end_of_input));
+    }
+  }
+}
+
+BENCHMARK(BM_StandaloneMap);
+
 }  // namespace
 }  // namespace standalone
 }  // namespace data
@@ -20,13 +20,17 @@ limitations under the License.
 #include <optional>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "absl/container/flat_hash_set.h"
 #include "absl/time/time.h"
 #include "tensorflow/core/framework/dataset.h"
 #include "tensorflow/core/framework/model.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/numa.h"
 #include "tsl/platform/thread_annotations.h"
 
 namespace tensorflow {
@@ -107,6 +111,30 @@ void TfDatazMetricsCollector::RecordGetNextLatency(
   }
 }
 
+void TfDatazMetricsCollector::RecordElementNumaPlacement(
+    const std::vector<Tensor>& element, int numa_node) {
+  if (!port::NUMAEnabled() || numa_node == port::kNUMANoAffinity) {
+    return;
+  }
+  if (num_numa_placement_elements_.fetch_add(1, std::memory_order_relaxed) %
+          kNumaPlacementSamplingPeriod !=
+      0) {
+    return;
+  }
+  for (const Tensor& tensor : element) {
+    if (!tensor.IsInitialized() || !DataTypeCanUseMemcpy(tensor.dtype()) ||
+        tensor.TotalBytes() == 0) {
+      continue;
+    }
+    const int64_t bytes = tensor.TotalBytes();
+    if (port::NUMAGetMemAffinity(tensor.data()) == numa_node) {
+      numa_local_bytes_.fetch_add(bytes, std::memory_order_relaxed);
+    } else {
+      numa_remote_bytes_.fetch_add(bytes, std::memory_order_relaxed);
+    }
+  }
+}
+
 absl::Duration TfDatazMetricsCollector::GetAverageLatencyForLastOneMinute() {
   return latency_estimator_.GetAverageLatency(
       ApproximateLatencyEstimator::Duration::kMinute);
@@ -138,6 +166,14 @@ std::shared_ptr<model::Model> TfDatazMetricsCollector::GetModel() {
   return model_;
 }
 
+int64_t TfDatazMetricsCollector::GetNumaLocalBytes() const {
+  return numa_local_bytes_.load(std::memory_order_relaxed);
+}
+
+int64_t TfDatazMetricsCollector::GetNumaRemoteBytes() const {
+  return numa_remote_bytes_.load(std::memory_order_relaxed);
+}
+
 namespace {
 static mutex* get_tfdataz_metrics_registry_lock() {
   static mutex tfdataz_metrics_registry_lock(LINKER_INITIALIZED);
@@ -15,15 +15,18 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DATA_TFDATAZ_METRICS_H_
 #define TENSORFLOW_CORE_DATA_TFDATAZ_METRICS_H_
 
+#include <atomic>
 #include <cstdint>
 #include <memory>
 #include <optional>
 #include <string>
+#include <vector>
 
 #include "absl/container/flat_hash_set.h"
 #include "absl/time/time.h"
 #include "tensorflow/core/framework/dataset.h"
 #include "tensorflow/core/framework/model.h"
+#include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/thread_annotations.h"
@@ -101,6 +104,16 @@ class TfDatazMetricsCollector {
   // Records `GetNext` call latency.
   void RecordGetNextLatency(int64_t get_next_latency_usec);
 
+  // Looking up the NUMA node of a buffer is a system call, so only one element
+  // out of this many is recorded by `RecordElementNumaPlacement`.
+  static constexpr int64_t kNumaPlacementSamplingPeriod = 100;
+
+  // Records which NUMA node holds the buffers of `element`, an element
+  // produced for a consumer on `numa_node`, for one element out of every
+  // `kNumaPlacementSamplingPeriod`. Does nothing if NUMA is not supported.
+  void RecordElementNumaPlacement(const std::vector<Tensor>& element,
+                                  int numa_node);
+
   // Returns the average `GetNext` latency for past 1 minute.
   absl::Duration GetAverageLatencyForLastOneMinute();
 
@@ -120,10 +133,21 @@ class TfDatazMetricsCollector {
 
   std::shared_ptr<model::Model> GetModel();
 
+  // Returns the number of sampled element bytes recorded by
+  // `RecordElementNumaPlacement` that were on the consumer's NUMA node.
+  int64_t GetNumaLocalBytes() const;
+
+  // Returns the number of sampled element bytes recorded by
+  // `RecordElementNumaPlacement` that had to cross NUMA nodes.
+  int64_t GetNumaRemoteBytes() const;
+
  private:
   DatasetBaseIterator* iterator_;  // not owned
   std::shared_ptr<model::Model> model_;
   ApproximateLatencyEstimator latency_estimator_;
+  std::atomic<int64_t> num_numa_placement_elements_ = 0;
+  std::atomic<int64_t> numa_local_bytes_ = 0;
+  std::atomic<int64_t> numa_remote_bytes_ = 0;
 };
 
 // Thread-safe global registry for the /tfdataz metrics. All callers to
@@ -14,12 +14,17 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/data/tfdataz_metrics.h"
 
+#include <cstdint>
 #include <memory>
 #include <utility>
+#include <vector>
 
 #include "absl/time/time.h"
 #include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/numa.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/util/fake_clock_env.h"
 
@@ -179,6 +184,36 @@ TEST_F(TfDatazMetricsTest, GetAverageLatencyWithZeroGetNextCalls) {
                   0);
 }
 
+TEST_F(TfDatazMetricsTest, RecordElementNumaPlacement) {
+  std::vector<Tensor> element = {test::AsTensor<int64_t>({1, 2, 3}),
+                                 test::AsTensor<tstring>({"a"}), Tensor()};
+  tfdataz_metrics_->RecordElementNumaPlacement(element, /*numa_node=*/0);
+  const int64_t recorded_bytes = tfdataz_metrics_->GetNumaLocalBytes() +
+                                 tfdataz_metrics_->GetNumaRemoteBytes();
+  // Only the buffer of the `int64` tensor is attributed to a NUMA node.
+  EXPECT_EQ(recorded_bytes, port::NUMAEnabled() ? 3 * sizeof(int64_t) : 0);
+}
+
+TEST_F(TfDatazMetricsTest, RecordElementNumaPlacementIsSampled) {
+  const std::vector<Tensor> element = {test::AsTensor<int64_t>({1, 2, 3})};
+  for (int i = 0; i <= TfDatazMetricsCollector::kNumaPlacementSamplingPeriod;
+       ++i) {
+    tfdataz_metrics_->RecordElementNumaPlacement(element, /*numa_node=*/0);
+  }
+  const int64_t recorded_bytes = tfdataz_metrics_->GetNumaLocalBytes() +
+                                 tfdataz_metrics_->GetNumaRemoteBytes();
+  // The first element of each sampling period is recorded.
+  EXPECT_EQ(recorded_bytes,
+            port::NUMAEnabled() ? 2 * 3 * sizeof(int64_t) : 0);
+}
+
+TEST_F(TfDatazMetricsTest, RecordElementNumaPlacementWithoutNumaNode) {
+  tfdataz_metrics_->RecordElementNumaPlacement(
+      {test::AsTensor<int64_t>({1, 2, 3})}, port::kNUMANoAffinity);
+  EXPECT_EQ(tfdataz_metrics_->GetNumaLocalBytes(), 0);
+  EXPECT_EQ(tfdataz_metrics_->GetNumaRemoteBytes(), 0);
+}
+
 class ScopedTfDataMetricsRegistration {
  public:
   explicit ScopedTfDataMetricsRegistration(
@@ -0,0 +1,301 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/tfrecord_index.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "tensorflow/core/lib/core/coding.h"
+#include "tensorflow/core/lib/hash/crc32c.h"
+#include "tensorflow/core/lib/io/cache.h"
+#include "tensorflow/core/lib/io/record_reader.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/file_system.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/random.h"
+#include "tensorflow/core/platform/raw_coding.h"
+#include "tensorflow/core/platform/tstring.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+// Format of the sidecar:
+//  byte      magic[8]
+//  uint64    size of the indexed file
+//  uint64    modification time of the indexed file, in nanoseconds
+//  uint64    number of offsets
+//  varint64  offset deltas[number of offsets]
+//  uint32    masked crc of the above
+constexpr absl::string_view kMagic = "TFRIDX01";
+constexpr size_t kHeaderSize = kMagic.size() + 3 * sizeof(uint64);
+constexpr size_t kFooterSize = sizeof(uint32);
+
+void DeleteBlock(const Slice& key, void* value) {
+  delete static_cast<std::string*>(value);
+}
+
+}  // namespace
+
+absl::StatusOr<std::shared_ptr<const TFRecordIndex>>
+TFRecordIndex::LoadOrBuild(Env* env, const std::string& filename,
+                           const io::RecordReaderOptions& options) {
+  FileStatistics file_stats;
+  TF_RETURN_IF_ERROR(env->Stat(filename, &file_stats));
+  const std::string index_filename =
+      absl::StrCat(filename, kTFRecordIndexSuffix);
+  if (env->FileExists(index_filename).ok()) {
+    absl::StatusOr<std::shared_ptr<const TFRecordIndex>> index =
+        Read(env, index_filename, file_stats);
+    if (index.ok()) {
+      return index;
+    }
+    LOG(WARNING) << "Rebuilding the index of TFRecord file " << filename
+                 << ": " << index.status();
+  }
+  absl::StatusOr<std::shared_ptr<const TFRecordIndex>> index =
+      Build(env, filename, options);
+  TF_RETURN_IF_ERROR(index.status());
+  absl::Status s = (*index)->Write(env, index_filename);
+  if (!s.ok()) {
+    LOG_FIRST_N(WARNING, 1) << "Failed to cache the index of TFRecord file "
+                            << filename << " in " << index_filename << ": "
+                            << s;
+  }
+  return index;
+}
+
+absl::StatusOr<std::shared_ptr<const TFRecordIndex>> TFRecordIndex::Build(
+    Env* env, const std::string& filename,
+    const io::RecordReaderOptions& options) {
+  if (options.compression_type != io::RecordReaderOptions::NONE) {
+    return absl::InvalidArgumentError(absl::StrCat(
+        "Cannot index compressed TFRecord file ", filename,
+        ": compressed records do not support positioned reads."));
+  }
+  FileStatistics file_stats;
+  TF_RETURN_IF_ERROR(env->Stat(filename, &file_stats));
+  std::unique_ptr<RandomAccessFile> file;
+  TF_RETURN_IF_ERROR(env->NewRandomAccessFile(filename, &file));
+  io::RecordReader reader(file.get(), options);
+  std::vector<uint64> offsets;
+  uint64 offset = 0;
+  while (true) {
+    offsets.push_back(offset);
+    int num_skipped;
+    absl::Status s = reader.SkipRecords(&offset, 1, &num_skipped);
+    if (errors::IsOutOfRange(s)) {
+      break;
+    }
+    TF_RETURN_IF_ERROR(s);
+  }
+  if (offset != file_stats.length) {
+    return absl::DataLossError(absl::StrCat(
+        "Truncated TFRecord file ", filename, ": the last record ends at ",
+        offset, " of ", file_stats.length, " bytes."));
+  }
+  return std::shared_ptr<const TFRecordIndex>(
+      new TFRecordIndex(file_stats, std::move(offsets)));
+}
+
+absl::StatusOr<std::shared_ptr<const TFRecordIndex>> TFRecordIndex::Read(
+    Env* env, const std::string& index_filename,
+    const FileStatistics& file_stats) {
+  std::string contents;
+  TF_RETURN_IF_ERROR(ReadFileToString(env, index_filename, &contents));
+  if (contents.size() < kHeaderSize + kFooterSize ||
+      absl::string_view(contents).substr(0, kMagic.size()) != kMagic) {
+    return absl::DataLossError(
+        absl::StrCat("Not a TFRecord index: ", index_filename));
+  }
+  const size_t data_size = contents.size() - kFooterSize;
+  const uint32 masked_crc = core::DecodeFixed32(contents.data() + data_size);
+  if (crc32c::Unmask(masked_crc) != crc32c::Value(contents.data(), data_size)) {
+    return absl::DataLossError(
+        absl::StrCat("Corrupted TFRecord index: ", index_filename));
+  }
+  const char* header = contents.data() + kMagic.size();
+  const int64_t indexed_file_size = core::DecodeFixed64(header);
+  const int64_t indexed_mtime_nsec =
+      core::DecodeFixed64(header + sizeof(uint64));
+  if (indexed_file_size != file_stats.length ||
+      indexed_mtime_nsec != file_stats.mtime_nsec) {
+    return absl::FailedPreconditionError(
+        absl::StrCat("Stale TFRecord index ", index_filename,
+                     ": the file was modified after it was indexed."));
+  }
+  const uint64 num_offsets = core::DecodeFixed64(header + 2 * sizeof(uint64));
+  StringPiece deltas(contents.data() + kHeaderSize, data_size - kHeaderSize);
+  std::vector<uint64> offsets;
+  offsets.reserve(std::min<uint64>(num_offsets, deltas.size()));
+  uint64 offset = 0;
+  for (uint64 i = 0; i < num_offsets; ++i) {
+    uint64 delta;
+    if (!core::GetVarint64(&deltas, &delta)) {
+      return absl::DataLossError(
+          absl::StrCat("Truncated TFRecord index: ", index_filename));
+    }
+    offset += delta;
+    offsets.push_back(offset);
+  }
+  if (offsets.empty() || offsets.back() != file_stats.length ||
+      !deltas.empty()) {
+    return absl::DataLossError(
+        absl::StrCat("Inconsistent TFRecord index: ", index_filename));
+  }
+  return std::shared_ptr<const TFRecordIndex>(
+      new TFRecordIndex(file_stats, std::move(offsets)));
+}
+
+absl::Status TFRecordIndex::Write(Env* env,
+                                  const std::string& index_filename) const {
+  std::string contents(kMagic);
+  core::PutFixed64(&contents, file_stats_.length);
+  core::PutFixed64(&contents, file_stats_.mtime_nsec);
+  core::PutFixed64(&contents, offsets_.size());
+  uint64 previous_offset = 0;
+  for (uint64 offset : offsets_) {
+    core::PutVarint64(&contents, offset - previous_offset);
+    previous_offset = offset;
+  }
+  core::PutFixed32(&contents,
+                   crc32c::Mask(crc32c::Value(contents.data(),
+                                              contents.size())));
+
+  // Concurrent readers of the same file may build its index at the same time,
+  // so each one writes to its own temporary file.
+  const std::string tmp_filename =
+      absl::StrCat(index_filename, ".", random::New64(), ".tmp");
+  TF_RETURN_IF_ERROR(WriteStringToFile(env, tmp_filename, contents));
+  absl::Status s = env->RenameFile(tmp_filename, index_filename);
+  if (!s.ok()) {
+    env->DeleteFile(tmp_filename).IgnoreError();
+  }
+  return s;
+}
+
+int64_t TFRecordIndex::FirstRecordAtOrAfter(uint64 offset) const {
+  return std::lower_bound(offsets_.begin(), offsets_.end() - 1, offset) -
+         offsets_.begin();
+}
+
+TFRecordRandomAccessReader::TFRecordRandomAccessReader(
+    std::unique_ptr<RandomAccessFile> file,
+    std::shared_ptr<const TFRecordIndex> index, table::Cache* cache,
+    uint64 block_size, bool verify_checksum)
+    : file_(std::move(file)),
+      index_(std::move(index)),
+      cache_(cache),
+      cache_id_(cache->NewId()),
+      block_size_(std::max<uint64>(block_size, 1)),
+      verify_checksum_(verify_checksum) {}
+
+absl::Status TFRecordRandomAccessReader::ReadRecord(int64_t index,
+                                                    tstring* record) const {
+  const uint64 offset = index_->record_offset(index);
+  const uint64 size = index_->record_size(index);
+  std::string bytes;
+  bytes.reserve(size);
+  TF_RETURN_IF_ERROR(ReadRange(offset, size, &bytes));
+  const size_t header_size = io::RecordReader::kHeaderSize;
+  const size_t footer_size = io::RecordReader::kFooterSize;
+  if (bytes.size() < header_size + footer_size ||
+      crc32c::Unmask(core::DecodeFixed32(bytes.data() + sizeof(uint64))) !=
+          crc32c::Value(bytes.data(), sizeof(uint64))) {
+    return absl::DataLossError(
+        absl::StrCat("Corrupted record header at ", offset));
+  }
+  const uint64 length = core::DecodeFixed64(bytes.data());
+  if (length != size - header_size - footer_size) {
+    return absl::DataLossError(absl::StrCat(
+        "Record at ", offset, " has ", length,
+        " bytes, which does not match the index. Was the file rewritten?"));
+  }
+  const char* data = bytes.data() + header_size;
+  if (verify_checksum_ &&
+      crc32c::Unmask(core::DecodeFixed32(data + length)) !=
+          crc32c::Value(data, length)) {
+    return absl::DataLossError(
+        absl::StrCat("Corrupted record data at ", offset));
+  }
+  record->assign(data, length);
+  return absl::OkStatus();
+}
+
+absl::Status TFRecordRandomAccessReader::ReadRange(uint64 offset, uint64 n,
+                                                   std::string* out) const {
+  const uint64 end = offset + n;
+  for (uint64 block = offset / block_size_; block * block_size_ < end;
+       ++block) {
+    absl::StatusOr<table::Cache::Handle*> handle = GetBlock(block);
+    TF_RETURN_IF_ERROR(handle.status());
+    const std::string& data =
+        *static_cast<const std::string*>(cache_->Value(*handle));
+    const uint64 block_start = block * block_size_;
+    const uint64 begin = std::max(offset, block_start) - block_start;
+    const uint64 limit = std::min<uint64>(end - block_start, data.size());
+    if (begin < limit) {
+      out->append(data, begin, limit - begin);
+    }
+    const bool short_block = data.size() < block_size_;
+    cache_->Release(*handle);
+    if (short_block) {
+      break;
+    }
+  }
+  if (out->size() != n) {
+    return absl::DataLossError(absl::StrCat("Truncated record at ", offset));
+  }
+  return absl::OkStatus();
+}
+
+absl::StatusOr<table::Cache::Handle*> TFRecordRandomAccessReader::GetBlock(
+    uint64 block) const {
+  char key[2 * sizeof(uint64)];
+  core::EncodeFixed64(key, cache_id_);
+  core::EncodeFixed64(key + sizeof(uint64), block);
+  const Slice cache_key(key, sizeof(key));
+  if (table::Cache::Handle* handle = cache_->Lookup(cache_key)) {
+    return handle;
+  }
+
+  auto data = std::make_unique<std::string>(block_size_, '\0');
+  StringPiece result;
+  absl::Status s =
+      file_->Read(block * block_size_, block_size_, &result, data->data());
+  if (!s.ok() && !errors::IsOutOfRange(s)) {
+    return s;
+  }
+  if (result.data() != data->data()) {
+    std::memmove(data->data(), result.data(), result.size());
+  }
+  data->resize(result.size());
+  const size_t charge = data->size();
+  return cache_->Insert(cache_key, data.release(), charge, &DeleteBlock);
+}
+
+}  // namespace data
+}  // namespace tensorflow
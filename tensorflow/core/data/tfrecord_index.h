@@ -0,0 +1,137 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DATA_TFRECORD_INDEX_H_
+#define TENSORFLOW_CORE_DATA_TFRECORD_INDEX_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "tensorflow/core/lib/io/cache.h"
+#include "tensorflow/core/lib/io/record_reader.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/file_system.h"
+#include "tensorflow/core/platform/tstring.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace data {
+
+// Suffix of the sidecar file holding the index of a TFRecord file.
+inline constexpr char kTFRecordIndexSuffix[] = ".tfrecord_index";
+
+// The offsets of the records of an uncompressed TFRecord file, which let
+// readers serve records by index with positioned reads.
+//
+// The index is built by scanning the record headers of the file once, and
+// cached next to the file in `<filename>.tfrecord_index`. The sidecar records
+// the size and modification time of the file it was built from, so that it is
+// rebuilt if the file changes.
+class TFRecordIndex {
+ public:
+  // Reads the index of `filename` from its sidecar. If the sidecar is missing,
+  // corrupted or stale, builds the index and tries to write the sidecar.
+  // Failing to write the sidecar, e.g. because the directory is read-only, is
+  // not an error.
+  static absl::StatusOr<std::shared_ptr<const TFRecordIndex>> LoadOrBuild(
+      Env* env, const std::string& filename,
+      const io::RecordReaderOptions& options);
+
+  // Builds the index by scanning `filename`.
+  static absl::StatusOr<std::shared_ptr<const TFRecordIndex>> Build(
+      Env* env, const std::string& filename,
+      const io::RecordReaderOptions& options);
+
+  // Reads an index written by `Write`. Returns `DataLoss` if the sidecar is
+  // corrupted, and `FailedPrecondition` if it was built from a different
+  // version of the file than the one described by `file_stats`.
+  static absl::StatusOr<std::shared_ptr<const TFRecordIndex>> Read(
+      Env* env, const std::string& index_filename,
+      const FileStatistics& file_stats);
+
+  // Atomically writes the index to `index_filename`.
+  absl::Status Write(Env* env, const std::string& index_filename) const;
+
+  int64_t num_records() const { return offsets_.size() - 1; }
+
+  // The offset of record `index` in the file.
+  uint64 record_offset(int64_t index) const { return offsets_[index]; }
+
+  // The size of record `index`, including its header and footer.
+  uint64 record_size(int64_t index) const {
+    return offsets_[index + 1] - offsets_[index];
+  }
+
+  // Returns the index of the first record which starts at or after `offset`.
+  int64_t FirstRecordAtOrAfter(uint64 offset) const;
+
+ private:
+  TFRecordIndex(const FileStatistics& file_stats, std::vector<uint64> offsets)
+      : file_stats_(file_stats), offsets_(std::move(offsets)) {}
+
+  // The size and modification time of the indexed file.
+  const FileStatistics file_stats_;
+  // The offset of every record, followed by the end offset of the last
+  // record.
+  const std::vector<uint64> offsets_;
+};
+
+// Reads the records of an indexed TFRecord file with positioned reads.
+//
+// Reads go through a block cache which may be shared between readers, so that
+// records close to each other in the file, e.g. when shuffling blocks of
+// records, only cost one read of the blocks holding them.
+//
+// Thread-safe.
+class TFRecordRandomAccessReader {
+ public:
+  // `cache` is not owned, must outlive the reader, and is charged in bytes.
+  TFRecordRandomAccessReader(std::unique_ptr<RandomAccessFile> file,
+                             std::shared_ptr<const TFRecordIndex> index,
+                             table::Cache* cache, uint64 block_size,
+                             bool verify_checksum);
+
+  // Reads record `index` into `*record`.
+  // REQUIRES: 0 <= index < index().num_records().
+  absl::Status ReadRecord(int64_t index, tstring* record) const;
+
+  const TFRecordIndex& index() const { return *index_; }
+
+ private:
+  // Appends bytes [offset, offset + n) of the file to `*out`.
+  absl::Status ReadRange(uint64 offset, uint64 n, std::string* out) const;
+
+  // Returns a handle to block `block` of the file, reading the block if it is
+  // not cached. The caller must release the handle.
+  absl::StatusOr<table::Cache::Handle*> GetBlock(uint64 block) const;
+
+  const std::unique_ptr<RandomAccessFile> file_;
+  const std::shared_ptr<const TFRecordIndex> index_;
+  table::Cache* const cache_;
+  // Distinguishes the blocks of this reader from those of other readers
+  // sharing `cache_`.
+  const uint64 cache_id_;
+  const uint64 block_size_;
+  const bool verify_checksum_;
+};
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_TFRECORD_INDEX_H_
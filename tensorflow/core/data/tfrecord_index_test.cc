@@ -0,0 +1,227 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/tfrecord_index.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/cache.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/io/record_reader.h"
+#include "tensorflow/core/lib/io/record_writer.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/file_system.h"
+#include "tensorflow/core/platform/statusor.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/tstring.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+std::string TestFilename(const std::string& name) {
+  return io::JoinPath(testing::TmpDir(), name);
+}
+
+Status WriteRecords(const std::string& filename,
+                    const std::vector<std::string>& records) {
+  std::unique_ptr<WritableFile> file;
+  TF_RETURN_IF_ERROR(Env::Default()->NewWritableFile(filename, &file));
+  io::RecordWriter writer(file.get());
+  for (const std::string& record : records) {
+    TF_RETURN_IF_ERROR(writer.WriteRecord(record));
+  }
+  TF_RETURN_IF_ERROR(writer.Close());
+  return file->Close();
+}
+
+std::vector<std::string> TestRecords() {
+  std::vector<std::string> records;
+  for (int i = 0; i < 20; ++i) {
+    records.push_back(std::string(i * 3, 'a' + i));
+  }
+  return records;
+}
+
+class TFRecordIndexTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    Env::Default()->DeleteFile(IndexFilename()).IgnoreError();
+    TF_ASSERT_OK(WriteRecords(filename_, TestRecords()));
+  }
+
+  std::string IndexFilename() const {
+    return absl::StrCat(filename_, kTFRecordIndexSuffix);
+  }
+
+  std::unique_ptr<TFRecordRandomAccessReader> NewReader(
+      std::shared_ptr<const TFRecordIndex> index, uint64 block_size) {
+    std::unique_ptr<RandomAccessFile> file;
+    TF_CHECK_OK(Env::Default()->NewRandomAccessFile(filename_, &file));
+    return std::make_unique<TFRecordRandomAccessReader>(
+        std::move(file), std::move(index), cache_.get(), block_size,
+        /*verify_checksum=*/true);
+  }
+
+  const std::string filename_ = TestFilename(
+      absl::StrCat(::testing::UnitTest::GetInstance()->current_test_info()
+                       ->name(),
+                   ".tfrecord"));
+  std::unique_ptr<table::Cache> cache_{table::NewLRUCache(1 << 10)};
+};
+
+TEST_F(TFRecordIndexTest, BuildsAndCachesIndex) {
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::shared_ptr<const TFRecordIndex> index,
+      TFRecordIndex::LoadOrBuild(Env::Default(), filename_,
+                                 io::RecordReaderOptions()));
+  EXPECT_EQ(index->num_records(), 20);
+  EXPECT_EQ(index->record_offset(0), 0);
+  EXPECT_EQ(index->record_size(1), io::RecordReader::kHeaderSize + 3 +
+                                       io::RecordReader::kFooterSize);
+  TF_EXPECT_OK(Env::Default()->FileExists(IndexFilename()));
+
+  FileStatistics stats;
+  TF_ASSERT_OK(Env::Default()->Stat(filename_, &stats));
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::shared_ptr<const TFRecordIndex> cached_index,
+      TFRecordIndex::Read(Env::Default(), IndexFilename(), stats));
+  ASSERT_EQ(cached_index->num_records(), index->num_records());
+  for (int64_t i = 0; i < index->num_records(); ++i) {
+    EXPECT_EQ(cached_index->record_offset(i), index->record_offset(i));
+    EXPECT_EQ(cached_index->record_size(i), index->record_size(i));
+  }
+}
+
+TEST_F(TFRecordIndexTest, RebuildsStaleIndex) {
+  TF_ASSERT_OK(TFRecordIndex::LoadOrBuild(Env::Default(), filename_,
+                                          io::RecordReaderOptions())
+                   .status());
+  TF_ASSERT_OK(WriteRecords(filename_, {"a", "b", "c"}));
+  FileStatistics stats;
+  TF_ASSERT_OK(Env::Default()->Stat(filename_, &stats));
+  EXPECT_FALSE(
+      TFRecordIndex::Read(Env::Default(), IndexFilename(), stats).ok());
+
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::shared_ptr<const TFRecordIndex> index,
+      TFRecordIndex::LoadOrBuild(Env::Default(), filename_,
+                                 io::RecordReaderOptions()));
+  EXPECT_EQ(index->num_records(), 3);
+}
+
+TEST_F(TFRecordIndexTest, RebuildsCorruptedIndex) {
+  TF_ASSERT_OK(TFRecordIndex::LoadOrBuild(Env::Default(), filename_,
+                                          io::RecordReaderOptions())
+                   .status());
+  std::string contents;
+  TF_ASSERT_OK(ReadFileToString(Env::Default(), IndexFilename(), &contents));
+  contents[contents.size() / 2] ^= 1;
+  TF_ASSERT_OK(WriteStringToFile(Env::Default(), IndexFilename(), contents));
+  FileStatistics stats;
+  TF_ASSERT_OK(Env::Default()->Stat(filename_, &stats));
+  EXPECT_TRUE(errors::IsDataLoss(
+      TFRecordIndex::Read(Env::Default(), IndexFilename(), stats).status()));
+
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::shared_ptr<const TFRecordIndex> index,
+      TFRecordIndex::LoadOrBuild(Env::Default(), filename_,
+                                 io::RecordReaderOptions()));
+  EXPECT_EQ(index->num_records(), 20);
+}
+
+TEST_F(TFRecordIndexTest, EmptyFile) {
+  TF_ASSERT_OK(WriteRecords(filename_, {}));
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::shared_ptr<const TFRecordIndex> index,
+      TFRecordIndex::LoadOrBuild(Env::Default(), filename_,
+                                 io::RecordReaderOptions()));
+  EXPECT_EQ(index->num_records(), 0);
+}
+
+TEST_F(TFRecordIndexTest, TruncatedFile) {
+  std::string contents;
+  TF_ASSERT_OK(ReadFileToString(Env::Default(), filename_, &contents));
+  contents.resize(contents.size() - 1);
+  TF_ASSERT_OK(WriteStringToFile(Env::Default(), filename_, contents));
+  EXPECT_TRUE(errors::IsDataLoss(
+      TFRecordIndex::Build(Env::Default(), filename_,
+                           io::RecordReaderOptions())
+          .status()));
+}
+
+TEST_F(TFRecordIndexTest, CompressedFile) {
+  EXPECT_TRUE(errors::IsInvalidArgument(
+      TFRecordIndex::Build(
+          Env::Default(), filename_,
+          io::RecordReaderOptions::CreateRecordReaderOptions("GZIP"))
+          .status()));
+}
+
+TEST_F(TFRecordIndexTest, FirstRecordAtOrAfter) {
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::shared_ptr<const TFRecordIndex> index,
+      TFRecordIndex::Build(Env::Default(), filename_,
+                           io::RecordReaderOptions()));
+  EXPECT_EQ(index->FirstRecordAtOrAfter(0), 0);
+  EXPECT_EQ(index->FirstRecordAtOrAfter(index->record_offset(5)), 5);
+  EXPECT_EQ(index->FirstRecordAtOrAfter(index->record_offset(5) + 1), 6);
+  EXPECT_EQ(index->FirstRecordAtOrAfter(1 << 20), 20);
+}
+
+TEST_F(TFRecordIndexTest, ReadsRecordsInAnyOrder) {
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::shared_ptr<const TFRecordIndex> index,
+      TFRecordIndex::Build(Env::Default(), filename_,
+                           io::RecordReaderOptions()));
+  const std::vector<std::string> records = TestRecords();
+  // Block sizes smaller than, close to and larger than the records.
+  for (uint64 block_size : {1, 7, 64, 1 << 20}) {
+    std::unique_ptr<TFRecordRandomAccessReader> reader =
+        NewReader(index, block_size);
+    for (int64_t i : {19, 0, 7, 8, 6, 19, 1}) {
+      tstring record;
+      TF_ASSERT_OK(reader->ReadRecord(i, &record));
+      EXPECT_EQ(record, records[i]) << "block size " << block_size;
+    }
+  }
+}
+
+TEST_F(TFRecordIndexTest, CorruptedRecord) {
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::shared_ptr<const TFRecordIndex> index,
+      TFRecordIndex::Build(Env::Default(), filename_,
+                           io::RecordReaderOptions()));
+  std::string contents;
+  TF_ASSERT_OK(ReadFileToString(Env::Default(), filename_, &contents));
+  contents[index->record_offset(3) + io::RecordReader::kHeaderSize] ^= 1;
+  TF_ASSERT_OK(WriteStringToFile(Env::Default(), filename_, contents));
+
+  std::unique_ptr<TFRecordRandomAccessReader> reader =
+      NewReader(index, /*block_size=*/16);
+  tstring record;
+  TF_EXPECT_OK(reader->ReadRecord(2, &record));
+  EXPECT_TRUE(errors::IsDataLoss(reader->ReadRecord(3, &record)));
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
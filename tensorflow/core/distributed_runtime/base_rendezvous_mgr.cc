@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/base_rendezvous_mgr.h"
 
+#include <algorithm>
 #include <functional>
 #include <memory>
 #include <unordered_set>
@@ -55,10 +56,62 @@ tsl::core::RefCountPtr<RemoteRendezvous> BaseRendezvousMgr::Find(
   return FindOrCreate(step_id);
 }
 
+bool VariableReadCache::Lookup(const string& key, int64_t step_seq,
+                               int64_t max_staleness, Tensor* value,
+                               bool* refresh) {
+  mutex_lock l(mu_);
+  max_staleness_ = std::max(max_staleness_, max_staleness);
+  auto it = entries_.find(key);
+  if (it == entries_.end() || it->second.step_seq < step_seq - max_staleness) {
+    return false;
+  }
+  Entry& entry = it->second;
+  *value = entry.value;
+  *refresh = !entry.refreshing && entry.step_seq < step_seq;
+  if (*refresh) entry.refreshing = true;
+  return true;
+}
+
+void VariableReadCache::Insert(const string& key, int64_t step_seq,
+                               const Tensor& value) {
+  mutex_lock l(mu_);
+  Entry& entry = entries_[key];
+  entry.refreshing = false;
+  if (entry.value.IsInitialized() && entry.step_seq > step_seq) return;
+  entry.value = value;
+  entry.step_seq = step_seq;
+}
+
+void VariableReadCache::AbandonRefresh(const string& key) {
+  mutex_lock l(mu_);
+  auto it = entries_.find(key);
+  if (it != entries_.end()) it->second.refreshing = false;
+}
+
+void VariableReadCache::EvictStale(int64_t step_seq) {
+  // Destruct the evicted values after releasing the lock.
+  std::vector<Tensor> evicted;
+  mutex_lock l(mu_);
+  for (auto it = entries_.begin(); it != entries_.end();) {
+    if (it->second.step_seq < step_seq - max_staleness_) {
+      evicted.push_back(std::move(it->second.value));
+      entries_.erase(it++);
+    } else {
+      ++it;
+    }
+  }
+}
+
 tsl::core::RefCountPtr<BaseRemoteRendezvous> BaseRendezvousMgr::FindOrCreate(
     int64_t step_id) {
-  return cache_->FindOrCreate(
-      step_id, [this, step_id]() { return Create(step_id, worker_env_); });
+  return cache_->FindOrCreate(step_id, [this, step_id]() {
+    tsl::core::RefCountPtr<BaseRemoteRendezvous> rendez =
+        Create(step_id, worker_env_);
+    const int64_t step_seq = next_step_seq_++;
+    variable_read_cache_->EvictStale(step_seq);
+    rendez->SetVariableReadCache(variable_read_cache_, step_seq);
+    return rendez;
+  });
 }
 
 void BaseRendezvousMgr::RecvLocalAsync(int64_t step_id,
@@ -329,19 +382,68 @@ void BaseRemoteRendezvous::RecvAsync(const ParsedKey& parsed,
         });
     return;
   } else {
+    if (recv_args.is_variable_read && max_variable_read_staleness_ > 0 &&
+        RecvVariableReadFromCache(parsed, recv_args, done)) {
+      return;
+    }
+    // Cache the value if later steps may reuse it.
+    const bool cache_value = recv_args.is_variable_read &&
+                             max_variable_read_staleness_ > 0 &&
+                             variable_read_cache_ != nullptr;
     // Keep current rendezvous alive while the recv is inflight.
     this->Ref();
-    RecvFromRemoteAsync(parsed, recv_args,
-                        [this, parsed, done](const Status& status,
-                                             const Rendezvous::Args& send_args,
-                                             const Rendezvous::Args& recv_args,
-                                             const Tensor& in, bool is_dead) {
-                          VLOG(2) << "RemoteRendezvous Finished Remote Recv "
-                                  << this << " " << parsed.FullKey();
-                          done(status, send_args, recv_args, in, is_dead);
-                          this->Unref();
-                        });
+    RecvFromRemoteAsync(
+        parsed, recv_args,
+        [this, parsed, done, cache_value](const Status& status,
+                                          const Rendezvous::Args& send_args,
+                                          const Rendezvous::Args& recv_args,
+                                          const Tensor& in, bool is_dead) {
+          VLOG(2) << "RemoteRendezvous Finished Remote Recv " << this << " "
+                  << parsed.FullKey();
+          if (cache_value && status.ok() && !is_dead) {
+            variable_read_cache_->Insert(string(parsed.FullKey()), step_seq_,
+                                         in);
+          }
+          done(status, send_args, recv_args, in, is_dead);
+          this->Unref();
+        });
+  }
+}
+
+bool BaseRemoteRendezvous::RecvVariableReadFromCache(
+    const ParsedKey& parsed, const Rendezvous::Args& recv_args,
+    const DoneCallback& done) {
+  if (!variable_read_cache_) return false;
+  const string key(parsed.FullKey());
+  Tensor value;
+  bool refresh = false;
+  if (!variable_read_cache_->Lookup(key, step_seq_,
+                                    max_variable_read_staleness_, &value,
+                                    &refresh)) {
+    return false;
+  }
+  VLOG(2) << "RemoteRendezvous serving cached value for " << key;
+  done(absl::OkStatus(), Args(), recv_args, value, false);
+  if (refresh) {
+    // The Recv op may finish before the fetch does, so the fetch must not use
+    // its cancellation manager. It is still aborted with this rendezvous.
+    Rendezvous::Args fetch_args = recv_args;
+    fetch_args.cancellation_manager = nullptr;
+    this->Ref();
+    RecvFromRemoteAsync(
+        parsed, fetch_args,
+        [this, key](const Status& status, const Rendezvous::Args& send_args,
+                    const Rendezvous::Args& recv_args, const Tensor& in,
+                    bool is_dead) {
+          if (status.ok() && !is_dead) {
+            variable_read_cache_->Insert(key, step_seq_, in);
+          } else {
+            variable_read_cache_->AbandonRefresh(key);
+          }
+          this->Unref();
+        });
   }
+  return true;
 }
 
 void BaseRemoteRendezvous::RecvLocalAsync(const ParsedKey& parsed,
@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_BASE_RENDEZVOUS_MGR_H_
 #define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_BASE_RENDEZVOUS_MGR_H_
 
+#include <atomic>
 #include <cstdint>
 #include <memory>
 #include <string>
@@ -47,6 +48,42 @@ namespace tensorflow {
 class BaseRemoteRendezvous;
 class BaseRecvTensorCall;
 
+// Values received by a worker for remote variable reads, kept across steps and
+// keyed by rendezvous key. Steps are numbered in the order in which the worker
+// creates their rendezvous. Thread-safe.
+class VariableReadCache {
+ public:
+  // Returns true and sets "*value" if the value cached for "key" was received
+  // in step "step_seq - max_staleness" or later. Sets "*refresh" if the caller
+  // should fetch the value of this step to replace it; at most one such fetch
+  // is in flight per key.
+  bool Lookup(const string& key, int64_t step_seq, int64_t max_staleness,
+              Tensor* value, bool* refresh);
+
+  // Caches "value", received for "key" in step "step_seq", unless a value
+  // from a later step is already cached.
+  void Insert(const string& key, int64_t step_seq, const Tensor& value);
+
+  // Marks the fetch started after Lookup() set "*refresh" as finished without
+  // a value.
+  void AbandonRefresh(const string& key);
+
+  // Evicts the values too old to be served in step "step_seq" under the
+  // largest "max_staleness" passed to Lookup() so far. Called when a step
+  // starts, so that the values of variables no longer read are freed.
+  void EvictStale(int64_t step_seq);
+
+ private:
+  struct Entry {
+    Tensor value;
+    int64_t step_seq = 0;
+    bool refreshing = false;
+  };
+  mutex mu_;
+  absl::flat_hash_map<string, Entry> entries_ TF_GUARDED_BY(mu_);
+  int64_t max_staleness_ TF_GUARDED_BY(mu_) = 0;
+};
+
 // RendezvousMgr keeps track of a set of local rendezvous instances.
 // All tensors sent by this worker are buffered in a RendezvousMgr
 // until the tensor is received.  Each global unique "step_id"
@@ -108,6 +145,10 @@ class BaseRendezvousMgr : public RendezvousMgrInterface {
   // Not owned.
   const WorkerEnv* const worker_env_;
 
+  const std::shared_ptr<VariableReadCache> variable_read_cache_ =
+      std::make_shared<VariableReadCache>();
+  std::atomic<int64_t> next_step_seq_{0};
+
   tsl::core::RefCountPtr<BaseRemoteRendezvous> FindOrCreate(int64_t step_id);
 
   BaseRendezvousMgr(const BaseRendezvousMgr&) = delete;
@@ -134,6 +175,18 @@ class BaseRemoteRendezvous : public RemoteRendezvous {
     return remote_eager_context_default_;
   }
 
+  void SetMaxVariableReadStaleness(int64_t steps) override {
+    max_variable_read_staleness_ = steps;
+  }
+
+  // Sets the cache from which variable reads of this step may be served, and
+  // the position of this step in the cache's step order.
+  void SetVariableReadCache(std::shared_ptr<VariableReadCache> cache,
+                            int64_t step_seq) {
+    variable_read_cache_ = std::move(cache);
+    step_seq_ = step_seq;
+  }
+
   // Forwards to local_, where the Tensor "val" will be buffered and
   // any waiting callback stored.
   Status Send(const ParsedKey& key, const Rendezvous::Args& args,
@@ -195,6 +248,10 @@ class BaseRemoteRendezvous : public RemoteRendezvous {
   // eager executors.
   bool remote_eager_context_default_ = false;
 
+  std::shared_ptr<VariableReadCache> variable_read_cache_;
+  int64_t step_seq_ = 0;
+  std::atomic<int64_t> max_variable_read_staleness_{0};
+
   mutable mutex mu_;
   mutable mutex calls_mu_;
 
@@ -271,6 +328,13 @@ class BaseRemoteRendezvous : public RemoteRendezvous {
   // Must be called only if fully initialized.
   void RecvLocalAsyncInternal(const ParsedKey& parsed, DoneCallback done);
 
+  // Serves a remote variable read from variable_read_cache_ if it holds a
+  // recent enough value, fetching the value of this step in the background.
+  // Returns false if the caller must fetch the value itself.
+  bool RecvVariableReadFromCache(const ParsedKey& parsed,
+                                 const Rendezvous::Args& recv_args,
+                                 const DoneCallback& done);
+
   BaseRemoteRendezvous(const BaseRemoteRendezvous&) = delete;
   void operator=(const BaseRemoteRendezvous&) = delete;
 };
@@ -14,15 +14,25 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/distributed_runtime/collective_param_resolver_distributed.h"
 
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/strings/escaping.h"
+#include "absl/strings/str_cat.h"
+#include "xla/tsl/distributed_runtime/coordination/coordination_service_agent.h"
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/common_runtime/device_mgr.h"
 #include "tensorflow/core/distributed_runtime/cancellable_call.h"
 #include "tensorflow/core/distributed_runtime/device_resolver_distributed.h"
 #include "tensorflow/core/distributed_runtime/worker_cache.h"
 #include "tensorflow/core/framework/device_attributes.pb.h"
+#include "tensorflow/core/platform/blocking_counter.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/statusor.h"
 #include "tensorflow/core/protobuf/config.pb.h"
 #include "tensorflow/core/util/device_name_utils.h"
 
@@ -204,6 +214,101 @@ void CollectiveParamResolverDistributed::CompleteInstanceAsync(
       });
 }
 
+Status CollectiveParamResolverDistributed::PreResolveGroups(
+    tsl::CoordinationServiceAgent* agent, absl::string_view batch_name,
+    const std::vector<CompleteGroupRequest>& members, absl::Duration timeout) {
+  const string prefix =
+      absl::StrCat("collective_param_resolver/", batch_name, "/");
+  PreResolvedGroups declared;
+  for (const CompleteGroupRequest& member : members) {
+    *declared.add_members() = member;
+  }
+  TF_RETURN_IF_ERROR(agent->InsertKeyValue(
+      absl::StrCat(prefix, "members/", task_name_),
+      declared.SerializeAsString()));
+  TF_RETURN_IF_ERROR(agent->WaitAtBarrier(absl::StrCat(prefix, "declared"),
+                                          timeout, /*tasks=*/{}));
+
+  const string groups_key = absl::StrCat(prefix, "groups");
+  PreResolvedGroups resolved;
+  if (group_leader_.empty()) {
+    TF_ASSIGN_OR_RETURN(std::vector<KeyValueEntry> entries,
+                        agent->GetKeyValueDir(absl::StrCat(prefix, "members")));
+    TF_RETURN_IF_ERROR(CompleteDeclaredGroups(entries, &resolved));
+    return agent->InsertKeyValue(groups_key, resolved.SerializeAsString());
+  }
+  TF_ASSIGN_OR_RETURN(string value, agent->GetKeyValue(groups_key, timeout));
+  if (!resolved.ParseFromString(value)) {
+    return errors::Internal("Failed to parse the groups resolved under ",
+                            groups_key);
+  }
+  for (const CompleteGroupResponse& group : resolved.groups()) {
+    TF_RETURN_IF_ERROR(UpdateGroupCache(group));
+  }
+  VLOG(1) << "Pre-resolved " << resolved.groups_size() << " groups of batch "
+          << batch_name;
+  return absl::OkStatus();
+}
+
+Status CollectiveParamResolverDistributed::CompleteDeclaredGroups(
+    const std::vector<KeyValueEntry>& entries, PreResolvedGroups* resolved) {
+  std::vector<CompleteGroupRequest> members;
+  absl::flat_hash_map<int32_t, int32_t> num_members;
+  for (const KeyValueEntry& entry : entries) {
+    PreResolvedGroups declared;
+    if (!declared.ParseFromString(entry.value())) {
+      return errors::Internal("Failed to parse the group members declared "
+                              "under ",
+                              entry.key());
+    }
+    for (CompleteGroupRequest& member : *declared.mutable_members()) {
+      ++num_members[member.group_key()];
+      members.push_back(std::move(member));
+    }
+  }
+  // A group with missing members would never complete.
+  for (const CompleteGroupRequest& member : members) {
+    if (num_members[member.group_key()] != member.group_size()) {
+      return errors::InvalidArgument(
+          "Group ", member.group_key(), " of size ", member.group_size(),
+          " has ", num_members[member.group_key()], " declared members");
+    }
+  }
+
+  std::vector<CollGroupParams> group_params(members.size());
+  std::vector<Status> statuses(members.size());
+  BlockingCounter counter(members.size());
+  for (int i = 0; i < members.size(); ++i) {
+    group_params[i].group_key = members[i].group_key();
+    group_params[i].group_size = members[i].group_size();
+    group_params[i].device_type = DeviceType(members[i].device_type());
+    CompleteGroupLocal(members[i].device_attributes(), &group_params[i],
+                       /*cancel_mgr=*/nullptr,
+                       [&statuses, &counter, i](const Status& s) {
+                         statuses[i] = s;
+                         counter.DecrementCount();
+                       });
+  }
+  counter.Wait();
+
+  absl::flat_hash_set<int32_t> added;
+  for (int i = 0; i < members.size(); ++i) {
+    TF_RETURN_IF_ERROR(statuses[i]);
+    const CollGroupParams& group = group_params[i];
+    if (!added.insert(group.group_key).second) continue;
+    CompleteGroupResponse* response = resolved->add_groups();
+    response->set_group_key(group.group_key);
+    response->set_group_size(group.group_size);
+    response->set_device_type(group.device_type.type_string());
+    response->set_num_tasks(group.num_tasks);
+    for (const CollGroupMember& member : group.members) {
+      *response->add_device_attributes() = member.device;
+    }
+    response->set_communicator_key(group.runtime_details.communicator_key);
+  }
+  return absl::OkStatus();
+}
+
 CollectiveParamResolverDistributed::GroupRec*
 CollectiveParamResolverDistributed::GetCachedGroup(int32_t group_key) {
   mutex_lock l(group_mu_);
@@ -15,10 +15,20 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_COLLECTIVE_PARAM_RESOLVER_DISTRIBUTED_H_
 #define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_COLLECTIVE_PARAM_RESOLVER_DISTRIBUTED_H_
 
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
 #include "tensorflow/core/common_runtime/collective_param_resolver_local.h"
 #include "tensorflow/core/framework/cancellation.h"
 #include "tensorflow/core/framework/device_attributes.pb.h"
 #include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/protobuf/worker.pb.h"
+#include "tsl/protobuf/coordination_service.pb.h"
+
+namespace tsl {
+class CoordinationServiceAgent;
+}  // namespace tsl
 
 namespace tensorflow {
 class ConfigProto;
@@ -50,6 +60,18 @@ class CollectiveParamResolverDistributed : public CollectiveParamResolverLocal {
 
   void StartAbort(const Status& s) override;
 
+  // Resolves up front the groups declared by all the tasks of the cluster.
+  // Memberships are exchanged through the coordination service in a fixed
+  // number of round trips, instead of a CompleteGroup RPC to the group leader
+  // for each group and device on first use.  `members` lists one entry per
+  // group and device of this task, possibly none.  Every task must make this
+  // call with the same `batch_name`.  Blocks until the groups are resolved,
+  // or fails once `timeout` expires.
+  Status PreResolveGroups(tsl::CoordinationServiceAgent* agent,
+                          absl::string_view batch_name,
+                          const std::vector<CompleteGroupRequest>& members,
+                          absl::Duration timeout);
+
  protected:
   // Returns the cached group iff there's an entry for this group_key in the
   // local group_table_; returns nullptr otherwise.
@@ -59,6 +81,11 @@ class CollectiveParamResolverDistributed : public CollectiveParamResolverLocal {
   Status UpdateGroupCache(const CompleteGroupResponse& resp)
       TF_LOCKS_EXCLUDED(group_mu_);
 
+  // Completes on the group leader the groups whose members are declared in
+  // `entries`, and adds them to `resolved`.
+  Status CompleteDeclaredGroups(const std::vector<KeyValueEntry>& entries,
+                                PreResolvedGroups* resolved);
+
   // Finds the GroupRec that corresponds to cp->group_key and also
   // populates cp->group from that GroupRec.
   //
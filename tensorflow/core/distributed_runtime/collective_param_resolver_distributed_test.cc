@@ -15,7 +15,20 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/collective_param_resolver_distributed.h"
 
+#include <map>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <gmock/gmock.h>
 #include "absl/container/flat_hash_map.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/match.h"
+#include "absl/time/time.h"
+#include "xla/tsl/distributed_runtime/call_options.h"
+#include "xla/tsl/distributed_runtime/coordination/coordination_client.h"
+#include "xla/tsl/distributed_runtime/coordination/coordination_service_agent.h"
 #include "tensorflow/core/common_runtime/device_mgr.h"
 #include "tensorflow/core/common_runtime/test_collective_executor_mgr.h"
 #include "tensorflow/core/distributed_runtime/device_resolver_distributed.h"
@@ -30,6 +43,8 @@ limitations under the License.
 #include "tensorflow/core/platform/random.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/util/device_name_utils.h"
+#include "tsl/protobuf/coordination_config.pb.h"
+#include "tsl/protobuf/coordination_service.pb.h"
 
 namespace tensorflow {
 namespace {
@@ -104,6 +119,170 @@ class FakeNcclCommunicator : public NcclCommunicatorInterface {
   void StartAbort(const Status& s) override {}
 };
 
+using tsl::CallOptions;
+using tsl::CoordinationClient;
+using tsl::CoordinationServiceAgent;
+
+class MockCoordinationServiceAgent : public CoordinationServiceAgent {
+ public:
+  MOCK_METHOD(Status, WaitAtBarrier,
+              (std::string_view barrier_id, absl::Duration timeout,
+               const std::vector<CoordinatedTask>& tasks),
+              (override));
+  MOCK_METHOD(Status, CancelBarrier, (std::string_view barrier_id), (override));
+
+  MOCK_METHOD(Status, Initialize,
+              (Env * env, std::string_view job_name, int task_id,
+               const CoordinationServiceConfig& configs,
+               std::unique_ptr<CoordinationClient> leader_client,
+               StatusCallback error_fn),
+              (override));
+  MOCK_METHOD(Status, Initialize,
+              (Env * env, const CoordinatedTask& task,
+               const CoordinationServiceConfig& configs,
+               std::unique_ptr<CoordinationClient> leader_client,
+               StatusCallback error_fn),
+              (override));
+  MOCK_METHOD(bool, IsInitialized, (), (override));
+  MOCK_METHOD(bool, IsConnected, (), (override));
+  MOCK_METHOD(bool, IsError, (), (override));
+  MOCK_METHOD(Status, Connect, (), (override));
+  MOCK_METHOD(Status, WaitForAllTasks, (const DeviceInfo& local_devices),
+              (override));
+  MOCK_METHOD(const DeviceInfo&, GetClusterDeviceInfo, (), (override));
+  MOCK_METHOD(absl::StatusOr<CoordinatedTask>, GetOwnTask, (), (override));
+  MOCK_METHOD(absl::StatusOr<std::vector<CoordinatedTaskStateInfo>>,
+              GetTaskState, (const std::vector<CoordinatedTask>& task),
+              (override));
+  MOCK_METHOD(Status, ReportError, (const Status& error), (override));
+  MOCK_METHOD(Status, Shutdown, (), (override));
+  MOCK_METHOD(Status, Reset, (), (override));
+  MOCK_METHOD(absl::StatusOr<std::string>, GetKeyValue, (std::string_view key),
+              (override));
+  MOCK_METHOD(absl::StatusOr<std::string>, GetKeyValue,
+              (std::string_view key, absl::Duration timeout), (override));
+  MOCK_METHOD(std::shared_ptr<CallOptions>, GetKeyValueAsync,
+              (std::string_view key, StatusOrValueCallback done), (override));
+  MOCK_METHOD(absl::StatusOr<std::string>, TryGetKeyValue,
+              (std::string_view key), (override));
+  MOCK_METHOD(absl::StatusOr<std::vector<KeyValueEntry>>, GetKeyValueDir,
+              (std::string_view key), (override));
+  MOCK_METHOD(void, GetKeyValueDirAsync,
+              (std::string_view key, StatusOrValueDirCallback done),
+              (override));
+  MOCK_METHOD(Status, InsertKeyValue,
+              (std::string_view key, std::string_view value), (override));
+  MOCK_METHOD(Status, InsertKeyValue,
+              (std::string_view key, std::string_view value,
+               bool allow_overwrite),
+              (override));
+  MOCK_METHOD(Status, DeleteKeyValue, (std::string_view key), (override));
+  MOCK_METHOD(Status, UpdateKeyValue,
+              (std::string_view key, std::string_view value), (override));
+  MOCK_METHOD(Status, StartWatchKey,
+              (std::string_view key, ChangedKeyValuesCallback on_change),
+              (override));
+  MOCK_METHOD(Status, StopWatchKey, (std::string_view key), (override));
+  MOCK_METHOD(void, WaitAtBarrierAsync,
+              (std::string_view barrier_id, absl::Duration timeout,
+               const std::vector<CoordinatedTask>& tasks, StatusCallback done),
+              (override));
+  MOCK_METHOD(void, CancelBarrierAsync,
+              (std::string_view barrier_id, StatusCallback done), (override));
+  MOCK_METHOD(absl::StatusOr<Env*>, GetEnv, (), (override));
+  MOCK_METHOD(void, SetError, (const Status& error), (override));
+  MOCK_METHOD(Status, ActivateWatch,
+              (std::string_view key,
+               (const std::map<std::string, std::string>&)),
+              (override));
+};
+
+// Key-value store and barriers of a coordination service shared by
+// `num_tasks` tasks.
+class FakeCoordinationService {
+ public:
+  explicit FakeCoordinationService(int num_tasks) : num_tasks_(num_tasks) {}
+
+  Status InsertKeyValue(std::string_view key, std::string_view value) {
+    mutex_lock l(mu_);
+    if (!kv_.emplace(key, value).second) {
+      return errors::AlreadyExists(key);
+    }
+    cv_.notify_all();
+    return absl::OkStatus();
+  }
+
+  absl::StatusOr<std::string> GetKeyValue(std::string_view key) {
+    mutex_lock l(mu_);
+    auto it = kv_.find(string(key));
+    while (it == kv_.end()) {
+      cv_.wait(l);
+      it = kv_.find(string(key));
+    }
+    return it->second;
+  }
+
+  std::vector<KeyValueEntry> GetKeyValueDir(std::string_view dir) {
+    const string prefix = strings::StrCat(dir, "/");
+    mutex_lock l(mu_);
+    std::vector<KeyValueEntry> entries;
+    for (auto it = kv_.lower_bound(prefix);
+         it != kv_.end() && absl::StartsWith(it->first, prefix); ++it) {
+      KeyValueEntry entry;
+      entry.set_key(it->first);
+      entry.set_value(it->second);
+      entries.push_back(std::move(entry));
+    }
+    return entries;
+  }
+
+  Status WaitAtBarrier(std::string_view barrier_id) {
+    mutex_lock l(mu_);
+    int& arrived = barriers_[string(barrier_id)];
+    ++arrived;
+    cv_.notify_all();
+    while (arrived < num_tasks_) {
+      cv_.wait(l);
+    }
+    return absl::OkStatus();
+  }
+
+ private:
+  const int num_tasks_;
+  mutex mu_;
+  condition_variable cv_;
+  std::map<string, string> kv_ TF_GUARDED_BY(mu_);
+  std::map<string, int> barriers_ TF_GUARDED_BY(mu_);
+};
+
+// Coordination service agent of one task of a FakeCoordinationService.
+class FakeCoordinationServiceAgent
+    : public ::testing::NiceMock<MockCoordinationServiceAgent> {
+ public:
+  explicit FakeCoordinationServiceAgent(FakeCoordinationService* service) {
+    using ::testing::_;
+    ON_CALL(*this, InsertKeyValue(_, _))
+        .WillByDefault([service](std::string_view key,
+                                 std::string_view value) {
+          return service->InsertKeyValue(key, value);
+        });
+    ON_CALL(*this, GetKeyValue(_, _))
+        .WillByDefault([service](std::string_view key, absl::Duration) {
+          return service->GetKeyValue(key);
+        });
+    ON_CALL(*this, GetKeyValueDir(_))
+        .WillByDefault([service](std::string_view key)
+                           -> absl::StatusOr<std::vector<KeyValueEntry>> {
+          return service->GetKeyValueDir(key);
+        });
+    ON_CALL(*this, WaitAtBarrier(_, _, _))
+        .WillByDefault([service](std::string_view barrier_id, absl::Duration,
+                                 const std::vector<CoordinatedTask>&) {
+          return service->WaitAtBarrier(barrier_id);
+        });
+  }
+};
+
 class DeviceResDistTest : public ::testing::Test {
  public:
   ~DeviceResDistTest() override {
@@ -327,6 +506,56 @@ TEST_F(DeviceResDistTest, Workers1Devices1) {
   ValidateCollectiveParams(num_workers, num_devices);
 }
 
+TEST_F(DeviceResDistTest, PreResolveGroups) {
+  const int num_workers = 3;
+  const int num_devices = 2;
+  DefineWorkers(num_workers, num_devices, "CPU", /*nccl*/ true);
+  DefineCollectiveParams(num_workers, num_devices, "CPU");
+  const int32_t group_key =
+      cp_["/job:worker/replica:0/task:0/device:CPU:0"]->group.group_key;
+
+  FakeCoordinationService service(num_workers);
+  std::vector<Status> statuses(num_workers);
+  {
+    std::vector<std::unique_ptr<Thread>> threads;
+    for (int wi = 0; wi < num_workers; ++wi) {
+      string task_name = strings::StrCat("/job:worker/replica:0/task:", wi);
+      std::vector<CompleteGroupRequest> members;
+      for (const string& device_name : dev_by_task_[task_name]) {
+        Device* device = nullptr;
+        TF_ASSERT_OK(
+            device_mgrs_[task_name]->LookupDevice(device_name, &device));
+        CompleteGroupRequest member;
+        member.set_group_key(group_key);
+        member.set_group_size(num_workers * num_devices);
+        member.set_device_type("CPU");
+        *member.mutable_device_attributes() = device->attributes();
+        members.push_back(std::move(member));
+      }
+      CollectiveParamResolverDistributed* cp_res =
+          cp_resolvers_[task_name].get();
+      threads.emplace_back(Env::Default()->StartThread(
+          ThreadOptions(), "pre_resolve",
+          [&service, &statuses, wi, cp_res, members = std::move(members)]() {
+            FakeCoordinationServiceAgent agent(&service);
+            statuses[wi] = cp_res->PreResolveGroups(&agent, "test", members,
+                                                    absl::Seconds(60));
+          }));
+    }
+  }
+
+  // Every task knows the group before any of its collectives resolves it.
+  for (int wi = 0; wi < num_workers; ++wi) {
+    TF_ASSERT_OK(statuses[wi]);
+    string task_name = strings::StrCat("/job:worker/replica:0/task:", wi);
+    CollGroupParams group;
+    TF_ASSERT_OK(cp_resolvers_[task_name]->LookupGroup(group_key, &group));
+    EXPECT_EQ(group.members.size(), num_workers * num_devices);
+  }
+  IssueRequests(num_workers, num_devices);
+  ValidateCollectiveParams(num_workers, num_devices);
+}
+
 TEST_F(DeviceResDistTest, Workers2Devices2) {
   const int num_workers = 2;
   const int num_devices = 2;
@@ -476,6 +476,10 @@ void GraphMgr::ExecuteAsync(
   RemoteRendezvous* rendezvous =
       worker_env_->rendezvous_mgr->Find(step_id).release();
   Status s = rendezvous->Initialize(session);
+  if (opts.max_variable_read_staleness_steps() > 0) {
+    rendezvous->SetMaxVariableReadStaleness(
+        opts.max_variable_read_staleness_steps());
+  }
   CollectiveExecutor::Handle* ce_handle =
       item->collective_graph_key != BuildGraphOptions::kNoCollectiveGraphKey
           ? new CollectiveExecutor::Handle(
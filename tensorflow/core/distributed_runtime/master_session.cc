@@ -31,6 +31,7 @@ limitations under the License.
 #include "tensorflow/core/debug/debug_graph_utils.h"
 #include "tensorflow/core/distributed_runtime/request_id.h"
 #include "tensorflow/core/distributed_runtime/scheduler.h"
+#include "tensorflow/core/distributed_runtime/step_critical_path.h"
 #include "tensorflow/core/distributed_runtime/worker_cache.h"
 #include "tensorflow/core/distributed_runtime/worker_interface.h"
 #include "tensorflow/core/framework/allocation_description.pb.h"
@@ -668,6 +669,10 @@ Status MasterSession::ReffedClientGraph::RunPartitionsHelper(
   if (pss->collect_partition_graphs) {
     exec_opts.set_record_partition_graphs(true);
   }
+  if (pss->max_variable_read_staleness_steps > 0) {
+    exec_opts.set_max_variable_read_staleness_steps(
+        pss->max_variable_read_staleness_steps);
+  }
   if (pss->collect_costs || pss->collect_timeline) {
     pss->step_stats.resize(partitions_.size());
   }
@@ -971,6 +976,21 @@ void MasterSession::ReffedClientGraph::ProcessStats(int64_t step_id,
   }
   // Assemble all stats for this timeline into a merged StepStats.
   if (pss->collect_timeline) {
+    if (options.trace_level() == RunOptions::FULL_TRACE) {
+      // The critical path follows the nodes of the partitions, leaving out
+      // the RPCs logged on their behalf.
+      StepStats partition_stats;
+      for (size_t i = 0; i < partitions_.size(); ++i) {
+        partition_stats.MergeFrom(pss->step_stats[i]);
+      }
+      Status s = ComputeStepCriticalPath(partition_stats,
+                                         resp->mutable_critical_path());
+      if (!s.ok()) {
+        LOG(WARNING) << "Failed to compute the critical path of step "
+                     << step_id << ": " << s;
+        resp->clear_critical_path();
+      }
+    }
     StepStats step_stats_proto;
     step_stats_proto.Swap(&pss->rpc_stats);
     for (size_t i = 0; i < partitions_.size(); ++i) {
@@ -1720,6 +1740,9 @@ Status MasterSession::BuildAndRegisterPartitions(ReffedClientGraph* rcg) {
       return dtype;
     }
   };
+  // Lets workers serve variable reads from a cache when a step asks for it
+  // with RunOptions.Experimental.max_variable_read_staleness_steps.
+  popts.tag_variable_reads = true;
   if (session_opts_.config.graph_options().enable_recv_scheduling()) {
     popts.scheduling_for_recvs = true;
     popts.need_to_record_start_times = true;
@@ -1904,6 +1927,8 @@ void MasterSession::FillPerStepState(MasterSession::ReffedClientGraph* rcg,
   out_pss->collect_rpcs = run_options.trace_level() == RunOptions::FULL_TRACE;
   out_pss->report_tensor_allocations_upon_oom =
       run_options.report_tensor_allocations_upon_oom();
+  out_pss->max_variable_read_staleness_steps =
+      run_options.experimental().max_variable_read_staleness_steps();
   // Build the cost model every 'build_cost_model_every' steps after skipping an
   // initial 'build_cost_model_after' steps.
   const int64_t build_cost_model_after =
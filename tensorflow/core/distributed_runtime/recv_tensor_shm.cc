@@ -0,0 +1,230 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/distributed_runtime/recv_tensor_shm.h"
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/random/random.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/host_info.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/strcat.h"
+#include "tensorflow/core/util/env_var.h"
+
+#if !defined(PLATFORM_WINDOWS)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif  // !defined(PLATFORM_WINDOWS)
+
+namespace tensorflow {
+namespace {
+
+// Below this size, copying the content into the response is cheaper than
+// creating and mapping a shared memory object.
+constexpr int64_t kMinShmBytes = 64 << 10;
+
+// The prefix of the names of the objects written by WriteRecvTensorShm.
+constexpr char kShmNamePrefix[] = "/tf_recv_tensor_";
+
+// How long after writing an object the sender unlinks it if the receiver
+// hasn't.
+constexpr uint64 kShmLeaseMicros = 5ull * 60 * 1000 * 1000;
+
+// Returns whether `name` may have been written by WriteRecvTensorShm: the
+// receiver must not open, let alone unlink, any other object.
+bool IsRecvTensorShmName(const std::string& name) {
+  return absl::StartsWith(name, kShmNamePrefix) &&
+         name.find('/', 1) == std::string::npos && name.size() <= 255;
+}
+
+Status CheckRecvTensorShmName(const std::string& name) {
+  if (!IsRecvTensorShmName(name)) {
+    return errors::InvalidArgument(
+        "'", name, "' is not a RecvTensor shared memory object.");
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace
+
+bool RecvTensorShmEnabled() {
+#if defined(PLATFORM_WINDOWS)
+  return false;
+#else
+  static const bool enabled = [] {
+    bool enabled = false;
+    Status s = ReadBoolFromEnvVar("TF_RECV_TENSOR_SHM_TRANSFER",
+                                  /*default_val=*/false, &enabled);
+    if (!s.ok()) {
+      LOG(WARNING) << s;
+    }
+    return enabled;
+  }();
+  return enabled;
+#endif  // defined(PLATFORM_WINDOWS)
+}
+
+void OfferRecvTensorShm(RecvTensorRequest* request) {
+  if (!RecvTensorShmEnabled()) return;
+  RecvTensorShmOffer offer;
+  offer.set_host(port::Hostname());
+  request->mutable_transport_options()->PackFrom(offer);
+}
+
+bool AcceptRecvTensorShm(const RecvTensorRequest& request) {
+  if (!RecvTensorShmEnabled()) return false;
+  RecvTensorShmOffer offer;
+  return request.transport_options().UnpackTo(&offer) &&
+         offer.host() == port::Hostname();
+}
+
+bool UseRecvTensorShm(const Tensor& tensor) {
+  return DataTypeCanUseMemcpy(tensor.dtype()) &&
+         tensor.TotalBytes() >= static_cast<size_t>(kMinShmBytes);
+}
+
+#if !defined(PLATFORM_WINDOWS)
+
+namespace {
+void UnlinkRecvTensorShm(const std::string& name) {
+  // Fails with ENOENT once the receiver has unlinked the object.
+  shm_unlink(name.c_str());
+}
+}  // namespace
+
+Status WriteRecvTensorShm(const Tensor& tensor, RecvTensorShm* shm) {
+  const std::string name = strings::StrCat(
+      kShmNamePrefix, getpid(), "_", strings::Hex(random::New64()));
+  const size_t size = tensor.TotalBytes();
+  const int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+  if (fd < 0) {
+    return errors::IOError(absl::StrCat("Failed to create ", name), errno);
+  }
+  void* base = MAP_FAILED;
+  int error = 0;
+  if (ftruncate(fd, size) == 0) {
+    base = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  }
+  if (base == MAP_FAILED) error = errno;
+  close(fd);
+  if (base == MAP_FAILED) {
+    shm_unlink(name.c_str());
+    return errors::IOError(absl::StrCat("Failed to map ", name), error);
+  }
+  std::memcpy(base, tensor.tensor_data().data(), size);
+  munmap(base, size);
+  shm->set_name(name);
+  shm->set_size(size);
+  return absl::OkStatus();
+}
+
+Status ReadRecvTensorShm(const RecvTensorShm& shm, char* data, size_t size) {
+  const std::string& name = shm.name();
+  TF_RETURN_IF_ERROR(CheckRecvTensorShmName(name));
+  if (static_cast<size_t>(shm.size()) != size) {
+    return errors::InvalidArgument(name, " holds ", shm.size(),
+                                   " bytes instead of the ", size,
+                                   " bytes of the received tensor.");
+  }
+  const int fd = shm_open(name.c_str(), O_RDONLY, 0600);
+  if (fd < 0) {
+    return errors::IOError(absl::StrCat("Failed to open ", name), errno);
+  }
+  // The name is no longer needed once opened, whatever happens next.
+  shm_unlink(name.c_str());
+  struct stat st;
+  if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < size) {
+    close(fd);
+    return errors::InvalidArgument(name, " does not hold the ", size,
+                                   " bytes of the received tensor.");
+  }
+  if (size == 0) {
+    close(fd);
+    return absl::OkStatus();
+  }
+  void* base = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+  const int error = errno;
+  close(fd);
+  if (base == MAP_FAILED) {
+    return errors::IOError(absl::StrCat("Failed to map ", name), error);
+  }
+  std::memcpy(data, base, size);
+  munmap(base, size);
+  return absl::OkStatus();
+}
+
+#else  // defined(PLATFORM_WINDOWS)
+
+namespace {
+void UnlinkRecvTensorShm(const std::string& name) {}
+}  // namespace
+
+Status WriteRecvTensorShm(const Tensor& tensor, RecvTensorShm* shm) {
+  return errors::Unimplemented(
+      "RecvTensor shared memory transfer is not supported on Windows.");
+}
+
+Status ReadRecvTensorShm(const RecvTensorShm& shm, char* data, size_t size) {
+  return errors::Unimplemented(
+      "RecvTensor shared memory transfer is not supported on Windows.");
+}
+
+#endif  // !defined(PLATFORM_WINDOWS)
+
+RecvTensorShmTracker::~RecvTensorShmTracker() {
+  mutex_lock l(mu_);
+  for (const auto& object : objects_) {
+    UnlinkRecvTensorShm(object.second);
+  }
+}
+
+Status RecvTensorShmTracker::Write(const Tensor& tensor, RecvTensorShm* shm) {
+  TF_RETURN_IF_ERROR(WriteRecvTensorShm(tensor, shm));
+  const uint64 now_micros = Env::Default()->NowMicros();
+  std::vector<std::string> expired;
+  {
+    mutex_lock l(mu_);
+    while (!objects_.empty() &&
+           objects_.front().first + kShmLeaseMicros <= now_micros) {
+      expired.push_back(std::move(objects_.front().second));
+      objects_.pop_front();
+    }
+    objects_.emplace_back(now_micros, shm->name());
+  }
+  for (const std::string& name : expired) {
+    UnlinkRecvTensorShm(name);
+  }
+  return absl::OkStatus();
+}
+
+void RecvTensorShmTracker::Abort(const RecvTensorShm& shm) {
+  if (!IsRecvTensorShmName(shm.name())) return;
+  VLOG(2) << "Unlinking " << shm.name() << ", its response failed.";
+  UnlinkRecvTensorShm(shm.name());
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,102 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RECV_TENSOR_SHM_H_
+#define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RECV_TENSOR_SHM_H_
+
+#include <cstddef>
+#include <deque>
+#include <string>
+#include <utility>
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/protobuf/transport_options.pb.h"
+#include "tensorflow/core/protobuf/worker.pb.h"
+
+namespace tensorflow {
+
+// Helpers to move the content of RecvTensor responses between worker
+// processes on the same host through POSIX shared memory, while the request
+// and the tensor metadata still go through the RPC.
+//
+// Both workers must set TF_RECV_TENSOR_SHM_TRANSFER=1.  The receiver then
+// offers shared memory on each request, and the sender accepts the offer for
+// large tensors when both share a hostname.  Every accepted response uses a
+// fresh shared memory object, which the receiver unlinks after copying it.
+// The sender tracks the objects it writes, see RecvTensorShmTracker, so that
+// the ones whose response never reaches the receiver are unlinked too.
+
+// Returns whether TF_RECV_TENSOR_SHM_TRANSFER is set.  Read once.
+bool RecvTensorShmEnabled();
+
+// Offers to receive the response to `request` through shared memory, if
+// enabled in this process.
+void OfferRecvTensorShm(RecvTensorRequest* request);
+
+// Returns whether the response to `request` may carry its tensor content
+// through shared memory: shared memory is enabled in this process and the
+// request comes from a receiver on the same host.
+bool AcceptRecvTensorShm(const RecvTensorRequest& request);
+
+// Returns whether the content of `tensor` is worth moving through shared
+// memory rather than inline in the response.
+bool UseRecvTensorShm(const Tensor& tensor);
+
+// Writes the content of `tensor` into a new shared memory object described
+// by `shm`.
+Status WriteRecvTensorShm(const Tensor& tensor, RecvTensorShm* shm);
+
+// Copies the `size` bytes of the shared memory object described by `shm`
+// into `data`, and unlinks it.  Fails without opening anything if `shm` does
+// not name an object written by WriteRecvTensorShm, or holds another size.
+Status ReadRecvTensorShm(const RecvTensorShm& shm, char* data, size_t size);
+
+// Tracks the shared memory objects written by a sender until they are
+// unlinked: by the receiver once it reads them, by Abort if the response
+// fails, and otherwise once they are a lease old or the tracker is destroyed.
+class RecvTensorShmTracker {
+ public:
+  RecvTensorShmTracker() = default;
+  // Unlinks the objects that are still tracked.
+  ~RecvTensorShmTracker();
+
+  // Writes the content of `tensor` like WriteRecvTensorShm, and tracks the new
+  // object.  Also unlinks the objects written more than a lease ago: their
+  // receiver reads them as soon as the response arrives, so their response
+  // is assumed lost.
+  Status Write(const Tensor& tensor, RecvTensorShm* shm);
+
+  // Unlinks the object described by `shm`, whose response did not reach the
+  // receiver.
+  void Abort(const RecvTensorShm& shm);
+
+ private:
+  mutex mu_;
+  // The names of the tracked objects with their write times, oldest first.
+  // The aborted ones stay until their lease expires, unlinking a name twice
+  // is harmless.
+  std::deque<std::pair<uint64, std::string>> objects_ TF_GUARDED_BY(mu_);
+
+  RecvTensorShmTracker(const RecvTensorShmTracker&) = delete;
+  void operator=(const RecvTensorShmTracker&) = delete;
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RECV_TENSOR_SHM_H_
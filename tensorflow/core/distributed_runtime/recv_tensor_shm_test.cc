@@ -0,0 +1,120 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/distributed_runtime/recv_tensor_shm.h"
+
+#include <cstdlib>
+#include <vector>
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/host_info.h"
+#include "tensorflow/core/platform/strcat.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/protobuf/transport_options.pb.h"
+#include "tensorflow/core/protobuf/worker.pb.h"
+
+namespace tensorflow {
+namespace {
+
+TEST(RecvTensorShmTest, RoundTrip) {
+  Tensor src(DT_INT32, TensorShape({64 << 10}));
+  auto flat = src.flat<int32>();
+  for (int i = 0; i < flat.size(); ++i) flat(i) = i;
+  RecvTensorShm shm;
+  TF_ASSERT_OK(WriteRecvTensorShm(src, &shm));
+  EXPECT_EQ(static_cast<size_t>(shm.size()), src.TotalBytes());
+
+  Tensor dst(DT_INT32, src.shape());
+  TF_ASSERT_OK(ReadRecvTensorShm(
+      shm, const_cast<char*>(dst.tensor_data().data()), dst.TotalBytes()));
+  test::ExpectTensorEqual<int32>(dst, src);
+
+  // The object was unlinked by the first read.
+  EXPECT_FALSE(ReadRecvTensorShm(shm,
+                                 const_cast<char*>(dst.tensor_data().data()),
+                                 dst.TotalBytes())
+                   .ok());
+}
+
+TEST(RecvTensorShmTest, SizeMismatch) {
+  Tensor src(DT_FLOAT, TensorShape({16}));
+  src.flat<float>().setZero();
+  RecvTensorShm shm;
+  TF_ASSERT_OK(WriteRecvTensorShm(src, &shm));
+  std::vector<char> dst(2 * src.TotalBytes());
+  EXPECT_TRUE(errors::IsInvalidArgument(
+      ReadRecvTensorShm(shm, dst.data(), dst.size())));
+  // The size is checked before opening the object, which is still there.
+  TF_EXPECT_OK(ReadRecvTensorShm(shm, dst.data(), src.TotalBytes()));
+}
+
+TEST(RecvTensorShmTest, OnlyRecvTensorObjects) {
+  std::vector<char> dst(16);
+  for (const char* name :
+       {"/other", "tf_recv_tensor_1", "/tf_recv_tensor_1/../other"}) {
+    RecvTensorShm shm;
+    shm.set_name(name);
+    shm.set_size(dst.size());
+    EXPECT_TRUE(errors::IsInvalidArgument(
+        ReadRecvTensorShm(shm, dst.data(), dst.size())))
+        << name;
+  }
+}
+
+TEST(RecvTensorShmTest, TrackerUnlinksUnreadObjects) {
+  Tensor src(DT_INT32, TensorShape({16}));
+  src.flat<int32>().setZero();
+  Tensor dst(DT_INT32, src.shape());
+  char* data = const_cast<char*>(dst.tensor_data().data());
+
+  RecvTensorShm aborted;
+  RecvTensorShm read;
+  RecvTensorShm unread;
+  {
+    RecvTensorShmTracker tracker;
+    TF_ASSERT_OK(tracker.Write(src, &aborted));
+    TF_ASSERT_OK(tracker.Write(src, &read));
+    TF_ASSERT_OK(tracker.Write(src, &unread));
+    tracker.Abort(aborted);
+    EXPECT_FALSE(ReadRecvTensorShm(aborted, data, dst.TotalBytes()).ok());
+    TF_EXPECT_OK(ReadRecvTensorShm(read, data, dst.TotalBytes()));
+  }
+  EXPECT_FALSE(ReadRecvTensorShm(unread, data, dst.TotalBytes()).ok());
+}
+
+TEST(RecvTensorShmTest, OnlySameHostLargeTensors) {
+  setenv("TF_RECV_TENSOR_SHM_TRANSFER", "1", /*overwrite=*/1);
+  ASSERT_TRUE(RecvTensorShmEnabled());
+
+  RecvTensorRequest request;
+  EXPECT_FALSE(AcceptRecvTensorShm(request));
+  OfferRecvTensorShm(&request);
+  EXPECT_TRUE(AcceptRecvTensorShm(request));
+
+  RecvTensorShmOffer offer;
+  offer.set_host(strings::StrCat(port::Hostname(), ".elsewhere"));
+  request.mutable_transport_options()->PackFrom(offer);
+  EXPECT_FALSE(AcceptRecvTensorShm(request));
+
+  EXPECT_FALSE(UseRecvTensorShm(Tensor(DT_FLOAT, TensorShape({16}))));
+  EXPECT_TRUE(UseRecvTensorShm(Tensor(DT_FLOAT, TensorShape({1 << 20}))));
+  EXPECT_FALSE(UseRecvTensorShm(Tensor(DT_STRING, TensorShape({1 << 14}))));
+}
+
+}  // namespace
+}  // namespace tensorflow
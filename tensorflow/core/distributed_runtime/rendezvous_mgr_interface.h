@@ -47,6 +47,10 @@ class RemoteRendezvous : public Rendezvous {
   // In remote eager, get if current instance is context default rendezvous.
   virtual bool IsRemoteEagerContextDefault() = 0;
 
+  // Lets receives of variable values in this step be served with values
+  // received in up to `steps` earlier steps. Zero, the default, disables it.
+  virtual void SetMaxVariableReadStaleness(int64_t steps) {}
+
  protected:
   bool is_cross_process() override { return true; }
 };
@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/rpc/grpc_tensor_coding.h"
 
+#include <vector>
+
 #include "grpcpp/support/byte_buffer.h"
 #include "grpcpp/support/slice.h"
 #include "tensorflow/core/common_runtime/dma_helper.h"
@@ -134,6 +136,87 @@ static void EncodeSkeleton(const Tensor& val, io::ProtoEncodeHelper* e) {
 #endif
 }
 
+// Encodes "response" with the DT_STRING tensor "val" as R.tensor() into
+// "*result", writing the string_val fields straight from the elements of
+// "val" instead of going through a TensorProto:
+//
+// A, B1, B2, C: as above
+// F1:  <tag encoding for TensorProto::string_val>
+// F2:  <varint32 length of the element>
+// G:   <actual data of the element>
+//
+// with F1 through G repeated for every element. The elements larger than
+// "large_string_bytes" share the backing store of "val" through their own
+// grpc::Slice, like E above for the large tensors, and the rest of the
+// encoding is written into a single grpc::Slice that the ByteBuffer
+// references piecewise in between.
+static void EncodeStringTensorToByteBuffer(const RecvTensorResponse& response,
+                                           const Tensor& val,
+                                           size_t large_string_bytes,
+                                           ::grpc::ByteBuffer* result) {
+  gtl::InlinedVector<char, 128> skeleton(SkeletonEncodingSizeUpperBound(val));
+  io::ProtoEncodeHelper e_skeleton(skeleton.data(), skeleton.size());
+  EncodeSkeleton(val, &e_skeleton);
+
+  const auto strings = val.flat<tstring>();
+  uint32 overall_tensor_proto_bytesize = e_skeleton.size();
+  size_t shared_bytes = 0;
+  for (int64_t i = 0; i < strings.size(); ++i) {
+    const size_t size = strings(i).size();
+    overall_tensor_proto_bytesize +=
+        VarLengthEncodingSize(TensorProto::kStringValFieldNumber, size);
+    if (size > large_string_bytes) shared_bytes += size;
+  }
+  string header;  // All of RecvTensorResponse except the tensor() field
+  response.AppendToString(&header);
+
+  size_t expected_size =
+      (header.size() +
+       VarLengthEncodingSize(RecvTensorResponse::kTensorFieldNumber,
+                             overall_tensor_proto_bytesize));
+  ::grpc::Slice copied(expected_size - shared_bytes);
+  io::ProtoEncodeHelper e(
+      reinterpret_cast<char*>(const_cast<uint8_t*>(copied.begin())),
+      copied.size());
+  // (A)
+  e.WriteRawBytes(header);
+  // (B1) & (B2)
+  e.WriteVarlengthBeginning(RecvTensorResponse::kTensorFieldNumber,
+                            overall_tensor_proto_bytesize);
+  // (C)
+  e.WriteRawBytes(StringPiece(e_skeleton.data(), e_skeleton.size()));
+
+  std::vector<::grpc::Slice> slices;
+  size_t copied_begin = 0;
+  for (int64_t i = 0; i < strings.size(); ++i) {
+    const tstring& s = strings(i);
+    // (F1) & (F2)
+    e.WriteVarlengthBeginning(TensorProto::kStringValFieldNumber, s.size());
+    if (s.size() <= large_string_bytes) {
+      // (G)
+      e.WriteRawBytes(s);
+      continue;
+    }
+    // (G) Encode the element by sharing the backing store of "val", which
+    // owns the element data.
+    slices.push_back(copied.sub(copied_begin, e.size()));
+    copied_begin = e.size();
+    const TensorBuffer* buf = DMAHelper::buffer(&val);
+    buf->Ref();
+    slices.push_back(::grpc::Slice(
+        const_cast<char*>(s.data()), s.size(),
+        [](void* backing) { static_cast<TensorBuffer*>(backing)->Unref(); },
+        const_cast<TensorBuffer*>(buf)));
+  }
+  if (copied_begin < e.size()) {
+    slices.push_back(copied.sub(copied_begin, e.size()));
+  }
+  CHECK_EQ(e.size() + shared_bytes, expected_size);
+
+  ::grpc::ByteBuffer tmp(slices.data(), slices.size());
+  result->Swap(&tmp);
+}
+
 void EncodeTensorToByteBuffer(bool is_dead, const Tensor& val, bool require_ack,
                               ::grpc::ByteBuffer* result) {
   const int kLargeTensorBytes = 1024;
@@ -153,7 +236,9 @@ void EncodeTensorToByteBuffer(bool is_dead, const Tensor& val, bool require_ack,
   }
   response.set_require_ack(require_ack);
   response.set_send_start_micros(Env::Default()->NowMicros());
-  if (!DataTypeCanUseMemcpy(val.dtype())) {
+  if (val.dtype() == DT_STRING) {
+    EncodeStringTensorToByteBuffer(response, val, kLargeTensorBytes, result);
+  } else if (!DataTypeCanUseMemcpy(val.dtype())) {
     // Straightforward but slow path for complicated kinds of tensor data
     // TODO(jeff,sanjay): If this becomes an issue, we could
     // go directly from val -> ByteBuffer, with some effort.
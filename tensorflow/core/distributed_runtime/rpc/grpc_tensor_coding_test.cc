@@ -100,4 +100,15 @@ TEST_F(GrpcTensorCodingTest, Simple) {
 
 TEST_F(GrpcTensorCodingTest, StringTensor) { DoTestForStrings(DT_STRING); }
 
+TEST_F(GrpcTensorCodingTest, LargeStrings) {
+  // The large elements share the backing store of the tensor.
+  Tensor a(DT_STRING, TensorShape({5}));
+  test::FillValues<tstring>(&a, {string(5000, 'a'), "b", string(1025, 'c'),
+                                 string(2000, 'd'), ""});
+  Validate(a, false);
+  Tensor b(DT_STRING, TensorShape({}));
+  b.scalar<tstring>()() = string(10000, 'e');
+  Validate(b, false);
+}
+
 }  // namespace tensorflow
@@ -34,6 +34,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/process_util.h"
 #include "tensorflow/core/common_runtime/step_stats_collector.h"
 #include "tensorflow/core/distributed_runtime/graph_mgr.h"
+#include "tensorflow/core/distributed_runtime/recv_tensor_shm.h"
 #include "tensorflow/core/distributed_runtime/rendezvous_mgr_interface.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_tensor_coding.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_util.h"
@@ -272,11 +273,18 @@ class GrpcWorkerServiceThread {
 
       worker_->GrpcRecvTensorAsync(
           call_opts, &call->request, &call->response,
-          [call, call_opts](const Status& s) {
+          [worker = worker_, call, call_opts](const Status& s) {
             call->ClearCancelCallback();
             delete call_opts;
             if (!s.ok()) {
               VLOG(3) << "Bad response from RecvTensor:" << s;
+            } else if (AcceptRecvTensorShm(call->request)) {
+              // The receiver unlinks the shared memory object of the
+              // response once it reads it, which it can't if the response
+              // doesn't reach it.
+              call->SetCancelCallback([worker, call]() {
+                worker->AbortRecvTensorShm(&call->response);
+              });
             }
             call->SendResponse(ToGrpcStatus(s));
           });
@@ -434,6 +442,42 @@ void GrpcWorker::EnableResponseCache() {
   response_cache_ = std::make_unique<RpcResponseCache>();
 }
 
+namespace {
+// Encodes the response to a RecvTensor from a receiver on the same host,
+// moving the content of `val` through shared memory so that only the
+// metadata goes through gRPC.  Falls back to the regular encoding if the
+// shared memory object cannot be created.
+void EncodeTensorToShm(const Tensor& val, bool require_ack,
+                       RecvTensorShmTracker* tracker,
+                       ::grpc::ByteBuffer* result) {
+  RecvTensorShm shm;
+  Status s = tracker->Write(val, &shm);
+  if (!s.ok()) {
+    LOG_EVERY_N_SEC(WARNING, 60)
+        << "Sending RecvTensor response inline: " << s;
+    grpc::EncodeTensorToByteBuffer(/*is_dead=*/false, val, require_ack,
+                                   result);
+    return;
+  }
+  RecvTensorResponse response;
+  response.mutable_tensor()->set_dtype(val.dtype());
+  val.shape().AsProto(response.mutable_tensor()->mutable_tensor_shape());
+  response.set_require_ack(require_ack);
+  response.set_send_start_micros(Env::Default()->NowMicros());
+  response.mutable_transport_options()->PackFrom(shm);
+  grpc::EncodeRecvTensorResponseToByteBuffer(response, result);
+}
+}  // namespace
+
+void GrpcWorker::AbortRecvTensorShm(::grpc::ByteBuffer* response) {
+  RecvTensorResponse parsed;
+  RecvTensorShm shm;
+  if (tsl::GrpcMaybeParseProto(response, &parsed) &&
+      parsed.transport_options().UnpackTo(&shm)) {
+    recv_tensor_shm_tracker_.Abort(shm);
+  }
+}
+
 // GrpcRecvTensorAsync: unlike the other Worker methods, which use protocol
 // buffers for a response object, to avoid extra protocol buffer serialization
 // overhead we generate our response directly into a ::grpc::ByteBuffer object
@@ -446,12 +490,19 @@ void GrpcWorker::GrpcRecvTensorAsync(CallOptions* opts,
   const int64_t step_id = request->step_id();
 
   bool cache_enabled = (response_cache_ != nullptr && request_id != 0);
+  const bool shm_accepted = AcceptRecvTensorShm(*request);
 
-  auto do_response = [response, done, cache_enabled](const Tensor& tensor,
-                                                     bool is_dead,
-                                                     const Status& status) {
+  auto do_response = [this, response, done, cache_enabled, shm_accepted](
+                         const Tensor& tensor, bool is_dead,
+                         const Status& status) {
     if (status.ok()) {
-      grpc::EncodeTensorToByteBuffer(is_dead, tensor, cache_enabled, response);
+      if (shm_accepted && !is_dead && UseRecvTensorShm(tensor)) {
+        EncodeTensorToShm(tensor, cache_enabled, &recv_tensor_shm_tracker_,
+                          response);
+      } else {
+        grpc::EncodeTensorToByteBuffer(is_dead, tensor, cache_enabled,
+                                       response);
+      }
     }
     done(status);
   };
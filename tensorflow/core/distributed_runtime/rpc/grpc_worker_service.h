@@ -21,6 +21,7 @@ limitations under the License.
 
 #include "grpcpp/server_builder.h"
 #include "xla/tsl/distributed_runtime/rpc/async_service_interface.h"
+#include "tensorflow/core/distributed_runtime/recv_tensor_shm.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_worker_service_impl.h"
 #include "tensorflow/core/distributed_runtime/rpc/rpc_response_cache.h"
 #include "tensorflow/core/distributed_runtime/worker.h"
@@ -51,6 +52,10 @@ class GrpcWorker : public Worker {
                                    ::grpc::ByteBuffer* response,
                                    StatusCallback done);
 
+  // Unlinks the shared memory object of a RecvTensor `response` encoded by
+  // GrpcRecvTensorAsync, if any, when it failed to reach the receiver.
+  void AbortRecvTensorShm(::grpc::ByteBuffer* response);
+
   void LoggingAsync(const LoggingRequest* request, LoggingResponse* response,
                     StatusCallback done) override;
 
@@ -70,6 +75,7 @@ class GrpcWorker : public Worker {
  private:
   std::unique_ptr<RpcResponseCache> response_cache_;
   const int32 recv_buf_max_chunk_;
+  RecvTensorShmTracker recv_tensor_shm_tracker_;
 };
 
 std::unique_ptr<GrpcWorker> NewGrpcWorker(WorkerEnv* worker_env,
@@ -15,20 +15,26 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/rpc/rpc_rendezvous_mgr.h"
 
+#include <string>
+
+#include "absl/container/flat_hash_map.h"
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/common_runtime/device_mgr.h"
 #include "tensorflow/core/common_runtime/dma_helper.h"
 #include "tensorflow/core/common_runtime/process_util.h"
+#include "tensorflow/core/distributed_runtime/recv_tensor_shm.h"
 #include "tensorflow/core/distributed_runtime/request_id.h"
 #include "tensorflow/core/distributed_runtime/tensor_coding.h"
 #include "tensorflow/core/distributed_runtime/worker_cache.h"
 #include "tensorflow/core/distributed_runtime/worker_interface.h"
+#include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/strings/numbers.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/notification.h"
 #include "tensorflow/core/platform/types.h"
 
@@ -47,7 +53,36 @@ class RpcRemoteRendezvous : public BaseRemoteRendezvous {
                            DoneCallback done) override;
 
  private:
-  ~RpcRemoteRendezvous() override {}
+  ~RpcRemoteRendezvous() override {
+    mutex_lock l(rpc_stats_mu_);
+    if (num_rpcs_ > 0) {
+      metrics::RecordRecvTensorRpcsPerStep(num_rpcs_, num_overlapping_rpcs_);
+    }
+  }
+
+  // Tracks the RecvTensor RPCs outstanding to each source worker, so that we
+  // can report how many of this step's RPCs could have been coalesced.
+  void RpcStarted(const string& src_worker) {
+    mutex_lock l(rpc_stats_mu_);
+    ++num_rpcs_;
+    if (outstanding_rpcs_[src_worker]++ > 0) {
+      ++num_overlapping_rpcs_;
+    }
+  }
+
+  void RpcDone(const string& src_worker) {
+    mutex_lock l(rpc_stats_mu_);
+    auto it = outstanding_rpcs_.find(src_worker);
+    if (--it->second == 0) {
+      outstanding_rpcs_.erase(it);
+    }
+  }
+
+  mutex rpc_stats_mu_;
+  absl::flat_hash_map<string, int64_t> outstanding_rpcs_
+      TF_GUARDED_BY(rpc_stats_mu_);
+  int64_t num_rpcs_ TF_GUARDED_BY(rpc_stats_mu_) = 0;
+  int64_t num_overlapping_rpcs_ TF_GUARDED_BY(rpc_stats_mu_) = 0;
 
   RpcRemoteRendezvous(const RpcRemoteRendezvous&) = delete;
   void operator=(const RpcRemoteRendezvous&) = delete;
@@ -69,6 +104,7 @@ class RpcRecvTensorCall : public BaseRecvTensorCall {
     req_.set_step_id(step_id);
     req_.set_rendezvous_key(key.data(), key.size());
     req_.set_request_id(GetUniqueRequestId());
+    OfferRecvTensorShm(&req_);
   }
 
   void Reset() {
@@ -289,7 +325,9 @@ void RpcRemoteRendezvous::RecvFromRemoteAsync(
 
   // Start "call".
   Ref();
+  RpcStarted(call->src_worker_);
   call->Start([this, call, recv_args, worker_cache]() {
+    RpcDone(call->src_worker_);
     // Removes "call" from calls_. Prevent StartAbort().
     DeregisterCall(call, recv_args);
     // If StartAbort was called prior to DeregisterCall, then the
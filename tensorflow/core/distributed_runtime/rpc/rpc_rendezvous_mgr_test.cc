@@ -342,4 +342,67 @@ TEST_F(RpcRendezvousMgrTest, RemoteRecvAsyncMany) {
   rmgr_.Cleanup(step_id);
 }
 
+TEST(VariableReadCacheTest, ServesRecentValues) {
+  VariableReadCache cache;
+  Tensor val;
+  bool refresh = false;
+  EXPECT_FALSE(cache.Lookup("key", /*step_seq=*/0, /*max_staleness=*/2, &val,
+                            &refresh));
+
+  cache.Insert("key", /*step_seq=*/0, V("a"));
+  // A value received in the current step needs no refresh.
+  ASSERT_TRUE(cache.Lookup("key", 0, 2, &val, &refresh));
+  EXPECT_EQ(V(val), "a");
+  EXPECT_FALSE(refresh);
+
+  // Older values are served while a single refresh is in flight.
+  ASSERT_TRUE(cache.Lookup("key", 2, 2, &val, &refresh));
+  EXPECT_EQ(V(val), "a");
+  EXPECT_TRUE(refresh);
+  ASSERT_TRUE(cache.Lookup("key", 2, 2, &val, &refresh));
+  EXPECT_FALSE(refresh);
+  EXPECT_FALSE(cache.Lookup("key", 3, 2, &val, &refresh));
+
+  cache.Insert("key", 2, V("b"));
+  ASSERT_TRUE(cache.Lookup("key", 3, 2, &val, &refresh));
+  EXPECT_EQ(V(val), "b");
+  EXPECT_TRUE(refresh);
+  cache.AbandonRefresh("key");
+  ASSERT_TRUE(cache.Lookup("key", 3, 2, &val, &refresh));
+  EXPECT_TRUE(refresh);
+
+  // A late value from an earlier step does not replace a newer one.
+  cache.Insert("key", 1, V("c"));
+  ASSERT_TRUE(cache.Lookup("key", 3, 2, &val, &refresh));
+  EXPECT_EQ(V(val), "b");
+}
+
+TEST(VariableReadCacheTest, EvictsStaleValues) {
+  VariableReadCache cache;
+  Tensor val;
+  bool refresh = false;
+  EXPECT_FALSE(cache.Lookup("old", /*step_seq=*/0, /*max_staleness=*/2, &val,
+                            &refresh));
+  cache.Insert("old", /*step_seq=*/0, V("a"));
+  cache.Insert("new", /*step_seq=*/1, V("b"));
+
+  // Both values can still be served in step 2.
+  cache.EvictStale(/*step_seq=*/2);
+  ASSERT_TRUE(cache.Lookup("old", 2, 2, &val, &refresh));
+  ASSERT_TRUE(cache.Lookup("new", 2, 2, &val, &refresh));
+
+  // Only "old" is too old for step 3, and it stays evicted with a larger
+  // staleness bound.
+  cache.EvictStale(/*step_seq=*/3);
+  EXPECT_FALSE(cache.Lookup("old", 3, 5, &val, &refresh));
+  ASSERT_TRUE(cache.Lookup("new", 3, 5, &val, &refresh));
+  EXPECT_EQ(V(val), "b");
+
+  // The largest staleness bound looked up so far is used.
+  cache.EvictStale(/*step_seq=*/6);
+  EXPECT_TRUE(cache.Lookup("new", 6, 5, &val, &refresh));
+  cache.EvictStale(/*step_seq=*/7);
+  EXPECT_FALSE(cache.Lookup("new", 7, 5, &val, &refresh));
+}
+
 }  // namespace tensorflow
@@ -0,0 +1,314 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/distributed_runtime/step_critical_path.h"
+
+#include <algorithm>
+#include <deque>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/strcat.h"
+#include "tensorflow/core/util/device_name_utils.h"
+
+namespace tensorflow {
+namespace {
+
+struct NodeInfo {
+  int device = 0;
+  int task = 0;
+  const NodeExecStats* stats = nullptr;
+  // On the clock of the node's task until the offsets are applied.
+  int64_t start = 0;
+  int64_t end = 0;
+  bool is_send = false;
+  bool is_recv = false;
+  string tensor_name;
+  string peer_device;
+  // For a _Recv, the matching _Send, if any.
+  int send = -1;
+  // The node on the same device that finished last before this one started.
+  int device_pred = -1;
+};
+
+// Bounds on the clock offset of task `b` minus the offset of task `a`.
+struct OffsetBounds {
+  bool has_lower = false;
+  bool has_upper = false;
+  int64_t lower = 0;
+  int64_t upper = 0;
+
+  void AddLower(int64_t v) {
+    lower = has_lower ? std::max(lower, v) : v;
+    has_lower = true;
+  }
+  void AddUpper(int64_t v) {
+    upper = has_upper ? std::min(upper, v) : v;
+    has_upper = true;
+  }
+  int64_t Resolve() const {
+    if (has_lower && has_upper) return lower + (upper - lower) / 2;
+    if (has_lower) return std::max<int64_t>(lower, 0);
+    if (has_upper) return std::min<int64_t>(upper, 0);
+    return 0;
+  }
+};
+
+string TaskName(const string& device) {
+  DeviceNameUtils::ParsedName parsed;
+  string task;
+  if (DeviceNameUtils::ParseFullName(device, &parsed) &&
+      DeviceNameUtils::GetTaskName(parsed, &task)) {
+    return task;
+  }
+  return device;
+}
+
+// Parses the "name = op(tensor_name @peer_device)" label StepStatsCollector
+// sets on _Send and _Recv nodes.
+Status ParseTransferLabel(NodeInfo* node) {
+  const string& label = node->stats->timeline_label();
+  const string prefix = strings::StrCat(node->stats->node_name(), " = ");
+  size_t pos = label.find(prefix);
+  if (pos == string::npos) return absl::OkStatus();
+  absl::string_view rest = absl::string_view(label).substr(pos + prefix.size());
+  size_t paren = rest.find('(');
+  if (paren == absl::string_view::npos) return absl::OkStatus();
+  absl::string_view op = rest.substr(0, paren);
+  node->is_send = op == "_Send" || op == "_HostSend";
+  node->is_recv = op == "_Recv" || op == "_HostRecv";
+  if (!node->is_send && !node->is_recv) return absl::OkStatus();
+  absl::string_view args = rest.substr(paren + 1);
+  size_t at = args.rfind(" @");
+  if (at == absl::string_view::npos || args.empty() || args.back() != ')') {
+    return errors::InvalidArgument("Malformed timeline label for ", op,
+                                   " node ", node->stats->node_name(), ": ",
+                                   label);
+  }
+  node->tensor_name = string(args.substr(0, at));
+  node->peer_device = string(args.substr(at + 2, args.size() - at - 3));
+  return absl::OkStatus();
+}
+
+string TransferKey(const string& tensor_name, const string& send_device,
+                   const string& recv_device) {
+  return strings::StrCat(tensor_name, ";", send_device, ";", recv_device);
+}
+
+}  // namespace
+
+Status ComputeStepCriticalPath(const StepStats& step_stats,
+                               StepCriticalPath* path) {
+  path->Clear();
+
+  std::vector<const string*> device_names;
+  std::map<string, int> task_index;
+  std::vector<string> task_names;
+  std::vector<NodeInfo> nodes;
+  for (const DeviceStepStats& ds : step_stats.dev_stats()) {
+    const int device = device_names.size();
+    device_names.push_back(&ds.device());
+    const string task_name = TaskName(ds.device());
+    auto [it, inserted] = task_index.emplace(task_name, task_names.size());
+    if (inserted) task_names.push_back(task_name);
+    for (const NodeExecStats& ns : ds.node_stats()) {
+      NodeInfo node;
+      node.device = device;
+      node.task = it->second;
+      node.stats = &ns;
+      node.start = ns.all_start_micros();
+      node.end = node.start + ns.all_end_rel_micros();
+      TF_RETURN_IF_ERROR(ParseTransferLabel(&node));
+      nodes.push_back(std::move(node));
+    }
+  }
+  if (nodes.empty()) return absl::OkStatus();
+
+  // Match each _Recv with the _Send of the same tensor, in start order when
+  // the same tensor is sent several times in the step.
+  std::vector<int> by_start(nodes.size());
+  for (int i = 0; i < nodes.size(); ++i) by_start[i] = i;
+  std::sort(by_start.begin(), by_start.end(), [&nodes](int a, int b) {
+    return nodes[a].start < nodes[b].start;
+  });
+  absl::flat_hash_map<string, std::deque<int>> pending_sends;
+  for (int i : by_start) {
+    if (nodes[i].is_send) {
+      pending_sends[TransferKey(nodes[i].tensor_name,
+                                *device_names[nodes[i].device],
+                                nodes[i].peer_device)]
+          .push_back(i);
+    }
+  }
+  std::vector<int> recvs;
+  for (int i : by_start) {
+    NodeInfo& node = nodes[i];
+    if (!node.is_recv) continue;
+    auto it = pending_sends.find(TransferKey(
+        node.tensor_name, node.peer_device, *device_names[node.device]));
+    if (it == pending_sends.end() || it->second.empty()) continue;
+    node.send = it->second.front();
+    it->second.pop_front();
+    recvs.push_back(i);
+  }
+
+  // Align the task clocks: a _Recv cannot finish before its _Send starts.
+  // Each offset is resolved against a neighbouring task already aligned,
+  // starting from the first task.
+  const int num_tasks = task_names.size();
+  std::map<std::pair<int, int>, OffsetBounds> bounds;
+  for (int r : recvs) {
+    const NodeInfo& recv = nodes[r];
+    const NodeInfo& send = nodes[recv.send];
+    if (send.task == recv.task) continue;
+    const int64_t lower = send.start - recv.end;
+    if (send.task < recv.task) {
+      bounds[{send.task, recv.task}].AddLower(lower);
+    } else {
+      bounds[{recv.task, send.task}].AddUpper(-lower);
+    }
+  }
+  std::vector<int64_t> offsets(num_tasks, 0);
+  std::vector<bool> aligned(num_tasks, false);
+  aligned[0] = true;
+  std::deque<int> queue = {0};
+  while (!queue.empty()) {
+    const int a = queue.front();
+    queue.pop_front();
+    for (const auto& [tasks, bound] : bounds) {
+      int b;
+      int64_t offset;
+      if (tasks.first == a) {
+        b = tasks.second;
+        offset = offsets[a] + bound.Resolve();
+      } else if (tasks.second == a) {
+        b = tasks.first;
+        offset = offsets[a] - bound.Resolve();
+      } else {
+        continue;
+      }
+      if (aligned[b]) continue;
+      aligned[b] = true;
+      offsets[b] = offset;
+      queue.push_back(b);
+    }
+  }
+  for (NodeInfo& node : nodes) {
+    node.start += offsets[node.task];
+    node.end += offsets[node.task];
+  }
+
+  // Find the device predecessor of each node.
+  std::vector<std::vector<int>> by_end(device_names.size());
+  for (int i = 0; i < nodes.size(); ++i) by_end[nodes[i].device].push_back(i);
+  for (std::vector<int>& device_nodes : by_end) {
+    std::sort(device_nodes.begin(), device_nodes.end(),
+              [&nodes](int a, int b) { return nodes[a].end < nodes[b].end; });
+    for (int i : device_nodes) {
+      NodeInfo& node = nodes[i];
+      auto it = std::upper_bound(
+          device_nodes.begin(), device_nodes.end(), node.start,
+          [&nodes](int64_t t, int j) { return t < nodes[j].end; });
+      // Skip empty nodes that start at the same time, which would otherwise
+      // be each other's predecessors.
+      while (it != device_nodes.begin()) {
+        --it;
+        if (nodes[*it].start < node.start) {
+          node.device_pred = *it;
+          break;
+        }
+      }
+    }
+  }
+
+  // Follow the path back from the node that finished last.
+  int last = 0;
+  for (int i = 1; i < nodes.size(); ++i) {
+    if (nodes[i].end > nodes[last].end) last = i;
+  }
+  std::vector<int> critical_nodes;
+  std::vector<bool> via_transfer;
+  std::vector<bool> visited(nodes.size(), false);
+  for (int cur = last; cur >= 0 && !visited[cur];) {
+    visited[cur] = true;
+    critical_nodes.push_back(cur);
+    const NodeInfo& node = nodes[cur];
+    const bool use_send = node.send >= 0 &&
+                          (node.device_pred < 0 ||
+                           nodes[node.send].end > nodes[node.device_pred].end);
+    via_transfer.push_back(use_send);
+    cur = use_send ? node.send : node.device_pred;
+  }
+  std::reverse(critical_nodes.begin(), critical_nodes.end());
+  std::reverse(via_transfer.begin(), via_transfer.end());
+
+  auto* task_micros = path->mutable_task_micros();
+  std::vector<bool> critical_transfer(nodes.size(), false);
+  for (int k = 0; k < critical_nodes.size(); ++k) {
+    const NodeInfo& node = nodes[critical_nodes[k]];
+    // The first node has no predecessor on the path.
+    const bool has_pred = k > 0;
+    const int64_t ready =
+        has_pred ? nodes[critical_nodes[k - 1]].end : node.start;
+    const int64_t critical =
+        std::max<int64_t>(0, node.end - std::max(node.start, ready));
+    const int64_t idle = std::max<int64_t>(0, node.start - ready);
+    StepCriticalPath::Node* out = path->add_nodes();
+    out->set_device(*device_names[node.device]);
+    out->set_node_name(node.stats->node_name());
+    out->set_start_micros(node.start);
+    out->set_end_micros(node.end);
+    out->set_via_transfer(has_pred && via_transfer[k]);
+    out->set_critical_micros(critical);
+    out->set_idle_micros(idle);
+    if (node.is_recv) {
+      path->set_recv_micros(path->recv_micros() + critical);
+    } else {
+      path->set_compute_micros(path->compute_micros() + critical);
+    }
+    path->set_idle_micros(path->idle_micros() + idle);
+    (*task_micros)[task_names[node.task]] += critical + idle;
+    if (has_pred && via_transfer[k]) {
+      critical_transfer[critical_nodes[k]] = true;
+    }
+  }
+  path->set_start_micros(nodes[critical_nodes.front()].start);
+  path->set_end_micros(nodes[critical_nodes.back()].end);
+
+  for (int r : recvs) {
+    const NodeInfo& recv = nodes[r];
+    const NodeInfo& send = nodes[recv.send];
+    StepCriticalPath::Transfer* out = path->add_transfers();
+    out->set_tensor_name(recv.tensor_name);
+    out->set_send_device(*device_names[send.device]);
+    out->set_recv_device(*device_names[recv.device]);
+    out->set_latency_micros(recv.end - send.end);
+    out->set_slack_micros(std::max<int64_t>(0, recv.start - send.end));
+    out->set_on_critical_path(critical_transfer[r]);
+  }
+
+  auto* clock_offsets = path->mutable_clock_offset_micros();
+  for (int t = 0; t < num_tasks; ++t) {
+    (*clock_offsets)[task_names[t]] = offsets[t];
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace tensorflow
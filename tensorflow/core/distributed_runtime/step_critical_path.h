@@ -0,0 +1,42 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_STEP_CRITICAL_PATH_H_
+#define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_STEP_CRITICAL_PATH_H_
+
+#include "tensorflow/core/framework/step_stats.pb.h"
+#include "tensorflow/core/platform/status.h"
+
+namespace tensorflow {
+
+// Computes the critical path of a step from the StepStats collected on all
+// devices that ran its partitions.
+//
+// The node stats of each device must carry the timeline labels set by
+// StepStatsCollector, from which each _Recv is matched with the _Send of the
+// same tensor.  A node is reached either from the node on its device that
+// finished last before it started or, for a _Recv, from its matching _Send,
+// whichever finished later.  The path is followed back from the node that
+// finished last in the step.
+//
+// Devices of the same task share a clock.  The clocks of other tasks are
+// shifted so that no _Recv finishes before its _Send starts, splitting the
+// difference when transfers in both directions bound the offset.
+Status ComputeStepCriticalPath(const StepStats& step_stats,
+                               StepCriticalPath* path);
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_STEP_CRITICAL_PATH_H_
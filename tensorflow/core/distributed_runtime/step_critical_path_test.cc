@@ -0,0 +1,139 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/distributed_runtime/step_critical_path.h"
+
+#include "tensorflow/core/framework/step_stats.pb.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/strcat.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+constexpr char kTask0[] = "/job:worker/replica:0/task:0";
+constexpr char kTask1[] = "/job:worker/replica:0/task:1";
+
+DeviceStepStats* AddDevice(StepStats* ss, const string& device) {
+  DeviceStepStats* ds = ss->add_dev_stats();
+  ds->set_device(device);
+  return ds;
+}
+
+// Adds a node labelled the way StepStatsCollector does; `args` is the tensor
+// name and peer device for _Send and _Recv nodes.
+void AddNode(DeviceStepStats* ds, const string& name, const string& op,
+             int64_t start, int64_t end, const string& args = "") {
+  NodeExecStats* ns = ds->add_node_stats();
+  ns->set_node_name(name);
+  ns->set_all_start_micros(start);
+  ns->set_all_end_rel_micros(end - start);
+  ns->set_timeline_label(strings::StrCat(name, " = ", op, "(", args, ")"));
+}
+
+TEST(StepCriticalPathTest, FollowsTransfers) {
+  const string cpu0 = strings::StrCat(kTask0, "/device:CPU:0");
+  const string cpu1 = strings::StrCat(kTask0, "/device:CPU:1");
+  StepStats ss;
+  DeviceStepStats* d0 = AddDevice(&ss, cpu0);
+  AddNode(d0, "a", "MatMul", 0, 10);
+  AddNode(d0, "send_a", "_Send", 10, 11, strings::StrCat("edge_a @", cpu1));
+  AddNode(d0, "d", "Add", 12, 14);
+  AddNode(d0, "recv_b", "_Recv", 20, 21, strings::StrCat("edge_b @", cpu1));
+  DeviceStepStats* d1 = AddDevice(&ss, cpu1);
+  AddNode(d1, "b", "Relu", 0, 3);
+  AddNode(d1, "recv_a", "_Recv", 2, 13, strings::StrCat("edge_a @", cpu0));
+  AddNode(d1, "send_b", "_Send", 3, 4, strings::StrCat("edge_b @", cpu0));
+  AddNode(d1, "c", "MatMul", 13, 30);
+
+  StepCriticalPath path;
+  TF_ASSERT_OK(ComputeStepCriticalPath(ss, &path));
+
+  ASSERT_EQ(path.nodes_size(), 4);
+  EXPECT_EQ(path.nodes(0).node_name(), "a");
+  EXPECT_EQ(path.nodes(1).node_name(), "send_a");
+  EXPECT_EQ(path.nodes(2).node_name(), "recv_a");
+  EXPECT_TRUE(path.nodes(2).via_transfer());
+  EXPECT_EQ(path.nodes(2).device(), cpu1);
+  EXPECT_EQ(path.nodes(2).critical_micros(), 2);
+  EXPECT_EQ(path.nodes(3).node_name(), "c");
+  EXPECT_FALSE(path.nodes(3).via_transfer());
+  EXPECT_EQ(path.start_micros(), 0);
+  EXPECT_EQ(path.end_micros(), 30);
+  EXPECT_EQ(path.compute_micros(), 28);
+  EXPECT_EQ(path.recv_micros(), 2);
+  EXPECT_EQ(path.idle_micros(), 0);
+  EXPECT_EQ(path.task_micros().at(kTask0), 30);
+
+  ASSERT_EQ(path.transfers_size(), 2);
+  EXPECT_EQ(path.transfers(0).tensor_name(), "edge_a");
+  EXPECT_EQ(path.transfers(0).send_device(), cpu0);
+  EXPECT_EQ(path.transfers(0).recv_device(), cpu1);
+  EXPECT_EQ(path.transfers(0).latency_micros(), 2);
+  EXPECT_EQ(path.transfers(0).slack_micros(), 0);
+  EXPECT_TRUE(path.transfers(0).on_critical_path());
+  EXPECT_EQ(path.transfers(1).tensor_name(), "edge_b");
+  EXPECT_EQ(path.transfers(1).slack_micros(), 16);
+  EXPECT_FALSE(path.transfers(1).on_critical_path());
+}
+
+TEST(StepCriticalPathTest, AlignsTaskClocks) {
+  const string cpu0 = strings::StrCat(kTask0, "/device:CPU:0");
+  const string cpu1 = strings::StrCat(kTask1, "/device:CPU:0");
+  // The clock of task 1 is 1000us behind the clock of task 0.
+  const int64_t skew = 1000;
+  StepStats ss;
+  DeviceStepStats* d0 = AddDevice(&ss, cpu0);
+  AddNode(d0, "send_x", "_Send", 10, 11, strings::StrCat("edge_x @", cpu1));
+  AddNode(d0, "recv_y", "_Recv", 15, 22, strings::StrCat("edge_y @", cpu1));
+  DeviceStepStats* d1 = AddDevice(&ss, cpu1);
+  AddNode(d1, "recv_x", "_Recv", 5 - skew, 12 - skew,
+          strings::StrCat("edge_x @", cpu0));
+  AddNode(d1, "send_y", "_Send", 20 - skew, 21 - skew,
+          strings::StrCat("edge_y @", cpu0));
+
+  StepCriticalPath path;
+  TF_ASSERT_OK(ComputeStepCriticalPath(ss, &path));
+
+  EXPECT_EQ(path.clock_offset_micros().at(kTask0), 0);
+  EXPECT_EQ(path.clock_offset_micros().at(kTask1), skew);
+  ASSERT_EQ(path.nodes_size(), 4);
+  EXPECT_EQ(path.nodes(0).node_name(), "send_x");
+  EXPECT_EQ(path.nodes(1).node_name(), "recv_x");
+  EXPECT_EQ(path.nodes(1).start_micros(), 5);
+  EXPECT_EQ(path.nodes(2).node_name(), "send_y");
+  EXPECT_EQ(path.nodes(3).node_name(), "recv_y");
+  EXPECT_EQ(path.end_micros(), 22);
+  EXPECT_EQ(path.task_micros().at(kTask1), 10);
+}
+
+TEST(StepCriticalPathTest, MalformedTransferLabel) {
+  StepStats ss;
+  DeviceStepStats* ds =
+      AddDevice(&ss, strings::StrCat(kTask0, "/device:CPU:0"));
+  AddNode(ds, "send", "_Send", 0, 1, "edge");
+  StepCriticalPath path;
+  EXPECT_TRUE(errors::IsInvalidArgument(ComputeStepCriticalPath(ss, &path)));
+}
+
+TEST(StepCriticalPathTest, Empty) {
+  StepCriticalPath path;
+  TF_ASSERT_OK(ComputeStepCriticalPath(StepStats(), &path));
+  EXPECT_EQ(path.nodes_size(), 0);
+}
+
+}  // namespace
+}  // namespace tensorflow
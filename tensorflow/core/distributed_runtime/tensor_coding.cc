@@ -18,6 +18,7 @@ limitations under the License.
 #include "google/protobuf/any.pb.h"
 
 #include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/distributed_runtime/recv_tensor_shm.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/framework/tensor_shape.pb.h"
 
@@ -30,6 +31,9 @@ void TensorResponse::Clear() {
   device_ = nullptr;
   alloc_attrs_ = AllocatorAttributes();
   allocator_ = nullptr;
+  staging_device_ = nullptr;
+  staging_context_ = nullptr;
+  staging_allocator_ = nullptr;
   already_used_ = false;
   ClearTensor();
 }
@@ -50,6 +54,23 @@ void TensorResponse::InitAlloc(DeviceBase* d, const AllocatorAttributes& aa) {
   allocator_ = device_->GetAllocator(alloc_attrs_);
 }
 
+void TensorResponse::InitAlloc(Device* d, const AllocatorAttributes& aa) {
+  InitAlloc(static_cast<DeviceBase*>(d), aa);
+  if (on_host_) return;
+  const DeviceBase::AcceleratorDeviceInfo* device_info =
+      d->tensorflow_accelerator_device_info();
+  if (device_info == nullptr || device_info->default_context == nullptr ||
+      device_info->use_pjrt_tensor_buffer) {
+    return;
+  }
+  AllocatorAttributes staging_attrs;
+  staging_attrs.set_on_host(true);
+  staging_attrs.set_gpu_compatible(true);
+  staging_device_ = d;
+  staging_context_ = device_info->default_context;
+  staging_allocator_ = d->GetAllocator(staging_attrs);
+}
+
 Status TensorResponse::InitFrom(RecvTensorResponse* response) {
   Status s;
   meta_.Swap(response);
@@ -81,12 +102,29 @@ void TensorResponse::InitPartial(const RecvTensorResponse& response,
 
 Status TensorResponse::ParseFrom(Source* source) {
   if (!on_host_) {
+    if (staging_allocator_ != nullptr) {
+      ClearTensor();
+      if (ParseFast(source, staging_allocator_)) {
+        TF_RETURN_IF_ERROR(ReadShmContent(&tensor_));
+        return CopyStagedTensorToDevice();
+      }
+      meta_.Clear();
+    }
     protobuf::io::CodedInputStream input(source->contents());
 
     // Pre-parse into local storage, then delegate to device.
     if (!meta_.ParseFromCodedStream(&input) || !input.ConsumedEntireMessage()) {
       return errors::InvalidArgument("Cannot parse tensor from response");
     }
+    RecvTensorShm shm;
+    if (meta_.transport_options().UnpackTo(&shm)) {
+      TensorShape shape(meta_.tensor().tensor_shape());
+      const size_t size =
+          shape.num_elements() * DataTypeSize(meta_.tensor().dtype());
+      string* content = meta_.mutable_tensor()->mutable_tensor_content();
+      content->resize(size);
+      TF_RETURN_IF_ERROR(ReadRecvTensorShm(shm, &(*content)[0], size));
+    }
     Status s =
         device_->MakeTensorFromProto(meta_.tensor(), alloc_attrs_, &tensor_);
     // Reduce memory usage for big tensors.
@@ -101,9 +139,9 @@ Status TensorResponse::ParseFrom(Source* source) {
     ClearTensor();
   }
   already_used_ = true;
-  if (ParseFast(source)) return absl::OkStatus();
+  if (ParseFast(source, allocator_)) return ReadShmContent(&tensor_);
   meta_.Clear();
-  if (ParseSlow(source)) return absl::OkStatus();
+  if (ParseSlow(source)) return ReadShmContent(&tensor_);
   return errors::InvalidArgument("Cannot parse tensor from response");
 }
 
@@ -144,18 +182,29 @@ bool ReadNestedMessage(protobuf::io::CodedInputStream* input,
 }  // namespace
 
 bool TensorResponse::ParseTensorSubmessage(
-    protobuf::io::CodedInputStream* input, TensorProto* tensor_meta) {
+    protobuf::io::CodedInputStream* input, TensorProto* tensor_meta,
+    Allocator* allocator) {
   bool seen_tensor_content = false;
+  // The elements of a DT_STRING tensor are read from its string_val fields
+  // straight into the tstrings of tensor_, which avoids building the
+  // repeated string_val field and copying it again in Tensor::FromProto.
+  tstring* strings = nullptr;
+  int64_t num_strings = 0;
   while (true) {
     auto p = input->ReadTagWithCutoff(127);
     int tag = GetTagFieldNumber(p.first);
     WireType wt = GetTagWireType(p.first);
     if (!p.second) {
       bool ok = (tag == 0);
+      if (ok && strings != nullptr) {
+        // Tensor::FromProto repeats the last element when there are fewer
+        // of them than the shape says, leave those to the slow path.
+        return num_strings == tensor_.NumElements();
+      }
       if (ok && !seen_tensor_content) {
         // No tensor content: could be because it's a zero-length tensor
         TensorShape shape(tensor_meta->tensor_shape());
-        Tensor t(allocator_, tensor_meta->dtype(), shape);
+        Tensor t(allocator, tensor_meta->dtype(), shape);
         tensor_ = std::move(t);
       }
       return ok;
@@ -166,7 +215,10 @@ bool TensorResponse::ParseTensorSubmessage(
         if ((wt != WIRETYPE_VARINT) || !input->ReadVarint32(&v)) return false;
         if (seen_tensor_content) return false;
         tensor_meta->set_dtype(static_cast<DataType>(static_cast<int>(v)));
-        if (!DataTypeCanUseMemcpy(tensor_meta->dtype())) return false;
+        if (!DataTypeCanUseMemcpy(tensor_meta->dtype()) &&
+            (tensor_meta->dtype() != DT_STRING || !on_host_)) {
+          return false;
+        }
         break;
       }
       case TensorProto::kTensorShapeFieldNumber: {
@@ -188,14 +240,15 @@ bool TensorResponse::ParseTensorSubmessage(
         // deal with this in the fast path.
         if (seen_tensor_content) return false;
         if (wt != WIRETYPE_LENGTH_DELIMITED ||
-            !tensor_meta->has_tensor_shape()) {
+            !tensor_meta->has_tensor_shape() ||
+            !DataTypeCanUseMemcpy(tensor_meta->dtype())) {
           return false;
         }
         int num_bytes;
         if (!ReadVarintSizeAsInt(input, &num_bytes)) return false;
         seen_tensor_content = true;
         TensorShape shape(tensor_meta->tensor_shape());
-        Tensor t(allocator_, tensor_meta->dtype(), shape);
+        Tensor t(allocator, tensor_meta->dtype(), shape);
         StringPiece buf = t.tensor_data();
         if (static_cast<size_t>(num_bytes) != buf.size()) return false;
         // TODO(jeff,sanjay): Figure out a way to avoid this copy if
@@ -206,6 +259,30 @@ bool TensorResponse::ParseTensorSubmessage(
         tensor_ = std::move(t);
         break;
       }
+      case TensorProto::kStringValFieldNumber: {
+        if (wt != WIRETYPE_LENGTH_DELIMITED ||
+            tensor_meta->dtype() != DT_STRING) {
+          return false;
+        }
+        if (strings == nullptr) {
+          // A missing tensor_shape is the one of a scalar.
+          seen_tensor_content = true;
+          TensorShape shape(tensor_meta->tensor_shape());
+          Tensor t(allocator, DT_STRING, shape);
+          tensor_ = std::move(t);
+          strings = tensor_.flat<tstring>().data();
+        }
+        int num_bytes;
+        if (!ReadVarintSizeAsInt(input, &num_bytes) ||
+            num_bytes > input->BytesUntilLimit() ||
+            num_strings >= tensor_.NumElements()) {
+          return false;
+        }
+        tstring* s = &strings[num_strings++];
+        s->resize_uninitialized(num_bytes);
+        if (!input->ReadRaw(s->mdata(), num_bytes)) return false;
+        break;
+      }
       default: {
         // Some other tag our fast path code is not prepared to handle.
         // return false.
@@ -215,7 +292,7 @@ bool TensorResponse::ParseTensorSubmessage(
   }
 }
 
-bool TensorResponse::ParseFast(Source* source) {
+bool TensorResponse::ParseFast(Source* source, Allocator* allocator) {
   protobuf::io::CodedInputStream input(source->contents());
   while (true) {
     auto p = input.ReadTagWithCutoff(127);
@@ -233,7 +310,8 @@ bool TensorResponse::ParseFast(Source* source) {
         std::pair<protobuf::io::CodedInputStream::Limit, int> p =
             input.IncrementRecursionDepthAndPushLimit(length);
         if (p.second < 0 ||
-            !ParseTensorSubmessage(&input, meta_.mutable_tensor())) {
+            !ParseTensorSubmessage(&input, meta_.mutable_tensor(),
+                                   allocator)) {
           return false;
         }
         if (!input.DecrementRecursionDepthAndPopLimit(p.first)) {
@@ -275,6 +353,29 @@ bool TensorResponse::ParseFast(Source* source) {
   return false;
 }
 
+Status TensorResponse::CopyStagedTensorToDevice() {
+  Tensor staged = std::move(tensor_);
+  Tensor copy(allocator_, staged.dtype(), staged.shape());
+  if (!copy.IsInitialized()) {
+    return errors::ResourceExhausted(
+        "OOM when allocating tensor of shape ", staged.shape().DebugString(),
+        " and type ", DataTypeString(staged.dtype()));
+  }
+  if (staged.TotalBytes() > 0) {
+    TF_RETURN_IF_ERROR(staging_context_->CopyCPUTensorToDeviceSync(
+        &staged, staging_device_, &copy));
+  }
+  tensor_ = std::move(copy);
+  return absl::OkStatus();
+}
+
+Status TensorResponse::ReadShmContent(Tensor* tensor) {
+  RecvTensorShm shm;
+  if (!meta_.transport_options().UnpackTo(&shm)) return absl::OkStatus();
+  StringPiece buf = tensor->tensor_data();
+  return ReadRecvTensorShm(shm, const_cast<char*>(buf.data()), buf.size());
+}
+
 bool TensorResponse::ParseSlow(Source* source) {
   if (!meta_.ParseFromZeroCopyStream(source->contents())) {
     return false;
@@ -25,7 +25,9 @@ limitations under the License.
 
 namespace tensorflow {
 
+class Device;
 class DeviceBase;
+class DeviceContext;
 class TensorProto;
 
 // TensorResponse can be used as the destination of an RPC that returns
@@ -45,6 +47,12 @@ class TensorResponse {
   // Initialize memory allocation related members.
   void InitAlloc(DeviceBase* d, const AllocatorAttributes& aa);
 
+  // Like above, but when "d" is an accelerator with a default DeviceContext,
+  // tensors destined for device memory are parsed straight into the
+  // device's gpu-compatible host memory and then DMA'd to the device,
+  // instead of being decoded into an intermediate TensorProto first.
+  void InitAlloc(Device* d, const AllocatorAttributes& aa);
+
   // Source provides a way for a particular RPC implementation to provide
   // received data to ParseFrom.
   class Source {
@@ -92,14 +100,23 @@ class TensorResponse {
 
  private:
   bool ParseTensorSubmessage(protobuf::io::CodedInputStream* input,
-                             TensorProto* tensor_meta);
-  bool ParseFast(Source* source);
+                             TensorProto* tensor_meta, Allocator* allocator);
+  bool ParseFast(Source* source, Allocator* allocator);
   bool ParseSlow(Source* source);
+  // Copies the host tensor parsed into staging memory to the device.
+  Status CopyStagedTensorToDevice();
+  // If the sender moved the content of the tensor through shared memory,
+  // copies it into `tensor`, which already has the received shape and type.
+  Status ReadShmContent(Tensor* tensor);
 
   bool on_host_ = false;
   DeviceBase* device_ = nullptr;
   AllocatorAttributes alloc_attrs_;
   Allocator* allocator_ = nullptr;
+  // Set only when device-bound tensors can be staged in host memory.
+  Device* staging_device_ = nullptr;
+  const DeviceContext* staging_context_ = nullptr;
+  Allocator* staging_allocator_ = nullptr;
   bool already_used_ = false;
   Tensor tensor_;
   RecvTensorResponse meta_;
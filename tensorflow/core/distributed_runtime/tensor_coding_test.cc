@@ -15,10 +15,15 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/tensor_coding.h"
 
+#include <cstring>
+
+#include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/distributed_runtime/recv_tensor_shm.h"
 #include "tensorflow/core/framework/device_attributes.pb.h"
 #include "tensorflow/core/framework/device_base.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/env.h"
@@ -46,6 +51,53 @@ class DummyDevice : public DeviceBase {
   DeviceAttributes attr_;
 };
 
+// Device context for a fake accelerator whose device memory is host memory.
+class CountingDeviceContext : public DeviceContext {
+ public:
+  void CopyCPUTensorToDevice(const Tensor* cpu_tensor, Device* device,
+                             Tensor* device_tensor, StatusCallback done,
+                             bool sync_dst_compute) const override {
+    ++num_copies_;
+    std::memcpy(const_cast<char*>(device_tensor->tensor_data().data()),
+                cpu_tensor->tensor_data().data(), cpu_tensor->TotalBytes());
+    done(absl::OkStatus());
+  }
+
+  int num_copies() const { return num_copies_; }
+
+ private:
+  mutable int num_copies_ = 0;
+};
+
+class FakeAcceleratorDevice : public Device {
+ public:
+  explicit FakeAcceleratorDevice(Env* env)
+      : Device(env, MakeAttributes()), context_(new CountingDeviceContext) {
+    device_info_.default_context = context_;
+    set_tensorflow_accelerator_device_info(&device_info_);
+  }
+  ~FakeAcceleratorDevice() override { context_->Unref(); }
+
+  Status Sync() override { return absl::OkStatus(); }
+
+  Allocator* GetAllocator(AllocatorAttributes attr) override {
+    return cpu_allocator();
+  }
+
+  const CountingDeviceContext* context() const { return context_; }
+
+ private:
+  static DeviceAttributes MakeAttributes() {
+    DeviceAttributes attr;
+    attr.set_name("/job:a/replica:0/task:0/device:FAKE_GPU:0");
+    attr.set_device_type("FAKE_GPU");
+    return attr;
+  }
+
+  CountingDeviceContext* context_;
+  AcceleratorDeviceInfo device_info_;
+};
+
 class StringSource : public TensorResponse::Source {
  public:
   explicit StringSource(const string* s, int block_size)
@@ -156,6 +208,81 @@ TEST_F(TensorResponseTest, Simple) {
 
 TEST_F(TensorResponseTest, StringTensor) { DoTestForStrings(DT_STRING); }
 
+TEST_F(TensorResponseTest, ScalarAndLargeStrings) {
+  Tensor scalar(DT_STRING, TensorShape({}));
+  scalar.scalar<tstring>()() = "a scalar";
+  Validate(scalar, false, true);
+  Tensor large(DT_STRING, TensorShape({3}));
+  test::FillValues<tstring>(&large,
+                            {string(100000, 'a'), "", string(3000, 'b')});
+  Validate(large, false, true);
+}
+
+TEST_F(TensorResponseTest, StringTensorWithFewerElements) {
+  // Tensor::FromProto repeats the last element up to the number of elements
+  // of the shape.
+  RecvTensorResponse proto;
+  proto.mutable_tensor()->set_dtype(DT_STRING);
+  TensorShape({3}).AsProto(proto.mutable_tensor()->mutable_tensor_shape());
+  proto.mutable_tensor()->add_string_val("first");
+  proto.mutable_tensor()->add_string_val("last");
+  string encoded;
+  proto.AppendToString(&encoded);
+
+  StringSource source(&encoded, 1024);
+  TensorResponse response;
+  DummyDevice cpu_device(Env::Default());
+  response.InitAlloc(&cpu_device, AllocatorAttributes());
+  TF_ASSERT_OK(response.ParseFrom(&source));
+  test::ExpectTensorEqual<tstring>(
+      response.tensor(),
+      test::AsTensor<tstring>({"first", "last", "last"}, TensorShape({3})));
+}
+
+TEST_F(TensorResponseTest, StagesDeviceTensorInHostMemory) {
+  Tensor src(DT_FLOAT, TensorShape({2, 3}));
+  test::FillValues<float>(&src, {1, 2, 3, 4, 5, 6});
+  RecvTensorResponse proto;
+  proto.set_send_start_micros(123456);
+  src.AsProtoTensorContent(proto.mutable_tensor());
+  string encoded;
+  proto.AppendToString(&encoded);
+
+  FakeAcceleratorDevice device(Env::Default());
+  TensorResponse response;
+  response.InitAlloc(&device, AllocatorAttributes());
+  for (int i = 0; i < 2; i++) {  // Twice so we exercise reuse of "response"
+    StringSource source(&encoded, 4);
+    TF_ASSERT_OK(response.ParseFrom(&source));
+    EXPECT_EQ(response.metadata().send_start_micros(), 123456);
+    test::ExpectTensorEqual<float>(response.tensor(), src);
+  }
+  EXPECT_EQ(device.context()->num_copies(), 2);
+}
+
+TEST_F(TensorResponseTest, ReadsContentFromSharedMemory) {
+  Tensor src(DT_FLOAT, TensorShape({2, 3}));
+  test::FillValues<float>(&src, {1, 2, 3, 4, 5, 6});
+  RecvTensorShm shm;
+  TF_ASSERT_OK(WriteRecvTensorShm(src, &shm));
+  RecvTensorResponse proto;
+  proto.mutable_tensor()->set_dtype(src.dtype());
+  src.shape().AsProto(proto.mutable_tensor()->mutable_tensor_shape());
+  proto.mutable_transport_options()->PackFrom(shm);
+  string encoded;
+  proto.AppendToString(&encoded);
+
+  StringSource source(&encoded, 1024);
+  TensorResponse response;
+  DummyDevice cpu_device(Env::Default());
+  response.InitAlloc(&cpu_device, AllocatorAttributes());
+  TF_ASSERT_OK(response.ParseFrom(&source));
+  test::ExpectTensorEqual<float>(response.tensor(), src);
+
+  // The receiver unlinks the shared memory object once read.
+  EXPECT_FALSE(response.ParseFrom(&source).ok());
+}
+
 string MakeFloatTensorTestCase(int num_elems) {
   std::vector<int8> v(num_elems);
   for (int i = 0; i < num_elems; i++) {
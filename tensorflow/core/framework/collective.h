@@ -116,6 +116,14 @@ struct CollImplDetails {
                               // e.g. ring or nccl
   float timeout_seconds;      // If non zero, set a completion timeout for the
                               // collective op to detect staleness.
+  // Wire format for reduction chunks sent between devices: "none" keeps the
+  // input dtype, "bf16" and "fp16" cast float32 chunks down while in transit.
+  // Only honored by implementations that support it.
+  string compression = "none";
+  // Number of group members whose contributions a reduction may leave out
+  // when they arrive last, so that stragglers do not hold up the step.  Only
+  // honored by implementations that support it.
+  int num_backup_workers = 0;
 };
 
 // Data common to all members of a collective instance.
@@ -327,6 +335,18 @@ class CollectiveExecutor : public core::RefCounted {
         "a CollectiveExecutor has not been provided."));
   }
 
+  // Like ExecuteAsync above, but runs the collective on `input` and `output`
+  // rather than on the first input and output of `ctx`. Both must stay alive
+  // until `done` is called.
+  virtual void ExecuteAsync(OpKernelContext* ctx,
+                            const CollectiveParams* col_params,
+                            const string& exec_key, const Tensor* input,
+                            Tensor* output, StatusCallback done) {
+    done(errors::Internal(
+        "A collective Op has been called in a context in which "
+        "a CollectiveExecutor has not been provided."));
+  }
+
   virtual void CompleteParamsAsync(const DeviceAttributes& device,
                                    CollectiveParams* cp,
                                    CancellationManager* cancel_mgr,
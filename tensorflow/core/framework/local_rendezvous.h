@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_FRAMEWORK_LOCAL_RENDEZVOUS_H_
 #define TENSORFLOW_CORE_FRAMEWORK_LOCAL_RENDEZVOUS_H_
 
+#include <atomic>
 #include <memory>
 #include <optional>
 #include <vector>
@@ -102,6 +103,9 @@ class LocalRendezvous {
   const std::unique_ptr<TableBucket[]> table_buckets_;
   mutex mu_;
   Status status_ TF_GUARDED_BY(mu_);
+  // Whether status_ is an error. Checked by Send and RecvAsync without
+  // locking mu_, which would be contended by all the threads of a step.
+  std::atomic<bool> aborted_{false};
 
   // We deliberately leak one reference of the aborted rendezvous here, so that
   // they won't be destructed, and lose the status_.
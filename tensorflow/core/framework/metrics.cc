@@ -37,6 +37,10 @@ auto* persistent_cache_load_count = tsl::monitoring::Counter<0>::New(
     "/tensorflow/core/persistent_cache_load_count",
     "The number of times a binary is loaded from the persistent cache.");
 
+auto* grappler_optimization_cache_lookups = tsl::monitoring::Counter<1>::New(
+    "/tensorflow/core/grappler_optimization_cache_lookups",
+    "The number of lookups of the Grappler optimization cache.", "result");
+
 auto* aot_bef_mlir_load_count = tsl::monitoring::Counter<0>::New(
     "/tensorflow/core/aot_bef_mlir_load_count",
     "The number of times BEF and MLIR are deserialized instead of generated "
@@ -75,10 +79,35 @@ auto* graph_run_output_tensor_bytes = tsl::monitoring::Sampler<0>::New(
     // Power of 2 with bucket count 14 (256MB)
     {tsl::monitoring::Buckets::Exponential(1, 4, 14)});
 
+auto* recv_tensor_rpcs_per_step = tsl::monitoring::Sampler<0>::New(
+    {"/tensorflow/core/recv_tensor_rpcs_per_step",
+     "The number of RecvTensor RPCs issued by a worker in one step."},
+    // Power of 2 with bucket count 16 (> 32k)
+    {tsl::monitoring::Buckets::Exponential(1, 2, 16)});
+
+auto* recv_tensor_overlapping_rpcs_per_step =
+    tsl::monitoring::Sampler<0>::New(
+        {"/tensorflow/core/recv_tensor_overlapping_rpcs_per_step",
+         "The number of RecvTensor RPCs in one step that were issued while "
+         "another RecvTensor RPC to the same source worker was outstanding."},
+        // Power of 2 with bucket count 16 (> 32k)
+        {tsl::monitoring::Buckets::Exponential(1, 2, 16)});
+
 auto* graph_unused_outputs = tsl::monitoring::Counter<1>::New(
     "/tensorflow/core/graph_unused_outputs",
     "The number of unused outputs for ops of a given type.", "name");
 
+auto* sampled_op_count = tsl::monitoring::Counter<1>::New(
+    "/tensorflow/core/sampled_op_count",
+    "The number of executions of ops of a given type in the sampled steps.",
+    "name");
+
+auto* sampled_op_compute_time_usecs = tsl::monitoring::Counter<1>::New(
+    "/tensorflow/core/sampled_op_compute_time_usecs",
+    "The compute time in microseconds of the ops of a given type in the "
+    "sampled steps.",
+    "name");
+
 auto* tf_data_fetch_op_counter = tsl::monitoring::Counter<1>::New(
     "/tensorflow/data/fetch_op",
     "The number of times a tf.data operation that fetches output(s) of a "
@@ -234,6 +263,15 @@ auto* tf_data_service_snapshot_ops_counter = tsl::monitoring::Counter<2>::New(
     "/tensorflow/data/service/snapshot_ops",
     "Number times a tf.data snapshot is saved/loaded.", "path", "op");
 
+auto* tf_data_service_snapshot_stage_duration_usecs_histogram =
+    tsl::monitoring::Sampler<1>::New(
+        {"/tensorflow/data/service/snapshot_stage_duration",
+         "Microseconds a distributed snapshot record spent in the given stage "
+         "of the writer pipeline {'serialize', 'queue', 'write'}.",
+         "stage"},
+        // Power of 2 with bucket count 20 (~1 second).
+        {tsl::monitoring::Buckets::Exponential(1, 2, 20)});
+
 auto* tf_data_service_data_transfer_protocol_used =
     tsl::monitoring::Counter<1>::New(
         "/tensorflow/data/service/data_transfer_protocol_used",
@@ -418,6 +456,12 @@ auto* xla_compilation_time_usecs = tsl::monitoring::Counter<0>::New(
     "/tensorflow/core/xla_compilation_time_usecs",
     "The total time spent on compiling XLA graphs in microseconds.");
 
+auto* nccl_communicator_init_time_usecs = tsl::monitoring::Sampler<0>::New(
+    {"/tensorflow/core/nccl_communicator_init_time_usecs",
+     "The time spent initializing NCCL communicators in microseconds."},
+    // Power of 2 with bucket count 20 (> 17 minutes)
+    {tsl::monitoring::Buckets::Exponential(1000, 2, 20)});
+
 auto* xla_tpu_spmd_cores_per_replica = tsl::monitoring::Counter<1>::New(
     "/tensorflow/tpu/xla_spmd_cores_per_replica",
     "The number of cores used by XLA SPMD-replicated models.", "cores");
@@ -443,6 +487,13 @@ auto* eager_client_error_counter = tsl::monitoring::Counter<2>::New(
     "Count the errors in eager client as a central place.", "error_source",
     "error_type");
 
+auto* collective_backup_dropped_contributions =
+    tsl::monitoring::Counter<1>::New(
+        "/tensorflow/core/collective_backup_dropped_contributions",
+        "The number of contributions to collective reductions with backup "
+        "workers that were dropped for arriving too late.",
+        "task");
+
 auto* mlir_bridge_first_phase_counter = tsl::monitoring::Counter<5>::New(
     "/tensorflow/core/tf_mlir_bridge_first_phase_v2_count",
     "Tracks processing state in first phase of mlir bridge", "bridge",
@@ -684,6 +735,12 @@ void RecordTFDataServiceSnapshotOp(const std::string& path,
   tf_data_service_snapshot_ops_counter->GetCell(path, op)->IncrementBy(1);
 }
 
+void RecordTFDataServiceSnapshotStageDuration(const std::string& stage,
+                                              uint64 duration_us) {
+  tf_data_service_snapshot_stage_duration_usecs_histogram->GetCell(stage)->Add(
+      duration_us);
+}
+
 void RecordTFDataServiceOptimalNumberOfWorkers(int64_t number_of_workers) {
   tf_data_service_optimal_number_of_workers->GetCell()->Set(number_of_workers);
 }
@@ -780,6 +837,16 @@ void RecordGraphOutputTensors(const size_t size) {
   graph_run_output_tensor_bytes_cell->Add(size);
 }
 
+void RecordRecvTensorRpcsPerStep(int64_t num_rpcs,
+                                 int64_t num_overlapping_rpcs) {
+  static auto* recv_tensor_rpcs_per_step_cell =
+      recv_tensor_rpcs_per_step->GetCell();
+  static auto* recv_tensor_overlapping_rpcs_per_step_cell =
+      recv_tensor_overlapping_rpcs_per_step->GetCell();
+  recv_tensor_rpcs_per_step_cell->Add(num_rpcs);
+  recv_tensor_overlapping_rpcs_per_step_cell->Add(num_overlapping_rpcs);
+}
+
 void RecordTPUXlaSpmdCoresPerReplica(int64_t cores_per_replica) {
   xla_tpu_spmd_cores_per_replica->GetCell(absl::StrCat(cores_per_replica))
       ->IncrementBy(1);
@@ -797,6 +864,10 @@ void UpdateAotBefMlirLoadCount() {
   aot_bef_mlir_load_count_cell->IncrementBy(1);
 }
 
+void RecordGrapplerOptimizationCacheLookup(const std::string& result) {
+  grappler_optimization_cache_lookups->GetCell(result)->IncrementBy(1);
+}
+
 void UpdateGraphExecTime(const uint64 running_time_usecs) {
   if (running_time_usecs > 0) {
     static auto* graph_runs_cell = graph_runs->GetCell();
@@ -921,10 +992,23 @@ void UpdateXlaCompilationTime(const uint64 compilation_time_usecs) {
   }
 }
 
+void UpdateNcclCommunicatorInitTime(const uint64 init_time_usecs) {
+  static auto* nccl_communicator_init_time_usecs_cell =
+      nccl_communicator_init_time_usecs->GetCell();
+  nccl_communicator_init_time_usecs_cell->Add(init_time_usecs);
+}
+
 void RecordUnusedOutput(const string& op_name) {
   graph_unused_outputs->GetCell(op_name)->IncrementBy(1);
 }
 
+void RecordSampledOpStats(const string& op_name, int64_t count,
+                          uint64 compute_time_usecs) {
+  sampled_op_count->GetCell(op_name)->IncrementBy(count);
+  sampled_op_compute_time_usecs->GetCell(op_name)->IncrementBy(
+      compute_time_usecs);
+}
+
 void RecordPipelineProcessingTime(const string& id,
                                   double pipeline_processing_time_usec) {
   GetTFDataPipelineProcessingTimeGauge(id)->Set(pipeline_processing_time_usec);
@@ -1029,6 +1113,10 @@ void UpdateEagerClientErrorCounter(const string& error_source,
   eager_client_error_counter->GetCell(error_source, error_type)->IncrementBy(1);
 }
 
+void RecordCollectiveBackupDroppedContribution(const string& task) {
+  collective_backup_dropped_contributions->GetCell(task)->IncrementBy(1);
+}
+
 void UpdateTfMlirBridgeGraphAnalysisPerOp(
     const std::string& op_name, const std::string& construction_context,
     bool is_single_core_inference_mode, const std::string& num_replicas,
@@ -189,6 +189,11 @@ void RecordTFDataServiceSnapshotBytesCommitted(int64_t bytes);
 void RecordTFDataServiceSnapshotOp(const std::string& path,
                                    const std::string& op);
 
+// Records the time (in microseconds) a distributed snapshot record spent in
+// `stage` of the snapshot writer pipeline.
+void RecordTFDataServiceSnapshotStageDuration(const std::string& stage,
+                                              uint64 duration_us);
+
 // Records the current estimated optimal number of tf.data service workers.
 void RecordTFDataServiceOptimalNumberOfWorkers(int64_t number_of_workers);
 
@@ -263,6 +268,12 @@ void RecordParseRaggedFeature(int64_t num_features);
 void RecordGraphInputTensors(const size_t size);
 void RecordGraphOutputTensors(const size_t size);
 
+// Records, for one step, the number of RecvTensor RPCs issued by a worker and
+// how many of them were issued while another RecvTensor RPC to the same
+// source worker was still outstanding (and so could have shared a batch).
+void RecordRecvTensorRpcsPerStep(int64_t num_rpcs,
+                                 int64_t num_overlapping_rpcs);
+
 // Records the number of cores requested by graphs with XLA SPMD enabled.
 void RecordTPUXlaSpmdCoresPerReplica(int64_t cores_per_replica);
 
@@ -272,6 +283,11 @@ void UpdateGraphPendingQueueLength(uint64 len);
 // Records that one output of an op of type `op_name` was unused.
 void RecordUnusedOutput(const string& op_name);
 
+// Records the `count` executions of ops of type `op_name` in a sampled step,
+// and their total compute time.
+void RecordSampledOpStats(const string& op_name, int64_t count,
+                          uint64 compute_time_usecs);
+
 // Records the pipeline processing time in microseconds
 void RecordPipelineProcessingTime(const string& id,
                                   double pipeline_processing_time_usec);
@@ -339,6 +355,10 @@ void IncrementFunctionGraphOptimizationCacheLoadCount(
 int64_t GetFunctionGraphOptimizationCacheLoadCount(
     GraphOptimizationSource source);
 
+// Records a lookup of the Grappler optimization cache. `result` is "hit",
+// "disk_hit" or "miss".
+void RecordGrapplerOptimizationCacheLookup(const std::string& result);
+
 // Records the activity of the first phase of the mlir bridge using the
 // tf_metadata.tf_mlir_bridge_first_phase_v2_count metric.
 // bridge_type: replicated, nonreplicated, etc.
@@ -522,6 +542,10 @@ void UpdateTpuVariableDistributionTime(const uint64 distribution_time_usecs);
 // Updates the metrics stored about time XLA spents compiling graphs.
 void UpdateXlaCompilationTime(const uint64 compilation_time_usecs);
 
+// Records the time spent initializing the NCCL communicator of a group of
+// devices.
+void UpdateNcclCommunicatorInitTime(const uint64 init_time_usecs);
+
 // Increments (by 1) a simple integer counter that is exposed for testing.
 void IncrementTestCounter(const string& name, const string& label);
 
@@ -544,6 +568,10 @@ void UpdateTpuErrorCounter(const string& op, const string& error_type);
 void UpdateEagerClientErrorCounter(const string& error_source,
                                    const string& error_type);
 
+// Records that the contribution of a group member in `task` was left out of a
+// collective reduction with backup workers because it arrived too late.
+void RecordCollectiveBackupDroppedContribution(const string& task);
+
 }  // namespace metrics
 }  // namespace tensorflow
 
@@ -22,7 +22,11 @@ limitations under the License.
 #include <memory>
 #include <optional>
 #include <queue>
+#include <string>
+#include <vector>
 
+#include "absl/algorithm/container.h"
+#include "absl/strings/str_cat.h"
 #include "absl/time/clock.h"
 #include "tensorflow/core/framework/cancellation.h"
 #include "tensorflow/core/framework/metrics.h"
@@ -239,6 +243,68 @@ bool AreAllParametersMax(const Model::ModelParameters& parameters) {
   return true;
 }
 
+// Returns the sum of the parallelism parameter values, i.e. the number of cores
+// the tuned pipeline uses.
+int64_t TotalParallelism(const Model::ModelParameters& parameters) {
+  int64_t total_parallelism = 0;
+  for (const auto& pair : parameters) {
+    if (pair.second->name == kParallelism) {
+      total_parallelism += std::round(pair.second->value);
+    }
+  }
+  return total_parallelism;
+}
+
+// Maps the parallelism parameter of each node with a tunable cycle length to
+// its cycle length parameter.
+absl::flat_hash_map<Parameter*, Parameter*> CollectCycleLengths(
+    const Model::ModelParameters& parameters) {
+  absl::flat_hash_map<std::string, Parameter*> parallelism_parameters;
+  for (const auto& pair : parameters) {
+    if (pair.second->name == kParallelism) {
+      parallelism_parameters[pair.first] = pair.second.get();
+    }
+  }
+  absl::flat_hash_map<Parameter*, Parameter*> cycle_lengths;
+  for (const auto& pair : parameters) {
+    if (pair.second->name != kCycleLength) {
+      continue;
+    }
+    Parameter* parallelism =
+        gtl::FindPtrOrNull(parallelism_parameters, pair.first);
+    if (parallelism != nullptr) {
+      cycle_lengths[parallelism] = pair.second.get();
+    }
+  }
+  return cycle_lengths;
+}
+
+// Increments `parameter`. A tunable cycle length is tuned together with the
+// parallelism of its node: only as many inputs are kept open as there are
+// workers to process them, so the cycle length is incremented too if it would
+// otherwise bound the parallelism. Returns the cycle length parameter if it was
+// incremented.
+Parameter* IncrementParameter(
+    Parameter* parameter,
+    const absl::flat_hash_map<Parameter*, Parameter*>& cycle_lengths) {
+  parameter->value++;
+  Parameter* cycle_length = gtl::FindPtrOrNull(cycle_lengths, parameter);
+  if (cycle_length != nullptr && cycle_length->value < parameter->value &&
+      cycle_length->value < cycle_length->max) {
+    cycle_length->value++;
+    return cycle_length;
+  }
+  return nullptr;
+}
+
+// Reverts `IncrementParameter`.
+void DecrementParameter(Parameter* parameter, Parameter* cycle_length) {
+  parameter->value--;
+  if (cycle_length != nullptr) {
+    cycle_length->value--;
+  }
+}
+
 // Records the ram usage of hill climbing algorithm.
 void RecordAutotuneRamUsage(int64 ram_budget, double max_buffered_bytes) {
   if (ram_budget == 0) {
@@ -690,6 +756,14 @@ class AsyncInterleaveMany : public Node {
     double input_time = input_times.at(long_name());
     consumer_time = input_time / static_cast<double>(num_inputs() - 1);
     double parallelism = num_inputs() - 1;  // default to cycle length
+    auto* cycle_length = gtl::FindOrNull(parameters_, kCycleLength);
+    if (cycle_length && (*cycle_length)->state &&
+        (*cycle_length)->state->tunable) {
+      // Inputs beyond the current cycle are not open yet, so it is the tuned
+      // cycle length rather than the number of inputs which bounds the
+      // parallelism.
+      parallelism = (*cycle_length)->value;
+    }
     auto* parameter = gtl::FindOrNull(parameters_, kParallelism);
     if (parameter) {
       parallelism = std::min(parallelism, (*parameter)->value);
@@ -2255,6 +2329,113 @@ Status Node::FromProto(ModelProto::Node node_proto,
   return FromProtoHelper(node_proto, *node);
 }
 
+// static
+std::shared_ptr<CpuBudgetManager> CpuBudgetManager::Global() {
+  static auto* manager = new std::shared_ptr<CpuBudgetManager>(
+      std::make_shared<CpuBudgetManager>(port::NumSchedulableCPUs()));
+  return *manager;
+}
+
+int64_t CpuBudgetManager::Register() {
+  mutex_lock l(mu_);
+  const int64_t id = next_id_++;
+  usages_[id] = Usage();
+  Rebalance();
+  return id;
+}
+
+void CpuBudgetManager::Unregister(int64_t id) {
+  mutex_lock l(mu_);
+  usages_.erase(id);
+  Rebalance();
+}
+
+void CpuBudgetManager::UpdateUsage(int64_t id, int64_t demand,
+                                   double marginal_throughput) {
+  mutex_lock l(mu_);
+  auto it = usages_.find(id);
+  if (it == usages_.end()) {
+    return;
+  }
+  it->second.demand = std::max<int64_t>(demand, 1);
+  it->second.marginal_throughput = std::max(marginal_throughput, 0.0);
+  Rebalance();
+}
+
+int64_t CpuBudgetManager::Allotment(int64_t id) const {
+  tf_shared_lock l(mu_);
+  auto it = usages_.find(id);
+  if (it == usages_.end()) {
+    return budget_;
+  }
+  return it->second.allotment;
+}
+
+void CpuBudgetManager::UpdateBudget(int64_t budget) {
+  mutex_lock l(mu_);
+  budget_ = budget;
+  Rebalance();
+  VLOG(2) << "Updated cpu budget to " << budget;
+}
+
+std::string CpuBudgetManager::DebugString() {
+  mutex_lock l(mu_);
+  std::string result = absl::StrCat("CpuBudgetManager: budget_: ", budget_);
+  for (const auto& [id, usage] : usages_) {
+    absl::StrAppend(&result, " model ", id, ": demand: ", usage.demand,
+                    " marginal throughput: ", usage.marginal_throughput,
+                    " allotment: ", usage.allotment, ";");
+  }
+  return result;
+}
+
+void CpuBudgetManager::Rebalance() {
+  auto weight = [](const Usage* usage) {
+    // Models whose marginal throughput is not known yet still get a share.
+    constexpr double kMinWeight = 1e-6;
+    return std::max(usage->marginal_throughput, kMinWeight);
+  };
+  int64_t remaining = budget_;
+  std::vector<Usage*> unsatisfied;
+  for (auto& [id, usage] : usages_) {
+    usage.allotment = 1;
+    --remaining;
+    if (usage.demand > usage.allotment) {
+      unsatisfied.push_back(&usage);
+    }
+  }
+  while (remaining > 0 && !unsatisfied.empty()) {
+    double total_weight = 0.0;
+    for (const Usage* usage : unsatisfied) {
+      total_weight += weight(usage);
+    }
+    int64_t allotted = 0;
+    for (Usage* usage : unsatisfied) {
+      const int64_t share = std::min<int64_t>(
+          remaining * weight(usage) / total_weight,
+          usage->demand - usage->allotment);
+      usage->allotment += share;
+      allotted += share;
+    }
+    if (allotted == 0) {
+      // All shares were rounded down to zero. Give a core to the model which
+      // benefits the most from it.
+      Usage* usage = *absl::c_max_element(
+          unsatisfied, [&weight](const Usage* lhs, const Usage* rhs) {
+            return weight(lhs) < weight(rhs);
+          });
+      ++usage->allotment;
+      allotted = 1;
+    }
+    remaining -= allotted;
+    unsatisfied.erase(std::remove_if(unsatisfied.begin(), unsatisfied.end(),
+                                     [](const Usage* usage) {
+                                       return usage->allotment >= usage->demand;
+                                     }),
+                      unsatisfied.end());
+  }
+}
+
 Model::Model(std::optional<std::string> dataset_name)
     : dataset_name_(std::move(dataset_name)),
       optimization_period_ms_(kOptimizationPeriodMinMs),
@@ -2297,6 +2478,19 @@ Model::~Model() {
   safe_to_collect_metrics_->val = false;
   // Reset the pipeline processing time to 0
   metrics::RecordPipelineProcessingTime(model_id_, 0);
+  if (cpu_budget_manager_) {
+    cpu_budget_manager_->Unregister(cpu_budget_manager_id_);
+  }
+}
+
+void Model::SetCpuBudgetManager(std::shared_ptr<CpuBudgetManager> manager) {
+  if (cpu_budget_manager_) {
+    cpu_budget_manager_->Unregister(cpu_budget_manager_id_);
+  }
+  cpu_budget_manager_ = std::move(manager);
+  if (cpu_budget_manager_) {
+    cpu_budget_manager_id_ = cpu_budget_manager_->Register();
+  }
 }
 
 void Model::AddNode(Node::Factory factory, const string& name,
@@ -2377,7 +2571,12 @@ void Model::Optimize(AutotuneAlgorithm algorithm,
   }
   OptimizationParams optimization_params;
   optimization_params.set_algorithm(algorithm);
-  optimization_params.set_cpu_budget(cpu_budget_func());
+  int64_t cpu_budget = cpu_budget_func();
+  if (cpu_budget_manager_) {
+    cpu_budget = std::min(
+        cpu_budget, cpu_budget_manager_->Allotment(cpu_budget_manager_id_));
+  }
+  optimization_params.set_cpu_budget(cpu_budget);
   optimization_params.set_ram_budget(model_ram_budget);
   optimization_params.set_model_input_time(model_input_time);
   switch (algorithm) {
@@ -2411,6 +2610,9 @@ void Model::Optimize(AutotuneAlgorithm algorithm,
   if (experiments_.contains("autotune_buffer_optimization")) {
     OptimizeBuffers(snapshot, optimization_params.ram_budget());
   }
+  if (cpu_budget_manager_) {
+    ReportCpuUsage(snapshot, optimization_params);
+  }
   {
     // Save the snapshot of the model proto including the parameters used by
     // autotune. This will be used as the model proto returned in `tfstreamz`.
@@ -2537,6 +2739,46 @@ bool Model::ShouldStop(int64_t cpu_budget, int64_t ram_budget,
   return all_max || TotalMaximumBufferedBytes(snapshot) > ram_budget;
 }
 
+void Model::ReportCpuUsage(std::shared_ptr<Node> snapshot,
+                           const OptimizationParams& optimization_params) {
+  auto parameters = CollectTunableParameters(snapshot);
+  const absl::flat_hash_map<Parameter*, Parameter*> cycle_lengths =
+      CollectCycleLengths(parameters);
+  const double output_time =
+      OutputTime(snapshot, optimization_params.model_input_time(),
+                 /*gradients=*/nullptr);
+  // The throughput gained by giving one more core to the parallelism
+  // parameter that benefits the most from it.
+  double marginal_throughput = 0.0;
+  for (auto& pair : parameters) {
+    if (pair.second->name != kParallelism ||
+        pair.second->value >= pair.second->max) {
+      continue;
+    }
+    Parameter* cycle_length =
+        IncrementParameter(pair.second.get(), cycle_lengths);
+    const double new_output_time =
+        OutputTime(snapshot, optimization_params.model_input_time(),
+                   /*gradients=*/nullptr);
+    DecrementParameter(pair.second.get(), cycle_length);
+    if (output_time > 0 && new_output_time > 0) {
+      marginal_throughput =
+          std::max(marginal_throughput, EnvTime::kSecondsToNanos /
+                                                new_output_time -
+                                            EnvTime::kSecondsToNanos /
+                                                output_time);
+    }
+  }
+  // Ask for one more core than in use while it would still help, so that the
+  // allotment can grow when other models need fewer cores.
+  const int64_t demand =
+      std::max<int64_t>(TotalParallelism(parameters), 1) +
+      (marginal_throughput > 0.0 ? 1 : 0);
+  cpu_budget_manager_->UpdateUsage(cpu_budget_manager_id_, demand,
+                                   marginal_throughput);
+  VLOG(2) << cpu_budget_manager_->DebugString();
+}
+
 // TODO(jsimsa): Add support for tracking and using the model input time.
 Status Model::OptimizeLoop(AutotuneAlgorithm algorithm,
                            std::function<int64_t()> cpu_budget_func,
@@ -2618,8 +2860,12 @@ void Model::OptimizeGradientDescent(
   CollectParameters(snapshot, parameters, &parallelism_parameters,
                     &buffer_size_parameters);
 
-  // Initialize the parameter values to minimal before tuning.
+  // Initialize the parameter values to minimal before tuning. Cycle lengths
+  // have no gradient, so they keep their current values.
   for (auto& pair : parameters) {
+    if (pair.second->name == kCycleLength) {
+      continue;
+    }
     pair.second->value = pair.second->min;
   }
 
@@ -2696,12 +2942,20 @@ void Model::OptimizeHillClimbHelper(
   }
   // Initialize the parameter values to minimal before tuning.
   for (auto& pair : parameters) {
-    if (skip_buffer_sizes && (pair.second->name == kBufferSize)) {
+    if ((skip_buffer_sizes && (pair.second->name == kBufferSize)) ||
+        pair.second->name == kCycleLength) {
       continue;
     }
     pair.second->value = pair.second->min;
   }
+  const absl::flat_hash_map<Parameter*, Parameter*> cycle_lengths =
+      CollectCycleLengths(parameters);
+  for (auto& [parallelism, cycle_length] : cycle_lengths) {
+    cycle_length->value = std::clamp(parallelism->value, cycle_length->min,
+                                     cycle_length->max);
+  }
   Parameter* best_parameter = nullptr;
+  Parameter* best_cycle_length = nullptr;
   while (!cancellation_manager->IsCancelled()) {
     const double output_time =
         OutputTime(snapshot, optimization_params.model_input_time(),
@@ -2713,19 +2967,29 @@ void Model::OptimizeHillClimbHelper(
         // Take a step back of the previous hill climbing attempt
         // so that the final parameters will not exceed the ram budget
         // as the current parameter meets should_stop(...) condition
-        best_parameter->value--;
+        DecrementParameter(best_parameter, best_cycle_length);
       }
       break;
     }
 
+    // When the CPU budget is shared with other models, it is a hard limit on
+    // the parallelism of this model.
+    const bool parallelism_budget_reached =
+        cpu_budget_manager_ != nullptr &&
+        TotalParallelism(parameters) >= optimization_params.cpu_budget();
     double best_delta = -1.0L;
     best_parameter = nullptr;
+    best_cycle_length = nullptr;
     for (auto& pair : parameters) {
       if (pair.second->value >= pair.second->max ||
-          (skip_buffer_sizes && (pair.second->name == kBufferSize))) {
+          (skip_buffer_sizes && (pair.second->name == kBufferSize)) ||
+          (parallelism_budget_reached && pair.second->name == kParallelism) ||
+          // Cycle lengths are tuned together with their parallelism.
+          pair.second->name == kCycleLength) {
         continue;
       }
-      pair.second->value++;
+      Parameter* cycle_length =
+          IncrementParameter(pair.second.get(), cycle_lengths);
       double new_output_time =
           OutputTime(snapshot, optimization_params.model_input_time(),
                      /*gradients=*/nullptr);
@@ -2735,7 +2999,7 @@ void Model::OptimizeHillClimbHelper(
         best_delta = delta;
         best_parameter = pair.second.get();
       }
-      pair.second->value--;
+      DecrementParameter(pair.second.get(), cycle_length);
     }
     if (!best_parameter) {
       metrics::RecordTFDataAutotuneStoppingCriteria("local_maximum_reached");
@@ -2746,7 +3010,7 @@ void Model::OptimizeHillClimbHelper(
       break;
     }
     // Take a hill-climb step
-    best_parameter->value++;
+    best_cycle_length = IncrementParameter(best_parameter, cycle_lengths);
   }
   if (ram_budget_manager.RequestModelAllocation(
           TotalMaximumBufferedBytes(snapshot))) {
@@ -181,7 +181,7 @@ class RamBudgetManager {
   // Returns whether the request succeeded.
   bool RequestModelAllocation(int64_t total_bytes) {
     mutex_lock l(mu_);
-    if (total_bytes > budget_ - legacy_prefetch_allocated_) {
+    if (total_bytes > UnreservedBytes()) {
       return false;
     }
     model_allocated_ = total_bytes;
@@ -201,8 +201,7 @@ class RamBudgetManager {
     // memory.
     if (delta_elements > 0) {
       int64_t max_delta_elements = static_cast<int64_t>(
-          (budget_ - legacy_prefetch_allocated_ - model_allocated_) /
-          element_size);
+          (UnreservedBytes() - model_allocated_) / element_size);
       if (max_delta_elements < 0) {
         return 0;
       }
@@ -224,17 +223,47 @@ class RamBudgetManager {
   // request. If not, no bytes are allocated.
   bool RequestLegacyPrefetchBytes(int64_t delta_bytes) {
     mutex_lock l(mu_);
-    if (delta_bytes > budget_ - legacy_prefetch_allocated_ - model_allocated_) {
+    if (delta_bytes > UnreservedBytes() - model_allocated_) {
       return false;
     }
     legacy_prefetch_allocated_ += delta_bytes;
     return true;
   }
 
+  // Requests `delta_bytes` additional bytes for elements held by in-memory
+  // caches. `delta_bytes` can be negative to release bytes.
+  //
+  // Returns whether there were enough bytes left in the budget to serve the
+  // request. If not, no bytes are allocated.
+  bool RequestCacheBytes(int64_t delta_bytes) {
+    mutex_lock l(mu_);
+    if (delta_bytes > UnreservedBytes() - model_allocated_) {
+      return false;
+    }
+    cache_allocated_ += delta_bytes;
+    return true;
+  }
+
+  // Requests `delta_bytes` additional bytes for records buffered between the
+  // stages of a writer pipeline, e.g. the distributed snapshot writer, or for
+  // the compressed elements of shuffle buffers.
+  // `delta_bytes` can be negative to release bytes.
+  //
+  // Returns whether there were enough bytes left in the budget to serve the
+  // request. If not, no bytes are allocated.
+  bool RequestBufferBytes(int64_t delta_bytes) {
+    mutex_lock l(mu_);
+    if (delta_bytes > UnreservedBytes() - model_allocated_) {
+      return false;
+    }
+    buffer_allocated_ += delta_bytes;
+    return true;
+  }
+
   // The total number of bytes that the model could potentially use.
   int64_t AvailableModelRam() const {
     tf_shared_lock l(mu_);
-    return budget_ - legacy_prefetch_allocated_;
+    return UnreservedBytes();
   }
 
   void UpdateBudget(int64_t budget) {
@@ -247,18 +276,84 @@ class RamBudgetManager {
     mutex_lock l(mu_);
     return absl::StrCat("RamBudgetManager: budget_: ", budget_,
                         " prefetch allocated: ", legacy_prefetch_allocated_,
+                        " cache allocated: ", cache_allocated_,
+                        " buffer allocated: ", buffer_allocated_,
                         " model allocated: ", model_allocated_);
   }
 
  private:
+  // The budget left once the bytes that are not managed by the model are
+  // accounted for.
+  int64_t UnreservedBytes() const TF_SHARED_LOCKS_REQUIRED(mu_) {
+    return budget_ - legacy_prefetch_allocated_ - cache_allocated_ -
+           buffer_allocated_;
+  }
+
   mutable mutex mu_;
   int64_t budget_ TF_GUARDED_BY(mu_) = 0;
   // Number of bytes allocated by legacy prefetch autotuner.
   int64_t legacy_prefetch_allocated_ TF_GUARDED_BY(mu_) = 0;
+  // Number of bytes allocated by in-memory caches.
+  int64_t cache_allocated_ TF_GUARDED_BY(mu_) = 0;
+  // Number of bytes allocated by writer pipeline buffers.
+  int64_t buffer_allocated_ TF_GUARDED_BY(mu_) = 0;
   // Number of bytes allocated by the model.
   int64_t model_allocated_ TF_GUARDED_BY(mu_) = 0;
 };
 
+// Class for dividing a CPU budget between the models of the input pipelines
+// running in the same process, so that co-located pipelines do not each tune
+// their parallelism to use every core of the host.
+//
+// After each optimization round, a model reports how many cores it would like
+// to use and by how much its throughput would increase with one more core. The
+// budget is then divided by weighted water-filling: cores are shared in
+// proportion to the marginal throughput per core, no model is allotted more
+// than it asked for, and the cores a model does not need are redistributed to
+// the others. Every model is allotted at least one core, even if that exceeds
+// the budget.
+class CpuBudgetManager {
+ public:
+  explicit CpuBudgetManager(int64_t budget) : budget_(budget) {}
+
+  // Returns the manager shared by all models of the process. Its budget is the
+  // number of schedulable cores.
+  static std::shared_ptr<CpuBudgetManager> Global();
+
+  // Registers a model and returns its id.
+  int64_t Register();
+
+  // Unregisters the model `id`, returning its cores to the other models.
+  void Unregister(int64_t id);
+
+  // Reports that model `id` would like to use `demand` cores, and that one
+  // more core would increase its throughput by `marginal_throughput` elements
+  // per second.
+  void UpdateUsage(int64_t id, int64_t demand, double marginal_throughput);
+
+  // Returns the number of cores allotted to model `id`.
+  int64_t Allotment(int64_t id) const;
+
+  void UpdateBudget(int64_t budget);
+
+  std::string DebugString();
+
+ private:
+  struct Usage {
+    int64_t demand = 1;
+    double marginal_throughput = 0.0;
+    int64_t allotment = 1;
+  };
+
+  // Recomputes the allotments of all models.
+  void Rebalance() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  mutable mutex mu_;
+  int64_t budget_ TF_GUARDED_BY(mu_);
+  int64_t next_id_ TF_GUARDED_BY(mu_) = 0;
+  absl::flat_hash_map<int64_t, Usage> usages_ TF_GUARDED_BY(mu_);
+};
+
 // Abstract representation of a TensorFlow input pipeline node. It collects
 // information about inputs to this node, processing time spent executing the
 // node logic, number of elements produced by the node, various other
@@ -951,6 +1046,10 @@ class Model {
     experiments_.insert(experiment);
   }
 
+  // Shares the CPU budget of the optimization with the other models registered
+  // with `manager`. Must be called before the optimization starts.
+  void SetCpuBudgetManager(std::shared_ptr<CpuBudgetManager> manager);
+
   // Adds a node with the given name and given parent.
   void AddNode(Node::Factory factory, const string& name,
                std::shared_ptr<Node> parent, std::shared_ptr<Node>* out_node)
@@ -1159,6 +1258,12 @@ class Model {
                   const ModelParameters& buffer_size_parameters,
                   std::shared_ptr<Node> snapshot, bool* cpu_budget_reached);
 
+  // Reports the number of cores the tuned pipeline rooted at `snapshot` uses,
+  // and the throughput it would gain from one more core, to
+  // `cpu_budget_manager_`.
+  void ReportCpuUsage(std::shared_ptr<Node> snapshot,
+                      const OptimizationParams& optimization_params);
+
   // Collects the processing time for the given node.
   double TotalProcessingTime(std::shared_ptr<Node> node);
 
@@ -1218,6 +1323,11 @@ class Model {
   OptimizationParams optimization_params_ TF_GUARDED_BY(mu_);
   // Stores the model id in the string format
   std::string model_id_;
+  // If set, divides the CPU budget between this model and the other models
+  // registered with it.
+  std::shared_ptr<CpuBudgetManager> cpu_budget_manager_;
+  // The id of this model in `cpu_budget_manager_`.
+  int64_t cpu_budget_manager_id_ = -1;
 };
 
 // Class to compute timing information for a model.
@@ -3574,6 +3574,134 @@ TEST(RamBudgetManagerTest, RequestAllocationsWithBudgetAdjustment) {
   EXPECT_TRUE(rbm.RequestLegacyPrefetchBytes(4));
 }
 
+TEST(RamBudgetManagerTest, RequestCacheBytes) {
+  RamBudgetManager rbm(10);
+  EXPECT_TRUE(rbm.RequestCacheBytes(4));
+  EXPECT_EQ(rbm.AvailableModelRam(), 6);
+  // Over budget 7 > 10 - 4
+  EXPECT_FALSE(rbm.RequestModelAllocation(7));
+  EXPECT_TRUE(rbm.RequestModelAllocation(6));
+  EXPECT_FALSE(rbm.RequestCacheBytes(1));
+  EXPECT_FALSE(rbm.RequestLegacyPrefetchBytes(1));
+  // Releasing cache bytes makes room for other allocations.
+  EXPECT_TRUE(rbm.RequestCacheBytes(-4));
+  EXPECT_TRUE(rbm.RequestLegacyPrefetchBytes(4));
+}
+
+TEST(RamBudgetManagerTest, RequestBufferBytes) {
+  RamBudgetManager rbm(10);
+  EXPECT_TRUE(rbm.RequestBufferBytes(3));
+  EXPECT_TRUE(rbm.RequestCacheBytes(2));
+  EXPECT_EQ(rbm.AvailableModelRam(), 5);
+  EXPECT_FALSE(rbm.RequestBufferBytes(6));
+  EXPECT_TRUE(rbm.RequestModelAllocation(5));
+  EXPECT_FALSE(rbm.RequestBufferBytes(1));
+  EXPECT_TRUE(rbm.RequestBufferBytes(-3));
+  EXPECT_EQ(rbm.AvailableModelRam(), 8);
+}
+
+TEST(CpuBudgetManagerTest, SharesInProportionToMarginalThroughput) {
+  CpuBudgetManager cbm(10);
+  const int64_t a = cbm.Register();
+  const int64_t b = cbm.Register();
+  EXPECT_EQ(cbm.Allotment(a), 1);
+  EXPECT_EQ(cbm.Allotment(b), 1);
+  cbm.UpdateUsage(a, /*demand=*/8, /*marginal_throughput=*/1.0);
+  cbm.UpdateUsage(b, /*demand=*/8, /*marginal_throughput=*/3.0);
+  // Each model gets one core, and the remaining 8 cores are shared 1:3.
+  EXPECT_EQ(cbm.Allotment(a), 3);
+  EXPECT_EQ(cbm.Allotment(b), 7);
+}
+
+TEST(CpuBudgetManagerTest, RedistributesUnneededCores) {
+  CpuBudgetManager cbm(10);
+  const int64_t a = cbm.Register();
+  const int64_t b = cbm.Register();
+  cbm.UpdateUsage(a, /*demand=*/2, /*marginal_throughput=*/100.0);
+  cbm.UpdateUsage(b, /*demand=*/20, /*marginal_throughput=*/1.0);
+  EXPECT_EQ(cbm.Allotment(a), 2);
+  EXPECT_EQ(cbm.Allotment(b), 8);
+  cbm.Unregister(a);
+  EXPECT_EQ(cbm.Allotment(b), 10);
+  cbm.UpdateBudget(4);
+  EXPECT_EQ(cbm.Allotment(b), 4);
+}
+
+TEST(CpuBudgetManagerTest, OversubscribedBudget) {
+  CpuBudgetManager cbm(1);
+  const int64_t a = cbm.Register();
+  const int64_t b = cbm.Register();
+  cbm.UpdateUsage(a, /*demand=*/4, /*marginal_throughput=*/1.0);
+  EXPECT_EQ(cbm.Allotment(a), 1);
+  EXPECT_EQ(cbm.Allotment(b), 1);
+}
+
+// Adds an interleave with tunable parallelism and cycle length, whose inputs
+// take 1us to produce an element, to `model`.
+std::shared_ptr<Node> AddTunableInterleave(Model& model) {
+  std::shared_ptr<mutex> mu = std::make_shared<mutex>();
+  std::shared_ptr<condition_variable> cv =
+      std::make_shared<condition_variable>();
+  std::shared_ptr<Node> interleave = model::MakeAsyncInterleaveManyNode(
+      {0, "interleave", nullptr},
+      {model::MakeParameter(kParallelism,
+                            std::make_shared<SharedState>(
+                                /*value=*/model::kAutotune, mu, cv),
+                            /*min=*/1, /*max=*/8),
+       model::MakeParameter(kCycleLength,
+                            std::make_shared<SharedState>(
+                                /*value=*/model::kAutotune, mu, cv),
+                            /*min=*/1, /*max=*/8)});
+  interleave->add_processing_time(100);
+  interleave->record_element();
+  model.AddNode([&interleave](Node::Args args) { return interleave; },
+                "interleave", nullptr, &interleave);
+  for (int i = 0; i < 3; ++i) {
+    std::shared_ptr<Node> source =
+        model::MakeSourceNode({i + 1, "source", interleave});
+    model.AddNode([&source](Node::Args args) { return source; }, "source",
+                  interleave, &source);
+    source->add_processing_time(1000);
+    source->record_element();
+  }
+  return interleave;
+}
+
+TEST(CpuBudgetManagerTest, HillClimbTunesCycleLengthWithParallelism) {
+  Model model;
+  std::shared_ptr<Node> interleave = AddTunableInterleave(model);
+  CancellationManager cancellation_manager;
+  RamBudgetManager ram_budget_manager(0);
+  model.Optimize(AutotuneAlgorithm::HILL_CLIMB, CpuBudgetFunc(40),
+                 /*ram_budget_share=*/1.0,
+                 /*fixed_ram_budget=*/1 << 30,
+                 /*model_input_time=*/0, ram_budget_manager,
+                 &cancellation_manager);
+  EXPECT_GT(interleave->parameter_value(kParallelism), 1);
+  EXPECT_EQ(interleave->parameter_value(kCycleLength),
+            interleave->parameter_value(kParallelism));
+}
+
+TEST(CpuBudgetManagerTest, AllotmentGrowsWithDemand) {
+  auto cbm = std::make_shared<CpuBudgetManager>(3);
+  Model model;
+  model.SetCpuBudgetManager(cbm);
+  std::shared_ptr<Node> interleave = AddTunableInterleave(model);
+  CancellationManager cancellation_manager;
+  RamBudgetManager ram_budget_manager(0);
+  for (int64_t expected_parallelism : {1, 2, 3, 3}) {
+    model.Optimize(AutotuneAlgorithm::HILL_CLIMB, CpuBudgetFunc(40),
+                   /*ram_budget_share=*/1.0,
+                   /*fixed_ram_budget=*/1 << 30,
+                   /*model_input_time=*/0, ram_budget_manager,
+                   &cancellation_manager);
+    EXPECT_EQ(interleave->parameter_value(kParallelism),
+              expected_parallelism);
+    EXPECT_EQ(interleave->parameter_value(kCycleLength),
+              expected_parallelism);
+  }
+}
+
 TEST(NodeTest, OnlyCollectParametersThatHaveElementsProduced) {
   // Builds a graph:
   // root <- parallel_map <- parallel_interleave
@@ -47,6 +47,7 @@ Rendezvous::ParsedKey& Rendezvous::ParsedKey::operator=(const ParsedKey& b) {
   dst = b.dst;
   edge_name = StringPiece(buf_.data() + (b.edge_name.data() - b_base),
                           b.edge_name.size());
+  hash_ = b.hash_;
   return *this;
 }
 
@@ -109,6 +110,7 @@ Status Rendezvous::ParseKey(StringPiece key, ParsedKey* out) {
     out->src_device = StringPiece(parts[0].data(), parts[0].size());
     out->dst_device = StringPiece(parts[2].data(), parts[2].size());
     out->edge_name = StringPiece(parts[3].data(), parts[3].size());
+    out->hash_ = Hash64(out->buf_.data(), out->buf_.size());
     return OkStatus();
   }
   return errors::InvalidArgument("Invalid  rendezvous key: ", key);
@@ -53,6 +53,9 @@ class RendezvousInterface {
     DeviceContext* device_context = nullptr;
     AllocatorAttributes alloc_attrs;
     CancellationManager* cancellation_manager = nullptr;  // not owned.
+    // Set by Recv ops that receive the value of a variable. Remote rendezvous
+    // may serve such receives from a cache of values of earlier steps.
+    bool is_variable_read = false;
   };
 
   // Parses the key constructed by CreateKey and parse src/dst device
@@ -71,11 +74,16 @@ class RendezvousInterface {
     ParsedKey& operator=(const ParsedKey& b);
     StringPiece FullKey() const { return buf_; }
 
+    // The hash of FullKey(), computed once by ParseKey() so that the
+    // rendezvous tables don't hash the key on every Send and Recv.
+    uint64 hash() const { return hash_; }
+
    private:
     friend class Rendezvous;
     friend class SendOp;
     friend class RecvOp;
     std::string buf_;
+    uint64 hash_ = 0;
   };
 
   // The caller is a tensor producer and it sends a message (a tensor
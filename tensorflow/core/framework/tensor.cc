@@ -964,12 +964,63 @@ int Tensor::RefCount() const {
   CASES_WITH_DEFAULT(TYPE_ENUM, STMTS, LOG(FATAL) << "Type not set"; \
                      , LOG(FATAL) << "Unexpected type: " << TYPE_ENUM;)
 
+static Allocator* get_default_cpu_allocator();
+
+namespace {
+
+// A buffer of at most kMaxBytes bytes stored inside the buffer object. The
+// small host tensors, e.g. the shapes and the scalars of the shape
+// computations, then take a single heap allocation instead of an allocation
+// of the allocator and another one for the buffer.
+class InlineBuffer : public TensorBuffer {
+ public:
+  static constexpr size_t kMaxBytes = 32;
+
+  explicit InlineBuffer(size_t size) : TensorBuffer(storage_), size_(size) {}
+
+  size_t size() const override { return size_; }
+  TensorBuffer* root_buffer() override { return this; }
+  bool GetAllocatedBytes(size_t* out_bytes) const override { return false; }
+
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(size_);
+    proto->set_allocator_name("InlineTensorBuffer");
+    proto->set_ptr(reinterpret_cast<uintptr_t>(data()));
+  }
+
+  AllocatorMemoryType GetMemoryType() const override {
+    return get_default_cpu_allocator()->GetMemoryType();
+  }
+
+ private:
+  ~InlineBuffer() override = default;
+
+  const size_t size_;
+  alignas(Allocator::kAllocatorAlignment) char storage_[kMaxBytes];
+};
+
+// Allocates a T[n] buffer with `a`, or inline if it is small and `a` is the
+// default CPU allocator without allocation tracking.
+template <typename T>
+TensorBuffer* NewBuffer(Allocator* a, int64_t n) {
+  if constexpr (is_simple_type<T>::value) {
+    if (n * sizeof(T) <= InlineBuffer::kMaxBytes &&
+        a == get_default_cpu_allocator() && !MemoryLoggingEnabled() &&
+        !CPUAllocatorStatsEnabled()) {
+      return new InlineBuffer(n * sizeof(T));
+    }
+  }
+  return new Buffer<T>(a, n);
+}
+
+}  // namespace
+
 Tensor::Tensor(Allocator* a, DataType type, const TensorShape& shape)
     : shape_(shape), buf_(nullptr) {
   set_dtype(type);
   CHECK_NOTNULL(a);
   if (shape_.num_elements() > 0 || a->AllocatesOpaqueHandle()) {
-    CASES(type, buf_ = new Buffer<T>(a, shape.num_elements()));
+    CASES(type, buf_ = NewBuffer<T>(a, shape.num_elements()));
   }
   if (MemoryLoggingEnabled() && buf_ != nullptr && buf_->data() != nullptr) {
     LogMemory::RecordTensorAllocation("Unknown", LogMemory::UNKNOWN_STEP_ID,
@@ -1414,6 +1414,34 @@ TEST(TensorFromProto, CompressedTensorProto) {
   ASSERT_TRUE(b.FromProto(p));
 }
 
+TEST(Tensor, SmallHostTensor) {
+  Tensor t(DT_INT32, TensorShape({4}));
+  EXPECT_TRUE(t.IsAligned());
+  for (int i = 0; i < 4; ++i) {
+    t.flat<int32>()(i) = i;
+  }
+  EXPECT_EQ(t.tensor_data().size(), 16);
+  EXPECT_EQ(t.AllocatedBytes(), 16);
+  Tensor copy = t;
+  EXPECT_TRUE(copy.SharesBufferWith(t));
+  Tensor slice = t.Slice(1, 3);
+  EXPECT_TRUE(slice.SharesBufferWith(t));
+  test::ExpectTensorEqual<int32>(slice, test::AsTensor<int32>({1, 2}));
+
+  TensorDescription description;
+  t.FillDescription(&description);
+  Tensor large(DT_INT32, TensorShape({9}));
+  TensorDescription large_description;
+  large.FillDescription(&large_description);
+  if (!CPUAllocatorStatsEnabled()) {
+    // The small tensors are stored inline in their buffer.
+    EXPECT_EQ(description.allocation_description().allocator_name(),
+              "InlineTensorBuffer");
+  }
+  EXPECT_NE(large_description.allocation_description().allocator_name(),
+            "InlineTensorBuffer");
+}
+
 TEST(Tensor, FailureToAllocate) {
   TensorShape shape({1});
   DummyCPUAllocator allocator;
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/graph/graph_partition.h"
 
+#include <algorithm>
 #include <deque>
 #include <memory>
 #include <queue>
@@ -28,6 +29,7 @@ limitations under the License.
 #include "tensorflow/core/framework/memory_types.h"
 #include "tensorflow/core/framework/node_def.pb.h"
 #include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/partial_tensor_shape.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/versions.pb.h"
@@ -181,6 +183,17 @@ void SetSendRecvAttrs(const PartitionOptions& opts, const Edge* edge,
   builder->Attr("_dst", edge->dst()->name());
 }
 
+// Returns true if `edge` carries the value of a variable, either straight from
+// the variable or through a ReadVariableOp or an Identity of it.
+bool IsVariableReadEdge(const Edge* edge) {
+  if (edge->IsControlEdge()) return false;
+  const Node* src = edge->src();
+  if (src->IsVariable() || src->type_string() == "ReadVariableOp") return true;
+  if (!src->IsIdentity()) return false;
+  const Node* input = nullptr;
+  return src->input_node(0, &input).ok() && input->IsVariable();
+}
+
 NodeDef* AddSend(const PartitionOptions& opts, const GraphInfo& g_info,
                  GraphDef* gdef, const Edge* edge,
                  NodeDefBuilder::NodeOut send_from, int64_t start_time,
@@ -291,6 +304,9 @@ NodeDef* AddRecv(const PartitionOptions& opts, const GraphInfo& g_info,
   SetSendRecvAttrs(opts, edge, tensor_name_attr, &recv_builder);
   recv_builder.Device(dst->assigned_device_name())
       .Attr("tensor_type", cast_dtype);
+  if (opts.tag_variable_reads && IsVariableReadEdge(edge)) {
+    recv_builder.Attr("_variable_read", true);
+  }
   NodeDef* recv = gdef->add_node();
   *status = recv_builder.Finalize(recv, /*consume=*/true);
   if (!status->ok()) return nullptr;
@@ -337,6 +353,21 @@ NodeDef* AddDummyConst(const PartitionOptions& opts, GraphDef* gdef,
   return result;
 }
 
+// Returns the estimated number of bytes of the tensor transferred by `edge`,
+// from the "_output_shapes" attr of its source, or 0 if it isn't known.
+int64_t EstimateRecvBytes(const Edge* edge) {
+  if (edge->IsControlEdge()) return 0;
+  const Node* src = edge->src();
+  std::vector<PartialTensorShape> shapes;
+  if (!GetNodeAttr(src->attrs(), "_output_shapes", &shapes).ok() ||
+      edge->src_output() >= shapes.size() ||
+      !shapes[edge->src_output()].IsFullyDefined()) {
+    return 0;
+  }
+  return shapes[edge->src_output()].num_elements() *
+         DataTypeSize(BaseType(src->output_type(edge->src_output())));
+}
+
 // A dummy node for scheduling.
 NodeDef* AddControlTrigger(const PartitionOptions& opts, GraphDef* gdef,
                            const string& assigned_device_name, int64_t epoch,
@@ -918,16 +949,52 @@ Status AddControlEdges(const PartitionOptions& opts,
     }
 
     // Finally, add the control edges to recvs.
+    std::vector<NodeDef*> recvs;
     for (int n = 0; n < gdef->node_size(); ++n) {
       NodeDef* ndef = gdef->mutable_node(n);
       if (ndef->op() == "_Recv") {
-        const int64_t start_time = node_to_start_time[ndef];
-        const int recv_epoch = start_time / resolution;
-        if (recv_epoch >= prefetch) {
-          NodeDef* dummy = dummys[recv_epoch - prefetch];
-          Graph::AddInput(ndef, dummy->name(), Graph::kControlSlot);
+        recvs.push_back(ndef);
+      }
+    }
+    const int64_t memory_budget =
+        opts.recv_memory_budget ? opts.recv_memory_budget(device_name) : 0;
+    if (memory_budget > 0) {
+      // The recvs that start first get the budget first.
+      std::stable_sort(recvs.begin(), recvs.end(),
+                       [&node_to_start_time](NodeDef* a, NodeDef* b) {
+                         return node_to_start_time[a] < node_to_start_time[b];
+                       });
+    }
+    // The bytes of the tensors received during each epoch and waiting for
+    // their consumers.
+    std::vector<int64_t> bytes_in_flight(dummys.size(), 0);
+    for (NodeDef* ndef : recvs) {
+      const int64_t start_time = node_to_start_time[ndef];
+      const int recv_epoch = start_time / resolution;
+      int enable_epoch = recv_epoch - prefetch;
+      int64_t recv_bytes = 0;
+      if (memory_budget > 0 &&
+          TryGetNodeAttr(*ndef, "_recv_bytes", &recv_bytes)) {
+        const int last_epoch =
+            std::min<int>(recv_epoch, bytes_in_flight.size() - 1);
+        auto exceeds_budget = [&](int first_epoch) {
+          return *std::max_element(bytes_in_flight.begin() + first_epoch,
+                                   bytes_in_flight.begin() + last_epoch + 1) +
+                     recv_bytes >
+                 memory_budget;
+        };
+        enable_epoch = std::max(enable_epoch, 0);
+        while (enable_epoch < last_epoch - 1 && exceeds_budget(enable_epoch)) {
+          ++enable_epoch;
+        }
+        for (int i = enable_epoch; i <= last_epoch; ++i) {
+          bytes_in_flight[i] += recv_bytes;
         }
       }
+      if (enable_epoch >= 0) {
+        NodeDef* dummy = dummys[enable_epoch];
+        Graph::AddInput(ndef, dummy->name(), Graph::kControlSlot);
+      }
     }
   }
   return absl::OkStatus();
@@ -1182,6 +1249,12 @@ Status Partition(const PartitionOptions& opts, Graph* g,
       NodeDef* recv = AddRecv(opts, g_info, dst_graph, edge, &real_recv,
                               tensor_name_attr, &status);
       if (!status.ok()) return status;
+      if (opts.scheduling_for_recvs && opts.recv_memory_budget) {
+        const int64_t recv_bytes = EstimateRecvBytes(edge);
+        if (recv_bytes > 0) {
+          AddNodeAttr("_recv_bytes", recv_bytes, real_recv);
+        }
+      }
 
       // Fix up the control flow edge.
       // NOTE(yuanbyu): 'real_recv' must be the real recv node.
@@ -77,10 +77,27 @@ struct PartitionOptions {
   bool need_to_record_start_times = false;
   std::vector<Microseconds> start_times;
 
+  // If set, and 'scheduling_for_recvs' is true, the recvs are also scheduled
+  // so that the tensors received on a device and waiting for their consumers
+  // fit in a memory budget: a large recv is enabled later than the other
+  // recvs, down to the epoch before the one of its consumers, while it would
+  // exceed the budget. Returns the budget in bytes for the partition of the
+  // given device, or a non-positive value if it has none.
+  //
+  // The sizes of the tensors are estimated from the "_output_shapes" attr of
+  // the nodes sending them. The recvs of tensors of unknown size are scheduled
+  // as if there were no budget.
+  std::function<int64_t(const string&)> recv_memory_budget = nullptr;
+
   // Optional customized function to compute the "tensor_name" attr value of
   // Send/Recv ops inserted during partitioning.
   std::function<string(const Edge*)> get_tensor_name_attr = nullptr;
 
+  // If true, Recv nodes that receive the value of a variable, either directly
+  // or through a ReadVariableOp or an Identity, are tagged with the
+  // "_variable_read" attr so that rendezvous may serve them from a cache.
+  bool tag_variable_reads = false;
+
   // If true, the `Partition()` function can make destructive changes to the
   // passed-in `Graph`.
   //
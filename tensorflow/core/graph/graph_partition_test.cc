@@ -563,6 +563,84 @@ TEST_F(GraphPartitionTest, SetIncarnation) {
   }
 }
 
+TEST_F(GraphPartitionTest, TagVariableReads) {
+  GraphDef gdef;
+  CHECK(protobuf::TextFormat::ParseFromString(
+      R"pb(
+        node {
+          name: 'A/v'
+          op: 'VariableV2'
+          attr {
+            key: 'dtype'
+            value { type: DT_FLOAT }
+          }
+          attr {
+            key: 'shape'
+            value { shape {} }
+          }
+        }
+        node {
+          name: 'A/read'
+          op: 'Identity'
+          input: 'A/v'
+          attr {
+            key: 'T'
+            value { type: DT_FLOAT }
+          }
+        }
+        node {
+          name: 'A/c'
+          op: 'Const'
+          attr {
+            key: 'dtype'
+            value { type: DT_FLOAT }
+          }
+          attr {
+            key: 'value'
+            value { tensor { dtype: DT_FLOAT tensor_shape {} float_val: 1 } }
+          }
+        }
+        node {
+          name: 'B/add'
+          op: 'Add'
+          input: 'A/read'
+          input: 'A/c'
+          attr {
+            key: 'T'
+            value { type: DT_FLOAT }
+          }
+        }
+      )pb",
+      &gdef));
+  gdef.mutable_versions()->set_producer(TF_GRAPH_DEF_VERSION);
+  Graph g(OpRegistry::Global());
+  TF_ASSERT_OK(ConvertGraphDefToGraph(GraphConstructorOptions(), gdef, &g));
+  for (Node* node : g.nodes()) {
+    node->set_assigned_device_name(DeviceName(node));
+  }
+
+  PartitionOptions popts;
+  popts.node_to_loc = SplitByDevice;
+  popts.new_name = [&g](const string& prefix) { return g.NewName(prefix); };
+  popts.get_incarnation = [](const string&) { return 1; };
+  popts.tag_variable_reads = true;
+  TF_ASSERT_OK(Partition(popts, &g, &partitions_));
+
+  int num_recvs = 0;
+  const GraphDef& b = partitions_["/job:a/replica:0/task:0/cpu:1"];
+  for (const NodeDef& ndef : b.node()) {
+    if (ndef.op() != "_Recv") continue;
+    ++num_recvs;
+    string src;
+    TF_ASSERT_OK(GetNodeAttr(ndef, "_src", &src));
+    bool variable_read = false;
+    EXPECT_EQ(TryGetNodeAttr(ndef, "_variable_read", &variable_read),
+              src == "A/read")
+        << src;
+  }
+  EXPECT_EQ(num_recvs, 2);
+}
+
 TEST_F(GraphPartitionTest, GraphDebugInfo) {
   GraphDef graph_def;
   Output a1 = FloatInput(in_.WithOpName("A1"));
@@ -810,5 +888,73 @@ TEST(TopologicalSortNodesWithTimePriority, WhileLoop) {
   }
 }
 
+TEST(AddControlEdgesTest, RecvMemoryBudget) {
+  GraphDef gdef;
+  CHECK(protobuf::TextFormat::ParseFromString(
+      R"pb(
+        node {
+          name: "last"
+          op: "NoOp"
+          attr {
+            key: "_start_time"
+            value { i: 990 }
+          }
+        }
+        node {
+          name: "r0"
+          op: "_Recv"
+          attr {
+            key: "_start_time"
+            value { i: 900 }
+          }
+          attr {
+            key: "_recv_bytes"
+            value { i: 600 }
+          }
+        }
+        node {
+          name: "r1"
+          op: "_Recv"
+          attr {
+            key: "_start_time"
+            value { i: 900 }
+          }
+          attr {
+            key: "_recv_bytes"
+            value { i: 600 }
+          }
+        }
+        node {
+          name: "r2"
+          op: "_Recv"
+          attr {
+            key: "_start_time"
+            value { i: 900 }
+          }
+        }
+      )pb",
+      &gdef));
+  std::unordered_map<string, GraphDef> partitions = {{"", gdef}};
+
+  PartitionOptions popts;
+  popts.new_name = [](const string& prefix) { return prefix; };
+  popts.scheduling_for_recvs = true;
+  popts.recv_memory_budget = [](const string& device) { return 1000; };
+  TF_ASSERT_OK(AddControlEdges(popts, &partitions));
+
+  // The epochs last 10us, so the recvs are in epoch 90 and are enabled 6
+  // epochs before by default. Both large recvs don't fit in the budget at the
+  // same time, so the second one is delayed to the epoch before its own.
+  std::unordered_map<string, std::vector<string>> recv_inputs;
+  for (const NodeDef& ndef : partitions[""].node()) {
+    if (ndef.op() == "_Recv") {
+      recv_inputs[ndef.name()] = {ndef.input().begin(), ndef.input().end()};
+    }
+  }
+  EXPECT_THAT(recv_inputs["r0"], ::testing::ElementsAre("^synch_84"));
+  EXPECT_THAT(recv_inputs["r1"], ::testing::ElementsAre("^synch_89"));
+  EXPECT_THAT(recv_inputs["r2"], ::testing::ElementsAre("^synch_84"));
+}
+
 }  // namespace
 }  // namespace tensorflow
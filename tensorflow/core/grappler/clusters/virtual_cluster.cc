@@ -15,18 +15,34 @@ limitations under the License.
 
 #include "tensorflow/core/grappler/clusters/virtual_cluster.h"
 
+#include <memory>
+
 #include "tensorflow/core/framework/cost_graph.pb.h"
 #include "tensorflow/core/framework/tensor_shape.pb.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/grappler/clusters/utils.h"
+#include "tensorflow/core/grappler/costs/measured_cost_database.h"
 #include "tensorflow/core/grappler/costs/op_level_cost_estimator.h"
 
 namespace tensorflow {
 namespace grappler {
 
+namespace {
+
+// Prefers the op costs measured on real runs, if they are collected.
+std::unique_ptr<OpLevelCostEstimator> DefaultNodeEstimator() {
+  if (const MeasuredCostDatabase* measured_costs =
+          MeasuredCostDatabase::Global()) {
+    return std::make_unique<MeasuredOpLevelCostEstimator>(measured_costs);
+  }
+  return std::make_unique<OpLevelCostEstimator>();
+}
+
+}  // namespace
+
 VirtualCluster::VirtualCluster(
     const std::unordered_map<string, DeviceProperties>& devices)
-    : VirtualCluster(devices, std::make_unique<OpLevelCostEstimator>(),
+    : VirtualCluster(devices, DefaultNodeEstimator(),
                      ReadyNodeManagerFactory("FirstReady")) {}
 
 VirtualCluster::VirtualCluster(
@@ -0,0 +1,161 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/costs/measured_cost_database.h"
+
+#include <cstdint>
+#include <optional>
+#include <string>
+
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/grappler/costs/utils.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+// Returns the part of `op_info` that the costs are keyed by.
+OpInfo KeyOpInfo(const OpInfo& op_info) {
+  OpInfo key;
+  key.set_op(op_info.op());
+  key.mutable_device()->set_type(op_info.device().type());
+  key.mutable_device()->set_model(op_info.device().model());
+  for (const auto& input : op_info.inputs()) {
+    OpInfo::TensorProperties* key_input = key.add_inputs();
+    key_input->set_dtype(input.dtype());
+    *key_input->mutable_shape() = input.shape();
+  }
+  return key;
+}
+
+}  // namespace
+
+MeasuredCostDatabase* MeasuredCostDatabase::Global() {
+  static MeasuredCostDatabase* const database = []() -> MeasuredCostDatabase* {
+    std::string path;
+    TF_CHECK_OK(
+        ReadStringFromEnvVar("TF_GRAPPLER_MEASURED_COSTS_FILE", "", &path));
+    if (path.empty()) return nullptr;
+    auto* database = new MeasuredCostDatabase(path);
+    Status status = database->Load();
+    if (!status.ok()) {
+      LOG(WARNING) << "Failed to load the measured op costs from " << path
+                   << ": " << status;
+    }
+    return database;
+  }();
+  return database;
+}
+
+std::string MeasuredCostDatabase::Key(const OpInfo& op_info) {
+  std::string key = absl::StrCat(op_info.op(), ";", op_info.device().type(),
+                                 ";", op_info.device().model());
+  for (const auto& input : op_info.inputs()) {
+    absl::StrAppend(&key, ";", DataTypeString(input.dtype()),
+                    PartialTensorShape::DebugString(input.shape()));
+  }
+  return key;
+}
+
+void MeasuredCostDatabase::Record(const OpInfo& op_info,
+                                  int64_t compute_cost_ns) {
+  if (compute_cost_ns < 0) return;
+  std::string key = Key(op_info);
+  mutex_lock l(mu_);
+  auto [it, inserted] = entries_.try_emplace(std::move(key));
+  Entry& entry = it->second;
+  if (inserted) entry.op_info = KeyOpInfo(op_info);
+  ++entry.count;
+  entry.mean_ns += (compute_cost_ns - entry.mean_ns) / entry.count;
+}
+
+void MeasuredCostDatabase::AddCostGraph(const CostGraphDef& cost_graph,
+                                        const GraphDef& graph) {
+  const OpPerformanceList performance =
+      CostGraphToOpPerformanceData(cost_graph, graph);
+  for (const OpPerformance& op_performance : performance.op_performance()) {
+    Record(op_performance.op(), op_performance.compute_cost());
+  }
+}
+
+std::optional<int64_t> MeasuredCostDatabase::Lookup(
+    const OpInfo& op_info) const {
+  const std::string key = Key(op_info);
+  tf_shared_lock l(mu_);
+  auto it = entries_.find(key);
+  if (it == entries_.end()) return std::nullopt;
+  return static_cast<int64_t>(it->second.mean_ns);
+}
+
+int64_t MeasuredCostDatabase::size() const {
+  tf_shared_lock l(mu_);
+  return entries_.size();
+}
+
+Status MeasuredCostDatabase::Load() {
+  if (!Env::Default()->FileExists(path_).ok()) return absl::OkStatus();
+  OpPerformanceList performance;
+  TF_RETURN_IF_ERROR(ReadBinaryProto(Env::Default(), path_, &performance));
+  for (const OpPerformance& op_performance : performance.op_performance()) {
+    Record(op_performance.op(), op_performance.compute_cost());
+  }
+  return absl::OkStatus();
+}
+
+Status MeasuredCostDatabase::Save() const {
+  OpPerformanceList performance;
+  {
+    tf_shared_lock l(mu_);
+    for (const auto& [key, entry] : entries_) {
+      OpPerformance* op_performance = performance.add_op_performance();
+      *op_performance->mutable_op() = entry.op_info;
+      op_performance->set_compute_cost(static_cast<int64_t>(entry.mean_ns));
+    }
+  }
+  // Write to a temporary file first, so that concurrent readers never see a
+  // partially written file.
+  const std::string tmp_path = absl::StrCat(path_, ".tmp");
+  TF_RETURN_IF_ERROR(WriteBinaryProto(Env::Default(), tmp_path, performance));
+  return Env::Default()->RenameFile(tmp_path, path_);
+}
+
+Costs MeasuredOpLevelCostEstimator::PredictCosts(
+    const OpContext& op_context) const {
+  Costs costs = OpLevelCostEstimator::PredictCosts(op_context);
+  const std::optional<int64_t> measured_ns =
+      database_->Lookup(op_context.op_info);
+  if (!measured_ns.has_value()) return costs;
+
+  VLOG(2) << "Using the measured cost of " << op_context.name << ": "
+          << *measured_ns << "ns instead of "
+          << costs.execution_time.count() << "ns";
+  costs.execution_time = Costs::Duration(*measured_ns);
+  costs.compute_time = costs.execution_time;
+  costs.memory_time = Costs::Duration(0);
+  costs.intermediate_memory_time = Costs::Duration(0);
+  costs.intermediate_memory_read_time = Costs::Duration(0);
+  costs.intermediate_memory_write_time = Costs::Duration(0);
+  costs.inaccurate = false;
+  costs.num_ops_with_unknown_shapes = 0;
+  return costs;
+}
+
+}  // end namespace grappler
+}  // end namespace tensorflow
@@ -0,0 +1,104 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_GRAPPLER_COSTS_MEASURED_COST_DATABASE_H_
+#define TENSORFLOW_CORE_GRAPPLER_COSTS_MEASURED_COST_DATABASE_H_
+
+#include <cstdint>
+#include <optional>
+#include <string>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/framework/cost_graph.pb.h"
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/grappler/costs/cost_estimator.h"
+#include "tensorflow/core/grappler/costs/op_context.h"
+#include "tensorflow/core/grappler/costs/op_level_cost_estimator.h"
+#include "tensorflow/core/grappler/costs/op_performance_data.pb.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+namespace grappler {
+
+// Thread-safe.
+// The compute costs of ops measured on real runs, keyed by the op type, the
+// types and shapes of the inputs, and the type and model of the device. The
+// costs are the averages of the measurements, and are persisted as an
+// OpPerformanceList so that later optimization runs can use them.
+class MeasuredCostDatabase {
+ public:
+  // `path` is the file the costs are loaded from and saved to.
+  explicit MeasuredCostDatabase(const std::string& path) : path_(path) {}
+
+  // Returns the process-wide database, loaded from the file named by the
+  // TF_GRAPPLER_MEASURED_COSTS_FILE environment variable, or nullptr if it is
+  // not set.
+  static MeasuredCostDatabase* Global();
+
+  // Returns the key of the costs of the op described by `op_info`.
+  static std::string Key(const OpInfo& op_info);
+
+  // Adds the measured compute cost of an op.
+  void Record(const OpInfo& op_info, int64_t compute_cost_ns);
+
+  // Adds the compute costs of the nodes of `graph` in `cost_graph`, e.g. as
+  // collected by RunMetadata.
+  void AddCostGraph(const CostGraphDef& cost_graph, const GraphDef& graph);
+
+  // Returns the average measured compute cost of the op described by
+  // `op_info`, if any.
+  std::optional<int64_t> Lookup(const OpInfo& op_info) const;
+
+  int64_t size() const;
+
+  // Loads the costs saved in the file, if it exists. The loaded costs count as
+  // one measurement each.
+  Status Load();
+  Status Save() const;
+
+ private:
+  struct Entry {
+    OpInfo op_info;
+    double mean_ns = 0;
+    int64_t count = 0;
+  };
+
+  const std::string path_;
+
+  mutable mutex mu_;
+  absl::flat_hash_map<std::string, Entry> entries_ TF_GUARDED_BY(mu_);
+};
+
+// An OpLevelCostEstimator that prefers the compute costs measured in a
+// MeasuredCostDatabase, and falls back to the analytical estimates for ops
+// that were not measured. The memory usage is always estimated analytically.
+class MeasuredOpLevelCostEstimator : public OpLevelCostEstimator {
+ public:
+  // `database` must outlive the estimator.
+  explicit MeasuredOpLevelCostEstimator(const MeasuredCostDatabase* database)
+      : database_(database) {}
+
+  Costs PredictCosts(const OpContext& op_context) const override;
+
+ private:
+  const MeasuredCostDatabase* const database_;
+};
+
+}  // end namespace grappler
+}  // end namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_COSTS_MEASURED_COST_DATABASE_H_
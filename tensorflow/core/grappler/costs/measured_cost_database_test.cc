@@ -0,0 +1,108 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/costs/measured_cost_database.h"
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "tensorflow/core/framework/tensor_shape.pb.h"
+#include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/core/grappler/costs/op_context.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+OpContext DescribeAdd(const std::vector<int64_t>& dims) {
+  OpContext op_context;
+  op_context.name = "add";
+  OpInfo& op_info = op_context.op_info;
+  op_info.set_op("AddV2");
+  op_info.mutable_device()->set_type("CPU");
+  op_info.mutable_device()->set_num_cores(4);
+  op_info.mutable_device()->set_frequency(1000);
+  for (int i = 0; i < 2; ++i) {
+    OpInfo::TensorProperties* input = op_info.add_inputs();
+    input->set_dtype(DT_FLOAT);
+    for (int64_t dim : dims) input->mutable_shape()->add_dim()->set_size(dim);
+  }
+  *op_info.add_outputs() = op_info.inputs(0);
+  return op_context;
+}
+
+TEST(MeasuredCostDatabaseTest, AveragesMeasurementsPerShape) {
+  MeasuredCostDatabase database("");
+  const OpInfo small = DescribeAdd({16}).op_info;
+  const OpInfo large = DescribeAdd({1024}).op_info;
+  database.Record(small, 100);
+  database.Record(small, 300);
+  database.Record(large, 5000);
+
+  EXPECT_EQ(database.size(), 2);
+  EXPECT_EQ(database.Lookup(small), 200);
+  EXPECT_EQ(database.Lookup(large), 5000);
+  EXPECT_EQ(database.Lookup(DescribeAdd({32}).op_info), std::nullopt);
+
+  // The device is part of the key.
+  OpInfo gpu = small;
+  gpu.mutable_device()->set_type("GPU");
+  EXPECT_EQ(database.Lookup(gpu), std::nullopt);
+}
+
+TEST(MeasuredCostDatabaseTest, SaveAndLoad) {
+  const std::string path =
+      io::JoinPath(testing::TmpDir(), "measured_cost_database_test.pb");
+  const OpInfo op_info = DescribeAdd({16}).op_info;
+  {
+    MeasuredCostDatabase database(path);
+    database.Record(op_info, 1234);
+    TF_ASSERT_OK(database.Save());
+  }
+
+  MeasuredCostDatabase database(path);
+  TF_ASSERT_OK(database.Load());
+  EXPECT_EQ(database.size(), 1);
+  EXPECT_EQ(database.Lookup(op_info), 1234);
+}
+
+TEST(MeasuredOpLevelCostEstimatorTest, PrefersMeasuredCosts) {
+  MeasuredCostDatabase database("");
+  const OpContext measured = DescribeAdd({16});
+  const OpContext not_measured = DescribeAdd({1024});
+  database.Record(measured.op_info, 1000000);
+
+  MeasuredOpLevelCostEstimator estimator(&database);
+  OpLevelCostEstimator analytical_estimator;
+
+  const Costs measured_costs = estimator.PredictCosts(measured);
+  EXPECT_EQ(measured_costs.execution_time, Costs::Duration(1000000));
+  EXPECT_EQ(measured_costs.compute_time, Costs::Duration(1000000));
+  EXPECT_FALSE(measured_costs.inaccurate);
+
+  const Costs fallback_costs = estimator.PredictCosts(not_measured);
+  const Costs analytical_costs =
+      analytical_estimator.PredictCosts(not_measured);
+  EXPECT_EQ(fallback_costs.execution_time, analytical_costs.execution_time);
+  EXPECT_EQ(fallback_costs.memory_time, analytical_costs.memory_time);
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
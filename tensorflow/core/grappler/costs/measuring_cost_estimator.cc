@@ -20,6 +20,7 @@ limitations under the License.
 #include "tensorflow/core/framework/cost_graph.pb.h"
 #include "tensorflow/core/framework/step_stats.pb.h"
 #include "tensorflow/core/grappler/clusters/cluster.h"
+#include "tensorflow/core/grappler/costs/measured_cost_database.h"
 #include "tensorflow/core/grappler/costs/robust_stats.h"
 #include "tensorflow/core/grappler/grappler_item.h"
 #include "tensorflow/core/kernels/ops_util.h"
@@ -58,6 +59,9 @@ Status MeasuringCostEstimator::PredictCosts(const GraphDef& optimized_graph,
     cost_graph = run_metadata->mutable_cost_graph();
   }
   const bool running_simulation = (cluster_->type() == "virtual");
+  // Feed the costs measured on real runs back to later optimizations.
+  MeasuredCostDatabase* const measured_costs =
+      running_simulation ? nullptr : MeasuredCostDatabase::Global();
 
   std::vector<double> times(measurement_steps_);
   BlockingCounter barrier(measurement_steps_);
@@ -104,6 +108,9 @@ Status MeasuringCostEstimator::PredictCosts(const GraphDef& optimized_graph,
       const double time = (finish - start).count() * 1e3;
       times[step] = time;
     }
+    if (measured_costs && (step + 1 == measurement_steps_)) {
+      measured_costs->AddCostGraph(metadata.cost_graph(), optimized_graph);
+    }
     if (cost_graph && (step + 1 == measurement_steps_)) {
       metadata.mutable_cost_graph()->Swap(cost_graph);
     }
@@ -139,6 +146,13 @@ Status MeasuringCostEstimator::PredictCosts(const GraphDef& optimized_graph,
     return status;
   }
 
+  if (measured_costs) {
+    Status save_status = measured_costs->Save();
+    if (!save_status.ok()) {
+      LOG(WARNING) << "Failed to save the measured op costs: " << save_status;
+    }
+  }
+
   // Compute the average time of the measure steps. Use Huber statistics
   // to filter out outliers.
   RobustStats stats(times);
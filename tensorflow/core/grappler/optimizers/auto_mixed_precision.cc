@@ -43,6 +43,7 @@ limitations under the License.
 #include "tensorflow/core/lib/strings/numbers.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/statusor.h"
@@ -1101,6 +1102,8 @@ class AutoMixedPrecisionImpl {
       std::vector<NodeTypeIdEdge>* implicit_fp32_edges) const;
   void AddAllowlistOps(absl::flat_hash_set<int>* allow_set) const;
   void RemoveAllowsetWithFp32(absl::flat_hash_set<int>* allow_set) const;
+  void RemoveUnprofitableAllowClusters(
+      absl::flat_hash_set<int>* allow_set) const;
   void PropagateDenyFwdThroughClearAndInfer(
       absl::flat_hash_set<int>* deny_set) const;
   void ForceColorMatchBetweenTensorListOps(
@@ -1540,6 +1543,11 @@ Status AutoMixedPrecisionImpl::Optimize() {
   RemoveAllowsetWithFp32(&allow_set);
   VLOG(2) << "Finished pass 6";
 
+  VLOG(2) << "Beginning pass 7 to remove the allow clusters whose casts cost "
+             "more than they save";
+  RemoveUnprofitableAllowClusters(&allow_set);
+  VLOG(2) << "Finished pass 7";
+
   VLOG(2) << "Forcing color match between data structure ops";
   for (const auto& cluster : tensor_list_clusters) {
     ForceColorMatchBetweenTensorListOps(cluster, &allow_set, &deny_set);
@@ -1914,6 +1922,84 @@ void AutoMixedPrecisionImpl::RemoveAllowsetWithFp32(
   }
 }
 
+// Removes from allow_set the connected clusters of allow nodes that aren't
+// worth the casts at their boundaries: those left without any allowlist op by
+// RemoveAllowsetWithFp32, and those with many more boundary casts than
+// allowlist ops. Only the allowlist ops are much faster in bfloat16 on the CPU,
+// the casts of the other ops mostly cost more than they save. Currently only
+// target for oneDNN.
+void AutoMixedPrecisionImpl::RemoveUnprofitableAllowClusters(
+    absl::flat_hash_set<int>* allow_set) const {
+  if (mode_ != AutoMixedPrecisionMode::BF16) {
+    return;
+  }
+  // The number of boundary casts an allowlist op is assumed to pay for.
+  constexpr int kMaxCastsPerAllowlistOp = 8;
+  absl::flat_hash_set<int> visited;
+  int num_kept_clusters = 0;
+  int num_removed_clusters = 0;
+  int num_kept_allowlist_ops = 0;
+  int num_kept_casts = 0;
+  for (int root_idx = 0; root_idx < graph_type_view_.num_nodes(); ++root_idx) {
+    if (!allow_set->count(root_idx) || visited.count(root_idx)) continue;
+    const NodeTypeId& root = *graph_type_view_.GetNode(root_idx);
+    std::vector<int> cluster;
+    DfsTypeTraversal(graph_type_view_, {&root},
+                     TypeTraversalDirection::kFollowInputsAndOutputs,
+                     DfsTypePredicates::Enter([&](int idx) -> bool {
+                       return allow_set->count(idx) && !visited.count(idx);
+                     }),
+                     DfsTypeCallbacks::PreOrder([&](int idx) {
+                       visited.insert(idx);
+                       cluster.push_back(idx);
+                     }));
+    int num_allowlist_ops = 0;
+    int num_casts = 0;
+    for (int idx : cluster) {
+      const NodeTypeId& item = *graph_type_view_.GetNode(idx);
+      if (f16_allowlist_.count(item.node->op())) ++num_allowlist_ops;
+      // The casts of the constants are folded, and the outputs of a node share
+      // their cast.
+      absl::flat_hash_set<int> cast_fanins;
+      for (const int fanin : graph_type_view_.GetFanin(idx)) {
+        if (!allow_set->count(fanin) &&
+            !IsConstant(*graph_type_view_.GetNode(fanin)->node)) {
+          cast_fanins.insert(fanin);
+        }
+      }
+      num_casts += cast_fanins.size();
+      for (const int fanout : graph_type_view_.GetFanout(idx)) {
+        if (!allow_set->count(fanout)) {
+          ++num_casts;
+          break;
+        }
+      }
+    }
+    if (num_allowlist_ops > 0 &&
+        num_casts <= kMaxCastsPerAllowlistOp * num_allowlist_ops) {
+      ++num_kept_clusters;
+      num_kept_allowlist_ops += num_allowlist_ops;
+      num_kept_casts += num_casts;
+      continue;
+    }
+    ++num_removed_clusters;
+    for (int idx : cluster) {
+      allow_set->erase(idx);
+      if (VLOG_IS_ON(2)) {
+        const NodeTypeId& item = *graph_type_view_.GetNode(idx);
+        VLOG(2) << "UnPainting type " << item.type_attr.DebugString()
+                << " of node " << item.node->name() << " ALLOW because its "
+                << "cluster has " << num_allowlist_ops << " allowlist ops and "
+                << num_casts << " boundary casts";
+      }
+    }
+  }
+  VLOG(1) << "Converting " << num_kept_clusters << " clusters with "
+          << num_kept_allowlist_ops << " allowlist ops and " << num_kept_casts
+          << " boundary casts to bfloat16, skipping " << num_removed_clusters
+          << " unprofitable clusters";
+}
+
 // Forces NextIteration nodes and their output Merge node(s) to have the same
 // color. Specifically, it removes them all from allow_set if any of the Merge
 // nodes is not in allow_set, otherwise it adds the NextIteration node to
@@ -2321,6 +2407,16 @@ Status AutoMixedPrecision::Optimize(Cluster* cluster, const GrapplerItem& item,
     LOG(WARNING) << "Note: GPUs detected. Using " << name()
                  << " graph optimizer configured for BFloat16 on CPUs";
   }
+  // Without AMX-BF16 or AVX512-BF16, the bfloat16 kernels convert their inputs
+  // to float32 and the casts inserted by the optimizer are rarely paid for.
+  if (mode_ == AutoMixedPrecisionMode::BF16 &&
+      !port::TestCPUFeature(port::CPUFeature::AMX_BF16) &&
+      !port::TestCPUFeature(port::CPUFeature::AVX512_BF16)) {
+    LOG_FIRST_N(WARNING, 1)
+        << "This CPU has no native bfloat16 instructions (AMX-BF16 or "
+           "AVX512-BF16), the " << name()
+        << " graph optimizer may slow the model down";
+  }
 
   // Optimize the output graph in-place.
   AutoMixedPrecisionImpl optimizer(cluster, item.NodesToPreserve(), output,
@@ -34,6 +34,7 @@ limitations under the License.
 #include "tensorflow/core/grappler/utils/grappler_test.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/random/random.h"
+#include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/util/util.h"
 
 // TODO(benbarsdell): Improve the numerical checks in these tests. The tests
@@ -1678,6 +1679,42 @@ TEST_F(AutoMixedPrecisionMklTest, TensorListSetGet) {
   }
 }
 
+TEST_F(AutoMixedPrecisionMklTest, UnprofitableCluster) {
+  if (!IsMKLEnabled())
+    GTEST_SKIP() << "Test only applicable to MKL auto-mixed precision.";
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope().WithDevice(
+      "/job:localhost/replica:0/task:0/device:CPU:0");
+  Output input = ops::Const(s.WithOpName("input"), 1.f / 32, {32, 32});
+  Output allow1 = ops::MatMul(s.WithOpName("allow1"), input, input);
+  // Each float32 input of the chain between the allowlist ops needs a cast.
+  Output infer = allow1;
+  for (int i = 0; i < 20; ++i) {
+    Output cst = ops::Const(s.WithOpName(strings::StrCat("input", i)), 1.f * i,
+                            {32, 32});
+    Output infer_input =
+        ops::Sqrt(s.WithOpName(strings::StrCat("infer_input", i)), cst);
+    infer =
+        ops::Add(s.WithOpName(strings::StrCat("infer", i)), infer, infer_input);
+  }
+  Output allow2 = ops::MatMul(s.WithOpName("allow2"), infer, infer);
+  Output fetch = ops::Identity(s.WithOpName("fetch"), allow2);
+
+  GrapplerItem item;
+  item.fetch = {"fetch"};
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  AutoMixedPrecision optimizer{AutoMixedPrecisionMode::BF16};
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(virtual_cluster_.get(), item, &output));
+  VLOG(1) << output.DebugString();
+
+  GraphView output_view(&output);
+  EXPECT_EQ(output.node_size(), item.graph.node_size());
+  EXPECT_EQ(output_view.GetNode("allow1")->attr().at("T").type(), DT_FLOAT);
+  EXPECT_EQ(output_view.GetNode("infer0")->attr().at("T").type(), DT_FLOAT);
+  EXPECT_EQ(output_view.GetNode("allow2")->attr().at("T").type(), DT_FLOAT);
+}
+
 TEST_F(AutoMixedPrecisionMklTest, InferFollowUpStreamAllow) {
   if (!IsMKLEnabled())
     GTEST_SKIP() << "Test only applicable to MKL auto-mixed precision.";
@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow/core/grappler/optimizers/function_optimizer.h"
 
+#include <cstdint>
+#include <optional>
 #include <vector>
 
 #include "absl/algorithm/container.h"
@@ -26,6 +28,7 @@ limitations under the License.
 #include "absl/strings/str_replace.h"
 #include "absl/strings/substitute.h"
 #include "tensorflow/compiler/jit/defs.h"
+#include "tensorflow/core/common_runtime/branch_profile.h"
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/common_runtime/device_mgr.h"
 #include "tensorflow/core/common_runtime/device_set.h"
@@ -820,6 +823,55 @@ bool LowerAsMultiDeviceFunctionIsOn(const Node* n) {
   return CheckBoolAttr(n, kLowerAsMultiDeviceFunctionAttr);
 }
 
+// If and Case nodes whose branch profile shows that one of the branches is
+// taken at least this ratio of at least this number of executions are kept
+// functional.
+constexpr int64_t kMinBranchProfileSamples = 100;
+constexpr double kMinDominantBranchRatio = 0.99;
+
+// Checks if an If or Case node must be kept functional instead of lowered to
+// Switch/Merge because of the process-wide BranchProfile:
+//
+// 1) One of its branches is almost always taken. A lowered node places,
+//    allocates and propagates dead tensors through all the branches on every
+//    execution, while the functional op only runs the branch that is taken,
+//    and keeps the other branches as the fallback if the predicate changes.
+// 2) The profile is being recorded and the node was not executed enough times
+//    yet, because only the If and Case kernels record to the profile.
+bool KeepFunctionalForBranchProfile(const Node* n) {
+  std::vector<string> branches;
+  if (n->IsIfNode()) {
+    NameAttrList then_func, else_func;
+    if (!GetNodeAttr(n->attrs(), "then_branch", &then_func).ok() ||
+        !GetNodeAttr(n->attrs(), "else_branch", &else_func).ok()) {
+      return false;
+    }
+    branches = {then_func.name(), else_func.name()};
+  } else if (n->IsCaseNode()) {
+    std::vector<NameAttrList> branch_funcs;
+    if (!GetNodeAttr(n->attrs(), "branches", &branch_funcs).ok()) {
+      return false;
+    }
+    for (const NameAttrList& func : branch_funcs) {
+      branches.push_back(func.name());
+    }
+  } else {
+    return false;
+  }
+
+  const BranchProfile* profile = BranchProfile::Global();
+  const string key = BranchProfile::Key(n->name(), branches);
+  const std::optional<int> dominant_branch = profile->DominantBranch(
+      key, kMinBranchProfileSamples, kMinDominantBranchRatio);
+  if (dominant_branch.has_value()) {
+    VLOG(2) << "Branch " << *dominant_branch << " of " << n->name()
+            << " is dominant";
+    return true;
+  }
+  return BranchProfile::RecordingEnabled() &&
+         profile->NumExecutions(key) < kMinBranchProfileSamples;
+}
+
 bool MarkedForXlaCompilation(const NodeDef& n) {
   auto is_enabled = [&](std::string attr_name) -> bool {
     auto it = n.attr().find(attr_name);
@@ -1264,6 +1316,13 @@ Status InlineFunctionCalls(const GrapplerItem& item,
     // Special case for lowering functional control flow ops. We do not rely on
     // LowerFunctionOpsPass because in Grappler we have to be more restrictive
     // about what type of function calls we are allowed to inline.
+    if (lower_control_flow && LowerUsingSwitchMergeIsOn(n) &&
+        KeepFunctionalForBranchProfile(n)) {
+      VLOG(2) << "Keep functional control flow op: " << SummarizeNode(*n);
+      // Also prevent the LowerFunctionalOpsPass from lowering it at runtime.
+      n->AddAttr(kLowerUsingSwitchMergeAttr, false);
+      continue;
+    }
     if (lower_control_flow && LowerUsingSwitchMergeIsOn(n)) {
       VLOG(2) << "Lower functional control flow op: " << SummarizeNode(*n);
       AddStrictInputSemantics(n, graph.get());
@@ -23,6 +23,7 @@ limitations under the License.
 #include "absl/algorithm/container.h"
 #include "tensorflow/cc/ops/functional_ops.h"
 #include "tensorflow/cc/ops/standard_ops.h"
+#include "tensorflow/core/common_runtime/branch_profile.h"
 #include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/framework/function_testlib.h"
 #include "tensorflow/core/framework/node_def.pb.h"
@@ -1432,6 +1433,67 @@ TEST_F(FunctionOptimizerTest, InlineIndirectFunctionDontLowerControlFlow) {
   }
 }
 
+TEST_F(FunctionOptimizerTest, KeepFunctionalControlFlowWithDominantBranch) {
+  FunctionOptimizer optimizer(RewriterConfig::AGGRESSIVE,
+                              /*lower_control_flow=*/true);
+
+  const auto count_nodes_with_op = [](const GraphDef& graph,
+                                      const string& op) {
+    return absl::c_count_if(graph.node(), [&](const NodeDef& node) {
+      return node.op() == op;
+    });
+  };
+
+  // item.fetch['d'] == (is_add) ? a + b : a * b
+  GrapplerItem item = ConditionalAdd();
+  BranchProfile* profile = BranchProfile::Global();
+  const string key = BranchProfile::Key("c/if_node", {"MyAdd", "MyMul"});
+
+  // Both branches are taken: the `If` node is lowered.
+  profile->Clear();
+  for (int i = 0; i < 100; ++i) profile->Record(key, i % 2, 2);
+  {
+    GraphDef optimized_graph;
+    TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &optimized_graph));
+    EXPECT_EQ(count_nodes_with_op(optimized_graph, "If"), 0);
+    EXPECT_EQ(count_nodes_with_op(optimized_graph, "Merge"), 2);
+  }
+
+  // The else branch is almost always taken: the `If` node is kept, and must not
+  // be lowered at runtime either.
+  profile->Clear();
+  for (int i = 0; i < 1000; ++i) profile->Record(key, i == 0 ? 0 : 1, 2);
+  GraphDef optimized_graph;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &optimized_graph));
+  profile->Clear();
+  EXPECT_EQ(count_nodes_with_op(optimized_graph, "PartitionedCall"), 0);
+  EXPECT_EQ(count_nodes_with_op(optimized_graph, "If"), 1);
+  EXPECT_EQ(count_nodes_with_op(optimized_graph, "Switch"), 0);
+  EXPECT_EQ(count_nodes_with_op(optimized_graph, "Merge"), 0);
+  for (const NodeDef& node : optimized_graph.node()) {
+    if (node.op() != "If") continue;
+    EXPECT_EQ(node.name(), "c/if_node");
+    EXPECT_FALSE(node.attr().at("_lower_using_switch_merge").b());
+  }
+
+  // The cold branch still runs when it is taken.
+  GrapplerItem optimized = item.WithGraph(std::move(optimized_graph));
+  for (bool is_add : {true, false}) {
+    std::vector<std::pair<string, Tensor>> feed = {
+        {"a", test::AsScalar<float>(1.0)},
+        {"b", test::AsScalar<float>(2.0)},
+        {"is_add", test::AsScalar<bool>(is_add)}};
+    item.feed = feed;
+    optimized.feed = feed;
+
+    auto tensors_expected = EvaluateFetchNodes(item);
+    ASSERT_EQ(tensors_expected.size(), 1);
+    auto tensors = EvaluateFetchNodes(optimized);
+    ASSERT_EQ(tensors.size(), tensors_expected.size());
+    test::ExpectTensorEqual<float>(tensors_expected[0], tensors[0]);
+  }
+}
+
 TEST_F(FunctionOptimizerTest, SpecializeFunctionXTimesTwo) {
   using test::function::NDef;
 
@@ -24,12 +24,16 @@ limitations under the License.
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/grappler/clusters/cluster.h"
+#include "tensorflow/core/grappler/costs/op_context.h"
+#include "tensorflow/core/grappler/costs/op_level_cost_estimator.h"
+#include "tensorflow/core/grappler/costs/utils.h"
 #include "tensorflow/core/grappler/grappler_item.h"
 #include "tensorflow/core/grappler/op_types.h"
 #include "tensorflow/core/grappler/optimizers/generic_layout_optimizer_transposer.h"
 #include "tensorflow/core/grappler/optimizers/generic_layout_optimizer_transposer_factory.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/platform/tensor_float_32_utils.h"
+#include "tensorflow/core/util/util.h"
 
 namespace tensorflow {
 namespace grappler {
@@ -38,8 +42,12 @@ namespace {
 
 constexpr char kNHWC[] = "NHWC";
 constexpr char kNCHW[] = "NCHW";
+constexpr char kAttrDataFormat[] = "data_format";
 constexpr float kGPURatioThreshold = 0.5;
 constexpr float kConvGPUExpectedDtypeThreshold = 0.5;
+// Maximum estimated time of the Transpose nodes left by a conversion on CPU,
+// relative to the estimated time of the converted layout sensitive nodes.
+constexpr float kCPUMaxReorderTimeRatio = 0.1;
 
 struct MutableNodeViewFormatter {
   void operator()(std::string* out, utils::MutableNodeView* node_view) const {
@@ -437,6 +445,70 @@ Status EraseCancellableNodesAroundPad(TransposeContext* context) {
   return mutation->Apply();
 }
 
+// Returns whether the conversion in `context` is worth its Transpose nodes on
+// CPU. The oneDNN kernels run both NCHW and NHWC natively, reordering into
+// their blocked formats internally, so the conversion to NHWC only pays off
+// when the reorders it adds are cheap compared to the converted nodes. Must be
+// called before the output shape attributes are erased.
+bool IsCPUConversionProfitable(const TransposeContext& context) {
+  static const OpLevelCostEstimator* estimator = new OpLevelCostEstimator();
+  const auto predict_time = [](const OpContext& op_context) {
+    return estimator->PredictCosts(op_context).execution_time.count();
+  };
+
+  int64_t reorder_ns = 0;
+  int64_t converted_ns = 0;
+  const int num_nodes = context.graph_view->NumNodes();
+  for (int i = 0; i < num_nodes; ++i) {
+    const auto* node = context.graph_view->GetNode(i);
+    const NodeDef* node_def = node->node();
+    OpContext op_context;
+    op_context.name = node_def->name();
+    op_context.device_name = node_def->device();
+    OpInfo& op_info = op_context.op_info;
+    op_info.set_op(node_def->op());
+    *op_info.mutable_attr() = node_def->attr();
+    *op_info.mutable_device() = GetDeviceInfo(node_def->device());
+    if (i >= context.num_nodes) {
+      // An added node, whose shape is only known from its attribute.
+      if (!IsTranspose(*node_def)) continue;
+      const auto* shape_attr = node->GetAttr(kAttrOutputShape);
+      const auto* type_attr = node->GetAttr("T");
+      if (shape_attr == nullptr || type_attr == nullptr ||
+          shape_attr->list().shape_size() != 1) {
+        return true;
+      }
+      OpInfo::TensorProperties tensor;
+      tensor.set_dtype(type_attr->type());
+      *tensor.mutable_shape() = shape_attr->list().shape(0);
+      *op_info.add_inputs() = tensor;
+      *op_info.add_outputs() = tensor;
+      reorder_ns += predict_time(op_context);
+    } else if (IsLayoutSensitiveOp(*node_def)) {
+      const auto* data_format_attr = node->GetAttr(kAttrDataFormat);
+      if (data_format_attr == nullptr ||
+          data_format_attr->s() != context.dst_format) {
+        continue;
+      }
+      // The properties are those of the original graph, in the source format.
+      for (const auto& input :
+           context.graph_properties->GetInputProperties(node_def->name())) {
+        *op_info.add_inputs() = input;
+      }
+      for (const auto& output :
+           context.graph_properties->GetOutputProperties(node_def->name())) {
+        *op_info.add_outputs() = output;
+      }
+      (*op_info.mutable_attr())[kAttrDataFormat].set_s(context.src_format);
+      converted_ns += predict_time(op_context);
+    }
+  }
+  VLOG(2) << "Layout conversion on CPU adds reorders estimated to take "
+          << reorder_ns << "ns to nodes estimated to take " << converted_ns
+          << "ns";
+  return reorder_ns <= kCPUMaxReorderTimeRatio * converted_ns;
+}
+
 Status EraseOutputShapeAttrs(TransposeContext* context) {
   utils::MutableGraphView* graph_view = context->graph_view.get();
   utils::Mutation* mutation = graph_view->GetMutationBuilder();
@@ -492,6 +564,7 @@ Status GenericLayoutOptimizer::Optimize(Cluster* cluster,
         /*assume_valid_feeds=*/is_aggressive, item, cluster, &context));
     switch (cpu_layout_conversion_) {
       case RewriterConfig::NCHW_TO_NHWC:
+      case RewriterConfig::NCHW_TO_NHWC_IF_PROFITABLE:
         context.AssignDeviceAndDataFormats(kCPU, kNCHW, kNHWC);
         break;
       // TODO(intel-tf): Add functionality for NHWC_TO_NCHW layout conversion on
@@ -518,6 +591,15 @@ Status GenericLayoutOptimizer::Optimize(Cluster* cluster,
     TF_RETURN_IF_ERROR(
         context.graph_view->SortTopologically(/*ignore_cycles=*/false, {}));
   }
+  // Without oneDNN, the CPU kernels may only support the destination format.
+  if (gpu_stats.num_gpus == 0 &&
+      cpu_layout_conversion_ == RewriterConfig::NCHW_TO_NHWC_IF_PROFITABLE &&
+      IsMKLEnabled() && !IsCPUConversionProfitable(context)) {
+    VLOG(2) << "Not converting the layout on CPU, since the reorders would "
+               "cost more than they save.";
+    *output = item.graph;
+    return absl::OkStatus();
+  }
   TF_RETURN_IF_ERROR(EraseOutputShapeAttrs(&context));
 
   *output = context.graph;
@@ -34,6 +34,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/platform/tensor_float_32_utils.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/util/util.h"
 
 namespace tensorflow {
 namespace grappler {
@@ -775,6 +776,46 @@ TEST_F(GenericLayoutOptimizerTest, OptimizeSimpleConv3DGraph_CPU) {
 #endif
 }
 
+TEST_F(GenericLayoutOptimizerTest, CPUConversionIfProfitable) {
+#if (GOOGLE_CUDA || TENSORFLOW_USE_ROCM)
+  GTEST_SKIP() << "The conversion is only gated on CPU";
+#endif  // (GOOGLE_CUDA || TENSORFLOW_USE_ROCM)
+  if (!IsMKLEnabled()) {
+    GTEST_SKIP() << "The conversion is only gated with oneDNN";
+  }
+  // A 1x1 convolution over a single channel is as cheap as the Transpose
+  // nodes around it.
+  Scope scope = Scope::NewRootScope().WithDevice("/CPU:0");
+  Tensor input_data(DT_FLOAT, TensorShape({1, 1, 256, 256}));
+  test::FillIota<float>(&input_data, 1.0f);
+  Output input = ops::Const(scope.WithOpName("Input"),
+                            Input::Initializer(input_data));
+  Tensor filter_data(DT_FLOAT, TensorShape({1, 1, 1, 1}));
+  test::FillIota<float>(&filter_data, 1.0f);
+  Output filter = ops::Const(scope.WithOpName("Filter"),
+                             Input::Initializer(filter_data));
+  Output conv = ops::Conv2D(scope.WithOpName("Conv2D"), input, filter,
+                            {1, 1, 1, 1}, "VALID",
+                            ops::Conv2D::Attrs().DataFormat("NCHW"));
+  Output fetch = ops::Identity(scope.WithOpName("Fetch"), {conv});
+  GrapplerItem item;
+  TF_ASSERT_OK(scope.ToGraphDef(&item.graph));
+  item.fetch = {"Fetch"};
+
+  GenericLayoutOptimizer optimizer(RewriterConfig::DEFAULT,
+                                   RewriterConfig::NCHW_TO_NHWC_IF_PROFITABLE);
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(virtual_cluster_.get(), item, &output));
+
+  Status status;
+  utils::GraphView graph_view(&output, &status);
+  TF_ASSERT_OK(status);
+  EXPECT_EQ(graph_view.NumNodes(), item.graph.node_size());
+  auto* conv_node = graph_view.GetNode("Conv2D");
+  ASSERT_NE(conv_node, nullptr);
+  VerifyDataFormatAttributeMatch(conv_node, "NCHW");
+}
+
 // TODO(yanzha): Add more complex Graph for test.
 
 }  // namespace grappler
@@ -22,13 +22,19 @@ limitations under the License.
 #include <unordered_set>
 #include <vector>
 
+#include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_split.h"
 #include "absl/strings/string_view.h"
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/attr_value.pb.h"
 #include "tensorflow/core/framework/full_type.pb.h"
+#include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/node_def_util.h"
 #include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/framework/types.h"
@@ -39,6 +45,7 @@ limitations under the License.
 #include "tensorflow/core/grappler/optimizers/constant_folding.h"
 #include "tensorflow/core/grappler/optimizers/evaluation_utils.h"
 #include "tensorflow/core/grappler/utils/frame.h"
+#include "tensorflow/core/grappler/utils/functions.h"
 #include "tensorflow/core/grappler/utils/traversal.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/stringpiece.h"
@@ -547,6 +554,337 @@ Status RemoveStackOps(const std::unordered_set<string>& nodes_to_preserve,
   return absl::OkStatus();
 }
 
+// Checks if a node of a While body function can be computed once before the
+// loop if all its inputs are loop invariant.
+bool CanHoistOutOfWhileBody(const NodeDef& node) {
+  const OpDef* op_def = nullptr;
+  // Function calls are not hoisted.
+  if (!OpRegistry::Global()->LookUpOpDef(node.op(), &op_def).ok()) {
+    return false;
+  }
+  if (op_def->is_stateful() || IsPlaceholder(node)) return false;
+  for (const auto& attr : node.attr()) {
+    if (attr.second.has_func() || attr.second.list().func_size() > 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Checks if hoisting a node saves work in every iteration.
+bool IsWorthHoistingOutOfWhileBody(const NodeDef& node) {
+  return !IsConstant(node) && !IsIdentity(node) && !IsIdentityN(node) &&
+         !IsSnapshot(node);
+}
+
+// Converts `body_input`, the FunctionDef "node:output:index" input of a body
+// node, to the GraphDef tensor name of the hoisted copy of the node.
+Status HoistedTensorName(
+    const string& body_input,
+    const absl::flat_hash_map<string, const NodeDef*>& body_nodes,
+    const absl::flat_hash_map<string, string>& hoisted_names,
+    string* tensor_name, DataType* dtype) {
+  const std::vector<string> parts = absl::StrSplit(body_input, ':');
+  int index;
+  if (parts.size() != 3 || !absl::SimpleAtoi(parts[2], &index)) {
+    return errors::InvalidArgument("Unexpected body input ", body_input);
+  }
+  const NodeDef* node = body_nodes.at(parts[0]);
+  const OpDef* op_def = nullptr;
+  TF_RETURN_IF_ERROR(OpRegistry::Global()->LookUpOpDef(node->op(), &op_def));
+  NameRangeMap outputs;
+  TF_RETURN_IF_ERROR(NameRangesForNode(*node, *op_def, nullptr, &outputs));
+  auto range = outputs.find(parts[1]);
+  if (range == outputs.end()) {
+    return errors::InvalidArgument("Unexpected body input ", body_input);
+  }
+  const int port = range->second.first + index;
+  const string& hoisted_name = hoisted_names.at(parts[0]);
+  *tensor_name = port == 0 ? hoisted_name : StrCat(hoisted_name, ":", port);
+  return OutputTypeForNode(*node, *op_def, port, dtype);
+}
+
+// Returns a name starting with `prefix` that is not in `names`, and adds it.
+string UniqueName(const string& prefix,
+                  absl::flat_hash_set<string>* names) {
+  string name = prefix;
+  for (int i = 1; !names->insert(name).second; ++i) {
+    name = StrCat(prefix, "_", i);
+  }
+  return name;
+}
+
+// Hoists the nodes of the body of the functional While node `while_node` that
+// only depend on loop invariant arguments (arguments that the body returns
+// unchanged) and constants. The hoisted nodes are computed once before the
+// loop, and their outputs used in the body are passed as new loop invariant
+// arguments to copies of the body and cond functions, so that other While
+// nodes calling the original functions are not affected.
+Status HoistWhileLoopInvariants(NodeDef* while_node,
+                                FunctionLibraryDefinition* flib,
+                                absl::flat_hash_set<string>* graph_node_names,
+                                GraphDef* optimized_graph) {
+  NameAttrList body_attr, cond_attr;
+  TF_RETURN_IF_ERROR(GetNodeAttr(*while_node, "body", &body_attr));
+  TF_RETURN_IF_ERROR(GetNodeAttr(*while_node, "cond", &cond_attr));
+  const FunctionDef* body = flib->Find(body_attr.name());
+  const FunctionDef* cond = flib->Find(cond_attr.name());
+  if (body == nullptr || cond == nullptr || IsParametrized(*body) ||
+      IsParametrized(*cond)) {
+    return absl::OkStatus();
+  }
+  const OpDef& signature = body->signature();
+  std::vector<string> while_inputs;
+  for (const string& input : while_node->input()) {
+    if (IsControlInput(input)) break;
+    while_inputs.push_back(input);
+  }
+  const int num_inputs = while_inputs.size();
+  if (signature.input_arg_size() != num_inputs ||
+      signature.output_arg_size() != num_inputs ||
+      cond->signature().input_arg_size() != num_inputs) {
+    return absl::OkStatus();
+  }
+
+  // Map from the body arguments that are returned unchanged to the
+  // corresponding While input.
+  absl::flat_hash_map<string, string> invariant_args;
+  for (int i = 0; i < signature.input_arg_size(); ++i) {
+    auto ret = body->ret().find(signature.output_arg(i).name());
+    if (ret != body->ret().end() &&
+        ret->second == signature.input_arg(i).name()) {
+      invariant_args.emplace(signature.input_arg(i).name(), while_inputs[i]);
+    }
+  }
+  if (invariant_args.empty()) return absl::OkStatus();
+
+  // Nodes with control outputs stay in the body.
+  absl::flat_hash_map<string, const NodeDef*> body_nodes;
+  absl::flat_hash_set<string> control_sources;
+  for (const NodeDef& node : body->node_def()) {
+    body_nodes.emplace(node.name(), &node);
+    for (const string& input : node.input()) {
+      if (IsControlInput(input)) control_sources.insert(NodeName(input));
+    }
+  }
+  for (const auto& control_ret : body->control_ret()) {
+    control_sources.insert(control_ret.second);
+  }
+
+  // Find the loop invariant nodes in topological order. The nodes of a
+  // FunctionDef are not sorted, so iterate until no more nodes are found.
+  absl::flat_hash_set<string> invariant_nodes;
+  std::vector<const NodeDef*> sorted_invariant_nodes;
+  const auto input_node = [](const string& input) {
+    return input.substr(0, input.find(':'));
+  };
+  for (bool found = true; found;) {
+    found = false;
+    for (const NodeDef& node : body->node_def()) {
+      if (invariant_nodes.contains(node.name()) ||
+          control_sources.contains(node.name()) ||
+          !CanHoistOutOfWhileBody(node)) {
+        continue;
+      }
+      const bool is_invariant =
+          absl::c_all_of(node.input(), [&](const string& input) {
+            return !IsControlInput(input) &&
+                   (invariant_args.contains(input) ||
+                    invariant_nodes.contains(input_node(input)));
+          });
+      if (is_invariant) {
+        invariant_nodes.insert(node.name());
+        sorted_invariant_nodes.push_back(&node);
+        found = true;
+      }
+    }
+  }
+
+  // Outputs of the hoisted nodes used by the nodes left in the body, or
+  // returned. Constants are copied rather than hoisted.
+  const auto is_hoisted = [&](const string& input) {
+    if (IsControlInput(input) || invariant_args.contains(input)) return false;
+    const string node = input_node(input);
+    return invariant_nodes.contains(node) && !IsConstant(*body_nodes.at(node));
+  };
+  std::vector<string> hoisted_outputs;
+  absl::flat_hash_set<string> seen_outputs;
+  const auto add_hoisted_output = [&](const string& input) {
+    if (is_hoisted(input) && seen_outputs.insert(input).second) {
+      hoisted_outputs.push_back(input);
+    }
+  };
+  for (const NodeDef& node : body->node_def()) {
+    if (invariant_nodes.contains(node.name())) continue;
+    for (const string& input : node.input()) add_hoisted_output(input);
+  }
+  for (const auto& ret : body->ret()) add_hoisted_output(ret.second);
+  if (hoisted_outputs.empty()) return absl::OkStatus();
+
+  // Only copy the invariant nodes needed to compute the hoisted outputs.
+  absl::flat_hash_set<string> needed_nodes;
+  std::vector<string> stack;
+  for (const string& output : hoisted_outputs) {
+    stack.push_back(input_node(output));
+  }
+  while (!stack.empty()) {
+    const string name = stack.back();
+    stack.pop_back();
+    if (!needed_nodes.insert(name).second) continue;
+    for (const string& input : body_nodes.at(name)->input()) {
+      if (!invariant_args.contains(input)) stack.push_back(input_node(input));
+    }
+  }
+  const bool worth_hoisting =
+      absl::c_any_of(needed_nodes, [&](const string& name) {
+        return IsWorthHoistingOutOfWhileBody(*body_nodes.at(name));
+      });
+  if (!worth_hoisting) return absl::OkStatus();
+
+  // Copy the needed nodes before the loop.
+  absl::flat_hash_map<string, string> hoisted_names;
+  std::vector<NodeDef> hoisted_nodes;
+  for (const NodeDef* node : sorted_invariant_nodes) {
+    if (!needed_nodes.contains(node->name())) continue;
+    NodeDef hoisted = *node;
+    hoisted.set_name(UniqueName(
+        AddPrefixToNodeName(node->name(),
+                            StrCat(while_node->name(), "/LoopInvariant")),
+        graph_node_names));
+    if (hoisted.device().empty()) hoisted.set_device(while_node->device());
+    for (int i = 0; i < hoisted.input_size(); ++i) {
+      auto arg = invariant_args.find(hoisted.input(i));
+      if (arg != invariant_args.end()) {
+        hoisted.set_input(i, arg->second);
+        continue;
+      }
+      string tensor_name;
+      DataType dtype;
+      TF_RETURN_IF_ERROR(HoistedTensorName(hoisted.input(i), body_nodes,
+                                           hoisted_names, &tensor_name,
+                                           &dtype));
+      hoisted.set_input(i, tensor_name);
+    }
+    hoisted_names.emplace(node->name(), hoisted.name());
+    hoisted_nodes.push_back(std::move(hoisted));
+  }
+
+  // Pass the hoisted outputs to copies of the body and cond functions as new
+  // loop invariant arguments.
+  FunctionDef new_body = *body;
+  FunctionDef new_cond = *cond;
+  new_body.mutable_signature()->set_name(
+      flib->UniqueFunctionName(StrCat(body_attr.name(), "_loop_invariant_")));
+  new_cond.mutable_signature()->set_name(
+      flib->UniqueFunctionName(StrCat(cond_attr.name(), "_loop_invariant_")));
+  absl::flat_hash_set<string> arg_names;
+  for (const FunctionDef* func : {body, cond}) {
+    for (const auto& arg : func->signature().input_arg()) {
+      arg_names.insert(arg.name());
+    }
+    for (const auto& arg : func->signature().output_arg()) {
+      arg_names.insert(arg.name());
+    }
+    for (const NodeDef& node : func->node_def()) arg_names.insert(node.name());
+  }
+
+  absl::flat_hash_map<string, string> hoisted_args;
+  std::vector<string> new_while_inputs;
+  std::vector<DataType> new_types;
+  for (const string& output : hoisted_outputs) {
+    string tensor_name;
+    DataType dtype;
+    TF_RETURN_IF_ERROR(HoistedTensorName(output, body_nodes, hoisted_names,
+                                         &tensor_name, &dtype));
+    const string arg_name = UniqueName("loop_invariant", &arg_names);
+    const string output_name = UniqueName(StrCat(arg_name, "_out"), &arg_names);
+    for (FunctionDef* func : {&new_body, &new_cond}) {
+      OpDef::ArgDef* arg = func->mutable_signature()->add_input_arg();
+      arg->set_name(arg_name);
+      arg->set_type(dtype);
+    }
+    OpDef::ArgDef* output_arg = new_body.mutable_signature()->add_output_arg();
+    output_arg->set_name(output_name);
+    output_arg->set_type(dtype);
+    (*new_body.mutable_ret())[output_name] = arg_name;
+    hoisted_args.emplace(output, arg_name);
+    new_while_inputs.push_back(tensor_name);
+    new_types.push_back(dtype);
+  }
+
+  // Remove the hoisted nodes from the body, and use the new arguments instead
+  // of their outputs.
+  new_body.clear_node_def();
+  for (const NodeDef& node : body->node_def()) {
+    if (invariant_nodes.contains(node.name()) && !IsConstant(node)) continue;
+    NodeDef* new_node = new_body.add_node_def();
+    *new_node = node;
+    for (int i = 0; i < new_node->input_size(); ++i) {
+      auto arg = hoisted_args.find(new_node->input(i));
+      if (arg != hoisted_args.end()) new_node->set_input(i, arg->second);
+    }
+  }
+  for (auto& ret : *new_body.mutable_ret()) {
+    auto arg = hoisted_args.find(ret.second);
+    if (arg != hoisted_args.end()) ret.second = arg->second;
+  }
+
+  VLOG(2) << "Hoist " << hoisted_nodes.size() << " loop invariant nodes out of "
+          << while_node->name() << " into " << new_while_inputs.size()
+          << " new loop variables";
+  TF_RETURN_IF_ERROR(flib->AddFunctionDef(new_body));
+  TF_RETURN_IF_ERROR(flib->AddFunctionDef(new_cond));
+  *optimized_graph->mutable_library()->add_function() = new_body;
+  *optimized_graph->mutable_library()->add_function() = new_cond;
+
+  // Update the While node. The new inputs go after the existing data inputs,
+  // so the existing outputs keep their indices.
+  std::vector<string> control_inputs(while_node->input().begin() + num_inputs,
+                                     while_node->input().end());
+  while_node->mutable_input()->DeleteSubrange(
+      num_inputs, while_node->input_size() - num_inputs);
+  for (const string& input : new_while_inputs) while_node->add_input(input);
+  for (const string& input : control_inputs) while_node->add_input(input);
+  auto* attrs = while_node->mutable_attr();
+  for (DataType dtype : new_types) {
+    (*attrs)["T"].mutable_list()->add_type(dtype);
+  }
+  for (const char* shapes_attr : {"output_shapes", "_output_shapes"}) {
+    auto it = attrs->find(shapes_attr);
+    if (it == attrs->end() || it->second.list().shape_size() != num_inputs) {
+      continue;
+    }
+    for (int i = 0; i < static_cast<int>(new_types.size()); ++i) {
+      it->second.mutable_list()->add_shape()->set_unknown_rank(true);
+    }
+  }
+  (*attrs)["body"].mutable_func()->set_name(new_body.signature().name());
+  (*attrs)["cond"].mutable_func()->set_name(new_cond.signature().name());
+
+  for (NodeDef& hoisted : hoisted_nodes) {
+    *optimized_graph->add_node() = std::move(hoisted);
+  }
+  return absl::OkStatus();
+}
+
+Status HoistFunctionalWhileLoopInvariants(GraphDef* optimized_graph) {
+  FunctionLibraryDefinition flib(OpRegistry::Global(),
+                                 optimized_graph->library());
+  absl::flat_hash_set<string> graph_node_names;
+  for (const NodeDef& node : optimized_graph->node()) {
+    graph_node_names.insert(node.name());
+  }
+  // Hoisting appends nodes to the graph, but never While nodes.
+  const int num_nodes = optimized_graph->node_size();
+  for (int i = 0; i < num_nodes; ++i) {
+    NodeDef* node = optimized_graph->mutable_node(i);
+    if (!IsWhile(*node)) continue;
+    TF_RETURN_IF_ERROR(HoistWhileLoopInvariants(node, &flib, &graph_node_names,
+                                                optimized_graph));
+  }
+  return absl::OkStatus();
+}
+
 bool IsSimpleBinaryOperator(const NodeDef& node) {
   return (IsLess(node) || IsLessEqual(node) || IsGreater(node) ||
           IsGreaterEqual(node) || IsEqual(node));
@@ -726,13 +1064,14 @@ LoopOptimizer::LoopOptimizer(RewriterConfig::Toggle opt_level,
                              DeviceBase* cpu_device)
     : opt_level_(opt_level),
       cpu_device_(cpu_device),
-      options_(LoopOptimizerOptions::Default(RewriterConfig::ON)) {
+      options_(LoopOptimizerOptions::Default(opt_level)) {
   resource_mgr_.reset(new ResourceMgr());
 }
 
 Status LoopOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
                                GraphDef* optimized_graph) {
   if (!options_.enable_loop_invariant_node_motion &&
+      !options_.enable_functional_while_invariant_node_motion &&
       !options_.enable_stack_push_removal &&
       !options_.enable_dead_branch_removal) {
     return errors::Aborted("Nothing to do.");
@@ -743,6 +1082,9 @@ Status LoopOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
     LoopInvariantNodeMotionOptimizer linm_optimizer(optimized_graph);
     TF_RETURN_IF_ERROR(linm_optimizer.Optimize());
   }
+  if (options_.enable_functional_while_invariant_node_motion) {
+    TF_RETURN_IF_ERROR(HoistFunctionalWhileLoopInvariants(optimized_graph));
+  }
   if (options_.enable_stack_push_removal) {
     TF_RETURN_IF_ERROR(RemoveStackOps(item.NodesToPreserve(), optimized_graph));
   }
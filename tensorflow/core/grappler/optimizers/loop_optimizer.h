@@ -40,7 +40,9 @@ class LoopOptimizer : public GraphOptimizer {
 
   string name() const override { return "loop_optimizer"; };
 
-  bool UsesFunctionLibrary() const override { return false; }
+  bool UsesFunctionLibrary() const override {
+    return options_.enable_functional_while_invariant_node_motion;
+  }
 
   Status Optimize(Cluster* cluster, const GrapplerItem& item,
                   GraphDef* optimized_graph) override;
@@ -51,11 +53,17 @@ class LoopOptimizer : public GraphOptimizer {
   // Granular control for loop optimizer stages.
   struct LoopOptimizerOptions {
     bool enable_loop_invariant_node_motion = false;
+    // Hoists loop invariant nodes out of the body functions of functional
+    // While nodes. Like any loop invariant code motion, it computes the
+    // hoisted nodes even if the loop runs zero iterations.
+    bool enable_functional_while_invariant_node_motion = false;
     bool enable_stack_push_removal = true;
     bool enable_dead_branch_removal = true;
 
     static LoopOptimizerOptions Default(RewriterConfig::Toggle opt_level) {
       LoopOptimizerOptions options;
+      options.enable_functional_while_invariant_node_motion =
+          opt_level == RewriterConfig::AGGRESSIVE;
       return options;
     }
   };
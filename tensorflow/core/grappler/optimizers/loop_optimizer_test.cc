@@ -17,6 +17,8 @@ limitations under the License.
 
 #include "tensorflow/cc/ops/standard_ops.h"
 #include "tensorflow/core/framework/full_type.pb.h"
+#include "tensorflow/core/framework/function.h"
+#include "tensorflow/core/framework/function_testlib.h"
 #include "tensorflow/core/framework/node_def.pb.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/grappler/grappler_item.h"
@@ -66,6 +68,11 @@ class LoopOptimizerTest : public GrapplerTest {
     optimizer->options_.enable_loop_invariant_node_motion = true;
   }
 
+  void EnableOnlyFunctionalWhileInvariantNodeMotion(LoopOptimizer* optimizer) {
+    DisableAllStages(optimizer);
+    optimizer->options_.enable_functional_while_invariant_node_motion = true;
+  }
+
   void EnableOnlyStackPushRemoval(LoopOptimizer* optimizer) {
     DisableAllStages(optimizer);
     optimizer->options_.enable_stack_push_removal = true;
@@ -75,6 +82,7 @@ class LoopOptimizerTest : public GrapplerTest {
   void DisableAllStages(LoopOptimizer* optimizer) {
     LoopOptimizer::LoopOptimizerOptions options;
     options.enable_loop_invariant_node_motion = false;
+    options.enable_functional_while_invariant_node_motion = false;
     options.enable_stack_push_removal = false;
     optimizer->options_ = options;
   }
@@ -750,6 +758,87 @@ TEST_F(LoopOptimizerTest, RemovePushWithoutMatchingPop) {
   }
 }
 
+TEST_F(LoopOptimizerTest, FunctionalWhileInvariantNodeMotion) {
+  using test::function::NDef;
+  using FDH = FunctionDefHelper;
+
+  // for (i = 0; i < 10; ++i) x += w * w
+  FunctionDef body = FDH::Create(
+      "LoopBody", {"i:int32", "x:float", "w:float"},
+      {"i_out:int32", "x_out:float", "w_out:float"}, {},
+      {FDH::Const("one", 1),
+       {{"next_i"}, "Add", {"i", "one:output:0"}, {{"T", DT_INT32}}},
+       {{"w2"}, "Mul", {"w", "w"}, {{"T", DT_FLOAT}}},
+       {{"next_x"}, "Add", {"x", "w2:z:0"}, {{"T", DT_FLOAT}}}},
+      {{"i_out", "next_i:z:0"}, {"x_out", "next_x:z:0"}, {"w_out", "w"}});
+  FunctionDef cond = FDH::Create(
+      "LoopCond", {"i:int32", "x:float", "w:float"}, {"z:bool"}, {},
+      {FDH::Const("ten", 10),
+       {{"less"}, "Less", {"i", "ten:output:0"}, {{"T", DT_INT32}}}},
+      {{"z", "less:z:0"}});
+
+  GrapplerItem item;
+  item.fetch = {"x_out"};
+  item.graph = test::function::GDef(
+      {NDef("i", "Const", {},
+            {{"dtype", DT_INT32}, {"value", test::AsScalar<int32>(0)}}),
+       NDef("x", "Const", {},
+            {{"dtype", DT_FLOAT}, {"value", test::AsScalar<float>(1.0)}}),
+       NDef("w", "Const", {},
+            {{"dtype", DT_FLOAT}, {"value", test::AsScalar<float>(3.0)}}),
+       NDef("while", "While", {"i", "x", "w"},
+            {{"T", DataTypeSlice{DT_INT32, DT_FLOAT, DT_FLOAT}},
+             {"body", FDH::FunctionRef("LoopBody")},
+             {"cond", FDH::FunctionRef("LoopCond")}}),
+       NDef("x_out", "Identity", {"while:1"}, {{"T", DT_FLOAT}})},
+      {body, cond});
+
+  LoopOptimizer optimizer;
+  EnableOnlyFunctionalWhileInvariantNodeMotion(&optimizer);
+  EXPECT_TRUE(optimizer.UsesFunctionLibrary());
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  // w * w is computed once before the loop, and passed to the body as a new
+  // loop invariant.
+  NodeMap node_map(&output);
+  const NodeDef* hoisted = node_map.GetNode("while/LoopInvariant/w2");
+  ASSERT_NE(hoisted, nullptr);
+  EXPECT_EQ(hoisted->op(), "Mul");
+  EXPECT_EQ(hoisted->input(0), "w");
+  EXPECT_EQ(hoisted->input(1), "w");
+
+  const NodeDef* while_node = node_map.GetNode("while");
+  ASSERT_EQ(while_node->input_size(), 4);
+  EXPECT_EQ(while_node->input(3), "while/LoopInvariant/w2");
+  EXPECT_EQ(while_node->attr().at("T").list().type_size(), 4);
+
+  FunctionLibraryDefinition flib(OpRegistry::Global(), output.library());
+  const FunctionDef* new_body =
+      flib.Find(while_node->attr().at("body").func().name());
+  const FunctionDef* new_cond =
+      flib.Find(while_node->attr().at("cond").func().name());
+  ASSERT_NE(new_body, nullptr);
+  ASSERT_NE(new_cond, nullptr);
+  EXPECT_NE(new_body->signature().name(), "LoopBody");
+  EXPECT_EQ(new_body->signature().input_arg_size(), 4);
+  EXPECT_EQ(new_body->signature().output_arg_size(), 4);
+  EXPECT_EQ(new_cond->signature().input_arg_size(), 4);
+  for (const NodeDef& node : new_body->node_def()) {
+    EXPECT_NE(node.op(), "Mul");
+  }
+  // The original functions are left unchanged.
+  EXPECT_EQ(flib.Find("LoopBody")->node_def_size(), 4);
+
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch);
+  auto tensors = EvaluateNodes(output, item.fetch);
+  ASSERT_EQ(tensors_expected.size(), 1);
+  ASSERT_EQ(tensors.size(), 1);
+  test::ExpectTensorEqual<float>(tensors_expected[0],
+                                 test::AsScalar<float>(91.0));
+  test::ExpectTensorEqual<float>(tensors[0], tensors_expected[0]);
+}
+
 TEST_F(LoopOptimizerTest, RemoveDeadBranchesConstantCondition) {
   Scope scope = Scope::NewRootScope();
   Output v_in = ops::Const<float>(scope.WithOpName("v_in"), {123.0}, {});
@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow/core/grappler/optimizers/memory_optimizer.h"
 
 #include <algorithm>
+#include <cstdint>
 #include <queue>
 #include <set>
 #include <unordered_map>
@@ -30,6 +31,8 @@ limitations under the License.
 #include "tensorflow/core/grappler/clusters/virtual_cluster.h"
 #include "tensorflow/core/grappler/costs/graph_memory.h"
 #include "tensorflow/core/grappler/costs/graph_properties.h"
+#include "tensorflow/core/grappler/costs/op_context.h"
+#include "tensorflow/core/grappler/costs/op_level_cost_estimator.h"
 #include "tensorflow/core/grappler/costs/utils.h"
 #include "tensorflow/core/grappler/graph_topology_view.h"
 #include "tensorflow/core/grappler/grappler_item.h"
@@ -440,6 +443,18 @@ void RecomputeSubgraph(
   }
 }
 
+// Nodes whose inputs we may want to recompute. This matches node names that
+// contain recomputation_targets_name_scope as a name scope, meaning it either
+// begins with or contains the name scope. Defaults to "gradients/" which will
+// match any node names that begins with "gradients/" or contains
+// "/gradients/".
+bool IsRecomputationTarget(const NodeDef& node,
+                           const string& recomputation_targets_name_scope) {
+  return absl::StartsWith(node.name(), recomputation_targets_name_scope) ||
+         static_cast<int>(
+             node.name().find("/" + recomputation_targets_name_scope)) != -1;
+}
+
 void RecomputationRewritingPass(RewriterConfig::MemOptType optimization_level,
                                 const string& recomputation_targets_name_scope,
                                 GraphDef* graph, const GrapplerItem& item) {
@@ -461,15 +476,7 @@ void RecomputationRewritingPass(RewriterConfig::MemOptType optimization_level,
   }
   std::function<bool(const NodeDef&)> is_target =
       [&recomputation_targets_name_scope](const NodeDef& node) {
-        // Nodes whose inputs we may want to recompute. This matches node names
-        // that contain recomputation_targets_name_scope as a name scope,
-        // meaning it either begins with or contains the name scope.
-        // Defaults to "gradients/" which will match any node names that begins
-        // with "gradients/" or contains "/gradients/".
-        return absl::StartsWith(node.name(),
-                                recomputation_targets_name_scope) ||
-               static_cast<int>(node.name().find(
-                   "/" + recomputation_targets_name_scope)) != -1;
+        return IsRecomputationTarget(node, recomputation_targets_name_scope);
       };
 
   if (optimization_level == RewriterConfig::RECOMPUTATION_HEURISTICS ||
@@ -512,6 +519,161 @@ void RecomputationRewritingPass(RewriterConfig::MemOptType optimization_level,
   }
 }
 
+// Estimates the time it takes to recompute `nodes`, in nanoseconds.
+int64_t EstimateRecomputationTime(
+    const std::unordered_set<const NodeDef*>& nodes,
+    const GraphProperties& properties) {
+  static const OpLevelCostEstimator* estimator = new OpLevelCostEstimator();
+  int64_t time_ns = 0;
+  for (const NodeDef* node : nodes) {
+    OpContext op_context;
+    op_context.name = node->name();
+    op_context.device_name = node->device();
+    OpInfo& op_info = op_context.op_info;
+    op_info.set_op(node->op());
+    *op_info.mutable_attr() = node->attr();
+    for (const auto& input : properties.GetInputProperties(node->name())) {
+      *op_info.add_inputs() = input;
+    }
+    for (const auto& output : properties.GetOutputProperties(node->name())) {
+      *op_info.add_outputs() = output;
+    }
+    *op_info.mutable_device() = GetDeviceInfo(node->device());
+    time_ns += estimator->PredictCosts(op_context).execution_time.count();
+  }
+  // Count at least a nanosecond per node, so that subgraphs of ops without a
+  // cost model are still ranked by their size.
+  return std::max<int64_t>(time_ns, nodes.size());
+}
+
+// Recomputes just enough of the candidate subgraphs to bring the peak memory
+// usage of every device, as simulated by GraphMemory, under `budget_bytes`.
+// Each round picks the subgraphs whose outputs are live at the peak greedily,
+// in decreasing order of the bytes they free per nanosecond of recomputation,
+// until the savings cover the excess. The memory usage is then simulated
+// again, since recomputing changes the schedule and hence the peak.
+bool BudgetedRecomputationPass(Cluster* cluster, int64_t budget_bytes,
+                               const string& recomputation_targets_name_scope,
+                               GrapplerItem* item) {
+  std::unordered_set<string> feeds;
+  for (const auto& feed : item->feed) {
+    feeds.insert(NodeName(feed.first));
+  }
+  std::function<bool(const NodeDef&)> is_target =
+      [&recomputation_targets_name_scope](const NodeDef& node) {
+        return IsRecomputationTarget(node, recomputation_targets_name_scope);
+      };
+  const std::unordered_set<string> cheap_to_recompute_ops =
+      GetCheapToRecomputeOps();
+  const string recomputed_node_scope =
+      strings::StrCat(kRecomputedNodePrefix, "/");
+  std::function<bool(const NodeDef&)> should_recompute =
+      [&](const NodeDef& node) {
+        return !is_target(node) && feeds.count(node.name()) == 0 &&
+               !absl::StartsWith(node.name(), recomputed_node_scope) &&
+               (cheap_to_recompute_ops.count(node.op()) > 0 ||
+                node.attr().count(kRecomputeHint) > 0);
+      };
+
+  bool updated_graph = false;
+  // Bound the number of rounds, since the simulated peak may not go under the
+  // budget no matter what is recomputed.
+  for (int round = 0; round < 10; ++round) {
+    GraphMemory memory(*item);
+    Status s = memory.InferStatically(cluster->GetDevices());
+    if (!s.ok()) {
+      VLOG(1) << "Failed to infer memory usage: " << s.message();
+      break;
+    }
+    // The bytes that each node keeps live at the peak of the devices that are
+    // over budget.
+    std::unordered_map<string, int64_t> live_bytes;
+    int64_t required_savings = 0;
+    for (const auto& device : cluster->GetDevices()) {
+      const GraphMemory::MemoryUsage& usage =
+          memory.GetPeakMemoryUsage(device.first);
+      if (usage.used_memory <= budget_bytes) {
+        continue;
+      }
+      VLOG(1) << "Peak memory usage of " << usage.used_memory << " bytes on "
+              << device.first << " exceeds the budget of " << budget_bytes
+              << " bytes";
+      required_savings =
+          std::max(required_savings, usage.used_memory - budget_bytes);
+      for (const auto& live_tensor : usage.live_tensors) {
+        live_bytes[live_tensor.node] += live_tensor.memory_used;
+      }
+    }
+    if (required_savings <= 0) {
+      break;
+    }
+
+    if (!TopologicalSort(&item->graph).ok()) {
+      break;
+    }
+    NodeMap node_map(&item->graph);
+    std::vector<RecomputedSubGraph> candidates = GetOpGroupsToRecompute(
+        &item->graph, node_map, should_recompute, is_target);
+    GraphProperties properties(*item);
+    // The recomputation times are only used for ranking, so keep going with
+    // the default costs if the shapes can't be inferred.
+    properties
+        .InferStatically(/*assume_valid_feeds=*/true,
+                         /*aggressive_shape_inference=*/false,
+                         /*include_tensor_values=*/false)
+        .IgnoreError();
+
+    struct ScoredSubGraph {
+      const RecomputedSubGraph* subgraph;
+      int64_t saved_bytes;
+      double bytes_per_ns;
+    };
+    std::vector<ScoredSubGraph> scored;
+    for (const RecomputedSubGraph& candidate : candidates) {
+      int64_t saved_bytes = 0;
+      for (const NodeDef* node : candidate.recomputed_source_nodes) {
+        auto it = live_bytes.find(node->name());
+        if (it != live_bytes.end()) {
+          saved_bytes += it->second;
+        }
+      }
+      if (saved_bytes == 0) {
+        continue;
+      }
+      const int64_t time_ns = EstimateRecomputationTime(
+          candidate.recomputed_source_nodes, properties);
+      scored.push_back({&candidate, saved_bytes,
+                        static_cast<double>(saved_bytes) / time_ns});
+    }
+    if (scored.empty()) {
+      VLOG(1) << "No recomputation reduces the peak memory usage";
+      break;
+    }
+    std::sort(scored.begin(), scored.end(),
+              [](const ScoredSubGraph& a, const ScoredSubGraph& b) {
+                return a.bytes_per_ns > b.bytes_per_ns;
+              });
+
+    std::unordered_map<const NodeDef*, int> topological_numbering;
+    for (int node_number = 0; node_number < item->graph.node().size();
+         ++node_number) {
+      topological_numbering[item->graph.mutable_node(node_number)] =
+          item->graph.node().size() - node_number - 1;
+    }
+    for (const ScoredSubGraph& candidate : scored) {
+      RecomputeSubgraph(candidate.subgraph->recomputed_source_nodes,
+                        candidate.subgraph->target_nodes, node_map,
+                        topological_numbering, &item->graph);
+      updated_graph = true;
+      required_savings -= candidate.saved_bytes;
+      if (required_savings <= 0) {
+        break;
+      }
+    }
+  }
+  return updated_graph;
+}
+
 bool SchedulingPass(Cluster* cluster, std::unique_ptr<GraphMemory>* memory_ptr,
                     GrapplerItem* item) {
   // Look for AddN nodes (and equivalent) and record input names.
@@ -1270,6 +1432,110 @@ bool SwappingPass(RewriterConfig::MemOptType optimization_level,
   return updated_graph;
 }
 
+// Attribute which may be added to ResourceApply* nodes to manually place them,
+// and the variables they update, on the host.
+const char* kOffloadToHost = "_offload_to_host";
+
+bool IsResourceApply(const NodeDef& node) {
+  return absl::StartsWith(node.op(), "ResourceApply") ||
+         absl::StartsWith(node.op(), "ResourceSparseApply");
+}
+
+// Ops consuming resource variables which have a CPU kernel, and can thus follow
+// the variables to the host.
+bool CanFollowVariableToHost(const NodeDef& node) {
+  static const auto* const ops = new std::unordered_set<string>{
+      "AssignAddVariableOp", "AssignSubVariableOp", "AssignVariableOp",
+      "DestroyResourceOp",   "ReadVariableOp",      "ResourceGather",
+      "VarIsInitializedOp",  "VariableShape"};
+  return ops->count(node.op()) > 0 || IsResourceApply(node);
+}
+
+// Returns in `host_device` the CPU of the task of `device`, if `device` is a
+// GPU.
+bool GetHostOfGpu(const string& device, string* host_device) {
+  DeviceNameUtils::ParsedName parsed_name;
+  if (!DeviceNameUtils::ParseFullName(device, &parsed_name) ||
+      parsed_name.type != DEVICE_GPU) {
+    return false;
+  }
+  parsed_name.type = DEVICE_CPU;
+  parsed_name.has_id = true;
+  parsed_name.id = 0;
+  *host_device = DeviceNameUtils::ParsedNameToString(parsed_name);
+  return true;
+}
+
+// Moves the optimizer ops on GPU to the host, together with the resource
+// variables they update (e.g. the parameter and the two slots of
+// ResourceApplyAdam) and all the other ops reading or writing these variables.
+// The gradients are then copied to the host, and the parameters back to the
+// GPU, by the regular send/recv pairs. Only the ops annotated with
+// kOffloadToHost are considered unless `offload_all` is true.
+bool OptimizerStateOffloadingPass(bool offload_all, GraphDef* graph) {
+  MutableGraphView view(graph);
+  bool updated_graph = false;
+  for (NodeDef& node : *graph->mutable_node()) {
+    if (!IsResourceApply(node) ||
+        (!offload_all && node.attr().count(kOffloadToHost) == 0)) {
+      continue;
+    }
+    string host_device;
+    if (!GetHostOfGpu(node.device(), &host_device)) {
+      continue;
+    }
+    const OpDef* op_def;
+    if (!OpRegistry::Global()->LookUpOpDef(node.op(), &op_def).ok()) {
+      continue;
+    }
+    // The variables updated by the node, which must be on its device.
+    std::vector<NodeDef*> variables;
+    bool can_offload = true;
+    for (int i = 0; i < node.input_size() && can_offload; ++i) {
+      if (IsControlInput(node.input(i))) {
+        break;
+      }
+      DataType input_type;
+      if (!InputTypeForNode(node, *op_def, i, &input_type).ok()) {
+        can_offload = false;
+        break;
+      }
+      if (input_type != DT_RESOURCE) {
+        continue;
+      }
+      NodeDef* variable = view.GetNode(NodeName(node.input(i)));
+      if (variable == nullptr || variable->op() != "VarHandleOp") {
+        can_offload = false;
+        break;
+      }
+      for (const auto& fanout :
+           view.GetFanouts(*variable, /*include_controlled_nodes=*/false)) {
+        if (!CanFollowVariableToHost(*fanout.node)) {
+          VLOG(2) << "Can't offload " << variable->name() << " used by "
+                  << fanout.node->name();
+          can_offload = false;
+          break;
+        }
+      }
+      variables.push_back(variable);
+    }
+    if (!can_offload || variables.empty()) {
+      continue;
+    }
+    VLOG(1) << "Offloading " << node.name() << " and the " << variables.size()
+            << " variables it updates to " << host_device;
+    for (NodeDef* variable : variables) {
+      for (const auto& fanout :
+           view.GetFanouts(*variable, /*include_controlled_nodes=*/false)) {
+        fanout.node->set_device(host_device);
+      }
+      variable->set_device(host_device);
+    }
+    updated_graph = true;
+  }
+  return updated_graph;
+}
+
 bool CrossesTaskOrCpuGpuBoundary(const NodeDef& node1, const NodeDef& node2) {
   string task1;
   string device1;
@@ -1380,21 +1646,45 @@ Status FindAssignNodesToRelax(const GraphDef& graph,
 
 Status MemoryOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
                                  GraphDef* optimized_graph) {
+  GrapplerItem optimized_item(item);
+  // Offloading only changes the placement of nodes, so it doesn't invalidate
+  // the node indices used below; it must run first since relaxing the
+  // allocator constraints depends on the placement.
+  const bool offloaded_optimizer_state = OptimizerStateOffloadingPass(
+      offload_optimizer_state_, &optimized_item.graph);
+
   std::set<int> nodes_to_relax;
-  TF_RETURN_IF_ERROR(FindAssignNodesToRelax(item.graph, &nodes_to_relax));
+  TF_RETURN_IF_ERROR(
+      FindAssignNodesToRelax(optimized_item.graph, &nodes_to_relax));
 
   bool run_recomputation_pass =
       (optimization_level_ == RewriterConfig::RECOMPUTATION_HEURISTICS ||
        optimization_level_ == RewriterConfig::HEURISTICS ||
        optimization_level_ == RewriterConfig::MANUAL);
-  if (!run_recomputation_pass && nodes_to_relax.empty() && item.fetch.empty()) {
+  if (!run_recomputation_pass && !offloaded_optimizer_state &&
+      nodes_to_relax.empty() && item.fetch.empty()) {
     return errors::Aborted("Nothing to do.");
   }
 
-  GrapplerItem optimized_item(item);
   RelaxAssignNodes(nodes_to_relax, &optimized_item.graph);
 
-  if (run_recomputation_pass) {
+  // With a memory budget, the recomputation heuristics only pick what is
+  // needed to fit in the budget, which requires simulating the memory usage.
+  const bool run_budgeted_recomputation_pass =
+      recomputation_budget_bytes_ > 0 &&
+      (optimization_level_ == RewriterConfig::RECOMPUTATION_HEURISTICS ||
+       optimization_level_ == RewriterConfig::HEURISTICS) &&
+      !item.fetch.empty() && cluster != nullptr;
+  if (run_budgeted_recomputation_pass) {
+    // Manual annotations are always respected.
+    RecomputationRewritingPass(RewriterConfig::MANUAL,
+                               recomputation_targets_name_scope_,
+                               &optimized_item.graph, item);
+    GRAPPLER_RETURN_IF_DEADLINE_EXCEEDED();
+    BudgetedRecomputationPass(cluster, recomputation_budget_bytes_,
+                              recomputation_targets_name_scope_,
+                              &optimized_item);
+  } else if (run_recomputation_pass) {
     RecomputationRewritingPass(optimization_level_,
                                recomputation_targets_name_scope_,
                                &optimized_item.graph, item);
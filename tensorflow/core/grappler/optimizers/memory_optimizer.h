@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_MEMORY_OPTIMIZER_H_
 #define TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_MEMORY_OPTIMIZER_H_
 
+#include <cstdint>
 #include <string>
 #include "tensorflow/core/grappler/clusters/cluster.h"
 #include "tensorflow/core/grappler/grappler_item.h"
@@ -33,11 +34,21 @@ class MemoryOptimizer : public GraphOptimizer {
   // recomputation_targets_name_scope: Name scope for potential outputs of
   //   recomputations. See
   //   RewriterConfig::memory_optimizer_target_node_name_scope.
+  // recomputation_budget_bytes: Per-device memory budget for the
+  //   recomputation heuristics. See
+  //   RewriterConfig::memory_optimizer_recomputation_budget_bytes.
+  // offload_optimizer_state: Whether to place all the variables updated by
+  //   optimizer ops on the host. See
+  //   RewriterConfig::memory_optimizer_offload_optimizer_state.
   explicit MemoryOptimizer(
       RewriterConfig::MemOptType optimization_level,
-      const string& recomputation_targets_name_scope = "gradients/")
+      const string& recomputation_targets_name_scope = "gradients/",
+      int64_t recomputation_budget_bytes = 0,
+      bool offload_optimizer_state = false)
       : optimization_level_(optimization_level),
-        recomputation_targets_name_scope_(recomputation_targets_name_scope) {}
+        recomputation_targets_name_scope_(recomputation_targets_name_scope),
+        recomputation_budget_bytes_(recomputation_budget_bytes),
+        offload_optimizer_state_(offload_optimizer_state) {}
   ~MemoryOptimizer() override {}
 
   string name() const override { return "memory_optimizer"; };
@@ -50,6 +61,8 @@ class MemoryOptimizer : public GraphOptimizer {
  private:
   RewriterConfig::MemOptType optimization_level_;
   string recomputation_targets_name_scope_;
+  int64_t recomputation_budget_bytes_;
+  bool offload_optimizer_state_;
 };
 
 }  // end namespace grappler
@@ -448,6 +448,89 @@ TEST_F(MemoryOptimizerTest, AccumulationRewrites) {
   }
 }
 
+TEST_F(MemoryOptimizerTest, RecomputationWithinBudget) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope().WithDevice("/cpu:0");
+  Output x = ops::Variable(s.WithOpName("x"), {128, 128}, DT_FLOAT);
+  Output a = ops::Relu(s.WithOpName("a"), x);  // Recomputed
+  Output b = ops::MatMul(s.WithOpName("b"), a, a);
+  Output c = ops::MatMul(s.WithOpName("c"), b, b);
+  Output grad_c = ops::AddN(s.WithOpName("gradients/c"), {c});
+  Output grad_b = ops::MatMul(s.WithOpName("gradients/b"), grad_c, b);
+  Output grad_a = ops::MatMul(s.WithOpName("gradients/a"), grad_b, a);
+
+  GrapplerItem item;
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+  item.fetch = {"gradients/a"};
+
+  std::unique_ptr<VirtualCluster> cluster(CreateVirtualCluster());
+
+  // The graph already fits in a large budget, so nothing is recomputed.
+  {
+    MemoryOptimizer optimizer(RewriterConfig::RECOMPUTATION_HEURISTICS,
+                              "gradients/",
+                              /*recomputation_budget_bytes=*/1 << 30);
+    GraphDef output;
+    TF_EXPECT_OK(optimizer.Optimize(cluster.get(), item, &output));
+    NodeMap node_map(&output);
+    EXPECT_EQ(node_map.GetNode("Recomputed/a"), nullptr);
+    EXPECT_EQ(node_map.GetNode("gradients/a")->input(1), "a");
+  }
+
+  // The activation is recomputed to try to fit in a small budget.
+  {
+    MemoryOptimizer optimizer(RewriterConfig::RECOMPUTATION_HEURISTICS,
+                              "gradients/",
+                              /*recomputation_budget_bytes=*/1);
+    GraphDef output;
+    TF_EXPECT_OK(optimizer.Optimize(cluster.get(), item, &output));
+    NodeMap node_map(&output);
+    ASSERT_NE(node_map.GetNode("Recomputed/a"), nullptr);
+    EXPECT_EQ(node_map.GetNode("Recomputed/a")->input(0), "x");
+    EXPECT_EQ(node_map.GetNode("gradients/a")->input(1), "Recomputed/a");
+    EXPECT_EQ(node_map.GetNode("b")->input(0), "a");
+  }
+}
+
+TEST_F(MemoryOptimizerTest, OffloadOptimizerState) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope().WithDevice("/gpu:0");
+  auto var = ops::VarHandleOp(s.WithOpName("var"), DT_FLOAT, {16, 16});
+  auto m = ops::VarHandleOp(s.WithOpName("m"), DT_FLOAT, {16, 16});
+  auto v = ops::VarHandleOp(s.WithOpName("v"), DT_FLOAT, {16, 16});
+  auto read = ops::ReadVariableOp(s.WithOpName("read"), var, DT_FLOAT);
+  auto grad = ops::Square(s.WithOpName("grad"), read);
+  auto scalar = ops::Const(s.WithOpName("scalar"), 0.1f);
+  auto apply = ops::ResourceApplyAdam(s.WithOpName("apply"), var, m, v, scalar,
+                                      scalar, scalar, scalar, scalar, scalar,
+                                      grad);
+
+  // The variable of this update escapes through an Identity, so it stays on
+  // the GPU.
+  auto other_var = ops::VarHandleOp(s.WithOpName("other_var"), DT_FLOAT, {16});
+  auto other_identity =
+      ops::Identity(s.WithOpName("other_identity"), other_var);
+  auto other_apply = ops::ResourceApplyGradientDescent(
+      s.WithOpName("other_apply"), other_var, scalar,
+      ops::Const(s.WithOpName("other_grad"), 1.0f, {16}));
+
+  GrapplerItem item;
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  MemoryOptimizer optimizer(RewriterConfig::MANUAL, "gradients/",
+                            /*recomputation_budget_bytes=*/0,
+                            /*offload_optimizer_state=*/true);
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  NodeMap node_map(&output);
+  for (const string& name : {"var", "m", "v", "read", "apply"}) {
+    EXPECT_EQ(node_map.GetNode(name)->device(), "/device:CPU:0") << name;
+  }
+  for (const string& name :
+       {"grad", "other_var", "other_identity", "other_apply"}) {
+    EXPECT_EQ(node_map.GetNode(name)->device(), "/gpu:0") << name;
+  }
+}
+
 class RelaxAllocatorConstraintsTest : public GrapplerTest {};
 
 TEST_F(RelaxAllocatorConstraintsTest, SameDevice) {
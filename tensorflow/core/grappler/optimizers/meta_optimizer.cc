@@ -16,10 +16,12 @@ limitations under the License.
 #include "tensorflow/core/grappler/optimizers/meta_optimizer.h"
 
 #include <algorithm>
+#include <cstdint>
 #include <functional>
 #include <string>
 #include <type_traits>
 #include <utility>
+#include <vector>
 
 #include "absl/status/status.h"
 #include "absl/strings/match.h"
@@ -49,6 +51,7 @@ limitations under the License.
 #include "tensorflow/core/grappler/optimizers/implementation_selector.h"
 #include "tensorflow/core/grappler/optimizers/loop_optimizer.h"
 #include "tensorflow/core/grappler/optimizers/memory_optimizer.h"
+#include "tensorflow/core/grappler/optimizers/meta_optimizer_cache.h"
 #include "tensorflow/core/grappler/optimizers/model_pruner.h"
 #include "tensorflow/core/grappler/optimizers/pin_to_host_optimizer.h"
 #include "tensorflow/core/grappler/optimizers/remapper.h"
@@ -62,7 +65,10 @@ limitations under the License.
 #include "tensorflow/core/grappler/verifiers/structure_verifier.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/gtl/map_util.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/threadpool.h"
 #include "tensorflow/core/util/dump_graph.h"
 #include "tensorflow/core/util/util.h"
 #include "tensorflow/core/util/xla_config_registry.h"
@@ -475,11 +481,16 @@ Status MetaOptimizer::InitializeOptimizers(
     if (cfg_.memory_optimizer_target_node_name_scope().empty()) {
       optimizers->push_back(
           // Use the default target node name prefix "gradients/"
-          std::make_unique<MemoryOptimizer>(cfg_.memory_optimization()));
+          std::make_unique<MemoryOptimizer>(
+              cfg_.memory_optimization(), "gradients/",
+              cfg_.memory_optimizer_recomputation_budget_bytes(),
+              cfg_.memory_optimizer_offload_optimizer_state()));
     } else {
       optimizers->push_back(std::make_unique<MemoryOptimizer>(
           cfg_.memory_optimization(),
-          cfg_.memory_optimizer_target_node_name_scope()));
+          cfg_.memory_optimizer_target_node_name_scope(),
+          cfg_.memory_optimizer_recomputation_budget_bytes(),
+          cfg_.memory_optimizer_offload_optimizer_state()));
     }
   }
   if (cfg_.auto_parallel().enable() && PLUGIN_IS_ON(auto_parallel)) {
@@ -888,7 +899,10 @@ Status MetaOptimizer::OptimizeGraph(
                                    }) != optimization_result.results.end();
 
   // Record graph optimization result.
-  optimization_results_.push_back(optimization_result);
+  {
+    mutex_lock l(optimization_results_mu_);
+    optimization_results_.push_back(optimization_result);
+  }
 
   if (is_optimized) {
     TF_RETURN_IF_ERROR(TopologicalSort(optimized_graph));
@@ -1169,7 +1183,8 @@ Status MetaOptimizer::OptimizeConsumeItem(Cluster* cluster, GrapplerItem&& item,
   while (optimize_function_library) {
     optimize_function_library = false;
 
-    int function_idx = 0;
+    // Functions to optimize in this pass over the library.
+    std::vector<const FunctionDef*> funcs;
     for (const FunctionDef& func : optimized_graph->library().function()) {
       GRAPPLER_RETURN_IF_DEADLINE_EXCEEDED();
 
@@ -1192,17 +1207,28 @@ Status MetaOptimizer::OptimizeConsumeItem(Cluster* cluster, GrapplerItem&& item,
       // and in function instantiation.
       if (data::IsTFDataFunction(func)) continue;
 
-      VLOG(3) << "Optimize function: function=" << func_name << " ["
-              << function_idx++ << " of "
-              << optimized_graph->library().function_size() << "]";
-
       // Function optimization might specialize nested function calls, so we
       // have to reset the flag and do at least one more pass over the library.
       optimize_function_library = true;
       optimized_funcs.insert(func_name);
+      funcs.push_back(&func);
+    }
+
+    std::vector<GrapplerFunctionItem> func_items(funcs.size());
+    std::vector<GraphDef> optimized_func_graphs(funcs.size());
+
+    // Optimizes the body of `funcs[i]`. Only reads `flib`, so that several
+    // functions can be optimized concurrently.
+    const auto optimize_function = [&](int i) -> Status {
+      GRAPPLER_RETURN_IF_DEADLINE_EXCEEDED();
+
+      const FunctionDef& func = *funcs[i];
+      const string& func_name = func.signature().name();
+      VLOG(3) << "Optimize function: function=" << func_name << " [" << i
+              << " of " << funcs.size() << "]";
 
       // Make a GrapplerItem from a FunctionDef.
-      GrapplerFunctionItem func_item;
+      GrapplerFunctionItem& func_item = func_items[i];
       TF_RETURN_IF_ERROR(
           MakeGrapplerFunctionItem(func, flib, producer, &func_item));
 
@@ -1227,7 +1253,7 @@ Status MetaOptimizer::OptimizeConsumeItem(Cluster* cluster, GrapplerItem&& item,
           false;
 
       // Optimize function body graph.
-      GraphDef optimized_func_graph;
+      GraphDef& optimized_func_graph = optimized_func_graphs[i];
       if (is_tpu_graph) {
         // Skip optimizing functions if this is a TPU graph. Currently, Grappler
         // passes do not handle TPU functions correctly in a variety of ways
@@ -1249,18 +1275,20 @@ Status MetaOptimizer::OptimizeConsumeItem(Cluster* cluster, GrapplerItem&& item,
         *func_item.graph.mutable_library() =
             GetFunctionDefLibraryStub(*func_item_function_library);
 
-        TF_RETURN_IF_ERROR(implementation_selector.Optimize(
-            cluster, func_item, &optimized_func_graph));
-      } else {
-        GrapplerFunctionItem func_item_copy = func_item;
-        TF_RETURN_IF_ERROR(OptimizeGraph(cluster, std::move(func_item_copy),
-                                         &optimized_func_graph));
+        return implementation_selector.Optimize(cluster, func_item,
+                                                &optimized_func_graph);
       }
+      GrapplerFunctionItem func_item_copy = func_item;
+      return OptimizeGraph(cluster, std::move(func_item_copy),
+                           &optimized_func_graph);
+    };
 
+    // Puts the optimized body of `funcs[i]` back into `flib`.
+    const auto replace_function = [&](int i) -> Status {
       // Function body optimization might have created new specialized
       // functions for each instantiation context. Add them to the library.
       for (const FunctionDef& func_def :
-           optimized_func_graph.library().function()) {
+           optimized_func_graphs[i].library().function()) {
         if (flib.Find(func_def.signature().name()) == nullptr) {
           TF_RETURN_IF_ERROR(flib.AddFunctionDef(func_def));
         }
@@ -1268,11 +1296,35 @@ Status MetaOptimizer::OptimizeConsumeItem(Cluster* cluster, GrapplerItem&& item,
 
       // Convert optimized graph back to FunctionDef.
       FunctionDef optimized_func;
-      func_item.SwapFunctionBody(std::move(optimized_func_graph));
-      TF_RETURN_IF_ERROR(MakeFunctionDef(func_item, flib, &optimized_func));
+      func_items[i].SwapFunctionBody(std::move(optimized_func_graphs[i]));
+      TF_RETURN_IF_ERROR(MakeFunctionDef(func_items[i], flib, &optimized_func));
 
       // Replace optimized function with a new FunctionDef.
-      TF_RETURN_IF_ERROR(flib.ReplaceFunction(func_name, optimized_func));
+      return flib.ReplaceFunction(funcs[i]->signature().name(), optimized_func);
+    };
+
+    const int num_threads = std::min<int>(
+        cfg_.function_optimization_parallelism(), funcs.size());
+    if (num_threads > 1) {
+      // Optimize the functions concurrently, then update the library in the
+      // order of the functions, so that the result is deterministic.
+      std::vector<Status> statuses(funcs.size());
+      {
+        thread::ThreadPool pool(Env::Default(), "grappler_function_optimizer",
+                                num_threads);
+        for (int i = 0; i < funcs.size(); ++i) {
+          pool.Schedule([&, i]() { statuses[i] = optimize_function(i); });
+        }
+      }
+      for (int i = 0; i < funcs.size(); ++i) {
+        TF_RETURN_IF_ERROR(statuses[i]);
+        TF_RETURN_IF_ERROR(replace_function(i));
+      }
+    } else {
+      for (int i = 0; i < funcs.size(); ++i) {
+        TF_RETURN_IF_ERROR(optimize_function(i));
+        TF_RETURN_IF_ERROR(replace_function(i));
+      }
     }
 
     // If optimized at least one function, update the graph library.
@@ -1369,11 +1421,23 @@ bool MetaOptimizerEnabled(const ConfigProto& cfg) {
 Status RunMetaOptimizer(GrapplerItem&& item, const ConfigProto& cfg,
                         DeviceBase* cpu_device, Cluster* cluster,
                         GraphDef* optimized_graph) {
+  MetaOptimizerCache* cache = MetaOptimizerCache::Global();
+  uint64_t cache_key = 0;
+  if (cache != nullptr) {
+    cache_key = MetaOptimizerCache::Key(item, cfg, cluster);
+    if (cache->Lookup(cache_key, optimized_graph)) {
+      VLOG(1) << "Reusing the optimized graph of the Grappler item " << item.id;
+      return absl::OkStatus();
+    }
+  }
+
   MetaOptimizer optimizer(cpu_device, cfg);
   optimizer.set_deadline_usec(
       DeadlineMicroSeconds(cfg.graph_options().rewrite_options()));
-  return optimizer.OptimizeConsumeItem(cluster, std::move(item),
-                                       optimized_graph);
+  TF_RETURN_IF_ERROR(optimizer.OptimizeConsumeItem(cluster, std::move(item),
+                                                   optimized_graph));
+  if (cache != nullptr) cache->Insert(cache_key, *optimized_graph);
+  return absl::OkStatus();
 }
 
 Status OptimizeGraph(
@@ -0,0 +1,212 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/meta_optimizer_cache.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/framework/metrics.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/fingerprint.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/random.h"
+#include "tensorflow/core/public/version.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+uint64_t FingerprintProto(const protobuf::MessageLite& proto) {
+  std::string serialized;
+  SerializeToStringDeterministic(proto, &serialized);
+  return Fingerprint64(serialized);
+}
+
+uint64_t FingerprintStrings(uint64_t fp, const std::vector<string>& strings) {
+  for (const string& s : strings) {
+    fp = FingerprintCat64(fp, Fingerprint64(s));
+  }
+  return FingerprintCat64(fp, strings.size());
+}
+
+}  // namespace
+
+MetaOptimizerCache* MetaOptimizerCache::Global() {
+  static MetaOptimizerCache* const cache = []() -> MetaOptimizerCache* {
+    bool enabled = false;
+    Status status =
+        ReadBoolFromEnvVar("TF_GRAPPLER_OPTIMIZATION_CACHE", false, &enabled);
+    if (!status.ok()) {
+      LOG(WARNING) << "Failed to read TF_GRAPPLER_OPTIMIZATION_CACHE: "
+                   << status;
+    }
+    if (!enabled) return nullptr;
+    Options options;
+    TF_CHECK_OK(ReadStringFromEnvVar("TF_GRAPPLER_OPTIMIZATION_CACHE_DIR", "",
+                                     &options.directory));
+    return new MetaOptimizerCache(options);
+  }();
+  return cache;
+}
+
+uint64_t MetaOptimizerCache::Key(const GrapplerItem& item,
+                                 const ConfigProto& config,
+                                 const Cluster* cluster) {
+  uint64_t fp = FingerprintCat64(Fingerprint64(TF_VERSION_STRING),
+                                 TF_GRAPH_DEF_VERSION);
+  fp = FingerprintCat64(fp, FingerprintProto(item.graph));
+  fp = FingerprintCat64(fp, FingerprintProto(config));
+
+  // The values of the feeds are not used by the optimizers, but their types
+  // and shapes may be.
+  for (const auto& feed : item.feed) {
+    fp = FingerprintCat64(fp, Fingerprint64(feed.first));
+    fp = FingerprintCat64(fp, feed.second.dtype());
+    fp = FingerprintCat64(fp, Fingerprint64(feed.second.shape().DebugString()));
+  }
+  fp = FingerprintCat64(fp, item.feed.size());
+  fp = FingerprintStrings(fp, item.fetch);
+  fp = FingerprintStrings(fp, item.init_ops);
+  fp = FingerprintStrings(fp, item.keep_ops);
+  fp = FingerprintStrings(
+      fp, {item.save_op, item.restore_op, item.save_restore_loc_tensor});
+  for (const QueueRunnerDef& queue_runner : item.queue_runners) {
+    fp = FingerprintCat64(fp, FingerprintProto(queue_runner));
+  }
+  fp = FingerprintCat64(fp, item.queue_runners.size());
+
+  std::vector<string> devices(item.devices().begin(), item.devices().end());
+  std::sort(devices.begin(), devices.end());
+  fp = FingerprintStrings(fp, devices);
+
+  const GrapplerItem::OptimizationOptions& options =
+      item.optimization_options();
+  fp = FingerprintCat64(fp, options.allow_non_differentiable_rewrites);
+  fp = FingerprintCat64(fp, options.allow_pruning_stateful_and_dataset_ops);
+  fp = FingerprintCat64(fp, options.optimize_function_library);
+  fp = FingerprintCat64(fp, options.is_eager_mode);
+  fp = FingerprintCat64(fp, options.intra_op_parallelism_threads);
+
+  if (cluster != nullptr) {
+    std::vector<std::pair<string, uint64_t>> properties;
+    for (const auto& device : cluster->GetDevices()) {
+      properties.emplace_back(device.first, FingerprintProto(device.second));
+    }
+    std::sort(properties.begin(), properties.end());
+    for (const auto& device : properties) {
+      fp = FingerprintCat64(fp, Fingerprint64(device.first));
+      fp = FingerprintCat64(fp, device.second);
+    }
+    fp = FingerprintCat64(fp, properties.size());
+  }
+  return fp;
+}
+
+bool MetaOptimizerCache::Lookup(uint64_t key, GraphDef* optimized_graph) {
+  {
+    mutex_lock l(mu_);
+    auto it = entries_.find(key);
+    if (it != entries_.end()) {
+      lru_.splice(lru_.begin(), lru_, it->second.lru_position);
+      *optimized_graph = *it->second.graph;
+      metrics::RecordGrapplerOptimizationCacheLookup("hit");
+      return true;
+    }
+  }
+
+  if (!options_.directory.empty()) {
+    const std::string path = FilePath(key);
+    if (Env::Default()->FileExists(path).ok()) {
+      auto graph = std::make_shared<GraphDef>();
+      Status status = ReadBinaryProto(Env::Default(), path, graph.get());
+      if (status.ok()) {
+        *optimized_graph = *graph;
+        mutex_lock l(mu_);
+        InsertInMemory(key, std::move(graph));
+        metrics::RecordGrapplerOptimizationCacheLookup("disk_hit");
+        return true;
+      }
+      LOG(WARNING) << "Failed to read the optimized graph " << path << ": "
+                   << status;
+    }
+  }
+
+  metrics::RecordGrapplerOptimizationCacheLookup("miss");
+  return false;
+}
+
+void MetaOptimizerCache::Insert(uint64_t key, const GraphDef& optimized_graph) {
+  auto graph = std::make_shared<const GraphDef>(optimized_graph);
+  {
+    mutex_lock l(mu_);
+    InsertInMemory(key, graph);
+  }
+
+  if (options_.directory.empty()) return;
+  // Write to a temporary file first, so that concurrent readers never see a
+  // partially written graph.
+  Env* env = Env::Default();
+  const std::string path = FilePath(key);
+  const std::string tmp_path =
+      absl::StrCat(path, ".tmp.", env->NowMicros(), ".", random::New64());
+  Status status = env->RecursivelyCreateDir(options_.directory);
+  if (status.ok()) status = WriteBinaryProto(env, tmp_path, *graph);
+  if (status.ok()) status = env->RenameFile(tmp_path, path);
+  if (!status.ok()) {
+    LOG(WARNING) << "Failed to write the optimized graph " << path << ": "
+                 << status;
+    env->DeleteFile(tmp_path).IgnoreError();
+  }
+}
+
+std::string MetaOptimizerCache::FilePath(uint64_t key) const {
+  return io::JoinPath(
+      options_.directory,
+      absl::StrCat("grappler_", absl::Hex(key, absl::kZeroPad16), ".pb"));
+}
+
+void MetaOptimizerCache::InsertInMemory(uint64_t key,
+                                        std::shared_ptr<const GraphDef> graph) {
+  const size_t bytes = graph->ByteSizeLong();
+  if (bytes > options_.max_bytes) return;
+
+  auto [it, inserted] = entries_.try_emplace(key);
+  if (!inserted) {
+    bytes_ -= it->second.bytes;
+    lru_.erase(it->second.lru_position);
+  }
+  lru_.push_front(key);
+  it->second = {std::move(graph), bytes, lru_.begin()};
+  bytes_ += bytes;
+
+  while (bytes_ > options_.max_bytes) {
+    auto evicted = entries_.find(lru_.back());
+    bytes_ -= evicted->second.bytes;
+    entries_.erase(evicted);
+    lru_.pop_back();
+  }
+}
+
+}  // namespace grappler
+}  // namespace tensorflow
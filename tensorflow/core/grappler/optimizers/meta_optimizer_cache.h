@@ -0,0 +1,98 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_META_OPTIMIZER_CACHE_H_
+#define TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_META_OPTIMIZER_CACHE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/grappler/clusters/cluster.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/protobuf/config.pb.h"
+
+namespace tensorflow {
+namespace grappler {
+
+// Thread-safe.
+// Caches the graphs optimized by the meta optimizer, so that optimizing the
+// same graph again, e.g. when a model is loaded by several sessions or a
+// function is retraced, returns the previous result instead of running all
+// the passes again. The graphs are kept in memory, and optionally in a
+// directory shared by the processes loading the same models.
+//
+// The global cache is enabled by the TF_GRAPPLER_OPTIMIZATION_CACHE
+// environment variable, and persisted in TF_GRAPPLER_OPTIMIZATION_CACHE_DIR if
+// it is set. Lookups are recorded in
+// /tensorflow/core/grappler_optimization_cache_lookups.
+class MetaOptimizerCache {
+ public:
+  struct Options {
+    // The maximum total size of the graphs kept in memory. Beyond it, the
+    // least recently used ones are evicted.
+    size_t max_bytes = size_t{1} << 30;
+    // If not empty, the directory where the graphs are persisted.
+    std::string directory;
+  };
+
+  explicit MetaOptimizerCache(const Options& options) : options_(options) {}
+
+  // Returns the process-wide cache, or nullptr if it is not enabled.
+  static MetaOptimizerCache* Global();
+
+  // Returns the key of optimizing `item` with `config` on the devices of
+  // `cluster`, which may be null. It covers the graph, the nodes to preserve,
+  // the devices, the config and the version of TensorFlow.
+  static uint64_t Key(const GrapplerItem& item, const ConfigProto& config,
+                      const Cluster* cluster);
+
+  // Copies the graph optimized with `key` to `optimized_graph`, and returns
+  // whether it was found.
+  bool Lookup(uint64_t key, GraphDef* optimized_graph);
+
+  void Insert(uint64_t key, const GraphDef& optimized_graph);
+
+ private:
+  struct Entry {
+    std::shared_ptr<const GraphDef> graph;
+    size_t bytes = 0;
+    std::list<uint64_t>::iterator lru_position;
+  };
+
+  std::string FilePath(uint64_t key) const;
+
+  void InsertInMemory(uint64_t key, std::shared_ptr<const GraphDef> graph)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  const Options options_;
+
+  mutex mu_;
+  absl::flat_hash_map<uint64_t, Entry> entries_ TF_GUARDED_BY(mu_);
+  // The keys of `entries_`, most recently used first.
+  std::list<uint64_t> lru_ TF_GUARDED_BY(mu_);
+  size_t bytes_ TF_GUARDED_BY(mu_) = 0;
+};
+
+}  // namespace grappler
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_META_OPTIMIZER_CACHE_H_
@@ -0,0 +1,129 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/meta_optimizer_cache.h"
+
+#include <cstdint>
+
+#include "tensorflow/cc/ops/standard_ops.h"
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/monitoring/cell_reader.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/protobuf/config.pb.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+using ::tensorflow::monitoring::testing::CellReader;
+
+constexpr char kLookups[] =
+    "/tensorflow/core/grappler_optimization_cache_lookups";
+
+GrapplerItem MakeItem() {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  auto a = ops::Const(s.WithOpName("a"), 1.0f, {16});
+  auto b = ops::Const(s.WithOpName("b"), 2.0f, {16});
+  auto c = ops::Add(s.WithOpName("c"), a, b);
+  GrapplerItem item;
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+  item.fetch = {"c"};
+  return item;
+}
+
+GraphDef MakeOptimizedGraph(const std::string& name) {
+  GraphDef graph;
+  NodeDef* node = graph.add_node();
+  node->set_name(name);
+  node->set_op("Const");
+  return graph;
+}
+
+TEST(MetaOptimizerCacheTest, KeyCoversItemAndConfig) {
+  const GrapplerItem item = MakeItem();
+  const ConfigProto config;
+  const uint64_t key = MetaOptimizerCache::Key(item, config, nullptr);
+  EXPECT_EQ(MetaOptimizerCache::Key(MakeItem(), config, nullptr), key);
+
+  GrapplerItem other_fetch = MakeItem();
+  other_fetch.fetch = {"a"};
+  EXPECT_NE(MetaOptimizerCache::Key(other_fetch, config, nullptr), key);
+
+  GrapplerItem other_graph = MakeItem();
+  other_graph.graph.mutable_node(0)->set_device("/device:CPU:0");
+  EXPECT_NE(MetaOptimizerCache::Key(other_graph, config, nullptr), key);
+
+  ConfigProto other_config;
+  RewriterConfig* rewriter_config =
+      other_config.mutable_graph_options()->mutable_rewrite_options();
+  rewriter_config->set_remapping(RewriterConfig::OFF);
+  EXPECT_NE(MetaOptimizerCache::Key(item, other_config, nullptr), key);
+}
+
+TEST(MetaOptimizerCacheTest, LookupAfterInsert) {
+  CellReader<int64_t> lookups(kLookups);
+  MetaOptimizerCache cache({});
+  GraphDef graph;
+  EXPECT_FALSE(cache.Lookup(1, &graph));
+  EXPECT_EQ(lookups.Delta("miss"), 1);
+
+  cache.Insert(1, MakeOptimizedGraph("optimized"));
+  ASSERT_TRUE(cache.Lookup(1, &graph));
+  ASSERT_EQ(graph.node_size(), 1);
+  EXPECT_EQ(graph.node(0).name(), "optimized");
+  EXPECT_EQ(lookups.Delta("hit"), 1);
+}
+
+TEST(MetaOptimizerCacheTest, EvictsLeastRecentlyUsed) {
+  MetaOptimizerCache::Options options;
+  options.max_bytes = 2 * MakeOptimizedGraph("graph_1").ByteSizeLong();
+  MetaOptimizerCache cache(options);
+  cache.Insert(1, MakeOptimizedGraph("graph_1"));
+  cache.Insert(2, MakeOptimizedGraph("graph_2"));
+  GraphDef graph;
+  ASSERT_TRUE(cache.Lookup(1, &graph));
+
+  cache.Insert(3, MakeOptimizedGraph("graph_3"));
+  EXPECT_TRUE(cache.Lookup(1, &graph));
+  EXPECT_FALSE(cache.Lookup(2, &graph));
+  EXPECT_TRUE(cache.Lookup(3, &graph));
+}
+
+TEST(MetaOptimizerCacheTest, PersistsInDirectory) {
+  CellReader<int64_t> lookups(kLookups);
+  MetaOptimizerCache::Options options;
+  options.directory =
+      io::JoinPath(testing::TmpDir(), "meta_optimizer_cache_test");
+  MetaOptimizerCache(options).Insert(7, MakeOptimizedGraph("persisted"));
+
+  MetaOptimizerCache cache(options);
+  GraphDef graph;
+  ASSERT_TRUE(cache.Lookup(7, &graph));
+  ASSERT_EQ(graph.node_size(), 1);
+  EXPECT_EQ(graph.node(0).name(), "persisted");
+  EXPECT_EQ(lookups.Delta("disk_hit"), 1);
+
+  // The graph is now in memory.
+  ASSERT_TRUE(cache.Lookup(7, &graph));
+  EXPECT_EQ(lookups.Delta("hit"), 1);
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
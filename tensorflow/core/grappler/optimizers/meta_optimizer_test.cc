@@ -420,6 +420,87 @@ TEST_F(MetaOptimizerTest, OptimizeFunctionLibrary) {
   test::ExpectTensorEqual<int>(tensors_expected[1], tensors[1]);
 }
 
+TEST_F(MetaOptimizerTest, OptimizeFunctionLibraryInParallel) {
+  using test::function::NDef;
+
+  // MySquare(x) = MyMul(x, x), and MyCube(x) = MyMul(MyMul(x, x), x), both
+  // marked as noinline, so that both are optimized as functions.
+  FunctionDef mul_func = FunctionDefHelper::Create(
+      "MyMul", {"x:T", "y:T"}, {"z:T"}, {"T: {float, double}"},
+      {{{"mul"}, "Mul", {"x", "y"}, {{"T", "$T"}}}},
+      /*ret_def=*/
+      {{"z", "mul:z:0"}});
+
+  FunctionDef square_func = FunctionDefHelper::Create(
+      "MySquare", {"x:T"}, {"z:T"}, {"T: {float, double}"},
+      {{{"my_mul"}, "MyMul", {"x", "x"}, {{"T", "$T"}}}},
+      /*ret_def=*/
+      {{"z", "my_mul:z:0"}});
+  (*square_func.mutable_attr())["_noinline"].set_b(true);
+
+  FunctionDef cube_func = FunctionDefHelper::Create(
+      "MyCube", {"x:T"}, {"z:T"}, {"T: {float, double}"},
+      {{{"square"}, "MyMul", {"x", "x"}, {{"T", "$T"}}},
+       {{"cube"}, "MyMul", {"square:z", "x"}, {{"T", "$T"}}}},
+      /*ret_def=*/
+      {{"z", "cube:z:0"}});
+  (*cube_func.mutable_attr())["_noinline"].set_b(true);
+
+  GrapplerItem item;
+  item.id = "tf_graph";
+  item.graph = test::function::GDef(
+      {NDef("a", "Placeholder", {}, {{"dtype", DT_FLOAT}}, kDevice),
+       NDef("square", "MySquare", {"a"}, {{"T", DT_FLOAT}}, kDevice),
+       NDef("cube", "MyCube", {"a"}, {{"T", DT_FLOAT}}, kDevice),
+       NDef("out_s", "Identity", {"square:0"}, {{"T", DT_FLOAT}}, kDevice),
+       NDef("out_c", "Identity", {"cube:0"}, {{"T", DT_FLOAT}}, kDevice)},
+      /*funcs=*/
+      {mul_func, square_func, cube_func});
+
+  const auto optimize = [&](int function_optimization_parallelism) {
+    ConfigProto config_proto;
+    auto& rewriter_config =
+        *config_proto.mutable_graph_options()->mutable_rewrite_options();
+    rewriter_config.set_meta_optimizer_iterations(RewriterConfig::TWO);
+    rewriter_config.set_function_optimization(RewriterConfig::ON);
+    rewriter_config.add_optimizers("function");
+    rewriter_config.set_min_graph_nodes(-1);
+    rewriter_config.set_function_optimization_parallelism(
+        function_optimization_parallelism);
+
+    MetaOptimizer optimizer(nullptr, config_proto);
+    GraphDef output;
+    TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+    return output;
+  };
+
+  const GraphDef sequential = optimize(/*function_optimization_parallelism=*/1);
+  const GraphDef parallel = optimize(/*function_optimization_parallelism=*/4);
+
+  // The functions optimized in parallel are the same as the ones optimized one
+  // after another.
+  FunctionLibraryDefinition sequential_flib(OpRegistry::Global(),
+                                            sequential.library());
+  FunctionLibraryDefinition parallel_flib(OpRegistry::Global(),
+                                          parallel.library());
+  ASSERT_EQ(sequential_flib.num_functions(), 2);
+  ASSERT_EQ(parallel_flib.num_functions(), 2);
+  for (const string& name : sequential_flib.ListFunctionNames()) {
+    const FunctionDef* parallel_func = parallel_flib.Find(name);
+    ASSERT_NE(parallel_func, nullptr) << name;
+    EXPECT_TRUE(FunctionDefsEqual(*sequential_flib.Find(name), *parallel_func))
+        << name;
+  }
+
+  item.fetch = {"out_s", "out_c"};
+  item.feed.emplace_back("a", test::AsScalar<float>(3.0f));
+  auto tensors_expected = EvaluateFetchNodes(item);
+  GrapplerItem optimized = item.WithGraph(GraphDef(parallel));
+  auto tensors = EvaluateFetchNodes(optimized);
+  test::ExpectTensorEqual<float>(tensors_expected[0], tensors[0]);
+  test::ExpectTensorEqual<float>(tensors_expected[1], tensors[1]);
+}
+
 TEST_F(MetaOptimizerTest, OptimizeFunctionLibraryPruneUnusedOutputs) {
   using test::function::NDef;
 
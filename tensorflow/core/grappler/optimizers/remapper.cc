@@ -16,7 +16,9 @@ limitations under the License.
 #include "tensorflow/core/grappler/optimizers/remapper.h"
 
 #include <algorithm>
+#include <cstdint>
 #include <cstdlib>
+#include <initializer_list>
 #include <map>
 #include <set>
 #include <string>
@@ -27,7 +29,11 @@ limitations under the License.
 #include "absl/container/flat_hash_set.h"
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/versions.pb.h"
+#include "tensorflow/core/grappler/costs/cost_estimator.h"
 #include "tensorflow/core/grappler/costs/graph_properties.h"
+#include "tensorflow/core/grappler/costs/op_context.h"
+#include "tensorflow/core/grappler/costs/op_level_cost_estimator.h"
+#include "tensorflow/core/grappler/costs/utils.h"
 #include "tensorflow/core/grappler/graph_view.h"
 #include "tensorflow/core/grappler/grappler_item.h"
 #include "tensorflow/core/grappler/op_types.h"
@@ -126,6 +132,10 @@ struct RemapperContext {
   RewriterConfig::CpuLayout cpu_layout_conversion;
   bool xla_auto_clustering_on;
   bool xla_cpu_jit_disable_fusion;
+  // See Remapper::set_min_fusion_savings_ns().
+  int64_t min_fusion_savings_ns = 0;
+  // See Remapper::set_dynamic_range_quantization().
+  bool dynamic_range_quantization = false;
 };
 
 // FusedBatchNorm that can be replaced with a cheaper set of primitives.
@@ -170,6 +180,37 @@ struct TensorToHashBucket {
   int string_to_hash_bucket = kMissingIndex;
 };
 
+// SparseSegment{Sum,Mean,SqrtN} of the rows that a Gather, and an optional
+// Identity, read from an embedding table at the unique ids, with the unique
+// indices. It can be replaced with a SparseSegment{Sum,Mean,SqrtN} that reads
+// the rows at the ids from the table directly.
+struct EmbeddingLookupSparse {
+  int unique = kMissingIndex;
+  int gather = kMissingIndex;
+  int identity = kMissingIndex;
+  int sparse_segment_reduction = kMissingIndex;
+};
+
+// BatchMatMul(Softmax(BatchMatMul(query, key, adj_y=true) * scale + bias),
+// value), as built by attention layers, with an optional scale of the query
+// or of the scores and an optional bias, e.g. an attention mask. It can be
+// replaced with a _FusedScaledDotProductAttention, which does not materialize
+// the attention scores and probabilities.
+struct ScaledDotProductAttention {
+  int query_scale = kMissingIndex;
+  int query_key_matmul = kMissingIndex;
+  int scores_scale = kMissingIndex;
+  int bias_add = kMissingIndex;
+  int softmax = kMissingIndex;
+  int value_matmul = kMissingIndex;
+  float scale = 1.0f;
+  // The inputs of the fused node.
+  string query;
+  string key;
+  string value;
+  string bias;
+};
+
 // Pad followed by Conv3D/FusedConv3D
 struct PadWithConv3D {
   PadWithConv3D() = default;
@@ -762,6 +803,72 @@ void AddInputShapesAttr(const RemapperContext& ctx, int node_index) {
   }
 }
 
+// The minimum time, in nanoseconds, that fusing elementwise ops into the
+// contraction feeding them must be estimated to save. The fused kernel applies
+// them to the output of the contraction before writing it, so the saving is
+// the memory traffic of the fused ops. If less than or equal to 0 (default
+// value), the ops are fused regardless of the estimate.
+int64_t DefaultMinFusionSavingsNs() {
+  static int64_t min_savings_ns = [] {
+    int64_t min_savings_ns = 0;
+    TF_CHECK_OK(tensorflow::ReadInt64FromEnvVar(
+        "TF_REMAPPER_MIN_FUSION_SAVINGS_NS", /*default_val=*/0,
+        &min_savings_ns));
+    return min_savings_ns;
+  }();
+  return min_savings_ns;
+}
+
+bool DefaultDynamicRangeQuantization() {
+  static bool dynamic_range_quantization = [] {
+    bool dynamic_range_quantization = false;
+    TF_CHECK_OK(tensorflow::ReadBoolFromEnvVar(
+        "TF_REMAPPER_DYNAMIC_RANGE_QUANTIZATION", /*default_val=*/false,
+        &dynamic_range_quantization));
+    return dynamic_range_quantization;
+  }();
+  return dynamic_range_quantization;
+}
+
+// Returns whether fusing `fused_nodes` into the contraction feeding them saves
+// at least `ctx.min_fusion_savings_ns`, as estimated by the
+// OpLevelCostEstimator. Fusions whose savings can't be estimated, e.g. because
+// of unknown shapes, are considered profitable.
+bool IsFusionProfitable(const RemapperContext& ctx,
+                        std::initializer_list<int> fused_nodes) {
+  const int64_t min_savings_ns = ctx.min_fusion_savings_ns;
+  if (min_savings_ns <= 0) return true;
+  if (!ctx.inferred_graph_properties) return true;
+
+  static const OpLevelCostEstimator* estimator = new OpLevelCostEstimator();
+  int64_t savings_ns = 0;
+  for (int node_index : fused_nodes) {
+    const NodeDef* node = ctx.graph_view.GetNode(node_index)->node();
+    OpContext op_context;
+    op_context.name = node->name();
+    op_context.device_name = node->device();
+    OpInfo& op_info = op_context.op_info;
+    op_info.set_op(node->op());
+    *op_info.mutable_attr() = node->attr();
+    for (const auto& input :
+         ctx.graph_properties.GetInputProperties(node->name())) {
+      *op_info.add_inputs() = input;
+    }
+    for (const auto& output :
+         ctx.graph_properties.GetOutputProperties(node->name())) {
+      *op_info.add_outputs() = output;
+    }
+    *op_info.mutable_device() = GetDeviceInfo(node->device());
+
+    const Costs costs = estimator->PredictCosts(op_context);
+    if (costs.inaccurate) return true;
+    savings_ns += costs.memory_time.count();
+  }
+  VLOG(2) << "Fusion of " << fused_nodes.size()
+          << " nodes is estimated to save " << savings_ns << "ns";
+  return savings_ns >= min_savings_ns;
+}
+
 bool FindContractionWithBias(const RemapperContext& ctx, int node_index,
                              ContractionWithBiasAdd* matched,
                              bool check_device_compatible = true) {
@@ -2646,6 +2753,272 @@ bool FindFusedBatchNormGradEx(const RemapperContext& ctx, int node_index,
   return false;
 }
 
+bool FindEmbeddingLookupSparse(const RemapperContext& ctx, int node_index,
+                               EmbeddingLookupSparse* matched) {
+  // Root of the pattern must be a SparseSegment{Sum,Mean,SqrtN} on CPU.
+  const auto* node_view = ctx.graph_view.GetNode(node_index);
+  const auto* node_def = node_view->node();
+  if (!IsAnySparseSegmentReduction(*node_def) ||
+      HasControlFaninOrFanout(*node_view) || !NodeIsOnCpu(node_def) ||
+      node_view->NumRegularFanins() < 3) {
+    return false;
+  }
+
+  // The nodes between the embedding table and the reduction must only be
+  // used by it.
+  const auto is_removable = [&ctx](const utils::MutableNodeView& view) {
+    return !HasControlFaninOrFanout(view) && HasAtMostOneFanoutAtPort0(view) &&
+           !IsInPreserveSet(ctx, view.node());
+  };
+
+  // The data input must be a Gather, possibly through an Identity.
+  const auto* data_fanin = &node_view->GetRegularFanin(0);
+  int identity = kMissingIndex;
+  if (data_fanin->index() != 0) return false;
+  if (IsIdentity(*data_fanin->node_view()->node())) {
+    if (!is_removable(*data_fanin->node_view())) return false;
+    identity = data_fanin->node_view()->node_index();
+    data_fanin = &data_fanin->node_view()->GetRegularFanin(0);
+    if (data_fanin->index() != 0) return false;
+  }
+  const auto* gather_node_view = data_fanin->node_view();
+  const auto* gather_node_def = gather_node_view->node();
+  if ((gather_node_def->op() != "Gather" &&
+       gather_node_def->op() != "GatherV2") ||
+      !is_removable(*gather_node_view) ||
+      gather_node_view->NumRegularFanins() < 2) {
+    return false;
+  }
+
+  // GatherV2 must read whole rows of the table.
+  if (gather_node_def->op() == "GatherV2") {
+    int batch_dims = 0;
+    if (TryGetNodeAttr(*gather_node_def, "batch_dims", &batch_dims) &&
+        batch_dims != 0) {
+      return false;
+    }
+    if (gather_node_view->NumRegularFanins() < 3) return false;
+    const auto* axis_node_def =
+        gather_node_view->GetRegularFanin(2).node_view()->node();
+    Tensor axis;
+    if (!IsConstant(*axis_node_def) ||
+        !axis.FromProto(axis_node_def->attr().at("value").tensor()) ||
+        axis.NumElements() != 1) {
+      return false;
+    }
+    if (axis.dtype() == DT_INT32) {
+      if (axis.flat<int32>()(0) != 0) return false;
+    } else if (axis.dtype() == DT_INT64) {
+      if (axis.flat<int64_t>()(0) != 0) return false;
+    } else {
+      return false;
+    }
+  }
+
+  // The Gather must read the rows at the unique ids, and the reduction must
+  // take the indices of each id in the unique ids from the same Unique.
+  const auto& ids_fanin = gather_node_view->GetRegularFanin(1);
+  const auto& indices_fanin = node_view->GetRegularFanin(1);
+  const auto* unique_node_view = ids_fanin.node_view();
+  const auto* unique_node_def = unique_node_view->node();
+  if (unique_node_def->op() != "Unique" || ids_fanin.index() != 0 ||
+      indices_fanin.node_view() != unique_node_view ||
+      indices_fanin.index() != 1 ||
+      unique_node_view->NumRegularFanins() < 1) {
+    return false;
+  }
+  if (!HasDataType(unique_node_def, DT_INT32) &&
+      !HasDataType(unique_node_def, DT_INT64)) {
+    return false;
+  }
+
+  EmbeddingLookupSparse pattern;
+  pattern.unique = unique_node_view->node_index();
+  pattern.gather = gather_node_view->node_index();
+  pattern.identity = identity;
+  pattern.sparse_segment_reduction = node_index;
+  *matched = pattern;
+
+  return true;
+}
+
+// Returns true iff `node` is a float constant with a single element, and
+// returns it in `value`.
+bool GetScalarFloatConstant(const NodeDef& node, float* value) {
+  Tensor tensor;
+  if (!IsConstant(node) || !HasDataType(&node, DT_FLOAT, "dtype") ||
+      !node.attr().contains("value") ||
+      !tensor.FromProto(node.attr().at("value").tensor()) ||
+      tensor.NumElements() != 1) {
+    return false;
+  }
+  *value = tensor.flat<float>()(0);
+  return true;
+}
+
+bool FindScaledDotProductAttention(RemapperContext* ctx, int node_index,
+                                   ScaledDotProductAttention* matched) {
+  // Root of the pattern must be a float BatchMatMul on CPU, multiplying the
+  // attention probabilities with the values.
+  const auto* node_view = ctx->graph_view.GetNode(node_index);
+  const auto* node_def = node_view->node();
+  const auto is_batch_matmul = [](const NodeDef& node, bool adj_y) {
+    if (!IsAnyBatchMatMul(node) || !HasDataType(&node, DT_FLOAT) ||
+        !NodeIsOnCpu(&node)) {
+      return false;
+    }
+    bool adj_x_attr = false;
+    bool adj_y_attr = false;
+    TryGetNodeAttr(node, "adj_x", &adj_x_attr);
+    TryGetNodeAttr(node, "adj_y", &adj_y_attr);
+    return !adj_x_attr && adj_y_attr == adj_y;
+  };
+  if (!is_batch_matmul(*node_def, /*adj_y=*/false) ||
+      HasControlFaninOrFanout(*node_view) ||
+      node_view->NumRegularFanins() != 2) {
+    return false;
+  }
+
+  // The nodes between the query and key and the root must only be used by the
+  // next node of the pattern.
+  const auto is_removable = [ctx](const utils::MutableNodeView& view) {
+    return !HasControlFaninOrFanout(view) && HasAtMostOneFanoutAtPort0(view) &&
+           !IsInPreserveSet(*ctx, view.node());
+  };
+  // Multiplies `scale` with the scalar input of the Mul `view`, and returns
+  // the index of its other input, or -1.
+  const auto match_scale = [&](const utils::MutableNodeView& view,
+                               float* scale) -> int {
+    if (!IsMul(*view.node()) || !HasDataType(view.node(), DT_FLOAT) ||
+        !is_removable(view) || view.NumRegularFanins() != 2) {
+      return -1;
+    }
+    for (int i = 0; i < 2; ++i) {
+      const NodeDef* scale_node =
+          view.GetRegularFanin(1 - i).node_view()->node();
+      float value;
+      if (GetScalarFloatConstant(*scale_node, &value)) {
+        *scale *= value;
+        return i;
+      }
+    }
+    return -1;
+  };
+
+  ScaledDotProductAttention pattern;
+  const auto& probabilities = node_view->GetRegularFanin(0);
+  const auto* softmax_view = probabilities.node_view();
+  if (probabilities.index() != 0 || !IsSoftmax(*softmax_view->node()) ||
+      !HasDataType(softmax_view->node(), DT_FLOAT) ||
+      !is_removable(*softmax_view)) {
+    return false;
+  }
+  pattern.softmax = softmax_view->node_index();
+  pattern.value_matmul = node_index;
+  pattern.value = node_def->input(1);
+
+  // Matches the scores from `fanin`, possibly scaled.
+  const auto match_scores =
+      [&](const utils::MutableFanoutView& fanin) -> bool {
+    const auto* view = fanin.node_view();
+    if (fanin.index() != 0) return false;
+    const int scores_input = match_scale(*view, &pattern.scale);
+    if (scores_input >= 0) {
+      pattern.scores_scale = view->node_index();
+      const auto& scores = view->GetRegularFanin(scores_input);
+      if (scores.index() != 0) return false;
+      view = scores.node_view();
+    }
+    if (!is_batch_matmul(*view->node(), /*adj_y=*/true) ||
+        !is_removable(*view) || view->NumRegularFanins() != 2) {
+      return false;
+    }
+    pattern.query_key_matmul = view->node_index();
+    pattern.query = view->node()->input(0);
+    pattern.key = view->node()->input(1);
+    const auto* query_view = view->GetRegularFanin(0).node_view();
+    const int query_input = match_scale(*query_view, &pattern.scale);
+    if (query_input >= 0) {
+      pattern.query_scale = query_view->node_index();
+      pattern.query = query_view->node()->input(query_input);
+    }
+    return true;
+  };
+
+  const auto& logits = softmax_view->GetRegularFanin(0);
+  const auto* logits_view = logits.node_view();
+  int bias_input = -1;
+  if (IsAdd(*logits_view->node()) && is_removable(*logits_view) &&
+      HasDataType(logits_view->node(), DT_FLOAT) &&
+      logits_view->NumRegularFanins() == 2 && logits.index() == 0) {
+    for (int i = 0; i < 2 && bias_input < 0; ++i) {
+      pattern.scale = 1.0f;
+      pattern.scores_scale = kMissingIndex;
+      pattern.query_scale = kMissingIndex;
+      if (match_scores(logits_view->GetRegularFanin(i))) bias_input = 1 - i;
+    }
+    if (bias_input < 0) return false;
+    pattern.bias_add = logits_view->node_index();
+    pattern.bias = logits_view->node()->input(bias_input);
+  } else if (!match_scores(logits)) {
+    return false;
+  }
+
+  // The kernel takes 4-D query, key and value with the same batch and heads,
+  // and a bias that broadcasts to the scores without broadcasting them.
+  if (!ctx->inferred_graph_properties) {
+    Status s = ctx->graph_properties.InferStatically(
+        /*assume_valid_feeds=*/false,
+        /*aggressive_shape_inference=*/false,
+        /*include_input_tensor_values=*/true,
+        /*include_output_tensor_values=*/false);
+    if (!s.ok()) return false;
+    ctx->inferred_graph_properties = true;
+  }
+  const auto same_dim = [](const TensorShapeProto::Dim& a,
+                           const TensorShapeProto::Dim& b) {
+    return IsKnownSymbolically(a) && a.size() == b.size();
+  };
+  const NodeDef* query_key_matmul =
+      ctx->graph_view.GetNode(pattern.query_key_matmul)->node();
+  const auto& query_key_props =
+      ctx->graph_properties.GetInputProperties(query_key_matmul->name());
+  const auto& value_props =
+      ctx->graph_properties.GetInputProperties(node_def->name());
+  if (query_key_props.size() != 2 || value_props.size() != 2) return false;
+  const TensorShapeProto& query_shape = query_key_props[0].shape();
+  const TensorShapeProto& key_shape = query_key_props[1].shape();
+  const TensorShapeProto& value_shape = value_props[1].shape();
+  for (const TensorShapeProto* shape :
+       {&query_shape, &key_shape, &value_shape}) {
+    if (shape->unknown_rank() || shape->dim_size() != 4) return false;
+  }
+  for (int i = 0; i < 2; ++i) {
+    if (!same_dim(query_shape.dim(i), key_shape.dim(i)) ||
+        !same_dim(query_shape.dim(i), value_shape.dim(i))) {
+      return false;
+    }
+  }
+  if (pattern.bias_add != kMissingIndex) {
+    const NodeDef* bias_add = logits_view->node();
+    const auto& bias_props =
+        ctx->graph_properties.GetInputProperties(bias_add->name());
+    if (bias_props.size() != 2) return false;
+    const TensorShapeProto& bias_shape = bias_props[bias_input].shape();
+    if (bias_shape.unknown_rank() || bias_shape.dim_size() > 4) return false;
+    const TensorShapeProto::Dim* scores_dims[4] = {
+        &query_shape.dim(0), &query_shape.dim(1), &query_shape.dim(2),
+        &key_shape.dim(2)};
+    for (int i = 3, j = bias_shape.dim_size() - 1; j >= 0; --i, --j) {
+      const auto& dim = bias_shape.dim(j);
+      if (dim.size() != 1 && !same_dim(dim, *scores_dims[i])) return false;
+    }
+  }
+
+  *matched = pattern;
+  return true;
+}
+
 bool FindTensorToHashBucket(const RemapperContext& ctx, int node_index,
                             TensorToHashBucket* matched) {
   // Root of the pattern must be a StringToHashBucketFast.
@@ -4336,6 +4709,150 @@ Status AddTensorToHashBucketNode(RemapperContext* ctx,
   return absl::OkStatus();
 }
 
+Status AddScaledDotProductAttentionNode(
+    RemapperContext* ctx, const ScaledDotProductAttention& matched,
+    std::vector<bool>* invalidated_nodes, std::vector<bool>* nodes_to_delete) {
+  const GraphDef* graph = ctx->graph_view.graph();
+  const NodeDef& value_matmul = graph->node(matched.value_matmul);
+  VLOG(2) << "Fuse scaled dot-product attention into "
+          << "_FusedScaledDotProductAttention: value_matmul="
+          << value_matmul.name() << " query_key_matmul="
+          << graph->node(matched.query_key_matmul).name()
+          << " softmax=" << graph->node(matched.softmax).name();
+
+  NodeDef fused_op;
+  fused_op.set_name(value_matmul.name());
+  fused_op.set_op("_FusedScaledDotProductAttention");
+  fused_op.set_device(value_matmul.device());
+  fused_op.add_input(matched.query);
+  fused_op.add_input(matched.key);
+  fused_op.add_input(matched.value);
+  const bool has_bias = matched.bias_add != kMissingIndex;
+  if (has_bias) fused_op.add_input(matched.bias);
+
+  auto* attr = fused_op.mutable_attr();
+  SetAttrValue(DT_FLOAT, &(*attr)["T"]);
+  SetAttrValue(has_bias ? 1 : 0, &(*attr)["num_args"]);
+  SetAttrValue(matched.scale, &(*attr)["scale"]);
+
+  utils::Mutation* mutation = ctx->graph_view.GetMutationBuilder();
+  Status status;
+  mutation->AddNode(std::move(fused_op), &status);
+  TF_RETURN_IF_ERROR(status);
+  TF_RETURN_IF_ERROR(mutation->Apply());
+
+  (*invalidated_nodes)[matched.value_matmul] = true;
+  for (int node : {matched.query_scale, matched.query_key_matmul,
+                   matched.scores_scale, matched.bias_add, matched.softmax}) {
+    if (node != kMissingIndex) (*nodes_to_delete)[node] = true;
+  }
+
+  return absl::OkStatus();
+}
+
+Status AddEmbeddingLookupSparseNode(RemapperContext* ctx,
+                                    const EmbeddingLookupSparse& matched,
+                                    std::vector<bool>* invalidated_nodes,
+                                    std::vector<bool>* nodes_to_delete) {
+  const GraphDef* graph = ctx->graph_view.graph();
+  const NodeDef& unique = graph->node(matched.unique);
+  const NodeDef& gather = graph->node(matched.gather);
+  const NodeDef& sparse_segment_reduction =
+      graph->node(matched.sparse_segment_reduction);
+  VLOG(2) << "Fuse Unique and " << gather.op() << " with "
+          << sparse_segment_reduction.op() << ":" << " unique=" << unique.name()
+          << " gather=" << gather.name()
+          << " sparse_segment_reduction=" << sparse_segment_reduction.name();
+
+  NodeDef fused_op;
+  fused_op.set_name(sparse_segment_reduction.name());
+  fused_op.set_op(sparse_segment_reduction.op());
+  fused_op.set_device(sparse_segment_reduction.device());
+  fused_op.add_input(gather.input(0));  // 0: params
+  fused_op.add_input(unique.input(0));  // 1: ids
+  // 2: segment_ids, 3: num_segments
+  for (int i = 2; i < sparse_segment_reduction.input_size(); ++i) {
+    fused_op.add_input(sparse_segment_reduction.input(i));
+  }
+
+  auto* attr = fused_op.mutable_attr();
+  *attr = sparse_segment_reduction.attr();
+  (*attr)["Tidx"] = unique.attr().at("T");
+
+  // The unique ids, or their indices, may still be used by other nodes.
+  const auto* unique_node_view = ctx->graph_view.GetNode(matched.unique);
+  const bool remove_unique =
+      !HasControlFaninOrFanout(*unique_node_view) &&
+      unique_node_view->GetRegularFanout(0).size() == 1 &&
+      unique_node_view->GetRegularFanout(1).size() == 1 &&
+      !IsInPreserveSet(*ctx, &unique);
+
+  utils::Mutation* mutation = ctx->graph_view.GetMutationBuilder();
+  Status status;
+  mutation->AddNode(std::move(fused_op), &status);
+  TF_RETURN_IF_ERROR(status);
+  TF_RETURN_IF_ERROR(mutation->Apply());
+
+  (*invalidated_nodes)[matched.sparse_segment_reduction] = true;
+  (*nodes_to_delete)[matched.gather] = true;
+  if (matched.identity != kMissingIndex) {
+    (*nodes_to_delete)[matched.identity] = true;
+  }
+  if (remove_unique) (*nodes_to_delete)[matched.unique] = true;
+
+  return absl::OkStatus();
+}
+
+// The minimum number of elements of the weights of a MatMul replaced with
+// _DynamicQuantizedMatMul. Smaller ones cost more to quantize the activations
+// than they save.
+constexpr int64_t kMinDynamicQuantizationWeights = 1 << 12;
+
+// Returns true iff the node is a float MatMul on CPU whose weights (its second
+// input) are a large enough float constant matrix.
+bool IsDynamicQuantizedMatMulCandidate(const RemapperContext& ctx,
+                                       int node_index) {
+  const auto* node_view = ctx.graph_view.GetNode(node_index);
+  const auto* node_def = node_view->node();
+  if (node_def->op() != "MatMul" || !HasDataType(node_def, DT_FLOAT) ||
+      !NodeIsOnCpu(node_def) || node_view->NumRegularFanins() != 2) {
+    return false;
+  }
+
+  const auto* weights_def = node_view->GetRegularFanin(1).node_view()->node();
+  if (!IsConstant(*weights_def) ||
+      !HasDataType(weights_def, DT_FLOAT, "dtype") ||
+      !weights_def->attr().contains("value")) {
+    return false;
+  }
+  const TensorShapeProto& weights_shape =
+      weights_def->attr().at("value").tensor().tensor_shape();
+  if (weights_shape.dim_size() != 2) return false;
+  const int64_t num_weights =
+      weights_shape.dim(0).size() * weights_shape.dim(1).size();
+  return num_weights >= kMinDynamicQuantizationWeights;
+}
+
+// Replaces the candidate MatMul nodes with _DynamicQuantizedMatMul nodes. This
+// runs before the other remappings, which would fuse the MatMul nodes with
+// their BiasAdd or activation.
+Status AddDynamicQuantizedMatMulNodes(RemapperContext* ctx) {
+  utils::Mutation* mutation = ctx->graph_view.GetMutationBuilder();
+  for (int i = 0; i < ctx->graph_view.NumNodes(); ++i) {
+    if (!IsDynamicQuantizedMatMulCandidate(*ctx, i)) continue;
+    auto* node_view = ctx->graph_view.GetNode(i);
+    VLOG(2) << "Replace MatMul with _DynamicQuantizedMatMul: matmul="
+            << node_view->GetName();
+    mutation->UpdateNodeOp(node_view, "_DynamicQuantizedMatMul");
+    for (const char* attr_name : {"T", "grad_a", "grad_b"}) {
+      if (node_view->GetAttr(attr_name) != nullptr) {
+        mutation->RemoveNodeAttr(node_view, attr_name);
+      }
+    }
+  }
+  return mutation->Apply();
+}
+
 Status AddFusedBatchMatMul(RemapperContext* ctx,
                            const std::map<string, int>& matched_nodes_map,
                            const std::set<int>& remove_node_indices,
@@ -4809,6 +5326,12 @@ bool RequiresInferredShapes(const RemapperContext& ctx, int node_index,
     return true;
   };
 
+  // The savings of fusions are estimated from the inferred shapes.
+  if (ctx.min_fusion_savings_ns > 0 &&
+      (IsBiasAdd(*node_def) || IsSupportedActivation(*node_def, cluster))) {
+    return true;
+  }
+
   if (IsMKLEnabled())
     return is_batch_norm_candidate() || is_batch_norm_fusion_candidate() ||
            IsContractionWithAdd(ctx, node_index) ||
@@ -4843,6 +5366,10 @@ Status Remapper::Optimize(Cluster* cluster, const GrapplerItem& item,
   RemapperContext ctx(&mutable_item, &status, cpu_layout_conversion_,
                       xla_auto_clustering_on_, xla_cpu_jit_disable_fusion);
   TF_RETURN_IF_ERROR(status);
+  ctx.min_fusion_savings_ns =
+      min_fusion_savings_ns_.value_or(DefaultMinFusionSavingsNs());
+  ctx.dynamic_range_quantization =
+      dynamic_range_quantization_.value_or(DefaultDynamicRangeQuantization());
 
   // Processing graph in reverse-topological sorted order allows to remap
   // longer chains of dependent ops in one pass.
@@ -4860,6 +5387,10 @@ Status Remapper::Optimize(Cluster* cluster, const GrapplerItem& item,
   bool allow_non_differentiable_rewrites =
       item.optimization_options().allow_non_differentiable_rewrites;
 
+  if (ctx.dynamic_range_quantization && allow_non_differentiable_rewrites) {
+    TF_RETURN_IF_ERROR(AddDynamicQuantizedMatMulNodes(&ctx));
+  }
+
   for (int i = num_nodes - 1; i >= 0; --i) {
     // Check if node was invalidated by one of the previous remaps.
     if (invalidated_nodes[i] || nodes_to_delete[i]) {
@@ -5098,7 +5629,8 @@ Status Remapper::Optimize(Cluster* cluster, const GrapplerItem& item,
     // _Fused{Conv2D,DepthwiseConv2dNative,MatMul}
     ContractionWithBiasAdd contract_with_bias;
     if (allow_non_differentiable_rewrites &&
-        FindContractionWithBias(ctx, i, &contract_with_bias)) {
+        FindContractionWithBias(ctx, i, &contract_with_bias) &&
+        IsFusionProfitable(ctx, {contract_with_bias.bias_add})) {
       TF_RETURN_IF_ERROR(AddFusedContractionNode(
           &ctx, contract_with_bias, &invalidated_nodes, &nodes_to_delete));
       continue;
@@ -5109,7 +5641,10 @@ Status Remapper::Optimize(Cluster* cluster, const GrapplerItem& item,
     ContractionWithBiasAddAndActivation contract_with_bias_and_activation;
     if (allow_non_differentiable_rewrites &&
         FindContractionWithBiasAndActivation(
-            ctx, cluster, i, &contract_with_bias_and_activation)) {
+            ctx, cluster, i, &contract_with_bias_and_activation) &&
+        IsFusionProfitable(
+            ctx, {contract_with_bias_and_activation.bias_add,
+                  contract_with_bias_and_activation.activation})) {
       TF_RETURN_IF_ERROR(
           AddFusedContractionNode(&ctx, contract_with_bias_and_activation,
                                   &invalidated_nodes, &nodes_to_delete));
@@ -5182,6 +5717,28 @@ Status Remapper::Optimize(Cluster* cluster, const GrapplerItem& item,
       continue;
     }
 
+    // Remap BatchMatMul(Softmax(BatchMatMul(query, key) * scale + bias), value)
+    // into the _FusedScaledDotProductAttention.
+    ScaledDotProductAttention scaled_dot_product_attention;
+    if (allow_non_differentiable_rewrites &&
+        FindScaledDotProductAttention(&ctx, i, &scaled_dot_product_attention)) {
+      TF_RETURN_IF_ERROR(AddScaledDotProductAttentionNode(
+          &ctx, scaled_dot_product_attention, &invalidated_nodes,
+          &nodes_to_delete));
+      continue;
+    }
+
+    // Remap SparseSegment{Sum,Mean,SqrtN}(Gather(params, Unique(ids).y),
+    // Unique(ids).idx, segment_ids) into the
+    // SparseSegment{Sum,Mean,SqrtN}(params, ids, segment_ids).
+    EmbeddingLookupSparse embedding_lookup_sparse;
+    if (FindEmbeddingLookupSparse(ctx, i, &embedding_lookup_sparse)) {
+      TF_RETURN_IF_ERROR(
+          AddEmbeddingLookupSparseNode(&ctx, embedding_lookup_sparse,
+                                       &invalidated_nodes, &nodes_to_delete));
+      continue;
+    }
+
     // During inference, most of the inputs to FusedBatchNorm are constant, and
     // we can therefore replace the op with a much cheaper set of primitives.
     FusedBatchNorm fused_batch_norm;
@@ -16,6 +16,9 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_REMAPPER_H_
 #define TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_REMAPPER_H_
 
+#include <cstdint>
+#include <optional>
+
 #include "tensorflow/core/grappler/optimizers/graph_optimizer.h"
 #include "tensorflow/core/protobuf/rewriter_config.pb.h"
 
@@ -43,10 +46,28 @@ class Remapper : public GraphOptimizer {
   Status Optimize(Cluster* cluster, const GrapplerItem& item,
                   GraphDef* optimized_graph) override;
 
+  // Sets the minimum time, in nanoseconds, that fusing elementwise ops into a
+  // contraction must be estimated to save. Defaults to the value of the
+  // TF_REMAPPER_MIN_FUSION_SAVINGS_NS environment variable.
+  void set_min_fusion_savings_ns(int64_t min_fusion_savings_ns) {
+    min_fusion_savings_ns_ = min_fusion_savings_ns;
+  }
+
+  // Sets whether MatMul nodes on CPU with large constant float weights are
+  // replaced with _DynamicQuantizedMatMul, which computes them with eight-bit
+  // arithmetic at some loss of precision. Defaults to the value of the
+  // TF_REMAPPER_DYNAMIC_RANGE_QUANTIZATION environment variable (false if
+  // unset).
+  void set_dynamic_range_quantization(bool dynamic_range_quantization) {
+    dynamic_range_quantization_ = dynamic_range_quantization;
+  }
+
  private:
   RewriterConfig::Toggle opt_level_;
   RewriterConfig::CpuLayout cpu_layout_conversion_;
   bool xla_auto_clustering_on_;
+  std::optional<int64_t> min_fusion_savings_ns_;
+  std::optional<bool> dynamic_range_quantization_;
 };
 
 }  // end namespace grappler
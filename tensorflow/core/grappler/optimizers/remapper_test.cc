@@ -736,6 +736,46 @@ TEST_F(RemapperFuseConvWithBias, Conv3D_BF16) {
   RunTest<3, DT_BFLOAT16>();
 }
 
+TEST_F(RemapperTest, FuseConv2DWithBiasIfProfitable) {
+  using ::tensorflow::ops::Placeholder;
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+  auto input_shape = ops::Placeholder::Shape({8, 32, 32, 3});
+  auto filter_shape = ops::Placeholder::Shape({1, 1, 3, 128});
+  auto bias_shape = ops::Placeholder::Shape({128});
+  auto input = Placeholder(s.WithOpName("input"), DT_FLOAT, input_shape);
+  auto filter = Placeholder(s.WithOpName("filter"), DT_FLOAT, filter_shape);
+  auto bias = Placeholder(s.WithOpName("bias"), DT_FLOAT, bias_shape);
+  auto conv =
+      ops::Conv2D(s.WithOpName("conv"), input, filter, {1, 1, 1, 1}, "SAME");
+  auto bias_add = ops::BiasAdd(s.WithOpName("bias_add"), conv, bias);
+  auto fetch = ops::Identity(s.WithOpName("fetch"), bias_add);
+
+  GrapplerItem item;
+  item.fetch = {"fetch"};
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+  for (int i = 0; i < item.graph.node_size(); ++i) {
+    item.graph.mutable_node(i)->set_device("/device:CPU:0");
+  }
+
+  const auto fused_op = [&](int64_t min_fusion_savings_ns) -> string {
+    Remapper optimizer(RewriterConfig::ON);
+    optimizer.set_min_fusion_savings_ns(min_fusion_savings_ns);
+    GraphDef output;
+    TF_CHECK_OK(optimizer.Optimize(nullptr, item, &output));
+    for (const NodeDef& node : output.node()) {
+      if (node.name() == "bias_add") return node.op();
+    }
+    return "";
+  };
+
+  // Writing and reading back the 8x32x32x128 output of the convolution takes
+  // much longer than a nanosecond, and much less than a second.
+  EXPECT_EQ(fused_op(/*min_fusion_savings_ns=*/0), "_FusedConv2D");
+  EXPECT_EQ(fused_op(/*min_fusion_savings_ns=*/1), "_FusedConv2D");
+  EXPECT_EQ(fused_op(/*min_fusion_savings_ns=*/1000 * 1000 * 1000), "BiasAdd");
+}
+
 class RemapperFuseConvWithBiasAndActivation : public RemapperTest {
  public:
   template <int dim, DataType DTYPE>
@@ -1767,6 +1807,299 @@ TEST_F(RemapperTensorToHashBucketTest, I32) { RunTest<DT_INT32>(); }
 
 TEST_F(RemapperTensorToHashBucketTest, I64) { RunTest<DT_INT64>(); }
 
+class RemapperEmbeddingLookupSparseTest : public RemapperTest {
+ public:
+  template <typename SparseSegmentReduction>
+  void RunTest(const string& op) {
+    using ::tensorflow::ops::Placeholder;
+
+    tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+    auto params = Placeholder(s.WithOpName("params"), DT_FLOAT,
+                              ops::Placeholder::Shape({100, 16}));
+    auto ids = Placeholder(s.WithOpName("ids"), DT_INT64,
+                           ops::Placeholder::Shape({12}));
+    auto segment_ids = Placeholder(s.WithOpName("segment_ids"), DT_INT32,
+                                   ops::Placeholder::Shape({12}));
+
+    auto unique = ops::Unique(s.WithOpName("unique"), ids);
+    auto axis = ops::Const(s.WithOpName("axis"), 0, {});
+    auto gather =
+        ops::GatherV2(s.WithOpName("gather"), params, unique.y, axis);
+    auto identity = ops::Identity(s.WithOpName("identity"), gather);
+    auto reduction = SparseSegmentReduction(s.WithOpName("reduction"),
+                                            identity, unique.idx, segment_ids);
+    auto fetch = ops::Identity(s.WithOpName("fetch"), reduction);
+
+    auto params_t = GenerateRandomTensor<DT_FLOAT>({100, 16});
+    Tensor ids_t(DT_INT64, TensorShape({12}));
+    test::FillValues<int64_t>(&ids_t, {3, 7, 3, 99, 0, 7, 7, 42, 3, 0, 5, 5});
+    Tensor segment_ids_t(DT_INT32, TensorShape({12}));
+    test::FillValues<int32>(&segment_ids_t, {0, 0, 0, 1, 1, 1, 1, 1, 3, 3, 3,
+                                             4});
+
+    GrapplerItem item;
+    item.fetch = {"fetch"};
+    item.feed = {
+        {"params", params_t}, {"ids", ids_t}, {"segment_ids", segment_ids_t}};
+    TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+
+    // Place all nodes on CPU.
+    for (int i = 0; i < item.graph.node_size(); ++i) {
+      item.graph.mutable_node(i)->set_device("/device:CPU:0");
+    }
+
+    Remapper optimizer(RewriterConfig::ON);
+    GraphDef output;
+    TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+    int found = 0;
+    for (const NodeDef& node : output.node()) {
+      EXPECT_NE(node.name(), "unique");
+      EXPECT_NE(node.name(), "gather");
+      EXPECT_NE(node.name(), "identity");
+      if (node.name() == "reduction") {
+        EXPECT_EQ(node.op(), op);
+        ASSERT_EQ(node.input_size(), 3);
+        EXPECT_EQ(node.input(0), "params");
+        EXPECT_EQ(node.input(1), "ids");
+        EXPECT_EQ(node.input(2), "segment_ids");
+        EXPECT_EQ(node.attr().at("Tidx").type(), DT_INT64);
+        found++;
+      }
+    }
+    EXPECT_EQ(found, 1);
+
+    auto tensors_expected = EvaluateNodes(item.graph, item.fetch, item.feed);
+    ASSERT_EQ(tensors_expected.size(), 1);
+    auto tensors = EvaluateNodes(output, item.fetch, item.feed);
+    ASSERT_EQ(tensors.size(), 1);
+    test::ExpectTensorNear<float>(tensors[0], tensors_expected[0], 1e-6);
+  }
+};
+
+TEST_F(RemapperEmbeddingLookupSparseTest, Sum) {
+  RunTest<ops::SparseSegmentSum>("SparseSegmentSum");
+}
+
+TEST_F(RemapperEmbeddingLookupSparseTest, Mean) {
+  RunTest<ops::SparseSegmentMean>("SparseSegmentMean");
+}
+
+TEST_F(RemapperEmbeddingLookupSparseTest, SqrtN) {
+  RunTest<ops::SparseSegmentSqrtN>("SparseSegmentSqrtN");
+}
+
+TEST_F(RemapperEmbeddingLookupSparseTest, UniqueIdsUsedElsewhere) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+  auto params = ops::Placeholder(s.WithOpName("params"), DT_FLOAT,
+                                 ops::Placeholder::Shape({100, 16}));
+  auto ids = ops::Placeholder(s.WithOpName("ids"), DT_INT32,
+                              ops::Placeholder::Shape({4}));
+  auto segment_ids = ops::Placeholder(s.WithOpName("segment_ids"), DT_INT32,
+                                      ops::Placeholder::Shape({4}));
+
+  auto unique = ops::Unique(s.WithOpName("unique"), ids);
+  auto gather = ops::Gather(s.WithOpName("gather"), params, unique.y);
+  auto reduction = ops::SparseSegmentSum(s.WithOpName("reduction"), gather,
+                                         unique.idx, segment_ids);
+  auto fetch = ops::Identity(s.WithOpName("fetch"), reduction);
+  auto fetch_ids = ops::Identity(s.WithOpName("fetch_ids"), unique.y);
+
+  GrapplerItem item;
+  item.fetch = {"fetch", "fetch_ids"};
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+  for (int i = 0; i < item.graph.node_size(); ++i) {
+    item.graph.mutable_node(i)->set_device("/device:CPU:0");
+  }
+
+  Remapper optimizer(RewriterConfig::ON);
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  bool found_unique = false;
+  for (const NodeDef& node : output.node()) {
+    EXPECT_NE(node.name(), "gather");
+    if (node.name() == "unique") found_unique = true;
+    if (node.name() == "reduction") {
+      ASSERT_EQ(node.input_size(), 3);
+      EXPECT_EQ(node.input(0), "params");
+      EXPECT_EQ(node.input(1), "ids");
+      EXPECT_EQ(node.attr().at("Tidx").type(), DT_INT32);
+    }
+  }
+  EXPECT_TRUE(found_unique);
+}
+
+TEST_F(RemapperTest, DynamicQuantizedMatMul) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+  auto lhs = ops::Placeholder(s.WithOpName("lhs"), DT_FLOAT,
+                              ops::Placeholder::Shape({8, 64}));
+  auto bias = ops::Placeholder(s.WithOpName("bias"), DT_FLOAT,
+                               ops::Placeholder::Shape({128}));
+  Tensor weights_t = GenerateRandomTensor<DT_FLOAT>({64, 128});
+  auto weights = ops::Const(s.WithOpName("weights"), weights_t);
+  Tensor small_weights_t = GenerateRandomTensor<DT_FLOAT>({64, 4});
+  auto small_weights = ops::Const(s.WithOpName("small_weights"),
+                                  small_weights_t);
+
+  auto matmul = ops::MatMul(s.WithOpName("matmul"), lhs, weights);
+  auto bias_add = ops::BiasAdd(s.WithOpName("bias_add"), matmul, bias);
+  auto small_matmul =
+      ops::MatMul(s.WithOpName("small_matmul"), lhs, small_weights);
+  auto fetch = ops::Identity(s.WithOpName("fetch"), bias_add);
+  auto small_fetch = ops::Identity(s.WithOpName("small_fetch"), small_matmul);
+
+  GrapplerItem item;
+  item.fetch = {"fetch", "small_fetch"};
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+  for (int i = 0; i < item.graph.node_size(); ++i) {
+    item.graph.mutable_node(i)->set_device("/device:CPU:0");
+  }
+
+  Remapper optimizer(RewriterConfig::ON);
+  optimizer.set_dynamic_range_quantization(true);
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  int found = 0;
+  for (const NodeDef& node : output.node()) {
+    if (node.name() == "matmul") {
+      // Replaced before it can be fused with the BiasAdd.
+      EXPECT_EQ(node.op(), "_DynamicQuantizedMatMul");
+      ASSERT_EQ(node.input_size(), 2);
+      EXPECT_EQ(node.input(0), "lhs");
+      EXPECT_EQ(node.input(1), "weights");
+      EXPECT_FALSE(node.attr().at("transpose_a").b());
+      EXPECT_FALSE(node.attr().contains("T"));
+      found++;
+    } else if (node.name() == "small_matmul") {
+      EXPECT_EQ(node.op(), "MatMul");
+      found++;
+    } else if (node.name() == "bias_add") {
+      EXPECT_EQ(node.op(), "BiasAdd");
+      found++;
+    }
+  }
+  EXPECT_EQ(found, 3);
+
+  Remapper disabled_optimizer(RewriterConfig::ON);
+  disabled_optimizer.set_dynamic_range_quantization(false);
+  TF_ASSERT_OK(disabled_optimizer.Optimize(nullptr, item, &output));
+  for (const NodeDef& node : output.node()) {
+    EXPECT_NE(node.op(), "_DynamicQuantizedMatMul");
+  }
+}
+
+class RemapperScaledDotProductAttentionTest : public RemapperTest {
+ public:
+  // Builds the attention of Placeholders of shape [2, 4, queries, 8], with a
+  // scale of the query if `scale_query`, or else of the scores, and a mask of
+  // shape `mask_shape` if not empty.
+  void RunTest(bool scale_query, const std::vector<int64_t>& mask_shape,
+               bool expect_fused) {
+    tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+    auto query = ops::Placeholder(s.WithOpName("query"), DT_FLOAT,
+                                  ops::Placeholder::Shape({2, 4, 10, 8}));
+    auto key = ops::Placeholder(s.WithOpName("key"), DT_FLOAT,
+                                ops::Placeholder::Shape({2, 4, 12, 8}));
+    auto value = ops::Placeholder(s.WithOpName("value"), DT_FLOAT,
+                                  ops::Placeholder::Shape({2, 4, 12, 8}));
+    auto scale = ops::Const(s.WithOpName("scale"), 0.35f, {});
+
+    Output scaled_query = query;
+    if (scale_query) {
+      scaled_query = ops::Mul(s.WithOpName("scaled_query"), query, scale);
+    }
+    Output scores = ops::BatchMatMulV2(s.WithOpName("scores"), scaled_query,
+                                       key, ops::BatchMatMulV2::AdjY(true));
+    if (!scale_query) {
+      scores = ops::Mul(s.WithOpName("scaled_scores"), scale, scores);
+    }
+    GrapplerItem item;
+    if (!mask_shape.empty()) {
+      auto mask = ops::Placeholder(
+          s.WithOpName("mask"), DT_FLOAT,
+          ops::Placeholder::Shape(PartialTensorShape(mask_shape)));
+      scores = ops::AddV2(s.WithOpName("masked_scores"), scores, mask);
+      item.feed.push_back(
+          {"mask", GenerateRandomTensor<DT_FLOAT>(TensorShape(mask_shape))});
+    }
+    auto probabilities = ops::Softmax(s.WithOpName("probabilities"), scores);
+    auto attention =
+        ops::BatchMatMulV2(s.WithOpName("attention"), probabilities, value);
+    auto fetch = ops::Identity(s.WithOpName("fetch"), attention);
+
+    item.fetch = {"fetch"};
+    item.feed.push_back(
+        {"query", GenerateRandomTensor<DT_FLOAT>({2, 4, 10, 8})});
+    item.feed.push_back({"key", GenerateRandomTensor<DT_FLOAT>({2, 4, 12, 8})});
+    item.feed.push_back(
+        {"value", GenerateRandomTensor<DT_FLOAT>({2, 4, 12, 8})});
+    TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+    for (int i = 0; i < item.graph.node_size(); ++i) {
+      item.graph.mutable_node(i)->set_device("/device:CPU:0");
+    }
+
+    Remapper optimizer(RewriterConfig::ON);
+    GraphDef output;
+    TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+    int found = 0;
+    for (const NodeDef& node : output.node()) {
+      if (node.name() != "attention") continue;
+      found++;
+      if (!expect_fused) {
+        EXPECT_EQ(node.op(), "BatchMatMulV2");
+        continue;
+      }
+      EXPECT_EQ(node.op(), "_FusedScaledDotProductAttention");
+      ASSERT_EQ(node.input_size(), mask_shape.empty() ? 3 : 4);
+      EXPECT_EQ(node.input(0), "query");
+      EXPECT_EQ(node.input(1), "key");
+      EXPECT_EQ(node.input(2), "value");
+      if (!mask_shape.empty()) EXPECT_EQ(node.input(3), "mask");
+      EXPECT_EQ(node.attr().at("num_args").i(), mask_shape.empty() ? 0 : 1);
+      EXPECT_FLOAT_EQ(node.attr().at("scale").f(), 0.35f);
+    }
+    EXPECT_EQ(found, 1);
+    if (expect_fused) {
+      for (const NodeDef& node : output.node()) {
+        EXPECT_NE(node.op(), "Softmax");
+      }
+    }
+
+    auto tensors_expected = EvaluateNodes(item.graph, item.fetch, item.feed);
+    ASSERT_EQ(tensors_expected.size(), 1);
+    auto tensors = EvaluateNodes(output, item.fetch, item.feed);
+    ASSERT_EQ(tensors.size(), 1);
+    test::ExpectTensorNear<float>(tensors[0], tensors_expected[0], 1e-5);
+  }
+};
+
+TEST_F(RemapperScaledDotProductAttentionTest, ScaledScores) {
+  RunTest(/*scale_query=*/false, /*mask_shape=*/{}, /*expect_fused=*/true);
+}
+
+TEST_F(RemapperScaledDotProductAttentionTest, ScaledQueryWithMask) {
+  RunTest(/*scale_query=*/true, /*mask_shape=*/{2, 1, 1, 12},
+          /*expect_fused=*/true);
+}
+
+TEST_F(RemapperScaledDotProductAttentionTest, MaskOfLowerRank) {
+  RunTest(/*scale_query=*/false, /*mask_shape=*/{10, 12},
+          /*expect_fused=*/true);
+}
+
+TEST_F(RemapperScaledDotProductAttentionTest, MaskBroadcastsScores) {
+  // The Add broadcasts the scores to the shape of the mask.
+  RunTest(/*scale_query=*/false, /*mask_shape=*/{3, 2, 4, 10, 12},
+          /*expect_fused=*/false);
+}
+
 class RemapperFuseMatMulWithBiasTest : public RemapperTest {
  public:
   template <DataType DTYPE>
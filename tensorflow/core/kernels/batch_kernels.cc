@@ -308,6 +308,10 @@ BatchFunctionKernel::BatchFunctionKernel(OpKernelConstruction* c)
   OP_REQUIRES_OK(c,
                  c->GetAttr("mixed_priority_policy", &mixed_priority_policy_));
   OP_REQUIRES_OK(c, c->GetAttr("batch_padding_policy", &batch_padding_policy_));
+  OP_REQUIRES_OK(c,
+                 c->GetAttr("batch_dispatch_policy", &batch_dispatch_policy_));
+  OP_REQUIRES_OK(c, c->GetAttr("low_priority_chunk_size",
+                               &low_priority_chunk_size_));
 
   OP_REQUIRES_OK(c, c->GetAttr("f", &func_));
 
@@ -316,6 +320,18 @@ BatchFunctionKernel::BatchFunctionKernel(OpKernelConstruction* c)
                                  &enable_large_batch_splitting_));
     has_attribute_enable_large_batch_splitting_ = true;
   }
+  if (c->HasAttr("enable_packed_batching")) {
+    OP_REQUIRES_OK(
+        c, c->GetAttr("enable_packed_batching", &enable_packed_batching_));
+  }
+  OP_REQUIRES(c, !(enable_packed_batching_ && enable_large_batch_splitting_),
+              errors::InvalidArgument(
+                  "enable_packed_batching cannot be combined with "
+                  "enable_large_batch_splitting."));
+  OP_REQUIRES(c, !(enable_packed_batching_ && low_priority_chunk_size_ > 0),
+              errors::InvalidArgument(
+                  "enable_packed_batching cannot be combined with "
+                  "low_priority_chunk_size."));
 
   // Helper function `SetAdaptiveBatchSchedulerOptions` calls
   // `OP_REQUIRES_OK`, which exits the current function upon error.
@@ -324,6 +340,18 @@ BatchFunctionKernel::BatchFunctionKernel(OpKernelConstruction* c)
   if (!c->status().ok()) {
     return;
   }
+  OP_REQUIRES(c,
+              !(enable_packed_batching_ &&
+                adaptive_batch_scheduler_options_ != std::nullopt),
+              errors::InvalidArgument("enable_packed_batching is not supported "
+                                      "with the adaptive batch scheduler."));
+  OP_REQUIRES(c,
+              adaptive_batch_scheduler_options_ == std::nullopt ||
+                  batch_dispatch_policy_ ==
+                      serving::kWaitForTimeoutDispatchPolicy,
+              errors::InvalidArgument(
+                  "batch_dispatch_policy ", batch_dispatch_policy_,
+                  " is not supported with the adaptive batch scheduler."));
 
   if (enable_adaptive_batch_threads_) {
     // One scheduler instance contains a couple of queue instances,
@@ -445,6 +473,9 @@ void BatchFunctionKernel::ComputeAsync(OpKernelContext* c, DoneCallback done) {
       if (session_metadata) {
         new_resource->set_session_metadata(*session_metadata);
       }
+      new_resource->set_enable_packed_batching(enable_packed_batching_);
+      new_resource->set_batch_dispatch_policy(batch_dispatch_policy_);
+      new_resource->set_low_priority_chunk_size(low_priority_chunk_size_);
       *r = new_resource.release();
       return absl::OkStatus();
     };
@@ -110,12 +110,15 @@ class BatchFunctionKernel : public AsyncOpKernel {
   int32 low_priority_batch_timeout_micros_;
   int32 low_priority_max_enqueued_batches_;
   std::vector<int32> low_priority_allowed_batch_sizes_;
+  int32 low_priority_chunk_size_;
   std::string mixed_priority_policy_;
   std::string batch_padding_policy_;
+  std::string batch_dispatch_policy_;
   NameAttrList func_;
   absl::optional<FunctionLibraryRuntime::Handle> fhandle_ TF_GUARDED_BY(mu_);
   bool enable_large_batch_splitting_ = false;
   bool has_attribute_enable_large_batch_splitting_ = false;
+  bool enable_packed_batching_ = false;
   bool enable_adaptive_batch_threads_ = false;
 
   mutex mu_;
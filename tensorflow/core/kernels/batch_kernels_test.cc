@@ -746,5 +746,190 @@ INSTANTIATE_TEST_SUITE_P(BatchFunctionKernelPaddingTestSuite,
                          ::testing::Values("PAD_UP", "BATCH_DOWN",
                                            "MINIMIZE_TPU_COST_PER_REQUEST"));
 
+class BatchFunctionKernelPackedTestState : public SharedBatchFunctionTestState {
+ public:
+  // Init test fixture with a packed batch kernel instance whose function
+  // returns its input rows, and the end row of every request.
+  absl::Status Init(int max_batch_size,
+                    bool enable_large_batch_splitting = false) {
+    static auto *const cpu_device = []() {
+      auto device =
+          DeviceFactory::NewDevice("CPU", {}, "/job:a/replica:0/task:0");
+      return device.release();
+    }();
+    device_ = cpu_device;
+
+    NameAttrList f;
+    f.set_name("PackedFunction");
+    FunctionDef func = FunctionDefHelper::Create(
+        // function_name
+        f.name(),
+        // in_def
+        {"x:int64", "row_splits:int64"},
+        // out_def
+        {"o:int64", "ends:int64"},
+        // attr_def
+        {},
+        // node_def
+        {{{"o"},
+          "EnsureShape",
+          {"x"},
+          {{"T", DataType::DT_INT64},
+           {"shape", TensorShape({max_batch_size, 2})}}},
+         FunctionDefHelper::Const<int64_t>("begin", {{1}}),
+         FunctionDefHelper::Const<int64_t>("size", {{-1}}),
+         {{"ends"},
+          "Slice",
+          {"row_splits", "begin:output:0", "size:output:0"},
+          {{"T", DataType::DT_INT64}, {"Index", DataType::DT_INT64}}}},
+        // ret_def
+        {{"o", "o:output"}, {"ends", "ends:output:0"}});
+    TF_RETURN_IF_ERROR(flib_def_->AddFunctionDef(func));
+    SharedBatchFunctionTestState::CreateFunctionLibraryRuntime();
+
+    std::vector<NodeDefBuilder::NodeOut> inputs(
+        {NodeDefBuilder::NodeOut({"n1", 0, DataType::DT_INT64})});
+    TF_RETURN_IF_ERROR(NodeDefBuilder("PackedBatchFunction", "BatchFunction")
+                           .Attr("max_batch_size", max_batch_size)
+                           .Attr("num_batch_threads", 8)
+                           .Attr("allowed_batch_sizes", std::vector<int>{})
+                           .Attr("batch_timeout_micros", 1000000)
+                           .Attr("max_enqueued_batches", 10)
+                           .Attr("enable_large_batch_splitting",
+                                 enable_large_batch_splitting)
+                           .Attr("enable_packed_batching", true)
+                           .Attr("Tin", {DataType::DT_INT64})
+                           .Input(inputs)
+                           .Attr("Tcaptured", std::vector<DataType>{})
+                           .Input(std::vector<NodeDefBuilder::NodeOut>{})
+                           .Attr("Tout", std::vector<DataType>{DT_INT64,
+                                                               DT_INT64})
+                           .Attr("f", f)
+                           .Finalize(node_def()));
+
+    return OpsTestBase::InitOp();
+  }
+
+  void TestBody() override {}
+};
+
+TEST(BatchFunctionKernelPackedTest, PacksRequestsWithoutPadding) {
+  // Requests of 2 and 3 rows fill a batch of 5 rows. Each receives its own
+  // rows, and the end row of its own request in the packed batch.
+  const std::vector<int64_t> num_rows = {2, 3};
+  tsl::BlockingCounter blocking_counter(num_rows.size());
+  for (int64_t rows : num_rows) {
+    Env::Default()->SchedClosure([&, rows]() {
+      BatchFunctionKernelPackedTestState test_state;
+      TF_CHECK_OK(test_state.Init(/*max_batch_size=*/5));
+      std::vector<int64_t> values(rows * 2, rows);
+      test_state.AddInputFromArray<int64_t>(TensorShape({rows, 2}), values);
+      TF_EXPECT_OK(test_state.RunOpKernel());
+
+      test::ExpectTensorEqual<int64_t>(
+          *test_state.GetOutput(0),
+          test::AsTensor<int64_t>(values, TensorShape({rows, 2})));
+      ASSERT_EQ(test_state.GetOutput(1)->NumElements(), 1);
+      const int64_t end = test_state.GetOutput(1)->flat<int64_t>()(0);
+      EXPECT_TRUE(end == rows || end == 5) << end;
+      blocking_counter.DecrementCount();
+    });
+  }
+  blocking_counter.Wait();
+}
+
+TEST(BatchFunctionKernelPackedTest, RejectsLargeBatchSplitting) {
+  BatchFunctionKernelPackedTestState test_state;
+  EXPECT_EQ(test_state
+                .Init(/*max_batch_size=*/5,
+                      /*enable_large_batch_splitting=*/true)
+                .code(),
+            absl::StatusCode::kInvalidArgument);
+}
+
+#if defined(PLATFORM_GOOGLE)
+class BatchFunctionKernelChunkTestState : public SharedBatchFunctionTestState {
+ public:
+  // Init test fixture with a batch kernel instance that runs low priority
+  // batches in chunks of 2 rows, which its function verifies.
+  absl::Status Init() {
+    static auto *const cpu_device = []() {
+      auto device =
+          DeviceFactory::NewDevice("CPU", {}, "/job:a/replica:0/task:0");
+      return device.release();
+    }();
+    device_ = cpu_device;
+
+    NameAttrList f;
+    f.set_name("ChunkFunction");
+    FunctionDef func = FunctionDefHelper::Create(
+        // function_name
+        f.name(),
+        // in_def
+        {"x:int64"},
+        // out_def
+        {"o:int64"},
+        // attr_def
+        {},
+        // node_def
+        {{{"o"},
+          "EnsureShape",
+          {"x"},
+          {{"T", DataType::DT_INT64}, {"shape", TensorShape({2, 2})}}}},
+        // ret_def
+        {{"o", "o:output"}});
+    TF_RETURN_IF_ERROR(flib_def_->AddFunctionDef(func));
+    SharedBatchFunctionTestState::CreateFunctionLibraryRuntime();
+
+    std::vector<NodeDefBuilder::NodeOut> inputs(
+        {NodeDefBuilder::NodeOut({"n1", 0, DataType::DT_INT64})});
+    TF_RETURN_IF_ERROR(
+        NodeDefBuilder("ChunkBatchFunction", "BatchFunction")
+            .Attr("max_batch_size", 4)
+            .Attr("num_batch_threads", 2)
+            .Attr("batch_timeout_micros", 1000000)
+            .Attr("max_enqueued_batches", 10)
+            .Attr("low_priority_max_batch_size", 4)
+            .Attr("low_priority_batch_timeout_micros", 1000000)
+            .Attr("low_priority_max_enqueued_batches", 2)
+            .Attr("mixed_priority_policy", serving::kPriorityIsolationAttrValue)
+            .Attr("low_priority_chunk_size", 2)
+            .Attr("Tin", {DataType::DT_INT64})
+            .Input(inputs)
+            .Attr("Tcaptured", std::vector<DataType>{})
+            .Input(std::vector<NodeDefBuilder::NodeOut>{})
+            .Attr("Tout", std::vector<DataType>{DT_INT64})
+            .Attr("f", f)
+            .Finalize(node_def()));
+
+    return OpsTestBase::InitOp();
+  }
+
+  void TestBody() override {}
+};
+
+TEST(BatchFunctionKernelChunkTest, RunsLowPriorityBatchInChunks) {
+  // 4 sheddable requests of 1 row form a low priority batch of 4 rows, which
+  // runs in 2 chunks. Each request still receives its own row.
+  tsl::BlockingCounter blocking_counter(4);
+  for (int64_t i = 0; i < 4; ++i) {
+    Env::Default()->SchedClosure([&, i]() {
+      tsl::criticality::ScopedCriticality scoped_criticality(
+          tsl::criticality::Criticality::kSheddable);
+      BatchFunctionKernelChunkTestState test_state;
+      TF_CHECK_OK(test_state.Init());
+      test_state.AddInputFromList<int64_t>(TensorShape({1, 2}), {i, i});
+      TF_EXPECT_OK(test_state.RunOpKernel());
+
+      test::ExpectTensorEqual<int64_t>(
+          *test_state.GetOutput(0),
+          test::AsTensor<int64_t>({i, i}, TensorShape({1, 2})));
+      blocking_counter.DecrementCount();
+    });
+  }
+  blocking_counter.Wait();
+}
+#endif
+
 }  // namespace
 }  // namespace tensorflow
@@ -16,6 +16,8 @@ limitations under the License.
 // Benchmarks for performance (throughput and latency) of BasicBatchScheduler
 // under various rates of task injection.
 
+#include <memory>
+
 #include "tensorflow/core/kernels/batching_util/basic_batch_scheduler.h"
 #include "tensorflow/core/lib/histogram/histogram.h"
 #include "tensorflow/core/platform/init_main.h"
@@ -330,6 +332,46 @@ BENCHMARK(ThroughputBM)
     ->ArgNames({"timeout", "batch_threads"})
     ->ArgsProduct({{0, 2, 10}, {1, 4, 8, 16}});
 
+// Measures the throughput of Schedule() alone when many request threads
+// enqueue into the same scheduler, i.e. the contention on its enqueue path.
+// Unlike ThroughputBM, the time to process the tasks is not measured.
+void ContendedEnqueueBM(::testing::benchmark::State& state) {
+  static std::unique_ptr<ThroughputBenchmark> bm;
+  if (state.thread_index() == 0) {
+    BasicBatchScheduler<BenchmarkBatchTask>::Options scheduler_options;
+    scheduler_options.max_batch_size = state.range(0);
+    scheduler_options.batch_timeout_micros = 1000;
+    scheduler_options.num_batch_threads = 4;
+    scheduler_options.max_enqueued_batches = INT_MAX;  // Unbounded queue.
+    bm.reset(new ThroughputBenchmark(scheduler_options));
+  }
+
+  const int kNumTasksPerIteration = 10 * 1000;
+
+  for (auto s : state) {
+    for (int j = 0; j < kNumTasksPerIteration; ++j) {
+      auto task = std::make_unique<BenchmarkBatchTask>();
+      TF_CHECK_OK(bm->GetScheduler()->Schedule(&task));
+    }
+  }
+
+  if (state.thread_index() == 0) {
+    // Wait for the scheduler to process all tasks, outside of the timing.
+    bm->ResetScheduler();
+    bm.reset();
+  }
+  state.SetItemsProcessed(state.iterations() * kNumTasksPerIteration);
+}
+BENCHMARK(ContendedEnqueueBM)
+    ->UseRealTime()
+    ->Threads(1)
+    ->Threads(16)
+    ->Threads(64)
+    ->ArgNames({"max_batch_size"})
+    ->Args({1})
+    ->Args({32})
+    ->Args({256});
+
 // Latency benchmark is a long running fixed interval (by time) benchmark and is
 // run once (see ->Iterations(1) below). We measure and report latency over this
 // fixed interval.
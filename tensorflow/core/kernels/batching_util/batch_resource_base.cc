@@ -27,6 +27,7 @@ limitations under the License.
 #include <utility>
 #include <vector>
 
+#include "absl/algorithm/container.h"
 #include "absl/container/fixed_array.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/functional/bind_front.h"
@@ -68,6 +69,7 @@ limitations under the License.
 #include "tensorflow/core/platform/env_time.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/notification.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/profiler/lib/traceme.h"
@@ -214,6 +216,17 @@ void RecordBatchDelayUsV2(int64_t batch_delay_us, const string& model_name,
       ->Add(static_cast<double>(batch_delay_us));
 }
 
+void RecordLowPriorityChunkWaitUs(int64_t wait_us, const string& model_name,
+                                  const string& op_name) {
+  static auto* cell = tensorflow::monitoring::Sampler<2>::New(
+      {"/tensorflow/serving/batching/low_priority_chunk_wait_us",
+       "Tracks the time (in microseconds) chunks of low priority batches wait "
+       "for running high priority batches by model_name (if available).",
+       "model_name", "op_name"},
+      monitoring::Buckets::Exponential(1, 2, 27));
+  cell->GetCell(model_name, op_name)->Add(static_cast<double>(wait_us));
+}
+
 void RecordBatchParamBatchTimeoutMicros(int64_t batch_timeout_micros,
                                         const string& model_name,
                                         const string& op_name) {
@@ -351,16 +364,28 @@ Status BatchResourceBase::RegisterWarmupInputs(
     (*batch_task)->status = shared_status;
     return batch_task;
   };
+  // Besides the allowed batch sizes, warm up the batch sizes a previous load
+  // of the model processed, which matters when any batch size is allowed.
+  std::vector<int32> warmup_batch_sizes = allowed_batch_sizes_;
+  const int32 max_batch_size =
+      batcher_ ? batcher_queue_options_.input_batch_size_limit
+               : adaptive_batcher_queue_options_.max_batch_size;
+  for (int32 batch_size : GetObservedWarmupBatchSizes(context)) {
+    if (batch_size <= max_batch_size &&
+        !absl::c_linear_search(warmup_batch_sizes, batch_size)) {
+      warmup_batch_sizes.push_back(batch_size);
+    }
+  }
   auto warmup_counter =
-      std::make_shared<absl::BlockingCounter>(allowed_batch_sizes_.size());
+      std::make_shared<absl::BlockingCounter>(warmup_batch_sizes.size());
   // Enqueue warmup batches.
-  for (int i = 0; i < allowed_batch_sizes_.size(); ++i) {
+  for (int i = 0; i < warmup_batch_sizes.size(); ++i) {
     Status status = RegisterInput(
         guid, context, batcher_queue_name, create_batch_task_fn_share_status,
         [warmup_counter = warmup_counter.get()]() {
           warmup_counter->DecrementCount();
         },
-        allowed_batch_sizes_[i]);
+        warmup_batch_sizes[i]);
     if (!status.ok()) return status;
   }
   // Enqueue real batch if the other batches were enqueued successfully.
@@ -705,6 +730,14 @@ Status BatchResourceBase::ConcatInputTensors(
                              context->op_kernel().name());
   RecordBatchSize(batch.size(), GetModelName(context),
                   context->op_kernel().name());
+  if (!just_for_warmup) {
+    // Lets the next load of the model warm up the batch sizes it processes.
+    GlobalBatchStatsRegistry()
+        .model(/* model_name= */ GetModelName(context),
+               /* op_name= */ context->op_kernel().name())
+        .batch_size(padded_batch_size)
+        .RegisterBatch();
+  }
 
   // All tasks should have the same number of input edges.
   const int num_inputs = batch.task(0).inputs.size();
@@ -856,6 +889,25 @@ Status BatchResourceBase::ConcatInputTensors(
   return absl::OkStatus();
 }
 
+Tensor BatchResourceBase::PackedRowSplits(
+    const BatchT& batch,
+    const std::vector<std::unique_ptr<BatchTask>>& unbatched_tasks) const {
+  // A warmup batch only holds padding.
+  const bool just_for_warmup = batch.task(0).forced_warmup_batch_size > 0;
+  const int num_tasks =
+      just_for_warmup ? 0 : batch.num_tasks() + unbatched_tasks.size();
+  Tensor row_splits(DT_INT64, TensorShape({num_tasks + 1}));
+  auto splits = row_splits.vec<int64_t>();
+  splits(0) = 0;
+  for (int i = 0; i < num_tasks; ++i) {
+    const BatchTask& task = i < batch.num_tasks()
+                                ? batch.task(i)
+                                : *unbatched_tasks[i - batch.num_tasks()];
+    splits(i + 1) = splits(i) + task.size();
+  }
+  return row_splits;
+}
+
 Status BatchResourceBase::SplitOutputTensors(
     const std::vector<Tensor>& combined_outputs, BatchT* batch,
     std::vector<std::unique_ptr<BatchTask>>& unbatched_tasks) const {
@@ -899,28 +951,43 @@ Status BatchResourceBase::SplitOutputTensors(
       return errors::FailedPrecondition(
           "Batched output tensor has 0 dimensions");
     }
-    if (output_tensor.shape().dim_size(0) !=
-        static_cast<int64_t>(batch->size() + unbatched_tasks_size +
-                             padding_size)) {
+    // In a packed batch, an output may also hold one row per task.
+    const int64_t num_tasks = batch->num_tasks() + unbatched_tasks.size();
+    const bool row_per_task =
+        enable_packed_batching_ &&
+        output_tensor.shape().dim_size(0) !=
+            static_cast<int64_t>(batch->size() + unbatched_tasks_size +
+                                 padding_size) &&
+        output_tensor.shape().dim_size(0) == num_tasks;
+    if (!row_per_task &&
+        output_tensor.shape().dim_size(0) !=
+            static_cast<int64_t>(batch->size() + unbatched_tasks_size +
+                                 padding_size)) {
       return errors::FailedPrecondition(
           "Batched output tensor's 0th dimension does not equal the sum of "
-          "the 0th dimension sizes of the input tensors");
+          "the 0th dimension sizes of the input tensors",
+          enable_packed_batching_ ? " nor the number of requests" : "");
     }
 
     std::vector<Tensor> split_tensor;
-    const Status split_status = tensor::Split(
-        output_tensor, task_sizes_plus_optional_padding, &split_tensor);
+    const Status split_status =
+        row_per_task
+            ? tensor::Split(output_tensor,
+                            std::vector<int64_t>(num_tasks, 1), &split_tensor)
+            : tensor::Split(output_tensor, task_sizes_plus_optional_padding,
+                            &split_tensor);
     DCHECK(split_status.ok()) << split_status;
     if (!split_status.ok()) {
       return errors::Internal("Tensor split operation failed: ",
                               split_status.message());
     }
-    DCHECK_EQ(split_tensor.size(), task_sizes_plus_optional_padding.size());
-    if (split_tensor.size() != task_sizes_plus_optional_padding.size()) {
+    const size_t expected_splits =
+        row_per_task ? num_tasks : task_sizes_plus_optional_padding.size();
+    DCHECK_EQ(split_tensor.size(), expected_splits);
+    if (split_tensor.size() != expected_splits) {
       return errors::Internal(
           "Tensor split operation did not work as expected; got ",
-          split_tensor.size(), " splits; expected ",
-          task_sizes_plus_optional_padding.size());
+          split_tensor.size(), " splits; expected ", expected_splits);
     }
 
     // Ignore a possible final split_tensors entry containing the padding.
@@ -959,6 +1026,86 @@ void BatchResourceBase::CleanUpFunctionHelper(BatchTask& task,
   task.done_callback();
 }
 
+Status BatchResourceBase::ProcessFuncBatchInChunks(
+    const BatchTask& last_task, const std::vector<Tensor>& concatenated_tensors,
+    std::vector<Tensor>* combined_outputs) const {
+  OpKernelContext* context = last_task.context;
+  const std::string& model_name = GetModelName(context);
+  const std::string& op_name = context->op_kernel().name();
+
+  const int64_t num_rows = concatenated_tensors[0].shape().dim_size(0);
+  std::vector<int64_t> chunk_sizes;
+  for (int64_t start = 0; start < num_rows; start += low_priority_chunk_size_) {
+    chunk_sizes.push_back(
+        std::min<int64_t>(low_priority_chunk_size_, num_rows - start));
+  }
+  std::vector<std::vector<Tensor>> chunk_args(chunk_sizes.size());
+  for (const Tensor& tensor : concatenated_tensors) {
+    std::vector<Tensor> chunks;
+    TF_RETURN_IF_ERROR(Split(context, tensor, chunk_sizes, &chunks));
+    for (int i = 0; i < chunks.size(); ++i) {
+      chunk_args[i].push_back(std::move(chunks[i]));
+    }
+  }
+
+  std::vector<std::vector<Tensor>> chunk_outputs(chunk_sizes.size());
+  for (int i = 0; i < chunk_sizes.size(); ++i) {
+    if (i > 0) {
+      const uint64 wait_start_time = EnvTime::NowMicros();
+      {
+        absl::MutexLock l(&high_priority_mu_);
+        high_priority_mu_.Await(absl::Condition(
+            +[](int* num_running) { return *num_running == 0; },
+            &num_running_high_priority_batches_));
+      }
+      RecordLowPriorityChunkWaitUs(EnvTime::NowMicros() - wait_start_time,
+                                   model_name, op_name);
+    }
+    tsl::profiler::TraceMe trace_me([&] {
+      return tsl::profiler::TraceMeEncode(
+          "ProcessLowPriorityChunk",
+          {{"chunk_index", i}, {"chunk_size", chunk_sizes[i]}});
+    });
+    std::vector<Tensor>& args = chunk_args[i];
+    args.insert(args.end(), last_task.captured_inputs.begin(),
+                last_task.captured_inputs.end());
+    Status chunk_status;
+    Notification chunk_done;
+    ProcessFuncBatchImpl(last_task, args, &chunk_outputs[i],
+                         [&](const Status& run_status) {
+                           chunk_status = run_status;
+                           chunk_done.Notify();
+                         });
+    chunk_done.WaitForNotification();
+    TF_RETURN_IF_ERROR(chunk_status);
+    if (chunk_outputs[i].size() != chunk_outputs[0].size()) {
+      return errors::Internal("Chunk ", i, " of a low priority batch has ",
+                              chunk_outputs[i].size(), " outputs; expected ",
+                              chunk_outputs[0].size());
+    }
+  }
+
+  combined_outputs->reserve(chunk_outputs[0].size());
+  for (int j = 0; j < chunk_outputs[0].size(); ++j) {
+    std::vector<Tensor> to_concatenate;
+    to_concatenate.reserve(chunk_outputs.size());
+    for (int i = 0; i < chunk_outputs.size(); ++i) {
+      const Tensor& output = chunk_outputs[i][j];
+      if (output.dims() == 0 || output.dim_size(0) != chunk_sizes[i]) {
+        return errors::FailedPrecondition(
+            "Output ", j, " of a chunk of a low priority batch has shape ",
+            output.shape().DebugString(), "; expected ", chunk_sizes[i],
+            " rows, one per input row");
+      }
+      to_concatenate.push_back(output);
+    }
+    Tensor combined_output;
+    TF_RETURN_IF_ERROR(Concat(context, to_concatenate, &combined_output));
+    combined_outputs->push_back(std::move(combined_output));
+  }
+  return absl::OkStatus();
+}
+
 void BatchResourceBase::ProcessFuncBatch(
     std::unique_ptr<BatchT> batch,
     std::vector<std::unique_ptr<BatchTask>> unbatched_tasks) const {
@@ -1029,6 +1176,9 @@ void BatchResourceBase::ProcessFuncBatch(
   std::vector<Tensor> combined_outputs;
   std::vector<Tensor> args(concatenated_tensors.begin(),
                            concatenated_tensors.end());
+  if (enable_packed_batching_) {
+    args.push_back(PackedRowSplits(*batch, unbatched_tasks));
+  }
   const auto& captured_inputs =
       batch->task(batch->num_tasks() - 1).captured_inputs;
   args.insert(args.end(), captured_inputs.begin(), captured_inputs.end());
@@ -1042,11 +1192,35 @@ void BatchResourceBase::ProcessFuncBatch(
                          model_name, last_task_context->op_kernel().name(),
                          processed_size);
   }
+  if (low_priority_chunk_size_ > 0 && IsLowPriorityBatch(*batch) &&
+      last_task.forced_warmup_batch_size == 0 &&
+      !concatenated_tensors.empty() &&
+      concatenated_tensors[0].shape().dim_size(0) > low_priority_chunk_size_) {
+    // `finally` reports the status once all the chunks have run.
+    status = ProcessFuncBatchInChunks(last_task, concatenated_tensors,
+                                      &combined_outputs);
+    if (status.ok()) {
+      status =
+          SplitOutputTensors(combined_outputs, batch.get(), unbatched_tasks);
+    }
+    return;
+  }
+  const bool count_high_priority_batch =
+      low_priority_chunk_size_ > 0 && !IsLowPriorityBatch(*batch);
+  if (count_high_priority_batch) {
+    absl::MutexLock l(&high_priority_mu_);
+    ++num_running_high_priority_batches_;
+  }
+
   // Releases the cleanup method here, because the callback of the function
   // library runtime will handle it now.
   finally.release();
   ProcessFuncBatchImpl(
       last_task, args, &combined_outputs, [&](const Status& run_status) {
+        if (count_high_priority_batch) {
+          absl::MutexLock l(&high_priority_mu_);
+          --num_running_high_priority_batches_;
+        }
         Status final_status;
         auto run_finally = gtl::MakeCleanup([&]() {
           // We do the cleanup here as an optimization, so that
@@ -1208,6 +1382,8 @@ Status BatchResourceBase::LookupOrCreateBatcherQueue(const string& queue_name,
     BatcherT::QueueOptions batcher_queue_options = batcher_queue_options_;
     batcher_queue_options.model_batch_stats = &GlobalBatchStatsRegistry().model(
         /* model_name= */ model_name, /* op_name= */ op_name);
+    batcher_queue_options.scheduling_metrics_label =
+        absl::StrCat(model_name, ":", op_name);
 
     TF_RETURN_IF_ERROR(batcher_->AddQueue(
         batcher_queue_options,
@@ -27,6 +27,7 @@ limitations under the License.
 #include "absl/strings/str_join.h"
 #include "absl/strings/string_view.h"
 #include "absl/synchronization/blocking_counter.h"
+#include "absl/synchronization/mutex.h"
 #include "tensorflow/core/common_runtime/cost_measurement_registry.h"
 #include "tensorflow/core/common_runtime/request_cost.h"
 #include "tensorflow/core/framework/op_kernel.h"
@@ -186,6 +187,30 @@ class BatchResourceBase : public ResourceBase {
 
   const SessionMetadata& session_metadata() const { return session_metadata_; }
 
+  // See the 'enable_packed_batching' attr of the BatchFunction op.
+  void set_enable_packed_batching(bool enable_packed_batching) {
+    enable_packed_batching_ = enable_packed_batching;
+  }
+
+  bool enable_packed_batching() const { return enable_packed_batching_; }
+
+  // If positive, the batch function runs on low priority batches of more rows
+  // than this in chunks of this many rows, one after the other. Before each
+  // chunk but the first, it waits until no high priority batch of this
+  // resource is running, so that long low priority batches give way to high
+  // priority ones at chunk boundaries. The outputs of the function must hold
+  // one row per input row.
+  void set_low_priority_chunk_size(int32_t low_priority_chunk_size) {
+    low_priority_chunk_size_ = low_priority_chunk_size;
+  }
+
+  // Sets the batch_dispatch_policy of the batcher queues, which must not have
+  // been created yet.
+  void set_batch_dispatch_policy(absl::string_view batch_dispatch_policy) {
+    batcher_queue_options_.batch_dispatch_policy =
+        std::string(batch_dispatch_policy);
+  }
+
   using CreateBatchTaskFn =
       std::function<StatusOr<std::unique_ptr<BatchTask>>()>;
 
@@ -308,10 +333,24 @@ class BatchResourceBase : public ResourceBase {
       OpKernelContext* context,
       std::vector<Tensor>* concatenated_tensors) const;
 
+  // Returns the row splits of the tasks within the concatenated input tensors
+  // of a packed batch, i.e. the extra argument of the batch function.
+  Tensor PackedRowSplits(
+      const BatchT& batch,
+      const std::vector<std::unique_ptr<BatchTask>>& unbatched_tasks) const;
+
   Status SplitOutputTensors(
       const std::vector<Tensor>& combined_outputs, BatchT* batch,
       std::vector<std::unique_ptr<BatchTask>>& unbatched_tasks) const;
 
+  // Runs the batch function on the `concatenated_tensors` of a low priority
+  // batch in chunks of `low_priority_chunk_size_` rows, and concatenates the
+  // outputs of the chunks into `combined_outputs`.
+  Status ProcessFuncBatchInChunks(
+      const BatchTask& last_task,
+      const std::vector<Tensor>& concatenated_tensors,
+      std::vector<Tensor>* combined_outputs) const;
+
   void ProcessFuncBatch(
       std::unique_ptr<BatchT> batch,
       std::vector<std::unique_ptr<BatchTask>> unbatched_tasks = {}) const;
@@ -347,10 +386,19 @@ class BatchResourceBase : public ResourceBase {
                                     BatcherQueueT** queue);
 
   SessionMetadata session_metadata_;
+  bool enable_packed_batching_ = false;
 
   absl::Mutex outstanding_batch_mu_;
   int num_outstanding_batched_items_ TF_GUARDED_BY(outstanding_batch_mu_) = 0;
 
+  // See set_low_priority_chunk_size().
+  int32_t low_priority_chunk_size_ = 0;
+  // The number of high priority batches running the batch function, counted
+  // only if `low_priority_chunk_size_` is positive.
+  mutable absl::Mutex high_priority_mu_;
+  mutable int num_running_high_priority_batches_
+      TF_GUARDED_BY(high_priority_mu_) = 0;
+
   // True if user specified a batch processing function for this resource.
   const bool has_process_batch_function_;
   // A batch scheduler, and options for creating queues.
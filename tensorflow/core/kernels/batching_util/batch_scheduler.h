@@ -318,8 +318,12 @@ class Batch {
   // The tasks in the batch.
   std::vector<std::unique_ptr<TaskType>> tasks_ TF_GUARDED_BY(mu_);
 
-  // The sum of the sizes of the tasks in 'tasks_'.
-  size_t size_ TF_GUARDED_BY(mu_) = 0;
+  // The sum of the sizes of the tasks in 'tasks_', and their number. Written
+  // under 'mu_', but read without it: the scheduler reads them several times
+  // per enqueued task while holding its own queue lock, and request threads
+  // would otherwise contend on 'mu_' with the batch threads as well.
+  std::atomic<size_t> size_ TF_GUARDED_BY(mu_){0};
+  std::atomic<int> num_tasks_ TF_GUARDED_BY(mu_){0};
 
   std::atomic<bool> empty_ TF_GUARDED_BY(mu_){true};
 
@@ -409,8 +413,10 @@ void Batch<TaskType>::AddTask(std::unique_ptr<TaskType> task) {
   DCHECK(!IsClosed());
   {
     mutex_lock l(mu_);
-    size_ += task->size();
+    size_.store(size_.load(std::memory_order_relaxed) + task->size(),
+                std::memory_order_release);
     tasks_.push_back(std::move(task));
+    num_tasks_.store(tasks_.size(), std::memory_order_release);
     empty_.store(false);
   }
 }
@@ -420,7 +426,8 @@ std::vector<std::unique_ptr<TaskType>> Batch<TaskType>::RemoveAllTasks() {
   DCHECK(IsClosed());
   {
     mutex_lock l(mu_);
-    size_ = 0;
+    size_.store(0, std::memory_order_release);
+    num_tasks_.store(0, std::memory_order_release);
     empty_.store(true);
     std::vector<std::unique_ptr<TaskType>> tasks_to_return;
 
@@ -438,8 +445,10 @@ std::unique_ptr<TaskType> Batch<TaskType>::RemoveTask() {
       return nullptr;
     }
     std::unique_ptr<TaskType> task = std::move(tasks_.back());
-    size_ -= task->size();
+    size_.store(size_.load(std::memory_order_relaxed) - task->size(),
+                std::memory_order_release);
     tasks_.pop_back();
+    num_tasks_.store(tasks_.size(), std::memory_order_release);
     if (tasks_.empty()) {
       empty_.store(true);
     }
@@ -448,11 +457,8 @@ std::unique_ptr<TaskType> Batch<TaskType>::RemoveTask() {
 }
 
 template <typename TaskType>
-int Batch<TaskType>::num_tasks() const {
-  {
-    mutex_lock l(mu_);
-    return tasks_.size();
-  }
+int Batch<TaskType>::num_tasks() const TF_NO_THREAD_SAFETY_ANALYSIS {
+  return num_tasks_.load(std::memory_order_acquire);
 }
 
 template <typename TaskType>
@@ -486,11 +492,8 @@ TaskType* Batch<TaskType>::mutable_task(int i) {
 }
 
 template <typename TaskType>
-size_t Batch<TaskType>::size() const {
-  {
-    mutex_lock l(mu_);
-    return size_;
-  }
+size_t Batch<TaskType>::size() const TF_NO_THREAD_SAFETY_ANALYSIS {
+  return size_.load(std::memory_order_acquire);
 }
 
 template <typename TaskType>
@@ -518,7 +521,7 @@ void Batch<TaskType>::TryTrimToNewSize(
     int new_size, std::vector<std::unique_ptr<TaskType>>& out_trimmed_tasks) {
   mutex_lock l(mu_);
   DCHECK_GT(new_size, 0);
-  DCHECK_LT(new_size, size_);
+  DCHECK_LT(new_size, size_.load(std::memory_order_relaxed));
   DCHECK(out_trimmed_tasks.empty());
 
   // Index of the first task to trim away. It is possible that it is the index
@@ -549,7 +552,8 @@ void Batch<TaskType>::TryTrimToNewSize(
   std::move(tasks_.begin() + first_task_to_move, tasks_.end(),
             std::back_inserter(out_trimmed_tasks));
   tasks_.resize(first_task_to_move);
-  size_ = new_size;
+  num_tasks_.store(tasks_.size(), std::memory_order_release);
+  size_.store(new_size, std::memory_order_release);
 }
 
 }  // namespace serving
@@ -62,6 +62,22 @@ inline constexpr absl::string_view kPadUpPolicy = "PAD_UP";
 inline constexpr absl::string_view kMinimizeTpuCostPerRequestPolicy =
     "MINIMIZE_TPU_COST_PER_REQUEST";
 
+// Constants containing possible values for the batch_dispatch_policy option of
+// a batch scheduler queue. It decides when a batch that is not full yet is
+// dispatched to a batch thread:
+//
+//   - WAIT_FOR_TIMEOUT: once its oldest task has waited for
+//     batch_timeout_micros.
+//   - PREDICT_ARRIVALS: like WAIT_FOR_TIMEOUT, but also as soon as, given the
+//     recent arrival rate of tasks, less than one more task is expected to
+//     arrive before that timeout. Waiting would then add latency to the tasks
+//     of the batch with little chance of making it any larger.
+//
+inline constexpr absl::string_view kWaitForTimeoutDispatchPolicy =
+    "WAIT_FOR_TIMEOUT";
+inline constexpr absl::string_view kPredictArrivalsDispatchPolicy =
+    "PREDICT_ARRIVALS";
+
 // Trims the batch to the next allowed batch size when possible and when
 // configured by batch_padding_policy.
 //
@@ -50,6 +50,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_KERNELS_BATCHING_UTIL_BATCH_STATS_H_
 #define TENSORFLOW_CORE_KERNELS_BATCHING_UTIL_BATCH_STATS_H_
 
+#include <algorithm>
 #include <atomic>
 #include <cstdint>
 #include <optional>
@@ -115,6 +116,63 @@ class CostTracker {
   absl::Duration sample_sum_ TF_GUARDED_BY(mu_);
 };
 
+// Tracks the rate at which tasks arrive, as an exponential moving average of
+// the time between consecutive arrivals.
+//
+// Thread-safe.
+class ArrivalRateTracker {
+ public:
+  // Registers the arrival of a task at `now_micros`.
+  void Register(uint64 now_micros) {
+    // The weight of the latest gap in the average; the average mostly
+    // reflects the last ten or so arrivals, which lets it follow bursts.
+    constexpr double kSmoothing = 0.2;
+
+    mutex_lock l(mu_);
+    if (num_arrivals_ > 0 && now_micros >= last_arrival_micros_) {
+      const double gap_micros =
+          static_cast<double>(now_micros - last_arrival_micros_);
+      mean_gap_micros_ = num_arrivals_ == 1
+                             ? gap_micros
+                             : (1 - kSmoothing) * mean_gap_micros_ +
+                                   kSmoothing * gap_micros;
+    }
+    ++num_arrivals_;
+    last_arrival_micros_ = std::max(last_arrival_micros_, now_micros);
+  }
+
+  // Returns the number of tasks expected to arrive within `duration_micros`
+  // of `now_micros`.
+  //
+  // If the time since the last arrival already exceeds the average gap, it is
+  // used as the gap instead, so that the expectation decays once a burst is
+  // over rather than at the next arrival.
+  //
+  // Returns std::nullopt until two arrivals have been registered.
+  std::optional<double> ExpectedArrivals(uint64 now_micros,
+                                         double duration_micros) const {
+    double gap_micros;
+    {
+      mutex_lock l(mu_);
+      if (num_arrivals_ < 2) return std::nullopt;
+      gap_micros = mean_gap_micros_;
+      if (now_micros > last_arrival_micros_) {
+        gap_micros = std::max(
+            gap_micros, static_cast<double>(now_micros - last_arrival_micros_));
+      }
+    }
+    // Tasks arriving together have no gap; count them one microsecond apart.
+    return duration_micros / std::max(gap_micros, 1.0);
+  }
+
+ private:
+  mutable mutex mu_;
+
+  int64_t num_arrivals_ TF_GUARDED_BY(mu_) = 0;
+  uint64 last_arrival_micros_ TF_GUARDED_BY(mu_) = 0;
+  double mean_gap_micros_ TF_GUARDED_BY(mu_) = 0;
+};
+
 // Tracks statistics for a particular model and batch size.
 //
 // Thread-safe.
@@ -122,8 +180,18 @@ class BatchSizeStats {
  public:
   CostTracker& tpu_cost() { return tpu_cost_; };
 
+  // Registers that a batch of this size has been processed.
+  void RegisterBatch() { num_batches_.fetch_add(1, std::memory_order_relaxed); }
+
+  // Returns the number of batches of this size processed so far.
+  int64_t num_batches() const {
+    return num_batches_.load(std::memory_order_relaxed);
+  }
+
  private:
   CostTracker tpu_cost_;
+
+  std::atomic<int64_t> num_batches_ = 0;
 };
 
 // Tracks statistics for a particular model.
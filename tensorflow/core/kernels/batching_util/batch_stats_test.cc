@@ -148,6 +148,41 @@ TEST(BatchStatsTest, NumBatchThreadsIsCorrect) {
   ASSERT_EQ(stats.num_batch_threads(), 16);
 }
 
+TEST(BatchStatsTest, ArrivalRateTrackerNeedsTwoArrivals) {
+  ArrivalRateTracker tracker;
+  ASSERT_FALSE(tracker.ExpectedArrivals(0, 100).has_value());
+
+  tracker.Register(0);
+  ASSERT_FALSE(tracker.ExpectedArrivals(0, 100).has_value());
+}
+
+TEST(BatchStatsTest, ArrivalRateTrackerExpectedArrivalsAreCorrect) {
+  ArrivalRateTracker tracker;
+  for (uint64 now_micros = 0; now_micros <= 100; now_micros += 10) {
+    tracker.Register(now_micros);
+  }
+
+  // One arrival every 10 microseconds.
+  ASSERT_DOUBLE_EQ(*tracker.ExpectedArrivals(100, 50), 5);
+
+  // Once nothing has arrived for 40 microseconds, the gap is at least that.
+  ASSERT_DOUBLE_EQ(*tracker.ExpectedArrivals(140, 80), 2);
+}
+
+TEST(BatchStatsTest, ArrivalRateTrackerFollowsBursts) {
+  ArrivalRateTracker tracker;
+  tracker.Register(0);
+  tracker.Register(1000);
+  ASSERT_DOUBLE_EQ(*tracker.ExpectedArrivals(1000, 10), 0.01);
+
+  // A burst quickly outweighs the earlier, slow arrival. Simultaneous arrivals
+  // count one microsecond apart.
+  for (int i = 0; i < 50; ++i) {
+    tracker.Register(1000);
+  }
+  ASSERT_DOUBLE_EQ(*tracker.ExpectedArrivals(1000, 10), 10);
+}
+
 }  // namespace
 
 }  // namespace tensorflow::serving
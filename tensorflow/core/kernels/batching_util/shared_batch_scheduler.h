@@ -18,6 +18,7 @@ limitations under the License.
 
 #include <stddef.h>
 
+#include <algorithm>
 #include <atomic>
 #include <cstddef>
 #include <cstdint>
@@ -25,6 +26,8 @@ limitations under the License.
 #include <functional>
 #include <list>
 #include <memory>
+#include <optional>
+#include <string>
 #include <utility>
 #include <variant>
 #include <vector>
@@ -39,6 +42,8 @@ limitations under the License.
 #include "tensorflow/core/kernels/batching_util/periodic_function.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/monitoring/counter.h"
+#include "tensorflow/core/lib/monitoring/sampler.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/env.h"
@@ -67,6 +72,23 @@ class Queue;
 namespace tensorflow {
 namespace serving {
 
+// Determines which queue a batch thread takes its next batch from, among the
+// queues of a SharedBatchScheduler that have a batch ready to be processed.
+enum class QueueSelectionPolicy {
+  // Visit the queues in turn.
+  kRoundRobin,
+  // Take the batch whose oldest task has the earliest deadline, where the
+  // deadline of a task is its enqueue time plus the `latency_slo_micros` of its
+  // queue.
+  kEarliestDeadlineFirst,
+  // Take the batch from the queue that has been charged the least processing
+  // cost so far, with costs divided by the `scheduling_weight` of the queue.
+  // The cost of a batch is estimated from the queue's `model_batch_stats` if
+  // available, and from the measured run time of its previous batches
+  // otherwise.
+  kWeightedFairQueuing,
+};
+
 // A batch scheduler for server instances that service multiple request types
 // (e.g. multiple machine-learned models, or multiple versions of a model served
 // concurrently), or even multiple distinct tasks for a given request. The
@@ -89,8 +111,9 @@ namespace serving {
 // dynamically, to accommodate e.g. versions of a model being brought up and
 // down over the lifetime of a server.
 //
-// The batch thread pool round-robins through the queues, running one batch
-// from a queue and then moving to the next queue. Each queue behaves like a
+// By default the batch thread pool round-robins through the queues, running one
+// batch from a queue and then moving to the next queue. Other policies may be
+// selected with `Options::queue_selection_policy`. Each queue behaves like a
 // BasicBatchScheduler instance, in the sense that it has maximum batch size and
 // timeout parameters, which govern when a batch is eligible to be processed.
 //
@@ -110,10 +133,6 @@ namespace serving {
 // For bulk processing jobs and throughput-oriented benchmarks, you may want to
 // set the maximum queue size to a large value.
 //
-// TODO(b/26539183): Support queue servicing policies other than round-robin.
-// E.g. let each queue specify a "share" (an int >= 1), so e.g. with queues A
-// and B having shares 1 and 2 respectively, the servicing pattern is ABBABB...
-//
 //
 // PERFORMANCE TUNING: See README.md.
 //
@@ -143,6 +162,10 @@ class SharedBatchScheduler
     // The environment to use.
     // (Typically only overridden by test code.)
     Env* env = Env::Default();
+
+    // How batch threads choose the queue to take the next batch from.
+    QueueSelectionPolicy queue_selection_policy =
+        QueueSelectionPolicy::kRoundRobin;
   };
   // Ownership is shared between the caller of Create() and any queues created
   // via AddQueue().
@@ -246,6 +269,11 @@ class SharedBatchScheduler
     // See the documentation for kPadUpPolicy for details.
     string batch_padding_policy = string(kPadUpPolicy);
 
+    // The policy deciding when a batch that is not full is dispatched.
+    //
+    // See the documentation for kWaitForTimeoutDispatchPolicy for details.
+    string batch_dispatch_policy = string(kWaitForTimeoutDispatchPolicy);
+
     // A pointer to a ModelBatchStats instance for this model. To be used for
     // cost-based padding policy selection.
     //
@@ -282,6 +310,20 @@ class SharedBatchScheduler
     // effective only when enable_priority_queue is true.
     MixedPriorityBatchingPolicy mixed_priority_batching_policy =
         MixedPriorityBatchingPolicy::kLowPriorityPaddingWithMaxBatchSize;
+
+    // The latency target for tasks in this queue, used by
+    // QueueSelectionPolicy::kEarliestDeadlineFirst. If zero,
+    // `batch_timeout_micros` is used instead. Must be non-negative.
+    int64_t latency_slo_micros = 0;
+
+    // The share of batch thread time given to this queue relative to the other
+    // queues under QueueSelectionPolicy::kWeightedFairQueuing. Must be
+    // positive.
+    double scheduling_weight = 1.0;
+
+    // If non-empty, per-queue scheduling metrics (queueing delay and latency
+    // SLO misses) are exported with this value as the `queue` label.
+    string scheduling_metrics_label;
   };
   // This method is marked virtual for testing purposes only.
   virtual Status AddQueue(const QueueOptions& options,
@@ -296,6 +338,14 @@ class SharedBatchScheduler
                               BatchUniquePtr* batch_to_process_out)
       TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
+  // Implements `GetNextWorkItem_Locked()` for queue selection policies other
+  // than round-robin. Asks the queue that ranks first under the policy for a
+  // batch. Leaves `*batch_to_process_out` empty if no queue has a batch ready,
+  // or if the chosen queue declines to schedule one.
+  void GetNextWorkItemByPolicy_Locked(
+      internal::Queue<TaskType>** queue_for_batch_out,
+      BatchUniquePtr* batch_to_process_out) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
   // The code executed in 'batch_threads_'. Obtains a batch to process from the
   // queue pointed to by 'next_queue_to_schedule_', and processes it. If that
   // queue declines to provide a batch to process, moves onto the next queue. If
@@ -309,6 +359,8 @@ class SharedBatchScheduler
 
   static bool BatchExists(const BatchUniquePtr& batch_to_process);
 
+  static size_t BatchSize(const BatchUniquePtr& batch_to_process);
+
   const Options options_;
 
   mutex mu_;
@@ -327,6 +379,12 @@ class SharedBatchScheduler
   // available batch thread should grab work.
   typename QueueList::iterator next_queue_to_schedule_ TF_GUARDED_BY(mu_);
 
+  // The virtual time of the queue that was served last, used by
+  // QueueSelectionPolicy::kWeightedFairQueuing. A queue that has been idle is
+  // not charged less than this, so that it cannot monopolize the batch threads
+  // to catch up once it becomes busy again.
+  double system_virtual_time_ TF_GUARDED_BY(mu_) = 0;
+
   // Used by idle batch threads to wait for work to enter the system. Notified
   // whenever a batch becomes schedulable.
   condition_variable schedulable_batch_cv_;
@@ -430,6 +488,29 @@ class Queue {
   std::vector<std::unique_ptr<TaskType>> GetLowPriorityTasksForPadding(
       size_t batch_size);
 
+  // Returns the enqueue time of the oldest task in the batch that
+  // ScheduleBatch() would return if called now, or nullopt if it would return
+  // nullptr. The answer may be stale by the time ScheduleBatch() is called.
+  std::optional<uint64> SchedulableBatchStartTimeMicros() const;
+
+  // Returns the deadline of a task enqueued at `start_time_micros`, for
+  // QueueSelectionPolicy::kEarliestDeadlineFirst.
+  uint64 DeadlineMicros(uint64 start_time_micros) const {
+    return start_time_micros + latency_slo_micros();
+  }
+
+  // Returns an estimate of the time in microseconds to process a batch of
+  // the given size.
+  double EstimatedBatchCostMicros(size_t batch_size) const;
+
+  double scheduling_weight() const { return options_.scheduling_weight; }
+
+  // The weighted cost charged to this queue so far under
+  // QueueSelectionPolicy::kWeightedFairQueuing. Only accessed by the
+  // scheduler, under the scheduler's mutex.
+  double virtual_time() const { return virtual_time_; }
+  void set_virtual_time(double virtual_time) { virtual_time_ = virtual_time; }
+
   // Processes a batch that has been returned earlier by ScheduleBatch().
   void ProcessBatch(std::unique_ptr<Batch<TaskType>> batch,
                     std::vector<std::unique_ptr<TaskType>> padding_task);
@@ -463,6 +544,19 @@ class Queue {
   // Same as IsEmpty(), but assumes the caller already holds a lock on 'mu_'.
   bool IsEmptyInternal() const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
+  int64_t latency_slo_micros() const {
+    return options_.latency_slo_micros > 0 ? options_.latency_slo_micros
+                                           : options_.batch_timeout_micros;
+  }
+
+  // Pops the start time of the front-most closed batch, which is about to be
+  // scheduled, and records the scheduling metrics of the batch.
+  void OnCloseBatchScheduled() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Records the scheduling metrics of a batch whose oldest task was enqueued at
+  // `start_time_micros`.
+  void RecordSchedulingMetrics(uint64 start_time_micros) const;
+
   // Returns true iff the task is a low priority task based on the queue option.
   bool IsLowPriorityTask(std::unique_ptr<TaskType>* task);
 
@@ -486,14 +580,21 @@ class Queue {
   // 'high_priority_batches_' is currently schedulable.
   bool IsOpenBatchSchedulable() const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
+  // Returns true if the non-empty open batch should be dispatched before its
+  // timeout, as decided by `options_.batch_dispatch_policy`.
+  bool ShouldDispatchOpenBatchEarly() const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
   // A variant of `IsOpenBatchSchedulable`; used when batches are formed at
   // task enqueue time, and open batch is `high_priority_batches_.back()`.
   bool IsOpenBatchSchedulableAfterEagerSplit() const
       TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
   // Determines whether the low priority tasks in `low_priority_tasks_` can form
-  // a batch on their own. If yes, returns a batch that is ready to be
-  // processed. Otherwise, returns an empty unique_ptr.
+  // a batch on their own.
+  bool IsLowPriorityBatchSchedulable() const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // If IsLowPriorityBatchSchedulable(), returns a batch of low priority tasks
+  // that is ready to be processed. Otherwise, returns an empty unique_ptr.
   std::unique_ptr<Batch<TaskType>> ScheduleLowPriorityBatch()
       TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
@@ -608,6 +709,23 @@ class Queue {
   // might contain an approximate value (see ScheduleBatchWithEagerSplit).
   uint64 open_batch_start_time_micros_ TF_GUARDED_BY(mu_);
 
+  // The values `open_batch_start_time_micros_` had when each of the closed
+  // batches in `high_priority_batches_` (or `task_handle_batches_`) was
+  // closed, front to back.
+  std::deque<uint64> closed_batch_start_times_micros_ TF_GUARDED_BY(mu_);
+
+  // The arrivals of high priority tasks, registered under the
+  // PREDICT_ARRIVALS batch dispatch policy only.
+  ArrivalRateTracker arrival_rate_;
+
+  // An exponential moving average of the time in microseconds it took to
+  // process one unit of task size, measured in ProcessBatch(). Zero until the
+  // first batch has been processed.
+  double cost_per_task_unit_micros_ TF_GUARDED_BY(mu_) = 0;
+
+  // See virtual_time().
+  double virtual_time_ = 0;
+
   // Whether this queue contains a batch that is eligible to be scheduled.
   // Used to keep track of when to call 'schedulable_batch_callback_'.
   bool schedulable_batch_ TF_GUARDED_BY(mu_) = false;
@@ -734,6 +852,22 @@ Status SharedBatchScheduler<TaskType>::AddQueueAfterRewritingOptions(
         options.enable_large_batch_splitting);
   }
 
+  if (options.batch_dispatch_policy != kWaitForTimeoutDispatchPolicy &&
+      options.batch_dispatch_policy != kPredictArrivalsDispatchPolicy) {
+    return errors::InvalidArgument("Unsupported batch_dispatch_policy: ",
+                                   options.batch_dispatch_policy);
+  }
+
+  if (options.latency_slo_micros < 0) {
+    return errors::InvalidArgument(
+        "latency_slo_micros must be non-negative; was ",
+        options.latency_slo_micros);
+  }
+  if (!(options.scheduling_weight > 0)) {
+    return errors::InvalidArgument("scheduling_weight must be positive; was ",
+                                   options.scheduling_weight);
+  }
+
   if (options.enable_lazy_split && (!options.enable_large_batch_splitting)) {
     return errors::InvalidArgument(
         "enable_lazy_split should be enabled only if "
@@ -763,6 +897,10 @@ Status SharedBatchScheduler<TaskType>::AddQueueAfterRewritingOptions(
                                           internal_queue.get()));
   {
     mutex_lock l(mu_);
+    // A new queue starts at the current virtual time rather than at zero, so
+    // that it gets its fair share but doesn't preempt the existing queues
+    // until it has caught up with them.
+    internal_queue->set_virtual_time(system_virtual_time_);
     queues_.push_back(std::move(internal_queue));
     if (next_queue_to_schedule_ == queues_.end()) {
       next_queue_to_schedule_ = queues_.begin();
@@ -796,10 +934,64 @@ bool SharedBatchScheduler<TaskType>::BatchExists(
   return absl::get<BatchTaskHandleUniquePtr>(batch_to_process) != nullptr;
 }
 
+template <typename TaskType>
+size_t SharedBatchScheduler<TaskType>::BatchSize(
+    const BatchUniquePtr& batch_to_process) {
+  if (absl::holds_alternative<BatchTaskUniqueptr>(batch_to_process)) {
+    return absl::get<BatchTaskUniqueptr>(batch_to_process)->size();
+  }
+  return absl::get<BatchTaskHandleUniquePtr>(batch_to_process)->size();
+}
+
+template <typename TaskType>
+void SharedBatchScheduler<TaskType>::GetNextWorkItemByPolicy_Locked(
+    internal::Queue<TaskType>** queue_for_batch_out,
+    BatchUniquePtr* batch_to_process_out) {
+  const bool weighted_fair_queuing =
+      options_.queue_selection_policy ==
+      QueueSelectionPolicy::kWeightedFairQueuing;
+  internal::Queue<TaskType>* best_queue = nullptr;
+  // The virtual time under weighted fair queuing, or the deadline in
+  // microseconds under earliest deadline first; lower is served first.
+  double best_rank = 0;
+  for (const auto& queue : queues_) {
+    std::optional<uint64> start_time_micros =
+        queue->SchedulableBatchStartTimeMicros();
+    if (!start_time_micros.has_value()) continue;
+    const double rank =
+        weighted_fair_queuing
+            ? std::max(queue->virtual_time(), system_virtual_time_)
+            : static_cast<double>(queue->DeadlineMicros(*start_time_micros));
+    if (best_queue == nullptr || rank < best_rank) {
+      best_queue = queue.get();
+      best_rank = rank;
+    }
+  }
+  if (best_queue == nullptr) return;
+
+  BatchUniquePtr batch_to_process = best_queue->ScheduleBatch();
+  if (!BatchExists(batch_to_process)) return;
+  if (weighted_fair_queuing) {
+    system_virtual_time_ = best_rank;
+    best_queue->set_virtual_time(
+        best_rank +
+        best_queue->EstimatedBatchCostMicros(BatchSize(batch_to_process)) /
+            best_queue->scheduling_weight());
+  }
+  *queue_for_batch_out = best_queue;
+  *batch_to_process_out = std::move(batch_to_process);
+}
+
 template <typename TaskType>
 void SharedBatchScheduler<TaskType>::GetNextWorkItem_Locked(
     internal::Queue<TaskType>** queue_for_batch_out,
     BatchUniquePtr* batch_to_process_out) {
+  if (options_.queue_selection_policy != QueueSelectionPolicy::kRoundRobin) {
+    GetNextWorkItemByPolicy_Locked(queue_for_batch_out, batch_to_process_out);
+    if (BatchExists(*batch_to_process_out)) return;
+    // Otherwise fall through to the round-robin scan, which also drops the
+    // closed queues that have run empty.
+  }
   BatchUniquePtr batch_to_process;
   internal::Queue<TaskType>* queue_for_batch = nullptr;
   const int num_queues = queues_.size();
@@ -953,6 +1145,9 @@ Status Queue<TaskType>::ScheduleWithLazySplit(std::unique_ptr<TaskType>* task) {
     DCHECK(!closed_);
 
     TF_RETURN_IF_ERROR(ValidateBatchTaskQueueCapacity((*task).get()));
+    if (options_.batch_dispatch_policy == kPredictArrivalsDispatchPolicy) {
+      arrival_rate_.Register(env_->NowMicros());
+    }
 
     const int64 open_batch_capacity =
         max_execution_batch_size - this->tail_batch_task_size();
@@ -1080,19 +1275,25 @@ Status Queue<TaskType>::ScheduleWithoutOrEagerSplit(
         {{"batching_input_task_size", (*task)->size()}});
   });
 
+  // Classify the task before taking the queue lock that every request thread
+  // contends on.
+  const bool is_low_priority_task = IsLowPriorityTask(task);
   bool notify_of_schedulable_batch = false;
   {
     mutex_lock l(mu_);
 
     DCHECK(!closed_);
 
-    if (IsLowPriorityTask(task)) {
+    if (is_low_priority_task) {
       // Insert the task to the low priority task queue instead of the high
       // priority batch queue below.
       TF_RETURN_IF_ERROR(ValidateLowPriorityTaskQueueCapacity(**task));
       low_priority_tasks_.AddTask(std::move(*task), env_->NowMicros());
     } else {
       TF_RETURN_IF_ERROR(ScheduleWithoutOrEagerSplitImpl(task));
+      if (options_.batch_dispatch_policy == kPredictArrivalsDispatchPolicy) {
+        arrival_rate_.Register(env_->NowMicros());
+      }
     }
 
     // Check if the batch queue has a schedulable batch and mark it schedulable
@@ -1278,12 +1479,18 @@ Queue<TaskType>::ScheduleBatchWithEagerSplit() {
       // There is at least one closed batch that is ready to be scheduled.
       batch_to_schedule = std::move(batches.front());
       batches.pop_front();
+      OnCloseBatchScheduled();
     }
 
     if (batch_to_schedule == nullptr) {
       // If there was no schedulable batch in the batch queue, try to schedule
       // from the low priority task queue.
+      const std::optional<uint64> low_priority_start_time_micros =
+          low_priority_tasks_.EarliestTaskStartTime();
       batch_to_schedule = ScheduleLowPriorityBatch();
+      if (batch_to_schedule != nullptr) {
+        RecordSchedulingMetrics(*low_priority_start_time_micros);
+      }
     }
 
     if (batch_to_schedule == nullptr) {
@@ -1323,6 +1530,7 @@ Queue<TaskType>::ScheduleBatch() {
       ++num_batches_being_processed_;
       task_handles_to_schedule = std::move(task_handle_batches_.front());
       task_handle_batches_.pop_front();
+      OnCloseBatchScheduled();
     } else {
       schedulable_batch_ = false;
     }
@@ -1383,6 +1591,11 @@ void Queue<TaskType>::ProcessBatch(
       tsl::profiler::ContextType::kSharedBatchScheduler,
       batch->traceme_context_id());
 
+  size_t batch_size = batch->size();
+  for (const std::unique_ptr<TaskType>& task : padding_task) {
+    batch_size += task->size();
+  }
+  const uint64 start_time_micros = env_->NowMicros();
   if (std::holds_alternative<ProcessBatchCallbackWithoutPaddingTasks>(
           process_batch_callback_)) {
     std::get<ProcessBatchCallbackWithoutPaddingTasks>(process_batch_callback_)(
@@ -1391,9 +1604,21 @@ void Queue<TaskType>::ProcessBatch(
     std::get<ProcessBatchCallbackWithPaddingTasks>(process_batch_callback_)(
         std::move(batch), std::move(padding_task));
   }
+  const uint64 end_time_micros = env_->NowMicros();
 
   {
     mutex_lock l(mu_);
+    if (batch_size > 0) {
+      const double cost_per_task_unit_micros =
+          static_cast<double>(end_time_micros - start_time_micros) /
+          batch_size;
+      constexpr double kCostSmoothing = 0.1;
+      cost_per_task_unit_micros_ =
+          cost_per_task_unit_micros_ == 0
+              ? cost_per_task_unit_micros
+              : (1 - kCostSmoothing) * cost_per_task_unit_micros_ +
+                    kCostSmoothing * cost_per_task_unit_micros;
+    }
     --num_batches_being_processed_;
     if (empty_notification_ != nullptr && IsEmptyInternal()) {
       empty_notification_->Notify();
@@ -1437,6 +1662,7 @@ bool Queue<TaskType>::IsEmptyInternal() const {
 
 template <typename TaskType>
 void Queue<TaskType>::StartNewBatch() {
+  closed_batch_start_times_micros_.push_back(open_batch_start_time_micros_);
   if (options_.enable_lazy_split) {
     task_handle_batches_.back()->Close();
     task_handle_batches_.emplace_back(new Batch<BatchInputTaskHandle<TaskType>>(
@@ -1467,7 +1693,8 @@ bool Queue<TaskType>::IsOpenBatchSchedulableAfterEagerSplit() const {
   }
   return closed_ || open_batch->size() >= max_execution_batch_size() ||
          env_->NowMicros() >=
-             open_batch_start_time_micros_ + options_.batch_timeout_micros;
+             open_batch_start_time_micros_ + options_.batch_timeout_micros ||
+         ShouldDispatchOpenBatchEarly();
 }
 
 template <typename TaskType>
@@ -1482,28 +1709,49 @@ bool Queue<TaskType>::IsOpenBatchSchedulable() const {
   }
   return closed_ || open_batch->size() >= max_execution_batch_size() ||
          env_->NowMicros() >=
-             open_batch_start_time_micros_ + options_.batch_timeout_micros;
+             open_batch_start_time_micros_ + options_.batch_timeout_micros ||
+         ShouldDispatchOpenBatchEarly();
 }
 
 template <typename TaskType>
-std::unique_ptr<Batch<TaskType>> Queue<TaskType>::ScheduleLowPriorityBatch() {
-  std::unique_ptr<Batch<TaskType>> batch_to_schedule;
+bool Queue<TaskType>::ShouldDispatchOpenBatchEarly() const {
+  if (options_.batch_dispatch_policy != kPredictArrivalsDispatchPolicy) {
+    return false;
+  }
+  const uint64 now_micros = env_->NowMicros();
+  const uint64 timeout_micros =
+      open_batch_start_time_micros_ + options_.batch_timeout_micros;
+  if (now_micros >= timeout_micros) return true;
+  std::optional<double> expected_arrivals = arrival_rate_.ExpectedArrivals(
+      now_micros, static_cast<double>(timeout_micros - now_micros));
+  // Without an arrival rate yet, wait for the timeout as usual.
+  return expected_arrivals.has_value() && *expected_arrivals < 1.0;
+}
+
+template <typename TaskType>
+bool Queue<TaskType>::IsLowPriorityBatchSchedulable() const {
   if (!options_.enable_priority_queue || low_priority_tasks_.empty()) {
-    // Return early if priority queue is disabled or there is no low priority
-    // task.
-    return batch_to_schedule;
+    // Priority queue is disabled or there is no low priority task.
+    return false;
   }
   if (env_->NowMicros() <
           *low_priority_tasks_.EarliestTaskStartTime() +
               options_.low_priority_queue_options.batch_timeout_micros &&
       low_priority_tasks_.size() <
           options_.low_priority_queue_options.max_execution_batch_size) {
-    // Return early if the low priority tasks can't fill up the max batch size
-    // and the earliest task didn't time out.
-    return batch_to_schedule;
+    // The low priority tasks can't fill up the max batch size and the earliest
+    // task didn't time out.
+    return false;
   }
-  if (!GetBatches().empty() && !GetBatches().front()->empty()) {
-    // Return early if there is a non-empty high priority batch in the queue.
+  // Only schedulable if there is no non-empty high priority batch in the
+  // queue.
+  return GetBatches().empty() || GetBatches().front()->empty();
+}
+
+template <typename TaskType>
+std::unique_ptr<Batch<TaskType>> Queue<TaskType>::ScheduleLowPriorityBatch() {
+  std::unique_ptr<Batch<TaskType>> batch_to_schedule;
+  if (!IsLowPriorityBatchSchedulable()) {
     return batch_to_schedule;
   }
 
@@ -1517,6 +1765,77 @@ std::unique_ptr<Batch<TaskType>> Queue<TaskType>::ScheduleLowPriorityBatch() {
   return batch_to_schedule;
 }
 
+template <typename TaskType>
+std::optional<uint64> Queue<TaskType>::SchedulableBatchStartTimeMicros() const {
+  mutex_lock l(mu_);
+  if (num_enqueued_batches() > 1) {
+    DCHECK(!closed_batch_start_times_micros_.empty());
+    return closed_batch_start_times_micros_.front();
+  }
+  if (IsOpenBatchSchedulable()) {
+    return open_batch_start_time_micros_;
+  }
+  if (!options_.enable_lazy_split && IsLowPriorityBatchSchedulable()) {
+    return low_priority_tasks_.EarliestTaskStartTime();
+  }
+  return std::nullopt;
+}
+
+template <typename TaskType>
+double Queue<TaskType>::EstimatedBatchCostMicros(size_t batch_size) const {
+  if (options_.model_batch_stats != nullptr) {
+    // Costs are registered by the size of the batch after padding.
+    const int32 padded_batch_size = GetNextAllowedBatchSize(
+        batch_size, options_.allowed_batch_sizes, options_.disable_padding);
+    std::optional<absl::Duration> cost =
+        options_.model_batch_stats->batch_size(padded_batch_size)
+            .tpu_cost()
+            .mean();
+    if (cost.has_value()) {
+      return absl::ToDoubleMicroseconds(*cost);
+    }
+  }
+  mutex_lock l(mu_);
+  // Before the first batch has been processed, charge one microsecond per unit
+  // of task size.
+  return batch_size * (cost_per_task_unit_micros_ > 0
+                           ? cost_per_task_unit_micros_
+                           : 1.0);
+}
+
+template <typename TaskType>
+void Queue<TaskType>::OnCloseBatchScheduled() {
+  DCHECK(!closed_batch_start_times_micros_.empty());
+  RecordSchedulingMetrics(closed_batch_start_times_micros_.front());
+  closed_batch_start_times_micros_.pop_front();
+}
+
+template <typename TaskType>
+void Queue<TaskType>::RecordSchedulingMetrics(uint64 start_time_micros) const {
+  if (options_.scheduling_metrics_label.empty()) return;
+  static auto* queueing_delay = monitoring::Sampler<1>::New(
+      {"/tensorflow/serving/batching/shared_batch_scheduler/queueing_delay_us",
+       "Tracks the time from the enqueue of the oldest task of a batch to the "
+       "batch being scheduled, by queue.",
+       "queue"},
+      // 1us to ~1min.
+      monitoring::Buckets::Exponential(1, 2, 27));
+  static auto* slo_misses = monitoring::Counter<1>::New(
+      "/tensorflow/serving/batching/shared_batch_scheduler/latency_slo_misses",
+      "The number of batches whose oldest task waited longer than the latency "
+      "SLO of its queue before being scheduled, by queue.",
+      "queue");
+  const uint64 now_micros = env_->NowMicros();
+  const int64_t delay_micros =
+      now_micros > start_time_micros ? now_micros - start_time_micros : 0;
+  queueing_delay->GetCell(options_.scheduling_metrics_label)
+      ->Add(static_cast<double>(delay_micros));
+  if (options_.latency_slo_micros > 0 &&
+      delay_micros > options_.latency_slo_micros) {
+    slo_misses->GetCell(options_.scheduling_metrics_label)->IncrementBy(1);
+  }
+}
+
 template <typename TaskType>
 size_t Queue<TaskType>::tail_batch_task_size() const {
   if (options_.enable_lazy_split) {
@@ -659,6 +659,57 @@ TEST_P(SharedBatchSchedulerTest, ObeysTimeout) {
   stop_teardown.Notify();
 }
 
+TEST_P(SharedBatchSchedulerTest, PredictArrivalsDispatchesBatchEarly) {
+  test_util::FakeClockEnv env(Env::Default());
+  Notification start_teardown, stop_teardown;
+  std::unique_ptr<Thread> teardown_thread =
+      CreateFakeClockAdvancerThread(&env, &start_teardown, &stop_teardown);
+  {
+    Notification batch_processed;
+    auto callback = [&](std::unique_ptr<Batch<FakeTask>> batch) {
+      ASSERT_TRUE(batch->IsClosed());
+      EXPECT_EQ(batch->num_tasks(), 2);
+      batch_processed.Notify();
+    };
+    auto scheduler = CreateSharedBatchScheduler(1, &env);
+    QueueOptions options = CreateQueueOptions(
+        10 /* max_execution_batch_size */, 10 /* input_batch_size_limit */,
+        1000 /* batch_timeout_micros */, 2 /* max_enqueued_batches */);
+    options.batch_dispatch_policy = string(kPredictArrivalsDispatchPolicy);
+    auto queue = CreateQueue(scheduler, options, callback);
+
+    // Tasks arrive 10 microseconds apart, so the batch keeps waiting for more
+    // while the gap since the last one is small compared to the time left.
+    TF_ASSERT_OK(ScheduleTask(1, queue.get()));
+    env.AdvanceByMicroseconds(10);
+    TF_ASSERT_OK(ScheduleTask(1, queue.get()));
+    env.AdvanceByMicroseconds(400);
+    Env::Default()->SleepForMicroseconds(10 * 1000 /* 10 milliseconds */);
+    EXPECT_FALSE(batch_processed.HasBeenNotified());
+
+    // After 600 microseconds without an arrival, less than one more task is
+    // expected in the 390 microseconds left before the timeout.
+    env.AdvanceByMicroseconds(200);
+    batch_processed.WaitForNotification();
+    start_teardown.Notify();
+  }
+  stop_teardown.Notify();
+}
+
+TEST_P(SharedBatchSchedulerTest, InvalidBatchDispatchPolicy) {
+  auto callback = [](std::unique_ptr<Batch<FakeTask>> batch) {};
+  auto scheduler = CreateSharedBatchScheduler(1);
+  std::unique_ptr<Queue> queue;
+
+  QueueOptions queue_options = CreateQueueOptions(
+      10 /* max_execution_batch_size */, 10 /* input_batch_size_limit */,
+      0 /* batch_timeout_micros */, 1 /* max_enqueued_batches */);
+  queue_options.batch_dispatch_policy = "SOMETIMES";
+  EXPECT_THAT(scheduler->AddQueue(queue_options, callback, &queue),
+              testing::StatusIs(error::INVALID_ARGUMENT,
+                                HasSubstr("batch_dispatch_policy")));
+}
+
 TEST_P(SharedBatchSchedulerTest, ObeysTimeoutWithRealClock) {
   Notification first_batch_processed, second_batch_processed;
   auto callback = [&first_batch_processed, &second_batch_processed](
@@ -807,6 +858,145 @@ TEST_P(SharedBatchSchedulerTest, Fairness) {
   stop_teardown.Notify();
 }
 
+// Creates a single-threaded scheduler with the given queue selection policy,
+// and a queue that records the order in which batches are processed. The
+// first batch of the queue named "blocker" blocks until `unblock` is
+// notified.
+class QueueSelectionPolicyTestHelper {
+ public:
+  QueueSelectionPolicyTestHelper(QueueSelectionPolicy policy, Env* env) {
+    Scheduler::Options options;
+    options.num_batch_threads = 1;
+    options.env = env;
+    options.queue_selection_policy = policy;
+    TF_CHECK_OK(Scheduler::Create(options, &scheduler_));
+  }
+
+  std::unique_ptr<Queue> AddQueue(const string& name,
+                                  QueueOptions queue_options) {
+    return CreateQueue(scheduler_, queue_options,
+                       [this, name](std::unique_ptr<Batch<FakeTask>> batch) {
+                         if (name == "blocker") {
+                           blocker_scheduled_.Notify();
+                           unblock_.WaitForNotification();
+                         }
+                         mutex_lock l(mu_);
+                         processed_.push_back(name);
+                       });
+  }
+
+  void WaitUntilBlockerScheduled() { blocker_scheduled_.WaitForNotification(); }
+  void Unblock() { unblock_.Notify(); }
+
+  std::vector<string> processed() {
+    mutex_lock l(mu_);
+    return processed_;
+  }
+
+ private:
+  std::shared_ptr<Scheduler> scheduler_;
+  Notification blocker_scheduled_;
+  Notification unblock_;
+  mutex mu_;
+  std::vector<string> processed_ TF_GUARDED_BY(mu_);
+};
+
+TEST_P(SharedBatchSchedulerTest, EarliestDeadlineFirst) {
+  test_util::FakeClockEnv env(Env::Default());
+  Notification start_teardown, stop_teardown;
+  std::unique_ptr<Thread> teardown_thread =
+      CreateFakeClockAdvancerThread(&env, &start_teardown, &stop_teardown);
+  {
+    QueueSelectionPolicyTestHelper helper(
+        QueueSelectionPolicy::kEarliestDeadlineFirst, &env);
+    QueueOptions queue_options = CreateQueueOptions(
+        10 /* max_execution_batch_size */, 10 /* input_batch_size_limit */,
+        1000 * 1000 /* batch_timeout_micros */, 100 /* max_enqueued_batches */);
+    std::unique_ptr<Queue> blocker = helper.AddQueue("blocker", queue_options);
+    queue_options.latency_slo_micros = 1000;
+    std::unique_ptr<Queue> relaxed = helper.AddQueue("relaxed", queue_options);
+    queue_options.latency_slo_micros = 10;
+    std::unique_ptr<Queue> urgent = helper.AddQueue("urgent", queue_options);
+
+    TF_ASSERT_OK(ScheduleTask(10, blocker.get()));
+    helper.WaitUntilBlockerScheduled();
+
+    // The batch of the relaxed queue is older, and is next in round-robin
+    // order, but the batch of the urgent queue is due first.
+    TF_ASSERT_OK(ScheduleTask(10, relaxed.get()));
+    env.AdvanceByMicroseconds(1);
+    TF_ASSERT_OK(ScheduleTask(10, urgent.get()));
+    helper.Unblock();
+
+    while (helper.processed().size() < 3) {
+      Env::Default()->SleepForMicroseconds(100);
+    }
+    EXPECT_THAT(helper.processed(),
+                ::testing::ElementsAre("blocker", "urgent", "relaxed"));
+    start_teardown.Notify();
+  }
+  stop_teardown.Notify();
+}
+
+TEST_P(SharedBatchSchedulerTest, WeightedFairQueuing) {
+  test_util::FakeClockEnv env(Env::Default());
+  Notification start_teardown, stop_teardown;
+  std::unique_ptr<Thread> teardown_thread =
+      CreateFakeClockAdvancerThread(&env, &start_teardown, &stop_teardown);
+  {
+    QueueSelectionPolicyTestHelper helper(
+        QueueSelectionPolicy::kWeightedFairQueuing, &env);
+    QueueOptions queue_options = CreateQueueOptions(
+        10 /* max_execution_batch_size */, 10 /* input_batch_size_limit */,
+        1000 * 1000 /* batch_timeout_micros */, 100 /* max_enqueued_batches */);
+    std::unique_ptr<Queue> light = helper.AddQueue("light", queue_options);
+    queue_options.scheduling_weight = 4;
+    std::unique_ptr<Queue> heavy = helper.AddQueue("heavy", queue_options);
+    queue_options.scheduling_weight = 1;
+    std::unique_ptr<Queue> blocker = helper.AddQueue("blocker", queue_options);
+
+    TF_ASSERT_OK(ScheduleTask(10, blocker.get()));
+    helper.WaitUntilBlockerScheduled();
+    for (int i = 0; i < 4; ++i) {
+      TF_ASSERT_OK(ScheduleTask(10, light.get()));
+      TF_ASSERT_OK(ScheduleTask(10, heavy.get()));
+    }
+    helper.Unblock();
+
+    while (helper.processed().size() < 9) {
+      Env::Default()->SleepForMicroseconds(100);
+    }
+    // Batches of equal cost, so the queue with 4x the weight is served 4x as
+    // often.
+    EXPECT_THAT(helper.processed(),
+                ::testing::ElementsAre("blocker", "light", "heavy", "heavy",
+                                       "heavy", "heavy", "light", "light",
+                                       "light"));
+    start_teardown.Notify();
+  }
+  stop_teardown.Notify();
+}
+
+TEST_P(SharedBatchSchedulerTest, InvalidQueueSelectionOptions) {
+  auto callback = [](std::unique_ptr<Batch<FakeTask>> batch) {};
+  auto scheduler = CreateSharedBatchScheduler(1);
+  std::unique_ptr<Queue> queue;
+
+  QueueOptions queue_options = CreateQueueOptions(
+      10 /* max_execution_batch_size */, 10 /* input_batch_size_limit */,
+      0 /* batch_timeout_micros */, 1 /* max_enqueued_batches */);
+  queue_options.scheduling_weight = 0;
+  EXPECT_THAT(scheduler->AddQueue(queue_options, callback, &queue),
+              testing::StatusIs(error::INVALID_ARGUMENT,
+                                HasSubstr("scheduling_weight")));
+
+  queue_options.scheduling_weight = 1;
+  queue_options.latency_slo_micros = -1;
+  EXPECT_THAT(scheduler->AddQueue(queue_options, callback, &queue),
+              testing::StatusIs(error::INVALID_ARGUMENT,
+                                HasSubstr("latency_slo_micros")));
+}
+
 TEST_P(SharedBatchSchedulerTest, ConstMethods) {
   for (const int max_enqueued_batches : {1, 2, 5}) {
     Notification processing, proceed;
@@ -14,18 +14,106 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/kernels/batching_util/warmup.h"
 
+#include <algorithm>
 #include <memory>
 #include <optional>
+#include <string>
+#include <tuple>
 #include <utility>
+#include <vector>
 
 #include "absl/status/status.h"
+#include "absl/strings/numbers.h"
 #include "absl/strings/str_cat.h"
+#include "absl/strings/str_split.h"
+#include "absl/strings/string_view.h"
 #include "absl/synchronization/mutex.h"
 #include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/kernels/batching_util/batch_stats.h"
+#include "tensorflow/core/platform/env.h"
+#include "tsl/platform/errors.h"
 #include "tsl/platform/logging.h"
 
 namespace tensorflow {
 namespace serving {
+namespace {
+
+// The most batch sizes a batch op warms up based on `batch_size_histogram`,
+// besides its allowed batch sizes.
+constexpr int kMaxObservedWarmupBatchSizes = 16;
+
+}  // namespace
+
+BatchSizeHistogram GetBatchSizeHistogram(BatchStatsRegistry& stats,
+                                         const std::string& model_name) {
+  BatchSizeHistogram histogram;
+  for (const auto& [name, op_name] : stats.ModelAndOpNames()) {
+    if (name != model_name) continue;
+    ModelBatchStats& model_stats = stats.model(name, op_name);
+    for (int32 batch_size : model_stats.BatchSizes()) {
+      const int64_t num_batches =
+          model_stats.batch_size(batch_size).num_batches();
+      if (num_batches > 0) {
+        histogram[op_name][batch_size] = num_batches;
+      }
+    }
+  }
+  return histogram;
+}
+
+absl::Status WriteBatchSizeHistogram(const BatchSizeHistogram& histogram,
+                                     const std::string& path) {
+  std::vector<std::tuple<std::string, int32, int64_t>> entries;
+  for (const auto& [op_name, num_batches_by_size] : histogram) {
+    for (const auto& [batch_size, num_batches] : num_batches_by_size) {
+      entries.emplace_back(op_name, batch_size, num_batches);
+    }
+  }
+  std::sort(entries.begin(), entries.end());
+  std::string content;
+  for (const auto& [op_name, batch_size, num_batches] : entries) {
+    absl::StrAppend(&content, op_name, " ", batch_size, " ", num_batches,
+                    "\n");
+  }
+  return WriteStringToFile(Env::Default(), path, content);
+}
+
+absl::StatusOr<BatchSizeHistogram> ReadBatchSizeHistogram(
+    const std::string& path) {
+  std::string content;
+  TF_RETURN_IF_ERROR(ReadFileToString(Env::Default(), path, &content));
+  BatchSizeHistogram histogram;
+  for (absl::string_view line : absl::StrSplit(content, '\n')) {
+    if (line.empty()) continue;
+    std::vector<absl::string_view> fields = absl::StrSplit(line, ' ');
+    int32 batch_size;
+    int64_t num_batches;
+    if (fields.size() != 3 || !absl::SimpleAtoi(fields[1], &batch_size) ||
+        !absl::SimpleAtoi(fields[2], &num_batches) || batch_size <= 0) {
+      return absl::InvalidArgumentError(absl::StrCat(
+          "Malformed line in batch size histogram ", path, ": ", line));
+    }
+    histogram[fields[0]][batch_size] += num_batches;
+  }
+  return histogram;
+}
+
+std::vector<int32> MostFrequentBatchSizes(const BatchSizeHistogram& histogram,
+                                          const std::string& op_name,
+                                          int max_batch_sizes) {
+  auto it = histogram.find(op_name);
+  if (it == histogram.end()) return {};
+  std::vector<std::pair<int64_t, int32>> batch_sizes;
+  for (const auto& [batch_size, num_batches] : it->second) {
+    batch_sizes.emplace_back(-num_batches, batch_size);
+  }
+  std::sort(batch_sizes.begin(), batch_sizes.end());
+  std::vector<int32> result;
+  for (int i = 0; i < batch_sizes.size() && i < max_batch_sizes; ++i) {
+    result.push_back(batch_sizes[i].second);
+  }
+  return result;
+}
 
 void WarmupStateRegistry::Handle::Release() {
   if (!key_.has_value()) {
@@ -78,5 +166,20 @@ bool ShouldWarmupAllBatchSizes(const OpKernelContext* c) {
   return per_model_data && per_model_data->warmup_all_batch_sizes;
 }
 
+std::vector<int32> GetObservedWarmupBatchSizes(const OpKernelContext* c) {
+  auto metadata = c->session_metadata();
+  if (metadata == nullptr || metadata->name().empty()) {
+    return {};
+  }
+  serving::WarmupStateRegistry::Key key(metadata->name(), metadata->version());
+  auto per_model_data = serving::GetGlobalWarmupStateRegistry().Lookup(key);
+  if (per_model_data == nullptr) {
+    return {};
+  }
+  return MostFrequentBatchSizes(per_model_data->batch_size_histogram,
+                                c->op_kernel().name(),
+                                kMaxObservedWarmupBatchSizes);
+}
+
 }  // namespace serving
 }  // namespace tensorflow
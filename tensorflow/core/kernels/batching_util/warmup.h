@@ -20,18 +20,48 @@ limitations under the License.
 #include <optional>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/hash/hash.h"
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/synchronization/mutex.h"
 #include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/kernels/batching_util/batch_stats.h"
+#include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/protobuf/config.pb.h"
 #include "tsl/platform/logging.h"
 
 namespace tensorflow {
 namespace serving {
 
+// The number of batches processed per batch size (after padding), keyed by
+// the name of the batch op. Persisted across loads of a model so that the next
+// load can warm up the batch sizes of its real traffic.
+using BatchSizeHistogram =
+    absl::flat_hash_map<std::string, absl::flat_hash_map<int32, int64_t>>;
+
+// Returns the histogram of the batches processed by the batch ops of the model
+// named `model_name`, as registered in `stats`.
+BatchSizeHistogram GetBatchSizeHistogram(BatchStatsRegistry& stats,
+                                         const std::string& model_name);
+
+// Writes `histogram` to the file at `path`, one "<op name> <batch size>
+// <number of batches>" line per batch size.
+absl::Status WriteBatchSizeHistogram(const BatchSizeHistogram& histogram,
+                                     const std::string& path);
+
+// Reads a histogram written by `WriteBatchSizeHistogram`.
+absl::StatusOr<BatchSizeHistogram> ReadBatchSizeHistogram(
+    const std::string& path);
+
+// Returns the at most `max_batch_sizes` batch sizes of `op_name` with the most
+// batches in `histogram`, most frequent first.
+std::vector<int32> MostFrequentBatchSizes(const BatchSizeHistogram& histogram,
+                                          const std::string& op_name,
+                                          int max_batch_sizes);
+
 // Global registry for model's warm-up states. Before a model executes warm-up
 // requests, it is registered here so that the runtime can distinguish demand
 // requests vs. warm-up requests and apply warm-up specific optimizations.
@@ -59,6 +89,12 @@ class WarmupStateRegistry {
     // for all `allowed_batch_sizes` of that batch op. This removes the
     // need to issue separate warmup requests for each batch size.
     bool warmup_all_batch_sizes = false;
+
+    // The batches a previous load of the model processed, e.g. as read by
+    // `ReadBatchSizeHistogram`. If `warmup_all_batch_sizes` is true, batch
+    // ops also warm up the most frequent batch sizes they processed, which
+    // matters for the ones without `allowed_batch_sizes`.
+    BatchSizeHistogram batch_size_histogram;
   };
 
   // RAII handle for registered models.
@@ -126,6 +162,11 @@ WarmupStateRegistry& GetGlobalWarmupStateRegistry();
 // based on the state of WarmupStateRegistry.
 bool ShouldWarmupAllBatchSizes(const OpKernelContext* c);
 
+// Returns the batch sizes the batch op of `c` should warm up besides its
+// allowed batch sizes, based on the `batch_size_histogram` of its model in
+// WarmupStateRegistry.
+std::vector<int32> GetObservedWarmupBatchSizes(const OpKernelContext* c);
+
 }  // namespace serving
 }  // namespace tensorflow
 
@@ -0,0 +1,91 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/batching_util/warmup.h"
+
+#include <string>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "tensorflow/core/kernels/batching_util/batch_stats.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow::serving {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+using ::testing::Pair;
+using ::testing::UnorderedElementsAre;
+
+TEST(WarmupTest, GetBatchSizeHistogram) {
+  BatchStatsRegistry stats;
+  for (int i = 0; i < 3; ++i) {
+    stats.model("m", "op").batch_size(8).RegisterBatch();
+  }
+  stats.model("m", "op").batch_size(4).RegisterBatch();
+  stats.model("m", "op").batch_size(2).tpu_cost();
+  stats.model("other", "op").batch_size(16).RegisterBatch();
+
+  BatchSizeHistogram histogram = GetBatchSizeHistogram(stats, "m");
+  EXPECT_THAT(histogram,
+              UnorderedElementsAre(Pair(
+                  "op", UnorderedElementsAre(Pair(8, 3), Pair(4, 1)))));
+}
+
+TEST(WarmupTest, WriteAndReadBatchSizeHistogram) {
+  BatchSizeHistogram histogram;
+  histogram["op1"][8] = 3;
+  histogram["op1"][4] = 1;
+  histogram["op2"][32] = 7;
+  const std::string path =
+      io::JoinPath(testing::TmpDir(), "batch_size_histogram");
+
+  TF_ASSERT_OK(WriteBatchSizeHistogram(histogram, path));
+  TF_ASSERT_OK_AND_ASSIGN(BatchSizeHistogram read,
+                          ReadBatchSizeHistogram(path));
+  EXPECT_EQ(read, histogram);
+}
+
+TEST(WarmupTest, ReadMalformedBatchSizeHistogram) {
+  const std::string path =
+      io::JoinPath(testing::TmpDir(), "malformed_batch_size_histogram");
+  TF_ASSERT_OK(WriteStringToFile(Env::Default(), path, "op 8\n"));
+  EXPECT_TRUE(errors::IsInvalidArgument(ReadBatchSizeHistogram(path).status()));
+
+  TF_ASSERT_OK(WriteStringToFile(Env::Default(), path, "op -8 3\n"));
+  EXPECT_TRUE(errors::IsInvalidArgument(ReadBatchSizeHistogram(path).status()));
+}
+
+TEST(WarmupTest, MostFrequentBatchSizes) {
+  BatchSizeHistogram histogram;
+  histogram["op"][8] = 3;
+  histogram["op"][4] = 5;
+  histogram["op"][16] = 3;
+  histogram["op"][32] = 1;
+
+  EXPECT_THAT(MostFrequentBatchSizes(histogram, "op", 3),
+              ElementsAre(4, 8, 16));
+  EXPECT_THAT(MostFrequentBatchSizes(histogram, "op", 10),
+              ElementsAre(4, 8, 16, 32));
+  EXPECT_THAT(MostFrequentBatchSizes(histogram, "unknown", 10), IsEmpty());
+}
+
+}  // namespace
+}  // namespace tensorflow::serving
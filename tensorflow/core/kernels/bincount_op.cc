@@ -15,11 +15,15 @@ limitations under the License.
 
 // See docs in ../ops/math_ops.cc.
 
+#include <algorithm>
 #include <atomic>
+#include <type_traits>
+#include <vector>
 
 #include "tensorflow/core/platform/errors.h"
 #define EIGEN_USE_THREADS
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/strings/str_cat.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/register_types.h"
@@ -30,6 +34,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/util/determinism.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 
@@ -40,6 +45,117 @@ typedef Eigen::GpuDevice GPUDevice;
 
 namespace functor {
 
+namespace {
+
+// The minimum number of values counted by each block of the input.
+constexpr int64_t kMinValuesPerBlock = 1 << 14;
+// The blocks count their values into dense partial bins as long as there are
+// at most this many bins per value of the block, and into hash maps otherwise.
+constexpr int64_t kMaxDenseBinsPerValue = 4;
+
+// Counts the values of `arr` that are less than `num_bins` into `output`,
+// which must be zero, in parallel blocks of the input: each block counts into
+// its own partial bins, then the partial bins are summed in block order. For
+// a given number of threads, the result doesn't depend on the scheduling.
+template <typename Tidx, typename T, bool binary_output>
+Status BincountInBlocks(OpKernelContext* context, const Tidx* arr,
+                        const int64_t arr_size, const T* weights,
+                        const Tidx num_bins,
+                        typename TTypes<T, 1>::Tensor& output) {
+  using Partial = typename std::conditional<binary_output, bool, T>::type;
+  auto count = [&](int64_t i, Partial* bin) {
+    if constexpr (binary_output) {
+      *bin = true;
+    } else {
+      // Complex numbers don't support "++".
+      *bin += weights != nullptr ? weights[i] : T(1);
+    }
+  };
+
+  const DeviceBase::CpuWorkerThreads& worker_threads =
+      *context->device()->tensorflow_cpu_worker_threads();
+  const int64_t num_blocks =
+      std::max<int64_t>(1, std::min<int64_t>(worker_threads.num_threads,
+                                             arr_size / kMinValuesPerBlock));
+  if (num_blocks == 1) {
+    T* output_data = output.data();
+    for (int64_t i = 0; i < arr_size; i++) {
+      const Tidx value = arr[i];
+      if (value < num_bins) {
+        if constexpr (binary_output) {
+          output_data[value] = T(1);
+        } else {
+          count(i, &output_data[value]);
+        }
+      }
+    }
+    return OkStatus();
+  }
+
+  auto block_begin = [&](int64_t block) {
+    return arr_size * block / num_blocks;
+  };
+  const int64_t cost_per_block = 8 * (arr_size / num_blocks);
+  if (num_bins <= kMaxDenseBinsPerValue * (arr_size / num_blocks)) {
+    Tensor partial_bins_t;
+    TF_RETURN_IF_ERROR(context->allocate_temp(
+        DataTypeToEnum<Partial>::value, TensorShape({num_blocks, num_bins}),
+        &partial_bins_t));
+    auto partial_bins = partial_bins_t.matrix<Partial>();
+    partial_bins.device(context->eigen_cpu_device()) =
+        partial_bins.constant(Partial(0));
+    Shard(worker_threads.num_threads, worker_threads.workers, num_blocks,
+          cost_per_block, [&](int64_t start_block, int64_t limit_block) {
+            for (int64_t block = start_block; block < limit_block; ++block) {
+              Partial* bins = &partial_bins(block, 0);
+              for (int64_t i = block_begin(block); i < block_begin(block + 1);
+                   i++) {
+                const Tidx value = arr[i];
+                if (value < num_bins) count(i, &bins[value]);
+              }
+            }
+          });
+
+    // Sum the partial bins along the 0th axis.
+    Eigen::array<int, 1> reduce_dim({0});
+    if constexpr (binary_output) {
+      output.device(context->eigen_cpu_device()) =
+          partial_bins.any(reduce_dim).template cast<T>();
+    } else {
+      output.device(context->eigen_cpu_device()) =
+          partial_bins.sum(reduce_dim);
+    }
+    return OkStatus();
+  }
+
+  // With many more bins than values, only the bins of the values of each
+  // block are kept.
+  std::vector<absl::flat_hash_map<Tidx, Partial>> partial_bins(num_blocks);
+  Shard(worker_threads.num_threads, worker_threads.workers, num_blocks,
+        cost_per_block, [&](int64_t start_block, int64_t limit_block) {
+          for (int64_t block = start_block; block < limit_block; ++block) {
+            absl::flat_hash_map<Tidx, Partial>& bins = partial_bins[block];
+            for (int64_t i = block_begin(block); i < block_begin(block + 1);
+                 i++) {
+              const Tidx value = arr[i];
+              if (value < num_bins) count(i, &bins[value]);
+            }
+          }
+        });
+  for (const absl::flat_hash_map<Tidx, Partial>& bins : partial_bins) {
+    for (const auto& bin : bins) {
+      if constexpr (binary_output) {
+        output(bin.first) = T(1);
+      } else {
+        output(bin.first) += bin.second;
+      }
+    }
+  }
+  return OkStatus();
+}
+
+}  // namespace
+
 template <typename Tidx, typename T>
 struct BincountFunctor<CPUDevice, Tidx, T, true> {
   static Status Compute(OpKernelContext* context,
@@ -56,32 +172,10 @@ struct BincountFunctor<CPUDevice, Tidx, T, true> {
       return errors::InvalidArgument("Input arr must be non-negative!");
     }
 
-    // Allocate partial output bin sums for each worker thread. Worker ids in
-    // ParallelForWithWorkerId range from 0 to NumThreads() inclusive.
-    ThreadPool* thread_pool =
-        context->device()->tensorflow_cpu_worker_threads()->workers;
-    const int64_t num_threads = thread_pool->NumThreads() + 1;
-    Tensor partial_bins_t;
-    TF_RETURN_IF_ERROR(context->allocate_temp(
-        DT_BOOL, TensorShape({num_threads, num_bins}), &partial_bins_t));
-    auto partial_bins = partial_bins_t.matrix<bool>();
-    partial_bins.setZero();
-    thread_pool->ParallelForWithWorkerId(
-        arr.size(), 8 /* cost */,
-        [&](int64_t start_ind, int64_t limit_ind, int64_t worker_id) {
-          for (int64_t i = start_ind; i < limit_ind; i++) {
-            Tidx value = arr(i);
-            if (value < num_bins) {
-              partial_bins(worker_id, value) = true;
-            }
-          }
-        });
-
-    // Sum the partial bins along the 0th axis.
-    Eigen::array<int, 1> reduce_dim({0});
-    output.device(context->eigen_cpu_device()) =
-        partial_bins.any(reduce_dim).cast<T>();
-    return OkStatus();
+    output.device(context->eigen_cpu_device()) = output.constant(T(0));
+    return BincountInBlocks<Tidx, T, /*binary_output=*/true>(
+        context, arr.data(), arr.size(), /*weights=*/nullptr, num_bins,
+        output);
   }
 };
 
@@ -101,70 +195,14 @@ struct BincountFunctor<CPUDevice, Tidx, T, false> {
       return errors::InvalidArgument("Input arr must be non-negative!");
     }
 
-    // Allocate partial output bin sums for each worker thread. Worker ids in
-    // ParallelForWithWorkerId range from 0 to NumThreads() inclusive.
-    ThreadPool* thread_pool =
-        context->device()->tensorflow_cpu_worker_threads()->workers;
-    const int64_t num_threads = thread_pool->NumThreads() + 1;
-    const Tidx* arr_data = arr.data();
-    const std::ptrdiff_t arr_size = arr.size();
-    const T* weight_data = weights.data();
-    if (weights.size() && weights.size() != arr_size) {
+    if (weights.size() && weights.size() != arr.size()) {
       return errors::InvalidArgument(
           "Input indices and weights must have the same size.");
     }
-    if (num_threads == 1) {
-      output.setZero();
-      T* output_data = output.data();
-      if (weights.size()) {
-        for (int64_t i = 0; i < arr_size; i++) {
-          const Tidx value = arr_data[i];
-          if (value < num_bins) {
-            output_data[value] += weight_data[i];
-          }
-        }
-      } else {
-        for (int64_t i = 0; i < arr_size; i++) {
-          const Tidx value = arr_data[i];
-          if (value < num_bins) {
-            // Complex numbers don't support "++".
-            output_data[value] += T(1);
-          }
-        }
-      }
-    } else {
-      Tensor partial_bins_t;
-      TF_RETURN_IF_ERROR(context->allocate_temp(
-          DataTypeToEnum<T>::value, TensorShape({num_threads, num_bins}),
-          &partial_bins_t));
-      auto partial_bins = partial_bins_t.matrix<T>();
-      partial_bins.setZero();
-      thread_pool->ParallelForWithWorkerId(
-          arr_size, 8 /* cost */,
-          [&](int64_t start_ind, int64_t limit_ind, int64_t worker_id) {
-            if (weights.size()) {
-              for (int64_t i = start_ind; i < limit_ind; i++) {
-                Tidx value = arr_data[i];
-                if (value < num_bins) {
-                  partial_bins(worker_id, value) += weight_data[i];
-                }
-              }
-            } else {
-              for (int64_t i = start_ind; i < limit_ind; i++) {
-                Tidx value = arr_data[i];
-                if (value < num_bins) {
-                  // Complex numbers don't support "++".
-                  partial_bins(worker_id, value) += T(1);
-                }
-              }
-            }
-          });
-
-      // Sum the partial bins along the 0th axis.
-      Eigen::array<int, 1> reduce_dim({0});
-      output.device(context->eigen_cpu_device()) = partial_bins.sum(reduce_dim);
-    }
-    return OkStatus();
+    output.device(context->eigen_cpu_device()) = output.constant(T(0));
+    return BincountInBlocks<Tidx, T, /*binary_output=*/false>(
+        context, arr.data(), arr.size(),
+        weights.size() ? weights.data() : nullptr, num_bins, output);
   }
 };
 
@@ -12,13 +12,17 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
+#include <cstring>
+#include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "tensorflow/core/activity_watcher/activity.h"
 #include "tensorflow/core/activity_watcher/activity_utils.h"
+#include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/framework/attr_value.pb.h"
 #include "tensorflow/core/framework/collective.h"
 #include "tensorflow/core/framework/device_attributes.pb.h"
@@ -642,9 +646,11 @@ class CollectiveOpV2Kernel : public AsyncOpKernel {
   }
 
   // Runs a collective. The output tensor must be allocated before calling this
-  // method. col_params must live until done is called.
-  void Run(OpKernelContext* c, CollectiveParams* col_params,
-           DoneCallback done) {
+  // method. col_params must live until done is called. If `input` and `output`
+  // are given the collective runs on them instead of on the first input and
+  // output of the Op, and they must also live until done is called.
+  void Run(OpKernelContext* c, CollectiveParams* col_params, DoneCallback done,
+           const Tensor* input = nullptr, Tensor* output = nullptr) {
     // Trace the Run event.
     tsl::profiler::TraceMeProducer producer(
         [this] {
@@ -688,7 +694,7 @@ class CollectiveOpV2Kernel : public AsyncOpKernel {
     // blocking work because it's not guaranteed that this call cannot block.
     c->collective_executor()->RunClosure([c, activity_id, xprof_ctx_id,
                                           done = std::move(done), col_params,
-                                          col_exec]() mutable {
+                                          col_exec, input, output]() mutable {
       tsl::profiler::TraceMeConsumer consumer(
           [&] {
             return tsl::profiler::TraceMeEncode(
@@ -704,7 +710,7 @@ class CollectiveOpV2Kernel : public AsyncOpKernel {
       col_exec->CompleteParamsAsync(
           c->device()->attributes(), col_params, c->cancellation_manager(),
           [c, activity_id, xprof_ctx_id, done = std::move(done), col_params,
-           col_exec](const Status& s) mutable {
+           col_exec, input, output](const Status& s) mutable {
             tsl::profiler::TraceMeConsumer consumer(
                 [&] {
                   return tsl::profiler::TraceMeEncode(
@@ -739,11 +745,15 @@ class CollectiveOpV2Kernel : public AsyncOpKernel {
                       << col_params->name << " device " << c->device()->name()
                       << " group " << col_params->group.group_key
                       << " instance " << col_params->instance.instance_key;
-              col_exec->ExecuteAsync(
-                  c, col_params,
+              const string exec_key =
                   CollectiveKey(c, col_params->group.group_key,
-                                col_params->instance.instance_key),
-                  actual_done);
+                                col_params->instance.instance_key);
+              if (input != nullptr) {
+                col_exec->ExecuteAsync(c, col_params, exec_key, input, output,
+                                       actual_done);
+              } else {
+                col_exec->ExecuteAsync(c, col_params, exec_key, actual_done);
+              }
             } else {
               c->SetStatus(s);
               done();
@@ -776,6 +786,8 @@ class CollectiveReduceV2OpKernel : public CollectiveOpV2Kernel {
     OP_REQUIRES_OK(c, c->GetAttr("final_op", &final_op_name));
     OP_REQUIRES_OK(
         c, c->GetAttr("max_subdivs_per_device", &max_subdivs_per_device_));
+    OP_REQUIRES_OK(c, c->GetAttr("compression", &compression_));
+    OP_REQUIRES_OK(c, c->GetAttr("num_backup_workers", &num_backup_workers_));
     // Prepare OpKernels for reduction and final operations.
     // The merge_op takes two inputs
     NodeDef sub_node;
@@ -806,6 +818,9 @@ class CollectiveReduceV2OpKernel : public CollectiveOpV2Kernel {
         done_with_cleanup);
     col_params->instance.impl_details.max_subdivs_per_device =
         max_subdivs_per_device_;
+    col_params->instance.impl_details.compression = compression_;
+    col_params->instance.impl_details.num_backup_workers =
+        num_backup_workers_;
     col_params->instance.shape = c->input(0).shape();
     col_params->merge_op = merge_op_.get();
     col_params->final_op = final_op_.get();
@@ -824,8 +839,10 @@ class CollectiveReduceV2OpKernel : public CollectiveOpV2Kernel {
     Run(c, col_params, std::move(done_with_cleanup));
   }
 
- private:
+ protected:
   int max_subdivs_per_device_;
+  string compression_;
+  int num_backup_workers_;
   std::unique_ptr<OpKernel> merge_op_;
   std::unique_ptr<OpKernel> final_op_;
 };
@@ -839,6 +856,177 @@ REGISTER_KERNEL_BUILDER(Name("CollectiveReduceV2")
                             .HostMemory("instance_key"),
                         CollectiveReduceV2OpKernel);
 
+// Copies each of `srcs` into the same-sized tensor at the same index of `dsts`
+// on the device of `c`, then calls `done`.
+void CopyTensorsInSameDevice(OpKernelContext* c, std::vector<Tensor> srcs,
+                             std::vector<Tensor> dsts, StatusCallback done) {
+  DeviceContext* device_ctx = c->op_device_context();
+  if (device_ctx == nullptr) {
+    for (int i = 0; i < srcs.size(); ++i) {
+      if (srcs[i].TotalBytes() == 0) continue;
+      memcpy(dsts[i].data(), srcs[i].data(), srcs[i].TotalBytes());
+    }
+    done(absl::OkStatus());
+    return;
+  }
+  struct CopyState {
+    std::vector<Tensor> srcs;
+    std::vector<Tensor> dsts;
+    StatusCallback done;
+    mutex mu;
+    Status status TF_GUARDED_BY(mu);
+    int pending TF_GUARDED_BY(mu);
+  };
+  auto state = std::make_shared<CopyState>();
+  state->srcs = std::move(srcs);
+  state->dsts = std::move(dsts);
+  state->done = std::move(done);
+  {
+    mutex_lock l(state->mu);
+    // One extra count held while the copies are being issued.
+    state->pending = state->srcs.size() + 1;
+  }
+  auto copy_done = [state](const Status& s) {
+    bool last;
+    {
+      mutex_lock l(state->mu);
+      state->status.Update(s);
+      last = --state->pending == 0;
+    }
+    if (last) {
+      Status status;
+      {
+        mutex_lock l(state->mu);
+        status = state->status;
+      }
+      state->done(status);
+    }
+  };
+  for (int i = 0; i < state->srcs.size(); ++i) {
+    if (state->srcs[i].TotalBytes() == 0) {
+      copy_done(absl::OkStatus());
+      continue;
+    }
+    device_ctx->CopyTensorInSameDevice(&state->srcs[i],
+                                       down_cast<Device*>(c->device()),
+                                       &state->dsts[i], copy_done);
+  }
+  copy_done(absl::OkStatus());
+}
+
+// Reduces a list of tensors with a single collective, by packing them into one
+// contiguous buffer, reducing the buffer and unpacking the result. This saves
+// the per-collective parameter resolution and launch overhead when reducing
+// many small tensors, e.g. the gradients of a model.
+class CollectiveBatchReduceV2OpKernel : public CollectiveReduceV2OpKernel {
+ public:
+  explicit CollectiveBatchReduceV2OpKernel(OpKernelConstruction* c)
+      : CollectiveReduceV2OpKernel(c) {}
+
+  void ComputeAsync(OpKernelContext* c, DoneCallback done) override {
+    OpInputList inputs;
+    OP_REQUIRES_OK_ASYNC(c, c->input_list("input", &inputs), done);
+    const Tensor* group_size;
+    const Tensor* group_key;
+    const Tensor* instance_key;
+    OP_REQUIRES_OK_ASYNC(c, c->input("group_size", &group_size), done);
+    OP_REQUIRES_OK_ASYNC(c, c->input("group_key", &group_key), done);
+    OP_REQUIRES_OK_ASYNC(c, c->input("instance_key", &instance_key), done);
+
+    auto col_params = new CollectiveParams();
+    // Holds the packed inputs, which are reduced in place.
+    auto packed = std::make_shared<Tensor>();
+    auto done_with_cleanup = [col_params, packed, done = std::move(done)]() {
+      done();
+      col_params->Unref();
+    };
+    OP_REQUIRES_OK_ASYNC(
+        c,
+        FillCollectiveParams(col_params, c, REDUCTION_COLLECTIVE, *group_size,
+                             *group_key, *instance_key),
+        done_with_cleanup);
+    col_params->instance.impl_details.max_subdivs_per_device =
+        max_subdivs_per_device_;
+    col_params->instance.impl_details.compression = compression_;
+    col_params->instance.impl_details.num_backup_workers =
+        num_backup_workers_;
+    col_params->merge_op = merge_op_.get();
+    col_params->final_op = final_op_.get();
+
+    int64_t num_elements = 0;
+    for (const Tensor& input : inputs) {
+      num_elements += input.NumElements();
+    }
+    col_params->instance.shape = TensorShape({num_elements});
+    OP_REQUIRES_OK_ASYNC(
+        c,
+        c->allocate_temp(data_type_, col_params->instance.shape, packed.get(),
+                         c->output_alloc_attr(0)),
+        done_with_cleanup);
+
+    // Pair up every input and output with its slice of the packed buffer.
+    std::vector<Tensor> flat_inputs;
+    std::vector<Tensor> flat_outputs;
+    std::vector<Tensor> slices;
+    int64_t offset = 0;
+    for (int i = 0; i < inputs.size(); ++i) {
+      const TensorShape flat_shape({inputs[i].NumElements()});
+      Tensor* output = nullptr;
+      OP_REQUIRES_OK_ASYNC(c,
+                           c->forward_input_or_allocate_output(
+                               {i}, i, inputs[i].shape(), &output),
+                           done_with_cleanup);
+      flat_inputs.emplace_back();
+      flat_outputs.emplace_back();
+      CHECK(flat_inputs.back().CopyFrom(inputs[i], flat_shape));
+      CHECK(flat_outputs.back().CopyFrom(*output, flat_shape));
+      slices.push_back(
+          packed->Slice(offset, offset + flat_shape.num_elements()));
+      offset += flat_shape.num_elements();
+    }
+    VLOG(1) << "CollectiveBatchReduceV2 group_size "
+            << col_params->group.group_size << " group_key "
+            << col_params->group.group_key << " instance_key "
+            << col_params->instance.instance_key << " num_tensors "
+            << inputs.size() << " num_elements " << num_elements << " device "
+            << c->device()->name();
+
+    CopyTensorsInSameDevice(
+        c, std::move(flat_inputs), slices,
+        [this, c, col_params, packed, slices,
+         flat_outputs = std::move(flat_outputs),
+         done = std::move(done_with_cleanup)](const Status& s) mutable {
+          OP_REQUIRES_OK_ASYNC(c, s, done);
+          Run(
+              c, col_params,
+              [c, slices = std::move(slices),
+               flat_outputs = std::move(flat_outputs),
+               done = std::move(done)]() mutable {
+                if (!c->status().ok()) {
+                  done();
+                  return;
+                }
+                CopyTensorsInSameDevice(
+                    c, std::move(slices), std::move(flat_outputs),
+                    [c, done = std::move(done)](const Status& s) {
+                      OP_REQUIRES_OK_ASYNC(c, s, done);
+                      done();
+                    });
+              },
+              packed.get(), packed.get());
+        });
+  }
+};
+
+REGISTER_KERNEL_BUILDER(Name("CollectiveBatchReduceV2").Device(DEVICE_CPU),
+                        CollectiveBatchReduceV2OpKernel);
+REGISTER_KERNEL_BUILDER(Name("CollectiveBatchReduceV2")
+                            .Device(DEVICE_DEFAULT)
+                            .HostMemory("group_size")
+                            .HostMemory("group_key")
+                            .HostMemory("instance_key"),
+                        CollectiveBatchReduceV2OpKernel);
+
 class CollectiveGatherV2OpKernel : public CollectiveOpV2Kernel {
  public:
   explicit CollectiveGatherV2OpKernel(OpKernelConstruction* c)
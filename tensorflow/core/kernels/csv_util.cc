@@ -0,0 +1,67 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/csv_util.h"
+
+#include <cstdint>
+#include <cstring>
+
+#include "absl/numeric/bits.h"
+#include "tensorflow/core/platform/byte_order.h"
+
+namespace tensorflow {
+namespace {
+
+constexpr uint64_t kLowBits = 0x0101010101010101ULL;
+constexpr uint64_t kHighBits = 0x8080808080808080ULL;
+
+// Returns a word with the high bit set in the bytes of `word` that are
+// equal to `ch`. Bits may also be set in the bytes above the first match,
+// but the lowest set bit is always exact.
+inline uint64_t MatchBytes(uint64_t word, char ch) {
+  const uint64_t x = word ^ (kLowBits * static_cast<unsigned char>(ch));
+  return (x - kLowBits) & ~x & kHighBits;
+}
+
+inline bool IsFieldEnd(char ch, char delim, bool use_quote_delim) {
+  return ch == delim || ch == '\n' || ch == '\r' ||
+         (use_quote_delim && ch == '"');
+}
+
+}  // namespace
+
+size_t FindCsvFieldEnd(StringPiece text, size_t pos, char delim,
+                       bool use_quote_delim) {
+  const char* data = text.data();
+  const size_t size = text.size();
+  if (port::kLittleEndian) {
+    // Without quotes, test the delimiter twice rather than branching.
+    const char quote = use_quote_delim ? '"' : delim;
+    for (; pos + sizeof(uint64_t) <= size; pos += sizeof(uint64_t)) {
+      uint64_t word;
+      std::memcpy(&word, data + pos, sizeof(word));
+      const uint64_t matches = MatchBytes(word, delim) |
+                               MatchBytes(word, '\n') |
+                               MatchBytes(word, '\r') | MatchBytes(word, quote);
+      if (matches != 0) return pos + absl::countr_zero(matches) / 8;
+    }
+  }
+  for (; pos < size; ++pos) {
+    if (IsFieldEnd(data[pos], delim, use_quote_delim)) return pos;
+  }
+  return size;
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,37 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_CSV_UTIL_H_
+#define TENSORFLOW_CORE_KERNELS_CSV_UTIL_H_
+
+#include <cstddef>
+
+#include "tensorflow/core/lib/core/stringpiece.h"
+
+namespace tensorflow {
+
+// Returns the position of the first character of `text` at or after `pos`
+// that ends an unquoted CSV field: `delim`, '\n', '\r', or '"' if
+// `use_quote_delim` is true. Returns `text.size()` if there is none.
+//
+// The text is scanned eight bytes at a time, testing all the bytes of a
+// word for the special characters at once, which makes it much faster than
+// a per character loop on long fields.
+size_t FindCsvFieldEnd(StringPiece text, size_t pos, char delim,
+                       bool use_quote_delim);
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_CSV_UTIL_H_
@@ -0,0 +1,63 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/csv_util.h"
+
+#include <string>
+
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+TEST(CsvUtilTest, FindsFieldEnds) {
+  EXPECT_EQ(FindCsvFieldEnd("", 0, ',', true), 0);
+  EXPECT_EQ(FindCsvFieldEnd("abc", 0, ',', true), 3);
+  EXPECT_EQ(FindCsvFieldEnd("abc,def", 0, ',', true), 3);
+  EXPECT_EQ(FindCsvFieldEnd("abc,def", 4, ',', true), 7);
+  EXPECT_EQ(FindCsvFieldEnd("abc\ndef", 0, ',', true), 3);
+  EXPECT_EQ(FindCsvFieldEnd("abc\rdef", 0, ',', true), 3);
+  EXPECT_EQ(FindCsvFieldEnd("ab\"c,def", 0, ',', true), 2);
+  EXPECT_EQ(FindCsvFieldEnd("ab\"c,def", 0, ',', false), 4);
+  EXPECT_EQ(FindCsvFieldEnd("abc|def,", 0, '|', true), 3);
+}
+
+TEST(CsvUtilTest, FindsFieldEndsAtAllPositions) {
+  // Covers each position of the special characters within the words and in
+  // the tail of the text, and bytes that differ from them by one.
+  for (char special : {',', '\n', '\r', '"'}) {
+    for (int size = 1; size < 40; ++size) {
+      for (int pos = 0; pos < size; ++pos) {
+        std::string text(size, special + 1);
+        for (int i = 0; i < pos; i += 2) text[i] = special - 1;
+        text[pos] = special;
+        for (int start = 0; start <= pos; ++start) {
+          EXPECT_EQ(FindCsvFieldEnd(text, start, ',', true), pos)
+              << "size " << size << " start " << start;
+        }
+      }
+      const std::string text(size, 'x');
+      EXPECT_EQ(FindCsvFieldEnd(text, 0, ',', true), size);
+    }
+  }
+}
+
+TEST(CsvUtilTest, HandlesHighBytes) {
+  const std::string text = "\xff\x80\xac\xa2\x8d\x8a\xac\xa2\xff,";
+  EXPECT_EQ(FindCsvFieldEnd(text, 0, ',', true), 9);
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -110,7 +110,19 @@ BatchDatasetParams BatchDatasetParams7() {
                             /*node_name=*/kNodeName);
 }
 
-// Test Case 8: test BatchDatasetV2 with an invalid batch size
+// Test Case 8: test BatchDatasetV2 with `batch_size` = 1, whose batches share
+// the buffers of the input elements.
+BatchDatasetParams BatchDatasetParams8() {
+  return BatchDatasetParams(RangeDatasetParams(0, 3, 1),
+                            /*batch_size=*/1,
+                            /*drop_remainder=*/false,
+                            /*parallel_copy=*/true,
+                            /*output_dtypes=*/{DT_INT64},
+                            /*output_shapes=*/{PartialTensorShape({1})},
+                            /*node_name=*/kNodeName);
+}
+
+// Test Case 9: test BatchDatasetV2 with an invalid batch size
 BatchDatasetParams InvalidBatchSizeBatchDatasetParams() {
   return BatchDatasetParams(RangeDatasetParams(0, 10, 1),
                             /*batch_size=*/-1,
@@ -148,7 +160,10 @@ std::vector<GetNextTestCase<BatchDatasetParams>> GetNextTestCases() {
                                   {{0, 1, 2, 3, 4, 5, 6, 7, 8, 9}})},
 
           {/*dataset_params=*/BatchDatasetParams7(),
-           /*expected_outputs=*/{}}};
+           /*expected_outputs=*/{}},
+          {/*dataset_params=*/BatchDatasetParams8(),
+           /*expected_outputs=*/
+           CreateTensors<int64_t>(TensorShape({1}), {{0}, {1}, {2}})}};
 }
 
 ITERATOR_GET_NEXT_TEST_P(BatchDatasetOpTest, BatchDatasetParams,
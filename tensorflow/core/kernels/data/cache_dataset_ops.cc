@@ -14,9 +14,12 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/kernels/data/cache_dataset_ops.h"
 
+#include <algorithm>
 #include <atomic>
 #include <cstddef>
 #include <cstdint>
+#include <deque>
+#include <iterator>
 #include <memory>
 #include <string>
 #include <utility>
@@ -28,6 +31,7 @@ limitations under the License.
 #include "tensorflow/core/data/serialization_utils.h"
 #include "tensorflow/core/framework/dataset.h"
 #include "tensorflow/core/framework/dataset_options.pb.h"
+#include "tensorflow/core/framework/model.h"
 #include "tensorflow/core/framework/partial_tensor_shape.h"
 #include "tensorflow/core/framework/resource_mgr.h"
 #include "tensorflow/core/framework/tensor.h"
@@ -38,6 +42,7 @@ limitations under the License.
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/refcount.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/tensor_bundle/naming.h"
 #include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
 
@@ -70,6 +75,12 @@ constexpr char kCacheCompleted[] = "cache_completed";
 constexpr char kIndex[] = "index";
 constexpr char kImpl[] = "Impl";
 constexpr char kCacheDataset[] = "CacheDataset";
+// Directory that the memory cache spills elements to once the RAM budget of
+// the pipeline is exhausted. The cache is kept in memory if it is not set.
+constexpr char kSpillDirEnvVar[] = "TF_DATA_MEMORY_CACHE_SPILL_DIR";
+// Number of elements ahead of the current one that a reader of the memory
+// cache reads from disk in parallel.
+constexpr int64_t kSpillReadAheadElements = 16;
 constexpr char kIncompleteCacheErrorMessage[] =
     "The calling iterator did not fully read the dataset being cached. In "
     "order to avoid unexpected truncation of the dataset, the partially cached "
@@ -877,8 +888,10 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
       mutex_lock l(mu_);
       if (cache_->IsCompleted()) {
         TF_RETURN_IF_ERROR(writer->WriteScalar(prefix(), kCacheCompleted, ""));
+        std::vector<std::vector<Tensor>> elements;
+        TF_RETURN_IF_ERROR(cache_->GetAll(&elements));
         TF_RETURN_IF_ERROR(
-            WriteElementsToCheckpoint(writer, prefix(), cache_->data()));
+            WriteElementsToCheckpoint(writer, prefix(), elements));
       }
       TF_RETURN_IF_ERROR(global_shuffle_iterator_.Save(prefix(), ctx, writer));
       return SaveInput(ctx, writer, iterator_);
@@ -910,13 +923,21 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
 
       ~MemoryWriterIterator() override {
         mutex_lock l(mu_);
-        if (!temp_cache_.empty() && !cache_->IsCompleted()) {
+        if ((!temp_cache_.empty() || spill_ != nullptr) &&
+            !cache_->IsCompleted()) {
           LOG(WARNING) << kIncompleteCacheErrorMessage;
           cache_->Reset();
         }
+        if (ram_budget_manager_ != nullptr) {
+          ram_budget_manager_->RequestCacheBytes(-reserved_bytes_);
+        }
       }
 
       Status Initialize(IteratorContext* ctx) override {
+        mutex_lock l(mu_);
+        TF_RETURN_IF_ERROR(ReadStringFromEnvVar(kSpillDirEnvVar,
+                                                /*default_val=*/"",
+                                                &spill_directory_));
         return dataset()->input_->MakeIterator(ctx, this, prefix(),
                                                &input_impl_);
       }
@@ -930,16 +951,15 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
         if (*end_of_sequence) {
           if (!cache_->IsCompleted()) {
             VLOG(2) << "Finalizing the cache because EOF has been reached.";
-            cache_->Complete(std::move(temp_cache_));
+            return CompleteCache();
           }
           return absl::OkStatus();
         }
-        RecordBufferEnqueue(ctx, *out_tensors);
-        temp_cache_.emplace_back(*out_tensors);
-        if (temp_cache_.size() == dataset()->input_->Cardinality()) {
+        TF_RETURN_IF_ERROR(AddToCache(ctx, *out_tensors));
+        if (NumCached() == dataset()->input_->Cardinality()) {
           VLOG(2) << "Finalizing the cache because its size matches the "
                      "expected input cardinality.";
-          cache_->Complete(std::move(temp_cache_));
+          return CompleteCache();
         }
         return absl::OkStatus();
       }
@@ -955,8 +975,20 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
                           IteratorStateWriter* writer) override {
         mutex_lock l(mu_);
         if (!cache_->IsCompleted()) {
-          TF_RETURN_IF_ERROR(
-              WriteElementsToCheckpoint(writer, prefix(), temp_cache_));
+          if (spill_ == nullptr) {
+            TF_RETURN_IF_ERROR(
+                WriteElementsToCheckpoint(writer, prefix(), temp_cache_));
+          } else {
+            std::vector<std::vector<Tensor>> elements = temp_cache_;
+            TF_RETURN_IF_ERROR(spill_->Seal());
+            elements.resize(NumCached());
+            for (int64_t i = 0; i < spill_->size(); ++i) {
+              TF_RETURN_IF_ERROR(
+                  spill_->Get(i, &elements[temp_cache_.size() + i]));
+            }
+            TF_RETURN_IF_ERROR(
+                WriteElementsToCheckpoint(writer, prefix(), elements));
+          }
         }
         return SaveInput(ctx, writer, input_impl_);
       }
@@ -965,17 +997,95 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
                              IteratorStateReader* reader) override {
         mutex_lock l(mu_);
         if (!reader->Contains(prefix(), kCacheCompleted)) {
+          std::vector<std::vector<Tensor>> elements;
           TF_RETURN_IF_ERROR(
-              ReadElementsFromCheckpoint(ctx, reader, prefix(), &temp_cache_));
+              ReadElementsFromCheckpoint(ctx, reader, prefix(), &elements));
+          for (const std::vector<Tensor>& element : elements) {
+            TF_RETURN_IF_ERROR(AddToCache(ctx, element));
+          }
         }
         return RestoreInput(ctx, reader, input_impl_);
       }
 
      private:
+      int64_t NumCached() const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        return temp_cache_.size() + (spill_ != nullptr ? spill_->size() : 0);
+      }
+
+      // Keeps `element` in memory while the RAM budget allows it, and spills
+      // it to disk afterwards. Once an element has been spilled, all the
+      // following elements are spilled too, so the cache holds a prefix of
+      // the elements in memory.
+      Status AddToCache(IteratorContext* ctx,
+                        const std::vector<Tensor>& element)
+          TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        if (spill_ == nullptr && !ReserveBytes(ctx, element)) {
+          VLOG(2) << "Spilling the memory cache to " << spill_directory_
+                  << " after " << temp_cache_.size() << " elements.";
+          TF_RETURN_IF_ERROR(
+              MemoryCacheSpill::Create(ctx->env(), spill_directory_, &spill_));
+        }
+        if (spill_ != nullptr) {
+          return spill_->Append(element);
+        }
+        RecordBufferEnqueue(ctx, element);
+        temp_cache_.push_back(element);
+        return absl::OkStatus();
+      }
+
+      // Returns whether `element` may be kept in memory. Without a spill
+      // directory, all elements are kept in memory.
+      bool ReserveBytes(IteratorContext* ctx,
+                        const std::vector<Tensor>& element)
+          TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        if (spill_directory_.empty()) {
+          return true;
+        }
+        if (ram_budget_manager_ == nullptr) {
+          ram_budget_manager_ = ctx->ram_budget_manager();
+          if (ram_budget_manager_ == nullptr) {
+            return true;
+          }
+        }
+        int64_t bytes = 0;
+        for (const Tensor& tensor : element) {
+          bytes += tensor.TotalBytes();
+        }
+        if (!ram_budget_manager_->RequestCacheBytes(bytes)) {
+          return false;
+        }
+        reserved_bytes_ += bytes;
+        return true;
+      }
+
+      Status CompleteCache() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        if (spill_ != nullptr) {
+          TF_RETURN_IF_ERROR(spill_->Seal());
+          VLOG(2) << "Spilled " << spill_->size() << " elements ("
+                  << spill_->bytes() << " compressed bytes) of the memory "
+                  << "cache to disk.";
+        }
+        cache_->Complete(std::move(temp_cache_), std::move(spill_),
+                         std::move(ram_budget_manager_), reserved_bytes_);
+        temp_cache_.clear();
+        ram_budget_manager_ = nullptr;
+        reserved_bytes_ = 0;
+        return absl::OkStatus();
+      }
+
       mutex mu_;
       std::unique_ptr<IteratorBase> input_impl_ TF_GUARDED_BY(mu_);
       MemoryCache* const cache_ TF_GUARDED_BY(mu_);  // not owned.
       std::vector<std::vector<Tensor>> temp_cache_ TF_GUARDED_BY(mu_);
+      // Directory to spill elements to once the RAM budget is exhausted. If
+      // empty, the whole cache is kept in memory.
+      std::string spill_directory_ TF_GUARDED_BY(mu_);
+      // Holds the elements that follow those of `temp_cache_`.
+      std::unique_ptr<MemoryCacheSpill> spill_ TF_GUARDED_BY(mu_);
+      std::shared_ptr<model::RamBudgetManager> ram_budget_manager_
+          TF_GUARDED_BY(mu_);
+      // Bytes of `ram_budget_manager_` reserved for `temp_cache_`.
+      int64_t reserved_bytes_ TF_GUARDED_BY(mu_) = 0;
     };  // MemoryWriterIterator
 
     class MemoryReaderIterator : public DatasetIterator<MemoryDatasetBase> {
@@ -985,6 +1095,11 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
             cache_(cache),
             index_(0) {}
 
+      ~MemoryReaderIterator() override {
+        mutex_lock l(mu_);
+        CancelReadAhead(l);
+      }
+
       Status Initialize(IteratorContext* ctx) override {
         // The memory allocated for the cache is owned by the parent
         // dataset but performance modeling uses the iterator abstraction and
@@ -992,7 +1107,7 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
         // is that this is incorrect if there are concurrent instances of this
         // iterator.
         tf_shared_lock l(mu_);
-        for (size_t i = 0; i < cache_->size(); ++i) {
+        for (size_t i = 0; i < cache_->size_in_memory(); ++i) {
           RecordBufferEnqueue(ctx, cache_->at(i));
         }
         return absl::OkStatus();
@@ -1002,17 +1117,30 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
                              std::vector<Tensor>* out_tensors,
                              bool* end_of_sequence) override {
         mutex_lock l(mu_);
-        if (index_ < cache_->size()) {
+        if (index_ >= cache_->size()) {
+          *end_of_sequence = true;
+          return absl::OkStatus();
+        }
+        ScheduleReadAhead(ctx);
+        if (index_ < cache_->size_in_memory()) {
           const std::vector<Tensor>& cache_tensors = cache_->at(index_);
           out_tensors->insert(out_tensors->begin(), cache_tensors.begin(),
                               cache_tensors.end());
-          index_++;
-          *end_of_sequence = false;
-          return absl::OkStatus();
         } else {
-          *end_of_sequence = true;
-          return absl::OkStatus();
+          // The front of `read_ahead_` holds the element at `index_`.
+          std::shared_ptr<ReadAheadElement> element = read_ahead_.front();
+          read_ahead_.pop_front();
+          while (!element->done) {
+            cond_var_.wait(l);
+          }
+          TF_RETURN_IF_ERROR(element->status);
+          out_tensors->insert(out_tensors->begin(),
+                              std::make_move_iterator(element->tensors.begin()),
+                              std::make_move_iterator(element->tensors.end()));
         }
+        index_++;
+        *end_of_sequence = false;
+        return absl::OkStatus();
       }
 
      protected:
@@ -1041,13 +1169,66 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
           }
           index_ = static_cast<size_t>(temp);
         }
+        CancelReadAhead(l);
+        next_read_ahead_index_ = index_;
         return absl::OkStatus();
       }
 
      private:
+      // An element of the cache that is being read from disk.
+      struct ReadAheadElement {
+        bool done = false;
+        Status status;
+        std::vector<Tensor> tensors;
+      };
+
+      // Starts reading the spilled elements among the next
+      // `kSpillReadAheadElements` ones. Since the in-memory elements precede
+      // the spilled ones, the first spilled elements are read from disk while
+      // the last in-memory ones are consumed.
+      void ScheduleReadAhead(IteratorContext* ctx)
+          TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        const int64_t end = std::min<int64_t>(
+            cache_->size(), index_ + kSpillReadAheadElements);
+        next_read_ahead_index_ = std::max<int64_t>(next_read_ahead_index_,
+                                                   cache_->size_in_memory());
+        for (; next_read_ahead_index_ < end; ++next_read_ahead_index_) {
+          auto element = std::make_shared<ReadAheadElement>();
+          read_ahead_.push_back(element);
+          ++num_outstanding_reads_;
+          MemoryCache* cache = cache_;
+          const int64_t index = next_read_ahead_index_;
+          (*ctx->runner())([this, cache, index, element]() {
+            std::vector<Tensor> tensors;
+            Status s = cache->Get(index, &tensors);
+            mutex_lock l(mu_);
+            element->status = std::move(s);
+            element->tensors = std::move(tensors);
+            element->done = true;
+            --num_outstanding_reads_;
+            cond_var_.notify_all();
+          });
+        }
+      }
+
+      // Waits for the outstanding reads and drops the elements read ahead.
+      void CancelReadAhead(mutex_lock& l) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        while (num_outstanding_reads_ > 0) {
+          cond_var_.wait(l);
+        }
+        read_ahead_.clear();
+      }
+
       mutex mu_;
+      condition_variable cond_var_;
       MemoryCache* const cache_ TF_GUARDED_BY(mu_);  // not owned.
       size_t index_ TF_GUARDED_BY(mu_);
+      // Elements at the indices [next_read_ahead_index_ - read_ahead_.size(),
+      // next_read_ahead_index_) that are read, or being read, from disk.
+      std::deque<std::shared_ptr<ReadAheadElement>> read_ahead_
+          TF_GUARDED_BY(mu_);
+      int64_t next_read_ahead_index_ TF_GUARDED_BY(mu_) = 0;
+      int64_t num_outstanding_reads_ TF_GUARDED_BY(mu_) = 0;
     };  // MemoryReaderIterator
 
     Status InitializeIterator(IteratorContext* ctx)
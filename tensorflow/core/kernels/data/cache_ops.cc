@@ -14,6 +14,13 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/kernels/data/cache_ops.h"
 
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/data/compression_utils.h"
 #include "tensorflow/core/data/dataset_utils.h"
 #include "tensorflow/core/framework/dataset.h"
 #include "tensorflow/core/framework/partial_tensor_shape.h"
@@ -22,6 +29,9 @@ limitations under the License.
 #include "tensorflow/core/lib/random/philox_random.h"
 #include "tensorflow/core/lib/random/random.h"
 #include "tensorflow/core/lib/random/random_distributions.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/strcat.h"
 
 namespace tensorflow {
 namespace data {
@@ -33,11 +43,116 @@ constexpr char kMemoryCache[] = "MemoryCache";
 
 string MemoryCacheManager::DebugString() const { return kMemoryCache; }
 
+Status MemoryCacheSpill::Create(Env* env, const std::string& directory,
+                                std::unique_ptr<MemoryCacheSpill>* out) {
+  TF_RETURN_IF_ERROR(env->RecursivelyCreateDir(directory));
+  std::string file_prefix = io::JoinPath(
+      directory, strings::StrCat("memory_cache_", strings::Hex(random::New64()),
+                                 "_", env->NowMicros()));
+  out->reset(new MemoryCacheSpill(env, std::move(file_prefix)));
+  return absl::OkStatus();
+}
+
+MemoryCacheSpill::~MemoryCacheSpill() {
+  const int64_t num_chunks = chunks_.size() + (file_ != nullptr ? 1 : 0);
+  file_.reset();
+  chunks_.clear();
+  for (int64_t chunk = 0; chunk < num_chunks; ++chunk) {
+    Status s = env_->DeleteFile(ChunkFilename(chunk));
+    if (!s.ok()) {
+      LOG(WARNING) << "Failed to delete memory cache spill file: " << s;
+    }
+  }
+}
+
+std::string MemoryCacheSpill::ChunkFilename(int64_t chunk) const {
+  return strings::StrCat(file_prefix_, "_", chunk, ".spill");
+}
+
+Status MemoryCacheSpill::Append(const std::vector<Tensor>& element) {
+  CompressedElement compressed;
+  TF_RETURN_IF_ERROR(CompressElement(element, &compressed));
+  std::string serialized;
+  if (!compressed.SerializeToString(&serialized)) {
+    return errors::Internal("Failed to serialize a dataset element of size ",
+                            compressed.ByteSizeLong());
+  }
+  if (file_ == nullptr) {
+    TF_RETURN_IF_ERROR(
+        env_->NewWritableFile(ChunkFilename(chunks_.size()), &file_));
+    file_bytes_ = 0;
+  }
+  TF_RETURN_IF_ERROR(file_->Append(serialized));
+  locations_.push_back({static_cast<int64_t>(chunks_.size()), file_bytes_,
+                        serialized.size()});
+  file_bytes_ += serialized.size();
+  bytes_ += serialized.size();
+  if (file_bytes_ >= kChunkBytes) {
+    return Seal();
+  }
+  return absl::OkStatus();
+}
+
+Status MemoryCacheSpill::Seal() {
+  if (file_ == nullptr) {
+    return absl::OkStatus();
+  }
+  TF_RETURN_IF_ERROR(file_->Close());
+  file_.reset();
+  std::unique_ptr<ReadOnlyMemoryRegion> region;
+  TF_RETURN_IF_ERROR(env_->NewReadOnlyMemoryRegionFromFile(
+      ChunkFilename(chunks_.size()), &region));
+  chunks_.push_back(std::move(region));
+  return absl::OkStatus();
+}
+
+Status MemoryCacheSpill::Get(int64_t index, std::vector<Tensor>* out) const {
+  if (index < 0 || index >= locations_.size()) {
+    return errors::OutOfRange("Index out of range [0, ", locations_.size(),
+                              "): ", index);
+  }
+  const Location& location = locations_[index];
+  if (location.chunk >= chunks_.size()) {
+    return errors::FailedPrecondition("Element ", index,
+                                      " of the memory cache spill is in a "
+                                      "chunk that has not been sealed.");
+  }
+  const char* data =
+      static_cast<const char*>(chunks_[location.chunk]->data()) +
+      location.offset;
+  CompressedElement compressed;
+  if (!compressed.ParseFromArray(data, location.length)) {
+    return errors::DataLoss("Failed to parse element ", index,
+                            " of memory cache spill file ",
+                            ChunkFilename(location.chunk));
+  }
+  return UncompressElement(compressed, out);
+}
+
+MemoryCache::~MemoryCache() {
+  mutex_lock l(mu_);
+  ReleaseBytes();
+}
+
 void MemoryCache::Complete(std::vector<std::vector<Tensor>>&& cache) {
+  Complete(std::move(cache), /*spill=*/nullptr,
+           /*ram_budget_manager=*/nullptr, /*reserved_bytes=*/0);
+}
+
+void MemoryCache::Complete(
+    std::vector<std::vector<Tensor>>&& cache,
+    std::unique_ptr<MemoryCacheSpill> spill,
+    std::shared_ptr<model::RamBudgetManager> ram_budget_manager,
+    int64_t reserved_bytes) {
   mutex_lock l(mu_);
   if (!completed_) {
     cache_ = std::move(cache);
+    spill_ = std::move(spill);
+    ram_budget_manager_ = std::move(ram_budget_manager);
+    reserved_bytes_ = reserved_bytes;
     completed_ = true;
+  } else if (ram_budget_manager != nullptr) {
+    ram_budget_manager->RequestCacheBytes(-reserved_bytes);
   }
 }
 
@@ -50,6 +165,16 @@ void MemoryCache::Reset() {
   mutex_lock l(mu_);
   completed_ = false;
   cache_.clear();
+  spill_.reset();
+  ReleaseBytes();
+}
+
+void MemoryCache::ReleaseBytes() {
+  if (ram_budget_manager_ != nullptr) {
+    ram_budget_manager_->RequestCacheBytes(-reserved_bytes_);
+    ram_budget_manager_.reset();
+  }
+  reserved_bytes_ = 0;
 }
 
 const std::vector<Tensor>& MemoryCache::at(int64_t index) {
@@ -58,14 +183,39 @@ const std::vector<Tensor>& MemoryCache::at(int64_t index) {
   return cache_[index];
 }
 
+Status MemoryCache::Get(int64_t index, std::vector<Tensor>* out) {
+  tf_shared_lock l(mu_);
+  if (index < cache_.size()) {
+    *out = cache_[index];
+    return absl::OkStatus();
+  }
+  if (spill_ == nullptr) {
+    return errors::OutOfRange("Index out of range [0, ", cache_.size(),
+                              "): ", index);
+  }
+  return spill_->Get(index - cache_.size(), out);
+}
+
+Status MemoryCache::GetAll(std::vector<std::vector<Tensor>>* out) {
+  tf_shared_lock l(mu_);
+  *out = cache_;
+  if (spill_ != nullptr) {
+    out->resize(cache_.size() + spill_->size());
+    for (int64_t i = 0; i < spill_->size(); ++i) {
+      TF_RETURN_IF_ERROR(spill_->Get(i, &(*out)[cache_.size() + i]));
+    }
+  }
+  return absl::OkStatus();
+}
+
 size_t MemoryCache::size() {
   tf_shared_lock l(mu_);
-  return cache_.size();
+  return cache_.size() + (spill_ != nullptr ? spill_->size() : 0);
 }
 
-const std::vector<std::vector<Tensor>>& MemoryCache::data() {
+size_t MemoryCache::size_in_memory() {
   tf_shared_lock l(mu_);
-  return cache_;
+  return cache_.size();
 }
 
 AnonymousMemoryCacheHandleOp::AnonymousMemoryCacheHandleOp(
@@ -16,45 +16,139 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_KERNELS_DATA_CACHE_OPS_H_
 #define TENSORFLOW_CORE_KERNELS_DATA_CACHE_OPS_H_
 
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
 #include "tensorflow/core/data/dataset_utils.h"
+#include "tensorflow/core/framework/model.h"
 #include "tensorflow/core/framework/resource_mgr.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/file_system.h"
 
 namespace tensorflow {
 namespace data {
 
+// Stores the dataset elements of a `MemoryCache` that do not fit in its memory
+// budget on local disk.
+//
+// Each element is compressed and appended to the current chunk file. Once a
+// chunk is full, or `Seal()` is called, it is closed and memory-mapped, and
+// its elements can be read back with `Get()`. The chunk files are deleted when
+// the spill is destroyed.
+//
+// `Append()` and `Seal()` must not be called concurrently with other methods.
+// `Get()` may be called concurrently with itself.
+class MemoryCacheSpill {
+ public:
+  // Creates a spill that writes its chunks to `directory`, which is created if
+  // it does not exist.
+  static Status Create(Env* env, const std::string& directory,
+                       std::unique_ptr<MemoryCacheSpill>* out);
+
+  ~MemoryCacheSpill();
+
+  // Appends `element` to the current chunk.
+  Status Append(const std::vector<Tensor>& element);
+
+  // Closes and maps the current chunk, so that all appended elements can be
+  // read.
+  Status Seal();
+
+  // Reads the element at the given index, which must be in a sealed chunk.
+  Status Get(int64_t index, std::vector<Tensor>* out) const;
+
+  // Returns the number of appended elements.
+  int64_t size() const { return locations_.size(); }
+
+  // Returns the number of compressed bytes written to disk.
+  int64_t bytes() const { return bytes_; }
+
+ private:
+  // Size above which the current chunk is sealed and a new one is started.
+  static constexpr int64_t kChunkBytes = 64 << 20;
+
+  struct Location {
+    int64_t chunk;
+    uint64_t offset;
+    uint64_t length;
+  };
+
+  MemoryCacheSpill(Env* env, std::string file_prefix)
+      : env_(env), file_prefix_(std::move(file_prefix)) {}
+
+  std::string ChunkFilename(int64_t chunk) const;
+
+  Env* const env_;
+  const std::string file_prefix_;
+  std::vector<Location> locations_;
+  // File of the chunk being written, if it has been opened.
+  std::unique_ptr<WritableFile> file_;
+  uint64_t file_bytes_ = 0;
+  // Mapped sealed chunks, indexed by chunk.
+  std::vector<std::unique_ptr<ReadOnlyMemoryRegion>> chunks_;
+  int64_t bytes_ = 0;
+};
+
 // A thread-safe data structure for caching dataset elements.
 //
 // The expected use is that a single `MemoryWriterIterator` populates the
 // cache with dataset elements. Once all elements are cached, the cache can
 // be used by one or more `MemoryReaderIterator`s.
+//
+// The cache holds a prefix of the elements in memory. If the writer ran out of
+// memory budget, the remaining elements are held by a `MemoryCacheSpill`.
 class MemoryCache {
  public:
   MemoryCache() = default;
+  ~MemoryCache();
 
   // Marks the cache as completed.
   void Complete(std::vector<std::vector<Tensor>>&& cache);
 
+  // Marks the cache as completed, with the elements of `spill` following those
+  // of `cache`. `reserved_bytes` of `ram_budget_manager` held by the elements
+  // of `cache` are released when the cache is reset.
+  void Complete(std::vector<std::vector<Tensor>>&& cache,
+                std::unique_ptr<MemoryCacheSpill> spill,
+                std::shared_ptr<model::RamBudgetManager> ram_budget_manager,
+                int64_t reserved_bytes);
+
   // Returns whether the cache is completed.
   bool IsCompleted();
 
   // Resets the cache.
   void Reset();
 
-  // Returns the element at the given index.
+  // Returns the element at the given index, which must be held in memory.
   const std::vector<Tensor>& at(int64_t index);
 
+  // Copies the element at the given index to `out`, reading it from disk if
+  // it has been spilled.
+  Status Get(int64_t index, std::vector<Tensor>* out);
+
+  // Copies all elements to `out`.
+  Status GetAll(std::vector<std::vector<Tensor>>* out);
+
   // Returns the size of the cache.
   size_t size();
 
-  // Returns a reference to the cache's data. The returned reference will be
-  // invalidated by any call to Reset().
-  const std::vector<std::vector<Tensor>>& data();
+  // Returns the number of elements held in memory. These are the elements with
+  // an index below this number.
+  size_t size_in_memory();
 
  private:
+  void ReleaseBytes() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
   mutex mu_;
   // Determines whether all elements of the dataset have been cached.
   bool completed_ TF_GUARDED_BY(mu_) = false;
   std::vector<std::vector<Tensor>> cache_ TF_GUARDED_BY(mu_);
+  std::unique_ptr<MemoryCacheSpill> spill_ TF_GUARDED_BY(mu_);
+  std::shared_ptr<model::RamBudgetManager> ram_budget_manager_
+      TF_GUARDED_BY(mu_);
+  int64_t reserved_bytes_ TF_GUARDED_BY(mu_) = 0;
 };
 
 // A resource wrapping a shared instance of a memory cache.
@@ -0,0 +1,139 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/cache_ops.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/framework/model.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/tstring.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+std::vector<Tensor> MakeElement(int64_t i) {
+  return {test::AsTensor<int64_t>({i, i + 1, i + 2}),
+          test::AsScalar<tstring>(std::string(100, 'a' + i % 26))};
+}
+
+void ExpectElement(const std::vector<Tensor>& element, int64_t i) {
+  std::vector<Tensor> expected = MakeElement(i);
+  ASSERT_EQ(element.size(), expected.size());
+  for (int j = 0; j < expected.size(); ++j) {
+    test::ExpectEqual(element[j], expected[j]);
+  }
+}
+
+std::string SpillDirectory(const std::string& name) {
+  return io::JoinPath(testing::TmpDir(), "memory_cache_spill", name);
+}
+
+TEST(MemoryCacheSpillTest, AppendAndGet) {
+  std::unique_ptr<MemoryCacheSpill> spill;
+  TF_ASSERT_OK(MemoryCacheSpill::Create(
+      Env::Default(), SpillDirectory("append_and_get"), &spill));
+  for (int64_t i = 0; i < 10; ++i) {
+    TF_ASSERT_OK(spill->Append(MakeElement(i)));
+  }
+  EXPECT_EQ(spill->size(), 10);
+  EXPECT_GT(spill->bytes(), 0);
+
+  std::vector<Tensor> element;
+  EXPECT_TRUE(errors::IsFailedPrecondition(spill->Get(0, &element)));
+  TF_ASSERT_OK(spill->Seal());
+  for (int64_t i = 9; i >= 0; --i) {
+    TF_ASSERT_OK(spill->Get(i, &element));
+    ExpectElement(element, i);
+  }
+  EXPECT_TRUE(errors::IsOutOfRange(spill->Get(10, &element)));
+
+  // Elements appended after sealing go to a new chunk.
+  TF_ASSERT_OK(spill->Append(MakeElement(10)));
+  TF_ASSERT_OK(spill->Seal());
+  TF_ASSERT_OK(spill->Get(10, &element));
+  ExpectElement(element, 10);
+}
+
+TEST(MemoryCacheSpillTest, DeletesChunks) {
+  const std::string directory = SpillDirectory("deletes_chunks");
+  {
+    std::unique_ptr<MemoryCacheSpill> spill;
+    TF_ASSERT_OK(MemoryCacheSpill::Create(Env::Default(), directory, &spill));
+    TF_ASSERT_OK(spill->Append(MakeElement(0)));
+    TF_ASSERT_OK(spill->Seal());
+    TF_ASSERT_OK(spill->Append(MakeElement(1)));
+    std::vector<std::string> children;
+    TF_ASSERT_OK(Env::Default()->GetChildren(directory, &children));
+    EXPECT_EQ(children.size(), 2);
+  }
+  std::vector<std::string> children;
+  TF_ASSERT_OK(Env::Default()->GetChildren(directory, &children));
+  EXPECT_TRUE(children.empty());
+}
+
+TEST(MemoryCacheTest, ReadsBothTiers) {
+  std::unique_ptr<MemoryCacheSpill> spill;
+  TF_ASSERT_OK(MemoryCacheSpill::Create(
+      Env::Default(), SpillDirectory("reads_both_tiers"), &spill));
+  std::vector<std::vector<Tensor>> in_memory;
+  for (int64_t i = 0; i < 3; ++i) {
+    in_memory.push_back(MakeElement(i));
+  }
+  for (int64_t i = 3; i < 5; ++i) {
+    TF_ASSERT_OK(spill->Append(MakeElement(i)));
+  }
+  TF_ASSERT_OK(spill->Seal());
+
+  auto ram_budget_manager = std::make_shared<model::RamBudgetManager>(100);
+  ASSERT_TRUE(ram_budget_manager->RequestCacheBytes(60));
+  MemoryCache cache;
+  cache.Complete(std::move(in_memory), std::move(spill), ram_budget_manager,
+                 /*reserved_bytes=*/60);
+  EXPECT_TRUE(cache.IsCompleted());
+  EXPECT_EQ(cache.size(), 5);
+  EXPECT_EQ(cache.size_in_memory(), 3);
+  EXPECT_EQ(ram_budget_manager->AvailableModelRam(), 40);
+
+  std::vector<Tensor> element;
+  for (int64_t i = 0; i < 5; ++i) {
+    TF_ASSERT_OK(cache.Get(i, &element));
+    ExpectElement(element, i);
+  }
+  EXPECT_TRUE(errors::IsOutOfRange(cache.Get(5, &element)));
+  std::vector<std::vector<Tensor>> elements;
+  TF_ASSERT_OK(cache.GetAll(&elements));
+  ASSERT_EQ(elements.size(), 5);
+  for (int64_t i = 0; i < 5; ++i) {
+    ExpectElement(elements[i], i);
+  }
+
+  cache.Reset();
+  EXPECT_FALSE(cache.IsCompleted());
+  EXPECT_EQ(cache.size(), 0);
+  EXPECT_EQ(ram_budget_manager->AvailableModelRam(), 100);
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
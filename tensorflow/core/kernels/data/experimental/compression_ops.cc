@@ -15,6 +15,9 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/data/experimental/compression_ops.h"
 
+#include <string>
+#include <vector>
+
 #include "tensorflow/core/data/compression_utils.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/variant.h"
@@ -25,7 +28,16 @@ namespace data {
 namespace experimental {
 
 CompressElementOp::CompressElementOp(OpKernelConstruction* ctx)
-    : OpKernel(ctx) {}
+    : OpKernel(ctx) {
+  std::string codec;
+  OP_REQUIRES_OK(ctx, ctx->GetAttr(kCodec, &codec));
+  if (codec == "columnar") {
+    codec_ = CompressionCodec::kColumnar;
+  } else {
+    OP_REQUIRES(ctx, codec == "snappy",
+                errors::InvalidArgument("Unknown compression codec: ", codec));
+  }
+}
 
 void CompressElementOp::Compute(OpKernelContext* ctx) {
   std::vector<Tensor> components;
@@ -34,7 +46,7 @@ void CompressElementOp::Compute(OpKernelContext* ctx) {
     components.push_back(ctx->input(i));
   }
   CompressedElement compressed;
-  OP_REQUIRES_OK(ctx, CompressElement(components, &compressed));
+  OP_REQUIRES_OK(ctx, CompressElement(components, codec_, &compressed));
 
   Tensor* output;
   OP_REQUIRES_OK(ctx, ctx->allocate_output(0, TensorShape({}), &output));
@@ -68,7 +80,10 @@ void UncompressElementOp::Compute(OpKernelContext* ctx) {
           tensor.DebugString()));
 
   std::vector<Tensor> components;
-  OP_REQUIRES_OK(ctx, UncompressElement(*compressed, &components));
+  OP_REQUIRES_OK(
+      ctx, UncompressElement(
+               *compressed, &components,
+               ctx->device()->tensorflow_cpu_worker_threads()->workers));
   OP_REQUIRES(ctx, components.size() == output_types_.size(),
               errors::FailedPrecondition("Expected ", output_types_.size(),
                                          " outputs from uncompress, but got ",
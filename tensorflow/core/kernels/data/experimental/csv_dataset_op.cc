@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow/core/framework/dataset.h"
 #include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/framework/shape_inference.h"
+#include "tensorflow/core/kernels/csv_util.h"
 #include "tensorflow/core/lib/io/inputstream_interface.h"
 #include "tensorflow/core/lib/io/random_inputstream.h"
 #include "tensorflow/core/lib/io/zlib_compression_options.h"
@@ -562,7 +563,9 @@ class CSVDatasetOp : public DatasetOpKernel {
             }
 
           } else {
-            pos_++;
+            // Skip to the next quote, or to the end of the buffer.
+            const size_t quote = StringPiece(buffer_).find('"', pos_);
+            pos_ = quote == StringPiece::npos ? buffer_.size() : quote;
           }
         }
       }
@@ -657,6 +660,10 @@ class CSVDatasetOp : public DatasetOpKernel {
             }
           }
 
+          // Skip to the next special character a word at a time.
+          pos_ = FindCsvFieldEnd(StringPiece(buffer_), pos_, dataset()->delim_,
+                                 dataset()->use_quote_delim_);
+          if (pos_ >= buffer_.size()) continue;
           char ch = buffer_[pos_];
 
           if (ch == dataset()->delim_) {
@@ -14,13 +14,22 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/kernels/data/experimental/directed_interleave_dataset_op.h"
 
+#include <cstdint>
+#include <limits>
+#include <list>
+#include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/data/dataset_utils.h"
 #include "tensorflow/core/data/name_utils.h"
+#include "tensorflow/core/data/serialization_utils.h"
 #include "tensorflow/core/data/split_utils.h"
 #include "tensorflow/core/framework/partial_tensor_shape.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/variant_tensor_data.h"
 #include "tensorflow/core/lib/hash/hash.h"
 #include "tensorflow/core/platform/errors.h"
 
@@ -45,8 +54,19 @@ namespace experimental {
 
 constexpr char kCycleLength[] = "cycle_length";
 constexpr char kDataInputImplEmpty[] = "data_input_impl_empty";
+constexpr char kDataInputImplUnopened[] = "data_input_impl_unopened";
 constexpr char kSelectorInputImplEmpty[] = "selector_input_impl_empty";
 
+// Experiment that opens the data inputs lazily, when they are first selected,
+// and bounds the number of data input iterators held in memory.
+constexpr char kBoundedInputsExperiment[] = "bounded_directed_interleave";
+
+// If `kBoundedInputsExperiment` is enabled, the maximum number of data input
+// iterators held in memory. The least recently selected inputs beyond this
+// number are parked: their state is saved and their iterators are destroyed,
+// to be restored the next time they are selected.
+constexpr int64_t kMaxLiveInputs = 256;
+
 class DirectedInterleaveDatasetOp::Dataset : public DatasetBase {
  public:
   Dataset(OpKernelContext* ctx, const DatasetBase* selector_input,
@@ -170,13 +190,16 @@ class DirectedInterleaveDatasetOp::Dataset : public DatasetBase {
       TF_RETURN_IF_ERROR(dataset()->selector_input_->MakeIterator(
           &input_contexts_[0], this, prefix(), &selector_input_impl_));
       ctx->MergeCheckpoint(input_contexts_[0].checkpoint());
-      data_input_impls_.resize(dataset()->data_inputs_.size());
-      for (size_t i = 0; i < data_input_impls_.size(); ++i) {
-        const DatasetBase* data_input = dataset()->data_inputs_[i];
-        TF_RETURN_IF_ERROR(data_input->MakeIterator(
-            &input_contexts_[i + 1], this,
-            strings::StrCat(prefix(), "[", i, "]"), &data_input_impls_[i]));
-        ctx->MergeCheckpoint(input_contexts_[i + 1].checkpoint());
+      const size_t num_inputs = dataset()->data_inputs_.size();
+      data_input_impls_.resize(num_inputs);
+      input_states_.resize(num_inputs, InputState::kUnopened);
+      lru_positions_.resize(num_inputs, live_inputs_.end());
+      if (GetExperiments().contains(kBoundedInputsExperiment)) {
+        max_live_inputs_ = kMaxLiveInputs;
+        return absl::OkStatus();
+      }
+      for (size_t i = 0; i < num_inputs; ++i) {
+        TF_RETURN_IF_ERROR(OpenInput(ctx, i, ctx->is_restoring()));
       }
       return absl::OkStatus();
     }
@@ -208,7 +231,8 @@ class DirectedInterleaveDatasetOp::Dataset : public DatasetBase {
               " >= ", data_input_impls_.size());
         }
 
-        if (data_input_impls_[selected_input]) {
+        if (input_states_[selected_input] != InputState::kExhausted) {
+          TF_RETURN_IF_ERROR(EnsureInputLive(ctx, selected_input));
           bool end_of_selected_input = false;
           TF_RETURN_IF_ERROR(data_input_impls_[selected_input]->GetNext(
               &input_contexts_[selected_input + 1], out_tensors,
@@ -228,7 +252,7 @@ class DirectedInterleaveDatasetOp::Dataset : public DatasetBase {
             return absl::OkStatus();
           }
 
-          data_input_impls_[selected_input].reset();
+          CloseInput(selected_input, InputState::kExhausted);
           --num_active_inputs_;
 
           if (num_active_inputs_ == 0) {
@@ -261,12 +285,27 @@ class DirectedInterleaveDatasetOp::Dataset : public DatasetBase {
         TF_RETURN_IF_ERROR(SaveInput(ctx, writer, selector_input_impl_));
       }
       for (size_t i = 0; i < data_input_impls_.size(); ++i) {
-        const auto& data_input_impl = data_input_impls_[i];
+        const InputState state = input_states_[i];
         TF_RETURN_IF_ERROR(writer->WriteScalar(
             full_name(strings::StrCat(kDataInputImplEmpty, "[", i, "]")),
-            static_cast<int64_t>(!data_input_impl)));
-        if (data_input_impl) {
-          TF_RETURN_IF_ERROR(SaveInput(ctx, writer, data_input_impl));
+            static_cast<int64_t>(state == InputState::kExhausted)));
+        switch (state) {
+          case InputState::kUnopened:
+            TF_RETURN_IF_ERROR(writer->WriteScalar(
+                full_name(strings::StrCat(kDataInputImplUnopened, "[", i, "]")),
+                1));
+            break;
+          case InputState::kLive:
+            TF_RETURN_IF_ERROR(SaveInput(ctx, writer, data_input_impls_[i]));
+            break;
+          case InputState::kParked:
+            if (!ctx->symbolic_checkpoint()) {
+              TF_RETURN_IF_ERROR(
+                  WriteVariantTensorData(ParkedInputData(i), writer));
+            }
+            break;
+          case InputState::kExhausted:
+            break;
         }
       }
       return absl::OkStatus();
@@ -283,25 +322,144 @@ class DirectedInterleaveDatasetOp::Dataset : public DatasetBase {
       } else {
         selector_input_impl_.reset();
       }
+      parked_inputs_.clear();
       for (size_t i = 0; i < data_input_impls_.size(); ++i) {
         TF_RETURN_IF_ERROR(reader->ReadScalar(
             full_name(strings::StrCat(kDataInputImplEmpty, "[", i, "]")),
             &input_empty));
-        if (!static_cast<bool>(input_empty)) {
-          TF_RETURN_IF_ERROR(RestoreInput(ctx, reader, data_input_impls_[i]));
-        } else {
-          data_input_impls_[i].reset();
+        if (static_cast<bool>(input_empty)) {
+          CloseInput(i, InputState::kExhausted);
+          continue;
+        }
+        // Checkpoints written before inputs were opened lazily do not have
+        // this key, and all of their non-empty inputs are opened.
+        if (reader->Contains(full_name(
+                strings::StrCat(kDataInputImplUnopened, "[", i, "]")))) {
+          CloseInput(i, InputState::kUnopened);
+          continue;
         }
+        if (input_states_[i] != InputState::kLive) {
+          TF_RETURN_IF_ERROR(OpenInput(ctx, i, /*is_restoring=*/true));
+        }
+        TF_RETURN_IF_ERROR(RestoreInput(ctx, reader, data_input_impls_[i]));
+        TF_RETURN_IF_ERROR(ParkLeastRecentlyUsedInputs());
       }
       return absl::OkStatus();
     }
 
    private:
+    // The state of a data input iterator.
+    enum class InputState {
+      // The iterator has not been created yet.
+      kUnopened,
+      // The iterator is held in memory.
+      kLive,
+      // The iterator state is saved in `parked_inputs_`.
+      kParked,
+      // The input has reached its end.
+      kExhausted,
+    };
+
+    // Creates the iterator of data input `index`.
+    Status OpenInput(IteratorContext* ctx, int64_t index, bool is_restoring)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      IteratorContext::Params params(&input_contexts_[index + 1]);
+      params.is_restoring = is_restoring;
+      IteratorContext input_ctx(std::move(params));
+      TF_RETURN_IF_ERROR(dataset()->data_inputs_[index]->MakeIterator(
+          &input_ctx, this, strings::StrCat(prefix(), "[", index, "]"),
+          &data_input_impls_[index]));
+      ctx->MergeCheckpoint(input_ctx.checkpoint());
+      input_states_[index] = InputState::kLive;
+      live_inputs_.push_front(index);
+      lru_positions_[index] = live_inputs_.begin();
+      return absl::OkStatus();
+    }
+
+    // Destroys the iterator of data input `index`, if any, and sets the input
+    // state to `state`.
+    void CloseInput(int64_t index, InputState state)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      data_input_impls_[index].reset();
+      if (lru_positions_[index] != live_inputs_.end()) {
+        live_inputs_.erase(lru_positions_[index]);
+        lru_positions_[index] = live_inputs_.end();
+      }
+      input_states_[index] = state;
+    }
+
+    // Makes sure the iterator of data input `index` is held in memory, opening
+    // or unparking it if needed, and marks it as the most recently used input.
+    Status EnsureInputLive(IteratorContext* ctx, int64_t index)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      switch (input_states_[index]) {
+        case InputState::kLive:
+          live_inputs_.splice(live_inputs_.begin(), live_inputs_,
+                              lru_positions_[index]);
+          return absl::OkStatus();
+        case InputState::kUnopened:
+          TF_RETURN_IF_ERROR(OpenInput(ctx, index, /*is_restoring=*/false));
+          break;
+        case InputState::kParked: {
+          TF_RETURN_IF_ERROR(OpenInput(ctx, index, /*is_restoring=*/true));
+          VariantTensorDataReader reader(ParkedInputData(index));
+          IteratorContext::Params params(&input_contexts_[index + 1]);
+          params.is_restoring = true;
+          IteratorContext restore_ctx(std::move(params));
+          TF_RETURN_IF_ERROR(
+              RestoreInput(&restore_ctx, &reader, data_input_impls_[index]));
+          ctx->MergeCheckpoint(restore_ctx.checkpoint());
+          parked_inputs_.erase(index);
+          break;
+        }
+        case InputState::kExhausted:
+          return errors::Internal("Data input ", index, " is exhausted.");
+      }
+      return ParkLeastRecentlyUsedInputs();
+    }
+
+    // Returns the saved state of the parked input `index`.
+    std::vector<const VariantTensorData*> ParkedInputData(int64_t index)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      std::vector<const VariantTensorData*> data;
+      for (const auto& iterator_data : parked_inputs_[index]) {
+        data.push_back(iterator_data.get());
+      }
+      return data;
+    }
+
+    // Parks the least recently used inputs beyond `max_live_inputs_`.
+    Status ParkLeastRecentlyUsedInputs() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      while (live_inputs_.size() > max_live_inputs_) {
+        const int64_t index = live_inputs_.back();
+        SerializationContext::Params params;
+        params.external_state_policy = ExternalStatePolicy::POLICY_IGNORE;
+        SerializationContext serialization_ctx(std::move(params));
+        VariantTensorDataWriter writer;
+        Status status =
+            data_input_impls_[index]->Save(&serialization_ctx, &writer);
+        if (!status.ok()) {
+          // The input cannot be parked, so the number of live inputs cannot be
+          // bounded.
+          LOG(WARNING) << "Failed to park input " << index
+                       << " of DirectedInterleave; all " << live_inputs_.size()
+                       << " opened inputs will be kept in memory: " << status;
+          max_live_inputs_ = std::numeric_limits<int64_t>::max();
+          return absl::OkStatus();
+        }
+        writer.ReleaseData(&parked_inputs_[index]);
+        CloseInput(index, InputState::kParked);
+        VLOG(2) << "DirectedInterleave parked input " << index;
+      }
+      return absl::OkStatus();
+    }
+
     void ResetInputs() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
       selector_input_impl_.reset();
-      for (auto& data_input_impl : data_input_impls_) {
-        data_input_impl.reset();
+      for (size_t i = 0; i < data_input_impls_.size(); ++i) {
+        CloseInput(i, InputState::kExhausted);
       }
+      parked_inputs_.clear();
       num_active_inputs_ = 0;
     }
 
@@ -312,6 +470,19 @@ class DirectedInterleaveDatasetOp::Dataset : public DatasetBase {
     std::unique_ptr<IteratorBase> selector_input_impl_ TF_GUARDED_BY(mu_);
     std::vector<std::unique_ptr<IteratorBase>> data_input_impls_
         TF_GUARDED_BY(mu_);
+    std::vector<InputState> input_states_ TF_GUARDED_BY(mu_);
+    // Indices of the live inputs, from the most to the least recently used,
+    // and the position of each live input in that list.
+    std::list<int64_t> live_inputs_ TF_GUARDED_BY(mu_);
+    std::vector<std::list<int64_t>::iterator> lru_positions_
+        TF_GUARDED_BY(mu_);
+    // The saved state of the parked inputs.
+    absl::flat_hash_map<int64_t,
+                        std::vector<std::unique_ptr<VariantTensorData>>>
+        parked_inputs_ TF_GUARDED_BY(mu_);
+    int64_t max_live_inputs_ TF_GUARDED_BY(mu_) =
+        std::numeric_limits<int64_t>::max();
+    // Number of inputs that have not reached their end.
     int64_t num_active_inputs_ TF_GUARDED_BY(mu_);
   };
 
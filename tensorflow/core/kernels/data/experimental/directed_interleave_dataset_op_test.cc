@@ -433,6 +433,56 @@ ITERATOR_SAVE_AND_RESTORE_TEST_P(DirectedInterleaveDatasetOpTest,
                                  DirectedInterleaveDatasetParams,
                                  IteratorSaveAndRestoreTestCases())
 
+// Test case: more inputs than the number of input iterators held in memory
+// when the `bounded_directed_interleave` experiment is enabled. Each input is
+// selected twice, so that the second selection unparks it.
+DirectedInterleaveDatasetParams ManyInputsParams(
+    std::vector<Tensor>* expected_outputs) {
+  constexpr int64_t kNumInputs = 300;
+  std::vector<int64_t> selector;
+  std::vector<RangeDatasetParams> inputs;
+  for (int64_t i = 0; i < kNumInputs; ++i) {
+    inputs.push_back(RangeDatasetParams(10 * i, 10 * i + 2, 1));
+    selector.push_back(i);
+  }
+  for (int64_t i = 0; i < kNumInputs; ++i) {
+    selector.push_back(i);
+  }
+  expected_outputs->clear();
+  for (int64_t i = 0; i < 2 * kNumInputs; ++i) {
+    expected_outputs->push_back(CreateTensor<int64_t>(
+        TensorShape{}, {10 * (i % kNumInputs) + i / kNumInputs}));
+  }
+  return DirectedInterleaveDatasetParams(
+      TensorSliceDatasetParams(
+          /*components=*/{CreateTensor<int64_t>(
+              TensorShape{static_cast<int64_t>(selector.size())}, selector)},
+          /*node_name=*/"tensor_slice"),
+      inputs,
+      /*stop_on_empty_dataset=*/false,
+      /*output_dtypes=*/{DT_INT64},
+      /*output_shapes=*/{PartialTensorShape({})},
+      /*num_input_datasets=*/kNumInputs,
+      /*node_name=*/kNodeName);
+}
+
+TEST_F(DirectedInterleaveDatasetOpTest, BoundedInputs) {
+  setenv("TF_JOB_NAME", "test_job", /*overwrite=*/1);
+  setenv("TF_TASK_ID", "0", /*overwrite=*/1);
+  setenv("TF_DATA_EXPERIMENT_OPT_IN", "bounded_directed_interleave",
+         /*overwrite=*/1);
+  std::vector<Tensor> expected_outputs;
+  auto dataset_params = ManyInputsParams(&expected_outputs);
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_EXPECT_OK(CheckIteratorGetNext(expected_outputs, /*compare_order=*/true));
+  TF_EXPECT_OK(CheckIteratorSaveAndRestore(
+      dataset_params.iterator_prefix(), expected_outputs,
+      /*breakpoints=*/{0, 1, 299, 350, 600}, /*compare_order=*/true));
+  unsetenv("TF_JOB_NAME");
+  unsetenv("TF_TASK_ID");
+  unsetenv("TF_DATA_EXPERIMENT_OPT_IN");
+}
+
 TEST_F(DirectedInterleaveDatasetOpTest, InvalidArguments) {
   std::vector<DirectedInterleaveDatasetParams> invalid_params_vec = {
       InvalidSelectorOuputDataType(), InvalidSelectorOuputShape(),
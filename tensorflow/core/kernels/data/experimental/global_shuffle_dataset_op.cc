@@ -50,6 +50,7 @@ namespace {
 
 constexpr int32_t kIndexShuffleRounds = 8;
 
+constexpr const char kBlockSize[] = "block_size";
 constexpr const char kDatasetType[] = "GlobalShuffle";
 constexpr const char kElementCount[] = "element_count";
 constexpr const char kGlobalShuffleDataset[] = "GlobalShuffleDataset";
@@ -72,15 +73,18 @@ class GlobalShuffleDatasetOp : public UnaryDatasetOpKernel {
   class Dataset;
 
   bool reshuffle_each_iteration_ = true;
+  int64_t block_size_ = 1;
 };
 
 class GlobalShuffleDatasetOp::Dataset : public DatasetBase {
  public:
   Dataset(OpKernelContext* ctx, const DatasetBase* input,
-          SeedGeneratorManager* seed_generator, RandomSeeds&& input_seeds,
-          bool owns_resource, ResourceHandle&& resource_handle)
+          int64_t block_size, SeedGeneratorManager* seed_generator,
+          RandomSeeds&& input_seeds, bool owns_resource,
+          ResourceHandle&& resource_handle)
       : DatasetBase(DatasetContext(ctx)),
         input_(input),
+        block_size_(block_size),
         seed_generator_(seed_generator),
         input_seeds_(std::move(input_seeds)),
         owns_resource_(owns_resource),
@@ -152,11 +156,14 @@ class GlobalShuffleDatasetOp::Dataset : public DatasetBase {
     AttrValue reshuffle_each_iteration;
     b->BuildAttrValue(seed_generator_->get()->reshuffle_each_iteration(),
                       &reshuffle_each_iteration);
+    AttrValue block_size;
+    b->BuildAttrValue(block_size_, &block_size);
     return b->AddDataset(
         this, /*inputs=*/
         {input_graph_node, seed_node, seed2_node, resource_handle_node},
         /*attrs=*/
-        {std::make_pair(kReshuffleEachIteration, reshuffle_each_iteration)},
+        {std::make_pair(kReshuffleEachIteration, reshuffle_each_iteration),
+         std::make_pair(kBlockSize, block_size)},
         output);
   }
 
@@ -168,6 +175,11 @@ class GlobalShuffleDatasetOp::Dataset : public DatasetBase {
   class Iterator;
 
   const DatasetBase* const input_;
+  // If greater than 1, the dataset shuffles blocks of `block_size_`
+  // consecutive elements, and the elements within each block, instead of
+  // shuffling all elements. This keeps most reads of file-based inputs close to
+  // the previous one, at the cost of some randomness.
+  const int64_t block_size_;
   SeedGeneratorManager* const seed_generator_;  // Owned
   const RandomSeeds input_seeds_;
   const bool owns_resource_;
@@ -229,6 +241,9 @@ class GlobalShuffleDatasetOp::Dataset::Iterator
     uint32_t seed3 = static_cast<uint32_t>(seed3_);
     uint64_t max_index =
         cardinality_ > 0 ? static_cast<uint64_t>(cardinality_ - 1) : 0;
+    if (dataset()->block_size_ > 1) {
+      return GetBlockIndexMapper(std::move(parent_index_mapper), max_index);
+    }
     return [parent_index_mapper, seed, seed2, seed3,
             max_index](size_t element_position) -> absl::StatusOr<size_t> {
       if (parent_index_mapper != nullptr) {
@@ -247,6 +262,46 @@ class GlobalShuffleDatasetOp::Dataset::Iterator
     };
   }
 
+  // Shuffles the order of the blocks, then the order of the elements within
+  // each block. The positions which the last, partial block leaves empty map to
+  // `NotFound`, which random access iterators skip.
+  IndexMapperFn GetBlockIndexMapper(IndexMapperFn parent_index_mapper,
+                                    uint64_t max_index) const
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    uint32_t seed = static_cast<uint32_t>(seed_);
+    uint32_t seed2 = static_cast<uint32_t>(seed2_);
+    uint32_t seed3 = static_cast<uint32_t>(seed3_);
+    const uint64_t block_size = static_cast<uint64_t>(dataset()->block_size_);
+    const uint64_t max_block = max_index / block_size;
+    return [parent_index_mapper, seed, seed2, seed3, block_size, max_block,
+            max_index](size_t element_position) -> absl::StatusOr<size_t> {
+      if (parent_index_mapper != nullptr) {
+        TF_ASSIGN_OR_RETURN(element_position,
+                            parent_index_mapper(element_position));
+      }
+      const uint64_t block_position = element_position / block_size;
+      if (block_position > max_block) {
+        return absl::OutOfRangeError("Out of range");
+      }
+      const uint64_t block =
+          max_block == 0
+              ? 0
+              : tensorflow::random::index_shuffle(
+                    block_position, {seed, seed2, seed3}, max_block,
+                    kIndexShuffleRounds);
+      // Each block gets its own order of elements.
+      const uint64_t offset = tensorflow::random::index_shuffle(
+          element_position % block_size,
+          {seed ^ static_cast<uint32_t>(block), seed2, seed3}, block_size - 1,
+          kIndexShuffleRounds);
+      const uint64_t index = block * block_size + offset;
+      if (index > max_index) {
+        return absl::NotFoundError("Past the end of the last block");
+      }
+      return static_cast<int64_t>(index);
+    };
+  }
+
   absl::Status SaveInternal(SerializationContext* ctx,
                             IteratorStateWriter* writer) override {
     absl::MutexLock l(&mu_);
@@ -316,6 +371,9 @@ GlobalShuffleDatasetOp::GlobalShuffleDatasetOp(OpKernelConstruction* ctx)
     OP_REQUIRES_OK(
         ctx, ctx->GetAttr(kReshuffleEachIteration, &reshuffle_each_iteration_));
   }
+  if (ctx->HasAttr(kBlockSize)) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr(kBlockSize, &block_size_));
+  }
 }
 
 void GlobalShuffleDatasetOp::MakeDataset(OpKernelContext* ctx,
@@ -373,8 +431,9 @@ void GlobalShuffleDatasetOp::MakeDataset(OpKernelContext* ctx,
     OP_REQUIRES_OK(ctx, s);
   }
 
-  *output = new Dataset(ctx, input, seed_generator, std::move(input_seeds),
-                        owns_resource, std::move(handle));
+  *output = new Dataset(ctx, input, block_size_, seed_generator,
+                        std::move(input_seeds), owns_resource,
+                        std::move(handle));
 }
 
 std::unique_ptr<IteratorBase>
@@ -650,13 +650,21 @@ class ParseExampleDatasetOp : public UnaryDatasetOpKernel {
                           std::vector<Tensor>* output) {
         thread::ThreadPool* device_threadpool =
             ctx->flr()->device()->tensorflow_cpu_worker_threads()->workers;
+        // The input is usually a single batch of serialized examples, which
+        // is parsed in place. Only multiple input tensors are concatenated.
+        absl::Span<const tstring> serialized;
         std::vector<tstring> slice_vec;
-        for (const Tensor& t : input) {
-          auto serialized_t = t.flat<tstring>();
-          absl::Span<const tstring> slice(serialized_t.data(),
-                                          serialized_t.size());
-          for (auto it = slice.begin(); it != slice.end(); it++)
-            slice_vec.push_back(*it);
+        if (input.size() == 1) {
+          auto serialized_t = input[0].flat<tstring>();
+          serialized = absl::Span<const tstring>(serialized_t.data(),
+                                                 serialized_t.size());
+        } else {
+          for (const Tensor& t : input) {
+            auto serialized_t = t.flat<tstring>();
+            slice_vec.insert(slice_vec.end(), serialized_t.data(),
+                             serialized_t.data() + serialized_t.size());
+          }
+          serialized = slice_vec;
         }
         example::FastParseExampleConfig config = dataset()->config_;
         // local copy of config_ for modification.
@@ -666,7 +674,7 @@ class ParseExampleDatasetOp : public UnaryDatasetOpKernel {
         }
         example::Result example_result;
         TF_RETURN_IF_ERROR(FastParseExample(
-            config, slice_vec, {}, device_threadpool, &example_result));
+            config, serialized, {}, device_threadpool, &example_result));
         (*output).resize(dataset()->key_to_output_index_.size());
         for (int d = 0; d < dataset()->dense_keys_.size(); ++d) {
           int output_index =
@@ -147,6 +147,14 @@ Status IteratorResource::GetNext(OpKernelContext* ctx,
   const int64_t get_next_latency_micros =
       env_.NowMicros() - absl::ToUnixMicros(start_time);
   tf_dataz_metrics_collector_->RecordGetNextLatency(get_next_latency_micros);
+  const ThreadingOptions& threading_options =
+      dataset->options().threading_options();
+  if (status.ok() && !*end_of_sequence &&
+      threading_options.optional_numa_node_case() ==
+          ThreadingOptions::kNumaNode) {
+    tf_dataz_metrics_collector_->RecordElementNumaPlacement(
+        *out_tensors, threading_options.numa_node());
+  }
   captured_state->MergeCheckpoint(iter_ctx.checkpoint());
   return status;
 }
@@ -180,6 +188,27 @@ absl::Status IteratorResource::GetModelProto(std::string& model_proto) {
   return absl::OkStatus();
 }
 
+absl::StatusOr<BottleneckReport> IteratorResource::AnalyzeBottleneck() {
+  std::shared_ptr<State> captured_state;
+  {
+    tf_shared_lock l(mu_);
+    captured_state = iterator_state_;
+  }
+  if (!captured_state->iterator()) {
+    return absl::FailedPreconditionError(
+        "AnalyzeBottleneck() failed because the iterator has not been "
+        "initialized. Ensure that you have run the initializer operation for "
+        "this iterator before analyzing it.");
+  }
+  std::shared_ptr<model::Model> model = captured_state->model();
+  if (!model) {
+    return absl::NotFoundError(
+        "Cannot find this iterator's analytical model. Did you disable "
+        "autotune for the dataset used to create this iterator?");
+  }
+  return data::AnalyzeBottleneck(*model);
+}
+
 Status IteratorResource::Save(OpKernelContext* ctx,
                               ExternalStatePolicy external_state_policy,
                               IteratorStateWriter* writer) {
@@ -20,6 +20,8 @@ limitations under the License.
 #include <utility>
 #include <vector>
 
+#include "absl/status/statusor.h"
+#include "tensorflow/core/data/bottleneck_analysis.h"
 #include "tensorflow/core/data/dataset_utils.h"
 #include "tensorflow/core/data/metric_utils.h"
 #include "tensorflow/core/data/tfdataz_metrics.h"
@@ -58,6 +60,10 @@ class IteratorResource : public ResourceBase {
 
   absl::Status GetModelProto(std::string& model_proto);
 
+  // Analyzes the autotuning model of the iterator for the stage bounding the
+  // throughput of its pipeline, see `AnalyzeBottleneck`.
+  absl::StatusOr<BottleneckReport> AnalyzeBottleneck();
+
   // Saves a checkpoint of the state of the iterator through the given `writer`.
   Status Save(OpKernelContext* ctx, ExternalStatePolicy external_state_policy,
               IteratorStateWriter* writer);
@@ -136,6 +136,11 @@ class ModelDatasetOp::Dataset : public DatasetBase {
                           : dataset()->ram_budget_) {
       cancellation_manager_ = std::make_unique<CancellationManager>();
       model_ = std::make_shared<model::Model>();
+      if (GetExperiments().contains("autotune_shared_cpu_budget")) {
+        // Divide the cores of the host with the other pipelines of the process
+        // instead of tuning each of them to use every core.
+        model_->SetCpuBudgetManager(model::CpuBudgetManager::Global());
+      }
     }
 
     ~Iterator() override { cancellation_manager_->StartCancel(); }
@@ -364,6 +364,11 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
           num_parallel_calls_(std::make_shared<model::SharedState>(
               params.dataset->num_parallel_calls_, mu_,
               num_parallel_calls_cond_var_)),
+          active_cycle_length_(std::make_shared<model::SharedState>(
+              ShouldTuneCycleLength(*params.dataset, deterministic)
+                  ? model::kAutotune
+                  : params.dataset->cycle_length_,
+              mu_, num_parallel_calls_cond_var_)),
           deterministic_(deterministic),
           current_elements_(params.dataset->cycle_length_) {}
 
@@ -400,6 +405,10 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
         num_parallel_calls_->value = std::min(
             GetAutotuneDefaultParallelism(ctx), dataset()->cycle_length_);
       }
+      if (active_cycle_length_->value == model::kAutotune) {
+        // The cycle length is tuned together with the parallelism.
+        active_cycle_length_->value = num_parallel_calls_->value;
+      }
       cancellation_manager_ = std::make_unique<CancellationManager>();
       IteratorContext::Params params(ctx);
       params.interleave_depth += 1;
@@ -479,8 +488,12 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
           std::move(args),
           {model::MakeParameter(kParallelism, num_parallel_calls_, /*min=*/min,
                                 /*max=*/dataset()->cycle_length_),
-           model::MakeNonTunableParameter(kCycleLength,
-                                          dataset()->cycle_length_),
+           active_cycle_length_->tunable
+               ? model::MakeParameter(kCycleLength, active_cycle_length_,
+                                      /*min=*/1,
+                                      /*max=*/dataset()->cycle_length_)
+               : model::MakeNonTunableParameter(kCycleLength,
+                                                dataset()->cycle_length_),
            model::MakeNonTunableParameter(kDeterministic,
                                           deterministic_ ? 1.0 : 0.0),
            model::MakeNonTunableParameter(
@@ -710,7 +723,7 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
     void EnsureInitialElementsCreated(IteratorContext* ctx)
         TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
       if (!initial_elements_created_) {
-        for (int i = 0; i < dataset()->cycle_length_; ++i) {
+        for (int i = 0; i < ActiveCycleLength(); ++i) {
           current_elements_[i] = MakeElement(ctx);
           if (!current_elements_[i]) {
             break;
@@ -759,6 +772,7 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
     // points to a valid result or is null if end of input has been reached.
     bool Consume(IteratorContext* ctx, std::shared_ptr<Result>* result)
         TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      FillActiveCycle(ctx);
       if (deterministic_) {
         return ConsumeHelper(ctx, result);
       }
@@ -814,8 +828,12 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
         }
         // We've consumed all results from the element. Get a new element from
         // future_elements, or create a new element if no future elements are
-        // available.
-        if (!future_elements_.empty()) {
+        // available. If autotuning shrank the cycle below the element's index,
+        // leave its slot empty instead.
+        if (cycle_index_ >= ActiveCycleLength()) {
+          current_elements_[cycle_index_].reset();
+          UpdateLastValidCurrentElement();
+        } else if (!future_elements_.empty()) {
           std::shared_ptr<Element> future_element =
               std::move(future_elements_.front());
           future_elements_.pop_front();
@@ -836,15 +854,7 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
             element->cycle_index = cycle_index_;
             current_workers_cond_var_.notify_one();
           }
-          while (last_valid_current_element_ >= 0 &&
-                 !current_elements_[last_valid_current_element_]) {
-            last_valid_current_element_--;
-            if (cycle_index_ > last_valid_current_element_) {
-              // We are about to move the cycle index below in
-              // AdvanceToNextInCycle().
-              cycle_index_ = last_valid_current_element_;
-            }
-          }
+          UpdateLastValidCurrentElement();
         }
         if (last_valid_current_element_ != -1) {
           AdvanceToNextInCycle();
@@ -852,6 +862,71 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
       }
     }
 
+    // Moves `last_valid_current_element_` back to the last non-null element
+    // after elements at the end of the cycle were removed.
+    void UpdateLastValidCurrentElement() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      while (last_valid_current_element_ >= 0 &&
+             !current_elements_[last_valid_current_element_]) {
+        last_valid_current_element_--;
+        if (cycle_index_ > last_valid_current_element_) {
+          // We are about to move the cycle index below in
+          // AdvanceToNextInCycle().
+          cycle_index_ = last_valid_current_element_;
+        }
+      }
+    }
+
+    // The number of slots of `current_elements_` which are refilled when their
+    // element is exhausted. Elements in the other slots are drained.
+    int64_t ActiveCycleLength() const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      return std::min(static_cast<int64_t>(active_cycle_length_->value),
+                      dataset()->cycle_length_);
+    }
+
+    // Fills the empty slots of the cycle which autotuning has activated since
+    // they were drained.
+    void FillActiveCycle(IteratorContext* ctx)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      if (!active_cycle_length_->tunable || !initial_elements_created_) {
+        return;
+      }
+      for (int64_t i = 0; i < ActiveCycleLength() && !end_of_input_; ++i) {
+        if (current_elements_[i]) {
+          continue;
+        }
+        if (!future_elements_.empty()) {
+          current_elements_[i] = std::move(future_elements_.front());
+          future_elements_.pop_front();
+          if (current_elements_[i]->iterator) {
+            EnableAutotune(ctx, current_elements_[i]->iterator.get());
+          }
+          future_workers_cond_var_.notify_one();
+        } else {
+          current_elements_[i] = MakeElement(ctx);
+          if (!current_elements_[i]) {
+            break;
+          }
+          elements_to_process_.push_back(i);
+        }
+        current_elements_[i]->cycle_index = i;
+        current_workers_cond_var_.notify_one();
+        last_valid_current_element_ =
+            std::max(last_valid_current_element_, i);
+      }
+    }
+
+    // Whether the cycle length is tuned. Changing the cycle length changes the
+    // order of the outputs, so it is only tuned when the caller asked for both
+    // the cycle length and the parallelism to be tuned and does not need a
+    // deterministic order.
+    static bool ShouldTuneCycleLength(const Dataset& dataset,
+                                      bool deterministic) {
+      return !deterministic &&
+             dataset.input_cycle_length_ == model::kAutotune &&
+             dataset.num_parallel_calls_ == model::kAutotune &&
+             GetExperiments().contains("autotune_cycle_length");
+    }
+
     // Creates a new element.
     std::shared_ptr<Element> MakeElement(IteratorContext* ctx)
         TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
@@ -1661,6 +1736,10 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
     // Identifies the maximum number of parallel calls.
     const std::shared_ptr<model::SharedState> num_parallel_calls_;
 
+    // Identifies the number of inputs which are interleaved at once. At most
+    // `dataset()->cycle_length_`, which is the size of `current_elements_`.
+    const std::shared_ptr<model::SharedState> active_cycle_length_;
+
     // The number of current workers currently alive or scheduled to be started.
     // This includes current workers which are blocked waiting for work.
     int num_current_workers_ TF_GUARDED_BY(mu_) = 0;
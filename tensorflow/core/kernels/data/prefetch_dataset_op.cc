@@ -18,17 +18,21 @@ limitations under the License.
 #include <deque>
 #include <limits>
 #include <string>
+#include <vector>
 
 #include "absl/status/status.h"
 #include "tensorflow/core/data/dataset_utils.h"
 #include "tensorflow/core/data/name_utils.h"
 #include "tensorflow/core/data/stats_utils.h"
+#include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/dataset.h"
 #include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/framework/model.h"
 #include "tensorflow/core/framework/partial_tensor_shape.h"
 #include "tensorflow/core/framework/stats_aggregator.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_util.h"
+#include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/kernels/data/prefetch_autotuner.h"
 #include "tensorflow/core/lib/gtl/cleanup.h"
 #include "tensorflow/core/lib/strings/str_util.h"
@@ -181,6 +185,8 @@ class PrefetchDatasetOp::Dataset : public DatasetBase {
           dataset()->buffer_size_, dataset()->buffer_size_min_,
           ctx->ram_budget_manager());
       interleave_depth_ = ctx->interleave_depth();
+      stage_in_pinned_memory_ =
+          GetExperiments().contains("pinned_prefetch_buffer");
 
       if (buffer_size_->value == model::kAutotune) {
         buffer_size_->value = buffer_size_min_;
@@ -556,6 +562,11 @@ class PrefetchDatasetOp::Dataset : public DatasetBase {
           buffer_element.status = input_impl_->GetNext(
               ctx.get(), &buffer_element.value, &end_of_sequence);
           buffer_element.checkpoint.Merge(ctx->checkpoint());
+          if (buffer_element.status.ok() && !end_of_sequence &&
+              stage_in_pinned_memory_) {
+            buffer_element.status =
+                StageInPinnedMemory(ctx.get(), &buffer_element.value);
+          }
         }
         if (buffer_element.status.ok() && end_of_sequence) {
           mutex_lock l(*mu_);
@@ -576,6 +587,22 @@ class PrefetchDatasetOp::Dataset : public DatasetBase {
       }
     }
 
+    // Copies `element` into the pinned host allocator of the device, if it
+    // has one. This does not copy anything to the device: it adds a host copy
+    // on the prefetch thread so that the later host-to-device copy by the
+    // consumer can be an asynchronous DMA.
+    Status StageInPinnedMemory(IteratorContext* ctx,
+                               std::vector<Tensor>* element) {
+      AllocatorAttributes attr;
+      attr.set_gpu_compatible(true);
+      Allocator* allocator = ctx->allocator(attr);
+      if (allocator == nullptr ||
+          allocator->GetMemoryType() != AllocatorMemoryType::kHostPinned) {
+        return absl::OkStatus();
+      }
+      return CopyToPinnedHostMemory(allocator, element);
+    }
+
     Status WriteStatus(IteratorStateWriter* writer, size_t index,
                        const Status& status) TF_EXCLUSIVE_LOCKS_REQUIRED(*mu_) {
       TF_RETURN_IF_ERROR(
@@ -634,6 +661,8 @@ class PrefetchDatasetOp::Dataset : public DatasetBase {
     bool cancelled_ TF_GUARDED_BY(*mu_) = false;
     bool prefetch_thread_finished_ TF_GUARDED_BY(*mu_) = false;
     const bool legacy_autotune_;
+    // Whether buffered elements are copied into pinned host memory.
+    bool stage_in_pinned_memory_ = false;
 
     std::atomic<int64_t> slack_us_;
 
@@ -669,6 +698,27 @@ class PrefetchDatasetOp::Dataset : public DatasetBase {
   TraceMeMetadata traceme_metadata_;
 };
 
+Status CopyToPinnedHostMemory(Allocator* allocator,
+                              std::vector<Tensor>* element) {
+  for (Tensor& component : *element) {
+    if (!DataTypeCanUseMemcpy(component.dtype()) ||
+        component.NumElements() == 0 ||
+        component.GetMemoryType() == AllocatorMemoryType::kHostPinned) {
+      continue;
+    }
+    Tensor staged(allocator, component.dtype(), component.shape());
+    if (!staged.IsInitialized()) {
+      return errors::ResourceExhausted(
+          "Failed to allocate pinned host memory for a prefetched element of "
+          "shape ",
+          component.shape().DebugString());
+    }
+    tensor::DeepCopy(component, &staged);
+    component = std::move(staged);
+  }
+  return absl::OkStatus();
+}
+
 PrefetchDatasetOp::PrefetchDatasetOp(OpKernelConstruction* ctx)
     : UnaryDatasetOpKernel(ctx) {
   if (ctx->HasAttr(kSlackPeriod)) {
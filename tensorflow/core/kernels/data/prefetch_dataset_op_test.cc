@@ -12,7 +12,12 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/data/prefetch_dataset_op.h"
 
+#include <string>
+#include <vector>
+
 #include "tensorflow/core/data/dataset_test_base.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
 
 namespace tensorflow {
 namespace data {
@@ -331,6 +336,43 @@ TEST_F(PrefetchDatasetOpTest, InvalidBufferSize) {
   EXPECT_EQ(Initialize(dataset_params).code(), error::INVALID_ARGUMENT);
 }
 
+// Reports the memory of the CPU allocator as pinned.
+class FakePinnedAllocator : public Allocator {
+ public:
+  std::string Name() override { return "fake_pinned"; }
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override {
+    return cpu_allocator()->AllocateRaw(alignment, num_bytes);
+  }
+  void DeallocateRaw(void* ptr) override {
+    cpu_allocator()->DeallocateRaw(ptr);
+  }
+  AllocatorMemoryType GetMemoryType() const override {
+    return AllocatorMemoryType::kHostPinned;
+  }
+};
+
+TEST(CopyToPinnedHostMemoryTest, CopiesPageableComponents) {
+  FakePinnedAllocator allocator;
+  Tensor pinned(&allocator, DT_FLOAT, TensorShape({2}));
+  test::FillValues<float>(&pinned, {1.5, 2.5});
+  const void* pinned_data = pinned.data();
+  std::vector<Tensor> element = {test::AsTensor<int64_t>({1, 2, 3}), pinned,
+                                 test::AsTensor<tstring>({"a", "b"}),
+                                 Tensor(DT_INT32, TensorShape({0}))};
+  ASSERT_NE(element[0].GetMemoryType(), AllocatorMemoryType::kHostPinned);
+
+  TF_ASSERT_OK(CopyToPinnedHostMemory(&allocator, &element));
+  ASSERT_EQ(element.size(), 4);
+  EXPECT_EQ(element[0].GetMemoryType(), AllocatorMemoryType::kHostPinned);
+  test::ExpectEqual(element[0], test::AsTensor<int64_t>({1, 2, 3}));
+  // Components already in pinned memory are not copied again.
+  EXPECT_EQ(element[1].data(), pinned_data);
+  // Strings can't be copied with memcpy, and empty tensors have no buffer.
+  EXPECT_NE(element[2].GetMemoryType(), AllocatorMemoryType::kHostPinned);
+  test::ExpectEqual(element[2], test::AsTensor<tstring>({"a", "b"}));
+  EXPECT_EQ(element[3].NumElements(), 0);
+}
+
 }  // namespace
 }  // namespace data
 }  // namespace tensorflow
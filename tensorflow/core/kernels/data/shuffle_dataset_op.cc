@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/kernels/data/shuffle_dataset_op.h"
 
+#include <algorithm>
 #include <cstdint>
 #include <deque>
 #include <memory>
@@ -23,15 +24,19 @@ limitations under the License.
 #include <utility>
 #include <vector>
 
+#include "absl/algorithm/container.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/strings/str_cat.h"
+#include "tensorflow/core/data/compression_utils.h"
 #include "tensorflow/core/data/dataset_utils.h"
 #include "tensorflow/core/data/name_utils.h"
 #include "tensorflow/core/data/serialization_utils.h"
 #include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/model.h"
 #include "tensorflow/core/framework/partial_tensor_shape.h"
 #include "tensorflow/core/framework/resource_mgr.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/variant.h"
 #include "tensorflow/core/kernels/data/random_seed_ops.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/random/philox_random.h"
@@ -39,6 +44,7 @@ limitations under the License.
 #include "tensorflow/core/lib/random/random_distributions.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/stringprintf.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 namespace data {
@@ -64,10 +70,15 @@ namespace data {
 const int64_t kLogIntervalMicros = 10 * 1000000;  // 10 seconds.
 const int64_t kMaxEpochsInBuffer = 3;
 
+// If set to true, the shuffle buffers keep their elements compressed and
+// uncompress them when they are produced, trading CPU time for memory.
+constexpr char kCompressBufferEnvVar[] = "TF_DATA_COMPRESS_SHUFFLE_BUFFER";
+
 constexpr char kNumRandomSamples[] = "num_random_samples";
 constexpr char kDataProduced[] = "data_produced";
 constexpr char kEndOfInputSequence[] = "end_of_input_sequence";
 constexpr char kEpoch[] = "epoch";
+constexpr char kCompressedBuffer[] = "compressed_buffer";
 constexpr char kNumElements[] = "num_elements";
 constexpr char kSlicesSize[] = "slices_size";
 constexpr char kSlicesStart[] = "slices_start";
@@ -81,6 +92,21 @@ constexpr char kShuffleDatasetV3[] = "ShuffleDatasetV3";
 constexpr char kShuffleAndRepeatDatasetV1[] = "ShuffleAndRepeatDataset";
 constexpr char kShuffleAndRepeatDatasetV2[] = "ShuffleAndRepeatDatasetV2";
 
+// Returns whether the shuffle buffer of an iterator producing elements of
+// `output_dtypes` keeps its elements compressed. Elements with variant
+// components, e.g. datasets, are always kept uncompressed.
+bool CompressShuffleBuffer(const DataTypeVector& output_dtypes) {
+  bool compress = false;
+  Status s = ReadBoolFromEnvVar(kCompressBufferEnvVar, /*default_val=*/false,
+                                &compress);
+  if (!s.ok()) {
+    LOG(WARNING) << s;
+  }
+  return compress && absl::c_none_of(output_dtypes, [](DataType dtype) {
+           return dtype == DT_VARIANT;
+         });
+}
+
 ShuffleDatasetOpBase::ShuffleDatasetOpBase(OpKernelConstruction* ctx)
     : UnaryDatasetOpKernel(ctx) {}
 
@@ -189,6 +215,8 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
     explicit Iterator(const Params& params, SeedGenerator* seed_generator)
         : DatasetIterator<ShuffleDatasetBase>(params),
           seed_generator_(seed_generator),
+          compress_buffer_(
+              CompressShuffleBuffer(params.dataset->output_dtypes())),
           parent_generator_(seed_generator->seed(), seed_generator->seed2()),
           generator_(&parent_generator_) {
       if (params.dataset->buffer_size_ == kUnknownCardinality) {
@@ -199,6 +227,13 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
       }
     }
 
+    ~Iterator() override {
+      mutex_lock l(mu_);
+      if (ram_budget_manager_ != nullptr) {
+        ram_budget_manager_->RequestBufferBytes(-reserved_bytes_);
+      }
+    }
+
     bool SymbolicCheckpointCompatible() const override { return true; }
 
     Status Initialize(IteratorContext* ctx) override {
@@ -233,8 +268,15 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
       int64_t offset =
           Random() % (slices_.front()->end - slices_.front()->start);
       int64_t index = (slices_.front()->start + offset) % buffer_->size();
-      *out_tensors = std::move(buffer_->at(index));
-      this->RecordBufferDequeue(ctx, *out_tensors);
+      if (compress_buffer_) {
+        std::vector<Tensor> compressed = std::move(buffer_->at(index));
+        this->RecordBufferDequeue(ctx, compressed);
+        ReleaseBytes(compressed);
+        TF_RETURN_IF_ERROR(UncompressBufferElement(compressed, out_tensors));
+      } else {
+        *out_tensors = std::move(buffer_->at(index));
+        this->RecordBufferDequeue(ctx, *out_tensors);
+      }
       std::swap(buffer_->at(index),
                 buffer_->at(slices_.front()->start % buffer_->size()));
       checkpoint_indices_.insert(index);
@@ -283,6 +325,10 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
       TF_RETURN_IF_ERROR(writer->WriteScalar(prefix(), kEpoch, epoch_));
       TF_RETURN_IF_ERROR(
           writer->WriteScalar(prefix(), kNumElements, num_elements_));
+      if (compress_buffer_) {
+        TF_RETURN_IF_ERROR(
+            writer->WriteScalar(prefix(), kCompressedBuffer, ""));
+      }
       const std::string key_prefix = absl::StrCat(prefix(), kColon, "buffer");
       if (ctx->symbolic_checkpoint()) {
         // When symbolic checkpointing is turned on, `writer`
@@ -361,6 +407,29 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
       TF_RETURN_IF_ERROR(ReadElementsFromCheckpoint(
           ctx, reader, absl::StrCat(prefix(), kColon, "buffer"),
           buffer_.get()));
+      // The checkpoint may have been written by an iterator that compressed
+      // its buffer differently.
+      const bool compressed_buffer =
+          reader->Contains(prefix(), kCompressedBuffer);
+      if (ram_budget_manager_ != nullptr) {
+        ram_budget_manager_->RequestBufferBytes(-reserved_bytes_);
+        reserved_bytes_ = 0;
+      }
+      for (auto& element : *buffer_) {
+        if (element.empty()) {
+          continue;
+        }
+        if (compressed_buffer && !compress_buffer_) {
+          std::vector<Tensor> uncompressed;
+          TF_RETURN_IF_ERROR(UncompressBufferElement(element, &uncompressed));
+          element = std::move(uncompressed);
+        } else if (!compressed_buffer && compress_buffer_) {
+          TF_RETURN_IF_ERROR(CompressBufferElement(&element));
+        }
+        if (compress_buffer_) {
+          ReserveBytes(ctx, element);
+        }
+      }
       if (ctx->symbolic_checkpoint()) {
         DCHECK(checkpoint_indices_.empty());
         for (size_t i = 0; i < buffer_->size(); ++i) {
@@ -463,7 +532,7 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
           slices_.back()->reached_end_of_sequence = true;
         }
         if (!end_of_input_sequence) {
-          AddToShuffleBuffer(ctx, std::move(input_element));
+          TF_RETURN_IF_ERROR(AddToShuffleBuffer(ctx, std::move(input_element)));
           continue;
         }
         input_impl_.reset();
@@ -520,12 +589,18 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
       return absl::OkStatus();
     }
 
-    void AddToShuffleBuffer(IteratorContext* ctx, std::vector<Tensor>&& element)
+    Status AddToShuffleBuffer(IteratorContext* ctx,
+                              std::vector<Tensor>&& element)
         TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
       data_produced_ = true;
       if (num_elements_ == 0) {
         VLOG(1) << "Starting to fill up shuffle buffer of size: "
-                << BufferSizeString();
+                << BufferSizeString()
+                << (compress_buffer_ ? " (compressed)" : "");
+      }
+      if (compress_buffer_) {
+        TF_RETURN_IF_ERROR(CompressBufferElement(&element));
+        ReserveBytes(ctx, element);
       }
       this->RecordBufferEnqueue(ctx, element);
       if (num_elements_ == buffer_->size()) {
@@ -539,6 +614,67 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
       }
       num_elements_++;
       slices_.back()->end++;
+      return absl::OkStatus();
+    }
+
+    // Replaces the components of `element` by a scalar variant tensor holding
+    // their compression.
+    static Status CompressBufferElement(std::vector<Tensor>* element) {
+      CompressedElement compressed;
+      TF_RETURN_IF_ERROR(CompressElement(*element, &compressed));
+      Tensor tensor(DT_VARIANT, TensorShape({}));
+      tensor.scalar<Variant>()() = std::move(compressed);
+      element->clear();
+      element->push_back(std::move(tensor));
+      return absl::OkStatus();
+    }
+
+    // Uncompresses an element compressed by `CompressBufferElement`.
+    static Status UncompressBufferElement(const std::vector<Tensor>& element,
+                                          std::vector<Tensor>* out) {
+      const CompressedElement* compressed = nullptr;
+      if (element.size() == 1 && element[0].dtype() == DT_VARIANT &&
+          TensorShapeUtils::IsScalar(element[0].shape())) {
+        compressed = element[0].scalar<Variant>()().get<CompressedElement>();
+      }
+      if (compressed == nullptr) {
+        return errors::DataLoss(
+            "Expected a compressed element in the shuffle buffer.");
+      }
+      return UncompressElement(*compressed, out);
+    }
+
+    // Reserves the bytes of the compressed `element` from the RAM budget of
+    // the pipeline. The element is buffered even if the budget is exhausted.
+    void ReserveBytes(IteratorContext* ctx, const std::vector<Tensor>& element)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      if (ram_budget_manager_ == nullptr) {
+        ram_budget_manager_ = ctx->ram_budget_manager();
+        if (ram_budget_manager_ == nullptr) {
+          return;
+        }
+      }
+      int64_t bytes = GetAllocatedBytes(element);
+      if (!ram_budget_manager_->RequestBufferBytes(bytes)) {
+        LOG_EVERY_N_SEC(WARNING, 60)
+            << dataset()->metadata().name() << ": The compressed shuffle "
+            << "buffer exceeds the RAM budget of the pipeline.";
+        return;
+      }
+      reserved_bytes_ += bytes;
+    }
+
+    // Releases the bytes of the compressed `element`. Elements buffered while
+    // the budget was exhausted weren't reserved, so at most `reserved_bytes_`
+    // are released.
+    void ReleaseBytes(const std::vector<Tensor>& element)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      if (ram_budget_manager_ == nullptr) {
+        return;
+      }
+      int64_t bytes = std::min(GetAllocatedBytes(element), reserved_bytes_);
+      ram_budget_manager_->RequestBufferBytes(-bytes);
+      reserved_bytes_ -= bytes;
     }
 
     void ClearEmptySlices() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
@@ -558,6 +694,9 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
 
     mutex mu_;
     SeedGenerator* const seed_generator_ TF_GUARDED_BY(mu_);  // Not owned.
+    // Whether the elements of `buffer_` are compressed. Each compressed
+    // element is a single scalar variant tensor holding a `CompressedElement`.
+    const bool compress_buffer_;
     std::unique_ptr<std::vector<std::vector<Tensor>>> buffer_
         TF_GUARDED_BY(mu_);
     // Holds the indices of `buffer_` that have changed since the previous
@@ -579,6 +718,11 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
         TF_GUARDED_BY(mu_);
     int64_t num_random_samples_ TF_GUARDED_BY(mu_) = 0;
     bool data_produced_ TF_GUARDED_BY(mu_) = false;
+    // The RAM budget the compressed elements of `buffer_` are reserved from,
+    // and the number of bytes reserved.
+    std::shared_ptr<model::RamBudgetManager> ram_budget_manager_
+        TF_GUARDED_BY(mu_);
+    int64_t reserved_bytes_ TF_GUARDED_BY(mu_) = 0;
   };
 
   const DatasetBase* const input_;
@@ -14,20 +14,31 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/kernels/data/tf_record_dataset_op.h"
 
+#include <algorithm>
 #include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
 
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "tensorflow/core/data/global_shuffle_utils.h"
 #include "tensorflow/core/data/name_utils.h"
+#include "tensorflow/core/data/tfrecord_index.h"
 #include "tensorflow/core/data/utils.h"
 #include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/framework/partial_tensor_shape.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/lib/io/buffered_inputstream.h"
+#include "tensorflow/core/lib/io/cache.h"
 #include "tensorflow/core/lib/io/inputbuffer.h"
 #include "tensorflow/core/lib/io/random_inputstream.h"
 #include "tensorflow/core/lib/io/record_reader.h"
 #include "tensorflow/core/lib/io/zlib_compression_options.h"
 #include "tensorflow/core/lib/io/zlib_inputstream.h"
+#include "tensorflow/core/platform/file_system.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
 
 namespace tensorflow {
 namespace data {
@@ -40,6 +51,8 @@ namespace data {
 /* static */ constexpr const char* const TFRecordDatasetOp::kCompressionType;
 /* static */ constexpr const char* const TFRecordDatasetOp::kBufferSize;
 /* static */ constexpr const char* const TFRecordDatasetOp::kByteOffsets;
+/* static */ constexpr const char* const TFRecordDatasetOp::kUseMmap;
+/* static */ constexpr const char* const TFRecordDatasetOp::kVerifyChecksum;
 
 constexpr char kTFRecordDataset[] = "TFRecordDataset";
 constexpr char kCurrentFileIndex[] = "current_file_index";
@@ -50,6 +63,10 @@ constexpr int64_t kUnspecifiedBufferSize = -1;
 constexpr int64_t kDefaultBufferSize = 256LL << 10;  // 256KB
 constexpr int64_t kCloudTpuBlockSize = 127LL << 20;  // 127MB.
 constexpr int64_t kS3BlockSize = kCloudTpuBlockSize;
+// Random access reads whole blocks of at most this size, and caches up to
+// `kRandomAccessCacheSize` bytes of them.
+constexpr int64_t kMaxRandomAccessBlockSize = 1LL << 20;  // 1MB
+constexpr int64_t kRandomAccessCacheSize = 64LL << 20;    // 64MB
 
 bool is_cloud_tpu_gcs_fs() {
 #if (defined(PLATFORM_CLOUD_TPU) && defined(TPU_GCS_FS)) || \
@@ -63,17 +80,20 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
  public:
   explicit Dataset(OpKernelContext* ctx, std::vector<string> filenames,
                    const string& compression_type, int64_t buffer_size,
-                   std::vector<int64_t> byte_offsets, int op_version)
+                   std::vector<int64_t> byte_offsets, bool use_mmap,
+                   bool verify_checksum, int op_version)
       : DatasetBase(DatasetContext(ctx)),
         filenames_(std::move(filenames)),
         compression_type_(compression_type),
         options_(io::RecordReaderOptions::CreateRecordReaderOptions(
             compression_type)),
         byte_offsets_(std::move(byte_offsets)),
+        use_mmap_(use_mmap),
         op_version_(op_version) {
     if (buffer_size > 0) {
       options_.buffer_size = buffer_size;
     }
+    options_.verify_checksum = verify_checksum;
   }
 
   std::unique_ptr<IteratorBase> MakeIteratorInternal(
@@ -107,6 +127,61 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
 
   Status CheckExternalState() const override { return absl::OkStatus(); }
 
+  // Random access reads the records of uncompressed files by offset, using
+  // the indices of the files. The indices are built the first time they are
+  // needed, and cached next to the files.
+  absl::Status RandomIndexingCompatible() const override {
+    if (!compression_type_.empty()) {
+      return errors::FailedPrecondition(
+          "Compressed TFRecord files do not support random access. Got "
+          "compression type ",
+          compression_type_, ".");
+    }
+    return absl::OkStatus();
+  }
+
+  int64_t CardinalityInternal(CardinalityOptions options) const override {
+    if (options.compute_level() <
+            CardinalityOptions::CARDINALITY_COMPUTE_MODERATE ||
+        !RandomIndexingCompatible().ok()) {
+      return kUnknownCardinality;
+    }
+    absl::StatusOr<const RandomAccessState*> state = GetRandomAccessState();
+    if (!state.ok()) {
+      LOG(WARNING) << "Failed to index TFRecord files: " << state.status();
+      return kUnknownCardinality;
+    }
+    return (*state)->start_indices.back();
+  }
+
+  Status Get(OpKernelContext* ctx, int64 index,
+             std::vector<Tensor>* out_tensors) const override {
+    return Get(AnyContext(ctx), index, out_tensors);
+  }
+
+  Status Get(AnyContext ctx, int64 index,
+             std::vector<Tensor>* out_tensors) const override {
+    TF_RETURN_IF_ERROR(RandomIndexingCompatible());
+    TF_ASSIGN_OR_RETURN(const RandomAccessState* state,
+                        GetRandomAccessState());
+    TF_RETURN_IF_ERROR(CheckRandomAccessCompatible(index));
+    const size_t file_index =
+        std::upper_bound(state->start_indices.begin(),
+                         state->start_indices.end(), index) -
+        state->start_indices.begin() - 1;
+    Tensor record(ctx.allocator, DT_STRING, TensorShape({}));
+    TF_RETURN_IF_ERROR(state->readers[file_index]->ReadRecord(
+        state->first_records[file_index] + index -
+            state->start_indices[file_index],
+        &record.scalar<tstring>()()));
+    static monitoring::CounterCell* bytes_counter =
+        metrics::GetTFDataBytesReadCounter(kDatasetType);
+    bytes_counter->IncrementBy(record.scalar<tstring>()().size());
+    out_tensors->clear();
+    out_tensors->push_back(std::move(record));
+    return absl::OkStatus();
+  }
+
  protected:
   Status AsGraphDefInternal(SerializationContext* ctx,
                             DatasetGraphDefBuilder* b,
@@ -117,8 +192,15 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
     TF_RETURN_IF_ERROR(b->AddScalar(compression_type_, &compression_type));
     Node* buffer_size = nullptr;
     TF_RETURN_IF_ERROR(b->AddScalar(options_.buffer_size, &buffer_size));
-    TF_RETURN_IF_ERROR(b->AddDataset(
-        this, {filenames, compression_type, buffer_size}, output));
+    AttrValue use_mmap_attr;
+    b->BuildAttrValue(use_mmap_, &use_mmap_attr);
+    AttrValue verify_checksum_attr;
+    b->BuildAttrValue(options_.verify_checksum, &verify_checksum_attr);
+    TF_RETURN_IF_ERROR(
+        b->AddDataset(this, {filenames, compression_type, buffer_size},
+                      {std::make_pair(kUseMmap, use_mmap_attr),
+                       std::make_pair(kVerifyChecksum, verify_checksum_attr)},
+                      output));
     Node* byte_offsets = nullptr;
     TF_RETURN_IF_ERROR(b->AddVector(byte_offsets_, &byte_offsets));
     return absl::OkStatus();
@@ -128,22 +210,24 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
   class Iterator : public DatasetIterator<Dataset> {
    public:
     explicit Iterator(const Params& params)
-        : DatasetIterator<Dataset>(params) {}
+        : DatasetIterator<Dataset>(params),
+          global_shuffle_iterator_(dataset()) {}
 
     bool SymbolicCheckpointCompatible() const override { return true; }
 
     Status GetNextInternal(IteratorContext* ctx,
                            std::vector<Tensor>* out_tensors,
                            bool* end_of_sequence) override {
+      if (ctx->index_mapper() != nullptr) {
+        return global_shuffle_iterator_.GetNext(ctx, out_tensors,
+                                                end_of_sequence);
+      }
       out_tensors->reserve(1);
       mutex_lock l(mu_);
       do {
         // We are currently processing a file, so try to read the next record.
-        if (reader_) {
-          out_tensors->emplace_back(ctx->allocator({}), DT_STRING,
-                                    TensorShape({}));
-          Status s =
-              reader_->ReadRecord(&out_tensors->back().scalar<tstring>()());
+        if (reader_ || mmap_reader_) {
+          Status s = ReadRecordLocked(ctx, out_tensors);
           if (s.ok()) {
             static monitoring::CounterCell* bytes_counter =
                 metrics::GetTFDataBytesReadCounter(kDatasetType);
@@ -152,7 +236,6 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
             *end_of_sequence = false;
             return absl::OkStatus();
           }
-          out_tensors->pop_back();
           if (!errors::IsOutOfRange(s)) {
             // In case of other errors e.g., DataLoss, we still move forward
             // the file index so that it works with ignore_errors.
@@ -185,10 +268,15 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
       do {
         // We are currently processing a file, so try to skip reading
         // the next (num_to_skip - *num_skipped) record.
-        if (reader_) {
+        if (reader_ || mmap_reader_) {
           int last_num_skipped;
-          Status s = reader_->SkipRecords(num_to_skip - *num_skipped,
-                                          &last_num_skipped);
+          Status s =
+              mmap_reader_
+                  ? mmap_reader_->SkipRecords(&mmap_offset_,
+                                              num_to_skip - *num_skipped,
+                                              &last_num_skipped)
+                  : reader_->SkipRecords(num_to_skip - *num_skipped,
+                                         &last_num_skipped);
           *num_skipped += last_num_skipped;
           if (s.ok()) {
             *end_of_sequence = false;
@@ -231,15 +319,22 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
       TF_RETURN_IF_ERROR(writer->WriteScalar(prefix(), kCurrentFileIndex,
                                              current_file_index_));
 
-      if (reader_) {
+      if (mmap_reader_) {
+        TF_RETURN_IF_ERROR(writer->WriteScalar(
+            prefix(), kOffset, static_cast<int64_t>(mmap_offset_)));
+      } else if (reader_) {
         TF_RETURN_IF_ERROR(
             writer->WriteScalar(prefix(), kOffset, reader_->TellOffset()));
       }
+      TF_RETURN_IF_ERROR(global_shuffle_iterator_.Save(prefix(), ctx, writer));
       return absl::OkStatus();
     }
 
     Status RestoreInternal(IteratorContext* ctx,
                            IteratorStateReader* reader) override {
+      if (ctx->restored_element_count().has_value()) {
+        return global_shuffle_iterator_.Restore(prefix(), ctx, reader);
+      }
       mutex_lock l(mu_);
       ResetStreamsLocked();
       int64_t current_file_index;
@@ -250,12 +345,63 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
         int64_t offset;
         TF_RETURN_IF_ERROR(reader->ReadScalar(prefix(), kOffset, &offset));
         TF_RETURN_IF_ERROR(SetupStreamsLocked(ctx->env()));
-        TF_RETURN_IF_ERROR(reader_->SeekOffset(offset));
+        TF_RETURN_IF_ERROR(SeekOffsetLocked(offset));
       }
       return absl::OkStatus();
     }
 
    private:
+    // Reads the next record of the current file into a new scalar string
+    // tensor at the back of `out_tensors`.
+    Status ReadRecordLocked(IteratorContext* ctx,
+                            std::vector<Tensor>* out_tensors)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      Tensor record(ctx->allocator({}), DT_STRING, TensorShape({}));
+      if (mmap_reader_) {
+        // The record is copied out of the mapping: a copy of a `tstring` view,
+        // e.g. into a batch, is still a view, which would outlive the mapping
+        // once the iterator moves on to the next file.
+        absl::string_view data;
+        TF_RETURN_IF_ERROR(mmap_reader_->ReadRecord(&mmap_offset_, &data));
+        record.scalar<tstring>()().assign(data.data(), data.size());
+      } else {
+        TF_RETURN_IF_ERROR(reader_->ReadRecord(&record.scalar<tstring>()()));
+      }
+      out_tensors->push_back(std::move(record));
+      return absl::OkStatus();
+    }
+
+    Status SeekOffsetLocked(int64_t offset) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      if (mmap_reader_) {
+        // Like `SequentialRecordReader::SeekOffset()`, the offset is only
+        // validated when the next record is read.
+        mmap_offset_ = offset;
+        return absl::OkStatus();
+      }
+      return reader_->SeekOffset(offset);
+    }
+
+    // Sets up a memory-mapped reader for `filename` if the dataset asks for
+    // one and the file system supports it. Returns false if the caller should
+    // fall back to reading through a `RandomAccessFile`.
+    bool SetupMemmappedStreamLocked(Env* env, const string& filename)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      if (!dataset()->use_mmap_ || !dataset()->compression_type_.empty()) {
+        return false;
+      }
+      std::unique_ptr<ReadOnlyMemoryRegion> region;
+      Status s = env->NewReadOnlyMemoryRegionFromFile(filename, &region);
+      if (!s.ok()) {
+        LOG_FIRST_N(INFO, 1) << "Failed to memory-map " << filename
+                             << ", falling back to buffered reads: " << s;
+        return false;
+      }
+      mmap_reader_ = std::make_unique<io::MemmappedRecordReader>(
+          std::move(region), dataset()->options_);
+      mmap_offset_ = 0;
+      return true;
+    }
+
     // Sets up reader streams to read from the file at `current_file_index_`.
     Status SetupStreamsLocked(Env* env) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
       if (current_file_index_ >= dataset()->filenames_.size()) {
@@ -265,14 +411,16 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
       }
 
       // Actually move on to next file.
-      TF_RETURN_IF_ERROR(env->NewRandomAccessFile(
-          TranslateFileName(dataset()->filenames_[current_file_index_]),
-          &file_));
-      reader_ = std::make_unique<io::SequentialRecordReader>(
-          file_.get(), dataset()->options_);
+      const string filename =
+          TranslateFileName(dataset()->filenames_[current_file_index_]);
+      if (!SetupMemmappedStreamLocked(env, filename)) {
+        TF_RETURN_IF_ERROR(env->NewRandomAccessFile(filename, &file_));
+        reader_ = std::make_unique<io::SequentialRecordReader>(
+            file_.get(), dataset()->options_);
+      }
       if (!dataset()->byte_offsets_.empty()) {
         TF_RETURN_IF_ERROR(
-            reader_->SeekOffset(dataset()->byte_offsets_[current_file_index_]));
+            SeekOffsetLocked(dataset()->byte_offsets_[current_file_index_]));
       }
       return absl::OkStatus();
     }
@@ -281,6 +429,8 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
     void ResetStreamsLocked() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
       reader_.reset();
       file_.reset();
+      mmap_reader_.reset();
+      mmap_offset_ = 0;
     }
 
     mutex mu_;
@@ -290,18 +440,93 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
     // we must destroy `reader_` before `file_`.
     std::unique_ptr<RandomAccessFile> file_ TF_GUARDED_BY(mu_);
     std::unique_ptr<io::SequentialRecordReader> reader_ TF_GUARDED_BY(mu_);
+
+    // Set instead of `reader_` when the current file is memory-mapped.
+    std::unique_ptr<io::MemmappedRecordReader> mmap_reader_ TF_GUARDED_BY(mu_);
+    uint64 mmap_offset_ TF_GUARDED_BY(mu_) = 0;
+
+    GlobalShuffleIterator global_shuffle_iterator_;
   };
 
+  // The readers used for random access, and where the records of each file
+  // start in the dataset.
+  struct RandomAccessState {
+    std::unique_ptr<table::Cache> block_cache;
+    std::vector<std::unique_ptr<TFRecordRandomAccessReader>> readers;
+    // The index of the first record of each file which is part of the
+    // dataset, i.e. which starts at or after the file's byte offset.
+    std::vector<int64_t> first_records;
+    // The index in the dataset of the first record of each file, followed by
+    // the number of records of the dataset.
+    std::vector<int64_t> start_indices;
+  };
+
+  // Returns the random access state, indexing the files the first time it is
+  // called.
+  absl::StatusOr<const RandomAccessState*> GetRandomAccessState() const
+      TF_LOCKS_EXCLUDED(random_access_mu_) {
+    mutex_lock l(random_access_mu_);
+    if (random_access_state_ != nullptr) {
+      return random_access_state_.get();
+    }
+    TF_RETURN_IF_ERROR(random_access_status_);
+    absl::StatusOr<std::unique_ptr<RandomAccessState>> state =
+        CreateRandomAccessState(Env::Default());
+    if (!state.ok()) {
+      random_access_status_ = state.status();
+      return state.status();
+    }
+    random_access_state_ = *std::move(state);
+    return random_access_state_.get();
+  }
+
+  absl::StatusOr<std::unique_ptr<RandomAccessState>> CreateRandomAccessState(
+      Env* env) const {
+    auto state = std::make_unique<RandomAccessState>();
+    state->block_cache.reset(table::NewLRUCache(kRandomAccessCacheSize));
+    const uint64 block_size = std::min(
+        options_.buffer_size > 0 ? options_.buffer_size : kDefaultBufferSize,
+        kMaxRandomAccessBlockSize);
+    state->start_indices.push_back(0);
+    for (size_t i = 0; i < filenames_.size(); ++i) {
+      const string filename = TranslateFileName(filenames_[i]);
+      TF_ASSIGN_OR_RETURN(std::shared_ptr<const TFRecordIndex> index,
+                          TFRecordIndex::LoadOrBuild(env, filename, options_));
+      const int64_t first_record =
+          byte_offsets_.empty()
+              ? 0
+              : index->FirstRecordAtOrAfter(byte_offsets_[i]);
+      std::unique_ptr<RandomAccessFile> file;
+      TF_RETURN_IF_ERROR(env->NewRandomAccessFile(filename, &file));
+      state->first_records.push_back(first_record);
+      state->start_indices.push_back(state->start_indices.back() +
+                                     index->num_records() - first_record);
+      state->readers.push_back(std::make_unique<TFRecordRandomAccessReader>(
+          std::move(file), std::move(index), state->block_cache.get(),
+          block_size, options_.verify_checksum));
+    }
+    return state;
+  }
+
   const std::vector<string> filenames_;
   const tstring compression_type_;
   io::RecordReaderOptions options_;
   const std::vector<int64_t> byte_offsets_;
+  const bool use_mmap_;
   const int op_version_;
+
+  mutable mutex random_access_mu_;
+  mutable std::unique_ptr<RandomAccessState> random_access_state_
+      TF_GUARDED_BY(random_access_mu_);
+  mutable absl::Status random_access_status_ TF_GUARDED_BY(random_access_mu_);
 };
 
 TFRecordDatasetOp::TFRecordDatasetOp(OpKernelConstruction* ctx)
     : DatasetOpKernel(ctx),
-      op_version_(ctx->def().op() == kTFRecordDataset ? 1 : 2) {}
+      op_version_(ctx->def().op() == kTFRecordDataset ? 1 : 2) {
+  OP_REQUIRES_OK(ctx, ctx->GetAttr(kUseMmap, &use_mmap_));
+  OP_REQUIRES_OK(ctx, ctx->GetAttr(kVerifyChecksum, &verify_checksum_));
+}
 
 void TFRecordDatasetOp::MakeDataset(OpKernelContext* ctx,
                                     DatasetBase** output) {
@@ -380,7 +605,8 @@ void TFRecordDatasetOp::MakeDataset(OpKernelContext* ctx,
   }
 
   *output = new Dataset(ctx, std::move(filenames), compression_type,
-                        buffer_size, std::move(byte_offsets), op_version_);
+                        buffer_size, std::move(byte_offsets), use_mmap_,
+                        verify_checksum_, op_version_);
 }
 
 namespace {
@@ -27,6 +27,8 @@ class TFRecordDatasetOp : public DatasetOpKernel {
   static constexpr const char* const kCompressionType = "compression_type";
   static constexpr const char* const kBufferSize = "buffer_size";
   static constexpr const char* const kByteOffsets = "byte_offsets";
+  static constexpr const char* const kUseMmap = "use_mmap";
+  static constexpr const char* const kVerifyChecksum = "verify_checksum";
 
   explicit TFRecordDatasetOp(OpKernelConstruction* ctx);
 
@@ -36,6 +38,8 @@ class TFRecordDatasetOp : public DatasetOpKernel {
  private:
   class Dataset;
   int op_version_;
+  bool use_mmap_;
+  bool verify_checksum_;
 };
 
 }  // namespace data
@@ -12,7 +12,9 @@ limitations under the License.
 #include "tensorflow/core/kernels/data/tf_record_dataset_op.h"
 
 #include <memory>
+#include <cstdint>
 #include <string>
+#include <vector>
 
 #include <gtest/gtest.h>
 #include "absl/log/log.h"
@@ -24,8 +26,10 @@ limitations under the License.
 #include "tensorflow/core/data/dataset_test_base.h"
 #include "tensorflow/core/data/name_utils.h"
 #include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/dataset_options.pb.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/lib/io/record_reader.h"
 #include "tensorflow/core/platform/env.h"
@@ -65,13 +69,16 @@ class TFRecordDatasetParams : public DatasetParams {
  public:
   TFRecordDatasetParams(std::vector<tstring> filenames,
                         CompressionType compression_type, int64_t buffer_size,
-                        std::vector<int64_t> byte_offsets, string node_name)
+                        std::vector<int64_t> byte_offsets, string node_name,
+                        bool use_mmap = false, bool verify_checksum = true)
       : DatasetParams({DT_STRING}, {PartialTensorShape({})},
                       std::move(node_name)),
         filenames_(std::move(filenames)),
         compression_type_(compression_type),
         buffer_size_(buffer_size),
-        byte_offsets_(std::move(byte_offsets)) {
+        byte_offsets_(std::move(byte_offsets)),
+        use_mmap_(use_mmap),
+        verify_checksum_(verify_checksum) {
     op_version_ = 2;
   }
 
@@ -99,6 +106,9 @@ class TFRecordDatasetParams : public DatasetParams {
   Status GetAttributes(AttributeVector* attr_vector) const override {
     attr_vector->clear();
     attr_vector->emplace_back("metadata", "");
+    attr_vector->emplace_back(TFRecordDatasetOp::kUseMmap, use_mmap_);
+    attr_vector->emplace_back(TFRecordDatasetOp::kVerifyChecksum,
+                              verify_checksum_);
     return absl::OkStatus();
   }
 
@@ -111,6 +121,8 @@ class TFRecordDatasetParams : public DatasetParams {
   CompressionType compression_type_;
   int64_t buffer_size_;
   std::vector<int64_t> byte_offsets_;
+  bool use_mmap_;
+  bool verify_checksum_;
 };
 
 class TFRecordDatasetOpTest : public DatasetOpsTestBase {};
@@ -227,6 +239,45 @@ TFRecordDatasetParams InvalidByteOffsets() {
                                /*node_name=*/kNodeName);
 }
 
+// Test case 6: multiple text files without compression, memory-mapped.
+TFRecordDatasetParams MemmappedDatasetParams() {
+  std::vector<tstring> filenames = {
+      absl::StrCat(testing::TmpDir(), "/tf_record_MMAP_1"),
+      absl::StrCat(testing::TmpDir(), "/tf_record_MMAP_2")};
+  std::vector<std::vector<string>> contents = {{"1", "22", "333"},
+                                               {"a", "bb", "ccc"}};
+  CompressionType compression_type = CompressionType::UNCOMPRESSED;
+  absl::Status status = CreateTestFiles(filenames, contents, compression_type);
+  TF_CHECK_OK(status) << "Failed to create the test files: "
+                      << absl::StrJoin(filenames, ", ") << ": " << status;
+  return TFRecordDatasetParams(filenames,
+                               /*compression_type=*/compression_type,
+                               /*buffer_size=*/10,
+                               /*byte_offsets=*/{},
+                               /*node_name=*/kNodeName,
+                               /*use_mmap=*/true);
+}
+
+// Test case 7: Read byte_offsets for memory-mapped records.
+TFRecordDatasetParams MemmappedByteOffsetsDatasetParams() {
+  std::vector<tstring> filenames = {
+      absl::StrCat(testing::TmpDir(), "/tf_record_MMAP_1"),
+      absl::StrCat(testing::TmpDir(), "/tf_record_MMAP_2")};
+  std::vector<std::vector<string>> contents = {{"1", "22", "333"},
+                                               {"a", "bb", "ccc"}};
+  CompressionType compression_type = CompressionType::UNCOMPRESSED;
+  absl::Status status = CreateTestFiles(filenames, contents, compression_type);
+  TF_CHECK_OK(status) << "Failed to create the test files: "
+                      << absl::StrJoin(filenames, ", ") << ": " << status;
+  std::vector<int64_t> byte_offsets = {GetOffset(filenames[0], 2),
+                                       GetOffset(filenames[1], 1)};
+  return TFRecordDatasetParams(filenames,
+                               /*compression_type=*/compression_type,
+                               /*buffer_size=*/10, byte_offsets,
+                               /*node_name=*/kNodeName,
+                               /*use_mmap=*/true);
+}
+
 std::vector<GetNextTestCase<TFRecordDatasetParams>> GetNextTestCases() {
   return {
       {/*dataset_params=*/TFRecordDatasetParams1(),
@@ -242,7 +293,12 @@ std::vector<GetNextTestCase<TFRecordDatasetParams>> GetNextTestCases() {
       {/*dataset_params=*/TFRecordDatasetParams4(),
        CreateTensors<tstring>(
            TensorShape({}),
-           {{"1"}, {"22"}, {"333"}, {"bb"}, {"ccc"}, {"zzz"}})}};
+           {{"1"}, {"22"}, {"333"}, {"bb"}, {"ccc"}, {"zzz"}})},
+      {/*dataset_params=*/MemmappedDatasetParams(),
+       CreateTensors<tstring>(
+           TensorShape({}), {{"1"}, {"22"}, {"333"}, {"a"}, {"bb"}, {"ccc"}})},
+      {/*dataset_params=*/MemmappedByteOffsetsDatasetParams(),
+       CreateTensors<tstring>(TensorShape({}), {{"333"}, {"bb"}, {"ccc"}})}};
 }
 
 ITERATOR_GET_NEXT_TEST_P(TFRecordDatasetOpTest, TFRecordDatasetParams,
@@ -280,6 +336,13 @@ std::vector<SkipTestCase<TFRecordDatasetParams>> SkipTestCases() {
            /*expected_outputs=*/
            CreateTensors<tstring>(TensorShape({}), {{"bb"}})},
           {/*dataset_params=*/TFRecordDatasetParams3(),
+           /*num_to_skip*/ 7, /*expected_num_skipped*/ 6},
+
+          {/*dataset_params=*/MemmappedDatasetParams(),
+           /*num_to_skip*/ 4, /*expected_num_skipped*/ 4, /*get_next*/ true,
+           /*expected_outputs=*/
+           CreateTensors<tstring>(TensorShape({}), {{"bb"}})},
+          {/*dataset_params=*/MemmappedDatasetParams(),
            /*num_to_skip*/ 7, /*expected_num_skipped*/ 6}};
 }
 
@@ -352,6 +415,68 @@ TEST_F(TFRecordDatasetOpTest, InvalidByteOffsetsToSeek) {
       absl::StatusCode::kDataLoss);
 }
 
+TEST_F(TFRecordDatasetOpTest, MemmappedRecordsBatchedAcrossFiles) {
+  // The first batch holds the records of both files, so its records must
+  // outlive the mapping of the first one.
+  auto dataset_params = BatchDatasetParams(MemmappedDatasetParams(),
+                                           /*batch_size=*/4,
+                                           /*drop_remainder=*/false,
+                                           /*parallel_copy=*/false,
+                                           /*output_dtypes=*/{DT_STRING},
+                                           /*output_shapes=*/
+                                           {PartialTensorShape({-1})},
+                                           /*node_name=*/"batch_dataset");
+  TF_ASSERT_OK(Initialize(dataset_params));
+  std::vector<Tensor> batches;
+  bool end_of_sequence = false;
+  while (!end_of_sequence) {
+    std::vector<Tensor> out_tensors;
+    TF_ASSERT_OK(iterator_->GetNext(iterator_ctx_.get(), &out_tensors,
+                                    &end_of_sequence));
+    batches.insert(batches.end(), out_tensors.begin(), out_tensors.end());
+  }
+  iterator_.reset();
+  dataset_->Unref();
+  dataset_ = nullptr;
+  TF_EXPECT_OK(ExpectEqual(
+      batches,
+      {test::AsTensor<tstring>({"1", "22", "333", "a"}, TensorShape({4})),
+       test::AsTensor<tstring>({"bb", "ccc"}, TensorShape({2}))},
+      /*compare_order=*/true));
+}
+
+TEST_F(TFRecordDatasetOpTest, RandomAccess) {
+  auto dataset_params = TFRecordDatasetParams4();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(dataset_->RandomIndexingCompatible());
+  CardinalityOptions options;
+  options.set_compute_level(CardinalityOptions::CARDINALITY_COMPUTE_MODERATE);
+  EXPECT_EQ(dataset_->Cardinality(options), 6);
+
+  const std::vector<tstring> expected = {"1", "22", "333", "bb", "ccc", "zzz"};
+  for (int64_t index : {5, 0, 3, 2, 4, 1}) {
+    std::vector<Tensor> out_tensors;
+    TF_ASSERT_OK(dataset_->Get(AnyContext(iterator_ctx_.get()), index,
+                               &out_tensors));
+    ASSERT_EQ(out_tensors.size(), 1);
+    EXPECT_EQ(out_tensors[0].scalar<tstring>()(), expected[index]);
+  }
+  std::vector<Tensor> out_tensors;
+  EXPECT_EQ(
+      dataset_->Get(AnyContext(iterator_ctx_.get()), 6, &out_tensors).code(),
+      absl::StatusCode::kOutOfRange);
+}
+
+TEST_F(TFRecordDatasetOpTest, CompressedFilesDoNotSupportRandomAccess) {
+  auto dataset_params = TFRecordDatasetParams1();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  EXPECT_EQ(dataset_->RandomIndexingCompatible().code(),
+            absl::StatusCode::kFailedPrecondition);
+  CardinalityOptions options;
+  options.set_compute_level(CardinalityOptions::CARDINALITY_COMPUTE_MODERATE);
+  EXPECT_EQ(dataset_->Cardinality(options), kUnknownCardinality);
+}
+
 std::vector<IteratorSaveAndRestoreTestCase<TFRecordDatasetParams>>
 IteratorSaveAndRestoreTestCases() {
   return {
@@ -365,6 +490,10 @@ IteratorSaveAndRestoreTestCases() {
        CreateTensors<tstring>(
            TensorShape({}), {{"1"}, {"22"}, {"333"}, {"a"}, {"bb"}, {"ccc"}})},
       {/*dataset_params=*/TFRecordDatasetParams3(),
+       /*breakpoints=*/{0, 2, 7},
+       CreateTensors<tstring>(
+           TensorShape({}), {{"1"}, {"22"}, {"333"}, {"a"}, {"bb"}, {"ccc"}})},
+      {/*dataset_params=*/MemmappedDatasetParams(),
        /*breakpoints=*/{0, 2, 7},
        CreateTensors<tstring>(
            TensorShape({}), {{"1"}, {"22"}, {"333"}, {"a"}, {"bb"}, {"ccc"}})}};
@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_KERNELS_DEBUG_OPS_H_
 #define TENSORFLOW_CORE_KERNELS_DEBUG_OPS_H_
 
+#include <atomic>
 #include <cstdint>
 #include <memory>
 #include <numeric>
@@ -466,10 +467,26 @@ class DebugIdentityV2Op : public OpKernel {
     if (context->HasAttr("tfdbg_run_id")) {
       OP_REQUIRES_OK(context, context->GetAttr("tfdbg_run_id", &tfdbg_run_id_));
     }
+    if (context->HasAttr("sampling_period")) {
+      OP_REQUIRES_OK(context,
+                     context->GetAttr("sampling_period", &sampling_period_));
+      OP_REQUIRES(context, sampling_period_ >= 1,
+                  errors::InvalidArgument(
+                      "sampling_period must be at least 1, got ",
+                      sampling_period_));
+    }
   }
 
   void Compute(OpKernelContext* context) override {
     const Tensor& tensor = context->input(0);
+    // Only one execution out of sampling_period is traced, but the summaries
+    // of the health modes counting infinities or NaNs always are.
+    const int64_t execution =
+        num_executions_.fetch_add(1, std::memory_order_relaxed);
+    if (execution % sampling_period_ != 0 && !HasInfOrNan(tensor)) {
+      context->set_output(0, tensor);
+      return;
+    }
     for (const string& dump_root : dump_roots_) {
       tfdbg::DebugEventsWriter* debug_events_writer =
           tfdbg::DebugEventsWriter::GetDebugEventsWriter(
@@ -482,6 +499,43 @@ class DebugIdentityV2Op : public OpKernel {
   }
 
  private:
+  // Returns whether `tensor`, the output of a DebugNumericSummaryV2 op of the
+  // tensor debug mode of this op, counts infinities or NaNs.
+  bool HasInfOrNan(const Tensor& tensor) const {
+    int begin;
+    int end;
+    switch (tensor_debug_mode_) {
+      case 2:  // CURT_HEALTH.
+        begin = 1;
+        end = 2;
+        break;
+      case 3:  // CONCISE_HEALTH.
+        begin = 2;
+        end = 5;
+        break;
+      case 4:  // FULL_HEALTH.
+        begin = 5;
+        end = 8;
+        break;
+      case 8:  // REDUCE_INF_NAN_THREE_SLOTS.
+        begin = 0;
+        end = 3;
+        break;
+      default:
+        return false;
+    }
+    if (tensor.dims() != 1 || tensor.NumElements() < end) {
+      return false;
+    }
+    for (int i = begin; i < end; ++i) {
+      if ((tensor.dtype() == DT_FLOAT && tensor.flat<float>()(i) != 0) ||
+          (tensor.dtype() == DT_DOUBLE && tensor.flat<double>()(i) != 0)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
   std::vector<string> dump_roots_;
   string tfdbg_context_id_;
   string device_name_;
@@ -490,6 +544,8 @@ class DebugIdentityV2Op : public OpKernel {
   int32 tensor_debug_mode_;
   int64_t circular_buffer_size_;
   string tfdbg_run_id_;
+  int64_t sampling_period_ = 1;
+  std::atomic<int64_t> num_executions_{0};
 };
 
 typedef Eigen::ThreadPoolDevice CPUDevice;
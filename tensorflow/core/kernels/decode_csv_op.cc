@@ -19,6 +19,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/kernels/csv_util.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/strings/numbers.h"
 
@@ -81,9 +82,10 @@ class DecodeCSVOp : public OpKernel {
       OP_REQUIRES_OK(ctx, output.allocate(i, records->shape(), &out));
     }
 
+    std::vector<string> fields;
     for (int64_t i = 0; i < records_size; ++i) {
       const StringPiece record(records_t(i));
-      std::vector<string> fields;
+      fields.clear();
       ExtractFields(ctx, record, &fields);
       OP_REQUIRES(ctx, fields.size() == out_type_.size(),
                   errors::InvalidArgument("Expect ", out_type_.size(),
@@ -232,48 +234,38 @@ class DecodeCSVOp : public OpKernel {
         // This is the body of the field;
         string field;
         if (!quoted) {
-          while (static_cast<size_t>(current_idx) < input.size() &&
-                 input[current_idx] != delim_) {
-            OP_REQUIRES(ctx,
-                        (!use_quote_delim_ || input[current_idx] != '"') &&
-                            input[current_idx] != '\n' &&
-                            input[current_idx] != '\r',
-                        errors::InvalidArgument(
-                            "Unquoted fields cannot have quotes/CRLFs inside"));
-            if (include) field += input[current_idx];
-            current_idx++;
+          // Find the end of the field a word at a time, and copy it at once.
+          const size_t end =
+              FindCsvFieldEnd(input, current_idx, delim_, use_quote_delim_);
+          OP_REQUIRES(ctx, end == input.size() || input[end] == delim_,
+                      errors::InvalidArgument(
+                          "Unquoted fields cannot have quotes/CRLFs inside"));
+          if (include) {
+            field.assign(input.data() + current_idx, end - current_idx);
           }
 
           // Go to next field or the end
-          current_idx++;
+          current_idx = end + 1;
         } else if (use_quote_delim_) {
-          // Quoted field needs to be ended with '"' and delim or end
-          while (
-              (static_cast<size_t>(current_idx) < input.size() - 1) &&
-              (input[current_idx] != '"' || input[current_idx + 1] != delim_)) {
-            if (input[current_idx] != '"') {
-              if (include) field += input[current_idx];
-              current_idx++;
-            } else {
-              OP_REQUIRES(
-                  ctx, input[current_idx + 1] == '"',
-                  errors::InvalidArgument("Quote inside a string has to be "
-                                          "escaped by another quote"));
-              if (include) field += '"';
-              current_idx += 2;
+          // Quoted field needs to be ended with '"' and delim or end. Copy the
+          // text up to each quote at once.
+          while (true) {
+            const size_t quote = input.find('"', current_idx);
+            OP_REQUIRES(ctx, quote != StringPiece::npos,
+                        errors::InvalidArgument("Quoted field has to end with "
+                                                "quote followed by delim or "
+                                                "end"));
+            if (include) {
+              field.append(input.data() + current_idx, quote - current_idx);
             }
+            current_idx = quote + 2;
+            if (quote == input.size() - 1 || input[quote + 1] == delim_) break;
+            OP_REQUIRES(
+                ctx, input[quote + 1] == '"',
+                errors::InvalidArgument("Quote inside a string has to be "
+                                        "escaped by another quote"));
+            if (include) field += '"';
           }
-
-          OP_REQUIRES(
-              ctx,
-              (static_cast<size_t>(current_idx) < input.size() &&
-               input[current_idx] == '"' &&
-               (static_cast<size_t>(current_idx) == input.size() - 1 ||
-                input[current_idx + 1] == delim_)),
-              errors::InvalidArgument("Quoted field has to end with quote "
-                                      "followed by delim or end"));
-
-          current_idx += 2;
         }
 
         num_fields_parsed++;
@@ -0,0 +1,138 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/graph/node_builder.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+
+namespace tensorflow {
+namespace {
+
+class DecodeCSVOpTest : public OpsTestBase {
+ protected:
+  void MakeOp(const DataTypeVector& out_types) {
+    TF_ASSERT_OK(NodeDefBuilder("decode_csv_op", "DecodeCSV")
+                     .Input(FakeInput(DT_STRING))
+                     .Input(FakeInput(out_types))
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+  }
+};
+
+TEST_F(DecodeCSVOpTest, DecodesFields) {
+  MakeOp({DT_INT32, DT_FLOAT, DT_STRING, DT_STRING});
+  AddInputFromArray<tstring>(
+      TensorShape({3}),
+      {"1,2.5,a long unquoted field,\"a \"\"quoted\"\", field\"",
+       "-7,,\"\",x", "3,0.25,b,\"\""});
+  AddInputFromArray<int32>(TensorShape({0}), {});
+  AddInputFromArray<float>(TensorShape({1}), {-1.0f});
+  AddInputFromArray<tstring>(TensorShape({1}), {"none"});
+  AddInputFromArray<tstring>(TensorShape({1}), {"default"});
+  TF_ASSERT_OK(RunOpKernel());
+
+  test::ExpectTensorEqual<int32>(
+      *GetOutput(0), test::AsTensor<int32>({1, -7, 3}, TensorShape({3})));
+  test::ExpectTensorEqual<float>(
+      *GetOutput(1),
+      test::AsTensor<float>({2.5f, -1.0f, 0.25f}, TensorShape({3})));
+  test::ExpectTensorEqual<tstring>(
+      *GetOutput(2),
+      test::AsTensor<tstring>({"a long unquoted field", "none", "b"}, {3}));
+  test::ExpectTensorEqual<tstring>(
+      *GetOutput(3),
+      test::AsTensor<tstring>({"a \"quoted\", field", "x", "default"}, {3}));
+}
+
+TEST_F(DecodeCSVOpTest, RejectsQuotesInUnquotedFields) {
+  MakeOp({DT_STRING, DT_STRING});
+  AddInputFromArray<tstring>(TensorShape({1}), {"abcdefghij\"k,l"});
+  AddInputFromArray<tstring>(TensorShape({0}), {});
+  AddInputFromArray<tstring>(TensorShape({0}), {});
+  EXPECT_TRUE(errors::IsInvalidArgument(RunOpKernel()));
+}
+
+TEST_F(DecodeCSVOpTest, RejectsUnterminatedQuotedFields) {
+  MakeOp({DT_STRING, DT_STRING});
+  AddInputFromArray<tstring>(TensorShape({1}), {"a,\"bcdefghijkl"});
+  AddInputFromArray<tstring>(TensorShape({0}), {});
+  AddInputFromArray<tstring>(TensorShape({0}), {});
+  EXPECT_TRUE(errors::IsInvalidArgument(RunOpKernel()));
+}
+
+Graph* SetupDecodeCSVGraph(int num_records, int num_cols, bool quoted) {
+  Graph* g = new Graph(OpRegistry::Global());
+  Tensor records(DT_STRING, TensorShape({num_records}));
+  auto records_flat = records.flat<tstring>();
+  for (int i = 0; i < num_records; ++i) {
+    std::string record;
+    for (int c = 0; c < num_cols; ++c) {
+      if (c > 0) record += ',';
+      if (quoted && c % 2 == 1) {
+        strings::StrAppend(&record, "\"field ", i, " of column ", c, "\"");
+      } else {
+        strings::StrAppend(&record, i + c * 0.125);
+      }
+    }
+    records_flat(i) = record;
+  }
+
+  std::vector<NodeBuilder::NodeOut> defaults;
+  for (int c = 0; c < num_cols; ++c) {
+    const DataType dtype = quoted && c % 2 == 1 ? DT_STRING : DT_FLOAT;
+    defaults.emplace_back(
+        test::graph::Constant(g, Tensor(dtype, TensorShape({0}))));
+  }
+  TF_CHECK_OK(NodeBuilder("decode_csv_op", "DecodeCSV")
+                  .Input(test::graph::Constant(g, records))
+                  .Input(defaults)
+                  .Finalize(g, nullptr /* node */));
+  return g;
+}
+
+void BM_DecodeCSV(::testing::benchmark::State& state) {
+  const int num_records = state.range(0);
+  const int num_cols = state.range(1);
+  const bool quoted = state.range(2);
+
+  Graph* g = SetupDecodeCSVGraph(num_records, num_cols, quoted);
+  test::Benchmark("cpu", g, /*old_benchmark_api*/ false).Run(state);
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) *
+                          num_records);
+}
+
+BENCHMARK(BM_DecodeCSV)
+    ->UseRealTime()
+    ->Args({1024, 8, false})
+    ->Args({1024, 8, true})
+    ->Args({1024, 64, false})
+    ->Args({1024, 64, true})
+    ->Args({16384, 8, false})
+    ->Args({16384, 8, true});
+
+}  // namespace
+}  // namespace tensorflow
@@ -19,6 +19,7 @@ limitations under the License.
 
 #include <algorithm>
 #include <deque>
+#include <utility>
 #include <vector>
 
 #include "tensorflow/core/framework/node_def.pb.h"
@@ -43,13 +44,55 @@ void FIFOQueue::DequeueLocked(OpKernelContext* ctx, Tuple* tuple) {
   DCHECK_GT(queues_[0].size(), size_t{0});
   (*tuple).reserve(num_components());
   for (int i = 0; i < num_components(); ++i) {
-    (*tuple).push_back(queues_[i][0]);
+    (*tuple).push_back(std::move(queues_[i][0]));
     queues_[i].pop_front();
   }
 }
 
+Status FIFOQueue::DequeueManyLocked(int64_t num_elements, OpKernelContext* ctx,
+                                    Tuple* tuple) {
+  DCHECK_GE(queues_[0].size(), num_elements);
+  tuple->reserve(num_components());
+  for (int i = 0; i < num_components(); ++i) {
+    Tensor element;
+    TF_RETURN_IF_ERROR(ctx->allocate_temp(
+        component_dtypes_[i], ManyOutShape(i, num_elements), &element));
+    tuple->push_back(std::move(element));
+  }
+  // The elements are moved into the batch straight from the queue.
+  for (int64_t index = 0; index < num_elements; ++index) {
+    for (int i = 0; i < num_components(); ++i) {
+      TF_RETURN_IF_ERROR(batch_util::CopyElementToSlice(
+          std::move(queues_[i].front()), &(*tuple)[i], index));
+      queues_[i].pop_front();
+    }
+  }
+  return absl::OkStatus();
+}
+
 void FIFOQueue::TryEnqueue(const Tuple& tuple, OpKernelContext* ctx,
                            DoneCallback callback) {
+  // When no enqueue is blocked and the queue has room, the element is enqueued
+  // right away, without registering an attempt and a cancellation callback.
+  bool enqueued = false;
+  bool flush = false;
+  {
+    mutex_lock l(mu_);
+    if (enqueue_attempts_.empty() && !closed_ &&
+        queues_[0].size() < static_cast<size_t>(capacity_)) {
+      for (int i = 0; i < num_components(); ++i) {
+        queues_[i].push_back(tuple[i]);
+      }
+      enqueued = true;
+      flush = !dequeue_attempts_.empty();
+    }
+  }
+  if (enqueued) {
+    if (flush) FlushUnlocked();
+    callback();
+    return;
+  }
+
   CancellationManager* cm = ctx->cancellation_manager();
   CancellationToken token = cm->get_cancellation_token();
   bool already_cancelled;
@@ -107,6 +150,34 @@ void FIFOQueue::TryEnqueueMany(const Tuple& tuple, OpKernelContext* ctx,
     return;
   }
 
+  // When no enqueue is blocked and the queue has room for the whole batch, it
+  // is enqueued right away.
+  bool enqueued = false;
+  bool flush = false;
+  {
+    mutex_lock l(mu_);
+    if (enqueue_attempts_.empty() && !closed_ &&
+        queues_[0].size() + batch_size <= static_cast<size_t>(capacity_)) {
+      for (int64_t index = 0; index < batch_size && ctx->status().ok();
+           ++index) {
+        for (int i = 0; i < num_components(); ++i) {
+          Tensor element;
+          ctx->SetStatus(
+              GetElementComponentFromBatch(tuple, index, i, ctx, &element));
+          if (!ctx->status().ok()) break;
+          queues_[i].push_back(std::move(element));
+        }
+      }
+      enqueued = true;
+      flush = !dequeue_attempts_.empty();
+    }
+  }
+  if (enqueued) {
+    if (flush) FlushUnlocked();
+    callback();
+    return;
+  }
+
   CancellationManager* cm = ctx->cancellation_manager();
   CancellationToken token = cm->get_cancellation_token();
   bool already_cancelled;
@@ -153,6 +224,24 @@ void FIFOQueue::TryEnqueueMany(const Tuple& tuple, OpKernelContext* ctx,
 }
 
 void FIFOQueue::TryDequeue(OpKernelContext* ctx, CallbackWithTuple callback) {
+  // When no dequeue is blocked and the queue isn't empty, the element is
+  // dequeued right away, without registering an attempt and a cancellation
+  // callback.
+  Tuple tuple;
+  bool flush = false;
+  {
+    mutex_lock l(mu_);
+    if (dequeue_attempts_.empty() && !queues_[0].empty()) {
+      DequeueLocked(ctx, &tuple);
+      flush = !enqueue_attempts_.empty();
+    }
+  }
+  if (!tuple.empty()) {
+    if (flush) FlushUnlocked();
+    callback(tuple);
+    return;
+  }
+
   CancellationManager* cm = ctx->cancellation_manager();
   CancellationToken token = cm->get_cancellation_token();
   bool already_cancelled;
@@ -244,6 +333,32 @@ void FIFOQueue::TryDequeueMany(int num_elements, OpKernelContext* ctx,
     return;
   }
 
+  // When no dequeue is blocked and the queue holds enough elements, the batch
+  // is dequeued right away.
+  Tuple batch;
+  bool dequeued = false;
+  bool flush = false;
+  {
+    mutex_lock l(mu_);
+    if (dequeue_attempts_.empty() &&
+        queues_[0].size() >= static_cast<size_t>(num_elements)) {
+      Tuple tuple;
+      Status s = DequeueManyLocked(num_elements, ctx, &tuple);
+      if (s.ok()) {
+        batch = std::move(tuple);
+      } else {
+        ctx->SetStatus(s);
+      }
+      dequeued = true;
+      flush = !enqueue_attempts_.empty();
+    }
+  }
+  if (dequeued) {
+    if (flush) FlushUnlocked();
+    callback(batch);
+    return;
+  }
+
   CancellationManager* cm = ctx->cancellation_manager();
   CancellationToken token = cm->get_cancellation_token();
   bool already_cancelled;
@@ -61,6 +61,11 @@ class FIFOQueue : public TypedQueue<std::deque<Tensor> > {
   void DequeueLocked(OpKernelContext* ctx, Tuple* tuple)
       TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
+  // Helper for dequeuing `num_elements` elements from queues_ into a batch
+  // allocated in `*tuple`.  queues_ must hold at least `num_elements`.
+  Status DequeueManyLocked(int64_t num_elements, OpKernelContext* ctx,
+                           Tuple* tuple) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
   static Status GetElementComponentFromBatch(const Tuple& tuple, int64_t index,
                                              int component,
                                              OpKernelContext* ctx,
@@ -20,6 +20,7 @@ limitations under the License.
 #define EIGEN_USE_THREADS
 
 #include "unsupported/Eigen/CXX11/Tensor"  // from @eigen_archive
+#include "tensorflow/core/common_runtime/branch_profile.h"
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/framework/device_base.h"
 #include "tensorflow/core/framework/function.h"
@@ -132,6 +133,10 @@ class IfOp : public AsyncOpKernel {
                 errors::Internal("No function library"));
     OP_REQUIRES_OK(ctx, ctx->GetAttr("then_branch", &then_func_));
     OP_REQUIRES_OK(ctx, ctx->GetAttr("else_branch", &else_func_));
+    if (BranchProfile::RecordingEnabled()) {
+      profile_key_ = BranchProfile::Key(
+          name(), {then_func_.name(), else_func_.name()});
+    }
   }
 
   ~IfOp() override {
@@ -161,12 +166,17 @@ class IfOp : public AsyncOpKernel {
                          done);
     bool cond;
     OP_REQUIRES_OK(ctx, ToBool({ctx->input(0)}, &cond));
+    if (!profile_key_.empty()) {
+      BranchProfile::Global()->Record(profile_key_, cond ? 0 : 1, 2);
+    }
     (new State(this, ctx, cond, then_handle, else_handle, done))->Start();
   }
 
  private:
   NameAttrList then_func_;
   NameAttrList else_func_;
+  // Key of the node in the BranchProfile, empty if it is not recorded.
+  string profile_key_;
 
   mutex mu_;
 
@@ -273,6 +283,14 @@ class CaseOp : public AsyncOpKernel {
     OP_REQUIRES(ctx, ctx->function_library() != nullptr,
                 errors::Internal("No function library"));
     OP_REQUIRES_OK(ctx, ctx->GetAttr("branches", &branch_funcs_));
+    if (BranchProfile::RecordingEnabled()) {
+      std::vector<string> branch_names;
+      branch_names.reserve(branch_funcs_.size());
+      for (const NameAttrList& func : branch_funcs_) {
+        branch_names.push_back(func.name());
+      }
+      profile_key_ = BranchProfile::Key(name(), branch_names);
+    }
   }
 
   ~CaseOp() override {
@@ -300,6 +318,14 @@ class CaseOp : public AsyncOpKernel {
                       errors::InvalidArgument("branch_index must be scalar"),
                       done);
     int32_t branch = branch_index.scalar<int32>()();
+    if (!profile_key_.empty()) {
+      // The last branch is the default branch.
+      const int num_branches = branch_funcs_.size();
+      BranchProfile::Global()->Record(
+          profile_key_,
+          branch < 0 || branch >= num_branches ? num_branches - 1 : branch,
+          num_branches);
+    }
 
     std::vector<FHandle> branch_handles(branch_funcs_.size());
     OP_REQUIRES_OK_ASYNC(ctx, GetHandles(ctx, branch_handles), done);
@@ -308,6 +334,8 @@ class CaseOp : public AsyncOpKernel {
 
  private:
   std::vector<NameAttrList> branch_funcs_;
+  // Key of the node in the BranchProfile, empty if it is not recorded.
+  string profile_key_;
   mutex mu_;
   std::unordered_map<FunctionLibraryRuntime*,
                      std::pair<std::vector<FHandle>,
@@ -0,0 +1,204 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// See docs in ../ops/nn_ops.cc.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+#include "Eigen/Core"  // from @eigen_archive
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+namespace tensorflow {
+namespace {
+
+// The number of queries and keys of the tiles of the attention scores.
+constexpr int64_t kQueryBlock = 64;
+constexpr int64_t kKeyBlock = 256;
+
+using RowMajorMatrix =
+    Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>;
+using ConstMatrixMap = Eigen::Map<const RowMajorMatrix>;
+
+}  // namespace
+
+// Computes softmax(scale * query * key^T + bias) * value for each batch and
+// head, tile by tile: the scores of a block of queries are computed for a
+// block of keys at a time, and the softmax is accumulated online, rescaling
+// the partial outputs whenever the maximum score of a query grows. The
+// [batch, heads, queries, keys] scores are never materialized.
+class FusedScaledDotProductAttentionOp : public OpKernel {
+ public:
+  explicit FusedScaledDotProductAttentionOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    OP_REQUIRES_OK(context, context->GetAttr("scale", &scale_));
+    int num_args;
+    OP_REQUIRES_OK(context, context->GetAttr("num_args", &num_args));
+    OP_REQUIRES(context, num_args <= 1,
+                errors::InvalidArgument(
+                    "_FusedScaledDotProductAttention takes at most one bias, "
+                    "got num_args=",
+                    num_args));
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& query = context->input(0);
+    const Tensor& key = context->input(1);
+    const Tensor& value = context->input(2);
+    for (const Tensor* t : {&query, &key, &value}) {
+      OP_REQUIRES(context, t->dims() == 4,
+                  errors::InvalidArgument(
+                      "query, key and value must be 4-D, got shapes ",
+                      query.shape().DebugString(), ", ",
+                      key.shape().DebugString(), " and ",
+                      value.shape().DebugString()));
+    }
+    const int64_t batch = query.dim_size(0);
+    const int64_t heads = query.dim_size(1);
+    const int64_t num_queries = query.dim_size(2);
+    const int64_t depth = query.dim_size(3);
+    const int64_t num_keys = key.dim_size(2);
+    const int64_t value_depth = value.dim_size(3);
+    OP_REQUIRES(
+        context,
+        key.dim_size(0) == batch && value.dim_size(0) == batch &&
+            key.dim_size(1) == heads && value.dim_size(1) == heads &&
+            key.dim_size(3) == depth && value.dim_size(2) == num_keys,
+        errors::InvalidArgument("Incompatible query, key and value shapes: ",
+                                query.shape().DebugString(), ", ",
+                                key.shape().DebugString(), " and ",
+                                value.shape().DebugString()));
+
+    // The strides of the bias, broadcast to [batch, heads, queries, keys].
+    const float* bias_data = nullptr;
+    int64_t bias_strides[4] = {0, 0, 0, 0};
+    if (context->num_inputs() > 3) {
+      const Tensor& bias = context->input(3);
+      const int64_t scores_dims[4] = {batch, heads, num_queries, num_keys};
+      OP_REQUIRES(context, bias.dims() <= 4,
+                  errors::InvalidArgument("bias must be at most 4-D, got ",
+                                          bias.shape().DebugString()));
+      int64_t stride = 1;
+      for (int i = 3, j = bias.dims() - 1; j >= 0; --i, --j) {
+        const int64_t dim = bias.dim_size(j);
+        OP_REQUIRES(context, dim == 1 || dim == scores_dims[i],
+                    errors::InvalidArgument(
+                        "bias of shape ", bias.shape().DebugString(),
+                        " can't be broadcast to the attention scores [", batch,
+                        ",", heads, ",", num_queries, ",", num_keys, "]"));
+        bias_strides[i] = dim == 1 ? 0 : stride;
+        stride *= dim;
+      }
+      bias_data = bias.flat<float>().data();
+    }
+
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(context,
+                   context->allocate_output(
+                       0, TensorShape({batch, heads, num_queries, value_depth}),
+                       &output));
+    if (output->NumElements() == 0) return;
+
+    const float* query_data = query.flat<float>().data();
+    const float* key_data = key.flat<float>().data();
+    const float* value_data = value.flat<float>().data();
+    float* output_data = output->flat<float>().data();
+    const float scale = scale_;
+
+    const int64_t num_query_blocks =
+        (num_queries + kQueryBlock - 1) / kQueryBlock;
+    auto work = [&](int64_t start, int64_t limit) {
+      RowMajorMatrix scores;
+      RowMajorMatrix partial_output;
+      Eigen::VectorXf row_max;
+      Eigen::VectorXf row_sum;
+      for (int64_t unit = start; unit < limit; ++unit) {
+        const int64_t b = unit / (heads * num_query_blocks);
+        const int64_t h = unit / num_query_blocks % heads;
+        const int64_t q_begin = unit % num_query_blocks * kQueryBlock;
+        const int64_t nq = std::min(kQueryBlock, num_queries - q_begin);
+        const int64_t bh = b * heads + h;
+        ConstMatrixMap q(query_data + (bh * num_queries + q_begin) * depth, nq,
+                         depth);
+
+        partial_output.setZero(nq, value_depth);
+        row_max.setConstant(nq, -std::numeric_limits<float>::infinity());
+        row_sum.setZero(nq);
+        for (int64_t k_begin = 0; k_begin < num_keys; k_begin += kKeyBlock) {
+          const int64_t nk = std::min(kKeyBlock, num_keys - k_begin);
+          ConstMatrixMap k(key_data + (bh * num_keys + k_begin) * depth, nk,
+                           depth);
+          ConstMatrixMap v(
+              value_data + (bh * num_keys + k_begin) * value_depth, nk,
+              value_depth);
+          scores.noalias() = scale * q * k.transpose();
+          if (bias_data != nullptr) {
+            for (int64_t i = 0; i < nq; ++i) {
+              const float* bias_row =
+                  bias_data + b * bias_strides[0] + h * bias_strides[1] +
+                  (q_begin + i) * bias_strides[2] + k_begin * bias_strides[3];
+              for (int64_t j = 0; j < nk; ++j) {
+                scores(i, j) += bias_row[j * bias_strides[3]];
+              }
+            }
+          }
+          for (int64_t i = 0; i < nq; ++i) {
+            const float new_max =
+                std::max(row_max[i], scores.row(i).maxCoeff());
+            // All the scores of the query so far are -inf, e.g. masked keys.
+            if (new_max == -std::numeric_limits<float>::infinity()) {
+              scores.row(i).setZero();
+              continue;
+            }
+            if (new_max > row_max[i]) {
+              const float correction = std::exp(row_max[i] - new_max);
+              row_sum[i] *= correction;
+              partial_output.row(i) *= correction;
+              row_max[i] = new_max;
+            }
+            scores.row(i) = (scores.row(i).array() - row_max[i]).exp();
+            row_sum[i] += scores.row(i).sum();
+          }
+          partial_output.noalias() += scores * v;
+        }
+
+        Eigen::Map<RowMajorMatrix> out(
+            output_data + (bh * num_queries + q_begin) * value_depth, nq,
+            value_depth);
+        out = row_sum.cwiseInverse().asDiagonal() * partial_output;
+      }
+    };
+    auto worker_threads = *(context->device()->tensorflow_cpu_worker_threads());
+    const int64_t cost_per_unit =
+        2 * kQueryBlock * num_keys * (depth + value_depth);
+    Shard(worker_threads.num_threads, worker_threads.workers,
+          batch * heads * num_query_blocks, cost_per_unit, work);
+  }
+
+ private:
+  float scale_;
+};
+
+REGISTER_KERNEL_BUILDER(Name("_FusedScaledDotProductAttention")
+                            .Device(DEVICE_CPU)
+                            .TypeConstraint<float>("T"),
+                        FusedScaledDotProductAttentionOp);
+
+}  // namespace tensorflow
@@ -0,0 +1,152 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+class FusedScaledDotProductAttentionOpTest : public OpsTestBase {
+ protected:
+  void MakeOp(int num_args, float scale) {
+    TF_ASSERT_OK(NodeDefBuilder("attention", "_FusedScaledDotProductAttention")
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(num_args, DT_FLOAT))
+                     .Attr("num_args", num_args)
+                     .Attr("scale", scale)
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+  }
+
+  void AddInput(const Tensor& t) {
+    AddInputFromArray<float>(
+        t.shape(), absl::Span<const float>(t.flat<float>().data(),
+                                           t.NumElements()));
+  }
+
+  // Runs the op on random inputs, and compares its output with the attention
+  // computed one query at a time. `bias_shape` is empty for no bias.
+  void RunAndCheck(int batch, int heads, int num_queries, int num_keys,
+                   int depth, int value_depth,
+                   const std::vector<int64_t>& bias_shape) {
+    const float scale = 1.0f / std::sqrt(static_cast<float>(depth));
+    MakeOp(bias_shape.empty() ? 0 : 1, scale);
+
+    Tensor query(DT_FLOAT, TensorShape({batch, heads, num_queries, depth}));
+    Tensor key(DT_FLOAT, TensorShape({batch, heads, num_keys, depth}));
+    Tensor value(DT_FLOAT, TensorShape({batch, heads, num_keys, value_depth}));
+    query.flat<float>().setRandom();
+    key.flat<float>().setRandom();
+    value.flat<float>().setRandom();
+    AddInput(query);
+    AddInput(key);
+    AddInput(value);
+
+    // The bias masks every third key.
+    Tensor bias(DT_FLOAT, TensorShape(bias_shape));
+    auto bias_at = [&](int b, int h, int q, int k) -> float {
+      if (bias_shape.empty()) return 0.0f;
+      const int64_t coords[4] = {b, h, q, k};
+      int64_t index = 0;
+      for (int i = 0; i < 4; ++i) {
+        index = index * bias_shape[i] + (bias_shape[i] == 1 ? 0 : coords[i]);
+      }
+      return bias.flat<float>()(index);
+    };
+    if (!bias_shape.empty()) {
+      bias.flat<float>().setRandom();
+      for (int64_t i = 0; i < bias.NumElements(); i += 3) {
+        bias.flat<float>()(i) = -std::numeric_limits<float>::infinity();
+      }
+      AddInput(bias);
+    }
+    TF_ASSERT_OK(RunOpKernel());
+
+    Tensor expected(DT_FLOAT,
+                    TensorShape({batch, heads, num_queries, value_depth}));
+    auto q_t = query.tensor<float, 4>();
+    auto k_t = key.tensor<float, 4>();
+    auto v_t = value.tensor<float, 4>();
+    auto expected_t = expected.tensor<float, 4>();
+    std::vector<double> scores(num_keys);
+    for (int b = 0; b < batch; ++b) {
+      for (int h = 0; h < heads; ++h) {
+        for (int q = 0; q < num_queries; ++q) {
+          double max = -std::numeric_limits<double>::infinity();
+          for (int k = 0; k < num_keys; ++k) {
+            double score = 0;
+            for (int d = 0; d < depth; ++d) {
+              score += q_t(b, h, q, d) * k_t(b, h, k, d);
+            }
+            scores[k] = scale * score + bias_at(b, h, q, k);
+            max = std::max(max, scores[k]);
+          }
+          double sum = 0;
+          for (int k = 0; k < num_keys; ++k) {
+            scores[k] = std::exp(scores[k] - max);
+            sum += scores[k];
+          }
+          for (int d = 0; d < value_depth; ++d) {
+            double output = 0;
+            for (int k = 0; k < num_keys; ++k) {
+              output += scores[k] * v_t(b, h, k, d);
+            }
+            expected_t(b, h, q, d) = output / sum;
+          }
+        }
+      }
+    }
+    test::ExpectTensorNear<float>(expected, *GetOutput(0), 1e-5);
+  }
+};
+
+TEST_F(FusedScaledDotProductAttentionOpTest, Small) {
+  RunAndCheck(2, 3, 5, 7, 4, 6, {});
+}
+
+TEST_F(FusedScaledDotProductAttentionOpTest, SeveralBlocks) {
+  RunAndCheck(1, 2, 70, 600, 8, 5, {});
+}
+
+TEST_F(FusedScaledDotProductAttentionOpTest, BroadcastBias) {
+  RunAndCheck(2, 2, 70, 300, 8, 8, {2, 1, 1, 300});
+}
+
+TEST_F(FusedScaledDotProductAttentionOpTest, FullBias) {
+  RunAndCheck(1, 2, 9, 260, 4, 4, {1, 2, 9, 260});
+}
+
+TEST_F(FusedScaledDotProductAttentionOpTest, IncompatibleShapes) {
+  MakeOp(0, 1.0f);
+  AddInputFromArray<float>(TensorShape({1, 1, 2, 3}), {0, 0, 0, 0, 0, 0});
+  AddInputFromArray<float>(TensorShape({1, 1, 2, 2}), {0, 0, 0, 0});
+  AddInputFromArray<float>(TensorShape({1, 1, 2, 2}), {0, 0, 0, 0});
+  EXPECT_TRUE(absl::IsInvalidArgument(RunOpKernel()));
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -0,0 +1,288 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// See docs in ../ops/math_ops.cc.
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Eigen/Core"  // from @eigen_archive
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+namespace tensorflow {
+namespace {
+
+// The number of elements computed by all the instructions of the program
+// before moving to the next ones, so that the intermediate results stay in
+// the L1 cache.
+constexpr int64_t kTileSize = 1024;
+
+using ArrayMap = Eigen::Map<Eigen::ArrayXf>;
+using ConstArrayMap = Eigen::Map<const Eigen::ArrayXf>;
+
+enum class OpCode {
+  kAdd,
+  kSub,
+  kMul,
+  kDiv,
+  kMaximum,
+  kMinimum,
+  kSquaredDifference,
+  kAbs,
+  kExp,
+  kSigmoid,
+  kNeg,
+  kRelu,
+  kRelu6,
+  kRsqrt,
+  kSqrt,
+  kSquare,
+  kTanh,
+};
+
+// The op codes of the TF ops supported in the programs, and whether they are
+// unary.
+const absl::flat_hash_map<std::string, std::pair<OpCode, bool>>& GetOpCodes() {
+  static const auto* op_codes =
+      new absl::flat_hash_map<std::string, std::pair<OpCode, bool>>({
+          {"Add", {OpCode::kAdd, false}},
+          {"AddV2", {OpCode::kAdd, false}},
+          {"Sub", {OpCode::kSub, false}},
+          {"Mul", {OpCode::kMul, false}},
+          {"RealDiv", {OpCode::kDiv, false}},
+          {"Maximum", {OpCode::kMaximum, false}},
+          {"Minimum", {OpCode::kMinimum, false}},
+          {"SquaredDifference", {OpCode::kSquaredDifference, false}},
+          {"Abs", {OpCode::kAbs, true}},
+          {"Exp", {OpCode::kExp, true}},
+          {"Sigmoid", {OpCode::kSigmoid, true}},
+          {"Neg", {OpCode::kNeg, true}},
+          {"Relu", {OpCode::kRelu, true}},
+          {"Relu6", {OpCode::kRelu6, true}},
+          {"Rsqrt", {OpCode::kRsqrt, true}},
+          {"Sqrt", {OpCode::kSqrt, true}},
+          {"Square", {OpCode::kSquare, true}},
+          {"Tanh", {OpCode::kTanh, true}},
+      });
+  return *op_codes;
+}
+
+struct Instruction {
+  OpCode op;
+  int lhs;
+  int rhs;
+};
+
+void Evaluate(OpCode op, const ConstArrayMap& x, const ConstArrayMap& y,
+              ArrayMap* out) {
+  switch (op) {
+    case OpCode::kAdd:
+      *out = x + y;
+      break;
+    case OpCode::kSub:
+      *out = x - y;
+      break;
+    case OpCode::kMul:
+      *out = x * y;
+      break;
+    case OpCode::kDiv:
+      *out = x / y;
+      break;
+    case OpCode::kMaximum:
+      *out = x.max(y);
+      break;
+    case OpCode::kMinimum:
+      *out = x.min(y);
+      break;
+    case OpCode::kSquaredDifference:
+      *out = (x - y).square();
+      break;
+    case OpCode::kAbs:
+      *out = x.abs();
+      break;
+    case OpCode::kExp:
+      *out = x.exp();
+      break;
+    case OpCode::kSigmoid:
+      *out = (1 + (-x).exp()).inverse();
+      break;
+    case OpCode::kNeg:
+      *out = -x;
+      break;
+    case OpCode::kRelu:
+      *out = x.max(0.0f);
+      break;
+    case OpCode::kRelu6:
+      *out = x.max(0.0f).min(6.0f);
+      break;
+    case OpCode::kRsqrt:
+      *out = x.rsqrt();
+      break;
+    case OpCode::kSqrt:
+      *out = x.sqrt();
+      break;
+    case OpCode::kSquare:
+      *out = x.square();
+      break;
+    case OpCode::kTanh:
+      *out = x.tanh();
+      break;
+  }
+}
+
+}  // namespace
+
+// Computes the program of the op tile by tile: the results of the
+// instructions are written to tiles of a scratch buffer, so that the chain
+// makes a single pass over the inputs and the output, and the tiles are
+// sharded over the worker threads.
+class FusedElementwiseOp : public OpKernel {
+ public:
+  explicit FusedElementwiseOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    std::vector<string> op_names;
+    std::vector<int32> lhs;
+    std::vector<int32> rhs;
+    OP_REQUIRES_OK(context, context->GetAttr("num_args", &num_args_));
+    OP_REQUIRES_OK(context, context->GetAttr("constants", &constants_));
+    OP_REQUIRES_OK(context, context->GetAttr("op_names", &op_names));
+    OP_REQUIRES_OK(context, context->GetAttr("lhs", &lhs));
+    OP_REQUIRES_OK(context, context->GetAttr("rhs", &rhs));
+    OP_REQUIRES(context,
+                !op_names.empty() && lhs.size() == op_names.size() &&
+                    rhs.size() == op_names.size(),
+                errors::InvalidArgument(
+                    "op_names, lhs and rhs must have the same nonzero size"));
+    const int num_leaves = num_args_ + constants_.size();
+    for (int i = 0; i < op_names.size(); ++i) {
+      auto it = GetOpCodes().find(op_names[i]);
+      OP_REQUIRES(context, it != GetOpCodes().end(),
+                  errors::InvalidArgument("Unsupported op in the program: ",
+                                          op_names[i]));
+      const bool unary = it->second.second;
+      // The operands are the leaves or the results of previous instructions.
+      const int num_values = num_leaves + i;
+      OP_REQUIRES(
+          context,
+          lhs[i] >= 0 && lhs[i] < num_values &&
+              (unary ? rhs[i] == -1 : rhs[i] >= 0 && rhs[i] < num_values),
+          errors::InvalidArgument("Invalid operands ", lhs[i], ", ", rhs[i],
+                                  " of the instruction ", i, ": ",
+                                  op_names[i]));
+      instructions_.push_back({it->second.first, lhs[i], rhs[i]});
+    }
+  }
+
+  void Compute(OpKernelContext* context) override {
+    // The output has the shape of the arguments that aren't broadcast, or the
+    // largest rank if they all have a single element.
+    int output_arg = 0;
+    for (int i = 1; i < num_args_; ++i) {
+      const Tensor& arg = context->input(i);
+      const Tensor& current = context->input(output_arg);
+      if (current.NumElements() == 1 &&
+          (arg.NumElements() != 1 || arg.dims() > current.dims())) {
+        output_arg = i;
+      }
+    }
+    const TensorShape& shape = context->input(output_arg).shape();
+    for (int i = 0; i < num_args_; ++i) {
+      const Tensor& arg = context->input(i);
+      OP_REQUIRES(context,
+                  arg.shape() == shape ||
+                      (arg.NumElements() == 1 && arg.dims() <= shape.dims()),
+                  errors::InvalidArgument(
+                      "The arguments must have the same shape or a single "
+                      "element, got ",
+                      arg.shape().DebugString(), " for ", shape.DebugString()));
+    }
+
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(context, context->allocate_output(0, shape, &output));
+    const int64_t num_elements = output->NumElements();
+    if (num_elements == 0) return;
+
+    std::vector<const float*> args(num_args_);
+    std::vector<bool> broadcast(num_args_);
+    for (int i = 0; i < num_args_; ++i) {
+      const Tensor& arg = context->input(i);
+      args[i] = arg.flat<float>().data();
+      broadcast[i] = arg.NumElements() == 1 && num_elements != 1;
+    }
+    float* output_data = output->flat<float>().data();
+
+    const int num_leaves = num_args_ + constants_.size();
+    const int num_instructions = instructions_.size();
+    const int64_t num_tiles = (num_elements + kTileSize - 1) / kTileSize;
+    auto work = [&](int64_t start, int64_t limit) {
+      // A tile per broadcast leaf, filled once, then a tile per instruction
+      // but the last one, which writes to the output.
+      std::vector<float> scratch((num_leaves + num_instructions) * kTileSize);
+      std::vector<const float*> leaves(num_leaves);
+      for (int i = 0; i < num_leaves; ++i) {
+        if (i < num_args_ && !broadcast[i]) continue;
+        float* tile = scratch.data() + i * kTileSize;
+        std::fill(tile, tile + kTileSize,
+                  i < num_args_ ? *args[i] : constants_[i - num_args_]);
+        leaves[i] = tile;
+      }
+      std::vector<const float*> values(num_leaves + num_instructions);
+      for (int64_t t = start; t < limit; ++t) {
+        const int64_t begin = t * kTileSize;
+        const int64_t size = std::min(kTileSize, num_elements - begin);
+        for (int i = 0; i < num_leaves; ++i) {
+          values[i] = i < num_args_ && !broadcast[i] ? args[i] + begin
+                                                     : leaves[i];
+        }
+        for (int i = 0; i < num_instructions; ++i) {
+          const Instruction& instruction = instructions_[i];
+          float* result = i == num_instructions - 1
+                              ? output_data + begin
+                              : scratch.data() + (num_leaves + i) * kTileSize;
+          ConstArrayMap x(values[instruction.lhs], size);
+          // The unary ops ignore their right operand.
+          ConstArrayMap y(
+              values[instruction.rhs < 0 ? instruction.lhs : instruction.rhs],
+              size);
+          ArrayMap out(result, size);
+          Evaluate(instruction.op, x, y, &out);
+          values[num_leaves + i] = result;
+        }
+      }
+    };
+    auto worker_threads = *(context->device()->tensorflow_cpu_worker_threads());
+    const int64_t cost_per_unit = kTileSize * num_instructions * 10;
+    Shard(worker_threads.num_threads, worker_threads.workers, num_tiles,
+          cost_per_unit, work);
+  }
+
+ private:
+  int num_args_;
+  std::vector<float> constants_;
+  std::vector<Instruction> instructions_;
+};
+
+REGISTER_KERNEL_BUILDER(
+    Name("_FusedElementwise").Device(DEVICE_CPU).TypeConstraint<float>("T"),
+    FusedElementwiseOp);
+
+}  // namespace tensorflow
@@ -0,0 +1,113 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+class FusedElementwiseOpTest : public OpsTestBase {
+ protected:
+  Status MakeOp(int num_args, const std::vector<float>& constants,
+                const std::vector<string>& op_names,
+                const std::vector<int>& lhs, const std::vector<int>& rhs) {
+    TF_RETURN_IF_ERROR(NodeDefBuilder("fused", "_FusedElementwise")
+                           .Input(FakeInput(num_args, DT_FLOAT))
+                           .Attr("num_args", num_args)
+                           .Attr("constants", constants)
+                           .Attr("op_names", op_names)
+                           .Attr("lhs", lhs)
+                           .Attr("rhs", rhs)
+                           .Finalize(node_def()));
+    return InitOp();
+  }
+
+  void AddInput(const Tensor& t) {
+    AddInputFromArray<float>(
+        t.shape(), absl::Span<const float>(t.flat<float>().data(),
+                                           t.NumElements()));
+  }
+};
+
+TEST_F(FusedElementwiseOpTest, ComputesTheProgram) {
+  // tanh(x * 0.5 + y) - relu(x), over several tiles.
+  TF_ASSERT_OK(MakeOp(/*num_args=*/2, /*constants=*/{0.5f},
+                      {"Mul", "AddV2", "Tanh", "Relu", "Sub"},
+                      {0, 3, 4, 0, 5}, {2, 1, -1, -1, 6}));
+  const int num_elements = 3000;
+  Tensor x(DT_FLOAT, TensorShape({3, num_elements / 3}));
+  Tensor y(DT_FLOAT, TensorShape({3, num_elements / 3}));
+  x.flat<float>().setRandom();
+  y.flat<float>().setRandom();
+  for (int i = 0; i < num_elements; i += 2) x.flat<float>()(i) *= -1;
+  AddInput(x);
+  AddInput(y);
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected(DT_FLOAT, x.shape());
+  for (int i = 0; i < num_elements; ++i) {
+    const float xi = x.flat<float>()(i);
+    expected.flat<float>()(i) =
+        std::tanh(xi * 0.5f + y.flat<float>()(i)) - std::max(xi, 0.0f);
+  }
+  test::ExpectClose(expected, *GetOutput(0), /*atol=*/1e-5, /*rtol=*/1e-5);
+}
+
+TEST_F(FusedElementwiseOpTest, BroadcastsTheArgumentsWithASingleElement) {
+  // (x - y)^2 / z.
+  TF_ASSERT_OK(MakeOp(/*num_args=*/3, /*constants=*/{},
+                      {"SquaredDifference", "RealDiv"}, {0, 3}, {1, 2}));
+  AddInputFromArray<float>(TensorShape({}), {1});
+  AddInputFromArray<float>(TensorShape({2, 2}), {1, 2, 3, 4});
+  AddInputFromArray<float>(TensorShape({1}), {2});
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected(DT_FLOAT, TensorShape({2, 2}));
+  test::FillValues<float>(&expected, {0, 0.5, 2, 4.5});
+  test::ExpectTensorEqual<float>(expected, *GetOutput(0));
+}
+
+TEST_F(FusedElementwiseOpTest, RejectsInvalidPrograms) {
+  // The instruction reads its own result.
+  EXPECT_FALSE(MakeOp(/*num_args=*/1, /*constants=*/{}, {"Neg"}, {1}, {-1})
+                   .ok());
+  // A binary op without its right operand.
+  EXPECT_FALSE(MakeOp(/*num_args=*/1, /*constants=*/{}, {"Mul"}, {0}, {-1})
+                   .ok());
+  EXPECT_FALSE(MakeOp(/*num_args=*/1, /*constants=*/{}, {"Erf"}, {0}, {-1})
+                   .ok());
+}
+
+TEST_F(FusedElementwiseOpTest, RejectsIncompatibleShapes) {
+  TF_ASSERT_OK(
+      MakeOp(/*num_args=*/2, /*constants=*/{}, {"AddV2"}, {0}, {1}));
+  AddInputFromArray<float>(TensorShape({2}), {1, 2});
+  AddInputFromArray<float>(TensorShape({3}), {1, 2, 3});
+  EXPECT_FALSE(RunOpKernel().ok());
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -19,11 +19,15 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/histogram_op.h"
 
+#include <algorithm>
+#include <atomic>
+
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 
@@ -32,6 +36,15 @@ typedef Eigen::GpuDevice GPUDevice;
 
 namespace functor {
 
+namespace {
+
+// The minimum number of values counted by each block of the input.
+constexpr int64_t kMinValuesPerBlock = 1 << 14;
+// The number of values whose bins are computed at once.
+constexpr int64_t kValuesPerChunk = 1024;
+
+}  // namespace
+
 template <typename T, typename Tout>
 struct HistogramFixedWidthFunctor<CPUDevice, T, Tout> {
   static Status Compute(OpKernelContext* context,
@@ -45,48 +58,83 @@ struct HistogramFixedWidthFunctor<CPUDevice, T, Tout> {
       return OkStatus();
     }
 
-    Tensor index_to_bin_tensor;
-    TF_RETURN_IF_ERROR(context->forward_input_or_allocate_temp(
-        {0}, DataTypeToEnum<int32>::value, TensorShape({values.size()}),
-        &index_to_bin_tensor));
-    auto index_to_bin = index_to_bin_tensor.flat<int32>();
-
     // Avoid overflow in step computation.
     const double step =
         static_cast<double>(value_range(1)) / static_cast<double>(nbins) -
         static_cast<double>(value_range(0)) / static_cast<double>(nbins);
     const double nbins_minus_1 = static_cast<double>(nbins - 1);
-
-    // We cannot handle NANs in the algorithm below (due to the cast to int32)
-    const Eigen::Tensor<int32, 1, 1> nans_tensor =
-        values.isnan().template cast<int32>();
-    const Eigen::Tensor<int32, 0, 1> reduced_tensor = nans_tensor.sum();
-    const int num_nans = reduced_tensor(0);
-    if (num_nans > 0) {
+    const T lower = value_range(0);
+    const T upper = value_range(1);
+
+    // The values are counted in parallel blocks, each into its own partial
+    // histogram. There are no more blocks than values per bin, so the partial
+    // histograms take no more memory than the values.
+    const DeviceBase::CpuWorkerThreads& worker_threads =
+        *context->device()->tensorflow_cpu_worker_threads();
+    const int64_t size = values.size();
+    const int64_t num_blocks = std::max<int64_t>(
+        1, std::min<int64_t>({worker_threads.num_threads,
+                              size / kMinValuesPerBlock, size / nbins}));
+    Tensor partial_bins_t;
+    TF_RETURN_IF_ERROR(context->allocate_temp(
+        DataTypeToEnum<Tout>::value, TensorShape({num_blocks, nbins}),
+        &partial_bins_t));
+    auto partial_bins = partial_bins_t.matrix<Tout>();
+    partial_bins.device(d) = partial_bins.constant(Tout(0));
+
+    std::atomic<bool> has_nan(false);
+    auto count_block = [&](int64_t start_block, int64_t limit_block) {
+      // The bins of a chunk of values are computed with vectorized Eigen
+      // expressions, then counted.
+      Eigen::Tensor<int32, 1, Eigen::RowMajor> bins(kValuesPerChunk);
+      for (int64_t block = start_block; block < limit_block; ++block) {
+        Tout* block_bins = &partial_bins(block, 0);
+        const int64_t block_end = size * (block + 1) / num_blocks;
+        for (int64_t begin = size * block / num_blocks; begin < block_end;
+             begin += kValuesPerChunk) {
+          const int64_t n = std::min(kValuesPerChunk, block_end - begin);
+          Eigen::TensorMap<Eigen::Tensor<const T, 1, Eigen::RowMajor>> chunk(
+              values.data() + begin, n);
+          // We cannot handle NANs in the algorithm below (due to the cast to
+          // int32).
+          const Eigen::Tensor<bool, 0, Eigen::RowMajor> any_nan =
+              chunk.isnan().any();
+          if (any_nan()) {
+            has_nan = true;
+            return;
+          }
+          // The calculation is done by finding the slot of each value in
+          // `values`. With [a, b]:
+          //   step = (b - a) / nbins
+          //   (x - a) / step
+          // , then the entries are mapped to output.
+          //
+          // Bound range and cast to double _before_ subtracting the
+          // lower-bound to avoid overflow.  Otherwise the difference may not
+          // fit within the type (e.g. int32).
+          Eigen::TensorMap<Eigen::Tensor<int32, 1, Eigen::RowMajor>>
+              chunk_bins(bins.data(), n);
+          chunk_bins = ((chunk.cwiseMax(lower).cwiseMin(upper).template cast<
+                             double>() -
+                         static_cast<double>(lower)) /
+                        step)
+                           .cwiseMin(nbins_minus_1)
+                           .template cast<int32>();
+          for (int64_t i = 0; i < n; ++i) {
+            block_bins[chunk_bins(i)] += Tout(1);
+          }
+        }
+      }
+    };
+    Shard(worker_threads.num_threads, worker_threads.workers, num_blocks,
+          /*cost_per_unit=*/10 * (size / num_blocks), count_block);
+    if (has_nan) {
       return errors::InvalidArgument("Histogram values must not contain NaN");
     }
 
-    // The calculation is done by finding the slot of each value in `values`.
-    // With [a, b]:
-    //   step = (b - a) / nbins
-    //   (x - a) / step
-    // , then the entries are mapped to output.
-    //
-    // Bound range and cast to double _before_ subtracting the lower-bound to
-    // avoid overflow.  Otherwise the difference may not fit within the type
-    // (e.g. int32).
-    index_to_bin.device(d) = ((values.cwiseMax(value_range(0))
-                                   .cwiseMin(value_range(1))
-                                   .template cast<double>() -
-                               static_cast<double>(value_range(0))) /
-                              step)
-                                 .cwiseMin(nbins_minus_1)
-                                 .template cast<int32>();
-
-    out.setZero();
-    for (int32_t i = 0; i < index_to_bin.size(); i++) {
-      out(index_to_bin(i)) += Tout(1);
-    }
+    // Sum the partial histograms along the 0th axis.
+    Eigen::array<int, 1> reduce_dim({0});
+    out.device(d) = partial_bins.sum(reduce_dim);
     return OkStatus();
   }
 };
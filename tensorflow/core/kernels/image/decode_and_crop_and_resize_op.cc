@@ -0,0 +1,295 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// See docs in ../ops/image_ops.cc
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "tensorflow/core/framework/bfloat16.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/op_requires.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/tensor_types.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/jpeg/jpeg_mem.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/stringpiece.h"
+#include "tensorflow/core/platform/tstring.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+namespace tensorflow {
+namespace {
+
+// The libjpeg DCT scaling ratios, from the largest.
+constexpr int kDctScalingRatios[] = {8, 4, 2, 1};
+
+// Returns the largest DCT scaling ratio at which the crop window is still at
+// least as large as the output, so that the resize never upsamples an image
+// that was decoded below its needed resolution.
+int DctScalingRatio(int64_t crop_height, int64_t crop_width,
+                    int64_t out_height, int64_t out_width) {
+  for (int ratio : kDctScalingRatios) {
+    if (crop_height / ratio >= out_height && crop_width / ratio >= out_width) {
+      return ratio;
+    }
+  }
+  return 1;
+}
+
+// The two input pixels an output pixel is interpolated from along one
+// dimension, as offsets into the input, and the weight of the upper one.
+struct Interpolation {
+  int64_t lower;
+  int64_t upper;
+  float lerp;
+};
+
+// Computes the bilinear interpolation, with half pixel centers, of the
+// `out_size` output pixels of the crop window [crop_start, crop_start +
+// crop_size) of the full resolution image along one dimension. The input is
+// decoded at 1/`ratio` of the full resolution, with `decoded_size` pixels
+// from the scaled pixel `decoded_start`. Input pixels are `stride` apart.
+std::vector<Interpolation> ComputeInterpolation(
+    int64_t out_size, int64_t crop_start, int64_t crop_size, int ratio,
+    int64_t decoded_start, int64_t decoded_size, int64_t stride) {
+  std::vector<Interpolation> interpolation(out_size);
+  const double scale = static_cast<double>(crop_size) / out_size;
+  for (int64_t i = 0; i < out_size; ++i) {
+    // The center of the output pixel in the full resolution image, then in
+    // the decoded part of the scaled image, whose pixel k is centered on
+    // (k + 0.5) * ratio.
+    const double center = crop_start + (i + 0.5) * scale;
+    const double in = std::max(center / ratio - 0.5 - decoded_start, 0.0);
+    const int64_t lower =
+        std::min(static_cast<int64_t>(in), decoded_size - 1);
+    const int64_t upper = std::min(lower + 1, decoded_size - 1);
+    interpolation[i].lower = lower * stride;
+    interpolation[i].upper = upper * stride;
+    interpolation[i].lerp = upper == lower ? 0.0f : in - lower;
+  }
+  return interpolation;
+}
+
+template <typename T>
+inline T FromFloat(float value) {
+  return static_cast<T>(value);
+}
+
+template <>
+inline uint8 FromFloat<uint8>(float value) {
+  // The interpolated values are within [0, 255].
+  return static_cast<uint8>(value + 0.5f);
+}
+
+// Resizes the decoded crop window `input` into `output`, one row at a time
+// from the two input rows it is interpolated from.
+template <typename T>
+void ResizeBilinear(OpKernelContext* context, const Tensor& input,
+                    const std::vector<Interpolation>& ys,
+                    const std::vector<Interpolation>& xs, Tensor* output) {
+  const uint8* input_data = input.flat<uint8>().data();
+  const int64_t channels = input.dim_size(2);
+  auto output_tensor = output->tensor<T, 3>();
+  const int64_t out_width = output->dim_size(1);
+  auto resize_rows = [&](int64_t start, int64_t limit) {
+    for (int64_t y = start; y < limit; ++y) {
+      const uint8* top = input_data + ys[y].lower;
+      const uint8* bottom = input_data + ys[y].upper;
+      const float y_lerp = ys[y].lerp;
+      T* out = &output_tensor(y, 0, 0);
+      for (int64_t x = 0; x < out_width; ++x) {
+        const Interpolation& xi = xs[x];
+        for (int64_t c = 0; c < channels; ++c) {
+          const float top_left = top[xi.lower + c];
+          const float top_right = top[xi.upper + c];
+          const float bottom_left = bottom[xi.lower + c];
+          const float bottom_right = bottom[xi.upper + c];
+          const float top_value = top_left + (top_right - top_left) * xi.lerp;
+          const float bottom_value =
+              bottom_left + (bottom_right - bottom_left) * xi.lerp;
+          *out++ =
+              FromFloat<T>(top_value + (bottom_value - top_value) * y_lerp);
+        }
+      }
+    }
+  };
+  auto worker_threads = *(context->device()->tensorflow_cpu_worker_threads());
+  const int64_t cost_per_row = out_width * channels * 10;
+  Shard(worker_threads.num_threads, worker_threads.workers, ys.size(),
+        cost_per_row, resize_rows);
+}
+
+// Decodes a crop window of a JPEG image and resizes it with bilinear
+// interpolation, decoding it at the smallest DCT scaling that keeps the crop
+// window at least as large as the output.
+class DecodeAndCropAndResizeJpegOp : public OpKernel {
+ public:
+  explicit DecodeAndCropAndResizeJpegOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    OP_REQUIRES_OK(context, context->GetAttr("channels", &channels_));
+    OP_REQUIRES(context, channels_ == 0 || channels_ == 1 || channels_ == 3,
+                errors::InvalidArgument("`channels` must be 0, 1 or 3 but got ",
+                                        channels_));
+    OP_REQUIRES_OK(context, context->GetAttr("fancy_upscaling",
+                                             &flags_.fancy_upscaling));
+    OP_REQUIRES_OK(context,
+                   context->GetAttr("try_recover_truncated",
+                                    &flags_.try_recover_truncated_jpeg));
+    OP_REQUIRES_OK(context, context->GetAttr("acceptable_fraction",
+                                             &flags_.min_acceptable_fraction));
+    string dct_method;
+    OP_REQUIRES_OK(context, context->GetAttr("dct_method", &dct_method));
+    OP_REQUIRES(
+        context,
+        (dct_method.empty() || dct_method == "INTEGER_FAST" ||
+         dct_method == "INTEGER_ACCURATE"),
+        errors::InvalidArgument("dct_method must be one of "
+                                "{'', 'INTEGER_FAST', 'INTEGER_ACCURATE'}"));
+    // The TensorFlow-chosen default for JPEG decoding is IFAST, sacrificing
+    // image quality for speed.
+    flags_.dct_method =
+        dct_method == "INTEGER_ACCURATE" ? JDCT_ISLOW : JDCT_IFAST;
+    flags_.components = channels_;
+    OP_REQUIRES_OK(context, context->GetAttr("dtype", &data_type_));
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& contents = context->input(0);
+    OP_REQUIRES(
+        context, TensorShapeUtils::IsScalar(contents.shape()),
+        errors::InvalidArgument("`contents` must be scalar but got shape",
+                                contents.shape().DebugString()));
+    const StringPiece input = contents.scalar<tstring>()();
+    OP_REQUIRES(context, input.size() <= std::numeric_limits<int>::max(),
+                errors::InvalidArgument(
+                    "JPEG contents are too large for int: ", input.size()));
+
+    const Tensor& crop_window = context->input(1);
+    OP_REQUIRES(context,
+                crop_window.dims() == 1 && crop_window.dim_size(0) == 4,
+                errors::InvalidArgument(
+                    "crop_window must have shape [4], got shape ",
+                    crop_window.shape().DebugString()));
+    const Tensor& size = context->input(2);
+    OP_REQUIRES(context, size.dims() == 1 && size.dim_size(0) == 2,
+                errors::InvalidArgument("size must have shape [2], got shape ",
+                                        size.shape().DebugString()));
+    auto crop_window_vec = crop_window.vec<int32>();
+    const int64_t crop_y = crop_window_vec(0);
+    const int64_t crop_x = crop_window_vec(1);
+    const int64_t crop_height = crop_window_vec(2);
+    const int64_t crop_width = crop_window_vec(3);
+    const int64_t out_height = size.vec<int32>()(0);
+    const int64_t out_width = size.vec<int32>()(1);
+    OP_REQUIRES(context, out_height > 0 && out_width > 0,
+                errors::InvalidArgument("size must be positive, got ",
+                                        out_height, "x", out_width));
+
+    int width, height, components;
+    OP_REQUIRES(context,
+                jpeg::GetImageInfo(input.data(), input.size(), &width, &height,
+                                   &components),
+                errors::InvalidArgument("Invalid JPEG data, size ",
+                                        input.size()));
+    OP_REQUIRES(
+        context,
+        crop_y >= 0 && crop_x >= 0 && crop_height > 0 && crop_width > 0 &&
+            crop_y + crop_height <= height && crop_x + crop_width <= width,
+        errors::InvalidArgument("Invalid crop window: y=", crop_y,
+                                ", x=", crop_x, ", h=", crop_height,
+                                ", w=", crop_width, " for image of ", height,
+                                "x", width));
+
+    // Decode the scaled pixels that cover the crop window. libjpeg rounds
+    // the scaled image size up.
+    const int ratio =
+        DctScalingRatio(crop_height, crop_width, out_height, out_width);
+    const int64_t scaled_height = (height + ratio - 1) / ratio;
+    const int64_t scaled_width = (width + ratio - 1) / ratio;
+    jpeg::UncompressFlags flags = flags_;
+    flags.ratio = ratio;
+    flags.crop = true;
+    flags.crop_y = crop_y / ratio;
+    flags.crop_x = crop_x / ratio;
+    flags.crop_height =
+        std::min(scaled_height, (crop_y + crop_height + ratio - 1) / ratio) -
+        flags.crop_y;
+    flags.crop_width =
+        std::min(scaled_width, (crop_x + crop_width + ratio - 1) / ratio) -
+        flags.crop_x;
+
+    Tensor decoded;
+    uint8* buffer = jpeg::Uncompress(
+        input.data(), input.size(), flags, nullptr /* nwarn */,
+        [&](int width, int height, int channels) -> uint8* {
+          Status status = context->allocate_temp(
+              DT_UINT8, TensorShape({height, width, channels}), &decoded);
+          if (!status.ok()) {
+            VLOG(1) << status;
+            context->SetStatus(status);
+            return nullptr;
+          }
+          return decoded.flat<uint8>().data();
+        });
+    OP_REQUIRES(
+        context, buffer,
+        errors::InvalidArgument(
+            "jpeg::Uncompress failed. Invalid JPEG data or crop window."));
+
+    const int64_t channels = decoded.dim_size(2);
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(context,
+                   context->allocate_output(
+                       0, TensorShape({out_height, out_width, channels}),
+                       &output));
+    const std::vector<Interpolation> ys = ComputeInterpolation(
+        out_height, crop_y, crop_height, ratio, flags.crop_y,
+        decoded.dim_size(0), decoded.dim_size(1) * channels);
+    const std::vector<Interpolation> xs =
+        ComputeInterpolation(out_width, crop_x, crop_width, ratio,
+                             flags.crop_x, decoded.dim_size(1), channels);
+    switch (data_type_) {
+      case DT_UINT8:
+        ResizeBilinear<uint8>(context, decoded, ys, xs, output);
+        break;
+      case DT_BFLOAT16:
+        ResizeBilinear<bfloat16>(context, decoded, ys, xs, output);
+        break;
+      case DT_FLOAT:
+        ResizeBilinear<float>(context, decoded, ys, xs, output);
+        break;
+      default:
+        context->SetStatus(errors::InvalidArgument(
+            "Unsupported dtype: ", DataTypeString(data_type_)));
+    }
+  }
+
+ private:
+  jpeg::UncompressFlags flags_;
+  int channels_;
+  DataType data_type_;
+};
+
+REGISTER_KERNEL_BUILDER(Name("DecodeAndCropAndResizeJpeg").Device(DEVICE_CPU),
+                        DecodeAndCropAndResizeJpegOp);
+
+}  // namespace
+}  // namespace tensorflow
@@ -0,0 +1,132 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <cmath>
+#include <vector>
+
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/jpeg/jpeg_mem.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+constexpr int kWidth = 640;
+constexpr int kHeight = 480;
+
+// The value of the red and green channels of the test image, which are
+// horizontal and vertical ramps.
+float Red(double x) { return x * 255 / kWidth; }
+float Green(double y) { return y * 255 / kHeight; }
+
+tstring EncodeTestImage() {
+  std::vector<uint8> image(kWidth * kHeight * 3);
+  for (int y = 0; y < kHeight; ++y) {
+    for (int x = 0; x < kWidth; ++x) {
+      uint8* pixel = &image[(y * kWidth + x) * 3];
+      pixel[0] = static_cast<uint8>(Red(x + 0.5));
+      pixel[1] = static_cast<uint8>(Green(y + 0.5));
+      pixel[2] = 128;
+    }
+  }
+  jpeg::CompressFlags flags;
+  flags.format = jpeg::FORMAT_RGB;
+  flags.quality = 95;
+  tstring encoded;
+  CHECK(jpeg::Compress(image.data(), kWidth, kHeight, flags, &encoded));
+  return encoded;
+}
+
+class DecodeAndCropAndResizeJpegOpTest : public OpsTestBase {
+ protected:
+  void MakeOp(DataType dtype) {
+    TF_ASSERT_OK(NodeDefBuilder("decode_op", "DecodeAndCropAndResizeJpeg")
+                     .Input(FakeInput(DT_STRING))
+                     .Input(FakeInput(DT_INT32))
+                     .Input(FakeInput(DT_INT32))
+                     .Attr("channels", 3)
+                     .Attr("dtype", dtype)
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+  }
+
+  // Checks that the red and green channels of the output follow the ramps of
+  // the test image over the crop window.
+  template <typename T>
+  void ExpectRamps(const std::vector<int32>& crop_window, int out_height,
+                   int out_width) {
+    const Tensor& output = *GetOutput(0);
+    ASSERT_EQ(output.shape(), TensorShape({out_height, out_width, 3}));
+    auto image = output.tensor<T, 3>();
+    for (int y = 0; y < out_height; ++y) {
+      for (int x = 0; x < out_width; ++x) {
+        const double center_y =
+            crop_window[0] + (y + 0.5) * crop_window[2] / out_height;
+        const double center_x =
+            crop_window[1] + (x + 0.5) * crop_window[3] / out_width;
+        EXPECT_NEAR(static_cast<float>(image(y, x, 0)), Red(center_x), 4)
+            << y << " " << x;
+        EXPECT_NEAR(static_cast<float>(image(y, x, 1)), Green(center_y), 4)
+            << y << " " << x;
+      }
+    }
+  }
+};
+
+TEST_F(DecodeAndCropAndResizeJpegOpTest, DownscalesWithDctScaling) {
+  MakeOp(DT_UINT8);
+  const std::vector<int32> crop_window = {37, 91, 417, 533};
+  AddInputFromArray<tstring>(TensorShape({}), {EncodeTestImage()});
+  AddInputFromArray<int32>(TensorShape({4}), crop_window);
+  AddInputFromArray<int32>(TensorShape({2}), {50, 60});
+  TF_ASSERT_OK(RunOpKernel());
+  ExpectRamps<uint8>(crop_window, 50, 60);
+}
+
+TEST_F(DecodeAndCropAndResizeJpegOpTest, Upscales) {
+  MakeOp(DT_FLOAT);
+  const std::vector<int32> crop_window = {100, 50, 30, 40};
+  AddInputFromArray<tstring>(TensorShape({}), {EncodeTestImage()});
+  AddInputFromArray<int32>(TensorShape({4}), crop_window);
+  AddInputFromArray<int32>(TensorShape({2}), {64, 64});
+  TF_ASSERT_OK(RunOpKernel());
+  ExpectRamps<float>(crop_window, 64, 64);
+}
+
+TEST_F(DecodeAndCropAndResizeJpegOpTest, OutputsBfloat16) {
+  MakeOp(DT_BFLOAT16);
+  const std::vector<int32> crop_window = {0, 0, kHeight, kWidth};
+  AddInputFromArray<tstring>(TensorShape({}), {EncodeTestImage()});
+  AddInputFromArray<int32>(TensorShape({4}), crop_window);
+  AddInputFromArray<int32>(TensorShape({2}), {100, 120});
+  TF_ASSERT_OK(RunOpKernel());
+  ExpectRamps<bfloat16>(crop_window, 100, 120);
+}
+
+TEST_F(DecodeAndCropAndResizeJpegOpTest, RejectsCropWindowOutsideImage) {
+  MakeOp(DT_UINT8);
+  AddInputFromArray<tstring>(TensorShape({}), {EncodeTestImage()});
+  AddInputFromArray<int32>(TensorShape({4}), {400, 0, 100, 100});
+  AddInputFromArray<int32>(TensorShape({2}), {10, 10});
+  EXPECT_TRUE(errors::IsInvalidArgument(RunOpKernel()));
+}
+
+}  // namespace
+}  // namespace tensorflow
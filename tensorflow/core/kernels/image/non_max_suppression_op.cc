@@ -19,10 +19,13 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/image/non_max_suppression_op.h"
 
+#include <algorithm>
 #include <cmath>
 #include <functional>
 #include <limits>
+#include <numeric>
 #include <queue>
+#include <type_traits>
 #include <vector>
 
 #include "unsupported/Eigen/CXX11/Tensor"  // from @eigen_archive
@@ -34,6 +37,7 @@ limitations under the License.
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 namespace {
@@ -192,6 +196,45 @@ static inline std::function<T(int, int)> CreateOverlapSimilarityFn(
                    std::placeholders::_2);
 }
 
+// Writes the indices and the scores of the boxes selected by NMS to the
+// outputs.
+template <typename T>
+void WriteNonMaxSuppressionOutputs(OpKernelContext* context, int output_size,
+                                   std::vector<int>* selected_indices,
+                                   std::vector<T>* selected_box_scores,
+                                   bool return_scores_tensor,
+                                   bool pad_to_max_output_size,
+                                   int* ptr_num_valid_outputs) {
+  std::vector<int>& selected = *selected_indices;
+  std::vector<T>& selected_scores = *selected_box_scores;
+  int num_valid_outputs = selected.size();
+  if (pad_to_max_output_size) {
+    selected.resize(output_size, 0);
+    selected_scores.resize(output_size, static_cast<T>(0));
+  }
+  if (ptr_num_valid_outputs) {
+    *ptr_num_valid_outputs = num_valid_outputs;
+  }
+
+  // Allocate output tensors
+  Tensor* output_indices = nullptr;
+  TensorShape output_shape({static_cast<int>(selected.size())});
+  OP_REQUIRES_OK(context,
+                 context->allocate_output(0, output_shape, &output_indices));
+  TTypes<int, 1>::Tensor output_indices_data = output_indices->tensor<int, 1>();
+  std::copy_n(selected.begin(), selected.size(), output_indices_data.data());
+
+  if (return_scores_tensor) {
+    Tensor* output_scores = nullptr;
+    OP_REQUIRES_OK(context,
+                   context->allocate_output(1, output_shape, &output_scores));
+    typename TTypes<T, 1>::Tensor output_scores_data =
+        output_scores->tensor<T, 1>();
+    std::copy_n(selected_scores.begin(), selected_scores.size(),
+                output_scores_data.data());
+  }
+}
+
 template <typename T>
 void DoNonMaxSuppressionOp(OpKernelContext* context, const Tensor& scores,
                            int num_boxes, const Tensor& max_output_size,
@@ -302,32 +345,172 @@ void DoNonMaxSuppressionOp(OpKernelContext* context, const Tensor& scores,
     }
   }
 
-  int num_valid_outputs = selected.size();
-  if (pad_to_max_output_size) {
-    selected.resize(output_size, 0);
-    selected_scores.resize(output_size, static_cast<T>(0));
+  WriteNonMaxSuppressionOutputs<T>(context, output_size, &selected,
+                                   &selected_scores, return_scores_tensor,
+                                   pad_to_max_output_size,
+                                   ptr_num_valid_outputs);
+}
+
+// Hard NMS with the IOU of at least this many boxes uses
+// DoBlockedNonMaxSuppression.
+constexpr int kMinBoxesForBlockedNMS = 1024;
+// The number of candidates DoBlockedNonMaxSuppression compares in parallel
+// against the boxes already selected.
+constexpr int kBlockedNMSBlockSize = 256;
+// The rough cost of an IOU computation, in cycles.
+constexpr int kIOUCost = 20;
+
+// The boxes selected by DoBlockedNonMaxSuppression, with their corners
+// ordered and their areas, stored as one array per coordinate so that the
+// IOU of a candidate with many of them can be vectorized.
+struct SelectedBoxes {
+  int size() const { return box_index.size(); }
+
+  std::vector<float> ymin;
+  std::vector<float> xmin;
+  std::vector<float> ymax;
+  std::vector<float> xmax;
+  std::vector<float> area;
+  std::vector<int> box_index;
+};
+
+// Returns whether the box with the given corners and area has an IOU above
+// `iou_threshold` with any of the selected boxes [begin, end). Computes the
+// IOU as `IOU` does.
+bool OverlapsAnySelected(float ymin, float xmin, float ymax, float xmax,
+                         float area, const SelectedBoxes& selected, int begin,
+                         int end, float iou_threshold) {
+  if (area <= 0) return false;
+  // Checks chunks of boxes without branches, to vectorize them.
+  constexpr int kChunkSize = 16;
+  for (int chunk = begin; chunk < end; chunk += kChunkSize) {
+    const int chunk_end = std::min(end, chunk + kChunkSize);
+    bool overlaps = false;
+    for (int j = chunk; j < chunk_end; ++j) {
+      const float intersection_ymin = std::max(ymin, selected.ymin[j]);
+      const float intersection_xmin = std::max(xmin, selected.xmin[j]);
+      const float intersection_ymax = std::min(ymax, selected.ymax[j]);
+      const float intersection_xmax = std::min(xmax, selected.xmax[j]);
+      const float intersection_area =
+          std::max(intersection_ymax - intersection_ymin, 0.0f) *
+          std::max(intersection_xmax - intersection_xmin, 0.0f);
+      const float iou =
+          intersection_area / (area + selected.area[j] - intersection_area);
+      overlaps |= selected.area[j] > 0 && iou > iou_threshold;
+    }
+    if (overlaps) return true;
   }
-  if (ptr_num_valid_outputs) {
-    *ptr_num_valid_outputs = num_valid_outputs;
+  return false;
+}
+
+// Hard NMS with the IOU, selecting the same boxes in the same order as
+// DoNonMaxSuppressionOp. The candidates are sorted by score, then compared
+// in blocks: each candidate of a block is compared against the boxes
+// selected by the previous blocks in parallel, and the remaining ones
+// against the boxes selected earlier in the block in order.
+void DoBlockedNonMaxSuppression(OpKernelContext* context, const Tensor& boxes,
+                                const Tensor& scores, int num_boxes,
+                                int output_size, float iou_threshold,
+                                float score_threshold,
+                                std::vector<int>* selected_indices,
+                                std::vector<float>* selected_scores) {
+  const float* boxes_data = boxes.flat<float>().data();
+  const float* scores_data = scores.flat<float>().data();
+  std::vector<int> candidates;
+  for (int i = 0; i < num_boxes; ++i) {
+    if (scores_data[i] > score_threshold) candidates.push_back(i);
+  }
+  // The order in which DoNonMaxSuppressionOp pops the candidates.
+  std::sort(candidates.begin(), candidates.end(), [scores_data](int i, int j) {
+    return scores_data[i] > scores_data[j] ||
+           (scores_data[i] == scores_data[j] && i < j);
+  });
+
+  SelectedBoxes selected;
+  auto worker_threads = *(context->device()->tensorflow_cpu_worker_threads());
+  std::vector<char> suppressed(kBlockedNMSBlockSize);
+  const int num_candidates = candidates.size();
+  for (int block_start = 0;
+       block_start < num_candidates && selected.size() < output_size;
+       block_start += kBlockedNMSBlockSize) {
+    const int block_size =
+        std::min(kBlockedNMSBlockSize, num_candidates - block_start);
+    const int num_previous = selected.size();
+    auto corners = [&](int candidate, float* ymin, float* xmin, float* ymax,
+                       float* xmax) {
+      const float* box = boxes_data + 4 * candidates[block_start + candidate];
+      *ymin = std::min(box[0], box[2]);
+      *xmin = std::min(box[1], box[3]);
+      *ymax = std::max(box[0], box[2]);
+      *xmax = std::max(box[1], box[3]);
+    };
+    Shard(worker_threads.num_threads, worker_threads.workers, block_size,
+          static_cast<int64_t>(num_previous) * kIOUCost,
+          [&](int64_t start, int64_t limit) {
+            for (int64_t c = start; c < limit; ++c) {
+              float ymin, xmin, ymax, xmax;
+              corners(c, &ymin, &xmin, &ymax, &xmax);
+              suppressed[c] = OverlapsAnySelected(
+                  ymin, xmin, ymax, xmax, (ymax - ymin) * (xmax - xmin),
+                  selected, 0, num_previous, iou_threshold);
+            }
+          });
+    for (int c = 0; c < block_size && selected.size() < output_size;
+         ++c) {
+      if (suppressed[c]) continue;
+      float ymin, xmin, ymax, xmax;
+      corners(c, &ymin, &xmin, &ymax, &xmax);
+      const float area = (ymax - ymin) * (xmax - xmin);
+      if (OverlapsAnySelected(ymin, xmin, ymax, xmax, area, selected,
+                              num_previous, selected.size(), iou_threshold)) {
+        continue;
+      }
+      selected.ymin.push_back(ymin);
+      selected.xmin.push_back(xmin);
+      selected.ymax.push_back(ymax);
+      selected.xmax.push_back(xmax);
+      selected.area.push_back(area);
+      selected.box_index.push_back(candidates[block_start + c]);
+    }
   }
 
-  // Allocate output tensors
-  Tensor* output_indices = nullptr;
-  TensorShape output_shape({static_cast<int>(selected.size())});
-  OP_REQUIRES_OK(context,
-                 context->allocate_output(0, output_shape, &output_indices));
-  TTypes<int, 1>::Tensor output_indices_data = output_indices->tensor<int, 1>();
-  std::copy_n(selected.begin(), selected.size(), output_indices_data.data());
+  *selected_indices = std::move(selected.box_index);
+  selected_scores->clear();
+  for (int i : *selected_indices) selected_scores->push_back(scores_data[i]);
+}
 
-  if (return_scores_tensor) {
-    Tensor* output_scores = nullptr;
-    OP_REQUIRES_OK(context,
-                   context->allocate_output(1, output_shape, &output_scores));
-    typename TTypes<T, 1>::Tensor output_scores_data =
-        output_scores->tensor<T, 1>();
-    std::copy_n(selected_scores.begin(), selected_scores.size(),
-                output_scores_data.data());
+// NMS with the IOU of `boxes` as the similarity. Large hard NMS of float
+// boxes goes through DoBlockedNonMaxSuppression.
+template <typename T>
+void DoNonMaxSuppressionWithIOU(OpKernelContext* context, const Tensor& boxes,
+                                const Tensor& scores, int num_boxes,
+                                const Tensor& max_output_size,
+                                const T iou_threshold, const T score_threshold,
+                                const T soft_nms_sigma,
+                                bool return_scores_tensor = false,
+                                bool pad_to_max_output_size = false,
+                                int* ptr_num_valid_outputs = nullptr) {
+  if constexpr (std::is_same<T, float>::value) {
+    if (soft_nms_sigma <= 0.0f && num_boxes >= kMinBoxesForBlockedNMS) {
+      const int output_size = max_output_size.scalar<int>()();
+      OP_REQUIRES(context, output_size >= 0,
+                  errors::InvalidArgument("output size must be non-negative"));
+      std::vector<int> selected;
+      std::vector<float> selected_scores;
+      DoBlockedNonMaxSuppression(context, boxes, scores, num_boxes,
+                                 output_size, iou_threshold, score_threshold,
+                                 &selected, &selected_scores);
+      WriteNonMaxSuppressionOutputs<float>(
+          context, output_size, &selected, &selected_scores,
+          return_scores_tensor, pad_to_max_output_size, ptr_num_valid_outputs);
+      return;
+    }
   }
+  auto similarity_fn = CreateIOUSimilarityFn<T>(boxes);
+  DoNonMaxSuppressionOp<T>(context, scores, num_boxes, max_output_size,
+                           iou_threshold, score_threshold, soft_nms_sigma,
+                           similarity_fn, return_scores_tensor,
+                           pad_to_max_output_size, ptr_num_valid_outputs);
 }
 
 struct ResultCandidate {
@@ -648,13 +831,12 @@ class NonMaxSuppressionOp : public OpKernel {
     if (!context->status().ok()) {
       return;
     }
-    auto similarity_fn = CreateIOUSimilarityFn<float>(boxes);
-
     const float score_threshold_val = std::numeric_limits<float>::lowest();
     const float dummy_soft_nms_sigma = static_cast<float>(0.0);
-    DoNonMaxSuppressionOp<float>(context, scores, num_boxes, max_output_size,
-                                 iou_threshold_, score_threshold_val,
-                                 dummy_soft_nms_sigma, similarity_fn);
+    DoNonMaxSuppressionWithIOU<float>(context, boxes, scores, num_boxes,
+                                      max_output_size, iou_threshold_,
+                                      score_threshold_val,
+                                      dummy_soft_nms_sigma);
   }
 
  private:
@@ -695,13 +877,11 @@ class NonMaxSuppressionV2Op : public OpKernel {
     if (!context->status().ok()) {
       return;
     }
-    auto similarity_fn = CreateIOUSimilarityFn<T>(boxes);
-
     const T score_threshold_val = std::numeric_limits<T>::lowest();
     const T dummy_soft_nms_sigma = static_cast<T>(0.0);
-    DoNonMaxSuppressionOp<T>(context, scores, num_boxes, max_output_size,
-                             iou_threshold_val, score_threshold_val,
-                             dummy_soft_nms_sigma, similarity_fn);
+    DoNonMaxSuppressionWithIOU<T>(context, boxes, scores, num_boxes,
+                                  max_output_size, iou_threshold_val,
+                                  score_threshold_val, dummy_soft_nms_sigma);
   }
 };
 
@@ -751,12 +931,10 @@ class NonMaxSuppressionV3Op : public OpKernel {
       return;
     }
 
-    auto similarity_fn = CreateIOUSimilarityFn<T>(boxes);
-
     const T dummy_soft_nms_sigma = static_cast<T>(0.0);
-    DoNonMaxSuppressionOp<T>(context, scores, num_boxes, max_output_size,
-                             iou_threshold_val, score_threshold_val,
-                             dummy_soft_nms_sigma, similarity_fn);
+    DoNonMaxSuppressionWithIOU<T>(context, boxes, scores, num_boxes,
+                                  max_output_size, iou_threshold_val,
+                                  score_threshold_val, dummy_soft_nms_sigma);
   }
 };
 
@@ -805,15 +983,14 @@ class NonMaxSuppressionV4Op : public OpKernel {
       return;
     }
 
-    auto similarity_fn = CreateIOUSimilarityFn<T>(boxes);
     int num_valid_outputs;
 
     bool return_scores_tensor_ = false;
     const T dummy_soft_nms_sigma = static_cast<T>(0.0);
-    DoNonMaxSuppressionOp<T>(
-        context, scores, num_boxes, max_output_size, iou_threshold_val,
-        score_threshold_val, dummy_soft_nms_sigma, similarity_fn,
-        return_scores_tensor_, pad_to_max_output_size_, &num_valid_outputs);
+    DoNonMaxSuppressionWithIOU<T>(
+        context, boxes, scores, num_boxes, max_output_size, iou_threshold_val,
+        score_threshold_val, dummy_soft_nms_sigma, return_scores_tensor_,
+        pad_to_max_output_size_, &num_valid_outputs);
     if (!context->status().ok()) {
       return;
     }
@@ -884,16 +1061,15 @@ class NonMaxSuppressionV5Op : public OpKernel {
       return;
     }
 
-    auto similarity_fn = CreateIOUSimilarityFn<T>(boxes);
     int num_valid_outputs;
 
     // For NonMaxSuppressionV5Op, we always return a second output holding
     // corresponding scores, so `return_scores_tensor` should never be false.
     const bool return_scores_tensor_ = true;
-    DoNonMaxSuppressionOp<T>(
-        context, scores, num_boxes, max_output_size, iou_threshold_val,
-        score_threshold_val, soft_nms_sigma_val, similarity_fn,
-        return_scores_tensor_, pad_to_max_output_size_, &num_valid_outputs);
+    DoNonMaxSuppressionWithIOU<T>(
+        context, boxes, scores, num_boxes, max_output_size, iou_threshold_val,
+        score_threshold_val, soft_nms_sigma_val, return_scores_tensor_,
+        pad_to_max_output_size_, &num_valid_outputs);
     if (!context->status().ok()) {
       return;
     }
@@ -77,4 +77,44 @@ BN_Boxes_Number(90, 90);
 BN_Boxes_Number(200, 1);
 BN_Boxes_Number(200, 200);
 
+static Graph* NonMaxSuppressionV5(int box_num, int max_output_size) {
+  Graph* g = new Graph(OpRegistry::Global());
+  Tensor boxes(DT_FLOAT, TensorShape({box_num, 4}));
+  boxes.flat<float>().setRandom();
+  Tensor scores(DT_FLOAT, TensorShape({box_num}));
+  scores.flat<float>().setRandom();
+
+  Tensor max_output_size_t(max_output_size);
+  Tensor iou_threshold(float(0.5));
+  Tensor score_threshold(float(0.0));
+  Tensor soft_nms_sigma(float(0.0));
+
+  Node* ret;
+  TF_CHECK_OK(NodeBuilder(g->NewName("n"), "NonMaxSuppressionV5")
+                  .Input(test::graph::Constant(g, boxes))
+                  .Input(test::graph::Constant(g, scores))
+                  .Input(test::graph::Constant(g, max_output_size_t))
+                  .Input(test::graph::Constant(g, iou_threshold))
+                  .Input(test::graph::Constant(g, score_threshold))
+                  .Input(test::graph::Constant(g, soft_nms_sigma))
+                  .Attr("pad_to_max_output_size", true)
+                  .Finalize(g, &ret));
+  return g;
+}
+
+#define BM_NonMaxSuppressionV5Dev(DEVICE, BN, MO)         \
+  static void BM_NMSV5_##DEVICE##_##BN##_##MO(            \
+      ::testing::benchmark::State& state) {               \
+    test::Benchmark(#DEVICE, NonMaxSuppressionV5(BN, MO), \
+                    /*old_benchmark_api*/ false)          \
+        .Run(state);                                      \
+    state.SetItemsProcessed(state.iterations() * BN);     \
+  }                                                       \
+  BENCHMARK(BM_NMSV5_##DEVICE##_##BN##_##MO);
+
+BM_NonMaxSuppressionV5Dev(cpu, 1000, 100);
+BM_NonMaxSuppressionV5Dev(cpu, 10000, 1000);
+BM_NonMaxSuppressionV5Dev(cpu, 100000, 1000);
+BM_NonMaxSuppressionV5Dev(cpu, 100000, 10000);
+
 }  // namespace tensorflow
@@ -769,6 +769,42 @@ TEST_F(NonMaxSuppressionV5OpTest, TestSelectFromThreeClustersWithSoftNMS) {
   test::ExpectTensorEqual<int>(expected_num_valid, *GetOutput(2));
 }
 
+TEST_F(NonMaxSuppressionV5OpTest, TestSelectFromManyPairsOfBoxes) {
+  // Enough boxes for the blocked hard NMS. Each pair of boxes overlaps, and
+  // the second box of each pair has the higher score.
+  constexpr int kNumPairs = 1000;
+  constexpr int kMaxOutputSize = 600;
+  MakeOp();
+  std::vector<float> boxes;
+  std::vector<float> scores;
+  for (int k = 0; k < kNumPairs; ++k) {
+    boxes.insert(boxes.end(), {0, 2.0f * k, 1, 2.0f * k + 1});
+    boxes.insert(boxes.end(), {0, 2.0f * k + 0.1f, 1, 2.0f * k + 1.1f});
+    scores.push_back(0.8f - 1e-4f * k);
+    scores.push_back(0.9f - 1e-4f * k);
+  }
+  AddInputFromArray<float>(TensorShape({2 * kNumPairs, 4}), boxes);
+  AddInputFromArray<float>(TensorShape({2 * kNumPairs}), scores);
+  AddInputFromArray<int>(TensorShape({}), {kMaxOutputSize});
+  AddInputFromArray<float>(TensorShape({}), {.5f});
+  AddInputFromArray<float>(TensorShape({}), {0.0f});
+  AddInputFromArray<float>(TensorShape({}), {0.0f});
+  TF_ASSERT_OK(RunOpKernel());
+
+  std::vector<int> expected_indices;
+  std::vector<float> expected_scores;
+  for (int k = 0; k < kMaxOutputSize; ++k) {
+    expected_indices.push_back(2 * k + 1);
+    expected_scores.push_back(scores[2 * k + 1]);
+  }
+  test::ExpectTensorEqual<int>(test::AsTensor<int>(expected_indices),
+                               *GetOutput(0));
+  test::ExpectTensorEqual<float>(test::AsTensor<float>(expected_scores),
+                                 *GetOutput(1));
+  test::ExpectTensorEqual<int>(test::AsScalar<int>(kMaxOutputSize),
+                               *GetOutput(2));
+}
+
 //
 // NonMaxSuppressionWithOverlapsOp Tests
 //
@@ -343,6 +343,19 @@ class TensorListReserve : public OpKernel {
     output.element_shape = element_shape;
     output.element_dtype = element_dtype_;
     output.tensors().resize(num_elements, Tensor(DT_INVALID));
+    // With a known element shape, the elements are set in place in a single
+    // buffer, so that stacking them needs no copy. The list falls back to
+    // separate elements if the buffer can't be allocated.
+    TensorShape buffer_shape;
+    if (c->device()->device_type() == DEVICE_CPU && num_elements > 0 &&
+        DataTypeCanUseMemcpy(element_dtype_) &&
+        element_shape.AsTensorShape(&buffer_shape)) {
+      buffer_shape.InsertDim(0, num_elements);
+      Tensor buffer;
+      if (c->allocate_temp(element_dtype_, buffer_shape, &buffer).ok()) {
+        output.SetContiguousBuffer(std::move(buffer));
+      }
+    }
     Tensor* result;
     AllocatorAttributes attr;
     attr.set_on_host(true);
@@ -480,6 +493,10 @@ class TensorListSetItem : public OpKernel {
     } else if (index >= l->tensors().size()) {
       output_list->tensors().resize(index + 1, Tensor(DT_INVALID));
     }
+    if (c->device()->device_type() == DEVICE_CPU &&
+        output_list->SetContiguousElement(index, value)) {
+      return;
+    }
     output_list->tensors()[index] = value;
   }
 
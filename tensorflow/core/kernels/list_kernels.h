@@ -219,6 +219,13 @@ class TensorListStack : public OpKernel {
                     partial_element_shape.DebugString()));
     TensorShape output_shape = element_shape;
     output_shape.InsertDim(0, tensor_list->tensors().size());
+    Tensor contiguous;
+    if (tensor_list->GetContiguousElements(0, tensor_list->tensors().size(),
+                                           &contiguous) &&
+        contiguous.shape() == output_shape) {
+      c->set_output(0, contiguous);
+      return;
+    }
     Tensor* output;
     OP_REQUIRES_OK(c, c->allocate_output(0, output_shape, &output));
     if (output->NumElements() == 0) {
@@ -716,6 +723,23 @@ class TensorListGather : public OpKernel {
                                 partial_element_shape.DebugString()));
     TensorShape output_shape = element_shape;
     output_shape.InsertDim(0, indices.NumElements());
+    // Consecutive elements in place in the contiguous buffer of the list are
+    // gathered without copying them.
+    const auto indices_flat = indices.flat<int32>();
+    bool consecutive = indices.NumElements() > 0;
+    for (int index = 1; consecutive && index < indices.NumElements();
+         ++index) {
+      consecutive = indices_flat(index) == indices_flat(index - 1) + 1;
+    }
+    Tensor contiguous;
+    if (consecutive &&
+        tensor_list->GetContiguousElements(
+            indices_flat(0), indices_flat(0) + indices.NumElements(),
+            &contiguous) &&
+        contiguous.shape() == output_shape) {
+      c->set_output(0, contiguous);
+      return;
+    }
     Tensor* output;
     OP_REQUIRES_OK(c, c->allocate_output(0, output_shape, &output));
     if (output->NumElements() == 0) {
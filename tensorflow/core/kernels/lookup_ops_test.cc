@@ -15,15 +15,25 @@ limitations under the License.
 
 // Tests kernels of lookup ops.
 
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
 #include "tensorflow/core/framework/fake_input.h"
 #include "tensorflow/core/framework/lookup_interface.h"
 #include "tensorflow/core/framework/node_def_builder.h"
 #include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/framework/shape_inference_testutil.h"
 #include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/kernels/initializable_lookup_table.h"
 #include "tensorflow/core/kernels/lookup_table_op.h"
+#include "tensorflow/core/kernels/lookup_util.h"
 #include "tensorflow/core/kernels/ops_testutil.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/null_file_system.h"
 #include "tensorflow/core/platform/test.h"
 
 namespace tensorflow {
@@ -100,5 +110,91 @@ TEST_F(LookupOpsTest, AnonymousHashTable_RefCounting) {
   EXPECT_FALSE(alive);
 }
 
+// The vocabulary file served by FlakyFileSystem. Reading it fails past its
+// first `kReadableBytes` bytes, in the middle of the line "f".
+constexpr char kVocabulary[] = "a\nb\nc\nd\ne\nf\ng\n";
+constexpr size_t kReadableBytes = 11;
+
+class FlakyFile : public RandomAccessFile {
+ public:
+  Status Read(uint64 offset, size_t n, StringPiece* result,
+              char* scratch) const override {
+    const size_t available =
+        offset < kReadableBytes ? std::min(n, kReadableBytes - offset) : 0;
+    std::memcpy(scratch, kVocabulary + offset, available);
+    *result = StringPiece(scratch, available);
+    if (available < n) return errors::DataLoss("Flaky read at ", offset);
+    return absl::OkStatus();
+  }
+};
+
+class FlakyFileSystem : public NullFileSystem {
+ public:
+  // import non-transactional method from the base class
+  using NullFileSystem::NewRandomAccessFile;
+
+  Status NewRandomAccessFile(
+      const string& fname, TransactionToken* token,
+      std::unique_ptr<RandomAccessFile>* result) override {
+    *result = std::make_unique<FlakyFile>();
+    return absl::OkStatus();
+  }
+};
+
+REGISTER_FILE_SYSTEM("flaky", FlakyFileSystem);
+
+// A table that records the batches of lines inserted into it.
+class RecordingTable : public lookup::InitializableLookupTable {
+ public:
+  DataType key_dtype() const override { return DT_STRING; }
+  DataType value_dtype() const override { return DT_INT64; }
+  size_t size() const override { return keys_.size(); }
+
+  const std::vector<string>& keys() const { return keys_; }
+  const std::vector<int64_t>& values() const { return values_; }
+  const std::vector<int64_t>& batch_sizes() const { return batch_sizes_; }
+
+ protected:
+  Status DoPrepare(size_t expected_num_elements) override {
+    return absl::OkStatus();
+  }
+
+  Status DoInsert(const Tensor& keys, const Tensor& values) override {
+    for (int64_t i = 0; i < keys.NumElements(); ++i) {
+      keys_.push_back(keys.flat<tstring>()(i));
+      values_.push_back(values.flat<int64_t>()(i));
+    }
+    batch_sizes_.push_back(keys.NumElements());
+    return absl::OkStatus();
+  }
+
+  Status DoFind(const Tensor& keys, Tensor* values,
+                const Tensor& default_value) override {
+    return errors::Unimplemented("DoFind");
+  }
+
+ private:
+  std::vector<string> keys_;
+  std::vector<int64_t> values_;
+  std::vector<int64_t> batch_sizes_;
+};
+
+TEST(InitializeTableFromTextFileTest, ReadErrorInTheMiddleOfABatch) {
+  core::RefCountPtr<RecordingTable> table(new RecordingTable);
+  // The keys are the lines, and the values their line numbers.
+  const Status status = lookup::InitializeTableFromTextFile(
+      "flaky://vocabulary.txt", /*vocab_size=*/7, /*delimiter=*/'\t',
+      /*key_index=*/-2, /*value_index=*/-1, /*offset=*/0, Env::Default(),
+      table.get());
+
+  // The lines read before the error are inserted as one batch, and the error
+  // is only returned after them.
+  EXPECT_TRUE(errors::IsDataLoss(status)) << status;
+  EXPECT_THAT(table->batch_sizes(), ::testing::ElementsAre(5));
+  EXPECT_THAT(table->keys(), ::testing::ElementsAre("a", "b", "c", "d", "e"));
+  EXPECT_THAT(table->values(), ::testing::ElementsAre(0, 1, 2, 3, 4));
+  EXPECT_FALSE(table->is_initialized());
+}
+
 }  // namespace
 }  // namespace tensorflow
@@ -24,6 +24,7 @@ limitations under the License.
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/variant.h"
 #include "tensorflow/core/kernels/initializable_lookup_table.h"
+#include "tensorflow/core/kernels/striped_hash_map.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/hash/hash.h"
 #include "tensorflow/core/platform/random.h"
@@ -36,11 +37,12 @@ std::string UniqueNodeName(const std::string& base) {
   return strings::StrCat(base, "/", counter.fetch_add(1), "/", random::New64());
 }
 
-// Lookup table that wraps an unordered_map, where the key and value data type
+// Lookup table that wraps a StripedHashMap, where the key and value data type
 // is specified. Each individual value must be a scalar. If vector values are
 // required, use MutableHashTableOfTensors.
 //
 // This table is mutable and thread safe - Insert can be called at any time.
+// Concurrent calls only contend on the stripes of the map they have keys in.
 //
 // Sample use case:
 //
@@ -55,10 +57,7 @@ class MutableHashTableOfScalars final : public LookupInterface {
  public:
   MutableHashTableOfScalars(OpKernelContext* ctx, OpKernel* kernel) {}
 
-  size_t size() const override {
-    tf_shared_lock l(mu_);
-    return table_.size();
-  }
+  size_t size() const override { return table_.size(); }
 
   Status Find(OpKernelContext* ctx, const Tensor& key, Tensor* value,
               const Tensor& default_value) override {
@@ -70,18 +69,19 @@ class MutableHashTableOfScalars final : public LookupInterface {
     int64_t default_total = default_flat.size();
     bool is_full_size_default = (total == default_total);
 
-    tf_shared_lock l(mu_);
-    for (int64_t i = 0; i < key_values.size(); ++i) {
-      // is_full_size_default is true:
-      //   Each key has an independent default value, key_values(i)
-      //   corresponding uses default_flat(i) as its default value.
-      //
-      // is_full_size_default is false:
-      //   All keys will share the default_flat(0) as default value.
-      value_values(i) = gtl::FindWithDefault(
-          table_, SubtleMustCopyIfIntegral(key_values(i)),
-          is_full_size_default ? default_flat(i) : default_flat(0));
-    }
+    table_.FindBatch(
+        absl::MakeConstSpan(key_values.data(), key_values.size()),
+        [&](int64_t i, const V& value) { value_values(i) = value; },
+        [&](int64_t i) {
+          // is_full_size_default is true:
+          //   Each key has an independent default value, key_values(i)
+          //   corresponding uses default_flat(i) as its default value.
+          //
+          // is_full_size_default is false:
+          //   All keys will share the default_flat(0) as default value.
+          value_values(i) =
+              is_full_size_default ? default_flat(i) : default_flat(0);
+        });
 
     return absl::OkStatus();
   }
@@ -89,14 +89,16 @@ class MutableHashTableOfScalars final : public LookupInterface {
   Status DoInsert(bool clear, const Tensor& keys, const Tensor& values) {
     const auto key_values = keys.flat<K>();
     const auto value_values = values.flat<V>();
+    const auto keys_span =
+        absl::MakeConstSpan(key_values.data(), key_values.size());
+    auto value = [&](int64_t i) -> V {
+      return SubtleMustCopyIfIntegral(value_values(i));
+    };
 
-    mutex_lock l(mu_);
     if (clear) {
-      table_.clear();
-    }
-    for (int64_t i = 0; i < key_values.size(); ++i) {
-      gtl::InsertOrUpdate(&table_, SubtleMustCopyIfIntegral(key_values(i)),
-                          SubtleMustCopyIfIntegral(value_values(i)));
+      table_.Assign(keys_span, value);
+    } else {
+      table_.InsertBatch(keys_span, value);
     }
     return absl::OkStatus();
   }
@@ -109,10 +111,8 @@ class MutableHashTableOfScalars final : public LookupInterface {
   Status Remove(OpKernelContext* ctx, const Tensor& keys) override {
     const auto key_values = keys.flat<K>();
 
-    mutex_lock l(mu_);
-    for (int64_t i = 0; i < key_values.size(); ++i) {
-      table_.erase(SubtleMustCopyIfIntegral(key_values(i)));
-    }
+    table_.EraseBatch(
+        absl::MakeConstSpan(key_values.data(), key_values.size()));
     return absl::OkStatus();
   }
 
@@ -122,17 +122,12 @@ class MutableHashTableOfScalars final : public LookupInterface {
   }
 
   Status ExportValues(OpKernelContext* ctx) override {
-    tf_shared_lock l(mu_);
-    int64_t size = table_.size();
-
-    Tensor* keys;
-    Tensor* values;
-    TF_RETURN_IF_ERROR(
-        ctx->allocate_output("keys", TensorShape({size}), &keys));
-    TF_RETURN_IF_ERROR(
-        ctx->allocate_output("values", TensorShape({size}), &values));
-    ExportKeysAndValues(keys, values);
-    return absl::OkStatus();
+    return ExportKeysAndValues(
+        [ctx](int64_t size, Tensor** keys, Tensor** values) {
+          TF_RETURN_IF_ERROR(
+              ctx->allocate_output("keys", TensorShape({size}), keys));
+          return ctx->allocate_output("values", TensorShape({size}), values);
+        });
   }
 
   DataType key_dtype() const override { return DataTypeToEnum<K>::v(); }
@@ -144,25 +139,20 @@ class MutableHashTableOfScalars final : public LookupInterface {
   TensorShape value_shape() const override { return TensorShape(); }
 
   int64_t MemoryUsed() const override {
-    int64_t ret = 0;
-    tf_shared_lock l(mu_);
-    for (unsigned i = 0; i < table_.bucket_count(); ++i) {
-      size_t bucket_size = table_.bucket_size(i);
-      if (bucket_size == 0) {
-        ret++;
-      } else {
-        ret += bucket_size;
-      }
-    }
-    return sizeof(MutableHashTableOfScalars) + ret;
+    return sizeof(MutableHashTableOfScalars) + table_.capacity();
   }
 
   Status AsGraphDef(GraphDefBuilder* builder, Node** out) const override {
-    tf_shared_lock l(mu_);
-    int64_t size = table_.size();
-    Tensor keys(key_dtype(), TensorShape({size}));
-    Tensor values(value_dtype(), TensorShape({size}));
-    ExportKeysAndValues(&keys, &values);
+    Tensor keys;
+    Tensor values;
+    TF_RETURN_IF_ERROR(ExportKeysAndValues(
+        [&](int64_t size, Tensor** keys_ptr, Tensor** values_ptr) {
+          keys = Tensor(key_dtype(), TensorShape({size}));
+          values = Tensor(value_dtype(), TensorShape({size}));
+          *keys_ptr = &keys;
+          *values_ptr = &values;
+          return absl::OkStatus();
+        }));
 
     // We set use_node_name_sharing with a unique node name so that the resource
     // can outlive the MutableHashTableV2 kernel. This means that the lifetime
@@ -195,24 +185,33 @@ class MutableHashTableOfScalars final : public LookupInterface {
   }
 
  private:
-  // Writes all keys and values into `keys` and `values`. `keys` and `values`
-  // must point to tensors of size `table_.size()`.
-  void ExportKeysAndValues(Tensor* keys, Tensor* values) const
-      TF_SHARED_LOCKS_REQUIRED(mu_) {
-    auto keys_data = keys->flat<K>();
-    auto values_data = values->flat<V>();
+  // Writes a snapshot of all keys and values into the tensors returned by
+  // `allocate(size, &keys, &values)`, which must hold `size` elements.
+  template <typename AllocateFn>
+  Status ExportKeysAndValues(AllocateFn allocate) const {
+    K* keys_data = nullptr;
+    V* values_data = nullptr;
     int64_t i = 0;
-    for (auto it = table_.begin(); it != table_.end(); ++it, ++i) {
-      keys_data(i) = it->first;
-      values_data(i) = it->second;
-    }
+    return table_.Snapshot(
+        [&](int64_t size) -> Status {
+          Tensor* keys;
+          Tensor* values;
+          TF_RETURN_IF_ERROR(allocate(size, &keys, &values));
+          keys_data = keys->flat<K>().data();
+          values_data = values->flat<V>().data();
+          return absl::OkStatus();
+        },
+        [&](const K& key, const V& value) {
+          keys_data[i] = key;
+          values_data[i] = value;
+          ++i;
+        });
   }
 
-  mutable mutex mu_;
-  std::unordered_map<K, V> table_ TF_GUARDED_BY(mu_);
+  StripedHashMap<K, V> table_;
 };
 
-// Lookup table that wraps an unordered_map. Behaves identical to
+// Lookup table that wraps a StripedHashMap. Behaves identical to
 // MutableHashTableOfScalars except that each value must be a vector.
 template <class K, class V>
 class MutableHashTableOfTensors final : public LookupInterface {
@@ -226,10 +225,7 @@ class MutableHashTableOfTensors final : public LookupInterface {
                                 value_shape_.DebugString()));
   }
 
-  size_t size() const override {
-    tf_shared_lock l(mu_);
-    return table_.size();
-  }
+  size_t size() const override { return table_.size(); }
 
   Status Find(OpKernelContext* ctx, const Tensor& key, Tensor* value,
               const Tensor& default_value) override {
@@ -242,27 +238,25 @@ class MutableHashTableOfTensors final : public LookupInterface {
     int64_t default_total = default_flat.size();
     bool is_full_size_default = (total == default_total);
 
-    tf_shared_lock l(mu_);
-    for (int64_t i = 0; i < key_values.size(); ++i) {
-      ValueArray* value_vec =
-          gtl::FindOrNull(table_, SubtleMustCopyIfIntegral(key_values(i)));
-      if (value_vec != nullptr) {
-        for (int64_t j = 0; j < value_dim; j++) {
-          value_values(i, j) = value_vec->at(j);
-        }
-      } else {
-        // is_full_size_default is true:
-        //   Each key has an independent default value, key_values(i)
-        //   corresponding uses default_flat(i) as its default value.
-        //
-        // is_full_size_default is false:
-        //   All keys will share the default_flat(0) as default value.
-        for (int64_t j = 0; j < value_dim; j++) {
-          value_values(i, j) =
-              is_full_size_default ? default_flat(i, j) : default_flat(0, j);
-        }
-      }
-    }
+    table_.FindBatch(
+        absl::MakeConstSpan(key_values.data(), key_values.size()),
+        [&](int64_t i, const ValueArray& value_vec) {
+          for (int64_t j = 0; j < value_dim; j++) {
+            value_values(i, j) = value_vec.at(j);
+          }
+        },
+        [&](int64_t i) {
+          // is_full_size_default is true:
+          //   Each key has an independent default value, key_values(i)
+          //   corresponding uses default_flat(i) as its default value.
+          //
+          // is_full_size_default is false:
+          //   All keys will share the default_flat(0) as default value.
+          for (int64_t j = 0; j < value_dim; j++) {
+            value_values(i, j) =
+                is_full_size_default ? default_flat(i, j) : default_flat(0, j);
+          }
+        });
 
     return absl::OkStatus();
   }
@@ -271,19 +265,21 @@ class MutableHashTableOfTensors final : public LookupInterface {
     const auto key_values = keys.flat<K>();
     const auto value_values = values.flat_inner_dims<V, 2>();
     int64_t value_dim = value_shape_.dim_size(0);
-
-    mutex_lock l(mu_);
-    if (clear) {
-      table_.clear();
-    }
-    for (int64_t i = 0; i < key_values.size(); ++i) {
+    const auto keys_span =
+        absl::MakeConstSpan(key_values.data(), key_values.size());
+    auto value = [&](int64_t i) {
       ValueArray value_vec;
       for (int64_t j = 0; j < value_dim; j++) {
         V value = value_values(i, j);
         value_vec.push_back(value);
       }
-      gtl::InsertOrUpdate(&table_, SubtleMustCopyIfIntegral(key_values(i)),
-                          value_vec);
+      return value_vec;
+    };
+
+    if (clear) {
+      table_.Assign(keys_span, value);
+    } else {
+      table_.InsertBatch(keys_span, value);
     }
     return absl::OkStatus();
   }
@@ -296,10 +292,8 @@ class MutableHashTableOfTensors final : public LookupInterface {
   Status Remove(OpKernelContext* ctx, const Tensor& keys) override {
     const auto key_values = keys.flat<K>();
 
-    mutex_lock l(mu_);
-    for (int64_t i = 0; i < key_values.size(); ++i) {
-      table_.erase(SubtleMustCopyIfIntegral(key_values(i)));
-    }
+    table_.EraseBatch(
+        absl::MakeConstSpan(key_values.data(), key_values.size()));
     return absl::OkStatus();
   }
 
@@ -309,18 +303,14 @@ class MutableHashTableOfTensors final : public LookupInterface {
   }
 
   Status ExportValues(OpKernelContext* ctx) override {
-    tf_shared_lock l(mu_);
-    int64_t size = table_.size();
     int64_t value_dim = value_shape_.dim_size(0);
-
-    Tensor* keys;
-    Tensor* values;
-    TF_RETURN_IF_ERROR(
-        ctx->allocate_output("keys", TensorShape({size}), &keys));
-    TF_RETURN_IF_ERROR(ctx->allocate_output(
-        "values", TensorShape({size, value_dim}), &values));
-    ExportKeysAndValues(keys, values);
-    return absl::OkStatus();
+    return ExportKeysAndValues(
+        [ctx, value_dim](int64_t size, Tensor** keys, Tensor** values) {
+          TF_RETURN_IF_ERROR(
+              ctx->allocate_output("keys", TensorShape({size}), keys));
+          return ctx->allocate_output(
+              "values", TensorShape({size, value_dim}), values);
+        });
   }
 
   DataType key_dtype() const override { return DataTypeToEnum<K>::v(); }
@@ -332,25 +322,21 @@ class MutableHashTableOfTensors final : public LookupInterface {
   TensorShape value_shape() const override { return value_shape_; }
 
   int64_t MemoryUsed() const override {
-    int64_t ret = 0;
-    tf_shared_lock l(mu_);
-    for (unsigned i = 0; i < table_.bucket_count(); ++i) {
-      size_t bucket_size = table_.bucket_size(i);
-      if (bucket_size == 0) {
-        ret++;
-      } else {
-        ret += bucket_size;
-      }
-    }
-    return sizeof(MutableHashTableOfTensors) + ret;
+    return sizeof(MutableHashTableOfTensors) + table_.capacity();
   }
 
   Status AsGraphDef(GraphDefBuilder* builder, Node** out) const override {
-    tf_shared_lock l(mu_);
-    int64_t size = table_.size();
-    Tensor keys(key_dtype(), TensorShape({size}));
-    Tensor values(value_dtype(), TensorShape({size, value_shape_.dim_size(0)}));
-    ExportKeysAndValues(&keys, &values);
+    Tensor keys;
+    Tensor values;
+    TF_RETURN_IF_ERROR(ExportKeysAndValues(
+        [&](int64_t size, Tensor** keys_ptr, Tensor** values_ptr) {
+          keys = Tensor(key_dtype(), TensorShape({size}));
+          values = Tensor(value_dtype(),
+                          TensorShape({size, value_shape_.dim_size(0)}));
+          *keys_ptr = &keys;
+          *values_ptr = &values;
+          return absl::OkStatus();
+        }));
 
     // We set use_node_name_sharing with a unique node name so that the resource
     // can outlive the MutableHashTableOfTensorsV2 kernel. This means that the
@@ -384,28 +370,37 @@ class MutableHashTableOfTensors final : public LookupInterface {
   }
 
  private:
-  // Writes all keys and values into `keys` and `values`. `keys` and `values`
-  // must point to tensors of size `table_.size()`.
-  void ExportKeysAndValues(Tensor* keys, Tensor* values) const
-      TF_SHARED_LOCKS_REQUIRED(mu_) {
+  typedef gtl::InlinedVector<V, 4> ValueArray;
+
+  // Writes a snapshot of all keys and values into the tensors returned by
+  // `allocate(size, &keys, &values)`, which must hold `size` keys and
+  // `size` value vectors.
+  template <typename AllocateFn>
+  Status ExportKeysAndValues(AllocateFn allocate) const {
     int64_t value_dim = value_shape_.dim_size(0);
-    auto keys_data = keys->flat<K>();
-    auto values_data = values->matrix<V>();
+    K* keys_data = nullptr;
+    V* values_data = nullptr;
     int64_t i = 0;
-    for (auto it = table_.begin(); it != table_.end(); ++it, ++i) {
-      K key = it->first;
-      ValueArray value = it->second;
-      keys_data(i) = key;
-      for (int64_t j = 0; j < value_dim; j++) {
-        values_data(i, j) = value[j];
-      }
-    }
+    return table_.Snapshot(
+        [&](int64_t size) -> Status {
+          Tensor* keys;
+          Tensor* values;
+          TF_RETURN_IF_ERROR(allocate(size, &keys, &values));
+          keys_data = keys->flat<K>().data();
+          values_data = values->flat<V>().data();
+          return absl::OkStatus();
+        },
+        [&](const K& key, const ValueArray& value) {
+          keys_data[i] = key;
+          for (int64_t j = 0; j < value_dim; j++) {
+            values_data[i * value_dim + j] = value[j];
+          }
+          ++i;
+        });
   }
 
   TensorShape value_shape_;
-  mutable mutex mu_;
-  typedef gtl::InlinedVector<V, 4> ValueArray;
-  std::unordered_map<K, ValueArray> table_ TF_GUARDED_BY(mu_);
+  StripedHashMap<K, ValueArray> table_;
 };
 
 namespace {
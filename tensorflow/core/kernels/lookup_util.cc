@@ -15,7 +15,13 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/lookup_util.h"
 
+#include <algorithm>
+#include <memory>
+#include <vector>
+
 #include "absl/status/status.h"
+#include "absl/strings/str_split.h"
+#include "absl/strings/string_view.h"
 #include "tensorflow/core/framework/function_handle_cache.h"
 #include "tensorflow/core/framework/lookup_interface.h"
 #include "tensorflow/core/framework/op_requires.h"
@@ -36,6 +42,8 @@ using InitializerSerializer =
 static const int kInputBufferSize = 1 * 1024 * 1024; /* bytes */
 static const int kLineNumber = -1;
 static const int kWholeLine = -2;
+// The number of lines of a text file inserted at a time into a table.
+static const int kLinesPerBatch = 1024;
 
 Status GetNumLinesInTextFile(Env* env, const string& vocab_file,
                              int64_t* num_lines) {
@@ -57,9 +65,10 @@ Status GetNumLinesInTextFile(Env* env, const string& vocab_file,
   return absl::OkStatus();
 }
 
-// Iterator that reads a text file. Each iteration process one line, it parses
-// the line and populates the keys and values tensors used for initialization
-// with a single key and corresponding value.
+// Iterator that reads a text file. Each iteration processes a batch of up to
+// `kLinesPerBatch` lines, it parses the lines and populates the keys and values
+// tensors used for initialization with a key and corresponding value per line.
+// The table then inserts a whole batch at a time.
 //
 // What information of the line to populate the key or values is specified by
 // providing key_index and value_index.
@@ -87,8 +96,8 @@ class TextFileLineIterator
     filename_ = filename;
     vocab_size_ = vocab_size;
     delimiter_ = delimiter;
-    key_ = Tensor(key_dtype, TensorShape({}));
-    value_ = Tensor(value_dtype, TensorShape({}));
+    key_dtype_ = key_dtype;
+    value_dtype_ = value_dtype;
     key_index_ = key_index;
     value_index_ = value_index;
     env_ = env;
@@ -107,63 +116,33 @@ class TextFileLineIterator
 
   void Next() override {
     if (!valid_) return;
-
-    string line;
-    status_ = input_buffer_->ReadLine(&line);
-    if (!status_.ok()) {
-      if (absl::IsOutOfRange(status_) && vocab_size_ != -1 &&
-          next_id_ != vocab_size_) {
-        status_ = errors::InvalidArgument("Invalid vocab_size in ", filename_,
-                                          ": expected ", vocab_size_,
-                                          " but got ", next_id_);
-      }
-      valid_ = false;
-      return;
-    }
-    if (vocab_size_ != -1 && next_id_ >= vocab_size_) {
-      LOG(WARNING) << "Truncated " << filename_ << " before its end at "
-                   << vocab_size_ << " records.";
-      LOG(WARNING) << "next_id_  : " << next_id_;
-      status_ = errors::OutOfRange("Finished reading ", vocab_size_,
-                                   " of lines from ", filename_);
-      valid_ = false;
-      return;
-    }
-    if (line.empty()) {
-      status_ = errors::InvalidArgument("Invalid content in ", filename_,
-                                        ": empty line found at position ",
-                                        input_buffer_->Tell(), ".");
+    // The status of the line that ended the previous batch early is reported
+    // once the lines before it have been consumed.
+    if (!pending_status_.ok()) {
+      status_ = pending_status_;
       valid_ = false;
       return;
     }
 
-    std::vector<string> tokens;
-    if (!ignore_split_) {
-      tokens = str_util::Split(line, delimiter_);
-      const auto expected_size =
-          static_cast<size_t>(std::max(key_index_, value_index_) + 1);
-      if (tokens.size() < expected_size) {
-        status_ = errors::InvalidArgument(
-            "Invalid number of columns in ", filename_, " line ", next_id_,
-            " (", line, ") : expected at least ", expected_size, " got ",
-            tokens.size());
-        valid_ = false;
-        return;
-      }
+    key_ = Tensor(key_dtype_, TensorShape({kLinesPerBatch}));
+    value_ = Tensor(value_dtype_, TensorShape({kLinesPerBatch}));
+    int64_t num_lines = 0;
+    Status status;
+    while (num_lines < kLinesPerBatch && status.ok()) {
+      status = ReadLine(num_lines);
+      if (status.ok()) ++num_lines;
     }
-
-    status_ = SetValue(line, tokens, key_index_, &key_);
-    if (!status_.ok()) {
+    if (num_lines == 0) {
+      status_ = status;
       valid_ = false;
       return;
     }
-    status_ = SetValue(line, tokens, value_index_, &value_);
-    if (!status_.ok()) {
-      valid_ = false;
-      return;
+    if (num_lines < kLinesPerBatch) {
+      key_ = key_.Slice(0, num_lines);
+      value_ = value_.Slice(0, num_lines);
     }
-
-    next_id_++;
+    status_ = absl::OkStatus();
+    pending_status_ = status;
   }
 
   bool Valid() const override { return valid_; }
@@ -188,80 +167,128 @@ class TextFileLineIterator
   }
 
  private:
-  Tensor key_;
-  Tensor value_;
-  bool valid_;  // true if the iterator points to an existing range.
-  int64_t key_index_;
-  int64_t value_index_;
-  Env* env_;
-  int64_t next_id_;
-  int64_t offset_;
-  int64_t vocab_size_;
-  string filename_;
-  char delimiter_;
-  Status status_;
-  bool ignore_split_;
-  std::unique_ptr<RandomAccessFile> file_;  // must outlive input_buffer_
-  std::unique_ptr<io::InputBuffer> input_buffer_;
+  // Reads the next line and stores its key and value in the row `row` of the
+  // keys and values tensors.
+  Status ReadLine(int64_t row) {
+    Status status = input_buffer_->ReadLine(&line_);
+    if (!status.ok()) {
+      if (absl::IsOutOfRange(status) && vocab_size_ != -1 &&
+          next_id_ != vocab_size_) {
+        return errors::InvalidArgument("Invalid vocab_size in ", filename_,
+                                       ": expected ", vocab_size_,
+                                       " but got ", next_id_);
+      }
+      return status;
+    }
+    if (vocab_size_ != -1 && next_id_ >= vocab_size_) {
+      LOG(WARNING) << "Truncated " << filename_ << " before its end at "
+                   << vocab_size_ << " records.";
+      LOG(WARNING) << "next_id_  : " << next_id_;
+      return errors::OutOfRange("Finished reading ", vocab_size_,
+                                " of lines from ", filename_);
+    }
+    if (line_.empty()) {
+      return errors::InvalidArgument("Invalid content in ", filename_,
+                                     ": empty line found at position ",
+                                     input_buffer_->Tell(), ".");
+    }
+
+    if (!ignore_split_) {
+      tokens_ = absl::StrSplit(line_, delimiter_);
+      const auto expected_size =
+          static_cast<size_t>(std::max(key_index_, value_index_) + 1);
+      if (tokens_.size() < expected_size) {
+        return errors::InvalidArgument(
+            "Invalid number of columns in ", filename_, " line ", next_id_,
+            " (", line_, ") : expected at least ", expected_size, " got ",
+            tokens_.size());
+      }
+    }
+
+    TF_RETURN_IF_ERROR(SetValue(key_index_, row, &key_));
+    TF_RETURN_IF_ERROR(SetValue(value_index_, row, &value_));
+    next_id_++;
+    return absl::OkStatus();
+  }
 
   // Set the corresponding value from line or tokens based on 'index' into the
-  // tensor 't'. The value is transformed to the given data type 'dtype'.
-  Status SetValue(const string& line, const std::vector<string>& tokens,
-                  int64_t index, Tensor* tensor) {
+  // row 'row' of the tensor 't'. The value is transformed to the given data
+  // type 'dtype'.
+  Status SetValue(int64_t index, int64_t row, Tensor* tensor) {
     if (index == kLineNumber) {
-      tensor->flat<int64_t>()(0) = next_id_ + offset_;
+      tensor->flat<int64_t>()(row) = next_id_ + offset_;
       return absl::OkStatus();
     }
-    const string& token = (index == kWholeLine) ? line : tokens[index];
+    const absl::string_view token =
+        (index == kWholeLine) ? absl::string_view(line_) : tokens_[index];
     const DataType& dtype = tensor->dtype();
     switch (dtype) {
       case DT_INT32: {
         int32_t value;
-        if (!strings::safe_strto32(token.c_str(), &value)) {
-          valid_ = false;
+        if (!strings::safe_strto32(token, &value)) {
           return errors::InvalidArgument("Field ", token, " in line ", next_id_,
                                          " is not a valid int32.");
         }
-        tensor->flat<int32>()(0) = value + offset_;
+        tensor->flat<int32>()(row) = value + offset_;
       } break;
       case DT_INT64: {
         int64_t value;
-        if (!strings::safe_strto64(token.c_str(), &value)) {
-          valid_ = false;
+        if (!strings::safe_strto64(token, &value)) {
           return errors::InvalidArgument("Field ", token, " in line ", next_id_,
                                          " is not a valid int64.");
         }
-        tensor->flat<int64_t>()(0) = value;
+        tensor->flat<int64_t>()(row) = value;
       } break;
       case DT_FLOAT: {
         float value;
-        if (!strings::safe_strtof(token.c_str(), &value)) {
-          valid_ = false;
+        if (!strings::safe_strtof(token, &value)) {
           return errors::InvalidArgument("Field ", token, " in line ", next_id_,
                                          " is not a valid float.");
         }
-        tensor->flat<float>()(0) = value;
+        tensor->flat<float>()(row) = value;
       } break;
       case DT_DOUBLE: {
         double value;
-        if (!strings::safe_strtod(token.c_str(), &value)) {
-          valid_ = false;
+        if (!strings::safe_strtod(token, &value)) {
           return errors::InvalidArgument("Field ", token, " in line ", next_id_,
                                          " is not a valid double.");
         }
-        tensor->flat<double>()(0) = value;
+        tensor->flat<double>()(row) = value;
       } break;
       case DT_STRING:
-        tensor->flat<tstring>()(0) = token;
+        tensor->flat<tstring>()(row) = token;
         break;
       default:
-        valid_ = false;
         return errors::InvalidArgument("Data type ", DataTypeString(dtype),
                                        " not supported.");
     }
     return absl::OkStatus();
   }
 
+  Tensor key_;
+  Tensor value_;
+  bool valid_;  // true if the iterator points to an existing range.
+  DataType key_dtype_;
+  DataType value_dtype_;
+  int64_t key_index_;
+  int64_t value_index_;
+  Env* env_;
+  int64_t next_id_;
+  int64_t offset_;
+  int64_t vocab_size_;
+  string filename_;
+  char delimiter_;
+  Status status_;
+  // The status of the line that ended the current batch early, if any.
+  Status pending_status_;
+  bool ignore_split_;
+  // The current line and its tokens, kept across the lines to reuse their
+  // storage.
+  string line_;
+  std::vector<absl::string_view> tokens_;
+  std::unique_ptr<RandomAccessFile> file_;  // must outlive input_buffer_
+  std::unique_ptr<io::InputBuffer> input_buffer_;
+
   TextFileLineIterator(const TextFileLineIterator&) = delete;
   void operator=(const TextFileLineIterator&) = delete;
 };
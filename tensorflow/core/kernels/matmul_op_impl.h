@@ -256,6 +256,105 @@ struct SequentialMatMulKernel {
   }
 };
 
+// Batch matmul kernel for small matrices, such as those of attention heads,
+// for which the blocking and packing of the general matmul cost more than the
+// products. It has microkernels specialized for the size of the rows of y
+// (when y is not transposed) or of the rows of both x and y (when y is
+// transposed), so that these rows are held in fixed-size vectors. Only x that
+// is not transposed is supported.
+template <typename Scalar>
+struct SmallMatMulKernel {
+  // The larger dimensions of x and z are limited to this.
+  static constexpr int64_t kMaxDim = 64;
+
+  // Computes the (m, n) matrix z = x * y for the (m, k) matrix x, with the
+  // (k, n) matrix y if transpose_y is false, or the (n, k) one otherwise.
+  using Fn = void (*)(const Scalar* x, const Scalar* y, Scalar* z, int64_t m,
+                      int64_t k, int64_t n);
+
+  template <int N>
+  static void MatMul(const Scalar* x, const Scalar* y, Scalar* z, int64_t m,
+                     int64_t k, int64_t n) {
+    using Row = Eigen::Matrix<Scalar, 1, N>;
+    for (int64_t i = 0; i < m; ++i) {
+      Row z_row = Row::Zero();
+      for (int64_t p = 0; p < k; ++p) {
+        z_row.noalias() += x[i * k + p] * Eigen::Map<const Row>(y + p * N);
+      }
+      Eigen::Map<Row>(z + i * N) = z_row;
+    }
+  }
+
+  template <int K>
+  static void MatMulTransposeY(const Scalar* x, const Scalar* y, Scalar* z,
+                               int64_t m, int64_t k, int64_t n) {
+    using Row = Eigen::Matrix<Scalar, 1, K>;
+    for (int64_t i = 0; i < m; ++i) {
+      const Eigen::Map<const Row> x_row(x + i * K);
+      for (int64_t j = 0; j < n; ++j) {
+        z[i * n + j] = x_row.dot(Eigen::Map<const Row>(y + j * K));
+      }
+    }
+  }
+
+  // Returns the microkernel for the given shapes, or nullptr if there is none.
+  static Fn GetKernel(int64_t m, int64_t k, int64_t n, bool transpose_y) {
+    if (!std::is_same<Scalar, float>::value &&
+        !std::is_same<Scalar, double>::value) {
+      return nullptr;
+    }
+    if (m > kMaxDim) return nullptr;
+    if (transpose_y) {
+      if (n > kMaxDim) return nullptr;
+      switch (k) {
+        case 8:
+          return &MatMulTransposeY<8>;
+        case 16:
+          return &MatMulTransposeY<16>;
+        case 32:
+          return &MatMulTransposeY<32>;
+        case 64:
+          return &MatMulTransposeY<64>;
+        default:
+          return nullptr;
+      }
+    }
+    if (k > kMaxDim) return nullptr;
+    switch (n) {
+      case 8:
+        return &MatMul<8>;
+      case 16:
+        return &MatMul<16>;
+      case 32:
+        return &MatMul<32>;
+      case 64:
+        return &MatMul<64>;
+      default:
+        return nullptr;
+    }
+  }
+
+  static void Run(Fn kernel, const Tensor& in_x, const Tensor& in_y,
+                  const MatMulBCast& bcast, Tensor* out, int64_t start,
+                  int64_t limit) {
+    const bool should_bcast = bcast.IsBroadcastingRequired();
+    const auto& x_batch_indices = bcast.x_batch_indices();
+    const auto& y_batch_indices = bcast.y_batch_indices();
+    const int64_t m = out->dim_size(1);
+    const int64_t n = out->dim_size(2);
+    const int64_t k = in_x.dim_size(2);
+    const Scalar* x_data = in_x.flat<Scalar>().data();
+    const Scalar* y_data = in_y.flat<Scalar>().data();
+    Scalar* z_data = out->flat<Scalar>().data();
+    for (int64_t i = start; i < limit; ++i) {
+      const int64_t x_batch_index = should_bcast ? x_batch_indices[i] : i;
+      const int64_t y_batch_index = should_bcast ? y_batch_indices[i] : i;
+      kernel(x_data + x_batch_index * m * k, y_data + y_batch_index * k * n,
+             z_data + i * m * n, m, k, n);
+    }
+  }
+};
+
 // For single-batch multiplications, manually parallize by splitting the output
 // matrix.
 template <typename Scalar>
@@ -430,9 +529,25 @@ struct LaunchBatchMatMul<CPUDevice, Scalar> {
     // Jan 21, 2020.
     const int64_t kMaxCostOuterParallelism = 128 * 128;  // heuristic.
     auto worker_threads = *(context->device()->tensorflow_cpu_worker_threads());
+    typename SmallMatMulKernel<Scalar>::Fn small_kernel = nullptr;
+    if (batch_size > 1 && !adj_x && !trans_x) {
+      small_kernel = SmallMatMulKernel<Scalar>::GetKernel(
+          out->dim_size(1), in_x.dim_size(2), out->dim_size(2),
+          adj_y || trans_y);
+    }
     // TODO(rmlarsen): Reconsider the heuristics now that we have asynchronous
     // evaluation in Eigen Tensor.
-    if (small_dim > 1 &&
+    if (small_kernel != nullptr) {
+      // Parallelize over outer dims, with a microkernel for each of the small
+      // matrix multiplies.
+      Shard(worker_threads.num_threads, worker_threads.workers, batch_size,
+            cost_per_unit,
+            [small_kernel, &in_x, &in_y, &bcast, out](int64_t start,
+                                                      int64_t limit) {
+              SmallMatMulKernel<Scalar>::Run(small_kernel, in_x, in_y, bcast,
+                                             out, start, limit);
+            });
+    } else if (small_dim > 1 &&
         (batch_size == 1 || cost_per_unit > kMaxCostOuterParallelism)) {
       // Parallelize over inner dims.
       // For large matrix products it is counter-productive to parallelize
@@ -775,5 +775,20 @@ BM_BatchMatmul(1, 1, 200, 10000, true, true);
 BM_BatchMatmul(8, 1, 200, 10000, true, true);
 BM_BatchMatmul(32, 1, 200, 10000, true, true);
 
+// Attention heads: the scores of the queries and the keys, and their products
+// with the values, for sequence lengths of 16-64 and head sizes of 32-64.
+BM_BatchMatmul(64, 16, 32, 16, false, true);
+BM_BatchMatmul(64, 16, 16, 32, false, false);
+BM_BatchMatmul(64, 16, 64, 16, false, true);
+BM_BatchMatmul(64, 16, 16, 64, false, false);
+BM_BatchMatmul(64, 32, 32, 32, false, true);
+BM_BatchMatmul(64, 32, 32, 32, false, false);
+BM_BatchMatmul(64, 32, 64, 32, false, true);
+BM_BatchMatmul(64, 32, 32, 64, false, false);
+BM_BatchMatmul(64, 64, 32, 64, false, true);
+BM_BatchMatmul(64, 64, 64, 32, false, false);
+BM_BatchMatmul(64, 64, 64, 64, false, true);
+BM_BatchMatmul(64, 64, 64, 64, false, false);
+
 }  // namespace
 }  // namespace tensorflow
@@ -28,6 +28,7 @@ limitations under the License.
 #include "tensorflow/core/kernels/reference_gemm.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/mutex.h"
 
 namespace tensorflow {
 
@@ -213,4 +214,143 @@ REGISTER_KERNEL_BUILDER(Name("QuantizedMatMul")
                             .TypeConstraint<qint32>("Toutput"),
                         QuantizedMatMulOp<quint8, quint8, qint32>);
 
+// Multiplies float matrices with eight-bit arithmetic. The weights in `b` are
+// quantized on the first run and kept, since Grappler only creates this op
+// for constant weights. The activations in `a` are quantized on each run over
+// their own range, and the 32-bit products are converted back to float.
+class DynamicQuantizedMatMulOp : public OpKernel {
+ public:
+  explicit DynamicQuantizedMatMulOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    OP_REQUIRES_OK(context, context->GetAttr("transpose_a", &transpose_a_));
+    OP_REQUIRES_OK(context, context->GetAttr("transpose_b", &transpose_b_));
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& a = context->input(0);
+    const Tensor& b = context->input(1);
+    OP_REQUIRES(context, TensorShapeUtils::IsMatrix(a.shape()),
+                errors::InvalidArgument("In[0] is not a matrix"));
+    OP_REQUIRES(context, TensorShapeUtils::IsMatrix(b.shape()),
+                errors::InvalidArgument("In[1] is not a matrix"));
+    const int a_dim_inner = transpose_a_ ? 0 : 1;
+    const int b_dim_inner = transpose_b_ ? 1 : 0;
+    OP_REQUIRES(context, a.dim_size(a_dim_inner) == b.dim_size(b_dim_inner),
+                errors::InvalidArgument("Matrix size-incompatible: In[0]: ",
+                                        a.shape().DebugString(),
+                                        ", In[1]: ", b.shape().DebugString()));
+
+    const int64_t m = a.dim_size(1 - a_dim_inner);
+    const int64_t n = b.dim_size(1 - b_dim_inner);
+    const int64_t k = a.dim_size(a_dim_inner);
+    Tensor* c = nullptr;
+    OP_REQUIRES_OK(context, context->allocate_output(0, {m, n}, &c));
+    if (c->NumElements() == 0) return;
+    if (k == 0) {
+      c->flat<float>().setZero();
+      return;
+    }
+
+    const Eigen::ThreadPoolDevice& device =
+        context->eigen_device<Eigen::ThreadPoolDevice>();
+    Tensor quantized_b;
+    float min_b;
+    float max_b;
+    {
+      mutex_lock l(mu_);
+      if (!quantized_b_.IsInitialized()) {
+        OP_REQUIRES_OK(context,
+                       Quantize(context, b, &quantized_b_, &min_b_, &max_b_));
+      }
+      quantized_b = quantized_b_;
+      min_b = min_b_;
+      max_b = max_b_;
+    }
+    OP_REQUIRES(context, quantized_b.shape() == b.shape(),
+                errors::InvalidArgument(
+                    "The shape of the weights changed from ",
+                    quantized_b.shape().DebugString(), " to ",
+                    b.shape().DebugString()));
+
+    Tensor quantized_a;
+    float min_a;
+    float max_a;
+    OP_REQUIRES_OK(context, Quantize(context, a, &quantized_a, &min_a, &max_a));
+
+    Tensor quantized_c;
+    OP_REQUIRES_OK(context,
+                   context->allocate_temp(DT_QINT32, {m, n}, &quantized_c));
+    const quint8* a_data = quantized_a.flat<quint8>().data();
+    const quint8* b_data = quantized_b.flat<quint8>().data();
+    qint32* c_data = quantized_c.flat<qint32>().data();
+    const int32_t offset_a =
+        FloatToQuantizedUnclamped<quint8>(0.0f, min_a, max_a);
+    const int32_t offset_b =
+        FloatToQuantizedUnclamped<quint8>(0.0f, min_b, max_b);
+    const int lda = a.dim_size(1);
+    const int ldb = b.dim_size(1);
+    const int ldc = n;
+    if (transpose_a_) {
+      if (transpose_b_) {
+        GemmlowpMultiply<true, true, false>(context, a_data, b_data, c_data, m,
+                                            n, k, offset_a, offset_b, lda, ldb,
+                                            ldc);
+      } else {
+        GemmlowpMultiply<true, false, false>(context, a_data, b_data, c_data,
+                                             m, n, k, offset_a, offset_b, lda,
+                                             ldb, ldc);
+      }
+    } else {
+      if (transpose_b_) {
+        GemmlowpMultiply<false, true, false>(context, a_data, b_data, c_data,
+                                             m, n, k, offset_a, offset_b, lda,
+                                             ldb, ldc);
+      } else {
+        GemmlowpMultiply<false, false, false>(context, a_data, b_data, c_data,
+                                              m, n, k, offset_a, offset_b, lda,
+                                              ldb, ldc);
+      }
+    }
+
+    // The products of the offset values are in units of the product of the
+    // quantization levels of a and b.
+    const float scale_c = FloatForOneQuantizedLevel<quint8>(min_a, max_a) *
+                          FloatForOneQuantizedLevel<quint8>(min_b, max_b);
+    c->flat<float>().device(device) =
+        quantized_c.flat<qint32>().cast<int32>().cast<float>() * scale_c;
+  }
+
+ private:
+  // Quantizes `input` to eight bits over its range, extended to include 0 so
+  // that it is exactly represented.
+  static Status Quantize(OpKernelContext* context, const Tensor& input,
+                         Tensor* output, float* min, float* max) {
+    const Eigen::ThreadPoolDevice& device =
+        context->eigen_device<Eigen::ThreadPoolDevice>();
+    Eigen::Tensor<float, 0, Eigen::RowMajor> input_min;
+    Eigen::Tensor<float, 0, Eigen::RowMajor> input_max;
+    input_min.device(device) = input.flat<float>().minimum();
+    input_max.device(device) = input.flat<float>().maximum();
+    *min = std::min(input_min(), 0.0f);
+    *max = std::max(input_max(), 0.0f);
+    if (*max == *min) *max = *min + 1.0f;
+    TF_RETURN_IF_ERROR(
+        context->allocate_temp(DT_QUINT8, input.shape(), output));
+    FloatTensorToQuantizedInPlaceUsingEigen<quint8>(device, input, *min, *max,
+                                                    output);
+    return OkStatus();
+  }
+
+  bool transpose_a_;
+  bool transpose_b_;
+
+  mutex mu_;
+  Tensor quantized_b_ TF_GUARDED_BY(mu_);
+  float min_b_ TF_GUARDED_BY(mu_) = 0.0f;
+  float max_b_ TF_GUARDED_BY(mu_) = 0.0f;
+};
+
+REGISTER_KERNEL_BUILDER(Name("_DynamicQuantizedMatMul").Device(DEVICE_CPU),
+                        DynamicQuantizedMatMulOp);
+
 }  // namespace tensorflow
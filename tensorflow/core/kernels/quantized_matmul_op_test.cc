@@ -393,4 +393,59 @@ TEST_F(QuantizedMatMulTest, Medium_WithParams) {
   test::ExpectTensorNear<float>(expected_float, output_float, 15.0);
 }
 
+class DynamicQuantizedMatMulTest : public OpsTestBase {
+ protected:
+  void RunTest(bool transpose_b) {
+    TF_ASSERT_OK(NodeDefBuilder("dynamic_quantized_mat_mul_op",
+                                "_DynamicQuantizedMatMul")
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Attr("transpose_b", transpose_b)
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+    // A matrix is:
+    // |  1 | -2 |  3 |
+    // |  4 |  5 | -6 |
+    AddInputFromArray<float>(TensorShape({2, 3}), {1, -2, 3, 4, 5, -6});
+    // B matrix is:
+    // |  0.5 | -0.25 |  1.0 |  0.0  |
+    // | -1.0 |  0.75 |  0.5 | -0.5  |
+    // |  0.25|  0.0  | -0.75|  1.0  |
+    if (transpose_b) {
+      AddInputFromArray<float>(TensorShape({4, 3}),
+                               {0.5, -1.0, 0.25, -0.25, 0.75, 0.0, 1.0, 0.5,
+                                -0.75, 0.0, -0.5, 1.0});
+    } else {
+      AddInputFromArray<float>(TensorShape({3, 4}),
+                               {0.5, -0.25, 1.0, 0.0, -1.0, 0.75, 0.5, -0.5,
+                                0.25, 0.0, -0.75, 1.0});
+    }
+    TF_ASSERT_OK(RunOpKernel());
+
+    // (1 * 0.5) + (-2 * -1.0) + (3 * 0.25) = 3.25
+    // (1 * -0.25) + (-2 * 0.75) + (3 * 0.0) = -1.75
+    // (1 * 1.0) + (-2 * 0.5) + (3 * -0.75) = -2.25
+    // (1 * 0.0) + (-2 * -0.5) + (3 * 1.0) = 4.0
+    // (4 * 0.5) + (5 * -1.0) + (-6 * 0.25) = -4.5
+    // (4 * -0.25) + (5 * 0.75) + (-6 * 0.0) = 2.75
+    // (4 * 1.0) + (5 * 0.5) + (-6 * -0.75) = 11.0
+    // (4 * 0.0) + (5 * -0.5) + (-6 * 1.0) = -8.5
+    Tensor expected(DT_FLOAT, TensorShape({2, 4}));
+    test::FillValues<float>(&expected,
+                            {3.25, -1.75, -2.25, 4.0, -4.5, 2.75, 11.0, -8.5});
+    // The error is about a quantization level of each input per product.
+    test::ExpectTensorNear<float>(expected, *GetOutput(0), 0.2);
+
+    // The weights quantized by the first run are reused.
+    TF_ASSERT_OK(RunOpKernel());
+    test::ExpectTensorNear<float>(expected, *GetOutput(0), 0.2);
+  }
+};
+
+TEST_F(DynamicQuantizedMatMulTest, Small) { RunTest(/*transpose_b=*/false); }
+
+TEST_F(DynamicQuantizedMatMulTest, Small_TransposeB) {
+  RunTest(/*transpose_b=*/true);
+}
+
 }  // namespace tensorflow
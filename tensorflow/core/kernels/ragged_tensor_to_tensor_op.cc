@@ -40,6 +40,7 @@ limitations under the License.
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/util/bcast.h"
 #include "tensorflow/core/util/ragged_to_dense_util.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 
@@ -117,6 +118,22 @@ class RaggedTensorToTensorBaseOp : public OpKernel {
     return max_width;
   }
 
+  // Returns whether `row_split` starts at 0, is sorted and doesn't point past
+  // the `num_values` values, so that each row can be copied directly from
+  // the values.
+  static bool IsValidRowSplit(const RowPartitionTensor& row_split,
+                              INDEX_TYPE num_values) {
+    const INDEX_TYPE tensor_length = row_split.size();
+    if (tensor_length == 0 || row_split(0) != 0 ||
+        row_split(tensor_length - 1) > num_values) {
+      return false;
+    }
+    for (INDEX_TYPE i = 0; i < tensor_length - 1; ++i) {
+      if (row_split(i + 1) < row_split(i)) return false;
+    }
+    return true;
+  }
+
   static INDEX_TYPE GetMaxWidthValueRowID(
       const RowPartitionTensor& value_rowids) {
     const INDEX_TYPE index_length = value_rowids.size();
@@ -399,6 +416,17 @@ class RaggedTensorToTensorBaseOp : public OpKernel {
     if (full_size > 0) {
       vector<INDEX_TYPE> output_index, new_output_index;
       int nvals = context->input(kValueInputIndex).shape().dim_size(0);
+      // The common case of a single ROW_SPLITS partition is copied row by
+      // row, without computing the output index of every value.
+      if (ragged_rank_ == 1 &&
+          GetRowPartitionTypeByDimension(0) == RowPartitionType::ROW_SPLITS) {
+        const RowPartitionTensor row_split = GetRowPartitionTensor(context, 0);
+        if (row_split.size() - 1 <= first_dimension &&
+            IsValidRowSplit(row_split, nvals)) {
+          SetOutputFromRowSplit(context, row_split, output_tensor);
+          return;
+        }
+      }
       output_index.reserve(nvals);
       new_output_index.reserve(nvals);
 
@@ -418,6 +446,11 @@ class RaggedTensorToTensorBaseOp : public OpKernel {
   virtual void SetOutput(OpKernelContext* context, int ragged_rank,
                          const vector<INDEX_TYPE>& output_index,
                          Tensor* output_tensor) = 0;
+  // Sets the output of a ragged tensor whose only partition is `row_split`,
+  // a valid row split with at most as many rows as the first dimension.
+  virtual void SetOutputFromRowSplit(OpKernelContext* context,
+                                     const RowPartitionTensor& row_split,
+                                     Tensor* output_tensor) = 0;
 
  private:
   vector<RowPartitionType> row_partition_types_;
@@ -466,6 +499,9 @@ void copy_array<Eigen::half, int32>(Eigen::half* dst, const Eigen::half* src,
 template <typename VALUE_TYPE, typename INDEX_TYPE>
 class RaggedTensorToTensorOp : public RaggedTensorToTensorBaseOp<INDEX_TYPE> {
  public:
+  typedef typename RaggedTensorToTensorBaseOp<INDEX_TYPE>::RowPartitionTensor
+      RowPartitionTensor;
+
   explicit RaggedTensorToTensorOp(OpKernelConstruction* context)
       : RaggedTensorToTensorBaseOp<INDEX_TYPE>(context) {}
 
@@ -488,30 +524,11 @@ class RaggedTensorToTensorOp : public RaggedTensorToTensorBaseOp<INDEX_TYPE> {
     int value_element_size = element_shape.num_elements();
     size_t output_index_size = output_index.size();
 
-    // Broadcast the default value to value_element_size.  (We can skip this
-    // if default_value_tensor.NumElements() == 1, since we use std::fill
-    // when that's true.)
-    const VALUE_TYPE* default_value =
-        default_value_tensor.flat<VALUE_TYPE>().data();
+    const VALUE_TYPE* default_value;
     Tensor bcast_default;  // Temporary tensor for result of broadcast
-    if (default_value_tensor.NumElements() != value_element_size &&
-        default_value_tensor.NumElements() != 1) {
-      const auto& src_shape = default_value_tensor.shape();
-      BCast bcast(BCast::FromShape(src_shape), BCast::FromShape(element_shape),
-                  /*fewer_dims_optimization=*/true);
-      // Note: bcast should always be valid, since we rejected any incompatible
-      // shapes when we called ValidateDefaultValueShape().
-      OP_REQUIRES(context, bcast.IsValid(),
-                  errors::InvalidArgument("Error broadcasting default_value"));
-      OP_REQUIRES_OK(context,
-                     context->allocate_temp(default_value_tensor.dtype(),
-                                            element_shape, &bcast_default));
-      const CPUDevice& device = context->eigen_device<CPUDevice>();
-      functor::BroadcastTo<CPUDevice, VALUE_TYPE>()(
-          device, context, bcast_default, element_shape, default_value_tensor,
-          src_shape, bcast);
-      default_value = bcast_default.flat<VALUE_TYPE>().data();
-    }
+    OP_REQUIRES_OK(context, BroadcastDefaultValue(context, element_shape,
+                                                  &bcast_default,
+                                                  &default_value));
 
     // Loop through the output_index vector, finding contiguous regions that
     // should be copied.  Once we find the end of a contiguous region, copy it
@@ -576,6 +593,95 @@ class RaggedTensorToTensorOp : public RaggedTensorToTensorBaseOp<INDEX_TYPE> {
       }
     }
   }
+
+  void SetOutputFromRowSplit(OpKernelContext* context,
+                             const RowPartitionTensor& row_split,
+                             Tensor* output_tensor) override {
+    if (output_tensor->NumElements() == 0) return;
+
+    const auto& values_tensor = context->input(kValueInputIndex);
+    const VALUE_TYPE* values_base = values_tensor.flat<VALUE_TYPE>().data();
+    const auto& default_value_tensor = context->input(kDefaultValueInputIndex);
+    VALUE_TYPE* output_base = output_tensor->flat<VALUE_TYPE>().data();
+
+    TensorShape element_shape = output_tensor->shape();
+    element_shape.RemoveDimRange(0, 2);
+    const int64_t value_element_size = element_shape.num_elements();
+
+    const VALUE_TYPE* default_value;
+    Tensor bcast_default;  // Temporary tensor for result of broadcast
+    OP_REQUIRES_OK(context, BroadcastDefaultValue(context, element_shape,
+                                                  &bcast_default,
+                                                  &default_value));
+    const bool scalar_default = default_value_tensor.NumElements() == 1;
+
+    // Each output row holds the first values of the corresponding row of the
+    // ragged tensor, and default values after them, so the rows are
+    // independent and are written in parallel.
+    const int64_t num_rows = row_split.size() - 1;
+    const int64_t num_columns = output_tensor->dim_size(1);
+    const int64_t output_row_size = num_columns * value_element_size;
+    auto write_rows = [&](int64_t begin, int64_t end) {
+      for (int64_t row = begin; row < end; ++row) {
+        VALUE_TYPE* dst = output_base + row * output_row_size;
+        int64_t num_copied = 0;
+        if (row < num_rows && row_split(row + 1) > row_split(row)) {
+          const int64_t row_start = row_split(row);
+          num_copied =
+              std::min<int64_t>(row_split(row + 1) - row_start, num_columns) *
+              value_element_size;
+          copy_array<VALUE_TYPE, int64_t>(
+              dst, values_base + row_start * value_element_size, num_copied);
+        }
+        if (scalar_default) {
+          std::fill(dst + num_copied, dst + output_row_size, *default_value);
+        } else {
+          for (int64_t i = num_copied; i < output_row_size;
+               i += value_element_size) {
+            copy_array<VALUE_TYPE, int64_t>(dst + i, default_value,
+                                            value_element_size);
+          }
+        }
+      }
+    };
+    auto worker_threads = context->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads->num_threads, worker_threads->workers,
+          output_tensor->dim_size(0), output_row_size * sizeof(VALUE_TYPE),
+          write_rows);
+  }
+
+ private:
+  // Broadcasts the default value to `element_shape` into `*bcast_default`
+  // and points `*default_value` to the result.  (We can skip this if the
+  // default value has a single element, since we use std::fill when that's
+  // true, or if it already has the shape of the elements.)
+  Status BroadcastDefaultValue(OpKernelContext* context,
+                               const TensorShape& element_shape,
+                               Tensor* bcast_default,
+                               const VALUE_TYPE** default_value) {
+    const auto& default_value_tensor = context->input(kDefaultValueInputIndex);
+    *default_value = default_value_tensor.flat<VALUE_TYPE>().data();
+    if (default_value_tensor.NumElements() == element_shape.num_elements() ||
+        default_value_tensor.NumElements() == 1) {
+      return absl::OkStatus();
+    }
+    const auto& src_shape = default_value_tensor.shape();
+    BCast bcast(BCast::FromShape(src_shape), BCast::FromShape(element_shape),
+                /*fewer_dims_optimization=*/true);
+    // Note: bcast should always be valid, since we rejected any incompatible
+    // shapes when we called ValidateDefaultValueShape().
+    if (!bcast.IsValid()) {
+      return errors::InvalidArgument("Error broadcasting default_value");
+    }
+    TF_RETURN_IF_ERROR(context->allocate_temp(default_value_tensor.dtype(),
+                                              element_shape, bcast_default));
+    const CPUDevice& device = context->eigen_device<CPUDevice>();
+    functor::BroadcastTo<CPUDevice, VALUE_TYPE>()(
+        device, context, *bcast_default, element_shape, default_value_tensor,
+        src_shape, bcast);
+    *default_value = bcast_default->flat<VALUE_TYPE>().data();
+    return absl::OkStatus();
+  }
 };
 
 #define REGISTER_CPU_KERNEL_INDEX_TYPE(value_type, index_type)       \
@@ -13,6 +13,7 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
 #include "tensorflow/core/framework/attr_value_util.h"
 #include "tensorflow/core/framework/fake_input.h"
 #include "tensorflow/core/framework/node_def_builder.h"
@@ -21,9 +22,13 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/graph/node_builder.h"
+#include "tensorflow/core/graph/testlib.h"
 #include "tensorflow/core/kernels/ops_testutil.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/random/simple_philox.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
 
 namespace tensorflow {
 namespace {
@@ -409,6 +414,34 @@ TEST_F(RaggedTensorToTensorOpTest, RaggedTensorToTensorConstrained) {
                                 0.01);
 }
 
+TEST_F(RaggedTensorToTensorOpTest, RaggedTensorToTensorRowSplitsConstrained) {
+  // params = [[[1, 2], [3, 4], [5, 6]],
+  //           [],
+  //           [[7, 8], [9, 10]],
+  //           []]
+  // constrained to (3, 2, 2)
+  BuildRaggedTensorToTensorGraph<int32, int64_t>(
+      TensorShape({3, 2, 2}),  // shape
+      {"ROW_SPLITS"},          // row_partition_types
+      ShapeAndValues<int32>{TensorShape({5, 2}),
+                            {1, 2, 3, 4, 5, 6, 7, 8, 9, 10}},  // values
+      createVector<int32>({0, -1}),                            // default_value
+      {createVector<int64_t>({0, 3, 3, 5, 5})}  // row_partition_tensors
+  );
+
+  TF_ASSERT_OK(RunOpKernel());
+
+  test::ExpectTensorEqual<int32>(*GetOutput(0),
+                                 test::AsTensor<int32>(
+                                     {
+                                         //
+                                         1, 2, 3, 4,     //
+                                         0, -1, 0, -1,   //
+                                         7, 8, 9, 10     //
+                                     },
+                                     TensorShape({3, 2, 2})));
+}
+
 TEST_F(RaggedTensorToTensorOpTest, RaggedTensorToTensor_3DParamsConstrained) {
   // params = [
   //           [[]],
@@ -555,5 +588,78 @@ TEST_F(RaggedTensorToTensorOpUnknownShapeTest, RowSplits) {
   INFER_OK(*op_, "?;[3,2,7];[2,7];[6]", "[?,?,2,7]");
 }
 
+constexpr int kRaggedRows = 10000;
+
+// Returns a graph converting a ragged tensor of kRaggedRows rows, whose
+// lengths are uniform in [0, 2 * avg_row_length], to a dense tensor as wide
+// as the longest possible row. The rows are partitioned with a ROW_SPLITS
+// tensor if `use_row_splits`, and with a VALUE_ROWIDS tensor otherwise.
+static Graph* RaggedTensorToTensor(bool use_row_splits, int avg_row_length) {
+  Graph* g = new Graph(OpRegistry::Global());
+  random::PhiloxRandom philox(301, 17);
+  random::SimplePhilox rnd(&philox);
+  std::vector<int64_t> row_splits = {0};
+  for (int i = 0; i < kRaggedRows; ++i) {
+    row_splits.push_back(row_splits.back() +
+                         rnd.Uniform(2 * avg_row_length + 1));
+  }
+  const int64_t num_values = row_splits.back();
+
+  Tensor shape(DT_INT64, TensorShape({2}));
+  test::FillValues<int64_t>(&shape, {kRaggedRows, 2 * avg_row_length});
+  Tensor values(DT_FLOAT, TensorShape({num_values}));
+  values.flat<float>().setRandom();
+  Tensor default_value(DT_FLOAT, TensorShape({}));
+  default_value.scalar<float>()() = 0;
+
+  std::vector<NodeBuilder::NodeOut> row_partition_tensors;
+  std::vector<string> row_partition_types;
+  if (use_row_splits) {
+    row_partition_tensors.push_back(
+        test::graph::Constant(g, test::AsTensor<int64_t>(row_splits)));
+    row_partition_types = {"ROW_SPLITS"};
+  } else {
+    Tensor first_dim_size(DT_INT64, TensorShape({}));
+    first_dim_size.scalar<int64_t>()() = kRaggedRows;
+    Tensor value_rowids(DT_INT64, TensorShape({num_values}));
+    for (int i = 0; i < kRaggedRows; ++i) {
+      for (int64_t j = row_splits[i]; j < row_splits[i + 1]; ++j) {
+        value_rowids.flat<int64_t>()(j) = i;
+      }
+    }
+    row_partition_tensors.push_back(test::graph::Constant(g, first_dim_size));
+    row_partition_tensors.push_back(test::graph::Constant(g, value_rowids));
+    row_partition_types = {"FIRST_DIM_SIZE", "VALUE_ROWIDS"};
+  }
+
+  Node* ret;
+  TF_CHECK_OK(NodeBuilder(g->NewName("n"), "RaggedTensorToTensor")
+                  .Input(test::graph::Constant(g, shape))
+                  .Input(test::graph::Constant(g, values))
+                  .Input(test::graph::Constant(g, default_value))
+                  .Input(row_partition_tensors)
+                  .Attr("row_partition_types", row_partition_types)
+                  .Finalize(g, &ret));
+  return g;
+}
+
+static void BM_RaggedTensorToTensor(::testing::benchmark::State& state) {
+  const bool use_row_splits = state.range(0);
+  const int avg_row_length = state.range(1);
+  test::Benchmark("cpu", RaggedTensorToTensor(use_row_splits, avg_row_length),
+                  /*old_benchmark_api=*/false)
+      .Run(state);
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) *
+                          kRaggedRows * 2 * avg_row_length);
+}
+BENCHMARK(BM_RaggedTensorToTensor)
+    ->UseRealTime()
+    ->ArgPair(0, 8)
+    ->ArgPair(1, 8)
+    ->ArgPair(0, 64)
+    ->ArgPair(1, 64)
+    ->ArgPair(0, 512)
+    ->ArgPair(1, 512);
+
 }  // namespace
 }  // namespace tensorflow
@@ -21,6 +21,8 @@ limitations under the License.
 #include <algorithm>
 #include <cmath>
 #include <memory>
+#include <type_traits>
+#include <utility>
 
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/register_types.h"
@@ -76,6 +78,16 @@ struct FillPhiloxRandom {
 template <class Distribution, bool VariableSamplesPerOutput>
 struct FillPhiloxRandomTask;
 
+// Whether `Distribution` can compute its results from samples generated ahead
+// of time, with `FromSample`.
+template <class Distribution, typename = void>
+struct HasFromSample : std::false_type {};
+template <class Distribution>
+struct HasFromSample<
+    Distribution, std::void_t<decltype(std::declval<Distribution&>().FromSample(
+                      std::declval<const PhiloxRandom::ResultType&>()))>>
+    : std::true_type {};
+
 // Specialization for distribution that takes a fixed number of samples for
 // each output.
 template <class Distribution>
@@ -90,7 +102,21 @@ struct FillPhiloxRandomTask<Distribution, false> {
 
     // First fill all the full-size groups
     int64_t limit_group_full = std::min(limit_group, size / kGroupSize);
-    for (int64_t index = start_group; index < limit_group_full; ++index) {
+    int64_t index = start_group;
+    if constexpr (HasFromSample<Distribution>::value) {
+      // Generate the samples of several groups at once, which is faster.
+      constexpr int kBatchSize = 8;
+      PhiloxRandom::ResultType batch[kBatchSize];
+      for (; index + kBatchSize <= limit_group_full; index += kBatchSize) {
+        gen.GenerateBatch<kBatchSize>(batch);
+        for (int i = 0; i < kBatchSize; ++i) {
+          auto samples = dist.FromSample(batch[i]);
+          std::copy(&samples[0], &samples[0] + kGroupSize, data + offset);
+          offset += kGroupSize;
+        }
+      }
+    }
+    for (; index < limit_group_full; ++index) {
       auto samples = dist(&gen);
       std::copy(&samples[0], &samples[0] + kGroupSize, data + offset);
       offset += kGroupSize;
@@ -116,6 +116,24 @@ void BM_PhiloxRandom(::testing::benchmark::State& state) {
 }
 BENCHMARK(BM_PhiloxRandom);
 
+void BM_PhiloxRandomBatch(::testing::benchmark::State& state) {
+  // Fill 2M random numbers
+  int count = 2 << 20;
+  random::PhiloxRandom gen(0x12345);
+  constexpr int kBatchSize = 8;
+  random::PhiloxRandom::ResultType samples[kBatchSize];
+
+  for (auto s : state) {
+    for (int j = 0; j < count; j += 4 * kBatchSize) {
+      /// each batch returns kBatchSize 128-bit samples
+      gen.GenerateBatch<kBatchSize>(samples);
+      tensorflow::testing::DoNotOptimize(samples);
+    }
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * count);
+}
+BENCHMARK(BM_PhiloxRandomBatch);
+
 void BM_StdMTRandom(::testing::benchmark::State& state) {
   // Fill 2M random numbers
   int count = 2 << 20;
@@ -15,7 +15,10 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/reduction_ops_common.h"
 
+#include <algorithm>
+
 #include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 
@@ -157,4 +160,99 @@ Status ReductionHelper::Simplify(const Tensor& data, const Tensor& axis,
   return absl::OkStatus();
 }
 
+namespace functor {
+namespace {
+
+// The number of rows summed sequentially by SumFloatColumns. The sums of the
+// blocks don't depend on the number of threads, and neither do the results.
+constexpr int64_t kRowsPerBlock = 256;
+// The smallest matrices summed by SumFloatColumns.
+constexpr int64_t kMinSumFloatColumnsSize = 1 << 14;
+// The width of the accumulators of narrow matrices: their rows are summed
+// several at a time, as one contiguous vector.
+constexpr int64_t kMinSumWidth = 64;
+
+}  // namespace
+
+bool SumFloatColumns(OpKernelContext* ctx, const float* in, int64_t rows,
+                     int64_t cols, float divisor, float* out) {
+  if (rows * cols < kMinSumFloatColumnsSize) return false;
+  const int64_t num_blocks = (rows + kRowsPerBlock - 1) / kRowsPerBlock;
+  Tensor partial_sums_t;
+  if (!ctx->allocate_temp(DT_FLOAT, TensorShape({num_blocks, cols}),
+                          &partial_sums_t)
+           .ok()) {
+    return false;
+  }
+  float* partial_sums = partial_sums_t.flat<float>().data();
+
+  // The rows of a block are contiguous, so narrow rows are added `width / cols`
+  // at a time into a vector of `width` sums, which is folded at the end.
+  const int64_t width =
+      cols >= kMinSumWidth ? cols : cols * (kMinSumWidth / cols);
+  auto sum_blocks = [&](int64_t begin, int64_t end) {
+    float narrow_sums[kMinSumWidth];
+    for (int64_t block = begin; block < end; ++block) {
+      float* block_sums = partial_sums + block * cols;
+      float* sums = width == cols ? block_sums : narrow_sums;
+      const int64_t row_begin = block * kRowsPerBlock;
+      const int64_t size =
+          (std::min(rows, row_begin + kRowsPerBlock) - row_begin) * cols;
+      const float* values = in + row_begin * cols;
+      std::copy_n(values, std::min(width, size), sums);
+      std::fill(sums + std::min(width, size), sums + width, 0.0f);
+      int64_t i = width;
+      for (; i + width <= size; i += width) {
+        for (int64_t j = 0; j < width; ++j) {
+          sums[j] += values[i + j];
+        }
+      }
+      for (int64_t j = 0; i + j < size; ++j) {
+        sums[j] += values[i + j];
+      }
+      if (width != cols) {
+        for (int64_t c = 0; c < cols; ++c) {
+          float sum = sums[c];
+          for (int64_t j = cols + c; j < width; j += cols) {
+            sum += sums[j];
+          }
+          block_sums[c] = sum;
+        }
+      }
+    }
+  };
+  const DeviceBase::CpuWorkerThreads& worker_threads =
+      *ctx->device()->tensorflow_cpu_worker_threads();
+  Shard(worker_threads.num_threads, worker_threads.workers, num_blocks,
+        kRowsPerBlock * cols, sum_blocks);
+
+  // Add the sums of the blocks pairwise.
+  for (int64_t stride = 1; stride < num_blocks; stride *= 2) {
+    const int64_t num_pairs = (num_blocks - stride + 2 * stride - 1) /
+                              (2 * stride);
+    auto add_pairs = [&](int64_t begin, int64_t end) {
+      for (int64_t pair = begin; pair < end; ++pair) {
+        float* sums = partial_sums + 2 * stride * pair * cols;
+        const float* other = sums + stride * cols;
+        for (int64_t c = 0; c < cols; ++c) {
+          sums[c] += other[c];
+        }
+      }
+    };
+    Shard(worker_threads.num_threads, worker_threads.workers, num_pairs, cols,
+          add_pairs);
+  }
+
+  if (divisor == 1) {
+    std::copy_n(partial_sums, cols, out);
+  } else {
+    for (int64_t c = 0; c < cols; ++c) {
+      out[c] = partial_sums[c] / divisor;
+    }
+  }
+  return true;
+}
+
+}  // namespace functor
+
 }  // namespace tensorflow
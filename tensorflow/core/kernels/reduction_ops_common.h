@@ -272,6 +272,44 @@ template <typename Reducer>
 struct ReduceFunctor<CPUDevice, Reducer>
     : ReduceFunctorBase<CPUDevice, Reducer> {};
 
+// Sums the columns of the row-major `rows` x `cols` matrix `in` into `out`,
+// dividing the sums by `divisor`. The rows are summed in fixed-size blocks in
+// parallel, then the sums of the blocks are added pairwise, which is faster
+// and more accurate than the Eigen reduction along the first axis. Returns
+// false, without writing `out`, for the matrices that the Eigen reduction
+// handles as well.
+bool SumFloatColumns(OpKernelContext* ctx, const float* in, int64_t rows,
+                     int64_t cols, float divisor, float* out);
+
+// Reduces float matrices along their first axis with SumFloatColumns.
+template <typename Reducer, bool kIsMean>
+struct FloatSumReduceFunctor : ReduceFunctorBase<CPUDevice, Reducer> {
+  template <typename OUT_T, typename IN_T, typename ReductionAxes>
+  static void Reduce(OpKernelContext* ctx, OUT_T out, IN_T in,
+                     const ReductionAxes& reduction_axes,
+                     const Reducer& reducer) {
+    using FirstAxis = Eigen::IndexList<Eigen::type2index<0>>;
+    if constexpr (IN_T::NumDimensions == 2 && OUT_T::NumDimensions == 1 &&
+                  std::is_same<ReductionAxes, FirstAxis>::value) {
+      const float divisor = kIsMean ? static_cast<float>(in.dimension(0)) : 1;
+      if (SumFloatColumns(ctx, in.data(), in.dimension(0), in.dimension(1),
+                          divisor, out.data())) {
+        return;
+      }
+    }
+    ReduceFunctorBase<CPUDevice, Reducer>::Reduce(ctx, out, in, reduction_axes,
+                                                  reducer);
+  }
+};
+
+template <>
+struct ReduceFunctor<CPUDevice, Eigen::internal::SumReducer<float>>
+    : FloatSumReduceFunctor<Eigen::internal::SumReducer<float>, false> {};
+
+template <>
+struct ReduceFunctor<CPUDevice, MeanReducer<float>>
+    : FloatSumReduceFunctor<MeanReducer<float>, true> {};
+
 }  // namespace functor
 }  // namespace tensorflow
 
@@ -184,6 +184,17 @@ static void BM_Sum2DColumnReduceGPU(::testing::benchmark::State& state) {
 }
 BENCHMARK(BM_Sum2DColumnReduceGPU)->RangePair(1, 8192, 1, 8192);
 
+static void BM_Sum2DColumnReduceCPU(::testing::benchmark::State& state) {
+  const int num_x = state.range(0);
+  const int num_y = state.range(1);
+
+  DoColReduce(state, "cpu", "Sum", num_x, num_y);
+}
+BENCHMARK(BM_Sum2DColumnReduceCPU)
+    ->ArgPair(1 << 20, 8)
+    ->ArgPair(1 << 18, 64)
+    ->ArgPair(8192, 8192);
+
 static void BM_Sum3DYReduceGPU(::testing::benchmark::State& state) {
   const int num_x = state.range(0);
   const int num_y = state.range(1);
@@ -18,12 +18,31 @@ limitations under the License.
 #include "re2/re2.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/kernels/regex_util.h"
+#include "tensorflow/core/kernels/string_util.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/thread_annotations.h"
 
 namespace tensorflow {
+namespace {
+
+// Rough cost of matching a string, in cycles per byte.
+constexpr int64_t kRegexFullMatchCostPerByte = 20;
+
+void FullMatch(OpKernelContext* ctx, const RE2& regex,
+               const TTypes<tstring>::ConstFlat& input_flat,
+               TTypes<bool>::Flat output_flat) {
+  ShardStrings(ctx, input_flat.data(), input_flat.size(),
+               kRegexFullMatchCostPerByte, [&](int64_t start, int64_t limit) {
+                 for (int64_t i = start; i < limit; ++i) {
+                   output_flat(i) = RE2::FullMatch(input_flat(i), regex);
+                 }
+               });
+}
+
+}  // namespace
 
 class RegexFullMatchOp : public OpKernel {
  public:
@@ -42,7 +61,7 @@ class RegexFullMatchOp : public OpKernel {
                 errors::InvalidArgument("Pattern must be scalar, but received ",
                                         pattern_tensor->shape().DebugString()));
     const string pattern = pattern_tensor->flat<tstring>()(0);
-    std::shared_ptr<RE2> regex = CachedRE2(pattern);
+    std::shared_ptr<const RE2> regex = CachedRE2(pattern);
     OP_REQUIRES(ctx, regex->ok(),
                 errors::InvalidArgument("Invalid pattern: ", pattern,
                                         ", error: ", regex->error()));
@@ -50,22 +69,19 @@ class RegexFullMatchOp : public OpKernel {
     Tensor* output_tensor = nullptr;
     OP_REQUIRES_OK(ctx, ctx->allocate_output("output", input_tensor->shape(),
                                              &output_tensor));
-    auto output_flat = output_tensor->flat<bool>();
-    for (size_t i = 0; i < input_flat.size(); ++i) {
-      output_flat(i) = RE2::FullMatch(input_flat(i), *regex);
-    }
+    FullMatch(ctx, *regex, input_flat, output_tensor->flat<bool>());
   }
 
  private:
-  std::shared_ptr<RE2> CachedRE2(const string& pattern) {
+  std::shared_ptr<const RE2> CachedRE2(const string& pattern) {
     {
       tf_shared_lock l(mu_);
       if (regex_ != nullptr && regex_->pattern() == pattern) {
         return regex_;
       }
     }
-    // Construct the new RE2 object before acquiring the lock.
-    auto regex = std::make_shared<RE2>(pattern);
+    // Look up the new RE2 object before acquiring the lock.
+    std::shared_ptr<const RE2> regex = GetCachedRE2(pattern);
     {
       mutex_lock l(mu_);
       // Swap instead of assigning so that we destruct the old
@@ -76,7 +92,7 @@ class RegexFullMatchOp : public OpKernel {
   }
 
   mutex mu_;
-  std::shared_ptr<RE2> regex_ TF_GUARDED_BY(mu_);
+  std::shared_ptr<const RE2> regex_ TF_GUARDED_BY(mu_);
 
   RegexFullMatchOp(const RegexFullMatchOp&) = delete;
   void operator=(const RegexFullMatchOp&) = delete;
@@ -90,7 +106,7 @@ class StaticRegexFullMatchOp : public OpKernel {
   explicit StaticRegexFullMatchOp(OpKernelConstruction* ctx) : OpKernel(ctx) {
     string pattern;
     OP_REQUIRES_OK(ctx, ctx->GetAttr("pattern", &pattern));
-    re_ = std::make_unique<RE2>(pattern);
+    re_ = GetCachedRE2(pattern);
     OP_REQUIRES(ctx, re_->ok(),
                 errors::InvalidArgument("Invalid pattern: ", pattern,
                                         ", error: ", re_->error()));
@@ -104,14 +120,11 @@ class StaticRegexFullMatchOp : public OpKernel {
     Tensor* output_tensor = nullptr;
     OP_REQUIRES_OK(ctx, ctx->allocate_output("output", input_tensor->shape(),
                                              &output_tensor));
-    auto output_flat = output_tensor->flat<bool>();
-    for (size_t i = 0; i < input_flat.size(); ++i) {
-      output_flat(i) = RE2::FullMatch(input_flat(i), *re_);
-    }
+    FullMatch(ctx, *re_, input_flat, output_tensor->flat<bool>());
   }
 
  private:
-  std::unique_ptr<RE2> re_;
+  std::shared_ptr<const RE2> re_;
 };
 
 REGISTER_KERNEL_BUILDER(Name("StaticRegexFullMatch").Device(DEVICE_CPU),
@@ -18,6 +18,8 @@ limitations under the License.
 #include "re2/re2.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/kernels/regex_util.h"
+#include "tensorflow/core/kernels/string_util.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/platform/mutex.h"
@@ -26,6 +28,9 @@ limitations under the License.
 namespace tensorflow {
 namespace {
 
+// Rough cost of replacing in a string, in cycles per byte.
+constexpr int64_t kRegexReplaceCostPerByte = 50;
+
 // Execute the specified regex using the given context.
 // Context requirements:
 //  - "input" string Tensor at input_index=0
@@ -48,17 +53,20 @@ Status InternalCompute(const RE2& regex, const string& rewrite,
     output_tensor->flat<tstring>() = input_tensor->flat<tstring>();
   }
   auto output_flat = output_tensor->flat<tstring>();
-  for (size_t i = 0; i < output_flat.size(); ++i) {
-    // TODO(dero): Mitigate copy; Global and GlobalReplace below currently only
-    // accept std::string.
-    string buf = output_flat(i);
-    if (replace_global) {
-      RE2::GlobalReplace(&buf, regex, rewrite);
-    } else {
-      RE2::Replace(&buf, regex, rewrite);
-    }
-    output_flat(i) = std::move(buf);
-  }
+  ShardStrings(ctx, output_flat.data(), output_flat.size(),
+               kRegexReplaceCostPerByte, [&](int64_t start, int64_t limit) {
+                 for (int64_t i = start; i < limit; ++i) {
+                   // TODO(dero): Mitigate copy; Global and GlobalReplace below
+                   // currently only accept std::string.
+                   string buf = output_flat(i);
+                   if (replace_global) {
+                     RE2::GlobalReplace(&buf, regex, rewrite);
+                   } else {
+                     RE2::Replace(&buf, regex, rewrite);
+                   }
+                   output_flat(i) = std::move(buf);
+                 }
+               });
   return absl::OkStatus();
 }
 }  // namespace
@@ -78,7 +86,7 @@ class RegexReplaceOp : public OpKernel {
                 errors::InvalidArgument("Pattern must be scalar, but received ",
                                         pattern_tensor->shape().DebugString()));
     const string& pattern = pattern_tensor->scalar<tstring>()();
-    std::shared_ptr<RE2> regex = CachedRE2(pattern);
+    std::shared_ptr<const RE2> regex = CachedRE2(pattern);
     OP_REQUIRES(ctx, regex->ok(),
                 errors::InvalidArgument("Invalid pattern: ", pattern,
                                         ", error: ", regex->error()));
@@ -93,15 +101,15 @@ class RegexReplaceOp : public OpKernel {
   }
 
  private:
-  std::shared_ptr<RE2> CachedRE2(const string& pattern) {
+  std::shared_ptr<const RE2> CachedRE2(const string& pattern) {
     {
       tf_shared_lock l(mu_);
       if (regex_ != nullptr && regex_->pattern() == pattern) {
         return regex_;
       }
     }
-    // Construct the new RE2 object before acquiring the lock.
-    auto regex = std::make_shared<RE2>(pattern);
+    // Look up the new RE2 object before acquiring the lock.
+    std::shared_ptr<const RE2> regex = GetCachedRE2(pattern);
     {
       mutex_lock l(mu_);
       // Swap instead of assigning so that we destruct the old
@@ -113,7 +121,7 @@ class RegexReplaceOp : public OpKernel {
 
   bool replace_global_;
   mutex mu_;
-  std::shared_ptr<RE2> regex_ TF_GUARDED_BY(mu_);
+  std::shared_ptr<const RE2> regex_ TF_GUARDED_BY(mu_);
 
   RegexReplaceOp(const RegexReplaceOp&) = delete;
   void operator=(const RegexReplaceOp&) = delete;
@@ -127,7 +135,7 @@ class StaticRegexReplaceOp : public OpKernel {
   explicit StaticRegexReplaceOp(OpKernelConstruction* ctx) : OpKernel(ctx) {
     string pattern;
     OP_REQUIRES_OK(ctx, ctx->GetAttr("pattern", &pattern));
-    re_ = std::make_unique<RE2>(pattern);
+    re_ = GetCachedRE2(pattern);
     OP_REQUIRES(ctx, re_->ok(),
                 errors::InvalidArgument("Invalid pattern: ", pattern,
                                         ", error: ", re_->error()));
@@ -141,7 +149,7 @@ class StaticRegexReplaceOp : public OpKernel {
   }
 
  private:
-  std::unique_ptr<RE2> re_;
+  std::shared_ptr<const RE2> re_;
   string rewrite_str_;
   bool replace_global_;
 };
@@ -13,6 +13,9 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <string>
+#include <vector>
+
 #include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/fake_input.h"
@@ -57,6 +60,45 @@ const char* lines[] = {
 const char kRegExPattern[] = "\\p{P}";
 const char kRewrite[] = " ";
 
+class RegexReplaceOpTest : public OpsTestBase {
+ protected:
+  void MakeRegexReplaceOp() {
+    TF_ASSERT_OK(NodeDefBuilder("regex_replace_op", "RegexReplace")
+                     .Input(FakeInput(DT_STRING))
+                     .Input(FakeInput(DT_STRING))
+                     .Input(FakeInput(DT_STRING))
+                     .Attr("replace_global", true)
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+  }
+};
+
+TEST_F(RegexReplaceOpTest, ManyStrings) {
+  // Enough strings to replace them on several threads, with empty strings.
+  std::vector<tstring> input;
+  std::vector<tstring> expected;
+  for (int i = 0; i < 1000; ++i) {
+    input.push_back(string(i % 10, 'a' + i % 26) + string(i % 3, '!'));
+    expected.push_back(string(i % 10, 'a' + i % 26) + string(i % 3, ' '));
+  }
+  MakeRegexReplaceOp();
+  AddInputFromArray<tstring>(TensorShape({1000}), input);
+  AddInputFromArray<tstring>(TensorShape({}), {kRegExPattern});
+  AddInputFromArray<tstring>(TensorShape({}), {kRewrite});
+  TF_ASSERT_OK(RunOpKernel());
+  test::ExpectTensorEqual<tstring>(test::AsTensor<tstring>(expected),
+                                   *GetOutput(0));
+}
+
+TEST_F(RegexReplaceOpTest, EmptyInput) {
+  MakeRegexReplaceOp();
+  AddInputFromArray<tstring>(TensorShape({0}), {});
+  AddInputFromArray<tstring>(TensorShape({}), {kRegExPattern});
+  AddInputFromArray<tstring>(TensorShape({}), {kRewrite});
+  TF_ASSERT_OK(RunOpKernel());
+  EXPECT_EQ(GetOutput(0)->NumElements(), 0);
+}
+
 Tensor GetTestTensor(int batch) {
   const int sz = TF_ARRAYSIZE(lines);
   Tensor t(DT_STRING, {batch});
@@ -0,0 +1,65 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/regex_util.h"
+
+#include <string>
+#include <utility>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+namespace {
+
+// The cache is cleared when it holds this many patterns, so that graphs that
+// build their patterns from the data do not grow it without bounds.
+constexpr size_t kMaxCachedPatterns = 1024;
+
+struct RegexCache {
+  mutex mu;
+  absl::flat_hash_map<std::string, std::shared_ptr<const RE2>> regexes
+      TF_GUARDED_BY(mu);
+};
+
+RegexCache* GetRegexCache() {
+  static RegexCache* cache = new RegexCache;
+  return cache;
+}
+
+}  // namespace
+
+std::shared_ptr<const RE2> GetCachedRE2(StringPiece pattern) {
+  RegexCache* cache = GetRegexCache();
+  {
+    tf_shared_lock l(cache->mu);
+    auto it = cache->regexes.find(pattern);
+    if (it != cache->regexes.end()) return it->second;
+  }
+  // Compile the pattern before acquiring the lock.
+  auto regex = std::make_shared<const RE2>(pattern);
+  // Declared before the lock so that the evicted RE2 objects are destructed
+  // after releasing it.
+  absl::flat_hash_map<std::string, std::shared_ptr<const RE2>> evicted;
+  mutex_lock l(cache->mu);
+  if (cache->regexes.size() >= kMaxCachedPatterns) {
+    evicted.swap(cache->regexes);
+  }
+  // Another thread may have inserted the pattern in the meantime.
+  auto inserted = cache->regexes.emplace(std::string(pattern), regex);
+  return inserted.first->second;
+}
+
+}  // namespace tensorflow
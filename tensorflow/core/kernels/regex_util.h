@@ -0,0 +1,34 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_KERNELS_REGEX_UTIL_H_
+#define TENSORFLOW_CORE_KERNELS_REGEX_UTIL_H_
+
+#include <memory>
+
+#include "re2/re2.h"
+#include "tensorflow/core/lib/core/stringpiece.h"
+
+namespace tensorflow {
+
+// Returns the compiled RE2 of `pattern`, from a process-wide cache shared by
+// the regex kernels, so that kernels with the same pattern compile it only
+// once. The returned RE2 may be invalid: check its ok().
+//
+// Thread-safe, and the RE2 objects are thread-safe for matching.
+std::shared_ptr<const RE2> GetCachedRE2(StringPiece pattern);
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_REGEX_UTIL_H_
@@ -0,0 +1,69 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/regex_util.h"
+
+#include <memory>
+
+#include "re2/re2.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/threadpool.h"
+
+namespace tensorflow {
+namespace {
+
+TEST(GetCachedRE2Test, ReusesCompiledPatterns) {
+  std::shared_ptr<const RE2> regex = GetCachedRE2("a+b");
+  ASSERT_TRUE(regex->ok());
+  EXPECT_TRUE(RE2::FullMatch("aab", *regex));
+  EXPECT_EQ(regex.get(), GetCachedRE2("a+b").get());
+  EXPECT_NE(regex.get(), GetCachedRE2("a+c").get());
+}
+
+TEST(GetCachedRE2Test, InvalidPattern) {
+  std::shared_ptr<const RE2> regex = GetCachedRE2("(");
+  EXPECT_FALSE(regex->ok());
+  EXPECT_EQ(regex.get(), GetCachedRE2("(").get());
+}
+
+TEST(GetCachedRE2Test, EvictsPatternsWhenFull) {
+  std::shared_ptr<const RE2> regex = GetCachedRE2("evicted");
+  // More patterns than the cache holds.
+  for (int i = 0; i < 4096; ++i) {
+    EXPECT_TRUE(GetCachedRE2(strings::StrCat("pattern", i))->ok());
+  }
+  std::shared_ptr<const RE2> recompiled = GetCachedRE2("evicted");
+  EXPECT_NE(regex.get(), recompiled.get());
+  EXPECT_EQ(recompiled.get(), GetCachedRE2("evicted").get());
+  // The evicted RE2 is still owned by its users.
+  EXPECT_TRUE(RE2::FullMatch("evicted", *regex));
+}
+
+TEST(GetCachedRE2Test, ConcurrentLookups) {
+  thread::ThreadPool pool(Env::Default(), "test", 8);
+  for (int t = 0; t < 8; ++t) {
+    pool.Schedule([]() {
+      for (int i = 0; i < 100; ++i) {
+        const string pattern = strings::StrCat("concurrent", i, "x*");
+        EXPECT_TRUE(RE2::FullMatch(strings::StrCat("concurrent", i, "xx"),
+                                   *GetCachedRE2(pattern)));
+      }
+    });
+  }
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -26,13 +26,13 @@ limitations under the License.
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/types.pb.h"
-#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/gtl/array_slice.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/lib/strings/stringprintf.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
 #include "tensorflow/core/util/tensor_slice_reader.h"
 #include "tensorflow/core/util/tensor_slice_reader_cache.h"
@@ -248,13 +248,7 @@ void RestoreTensor(OpKernelContext* context,
 
 namespace {
 
-// Tensors larger than this threshold will be restored from a thread-pool.
-const int64_t kLargeShapeThreshold = 16 << 20;  // 16M
-
-// A restore operation for a single tensor.  Small tensors may be restored
-// directly from the op thread to improve read locality.  Large tensors can be
-// restored from a thread pool: this requires creating a separate BundleReader
-// for each restore.
+// The restore operation for a single tensor.
 struct RestoreOp {
   RestoreOp(OpKernelContext* context, int idx, const string& tensor_name,
             const string& shape_and_slice, const string& reader_prefix,
@@ -266,88 +260,37 @@ struct RestoreOp {
         reader_prefix(reader_prefix),
         dtype(dtype) {}
 
-  // Move-only. It does not make sense to "run()" a copied RestoreOp.
-  RestoreOp(const RestoreOp&) = delete;
-  RestoreOp& operator=(const RestoreOp&) = delete;
-  RestoreOp(RestoreOp&&) = default;
-  RestoreOp& operator=(RestoreOp&&) = default;
-
-  bool is_large_shape(BundleReader* reader) const {
-    TensorShape restored_full_shape;
-
-    // Ignore status here; we'll catch the error later.
-    if (!reader->LookupTensorShape(tensor_name, &restored_full_shape).ok()) {
-      return false;
-    }
-
-    return restored_full_shape.num_elements() > kLargeShapeThreshold;
-  }
-
-  // Run this restore operation using a new BundleReader.
-  void run_with_new_reader(BundleCache* cache) {
-    BundleReader reader(tsl::Env::Default(), reader_prefix, {cache, false});
-    if (!reader.status().ok()) {
-      status = reader.status();
-      return;
-    }
-
-    status = run(&reader);
-  }
-
-  Status run(BundleReader* reader) {
+  // Allocates the output for this restore, and fills in the `request` that
+  // reads it.
+  Status Prepare(BundleReader* reader, BundleReader::LookupRequest* request) {
     TensorShape restored_full_shape;
     TF_RETURN_IF_ERROR(
         reader->LookupTensorShape(tensor_name, &restored_full_shape));
 
     VLOG(1) << "Restoring tensor " << idx << " : " << tensor_name << " : "
             << restored_full_shape.num_elements();
-    Tensor* restored_tensor;
+    request->key = tensor_name;
     if (shape_and_slice.empty()) {
       // Lookup the full tensor.
-      TF_RETURN_IF_ERROR(
-          context->allocate_output(idx, restored_full_shape, &restored_tensor));
-      TF_RETURN_IF_ERROR(reader->Lookup(tensor_name, restored_tensor));
-    } else {
-      // Lookup the slice.
-      TensorShape parsed_full_shape;
-      TensorSlice parsed_slice;
-      TensorShape parsed_slice_shape;
-
-      TF_RETURN_IF_ERROR(
-          checkpoint::ParseShapeAndSlice(shape_and_slice, &parsed_full_shape,
-                                         &parsed_slice, &parsed_slice_shape));
-
-      if (!restored_full_shape.IsSameSize(parsed_full_shape)) {
-        return errors::InvalidArgument(
-            "tensor_name = ", tensor_name, "; shape in shape_and_slice spec ",
-            parsed_full_shape.DebugString(),
-            " does not match the shape stored in checkpoint: ",
-            restored_full_shape.DebugString());
-      }
-      TF_RETURN_IF_ERROR(
-          context->allocate_output(idx, parsed_slice_shape, &restored_tensor));
-      TF_RETURN_IF_ERROR(
-          reader->LookupSlice(tensor_name, parsed_slice, restored_tensor));
+      return context->allocate_output(idx, restored_full_shape, &request->val);
     }
-    if (VLOG_IS_ON(5)) {
-      if (restored_tensor->dtype() == DT_FLOAT) {
-        const float* t_data = restored_tensor->flat<float>().data();
-        float min = std::numeric_limits<float>::infinity();
-        float max = -std::numeric_limits<float>::infinity();
-        double avg = 0.0;
-        for (int i = 0; i < restored_tensor->NumElements(); ++i) {
-          if (t_data[i] < min) min = t_data[i];
-          if (t_data[i] > max) max = t_data[i];
-          avg += t_data[i];
-        }
-        VLOG(5) << " min " << min << " max " << max << " avg "
-                << avg / restored_tensor->NumElements() << " total elts "
-                << restored_tensor->NumElements();
-      }
+
+    // Lookup the slice.
+    TensorShape parsed_full_shape;
+    TensorSlice parsed_slice;
+    TensorShape parsed_slice_shape;
+    TF_RETURN_IF_ERROR(
+        checkpoint::ParseShapeAndSlice(shape_and_slice, &parsed_full_shape,
+                                       &parsed_slice, &parsed_slice_shape));
+    if (!restored_full_shape.IsSameSize(parsed_full_shape)) {
+      return errors::InvalidArgument(
+          "tensor_name = ", tensor_name, "; shape in shape_and_slice spec ",
+          parsed_full_shape.DebugString(),
+          " does not match the shape stored in checkpoint: ",
+          restored_full_shape.DebugString());
     }
-    VLOG(1) << "Done restoring tensor " << idx << " : " << tensor_name << " : "
-            << restored_full_shape.num_elements();
-    return absl::OkStatus();
+    request->slice = parsed_slice;
+    return context->allocate_output(idx, parsed_slice_shape, &request->val);
   }
 
   OpKernelContext* context;
@@ -356,8 +299,6 @@ struct RestoreOp {
   string shape_and_slice;
   string reader_prefix;
   DataType dtype;
-
-  ::tensorflow::Status status;
 };
 
 }  // namespace
@@ -405,69 +346,39 @@ Status RestoreTensorsV2(OpKernelContext* context, const Tensor& prefix,
     return errors::InvalidArgument(error_msg);
   }
 
-  // Split restore ops into two groups: large and small. We schedule
-  // large ops first, to prevent them from waiting on the small op.
-  std::vector<RestoreOp*> large_restore_ops;
-  std::vector<RestoreOp*> small_restore_ops;
+  // The whole tensors are mapped from the data files of read-only models,
+  // when possible, and the other ones are read.
+  const bool mmap_tensors =
+      context->session_config() != nullptr &&
+      context->session_config()->experimental().mmap_restored_variables();
+  std::vector<BundleReader::LookupRequest> requests;
+  requests.reserve(restore_ops.size());
   for (RestoreOp& restore_op : restore_ops) {
-    if (restore_op.is_large_shape(&default_reader)) {
-      large_restore_ops.push_back(&restore_op);
-    } else {
-      small_restore_ops.push_back(&restore_op);
+    if (mmap_tensors && restore_op.shape_and_slice.empty()) {
+      Tensor mapped;
+      if (default_reader.LookupMapped(restore_op.tensor_name, &mapped)) {
+        context->set_output(restore_op.idx, mapped);
+        continue;
+      }
     }
+    requests.emplace_back();
+    TF_RETURN_IF_ERROR(restore_op.Prepare(&default_reader, &requests.back()));
   }
 
+  // All tensors are restored with a single batch of coalesced, concurrent
+  // reads.
+  BundleReader::LookupBatchOptions options;
   if (context->session_config() != nullptr &&
       context->session_config()->intra_op_parallelism_threads() > 0) {
-    // If an explicit restore parallelism is specified, we use it to run
-    // run both small and large restore ops in parallel.
-    auto reader_pool = std::make_unique<thread::ThreadPool>(
-        tsl::Env::Default(), "restore_tensors",
-        context->session_config()->intra_op_parallelism_threads());
-
-    // Schedule large ops first, followed by the small.
-    for (auto* op : large_restore_ops) {
-      reader_pool->Schedule(
-          [op, &cache]() { op->run_with_new_reader(&cache); });
-    }
-    for (auto* op : small_restore_ops) {
-      reader_pool->Schedule(
-          [op, &cache]() { op->run_with_new_reader(&cache); });
-    }
-
-    // Wait for all scheduled work to finish and check the status of all
-    // ops that ran in the pool.
-    reader_pool.reset();
-    for (auto& op : restore_ops) {
-      TF_RETURN_IF_ERROR(op.status);
-    }
-  } else {
-    // If no restore parallelism is specified, we run large restore ops with
-    // a modest parallelism, and small restore ops serially.
-
-    // Avoid creating a pool if there are no large restore ops.
-    std::unique_ptr<thread::ThreadPool> reader_pool;
-    if (!large_restore_ops.empty()) {
-      reader_pool.reset(
-          new thread::ThreadPool(Env::Default(), "restore_tensors", 8));
-      for (auto* op : large_restore_ops) {
-        reader_pool->Schedule(
-            [op, &cache]() { op->run_with_new_reader(&cache); });
-      }
-    }
-
-    // Read small tensors from the op thread.
-    for (auto* op : small_restore_ops) {
-      TF_RETURN_IF_ERROR(op->run(&default_reader));
-    }
-
-    // Wait for all scheduled work to finish and check the status of all
-    // ops that ran in the pool.
-    reader_pool.reset();
-    for (auto* op : large_restore_ops) {
-      TF_RETURN_IF_ERROR(op->status);
-    }
+    options.num_threads =
+        context->session_config()->intra_op_parallelism_threads();
   }
+  int64_t max_mb_in_flight;
+  TF_RETURN_IF_ERROR(ReadInt64FromEnvVar("TF_RESTORE_MAX_MB_IN_FLIGHT",
+                                         options.max_bytes_in_flight >> 20,
+                                         &max_mb_in_flight));
+  options.max_bytes_in_flight = max_mb_in_flight << 20;
+  TF_RETURN_IF_ERROR(default_reader.LookupBatch(requests, options));
 
   for (const RestoreOp& restore_op : restore_ops) {
     if (restore_op.dtype != context->mutable_output(restore_op.idx)->dtype()) {
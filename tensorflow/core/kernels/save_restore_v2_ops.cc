@@ -17,13 +17,17 @@ limitations under the License.
 
 #include <cstddef>
 #include <limits>
+#include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "tensorflow/core/framework/bounds_check.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/resource_mgr.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_util.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/kernels/checkpoint_callback_manager.h"
@@ -32,7 +36,10 @@ limitations under the License.
 #include "tensorflow/core/lib/io/path.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"  // IWYU pragma: keep
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/notification.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/saved_tensor_slice_util.h"
 #include "tensorflow/core/util/tensor_bundle/naming.h"
 #include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
@@ -90,6 +97,155 @@ void ValidateInputs(bool is_save_op, OpKernelContext* context,
   }
 }
 
+// A tensor, or a slice of a tensor, to save.
+struct SaveItem {
+  string name;
+  bool is_slice = false;
+  TensorShape full_shape;  // Only set if "is_slice".
+  TensorSlice slice;       // Only set if "is_slice".
+  Tensor tensor;
+};
+
+// Writes "items" to a new bundle at "prefix".
+Status WriteBundle(const string& prefix, const std::vector<SaveItem>& items,
+                   const BundleWriter::Options& options) {
+  BundleWriter writer(Env::Default(), prefix, options);
+  TF_RETURN_IF_ERROR(writer.status());
+  VLOG(1) << "BundleWriter, prefix_string: " << prefix;
+
+  for (const SaveItem& item : items) {
+    const Tensor& tensor = item.tensor;
+    VLOG(2) << "Starting save of " << item.name;
+    if (item.is_slice) {
+      TF_RETURN_IF_ERROR(
+          writer.AddSlice(item.name, item.full_shape, item.slice, tensor));
+    } else {
+      TF_RETURN_IF_ERROR(writer.Add(item.name, tensor));
+    }
+
+    if (VLOG_IS_ON(5)) {
+      if (tensor.dtype() == DT_FLOAT) {
+        const float* t_data = tensor.flat<float>().data();
+        float min = std::numeric_limits<float>::infinity();
+        float max = -std::numeric_limits<float>::infinity();
+        double avg = 0.0;
+        for (int i = 0; i < tensor.NumElements(); ++i) {
+          if (t_data[i] < min) min = t_data[i];
+          if (t_data[i] > max) max = t_data[i];
+          avg += t_data[i];
+        }
+        VLOG(5) << " min " << min << " max " << max << " avg "
+                << avg / tensor.NumElements() << " total elts "
+                << tensor.NumElements();
+      }
+    }
+
+    VLOG(2) << "Done save of " << item.name;
+  }
+  TF_RETURN_IF_ERROR(writer.Finish());
+  VLOG(1) << "Done BundleWriter, prefix_string: " << prefix << ", "
+          << writer.reused_bytes() << " bytes reused from "
+          << options.base_prefix;
+  return absl::OkStatus();
+}
+
+// A bundle written in the background by SaveV2.
+struct PendingSave {
+  Notification done;
+  Status status;  // Set before "done" is notified.
+};
+
+// Keeps track, process-wide, of the bundles that SaveV2 ops are writing in
+// the background, so that the ops reading them wait for the write to finish,
+// and of the prefixes that MergeV2Checkpoints merged bundles into, so that
+// incremental saves find their base bundle.
+class SaveRegistry {
+ public:
+  static SaveRegistry* Global() {
+    static SaveRegistry* registry = new SaveRegistry;
+    return registry;
+  }
+
+  void AddPending(const string& prefix, std::shared_ptr<PendingSave> save) {
+    mutex_lock l(mu_);
+    pending_[prefix] = std::move(save);
+  }
+
+  // Notifies "save" with "status". Successful saves are forgotten right away,
+  // failed ones are reported by the next WaitForPending() of "prefix".
+  void Done(const string& prefix, PendingSave* save, Status status) {
+    {
+      mutex_lock l(mu_);
+      auto it = pending_.find(prefix);
+      if (status.ok() && it != pending_.end() && it->second.get() == save) {
+        pending_.erase(it);
+      }
+    }
+    save->status = std::move(status);
+    save->done.Notify();
+  }
+
+  // Waits until the bundle at "prefix" is written, if it is being written in
+  // the background, and returns the status of the write.
+  Status WaitForPending(const string& prefix) {
+    std::shared_ptr<PendingSave> save;
+    {
+      mutex_lock l(mu_);
+      auto it = pending_.find(prefix);
+      if (it == pending_.end()) return absl::OkStatus();
+      save = std::move(it->second);
+      pending_.erase(it);
+    }
+    save->done.WaitForNotification();
+    return save->status;
+  }
+
+  void RecordMerge(const string& prefix, const string& merged_prefix) {
+    mutex_lock l(mu_);
+    merged_prefixes_[prefix] = merged_prefix;
+  }
+
+  // Returns the prefix of the bundle that now holds the tensors written at
+  // "prefix".
+  string TakeMergedPrefix(const string& prefix) {
+    mutex_lock l(mu_);
+    auto it = merged_prefixes_.find(prefix);
+    if (it == merged_prefixes_.end()) return prefix;
+    string merged_prefix = std::move(it->second);
+    merged_prefixes_.erase(it);
+    return merged_prefix;
+  }
+
+ private:
+  mutex mu_;
+  absl::flat_hash_map<string, std::shared_ptr<PendingSave>> pending_
+      TF_GUARDED_BY(mu_);
+  absl::flat_hash_map<string, string> merged_prefixes_ TF_GUARDED_BY(mu_);
+};
+
+// If set, SaveV2 snapshots its inputs into host staging copies and writes the
+// bundle in the background, returning as soon as the copies are made.
+bool AsyncSaveEnabled() {
+  static const bool enabled = [] {
+    bool value;
+    TF_CHECK_OK(ReadBoolFromEnvVar("TF_ASYNC_CHECKPOINT_SAVE", false, &value));
+    return value;
+  }();
+  return enabled;
+}
+
+// If set, each SaveV2 op writes an incremental bundle on top of the bundle it
+// saved last: unchanged tensors are not written again.
+bool IncrementalSaveEnabled() {
+  static const bool enabled = [] {
+    bool value;
+    TF_CHECK_OK(
+        ReadBoolFromEnvVar("TF_INCREMENTAL_CHECKPOINT_SAVE", false, &value));
+    return value;
+  }();
+  return enabled;
+}
+
 }  // namespace
 
 // Saves a list of named tensors using the tensor bundle library.
@@ -97,6 +253,11 @@ class SaveV2 : public OpKernel {
  public:
   explicit SaveV2(OpKernelConstruction* context) : OpKernel(context) {}
 
+  ~SaveV2() override {
+    mutex_lock l(mu_);
+    if (pending_ != nullptr) pending_->done.WaitForNotification();
+  }
+
   void Compute(OpKernelContext* context) override {
     const Tensor& prefix = context->input(0);
     const Tensor& tensor_names = context->input(1);
@@ -111,57 +272,76 @@ class SaveV2 : public OpKernel {
     const auto& tensor_names_flat = tensor_names.flat<tstring>();
     const auto& shape_and_slices_flat = shape_and_slices.flat<tstring>();
 
-    BundleWriter writer(Env::Default(), prefix_string);
-    OP_REQUIRES_OK(context, writer.status());
-    VLOG(1) << "BundleWriter, prefix_string: " << prefix_string;
-
+    std::vector<SaveItem> items(num_tensors);
     for (int i = 0; i < num_tensors; ++i) {
-      const string& tensor_name = tensor_names_flat(i);
-      const Tensor& tensor = context->input(i + kFixedInputs);
-      VLOG(2) << "Starting save of " << tensor_name;
+      SaveItem& item = items[i];
+      item.name = tensor_names_flat(i);
+      item.tensor = context->input(i + kFixedInputs);
 
       if (!shape_and_slices_flat(i).empty()) {
         const string& shape_spec = shape_and_slices_flat(i);
-        TensorShape shape;
-        TensorSlice slice(tensor.dims());
         TensorShape slice_shape;
+        item.is_slice = true;
+        item.slice = TensorSlice(item.tensor.dims());
 
         OP_REQUIRES_OK(context, checkpoint::ParseShapeAndSlice(
-                                    shape_spec, &shape, &slice, &slice_shape));
-        OP_REQUIRES(context, slice_shape.IsSameSize(tensor.shape()),
+                                    shape_spec, &item.full_shape, &item.slice,
+                                    &slice_shape));
+        OP_REQUIRES(context, slice_shape.IsSameSize(item.tensor.shape()),
                     errors::InvalidArgument("Slice in shape_and_slice "
                                             "specification does not match the "
                                             "shape of the tensor to  save: ",
                                             shape_spec, ", tensor: ",
-                                            tensor.shape().DebugString()));
-
-        OP_REQUIRES_OK(context,
-                       writer.AddSlice(tensor_name, shape, slice, tensor));
-      } else {
-        OP_REQUIRES_OK(context, writer.Add(tensor_name, tensor));
+                                            item.tensor.shape().DebugString()));
       }
+    }
 
-      if (VLOG_IS_ON(5)) {
-        if (tensor.dtype() == DT_FLOAT) {
-          const float* t_data = tensor.flat<float>().data();
-          float min = std::numeric_limits<float>::infinity();
-          float max = -std::numeric_limits<float>::infinity();
-          double avg = 0.0;
-          for (int i = 0; i < tensor.NumElements(); ++i) {
-            if (t_data[i] < min) min = t_data[i];
-            if (t_data[i] > max) max = t_data[i];
-            avg += t_data[i];
-          }
-          VLOG(5) << " min " << min << " max " << max << " avg "
-                  << avg / tensor.NumElements() << " total elts "
-                  << tensor.NumElements();
+    BundleWriter::Options options;
+    std::shared_ptr<PendingSave> save;
+    {
+      mutex_lock l(mu_);
+      // At most one save per op is written in the background, so that
+      // staging copies use at most as much memory as the saved tensors.
+      if (pending_ != nullptr) {
+        pending_->done.WaitForNotification();
+        const Status status = pending_->status;
+        pending_ = nullptr;
+        OP_REQUIRES_OK(context, status);
+      }
+      if (IncrementalSaveEnabled()) {
+        options.fingerprint_tensors = true;
+        if (!last_prefix_.empty()) {
+          options.base_prefix =
+              SaveRegistry::Global()->TakeMergedPrefix(last_prefix_);
         }
+        last_prefix_ = prefix_string;
+      }
+      if (AsyncSaveEnabled()) {
+        save = std::make_shared<PendingSave>();
+        pending_ = save;
       }
+    }
 
-      VLOG(2) << "Done save of " << tensor_name;
+    if (save == nullptr) {
+      OP_REQUIRES_OK(context, WriteBundle(prefix_string, items, options));
+    } else {
+      // Training may update the saved variables in place as soon as this op
+      // returns, so the background write works on copies.
+      for (SaveItem& item : items) {
+        item.tensor = tensor::DeepCopy(item.tensor);
+      }
+      SaveRegistry::Global()->AddPending(prefix_string, save);
+      Env::Default()->SchedClosure(
+          [prefix_string, items = std::move(items), options, save]() {
+            Status status = WriteBundle(prefix_string, items, options);
+            if (!status.ok()) {
+              LOG(ERROR) << "Background save to " << prefix_string
+                         << " failed: " << status;
+            }
+            SaveRegistry::Global()->Done(prefix_string, save.get(),
+                                         std::move(status));
+          });
     }
-    OP_REQUIRES_OK(context, writer.Finish());
-    VLOG(1) << "Done BundleWriter, prefix_string: " << prefix_string;
 
     ResourceMgr* resource_manager = context->resource_manager();
     if (resource_manager != nullptr) {
@@ -182,6 +362,13 @@ class SaveV2 : public OpKernel {
       checkpoint_callback_manager->Unref();
     }
   }
+
+ private:
+  mutex mu_;
+  // The save of this op that is being written in the background, if any.
+  std::shared_ptr<PendingSave> pending_ TF_GUARDED_BY(mu_);
+  // The prefix this op saved to last, the base of its next incremental save.
+  string last_prefix_ TF_GUARDED_BY(mu_);
 };
 REGISTER_KERNEL_BUILDER(Name("SaveV2").Device(DEVICE_CPU), SaveV2);
 
@@ -205,6 +392,8 @@ class RestoreV2 : public OpKernel {
     if (!context->status().ok()) return;
 
     const string& prefix_string = prefix.scalar<tstring>()();
+    OP_REQUIRES_OK(context,
+                   SaveRegistry::Global()->WaitForPending(prefix_string));
 
     VLOG(2) << "Started Restore at prefix: " << prefix_string;
     // Intention: we plan to use the RestoreV2 op as a backward-compatible
@@ -287,9 +476,18 @@ class MergeV2Checkpoints : public OpKernel {
         absl::Span<const tstring>(checkpoint_prefixes.flat<tstring>());
     Env* env = Env::Default();
     const string& merged_prefix = destination_prefix.scalar<tstring>()();
+    for (const string& input_prefix : input_prefixes) {
+      OP_REQUIRES_OK(context,
+                     SaveRegistry::Global()->WaitForPending(input_prefix));
+    }
     OP_REQUIRES_OK(context,
                    tensorflow::MergeBundles(env, input_prefixes, merged_prefix,
                                             allow_missing_files_));
+    if (IncrementalSaveEnabled()) {
+      for (const string& input_prefix : input_prefixes) {
+        SaveRegistry::Global()->RecordMerge(input_prefix, merged_prefix);
+      }
+    }
 
     if (delete_old_dirs_) {
       const string merged_dir(io::Dirname(merged_prefix));
@@ -37,6 +37,7 @@ limitations under the License.
 #include "tensorflow/core/kernels/inplace_ops_functor.h"
 #include "tensorflow/core/kernels/scatter_nd_op.h"
 #include "tensorflow/core/kernels/scatter_nd_util.h"
+#include "tensorflow/core/kernels/segment_reduction_ops.h"
 #include "tensorflow/core/kernels/training_op_helpers.h"
 #include "tensorflow/core/kernels/variable_ops.h"
 #include "tensorflow/core/lib/strings/str_util.h"
@@ -1098,6 +1099,67 @@ Status DoScatterNdOnCpu(OpKernelContext* c, const Tensor& indices,
   return OkStatus();
 }
 
+// Returns true if the updates of a ScatterNd add or sub should be sorted and
+// summed per output slice on the GPU rather than applied with atomics: when
+// determinism is required, or when there are many updates per output slice.
+template <typename Index>
+bool UseSortedScatterNd(const Tensor& indices, const TensorShape& shape) {
+  if (indices.dims() < 1) return false;
+  const int64_t slice_dim =
+      indices.dims() > 1 ? indices.dim_size(indices.dims() - 1) : 1;
+  // Leave the unsupported ranks to DoScatterNdImpl, which reports them.
+  if (slice_dim < 1 || slice_dim > 7 || slice_dim > shape.dims()) return false;
+  int64_t num_slices = 1;
+  for (int i = 0; i < slice_dim; ++i) {
+    num_slices *= shape.dim_size(i);
+  }
+  const int64_t num_updates = indices.NumElements() / slice_dim;
+  // GpuRadixSort sorts at most int32 keys, and the out-of-bounds indices are
+  // mapped to the slice id num_slices.
+  if (num_updates > std::numeric_limits<int>::max() ||
+      num_slices >= std::numeric_limits<Index>::max()) {
+    return false;
+  }
+  return (OpDeterminismRequired() && !DisableScatterOpDeterminism()) ||
+         PreferSortedSegmentReduction(num_updates, num_slices);
+}
+
+// Runs a ScatterNd add or sub on the GPU with ScatterNdSortedFunctor, which is
+// deterministic. As on the GPU, out-of-bounds indices are ignored.
+template <typename T, typename Index, scatter_nd_op::UpdateOp Op>
+Status DoScatterNdSortedOnGpu(OpKernelContext* c, const Tensor& indices,
+                              const Tensor& updates, const TensorShape& shape,
+                              Tensor* out, bool allocate) {
+  int64_t slice_dim;
+  Index num_updates;
+  Index slice_size;
+  TF_RETURN_IF_ERROR(PrepareAndValidateInputs<Index>(
+      shape, indices, updates, &slice_dim, &num_updates, &slice_size));
+
+  if (allocate) {
+    TF_RETURN_IF_ERROR(c->allocate_temp(DataTypeToEnum<T>::value, shape, out));
+  } else {
+    CHECK_NOTNULL(out);  // Crash OK
+  }
+  if (shape.num_elements() == 0) {
+    return OkStatus();
+  }
+
+  // The sums of an add are written into a brand new tensor, which only needs
+  // to be zeroed out if there are none.
+  const bool sum_into_output = allocate && Op == scatter_nd_op::UpdateOp::ADD;
+  if (allocate && (!sum_into_output || num_updates == 0)) {
+    functor::SetZeroFunctor<GPUDevice, T> fill;
+    fill(c->eigen_device<GPUDevice>(), out->flat<T>());
+  }
+  functor::ScatterNdSortedFunctor<GPUDevice, T, Index, Op> functor;
+  return functor(
+      c, shape, slice_dim, /*output_is_zero=*/allocate,
+      indices.flat_inner_dims<Index>(),
+      updates.shaped<T, 2>({num_updates, slice_size}),
+      out->shaped<T, 2>({shape.num_elements() / slice_size, slice_size}));
+}
+
 #endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
 
 }  // namespace
@@ -1108,6 +1170,18 @@ Status DoScatterNd(OpKernelContext* c, const Tensor& indices,
                    const Tensor& updates, const TensorShape& shape, Tensor* out,
                    bool allocate, BadIndicesPolicy bad_indices_policy) {
 #if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+  // Floating-point adds are only deterministic if the updates of each output
+  // slice are summed in a fixed order.
+  if constexpr (std::is_same<Device, GPUDevice>::value &&
+                (Op == scatter_nd_op::UpdateOp::ADD ||
+                 Op == scatter_nd_op::UpdateOp::SUB) &&
+                !Eigen::NumTraits<T>::IsInteger &&
+                !Eigen::NumTraits<T>::IsComplex) {
+    if (UseSortedScatterNd<Index>(indices, shape)) {
+      return DoScatterNdSortedOnGpu<T, Index, Op>(c, indices, updates, shape,
+                                                  out, allocate);
+    }
+  }
   if (std::is_same<Device, GPUDevice>::value &&
       tensorflow::OpDeterminismRequired() && !DisableScatterOpDeterminism()) {
     return DoScatterNdOnCpu<T, Index, Op>(c, indices, updates, shape, out,
@@ -1184,6 +1258,25 @@ TF_CALL_GPU_NUMBER_TYPES(DECLARE_GPU_SPECS);
 TF_CALL_GPU_NUMBER_TYPES(DECLARE_GPU_SPECS_MIN_MAX);
 TF_CALL_COMPLEX_TYPES(DECLARE_GPU_SPECS);
 
+#define DECLARE_GPU_SORTED_SPECS_INDEX_OP(T, Index, op)                     \
+  template <>                                                               \
+  Status ScatterNdSortedFunctor<GPUDevice, T, Index, op>::operator()(       \
+      OpKernelContext* c, const TensorShape& output_shape, int slice_dim,   \
+      bool output_is_zero, typename TTypes<Index, 2>::ConstTensor Tindices, \
+      typename TTypes<T, 2>::ConstTensor Tupdates,                          \
+      typename TTypes<T, 2>::Tensor Toutput);                               \
+  extern template struct ScatterNdSortedFunctor<GPUDevice, T, Index, op>;
+
+#define DECLARE_GPU_SORTED_SPECS(T)                                            \
+  DECLARE_GPU_SORTED_SPECS_INDEX_OP(T, int32, scatter_nd_op::UpdateOp::ADD);   \
+  DECLARE_GPU_SORTED_SPECS_INDEX_OP(T, int32, scatter_nd_op::UpdateOp::SUB);   \
+  DECLARE_GPU_SORTED_SPECS_INDEX_OP(T, int64_t, scatter_nd_op::UpdateOp::ADD); \
+  DECLARE_GPU_SORTED_SPECS_INDEX_OP(T, int64_t, scatter_nd_op::UpdateOp::SUB)
+
+TF_CALL_GPU_NUMBER_TYPES(DECLARE_GPU_SORTED_SPECS);
+
+#undef DECLARE_GPU_SORTED_SPECS
+#undef DECLARE_GPU_SORTED_SPECS_INDEX_OP
 #undef DECLARE_GPU_SPECS_MIN_MAX
 #undef DECLARE_GPU_SPECS
 #undef DECLARE_GPU_SPECS_INDEX_MIN_MAX
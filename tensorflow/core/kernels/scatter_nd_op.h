@@ -56,6 +56,22 @@ struct ScatterNdFunctor {
       typename TTypes<T, 2>::Tensor Toutput);
 };
 
+// Functor used by ScatterOp to add (or subtract) the updates deterministically
+// on GPU: the updates are sorted by the output slice they point to, then the
+// updates of each slice are summed in a single pass, without atomics. This is
+// also faster than the atomic ScatterNdFunctor when many updates collide on
+// the same slices. Out-of-bounds indices are ignored. If `output_is_zero`, the
+// sums may be written into Toutput instead of added to it.
+template <typename Device, typename T, typename Index,
+          scatter_nd_op::UpdateOp op>
+struct ScatterNdSortedFunctor {
+  Status operator()(OpKernelContext* c, const TensorShape& output_shape,
+                    int slice_dim, bool output_is_zero,
+                    typename TTypes<Index, 2>::ConstTensor Tindices,
+                    typename TTypes<T, 2>::ConstTensor Tupdates,
+                    typename TTypes<T, 2>::Tensor Toutput);
+};
+
 // Scatter updates into indices in Tensor out.  The argument allocate
 // controls whether 'out' should be created.  If allocate is true,
 // *out will be updated to the scattered tensor upon successful completion.
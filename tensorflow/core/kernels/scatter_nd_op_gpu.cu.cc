@@ -20,6 +20,8 @@ limitations under the License.
 #include "unsupported/Eigen/CXX11/Tensor"  // from @eigen_archive
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/kernels/scatter_nd_op.h"
+#include "tensorflow/core/kernels/segment_reduction_ops_gpu.cu.h"
+#include "tensorflow/core/lib/core/bits.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/util/gpu_kernel_helper.h"
 
@@ -121,6 +123,41 @@ __global__ void ScatterNdOpKernel(
   }
 }
 
+// The maximum indices.shape[-1] supported by ScatterNd.
+constexpr int kMaxSliceDim = 7;
+
+// Writes the index of the output slice each index points to into slice_ids,
+// or num_slices if the index is out of bounds.
+template <typename Index>
+__global__ void ScatterNdSliceIdsKernel(
+    const Index* indices, const Eigen::array<int64, kMaxSliceDim> dims,
+    const Eigen::array<int64, kMaxSliceDim> strides, const int slice_dim,
+    const int64 num_indices, const Index num_slices, Index* slice_ids) {
+  GPU_1D_KERNEL_LOOP(index, num_indices) {
+    int64 slice = 0;
+    bool out_of_bounds = false;
+    for (int dim = 0; dim < slice_dim; ++dim) {
+      const Index ix_d =
+          internal::SubtleMustCopy(ldg(indices + slice_dim * index + dim));
+      out_of_bounds |= !FastBoundsCheck(ix_d, dims[dim]);
+      slice += ix_d * strides[dim];
+    }
+    slice_ids[index] = out_of_bounds ? num_slices : static_cast<Index>(slice);
+  }
+}
+
+template <typename T, scatter_nd_op::UpdateOp op>
+__global__ void ScatterNdAccumulateKernel(const int64 size, const T* sums,
+                                          T* out) {
+  GPU_1D_KERNEL_LOOP(i, size) {
+    if (op == scatter_nd_op::UpdateOp::ADD) {
+      out[i] += sums[i];
+    } else {
+      out[i] -= sums[i];
+    }
+  }
+}
+
 namespace functor {
 
 // Functor used by ScatterOp to do the computations.
@@ -162,6 +199,89 @@ struct ScatterNdFunctor<GPUDevice, T, Index, op, IXDIM> {
   }
 };
 
+template <typename T, typename Index, scatter_nd_op::UpdateOp op>
+struct ScatterNdSortedFunctor<GPUDevice, T, Index, op> {
+  static_assert(op == scatter_nd_op::UpdateOp::ADD ||
+                    op == scatter_nd_op::UpdateOp::SUB,
+                "Only ADD and SUB can be computed as segment sums.");
+
+  Status operator()(OpKernelContext* c, const TensorShape& output_shape,
+                    int slice_dim, bool output_is_zero,
+                    typename TTypes<Index, 2>::ConstTensor Tindices,
+                    typename TTypes<T, 2>::ConstTensor Tupdates,
+                    typename TTypes<T, 2>::Tensor Toutput) {
+    const GPUDevice& d = c->eigen_device<GPUDevice>();
+    const Index num_updates = Tupdates.dimension(0);
+    const Index slice_size = Tupdates.dimension(1);
+    const Index num_slices = Toutput.dimension(0);
+    if (num_updates == 0 || slice_size == 0) return OkStatus();
+
+    Eigen::array<int64, kMaxSliceDim> dims;
+    Eigen::array<int64, kMaxSliceDim> strides;
+    int64 stride = 1;
+    for (int dim = slice_dim - 1; dim >= 0; --dim) {
+      dims[dim] = output_shape.dim_size(dim);
+      strides[dim] = stride;
+      stride *= dims[dim];
+    }
+
+    Tensor slice_ids;
+    TF_RETURN_IF_ERROR(c->allocate_temp(DataTypeToEnum<Index>::value,
+                                        TensorShape({num_updates}),
+                                        &slice_ids));
+    GpuLaunchConfig config = GetGpuLaunchConfig(num_updates, d);
+    TF_RETURN_IF_ERROR(GpuLaunchKernel(
+        ScatterNdSliceIdsKernel<Index>, config.block_count,
+        config.thread_per_block, 0, d.stream(), Tindices.data(), dims,
+        strides, slice_dim, static_cast<int64>(num_updates), num_slices,
+        slice_ids.flat<Index>().data()));
+
+    // The slice ids are in [0, num_slices], so only their low bits need to be
+    // sorted.
+    Tensor sorted_slice_ids;
+    TF_RETURN_IF_ERROR(c->allocate_temp(DataTypeToEnum<Index>::value,
+                                        TensorShape({num_updates}),
+                                        &sorted_slice_ids));
+    Tensor sorted_updates;
+    TF_RETURN_IF_ERROR(c->allocate_temp(DataTypeToEnum<Index>::value,
+                                        TensorShape({num_updates}),
+                                        &sorted_updates));
+    TF_RETURN_IF_ERROR(GpuRadixSort(
+        c, num_updates, /*keys_in=*/slice_ids.flat<Index>().data(),
+        /*keys_out=*/sorted_slice_ids.flat<Index>().data(),
+        /*indices_in=*/static_cast<const Index*>(nullptr),
+        /*indices_out=*/sorted_updates.flat<Index>().data(),
+        /*num_bits=*/Log2Ceiling64(static_cast<int64>(num_slices) + 1)));
+
+    // Sum the updates of each slice, into the output if it starts at zero.
+    const bool sum_into_output =
+        output_is_zero && op == scatter_nd_op::UpdateOp::ADD;
+    Tensor sums;
+    if (!sum_into_output) {
+      TF_RETURN_IF_ERROR(c->allocate_temp(DataTypeToEnum<T>::value,
+                                          TensorShape({num_slices, slice_size}),
+                                          &sums));
+    }
+    T* sums_data = sum_into_output ? Toutput.data() : sums.flat<T>().data();
+    using Treduce = typename ReduceType<functor::Sum, T>::type;
+    using Tweights = typename RealTypeIfComplex<T>::type;
+    TF_RETURN_IF_ERROR(SegmentReduceGPU<Treduce>(
+        c, num_updates, slice_size, num_slices, functor::Sum(),
+        /*initial_value=*/T(0), /*empty_segment_value=*/T(0),
+        /*is_mean=*/false, /*is_sqrtn=*/false, /*input=*/Tupdates.data(),
+        /*segment_ids=*/sorted_slice_ids.flat<Index>().data(),
+        /*indices=*/sorted_updates.flat<Index>().data(),
+        /*weights=*/static_cast<Tweights*>(nullptr), sums_data));
+    if (sum_into_output) return OkStatus();
+
+    config = GetGpuLaunchConfig(Toutput.size(), d);
+    return GpuLaunchKernel(ScatterNdAccumulateKernel<T, op>, config.block_count,
+                           config.thread_per_block, 0, d.stream(),
+                           static_cast<int64>(Toutput.size()), sums_data,
+                           Toutput.data());
+  }
+};
+
 }  // namespace functor
 
 #define DECLARE_GPU_SPECS_INDEX_OP_IXDIM(T, Index, op, IXDIM) \
@@ -193,6 +313,16 @@ struct ScatterNdFunctor<GPUDevice, T, Index, op, IXDIM> {
   DECLARE_GPU_SPECS_INDEX_MINMAX(T, int32); \
   DECLARE_GPU_SPECS_INDEX_MINMAX(T, int64)
 
+#define DECLARE_GPU_SORTED_SPECS_INDEX(T, Index)          \
+  template struct functor::ScatterNdSortedFunctor<        \
+      GPUDevice, T, Index, scatter_nd_op::UpdateOp::ADD>; \
+  template struct functor::ScatterNdSortedFunctor<        \
+      GPUDevice, T, Index, scatter_nd_op::UpdateOp::SUB>;
+
+#define DECLARE_GPU_SORTED_SPECS(T)         \
+  DECLARE_GPU_SORTED_SPECS_INDEX(T, int32); \
+  DECLARE_GPU_SORTED_SPECS_INDEX(T, int64)
+
 TF_CALL_int32(DECLARE_GPU_SPECS);
 TF_CALL_int32(DECLARE_GPU_SPECS_MINMAX);
 TF_CALL_int64(DECLARE_GPU_SPECS);
@@ -200,7 +330,10 @@ TF_CALL_int64(DECLARE_GPU_SPECS_MINMAX);
 TF_CALL_GPU_NUMBER_TYPES(DECLARE_GPU_SPECS);
 TF_CALL_GPU_NUMBER_TYPES(DECLARE_GPU_SPECS_MINMAX);
 TF_CALL_COMPLEX_TYPES(DECLARE_GPU_SPECS);
+TF_CALL_GPU_NUMBER_TYPES(DECLARE_GPU_SORTED_SPECS);
 
+#undef DECLARE_GPU_SORTED_SPECS
+#undef DECLARE_GPU_SORTED_SPECS_INDEX
 #undef DECLARE_GPU_SPECS
 #undef DECLARE_GPU_SPECS_MINMAX
 #undef DECLARE_GPU_SPECS_INDEX
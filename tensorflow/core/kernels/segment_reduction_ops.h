@@ -78,6 +78,17 @@ struct ReduceOpIsAssociative<functor::Max, T> : std::true_type {};
 template <typename T>
 struct ReduceOpIsAssociative<functor::Min, T> : std::true_type {};
 
+// Returns true if reducing `num_rows` rows into `num_segments` segments with
+// atomics would contend heavily on the output rows, i.e. if there are many
+// rows per segment on average. Sorting the rows by segment and reducing each
+// segment in a single pass is then faster, and also deterministic.
+inline bool PreferSortedSegmentReduction(int64_t num_rows,
+                                         int64_t num_segments) {
+  constexpr int64_t kMinRows = 1 << 14;
+  constexpr int64_t kMinRowsPerSegment = 32;
+  return num_rows >= kMinRows && num_rows >= kMinRowsPerSegment * num_segments;
+}
+
 typedef Eigen::GpuDevice GPUDevice;
 // Functor for SegmentReductionGPUOp.
 // output_rows: the number of output segments (unique segment ids in
@@ -859,10 +859,23 @@ struct UnsortedSegmentFunctor<GPUDevice, T, Index, InitialValueF, ReductionF> {
       return;
     }
 
+    // Launch kernel(s) to compute unsorted segment reduction.
+    // Notes:
+    // *) 'data_size' is the total number of elements to process.
+    // *) 'segment_ids.shape' is a prefix of data's shape.
+    // *) 'input_outer_dim_size' is the total number of segments to process.
+    const Index input_outer_dim_size = unsorted_segment_ids.dimension(0);
+    const Index input_inner_dim_size = data.dimension(1);
+    const Index output_outer_dim_size = output.dimension(0);
+    const Index num_segments = output.size() / input_inner_dim_size;
+
+    // The sorted (deterministic) kernels are also used when many rows collide
+    // on each segment, since the atomic kernel then serializes on the output.
     bool use_deterministic_kernels =
         UseDeterministicSegmentReductions() ||
         (!ReduceOpIsAssociative<ReductionF, T>::value &&
-         OpDeterminismRequired());
+         OpDeterminismRequired()) ||
+        PreferSortedSegmentReduction(input_outer_dim_size, num_segments);
 
     bool determinism_requirement_met =
         use_deterministic_kernels ||
@@ -875,16 +888,6 @@ struct UnsortedSegmentFunctor<GPUDevice, T, Index, InitialValueF, ReductionF> {
             "Deterministic GPU implementation of unsorted segment reduction op"
             " not available."));
 
-    // Launch kernel(s) to compute unsorted segment reduction.
-    // Notes:
-    // *) 'data_size' is the total number of elements to process.
-    // *) 'segment_ids.shape' is a prefix of data's shape.
-    // *) 'input_outer_dim_size' is the total number of segments to process.
-    const Index input_outer_dim_size = unsorted_segment_ids.dimension(0);
-    const Index input_inner_dim_size = data.dimension(1);
-    const Index output_outer_dim_size = output.dimension(0);
-    const Index num_segments = output.size() / input_inner_dim_size;
-
     // TODO(benbarsdell): If there are no performance concerns with the new
     // deterministic kernels, remove this runtime check and the old
     // non-deterministic kernels.
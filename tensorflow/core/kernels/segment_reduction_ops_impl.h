@@ -51,8 +51,10 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/platform/bfloat16.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/prefetch.h"
 #include "tensorflow/core/util/determinism.h"
 #include "tensorflow/core/util/util.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 #if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
 #include "tensorflow/core/common_runtime/gpu/gpu_event_mgr.h"
@@ -618,33 +620,20 @@ class SparseSegmentReductionOpBase : public OpKernel {
                 errors::InvalidArgument("segment ids must be >= 0"));
     auto output_flat = output->flat_outer_dims<T>();
 
-    // If we use DT_BFLOAT16 or DT_HALF, we need to use DT_FLOAT for
-    // accumulation. We create a temp tensor to perform this accumulation for
-    // every segment.
-    Tensor temp;
-    if (input.dtype() == DT_BFLOAT16 || input.dtype() == DT_HALF) {
-      TensorShape temp_shape = output_shape;
-      OP_REQUIRES_OK(context, temp_shape.SetDimWithStatus(/*d=*/0, /*size=*/1));
-      temp = tensorflow::Tensor(DT_FLOAT, temp_shape);
-    }
-    auto temp_flat = temp.flat_outer_dims<float>();
-
-    int64_t start = 0, end = 1;
-    // Index from which the output is not initialized.
-    SegmentId uninitialized_index = 0;
-    SegmentId out_index = internal::SubtleMustCopy(segment_vec(start));
-
-    while (true) {
+    // Split the indices into segments, i.e. runs of equal segment ids. Segment
+    // k reduces the rows at indices [segment_starts[k], segment_starts[k + 1])
+    // into output row out_indices[k].
+    std::vector<int64_t> segment_starts = {0};
+    std::vector<SegmentId> out_indices;
+    SegmentId out_index = internal::SubtleMustCopy(segment_vec(0));
+    for (int64_t end = 1;; ++end) {
       // We initialize next_index to 0 to avoid "warning: 'next_index' may be
       // used uninitialized in this function" in the Mac build (since the
       // compiler isn't smart enough to realize the code is safe).
       SegmentId next_index = 0;
       if (end < num_indices) {
         next_index = internal::SubtleMustCopy(segment_vec(end));
-        if (out_index == next_index) {
-          ++end;
-          continue;
-        }
+        if (out_index == next_index) continue;
         // We have a new segment here.  Verify that the segment ids are growing.
         OP_REQUIRES(context, out_index < next_index,
                     errors::InvalidArgument("segment ids are not increasing"));
@@ -656,34 +645,95 @@ class SparseSegmentReductionOpBase : public OpKernel {
               "Segment id ", out_index, " out of range [0, ", output_rows,
               "), possibly because 'segment_ids' input is not sorted."));
 
-      // If there is a gap between two indices, we need to set that gap to the
-      // default value.
-      if (out_index > uninitialized_index) {
-        Eigen::DSizes<Eigen::DenseIndex, 2> gap_slice_shape(
-            out_index - uninitialized_index, num_col);
-        Eigen::TensorMap<Eigen::Tensor<T, 2, Eigen::RowMajor>, Eigen::Unaligned>
-            gap_slice(&output_flat(uninitialized_index, 0), gap_slice_shape);
-        gap_slice.setConstant(default_value_);
+      segment_starts.push_back(end);
+      out_indices.push_back(out_index);
+      if (end == num_indices) break;
+      out_index = next_index;
+    }
+    const int64_t num_segments = out_indices.size();
+
+    // The segments are reduced in blocks of about the same number of rows, so
+    // that many short segments and a few long ones are spread evenly over the
+    // threads.
+    const auto& worker_threads =
+        *context->device()->tensorflow_cpu_worker_threads();
+    const int num_threads = std::max(worker_threads.num_threads, 1);
+    const int64_t num_blocks =
+        std::min<int64_t>(num_segments, kBlocksPerThread * num_threads);
+    const auto block_first_segment = [&](int64_t block) -> int64_t {
+      if (block == num_blocks) return num_segments;
+      const int64_t first_row = block * num_indices / num_blocks;
+      return std::lower_bound(segment_starts.begin(),
+                              segment_starts.end() - 1, first_row) -
+             segment_starts.begin();
+    };
+
+    // If we use DT_BFLOAT16 or DT_HALF, we need to use DT_FLOAT for
+    // accumulation. We create a temp tensor to perform this accumulation for
+    // every segment, with a row per block.
+    Tensor temp;
+    if (input.dtype() == DT_BFLOAT16 || input.dtype() == DT_HALF) {
+      TensorShape temp_shape = output_shape;
+      OP_REQUIRES_OK(context,
+                     temp_shape.SetDimWithStatus(/*d=*/0, /*size=*/num_blocks));
+      temp = tensorflow::Tensor(DT_FLOAT, temp_shape);
+    }
+    auto temp_flat = temp.flat_outer_dims<float>();
+    const bool use_temp = temp.NumElements() > 0;
+
+    // The position of the first out of range index in each block, if any.
+    std::vector<int64_t> bad_positions(num_blocks, -1);
+    auto reduce_blocks = [&](int64_t begin_block, int64_t end_block) {
+      for (int64_t block = begin_block; block < end_block; ++block) {
+        const int64_t end_segment = block_first_segment(block + 1);
+        for (int64_t k = block_first_segment(block); k < end_segment; ++k) {
+          const int64_t start = segment_starts[k];
+          const int64_t end = segment_starts[k + 1];
+          // If there is a gap between two indices, we need to set that gap to
+          // the default value.
+          const SegmentId uninitialized_index =
+              k == 0 ? 0 : out_indices[k - 1] + 1;
+          if (out_indices[k] > uninitialized_index) {
+            Eigen::DSizes<Eigen::DenseIndex, 2> gap_slice_shape(
+                out_indices[k] - uninitialized_index, num_col);
+            Eigen::TensorMap<Eigen::Tensor<T, 2, Eigen::RowMajor>,
+                             Eigen::Unaligned>
+                gap_slice(&output_flat(uninitialized_index, 0),
+                          gap_slice_shape);
+            gap_slice.setConstant(default_value_);
+          }
+
+          // Load the first rows of the next segment while this one is
+          // reduced.
+          PrefetchRows(input_flat, indices_vec, end,
+                       std::min(end + kNumPrefetchRows, num_indices));
+
+          auto out = output_flat.template chip<0>(out_indices[k]);
+          auto temp_row = temp_flat.template chip<0>(use_temp ? block : 0);
+          const int bad_offset = Reduce<T, Index>(
+              input_flat, indices_vec, start, end - start, out, temp_row);
+          if (bad_offset >= 0) {
+            bad_positions[block] = start + bad_offset;
+            break;
+          }
+        }
       }
+    };
+    const int64_t cost_per_block =
+        std::max<int64_t>(num_indices / num_blocks, 1) * num_col;
+    Shard(worker_threads.num_threads, worker_threads.workers, num_blocks,
+          cost_per_block, reduce_blocks);
 
-      auto out = output_flat.template chip<0>(out_index);
-      auto temp = temp_flat.template chip<0>(0);
-      const int bad_offset = Reduce<T, Index>(input_flat, indices_vec, start,
-                                              end - start, out, temp);
-      OP_REQUIRES(context, bad_offset < 0,
+    for (const int64_t bad_position : bad_positions) {
+      OP_REQUIRES(context, bad_position < 0,
                   errors::InvalidArgument(
-                      "Bad: indices[", start + bad_offset,
-                      "] == ", indices_vec(start + bad_offset),
-                      " out of range [0, ", input_flat.dimension(0), ")"));
-
-      start = end;
-      ++end;
-      uninitialized_index = out_index + 1;
-      out_index = next_index;
-      if (end > num_indices) break;
+                      "Bad: indices[", bad_position,
+                      "] == ", indices_vec(bad_position), " out of range [0, ",
+                      input_flat.dimension(0), ")"));
     }
 
     // Fill the gap at the end with the default value.
+    const SegmentId uninitialized_index = out_indices.back() + 1;
     if (uninitialized_index < output_rows) {
       Eigen::DSizes<Eigen::DenseIndex, 2> gap_slice_shape(
           output_rows - uninitialized_index, num_col);
@@ -694,6 +744,33 @@ class SparseSegmentReductionOpBase : public OpKernel {
   }
 
  private:
+  // The number of rows gathered from `input` to prefetch ahead of the
+  // reduction, if they are small enough for the whole rows to be prefetched.
+  static constexpr int64_t kNumPrefetchRows = 8;
+  static constexpr int64_t kMaxPrefetchRowBytes = 1024;
+  static constexpr int64_t kPrefetchStrideBytes = 64;
+  // The number of blocks of segments per thread, so that the threads that
+  // are done early can take over more blocks.
+  static constexpr int64_t kBlocksPerThread = 4;
+
+  void PrefetchRows(const typename TTypes<T>::ConstMatrix& input_flat,
+                    const typename TTypes<Index>::ConstVec& indices_vec,
+                    int64_t start, int64_t end) {
+    const int64_t row_bytes = input_flat.dimension(1) * sizeof(T);
+    if (row_bytes > kMaxPrefetchRowBytes) return;
+    for (int64_t i = start; i < end; ++i) {
+      const Index index = indices_vec(i);
+      // Out of range indices are reported by Reduce().
+      if (!FastBoundsCheck(index, input_flat.dimension(0))) continue;
+      const char* row = reinterpret_cast<const char*>(input_flat.data()) +
+                        static_cast<int64_t>(index) * row_bytes;
+      for (int64_t offset = 0; offset < row_bytes;
+           offset += kPrefetchStrideBytes) {
+        port::prefetch<port::PREFETCH_HINT_T0>(row + offset);
+      }
+    }
+  }
+
   const DataType dtidx_;
 
   template <typename Tin>
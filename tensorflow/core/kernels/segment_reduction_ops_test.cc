@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 
 #include <functional>
+#include <random>
 #include <vector>
 
 #include "tensorflow/core/common_runtime/device.h"
@@ -181,6 +182,66 @@ BM_Reduce_Arg(64, 32, 2);
 BM_Reduce_Arg(4096, 32, 2);
 BM_Reduce_Arg(4096, 128, 2);
 
+// Reduces the rows of a {vocab_size, num_cols} table at ids with a skewed
+// distribution, as in embedding lookups, into segments whose lengths vary
+// around `segment_size`.
+static void BM_SparseSegmentReduction(::testing::benchmark::State& state,
+                                      const string& reduction, int vocab_size,
+                                      int num_cols, int segment_size) {
+  Graph* g = new Graph(OpRegistry::Global());
+
+  const int kNumSegments = 4096;
+  std::mt19937 gen(42);
+  std::uniform_int_distribution<int> length_dist(1, 2 * segment_size - 1);
+  std::uniform_real_distribution<double> id_dist(0.0, 1.0);
+  std::vector<int32> ids;
+  std::vector<int32> segment_ids;
+  for (int segment = 0; segment < kNumSegments; ++segment) {
+    const int length = length_dist(gen);
+    for (int i = 0; i < length; ++i) {
+      const double u = id_dist(gen);
+      ids.push_back(static_cast<int32>(u * u * u * (vocab_size - 1)));
+      segment_ids.push_back(segment);
+    }
+  }
+
+  const int64_t num_indices = ids.size();
+  Tensor indices(DT_INT32, TensorShape({num_indices}));
+  std::copy(ids.begin(), ids.end(), indices.flat<int32>().data());
+  Tensor segments(DT_INT32, TensorShape({num_indices}));
+  std::copy(segment_ids.begin(), segment_ids.end(),
+            segments.flat<int32>().data());
+  Tensor input(DT_FLOAT, TensorShape({vocab_size, num_cols}));
+  input.flat<float>().setRandom();
+
+  Node* node;
+  TF_CHECK_OK(NodeBuilder(g->NewName("n"), reduction)
+                  .Input(test::graph::Constant(g, input))
+                  .Input(test::graph::Constant(g, indices))
+                  .Input(test::graph::Constant(g, segments))
+                  .Attr("T", DT_FLOAT)
+                  .Finalize(g, &node));
+
+  test::Benchmark("cpu", g, /*old_benchmark_api*/ false).Run(state);
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                          num_indices * num_cols * sizeof(float));
+}
+
+#define BM_SparseReduce(O, V, C, S)                                          \
+  static void BM_##O##_##V##_##C##_##S(::testing::benchmark::State& state) { \
+    BM_SparseSegmentReduction(state, #O, V, C, S);                           \
+  }                                                                          \
+  BENCHMARK(BM_##O##_##V##_##C##_##S)->UseRealTime();
+
+#define BM_SparseReduce_Arg(V, C, S)          \
+  BM_SparseReduce(SparseSegmentSum, V, C, S); \
+  BM_SparseReduce(SparseSegmentMean, V, C, S);
+
+BM_SparseReduce_Arg(100000, 16, 4);
+BM_SparseReduce_Arg(100000, 64, 4);
+BM_SparseReduce_Arg(100000, 256, 4);
+BM_SparseReduce_Arg(100000, 64, 64);
+
 template <DataType T>
 static void SparseSegmentMeanGradHelper(::testing::benchmark::State& state,
                                         float uniqueness, int size) {
@@ -158,6 +158,9 @@ RecvOp::RecvOp(OpKernelConstruction* ctx) : AsyncOpKernel(ctx) {
   if (!ctx->GetAttr("_hostmem_sendrecv", &hostmem_sendrecv_).ok()) {
     hostmem_sendrecv_ = false;
   }
+  if (!ctx->GetAttr("_variable_read", &variable_read_).ok()) {
+    variable_read_ = false;
+  }
 }
 
 string RecvOp::TraceString(const OpKernelContext& ctx, bool verbose) const {
@@ -203,6 +206,7 @@ void RecvOp::ComputeAsync(OpKernelContext* ctx, DoneCallback done) {
   args.device_context = ctx->op_device_context();
   args.alloc_attrs = ctx->output_alloc_attr(0);
   args.cancellation_manager = ctx->cancellation_manager();
+  args.is_variable_read = variable_read_;
 
   FrameAndIter frame_iter = GetFrameAndIter(ctx, hostmem_sendrecv_);
   if (frame_iter == FrameAndIter(0, 0)) {
@@ -17,6 +17,7 @@ limitations under the License.
 #include <assert.h>
 
 #include <limits>
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -270,6 +271,55 @@ StringPiece KeyedDenseTensorColumn<StringPiece>::Feature(
   return tensor_.matrix<tstring>()(batch, n);
 }
 
+// ProductIterator generates cartesian products based on indices.
+template <typename InternalType>
+class ProductIterator {
+ public:
+  explicit ProductIterator(
+      const std::vector<std::unique_ptr<ColumnInterface<InternalType>>>&
+          columns,
+      int64_t batch_index)
+      : columns_(columns), batch_index_(batch_index) {
+    next_permutation_.resize(columns_.size(), 0);
+    // Sets has_next_ to false if any feature column has 0 features.
+    has_next_ = true;
+    for (int i = 0; i < columns_.size(); i++) {
+      if (columns_[i]->FeatureCount(batch_index_) == 0) {
+        has_next_ = false;
+        break;
+      }
+    }
+  }
+
+  std::vector<int> Next() {
+    std::vector<int> permutation(next_permutation_);
+
+    // Generates next permutation, if available.
+    bool carry = true;
+    for (int i = next_permutation_.size() - 1; i >= 0; i--) {
+      if (carry) {
+        next_permutation_[i] = next_permutation_[i] + 1;
+      }
+      if (next_permutation_[i] == columns_[i]->FeatureCount(batch_index_)) {
+        next_permutation_[i] = 0;
+      } else {
+        carry = false;
+        break;
+      }
+    }
+    has_next_ = !carry;
+    return permutation;
+  }
+
+  bool HasNext() { return has_next_; }
+
+ private:
+  bool has_next_;
+  const std::vector<std::unique_ptr<ColumnInterface<InternalType>>>& columns_;
+  const int64_t batch_index_;
+  std::vector<int> next_permutation_;
+};
+
 // Updates Output tensors with sparse crosses.
 template <typename OutType>
 class OutputUpdater {
@@ -321,11 +371,91 @@ class StringCrosser {
     return absl::StrJoin(cross_vec, k_feature_separator_);
   }
 
+  // Writes the crosses of the row `batch_index` to `updater`.
+  void GenerateRow(const int64_t batch_index, bool unused_strong_hash,
+                   const OutputUpdater<tstring>& updater) const {
+    ProductIterator<InternalType> product_iterator(columns_, batch_index);
+    int64_t cross_count = 0;
+    while (product_iterator.HasNext()) {
+      const auto permutation = product_iterator.Next();
+      updater.Update(batch_index, cross_count,
+                     Generate(batch_index, permutation, false));
+      cross_count++;
+    }
+  }
+
  private:
   const std::vector<std::unique_ptr<ColumnInterface<InternalType>>>& columns_;
   const tstring k_feature_separator_;
 };
 
+// Writes the hashed crosses of the row `batch_index` to `updater`, in the
+// order of `ProductIterator`. The features of the row are hashed once, and
+// the fingerprint of the leading features of a cross is shared by all the
+// crosses with the same leading features, so that a cross costs a single
+// `FingerprintCat64` on average. If `hash_key` is set, the features are
+// concatenated to it, otherwise to the feature of the first column.
+void GenerateHashedCrosses(
+    const std::vector<std::unique_ptr<ColumnInterface<int64_t>>>& columns,
+    const int64_t batch_index, bool strong_hash,
+    const std::optional<uint64> hash_key, const int64_t num_buckets,
+    const OutputUpdater<int64_t>& updater) {
+  const int num_columns = columns.size();
+  if (num_columns == 0) return;
+  gtl::InlinedVector<int64_t, 8> feature_counts(num_columns);
+  gtl::InlinedVector<int64_t, 8> feature_offsets(num_columns + 1, 0);
+  for (int i = 0; i < num_columns; ++i) {
+    feature_counts[i] = columns[i]->FeatureCount(batch_index);
+    // If one column is missing any feature, there won't be any cross.
+    if (feature_counts[i] == 0) return;
+    feature_offsets[i + 1] = feature_offsets[i] + feature_counts[i];
+  }
+  gtl::InlinedVector<uint64, 32> features(feature_offsets[num_columns]);
+  for (int i = 0; i < num_columns; ++i) {
+    for (int64_t n = 0; n < feature_counts[i]; ++n) {
+      features[feature_offsets[i] + n] =
+          columns[i]->Feature(batch_index, n, strong_hash);
+    }
+  }
+
+  // `prefix_hashes[i]` is the fingerprint of the features of
+  // `permutation[0..i]`.
+  gtl::InlinedVector<int64_t, 8> permutation(num_columns, 0);
+  gtl::InlinedVector<uint64, 8> prefix_hashes(num_columns);
+  auto update_prefix_hashes = [&](int first_column) {
+    for (int i = first_column; i < num_columns; ++i) {
+      const uint64 feature = features[feature_offsets[i] + permutation[i]];
+      if (i > 0) {
+        prefix_hashes[i] = FingerprintCat64(prefix_hashes[i - 1], feature);
+      } else if (hash_key.has_value()) {
+        prefix_hashes[i] = FingerprintCat64(*hash_key, feature);
+      } else {
+        prefix_hashes[i] = feature;
+      }
+    }
+  };
+  update_prefix_hashes(0);
+  int64_t cross_count = 0;
+  while (true) {
+    const uint64 hashed_output = prefix_hashes[num_columns - 1];
+    // The output is int64 based on the number of buckets. To prevent negative
+    // output without buckets we take modulo to max int64.
+    updater.Update(batch_index, cross_count,
+                   num_buckets > 0
+                       ? hashed_output % num_buckets
+                       : hashed_output % std::numeric_limits<int64_t>::max());
+    cross_count++;
+    // Advances to the next permutation, the last column varying fastest.
+    int i = num_columns - 1;
+    while (i >= 0 && ++permutation[i] == feature_counts[i]) {
+      permutation[i] = 0;
+      --i;
+    }
+    if (i < 0) break;
+    update_prefix_hashes(i);
+  }
+}
+
 // Generates the sparse crosses as nested hash to avoid string manipulations.
 class HashCrosser {
  public:
@@ -335,22 +465,12 @@ class HashCrosser {
       const tstring k_feature_separator_unused)
       : columns_(columns), num_buckets_(num_buckets), hash_key_(hash_key) {}
 
-  int64_t Generate(const int64_t batch_index,
-                   const std::vector<int>& permutation,
-                   bool unused_strong_hash) const {
-    // Do the fingerprint concatenation on uint64.
-    uint64 hashed_output = hash_key_;
-    for (size_t i = 0; i < permutation.size(); ++i) {
-      uint64 hash_i = columns_[i]->Feature(batch_index, permutation[i], false);
-      hashed_output = FingerprintCat64(hashed_output, hash_i);
-    }
-    // The return value is int64 based on the number of buckets.
-    if (num_buckets_ > 0) {
-      return hashed_output % num_buckets_;
-    } else {
-      // To prevent negative output we take modulo to max int64.
-      return hashed_output % std::numeric_limits<int64_t>::max();
-    }
+  // Writes the crosses of the row `batch_index` to `updater`. The fingerprint
+  // concatenation is done on uint64, starting from `hash_key`.
+  void GenerateRow(const int64_t batch_index, bool unused_strong_hash,
+                   const OutputUpdater<int64_t>& updater) const {
+    GenerateHashedCrosses(columns_, batch_index, /*strong_hash=*/false,
+                          hash_key_, num_buckets_, updater);
   }
 
  private:
@@ -368,24 +488,12 @@ class HashCrosserV2 {
       const tstring k_feature_separator_unused)
       : columns_(columns), num_buckets_(num_buckets) {}
 
-  int64_t Generate(const int64_t batch_index,
-                   const std::vector<int>& permutation,
-                   bool strong_hash) const {
-    // Do the fingerprint concatenation on uint64.
-    uint64 hashed_output =
-        columns_[0]->Feature(batch_index, permutation[0], strong_hash);
-    for (size_t i = 1; i < permutation.size(); ++i) {
-      uint64 hash_i =
-          columns_[i]->Feature(batch_index, permutation[i], strong_hash);
-      hashed_output = FingerprintCat64(hashed_output, hash_i);
-    }
-    // The return value is int64 based on the number of buckets.
-    if (num_buckets_ > 0) {
-      return hashed_output % num_buckets_;
-    } else {
-      // To prevent negative output we take modulo to max int64.
-      return hashed_output % std::numeric_limits<int64_t>::max();
-    }
+  // Writes the crosses of the row `batch_index` to `updater`. The fingerprint
+  // concatenation is done on uint64, starting from the first feature.
+  void GenerateRow(const int64_t batch_index, bool strong_hash,
+                   const OutputUpdater<int64_t>& updater) const {
+    GenerateHashedCrosses(columns_, batch_index, strong_hash,
+                          /*hash_key=*/std::nullopt, num_buckets_, updater);
   }
 
  private:
@@ -393,55 +501,6 @@ class HashCrosserV2 {
   const int64_t num_buckets_;
 };
 
-// ProductIterator generates cartesian products based on indices.
-template <typename InternalType>
-class ProductIterator {
- public:
-  explicit ProductIterator(
-      const std::vector<std::unique_ptr<ColumnInterface<InternalType>>>&
-          columns,
-      int64_t batch_index)
-      : columns_(columns), batch_index_(batch_index) {
-    next_permutation_.resize(columns_.size(), 0);
-    // Sets has_next_ to false if any feature column has 0 features.
-    has_next_ = true;
-    for (int i = 0; i < columns_.size(); i++) {
-      if (columns_[i]->FeatureCount(batch_index_) == 0) {
-        has_next_ = false;
-        break;
-      }
-    }
-  }
-
-  std::vector<int> Next() {
-    std::vector<int> permutation(next_permutation_);
-
-    // Generates next permutation, if available.
-    bool carry = true;
-    for (int i = next_permutation_.size() - 1; i >= 0; i--) {
-      if (carry) {
-        next_permutation_[i] = next_permutation_[i] + 1;
-      }
-      if (next_permutation_[i] == columns_[i]->FeatureCount(batch_index_)) {
-        next_permutation_[i] = 0;
-      } else {
-        carry = false;
-        break;
-      }
-    }
-    has_next_ = !carry;
-    return permutation;
-  }
-
-  bool HasNext() { return has_next_; }
-
- private:
-  bool has_next_;
-  const std::vector<std::unique_ptr<ColumnInterface<InternalType>>>& columns_;
-  const int64_t batch_index_;
-  std::vector<int> next_permutation_;
-};
-
 template <bool HASHED_OUTPUT, typename InternalType>
 struct CrossTraits;
 
@@ -785,16 +844,9 @@ class SparseCrossOp : public OpKernel {
 
     typename CrossTraits<HASHED_OUTPUT, InternalType>::Updater updater(
         output_start_indices, indices_out, values_out);
-    auto do_work = [&columns, crosser, updater](int64_t begin, int64_t end) {
-      for (int b = begin; b < end; b++) {
-        ProductIterator<InternalType> product_iterator(columns, b);
-        int64_t cross_count = 0;
-        while (product_iterator.HasNext()) {
-          const auto permutation = product_iterator.Next();
-          updater.Update(b, cross_count,
-                         crosser.Generate(b, permutation, false));
-          cross_count++;
-        }
+    auto do_work = [&crosser, &updater](int64_t begin, int64_t end) {
+      for (int64_t b = begin; b < end; b++) {
+        crosser.GenerateRow(b, false, updater);
       }
     };
 
@@ -856,16 +908,9 @@ class SparseCrossV2Op : public OpKernel {
     StringCrosser<tstring> crosser(columns, 0, 0, separator);
     OutputUpdater<tstring> updater(output_start_indices, indices_out,
                                    values_out);
-    auto do_work = [&columns, crosser, updater](int64_t begin, int64_t end) {
-      for (int b = begin; b < end; b++) {
-        ProductIterator<tstring> product_iterator(columns, b);
-        int64_t cross_count = 0;
-        while (product_iterator.HasNext()) {
-          const auto permutation = product_iterator.Next();
-          updater.Update(b, cross_count,
-                         crosser.Generate(b, permutation, false));
-          cross_count++;
-        }
+    auto do_work = [&crosser, &updater](int64_t begin, int64_t end) {
+      for (int64_t b = begin; b < end; b++) {
+        crosser.GenerateRow(b, false, updater);
       }
     };
 
@@ -935,17 +980,10 @@ class SparseCrossHashedOp : public OpKernel {
     HashCrosserV2 crosser(columns, num_buckets, 0, unused_sep);
     OutputUpdater<int64_t> updater(output_start_indices, indices_out,
                                    values_out);
-    auto do_work = [&columns, crosser, updater, strong_hash](int64_t begin,
-                                                             int64_t end) {
-      for (int b = begin; b < end; b++) {
-        ProductIterator<int64_t> product_iterator(columns, b);
-        int64_t cross_count = 0;
-        while (product_iterator.HasNext()) {
-          const auto permutation = product_iterator.Next();
-          updater.Update(b, cross_count,
-                         crosser.Generate(b, permutation, strong_hash));
-          cross_count++;
-        }
+    auto do_work = [&crosser, &updater, strong_hash](int64_t begin,
+                                                     int64_t end) {
+      for (int64_t b = begin; b < end; b++) {
+        crosser.GenerateRow(b, strong_hash, updater);
       }
     };
 
@@ -19,12 +19,16 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/sparse_tensor_dense_matmul_op.h"
 
+#include <algorithm>
+#include <vector>
+
 #include "Eigen/Core"  // from @eigen_archive
 #include "tensorflow/core/framework/bounds_check.h"
 #include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/kernels/fill_functor.h"
 #include "tensorflow/core/platform/bfloat16.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 
@@ -322,6 +326,108 @@ Status SparseTensorDenseMatMulImpl(
   }
   return absl::OkStatus();
 }
+
+// The number of columns of the output accumulated at once for each row by
+// SparseTensorDenseMatMulByRows.
+constexpr int64_t kColumnBlock = 256;
+
+// Whether SparseTensorDenseMatMulByRows should be used for a product with
+// `nnz` nonzeros and `rhs_right` columns.
+bool UseSparseTensorDenseMatMulByRows(OpKernelContext* ctx, std::size_t nnz,
+                                      std::size_t rhs_right, int64_t num_rows) {
+  // The CSR conversion costs about as much as two passes over the nonzeros,
+  // which pays off when several threads share the multiplication.
+  static constexpr std::size_t kMinWork = 1 << 18;
+  return ctx->device()->tensorflow_cpu_worker_threads()->num_threads > 1 &&
+         num_rows > 1 && nnz * rhs_right >= kMinWork;
+}
+
+// Computes the same product as SparseTensorDenseMatMulImpl, but multiplies the
+// rows of the output in parallel. The nonzeros are first sorted by output row
+// into CSR form, keeping their order within a row, so every output is summed
+// in the same order as sequentially. Each row is then accumulated a block of
+// columns at a time, so that the block stays in cache across the nonzeros of
+// the row.
+template <typename T, typename Tsum, typename Tindices, bool ADJ_A, bool ADJ_B>
+Status SparseTensorDenseMatMulByRows(
+    OpKernelContext* ctx, typename TTypes<Tsum>::Matrix out,
+    typename TTypes<Tindices>::ConstMatrix a_indices,
+    typename TTypes<T>::ConstVec a_values, typename TTypes<T>::ConstMatrix b) {
+  const std::size_t nnz = a_values.size();
+  const int64_t num_rows = out.dimension(0);
+  const int64_t rhs_right = (ADJ_B ? b.dimension(0) : b.dimension(1));
+  const std::size_t lhs_right = (ADJ_B ? b.dimension(1) : b.dimension(0));
+  const int lhs_index_a = ADJ_A ? 1 : 0;
+  const int rhs_index_a = ADJ_A ? 0 : 1;
+
+  // Copy and check the indices once, in the same order as the sequential
+  // implementation, and count the nonzeros of each row.
+  std::vector<Tindices> rows(nnz);
+  std::vector<Tindices> cols(nnz);
+  std::vector<int64_t> row_starts(num_rows + 1, 0);
+  for (std::size_t i = 0; i < nnz; ++i) {
+    const Tindices m = internal::SubtleMustCopy(a_indices(i, lhs_index_a));
+    const Tindices k = internal::SubtleMustCopy(a_indices(i, rhs_index_a));
+    if (!FastBoundsCheck(k, lhs_right)) {
+      return KOutOfBoundsError(k, i, rhs_index_a, lhs_right);
+    }
+    if (!FastBoundsCheck(m, num_rows)) {
+      return MOutOfBoundsError(m, i, lhs_index_a, num_rows);
+    }
+    rows[i] = m;
+    cols[i] = k;
+    ++row_starts[m + 1];
+  }
+  for (int64_t m = 0; m < num_rows; ++m) {
+    row_starts[m + 1] += row_starts[m];
+  }
+  std::vector<Tindices> csr_cols(nnz);
+  std::vector<T> csr_values(nnz);
+  {
+    std::vector<int64_t> next(row_starts.begin(), row_starts.end() - 1);
+    for (std::size_t i = 0; i < nnz; ++i) {
+      const int64_t pos = next[rows[i]]++;
+      csr_cols[pos] = cols[i];
+      csr_values[pos] = ADJ_A ? MaybeConj(a_values(i)) : a_values(i);
+    }
+  }
+
+  // Each nonzero multiplies a row of the (adjoint of) B.
+  const T* b_rows = b.data();
+  Tensor b_adjoint_t;
+  if (ADJ_B) {
+    TF_RETURN_IF_ERROR(ctx->allocate_temp(
+        DataTypeToEnum<T>::value,
+        TensorShape({static_cast<int64_t>(lhs_right), rhs_right}),
+        &b_adjoint_t));
+    Eigen::array<int, 2> shuffle{1, 0};
+    b_adjoint_t.matrix<T>().device(ctx->eigen_device<CPUDevice>()) =
+        b.shuffle(shuffle).conjugate();
+    b_rows = b_adjoint_t.matrix<T>().data();
+  }
+
+  auto multiply_rows = [&](int64_t begin_row, int64_t end_row) {
+    for (int64_t m = begin_row; m < end_row; ++m) {
+      for (int64_t n = 0; n < rhs_right; n += kColumnBlock) {
+        const int64_t block_size = std::min(kColumnBlock, rhs_right - n);
+        Eigen::Map<Eigen::Array<Tsum, Eigen::Dynamic, 1>> out_block(&out(m, n),
+                                                                    block_size);
+        for (int64_t j = row_starts[m]; j < row_starts[m + 1]; ++j) {
+          Eigen::Map<const Eigen::Array<T, Eigen::Dynamic, 1>> b_block(
+              b_rows + csr_cols[j] * rhs_right + n, block_size);
+          out_block += b_block.template cast<Tsum>() *
+                       static_cast<Tsum>(csr_values[j]);
+        }
+      }
+    }
+  };
+  const DeviceBase::CpuWorkerThreads& worker_threads =
+      *ctx->device()->tensorflow_cpu_worker_threads();
+  const int64_t cost_per_row = 2 * (nnz / num_rows + 1) * rhs_right;
+  Shard(worker_threads.num_threads, worker_threads.workers, num_rows,
+        cost_per_row, multiply_rows);
+  return absl::OkStatus();
+}
 }  // namespace
 
 template <typename T, typename Tindices, bool ADJ_A, bool ADJ_B>
@@ -338,9 +444,7 @@ struct SparseTensorDenseMatMulFunctor<CPUDevice, T, Tindices, ADJ_A, ADJ_B> {
           TensorShape({out.dimension(0), out.dimension(1)}), &temp_out_t));
       auto temp_out = temp_out_t.matrix<Tsum>();
       temp_out.setZero();
-      TF_RETURN_IF_ERROR(
-          SparseTensorDenseMatMulImpl<T, Tsum, Tindices, ADJ_A, ADJ_B>(
-              temp_out, a_indices, a_values, b));
+      TF_RETURN_IF_ERROR(Multiply<Tsum>(ctx, temp_out, a_indices, a_values, b));
       out = temp_out.template cast<T>();
     } else {
       out.setZero();
@@ -349,11 +453,27 @@ struct SparseTensorDenseMatMulFunctor<CPUDevice, T, Tindices, ADJ_A, ADJ_B> {
       auto out_workaround =
           *reinterpret_cast<typename TTypes<Tsum>::Matrix*>(&out);
       TF_RETURN_IF_ERROR(
-          SparseTensorDenseMatMulImpl<T, Tsum, Tindices, ADJ_A, ADJ_B>(
-              out_workaround, a_indices, a_values, b));
+          Multiply<Tsum>(ctx, out_workaround, a_indices, a_values, b));
     }
     return OkStatus();
   }
+
+ private:
+  template <typename Tsum>
+  static Status Multiply(OpKernelContext* ctx,
+                         typename TTypes<Tsum>::Matrix out,
+                         typename TTypes<Tindices>::ConstMatrix a_indices,
+                         typename TTypes<T>::ConstVec a_values,
+                         typename TTypes<T>::ConstMatrix b) {
+    if (UseSparseTensorDenseMatMulByRows(
+            ctx, a_values.size(), ADJ_B ? b.dimension(0) : b.dimension(1),
+            out.dimension(0))) {
+      return SparseTensorDenseMatMulByRows<T, Tsum, Tindices, ADJ_A, ADJ_B>(
+          ctx, out, a_indices, a_values, b);
+    }
+    return SparseTensorDenseMatMulImpl<T, Tsum, Tindices, ADJ_A, ADJ_B>(
+        out, a_indices, a_values, b);
+  }
 };
 
 }  // namespace functor
@@ -19,6 +19,11 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/sparse_xent_op.h"
 
+#include <algorithm>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
 #include "unsupported/Eigen/CXX11/Tensor"  // from @eigen_archive
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor.h"
@@ -26,6 +31,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor_types.h"
 #include "tensorflow/core/util/determinism.h"
 #include "tensorflow/core/util/env_var.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 
@@ -109,17 +115,142 @@ class SparseSoftmaxXentWithLogitsOp : public OpKernel {
   }
 };
 
-// Partial specialization for a CPUDevice, that uses the Eigen implementation
-// from XentEigenImpl.
 namespace functor {
+
+// The number of classes of a block of SparseXentCpuImpl.
+constexpr int64_t kSparseXentClassBlock = 8192;
+// The number of classes SparseXentCpuImpl converts to the accumulation type
+// at a time.
+constexpr int64_t kSparseXentChunk = 256;
+
+// Computes the loss and backprop of each row of logits in two passes over
+// blocks of its classes, without temporary tensors: the first pass computes
+// the maximum and the sum of the exponentials of each block, with the sum
+// rescaled to the running maximum chunk by chunk, and the second one writes
+// the softmax. Rows with many classes are split into several blocks, so that
+// small batches of large vocabularies still run in parallel. `backprop` may
+// be the buffer of `logits`. Half-precision logits are accumulated in float.
+template <typename T, typename Index>
+struct SparseXentCpuImpl {
+  using Acc = typename std::conditional<std::is_same<T, double>::value,
+                                        double, float>::type;
+  using AccArray = Eigen::Array<Acc, Eigen::Dynamic, 1>;
+
+  static void Compute(OpKernelContext* ctx,
+                      typename TTypes<T>::ConstMatrix logits,
+                      typename TTypes<Index>::ConstVec labels,
+                      typename TTypes<T>::Vec loss,
+                      typename TTypes<T>::Matrix backprop) {
+    const int64_t batch_size = logits.dimension(0);
+    const int64_t num_classes = logits.dimension(1);
+    const int64_t num_blocks =
+        (num_classes + kSparseXentClassBlock - 1) / kSparseXentClassBlock;
+    const int64_t block_classes = std::min(num_classes, kSparseXentClassBlock);
+    auto worker_threads = *(ctx->device()->tensorflow_cpu_worker_threads());
+
+    // The maximum and the sum of exp(logits - maximum) of each block.
+    std::vector<Acc> block_max(batch_size * num_blocks);
+    std::vector<Acc> block_sum(batch_size * num_blocks);
+    Shard(worker_threads.num_threads, worker_threads.workers,
+          batch_size * num_blocks, block_classes * 20,
+          [&](int64_t start, int64_t limit) {
+            AccArray chunk(kSparseXentChunk);
+            for (int64_t i = start; i < limit; ++i) {
+              const T* row = &logits(i / num_blocks, 0);
+              const int64_t begin = (i % num_blocks) * kSparseXentClassBlock;
+              const int64_t end =
+                  std::min(num_classes, begin + kSparseXentClassBlock);
+              Acc max = -std::numeric_limits<Acc>::infinity();
+              Acc sum = 0;
+              for (int64_t c = begin; c < end; c += kSparseXentChunk) {
+                const int64_t n = std::min(kSparseXentChunk, end - c);
+                auto values = chunk.head(n);
+                for (int64_t j = 0; j < n; ++j) {
+                  values[j] = static_cast<Acc>(row[c + j]);
+                }
+                const Acc new_max = std::max(max, values.maxCoeff());
+                // All the logits so far are -inf, e.g. masked classes.
+                if (new_max == -std::numeric_limits<Acc>::infinity()) {
+                  continue;
+                }
+                if (new_max > max) {
+                  sum *= Eigen::numext::exp(max - new_max);
+                  max = new_max;
+                }
+                sum += (values - max).exp().sum();
+              }
+              block_max[i] = max;
+              block_sum[i] = sum;
+            }
+          });
+
+    // Combines the blocks of each row, and reads the logit of the label
+    // before the second pass overwrites it.
+    std::vector<Acc> row_max(batch_size);
+    std::vector<Acc> row_inv_sum(batch_size);
+    for (int64_t b = 0; b < batch_size; ++b) {
+      Acc max = -std::numeric_limits<Acc>::infinity();
+      for (int64_t k = 0; k < num_blocks; ++k) {
+        max = std::max(max, block_max[b * num_blocks + k]);
+      }
+      Acc sum = 0;
+      for (int64_t k = 0; k < num_blocks; ++k) {
+        sum += block_sum[b * num_blocks + k] *
+               Eigen::numext::exp(block_max[b * num_blocks + k] - max);
+      }
+      row_max[b] = max;
+      row_inv_sum[b] = Acc(1) / sum;
+      const Index label = internal::SubtleMustCopy(labels(b));
+      loss(b) = FastBoundsCheck(label, num_classes)
+                    ? static_cast<T>(Eigen::numext::log(sum) + max -
+                                     static_cast<Acc>(logits(b, label)))
+                    : Eigen::NumTraits<T>::quiet_NaN();
+    }
+
+    Shard(worker_threads.num_threads, worker_threads.workers,
+          batch_size * num_blocks, block_classes * 20,
+          [&](int64_t start, int64_t limit) {
+            AccArray chunk(kSparseXentChunk);
+            for (int64_t i = start; i < limit; ++i) {
+              const int64_t b = i / num_blocks;
+              const T* row = &logits(b, 0);
+              T* out = &backprop(b, 0);
+              const int64_t begin = (i % num_blocks) * kSparseXentClassBlock;
+              const int64_t end =
+                  std::min(num_classes, begin + kSparseXentClassBlock);
+              const Index label = internal::SubtleMustCopy(labels(b));
+              if (!FastBoundsCheck(label, num_classes)) {
+                std::fill(out + begin, out + end,
+                          Eigen::NumTraits<T>::quiet_NaN());
+                continue;
+              }
+              for (int64_t c = begin; c < end; c += kSparseXentChunk) {
+                const int64_t n = std::min(kSparseXentChunk, end - c);
+                auto values = chunk.head(n);
+                for (int64_t j = 0; j < n; ++j) {
+                  values[j] = static_cast<Acc>(row[c + j]);
+                }
+                values = (values - row_max[b]).exp() * row_inv_sum[b];
+                for (int64_t j = 0; j < n; ++j) {
+                  out[c + j] = static_cast<T>(values[j]);
+                }
+              }
+              if (label >= begin && label < end) {
+                out[label] = static_cast<T>(static_cast<Acc>(out[label]) - 1);
+              }
+            }
+          });
+  }
+};
+
+// Partial specialization for a CPUDevice, that uses SparseXentCpuImpl.
 template <typename T, typename Index>
 struct SparseXentFunctor<CPUDevice, T, Index> {
   void operator()(OpKernelContext* ctx, typename TTypes<T>::ConstMatrix logits,
                   typename TTypes<Index>::ConstVec labels,
                   typename TTypes<T>::Vec scratch, typename TTypes<T>::Vec loss,
                   typename TTypes<T>::Matrix backprop) {
-    SparseXentEigenImpl<CPUDevice, T, Index>::Compute(ctx, logits, labels,
-                                                      scratch, loss, backprop);
+    SparseXentCpuImpl<T, Index>::Compute(ctx, logits, labels, loss, backprop);
   }
 };
 }  // namespace functor
@@ -13,16 +13,77 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <cmath>
+#include <limits>
 #include <random>
+#include <vector>
 
 #include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
 #include "tensorflow/core/kernels/xent_op.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/test_benchmark.h"
 
 namespace tensorflow {
 
+class SparseXentOpTest : public OpsTestBase {
+ protected:
+  // Runs the op on `logits` of shape [batch_size, num_classes], and compares
+  // its outputs with a computation in double.
+  void RunAndCheck(int batch_size, int num_classes,
+                   const std::vector<float>& logits,
+                   const std::vector<int64_t>& labels) {
+    TF_ASSERT_OK(NodeDefBuilder("sparse_xent_op",
+                                "SparseSoftmaxCrossEntropyWithLogits")
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_INT64))
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+    AddInputFromArray<float>(TensorShape({batch_size, num_classes}), logits);
+    AddInputFromArray<int64_t>(TensorShape({batch_size}), labels);
+    TF_ASSERT_OK(RunOpKernel());
+
+    Tensor expected_loss(DT_FLOAT, TensorShape({batch_size}));
+    Tensor expected_backprop(DT_FLOAT, TensorShape({batch_size, num_classes}));
+    for (int b = 0; b < batch_size; ++b) {
+      const float* row = logits.data() + b * num_classes;
+      double max = -std::numeric_limits<double>::infinity();
+      for (int c = 0; c < num_classes; ++c) max = std::max<double>(max, row[c]);
+      double sum = 0;
+      for (int c = 0; c < num_classes; ++c) sum += std::exp(row[c] - max);
+      expected_loss.vec<float>()(b) = std::log(sum) + max - row[labels[b]];
+      for (int c = 0; c < num_classes; ++c) {
+        expected_backprop.matrix<float>()(b, c) =
+            std::exp(row[c] - max) / sum - (c == labels[b] ? 1.0 : 0.0);
+      }
+    }
+    test::ExpectTensorNear<float>(expected_loss, *GetOutput(0), 1e-5);
+    test::ExpectTensorNear<float>(expected_backprop, *GetOutput(1), 1e-5);
+  }
+};
+
+TEST_F(SparseXentOpTest, Small) {
+  RunAndCheck(3, 4, {1, 2, 3, 4, -1, -2, -3, -4, 100, 0, 100, 0}, {0, 3, 2});
+}
+
+TEST_F(SparseXentOpTest, ManyClasses) {
+  // Several blocks of classes per row, some of them only -inf.
+  constexpr int kNumClasses = 20000;
+  std::mt19937 gen(1);
+  std::uniform_real_distribution<float> dist(-10, 10);
+  std::vector<float> logits(2 * kNumClasses);
+  for (float& logit : logits) logit = dist(gen);
+  std::fill(logits.begin(), logits.begin() + 9000,
+            -std::numeric_limits<float>::infinity());
+  logits[kNumClasses + 19999] = 30;
+  RunAndCheck(2, kNumClasses, logits, {12345, 19999});
+}
+
 template <class T>
 static Graph* SparseXent(int batch_size, int num_classes, DataType type) {
   Graph* g = new Graph(OpRegistry::Global());
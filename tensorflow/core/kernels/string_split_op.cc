@@ -15,7 +15,9 @@ limitations under the License.
 
 // See docs in ../ops/string_ops.cc.
 
+#include <algorithm>
 #include <string>
+#include <vector>
 
 #include "tensorflow/core/framework/kernel_def_builder.h"
 #include "tensorflow/core/framework/op_kernel.h"
@@ -24,6 +26,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/core/stringpiece.h"
 #include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 namespace {
@@ -139,24 +142,117 @@ std::vector<StringPiece> SplitV2(const tstring& str, StringPiece sep,
     }
     return result;
   }
-  auto p = std::search(text.begin(), text.end(), sep.begin(), sep.end());
+  // A single character separator is found with memchr, which scans the text
+  // many bytes at a time.
+  auto find_sep = [sep](StringPiece text) {
+    return sep.size() == 1 ? text.find(sep[0]) : text.find(sep);
+  };
+  size_t p = find_sep(text);
   int split = 0;
-  while (p != text.end()) {
-    StringPiece token = text.substr(0, p - text.begin());
-    result.push_back(token);
-    text.remove_prefix(token.size());
-    text.remove_prefix(sep.size());
+  while (p != StringPiece::npos) {
+    result.push_back(text.substr(0, p));
+    text.remove_prefix(p + sep.size());
     ++split;
     if (maxsplit > 0 && split == maxsplit) {
       result.push_back(StringPiece(text));
       return result;
     }
-    p = std::search(text.begin(), text.end(), sep.begin(), sep.end());
+    p = find_sep(text);
   }
   result.push_back(text);
   return result;
 }
 
+// The number of input strings split by a single thread, and a rough cost of
+// splitting a string, in cycles per byte.
+constexpr int64_t kSplitBlockSize = 256;
+constexpr int64_t kSplitCostPerByte = 10;
+
+// Splits each string of `input_vec` with `split` and writes the tokens to the
+// sparse outputs of the StringSplit ops. Blocks of strings are split in
+// parallel into their own tokens, which are then copied in parallel to the
+// outputs, at the offset of the first token of each block.
+template <typename SplitFn>
+void SplitToSparse(OpKernelContext* ctx,
+                   const TTypes<tstring>::ConstVec& input_vec,
+                   const SplitFn& split) {
+  const int64_t batch_size = input_vec.dimension(0);
+  const int64_t num_blocks =
+      (batch_size + kSplitBlockSize - 1) / kSplitBlockSize;
+  int64_t total_bytes = 0;
+  for (int64_t i = 0; i < batch_size; ++i) {
+    total_bytes += input_vec(i).size();
+  }
+  const int64_t bytes_per_block =
+      std::max<int64_t>(1, total_bytes / std::max<int64_t>(1, num_blocks));
+  const int64_t cost_per_block = kSplitCostPerByte * bytes_per_block;
+
+  std::vector<std::vector<StringPiece>> block_tokens(num_blocks);
+  std::vector<int64_t> num_indices(batch_size);
+  auto worker_threads = *(ctx->device()->tensorflow_cpu_worker_threads());
+  Shard(worker_threads.num_threads, worker_threads.workers, num_blocks,
+        cost_per_block, [&](int64_t start_block, int64_t limit_block) {
+          for (int64_t b = start_block; b < limit_block; ++b) {
+            std::vector<StringPiece>& tokens = block_tokens[b];
+            // Guess that we'll be unpacking a handful of tokens per example.
+            static constexpr int kReserveSize = 4;
+            tokens.reserve(kSplitBlockSize * kReserveSize);
+            const int64_t limit =
+                std::min(batch_size, (b + 1) * kSplitBlockSize);
+            for (int64_t i = b * kSplitBlockSize; i < limit; ++i) {
+              std::vector<StringPiece> parts = split(input_vec(i));
+              num_indices[i] = parts.size();
+              tokens.insert(tokens.end(), parts.begin(), parts.end());
+            }
+          }
+        });
+
+  std::vector<int64_t> block_offsets(num_blocks);
+  int64_t output_size = 0;
+  for (int64_t b = 0; b < num_blocks; ++b) {
+    block_offsets[b] = output_size;
+    output_size += block_tokens[b].size();
+  }
+  int64_t max_num_entries = 0;
+  for (int64_t i = 0; i < batch_size; ++i) {
+    max_num_entries = std::max(max_num_entries, num_indices[i]);
+  }
+
+  Tensor* sp_indices_t;
+  OP_REQUIRES_OK(ctx, ctx->allocate_output(0, TensorShape({output_size, 2}),
+                                           &sp_indices_t));
+  Tensor* sp_tokens_t;
+  OP_REQUIRES_OK(
+      ctx, ctx->allocate_output(1, TensorShape({output_size}), &sp_tokens_t));
+  Tensor* sp_shape_t;
+  OP_REQUIRES_OK(ctx, ctx->allocate_output(2, TensorShape({2}), &sp_shape_t));
+
+  auto sp_indices = sp_indices_t->matrix<int64_t>();
+  auto sp_tokens = sp_tokens_t->vec<tstring>();
+  auto sp_shape = sp_shape_t->vec<int64_t>();
+  sp_shape(0) = batch_size;
+  sp_shape(1) = max_num_entries;
+  Shard(worker_threads.num_threads, worker_threads.workers, num_blocks,
+        cost_per_block, [&](int64_t start_block, int64_t limit_block) {
+          for (int64_t b = start_block; b < limit_block; ++b) {
+            const std::vector<StringPiece>& tokens = block_tokens[b];
+            int64_t c = block_offsets[b];
+            size_t t = 0;
+            const int64_t limit =
+                std::min(batch_size, (b + 1) * kSplitBlockSize);
+            for (int64_t i = b * kSplitBlockSize; i < limit; ++i) {
+              for (int64_t j = 0; j < num_indices[i]; ++j) {
+                sp_indices(c, 0) = i;
+                sp_indices(c, 1) = j;
+                sp_tokens(c).assign(tokens[t].data(), tokens[t].size());
+                ++c;
+                ++t;
+              }
+            }
+          }
+        });
+}
+
 }  // namespace
 
 class StringSplitOp : public OpKernel {
@@ -179,7 +275,6 @@ class StringSplitOp : public OpKernel {
                                         input_tensor->shape().DebugString()));
 
     const auto input_vec = input_tensor->vec<tstring>();
-    const int64_t batch_size = input_vec.dimension(0);
 
     const Tensor* delimiter_tensor;
     OP_REQUIRES_OK(ctx, ctx->input("delimiter", &delimiter_tensor));
@@ -190,49 +285,10 @@ class StringSplitOp : public OpKernel {
     const auto delimiter_vec = delimiter_tensor->flat<tstring>();
     const tstring& delimiter = delimiter_vec(0);
     // Empty delimiter means split the input character by character.
-    std::vector<StringPiece> tokens;
-    // Guess that we'll be unpacking a handful of tokens per example.
-    static constexpr int kReserveSize = 4;
-    tokens.reserve(batch_size * kReserveSize);
-
-    int64_t output_size = 0;
-    int64_t max_num_entries = 0;
-    std::vector<int64_t> num_indices(batch_size);
-    for (int64_t i = 0; i < batch_size; ++i) {
-      std::vector<StringPiece> parts =
-          skip_empty_ ? Split(input_vec(i), delimiter, str_util::SkipEmpty())
-                      : Split(input_vec(i), delimiter, str_util::AllowEmpty());
-      int64_t n_entries = parts.size();
-      num_indices[i] = n_entries;
-      output_size += n_entries;
-      max_num_entries = std::max(max_num_entries, n_entries);
-      tokens.insert(tokens.end(), std::make_move_iterator(parts.begin()),
-                    std::make_move_iterator(parts.end()));
-    }
-
-    Tensor* sp_indices_t;
-    OP_REQUIRES_OK(ctx, ctx->allocate_output(0, TensorShape({output_size, 2}),
-                                             &sp_indices_t));
-    Tensor* sp_tokens_t;
-    OP_REQUIRES_OK(
-        ctx, ctx->allocate_output(1, TensorShape({output_size}), &sp_tokens_t));
-    Tensor* sp_shape_t;
-    OP_REQUIRES_OK(ctx, ctx->allocate_output(2, TensorShape({2}), &sp_shape_t));
-
-    auto sp_indices = sp_indices_t->matrix<int64_t>();
-    auto sp_tokens = sp_tokens_t->vec<tstring>();
-    auto sp_shape = sp_shape_t->vec<int64_t>();
-    sp_shape(0) = batch_size;
-    sp_shape(1) = max_num_entries;
-    size_t c = 0;
-    for (size_t i = 0; i < batch_size; ++i) {
-      for (size_t j = 0; j < num_indices[i]; ++j) {
-        sp_indices(c, 0) = i;
-        sp_indices(c, 1) = j;
-        sp_tokens(c).assign(tokens[c].data(), tokens[c].size());
-        ++c;
-      }
-    }
+    SplitToSparse(ctx, input_vec, [&](const tstring& str) {
+      return skip_empty_ ? Split(str, delimiter, str_util::SkipEmpty())
+                         : Split(str, delimiter, str_util::AllowEmpty());
+    });
   }
 
  private:
@@ -254,7 +310,6 @@ class StringSplitV2Op : public OpKernel {
                                         input_tensor->shape().DebugString()));
 
     const auto input_vec = input_tensor->vec<tstring>();
-    const int64_t batch_size = input_vec.dimension(0);
 
     const Tensor* sep_tensor;
     OP_REQUIRES_OK(ctx, ctx->input("sep", &sep_tensor));
@@ -263,46 +318,9 @@ class StringSplitV2Op : public OpKernel {
                                         sep_tensor->shape().DebugString()));
     const auto sep_vec = sep_tensor->flat<tstring>();
     StringPiece sep(sep_vec(0));
-    std::vector<StringPiece> tokens;
-    // Guess that we'll be unpacking a handful of tokens per example.
-    static constexpr int kReserveSize = 4;
-    tokens.reserve(batch_size * kReserveSize);
-
-    int64_t output_size = 0;
-    int64_t max_num_entries = 0;
-    std::vector<int64_t> num_indices(batch_size);
-    for (int64_t i = 0; i < batch_size; ++i) {
-      std::vector<StringPiece> parts = SplitV2(input_vec(i), sep, maxsplit_);
-      int64_t n_entries = parts.size();
-      num_indices[i] = n_entries;
-      output_size += n_entries;
-      max_num_entries = std::max(max_num_entries, n_entries);
-      tokens.insert(tokens.end(), parts.begin(), parts.end());
-    }
-
-    Tensor* sp_indices_t;
-    OP_REQUIRES_OK(ctx, ctx->allocate_output(0, TensorShape({output_size, 2}),
-                                             &sp_indices_t));
-    Tensor* sp_tokens_t;
-    OP_REQUIRES_OK(
-        ctx, ctx->allocate_output(1, TensorShape({output_size}), &sp_tokens_t));
-    Tensor* sp_shape_t;
-    OP_REQUIRES_OK(ctx, ctx->allocate_output(2, TensorShape({2}), &sp_shape_t));
-
-    auto sp_indices = sp_indices_t->matrix<int64_t>();
-    auto sp_tokens = sp_tokens_t->vec<tstring>();
-    auto sp_shape = sp_shape_t->vec<int64_t>();
-    sp_shape(0) = batch_size;
-    sp_shape(1) = max_num_entries;
-    size_t c = 0;
-    for (size_t i = 0; i < batch_size; ++i) {
-      for (size_t j = 0; j < num_indices[i]; ++j) {
-        sp_indices(c, 0) = i;
-        sp_indices(c, 1) = j;
-        sp_tokens(c).assign(tokens[c].data(), tokens[c].size());
-        ++c;
-      }
-    }
+    SplitToSparse(ctx, input_vec, [&](const tstring& str) {
+      return SplitV2(str, sep, maxsplit_);
+    });
   }
 
  private:
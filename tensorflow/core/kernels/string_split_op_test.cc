@@ -13,6 +13,10 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <algorithm>
+#include <string>
+#include <vector>
+
 #include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/fake_input.h"
@@ -26,10 +30,143 @@ limitations under the License.
 #include "tensorflow/core/kernels/ops_testutil.h"
 #include "tensorflow/core/kernels/ops_util.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/test_benchmark.h"
 
 namespace tensorflow {
+namespace {
+
+class StringSplitOpTest : public OpsTestBase {
+ protected:
+  void MakeStringSplitOp(bool skip_empty) {
+    TF_ASSERT_OK(NodeDefBuilder("string_split_op", "StringSplit")
+                     .Input(FakeInput(DT_STRING))
+                     .Input(FakeInput(DT_STRING))
+                     .Attr("skip_empty", skip_empty)
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+  }
+
+  void MakeStringSplitV2Op() {
+    TF_ASSERT_OK(NodeDefBuilder("string_split_op", "StringSplitV2")
+                     .Input(FakeInput(DT_STRING))
+                     .Input(FakeInput(DT_STRING))
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+  }
+
+  void AddInputs(const std::vector<tstring>& input, const tstring& sep) {
+    AddInputFromArray<tstring>(
+        TensorShape({static_cast<int64_t>(input.size())}), input);
+    AddInputFromArray<tstring>(TensorShape({}), {sep});
+  }
+
+  // Checks the sparse outputs against the tokens of each input string.
+  void ExpectTokens(const std::vector<std::vector<string>>& tokens) {
+    std::vector<int64_t> indices;
+    std::vector<tstring> values;
+    int64_t max_num_tokens = 0;
+    for (size_t i = 0; i < tokens.size(); ++i) {
+      for (size_t j = 0; j < tokens[i].size(); ++j) {
+        indices.push_back(i);
+        indices.push_back(j);
+        values.push_back(tokens[i][j]);
+      }
+      max_num_tokens =
+          std::max(max_num_tokens, static_cast<int64_t>(tokens[i].size()));
+    }
+    const int64_t num_values = values.size();
+    test::ExpectTensorEqual<int64_t>(
+        test::AsTensor<int64_t>(indices, {num_values, 2}), *GetOutput(0));
+    test::ExpectTensorEqual<tstring>(test::AsTensor<tstring>(values),
+                                     *GetOutput(1));
+    test::ExpectTensorEqual<int64_t>(
+        test::AsTensor<int64_t>(
+            {static_cast<int64_t>(tokens.size()), max_num_tokens}),
+        *GetOutput(2));
+  }
+};
+
+// Returns the tokens of enough strings to split them in several blocks, with
+// empty tokens, and strings of a single empty token.
+std::vector<std::vector<string>> ManyTokens() {
+  std::vector<std::vector<string>> tokens(1000);
+  for (int i = 0; i < 1000; ++i) {
+    for (int j = 0; j <= i % 5; ++j) {
+      tokens[i].push_back(string(i % 3 == 0 ? 0 : j + 1, 'a' + i % 26));
+    }
+  }
+  return tokens;
+}
+
+std::vector<tstring> JoinTokens(const std::vector<std::vector<string>>& tokens,
+                                const string& sep) {
+  std::vector<tstring> input;
+  for (const auto& row : tokens) input.push_back(str_util::Join(row, sep));
+  return input;
+}
+
+TEST_F(StringSplitOpTest, SplitV2ManyStringsWithCharSeparator) {
+  const std::vector<std::vector<string>> tokens = ManyTokens();
+  MakeStringSplitV2Op();
+  AddInputs(JoinTokens(tokens, ","), ",");
+  TF_ASSERT_OK(RunOpKernel());
+  ExpectTokens(tokens);
+}
+
+TEST_F(StringSplitOpTest, SplitV2ManyStringsWithStringSeparator) {
+  const std::vector<std::vector<string>> tokens = ManyTokens();
+  MakeStringSplitV2Op();
+  AddInputs(JoinTokens(tokens, "<>"), "<>");
+  TF_ASSERT_OK(RunOpKernel());
+  ExpectTokens(tokens);
+}
+
+TEST_F(StringSplitOpTest, SplitManyStrings) {
+  std::vector<std::vector<string>> tokens = ManyTokens();
+  MakeStringSplitOp(/*skip_empty=*/false);
+  AddInputs(JoinTokens(tokens, ","), ",");
+  TF_ASSERT_OK(RunOpKernel());
+  // Empty strings have no tokens, even when empty tokens are kept.
+  for (auto& row : tokens) {
+    if (row.size() == 1 && row[0].empty()) row.clear();
+  }
+  ExpectTokens(tokens);
+}
+
+TEST_F(StringSplitOpTest, SplitManyStringsSkippingEmptyTokens) {
+  std::vector<std::vector<string>> tokens = ManyTokens();
+  MakeStringSplitOp(/*skip_empty=*/true);
+  AddInputs(JoinTokens(tokens, ","), ",");
+  TF_ASSERT_OK(RunOpKernel());
+  for (auto& row : tokens) {
+    row.erase(std::remove(row.begin(), row.end(), ""), row.end());
+  }
+  ExpectTokens(tokens);
+}
+
+TEST_F(StringSplitOpTest, SplitManyStringsWithEmptyDelimiter) {
+  std::vector<std::vector<string>> tokens(1000);
+  std::vector<tstring> input;
+  for (int i = 0; i < 1000; ++i) {
+    for (int j = 0; j < i % 4; ++j) tokens[i].push_back(string(1, 'a' + j));
+    input.push_back(str_util::Join(tokens[i], ""));
+  }
+  MakeStringSplitOp(/*skip_empty=*/true);
+  AddInputs(input, "");
+  TF_ASSERT_OK(RunOpKernel());
+  ExpectTokens(tokens);
+}
+
+TEST_F(StringSplitOpTest, SplitEmptyBatch) {
+  MakeStringSplitV2Op();
+  AddInputs({}, ",");
+  TF_ASSERT_OK(RunOpKernel());
+  ExpectTokens({});
+}
+
+}  // namespace
 
 // Test data from the TensorFlow README.md.
 const char* lines[] = {
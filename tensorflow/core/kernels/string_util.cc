@@ -14,7 +14,11 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/kernels/string_util.h"
 
+#include <algorithm>
+
+#include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 
@@ -61,4 +65,17 @@ int32 UTF8StrLen(const string& str) {
   return result;
 }
 
+void ShardStrings(OpKernelContext* context, const tstring* strings,
+                  int64_t num_strings, int64_t cost_per_byte,
+                  const std::function<void(int64_t, int64_t)>& work) {
+  if (num_strings <= 0) return;
+  int64_t num_bytes = 0;
+  for (int64_t i = 0; i < num_strings; ++i) num_bytes += strings[i].size();
+  const int64_t cost_per_string =
+      cost_per_byte * std::max<int64_t>(1, num_bytes / num_strings);
+  auto worker_threads = *(context->device()->tensorflow_cpu_worker_threads());
+  Shard(worker_threads.num_threads, worker_threads.workers, num_strings,
+        cost_per_string, work);
+}
+
 }  // namespace tensorflow
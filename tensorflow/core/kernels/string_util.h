@@ -15,11 +15,17 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_KERNELS_STRING_UTIL_H_
 #define TENSORFLOW_CORE_KERNELS_STRING_UTIL_H_
 
+#include <cstdint>
+#include <functional>
+
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/core/stringpiece.h"
+#include "tensorflow/core/platform/tstring.h"
 
 namespace tensorflow {
 
+class OpKernelContext;
+
 // Enumeration for unicode encodings.  Used by ops such as
 // tf.strings.unicode_encode and tf.strings.unicode_decode.
 enum class UnicodeEncoding { UTF8, UTF16BE, UTF32BE };
@@ -83,6 +89,13 @@ bool BackNUTF8CharPositions(const StringPiece in,
   return utf8_chars_counted == num_utf8_chars_to_shift;
 }
 
+// Calls `work(start, limit)` on ranges of `strings[0, num_strings)`, on the
+// intra-op threads of `context`. The cost of each string is estimated as
+// `cost_per_byte` times the mean length of the strings.
+void ShardStrings(OpKernelContext* context, const tstring* strings,
+                  int64_t num_strings, int64_t cost_per_byte,
+                  const std::function<void(int64_t, int64_t)>& work);
+
 }  // namespace tensorflow
 
 #endif  // TENSORFLOW_CORE_KERNELS_STRING_UTIL_H_
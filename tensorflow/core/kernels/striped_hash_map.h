@@ -0,0 +1,270 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_STRIPED_HASH_MAP_H_
+#define TENSORFLOW_CORE_KERNELS_STRIPED_HASH_MAP_H_
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/hash/hash.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/tstring.h"
+
+namespace tensorflow {
+namespace lookup {
+
+namespace internal {
+
+template <typename K>
+struct StripedHash {
+  size_t operator()(const K& key) const { return absl::Hash<K>()(key); }
+};
+
+template <>
+struct StripedHash<tstring> {
+  size_t operator()(const tstring& key) const {
+    return absl::Hash<absl::string_view>()(absl::string_view(key));
+  }
+};
+
+}  // namespace internal
+
+// A hash map for tables that serve many concurrent lookups.
+//
+// The keys are split over `kNumStripes` stripes by hash. Each stripe is an
+// open-addressing Swiss table (absl::flat_hash_map, which probes a group of
+// slots at once with SIMD instructions) guarded by its own reader-writer lock,
+// so that concurrent finds and inserts only contend when they touch the same
+// stripe.
+//
+// The batched operations group the keys by stripe, so each stripe is locked
+// once per batch, and prefetch the slots of upcoming keys while probing for
+// the current one.
+//
+// Thread-safe.
+template <class K, class V, int kNumStripes = 64>
+class StripedHashMap {
+ public:
+  static_assert((kNumStripes & (kNumStripes - 1)) == 0,
+                "kNumStripes must be a power of two");
+
+  StripedHashMap() = default;
+  StripedHashMap(const StripedHashMap&) = delete;
+  void operator=(const StripedHashMap&) = delete;
+
+  size_t size() const {
+    size_t size = 0;
+    for (const Stripe& stripe : stripes_) {
+      tf_shared_lock l(stripe.mu);
+      size += stripe.map.size();
+    }
+    return size;
+  }
+
+  // Number of slots allocated by all stripes.
+  size_t capacity() const {
+    size_t capacity = 0;
+    for (const Stripe& stripe : stripes_) {
+      tf_shared_lock l(stripe.mu);
+      capacity += stripe.map.capacity();
+    }
+    return capacity;
+  }
+
+  // For each `i`, calls `found(i, value)` if `keys[i]` is in the map and
+  // `missing(i)` otherwise. The calls are made in no particular order, with
+  // the stripe of `keys[i]` locked.
+  template <typename FoundFn, typename MissingFn>
+  void FindBatch(absl::Span<const K> keys, FoundFn found,
+                 MissingFn missing) const {
+    const KeyCopy key_copy(keys);
+    const absl::Span<const K> stable_keys = key_copy.keys();
+    ForEachStripe(
+        stripes_, stable_keys,
+        [&](const Stripe& stripe, absl::Span<const int64_t> ids) {
+          tf_shared_lock l(stripe.mu);
+          for (int64_t j = 0; j < ids.size(); ++j) {
+            if (j + kPrefetchDistance < ids.size()) {
+              stripe.map.prefetch(stable_keys[ids[j + kPrefetchDistance]]);
+            }
+            const int64_t i = ids[j];
+            auto it = stripe.map.find(stable_keys[i]);
+            if (it != stripe.map.end()) {
+              found(i, it->second);
+            } else {
+              missing(i);
+            }
+          }
+        });
+  }
+
+  // Inserts or updates `keys[i]` with the value `value(i)`. If a key appears
+  // several times in `keys`, the last value is kept.
+  template <typename ValueFn>
+  void InsertBatch(absl::Span<const K> keys, ValueFn value) {
+    const KeyCopy key_copy(keys);
+    const absl::Span<const K> stable_keys = key_copy.keys();
+    ForEachStripe(stripes_, stable_keys,
+                  [&](Stripe& stripe, absl::Span<const int64_t> ids) {
+                    mutex_lock l(stripe.mu);
+                    for (int64_t j = 0; j < ids.size(); ++j) {
+                      if (j + kPrefetchDistance < ids.size()) {
+                        stripe.map.prefetch(
+                            stable_keys[ids[j + kPrefetchDistance]]);
+                      }
+                      const int64_t i = ids[j];
+                      stripe.map.insert_or_assign(stable_keys[i], value(i));
+                    }
+                  });
+  }
+
+  void EraseBatch(absl::Span<const K> keys) {
+    const KeyCopy key_copy(keys);
+    const absl::Span<const K> stable_keys = key_copy.keys();
+    ForEachStripe(stripes_, stable_keys,
+                  [&](Stripe& stripe, absl::Span<const int64_t> ids) {
+                    mutex_lock l(stripe.mu);
+                    for (int64_t i : ids) stripe.map.erase(stable_keys[i]);
+                  });
+  }
+
+  void Clear() {
+    for (Stripe& stripe : stripes_) {
+      mutex_lock l(stripe.mu);
+      stripe.map.clear();
+    }
+  }
+
+  // Locks all stripes, calls `start(size)` with the number of entries, and,
+  // if it returns OK, `visit(key, value)` for each entry. Gives a consistent
+  // snapshot of the map.
+  template <typename StartFn, typename VisitFn>
+  Status Snapshot(StartFn start, VisitFn visit) const
+      TF_NO_THREAD_SAFETY_ANALYSIS {
+    std::array<std::unique_ptr<tf_shared_lock>, kNumStripes> locks;
+    int64_t size = 0;
+    for (int s = 0; s < kNumStripes; ++s) {
+      locks[s] = std::make_unique<tf_shared_lock>(stripes_[s].mu);
+      size += stripes_[s].map.size();
+    }
+    TF_RETURN_IF_ERROR(start(size));
+    for (const Stripe& stripe : stripes_) {
+      for (const auto& entry : stripe.map) visit(entry.first, entry.second);
+    }
+    return absl::OkStatus();
+  }
+
+  // Atomically replaces the contents of the map with `keys[i]` -> `value(i)`.
+  template <typename ValueFn>
+  void Assign(absl::Span<const K> keys,
+              ValueFn value) TF_NO_THREAD_SAFETY_ANALYSIS {
+    std::array<std::unique_ptr<mutex_lock>, kNumStripes> locks;
+    for (int s = 0; s < kNumStripes; ++s) {
+      locks[s] = std::make_unique<mutex_lock>(stripes_[s].mu);
+      stripes_[s].map.clear();
+    }
+    const KeyCopy key_copy(keys);
+    const absl::Span<const K> stable_keys = key_copy.keys();
+    for (int64_t i = 0; i < stable_keys.size(); ++i) {
+      stripes_[StripeOf(stable_keys[i])].map.insert_or_assign(stable_keys[i],
+                                                              value(i));
+    }
+  }
+
+ private:
+  using Hash = internal::StripedHash<K>;
+
+  // Number of keys ahead of the current one whose slots are prefetched.
+  static constexpr int kPrefetchDistance = 8;
+
+  struct alignas(64) Stripe {
+    mutable mutex mu;
+    absl::flat_hash_map<K, V, Hash> map TF_GUARDED_BY(mu);
+  };
+
+  // Integral keys are copied once, so that the stripe a key is assigned to
+  // and the slot it is probed at agree even if the input tensor changes
+  // concurrently.
+  class KeyCopy {
+   public:
+    explicit KeyCopy(absl::Span<const K> keys) {
+      if constexpr (std::is_trivially_copyable_v<K>) {
+        copy_.assign(keys.begin(), keys.end());
+        keys_ = copy_;
+      } else {
+        keys_ = keys;
+      }
+    }
+    absl::Span<const K> keys() const { return keys_; }
+
+   private:
+    std::vector<K> copy_;
+    absl::Span<const K> keys_;
+  };
+
+  static int StripeOf(const K& key) {
+    // Mixes in the high bits, which the map of the stripe uses the least.
+    const uint64_t hash = Hash()(key);
+    return (hash ^ (hash >> 32)) & (kNumStripes - 1);
+  }
+
+  // Calls `fn(stripe, ids)` for each of `stripes` that holds keys of `keys`,
+  // where `ids` are the indices of these keys in `keys`.
+  template <typename StripeArray, typename Fn>
+  static void ForEachStripe(StripeArray& stripes, absl::Span<const K> keys,
+                            Fn fn) {
+    if (keys.size() == 1) {
+      const int64_t id = 0;
+      fn(stripes[StripeOf(keys[0])], absl::Span<const int64_t>(&id, 1));
+      return;
+    }
+    // Counting sort of the keys by stripe.
+    std::vector<uint8_t> stripe_of(keys.size());
+    std::array<int64_t, kNumStripes + 1> start = {};
+    for (int64_t i = 0; i < keys.size(); ++i) {
+      stripe_of[i] = StripeOf(keys[i]);
+      ++start[stripe_of[i] + 1];
+    }
+    for (int s = 0; s < kNumStripes; ++s) start[s + 1] += start[s];
+    std::vector<int64_t> ids(keys.size());
+    std::array<int64_t, kNumStripes> next;
+    std::copy(start.begin(), start.end() - 1, next.begin());
+    for (int64_t i = 0; i < keys.size(); ++i) ids[next[stripe_of[i]]++] = i;
+    for (int s = 0; s < kNumStripes; ++s) {
+      if (start[s] == start[s + 1]) continue;
+      fn(stripes[s], absl::Span<const int64_t>(ids.data() + start[s],
+                                               start[s + 1] - start[s]));
+    }
+  }
+
+  Stripe stripes_[kNumStripes];
+};
+
+}  // namespace lookup
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_STRIPED_HASH_MAP_H_
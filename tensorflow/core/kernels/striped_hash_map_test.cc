@@ -0,0 +1,137 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/striped_hash_map.h"
+
+#include <cstdint>
+#include <map>
+#include <vector>
+
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/tstring.h"
+
+namespace tensorflow {
+namespace lookup {
+namespace {
+
+// Returns the value of each of `keys`, or -1 if it is missing.
+template <typename K, typename V>
+std::vector<V> Find(const StripedHashMap<K, V>& map,
+                    const std::vector<K>& keys) {
+  std::vector<V> values(keys.size());
+  map.FindBatch(
+      keys, [&](int64_t i, const V& value) { values[i] = value; },
+      [&](int64_t i) { values[i] = -1; });
+  return values;
+}
+
+template <typename K, typename V>
+std::map<K, V> Contents(const StripedHashMap<K, V>& map) {
+  std::map<K, V> contents;
+  int64_t expected_size = -1;
+  TF_EXPECT_OK(map.Snapshot(
+      [&](int64_t size) {
+        expected_size = size;
+        return absl::OkStatus();
+      },
+      [&](const K& key, const V& value) { contents[key] = value; }));
+  EXPECT_EQ(contents.size(), expected_size);
+  return contents;
+}
+
+TEST(StripedHashMapTest, InsertFindErase) {
+  StripedHashMap<int64_t, int64_t> map;
+  std::vector<int64_t> keys;
+  for (int64_t i = 0; i < 1000; ++i) keys.push_back(i * 7);
+  map.InsertBatch(keys, [&](int64_t i) { return keys[i] + 1; });
+  EXPECT_EQ(map.size(), 1000);
+  EXPECT_GE(map.capacity(), 1000);
+
+  std::vector<int64_t> values = Find(map, keys);
+  for (int64_t i = 0; i < keys.size(); ++i) EXPECT_EQ(values[i], keys[i] + 1);
+  EXPECT_EQ(Find(map, std::vector<int64_t>{1, 14}),
+            std::vector<int64_t>({-1, 15}));
+
+  map.EraseBatch(std::vector<int64_t>{0, 7, 1});
+  EXPECT_EQ(map.size(), 998);
+  EXPECT_EQ(Find(map, std::vector<int64_t>{0, 7, 14}),
+            std::vector<int64_t>({-1, -1, 15}));
+
+  map.Clear();
+  EXPECT_EQ(map.size(), 0);
+}
+
+TEST(StripedHashMapTest, LastDuplicateWins) {
+  StripedHashMap<int32_t, int32_t> map;
+  map.InsertBatch(std::vector<int32_t>{3, 3, 3},
+                  [](int64_t i) { return static_cast<int32_t>(i); });
+  EXPECT_EQ(Find(map, std::vector<int32_t>{3}), std::vector<int32_t>({2}));
+}
+
+TEST(StripedHashMapTest, StringKeys) {
+  StripedHashMap<tstring, int64_t> map;
+  const std::vector<tstring> keys = {"a", "b", "a long key that is not small"};
+  map.InsertBatch(keys, [](int64_t i) { return i; });
+  EXPECT_EQ(Find(map, std::vector<tstring>{"a long key that is not small",
+                                           "c", "a"}),
+            std::vector<int64_t>({2, -1, 0}));
+}
+
+TEST(StripedHashMapTest, AssignAndSnapshot) {
+  StripedHashMap<int64_t, int64_t> map;
+  map.InsertBatch(std::vector<int64_t>{1, 2}, [](int64_t i) { return i; });
+  map.Assign(std::vector<int64_t>{5, 6, 7}, [](int64_t i) { return 10 * i; });
+  EXPECT_EQ(Contents(map),
+            (std::map<int64_t, int64_t>{{5, 0}, {6, 10}, {7, 20}}));
+
+  EXPECT_TRUE(errors::IsInternal(map.Snapshot(
+      [](int64_t size) { return errors::Internal("failed"); },
+      [](int64_t key, int64_t value) { FAIL(); })));
+}
+
+TEST(StripedHashMapTest, ConcurrentInsertAndFind) {
+  constexpr int kNumThreads = 8;
+  constexpr int kKeysPerThread = 2000;
+  StripedHashMap<int64_t, int64_t> map;
+  {
+    thread::ThreadPool pool(Env::Default(), "test", kNumThreads);
+    for (int t = 0; t < kNumThreads; ++t) {
+      pool.Schedule([&map, t]() {
+        std::vector<int64_t> keys;
+        for (int i = 0; i < kKeysPerThread; ++i) {
+          keys.push_back(t * kKeysPerThread + i);
+        }
+        for (int i = 0; i < kKeysPerThread; i += 100) {
+          const std::vector<int64_t> batch(keys.begin() + i,
+                                           keys.begin() + i + 100);
+          map.InsertBatch(batch, [&](int64_t j) { return -batch[j]; });
+          std::vector<int64_t> values = Find(map, batch);
+          for (int j = 0; j < batch.size(); ++j) {
+            EXPECT_EQ(values[j], -batch[j]);
+          }
+        }
+      });
+    }
+  }
+  EXPECT_EQ(map.size(), kNumThreads * kKeysPerThread);
+}
+
+}  // namespace
+}  // namespace lookup
+}  // namespace tensorflow
@@ -23,6 +23,7 @@ limitations under the License.
 #include "tensorflow/core/summary/schema.h"
 #include "tensorflow/core/summary/summary_db_writer.h"
 #include "tensorflow/core/summary/summary_file_writer.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/event.pb.h"
 
 namespace tensorflow {
@@ -53,15 +54,24 @@ class CreateSummaryFileWriterOp : public OpKernel {
     OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(tmp->shape()),
                 errors::InvalidArgument("filename_suffix must be a scalar"));
     const string filename_suffix = tmp->scalar<tstring>()();
+    SummaryFileWriterOptions options;
+    options.max_queue = max_queue;
+    options.flush_millis = flush_millis;
+    OP_REQUIRES_OK(ctx, ReadBoolFromEnvVar("TF_SUMMARY_WRITER_ASYNC",
+                                           /*default_val=*/false,
+                                           &options.async));
+    OP_REQUIRES_OK(ctx, ReadBoolFromEnvVar("TF_SUMMARY_WRITER_SCALAR_COLUMNS",
+                                           /*default_val=*/false,
+                                           &options.write_scalar_columns));
 
     core::RefCountPtr<SummaryWriterInterface> s;
     OP_REQUIRES_OK(ctx, LookupOrCreateResource<SummaryWriterInterface>(
                             ctx, HandleFromInput(ctx, 0), &s,
-                            [max_queue, flush_millis, logdir, filename_suffix,
+                            [options, logdir, filename_suffix,
                              ctx](SummaryWriterInterface** s) {
                               return CreateSummaryFileWriter(
-                                  max_queue, flush_millis, logdir,
-                                  filename_suffix, ctx->env(), s);
+                                  options, logdir, filename_suffix,
+                                  ctx->env(), s);
                             }));
   }
 };
@@ -14,6 +14,11 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/kernels/tensor_list.h"
 
+#include <atomic>
+#include <cstring>
+#include <utility>
+
+#include "tensorflow/core/common_runtime/dma_helper.h"
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/tensor_shape.pb.h"
 #include "tensorflow/core/framework/variant_op_registry.h"
@@ -25,6 +30,75 @@ TensorList::~TensorList() {
   if (tensors_) tensors_->Unref();
 }
 
+bool TensorList::SetContiguousBuffer(Tensor buffer) {
+  if (buffer.dims() < 1 || buffer.NumElements() == 0 ||
+      !DataTypeCanUseMemcpy(buffer.dtype())) {
+    return false;
+  }
+  // The views of the elements must be aligned, like any other tensor.
+  TensorBuffer* root = DMAHelper::buffer(&buffer);
+  const int64_t element_bytes = buffer.TotalBytes() / buffer.dim_size(0);
+  if (root != root->root_buffer() || !buffer.IsAligned() ||
+      element_bytes % EIGEN_MAX_ALIGN_BYTES != 0) {
+    return false;
+  }
+  tensors_->buffer_views_.clear();
+  tensors_->buffer_views_.resize(buffer.dim_size(0));
+  tensors_->num_buffer_views_ = 0;
+  tensors_->buffer_ = std::move(buffer);
+  return true;
+}
+
+bool TensorList::SetContiguousElement(int index, const Tensor& value) {
+  Tensor& buffer = tensors_->buffer_;
+  if (!buffer.IsInitialized() || index < 0 || index >= buffer.dim_size(0) ||
+      index >= tensors().size() || value.dtype() != buffer.dtype()) {
+    return false;
+  }
+  Tensor& view = tensors_->buffer_views_[index];
+  if (!view.IsInitialized()) {
+    view = buffer.SubSlice(index);
+    ++tensors_->num_buffer_views_;
+  }
+  if (value.shape() != view.shape()) return false;
+
+  // The element can only be overwritten if no other tensor refers to it. The
+  // buffer is referenced by `buffer` and once by each view of its elements,
+  // however many tensors share that view. The view of the element is
+  // referenced by `buffer_views_`, and by the element of the list if it is
+  // still in place.
+  const TensorBuffer* view_buffer = DMAHelper::buffer(&view);
+  const int view_refs =
+      DMAHelper::buffer(&tensors()[index]) == view_buffer ? 2 : 1;
+  if (view_buffer->RefCount() != view_refs ||
+      DMAHelper::buffer(&buffer)->RefCount() !=
+          1 + tensors_->num_buffer_views_) {
+    return false;
+  }
+  std::atomic_thread_fence(std::memory_order_acquire);
+  std::memcpy(view.data(), value.data(), value.TotalBytes());
+  tensors()[index] = view;
+  return true;
+}
+
+bool TensorList::GetContiguousElements(int begin, int end, Tensor* out) const {
+  const Tensor& buffer = tensors_->buffer_;
+  if (!buffer.IsInitialized() || begin < 0 || begin >= end ||
+      end > buffer.dim_size(0) || end > tensors().size()) {
+    return false;
+  }
+  for (int i = begin; i < end; ++i) {
+    const Tensor& view = tensors_->buffer_views_[i];
+    const Tensor& element = tensors()[i];
+    if (!view.IsInitialized() || element.dtype() != view.dtype() ||
+        element.data() != view.data() || element.shape() != view.shape()) {
+      return false;
+    }
+  }
+  *out = buffer.Slice(begin, end);
+  return true;
+}
+
 void TensorList::Encode(VariantTensorData* data) const {
   data->set_type_name(TypeName());
   std::vector<size_t> invalid_indices;
@@ -38,6 +38,11 @@ namespace tensorflow {
 // a reference count.  Modifying b.tensors() modifies a.tensors().  In this way,
 // TensorList should be considered similar to the tf::Tensor object.
 //
+// A TensorList may also own a contiguous buffer holding all of its elements,
+// e.g. when it was reserved with a fully defined element shape: see
+// SetContiguousBuffer(). Its elements are then written into the buffer in
+// place, and read back as a single tensor without copying them.
+//
 // In order to get a copy of the underlying list, use the Copy method:
 //
 //    TensorList b = a.Copy();
@@ -127,6 +132,7 @@ class TensorList {
   const std::vector<Tensor>& tensors() const { return tensors_->values_; }
 
   // Get a new TensorList containing a copy of the underlying tensor container.
+  // The copy shares the elements, but not the contiguous buffer.
   TensorList Copy() const {
     TensorList out;
     out.element_shape = element_shape;
@@ -141,10 +147,32 @@ class TensorList {
   // container?
   bool RefCountIsOne() const { return tensors_->RefCountIsOne(); }
 
+  // Makes `buffer`, of shape [n] + element_shape, the contiguous storage of
+  // the first n elements of the list. Returns false, leaving the list
+  // unchanged, if the elements of `buffer` would not be aligned.
+  bool SetContiguousBuffer(Tensor buffer);
+
+  // Copies `value` into the element `index` of the contiguous buffer, and sets
+  // the element of the list to a view of it. The caller must own the list
+  // (see RefCountIsOne()), and `value` must be in host memory. Returns false,
+  // leaving the list unchanged, if the element is not in the buffer, if
+  // `value` has another shape or type, or if another tensor might still see
+  // the previous value of the element.
+  bool SetContiguousElement(int index, const Tensor& value);
+
+  // Sets `*out` to a view of the elements [begin, end) of the list and returns
+  // true if they all are in place in the contiguous buffer.
+  bool GetContiguousElements(int begin, int end, Tensor* out) const;
+
  private:
   class Tensors : public core::RefCounted {
    public:
     std::vector<Tensor> values_;
+    // The contiguous storage of the elements, if any, and the views of its
+    // elements that were set with SetContiguousElement().
+    Tensor buffer_;
+    std::vector<Tensor> buffer_views_;
+    int num_buffer_views_ = 0;
   };
   Tensors* tensors_;
 };
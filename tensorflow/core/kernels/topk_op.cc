@@ -129,6 +129,161 @@ class TopK : public OpKernel {
 
 namespace functor {
 
+// Rows with at least this many columns, and k small enough compared to them,
+// are split into blocks of columns whose top k are computed in parallel and
+// then merged.
+constexpr int64_t kMinStreamingTopKCols = 1 << 16;
+constexpr int64_t kMinStreamingTopKColsPerK = 8;
+// The minimum number of columns of a block.
+constexpr int64_t kMinStreamingTopKBlockCols = 1 << 14;
+// The columns are compared to the threshold this many at a time, in a loop
+// that the compiler can vectorize.
+constexpr int64_t kStreamingTopKChunkCols = 32;
+
+// Returns true iff input_data[a] comes before input_data[b] in the top k:
+// it is larger, or equal with a smaller index. NaNs come before all the other
+// values, so that this is a strict weak ordering as std::nth_element needs.
+template <typename T, typename Tidx>
+struct StableTopKComparator {
+  const T* input_data;
+  bool operator()(const Tidx a, const Tidx b) const {
+    const bool a_is_nan = Eigen::numext::isnan(input_data[a]);
+    const bool b_is_nan = Eigen::numext::isnan(input_data[b]);
+    if (a_is_nan || b_is_nan) {
+      return a_is_nan == b_is_nan ? a < b : a_is_nan;
+    }
+    if (input_data[b] < input_data[a]) {
+      return true;
+    } else if (input_data[b] > input_data[a]) {
+      return false;
+    } else {
+      return a < b;
+    }
+  }
+};
+
+// Appends to `candidates` at most k indices in [col_begin, col_end) that
+// include the top k of the columns of `input_data` in this range.
+//
+// The candidates are kept in a buffer of 2 * k indices. Whenever it is full,
+// it is cut down to its top k, and the smallest value of these becomes the
+// threshold: the next columns must be larger, or NaN, to be candidates, since
+// the equal ones have larger indices than the k kept ones. Most columns of
+// long rows are below the threshold, and only take a comparison to it.
+template <typename T, typename Tidx>
+void StreamingTopKBlock(const T* input_data, int k, int64_t col_begin,
+                        int64_t col_end, std::vector<Tidx>* candidates) {
+  const StableTopKComparator<T, Tidx> comp{input_data};
+  std::vector<Tidx> buffer;
+  buffer.reserve(2 * k);
+  const int64_t init_end = std::min<int64_t>(col_begin + k, col_end);
+  for (int64_t c = col_begin; c < init_end; ++c) buffer.push_back(c);
+  if (init_end < col_end) {
+    std::nth_element(buffer.begin(), buffer.begin() + (k - 1), buffer.end(),
+                     comp);
+    T threshold = input_data[buffer[k - 1]];
+    auto is_candidate = [&](int64_t c) {
+      return input_data[c] > threshold || Eigen::numext::isnan(input_data[c]);
+    };
+    auto push = [&](int64_t c) {
+      if (!is_candidate(c)) return;
+      buffer.push_back(c);
+      if (buffer.size() < 2 * static_cast<size_t>(k)) return;
+      std::nth_element(buffer.begin(), buffer.begin() + (k - 1), buffer.end(),
+                       comp);
+      buffer.resize(k);
+      threshold = input_data[buffer[k - 1]];
+    };
+    int64_t c = init_end;
+    for (; c + kStreamingTopKChunkCols <= col_end;
+         c += kStreamingTopKChunkCols) {
+      bool any_candidate = false;
+      for (int64_t j = 0; j < kStreamingTopKChunkCols; ++j) {
+        any_candidate |= is_candidate(c + j);
+      }
+      if (!any_candidate) continue;
+      for (int64_t j = 0; j < kStreamingTopKChunkCols; ++j) push(c + j);
+    }
+    for (; c < col_end; ++c) push(c);
+  }
+  if (buffer.size() > static_cast<size_t>(k)) {
+    std::nth_element(buffer.begin(), buffer.begin() + (k - 1), buffer.end(),
+                     comp);
+    buffer.resize(k);
+  }
+  candidates->insert(candidates->end(), buffer.begin(), buffer.end());
+}
+
+// Computes the top k of rows much longer than k by splitting each of them
+// into blocks of columns, computing the top k candidates of each block in
+// parallel, and merging the candidates of each row.
+template <typename T, typename Tidx>
+void StreamingTopK(OpKernelContext* context, bool sorted, int k,
+                   const typename TTypes<T, 2>::ConstTensor& input,
+                   const int64_t num_rows, const int64_t num_cols,
+                   typename TTypes<T, 2>::Tensor values,
+                   typename TTypes<Tidx, 2>::Tensor indices) {
+  auto worker_threads = *(context->device()->tensorflow_cpu_worker_threads());
+  const int64_t blocks_per_row = std::max<int64_t>(
+      1, std::min<int64_t>(
+             (worker_threads.num_threads + num_rows - 1) / num_rows,
+             num_cols / std::max<int64_t>(kMinStreamingTopKBlockCols, 2 * k)));
+  const int64_t cols_per_block =
+      (num_cols + blocks_per_row - 1) / blocks_per_row;
+  const int64_t num_blocks = num_rows * blocks_per_row;
+  std::vector<std::vector<Tidx>> block_candidates(num_blocks);
+
+  auto compute_blocks = [&](int64_t start_block, int64_t limit_block) {
+    for (int64_t i = start_block; i < limit_block; ++i) {
+      const int64_t b = i / blocks_per_row;
+      const int64_t col_begin = (i % blocks_per_row) * cols_per_block;
+      const int64_t col_end = std::min(col_begin + cols_per_block, num_cols);
+      block_candidates[i].reserve(k);
+      StreamingTopKBlock<T, Tidx>(&input(b, 0), k, col_begin, col_end,
+                                  &block_candidates[i]);
+    }
+  };
+  const double block_cost =
+      cols_per_block * (Eigen::TensorOpCost::AddCost<T>() +
+                        Eigen::TensorOpCost::AddCost<Tidx>());
+  Shard(worker_threads.num_threads, worker_threads.workers, num_blocks,
+        static_cast<int64_t>(block_cost), compute_blocks);
+
+  auto merge_rows = [&](int64_t start_batch, int64_t limit_batch) {
+    for (int64_t b = start_batch; b < limit_batch; ++b) {
+      const StableTopKComparator<T, Tidx> comp{&input(b, 0)};
+      std::vector<Tidx> candidates;
+      candidates.reserve(blocks_per_row * k);
+      for (int64_t i = b * blocks_per_row; i < (b + 1) * blocks_per_row; ++i) {
+        candidates.insert(candidates.end(), block_candidates[i].begin(),
+                          block_candidates[i].end());
+        block_candidates[i] = std::vector<Tidx>();
+      }
+      if (sorted) {
+        std::partial_sort(candidates.begin(), candidates.begin() + k,
+                          candidates.end(), comp);
+      } else {
+        // Output the top k in the order of their indices, so that equal
+        // values are still ordered by index.
+        std::nth_element(candidates.begin(), candidates.begin() + (k - 1),
+                         candidates.end(), comp);
+        std::sort(candidates.begin(), candidates.begin() + k);
+      }
+      for (int i = 0; i < k; ++i) {
+        indices(b, i) = candidates[i];
+        values(b, i) = input(b, candidates[i]);
+      }
+    }
+  };
+  const double cmp_cost = 3 * Eigen::TensorOpCost::AddCost<Tidx>() +
+                          Eigen::TensorOpCost::AddCost<T>();
+  const double merge_cost =
+      cmp_cost * blocks_per_row * k *
+      Eigen::numext::log2(static_cast<float>(k + 1));
+  Shard(worker_threads.num_threads, worker_threads.workers, num_rows,
+        static_cast<int64_t>(merge_cost), merge_rows);
+}
+
 template <typename T, typename Tidx>
 struct TopKFunctor<CPUDevice, T, Tidx> {
   static EIGEN_ALWAYS_INLINE Status Compute(
@@ -161,6 +316,13 @@ struct TopKFunctor<CPUDevice, T, Tidx> {
       return OkStatus();
     }
 
+    if (num_cols >= kMinStreamingTopKCols &&
+        k <= num_cols / kMinStreamingTopKColsPerK) {
+      StreamingTopK<T, Tidx>(context, sorted, k, input, num_rows, num_cols,
+                             values, indices);
+      return OkStatus();
+    }
+
     auto SortIndices = [&](int64_t start_batch, int64_t limit_batch) {
       for (int32_t b = start_batch; b < limit_batch; ++b) {
         const T* input_data = &input(b, 0);
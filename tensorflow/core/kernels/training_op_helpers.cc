@@ -15,6 +15,12 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/training_op_helpers.h"
 
+#include <cstdint>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 
@@ -26,4 +32,28 @@ void MaybeForwardRefInputToRefOutput(OpKernelContext* ctx, int input,
   }
 }
 
+bool UseSparseApplyRowLocks(OpKernelContext* ctx,
+                            const std::vector<int>& input_ids) {
+  static const bool use_row_locks = [] {
+    bool use_row_locks = false;
+    const absl::Status status = ReadBoolFromEnvVar(
+        "TF_SPARSE_APPLY_USE_ROW_LOCKS", /*default_val=*/false, &use_row_locks);
+    if (!status.ok()) LOG(ERROR) << status;
+    return use_row_locks;
+  }();
+  if (!use_row_locks) return false;
+  for (int input : input_ids) {
+    if (ctx->input_dtype(input) != DT_RESOURCE) return false;
+  }
+  return true;
+}
+
+tsl::mutex* SparseApplyRowMutex(const void* row) {
+  // A prime number of mutexes spreads rows of any size evenly.
+  constexpr int kNumRowMutexes = 1031;
+  static tsl::mutex* row_mutexes = new tsl::mutex[kNumRowMutexes];
+  return &row_mutexes[(reinterpret_cast<uintptr_t>(row) / sizeof(float)) %
+                      kNumRowMutexes];
+}
+
 }  // end namespace tensorflow
@@ -226,6 +226,21 @@ VariableInputLockHolder MaybeLockVariableInputMutexesInOrder(
 void MaybeForwardRefInputToRefOutput(OpKernelContext* ctx, int input,
                                      int output);
 
+// Returns true if a sparse update with use_locking=true of the variables
+// `input_ids` in `ctx` should only hold shared locks on the variables, as with
+// use_locking=false, and lock each row of them while it is updated, with
+// SparseApplyRowMutex(). Concurrent updates of different rows then run in
+// parallel, while the updates of each row stay atomic. Enabled by the
+// TF_SPARSE_APPLY_USE_ROW_LOCKS environment variable, for resource variables
+// only: the updates of reference variables need their exclusive locks.
+bool UseSparseApplyRowLocks(OpKernelContext* ctx,
+                            const std::vector<int>& input_ids);
+
+// Returns the mutex of `row`, the first element of a row of a variable
+// updated with row locks. The rows of all the variables are spread over a
+// fixed number of mutexes.
+tsl::mutex* SparseApplyRowMutex(const void* row);
+
 // This is for use with ResourceVariables to ensure *tensor has a
 // reference count of 1 before you update it.
 // REQUIRES: If you pass in variable->tensor(), *variable->mu() must be held.
@@ -17,6 +17,7 @@ limitations under the License.
 #include "tensorflow/core/kernels/training_ops.h"
 
 #include <algorithm>  // NOLINT
+#include <optional>
 
 #include "tensorflow/core/framework/bounds_check.h"
 #include "tensorflow/core/framework/op_kernel.h"
@@ -170,7 +171,7 @@ struct SparseApplyAdagrad<CPUDevice, T, Tindex, has_epsilon> {
                     typename TTypes<T>::ConstScalar epsilon,
                     typename TTypes<T>::ConstMatrix grad,
                     typename TTypes<Tindex>::ConstVec indices,
-                    int64_t inner_dim, bool update_slots) {
+                    int64_t inner_dim, bool update_slots, bool lock_rows) {
     const Tindex N = static_cast<Tindex>(indices.dimension(0));
     if (N == 0) return OkStatus();
     const Tindex first_dim_size = static_cast<Tindex>(var.dimension(0));
@@ -197,6 +198,8 @@ struct SparseApplyAdagrad<CPUDevice, T, Tindex, has_epsilon> {
           auto a = accum.template chip<0>(index);
           auto g = grad.template chip<0>(i);
           auto v = var.template chip<0>(index);
+          std::optional<mutex_lock> row_lock;
+          if (lock_rows) row_lock.emplace(*SparseApplyRowMutex(&var(index, 0)));
           if (update_slots) {
             a += g.square();
           }
@@ -224,6 +227,8 @@ struct SparseApplyAdagrad<CPUDevice, T, Tindex, has_epsilon> {
           const Tindex index = internal::SubtleMustCopy(indices(i));
           T& a = accum(index);
           const T& g = grad(i);
+          std::optional<mutex_lock> row_lock;
+          if (lock_rows) row_lock.emplace(*SparseApplyRowMutex(&var(index)));
           if (update_slots) {
             a += g * g;
           }
@@ -597,7 +602,8 @@ struct SparseApplyFtrl<CPUDevice, T, Tindex, has_l2_shrinkage> {
                     typename TTypes<T>::ConstScalar lr_power,
                     typename TTypes<T>::ConstMatrix grad_flat,
                     typename TTypes<Tindex>::ConstVec indices_vec,
-                    int64_t inner_dim, bool multiply_linear_by_lr) {
+                    int64_t inner_dim, bool multiply_linear_by_lr,
+                    bool lock_rows) {
     const Tindex N = static_cast<Tindex>(indices_vec.dimension(0));
     if (N > 0) {
       T lr_scalar = lr();
@@ -623,6 +629,10 @@ struct SparseApplyFtrl<CPUDevice, T, Tindex, has_l2_shrinkage> {
           auto linear = linear_flat.template chip<0>(index);
           auto grad = grad_flat.template chip<0>(i);
           auto var = var_flat.template chip<0>(index);
+          std::optional<mutex_lock> row_lock;
+          if (lock_rows) {
+            row_lock.emplace(*SparseApplyRowMutex(&var_flat(index, 0)));
+          }
 
           if (has_l2_shrinkage) {
             auto grad_with_shrinkage =
@@ -656,6 +666,8 @@ struct SparseApplyFtrl<CPUDevice, T, Tindex, has_l2_shrinkage> {
           T& a = accum_flat(index);
           T& l = linear_flat(index);
           T& v = var_flat(index);
+          std::optional<mutex_lock> row_lock;
+          if (lock_rows) row_lock.emplace(*SparseApplyRowMutex(&v));
           T g;
           if (has_l2_shrinkage) {
             g = grad_flat(i) +
@@ -1888,8 +1900,12 @@ class SparseApplyAdagradOp : public OpKernel {
 
   void Compute(OpKernelContext* ctx) override TF_NO_THREAD_SAFETY_ANALYSIS {
     const bool sparse = true;
+    // With row locks, the variables are only locked for shared access.
+    const bool lock_rows = use_exclusive_lock_ &&
+                           std::is_same<Device, CPUDevice>::value &&
+                           UseSparseApplyRowLocks(ctx, {0, 1});
     auto locks = MaybeLockVariableInputMutexesInOrder<Device, T>(
-        ctx, use_exclusive_lock_, sparse, {0, 1});
+        ctx, use_exclusive_lock_ && !lock_rows, sparse, {0, 1});
     Tensor var;
     OP_REQUIRES_OK(ctx, GetInputTensorFromVariable<Device, T>(
                             ctx, 0, use_exclusive_lock_, sparse, &var));
@@ -1945,7 +1961,7 @@ class SparseApplyAdagradOp : public OpKernel {
                  device, var.flat_outer_dims<T>(), accum.flat_outer_dims<T>(),
                  // Note: Passing lr as a placeholder for unused epsilon.
                  lr.scalar<T>(), lr.scalar<T>(), grad.flat_outer_dims<T>(),
-                 indices.vec<Tindex>(), inner_dim, update_slots_));
+                 indices.vec<Tindex>(), inner_dim, update_slots_, lock_rows));
 
     MaybeForwardRefInputToRefOutput(ctx, 0, 0);
   }
@@ -1987,7 +2003,7 @@ namespace functor {
       typename TTypes<T>::ConstScalar epsilon,                                 \
       typename TTypes<T>::ConstMatrix grad,                                    \
       typename TTypes<Tindex>::ConstVec indices, int64_t inner_dim,            \
-      bool update_slots);                                                      \
+      bool update_slots, bool lock_rows);                                      \
   extern template struct SparseApplyAdagrad<GPUDevice, T, Tindex,              \
                                             /*has_epsilon=*/false>;
 DECLARE_GPU_SPEC(Eigen::half, int32);
@@ -2018,8 +2034,12 @@ class SparseApplyAdagradV2Op : public OpKernel {
 
   void Compute(OpKernelContext* ctx) override TF_NO_THREAD_SAFETY_ANALYSIS {
     const bool sparse = true;
+    // With row locks, the variables are only locked for shared access.
+    const bool lock_rows = use_exclusive_lock_ &&
+                           std::is_same<Device, CPUDevice>::value &&
+                           UseSparseApplyRowLocks(ctx, {0, 1});
     auto locks = MaybeLockVariableInputMutexesInOrder<Device, T>(
-        ctx, use_exclusive_lock_, sparse, {0, 1});
+        ctx, use_exclusive_lock_ && !lock_rows, sparse, {0, 1});
     Tensor var;
     OP_REQUIRES_OK(ctx, GetInputTensorFromVariable<Device, T>(
                             ctx, 0, use_exclusive_lock_, sparse, &var));
@@ -2078,7 +2098,7 @@ class SparseApplyAdagradV2Op : public OpKernel {
                                          /*has_epsilon = */ true>()(
                  device, var.flat_outer_dims<T>(), accum.flat_outer_dims<T>(),
                  lr.scalar<T>(), epsilon.scalar<T>(), grad.flat_outer_dims<T>(),
-                 indices.vec<Tindex>(), inner_dim, update_slots_));
+                 indices.vec<Tindex>(), inner_dim, update_slots_, lock_rows));
 
     MaybeForwardRefInputToRefOutput(ctx, 0, 0);
   }
@@ -2120,7 +2140,7 @@ namespace functor {
       typename TTypes<T>::ConstScalar epsilon,                                \
       typename TTypes<T>::ConstMatrix grad,                                   \
       typename TTypes<Tindex>::ConstVec indices, int64_t inner_dim,           \
-      bool update_slots);                                                     \
+      bool update_slots, bool lock_rows);                                     \
   extern template struct SparseApplyAdagrad<GPUDevice, T, Tindex,             \
                                             /*has_epsilon=*/true>;
 DECLARE_GPU_SPEC(Eigen::half, int32);
@@ -2806,8 +2826,12 @@ class SparseApplyFtrlOp : public OpKernel {
 
   void Compute(OpKernelContext* ctx) override TF_NO_THREAD_SAFETY_ANALYSIS {
     const bool sparse = true;
+    // With row locks, the variables are only locked for shared access.
+    const bool lock_rows = use_exclusive_lock_ &&
+                           std::is_same<Device, CPUDevice>::value &&
+                           UseSparseApplyRowLocks(ctx, {0, 1, 2});
     auto locks = MaybeLockVariableInputMutexesInOrder<Device, T>(
-        ctx, use_exclusive_lock_, sparse, {0, 1, 2});
+        ctx, use_exclusive_lock_ && !lock_rows, sparse, {0, 1, 2});
     Tensor var;
     OP_REQUIRES_OK(ctx, GetInputTensorFromVariable<Device, T>(
                             ctx, 0, use_exclusive_lock_, sparse, &var));
@@ -2928,7 +2952,7 @@ class SparseApplyFtrlOp : public OpKernel {
                  // (it will not be used).
                  has_l2_shrinkage ? l2_shrinkage->scalar<T>() : l2.scalar<T>(),
                  lr_power.scalar<T>(), grad.flat_outer_dims<T>(), indices_vec,
-                 inner_dim, multiply_linear_by_lr_));
+                 inner_dim, multiply_linear_by_lr_, lock_rows));
 
     MaybeForwardRefInputToRefOutput(ctx, 0, 0);
   }
@@ -2977,7 +3001,7 @@ namespace functor {
       typename TTypes<T>::ConstScalar lr_power,                               \
       typename TTypes<T>::ConstMatrix grad,                                   \
       typename TTypes<Tindex>::ConstVec indices, int64_t inner_dim,           \
-      bool multiply_linear_by_lr);                                            \
+      bool multiply_linear_by_lr, bool lock_rows);                            \
   extern template struct SparseApplyFtrl<GPUDevice, T, Tindex,                \
                                          /*has_l2_shrinkage=*/false>;
 DECLARE_GPU_SPEC(Eigen::half, int32);
@@ -3037,7 +3061,7 @@ namespace functor {
       typename TTypes<T>::ConstScalar lr_power,                               \
       typename TTypes<T>::ConstMatrix grad,                                   \
       typename TTypes<Tindex>::ConstVec indices, int64_t inner_dim,           \
-      bool multiply_linear_by_lr);                                            \
+      bool multiply_linear_by_lr, bool lock_rows);                            \
   extern template struct SparseApplyFtrl<GPUDevice, T, Tindex,                \
                                          /*has_l2_shrinkage=*/true>;
 DECLARE_GPU_SPEC(Eigen::half, int32);
@@ -106,14 +106,15 @@ struct ApplyAdagradDA {
 
 template <typename Device, typename T, typename Tindex, bool has_epsilon>
 struct SparseApplyAdagrad {
-  // Note that epsilon is ignored if has_epsilon is false.
+  // Note that epsilon is ignored if has_epsilon is false. If lock_rows is true,
+  // each row is updated under its SparseApplyRowMutex().
   Status operator()(const Device& d, typename TTypes<T>::Matrix var,
                     typename TTypes<T>::Matrix accum,
                     typename TTypes<T>::ConstScalar lr,
                     typename TTypes<T>::ConstScalar epsilon,
                     typename TTypes<T>::ConstMatrix grad,
                     typename TTypes<Tindex>::ConstVec indices,
-                    int64_t inner_dim, bool update_slots);
+                    int64_t inner_dim, bool update_slots, bool lock_rows);
 };
 
 template <typename Device, typename T>
@@ -190,6 +191,7 @@ struct ApplyFtrlV2MultiplyLinearByLr {
 
 template <typename Device, typename T, typename Tindex, bool has_l2_shrinkage>
 struct SparseApplyFtrl {
+  // If lock_rows is true, each row is updated under its SparseApplyRowMutex().
   Status operator()(const Device& d, typename TTypes<T>::Matrix var_flat,
                     typename TTypes<T>::Matrix accum_flat,
                     typename TTypes<T>::Matrix linear_flat,
@@ -200,7 +202,8 @@ struct SparseApplyFtrl {
                     typename TTypes<T>::ConstScalar lr_power,
                     typename TTypes<T>::ConstMatrix grad_flat,
                     typename TTypes<Tindex>::ConstVec indices_vec,
-                    int64_t inner_dim, bool multiply_linear_by_lr);
+                    int64_t inner_dim, bool multiply_linear_by_lr,
+                    bool lock_rows);
 };
 
 template <typename Device, typename T>
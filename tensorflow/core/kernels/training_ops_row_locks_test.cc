@@ -0,0 +1,223 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Tests the sparse updates of resource variables with
+// TF_SPARSE_APPLY_USE_ROW_LOCKS set, against the same updates of reference
+// variables, which keep their exclusive locks. The environment variable is read
+// once per process, so it is set for all the tests of this binary.
+
+#include <stdlib.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/resource_var.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+constexpr int kRows = 16;
+constexpr int kCols = 8;
+
+// Runs a sparse update kernel on its own CPU device. The first `vars.size()`
+// inputs of the kernel are the variable and its slots, the others `args`.
+class SparseApplyKernel : public OpsTestBase {
+ public:
+  void TestBody() override {}
+
+  // Sets the kernel up to update `vars` in place, as reference variables.
+  Status InitOnRefs(const std::string& op, std::vector<Tensor>& vars,
+                    const std::vector<Tensor>& args) {
+    TF_RETURN_IF_ERROR(Init(op, vars.size(), DT_FLOAT_REF, args));
+    for (Tensor& var : vars) {
+      Tensor* input = AddInput(DT_FLOAT, var.shape());
+      *input = var;
+    }
+    AddArgs(args);
+    return absl::OkStatus();
+  }
+
+  // Sets the kernel up to update `vars`, as resource variables.
+  Status InitOnResources(const std::string& op, const std::vector<Var*>& vars,
+                         const std::vector<Tensor>& args) {
+    TF_RETURN_IF_ERROR(
+        Init(absl::StrCat("Resource", op), vars.size(), DT_RESOURCE, args));
+    for (size_t i = 0; i < vars.size(); ++i) {
+      // The resource manager of the device takes one reference.
+      vars[i]->Ref();
+      AddResourceInput<Var>("", absl::StrCat("var", i), vars[i]);
+    }
+    AddArgs(args);
+    return absl::OkStatus();
+  }
+
+ private:
+  Status Init(const std::string& op, int num_vars, DataType var_type,
+              const std::vector<Tensor>& args) {
+    NodeDefBuilder builder("update", op);
+    for (int i = 0; i < num_vars; ++i) builder.Input(FakeInput(var_type));
+    for (const Tensor& arg : args) builder.Input(FakeInput(arg.dtype()));
+    TF_RETURN_IF_ERROR(builder.Attr("use_locking", true).Finalize(node_def()));
+    return InitOp();
+  }
+
+  void AddArgs(const std::vector<Tensor>& args) {
+    for (const Tensor& arg : args) {
+      *AddInput(arg.dtype(), arg.shape()) = arg;
+    }
+  }
+};
+
+class SparseApplyRowLocksTest : public ::testing::Test {
+ protected:
+  SparseApplyRowLocksTest() {
+    setenv("TF_SPARSE_APPLY_USE_ROW_LOCKS", "true", /*overwrite=*/1);
+  }
+
+  static Tensor Matrix(float value) {
+    Tensor matrix(DT_FLOAT, TensorShape({kRows, kCols}));
+    matrix.flat<float>().setConstant(value);
+    return matrix;
+  }
+
+  static Tensor RandomMatrix(int rows) {
+    Tensor matrix(DT_FLOAT, TensorShape({rows, kCols}));
+    matrix.flat<float>().setRandom();
+    return matrix;
+  }
+
+  // Returns `vars` after `num_threads` threads each ran `num_steps` times
+  // `op` on them, as resource variables with row locks.
+  static std::vector<Tensor> RunOnResources(const std::string& op,
+                                            const std::vector<Tensor>& vars,
+                                            const std::vector<Tensor>& args,
+                                            int num_threads, int num_steps) {
+    std::vector<core::RefCountPtr<Var>> resources;
+    std::vector<Var*> resource_ptrs;
+    for (const Tensor& var : vars) {
+      resources.emplace_back(new Var(DT_FLOAT));
+      *resources.back()->tensor() = tensor::DeepCopy(var);
+      resources.back()->is_initialized = true;
+      resource_ptrs.push_back(resources.back().get());
+    }
+
+    std::vector<std::unique_ptr<SparseApplyKernel>> kernels;
+    for (int i = 0; i < num_threads; ++i) {
+      kernels.push_back(std::make_unique<SparseApplyKernel>());
+      TF_CHECK_OK(kernels.back()->InitOnResources(op, resource_ptrs, args));
+    }
+    {
+      std::vector<std::unique_ptr<Thread>> threads;
+      for (int i = 0; i < num_threads; ++i) {
+        threads.emplace_back(Env::Default()->StartThread(
+            {}, absl::StrCat("update_", i), [&kernels, i, num_steps]() {
+              for (int step = 0; step < num_steps; ++step) {
+                TF_CHECK_OK(kernels[i]->RunOpKernel());
+              }
+            }));
+      }
+    }
+
+    std::vector<Tensor> results;
+    for (const auto& resource : resources) {
+      results.push_back(*resource->tensor());
+    }
+    return results;
+  }
+
+  // Returns `vars` after running `op` `num_steps` times on them, as reference
+  // variables under their exclusive locks.
+  static std::vector<Tensor> RunOnRefs(const std::string& op,
+                                       const std::vector<Tensor>& vars,
+                                       const std::vector<Tensor>& args,
+                                       int num_steps) {
+    std::vector<Tensor> refs;
+    for (const Tensor& var : vars) refs.push_back(tensor::DeepCopy(var));
+    SparseApplyKernel kernel;
+    TF_CHECK_OK(kernel.InitOnRefs(op, refs, args));
+    for (int step = 0; step < num_steps; ++step) {
+      TF_CHECK_OK(kernel.RunOpKernel());
+    }
+    return refs;
+  }
+
+  static void ExpectSameResults(const std::string& op,
+                                const std::vector<Tensor>& vars,
+                                const std::vector<Tensor>& args,
+                                int num_threads, int num_steps) {
+    std::vector<Tensor> expected =
+        RunOnRefs(op, vars, args, num_threads * num_steps);
+    std::vector<Tensor> results =
+        RunOnResources(op, vars, args, num_threads, num_steps);
+    ASSERT_EQ(results.size(), expected.size());
+    for (size_t i = 0; i < results.size(); ++i) {
+      test::ExpectTensorNear<float>(results[i], expected[i], 1e-5);
+    }
+  }
+
+  static std::vector<Tensor> AdagradArgs(const Tensor& indices) {
+    return {test::AsScalar<float>(0.01f), RandomMatrix(indices.NumElements()),
+            indices};
+  }
+
+  static std::vector<Tensor> FtrlArgs(const Tensor& indices) {
+    return {RandomMatrix(indices.NumElements()), indices,
+            test::AsScalar<float>(0.01f), test::AsScalar<float>(0.001f),
+            test::AsScalar<float>(0.0f), test::AsScalar<float>(-0.5f)};
+  }
+};
+
+TEST_F(SparseApplyRowLocksTest, AdagradWithDuplicateIndices) {
+  const Tensor indices = test::AsTensor<int32>({1, 5, 1, 1, 12, 5});
+  ExpectSameResults("SparseApplyAdagrad", {RandomMatrix(kRows), Matrix(0.1f)},
+                    AdagradArgs(indices), /*num_threads=*/1,
+                    /*num_steps=*/1);
+}
+
+TEST_F(SparseApplyRowLocksTest, FtrlWithDuplicateIndices) {
+  const Tensor indices = test::AsTensor<int32>({1, 5, 1, 1, 12, 5});
+  ExpectSameResults("SparseApplyFtrl",
+                    {RandomMatrix(kRows), Matrix(0.1f), Matrix(0.0f)},
+                    FtrlArgs(indices), /*num_threads=*/1, /*num_steps=*/1);
+}
+
+// All the threads apply the same gradients to rows that are distinct within a
+// batch, so every order of the row updates gives the same results.
+TEST_F(SparseApplyRowLocksTest, ConcurrentAdagradUpdates) {
+  const Tensor indices = test::AsTensor<int32>({0, 3, 7, 8, 15});
+  ExpectSameResults("SparseApplyAdagrad", {RandomMatrix(kRows), Matrix(0.1f)},
+                    AdagradArgs(indices), /*num_threads=*/8,
+                    /*num_steps=*/50);
+}
+
+TEST_F(SparseApplyRowLocksTest, ConcurrentFtrlUpdates) {
+  const Tensor indices = test::AsTensor<int32>({0, 3, 7, 8, 15});
+  ExpectSameResults("SparseApplyFtrl",
+                    {RandomMatrix(kRows), Matrix(0.1f), Matrix(0.0f)},
+                    FtrlArgs(indices), /*num_threads=*/8, /*num_steps=*/50);
+}
+
+}  // namespace
+}  // namespace tensorflow
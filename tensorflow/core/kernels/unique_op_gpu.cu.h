@@ -20,6 +20,9 @@ limitations under the License.
 
 #define EIGEN_USE_GPU
 
+#include <limits>
+#include <type_traits>
+
 #include "unsupported/Eigen/CXX11/Tensor"  // from @eigen_archive
 #include "tensorflow/core/common_runtime/gpu/gpu_event_mgr.h"
 #include "tensorflow/core/framework/op_kernel.h"
@@ -170,6 +173,178 @@ Status LookupAndScatterUniqueIds(const GPUDevice& d, int64_t input_size,
                          sorted_input_unique_ids, inv_sorted_unique_perm, idx);
 }
 
+// The hash table algorithm is used for integer inputs of at least this size.
+// For smaller inputs, sorting them is faster.
+constexpr int64_t kMinHashTableInputSize = 1 << 20;
+// The number of slots of the hash table per input element.
+constexpr int64_t kHashTableSlotsPerElement = 2;
+
+template <typename T>
+__device__ uint64 HashUniqueKey(T key) {
+  // The finalizer of MurmurHash3, which mixes all the bits of the key into
+  // the low bits used to select a slot.
+  uint64 h = static_cast<uint64>(key);
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdull;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53ull;
+  h ^= h >> 33;
+  return h;
+}
+
+template <typename TIndex>
+__device__ TIndex AtomicCasIndex(TIndex* ptr, TIndex compare, TIndex value) {
+  using CasType = tensorflow::detail::CudaSupportedType<TIndex>;
+  return static_cast<TIndex>(
+      atomicCAS(tensorflow::detail::ToCudaSupportedPtr(ptr),
+                static_cast<CasType>(compare), static_cast<CasType>(value)));
+}
+
+template <typename TIndex>
+__global__ void InitHashTableKernel(int64_t num_slots, int64_t input_size,
+                                    TIndex* __restrict__ table,
+                                    TIndex* __restrict__ first_input_inds,
+                                    TIndex* __restrict__ slot_counts) {
+  GPU_1D_KERNEL_LOOP(i, num_slots) {
+    table[i] = -1;
+    first_input_inds[i] = input_size;
+    if (slot_counts) slot_counts[i] = 0;
+  }
+}
+
+// Inserts each input value in the open addressing table, as the index of its
+// first insertion, and records its slot, the index of its first occurrence in
+// the input and the number of its occurrences.
+template <typename T, typename TIndex>
+__global__ void InsertInHashTableKernel(int64_t input_size, int64_t num_slots,
+                                        const T* __restrict__ input,
+                                        TIndex* __restrict__ table,
+                                        TIndex* __restrict__ first_input_inds,
+                                        TIndex* __restrict__ slot_counts,
+                                        TIndex* __restrict__ input_slots) {
+  GPU_1D_KERNEL_LOOP(i, input_size) {
+    const T key = input[i];
+    TIndex slot = HashUniqueKey(key) % num_slots;
+    while (true) {
+      // The slots only ever change from empty to their final value, so a
+      // stale read of an empty slot is caught by the compare-and-swap.
+      TIndex entry = table[slot];
+      if (entry < 0) {
+        entry = AtomicCasIndex(table + slot, TIndex(-1), TIndex(i));
+        if (entry < 0) break;
+      }
+      if (input[entry] == key) break;
+      slot = slot + 1 == num_slots ? 0 : slot + 1;
+    }
+    input_slots[i] = slot;
+    GpuAtomicMin(first_input_inds + slot, TIndex(i));
+    if (slot_counts) GpuAtomicAdd(slot_counts + slot, TIndex(1));
+  }
+}
+
+// Builds the hash table of the input values, and fills input_slots with the
+// slot of each input value, first_input_inds with the index of the first
+// occurrence of the value of each slot, and slot_counts (if not nullptr) with
+// the number of its occurrences.
+template <typename T, typename TIndex>
+Status BuildHashTable(const GPUDevice& d, int64_t input_size,
+                      int64_t num_slots, const T* input, TIndex* table,
+                      TIndex* first_input_inds, TIndex* slot_counts,
+                      TIndex* input_slots) {
+  CHECK_GT(input_size, 0);  // Crash OK
+  GpuLaunchConfig init_config = GetGpuLaunchConfig(
+      num_slots, d, &InitHashTableKernel<TIndex>,
+      /*dynamic_shared_memory_size=*/0, /*block_size_limit=*/0);
+  TF_RETURN_IF_ERROR(GpuLaunchKernel(
+      InitHashTableKernel<TIndex>, init_config.block_count,
+      init_config.thread_per_block, 0, d.stream(), num_slots, input_size,
+      table, first_input_inds, slot_counts));
+  GpuLaunchConfig config = GetGpuLaunchConfig(
+      input_size, d, &InsertInHashTableKernel<T, TIndex>,
+      /*dynamic_shared_memory_size=*/0, /*block_size_limit=*/0);
+  return GpuLaunchKernel(InsertInHashTableKernel<T, TIndex>,
+                         config.block_count, config.thread_per_block, 0,
+                         d.stream(), input_size, num_slots, input, table,
+                         first_input_inds, slot_counts, input_slots);
+}
+
+// Returns true iff index is the first occurrence of its value, except for the
+// first one, so that the prefix sum gives the unique IDs in order of
+// appearance.
+template <typename TIndex>
+struct FirstOccurrenceIndicatorFunctor {
+  const TIndex* __restrict__ input_slots_;
+  const TIndex* __restrict__ first_input_inds_;
+  FirstOccurrenceIndicatorFunctor(const TIndex* input_slots,
+                                  const TIndex* first_input_inds)
+      : input_slots_(input_slots), first_input_inds_(first_input_inds) {}
+  __device__ TIndex operator()(const TIndex& i) const {
+    return i > 0 && first_input_inds_[input_slots_[i]] == i;
+  }
+};
+
+template <typename T, typename TIndex>
+__global__ void GatherHashTableOutputsKernel(
+    int64_t input_size, const T* __restrict__ input,
+    const TIndex* __restrict__ input_slots,
+    const TIndex* __restrict__ input_unique_ids,
+    const TIndex* __restrict__ slot_counts, T* __restrict__ output,
+    TIndex* __restrict__ slot_unique_ids, TIndex* __restrict__ count) {
+  GPU_1D_KERNEL_LOOP(i, input_size) {
+    const TIndex unique_id = input_unique_ids[i];
+    if (i == 0 || unique_id != input_unique_ids[i - 1]) {
+      const TIndex slot = input_slots[i];
+      output[unique_id] = input[i];
+      slot_unique_ids[slot] = unique_id;
+      if (count) count[unique_id] = slot_counts[slot];
+    }
+  }
+}
+
+// Writes the value and the count (if count is not nullptr) of each unique ID
+// at its first occurrence, and maps the slot of the value to the unique ID in
+// slot_unique_ids.
+template <typename T, typename TIndex>
+Status GatherHashTableOutputs(const GPUDevice& d, int64_t input_size,
+                              const T* input, const TIndex* input_slots,
+                              const TIndex* input_unique_ids,
+                              const TIndex* slot_counts, T* output,
+                              TIndex* slot_unique_ids, TIndex* count) {
+  CHECK_GT(input_size, 0);  // Crash OK
+  GpuLaunchConfig config = GetGpuLaunchConfig(
+      input_size, d, &GatherHashTableOutputsKernel<T, TIndex>,
+      /*dynamic_shared_memory_size=*/0, /*block_size_limit=*/0);
+  return GpuLaunchKernel(GatherHashTableOutputsKernel<T, TIndex>,
+                         config.block_count, config.thread_per_block, 0,
+                         d.stream(), input_size, input, input_slots,
+                         input_unique_ids, slot_counts, output,
+                         slot_unique_ids, count);
+}
+
+template <typename TIndex>
+__global__ void LookupHashTableUniqueIdsKernel(
+    int64_t input_size, const TIndex* __restrict__ input_slots,
+    const TIndex* __restrict__ slot_unique_ids, TIndex* __restrict__ idx) {
+  GPU_1D_KERNEL_LOOP(i, input_size) {
+    idx[i] = slot_unique_ids[input_slots[i]];
+  }
+}
+
+// Maps the slot of each input value to its unique ID.
+template <typename TIndex>
+Status LookupHashTableUniqueIds(const GPUDevice& d, int64_t input_size,
+                                const TIndex* input_slots,
+                                const TIndex* slot_unique_ids, TIndex* idx) {
+  CHECK_GT(input_size, 0);  // Crash OK
+  GpuLaunchConfig config = GetGpuLaunchConfig(
+      input_size, d, &LookupHashTableUniqueIdsKernel<TIndex>,
+      /*dynamic_shared_memory_size=*/0, /*block_size_limit=*/0);
+  return GpuLaunchKernel(LookupHashTableUniqueIdsKernel<TIndex>,
+                         config.block_count, config.thread_per_block, 0,
+                         d.stream(), input_size, input_slots, slot_unique_ids,
+                         idx);
+}
+
 }  // namespace unique_op_gpu
 
 // This only supports Unique[WithCounts], not Unique[WithCounts]V2.
@@ -225,6 +400,16 @@ class UniqueOpGPU : public AsyncOpKernel {
       return;
     }
 
+    if constexpr (std::is_integral<T>::value) {
+      // The slots of the hash table are indexed with TIndex.
+      if (input_size >= unique_op_gpu::kMinHashTableInputSize &&
+          input_size <= std::numeric_limits<TIndex>::max() /
+                            unique_op_gpu::kHashTableSlotsPerElement) {
+        ComputeWithHashTable(context, input, has_count_output, done);
+        return;
+      }
+    }
+
     // The algorithm implemented here is as follows:
     // input = [3, 5, 3, 4, 1, 4, 9, 8, 6, 3, 5, 7, 8, 8, 4, 6, 4, 2, 5, 6]
     // 1) Sort the input to group equal values together in segments.
@@ -438,6 +623,153 @@ class UniqueOpGPU : public AsyncOpKernel {
       done();
     };
 
+    context->device()
+        ->tensorflow_accelerator_device_info()
+        ->event_mgr->ThenExecute(stream, async_finish_computation);
+  }
+
+ private:
+  // Computes the outputs with a hash table instead of sorting the input, which
+  // takes less time and temporary memory for large inputs.
+  // 1) Insert the input values in an open addressing table, recording the slot
+  //    of each value, the index of the first occurrence of the value of each
+  //    slot and (if necessary) its count.
+  //      input_slots, first_input_inds, slot_counts = insert(input)
+  // 2) Use prefix sum over the first occurrences to compute the unique ID of
+  //    each input value in order of first appearance.
+  //      input_unique_ids = prefix_sum(first_input_inds[input_slots] == i)
+  // 3) Write the value and count of each unique ID at its first occurrence,
+  //    and map the slots to the unique IDs.
+  //      output[input_unique_ids] = input (@ first occurrences)
+  //      slot_unique_ids[input_slots] = input_unique_ids (@ first occurrences)
+  // 4) Look up the unique ID of each input value from its slot.
+  //      idx = slot_unique_ids[input_slots]
+  void ComputeWithHashTable(OpKernelContext* context, const Tensor& input,
+                            bool has_count_output, DoneCallback done) {
+    using namespace unique_op_gpu;
+    const GPUDevice& device = context->eigen_gpu_device();
+    se::Stream* stream = context->op_device_context()->stream();
+    const int64_t input_size = input.NumElements();
+    const int64_t num_slots = kHashTableSlotsPerElement * input_size;
+    const T* input_ptr = input.flat<T>().data();
+
+    Tensor table;
+    TIndex* table_ptr = nullptr;
+    AllocateTemp(context, num_slots, &table, &table_ptr, done);
+    if (!context->status().ok()) return;
+
+    Tensor first_input_inds;
+    TIndex* first_input_inds_ptr = nullptr;
+    AllocateTemp(context, num_slots, &first_input_inds, &first_input_inds_ptr,
+                 done);
+    if (!context->status().ok()) return;
+
+    Tensor slot_counts;
+    TIndex* slot_counts_ptr = nullptr;
+    if (has_count_output) {
+      AllocateTemp(context, num_slots, &slot_counts, &slot_counts_ptr, done);
+      if (!context->status().ok()) return;
+    }
+
+    Tensor input_slots;
+    TIndex* input_slots_ptr = nullptr;
+    AllocateTemp(context, input_size, &input_slots, &input_slots_ptr, done);
+    if (!context->status().ok()) return;
+
+    OP_REQUIRES_OK_ASYNC(
+        context,
+        BuildHashTable(device, input_size, num_slots, input_ptr, table_ptr,
+                       first_input_inds_ptr, slot_counts_ptr, input_slots_ptr),
+        done);
+
+    // Free temporary tensor that is no longer needed.
+    table = Tensor();
+    table_ptr = nullptr;
+
+    gpuprim::CountingInputIterator<TIndex> counting_iter(0);
+    gpuprim::TransformInputIterator<TIndex,
+                                    FirstOccurrenceIndicatorFunctor<TIndex>,
+                                    gpuprim::CountingInputIterator<TIndex>>
+        first_occurrence_iter(counting_iter,
+                              {input_slots_ptr, first_input_inds_ptr});
+
+    Tensor input_unique_ids;
+    TIndex* input_unique_ids_ptr = nullptr;
+    AllocateTemp(context, input_size, &input_unique_ids, &input_unique_ids_ptr,
+                 done);
+    if (!context->status().ok()) return;
+
+    OP_REQUIRES_OK_ASYNC(
+        context,
+        GpuInclusivePrefixSum(context, input_size, first_occurrence_iter,
+                              input_unique_ids_ptr),
+        done);
+
+    // Copy the last element of input_unique_ids back to the host to obtain
+    // uniq_size.
+    ScratchSpace<TIndex> last_idx_host(context, 1, /*on_host=*/true);
+    OP_REQUIRES_OK_ASYNC(
+        context,
+        stream->Memcpy(last_idx_host.mutable_data(),
+                       se::DeviceMemoryBase(
+                           input_unique_ids_ptr + (input_size - 1),
+                           sizeof(*last_idx_host.data())),
+                       sizeof(*last_idx_host.data())),
+        done);
+
+    auto async_finish_computation =
+        [context, input_size, input_ptr, first_input_inds,
+         first_input_inds_ptr, slot_counts, slot_counts_ptr, input_slots,
+         input_slots_ptr, input_unique_ids, input_unique_ids_ptr,
+         last_idx_host, has_count_output, done]() -> void {
+      const GPUDevice& device = context->eigen_gpu_device();
+      int64 uniq_size = (*last_idx_host.data()) + 1;
+
+      se::gpu::ScopedActivateExecutorContext scoped_activation{
+          context->op_device_context()->stream()->parent()};
+
+      Tensor* output = nullptr;
+      OP_REQUIRES_OK_ASYNC(
+          context,
+          context->allocate_output(0, TensorShape({uniq_size}), &output), done);
+      T* output_ptr = output->flat<T>().data();
+
+      TIndex* count_ptr = nullptr;
+      if (has_count_output) {
+        Tensor* count = nullptr;
+        OP_REQUIRES_OK_ASYNC(
+            context,
+            context->allocate_output(2, TensorShape({uniq_size}), &count),
+            done);
+        count_ptr = count->flat<TIndex>().data();
+      }
+
+      // The first occurrences are not needed anymore, so their slots are
+      // reused to map the slots to the unique IDs.
+      TIndex* slot_unique_ids_ptr = first_input_inds_ptr;
+      OP_REQUIRES_OK_ASYNC(
+          context,
+          GatherHashTableOutputs(device, input_size, input_ptr,
+                                 input_slots_ptr, input_unique_ids_ptr,
+                                 slot_counts_ptr, output_ptr,
+                                 slot_unique_ids_ptr, count_ptr),
+          done);
+
+      Tensor* idx = nullptr;
+      OP_REQUIRES_OK_ASYNC(
+          context, context->allocate_output(1, TensorShape({input_size}), &idx),
+          done);
+      TIndex* idx_ptr = idx->flat<TIndex>().data();
+
+      OP_REQUIRES_OK_ASYNC(
+          context,
+          LookupHashTableUniqueIds(device, input_size, input_slots_ptr,
+                                   slot_unique_ids_ptr, idx_ptr),
+          done);
+
+      done();
+    };
+
     context->device()
         ->tensorflow_accelerator_device_info()
         ->event_mgr->ThenExecute(stream, async_finish_computation);
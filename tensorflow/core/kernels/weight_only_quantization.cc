@@ -0,0 +1,116 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/weight_only_quantization.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/platform/errors.h"
+
+namespace tensorflow {
+
+Status QuantizeWeightsPerGroup(const Tensor& weights, int bits,
+                               int64_t group_size, Tensor* packed,
+                               Tensor* scales) {
+  if (bits != 4 && bits != 8) {
+    return errors::InvalidArgument("Weights can be quantized to 4 or 8 bits, ",
+                                   "got ", bits);
+  }
+  if (group_size <= 0) {
+    return errors::InvalidArgument("group_size must be positive, got ",
+                                   group_size);
+  }
+  if (weights.dtype() != DT_FLOAT || weights.dims() != 2) {
+    return errors::InvalidArgument("Weights must be a float matrix, got a ",
+                                   DataTypeString(weights.dtype()),
+                                   " tensor of shape ",
+                                   weights.shape().DebugString());
+  }
+  const int64_t rows = weights.dim_size(0);
+  const int64_t cols = weights.dim_size(1);
+  const int64_t num_groups = (rows + group_size - 1) / group_size;
+  const int64_t row_bytes = PackedWeightsRowBytes(bits, cols);
+  *packed = Tensor(DT_UINT8, TensorShape({rows, row_bytes}));
+  *scales = Tensor(DT_FLOAT, TensorShape({num_groups, cols}));
+  const auto w = weights.matrix<float>();
+  auto p = packed->matrix<uint8_t>();
+  auto s = scales->matrix<float>();
+  p.setZero();
+
+  const int max_q = (1 << (bits - 1)) - 1;
+  for (int64_t g = 0; g < num_groups; ++g) {
+    const int64_t row_begin = g * group_size;
+    const int64_t row_end = std::min(rows, row_begin + group_size);
+    for (int64_t c = 0; c < cols; ++c) {
+      float max_abs = 0;
+      for (int64_t r = row_begin; r < row_end; ++r) {
+        max_abs = std::max(max_abs, std::abs(w(r, c)));
+      }
+      const float scale = max_abs / max_q;
+      s(g, c) = scale;
+      for (int64_t r = row_begin; r < row_end; ++r) {
+        int q = 0;
+        if (scale > 0) {
+          q = static_cast<int>(std::round(w(r, c) / scale));
+          q = std::clamp(q, -max_q, max_q);
+        }
+        if (bits == 8) {
+          p(r, c) = static_cast<uint8_t>(q);
+        } else {
+          const int shift = (c % 2) * 4;
+          p(r, c / 2) |= static_cast<uint8_t>((q & 0xF) << shift);
+        }
+      }
+    }
+  }
+  return absl::OkStatus();
+}
+
+void DequantizeWeightsPanel(const uint8_t* packed, const float* scales,
+                            int bits, int64_t group_size, int64_t cols,
+                            int64_t row_begin, int64_t num_rows,
+                            int64_t col_begin, int64_t num_cols, float* out) {
+  const int64_t row_bytes = PackedWeightsRowBytes(bits, cols);
+  for (int64_t i = 0; i < num_rows; ++i) {
+    const int64_t row = row_begin + i;
+    const float* row_scales = scales + row / group_size * cols + col_begin;
+    float* out_row = out + i * num_cols;
+    if (bits == 8) {
+      const int8_t* q =
+          reinterpret_cast<const int8_t*>(packed + row * row_bytes) + col_begin;
+      for (int64_t j = 0; j < num_cols; ++j) {
+        out_row[j] = q[j] * row_scales[j];
+      }
+    } else {
+      // Sign-extend the low and high nibbles of each byte.
+      const int8_t* q =
+          reinterpret_cast<const int8_t*>(packed + row * row_bytes) +
+          col_begin / 2;
+      int64_t j = 0;
+      for (; j + 1 < num_cols; j += 2) {
+        const int8_t byte = q[j / 2];
+        out_row[j] = (static_cast<int8_t>(byte << 4) >> 4) * row_scales[j];
+        out_row[j + 1] = (byte >> 4) * row_scales[j + 1];
+      }
+      if (j < num_cols) {
+        out_row[j] = (static_cast<int8_t>(q[j / 2] << 4) >> 4) * row_scales[j];
+      }
+    }
+  }
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,58 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_WEIGHT_ONLY_QUANTIZATION_H_
+#define TENSORFLOW_CORE_KERNELS_WEIGHT_ONLY_QUANTIZATION_H_
+
+#include <cstdint>
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/status.h"
+
+namespace tensorflow {
+
+// The weights of _WeightOnlyQuantizedMatMul are a [K, N] float matrix stored as
+// signed `bits`-bit integers, 4 or 8, with a float scale for each group of
+// `group_size` consecutive rows of each column:
+//
+//   weights(k, n) = q(k, n) * scales(k / group_size, n)
+//
+// The integers are packed row by row into uint8 values: one per byte for 8
+// bits, and two per byte for 4 bits, the even column in the low nibble.
+
+// Returns the number of bytes of each packed row of `cols` weights.
+inline int64_t PackedWeightsRowBytes(int bits, int64_t cols) {
+  return bits == 4 ? (cols + 1) / 2 : cols;
+}
+
+// Quantizes the [K, N] float matrix `weights` symmetrically, with the largest
+// magnitude of each group mapped to the largest integer (7 or 127). Allocates
+// `packed` as a [K, PackedWeightsRowBytes(bits, N)] uint8 matrix, and `scales`
+// as a [ceil(K / group_size), N] float matrix.
+Status QuantizeWeightsPerGroup(const Tensor& weights, int bits,
+                               int64_t group_size, Tensor* packed,
+                               Tensor* scales);
+
+// Dequantizes the weights of rows [row_begin, row_begin + num_rows) and
+// columns [col_begin, col_begin + num_cols) of the `cols` columns, into the
+// row-major [num_rows, num_cols] matrix `out`. `col_begin` must be even.
+void DequantizeWeightsPanel(const uint8_t* packed, const float* scales,
+                            int bits, int64_t group_size, int64_t cols,
+                            int64_t row_begin, int64_t num_rows,
+                            int64_t col_begin, int64_t num_cols, float* out);
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_WEIGHT_ONLY_QUANTIZATION_H_
@@ -0,0 +1,151 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// See docs in ../ops/math_ops.cc.
+
+#define EIGEN_USE_THREADS
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "Eigen/Core"  // from @eigen_archive
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/kernels/weight_only_quantization.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+namespace tensorflow {
+namespace {
+
+// The rows of the activations multiplied at once, and the rows and columns of
+// the blocks of weights dequantized at once, which fit in the L2 cache.
+constexpr int64_t kRowBlock = 256;
+constexpr int64_t kDepthBlock = 256;
+constexpr int64_t kColumnBlock = 64;
+
+using RowMajorMatrix =
+    Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>;
+using Stride = Eigen::OuterStride<>;
+
+}  // namespace
+
+// Multiplies the activations with the low-bit weights without materializing
+// the float weights: each [kDepthBlock, kColumnBlock] block of weights is
+// dequantized into a buffer that stays in cache, and multiplied with the
+// activations by Eigen. Blocks of rows and columns of the output are sharded
+// over the worker threads.
+class WeightOnlyQuantizedMatMulOp : public OpKernel {
+ public:
+  explicit WeightOnlyQuantizedMatMulOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    OP_REQUIRES_OK(context, context->GetAttr("bits", &bits_));
+    OP_REQUIRES_OK(context, context->GetAttr("group_size", &group_size_));
+    OP_REQUIRES_OK(context, context->GetAttr("transpose_a", &transpose_a_));
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& a = context->input(0);
+    const Tensor& packed_b = context->input(1);
+    const Tensor& scales = context->input(2);
+    OP_REQUIRES(context,
+                a.dims() == 2 && packed_b.dims() == 2 && scales.dims() == 2,
+                errors::InvalidArgument(
+                    "a, packed_b and scales must be matrices, got shapes ",
+                    a.shape().DebugString(), ", ",
+                    packed_b.shape().DebugString(), " and ",
+                    scales.shape().DebugString()));
+    const int64_t m = a.dim_size(transpose_a_ ? 1 : 0);
+    const int64_t k = a.dim_size(transpose_a_ ? 0 : 1);
+    const int64_t n = scales.dim_size(1);
+    OP_REQUIRES(
+        context,
+        packed_b.dim_size(0) == k &&
+            packed_b.dim_size(1) == PackedWeightsRowBytes(bits_, n) &&
+            scales.dim_size(0) == (k + group_size_ - 1) / group_size_,
+        errors::InvalidArgument(
+            "Incompatible shapes of a, packed_b and scales for ", bits_,
+            "-bit weights in groups of ", group_size_, ": ",
+            a.shape().DebugString(), ", ", packed_b.shape().DebugString(),
+            " and ", scales.shape().DebugString()));
+
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(context,
+                   context->allocate_output(0, TensorShape({m, n}), &output));
+    if (output->NumElements() == 0) return;
+
+    // The activations are multiplied as a row-major [m, k] matrix.
+    Tensor a_transposed;
+    const float* a_data = a.flat<float>().data();
+    if (transpose_a_) {
+      OP_REQUIRES_OK(context,
+                     context->allocate_temp(DT_FLOAT, TensorShape({m, k}),
+                                            &a_transposed));
+      Eigen::array<int, 2> shuffle{1, 0};
+      a_transposed.matrix<float>().device(
+          context->eigen_device<Eigen::ThreadPoolDevice>()) =
+          a.matrix<float>().shuffle(shuffle);
+      a_data = a_transposed.matrix<float>().data();
+    }
+    const uint8_t* packed_data = packed_b.flat<uint8_t>().data();
+    const float* scales_data = scales.flat<float>().data();
+    float* output_data = output->flat<float>().data();
+    const int bits = bits_;
+    const int64_t group_size = group_size_;
+
+    const int64_t num_row_blocks = (m + kRowBlock - 1) / kRowBlock;
+    const int64_t num_col_blocks = (n + kColumnBlock - 1) / kColumnBlock;
+    auto work = [&](int64_t start, int64_t limit) {
+      std::vector<float> weights(kDepthBlock * kColumnBlock);
+      for (int64_t unit = start; unit < limit; ++unit) {
+        const int64_t row_begin = unit / num_col_blocks * kRowBlock;
+        const int64_t col_begin = unit % num_col_blocks * kColumnBlock;
+        const int64_t rows = std::min(kRowBlock, m - row_begin);
+        const int64_t cols = std::min(kColumnBlock, n - col_begin);
+        Eigen::Map<RowMajorMatrix, 0, Stride> out(
+            output_data + row_begin * n + col_begin, rows, cols, Stride(n));
+        out.setZero();
+        for (int64_t depth_begin = 0; depth_begin < k;
+             depth_begin += kDepthBlock) {
+          const int64_t depth = std::min(kDepthBlock, k - depth_begin);
+          DequantizeWeightsPanel(packed_data, scales_data, bits, group_size, n,
+                                 depth_begin, depth, col_begin, cols,
+                                 weights.data());
+          Eigen::Map<const RowMajorMatrix, 0, Stride> lhs(
+              a_data + row_begin * k + depth_begin, rows, depth, Stride(k));
+          Eigen::Map<const RowMajorMatrix> rhs(weights.data(), depth, cols);
+          out.noalias() += lhs * rhs;
+        }
+      }
+    };
+    const DeviceBase::CpuWorkerThreads& worker_threads =
+        *context->device()->tensorflow_cpu_worker_threads();
+    const int64_t cost_per_unit =
+        2 * std::min(kRowBlock, m) * k * std::min(kColumnBlock, n);
+    Shard(worker_threads.num_threads, worker_threads.workers,
+          num_row_blocks * num_col_blocks, cost_per_unit, work);
+  }
+
+ private:
+  int bits_;
+  int64_t group_size_;
+  bool transpose_a_;
+};
+
+REGISTER_KERNEL_BUILDER(Name("_WeightOnlyQuantizedMatMul").Device(DEVICE_CPU),
+                        WeightOnlyQuantizedMatMulOp);
+
+}  // namespace tensorflow
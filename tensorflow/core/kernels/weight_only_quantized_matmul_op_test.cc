@@ -0,0 +1,160 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <cmath>
+#include <vector>
+
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/kernels/weight_only_quantization.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+TEST(WeightOnlyQuantizationTest, RoundTrip) {
+  for (int bits : {4, 8}) {
+    Tensor weights(DT_FLOAT, TensorShape({5, 3}));
+    test::FillValues<float>(&weights, {1.0f, -0.5f, 0.0f, 0.25f, 2.0f, 0.0f,
+                                       -1.0f, 1.0f, 0.0f, 0.5f, -2.0f, 0.0f,
+                                       3.0f, 0.1f, 0.0f});
+    Tensor packed;
+    Tensor scales;
+    TF_ASSERT_OK(QuantizeWeightsPerGroup(weights, bits, 4, &packed, &scales));
+    EXPECT_EQ(packed.shape(),
+              TensorShape({5, PackedWeightsRowBytes(bits, 3)}));
+    EXPECT_EQ(scales.shape(), TensorShape({2, 3}));
+
+    Tensor dequantized(DT_FLOAT, weights.shape());
+    DequantizeWeightsPanel(packed.flat<uint8_t>().data(),
+                           scales.flat<float>().data(), bits, 4, 3, 0, 5, 0, 3,
+                           dequantized.flat<float>().data());
+    // The largest magnitude of each group is exact, and the others are within
+    // half a step of it.
+    const float max_q = bits == 4 ? 7.0f : 127.0f;
+    auto w = weights.matrix<float>();
+    auto s = scales.matrix<float>();
+    auto d = dequantized.matrix<float>();
+    for (int k = 0; k < 5; ++k) {
+      for (int n = 0; n < 3; ++n) {
+        EXPECT_NEAR(w(k, n), d(k, n), s(k / 4, n) / 2 + 1e-6);
+      }
+    }
+    EXPECT_FLOAT_EQ(s(0, 1), 2.0f / max_q);
+    EXPECT_FLOAT_EQ(d(3, 1), -2.0f);
+    EXPECT_FLOAT_EQ(d(4, 0), 3.0f);
+  }
+}
+
+TEST(WeightOnlyQuantizationTest, InvalidArguments) {
+  Tensor weights(DT_FLOAT, TensorShape({4, 4}));
+  weights.flat<float>().setZero();
+  Tensor packed;
+  Tensor scales;
+  EXPECT_TRUE(absl::IsInvalidArgument(
+      QuantizeWeightsPerGroup(weights, 3, 4, &packed, &scales)));
+  EXPECT_TRUE(absl::IsInvalidArgument(
+      QuantizeWeightsPerGroup(weights, 4, 0, &packed, &scales)));
+  EXPECT_TRUE(absl::IsInvalidArgument(QuantizeWeightsPerGroup(
+      Tensor(DT_FLOAT, TensorShape({4})), 4, 4, &packed, &scales)));
+}
+
+class WeightOnlyQuantizedMatMulOpTest : public OpsTestBase {
+ protected:
+  void MakeOp(int bits, int64_t group_size, bool transpose_a) {
+    TF_ASSERT_OK(NodeDefBuilder("matmul", "_WeightOnlyQuantizedMatMul")
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_UINT8))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Attr("bits", bits)
+                     .Attr("group_size", group_size)
+                     .Attr("transpose_a", transpose_a)
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+  }
+
+  // Multiplies random activations with random quantized weights, and compares
+  // the product with the product of the dequantized weights.
+  void RunAndCheck(int bits, int64_t group_size, bool transpose_a, int m,
+                   int k, int n) {
+    MakeOp(bits, group_size, transpose_a);
+    Tensor a(DT_FLOAT, transpose_a ? TensorShape({k, m}) : TensorShape({m, k}));
+    a.flat<float>().setRandom();
+    Tensor weights(DT_FLOAT, TensorShape({k, n}));
+    weights.flat<float>().setRandom();
+    Tensor packed;
+    Tensor scales;
+    TF_ASSERT_OK(
+        QuantizeWeightsPerGroup(weights, bits, group_size, &packed, &scales));
+    AddInputFromArray<float>(
+        a.shape(),
+        absl::Span<const float>(a.flat<float>().data(), a.NumElements()));
+    AddInputFromArray<uint8_t>(
+        packed.shape(), absl::Span<const uint8_t>(packed.flat<uint8_t>().data(),
+                                                  packed.NumElements()));
+    AddInputFromArray<float>(
+        scales.shape(), absl::Span<const float>(scales.flat<float>().data(),
+                                                scales.NumElements()));
+    TF_ASSERT_OK(RunOpKernel());
+
+    std::vector<float> dequantized(k * n);
+    DequantizeWeightsPanel(packed.flat<uint8_t>().data(),
+                           scales.flat<float>().data(), bits, group_size, n, 0,
+                           k, 0, n, dequantized.data());
+    Tensor expected(DT_FLOAT, TensorShape({m, n}));
+    auto a_t = a.matrix<float>();
+    for (int i = 0; i < m; ++i) {
+      for (int j = 0; j < n; ++j) {
+        double sum = 0;
+        for (int d = 0; d < k; ++d) {
+          sum += (transpose_a ? a_t(d, i) : a_t(i, d)) * dequantized[d * n + j];
+        }
+        expected.matrix<float>()(i, j) = sum;
+      }
+    }
+    test::ExpectTensorNear<float>(expected, *GetOutput(0), 1e-4 * k);
+  }
+};
+
+TEST_F(WeightOnlyQuantizedMatMulOpTest, Int4) {
+  RunAndCheck(4, 8, false, 3, 20, 7);
+}
+
+TEST_F(WeightOnlyQuantizedMatMulOpTest, Int8) {
+  RunAndCheck(8, 16, false, 5, 40, 6);
+}
+
+TEST_F(WeightOnlyQuantizedMatMulOpTest, TransposeA) {
+  RunAndCheck(4, 32, true, 4, 70, 9);
+}
+
+TEST_F(WeightOnlyQuantizedMatMulOpTest, SeveralBlocks) {
+  RunAndCheck(4, 128, false, 300, 600, 130);
+}
+
+TEST_F(WeightOnlyQuantizedMatMulOpTest, IncompatibleShapes) {
+  MakeOp(4, 2, false);
+  AddInputFromArray<float>(TensorShape({1, 4}), {0, 0, 0, 0});
+  AddInputFromArray<uint8_t>(TensorShape({4, 2}), {0, 0, 0, 0, 0, 0, 0, 0});
+  AddInputFromArray<float>(TensorShape({1, 3}), {1, 1, 1});
+  EXPECT_TRUE(absl::IsInvalidArgument(RunOpKernel()));
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -19,6 +19,8 @@ limitations under the License.
 #if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
 
 #include "absl/base/call_once.h"
+#include "absl/types/span.h"
+#include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/core/refcount.h"
 #include "tensorflow/core/lib/core/threadpool.h"
@@ -50,6 +52,14 @@ using se::rocm::ScopedActivateExecutorContext;
 int NcclManager::instance_count = 0;
 #endif
 
+// NCCL 2.14 and later can create non-blocking communicators, whose
+// initialization can be aborted.
+#if GOOGLE_CUDA && NCCL_VERSION_CODE >= 21400
+#define TF_NCCL_NONBLOCKING_COMM 1
+#else
+#define TF_NCCL_NONBLOCKING_COMM 0
+#endif
+
 #define NCCL_RETURN_IF_ERROR(...)                                        \
   do {                                                                   \
     ncclResult_t nccl_status = (__VA_ARGS__);                            \
@@ -148,6 +158,41 @@ void StringToNcclUniqueId(const string& str_id, ncclUniqueId* nccl_id) {
   }
 }
 
+#if TF_NCCL_NONBLOCKING_COMM
+// Interval between the polls of the communicators being initialized.
+constexpr int64_t kCommInitPollIntervalUsecs = 1000;
+
+// Waits for the initialization of the non-blocking `nccl_comms`. If it fails,
+// or if `abort_requested` is set meanwhile, aborts the communicators and
+// returns an error.
+Status WaitForCommInit(absl::Span<const ncclComm_t> nccl_comms,
+                       const std::atomic<bool>& abort_requested) {
+  Status status;
+  for (ncclComm_t nccl_comm : nccl_comms) {
+    ncclResult_t state = ncclInProgress;
+    while (status.ok() && state == ncclInProgress) {
+      ncclResult_t nccl_status = ncclCommGetAsyncError(nccl_comm, &state);
+      if (nccl_status != ncclSuccess) state = nccl_status;
+      if (state == ncclInProgress) {
+        if (abort_requested.load(std::memory_order_relaxed)) {
+          status = errors::Aborted("NCCL communicator initialization aborted");
+        } else {
+          Env::Default()->SleepForMicroseconds(kCommInitPollIntervalUsecs);
+        }
+      } else if (state != ncclSuccess) {
+        status = errors::Internal("NCCL: ", ncclGetErrorString(state),
+                                  ". Set NCCL_DEBUG=WARN for detail.");
+      }
+    }
+    if (!status.ok()) break;
+  }
+  if (!status.ok()) {
+    for (ncclComm_t nccl_comm : nccl_comms) ncclCommAbort(nccl_comm);
+  }
+  return status;
+}
+#endif  // TF_NCCL_NONBLOCKING_COMM
+
 }  // namespace
 
 // A `Collective` encapsulates state for a collective instance at one node.
@@ -388,6 +433,8 @@ Status NcclManager::GetCommunicator(NcclManager::Collective* collective,
   }
 
   std::vector<ncclComm_t> nccl_comms(collective->num_local_devices);
+  tensorflow::profiler::TraceMe traceme("NcclCommunicatorInit");
+  const uint64 init_start_usecs = env->NowMicros();
   VLOG(2) << "Created nccl Communicator with "
           << "num_global_devices = " << collective->num_global_devices
           << " num_local_devices = " << collective->num_local_devices
@@ -407,6 +454,12 @@ Status NcclManager::GetCommunicator(NcclManager::Collective* collective,
   }
   int saved_device = 0;
   CUDA_RETURN_IF_ERROR(cudaGetDevice(&saved_device));
+#if TF_NCCL_NONBLOCKING_COMM
+  // The initialization waits for the ranks of the other nodes. It is done in
+  // non-blocking mode so that `StartAbort` can stop it, as it holds `mu_`.
+  ncclConfig_t config = NCCL_CONFIG_INITIALIZER;
+  config.blocking = 0;
+#endif
   NCCL_RETURN_IF_ERROR(ncclGroupStart());
   for (int i = 0; i < collective->num_local_devices; ++i) {
     // Set rank to `participant->global_rank` if provided, else `i`.
@@ -414,11 +467,25 @@ Status NcclManager::GetCommunicator(NcclManager::Collective* collective,
                          ? collective->participants[i]->global_rank
                          : i;
     CUDA_RETURN_IF_ERROR(cudaSetDevice(devices[i]));
+#if TF_NCCL_NONBLOCKING_COMM
+    ncclResult_t init_status = ncclCommInitRankConfig(
+        nccl_comms.data() + i, collective->num_global_devices, nccl_id, rank,
+        &config);
+    if (init_status != ncclInProgress) NCCL_RETURN_IF_ERROR(init_status);
+#else
     NCCL_RETURN_IF_ERROR(ncclCommInitRank(
         nccl_comms.data() + i, collective->num_global_devices, nccl_id, rank));
+#endif
   }
+#if TF_NCCL_NONBLOCKING_COMM
+  ncclResult_t group_status = ncclGroupEnd();
+  if (group_status != ncclInProgress) NCCL_RETURN_IF_ERROR(group_status);
+  CUDA_RETURN_IF_ERROR(cudaSetDevice(saved_device));
+  TF_RETURN_IF_ERROR(WaitForCommInit(nccl_comms, abort_requested_));
+#else
   NCCL_RETURN_IF_ERROR(ncclGroupEnd());
   CUDA_RETURN_IF_ERROR(cudaSetDevice(saved_device));
+#endif
 #else
   // Since NCCL 1 is single node only, we use ncclCommInitAll.  We could have
   // used ncclCommInitRank with NCCL 1 as well, but then we would have to
@@ -427,6 +494,7 @@ Status NcclManager::GetCommunicator(NcclManager::Collective* collective,
   NCCL_RETURN_IF_ERROR(ncclCommInitAll(
       nccl_comms.data(), collective->num_local_devices, devices.data()));
 #endif
+  metrics::UpdateNcclCommunicatorInitTime(env->NowMicros() - init_start_usecs);
 
   for (int i = 0; i < collective->num_local_devices; ++i) {
     members[i].nccl_comm = nccl_comms[i];
@@ -902,6 +970,14 @@ void NcclManager::LoopKernelLaunches(NcclStream* nccl_stream) {
         break;
       }
     }
+#if TF_NCCL_NONBLOCKING_COMM
+    // The calls on a non-blocking communicator may return before the kernel
+    // is enqueued.
+    while (nccl_result == ncclInProgress) {
+      ncclResult_t nccl_status = ncclCommGetAsyncError(nccl_comm, &nccl_result);
+      if (nccl_status != ncclSuccess) nccl_result = nccl_status;
+    }
+#endif
 
     // Run the done_callback when the nccl kernel finishes running.
     auto done_callback = [collective, p_idx, nccl_result]() {
@@ -925,6 +1001,7 @@ void NcclManager::LoopKernelLaunches(NcclStream* nccl_stream) {
 void NcclManager::StartAbort(const Status& s) {
   absl::flat_hash_map<string, Collective*> collectives;
   std::vector<std::unique_ptr<Communicator>> communicators;
+  abort_requested_.store(true, std::memory_order_relaxed);
   {
     mutex_lock l(mu_);
     if (!status_.ok()) {
@@ -975,6 +1052,7 @@ void NcclManager::StartAbort(const Status& s) {
 void NcclManager::Reset() {
   mutex_lock l(mu_);
   status_ = Status();
+  abort_requested_.store(false, std::memory_order_relaxed);
   VLOG(2) << "Reset NcclManager " << this;
 }
 
@@ -17,6 +17,7 @@ limitations under the License.
 
 #if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
 
+#include <atomic>
 #include <vector>
 
 // TODO(rmlarsen): Get rid of this workaround. "gpu_assert" is defined when
@@ -272,6 +273,10 @@ class NcclManager {
 
   Status status_ TF_GUARDED_BY(mu_);
 
+  // Set by `StartAbort` before it acquires `mu_`, so that the initialization of
+  // a communicator, which holds `mu_`, stops waiting for the other ranks.
+  std::atomic<bool> abort_requested_{false};
+
   NcclManager(const NcclManager&) = delete;
   void operator=(const NcclManager&) = delete;
 };
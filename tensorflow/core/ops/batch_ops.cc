@@ -96,6 +96,34 @@ REGISTER_OP("BatchFunction")
     // NOTE: Support for `enable_large_batch_splitting == true` is still
     // developed in progress.
     .Attr("enable_large_batch_splitting: bool = false")
+    // If 'enable_packed_batching' is true, the inputs of the batched requests
+    // are concatenated along the 0th dimension as they are, e.g. the tokens of
+    // variable-length sequences, and 'f' receives an extra int64 input after
+    // 'in_tensors' with the row splits of the requests: request i owns rows
+    // [row_splits[i], row_splits[i + 1]) of each input, and rows past the last
+    // split are padding.  Batch sizes, including 'max_batch_size', count
+    // rows.  Each output of 'f' either has a row per input row, or one row
+    // per request.  Requests are never split across batches, so this cannot
+    // be combined with 'enable_large_batch_splitting' or the adaptive
+    // scheduler.
+    .Attr("enable_packed_batching: bool = false")
+    // The policy deciding when a batch that is not full yet is dispatched:
+    //   - WAIT_FOR_TIMEOUT: once its oldest request has waited for
+    //     'batch_timeout_micros'.
+    //   - PREDICT_ARRIVALS: like WAIT_FOR_TIMEOUT, but also as soon as, given
+    //     the recent arrival rate of requests, less than one more request is
+    //     expected before that timeout.
+    //
+    // WARNING: Not supported with the adaptive batch scheduler.
+    .Attr(
+        "batch_dispatch_policy: {'WAIT_FOR_TIMEOUT', 'PREDICT_ARRIVALS'} = "
+        "'WAIT_FOR_TIMEOUT'")
+    // If positive, 'f' runs on low priority batches of more rows than this
+    // in chunks of this many rows, and each chunk but the first waits for the
+    // running high priority batches, so that they do not queue up behind a
+    // long low priority batch. The outputs of 'f' must hold one row per input
+    // row. Cannot be combined with 'enable_packed_batching'.
+    .Attr("low_priority_chunk_size: int >= 0 = 0")
     // TODO(apassos): Fix this shape inference function. It requires shape
     // inference of function calls.
     .SetShapeFn(shape_inference::UnknownShape)
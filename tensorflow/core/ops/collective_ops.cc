@@ -139,10 +139,39 @@ REGISTER_OP("CollectiveReduceV2")
     .Attr("is_stateless: bool = false")
     .Attr("Nordering_token: int >= 0 = 0")
     .Attr("max_subdivs_per_device: int = -1")
+    .Attr("compression: {'none', 'bf16', 'fp16'} = 'none'")
+    .Attr("num_backup_workers: int >= 0 = 0")
     .SetIsStateful()
     .SetIsDistributedCommunication()
     .SetShapeFn(shape_inference::UnchangedShape);
 
+REGISTER_OP("CollectiveBatchReduceV2")
+    .Input("input: N * T")
+    .Output("data: N * T")
+    .Attr("T: {bfloat16, float, float16, float64, int32, int64}")
+    .Attr("N: int >= 1")
+    .Input("group_size: int32")
+    .Input("group_key: int32")
+    .Input("instance_key: int32")
+    .Input("ordering_token: Nordering_token * resource")
+    .Attr("merge_op: {'Min', 'Max', 'Mul', 'Add'}")
+    .Attr("final_op: {'Id', 'Div'}")
+    .Attr("communication_hint: string = 'auto'")
+    .Attr("timeout_seconds: float = 0")
+    .Attr("is_stateless: bool = false")
+    .Attr("Nordering_token: int >= 0 = 0")
+    .Attr("max_subdivs_per_device: int = -1")
+    .Attr("compression: {'none', 'bf16', 'fp16'} = 'none'")
+    .Attr("num_backup_workers: int >= 0 = 0")
+    .SetIsStateful()
+    .SetIsDistributedCommunication()
+    .SetShapeFn([](shape_inference::InferenceContext* c) {
+      for (int i = 0; i < c->num_outputs(); ++i) {
+        c->set_output(i, c->input(i));
+      }
+      return absl::OkStatus();
+    });
+
 REGISTER_OP("CollectiveReduceScatterV2")
     .Input("input: T")
     .Output("data: T")
@@ -841,6 +841,8 @@ REGISTER_OP("TFRecordDataset")
     .Input("compression_type: string")
     .Input("buffer_size: int64")
     .Attr("metadata: string = ''")
+    .Attr("use_mmap: bool = false")
+    .Attr("verify_checksum: bool = true")
     .Output("handle: variant")
     .SetDoNotOptimize()  // TODO(b/123753214): See comment in dataset_ops.cc.
     .SetTypeConstructor(full_type::UnaryTensorContainer(TFT_DATASET,
@@ -862,6 +864,8 @@ REGISTER_OP("TFRecordDatasetV2")
     .Input("buffer_size: int64")
     .Input("byte_offsets: int64")
     .Attr("metadata: string = ''")
+    .Attr("use_mmap: bool = false")
+    .Attr("verify_checksum: bool = true")
     .Output("handle: variant")
     .SetDoNotOptimize()  // TODO(b/123753214): See comment in dataset_ops.cc.
     .SetTypeConstructor(full_type::UnaryTensorContainer(TFT_DATASET,
@@ -107,6 +107,7 @@ REGISTER_OP("DebugIdentityV2")
     .Attr("debug_urls: list(string) = []")
     .Attr("circular_buffer_size: int = 1000")
     .Attr("tfdbg_run_id: string = ''")
+    .Attr("sampling_period: int = 1")
     .SetIsStateful()
     .SetShapeFn(shape_inference::UnchangedShape);
 
@@ -175,6 +175,7 @@ REGISTER_OP("CompressElement")
     .Input("components: input_types")
     .Output("compressed: variant")
     .Attr("input_types: list(type) >= 1")
+    .Attr("codec: {'snappy', 'columnar'} = 'snappy'")
     .SetShapeFn(shape_inference::ScalarShape);
 
 REGISTER_OP("UncompressElement")
@@ -509,6 +510,7 @@ REGISTER_OP("GlobalShuffleDataset")
     .Input("seed_generator: resource")
     .Output("handle: variant")
     .Attr("reshuffle_each_iteration: bool = true")
+    .Attr("block_size: int >= 1 = 1")
     .Attr("output_types: list(type) >= 1")
     .Attr("output_shapes: list(shape) >= 1")
     .Attr("metadata: string = ''")
@@ -352,6 +352,41 @@ REGISTER_OP("_UnaryOpsComposition")
 expected to create these operators.
 )doc");
 
+REGISTER_OP("_FusedElementwise")
+    .Input("args: num_args * T")
+    .Output("y: T")
+    .Attr("T: {float}")
+    .Attr("num_args: int >= 1")
+    .Attr("constants: list(float) = []")
+    .Attr("op_names: list(string)")
+    .Attr("lhs: list(int)")
+    .Attr("rhs: list(int)")
+    .SetShapeFn([](InferenceContext* c) {
+      // The arguments with a single element are broadcast to the others.
+      ShapeHandle output = c->input(0);
+      for (int i = 1; i < c->num_inputs(); ++i) {
+        TF_RETURN_IF_ERROR(BroadcastBinaryOpOutputShapeFnHelper(
+            c, output, c->input(i), /*incompatible_shape_error=*/true,
+            &output));
+      }
+      c->set_output(0, output);
+      return absl::OkStatus();
+    })
+    .Doc(R"doc(
+Computes a chain of elementwise ops in a single pass over its inputs.
+
+The chain is a program whose values are `args`, then `constants`, then the
+results of the instructions in order. Instruction i applies the TF op
+`op_names[i]` (e.g. "AddV2" or "Tanh") to the values `lhs[i]` and `rhs[i]`,
+with `rhs[i]` = -1 for unary ops. The result of the last instruction is `y`.
+
+Each argument either has the shape of `y` or has a single element, which is
+broadcast.
+
+*NOTE*: Do not invoke this operator directly in Python. Graph rewrite pass is
+expected to create these operators.
+)doc");
+
 #undef UNARY
 #undef UNARY_REAL
 #undef UNARY_COMPLEX
@@ -1932,6 +1967,61 @@ REGISTER_OP("QuantizedMatMul")
       return absl::OkStatus();
     });
 
+REGISTER_OP("_DynamicQuantizedMatMul")
+    .Input("a: float")
+    .Input("b: float")
+    .Output("product: float")
+    .Attr("transpose_a: bool = false")
+    .Attr("transpose_b: bool = false")
+    .SetShapeFn(shape_inference::MatMulShape)
+    .Doc(R"doc(
+Performs a MatMul with eight-bit arithmetic.
+
+The weights in `b` are quantized once, on the first run, so they must be
+constant. The activations in `a` are quantized on each run over their range,
+and the product is converted back to float.
+
+*NOTE*: Do not invoke this operator directly in Python. Grappler is
+expected to create these operators.
+)doc");
+
+REGISTER_OP("_WeightOnlyQuantizedMatMul")
+    .Input("a: float")
+    .Input("packed_b: uint8")
+    .Input("scales: float")
+    .Output("product: float")
+    .Attr("bits: {4, 8}")
+    .Attr("group_size: int >= 1")
+    .Attr("transpose_a: bool = false")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle a;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(0), 2, &a));
+      ShapeHandle packed_b;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 2, &packed_b));
+      ShapeHandle scales;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(2), 2, &scales));
+      bool transpose_a;
+      TF_RETURN_IF_ERROR(c->GetAttr("transpose_a", &transpose_a));
+      DimensionHandle inner;
+      TF_RETURN_IF_ERROR(c->Merge(c->Dim(a, transpose_a ? 0 : 1),
+                                  c->Dim(packed_b, 0), &inner));
+      c->set_output(0, c->Matrix(c->Dim(a, transpose_a ? 1 : 0),
+                                 c->Dim(scales, 1)));
+      return absl::OkStatus();
+    })
+    .Doc(R"doc(
+Performs a MatMul with float activations and low-bit weights.
+
+The [K, N] weights are stored as signed `bits`-bit integers packed into the
+rows of `packed_b`, one per byte for 8 bits and two per byte for 4 bits, with
+the even column in the low nibble. Their values are the integers times
+`scales`, which holds one scale for each group of `group_size` rows of each
+column. The weights are dequantized in cache-sized blocks while multiplying.
+
+*NOTE*: Do not invoke this operator directly in Python. The
+quantize_matmul_weights graph transform is expected to create these operators.
+)doc");
+
 // Note: This op is not commutative w.r.t. to all its inputs.
 REGISTER_OP("QuantizedMul")
     .Input("x: T1")
@@ -1301,6 +1301,56 @@ REGISTER_OP("LogSoftmax")
 
 // --------------------------------------------------------------------------
 
+REGISTER_OP("_FusedScaledDotProductAttention")
+    .Input("query: T")
+    .Input("key: T")
+    .Input("value: T")
+    .Input("args: num_args * T")
+    .Output("output: T")
+    .Attr("T: {float}")
+    .Attr("num_args: int >= 0")
+    .Attr("scale: float = 1.0")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle query;
+      ShapeHandle key;
+      ShapeHandle value;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(0), 4, &query));
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 4, &key));
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(2), 4, &value));
+      DimensionHandle unused;
+      TF_RETURN_IF_ERROR(c->Merge(c->Dim(query, 3), c->Dim(key, 3), &unused));
+      TF_RETURN_IF_ERROR(c->Merge(c->Dim(key, 2), c->Dim(value, 2), &unused));
+      ShapeHandle batch_and_heads;
+      TF_RETURN_IF_ERROR(c->Subshape(query, 0, 2, &batch_and_heads));
+      for (ShapeHandle s : {key, value}) {
+        ShapeHandle other;
+        TF_RETURN_IF_ERROR(c->Subshape(s, 0, 2, &other));
+        TF_RETURN_IF_ERROR(
+            c->Merge(batch_and_heads, other, &batch_and_heads));
+      }
+      ShapeHandle output;
+      TF_RETURN_IF_ERROR(c->Concatenate(
+          batch_and_heads, c->Vector(c->Dim(query, 2)), &output));
+      TF_RETURN_IF_ERROR(
+          c->Concatenate(output, c->Vector(c->Dim(value, 3)), &output));
+      c->set_output(0, output);
+      return absl::OkStatus();
+    })
+    .Doc(R"doc(
+Computes the scaled dot-product attention softmax(scale * query * key^T +
+bias) * value.
+
+`query` is [batch, heads, queries, depth], `key` is [batch, heads, keys,
+depth] and `value` is [batch, heads, keys, value_depth]. The optional bias in
+`args`, e.g. an attention mask, must broadcast to [batch, heads, queries,
+keys]. The attention scores are computed in tiles and never materialized.
+
+*NOTE*: Do not invoke this operator directly in Python. Grappler is
+expected to create these operators.
+)doc");
+
+// --------------------------------------------------------------------------
+
 REGISTER_OP("SoftmaxCrossEntropyWithLogits")
     .Input("features: T")
     .Input("labels: T")
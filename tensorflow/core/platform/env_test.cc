@@ -18,6 +18,7 @@ limitations under the License.
 #include <sys/stat.h>
 
 #include <memory>
+#include <vector>
 
 #include "xla/tsl/lib/core/status_test_util.h"
 #include "tensorflow/core/framework/graph.pb.h"
@@ -283,6 +284,35 @@ TEST_F(DefaultEnvTest, LocalFileSystem) {
   }
 }
 
+TEST_F(DefaultEnvTest, IoUringFileSystem) {
+  // The reads of at least two chunks go through the io_uring, if available.
+  const int length = (4 << 20) + 5;
+  const string filename = io::JoinPath(BaseDir(), "uring_file");
+  const string input = CreateTestFile(env_, filename, length);
+
+  std::unique_ptr<RandomAccessFile> f;
+  TF_EXPECT_OK(
+      env_->NewRandomAccessFile(strings::StrCat("uring://", filename), &f));
+  std::vector<char> scratch(length + 1);
+  StringPiece result;
+  TF_EXPECT_OK(f->Read(0, length, &result, scratch.data()));
+  EXPECT_EQ(input, result);
+  TF_EXPECT_OK(f->Read(3, 1 << 20, &result, scratch.data()));
+  EXPECT_EQ(input.substr(3, 1 << 20), result);
+  TF_EXPECT_OK(f->Read(7, 100, &result, scratch.data()));
+  EXPECT_EQ(input.substr(7, 100), result);
+
+  // Reading past EOF should give an OUT_OF_RANGE error.
+  EXPECT_EQ(error::OUT_OF_RANGE,
+            f->Read(1 << 20, length, &result, scratch.data()).code());
+  EXPECT_EQ(input.substr(1 << 20), result);
+
+  string output;
+  TF_EXPECT_OK(
+      ReadFileToString(env_, strings::StrCat("uring://", filename), &output));
+  EXPECT_EQ(input, output);
+}
+
 TEST_F(DefaultEnvTest, SleepForMicroseconds) {
   const int64_t start = env_->NowMicros();
   const int64_t sleep_time = 1e6 + 5e5;
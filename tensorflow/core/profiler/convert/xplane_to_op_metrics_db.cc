@@ -67,6 +67,9 @@ struct TfActivity {
   tsl::profiler::TfOp tf_op;
   // Whether it is eagerly executed.
   bool is_eager;
+  // The bytes read from the DRAM by this Op, measured by the hardware
+  // counters.
+  uint64 dram_bytes;
 };
 
 // TF Op metrics stored as element in OpStack.
@@ -103,7 +106,8 @@ void ProcessOneTfActivity(const TfActivity& activity,
           info->start_timestamp_ps, activity.timestamp_ps);
       tf_metrics_data->tf_metrics_db_builder.EnterOp(
           activity.tf_op.name, activity.tf_op.type, activity.is_eager,
-          tf_op_span.duration_ps(), info->children_duration_ps);
+          tf_op_span.duration_ps(), info->children_duration_ps,
+          activity.dram_bytes);
       TfOpInfo* parent_info = tf_op_stack->Top();
       if (parent_info != nullptr) {
         parent_info->children_duration_ps += tf_op_span.duration_ps();
@@ -151,11 +155,16 @@ void CollectTfActivities(
                   event.GetStat(StatType::kIsEager)) {
             is_eager = stat->IntValue();
           }
+          uint64 dram_bytes = 0;
+          if (std::optional<XStatVisitor> stat =
+                  event.GetStat(StatType::kDramBytes)) {
+            dram_bytes = stat->IntOrUintValue();
+          }
           tsl::profiler::Timespan span = event.GetTimespan();
-          tf_activities->push_back(
-              {span.begin_ps(), tf_op_id, kTfOpBegin, *tf_op, is_eager});
-          tf_activities->push_back(
-              {span.end_ps(), tf_op_id, kTfOpEnd, *tf_op, is_eager});
+          tf_activities->push_back({span.begin_ps(), tf_op_id, kTfOpBegin,
+                                    *tf_op, is_eager, dram_bytes});
+          tf_activities->push_back({span.end_ps(), tf_op_id, kTfOpEnd, *tf_op,
+                                    is_eager, dram_bytes});
         }
         if (auto tf_op_stat = event.GetStat(StatType::kTfOp);
             tf_op_stat.has_value()) {
@@ -164,9 +173,9 @@ void CollectTfActivities(
               tsl::profiler::ParseTfOpFullname(tf_op_stat->StrOrRefValue());
           tsl::profiler::Timespan span = event.GetTimespan();
           tf_activities->push_back(
-              {span.begin_ps(), tf_op_id, kTfOpBegin, tf_op, false});
+              {span.begin_ps(), tf_op_id, kTfOpBegin, tf_op, false, 0});
           tf_activities->push_back(
-              {span.end_ps(), tf_op_id, kTfOpEnd, tf_op, false});
+              {span.end_ps(), tf_op_id, kTfOpEnd, tf_op, false, 0});
         }
       });
 }
@@ -146,6 +146,31 @@ TEST(ConvertXPlaneToOpMetricsDb, HostOpMetricsDb) {
   EXPECT_EQ(tsl::profiler::NanoToPico(kTfOp2DurationNs), op_2.time_ps());
 }
 
+TEST(ConvertXPlaneToOpMetricsDb, HostOpMetricsDbWithDramBytes) {
+  static constexpr char kTfOp[] = "TfOp:TfOp";
+  constexpr uint64 kDramBytes = 4096;
+
+  XSpace xspace;
+  XPlane* xplane = GetOrCreateHostXPlane(&xspace);
+  XPlaneBuilder host_plane(xplane);
+  XLineBuilder thread = host_plane.GetOrCreateLine(/*line_id=*/10);
+  for (int64_t start_ns : {100000, 110000}) {
+    XEventBuilder event =
+        thread.AddEvent(*host_plane.GetOrCreateEventMetadata(kTfOp));
+    event.SetTimestampNs(start_ns);
+    event.SetDurationNs(8000);
+    event.AddStatValue(*host_plane.GetOrCreateStatMetadata(
+                           GetStatTypeStr(StatType::kDramBytes)),
+                       kDramBytes);
+  }
+
+  OpMetricsDb op_metrics = ConvertHostThreadsXPlaneToOpMetricsDb(*xplane);
+  const OpMetrics& op = op_metrics.metrics_db().at(0);
+  EXPECT_EQ("TfOp", op.name());
+  EXPECT_EQ(2, op.occurrences());
+  EXPECT_EQ(kDramBytes * 2, op.bytes_accessed());
+}
+
 TEST(ConvertXPlaneToOpMetricsDb, DeviceOpMetricsDb) {
   // TfOp1 has kernel1 and kernel2; TfOp2 has kernel3.
   static constexpr char kTfOp1[] = "TfOp1";
@@ -48,6 +48,16 @@ class AnnotatedTraceMe {
     }
   }
 
+  // Appends the metadata returned by metadata_generator to the TraceMe, which
+  // only calls it when the activity is recorded. See TraceMe::AppendMetadata.
+  template <typename MetadataGeneratorT>
+  void AppendMetadata(MetadataGeneratorT&& metadata_generator) {
+    if (trace_me_.has_value()) {
+      trace_me_->AppendMetadata(
+          std::forward<MetadataGeneratorT>(metadata_generator));
+    }
+  }
+
  private:
   std::optional<tsl::profiler::TraceMe> trace_me_;
   std::optional<tsl::profiler::ScopedAnnotation> scoped_annotation_;
@@ -43,7 +43,8 @@ double GetCappedPerf(double perf, uint64 time, double rate_limit) {
 
 void HostOpMetricsDbBuilder::EnterOp(absl::string_view name,
                                      absl::string_view category, bool is_eager,
-                                     uint64 time_ps, uint64 children_time_ps) {
+                                     uint64 time_ps, uint64 children_time_ps,
+                                     uint64 bytes_accessed) {
   uint64 self_time_ps = time_ps - children_time_ps;
   DCHECK_GE(time_ps, self_time_ps);
   OpMetrics* op_metrics =
@@ -55,6 +56,8 @@ void HostOpMetricsDbBuilder::EnterOp(absl::string_view name,
   op_metrics->set_occurrences(op_metrics->occurrences() + 1);
   op_metrics->set_time_ps(op_metrics->time_ps() + time_ps);
   op_metrics->set_self_time_ps(op_metrics->self_time_ps() + self_time_ps);
+  op_metrics->set_bytes_accessed(op_metrics->bytes_accessed() +
+                                 bytes_accessed);
   db()->set_total_op_time_ps(db()->total_op_time_ps() + self_time_ps);
 }
 
@@ -39,8 +39,11 @@ class HostOpMetricsDbBuilder : public OpMetricsDbBuilder {
   //             the execution time of its children.
   //   children_time_ps = the execution time of the children of this OP in
   //                      picoseconds
+  //   bytes_accessed = the bytes read from the DRAM by this OP, measured by
+  //                    the hardware counters.
   void EnterOp(absl::string_view name, absl::string_view category,
-               bool is_eager, uint64 time_ps, uint64 children_time_ps);
+               bool is_eager, uint64 time_ps, uint64 children_time_ps,
+               uint64 bytes_accessed = 0);
 
   // Updates total_host_infeed_enq_duration_ps_ and
   // total_host_infeed_enq_duration_ps_.
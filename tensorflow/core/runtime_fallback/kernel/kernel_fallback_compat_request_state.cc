@@ -30,6 +30,8 @@ limitations under the License.
 #include "tensorflow/core/framework/resource_mgr.h"
 #include "tensorflow/core/platform/threadpool_interface.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/tfrt/fallback/device_with_custom_allocator.h"
+#include "tensorflow/core/tfrt/fallback/request_arena_allocator.h"
 #include "tensorflow/core/tfrt/graph_executor/config.h"
 #include "tensorflow/core/tfrt/utils/fallback_tensor.h"
 #include "tfrt/host_context/resource_context.h"  // from @tf_runtime
@@ -141,6 +143,29 @@ KernelFallbackCompatRequestState::KernelFallbackCompatRequestState(
           runner_table, resource_array, user_intra_op_threadpool,
           model_metadata, pflr) {}
 
+KernelFallbackCompatRequestState::~KernelFallbackCompatRequestState() {
+  if (request_arena_ != nullptr) {
+    request_arena_->Release(session_metadata_.name());
+  }
+}
+
+void KernelFallbackCompatRequestState::EnableRequestArena(
+    const tfrt_stub::RequestArenaAllocator::Options& options) {
+  DCHECK(request_arena_ == nullptr);
+  request_arena_ = new tfrt_stub::RequestArenaAllocator(
+      cpu_device_->GetAllocator(AllocatorAttributes()), options);
+
+  // Kernels find the host CPU device either directly or through
+  // `custom_device_`, so both point to the wrapper. The wrapper replaces the
+  // renamed device in `custom_device_` if any, which is equivalent to
+  // `custom_cpu_device_`.
+  const tensorflow::Device* host_cpu = device_manager_->HostCPU();
+  auto& arena_cpu_device = custom_device_[host_cpu];
+  arena_cpu_device = std::make_unique<tfrt_stub::DeviceWithCustomAllocator>(
+      cpu_device_, request_arena_);
+  cpu_device_ = arena_cpu_device.get();
+}
+
 static std::function<void(std::function<void()>)>* GetDefaultRunner() {
   static auto* const default_runner =
       new std::function<void(std::function<void()>)>(
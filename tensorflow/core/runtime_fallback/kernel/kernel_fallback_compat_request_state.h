@@ -29,6 +29,7 @@ limitations under the License.
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/tfrt/fallback/cost_recorder.h"
 #include "tensorflow/core/tfrt/fallback/op_kernel_runner.h"
+#include "tensorflow/core/tfrt/fallback/request_arena_allocator.h"
 #include "tensorflow/core/tfrt/graph_executor/config.h"
 #include "tensorflow/core/tfrt/utils/fallback_tensor.h"
 #include "tfrt/host_context/async_value_ref.h"  // from @tf_runtime
@@ -101,6 +102,8 @@ class KernelFallbackCompatRequestState {
       const absl::optional<SessionMetadata>& model_metadata,
       const tensorflow::ProcessFunctionLibraryRuntime* pflr);
 
+  ~KernelFallbackCompatRequestState();
+
   int64_t step_id() const { return step_id_; }
 
   // Returns the user-specified custom device corresponding to the given device.
@@ -181,6 +184,16 @@ class KernelFallbackCompatRequestState {
     return runtime_config_;
   }
 
+  // Allocates the host tensors of this request from a per-request arena, see
+  // tfrt_stub::RequestArenaAllocator. Must be called before any kernel runs.
+  void EnableRequestArena(
+      const tfrt_stub::RequestArenaAllocator::Options& options);
+
+  // Nullable.
+  tfrt_stub::RequestArenaAllocator* request_arena() const {
+    return request_arena_;
+  }
+
  private:
   int64_t step_id_ = 0;
   // Below are resources needed by current tensorflow.
@@ -223,6 +236,10 @@ class KernelFallbackCompatRequestState {
   tfrt::ResourceContext* client_graph_resource_context_ = nullptr;
 
   const tensorflow::tfrt_stub::RuntimeConfig* runtime_config_ = nullptr;
+
+  // Not owned. It is released when the request ends, and deletes itself once
+  // the tensors it allocated are deallocated.
+  tfrt_stub::RequestArenaAllocator* request_arena_ = nullptr;
 };
 
 // Set up fallback context with common tensorflow states such as devices,
@@ -242,8 +242,7 @@ void BatchFunctionFallbackKernel<BatchResourceType>::ComputeAsync(
       tensorflow::core::RefCountPtr<BatchResourceType>>(shared_name_, creator);
   if (!br.ok()) OP_REQUIRES_OK_ASYNC(c, br.status(), done);
   auto expected_name = BatchResourceType::GetBatchFunctionName(batch_function_);
-  auto received_name =
-      BatchResourceType::GetBatchFunctionName((*br)->get()->batch_function());
+  auto received_name = (*br)->get()->batch_function_name();
 
   // TODO(b/187173237): When we can guarantee only 1 copy of BEF function is
   // generated for the batched function, we can assert the pointers are equal
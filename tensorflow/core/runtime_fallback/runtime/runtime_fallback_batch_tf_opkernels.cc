@@ -186,6 +186,8 @@ class FallbackBatchResource : public tensorflow::serving::BatchResourceBase {
     return bef_func_;
   }
 
+  absl::string_view batch_function_name() const { return bef_func_->name(); }
+
   static tsl::RCReference<const tfrt::Function> CastHandleToFunction(
       int64_t handle) {
     // BEF function's address is passed in as an I64 attribute.
@@ -14,7 +14,13 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/summary/summary_file_writer.h"
 
+#include <algorithm>
+#include <chrono>  // NOLINT(build/c++11)
+#include <functional>
+#include <map>
 #include <memory>
+#include <utility>
+#include <vector>
 
 #include "absl/strings/match.h"
 #include "absl/strings/str_cat.h"
@@ -22,8 +28,14 @@ limitations under the License.
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/resource_mgr.h"
 #include "tensorflow/core/framework/summary.pb.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_util.h"
 #include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/io/compression.h"
 #include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/io/record_writer.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
 #include "tensorflow/core/summary/summary_converter.h"
 #include "tensorflow/core/util/events_writer.h"
 
@@ -32,11 +44,10 @@ namespace {
 
 class SummaryFileWriter : public SummaryWriterInterface {
  public:
-  SummaryFileWriter(int max_queue, int flush_millis, Env* env)
+  SummaryFileWriter(const SummaryFileWriterOptions& options, Env* env)
       : SummaryWriterInterface(),
         is_initialized_(false),
-        max_queue_(max_queue),
-        flush_millis_(flush_millis),
+        options_(options),
         env_(env) {}
 
   Status Initialize(const string& logdir, const string& filename_suffix) {
@@ -55,90 +66,117 @@ class SummaryFileWriter : public SummaryWriterInterface {
     string sep = absl::StartsWith(filename_suffix, ".") ? "" : ".";
     const string uniquified_filename_suffix = absl::StrCat(
         ".", pid, ".", file_id_counter.fetch_add(1), sep, filename_suffix);
-    mutex_lock ml(mu_);
+    mutex_lock wl(write_mu_);
     events_writer_ =
         std::make_unique<EventsWriter>(io::JoinPath(logdir, "events"));
     TF_RETURN_WITH_CONTEXT_IF_ERROR(
         events_writer_->InitWithSuffix(uniquified_filename_suffix),
         "Could not initialize events writer.");
+    if (options_.write_scalar_columns) {
+      const string columns_path = io::JoinPath(
+          logdir, absl::StrCat("scalars.out.tfcolumns.", env_->NowSeconds(),
+                               uniquified_filename_suffix));
+      TF_RETURN_WITH_CONTEXT_IF_ERROR(
+          env_->NewWritableFile(columns_path, &columns_file_),
+          "Could not create the scalar columns file.");
+      columns_writer_ = std::make_unique<io::RecordWriter>(
+          columns_file_.get(),
+          io::RecordWriterOptions::CreateRecordWriterOptions(
+              io::compression::kZlib));
+    }
+    mutex_lock ml(mu_);
     last_flush_ = env_->NowMicros();
     is_initialized_ = true;
+    if (options_.async) {
+      background_thread_.reset(
+          env_->StartThread(ThreadOptions(), "summary_file_writer",
+                            [this]() { BackgroundLoop(); }));
+    }
     return absl::OkStatus();
   }
 
   Status Flush() override {
-    mutex_lock ml(mu_);
-    if (!is_initialized_) {
-      return errors::FailedPrecondition("Class was not properly initialized.");
+    {
+      mutex_lock ml(mu_);
+      if (!is_initialized_) {
+        return errors::FailedPrecondition(
+            "Class was not properly initialized.");
+      }
     }
-    return InternalFlush();
+    Status status = FlushQueue();
+    mutex_lock wl(write_mu_);
+    status.Update(background_status_);
+    background_status_ = absl::OkStatus();
+    return status;
   }
 
   ~SummaryFileWriter() override {
+    if (background_thread_ != nullptr) {
+      {
+        mutex_lock ml(mu_);
+        stop_ = true;
+      }
+      queue_due_.notify_one();
+      background_thread_.reset();
+    }
     (void)Flush();  // Ignore errors.
   }
 
   Status WriteTensor(int64_t global_step, Tensor t, const string& tag,
                      const string& serialized_metadata) override {
-    std::unique_ptr<Event> e{new Event};
-    e->set_step(global_step);
-    e->set_wall_time(GetWallTime());
-    Summary::Value* v = e->mutable_summary()->add_value();
-
-    if (t.dtype() == DT_STRING) {
-      // Treat DT_STRING specially, so that tensor_util.MakeNdarray in Python
-      // can convert the TensorProto to string-type numpy array. MakeNdarray
-      // does not work with strings encoded by AsProtoTensorContent() in
-      // tensor_content.
-      t.AsProtoField(v->mutable_tensor());
-    } else {
-      t.AsProtoTensorContent(v->mutable_tensor());
-    }
-    v->set_tag(tag);
-    if (!serialized_metadata.empty()) {
-      v->mutable_metadata()->ParseFromString(serialized_metadata);
-    }
-    return WriteEvent(std::move(e));
+    return Write(global_step, t,
+                 [tag, serialized_metadata](const Tensor& t, Summary* s) {
+                   Summary::Value* v = s->add_value();
+                   if (t.dtype() == DT_STRING) {
+                     // Treat DT_STRING specially, so that
+                     // tensor_util.MakeNdarray in Python can convert the
+                     // TensorProto to string-type numpy array. MakeNdarray
+                     // does not work with strings encoded by
+                     // AsProtoTensorContent() in tensor_content.
+                     t.AsProtoField(v->mutable_tensor());
+                   } else {
+                     t.AsProtoTensorContent(v->mutable_tensor());
+                   }
+                   v->set_tag(tag);
+                   if (!serialized_metadata.empty()) {
+                     v->mutable_metadata()->ParseFromString(
+                         serialized_metadata);
+                   }
+                   return absl::OkStatus();
+                 });
   }
 
   Status WriteScalar(int64_t global_step, Tensor t,
                      const string& tag) override {
-    std::unique_ptr<Event> e{new Event};
-    e->set_step(global_step);
-    e->set_wall_time(GetWallTime());
-    TF_RETURN_IF_ERROR(
-        AddTensorAsScalarToSummary(t, tag, e->mutable_summary()));
-    return WriteEvent(std::move(e));
+    return Write(global_step, t, [tag](const Tensor& t, Summary* s) {
+      return AddTensorAsScalarToSummary(t, tag, s);
+    });
   }
 
   Status WriteHistogram(int64_t global_step, Tensor t,
                         const string& tag) override {
-    std::unique_ptr<Event> e{new Event};
-    e->set_step(global_step);
-    e->set_wall_time(GetWallTime());
-    TF_RETURN_IF_ERROR(
-        AddTensorAsHistogramToSummary(t, tag, e->mutable_summary()));
-    return WriteEvent(std::move(e));
+    return Write(global_step, t, [tag](const Tensor& t, Summary* s) {
+      return AddTensorAsHistogramToSummary(t, tag, s);
+    });
   }
 
   Status WriteImage(int64_t global_step, Tensor t, const string& tag,
                     int max_images, Tensor bad_color) override {
-    std::unique_ptr<Event> e{new Event};
-    e->set_step(global_step);
-    e->set_wall_time(GetWallTime());
-    TF_RETURN_IF_ERROR(AddTensorAsImageToSummary(t, tag, max_images, bad_color,
-                                                 e->mutable_summary()));
-    return WriteEvent(std::move(e));
+    return Write(global_step, t,
+                 [tag, max_images, bad_color = tensor::DeepCopy(bad_color)](
+                     const Tensor& t, Summary* s) {
+                   return AddTensorAsImageToSummary(t, tag, max_images,
+                                                    bad_color, s);
+                 });
   }
 
   Status WriteAudio(int64_t global_step, Tensor t, const string& tag,
                     int max_outputs, float sample_rate) override {
-    std::unique_ptr<Event> e{new Event};
-    e->set_step(global_step);
-    e->set_wall_time(GetWallTime());
-    TF_RETURN_IF_ERROR(AddTensorAsAudioToSummary(
-        t, tag, max_outputs, sample_rate, e->mutable_summary()));
-    return WriteEvent(std::move(e));
+    return Write(global_step, t,
+                 [tag, max_outputs, sample_rate](const Tensor& t, Summary* s) {
+                   return AddTensorAsAudioToSummary(t, tag, max_outputs,
+                                                    sample_rate, s);
+                 });
   }
 
   Status WriteGraph(int64_t global_step,
@@ -151,44 +189,175 @@ class SummaryFileWriter : public SummaryWriterInterface {
   }
 
   Status WriteEvent(std::unique_ptr<Event> event) override {
-    mutex_lock ml(mu_);
-    queue_.emplace_back(std::move(event));
-    if (queue_.size() > max_queue_ ||
-        env_->NowMicros() - last_flush_ > 1000 * flush_millis_) {
-      return InternalFlush();
-    }
-    return absl::OkStatus();
+    return Enqueue({std::move(event), nullptr});
   }
 
   string DebugString() const override { return "SummaryFileWriter"; }
 
  private:
+  // An event of the queue, whose summary is still to be converted from a
+  // tensor by `convert` if it is set.
+  struct PendingEvent {
+    std::unique_ptr<Event> event;
+    std::function<Status(Event*)> convert;
+  };
+
+  // The steps and the values of the scalars of a tag in a flushed batch.
+  struct ScalarColumn {
+    std::vector<double> steps;
+    std::vector<double> values;
+  };
+
   double GetWallTime() {
     return static_cast<double>(env_->NowMicros()) / 1.0e6;
   }
 
-  Status InternalFlush() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
-    for (const std::unique_ptr<Event>& e : queue_) {
-      events_writer_->WriteEvent(*e);
+  // Converts `t` into the summary of an event of `global_step` with
+  // `convert`, on the calling thread, or on the background thread in async
+  // mode.
+  Status Write(int64_t global_step, const Tensor& t,
+               std::function<Status(const Tensor&, Summary*)> convert) {
+    std::unique_ptr<Event> e{new Event};
+    e->set_step(global_step);
+    e->set_wall_time(GetWallTime());
+    if (!options_.async) {
+      TF_RETURN_IF_ERROR(convert(t, e->mutable_summary()));
+      return WriteEvent(std::move(e));
+    }
+    // The tensor is copied, as its buffer may be updated in place once the
+    // summary op returns.
+    auto convert_event = [t = tensor::DeepCopy(t),
+                          convert = std::move(convert)](Event* event) {
+      return convert(t, event->mutable_summary());
+    };
+    return Enqueue({std::move(e), std::move(convert_event)});
+  }
+
+  Status Enqueue(PendingEvent pending) TF_LOCKS_EXCLUDED(mu_, write_mu_) {
+    {
+      mutex_lock ml(mu_);
+      queue_.push_back(std::move(pending));
+      if (!QueueIsDue()) {
+        return absl::OkStatus();
+      }
+      if (options_.async) {
+        queue_due_.notify_one();
+        return absl::OkStatus();
+      }
+    }
+    return FlushQueue();
+  }
+
+  bool QueueIsDue() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    return queue_.size() > options_.max_queue ||
+           env_->NowMicros() - last_flush_ > 1000 * options_.flush_millis;
+  }
+
+  // Flushes the queue whenever it is due, until the writer is destroyed.
+  void BackgroundLoop() {
+    while (true) {
+      {
+        mutex_lock ml(mu_);
+        const int wait_millis = std::max(options_.flush_millis, 1);
+        while (!stop_ && (queue_.empty() || !QueueIsDue())) {
+          queue_due_.wait_for(ml, std::chrono::milliseconds(wait_millis));
+        }
+        if (stop_) {
+          return;
+        }
+      }
+      const Status s = FlushQueue();
+      if (!s.ok()) {
+        mutex_lock wl(write_mu_);
+        background_status_.Update(s);
+      }
+    }
+  }
+
+  // Converts and writes the events of the queue as a batch, then flushes the
+  // files. The batch is taken out of `mu_`, so that the summaries keep being
+  // enqueued while it is written.
+  Status FlushQueue() TF_LOCKS_EXCLUDED(mu_, write_mu_) {
+    mutex_lock wl(write_mu_);
+    std::vector<PendingEvent> batch;
+    {
+      mutex_lock ml(mu_);
+      batch.swap(queue_);
+      last_flush_ = env_->NowMicros();
+    }
+    Status status;
+    std::map<string, ScalarColumn> columns;
+    for (PendingEvent& pending : batch) {
+      if (pending.convert) {
+        const Status s = pending.convert(pending.event.get());
+        if (!s.ok()) {
+          status.Update(s);
+          continue;
+        }
+      }
+      events_writer_->WriteEvent(*pending.event);
+      if (columns_writer_ != nullptr) {
+        for (const Summary::Value& v : pending.event->summary().value()) {
+          if (v.value_case() != Summary::Value::kSimpleValue) continue;
+          ScalarColumn& column = columns[v.tag()];
+          column.steps.push_back(pending.event->step());
+          column.values.push_back(v.simple_value());
+        }
+      }
     }
-    queue_.clear();
     TF_RETURN_WITH_CONTEXT_IF_ERROR(events_writer_->Flush(),
                                     "Could not flush events file.");
-    last_flush_ = env_->NowMicros();
-    return absl::OkStatus();
+    if (columns_writer_ != nullptr) {
+      if (!columns.empty()) {
+        TF_RETURN_IF_ERROR(WriteColumns(columns));
+      }
+      TF_RETURN_IF_ERROR(columns_writer_->Flush());
+      TF_RETURN_WITH_CONTEXT_IF_ERROR(
+          columns_file_->Flush(), "Could not flush the scalar columns file.");
+    }
+    return status;
+  }
+
+  // Appends a record of `columns` to the scalar columns file.
+  Status WriteColumns(const std::map<string, ScalarColumn>& columns)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(write_mu_) {
+    Event event;
+    event.set_wall_time(GetWallTime());
+    for (const auto& [tag, column] : columns) {
+      const int64_t size = column.steps.size();
+      Tensor t(DT_DOUBLE, TensorShape({2, size}));
+      auto matrix = t.matrix<double>();
+      for (int64_t i = 0; i < size; ++i) {
+        matrix(0, i) = column.steps[i];
+        matrix(1, i) = column.values[i];
+      }
+      Summary::Value* v = event.mutable_summary()->add_value();
+      v->set_tag(tag);
+      t.AsProtoTensorContent(v->mutable_tensor());
+    }
+    return columns_writer_->WriteRecord(event.SerializeAsString());
   }
 
   bool is_initialized_;
-  const int max_queue_;
-  const int flush_millis_;
-  uint64 last_flush_;
+  const SummaryFileWriterOptions options_;
   Env* env_;
   mutex mu_;
-  std::vector<std::unique_ptr<Event>> queue_ TF_GUARDED_BY(mu_);
-  // A pointer to allow deferred construction.
-  std::unique_ptr<EventsWriter> events_writer_ TF_GUARDED_BY(mu_);
+  uint64 last_flush_ TF_GUARDED_BY(mu_);
+  condition_variable queue_due_;
+  bool stop_ TF_GUARDED_BY(mu_) = false;
+  std::vector<PendingEvent> queue_ TF_GUARDED_BY(mu_);
   std::vector<std::pair<string, SummaryMetadata>> registered_summaries_
       TF_GUARDED_BY(mu_);
+  // Serializes the writes of the batches, which are taken in order.
+  mutex write_mu_ TF_ACQUIRED_BEFORE(mu_);
+  // A pointer to allow deferred construction.
+  std::unique_ptr<EventsWriter> events_writer_ TF_GUARDED_BY(write_mu_);
+  std::unique_ptr<WritableFile> columns_file_ TF_GUARDED_BY(write_mu_);
+  std::unique_ptr<io::RecordWriter> columns_writer_ TF_GUARDED_BY(write_mu_);
+  // The first error of the batches written by the background thread since
+  // the last Flush().
+  Status background_status_ TF_GUARDED_BY(write_mu_);
+  std::unique_ptr<Thread> background_thread_;
 };
 
 }  // namespace
@@ -197,7 +366,18 @@ Status CreateSummaryFileWriter(int max_queue, int flush_millis,
                                const string& logdir,
                                const string& filename_suffix, Env* env,
                                SummaryWriterInterface** result) {
-  SummaryFileWriter* w = new SummaryFileWriter(max_queue, flush_millis, env);
+  SummaryFileWriterOptions options;
+  options.max_queue = max_queue;
+  options.flush_millis = flush_millis;
+  return CreateSummaryFileWriter(options, logdir, filename_suffix, env,
+                                 result);
+}
+
+Status CreateSummaryFileWriter(const SummaryFileWriterOptions& options,
+                               const string& logdir,
+                               const string& filename_suffix, Env* env,
+                               SummaryWriterInterface** result) {
+  SummaryFileWriter* w = new SummaryFileWriter(options, env);
   const Status s = w->Initialize(logdir, filename_suffix);
   if (!s.ok()) {
     w->Unref();
@@ -38,6 +38,41 @@ Status CreateSummaryFileWriter(int max_queue, int flush_millis,
                                const string& filename_suffix, Env* env,
                                SummaryWriterInterface** result);
 
+/// \brief Options of the summary file writers.
+///
+/// The CreateSummaryFileWriter op reads `async` and `write_scalar_columns`
+/// from the TF_SUMMARY_WRITER_ASYNC and TF_SUMMARY_WRITER_SCALAR_COLUMNS
+/// environment variables.
+struct SummaryFileWriterOptions {
+  /// The number of summaries enqueued before a flush of the queue.
+  int max_queue = 10;
+
+  /// The maximum number of milliseconds between two flushes of the queue.
+  int flush_millis = 10000;
+
+  /// Whether the summaries are converted to events, serialized and written
+  /// by a background thread of the writer. The Write* calls then only copy
+  /// their tensor and enqueue it, and the conversion errors are returned by
+  /// the next Flush().
+  bool async = false;
+
+  /// Whether the scalar summaries are also written to a columnar file next
+  /// to the events file, named scalars.out.tfcolumns.[timestamp].[suffix].
+  /// Every flush of the queue appends a ZLIB compressed record to it: an
+  /// Event whose summary has a value per tag, with a [2, n] DT_DOUBLE
+  /// tensor holding the steps of the batch, then their values, so that a
+  /// reader loads a tag's scalars without parsing an event per point.
+  bool write_scalar_columns = false;
+};
+
+/// \brief Creates a summary file writer with the given options.
+///
+/// See above for the events file and the arguments.
+Status CreateSummaryFileWriter(const SummaryFileWriterOptions& options,
+                               const string& logdir,
+                               const string& filename_suffix, Env* env,
+                               SummaryWriterInterface** result);
+
 }  // namespace tensorflow
 
 #endif  // TENSORFLOW_CORE_SUMMARY_SUMMARY_FILE_WRITER_H_
@@ -16,10 +16,13 @@ limitations under the License.
 
 #include "tensorflow/core/framework/summary.pb.h"
 #include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/refcount.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/compression.h"
 #include "tensorflow/core/lib/io/path.h"
 #include "tensorflow/core/lib/io/record_reader.h"
 #include "tensorflow/core/platform/env.h"
@@ -281,5 +284,117 @@ TEST_F(SummaryFileWriterTest, AvoidFilenameCollision) {
       << "files = [" << absl::StrJoin(files, ", ") << "]";
 }
 
+// Returns the records of the files of the test directory whose name contains
+// both `prefix` and `test_name`.
+std::vector<tstring> ReadRecords(Env* env, const string& prefix,
+                                 const string& test_name,
+                                 const io::RecordReaderOptions& options) {
+  std::vector<string> files;
+  TF_CHECK_OK(env->GetChildren(testing::TmpDir(), &files));
+  std::vector<tstring> records;
+  for (const string& f : files) {
+    if (!absl::StrContains(f, prefix) || !absl::StrContains(f, test_name)) {
+      continue;
+    }
+    std::unique_ptr<RandomAccessFile> read_file;
+    TF_CHECK_OK(env->NewRandomAccessFile(io::JoinPath(testing::TmpDir(), f),
+                                         &read_file));
+    io::RecordReader reader(read_file.get(), options);
+    tstring record;
+    uint64 offset = 0;
+    while (reader.ReadRecord(&offset, &record).ok()) {
+      records.push_back(record);
+    }
+  }
+  return records;
+}
+
+TEST_F(SummaryFileWriterTest, AsyncWritesTheEventsInOrder) {
+  const string test_name = "async_order_test";
+  SummaryFileWriterOptions options;
+  options.max_queue = 7;
+  options.async = true;
+  SummaryWriterInterface* writer;
+  TF_ASSERT_OK(CreateSummaryFileWriter(options, testing::TmpDir(), test_name,
+                                       &env_, &writer));
+  core::ScopedUnref deleter(writer);
+  const int num_steps = 100;
+  for (int step = 0; step < num_steps; ++step) {
+    Tensor value(DT_FLOAT, TensorShape({}));
+    value.scalar<float>()() = step;
+    TF_ASSERT_OK(writer->WriteScalar(step, value, "loss"));
+    // The tensor is copied by the writer.
+    value.scalar<float>()() = -1;
+  }
+  TF_ASSERT_OK(writer->Flush());
+
+  std::vector<tstring> records = ReadRecords(&env_, "events", test_name,
+                                             io::RecordReaderOptions());
+  // The first event is the version of the file.
+  ASSERT_EQ(records.size(), num_steps + 1);
+  for (int step = 0; step < num_steps; ++step) {
+    Event e;
+    ASSERT_TRUE(e.ParseFromString(records[step + 1]));
+    EXPECT_EQ(e.step(), step);
+    ASSERT_EQ(e.summary().value_size(), 1);
+    EXPECT_EQ(e.summary().value(0).simple_value(), step);
+  }
+}
+
+TEST_F(SummaryFileWriterTest, AsyncReturnsTheConversionErrorsOnFlush) {
+  SummaryFileWriterOptions options;
+  options.async = true;
+  SummaryWriterInterface* writer;
+  TF_ASSERT_OK(CreateSummaryFileWriter(options, testing::TmpDir(),
+                                       "async_error_test", &env_, &writer));
+  core::ScopedUnref deleter(writer);
+  // An image must have 4 dimensions.
+  Tensor image(DT_FLOAT, TensorShape({1, 1}));
+  image.flat<float>().setZero();
+  Tensor bad_color(DT_UINT8, TensorShape({1}));
+  bad_color.flat<uint8>().setZero();
+  TF_EXPECT_OK(writer->WriteImage(2, image, "name", 1, bad_color));
+  EXPECT_FALSE(writer->Flush().ok());
+  TF_EXPECT_OK(writer->Flush());
+}
+
+TEST_F(SummaryFileWriterTest, WriteScalarColumns) {
+  const string test_name = "scalar_columns_test";
+  SummaryFileWriterOptions options;
+  options.max_queue = 100;
+  options.write_scalar_columns = true;
+  SummaryWriterInterface* writer;
+  TF_ASSERT_OK(CreateSummaryFileWriter(options, testing::TmpDir(), test_name,
+                                       &env_, &writer));
+  core::ScopedUnref deleter(writer);
+  for (int step = 0; step < 3; ++step) {
+    Tensor value(DT_FLOAT, TensorShape({}));
+    value.scalar<float>()() = step * 2;
+    TF_ASSERT_OK(writer->WriteScalar(step, value, "a"));
+    value.scalar<float>()() = step * 3;
+    TF_ASSERT_OK(writer->WriteScalar(step + 10, value, "b"));
+  }
+  TF_ASSERT_OK(writer->Flush());
+
+  std::vector<tstring> records = ReadRecords(
+      &env_, "tfcolumns", test_name,
+      io::RecordReaderOptions::CreateRecordReaderOptions(
+          io::compression::kZlib));
+  ASSERT_EQ(records.size(), 1);
+  Event e;
+  ASSERT_TRUE(e.ParseFromString(records[0]));
+  ASSERT_EQ(e.summary().value_size(), 2);
+  EXPECT_EQ(e.summary().value(0).tag(), "a");
+  EXPECT_EQ(e.summary().value(1).tag(), "b");
+  Tensor a;
+  Tensor b;
+  ASSERT_TRUE(a.FromProto(e.summary().value(0).tensor()));
+  ASSERT_TRUE(b.FromProto(e.summary().value(1).tensor()));
+  test::ExpectTensorEqual<double>(
+      a, test::AsTensor<double>({0, 1, 2, 0, 2, 4}, TensorShape({2, 3})));
+  test::ExpectTensorEqual<double>(
+      b, test::AsTensor<double>({10, 11, 12, 0, 3, 6}, TensorShape({2, 3})));
+}
+
 }  // namespace
 }  // namespace tensorflow
@@ -0,0 +1,139 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/tfrt/fallback/request_arena_allocator.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+
+#include "absl/strings/string_view.h"
+#include "xla/tsl/framework/allocator.h"
+#include "tsl/lib/monitoring/sampler.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+
+namespace tensorflow {
+namespace tfrt_stub {
+namespace {
+
+auto* request_arena_bytes = tsl::monitoring::Sampler<1>::New(
+    {"/tensorflow/tfrt/fallback/request_arena_bytes",
+     "The peak bytes of the per-request arena allocator of fallback kernels.",
+     "model_name"},
+    // Power of 2 with bucket count 32 (~4GB).
+    {tsl::monitoring::Buckets::Exponential(1, 2, 32)});
+
+}  // namespace
+
+RequestArenaAllocator::RequestArenaAllocator(tsl::Allocator* base,
+                                             const Options& options)
+    : base_(base), options_(options) {
+  DCHECK(base_);
+  DCHECK_LE(options_.max_small_allocation_bytes, options_.chunk_bytes);
+}
+
+RequestArenaAllocator::~RequestArenaAllocator() {
+  for (char* chunk : chunks_) {
+    base_->DeallocateRaw(chunk);
+  }
+}
+
+void* RequestArenaAllocator::AllocateRaw(size_t alignment, size_t num_bytes) {
+  mutex_lock l(mu_);
+  DCHECK(!released_);
+
+  void* ptr = nullptr;
+  if (num_bytes <= options_.max_small_allocation_bytes &&
+      alignment <= kAllocatorAlignment) {
+    auto aligned = [mask = static_cast<uintptr_t>(alignment) - 1](char* p) {
+      const uintptr_t address = reinterpret_cast<uintptr_t>(p);
+      return reinterpret_cast<char*>((address + mask) & ~mask);
+    };
+    char* next = next_ == nullptr ? nullptr : aligned(next_);
+    if (next == nullptr || end_ - next < static_cast<ptrdiff_t>(num_bytes)) {
+      next = nullptr;
+      if (static_cast<size_t>(stats_.bytes_reserved) + options_.chunk_bytes <=
+          options_.max_arena_bytes) {
+        next = static_cast<char*>(
+            base_->AllocateRaw(kAllocatorAlignment, options_.chunk_bytes));
+      }
+      if (next != nullptr) {
+        chunks_.push_back(next);
+        end_ = next + options_.chunk_bytes;
+        stats_.bytes_reserved += options_.chunk_bytes;
+        stats_.bytes_in_use += options_.chunk_bytes;
+      }
+    }
+    if (next != nullptr) {
+      ptr = next;
+      next_ = next + num_bytes;
+    }
+  }
+
+  if (ptr == nullptr) {
+    ptr = base_->AllocateRaw(alignment, num_bytes);
+    if (ptr == nullptr) return nullptr;
+    base_allocations_[ptr] = num_bytes;
+    stats_.bytes_in_use += num_bytes;
+  }
+
+  ++num_live_allocations_;
+  ++stats_.num_allocs;
+  stats_.peak_bytes_in_use =
+      std::max(stats_.peak_bytes_in_use, stats_.bytes_in_use);
+  stats_.largest_alloc_size =
+      std::max<int64_t>(stats_.largest_alloc_size, num_bytes);
+  return ptr;
+}
+
+void RequestArenaAllocator::DeallocateRaw(void* ptr) {
+  bool should_delete = false;
+  {
+    mutex_lock l(mu_);
+    // Allocations carved out of the chunks are freed with the chunks.
+    auto it = base_allocations_.find(ptr);
+    if (it != base_allocations_.end()) {
+      stats_.bytes_in_use -= it->second;
+      base_allocations_.erase(it);
+      base_->DeallocateRaw(ptr);
+    }
+    --num_live_allocations_;
+    should_delete = ShouldDelete();
+  }
+  if (should_delete) delete this;
+}
+
+std::optional<tsl::AllocatorStats> RequestArenaAllocator::GetStats() {
+  mutex_lock l(mu_);
+  return stats_;
+}
+
+void RequestArenaAllocator::Release(absl::string_view model_name) {
+  bool should_delete = false;
+  {
+    mutex_lock l(mu_);
+    DCHECK(!released_);
+    released_ = true;
+    request_arena_bytes->GetCell(std::string(model_name))
+        ->Add(stats_.peak_bytes_in_use);
+    should_delete = ShouldDelete();
+  }
+  if (should_delete) delete this;
+}
+
+}  // namespace tfrt_stub
+}  // namespace tensorflow
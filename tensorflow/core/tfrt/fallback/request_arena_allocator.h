@@ -0,0 +1,98 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_TFRT_FALLBACK_REQUEST_ARENA_ALLOCATOR_H_
+#define TENSORFLOW_CORE_TFRT_FALLBACK_REQUEST_ARENA_ALLOCATOR_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
+#include "xla/tsl/framework/allocator.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+namespace tfrt_stub {
+
+// Thread-safe.
+// An allocator for the host tensors of one request. Small allocations are
+// carved out of large chunks and are never freed individually, which makes
+// the many small temporaries of fallback kernels cheap; the chunks are all
+// returned to the base allocator at once. Large allocations, and allocations
+// made once `max_arena_bytes` is reached, go to the base allocator.
+//
+// Tensors allocated from the arena may outlive the request, e.g. as its
+// outputs. The allocator therefore deletes itself once Release() has been
+// called and every allocation has been deallocated.
+class RequestArenaAllocator : public tsl::Allocator {
+ public:
+  struct Options {
+    // The size of the chunks that small allocations are carved out of.
+    size_t chunk_bytes = 64 << 10;
+    // Allocations above this size go to the base allocator.
+    size_t max_small_allocation_bytes = 4 << 10;
+    // The total size of the chunks of one request. Small allocations go to
+    // the base allocator once it is reached.
+    size_t max_arena_bytes = 16 << 20;
+  };
+
+  // `base` must outlive this allocator.
+  RequestArenaAllocator(tsl::Allocator* base, const Options& options);
+
+  std::string Name() override { return "request_arena"; }
+
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override;
+  void DeallocateRaw(void* ptr) override;
+
+  // `bytes_in_use` and `peak_bytes_in_use` count the chunks as a whole,
+  // `bytes_reserved` counts the chunks only.
+  std::optional<tsl::AllocatorStats> GetStats() override;
+
+  // Marks the end of the request of the model `model_name`, and records the
+  // peak bytes used by it in /tensorflow/tfrt/fallback/request_arena_bytes.
+  // The allocator must not be used for new allocations afterwards.
+  void Release(absl::string_view model_name);
+
+ private:
+  ~RequestArenaAllocator() override;
+
+  // Returns whether the allocator should be deleted.
+  bool ShouldDelete() const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    return released_ && num_live_allocations_ == 0;
+  }
+
+  tsl::Allocator* const base_;
+  const Options options_;
+
+  mutex mu_;
+  std::vector<char*> chunks_ TF_GUARDED_BY(mu_);
+  // The free range of the last chunk.
+  char* next_ TF_GUARDED_BY(mu_) = nullptr;
+  char* end_ TF_GUARDED_BY(mu_) = nullptr;
+  // The allocations of the base allocator, with their sizes.
+  absl::flat_hash_map<void*, size_t> base_allocations_ TF_GUARDED_BY(mu_);
+  int64_t num_live_allocations_ TF_GUARDED_BY(mu_) = 0;
+  bool released_ TF_GUARDED_BY(mu_) = false;
+  tsl::AllocatorStats stats_ TF_GUARDED_BY(mu_);
+};
+
+}  // namespace tfrt_stub
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_TFRT_FALLBACK_REQUEST_ARENA_ALLOCATOR_H_
@@ -0,0 +1,112 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/tfrt/fallback/request_arena_allocator.h"
+
+#include <cstdint>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/monitoring/cell_reader.h"
+
+namespace tensorflow {
+namespace tfrt_stub {
+namespace {
+
+using ::tensorflow::monitoring::testing::CellReader;
+using ::tensorflow::monitoring::testing::Histogram;
+
+TEST(RequestArenaAllocatorTest, SmallAllocationsShareChunks) {
+  RequestArenaAllocator::Options options;
+  options.chunk_bytes = 1024;
+  options.max_small_allocation_bytes = 256;
+  auto* allocator = new RequestArenaAllocator(cpu_allocator(), options);
+
+  void* a = allocator->AllocateRaw(Allocator::kAllocatorAlignment, 100);
+  void* b = allocator->AllocateRaw(Allocator::kAllocatorAlignment, 100);
+  ASSERT_NE(a, nullptr);
+  ASSERT_NE(b, nullptr);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(b) % Allocator::kAllocatorAlignment,
+            0);
+  EXPECT_EQ(static_cast<char*>(b) - static_cast<char*>(a), 128);
+
+  // Large allocations go to the base allocator.
+  void* c = allocator->AllocateRaw(Allocator::kAllocatorAlignment, 4096);
+  ASSERT_NE(c, nullptr);
+
+  auto stats = allocator->GetStats();
+  ASSERT_TRUE(stats.has_value());
+  EXPECT_EQ(stats->num_allocs, 3);
+  EXPECT_EQ(stats->bytes_reserved, 1024);
+  EXPECT_EQ(stats->bytes_in_use, 1024 + 4096);
+  EXPECT_EQ(stats->largest_alloc_size, 4096);
+
+  allocator->DeallocateRaw(c);
+  stats = allocator->GetStats();
+  EXPECT_EQ(stats->bytes_in_use, 1024);
+  EXPECT_EQ(stats->peak_bytes_in_use, 1024 + 4096);
+
+  allocator->DeallocateRaw(a);
+  allocator->DeallocateRaw(b);
+  allocator->Release("test_model");
+}
+
+TEST(RequestArenaAllocatorTest, FallsBackToBaseAllocatorWhenFull) {
+  RequestArenaAllocator::Options options;
+  options.chunk_bytes = 256;
+  options.max_small_allocation_bytes = 256;
+  options.max_arena_bytes = 256;
+  auto* allocator = new RequestArenaAllocator(cpu_allocator(), options);
+
+  void* a = allocator->AllocateRaw(Allocator::kAllocatorAlignment, 200);
+  void* b = allocator->AllocateRaw(Allocator::kAllocatorAlignment, 200);
+  ASSERT_NE(a, nullptr);
+  ASSERT_NE(b, nullptr);
+  EXPECT_EQ(allocator->GetStats()->bytes_reserved, 256);
+  EXPECT_EQ(allocator->GetStats()->bytes_in_use, 256 + 200);
+
+  allocator->DeallocateRaw(b);
+  allocator->DeallocateRaw(a);
+  allocator->Release("test_model");
+}
+
+TEST(RequestArenaAllocatorTest, TensorsOutliveRelease) {
+  CellReader<Histogram> arena_bytes(
+      "/tensorflow/tfrt/fallback/request_arena_bytes");
+  auto* allocator = new RequestArenaAllocator(cpu_allocator(), {});
+
+  Tensor output;
+  {
+    Tensor temporary(allocator, DT_INT32, TensorShape({16}));
+    temporary.flat<int32_t>().setConstant(7);
+    output = Tensor(allocator, DT_INT32, TensorShape({16}));
+    output.flat<int32_t>() = temporary.flat<int32_t>();
+  }
+  allocator->Release("test_model");
+
+  // The allocator is deleted with the last tensor.
+  test::ExpectTensorEqual<int32_t>(
+      output, test::AsTensor<int32_t>(std::vector<int32_t>(16, 7)));
+  output = Tensor();
+
+  EXPECT_EQ(arena_bytes.Delta("test_model").num(), 1);
+}
+
+}  // namespace
+}  // namespace tfrt_stub
+}  // namespace tensorflow
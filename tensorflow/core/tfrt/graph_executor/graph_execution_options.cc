@@ -123,8 +123,13 @@ std::ostream& operator<<(std::ostream& os,
             << ", enable_grappler_function_optimizer = "
             << options.enable_grappler_function_optimizer
             << ", enable_tfrt_gpu = " << options.enable_tfrt_gpu
-            << ", use_ifrt = " << options.use_ifrt << ", runtime = "
-            << options.runtime
+            << ", use_ifrt = " << options.use_ifrt
+            << ", cross_model_resource_sharing_key = "
+            << options.cross_model_resource_sharing_key
+            << ", mlrt_inline_execution_max_kernels = "
+            << options.mlrt_inline_execution_max_kernels
+            << ", enable_request_arena = " << options.enable_request_arena
+            << ", runtime = " << options.runtime
             // clang-tidy off
             << ", model_metadata = "
             << options.model_metadata.DebugString()
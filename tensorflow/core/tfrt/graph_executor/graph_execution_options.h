@@ -108,6 +108,28 @@ struct GraphExecutionOptions {
   // This option is experimental.
   bool use_ifrt = false;
 
+  // If non-empty, the client graphs of all graph executors with the same key
+  // and client graph name share the queues of their batch ops, and nothing
+  // else, so that the requests of models loaded several times are batched
+  // together. The key must identify the content of the
+  // model, e.g. its SavedModel fingerprint. Only supported with MLRT.
+  // This option is experimental.
+  std::string cross_model_resource_sharing_key;
+
+  // If positive, MLRT functions with at most this many kernels and no
+  // asynchronous kernels, i.e. for which the compiler's cost model found
+  // nothing worth running in parallel, start executing on the caller thread
+  // instead of being handed over to the work queue. This saves the thread hops
+  // that dominate the latency of small models. This option is experimental.
+  int mlrt_inline_execution_max_kernels = 0;
+
+  // If true, the host tensors allocated by fallback kernels during a request
+  // come from a per-request arena that is freed all at once, instead of from
+  // the host allocator one by one. The peak bytes of the arena are recorded in
+  // /tensorflow/tfrt/fallback/request_arena_bytes. This option is
+  // experimental.
+  bool enable_request_arena = false;
+
   tensorflow::TfrtCompileOptions compile_options;
 };
 
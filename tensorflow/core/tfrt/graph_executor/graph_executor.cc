@@ -25,13 +25,16 @@ limitations under the License.
 #include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/inlined_vector.h"
 #include "absl/log/check.h"
 #include "absl/log/log.h"
 #include "absl/status/status.h"
+#include "absl/strings/match.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_join.h"
 #include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/time/clock.h"
 #include "absl/time/time.h"
 #include "absl/types/optional.h"
@@ -139,8 +142,41 @@ auto* graph_executor_mode = monitoring::Gauge<std::string, 2>::New(
     "executor modes (BEF vs MLRT interpreter)",
     "model_name", "model_version");
 
+// Returns the resource context holding the batch resources shared by the
+// client graphs whose executors have the same `key`. It is destroyed with the
+// last of them.
+std::shared_ptr<tfrt::ResourceContext> GetSharedBatchResourceContext(
+    const std::string& key) {
+  static absl::Mutex* mu = new absl::Mutex();
+  static auto* contexts = new absl::flat_hash_map<
+      std::string, std::weak_ptr<tfrt::ResourceContext>>();
+  absl::MutexLock lock(mu);
+  std::shared_ptr<tfrt::ResourceContext> context = (*contexts)[key].lock();
+  if (context == nullptr) {
+    context = std::make_shared<tfrt::ResourceContext>();
+    (*contexts)[key] = context;
+  }
+  return context;
+}
+
 }  // namespace
 
+bool CanRunMlrtFunctionInline(const mlrt::bc::Executable& executable,
+                              mlrt::bc::Function function, int max_kernels) {
+  if (function.kernels().size() > static_cast<size_t>(max_kernels)) {
+    return false;
+  }
+  const auto kernel_names = executable.kernel_names();
+  for (const auto& kernel : function.kernels()) {
+    // E.g. `mlrt.async` and `tf_mlrt.async_while`, which run other functions
+    // in parallel.
+    if (absl::StrContains(kernel_names[kernel.code()].Get(), "async")) {
+      return false;
+    }
+  }
+  return true;
+}
+
 tensorflow::Status RunMlrtFunction(
     mlrt::bc::Function function,
     const mlrt::LoadedExecutable& loaded_executable,
@@ -148,7 +184,7 @@ tensorflow::Status RunMlrtFunction(
     tfrt::ConcurrentWorkQueue& work_queue,
     absl::Span<const tensorflow::Tensor> inputs,
     std::vector<tensorflow::Tensor>* outputs,
-    SyncResourceState* sync_resource_state) {
+    SyncResourceState* sync_resource_state, bool run_inline) {
   DCHECK(function);
   const auto* fallback_request_state =
       request_context->GetDataIfExists<tfd::KernelFallbackCompatRequestState>();
@@ -203,8 +239,12 @@ tensorflow::Status RunMlrtFunction(
 
   // TODO(chky): Set up cancellation.
 
-  work_queue.AddTask(
-      [&execution_context]() { mlrt::Execute(execution_context); });
+  if (run_inline) {
+    mlrt::Execute(execution_context);
+  } else {
+    work_queue.AddTask(
+        [&execution_context]() { mlrt::Execute(execution_context); });
+  }
 
   work_queue.Await(chain);
 
@@ -285,6 +325,9 @@ absl::StatusOr<std::unique_ptr<RequestInfo>> CreateRequestInfo(
   fallback_request_state.set_runtime_config(&options.runtime_config);
   fallback_request_state.set_cancellation_manager(
       &request_info->cancellation_manager);
+  if (options.enable_request_arena) {
+    fallback_request_state.EnableRequestArena(/*options=*/{});
+  }
 
   // Set priority in the builder.
   tfrt::RequestOptions request_options;
@@ -393,10 +436,14 @@ tensorflow::Status GraphExecutionRunOnFunction(
           "Function not found in MLRT executable: ", signature_name));
     }
 
+    const bool run_inline =
+        options.mlrt_inline_execution_max_kernels > 0 &&
+        CanRunMlrtFunctionInline(loaded_executable->executable(), function,
+                                 options.mlrt_inline_execution_max_kernels);
     return RunMlrtFunction(function, *loaded_executable,
                            request_info->tfrt_request_context,
                            *request_info->request_queue, inputs, outputs,
-                           /*sync_resource_state=*/nullptr);
+                           /*sync_resource_state=*/nullptr, run_inline);
   }
 
   DCHECK(func);
@@ -774,6 +821,16 @@ GraphExecutor::ImportAndCompileClientGraph(
         std::make_unique<mlrt::LoadedExecutable>(executable, *kernel_registry_);
     executable_context = std::make_shared<ExecutableContext>(
         std::move(bytecode_buffer), std::move(bytecode_executable));
+    if (!options_.cross_model_resource_sharing_key.empty()) {
+      // Only the batch resources are shared, the rest of the client graph
+      // resource context stays per model.
+      executable_context->resource_context
+          .CreateResource<std::shared_ptr<tfrt::ResourceContext>>(
+              tf_mlrt::kSharedBatchResourceContextName,
+              GetSharedBatchResourceContext(
+                  absl::StrCat(options_.cross_model_resource_sharing_key, "/",
+                               client_graph.name)));
+    }
   } else {
     tfrt::BefBuffer bef;
     TF_RETURN_IF_ERROR(
@@ -1103,6 +1160,15 @@ Status GraphExecutor::LoadedClientGraph::UpdateCost(
   {
     // Swap in the new `ExecutableContext`.
     tensorflow::mutex_lock lock(executable_context_mu_);
+    if (auto shared_batch_resource_context =
+            executable_context_->resource_context
+                .GetResource<std::shared_ptr<tfrt::ResourceContext>>(
+                    tf_mlrt::kSharedBatchResourceContextName)) {
+      new_executable_context->resource_context
+          .CreateResource<std::shared_ptr<tfrt::ResourceContext>>(
+              tf_mlrt::kSharedBatchResourceContextName,
+              **shared_batch_resource_context);
+    }
     // TODO(b/259602527): Add test cases that fail when code is changed. E.g.,
     // add a test kernel that examines the cost.
     executable_context_ = std::move(new_executable_context);
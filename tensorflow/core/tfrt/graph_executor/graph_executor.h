@@ -50,6 +50,7 @@ limitations under the License.
 #include "tensorflow/core/tfrt/graph_executor/executable_context.h"
 #include "tensorflow/core/tfrt/graph_executor/graph_execution_options.h"
 #include "tensorflow/core/tfrt/graph_executor/sync_resource_state.h"
+#include "tensorflow/core/tfrt/mlrt/bytecode/executable.h"
 #include "tensorflow/core/tfrt/mlrt/bytecode/function.h"
 #include "tensorflow/core/tfrt/mlrt/interpreter/context.h"
 #include "tensorflow/core/tfrt/mlrt/interpreter/value.h"
@@ -132,7 +133,9 @@ tensorflow::Status GraphExecutionRunOnFunction(
     std::optional<StreamCallbackId> stream_callback_id,
     CostRecorder* cost_recorder = nullptr);
 
-// Runs a MLRT function for executing tensorflow graphs.
+// Runs a MLRT function for executing tensorflow graphs. If `run_inline` is
+// true, the execution starts on the caller thread, and only the parts that
+// wait for asynchronous values continue on `work_queue`.
 tensorflow::Status RunMlrtFunction(
     mlrt::bc::Function function,
     const mlrt::LoadedExecutable& loaded_executable,
@@ -140,7 +143,14 @@ tensorflow::Status RunMlrtFunction(
     tfrt::ConcurrentWorkQueue& work_queue,
     absl::Span<const tensorflow::Tensor> inputs,
     std::vector<tensorflow::Tensor>* outputs,
-    SyncResourceState* sync_resource_state);
+    SyncResourceState* sync_resource_state, bool run_inline = false);
+
+// Returns true if `function` of `executable` has at most `max_kernels` kernels
+// and none of them starts asynchronous execution, so that running it inline
+// does not give up any parallelism; see
+// `GraphExecutionOptions::mlrt_inline_execution_max_kernels`.
+bool CanRunMlrtFunctionInline(const mlrt::bc::Executable& executable,
+                              mlrt::bc::Function function, int max_kernels);
 
 // Loads (if not yet) and runs a subgraph in a graph as per each request.
 class GraphExecutor {
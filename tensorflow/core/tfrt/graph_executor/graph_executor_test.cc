@@ -16,6 +16,7 @@ limitations under the License.
 
 #include <cstdint>
 #include <memory>
+#include <optional>
 #include <string>
 #include <utility>
 #include <vector>
@@ -25,6 +26,7 @@ limitations under the License.
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 #include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
 #include "absl/time/time.h"
 #include "absl/types/span.h"
 #include "tensorflow/cc/framework/ops.h"
@@ -42,13 +44,17 @@ limitations under the License.
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/graph/graph.h"
 #include "tensorflow/core/graph/graph_def_builder.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/protobuf.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/protobuf/rewriter_config.pb.h"
 #include "tensorflow/core/tfrt/fallback/fallback_state.h"
+#include "tensorflow/core/tfrt/fallback/op_kernel_runner_cache.h"
 #include "tensorflow/core/tfrt/graph_executor/graph_execution_options.h"
 #include "tensorflow/core/tfrt/mlrt/interpreter/context.h"
 #include "tensorflow/core/tfrt/mlrt/interpreter/value.h"
+#include "tensorflow/core/tfrt/mlrt/kernel/batch_kernel.h"
 #include "tensorflow/core/tfrt/mlrt/kernel/kernel.h"
 #include "tensorflow/core/tfrt/saved_model/saved_model_testutil.h"
 #include "tsl/platform/statusor.h"
@@ -129,6 +135,41 @@ TEST_P(GraphExecutorTest, Vanilla) {
               ::testing::ElementsAreArray({2}));
 }
 
+TEST_F(GraphExecutorTest, MlrtInlineExecution) {
+  GraphDef graph_def;
+  TF_ASSERT_OK(GetSimpleGraphDef(graph_def));
+
+  auto runtime = DefaultTfrtRuntime(/*num_threads=*/1);
+  GraphExecutor::Options options(runtime.get());
+  options.enable_mlrt = true;
+  options.mlrt_inline_execution_max_kernels = 64;
+
+  TF_ASSERT_OK_AND_ASSIGN(
+      auto fallback_state,
+      tensorflow::tfrt_stub::FallbackState::Create(
+          CreateDefaultSessionOptions(options), graph_def.library()))
+  auto resource_context = std::make_unique<tfrt::ResourceContext>();
+  TF_ASSERT_OK_AND_ASSIGN(
+      auto graph_executor,
+      GraphExecutor::Create(std::move(options), std::move(fallback_state),
+                            std::move(resource_context), graph_def,
+                            GetKernelRegistry()));
+
+  std::vector<std::pair<std::string, tensorflow::Tensor>> inputs;
+  inputs.push_back({"input", CreateTfTensor<int32_t>(
+                                 /*shape=*/{1, 3}, /*data=*/{1, 1, 1})});
+
+  for (int i = 0; i < 3; ++i) {
+    std::vector<tensorflow::Tensor> outputs;
+    TF_ASSERT_OK(graph_executor->Run(/*run_options=*/{}, inputs,
+                                     /*output_tensor_names=*/{"rank"},
+                                     /*target_tensor_names=*/{}, &outputs));
+    ASSERT_EQ(outputs.size(), 1);
+    EXPECT_THAT(GetTfTensorData<int32_t>(outputs[0]),
+                ::testing::ElementsAreArray({2}));
+  }
+}
+
 TEST_P(GraphExecutorTest, OnlineCostAnalysisOptionsOverrideToOnce) {
   GraphDef graph_def;
   TF_ASSERT_OK(GetSimpleGraphDef(graph_def));
@@ -503,6 +544,168 @@ TEST_F(GraphExecutorTest, Extend) {
               ::testing::ElementsAreArray({2}));
 }
 
+// Returns a graph whose `batch` output adds to each element of `input` the size
+// of the batch that it ran in.
+tensorflow::Status GetBatchFunctionGraphDef(GraphDef& graph_def) {
+  if (!protobuf::TextFormat::ParseFromString(
+          R"pb(
+            node {
+              name: "input"
+              op: "Placeholder"
+              device: "/device:CPU:0"
+              attr {
+                key: "dtype"
+                value { type: DT_INT32 }
+              }
+              attr {
+                key: "shape"
+                value { shape { dim { size: 1 } } }
+              }
+            }
+            node {
+              name: "batch"
+              op: "BatchFunction"
+              input: "input"
+              device: "/device:CPU:0"
+              attr {
+                key: "f"
+                value { func { name: "AddBatchSize" } }
+              }
+              attr {
+                key: "num_batch_threads"
+                value { i: 1 }
+              }
+              attr {
+                key: "max_batch_size"
+                value { i: 2 }
+              }
+              attr {
+                key: "batch_timeout_micros"
+                value { i: 10000000 }
+              }
+              attr {
+                key: "shared_name"
+                value { s: "batch" }
+              }
+              attr {
+                key: "Tin"
+                value { list { type: DT_INT32 } }
+              }
+              attr {
+                key: "Tcaptured"
+                value { list {} }
+              }
+              attr {
+                key: "Tout"
+                value { list { type: DT_INT32 } }
+              }
+            }
+            library {
+              function {
+                signature {
+                  name: "AddBatchSize"
+                  input_arg { name: "x" type: DT_INT32 }
+                  output_arg { name: "y" type: DT_INT32 }
+                }
+                node_def {
+                  name: "size"
+                  op: "Size"
+                  input: "x"
+                  attr {
+                    key: "T"
+                    value { type: DT_INT32 }
+                  }
+                  attr {
+                    key: "out_type"
+                    value { type: DT_INT32 }
+                  }
+                }
+                node_def {
+                  name: "add"
+                  op: "AddV2"
+                  input: "x"
+                  input: "size:output:0"
+                  attr {
+                    key: "T"
+                    value { type: DT_INT32 }
+                  }
+                }
+                ret { key: "y" value: "add:z:0" }
+              }
+            })pb",
+          &graph_def)) {
+    return absl::InternalError("failed to parse the batch function graph");
+  }
+  return absl::OkStatus();
+}
+
+TEST_F(GraphExecutorTest, CrossModelBatchingSharesOnlyTheBatchQueue) {
+  GraphDef graph_def;
+  TF_ASSERT_OK(GetBatchFunctionGraphDef(graph_def));
+
+  auto runtime = DefaultTfrtRuntime(/*num_threads=*/4);
+  std::vector<std::unique_ptr<GraphExecutor>> graph_executors;
+  for (int i = 0; i < 2; ++i) {
+    GraphExecutor::Options options(runtime.get());
+    options.enable_mlrt = true;
+    options.cross_model_resource_sharing_key = "same_fingerprint";
+
+    TF_ASSERT_OK_AND_ASSIGN(
+        auto fallback_state,
+        tensorflow::tfrt_stub::FallbackState::Create(
+            CreateDefaultSessionOptions(options), graph_def.library()));
+    auto kernel_registry = GetKernelRegistry();
+    tensorflow::tf_mlrt::RegisterTfMlrtBatchKernels(*kernel_registry);
+    TF_ASSERT_OK_AND_ASSIGN(
+        auto graph_executor,
+        GraphExecutor::Create(std::move(options), std::move(fallback_state),
+                              std::make_unique<tfrt::ResourceContext>(),
+                              graph_def, std::move(kernel_registry)));
+    graph_executors.push_back(std::move(graph_executor));
+  }
+
+  // A batch holds up to two requests and times out long after the test would,
+  // so each model only gets its request back if the other model's request
+  // joined its batch.
+  std::vector<tensorflow::Status> statuses(2);
+  std::vector<std::vector<tensorflow::Tensor>> outputs(2);
+  {
+    std::vector<std::unique_ptr<Thread>> threads;
+    for (int i = 0; i < 2; ++i) {
+      threads.emplace_back(Env::Default()->StartThread(
+          {}, absl::StrCat("model_", i), [&, i]() {
+            std::vector<std::pair<std::string, tensorflow::Tensor>> inputs;
+            inputs.push_back(
+                {"input", CreateTfTensor<int32_t>(/*shape=*/{1},
+                                                  /*data=*/{10 * i})});
+            statuses[i] = graph_executors[i]->Run(
+                /*run_options=*/{}, inputs,
+                /*output_tensor_names=*/{"batch:0"},
+                /*target_tensor_names=*/{}, &outputs[i]);
+          }));
+    }
+  }
+
+  for (int i = 0; i < 2; ++i) {
+    TF_ASSERT_OK(statuses[i]);
+    ASSERT_EQ(outputs[i].size(), 1);
+    EXPECT_THAT(GetTfTensorData<int32_t>(outputs[i][0]),
+                ::testing::ElementsAreArray({10 * i + 2}));
+  }
+
+  // The other resources of the batch op, e.g. its kernel runners, stay per
+  // model.
+  std::vector<OpKernelRunnerCache*> runner_caches;
+  for (auto& graph_executor : graph_executors) {
+    std::optional<OpKernelRunnerCache*> runner_cache =
+        graph_executor->resource_context().GetResource<OpKernelRunnerCache>(
+            tensorflow::tf_mlrt::kOpKernelRunnerCacheResourceName);
+    ASSERT_TRUE(runner_cache.has_value());
+    runner_caches.push_back(*runner_cache);
+  }
+  EXPECT_NE(runner_caches[0], runner_caches[1]);
+}
+
 TEST_F(GraphExecutorTest, DisableCompilation) {
   GraphDef graph_def;
   TF_ASSERT_OK(GetSimpleGraphDef(graph_def));
@@ -14,12 +14,14 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/tfrt/ifrt/checkpoint_loader.h"
 
+#include <algorithm>
 #include <cstdint>
 #include <memory>
 #include <string>
 #include <utility>
 #include <vector>
 
+#include "absl/functional/any_invocable.h"
 #include "absl/log/check.h"
 #include "absl/log/log.h"
 #include "absl/status/status.h"
@@ -59,6 +61,11 @@ namespace {
 
 static constexpr int kNumRestoreClusters = 4;
 
+// The variables are restored in shards of at most about this size, so that the
+// restored tensors are transferred to the devices while the next shards are
+// read, instead of after a few shards as large as a quarter of the model.
+static constexpr int64_t kMaxRestoreShardSizeBytes = int64_t{256} << 20;
+
 // A shard of variables to be restored.
 struct RestoreVariableShard {
   tensorflow::Tensor prefix;
@@ -138,16 +145,15 @@ absl::StatusOr<tensorflow::Tensor> Cast(
   return *(op_kernel_context.mutable_output(0));
 }
 
-absl::Status RunShard(RestoreVariableShard shard,
-                      IfrtRestoreTensorRegistry* ifrt_restore_tensor_registry,
-                      tfrt::ConcurrentWorkQueue* checkpoint_loader_work_queue,
-                      tf_mlrt::Context& context) {
+// Registers the tensors of `shard` in `ifrt_restore_tensor_registry` and
+// returns the task restoring them.
+absl::StatusOr<absl::AnyInvocable<void()>> PrepareShard(
+    RestoreVariableShard shard,
+    IfrtRestoreTensorRegistry* ifrt_restore_tensor_registry,
+    tf_mlrt::Context& context) {
   if (!ifrt_restore_tensor_registry) {
     return absl::InternalError("ifrt_restore_tensor_registry must not be null");
   }
-  if (!checkpoint_loader_work_queue) {
-    return absl::InternalError("checkpoint_loader_work_queue must not be null");
-  }
   const int num_outputs = shard.var_handles.size();
   DCHECK_EQ(num_outputs, shard.tensor_names.NumElements());
   auto& fallback_request_state = context.fallback_request_state();
@@ -219,10 +225,8 @@ absl::Status RunShard(RestoreVariableShard shard,
     async_state->results.push_back(std::move(promise));
   }
 
-  // Use dedicated work queue for restore operation.
-  checkpoint_loader_work_queue->AddTask([runner = std::move(runner),
-                                         async_state = std::move(async_state),
-                                         shard = std::move(shard)]() {
+  return [runner = std::move(runner), async_state = std::move(async_state),
+          shard = std::move(shard)]() {
     // Keep input tensor alive in `shard`.
     auto* op_kernel_context_ptr = &async_state->context;
     runner.Run(op_kernel_context_ptr);
@@ -271,12 +275,27 @@ absl::Status RunShard(RestoreVariableShard shard,
         }
       }
     }
+  };
+}
+
+// Runs the tasks of `tasks` from `index` one after the other on `work_queue`.
+// Each task enqueues the next one when it is done, so that the tasks enqueued
+// meanwhile, e.g. the transfers of the restored tensors to the devices, don't
+// wait for all the remaining tasks.
+void RunInSequence(
+    std::shared_ptr<std::vector<absl::AnyInvocable<void()>>> tasks, int index,
+    tfrt::ConcurrentWorkQueue* work_queue) {
+  if (index >= tasks->size()) return;
+  work_queue->AddTask([tasks = std::move(tasks), index, work_queue]() mutable {
+    (*tasks)[index]();
+    // Release the inputs and the kernel state of the restored shard.
+    (*tasks)[index] = nullptr;
+    RunInSequence(std::move(tasks), index + 1, work_queue);
   });
-  return absl::OkStatus();
 }
 
 int64_t GetSizeFromVarHandle(const ResourceHandle& handle) {
-  int size = 0;
+  int64_t size = 0;
   for (auto& dtype_and_shape : handle.dtypes_and_shapes()) {
     size += DataTypeSize(dtype_and_shape.dtype) *
             dtype_and_shape.shape.num_elements();
@@ -299,15 +318,27 @@ absl::Status CheckpointLoader::Load(
     const tensorflow::tfrt_stub::FallbackTensor& shape_and_slices,
     const mlrt::bc::Vector<tensorflow::DataType>& restored_dtypes,
     const mlrt::bc::Vector<bool>& truncate_in_cast, tf_mlrt::Context& context) {
+  if (!checkpoint_loader_work_queue_) {
+    return absl::InternalError("checkpoint_loader_work_queue must not be null");
+  }
   std::vector<int64_t> variable_sizes;
   variable_sizes.reserve(var_handles.size());
+  int64_t total_size = 0;
   for (auto& handle : var_handles) {
     variable_sizes.push_back(GetSizeFromVarHandle(
         handle.tensor().scalar<tensorflow::ResourceHandle>()()));
+    total_size += variable_sizes.back();
   }
 
-  std::vector<std::vector<int>> sharded_indices = tf_mlrt::ShardVariables(
-      kNumRestoreClusters, absl::MakeSpan(variable_sizes));
+  // There are at most `kNumRestoreClusters` shards restored at a time, which
+  // bounds the host memory of the restores in flight.
+  const int64_t num_shards = std::max<int64_t>(
+      kNumRestoreClusters,
+      std::min<int64_t>(var_handles.size(),
+                        (total_size + kMaxRestoreShardSizeBytes - 1) /
+                            kMaxRestoreShardSizeBytes));
+  std::vector<std::vector<int>> sharded_indices =
+      tf_mlrt::ShardVariables(num_shards, absl::MakeSpan(variable_sizes));
 
   // Converts the names and slices back to the tensor.
   auto vector_to_tensor = [](const std::vector<tsl::tstring>& vec) {
@@ -347,11 +378,29 @@ absl::Status CheckpointLoader::Load(
     shard.shape_and_slices = vector_to_tensor(shape_and_slices);
     shards.push_back(std::move(shard));
   }
-  for (const auto& shard : shards) {
-    TF_RETURN_IF_ERROR(RunShard(shard, ifrt_restore_tensor_registry_,
-                                checkpoint_loader_work_queue_, context));
+
+  std::vector<std::shared_ptr<std::vector<absl::AnyInvocable<void()>>>> chains;
+  for (int i = 0; i < std::min<int>(shards.size(), kNumRestoreClusters); ++i) {
+    chains.push_back(
+        std::make_shared<std::vector<absl::AnyInvocable<void()>>>());
   }
-  return absl::OkStatus();
+  absl::Status status;
+  for (int i = 0; i < shards.size(); ++i) {
+    absl::StatusOr<absl::AnyInvocable<void()>> task =
+        PrepareShard(std::move(shards[i]), ifrt_restore_tensor_registry_,
+                     context);
+    if (!task.ok()) {
+      status = task.status();
+      break;
+    }
+    chains[i % chains.size()]->push_back(*std::move(task));
+  }
+  // The shards already registered are restored even on error, so that their
+  // futures become ready.
+  for (auto& chain : chains) {
+    RunInSequence(std::move(chain), /*index=*/0, checkpoint_loader_work_queue_);
+  }
+  return status;
 }
 
 }  // namespace ifrt_serving
@@ -44,7 +44,6 @@ namespace tf_mlrt {
 namespace {
 
 constexpr char kMlrtBatchFunctionName[] = "MlrtBatchFunction";
-constexpr char kOpKernelRunnerCacheResourceName[] = "MlrtOpKernelCache";
 
 // The custom KernelFrame for tf_mlrt.batch_function op.
 struct BatchFunctionOp : mlrt::KernelFrame {
@@ -95,14 +94,23 @@ mlrt::ExecutionContext*& GetBatchFunctionMlrtContext() {
   return context;
 }
 
+// A thread local variable for passing the batch function of the caller's
+// executable in the same thread, along with the mlrt::ExecutionContext.
+mlrt::bc::Function& GetBatchFunctionMlrtFunction() {
+  thread_local mlrt::bc::Function function;
+  return function;
+}
+
 // An RAII object for saving and restoring the thread local
-// mlrt::ExecutionContext.
+// mlrt::ExecutionContext and batch function.
 class ScopedBatchFunctionMlrtContext {
  public:
-  explicit ScopedBatchFunctionMlrtContext(
-      mlrt::ExecutionContext* current_context) {
+  ScopedBatchFunctionMlrtContext(mlrt::ExecutionContext* current_context,
+                                 mlrt::bc::Function current_function) {
     last_context_ = GetBatchFunctionMlrtContext();
+    last_function_ = GetBatchFunctionMlrtFunction();
     GetBatchFunctionMlrtContext() = current_context;
+    GetBatchFunctionMlrtFunction() = current_function;
   }
 
   ScopedBatchFunctionMlrtContext(const ScopedBatchFunctionMlrtContext&) =
@@ -112,14 +120,16 @@ class ScopedBatchFunctionMlrtContext {
 
   ~ScopedBatchFunctionMlrtContext() {
     GetBatchFunctionMlrtContext() = last_context_;
+    GetBatchFunctionMlrtFunction() = last_function_;
   }
 
  private:
   mlrt::ExecutionContext* last_context_ = nullptr;
+  mlrt::bc::Function last_function_;
 };
 
 void BatchFunctionOp::Invoke() {
-  ScopedBatchFunctionMlrtContext scoped_context(&execution_context());
+  ScopedBatchFunctionMlrtContext scoped_context(&execution_context(), f());
 
   const auto& fallback_request_state = context().fallback_request_state();
 
@@ -173,15 +183,21 @@ void BatchFunctionOp::Invoke() {
 // A customized BatchResource whose batch function is a mlrt::bc::Function.
 class MlrtBatchResource : public tensorflow::serving::BatchResourceBase {
   struct MlrtBatchTask : BatchTask {
-    explicit MlrtBatchTask(mlrt::ExecutionContext* caller_context)
-        : caller_context(caller_context) {
+    MlrtBatchTask(mlrt::ExecutionContext* caller_context,
+                  mlrt::bc::Function caller_function)
+        : caller_context(caller_context), caller_function(caller_function) {
       DCHECK(caller_context);
+      DCHECK(caller_function);
     }
     mlrt::ExecutionContext* caller_context = nullptr;
+    // The batch function in the executable of `caller_context`. It differs
+    // from the one of the resource if the resource is shared across models.
+    mlrt::bc::Function caller_function;
 
    private:
     std::unique_ptr<BatchTask> CreateDerivedTask() override {
-      return std::make_unique<MlrtBatchTask>(this->caller_context);
+      return std::make_unique<MlrtBatchTask>(this->caller_context,
+                                             this->caller_function);
     }
   };
 
@@ -196,7 +212,8 @@ class MlrtBatchResource : public tensorflow::serving::BatchResourceBase {
   // local is used to pass the context.
   static absl::StatusOr<std::unique_ptr<BatchTask>> CreateBatchTask(
       OpKernelContext*) {
-    return {std::make_unique<MlrtBatchTask>(GetBatchFunctionMlrtContext())};
+    return {std::make_unique<MlrtBatchTask>(GetBatchFunctionMlrtContext(),
+                                            GetBatchFunctionMlrtFunction())};
   }
 
   // This can only be called in Compute() and ComputeAsync() because thread
@@ -208,9 +225,17 @@ class MlrtBatchResource : public tensorflow::serving::BatchResourceBase {
     const auto& fallback_request_state = context.fallback_request_state();
     // If `client_graph_resource_context` is null, it implies that it's safe to
     // fall back to the per-model resource context.
-    return fallback_request_state.client_graph_resource_context() != nullptr
-               ? fallback_request_state.client_graph_resource_context()
-               : &context.resource_context();
+    tfrt::ResourceContext* client_graph_resource_context =
+        fallback_request_state.client_graph_resource_context() != nullptr
+            ? fallback_request_state.client_graph_resource_context()
+            : &context.resource_context();
+    if (auto shared_batch_resource_context =
+            client_graph_resource_context
+                ->GetResource<std::shared_ptr<tfrt::ResourceContext>>(
+                    kSharedBatchResourceContextName)) {
+      return (*shared_batch_resource_context)->get();
+    }
+    return client_graph_resource_context;
   }
 
   static absl::string_view GetBatchFunctionName(
@@ -269,7 +294,9 @@ class MlrtBatchResource : public tensorflow::serving::BatchResourceBase {
 
   string DebugString() const final { return "MlrtBatchResource"; }
 
-  mlrt::bc::Function batch_function() const { return batch_function_; }
+  absl::string_view batch_function_name() const {
+    return batch_function_name_;
+  }
 
  private:
   MlrtBatchResource(mlrt::bc::Function batch_function,
@@ -279,7 +306,7 @@ class MlrtBatchResource : public tensorflow::serving::BatchResourceBase {
       : BatchResourceBase(
             /*has_process_batch_function=*/true, std::move(batcher),
             batcher_queue_options, allowed_batch_sizes),
-        batch_function_(batch_function) {}
+        batch_function_name_(batch_function.name().str()) {}
 
   MlrtBatchResource(mlrt::bc::Function batch_function,
                     std::shared_ptr<AdaptiveBatcherT> batcher,
@@ -288,14 +315,17 @@ class MlrtBatchResource : public tensorflow::serving::BatchResourceBase {
       : BatchResourceBase(
             /*has_process_batch_function=*/true, std::move(batcher),
             batcher_queue_options, allowed_batch_sizes),
-        batch_function_(batch_function) {}
+        batch_function_name_(batch_function.name().str()) {}
 
   void ProcessFuncBatchImpl(
       const BatchTask& last_task, absl::Span<const Tensor> inputs,
       std::vector<Tensor>* combined_outputs,
       std::function<void(const Status&)> done) const override;
 
-  mlrt::bc::Function batch_function_;
+  // The name rather than the function, which belongs to the executable that
+  // created the resource and may be destroyed before the resource is, if the
+  // resource is shared across models.
+  std::string batch_function_name_;
 };
 
 void MlrtBatchResource::ProcessFuncBatchImpl(
@@ -308,10 +338,11 @@ void MlrtBatchResource::ProcessFuncBatchImpl(
     arguments.emplace_back(tfrt_stub::FallbackTensor(input));
   }
 
-  std::vector<mlrt::Value> results(batch_function_.output_regs().size());
-
   const auto& task = down_cast<const MlrtBatchTask&>(last_task);
   DCHECK(task.context);
+  mlrt::bc::Function batch_function = task.caller_function;
+
+  std::vector<mlrt::Value> results(batch_function.output_regs().size());
   mlrt::ExecutionContext& caller_context = *task.caller_context;
 
   auto& caller_tf_context = caller_context.GetUserContext<tf_mlrt::Context>();
@@ -370,7 +401,7 @@ void MlrtBatchResource::ProcessFuncBatchImpl(
   execution_context.set_exit_handler(
       [chain]() mutable { chain.SetStateConcrete(); });
 
-  execution_context.CallByMove(batch_function_, absl::MakeSpan(arguments),
+  execution_context.CallByMove(batch_function, absl::MakeSpan(arguments),
                                absl::MakeSpan(results));
 
   work_queue->AddTask(
@@ -20,6 +20,10 @@ limitations under the License.
 namespace tensorflow {
 namespace tf_mlrt {
 
+// The name of the `tfrt_stub::OpKernelRunnerCache` of the batch ops in the
+// request resource context.
+inline constexpr char kOpKernelRunnerCacheResourceName[] = "MlrtOpKernelCache";
+
 void RegisterTfMlrtBatchKernels(mlrt::KernelRegistry& registry);
 
 }  // namespace tf_mlrt
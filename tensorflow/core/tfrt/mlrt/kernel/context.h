@@ -24,6 +24,14 @@ limitations under the License.
 namespace tensorflow {
 namespace tf_mlrt {
 
+// The name of the `std::shared_ptr<tfrt::ResourceContext>` resource that, if
+// present in a client graph resource context, holds the batch resources of
+// that client graph instead. Graph executors set it to share only the batch
+// queues of identical models; see
+// `GraphExecutionOptions::cross_model_resource_sharing_key`.
+inline constexpr char kSharedBatchResourceContextName[] =
+    "SharedBatchResourceContext";
+
 // The context for tensorflow::OpKernel.
 class Context : public mlrt::UserContext<Context> {
  public:
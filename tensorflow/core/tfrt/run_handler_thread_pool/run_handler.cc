@@ -27,6 +27,8 @@ limitations under the License.
 
 #include "unsupported/Eigen/CXX11/Tensor"  // from @eigen_archive
 #include "tensorflow/core/lib/core/threadpool_interface.h"
+#include "tensorflow/core/lib/monitoring/counter.h"
+#include "tensorflow/core/lib/monitoring/gauge.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/context.h"
 #include "tensorflow/core/platform/denormal.h"
@@ -48,6 +50,18 @@ namespace {
 typedef typename internal::RunHandlerEnvironment::Task Task;
 typedef Eigen::RunQueue<Task, 1024> Queue;
 
+auto* inter_op_threads = tensorflow::monitoring::Gauge<int64_t, 1>::New(
+    "/tensorflow/tfrt/run_handler/inter_op_threads",
+    "The number of threads of the run handler thread pool that currently run "
+    "inter-op work.",
+    "pool_name");
+
+auto* thread_repartitions = tensorflow::monitoring::Counter<2>::New(
+    "/tensorflow/tfrt/run_handler/thread_repartitions",
+    "The number of threads lent between inter-op and intra-op work by the "
+    "adaptive thread partitioning of the run handler thread pool.",
+    "pool_name", "lent_to");
+
 }  // namespace
 
 namespace internal {
@@ -356,6 +370,12 @@ RunHandlerThreadPool::RunHandlerThreadPool(
       blocking_thread_max_waiting_time_(
           options.blocking_threads_max_sleep_time_micro_sec),
       enable_wake_up_(options.enable_wake_up),
+      adaptive_thread_partitioning_(
+          options.enable_adaptive_thread_partitioning),
+      adaptive_partitioning_interval_(
+          options.adaptive_partitioning_interval_micro_sec),
+      num_active_blocking_threads_(options.num_blocking_threads),
+      next_partitioning_time_us_(0),
       thread_data_(num_threads_),
       env_(env, thread_options, name),
       name_(name),
@@ -376,6 +396,7 @@ RunHandlerThreadPool::RunHandlerThreadPool(
   VLOG(1) << "Creating RunHandlerThreadPool " << name << " with  "
           << num_blocking_threads_ << " blocking threads and "
           << num_non_blocking_threads_ << " non-blocking threads.";
+  inter_op_threads->GetCell(name_)->Set(num_blocking_threads_);
 }
 
 RunHandlerThreadPool::~RunHandlerThreadPool() {
@@ -474,6 +495,57 @@ int RunHandlerThreadPool::NumNonBlockingThreads() const {
   return num_non_blocking_threads_;
 }
 
+int RunHandlerThreadPool::NumActiveBlockingThreads() const {
+  return num_active_blocking_threads_.load(std::memory_order_relaxed);
+}
+
+void RunHandlerThreadPool::MaybeRepartitionThreads(
+    const Eigen::MaxSizeVector<ThreadWorkSource*>& thread_work_sources) {
+  if (!adaptive_thread_partitioning_) return;
+  // Only one thread per interval repartitions.
+  const uint64_t now = tensorflow::EnvTime::NowMicros();
+  uint64_t next = next_partitioning_time_us_.load(std::memory_order_relaxed);
+  if (now < next || !next_partitioning_time_us_.compare_exchange_strong(
+                        next, now + adaptive_partitioning_interval_,
+                        std::memory_order_relaxed)) {
+    return;
+  }
+
+  int64_t blocking_queued = 0;
+  int64_t non_blocking_queued = 0;
+  for (int i = 0; i < thread_work_sources.size(); ++i) {
+    blocking_queued += thread_work_sources[i]->TaskQueueSize(true);
+    non_blocking_queued += thread_work_sources[i]->TaskQueueSize(false);
+  }
+
+  // Lends a thread only if the other kind of work has twice as many queued
+  // tasks per thread, so that the partitioning does not flip back and forth.
+  const int num_blocking = NumActiveBlockingThreads();
+  const int num_non_blocking = num_threads_ - num_blocking;
+  int new_num_blocking = num_blocking;
+  if (num_non_blocking > 1 &&
+      blocking_queued * num_non_blocking >
+          2 * non_blocking_queued * num_blocking) {
+    ++new_num_blocking;
+  } else if (num_blocking > 1 &&
+             non_blocking_queued * num_blocking >
+                 2 * blocking_queued * num_non_blocking) {
+    --new_num_blocking;
+  } else {
+    return;
+  }
+  VLOG(2) << "Repartitioning " << name_ << " to " << new_num_blocking
+          << " blocking threads with " << blocking_queued
+          << " queued blocking tasks and " << non_blocking_queued
+          << " queued non-blocking tasks.";
+  num_active_blocking_threads_.store(new_num_blocking,
+                                     std::memory_order_relaxed);
+  inter_op_threads->GetCell(name_)->Set(new_num_blocking);
+  thread_repartitions
+      ->GetCell(name_, new_num_blocking > num_blocking ? "inter" : "intra")
+      ->IncrementBy(1);
+}
+
 RunHandlerThreadPool::ThreadData::ThreadData()
     : new_version(0), current_index(0), current_version(0) {}
 
@@ -543,7 +615,12 @@ void RunHandlerThreadPool::WorkerLoop(int thread_id,
         thread_data_[thread_id].current_thread_work_sources.get();
     sub_thread_pool_id = thread_data_[thread_id].sub_thread_pool_id;
     int active_requests = thread_work_sources->size();
-    if (may_steal_blocking_work) {
+    bool is_blocking_thread = may_steal_blocking_work;
+    if (adaptive_thread_partitioning_) {
+      MaybeRepartitionThreads(*thread_work_sources);
+      is_blocking_thread = thread_id < NumActiveBlockingThreads();
+    }
+    if (is_blocking_thread) {
       // Each thread will first look for tasks from requests that belongs to
       // its sub thread pool.
       int search_range_start =
@@ -598,7 +675,7 @@ void RunHandlerThreadPool::WorkerLoop(int thread_id,
                   << (*thread_work_sources)[i]->ToString();
         }
       }
-      WaitForWorkInSubThreadPool(thread_id, may_steal_blocking_work,
+      WaitForWorkInSubThreadPool(thread_id, is_blocking_thread,
                                  sub_thread_pool_id);
     }
   }
@@ -724,16 +801,8 @@ class RunHandlerPool::Impl {
         waiters_mu_(options.num_sub_thread_pool),
         queue_waiters_(options.num_sub_thread_pool),
         run_handler_thread_pool_(new internal::RunHandlerThreadPool(
-            internal::RunHandlerThreadPool::Options(
-                options.num_inter_op_threads, options.num_intra_op_threads,
-                options.wait_if_no_active_request,
-                options.non_blocking_threads_sleep_time_micro_sec,
-                options.blocking_threads_max_sleep_time_micro_sec,
-                options.use_adaptive_waiting_time, options.enable_wake_up,
-                options.max_concurrent_handler,
-                options.num_threads_in_sub_thread_pool,
-                options.sub_thread_request_percentage),
-            tensorflow::Env::Default(), tensorflow::ThreadOptions(),
+            ThreadPoolOptions(options), tensorflow::Env::Default(),
+            tensorflow::ThreadOptions(),
             "tf_run_handler_pool", &waiters_mu_, &queue_waiters_)),
         iterations_(0),
         version_(0),
@@ -908,6 +977,9 @@ class RunHandlerPool::Impl {
       const Eigen::MaxSizeVector<internal::ThreadWorkSource*>&
           thread_work_sources);
 
+  static internal::RunHandlerThreadPool::Options ThreadPoolOptions(
+      const Options& options);
+
   void LogInfo() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
   // Maximum number of handlers pre-created during pool construction time. The
@@ -940,6 +1012,23 @@ class RunHandlerPool::Impl {
   const std::vector<double> sub_thread_pool_end_request_percentage_;
 };
 
+internal::RunHandlerThreadPool::Options
+RunHandlerPool::Impl::ThreadPoolOptions(const Options& options) {
+  internal::RunHandlerThreadPool::Options thread_pool_options(
+      options.num_inter_op_threads, options.num_intra_op_threads,
+      options.wait_if_no_active_request,
+      options.non_blocking_threads_sleep_time_micro_sec,
+      options.blocking_threads_max_sleep_time_micro_sec,
+      options.use_adaptive_waiting_time, options.enable_wake_up,
+      options.max_concurrent_handler, options.num_threads_in_sub_thread_pool,
+      options.sub_thread_request_percentage);
+  thread_pool_options.enable_adaptive_thread_partitioning =
+      options.enable_adaptive_thread_partitioning;
+  thread_pool_options.adaptive_partitioning_interval_micro_sec =
+      options.adaptive_partitioning_interval_micro_sec;
+  return thread_pool_options;
+}
+
 void RunHandlerPool::Impl::RecomputePoolStats(
     int num_active_requests, uint64_t version,
     const Eigen::MaxSizeVector<internal::ThreadWorkSource*>&
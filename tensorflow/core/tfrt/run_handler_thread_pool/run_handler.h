@@ -108,6 +108,17 @@ class RunHandlerPool {
 
     // If true, threads will be waken up by new tasks.
     bool enable_wake_up = true;
+
+    // If true, the split of the threads between inter-op and intra-op work
+    // follows the demand: every `adaptive_partitioning_interval_micro_sec`,
+    // one thread is lent to the kind of work with more queued tasks per
+    // thread. The total number of threads stays the same, and each kind
+    // keeps at least one thread. The num_inter_op_threads is the initial
+    // split.
+    bool enable_adaptive_thread_partitioning = false;
+
+    // The minimum time between two changes of the thread partitioning.
+    int adaptive_partitioning_interval_micro_sec = 10000;
   };
   explicit RunHandlerPool(Options options);
   ~RunHandlerPool();
@@ -301,6 +312,8 @@ class RunHandlerThreadPool {
     int max_concurrent_handler;
     std::vector<int> num_threads_in_sub_thread_pool;
     std::vector<double> sub_thread_request_percentage;
+    bool enable_adaptive_thread_partitioning = false;
+    int adaptive_partitioning_interval_micro_sec = 10000;
     Options(int num_blocking_threads, int num_non_blocking_threads,
             bool wait_if_no_active_request,
             int non_blocking_threads_sleep_time_micro_sec,
@@ -357,6 +370,16 @@ class RunHandlerThreadPool {
 
   int NumNonBlockingThreads() const;
 
+  // The number of threads that currently run blocking, i.e. inter-op, work.
+  // Without adaptive thread partitioning it is NumBlockingThreads().
+  int NumActiveBlockingThreads() const;
+
+  // With adaptive thread partitioning, lends one thread to the blocking or
+  // non-blocking work of `thread_work_sources`, whichever has more queued
+  // tasks per thread, if the partitioning interval has elapsed.
+  void MaybeRepartitionThreads(
+      const Eigen::MaxSizeVector<ThreadWorkSource*>& thread_work_sources);
+
   void WorkerLoop(int thread_id, bool may_steal_blocking_work);
 
   // Search tasks from Requets range searching_range_start to
@@ -399,6 +422,11 @@ class RunHandlerThreadPool {
   const int non_blocking_thread_sleep_time_;
   const int blocking_thread_max_waiting_time_;
   const bool enable_wake_up_;
+  const bool adaptive_thread_partitioning_;
+  const int adaptive_partitioning_interval_;
+  // The threads with an id below it run blocking work.
+  std::atomic<int> num_active_blocking_threads_;
+  std::atomic<uint64_t> next_partitioning_time_us_;
   Eigen::MaxSizeVector<ThreadData> thread_data_;
   internal::RunHandlerEnvironment env_;
   std::atomic<bool> cancelled_;
@@ -56,6 +56,10 @@ RunHandlerThreadWorkQueue::RunHandlerThreadWorkQueue(const Options& options)
   pool_options.enable_wake_up = options.enable_wake_up;
   pool_options.wait_if_no_active_request = options.wait_if_no_active_request;
   pool_options.use_adaptive_waiting_time = options.use_adaptive_waiting_time;
+  pool_options.enable_adaptive_thread_partitioning =
+      options.enable_adaptive_thread_partitioning;
+  pool_options.adaptive_partitioning_interval_micro_sec =
+      options.adaptive_partitioning_interval_micro_sec;
   handler_pool_ = std::make_unique<RunHandlerPool>(pool_options);
 }
 
@@ -126,7 +130,11 @@ std::ostream& operator<<(std::ostream& strm,
               << options.use_adaptive_waiting_time
               << ", wait_if_no_active_request = "
               << options.wait_if_no_active_request
-              << ", enable_wake_up = " << options.enable_wake_up << "}";
+              << ", enable_wake_up = " << options.enable_wake_up
+              << ", enable_adaptive_thread_partitioning = "
+              << options.enable_adaptive_thread_partitioning
+              << ", adaptive_partitioning_interval_micro_sec = "
+              << options.adaptive_partitioning_interval_micro_sec << "}";
 }
 
 }  // namespace tf
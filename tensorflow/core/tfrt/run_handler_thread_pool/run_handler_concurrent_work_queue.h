@@ -79,6 +79,13 @@ class RunHandlerThreadWorkQueue
 
     // If true, threads will be waken up by new tasks.
     bool enable_wake_up = true;
+
+    // If true, the main and complementary threads are lent to each other
+    // following the demand, see RunHandlerPool::Options.
+    bool enable_adaptive_thread_partitioning = false;
+
+    // The minimum time between two changes of the thread partitioning.
+    int adaptive_partitioning_interval_micro_sec = 10000;
   };
 
   explicit RunHandlerThreadWorkQueue(const Options& options);
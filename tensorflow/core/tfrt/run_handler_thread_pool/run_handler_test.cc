@@ -643,6 +643,65 @@ TEST_P(RunHandlerThreadPoolTest, MultipleSubThreadPool) {
   delete run_handler_thread_pool;
 }
 
+TEST(RunHandlerThreadPoolPartitioningTest, LendsThreadsToQueuedWork) {
+  Eigen::MaxSizeVector<tensorflow::mutex> waiters_mu(1);
+  waiters_mu.resize(1);
+  Eigen::MaxSizeVector<internal::Waiter> waiters(1);
+  waiters.resize(1);
+  internal::RunHandlerThreadPool::Options options(
+      /*num_blocking_threads=*/2, /*num_non_blocking_threads=*/2,
+      /*wait_if_no_active_request=*/true,
+      /*non_blocking_threads_sleep_time_micro_sec=*/250,
+      /*blocking_threads_max_sleep_time_micro_sec=*/250,
+      /*use_adaptive_waiting_time=*/true, /*enable_wake_up=*/true,
+      /*max_concurrent_handler=*/128,
+      /*num_threads_in_sub_thread_pool=*/{2},
+      /*sub_thread_request_percentage=*/{1});
+  options.enable_adaptive_thread_partitioning = true;
+  options.adaptive_partitioning_interval_micro_sec = 0;
+  // The threads are not started, so that the queued tasks stay queued.
+  internal::RunHandlerThreadPool run_handler_thread_pool(
+      options, tensorflow::Env::Default(), tensorflow::ThreadOptions(),
+      "tf_run_handler_pool", &waiters_mu, &waiters);
+  internal::ThreadWorkSource tws;
+  tws.SetWaiter(1, &waiters[0], &waiters_mu[0]);
+  Eigen::MaxSizeVector<internal::ThreadWorkSource*> thread_work_sources(1);
+  thread_work_sources.push_back(&tws);
+  std::function<void()> fn = [] {};
+
+  EXPECT_EQ(run_handler_thread_pool.NumActiveBlockingThreads(), 2);
+  run_handler_thread_pool.MaybeRepartitionThreads(thread_work_sources);
+  EXPECT_EQ(run_handler_thread_pool.NumActiveBlockingThreads(), 2);
+
+  // Inter-op work borrows the intra-op threads, but leaves one of them.
+  for (int i = 0; i < 4; ++i) {
+    run_handler_thread_pool.AddWorkToQueue(&tws, /*is_blocking=*/true,
+                                           TaskFunction(fn));
+  }
+  run_handler_thread_pool.MaybeRepartitionThreads(thread_work_sources);
+  EXPECT_EQ(run_handler_thread_pool.NumActiveBlockingThreads(), 3);
+  run_handler_thread_pool.MaybeRepartitionThreads(thread_work_sources);
+  EXPECT_EQ(run_handler_thread_pool.NumActiveBlockingThreads(), 3);
+  for (int i = 0; i < 4; ++i) {
+    tws.PopBlockingTask();
+  }
+
+  // And the other way around.
+  for (int i = 0; i < 4; ++i) {
+    run_handler_thread_pool.AddWorkToQueue(&tws, /*is_blocking=*/false,
+                                           TaskFunction(fn));
+  }
+  run_handler_thread_pool.MaybeRepartitionThreads(thread_work_sources);
+  EXPECT_EQ(run_handler_thread_pool.NumActiveBlockingThreads(), 2);
+  run_handler_thread_pool.MaybeRepartitionThreads(thread_work_sources);
+  EXPECT_EQ(run_handler_thread_pool.NumActiveBlockingThreads(), 1);
+  run_handler_thread_pool.MaybeRepartitionThreads(thread_work_sources);
+  EXPECT_EQ(run_handler_thread_pool.NumActiveBlockingThreads(), 1);
+  for (int i = 0; i < 4; ++i) {
+    tws.PopNonBlockingTask(0, true);
+  }
+}
+
 INSTANTIATE_TEST_SUITE_P(Parameter, RunHandlerThreadPoolTest,
                          testing::Combine(::testing::Bool(),
                                           ::testing::Bool()));
@@ -18,6 +18,7 @@ limitations under the License.
 #include <cstddef>
 #include <functional>
 #include <iterator>
+#include <list>
 #include <memory>
 #include <optional>
 #include <string>
@@ -39,6 +40,7 @@ limitations under the License.
 #include "mlir/IR/DialectRegistry.h"  // from @llvm-project
 #include "mlir/IR/MLIRContext.h"  // from @llvm-project
 #include "mlir/IR/OwningOpRef.h"  // from @llvm-project
+#include "tensorflow/cc/saved_model/fingerprinting.h"
 #include "tensorflow/compiler/jit/flags.h"
 #include "tensorflow/compiler/mlir/tensorflow/translate/import_model.h"
 #include "tensorflow/compiler/mlir/tensorflow/translate/mlir_roundtrip_flags.h"
@@ -104,6 +106,12 @@ auto* lazy_loading_count = monitoring::Counter<3>::New(
     "/tensorflow/tfrt/lazy_loading_count", "The total number of lazy loadings.",
     "model_name", "model_version", "use_graph_executor");
 
+auto* lazy_unloading_count = monitoring::Counter<2>::New(
+    "/tensorflow/tfrt/lazy_unloading_count",
+    "The total number of lazily loaded signatures unloaded for being the least "
+    "recently used.",
+    "model_name", "model_version");
+
 auto* use_ifrt_count = monitoring::Counter<3>::New(
     "/tensorflow/tfrt/use_ifrt", "The total number of instances that use IFRT.",
     "model_name", "model_version", "use_ifrt");
@@ -510,6 +518,26 @@ absl::StatusOr<std::unique_ptr<SavedModel>> SavedModelImpl::LoadSavedModel(
         saved_model_dir;
   }
 
+  if (options.enable_cross_model_batching) {
+    // Models with the same fingerprint run the same computations on the same
+    // weights, so their batch ops can batch each other's requests.
+    auto singleprint =
+        saved_model::fingerprinting::Singleprint(saved_model_dir);
+    if (!options.graph_execution_options.enable_mlrt) {
+      LOG(WARNING) << "Cross-model batching requires MLRT, disabling it for "
+                   << saved_model_dir;
+    } else if (!singleprint.ok()) {
+      LOG(WARNING) << "Cross-model batching requires a fingerprint, disabling "
+                   << "it for " << saved_model_dir << ": "
+                   << singleprint.status();
+    } else {
+      options.graph_execution_options.cross_model_resource_sharing_key =
+          absl::StrCat(*singleprint, "/",
+                       absl::StrJoin(meta_graph_def.meta_info_def().tags(),
+                                     ","));
+    }
+  }
+
   // Register TFRT dialects
   mlir::DialectRegistry registry;
   if (aot_exist) {
@@ -773,14 +801,29 @@ absl::StatusOr<std::unique_ptr<SavedModel>> SavedModelImpl::LoadSavedModel(
         ->IncrementBy(1);
   }
 
+  const bool preload_signatures = options.enable_lazy_loading &&
+                                  !options.lazy_loading_use_graph_executor;
+  const std::vector<std::string> preload_signature_names =
+      options.lazy_loading_preload_signatures;
+
   // Finally, create the saved model.
-  return {std::make_unique<SavedModelImpl>(
+  auto saved_model = std::make_unique<SavedModelImpl>(
       std::move(options), std::move(symbol_uids), std::move(meta_graph_def),
       std::move(bef), std::move(bef_file), std::move(bytecode),
       std::move(loaded_executable),
       std::move(initializers_and_signatures.signature_map),
       std::move(runner_table), std::move(resource_array),
-      std::move(graph_executor))};
+      std::move(graph_executor));
+
+  if (preload_signatures) {
+    for (const std::string& name : preload_signature_names) {
+      TF_RETURN_IF_ERROR(
+          saved_model->GetOrCreateLoadingResult(/*run_options=*/{}, {name})
+              .status());
+    }
+  }
+
+  return {std::move(saved_model)};
 }
 
 SavedModelImpl::SavedModelImpl(
@@ -876,6 +919,8 @@ tensorflow::Status SavedModelImpl::Run(
   OpKernelRunnerTable* runner_table = nullptr;
   tfd::FallbackResourceArray* resource_array = nullptr;
   tfrt::ResourceContext* client_graph_resource_context = nullptr;
+  // Keeps the lazily loaded signature alive while it runs.
+  std::shared_ptr<const LoadingResult> loading_result;
   if (options_.enable_lazy_loading) {
     // TODO(b/216379787): Remove this lazy loading path once b/279197040 is
     // unblocked.
@@ -887,16 +932,16 @@ tensorflow::Status SavedModelImpl::Run(
     // If lazy loading is enabled, no signature is loaded into `bef_file_`, so
     // we need to find the BEF from the cache or create one.
     TF_ASSIGN_OR_RETURN(
-        const LoadingResult& loading_result,
+        loading_result,
         GetOrCreateLoadingResult(run_options, {std::string(name)}));
-    symbol_uids = &loading_result.symbol_uids;
-    loaded_executable = loading_result.bytecode_executable.get();
+    symbol_uids = &loading_result->symbol_uids;
+    loaded_executable = loading_result->bytecode_executable.get();
     if (loaded_executable == nullptr) {
-      func = loading_result.bef_file->GetFunction(loading_result.name);
+      func = loading_result->bef_file->GetFunction(loading_result->name);
     }
-    runner_table = loading_result.runner_table.get();
-    resource_array = loading_result.resource_array.get();
-    client_graph_resource_context = loading_result.resource_context.get();
+    runner_table = loading_result->runner_table.get();
+    resource_array = loading_result->resource_array.get();
+    client_graph_resource_context = loading_result->resource_context.get();
   } else {
     symbol_uids = &symbol_uids_;
     if (loaded_executable_) {
@@ -1119,7 +1164,7 @@ absl::StatusOr<JoinedSignature> JoinSignatures(
 }  // namespace
 
 // TODO(b/216379787): Reuse `GraphExecutor::LoadClientGraph()`.
-absl::StatusOr<std::reference_wrapper<const SavedModelImpl::LoadingResult>>
+absl::StatusOr<std::unique_ptr<SavedModelImpl::LoadingResult>>
 SavedModelImpl::LoadJoinedSignature(const JoinedSignature& joined_signature) {
   // Step 1: Import the combined subgraph from proto to an MLIR module.
   mlir::DialectRegistry registry;
@@ -1184,26 +1229,45 @@ SavedModelImpl::LoadJoinedSignature(const JoinedSignature& joined_signature) {
   }
   symbol_uids.tfrt_symbol_uid = MaybeUploadMlirToXsymbol(module.get());
   loading_result->symbol_uids = std::move(symbol_uids);
-
-  // Store loading_result in cache.
-  const auto* loading_result_ptr = loading_result.get();
-  loading_result_cache_[joined_signature.name] = std::move(loading_result);
-  return {*loading_result_ptr};
+  return loading_result;
 }
 
-absl::StatusOr<std::reference_wrapper<const SavedModelImpl::LoadingResult>>
+absl::StatusOr<std::shared_ptr<const SavedModelImpl::LoadingResult>>
 SavedModelImpl::GetOrCreateLoadingResult(const RunOptions& run_options,
                                          absl::Span<const std::string> names) {
   const auto joined_name = absl::StrJoin(names, kSignatureJoiningDelimiter);
-  tensorflow::mutex_lock l(loading_result_cache_mu_);
-  const auto iter = loading_result_cache_.find(joined_name);
-  if (iter != loading_result_cache_.end()) return {*iter->second};
-
-  if (run_options.disable_compilation) {
-    return tensorflow::errors::InvalidArgument(
-        absl::StrCat("GraphExecutor: compilation is disabled in execution but "
-                     "the compiled graph is not found for ",
-                     joined_name));
+  std::shared_ptr<LoadingResultCacheEntry> entry;
+  {
+    tensorflow::mutex_lock l(loading_result_cache_mu_);
+    const auto iter = loading_result_cache_.find(joined_name);
+    if (iter != loading_result_cache_.end() &&
+        iter->second->loading_result != nullptr) {
+      // Mark it as the most recently used.
+      loaded_lru_.splice(loaded_lru_.begin(), loaded_lru_,
+                         iter->second->lru_position);
+      return iter->second->loading_result;
+    }
+
+    if (run_options.disable_compilation) {
+      return tensorflow::errors::InvalidArgument(absl::StrCat(
+          "GraphExecutor: compilation is disabled in execution but "
+          "the compiled graph is not found for ",
+          joined_name));
+    }
+
+    if (iter != loading_result_cache_.end()) {
+      entry = iter->second;
+    } else {
+      entry = std::make_shared<LoadingResultCacheEntry>();
+      loading_result_cache_[joined_name] = entry;
+    }
+  }
+
+  tensorflow::mutex_lock loading_lock(entry->loading_mu);
+  {
+    // Another invocation may have loaded it in the meantime.
+    tensorflow::mutex_lock l(loading_result_cache_mu_);
+    if (entry->loading_result != nullptr) return entry->loading_result;
   }
 
   TF_ASSIGN_OR_RETURN(
@@ -1217,7 +1281,31 @@ SavedModelImpl::GetOrCreateLoadingResult(const RunOptions& run_options,
               << absl::ToInt64Milliseconds(absl::Now() - start_time) << " ms.";
   });
 
-  return LoadJoinedSignature(joined_signature);
+  TF_ASSIGN_OR_RETURN(std::shared_ptr<const LoadingResult> loading_result,
+                      LoadJoinedSignature(joined_signature));
+
+  tensorflow::mutex_lock l(loading_result_cache_mu_);
+  entry->loading_result = loading_result;
+  loaded_lru_.push_front(joined_name);
+  entry->lru_position = loaded_lru_.begin();
+  UnloadColdLoadingResults();
+  return loading_result;
+}
+
+void SavedModelImpl::UnloadColdLoadingResults() {
+  const int max_loaded = options_.lazy_loading_max_loaded_signatures;
+  if (max_loaded <= 0) return;
+  const tensorflow::SessionMetadata& model_metadata =
+      options_.graph_execution_options.model_metadata;
+  while (loaded_lru_.size() > static_cast<size_t>(max_loaded)) {
+    LOG(INFO) << "TFRT unloading joined signature " << loaded_lru_.back()
+              << " as the least recently used.";
+    loading_result_cache_.erase(loaded_lru_.back());
+    loaded_lru_.pop_back();
+    lazy_unloading_count
+        ->GetCell(model_metadata.name(), absl::StrCat(model_metadata.version()))
+        ->IncrementBy(1);
+  }
 }
 
 }  // namespace tfrt_stub
@@ -18,6 +18,7 @@ limitations under the License.
 #include <cstdint>
 #include <functional>
 #include <limits>
+#include <list>
 #include <memory>
 #include <optional>
 #include <string>
@@ -30,6 +31,7 @@ limitations under the License.
 #include "absl/types/span.h"
 #include "tensorflow/core/framework/graph.pb.h"
 #include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/thread_annotations.h"
 #include "tensorflow/core/protobuf/config.pb.h"
 #include "tensorflow/core/protobuf/meta_graph.pb.h"
@@ -107,9 +109,27 @@ class SavedModel {
     // TODO(b/216379787): Remove this option once b/279197040 is unblocked.
     bool lazy_loading_use_graph_executor = false;
 
+    // With lazy loading, the signatures to load along with the saved model,
+    // e.g. the few that get most of the traffic. Ignored if
+    // `lazy_loading_use_graph_executor` is true.
+    std::vector<std::string> lazy_loading_preload_signatures;
+
+    // With lazy loading, if positive, the maximum number of signatures (or
+    // signature combinations) kept loaded. Beyond it, the least recently used
+    // one is unloaded, and loaded again on its next invocation. Ignored if
+    // `lazy_loading_use_graph_executor` is true.
+    int lazy_loading_max_loaded_signatures = 0;
+
     // True if and only if SavedModel is being loaded to generate AOT results.
     bool aot_generation = false;
 
+    // If true, the batch ops of the models loaded with the same SavedModel
+    // fingerprint and tags share their batch queues, so that a model loaded
+    // several times, e.g. under different names, still forms full batches.
+    // Requires MLRT and a `fingerprint.pb` in the SavedModel; otherwise it is
+    // ignored with a warning. This option is experimental.
+    bool enable_cross_model_batching = false;
+
     GraphExecutionOptions graph_execution_options;
   };
 
@@ -281,6 +301,17 @@ class SavedModelImpl final : public SavedModel {
     std::unique_ptr<tfrt::ResourceContext> resource_context;
   };
 
+  struct LoadingResultCacheEntry {
+    // Held while loading, so that concurrent invocations of a signature load
+    // it only once without blocking the loading of other signatures.
+    tensorflow::mutex loading_mu;
+    // The fields below are guarded by `loading_result_cache_mu_`. The loading
+    // result is shared with the running invocations, so that unloading it
+    // does not affect them.
+    std::shared_ptr<const LoadingResult> loading_result;
+    std::list<std::string>::iterator lru_position;
+  };
+
   // Imports a subgraph as an MLIR module with the specified `input_nodes`,
   // `output_nodes`.
   absl::StatusOr<mlir::OwningOpRef<mlir::ModuleOp>> ImportSubgraph(
@@ -290,16 +321,21 @@ class SavedModelImpl final : public SavedModel {
       const std::vector<std::string>& target_nodes);
 
   // Given the joined signature, loads the subgraph and returns loading result.
-  absl::StatusOr<std::reference_wrapper<const SavedModelImpl::LoadingResult>>
+  absl::StatusOr<std::unique_ptr<SavedModelImpl::LoadingResult>>
   LoadJoinedSignature(const JoinedSignature& joined_signature)
-      TF_EXCLUSIVE_LOCKS_REQUIRED(loading_result_cache_mu_);
+      TF_LOCKS_EXCLUDED(loading_result_cache_mu_);
 
   // Returns the loading result given the signature names.
-  absl::StatusOr<std::reference_wrapper<const SavedModelImpl::LoadingResult>>
+  absl::StatusOr<std::shared_ptr<const SavedModelImpl::LoadingResult>>
   GetOrCreateLoadingResult(const RunOptions& run_options,
                            absl::Span<const std::string> names)
       TF_LOCKS_EXCLUDED(loading_result_cache_mu_);
 
+  // Unloads the least recently used loading results beyond
+  // `lazy_loading_max_loaded_signatures`.
+  void UnloadColdLoadingResults()
+      TF_EXCLUSIVE_LOCKS_REQUIRED(loading_result_cache_mu_);
+
   SymbolUids symbol_uids_;
   // `meta_graph_def_` only contains metadata of the model. The graph_def field
   // is removed.
@@ -319,11 +355,12 @@ class SavedModelImpl final : public SavedModel {
   std::unique_ptr<OpKernelRunnerTable> runner_table_;
   std::unique_ptr<tfd::FallbackResourceArray> resource_array_;
   tensorflow::mutex loading_result_cache_mu_;
-  // For pointer stability of values in `absl::flat_hash_map<>`, additional
-  // `std::unique_ptr<>` is necessary. (See https://abseil.io/tips/136.)
+  // The entries are shared with the invocations waiting for them to be loaded.
   absl::flat_hash_map<std::string /*joined_name*/,
-                      std::unique_ptr<LoadingResult>>
+                      std::shared_ptr<LoadingResultCacheEntry>>
       loading_result_cache_ TF_GUARDED_BY(loading_result_cache_mu_);
+  // The joined names of the loaded results, most recently used first.
+  std::list<std::string> loaded_lru_ TF_GUARDED_BY(loading_result_cache_mu_);
 };
 
 class SavedModelMiraImpl;
@@ -1071,6 +1071,53 @@ TEST(SavedModelTest, DisableCompilation) {
   TF_ASSERT_OK((*saved_model)->Run(run_options, "toy", inputs, &outputs));
 }
 
+TEST(SavedModelTest, LazyLoadingPreloadAndUnload) {
+  std::string saved_model_dir = tensorflow::GetDataDependencyFilepath(
+      "tensorflow/core/tfrt/saved_model/tests/toy_v1/1");
+
+  auto runtime = DefaultTfrtRuntime(/*num_threads=*/1);
+  auto options = DefaultSavedModelOptions(runtime.get());
+  options.enable_lazy_loading = true;
+  options.lazy_loading_preload_signatures = {"toy"};
+  options.lazy_loading_max_loaded_signatures = 1;
+
+  TF_ASSERT_OK_AND_ASSIGN(
+      auto saved_model, SavedModelImpl::LoadSavedModel(options, saved_model_dir,
+                                                       /*tags=*/{"serve"}));
+
+  // Set input 'x' to [[1, 1, 1]]
+  std::vector<tensorflow::Tensor> inputs;
+  inputs.push_back(
+      CreateTfTensor<int32_t>(/*shape=*/{1, 3}, /*data=*/{1, 1, 1}));
+  std::vector<tensorflow::Tensor> outputs;
+
+  // The preloaded signature runs without compilation.
+  tfrt::SavedModel::RunOptions run_options;
+  run_options.disable_compilation = true;
+  TF_ASSERT_OK(saved_model->Run(run_options, "toy", inputs, &outputs));
+  ASSERT_EQ(outputs.size(), 1);
+  EXPECT_THAT(GetTfTensorData<int32_t>(outputs[0]),
+              ::testing::ElementsAreArray({6}));
+  EXPECT_FALSE(
+      saved_model->Run(run_options, "another_toy", inputs, &outputs).ok());
+
+  // Loading another signature unloads it.
+  run_options.disable_compilation = false;
+  TF_ASSERT_OK(saved_model->Run(run_options, "another_toy", inputs, &outputs));
+  run_options.disable_compilation = true;
+  auto status = saved_model->Run(run_options, "toy", inputs, &outputs);
+  EXPECT_THAT(
+      status.message(),
+      ::testing::HasSubstr("GraphExecutor: compilation is disabled in "
+                           "execution but the compiled graph is not found"));
+
+  run_options.disable_compilation = false;
+  TF_ASSERT_OK(saved_model->Run(run_options, "toy", inputs, &outputs));
+  ASSERT_EQ(outputs.size(), 1);
+  EXPECT_THAT(GetTfTensorData<int32_t>(outputs[0]),
+              ::testing::ElementsAreArray({6}));
+}
+
 TEST(SavedModelTest, CustomModelConfig) {
   // SavedModel toy contains a graph of a single 'tf.AddV2' op. It is generated
   // using the following python code:
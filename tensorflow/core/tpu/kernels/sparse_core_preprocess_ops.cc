@@ -37,6 +37,7 @@ limitations under the License.
 #include "xla/stream_executor/tpu/tpu_api.h"
 #include "xla/stream_executor/tpu/tpu_ops_c_api.h"
 #include "xla/util.h"
+#include "tensorflow/core/framework/device_base.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/op_requires.h"
 #include "tensorflow/core/framework/tensor.h"
@@ -47,6 +48,7 @@ limitations under the License.
 #include "tensorflow/core/platform/tstring.h"
 #include "tensorflow/core/tpu/kernels/sparse_core_ops_stats_handler.h"
 #include "tensorflow/core/tpu/kernels/sparse_core_ops_utils.h"
+#include "tensorflow/core/util/work_sharder.h"
 #include "tsl/profiler/lib/traceme.h"
 
 namespace tensorflow {
@@ -205,6 +207,10 @@ absl::Status ConcatInputFeatureFromSameTable(
   return absl::OkStatus();
 }
 
+// Sorts and dedups the ids of each feature group and counts the ids and the
+// unique ids per physical replica. The feature groups are independent, so
+// they are sharded over the worker threads with a counter per group, which
+// are summed at the end.
 absl::Status SortDedupAndCountStatsOfCooTensor(
     std::vector<std::unique_ptr<int32_t[]>>* updated_row_ids,
     std::vector<std::unique_ptr<int32_t[]>>* updated_col_ids,
@@ -215,64 +221,96 @@ absl::Status SortDedupAndCountStatsOfCooTensor(
     std::vector<std::unique_ptr<uint64_t[]>>* col_ids_index_list,
     std::vector<int32_t>* total_id_counter,
     std::vector<int32_t>* total_unique_id_counter,
-    int32_t num_physical_replica_mod, int32_t num_input_feature_group) {
-  for (int feature_group_id = 0; feature_group_id < num_input_feature_group;
-       ++feature_group_id) {
-    int32_t total_id_count = (*total_id_counts)[feature_group_id];
-    (*dedup_ids_index_mapping)[feature_group_id] =
-        std::unique_ptr<uint32_t[]>(new uint32_t[total_id_count]);
-
-    (*gains_after_dedup)[feature_group_id] =
-        std::unique_ptr<float[]>(new float[total_id_count]);
-
-    uint32_t* per_feature_dedup_ids_index_mapping =
-        (*dedup_ids_index_mapping)[feature_group_id].get();
-
-    float* per_feature_gains_after_dedup =
-        (*gains_after_dedup)[feature_group_id].get();
-    const int32_t* row_ids_ptr = (*updated_row_ids)[feature_group_id].get();
-    const int32_t* col_ids_ptr = (*updated_col_ids)[feature_group_id].get();
-    const float* gains_ptr = (*updated_gains)[feature_group_id].get();
-    (*col_ids_index_list)[feature_group_id] =
-        std::make_unique<uint64_t[]>(total_id_count);
-    uint64_t* per_feature_col_ids_index_list =
-        (*col_ids_index_list)[feature_group_id].get();
-    for (int32_t index = 0; index < total_id_count; ++index) {
-      per_feature_col_ids_index_list[index] =
-          (static_cast<uint64_t>(*(col_ids_ptr + index)) << 32) + index;
+    int32_t num_physical_replica_mod, int32_t num_input_feature_group,
+    const DeviceBase::CpuWorkerThreads& worker_threads) {
+  tsl::profiler::TraceMe traceme("SortDedupAndCountStatsOfCooTensor");
+  const int num_physical_replica = total_id_counter->size();
+  std::vector<std::vector<int32_t>> id_counters(
+      num_input_feature_group, std::vector<int32_t>(num_physical_replica));
+  std::vector<std::vector<int32_t>> unique_id_counters(
+      num_input_feature_group, std::vector<int32_t>(num_physical_replica));
+
+  auto sort_and_dedup = [&](int64_t begin, int64_t end) {
+    for (int feature_group_id = begin; feature_group_id < end;
+         ++feature_group_id) {
+      int32_t total_id_count = (*total_id_counts)[feature_group_id];
+      (*dedup_ids_index_mapping)[feature_group_id] =
+          std::unique_ptr<uint32_t[]>(new uint32_t[total_id_count]);
+
+      (*gains_after_dedup)[feature_group_id] =
+          std::unique_ptr<float[]>(new float[total_id_count]);
+
+      uint32_t* per_feature_dedup_ids_index_mapping =
+          (*dedup_ids_index_mapping)[feature_group_id].get();
+
+      float* per_feature_gains_after_dedup =
+          (*gains_after_dedup)[feature_group_id].get();
+      const int32_t* row_ids_ptr = (*updated_row_ids)[feature_group_id].get();
+      const int32_t* col_ids_ptr = (*updated_col_ids)[feature_group_id].get();
+      const float* gains_ptr = (*updated_gains)[feature_group_id].get();
+      (*col_ids_index_list)[feature_group_id] =
+          std::make_unique<uint64_t[]>(total_id_count);
+      uint64_t* per_feature_col_ids_index_list =
+          (*col_ids_index_list)[feature_group_id].get();
+      for (int32_t index = 0; index < total_id_count; ++index) {
+        per_feature_col_ids_index_list[index] =
+            (static_cast<uint64_t>(*(col_ids_ptr + index)) << 32) + index;
+      }
+      hwy::VQSort(per_feature_col_ids_index_list, total_id_count,
+                  hwy::SortAscending());
+
+      std::vector<int32_t>& id_counter = id_counters[feature_group_id];
+      std::vector<int32_t>& unique_id_counter =
+          unique_id_counters[feature_group_id];
+      // Loop through the col ids to count the ids and unique ids.
+      int32_t previous_col_id = -1;
+      int32_t previous_row_id = -1;
+      uint32_t previous_id_array_index = 0;
+      for (int32_t index = 0; index < total_id_count; ++index) {
+        uint64_t item = per_feature_col_ids_index_list[index];
+        int32 col_id = item >> 32;
+        uint32_t id_array_index = item & 0xffffffff;
+        int32_t row_id = *(row_ids_ptr + id_array_index);
+        // If the row ids and col ids are both same as the previous one,
+        // dedup the id by adding the gains.
+        if (row_id != previous_row_id || col_id != previous_col_id) {
+          per_feature_dedup_ids_index_mapping[id_array_index] = id_array_index;
+          per_feature_gains_after_dedup[id_array_index] =
+              *(gains_ptr + id_array_index);
+          uint32_t replica_id = col_id & num_physical_replica_mod;
+          id_counter[replica_id]++;
+          if (col_id != previous_col_id) unique_id_counter[replica_id]++;
+        } else {
+          // Dedup the id if both row id and col id is the same.
+          uint32_t parent_idx =
+              per_feature_dedup_ids_index_mapping[previous_id_array_index];
+          per_feature_dedup_ids_index_mapping[id_array_index] = parent_idx;
+          per_feature_gains_after_dedup[parent_idx] +=
+              *(gains_ptr + id_array_index);
+        }
+        previous_id_array_index = id_array_index;
+        previous_col_id = col_id;
+        previous_row_id = row_id;
+      }
     }
-    hwy::VQSort(per_feature_col_ids_index_list, total_id_count,
-                hwy::SortAscending());
+  };
+  const int64_t total_id_count =
+      absl::c_accumulate(*total_id_counts, int64_t{0});
+  // The sort dominates the cost of a feature group.
+  const int64_t cost_per_feature_group =
+      num_input_feature_group > 0
+          ? 50 * total_id_count / num_input_feature_group
+          : 0;
+  Shard(worker_threads.num_threads, worker_threads.workers,
+        num_input_feature_group, cost_per_feature_group, sort_and_dedup);
 
-    // Loop through the col ids to count the ids and unique ids.
-    int32_t previous_col_id = -1;
-    int32_t previous_row_id = -1;
-    uint32_t previous_id_array_index = 0;
-    for (int32_t index = 0; index < total_id_count; ++index) {
-      uint64_t item = per_feature_col_ids_index_list[index];
-      int32 col_id = item >> 32;
-      uint32_t id_array_index = item & 0xffffffff;
-      int32_t row_id = *(row_ids_ptr + id_array_index);
-      // If the row ids and col ids are both same as the previous one,
-      // dedup the id by adding the gains.
-      if (row_id != previous_row_id || col_id != previous_col_id) {
-        per_feature_dedup_ids_index_mapping[id_array_index] = id_array_index;
-        per_feature_gains_after_dedup[id_array_index] =
-            *(gains_ptr + id_array_index);
-        uint32_t replica_id = col_id & num_physical_replica_mod;
-        (*total_id_counter)[replica_id]++;
-        if (col_id != previous_col_id) (*total_unique_id_counter)[replica_id]++;
-      } else {
-        // Dedup the id if both row id and col id is the same.
-        uint32_t parent_idx =
-            per_feature_dedup_ids_index_mapping[previous_id_array_index];
-        per_feature_dedup_ids_index_mapping[id_array_index] = parent_idx;
-        per_feature_gains_after_dedup[parent_idx] +=
-            *(gains_ptr + id_array_index);
-      }
-      previous_id_array_index = id_array_index;
-      previous_col_id = col_id;
-      previous_row_id = row_id;
+  for (int feature_group_id = 0; feature_group_id < num_input_feature_group;
+       ++feature_group_id) {
+    for (int replica_id = 0; replica_id < num_physical_replica; ++replica_id) {
+      (*total_id_counter)[replica_id] +=
+          id_counters[feature_group_id][replica_id];
+      (*total_unique_id_counter)[replica_id] +=
+          unique_id_counters[feature_group_id][replica_id];
     }
   }
   return absl::OkStatus();
@@ -1454,7 +1492,8 @@ void SortListOfSparseCoreCooTensorsOp::Compute(OpKernelContext* ctx) {
                &updated_row_ids, &updated_col_ids, &updated_gains,
                &total_id_counts, &dedup_ids_index_mapping, &gains_after_dedup,
                &col_ids_index_list, &total_id_counter, &total_unique_id_counter,
-               num_physical_replica_mod, num_input_feature_group));
+               num_physical_replica_mod, num_input_feature_group,
+               *ctx->device()->tensorflow_cpu_worker_threads()));
 
   for (int replica_id = 0; replica_id < num_physical_replica_; ++replica_id) {
     // If the one of the replica (unique) id count is larger than the max
@@ -1873,7 +1912,8 @@ void GetStatsFromListOfSparseCoreCooTensorsOp::Compute(OpKernelContext* ctx) {
                &updated_row_ids, &updated_col_ids, &updated_gains,
                &total_id_counts, &dedup_ids_index_mapping, &gains_after_dedup,
                &col_ids_index_list, &total_id_counter, &total_unique_id_counter,
-               num_physical_replica_mod, num_input_feature_group));
+               num_physical_replica_mod, num_input_feature_group,
+               *ctx->device()->tensorflow_cpu_worker_threads()));
 
   int32_t max_ids_per_sparse_core = *absl::c_max_element(total_id_counter);
   int32_t max_unique_ids_per_sparse_core =
@@ -0,0 +1,156 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/tpu/kernels/tpu_compilation_cache_file_store.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/cleanup/cleanup.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "xla/stream_executor/tpu/proto_helper.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/fingerprint.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/public/version.h"
+#if defined(LIBTPU_ON_GCE)
+#include "tensorflow/core/tpu/kernels/tpu_compilation_cache.pb.h"
+#endif
+
+namespace tensorflow {
+namespace tpu {
+
+TpuCompilationCacheFileStore::TpuCompilationCacheFileStore(
+    std::string cache_location, bool read_only)
+    : cache_location_(std::move(cache_location)), read_only_(read_only) {}
+
+std::string TpuCompilationCacheFileStore::EntryKey(
+    const TpuCompilationCacheKey& subgraph_key) {
+  // The prefix covers the computation, its shapes and the topology. The
+  // session handle is left out so that the key is stable across the jobs.
+  std::string key = absl::StrCat(TF_VERSION_STRING, "|", subgraph_key.prefix);
+  if (subgraph_key.has_guaranteed_const) {
+    absl::StrAppend(&key, "|", subgraph_key.guaranteed_const_fingerprint());
+  }
+  return key;
+}
+
+std::string TpuCompilationCacheFileStore::GetFilePath(
+    const std::string& key) const {
+  return io::JoinPath(
+      cache_location_,
+      absl::StrCat(absl::Hex(Fingerprint64(key), absl::kZeroPad16),
+                   ".tpu_programs"));
+}
+
+#if defined(LIBTPU_ON_GCE)
+absl::Status TpuCompilationCacheFileStore::Lookup(
+    const std::string& key, TpuProgramGroup* tpu_program_group) const {
+  Env* env = Env::Default();
+  const std::string file_path = GetFilePath(key);
+  TF_RETURN_IF_ERROR(env->FileExists(file_path));
+  TpuPersistentCacheEntryExternal entry;
+  TF_RETURN_IF_ERROR(ReadBinaryProto(env, file_path, &entry));
+  if (entry.key() != key) {
+    return absl::NotFoundError(
+        absl::StrCat("The entry at ", file_path, " has another key."));
+  }
+  if (entry.programs_size() == 0) {
+    return absl::DataLossError(
+        absl::StrCat("The entry at ", file_path, " has no programs."));
+  }
+
+  std::vector<TpuSerializedProto> programs;
+  auto cleanup = absl::MakeCleanup([&programs]() {
+    for (TpuSerializedProto& program : programs) {
+      stream_executor::tpu::SerializedProto_Free(program);
+    }
+  });
+  for (const GetTpuProgramResponseExternal& program : entry.programs()) {
+    programs.push_back(stream_executor::tpu::SerializeProto(program));
+  }
+  return tpu_program_group->DeserializeFromRpcResponseProtos(programs);
+}
+
+absl::Status TpuCompilationCacheFileStore::Insert(
+    const std::string& key, const TpuProgramGroup& tpu_program_group) const {
+  if (read_only_) return absl::OkStatus();
+
+  TpuPersistentCacheEntryExternal entry;
+  entry.set_key(key);
+  for (int i = 0; i < tpu_program_group.program_count(); ++i) {
+    GetTpuProgramResponseExternal* program = entry.add_programs();
+
+    TpuExecutableSerializedProto executable;
+    auto cleanup_executable = absl::MakeCleanup([&executable]() {
+      if (executable.size > 0) {
+        stream_executor::tpu::SerializedProto_Free(executable);
+      }
+    });
+    TF_RETURN_IF_ERROR(tpu_program_group.SerializeExecutable(i, &executable));
+    if (!program->mutable_proto()->ParseFromArray(executable.bytes,
+                                                  executable.size)) {
+      return absl::InternalError("Failed to serialize TPU program.");
+    }
+
+    CompilerMetadataSerializedProto compiler_metadata;
+    auto cleanup_compiler_metadata = absl::MakeCleanup([&compiler_metadata]() {
+      if (compiler_metadata.size > 0) {
+        stream_executor::tpu::SerializedProto_Free(compiler_metadata);
+      }
+    });
+    TF_RETURN_IF_ERROR(
+        tpu_program_group.SerializeCompilerMetadata(i, &compiler_metadata));
+    if (!program->mutable_compiler_metadata()->ParseFromArray(
+            compiler_metadata.bytes, compiler_metadata.size)) {
+      return absl::InternalError("Failed to serialize compiler metadata.");
+    }
+    program->set_may_modify_variables(
+        tpu_program_group.may_modify_variables(i));
+    program->set_is_empty(false);
+  }
+
+  // The entry is written to a temporary file first, so that the other jobs
+  // never read a partially written entry.
+  Env* env = Env::Default();
+  TF_RETURN_IF_ERROR(env->RecursivelyCreateDir(cache_location_));
+  const std::string file_path = GetFilePath(key);
+  std::string temp_path = file_path;
+  if (!env->CreateUniqueFileName(&temp_path, ".tmp")) {
+    return absl::UnavailableError(absl::StrCat(
+        "Could not create a unique file inside ", cache_location_));
+  }
+  TF_RETURN_IF_ERROR(WriteBinaryProto(env, temp_path, entry));
+  return env->RenameFile(temp_path, file_path);
+}
+#else
+absl::Status TpuCompilationCacheFileStore::Lookup(
+    const std::string& key, TpuProgramGroup* tpu_program_group) const {
+  return absl::UnimplementedError(
+      "The TPU compilation cache file store requires a libtpu build.");
+}
+
+absl::Status TpuCompilationCacheFileStore::Insert(
+    const std::string& key, const TpuProgramGroup& tpu_program_group) const {
+  return absl::UnimplementedError(
+      "The TPU compilation cache file store requires a libtpu build.");
+}
+#endif  // LIBTPU_ON_GCE
+
+}  // namespace tpu
+}  // namespace tensorflow
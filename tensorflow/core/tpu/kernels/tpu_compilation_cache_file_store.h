@@ -0,0 +1,68 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_TPU_KERNELS_TPU_COMPILATION_CACHE_FILE_STORE_H_
+#define TENSORFLOW_CORE_TPU_KERNELS_TPU_COMPILATION_CACHE_FILE_STORE_H_
+
+#include <string>
+
+#include "absl/status/status.h"
+#include "tensorflow/core/tpu/kernels/tpu_compilation_cache_key.h"
+#include "tensorflow/core/tpu/kernels/tpu_compile_op_support.h"
+#include "tensorflow/core/tpu/kernels/tpu_program_group.h"
+
+namespace tensorflow {
+namespace tpu {
+
+// Persistent compilation cache storing the compiled TPU programs in a
+// directory of a file system, e.g. a GCS bucket, so that the jobs compiling
+// the same computations on the same topology share them across restarts and
+// preemptions. An entry holds the programs of all the cores of a computation
+// and is looked up before compiling it.
+//
+// The TPU compiler version isn't part of the key of the entries, so the
+// directory should be specific to a TPU runtime release.
+class TpuCompilationCacheFileStore
+    : public TpuPersistentCompilationCacheInterface {
+ public:
+  // If `read_only` is true, the compiled programs aren't stored.
+  TpuCompilationCacheFileStore(std::string cache_location, bool read_only);
+  ~TpuCompilationCacheFileStore() override = default;
+
+  std::string cache_location() const override { return cache_location_; }
+
+  // Returns the key of the entry of the computation of `subgraph_key`. It
+  // doesn't depend on the session, unlike the key of the host cache.
+  static std::string EntryKey(const TpuCompilationCacheKey& subgraph_key);
+
+  // Initializes `tpu_program_group` with the programs stored for `key`.
+  // Returns a NotFound error if there are none.
+  absl::Status Lookup(const std::string& key,
+                      TpuProgramGroup* tpu_program_group) const;
+
+  // Stores the programs of `tpu_program_group` for `key`.
+  absl::Status Insert(const std::string& key,
+                      const TpuProgramGroup& tpu_program_group) const;
+
+ private:
+  std::string GetFilePath(const std::string& key) const;
+
+  const std::string cache_location_;
+  const bool read_only_;
+};
+
+}  // namespace tpu
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_TPU_KERNELS_TPU_COMPILATION_CACHE_FILE_STORE_H_
@@ -0,0 +1,104 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/tpu/kernels/tpu_compilation_cache_file_store.h"
+
+#include <string>
+
+#include <gtest/gtest.h>
+#include "absl/status/status.h"
+#include "absl/strings/match.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/public/version.h"
+#include "tensorflow/core/tpu/kernels/tpu_compilation_cache_key.h"
+#include "tensorflow/core/tpu/kernels/tpu_program_group.h"
+
+namespace tensorflow {
+namespace tpu {
+namespace {
+
+TpuCompilationCacheKey MakeKey(const std::string& prefix,
+                               const std::string& session_handle) {
+  TpuCompilationCacheKey key(prefix);
+  key.session_handle = session_handle;
+  key.session_id = session_handle.size();
+  return key;
+}
+
+TEST(TpuCompilationCacheFileStoreTest, EntryKeyIgnoresSession) {
+  const std::string entry_key =
+      TpuCompilationCacheFileStore::EntryKey(MakeKey("prefix", "session1"));
+  EXPECT_TRUE(absl::StartsWith(entry_key, TF_VERSION_STRING));
+  EXPECT_EQ(entry_key, TpuCompilationCacheFileStore::EntryKey(
+                           MakeKey("prefix", "session10")));
+  EXPECT_NE(entry_key, TpuCompilationCacheFileStore::EntryKey(
+                           MakeKey("other_prefix", "session1")));
+}
+
+TEST(TpuCompilationCacheFileStoreTest, EntryKeyOfGuaranteedConstants) {
+  auto make_key = [](const std::string& session_handle,
+                     const std::string& fingerprint) {
+    TpuCompilationCacheKey key = MakeKey("prefix", session_handle);
+    key.has_guaranteed_const = true;
+    key.guaranteed_const_fingerprint = [fingerprint]() { return fingerprint; };
+    return key;
+  };
+  const std::string entry_key =
+      TpuCompilationCacheFileStore::EntryKey(make_key("session1", "fp1"));
+  // The fingerprint of the constants replaces the session handle.
+  EXPECT_EQ(entry_key, TpuCompilationCacheFileStore::EntryKey(
+                           make_key("session2", "fp1")));
+  EXPECT_NE(entry_key, TpuCompilationCacheFileStore::EntryKey(
+                           make_key("session1", "fp2")));
+  EXPECT_NE(entry_key, TpuCompilationCacheFileStore::EntryKey(
+                           MakeKey("prefix", "session1")));
+}
+
+TEST(TpuCompilationCacheFileStoreTest, LookupMissingEntry) {
+  const std::string cache_location =
+      io::JoinPath(testing::TmpDir(), "tpu_compilation_cache_lookup");
+  TpuCompilationCacheFileStore store(cache_location, /*read_only=*/false);
+  EXPECT_EQ(store.cache_location(), cache_location);
+  TpuProgramGroup tpu_program_group;
+  const absl::Status status = store.Lookup(
+      TpuCompilationCacheFileStore::EntryKey(MakeKey("prefix", "session")),
+      &tpu_program_group);
+#if defined(LIBTPU_ON_GCE)
+  EXPECT_TRUE(absl::IsNotFound(status)) << status;
+#else
+  EXPECT_TRUE(absl::IsUnimplemented(status)) << status;
+#endif  // LIBTPU_ON_GCE
+}
+
+TEST(TpuCompilationCacheFileStoreTest, ReadOnlyStoreDoesNotWrite) {
+  const std::string cache_location =
+      io::JoinPath(testing::TmpDir(), "tpu_compilation_cache_read_only");
+  TpuCompilationCacheFileStore store(cache_location, /*read_only=*/true);
+  TpuProgramGroup tpu_program_group;
+  const absl::Status status = store.Insert(
+      TpuCompilationCacheFileStore::EntryKey(MakeKey("prefix", "session")),
+      tpu_program_group);
+#if defined(LIBTPU_ON_GCE)
+  EXPECT_TRUE(status.ok()) << status;
+#else
+  EXPECT_TRUE(absl::IsUnimplemented(status)) << status;
+#endif  // LIBTPU_ON_GCE
+  EXPECT_TRUE(absl::IsNotFound(Env::Default()->FileExists(cache_location)));
+}
+
+}  // namespace
+}  // namespace tpu
+}  // namespace tensorflow
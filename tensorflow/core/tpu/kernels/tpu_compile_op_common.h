@@ -69,17 +69,19 @@ class CompileOpImplFactory {
 // Abstract base class for TpuCompileOpKernel implementation.
 class TpuCompileOpKernelCommon {
  public:
-  TpuCompileOpKernelCommon(const std::string& mlir_module,
-                           const tpu::TPUCompileMetadataProto metadata,
-                           int num_computations, bool return_hlo_protos,
-                           bool unload_cache_on_session_close)
+  TpuCompileOpKernelCommon(
+      const std::string& mlir_module,
+      const tpu::TPUCompileMetadataProto metadata, int num_computations,
+      bool return_hlo_protos, bool unload_cache_on_session_close,
+      std::unique_ptr<TpuPersistentCompilationCacheInterface> persistent_cache =
+          nullptr)
       : metadata_(metadata),
         use_mlir_(true),
         mlir_module_(mlir_module),
         num_computations_(num_computations),
         return_hlo_protos_(return_hlo_protos),
         unload_cache_entry_on_session_close_(unload_cache_on_session_close),
-        persistent_cache_(nullptr) {
+        persistent_cache_(std::move(persistent_cache)) {
     mlir_module_fingerprint_ = tensorflow::Fingerprint64(mlir_module_);
   }
 
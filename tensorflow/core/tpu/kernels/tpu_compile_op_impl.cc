@@ -16,15 +16,19 @@ limitations under the License.
 
 #include <memory>
 #include <string>
+#include <utility>
 #include <variant>
 #include <vector>
 
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "tensorflow/compiler/jit/flags.h"
 #include "xla/stream_executor/platform/initialize.h"
 #include "xla/stream_executor/tpu/tpu_ops_c_api.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/platform/casts.h"
+#include "tensorflow/core/tpu/kernels/tpu_compilation_cache_file_store.h"
 #include "tensorflow/core/tpu/kernels/tpu_compilation_cache_key.h"
 #include "tensorflow/core/tpu/kernels/tpu_compile.pb.h"
 #include "tensorflow/core/tpu/kernels/tpu_compile_op_common.h"
@@ -59,6 +63,67 @@ absl::Status TpuCompileOpKernelImpl::Compile(
   return s;
 }
 
+absl::Status
+TpuCompileOpKernelImpl::LookupPersistentCompilationCacheAndFillCaches(
+    FunctionLibraryRuntime* flib_runtime,
+    const SessionMetadata* session_metadata,
+    const TpuMeshStateInterface* mesh_state,
+    const std::vector<TensorShape>& dynamic_shapes,
+    const OpInputList& guaranteed_constants,
+    TpuPersistentCompilationCacheInterface* persistent_cache,
+    const TpuCompilationCacheKey& key,
+    TpuProgramGroupInterface* tpu_program_group) {
+  auto* file_store =
+      tensorflow::down_cast<TpuCompilationCacheFileStore*>(persistent_cache);
+  auto* programs = tensorflow::down_cast<TpuProgramGroup*>(tpu_program_group);
+  const std::string entry_key = TpuCompilationCacheFileStore::EntryKey(key);
+  // The stored programs don't have the HLO metadata.
+  if (!return_hlo_protos_) {
+    absl::Status status = file_store->Lookup(entry_key, programs);
+    if (status.ok()) {
+      LOG(INFO) << "Loaded the TPU programs of " << key.prefix
+                << " from the persistent compilation cache at "
+                << file_store->cache_location();
+      std::vector<TensorShape> arg_shapes;
+      TF_RETURN_IF_ERROR(
+          ComputeArgumentShapes(metadata_, dynamic_shapes, &arg_shapes));
+      return RegisterXLAFingerprints(
+          arg_shapes, tpu_program_group,
+          use_mlir_ ? mlir_module_fingerprint_
+                    : metadata_.function_library_fingerprint());
+    }
+    if (!absl::IsNotFound(status)) {
+      LOG(WARNING) << "Failed to load the TPU programs of " << key.prefix
+                   << " from the persistent compilation cache at "
+                   << file_store->cache_location() << ": " << status;
+    }
+  }
+
+  TF_RETURN_IF_ERROR(CompileLocallyAndFillHostCache(
+      flib_runtime, session_metadata, mesh_state, dynamic_shapes,
+      guaranteed_constants, key, tpu_program_group));
+  absl::Status status = file_store->Insert(entry_key, *programs);
+  if (!status.ok()) {
+    LOG(WARNING) << "Failed to store the TPU programs of " << key.prefix
+                 << " in the persistent compilation cache at "
+                 << file_store->cache_location() << ": " << status;
+  }
+  return absl::OkStatus();
+}
+
+namespace {
+
+// Returns the persistent compilation cache set by the flags, if any.
+std::unique_ptr<TpuCompilationCacheFileStore> CreatePersistentCache() {
+  const MarkForCompilationPassFlags* flags = GetMarkForCompilationPassFlags();
+  if (flags->tf_xla_tpu_persistent_cache_directory.empty()) return nullptr;
+  return std::make_unique<TpuCompilationCacheFileStore>(
+      flags->tf_xla_tpu_persistent_cache_directory,
+      flags->tf_xla_persistent_cache_read_only);
+}
+
+}  // namespace
+
 class TpuCompileOpImplFactory : public CompileOpImplFactory {
  public:
   absl::StatusOr<std::unique_ptr<TpuCompileOpKernelCommon>> CreateNonMlirImpl(
@@ -72,7 +137,7 @@ class TpuCompileOpImplFactory : public CompileOpImplFactory {
     return {std::make_unique<TpuCompileOpKernelImpl>(
         function_name, metadata, metadata.num_cores_per_replica(),
         /*return_hlo_protos=*/false,
-        /*unload_cache_on_session_close=*/false)};
+        /*unload_cache_on_session_close=*/false, CreatePersistentCache())};
   }
 
   absl::StatusOr<std::unique_ptr<TpuCompileOpKernelCommon>> CreateMlirImpl(
@@ -85,7 +150,7 @@ class TpuCompileOpImplFactory : public CompileOpImplFactory {
     return {std::make_unique<TpuCompileOpKernelImpl>(
         mlir_module, metadata, metadata.num_cores_per_replica(),
         /*return_hlo_protos=*/false,
-        /*unload_cache_on_session_close=*/false)};
+        /*unload_cache_on_session_close=*/false, CreatePersistentCache())};
   }
 };
 
@@ -15,7 +15,9 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_TPU_KERNELS_TPU_COMPILE_OP_IMPL_H_
 #define TENSORFLOW_CORE_TPU_KERNELS_TPU_COMPILE_OP_IMPL_H_
 
+#include <memory>
 #include <string>
+#include <utility>
 #include <variant>
 #include <vector>
 
@@ -24,6 +26,7 @@ limitations under the License.
 #include "tensorflow/core/framework/attr_value.pb.h"
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/protobuf/tpu/compile_metadata.pb.h"
+#include "tensorflow/core/tpu/kernels/tpu_compilation_cache_file_store.h"
 #include "tensorflow/core/tpu/kernels/tpu_compilation_cache_key.h"
 #include "tensorflow/core/tpu/kernels/tpu_compile_op_common.h"
 #include "tensorflow/core/tpu/kernels/tpu_compile_op_support.h"
@@ -38,21 +41,25 @@ namespace tpu {
 // into XLA HLO and then into a TPU execuable binary.
 class TpuCompileOpKernelImpl : public TpuCompileOpKernelCommon {
  public:
-  TpuCompileOpKernelImpl(const std::string& mlir_module,
-                         const tpu::TPUCompileMetadataProto& metadata,
-                         int num_computations, bool return_hlo_protos,
-                         bool unload_cache_on_session_close)
+  TpuCompileOpKernelImpl(
+      const std::string& mlir_module,
+      const tpu::TPUCompileMetadataProto& metadata, int num_computations,
+      bool return_hlo_protos, bool unload_cache_on_session_close,
+      std::unique_ptr<TpuCompilationCacheFileStore> persistent_cache = nullptr)
       : TpuCompileOpKernelCommon(mlir_module, metadata, num_computations,
                                  return_hlo_protos,
-                                 unload_cache_on_session_close) {}
+                                 unload_cache_on_session_close,
+                                 std::move(persistent_cache)) {}
 
-  TpuCompileOpKernelImpl(const NameAttrList& function,
-                         const tpu::TPUCompileMetadataProto& metadata,
-                         int num_computations, bool return_hlo_protos,
-                         bool unload_cache_on_session_close)
-      : TpuCompileOpKernelCommon(
-            function, metadata, num_computations, return_hlo_protos,
-            unload_cache_on_session_close, /*persistent_cache=*/nullptr) {}
+  TpuCompileOpKernelImpl(
+      const NameAttrList& function,
+      const tpu::TPUCompileMetadataProto& metadata, int num_computations,
+      bool return_hlo_protos, bool unload_cache_on_session_close,
+      std::unique_ptr<TpuCompilationCacheFileStore> persistent_cache = nullptr)
+      : TpuCompileOpKernelCommon(function, metadata, num_computations,
+                                 return_hlo_protos,
+                                 unload_cache_on_session_close,
+                                 std::move(persistent_cache)) {}
 
   absl::Status Compile(
       const std::variant<MlirToHloArgs, FunctionToHloArgs>& computation,
@@ -60,6 +67,20 @@ class TpuCompileOpKernelImpl : public TpuCompileOpKernelCommon {
       const std::vector<TensorShape>& arg_shapes,
       const TpuCompilationCacheKey* key,
       TpuProgramGroupInterface* tpu_program_group) override;
+
+ protected:
+  // Looks up the programs in the TpuCompilationCacheFileStore, then compiles
+  // them and stores them on a miss. A failure to load or to store the
+  // programs only falls back to compiling them.
+  absl::Status LookupPersistentCompilationCacheAndFillCaches(
+      FunctionLibraryRuntime* flib_runtime,
+      const SessionMetadata* session_metadata,
+      const TpuMeshStateInterface* mesh_state,
+      const std::vector<TensorShape>& dynamic_shapes,
+      const OpInputList& guaranteed_constants,
+      TpuPersistentCompilationCacheInterface* persistent_cache,
+      const TpuCompilationCacheKey& key,
+      TpuProgramGroupInterface* tpu_program_group) override;
 };
 
 }  // namespace tpu
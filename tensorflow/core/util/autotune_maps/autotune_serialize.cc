@@ -16,21 +16,28 @@ limitations under the License.
 // For Google-internal use only.
 #include "tensorflow/core/util/autotune_maps/autotune_serialize.h"
 
+#include <cstdint>
 #include <map>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
+#include "absl/base/call_once.h"
+#include "absl/strings/str_cat.h"
 #include "xla/status_macros.h"
 #include "xla/stream_executor/dnn.h"
 #include "xla/stream_executor/gpu/gpu_init.h"
 #include "xla/stream_executor/platform_manager.h"
+#include "xla/stream_executor/stream_executor.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/str_util.h"
 #include "tensorflow/core/util/activation_mode.h"
 #include "tensorflow/core/util/autotune_maps/autotune_map.pb.h"
 #include "tensorflow/core/util/autotune_maps/conv_autotune_maps.h"
 #include "tensorflow/core/util/autotune_maps/conv_parameters.h"
 #include "tensorflow/core/util/autotune_maps/conv_parameters.pb.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tsl/lib/strings/proto_serialization.h"
 #include "tsl/protobuf/dnn.pb.h"
 
@@ -170,6 +177,25 @@ Status PopulateConvMap(
   return OkStatus();
 }
 
+// Returns the versions of the driver and of the DNN library of the first GPU,
+// which the autotune results depend on, or an empty string if they are
+// unknown.
+std::string GetRuntimeVersions() {
+  absl::StatusOr<se::Platform *> platform =
+      se::PlatformManager::PlatformWithName(se::GpuPlatformName());
+  if (!platform.ok() || (*platform)->VisibleDeviceCount() <= 0) return "";
+  absl::StatusOr<se::StreamExecutor *> executor =
+      (*platform)->ExecutorForDevice(0);
+  if (!executor.ok() || (*executor)->AsDnn() == nullptr) return "";
+  absl::StatusOr<se::dnn::VersionInfo> dnn_version =
+      (*executor)->AsDnn()->GetVersion();
+  if (!dnn_version.ok()) return "";
+  return absl::StrCat(
+      "driver ", (*executor)->GetDeviceDescription().driver_version(), " dnn ",
+      dnn_version->major_version(), ".", dnn_version->minor_version(), ".",
+      dnn_version->patch());
+}
+
 }  // namespace
 #endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
 
@@ -180,6 +206,7 @@ Status SerializeAutotuneMaps(std::string *output) {
                       ConvMapToProto(*ConvAutotuneMap::GetInstance()));
   TF_ASSIGN_OR_RETURN(*proto.mutable_fused_conv_map(),
                       ConvMapToProto(*FusedConvAutotuneMap::GetInstance()));
+  proto.set_runtime_versions(GetRuntimeVersions());
 #endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
   TF_RET_CHECK(tsl::SerializeToStringDeterministic(proto, output));
   return absl::OkStatus();
@@ -195,6 +222,16 @@ Status LoadSerializedAutotuneMaps(absl::string_view s) {
     return errors::InvalidArgument(
         "Failed to parse the autotune maps from string.");
   }
+  if (!proto.runtime_versions().empty()) {
+    const std::string runtime_versions = GetRuntimeVersions();
+    if (!runtime_versions.empty() &&
+        runtime_versions != proto.runtime_versions()) {
+      return errors::Aborted(
+          "Aborted because the autotune results were obtained with other "
+          "versions of the GPU driver and DNN library. Expected: ",
+          runtime_versions, ". Actual: ", proto.runtime_versions());
+    }
+  }
   TF_RETURN_IF_ERROR(
       PopulateConvMap(proto.conv_map(), ConvAutotuneMap::GetInstance()));
   TF_RETURN_IF_ERROR(PopulateConvMap(proto.fused_conv_map(),
@@ -211,4 +248,71 @@ void ResetAutotuneMaps() {
 #endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
 }
 
+Status LoadAutotuneMapsFromFile(Env *env, const std::string &filename) {
+  std::string serialized;
+  TF_RETURN_IF_ERROR(ReadFileToString(env, filename, &serialized));
+  return LoadSerializedAutotuneMaps(serialized);
+}
+
+Status SaveAutotuneMapsToFile(Env *env, const std::string &filename) {
+  std::string serialized;
+  TF_RETURN_IF_ERROR(SerializeAutotuneMaps(&serialized));
+  // The maps are written to a temporary file first, which is then renamed.
+  std::string temp_filename = filename;
+  if (!env->CreateUniqueFileName(&temp_filename, ".tmp")) {
+    return errors::Unavailable("Could not create a temporary file for ",
+                               filename);
+  }
+  TF_RETURN_IF_ERROR(WriteStringToFile(env, temp_filename, serialized));
+  return env->RenameFile(temp_filename, filename);
+}
+
+void MaybeShareAutotuneMapsThroughFile() {
+  static absl::once_flag once;
+  absl::call_once(once, [] {
+    std::string filename;
+    TF_CHECK_OK(ReadStringFromEnvVar("TF_AUTOTUNE_MAPS_FILE", "", &filename));
+    if (filename.empty()) return;
+    int64_t save_interval_secs;
+    TF_CHECK_OK(ReadInt64FromEnvVar("TF_AUTOTUNE_MAPS_FILE_SAVE_INTERVAL_SECS",
+                                    60, &save_interval_secs));
+    Env *env = Env::Default();
+    Status status = LoadAutotuneMapsFromFile(env, filename);
+    if (!status.ok() && !errors::IsNotFound(status)) {
+      LOG(WARNING) << "Failed to load the autotune maps from " << filename
+                   << ": " << status;
+    }
+
+    // The thread runs until the process exits.
+    env->StartThread(
+        ThreadOptions(), "autotune_maps_file",
+        [env, filename, save_interval_secs]() {
+          std::string saved;
+          TF_CHECK_OK(SerializeAutotuneMaps(&saved));
+          while (true) {
+            env->SleepForMicroseconds(save_interval_secs * 1000000);
+            std::string serialized;
+            if (!SerializeAutotuneMaps(&serialized).ok() ||
+                serialized == saved) {
+              continue;
+            }
+            // Merges the results of the other processes saved meanwhile, so
+            // that they aren't overwritten.
+            Status status = LoadAutotuneMapsFromFile(env, filename);
+            if (!status.ok() && !errors::IsNotFound(status)) {
+              LOG(WARNING) << "Failed to merge the autotune maps of "
+                           << filename << ": " << status;
+            }
+            status = SaveAutotuneMapsToFile(env, filename);
+            if (!status.ok()) {
+              LOG(WARNING) << "Failed to save the autotune maps to "
+                           << filename << ": " << status;
+              continue;
+            }
+            if (!SerializeAutotuneMaps(&saved).ok()) saved.clear();
+          }
+        });
+  });
+}
+
 }  // namespace tensorflow
@@ -27,6 +27,7 @@ limitations under the License.
 
 #include <string>
 
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/status.h"
 
 namespace tensorflow {
@@ -43,6 +44,22 @@ Status SerializeAutotuneMaps(std::string* output);
 // Resets all autotune maps. For test use only.
 void ResetAutotuneMaps();
 
+// Loads the autotune maps stored in the file `filename` by
+// SaveAutotuneMapsToFile and uses them to update the runtime autotune maps.
+Status LoadAutotuneMapsFromFile(Env* env, const std::string& filename);
+
+// Stores all the autotune maps in the file `filename`. The file is replaced
+// atomically, so that the processes sharing it never read a partial file.
+Status SaveAutotuneMapsToFile(Env* env, const std::string& filename);
+
+// If the environment variable TF_AUTOTUNE_MAPS_FILE names a file, loads the
+// autotune maps from it and starts a background thread that merges the
+// autotune results of this process into the file every
+// TF_AUTOTUNE_MAPS_FILE_SAVE_INTERVAL_SECS seconds (60 by default). The
+// processes sharing the file, e.g. the replicas of a model server, then don't
+// autotune the same operations again. Only the first call has an effect.
+void MaybeShareAutotuneMapsThroughFile();
+
 }  // namespace tensorflow
 
 #endif  // TENSORFLOW_CORE_UTIL_AUTOTUNE_MAPS_AUTOTUNE_SERIALIZE_H_
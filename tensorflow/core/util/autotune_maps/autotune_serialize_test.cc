@@ -20,8 +20,11 @@ limitations under the License.
 #include "tensorflow/core/util/autotune_maps/autotune_serialize.h"
 #include "xla/stream_executor/gpu/gpu_driver.h"
 #include "xla/stream_executor/gpu/gpu_init.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/path.h"
 #include "tensorflow/core/platform/status_matchers.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/util/autotune_maps/autotune_map.pb.h"
 #include "tensorflow/core/util/autotune_maps/conv_autotune_maps.h"
 #include "tensorflow/core/util/autotune_maps/conv_parameters.h"
 #include "tensorflow/core/util/autotune_maps/conv_parameters.pb.h"
@@ -181,6 +184,55 @@ TEST(AutotuneSerializeTest, VersionControl) {
                HasSubstr("Aborted because the loaded autotune results")));
   EXPECT_EQ(ConvAutotuneMap::GetInstance()->GetMap().size(), 0);
 }
+
+// Tests that the autotune maps saved to a file are loaded back, and that the
+// results of other GPU runtime versions are rejected.
+TEST(AutotuneSerializeTest, File) {
+  TF_CHECK_OK(GpuDriver::Init());
+  ResetAutotuneMaps();
+  ConvParameters conv_params_example_a = {
+      GetStreamExec(),
+      /*batch=*/1,
+      /*in_depths=*/1,
+      /*in=*/{{1, 1}},
+      /*data_format=*/TensorFormat::FORMAT_NCHW,
+      /*out_depths=*/1,
+      /*filter=*/{{1, 1}},
+      /*dilation=*/{{1, 1}},
+      /*stride=*/{{1, 1}},
+      /*padding=*/{{1, 1}},
+      /*dtype=*/DataType::DT_INT8,
+      /*group_count=*/1};
+  AlgorithmDesc algorithm(/*algo_id=*/1, /*use_tensor_ops=*/true);
+  AlgorithmDesc algorithm_no_scratch(/*algo_id=*/1, /*use_tensor_ops=*/true);
+  AutotuneEntry<se::dnn::ConvOp> example_a(algorithm, algorithm_no_scratch);
+  ConvAutotuneMap::GetInstance()->Insert(conv_params_example_a, example_a);
+
+  Env* env = Env::Default();
+  const std::string filename =
+      io::JoinPath(testing::TmpDir(), "autotune_maps.pb");
+  TF_CHECK_OK(SaveAutotuneMapsToFile(env, filename));
+  ResetAutotuneMaps();
+  TF_CHECK_OK(LoadAutotuneMapsFromFile(env, filename));
+  AutotuneEntry<se::dnn::ConvOp> entry;
+  EXPECT_TRUE(
+      ConvAutotuneMap::GetInstance()->Find(conv_params_example_a, &entry));
+  EXPECT_EQ(entry, example_a);
+
+  AutotuneMapsProto proto;
+  TF_CHECK_OK(ReadBinaryProto(env, filename, &proto));
+  EXPECT_FALSE(proto.runtime_versions().empty());
+  proto.set_runtime_versions("driver 0 dnn 0.0.0");
+  TF_CHECK_OK(WriteBinaryProto(env, filename, proto));
+  ResetAutotuneMaps();
+  EXPECT_THAT(LoadAutotuneMapsFromFile(env, filename),
+              StatusIs(error::ABORTED, HasSubstr("other versions")));
+  EXPECT_EQ(ConvAutotuneMap::GetInstance()->GetMap().size(), 0);
+
+  EXPECT_THAT(
+      LoadAutotuneMapsFromFile(env, io::JoinPath(testing::TmpDir(), "none")),
+      StatusIs(error::NOT_FOUND));
+}
 }  // namespace
 }  // namespace tensorflow
 #endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
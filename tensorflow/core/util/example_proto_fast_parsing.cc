@@ -119,6 +119,43 @@ constexpr uint8 kVarintTag(uint32 tag) { return (tag << 3) | 0; }
 constexpr uint8 kDelimitedTag(uint32 tag) { return (tag << 3) | 2; }
 constexpr uint8 kFixed32Tag(uint32 tag) { return (tag << 3) | 5; }
 
+// Appends the packed varints in [begin, end) to `int64_list`. Returns false if
+// the last varint is truncated or any varint is longer than 10 bytes.
+//
+// Every varint ends with the only one of its bytes that has the high bit
+// clear, so the number of values is known upfront; this lets the output be
+// resized once and the counting loop be vectorized.
+template <typename Result>
+bool DecodePackedVarints(const uint8* begin, const uint8* end,
+                         Result* int64_list) {
+  if (begin == end) return true;
+  if (end[-1] & 0x80) return false;
+  size_t num_values = 0;
+  for (const uint8* p = begin; p < end; ++p) {
+    num_values += (*p & 0x80) == 0;
+  }
+  const size_t initial_size = int64_list->size();
+  int64_list->resize(initial_size + num_values);
+  // May be less than requested in case of a LimitedArraySlice.
+  const size_t size = int64_list->size();
+  size_t index = initial_size;
+  for (const uint8* p = begin; p < end; ++index) {
+    uint64 value = *p & 0x7f;
+    if (*p++ & 0x80) {
+      int shift = 7;
+      do {
+        if (shift > 63) return false;
+        value |= static_cast<uint64>(*p & 0x7f) << shift;
+        shift += 7;
+      } while (*p++ & 0x80);
+    }
+    if (index < size) {
+      int64_list->data()[index] = static_cast<int64_t>(value);
+    }
+  }
+  return true;
+}
+
 namespace parsed {
 
 // ParseDataType has to be called first, then appropriate ParseZzzzList.
@@ -307,6 +344,20 @@ class Feature {
         if (!stream.ReadVarint32(&packed_length)) return false;
         auto packed_limit = stream.PushLimit(packed_length);
 
+        // The input is a flat array, so the packed values are contiguous in
+        // the buffer and can be decoded without going through the stream one
+        // varint at a time.
+        const void* packed_data;
+        int packed_available;
+        if (packed_length > 0 &&
+            stream.GetDirectBufferPointer(&packed_data, &packed_available) &&
+            static_cast<uint32>(packed_available) >= packed_length) {
+          const uint8* begin = static_cast<const uint8*>(packed_data);
+          if (!DecodePackedVarints(begin, begin + packed_length, int64_list)) {
+            return false;
+          }
+          stream.Skip(packed_length);
+        }
         while (!stream.ExpectAtEnd()) {
           protobuf_uint64 n;  // There is no API for int64
           if (!stream.ReadVarint64(&n)) return false;
@@ -15,12 +15,15 @@ limitations under the License.
 
 #include "tensorflow/core/util/example_proto_fast_parsing.h"
 
+#include <limits>
 #include <unordered_set>
 #include <utility>
 #include <vector>
 
 #include "tensorflow/core/example/example.pb.h"
 #include "tensorflow/core/example/feature.pb.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/random/philox_random.h"
 #include "tensorflow/core/lib/random/simple_philox.h"
 #include "tensorflow/core/platform/protobuf.h"
@@ -172,6 +175,65 @@ TEST(FastParse, Packed) {
       "\x0a\x0d\x0a\x0b\x0a\x03\x61\x67\x65\x12\x04\x1a\x02\x08\x0d");
 }
 
+TEST(FastParse, PackedInt64MultiByteVarints) {
+  Example example;
+  auto* int64_list =
+      (*example.mutable_features()->mutable_feature())["age"]
+          .mutable_int64_list();
+  for (int64_t value : {int64_t{0}, int64_t{1}, int64_t{127}, int64_t{128},
+                        int64_t{300}, int64_t{-1},
+                        std::numeric_limits<int64_t>::max(),
+                        std::numeric_limits<int64_t>::min()}) {
+    int64_list->add_value(value);
+  }
+  TestCorrectness(Serialize(example));
+}
+
+TEST(FastParse, PackedInt64TruncatedVarint) {
+  Example example;
+  // The last varint of the packed list has its continuation bit set.
+  EXPECT_FALSE(TestFastParse(
+      "\x0a\x0e\x0a\x0c\x0a\x03\x61\x67\x65\x12\x05\x1a\x03\x0a\x01\x8d",
+      &example));
+  // An 11-byte varint.
+  EXPECT_FALSE(TestFastParse(
+      "\x0a\x18\x0a\x16\x0a\x03\x61\x67\x65\x12\x0f\x1a\x0d\x0a\x0b"
+      "\xff\xff\xff\xff\xff\xff\xff\xff\xff\xff\x01",
+      &example));
+}
+
+TEST(TestFastParseExample, DensePackedInt64) {
+  Example example;
+  auto* int64_list =
+      (*example.mutable_features()->mutable_feature())["age"]
+          .mutable_int64_list();
+  int64_list->add_value(1);
+  int64_list->add_value(1000);
+  int64_list->add_value(-5);
+  const std::vector<tstring> serialized = {Serialize(example)};
+
+  FastParseExampleConfig config;
+  config.dense.push_back({"age", DT_INT64, PartialTensorShape({3}),
+                          Tensor(DT_INT64, TensorShape({0})),
+                          /*variable_length=*/false,
+                          /*elements_per_stride=*/3});
+  Result result;
+  TF_ASSERT_OK(FastParseExample(config, serialized,
+                                absl::Span<const tstring>(), nullptr, &result));
+  ASSERT_EQ(result.dense_values.size(), 1);
+  test::ExpectTensorEqual<int64_t>(
+      result.dense_values[0],
+      test::AsTensor<int64_t>({1, 1000, -5}, TensorShape({1, 3})));
+
+  // More values than the dense shape allows.
+  int64_list->add_value(7);
+  const std::vector<tstring> too_long = {Serialize(example)};
+  Result too_long_result;
+  EXPECT_FALSE(FastParseExample(config, too_long, absl::Span<const tstring>(),
+                                nullptr, &too_long_result)
+                   .ok());
+}
+
 TEST(FastParse, ValueBeforeKeyInMap) {
   TestCorrectness("\x0a\x12\x0a\x10\x12\x09\x0a\x07\x0a\x05value\x0a\x03key");
 }
@@ -15,14 +15,20 @@ limitations under the License.
 
 #include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cstdlib>
 #include <cstring>
+#include <deque>
 #include <memory>
+#include <tuple>
 #include <utility>
+#include <vector>
 
 #include "absl/base/call_once.h"
 #include "absl/synchronization/mutex.h"
 #include "xla/tsl/util/byte_swap_array.h"
+#include "tensorflow/core/framework/allocation_description.pb.h"
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/framework/tensor_shape.pb.h"
@@ -43,6 +49,7 @@ limitations under the License.
 #include "tensorflow/core/platform/bfloat16.h"
 #include "tensorflow/core/platform/cord.h"
 #include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/fingerprint.h"
 #include "tensorflow/core/platform/mem.h"
 #include "tensorflow/core/platform/path.h"
 #include "tensorflow/core/platform/random.h"
@@ -424,6 +431,24 @@ Status PadAlignment(tsl::BufferedWritableFile* out, int alignment,
   return status;
 }
 
+// Returns how the metadata of the bundle with "prefix" refers to the data file
+// "filename" of another bundle: by its base name if the two are in the same
+// directory.
+string ExternalDataFileName(StringPiece prefix, StringPiece filename) {
+  if (io::Dirname(filename) == io::Dirname(prefix)) {
+    return string(io::Basename(filename));
+  }
+  return string(filename);
+}
+
+// Inverse of ExternalDataFileName().
+string ResolveExternalDataFile(StringPiece prefix, StringPiece name) {
+  if (io::Dirname(name).empty()) {
+    return io::JoinPath(io::Dirname(prefix), name);
+  }
+  return string(name);
+}
+
 }  // namespace
 
 BundleWriter::BundleWriter(Env* env, StringPiece prefix, const Options& options)
@@ -451,6 +476,61 @@ BundleWriter::BundleWriter(Env* env, StringPiece prefix, const Options& options)
       std::move(wrapper), 8 << 20 /* 8MB write buffer */);
 
   VLOG(1) << "Writing to file " << data_path_;
+
+  if (!options_.base_prefix.empty()) {
+    auto base = std::make_unique<BundleReader>(env_, options_.base_prefix);
+    BundleHeaderProto header;
+    Status s = base->status();
+    if (s.ok()) {
+      base->Seek(kHeaderEntryKey);
+      s = base->Valid()
+              ? ParseEntryProto(base->key(), base->value(), &header)
+              : errors::DataLoss("Missing header entry");
+    }
+    const BundleHeaderProto::Endianness endianness =
+        port::kLittleEndian ? BundleHeaderProto::LITTLE
+                            : BundleHeaderProto::BIG;
+    if (s.ok() && header.endianness() != endianness) {
+      s = errors::Unimplemented("Base bundle has a different endianness");
+    }
+    if (s.ok()) {
+      base_ = std::move(base);
+    } else {
+      LOG(WARNING) << "Writing all tensors of " << prefix_
+                   << ": unable to use base bundle " << options_.base_prefix
+                   << ": " << s;
+    }
+  }
+}
+
+BundleWriter::~BundleWriter() = default;
+
+bool BundleWriter::ReuseBaseEntry(StringPiece key, const Tensor& val,
+                                  uint64 fingerprint, BundleEntryProto* entry) {
+  base_->Seek(key);
+  if (!base_->Valid() || base_->key() != key) return false;
+  BundleEntryProto base_entry;
+  if (!ParseEntryProto(key, base_->value(), &base_entry).ok()) return false;
+  if (base_entry.fingerprint() != fingerprint ||
+      base_entry.dtype() != val.dtype() || !base_entry.slices().empty() ||
+      base_entry.size() != val.TotalBytes() ||
+      !TensorShape::IsValid(base_entry.shape()) ||
+      !val.shape().IsSameSize(TensorShape(base_entry.shape()))) {
+    return false;
+  }
+
+  // This bundle writes a single data file, so external shard ids start at 1.
+  const string data_file = ExternalDataFileName(
+      prefix_, base_->ShardFilename(base_entry.shard_id()));
+  auto it = external_shard_ids_.try_emplace(data_file,
+                                            1 + external_data_files_.size());
+  if (it.second) external_data_files_.push_back(data_file);
+  *entry = std::move(base_entry);
+  entry->set_shard_id(it.first->second);
+  reused_bytes_ += entry->size();
+  VLOG(2) << "Reusing " << entry->size() << " bytes of " << key << " from "
+          << data_file;
+  return true;
 }
 
 Status BundleWriter::Add(StringPiece key, const Tensor& val) {
@@ -463,6 +543,15 @@ Status BundleWriter::Add(StringPiece key, const Tensor& val) {
   }
 
   BundleEntryProto* entry = &entries_[key_string];
+  uint64 fingerprint = 0;
+  if ((options_.fingerprint_tensors || base_ != nullptr) &&
+      DataTypeCanUseMemcpy(val.dtype())) {
+    // Zero means "no fingerprint".
+    fingerprint = std::max<uint64>(Fingerprint64(val.tensor_data()), 1);
+    if (base_ != nullptr && ReuseBaseEntry(key, val, fingerprint, entry)) {
+      return absl::OkStatus();
+    }
+  }
   entry->set_dtype(val.dtype());
   val.shape().AsProto(entry->mutable_shape());
   entry->set_shard_id(0);
@@ -484,6 +573,7 @@ Status BundleWriter::Add(StringPiece key, const Tensor& val) {
   if (status_.ok()) {
     entry->set_size(data_bytes_written);
     entry->set_crc32c(crc32c::Mask(crc32c));
+    entry->set_fingerprint(fingerprint);
     size_ += data_bytes_written;
     status_ = PadAlignment(out_.get(), options_.data_alignment, &size_);
   }
@@ -565,6 +655,9 @@ Status BundleWriter::Finish() {
     VersionDef* version = header.mutable_version();
     version->set_producer(kTensorBundleVersion);
     version->set_min_consumer(kTensorBundleMinConsumer);
+    for (const string& data_file : external_data_files_) {
+      header.add_external_data_files(data_file);
+    }
 
     builder.Add(kHeaderEntryKey, header.SerializeAsString());
 
@@ -604,6 +697,12 @@ struct MergeState {
   std::map<string, BundleEntryProto> entries;
   // Data file path -> new shard id in the final merged bundle.
   std::unordered_map<string, int32> shard_ids;
+
+  // Data files of other bundles referred to by the merged bundles, and their
+  // index in "external_data_files". Until all bundles are merged, entries in
+  // these files have shard id "-1 - index".
+  std::vector<string> external_data_files;
+  std::unordered_map<string, int32> external_shard_ids;
 };
 
 // Merges entries of "prefix" into the accumulator state "merge".
@@ -624,6 +723,7 @@ static Status MergeOneBundle(Env* env, StringPiece prefix,
   std::unique_ptr<table::Iterator> iter(table->NewIterator());
 
   int num_shards;
+  std::vector<string> external_data_files;
   // Process header.
   {
     iter->Seek(kHeaderEntryKey);
@@ -657,6 +757,9 @@ static Status MergeOneBundle(Env* env, StringPiece prefix,
       }
     }
     num_shards = header.num_shards();
+    for (const string& data_file : header.external_data_files()) {
+      external_data_files.push_back(ResolveExternalDataFile(prefix, data_file));
+    }
     iter->Next();
   }
 
@@ -698,6 +801,24 @@ static Status MergeOneBundle(Env* env, StringPiece prefix,
     }
 
     // Key doesn't duplicate: a fresh tensor/slice entry.
+    if (to_merge_entry.shard_id() >= num_shards &&
+        to_merge_entry.slices().empty()) {
+      const int32 index = to_merge_entry.shard_id() - num_shards;
+      if (index >= external_data_files.size()) {
+        return errors::DataLoss("Invalid shard id ", to_merge_entry.shard_id(),
+                                " of tensor keyed by ", key,
+                                " when merging prefix: ", prefix);
+      }
+      auto result = merge_state->external_shard_ids.insert(
+          {external_data_files[index],
+           merge_state->external_data_files.size()});
+      if (result.second) {
+        merge_state->external_data_files.push_back(external_data_files[index]);
+      }
+      to_merge_entry.set_shard_id(-1 - result.first->second);
+      merge_state->entries[key] = to_merge_entry;
+      continue;
+    }
     auto result = merge_state->shard_ids.insert(
         {DataFilename(prefix, to_merge_entry.shard_id(), num_shards),
          merge_state->shard_ids.size()});
@@ -749,9 +870,16 @@ Status MergeBundles(Env* env, absl::Span<const tstring> prefixes,
     header.set_num_shards(merge.num_shards);
     header.set_endianness(merge.endianness);
     *header.mutable_version() = merge.version;
+    for (const string& data_file : merge.external_data_files) {
+      header.add_external_data_files(
+          ExternalDataFileName(merged_prefix, data_file));
+    }
     builder.Add(kHeaderEntryKey, header.SerializeAsString());
     // All others.
-    for (const auto& p : merge.entries) {
+    for (auto& p : merge.entries) {
+      if (p.second.shard_id() < 0) {
+        p.second.set_shard_id(merge.num_shards - 1 - p.second.shard_id());
+      }
       builder.Add(p.first, p.second.SerializeAsString());
     }
     status = builder.Finish();
@@ -830,6 +958,9 @@ BundleReader::BundleReader(Env* env, StringPiece prefix, Options options)
     return;
   }
   num_shards_ = header.num_shards();
+  for (const string& data_file : header.external_data_files()) {
+    external_data_files_.push_back(ResolveExternalDataFile(prefix_, data_file));
+  }
   if ((header.endianness() == BundleHeaderProto::BIG && port::kLittleEndian) ||
       (header.endianness() == BundleHeaderProto::LITTLE &&
        !port::kLittleEndian)) {
@@ -911,7 +1042,7 @@ Status BundleReader::GetValue(const BundleEntryProto& entry, Tensor* val) {
   if (buffered_file == nullptr) {
     RandomAccessFile* file = nullptr;
     TF_RETURN_IF_ERROR(cache_->GetFile(
-        DataFilename(prefix_, entry.shard_id(), num_shards_), &file));
+        ShardFilename(entry.shard_id()), &file));
     buffered_file = new io::InputBuffer(file, kBufferSize);
     data_[entry.shard_id()] = buffered_file;
   }
@@ -955,7 +1086,7 @@ Status BundleReader::GetValue(const BundleEntryProto& entry, Tensor* val) {
             std::unique_ptr<RandomAccessFile> section_reader = nullptr;
             StringPiece sp;
             if (auto file_status = env_->NewRandomAccessFile(
-                    DataFilename(prefix_, entry.shard_id(), num_shards_),
+                    ShardFilename(entry.shard_id()),
                     &section_reader);
                 !file_status.ok()) {
               statuses[i] = file_status;
@@ -1033,6 +1164,67 @@ Status BundleReader::Lookup(StringPiece key, Tensor* val) {
   }
 }
 
+namespace {
+
+// The buffer of a tensor stored in a memory mapped data file.
+class MappedTensorBuffer : public TensorBuffer {
+ public:
+  MappedTensorBuffer(std::shared_ptr<ReadOnlyMemoryRegion> region,
+                     const char* data, size_t size)
+      : TensorBuffer(const_cast<char*>(data)),
+        region_(std::move(region)),
+        size_(size) {}
+
+  size_t size() const override { return size_; }
+  TensorBuffer* root_buffer() override { return this; }
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(size_);
+    proto->set_allocator_name("BundleReader::LookupMapped");
+  }
+  bool OwnsMemory() const override { return false; }
+
+ private:
+  const std::shared_ptr<ReadOnlyMemoryRegion> region_;
+  const size_t size_;
+};
+
+}  // namespace
+
+bool BundleReader::LookupMapped(StringPiece key, Tensor* val) {
+  CHECK(val != nullptr);
+  BundleEntryProto entry;
+  if (!GetBundleEntryProto(key, &entry).ok() || !entry.slices().empty() ||
+      !DataTypeCanUseMemcpy(entry.dtype()) || need_to_swap_bytes_ ||
+      entry.offset() % EIGEN_MAX_ALIGN_BYTES != 0) {
+    return false;
+  }
+  const TensorShape shape(entry.shape());
+  const int64_t size = shape.num_elements() * DataTypeSize(entry.dtype());
+  if (size == 0 || entry.size() != size) return false;
+
+  auto it = mapped_data_.find(entry.shard_id());
+  if (it == mapped_data_.end()) {
+    std::unique_ptr<ReadOnlyMemoryRegion> region;
+    const string filename = ShardFilename(entry.shard_id());
+    Status s = env_->NewReadOnlyMemoryRegionFromFile(filename, &region);
+    if (!s.ok()) {
+      VLOG(1) << "Couldn't map " << filename << ", reading it instead: " << s;
+    }
+    it = mapped_data_.emplace(entry.shard_id(), std::move(region)).first;
+  }
+  const std::shared_ptr<ReadOnlyMemoryRegion>& region = it->second;
+  if (region == nullptr || entry.offset() + size > region->length() ||
+      reinterpret_cast<uintptr_t>(region->data()) % EIGEN_MAX_ALIGN_BYTES !=
+          0) {
+    return false;
+  }
+  auto* buffer = new MappedTensorBuffer(
+      region, static_cast<const char*>(region->data()) + entry.offset(), size);
+  *val = Tensor(entry.dtype(), shape, buffer);
+  buffer->Unref();
+  return true;
+}
+
 Status BundleReader::ReadCurrent(Tensor* val) {
   CHECK(val != nullptr);
   BundleEntryProto entry;
@@ -1071,6 +1263,258 @@ Status BundleReader::LookupSlice(StringPiece full_tensor_key,
   return GetSliceValue(full_tensor_key, entry, slice_spec, val);
 }
 
+namespace {
+
+// A tensor read by `BundleReader::LookupBatch()` straight from its bytes in a
+// data file.
+struct ContiguousTensor {
+  int32_t shard_id;
+  int64_t offset;
+  int64_t size;
+  uint32 masked_crc32c;
+  Tensor* val;
+  // Number of reads of the tensor that have not completed yet.
+  std::atomic<int> pending_reads{0};
+};
+
+// A read of file[offset, offset + size). Either a section of a single tensor,
+// which is read into the tensor directly, or several whole tensors, which are
+// read into a staging buffer and copied out.
+struct CoalescedRead {
+  int32_t shard_id;
+  int64_t offset;
+  int64_t size;
+  std::vector<ContiguousTensor*> tensors;
+
+  bool staged() const { return tensors.size() > 1; }
+};
+
+// Reads file[offset, offset + size) into "dst".
+Status ReadInto(RandomAccessFile* file, int64_t offset, int64_t size,
+                char* dst) {
+  StringPiece sp;
+  TF_RETURN_IF_ERROR(file->Read(offset, size, &sp, dst));
+  if (sp.data() != dst) {
+    memmove(dst, sp.data(), size);
+  }
+  return absl::OkStatus();
+}
+
+// Groups "tensors", sorted by location, into reads of at most
+// "max_read_bytes": tensors separated by at most "max_gap_bytes" are read
+// together, and larger tensors are read in sections.
+std::vector<CoalescedRead> CoalesceReads(
+    absl::Span<ContiguousTensor* const> tensors, int64_t max_read_bytes,
+    int64_t max_gap_bytes) {
+  std::vector<CoalescedRead> reads;
+  CoalescedRead* open_read = nullptr;
+  for (ContiguousTensor* tensor : tensors) {
+    if (tensor->size > max_read_bytes) {
+      open_read = nullptr;
+      for (int64_t offset = 0; offset < tensor->size;
+           offset += max_read_bytes) {
+        reads.push_back({tensor->shard_id, tensor->offset + offset,
+                         std::min(max_read_bytes, tensor->size - offset),
+                         {tensor}});
+        ++tensor->pending_reads;
+      }
+      continue;
+    }
+    ++tensor->pending_reads;
+    if (open_read != nullptr && open_read->shard_id == tensor->shard_id) {
+      const int64_t end = open_read->offset + open_read->size;
+      if (tensor->offset >= end && tensor->offset - end <= max_gap_bytes &&
+          tensor->offset + tensor->size - open_read->offset <=
+              max_read_bytes) {
+        open_read->size = tensor->offset + tensor->size - open_read->offset;
+        open_read->tensors.push_back(tensor);
+        continue;
+      }
+    }
+    reads.push_back(
+        {tensor->shard_id, tensor->offset, tensor->size, {tensor}});
+    open_read = &reads.back();
+  }
+  return reads;
+}
+
+}  // namespace
+
+bool BundleReader::GetContiguousEntry(const LookupRequest& request,
+                                      const BundleEntryProto& entry,
+                                      BundleEntryProto* contiguous_entry) {
+  if (!DataTypeCanUseMemcpy(entry.dtype()) ||
+      request.val->dtype() != entry.dtype() ||
+      request.val->NumElements() == 0) {
+    return false;
+  }
+  if (entry.slices().empty()) {
+    if (request.slice.has_value() &&
+        !IsFullSlice(*request.slice, TensorShape(entry.shape()))) {
+      return false;
+    }
+    *contiguous_entry = entry;
+  } else {
+    if (!request.slice.has_value() ||
+        absl::c_none_of(entry.slices(), [&](const TensorSliceProto& stored) {
+          return TensorSlice(stored) == *request.slice;
+        })) {
+      return false;
+    }
+    // Errors are reported by "GetSliceValue()".
+    if (!GetBundleEntryProto(
+             checkpoint::EncodeTensorNameSlice(request.key, *request.slice),
+             contiguous_entry)
+             .ok()) {
+      return false;
+    }
+  }
+  return contiguous_entry->size() == request.val->TotalBytes();
+}
+
+Status BundleReader::LookupBatch(absl::Span<const LookupRequest> requests,
+                                 const LookupBatchOptions& options) {
+  std::deque<ContiguousTensor> contiguous_tensors;
+  std::vector<const LookupRequest*> other_requests;
+  for (const LookupRequest& request : requests) {
+    CHECK(request.val != nullptr);
+    BundleEntryProto entry;
+    TF_RETURN_IF_ERROR(GetBundleEntryProto(request.key, &entry));
+    BundleEntryProto contiguous_entry;
+    if (!GetContiguousEntry(request, entry, &contiguous_entry)) {
+      other_requests.push_back(&request);
+      continue;
+    }
+    ContiguousTensor& tensor = contiguous_tensors.emplace_back();
+    tensor.shard_id = contiguous_entry.shard_id();
+    tensor.offset = contiguous_entry.offset();
+    tensor.size = contiguous_entry.size();
+    tensor.masked_crc32c = contiguous_entry.crc32c();
+    tensor.val = request.val;
+  }
+
+  std::vector<ContiguousTensor*> sorted_tensors;
+  sorted_tensors.reserve(contiguous_tensors.size());
+  absl::flat_hash_map<int32_t, RandomAccessFile*> files;
+  for (ContiguousTensor& tensor : contiguous_tensors) {
+    sorted_tensors.push_back(&tensor);
+    RandomAccessFile*& file = files[tensor.shard_id];
+    if (file == nullptr) {
+      TF_RETURN_IF_ERROR(cache_->GetFile(
+          ShardFilename(tensor.shard_id), &file));
+    }
+  }
+  absl::c_sort(sorted_tensors,
+               [](const ContiguousTensor* a, const ContiguousTensor* b) {
+                 return std::tie(a->shard_id, a->offset) <
+                        std::tie(b->shard_id, b->offset);
+               });
+  const std::vector<CoalescedRead> reads = CoalesceReads(
+      sorted_tensors, std::max<int64_t>(options.max_read_bytes, 1),
+      options.max_gap_bytes);
+
+  absl::Mutex mu;
+  absl::CondVar bytes_released;
+  Status status;
+  int64_t bytes_in_flight = 0;
+
+  // Verifies "tensor" once all its bytes have been read.
+  auto finish_tensor = [this](const ContiguousTensor& tensor) -> Status {
+    // The checksum is on the bytes in the order they appear in the file.
+    const uint32 actual_crc32c =
+        crc32c::Value(tensor.val->tensor_data().data(), tensor.size);
+    if (crc32c::Unmask(tensor.masked_crc32c) != actual_crc32c) {
+      return errors::DataLoss(
+          "TensorBundle at ", prefix_, " shard ", tensor.shard_id, " (",
+          tensor.size, " bytes): Checksum does not match: stored ",
+          strings::Printf("%08u", crc32c::Unmask(tensor.masked_crc32c)),
+          " vs. calculated on the restored bytes ", actual_crc32c);
+    }
+    if (need_to_swap_bytes_) {
+      TF_RETURN_IF_ERROR(ByteSwapTensor(tensor.val));
+    }
+    return absl::OkStatus();
+  };
+
+  auto run_read = [&](const CoalescedRead& read) -> Status {
+    RandomAccessFile* file = files.at(read.shard_id);
+    if (!read.staged()) {
+      ContiguousTensor* tensor = read.tensors[0];
+      char* dst = const_cast<char*>(tensor->val->tensor_data().data()) +
+                  (read.offset - tensor->offset);
+      TF_RETURN_IF_ERROR(ReadInto(file, read.offset, read.size, dst));
+    } else {
+      // Bounds the staging memory, but always lets a read through when none
+      // is in flight, so that a read larger than the bound cannot stall.
+      {
+        absl::MutexLock lock(&mu);
+        while (bytes_in_flight > 0 &&
+               bytes_in_flight + read.size > options.max_bytes_in_flight) {
+          bytes_released.Wait(&mu);
+        }
+        bytes_in_flight += read.size;
+      }
+      auto staging = std::make_unique<char[]>(read.size);
+      Status read_status =
+          ReadInto(file, read.offset, read.size, staging.get());
+      if (read_status.ok()) {
+        for (ContiguousTensor* tensor : read.tensors) {
+          memcpy(const_cast<char*>(tensor->val->tensor_data().data()),
+                 staging.get() + (tensor->offset - read.offset), tensor->size);
+        }
+      }
+      staging.reset();
+      {
+        absl::MutexLock lock(&mu);
+        bytes_in_flight -= read.size;
+      }
+      bytes_released.SignalAll();
+      TF_RETURN_IF_ERROR(read_status);
+    }
+    for (ContiguousTensor* tensor : read.tensors) {
+      if (--tensor->pending_reads == 0) {
+        TF_RETURN_IF_ERROR(finish_tensor(*tensor));
+      }
+    }
+    return absl::OkStatus();
+  };
+
+  std::unique_ptr<thread::ThreadPool> reader_pool;
+  if (!reads.empty()) {
+    reader_pool = std::make_unique<thread::ThreadPool>(
+        Env::Default(), "restore_tensor_batch",
+        std::max(1, std::min<int>(options.num_threads, reads.size())));
+    for (const CoalescedRead& read : reads) {
+      reader_pool->Schedule([&, read = &read]() {
+        {
+          absl::MutexLock lock(&mu);
+          if (!status.ok()) return;
+        }
+        Status read_status = run_read(*read);
+        if (!read_status.ok()) {
+          absl::MutexLock lock(&mu);
+          status.Update(read_status);
+        }
+      });
+    }
+  }
+
+  // Serves the other requests from this thread while the reads are in flight.
+  Status other_status;
+  for (const LookupRequest* request : other_requests) {
+    other_status = request->slice.has_value()
+                       ? LookupSlice(request->key, *request->slice,
+                                     request->val)
+                       : Lookup(request->key, request->val);
+    if (!other_status.ok()) break;
+  }
+
+  reader_pool.reset();  // Waits for the reads to finish.
+  TF_RETURN_IF_ERROR(other_status);
+  absl::MutexLock lock(&mu);
+  return status;
+}
+
 Status BundleReader::GetSliceValue(StringPiece full_tensor_key,
                                    const BundleEntryProto& full_tensor_entry,
                                    const TensorSlice& slice_spec, Tensor* val) {
@@ -1207,6 +1651,14 @@ Status BundleReader::LookupTensorShape(StringPiece key, TensorShape* shape) {
   return LookupDtypeAndShape(key, &ignored, shape);
 }
 
+string BundleReader::ShardFilename(int32_t shard_id) const {
+  const int64_t index = static_cast<int64_t>(shard_id) - num_shards_;
+  if (index >= 0 && index < external_data_files_.size()) {
+    return external_data_files_[index];
+  }
+  return DataFilename(prefix_, shard_id, num_shards_);
+}
+
 string BundleReader::DebugString() {
   // Format used below emulates that of TensorSliceReader::DebugString().
   string shape_str;
@@ -57,6 +57,11 @@ limitations under the License.
 //        "/fs/model/train/ckpt-step/tmp/worker1-step"},
 //       "/fs/model/train/ckpt-step/ckpt" /* merged prefix */);
 //
+// A bundle can also be written incrementally on top of an earlier one (see
+// BundleWriter::Options::base_prefix).  Tensors that have not changed since
+// are not written again; the metadata refers to the data files of the earlier
+// bundle instead.
+//
 
 #ifndef TENSORFLOW_CORE_UTIL_TENSOR_BUNDLE_TENSOR_BUNDLE_H_
 #define TENSORFLOW_CORE_UTIL_TENSOR_BUNDLE_TENSOR_BUNDLE_H_
@@ -64,6 +69,7 @@ limitations under the License.
 #include <cstdint>
 #include <map>
 #include <memory>
+#include <optional>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -72,6 +78,7 @@ limitations under the License.
 #include "absl/container/flat_hash_map.h"
 #include "absl/functional/function_ref.h"
 #include "absl/strings/string_view.h"
+#include "absl/types/span.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/tensor_slice.h"
@@ -106,6 +113,8 @@ extern const int kTensorBundleVersion;
 // corresponding value is a BundleHeaderProto.
 extern const char* const kHeaderEntryKey;
 
+class BundleReader;
+
 // Builds a string-string table of tensor names to BundleEntryProto (metadata).
 //
 // On construction, attempts to create a directory given by the dirname of
@@ -119,9 +128,25 @@ class BundleWriter {
     // Alignment, in bytes, for tensor data.
     // Must be >= 1. The default size of 1 densely packs tensors.
     int data_alignment{1};
+
+    // Records a fingerprint of the bytes of each tensor of a memcpy-able
+    // dtype, so that later incremental bundles can refer to it.
+    bool fingerprint_tensors{false};
+
+    // If set, writes an incremental bundle on top of the bundle with this
+    // prefix: a tensor whose key, dtype, shape and fingerprint match an entry
+    // of the base bundle is not written again, and the new metadata refers to
+    // the data file of the base bundle instead. Implies
+    // "fingerprint_tensors". If the base bundle can't be read, all tensors
+    // are written.
+    //
+    // The data files of the base bundle (and of the bundles it refers to)
+    // must outlive the new bundle.
+    std::string base_prefix;
   };
   BundleWriter(Env* env, absl::string_view prefix,
                const Options& options = Options());
+  ~BundleWriter();
 
   // Adds the tensor "val" under key "key".
   // Across calls "key" must be unique but can be added in any order.
@@ -152,7 +177,16 @@ class BundleWriter {
 
   Status status() const { return status_; }
 
+  // Number of tensor bytes that were not written because the base bundle
+  // already holds them.
+  int64_t reused_bytes() const { return reused_bytes_; }
+
  private:
+  // If the base bundle holds a tensor identical to "val" under "key", fills
+  // in "entry" to refer to it and returns true.
+  bool ReuseBaseEntry(absl::string_view key, const Tensor& val,
+                      uint64 fingerprint, BundleEntryProto* entry);
+
   Env* const env_;  // Not owned.
   const Options options_;
   const std::string prefix_;
@@ -164,6 +198,13 @@ class BundleWriter {
   std::map<std::string, BundleEntryProto> entries_;
   Status status_;
 
+  // For incremental bundles: the base bundle (null if none), and the data
+  // files that entries refer to, in the order of their shard ids.
+  std::unique_ptr<BundleReader> base_;
+  std::vector<std::string> external_data_files_;
+  absl::flat_hash_map<std::string, int32_t> external_shard_ids_;
+  int64_t reused_bytes_ = 0;
+
   BundleWriter(const BundleWriter&) = delete;
   void operator=(const BundleWriter&) = delete;
 };
@@ -264,6 +305,21 @@ class BundleReader {
   // REQUIRES: status().ok()
   Status Lookup(absl::string_view key, Tensor* val) TF_MUST_USE_RESULT;
 
+  // Looks up the whole, non-partitioned tensor keyed by "key" without reading
+  // it: on success, "val" is a tensor backed by the memory mapped data file,
+  // which it keeps mapped, and which must not be modified.
+  //
+  // Returns false, and the tensor should be read with "Lookup()", when it
+  // can't be mapped: on error, for the tensors needing a decoding (strings,
+  // variants or swapped bytes), for the ones not stored at an offset aligned
+  // for Eigen (see "BundleWriter::Options::data_alignment") and on the file
+  // systems not supporting "NewReadOnlyMemoryRegionFromFile()".
+  //
+  // The stored crc32c checksum isn't validated, as that would read the whole
+  // tensor.
+  // REQUIRES: status().ok()
+  bool LookupMapped(absl::string_view key, Tensor* val);
+
   // Looks up the tensor pointed to by the internal iterator.
   //
   // On error, "val" may contain nonsense data.
@@ -291,6 +347,47 @@ class BundleReader {
                      const TensorSlice& slice_spec,
                      Tensor* val) TF_MUST_USE_RESULT;
 
+  // A tensor, or a slice of a tensor, to read with `LookupBatch()`.
+  struct LookupRequest {
+    std::string key;
+    // If set, reads this slice of the (possibly partitioned) tensor keyed by
+    // "key", as "LookupSlice()" does. Otherwise reads the whole tensor, as
+    // "Lookup()" does.
+    std::optional<TensorSlice> slice;
+    // Not owned. Must be allocated with the shape and dtype of the contents to
+    // read, as for "Lookup()".
+    Tensor* val;
+  };
+
+  struct LookupBatchOptions {
+    // Maximum number of reads issued concurrently.
+    int num_threads = 8;
+    // Reads of tensors stored next to each other in a data file are coalesced
+    // into reads of at most this many bytes. Larger tensors are read in
+    // sections of this size.
+    int64_t max_read_bytes = 32 << 20;
+    // Two tensors are still considered next to each other if at most this
+    // many bytes (e.g. alignment padding) separate them in the data file.
+    int64_t max_gap_bytes = 64 << 10;
+    // Upper bound on the staging memory allocated by coalesced reads at any
+    // time. Tensors that are not coalesced are read straight into "val".
+    int64_t max_bytes_in_flight = 256 << 20;
+  };
+
+  // Reads all "requests", returning the first error encountered.
+  //
+  // Equivalent to calling "Lookup()" or "LookupSlice()" for each request, but
+  // much faster on file systems with high latency: copyable tensors that are
+  // stored contiguously (whole tensors, and slices that match a stored slice)
+  // are read with large, concurrent reads whose results are copied into
+  // "val" and checksummed in parallel. The remaining requests are served one
+  // at a time by the calling thread in the meantime.
+  //
+  // On error, the "val"s may contain nonsense data.
+  // REQUIRES: status().ok()
+  Status LookupBatch(absl::Span<const LookupRequest> requests,
+                     const LookupBatchOptions& options) TF_MUST_USE_RESULT;
+
   // Seeks to the first position in the bundle whose key is no less than "key".
   // REQUIRES: status().ok()
   void Seek(absl::string_view key) { return iter_->Seek(key); }
@@ -310,6 +407,11 @@ class BundleReader {
 
   std::string DebugString();
 
+  // Returns the name of the data file that holds the tensors of "shard_id",
+  // which may belong to another bundle if this one is incremental.
+  // REQUIRES: status().ok()
+  std::string ShardFilename(int32_t shard_id) const;
+
  private:
   // Seeks for "key" and reads the metadata proto.
   // On non-OK return, clears "entry" for the caller.
@@ -330,6 +432,14 @@ class BundleReader {
                        const TensorSlice& slice_spec,
                        Tensor* val) TF_MUST_USE_RESULT;
 
+  // Returns in "contiguous_entry" the entry whose bytes are exactly the
+  // contents requested by "request", if there is one: the entry of the whole
+  // tensor, or of a stored slice equal to the requested one. Returns false if
+  // "request" has to be served by "GetSliceValue()".
+  bool GetContiguousEntry(const LookupRequest& request,
+                          const BundleEntryProto& entry,
+                          BundleEntryProto* contiguous_entry);
+
   Env* env_;  // Not owned.
   const std::string prefix_;
   std::unique_ptr<BundleCache> owned_cache_;  // may be null
@@ -344,6 +454,11 @@ class BundleReader {
   // Owned InputBuffer objects. cache_ owns the underlying RandomAccessFiles.
   std::unordered_map<int32_t, io::InputBuffer*> data_;
 
+  // The mapped data files, shared with the tensors of "LookupMapped()". Null
+  // for the files which couldn't be mapped.
+  std::unordered_map<int32_t, std::shared_ptr<ReadOnlyMemoryRegion>>
+      mapped_data_;
+
   // Maps each partitioned tensor's key to its stored slices (represented in a
   // TensorSliceSet).  Populated on-demand.
   std::unordered_map<std::string, checkpoint::TensorSliceSet*> tensor_slices_;
@@ -352,6 +467,10 @@ class BundleReader {
   // the header entry in the metadata table.
   int num_shards_;
 
+  // Data files of other bundles referred to by an incremental bundle, with
+  // shard ids starting at "num_shards_".
+  std::vector<std::string> external_data_files_;
+
   // Flag that this class sets to true when the endianness of the target bundle
   // differs from that of the current system's processor architecture.
   bool need_to_swap_bytes_;
@@ -1151,6 +1151,193 @@ TEST(TensorBundleTest, LargeVariableLoadingTest) {
   }
 }
 
+TEST(TensorBundleTest, LookupBatch) {
+  const TensorShape kFullShape({5, 10});
+  const TensorSlice slice1 = TensorSlice::ParseOrDie("-:0,1");
+  const TensorSlice slice2 = TensorSlice::ParseOrDie("-:1,9");
+  {
+    BundleWriter writer(Env::Default(), Prefix("batch"));
+    TF_EXPECT_OK(writer.Add("float", Constant_100x100<float>(1)));
+    TF_EXPECT_OK(writer.Add("int", Constant_2x3<int32>(2)));
+    TF_EXPECT_OK(writer.Add("int2", Constant_2x3<int32>(6)));
+    TF_EXPECT_OK(writer.Add("large", Constant_100x100<double>(3)));
+    TF_EXPECT_OK(writer.Add("string", test::AsTensor<tstring>({"a", "bc"})));
+    TF_EXPECT_OK(writer.AddSlice("sliced", kFullShape, slice1,
+                                 Constant<float>(4., TensorShape({5, 1}))));
+    TF_EXPECT_OK(writer.AddSlice("sliced", kFullShape, slice2,
+                                 Constant<float>(5., TensorShape({5, 9}))));
+    TF_ASSERT_OK(writer.Finish());
+  }
+
+  BundleReader::LookupBatchOptions default_options;
+  // Splits the large tensors into sections, and coalesces the small ones.
+  BundleReader::LookupBatchOptions small_reads;
+  small_reads.max_read_bytes = 1000;
+  small_reads.max_bytes_in_flight = 1;
+  // No coalescing.
+  BundleReader::LookupBatchOptions single_thread;
+  single_thread.num_threads = 1;
+  single_thread.max_gap_bytes = -1;
+  for (const BundleReader::LookupBatchOptions& options :
+       {default_options, small_reads, single_thread}) {
+    BundleReader reader(Env::Default(), Prefix("batch"));
+    TF_ASSERT_OK(reader.status());
+
+    Tensor float_val(DT_FLOAT, TensorShape({100, 100}));
+    Tensor int_val(DT_INT32, TensorShape({2, 3}));
+    Tensor int2_val(DT_INT32, TensorShape({2, 3}));
+    Tensor large_val(DT_DOUBLE, TensorShape({100, 100}));
+    Tensor string_val(DT_STRING, TensorShape({2}));
+    // A stored slice, and a slice "cutting" both stored slices.
+    Tensor slice2_val(DT_FLOAT, TensorShape({5, 9}));
+    Tensor cut_val(DT_FLOAT, TensorShape({5, 2}));
+    // The whole of an unpartitioned tensor, requested as a slice.
+    Tensor full_slice_val(DT_INT32, TensorShape({2, 3}));
+    TF_ASSERT_OK(reader.LookupBatch(
+        {{"large", std::nullopt, &large_val},
+         {"string", std::nullopt, &string_val},
+         {"sliced", slice2, &slice2_val},
+         {"float", std::nullopt, &float_val},
+         {"sliced", TensorSlice::ParseOrDie("-:0,2"), &cut_val},
+         {"int", TensorSlice(2), &full_slice_val},
+         {"int", std::nullopt, &int_val},
+         {"int2", std::nullopt, &int2_val}},
+        options));
+
+    test::ExpectTensorEqual<float>(float_val, Constant_100x100<float>(1));
+    test::ExpectTensorEqual<int32>(int_val, Constant_2x3<int32>(2));
+    test::ExpectTensorEqual<int32>(int2_val, Constant_2x3<int32>(6));
+    test::ExpectTensorEqual<int32>(full_slice_val, Constant_2x3<int32>(2));
+    test::ExpectTensorEqual<double>(large_val, Constant_100x100<double>(3));
+    test::ExpectTensorEqual<tstring>(string_val,
+                                     test::AsTensor<tstring>({"a", "bc"}));
+    test::ExpectTensorEqual<float>(slice2_val,
+                                   Constant<float>(5., TensorShape({5, 9})));
+    Tensor expected_cut_val(DT_FLOAT, TensorShape({5, 2}));
+    test::FillFn<float>(&expected_cut_val, [](int offset) -> float {
+      return offset % 2 == 0 ? 4 : 5;
+    });
+    test::ExpectTensorEqual<float>(cut_val, expected_cut_val);
+  }
+}
+
+TEST(TensorBundleTest, LookupBatchErrors) {
+  {
+    BundleWriter writer(Env::Default(), Prefix("batch_errors"));
+    TF_EXPECT_OK(writer.Add("bar", Constant_100x100<float>(1)));
+    TF_EXPECT_OK(writer.Add("foo", Constant_100x100<float>(2)));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  BundleReader::LookupBatchOptions options;
+  options.max_read_bytes = 1000;
+
+  {
+    BundleReader reader(Env::Default(), Prefix("batch_errors"));
+    TF_ASSERT_OK(reader.status());
+    Tensor val(DT_FLOAT, TensorShape({100, 100}));
+    EXPECT_TRUE(errors::IsNotFound(
+        reader.LookupBatch({{"baz", std::nullopt, &val}}, options)));
+  }
+
+  // Corrupts the last byte of "foo".
+  const string datafile = DataFilename(Prefix("batch_errors"), 0, 1);
+  string data;
+  TF_ASSERT_OK(ReadFileToString(Env::Default(), datafile, &data));
+  data.back() = ~data.back();
+  TF_ASSERT_OK(WriteStringToFile(Env::Default(), datafile, data));
+  {
+    BundleReader reader(Env::Default(), Prefix("batch_errors"));
+    TF_ASSERT_OK(reader.status());
+    Tensor bar(DT_FLOAT, TensorShape({100, 100}));
+    Tensor foo(DT_FLOAT, TensorShape({100, 100}));
+    Status status = reader.LookupBatch(
+        {{"bar", std::nullopt, &bar}, {"foo", std::nullopt, &foo}}, options);
+    EXPECT_TRUE(errors::IsDataLoss(status));
+    EXPECT_TRUE(absl::StrContains(status.message(), "Checksum does not match"));
+  }
+}
+
+TEST(TensorBundleTest, IncrementalBundles) {
+  Env* env = Env::Default();
+  const Tensor frozen = Constant_100x100<float>(1);
+  {
+    BundleWriter::Options options;
+    options.fingerprint_tensors = true;
+    BundleWriter writer(env, Prefix("incremental-1"), options);
+    TF_EXPECT_OK(writer.Add("frozen", frozen));
+    TF_EXPECT_OK(writer.Add("trained", Constant_100x100<float>(2)));
+    TF_EXPECT_OK(writer.Add("strings", Constant_2x3<tstring>("foo")));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  {
+    BundleWriter::Options options;
+    options.base_prefix = Prefix("incremental-1");
+    BundleWriter writer(env, Prefix("incremental-2"), options);
+    TF_EXPECT_OK(writer.Add("frozen", frozen));
+    TF_EXPECT_OK(writer.Add("trained", Constant_100x100<float>(3)));
+    TF_EXPECT_OK(writer.Add("strings", Constant_2x3<tstring>("foo")));
+    TF_EXPECT_OK(writer.Add("new", Constant_2x3<int32>(4)));
+    EXPECT_EQ(writer.reused_bytes(), frozen.TotalBytes());
+    TF_ASSERT_OK(writer.Finish());
+  }
+  {
+    // Written in a temporary directory and merged, as by a sharded save.
+    BundleWriter::Options options;
+    options.base_prefix = Prefix("incremental-2");
+    BundleWriter writer(env, Prefix("incremental-3_temp/part-0"), options);
+    TF_EXPECT_OK(writer.Add("frozen", frozen));
+    TF_EXPECT_OK(writer.Add("trained", Constant_100x100<float>(3)));
+    EXPECT_EQ(writer.reused_bytes(), 2 * frozen.TotalBytes());
+    TF_ASSERT_OK(writer.Finish());
+    TF_ASSERT_OK(MergeBundles(env, {Prefix("incremental-3_temp/part-0")},
+                              Prefix("incremental-3")));
+  }
+
+  // Nothing changed since "incremental-2", so no data is written.
+  EXPECT_TRUE(errors::IsNotFound(
+      env->FileExists(DataFilename(Prefix("incremental-3"), 0, 1))));
+  uint64 data_size;
+  TF_ASSERT_OK(env->GetFileSize(DataFilename(Prefix("incremental-2"), 0, 1),
+                                &data_size));
+  EXPECT_LT(data_size, 2 * frozen.TotalBytes());
+
+  {
+    BundleReader reader(env, Prefix("incremental-2"));
+    TF_ASSERT_OK(reader.status());
+    Expect<float>(&reader, "frozen", frozen);
+    Expect<float>(&reader, "trained", Constant_100x100<float>(3));
+    Expect<tstring>(&reader, "strings", Constant_2x3<tstring>("foo"));
+    Expect<int32>(&reader, "new", Constant_2x3<int32>(4));
+  }
+  {
+    // Both tensors refer directly to the data files they were written to.
+    BundleReader reader(env, Prefix("incremental-3"));
+    TF_ASSERT_OK(reader.status());
+    EXPECT_EQ(AllTensorKeys(&reader),
+              std::vector<string>({"frozen", "trained"}));
+    Expect<float>(&reader, "frozen", frozen);
+    Expect<float>(&reader, "trained", Constant_100x100<float>(3));
+    EXPECT_EQ(reader.ShardFilename(1),
+              DataFilename(Prefix("incremental-1"), 0, 1));
+    EXPECT_EQ(reader.ShardFilename(2),
+              DataFilename(Prefix("incremental-2"), 0, 1));
+  }
+}
+
+TEST(TensorBundleTest, IncrementalBundleWithMissingBase) {
+  BundleWriter::Options options;
+  options.base_prefix = Prefix("nonexistent");
+  BundleWriter writer(Env::Default(), Prefix("missing_base"), options);
+  TF_ASSERT_OK(writer.status());
+  TF_EXPECT_OK(writer.Add("foo", Constant_2x3<float>(1)));
+  EXPECT_EQ(writer.reused_bytes(), 0);
+  TF_ASSERT_OK(writer.Finish());
+
+  BundleReader reader(Env::Default(), Prefix("missing_base"));
+  TF_ASSERT_OK(reader.status());
+  Expect<float>(&reader, "foo", Constant_2x3<float>(1));
+}
+
 absl::Status CreateFile(Env* env, const std::string& fname) {
   std::unique_ptr<WritableFile> file;
   TF_RETURN_IF_ERROR(env->NewWritableFile(fname, &file));
@@ -1270,6 +1457,56 @@ TEST_F(TensorBundleAlignmentTest, AlignmentTest) {
   }
 }
 
+TEST(TensorBundleTest, LookupMapped) {
+  {
+    BundleWriter::Options opts;
+    opts.data_alignment = EIGEN_MAX_ALIGN_BYTES;
+    BundleWriter writer(Env::Default(), Prefix("aligned"), opts);
+    TF_EXPECT_OK(writer.Add("float", Constant_2x3<float>(1)));
+    TF_EXPECT_OK(writer.Add("int", Constant_2x3<int32>(2)));
+    TF_EXPECT_OK(writer.Add("string", Constant_2x3<tstring>("foo")));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  {
+    BundleReader reader(Env::Default(), Prefix("aligned"));
+    TF_ASSERT_OK(reader.status());
+    Tensor val;
+    EXPECT_TRUE(reader.LookupMapped("float", &val));
+    test::ExpectTensorEqual<float>(val, Constant_2x3<float>(1));
+    EXPECT_TRUE(reader.LookupMapped("int", &val));
+    test::ExpectTensorEqual<int32>(val, Constant_2x3<int32>(2));
+    // The strings need a decoding, and are only read.
+    EXPECT_FALSE(reader.LookupMapped("string", &val));
+    EXPECT_FALSE(reader.LookupMapped("missing", &val));
+  }
+  {
+    // The mapped tensors keep the data file mapped.
+    Tensor val;
+    {
+      BundleReader reader(Env::Default(), Prefix("aligned"));
+      TF_ASSERT_OK(reader.status());
+      EXPECT_TRUE(reader.LookupMapped("int", &val));
+    }
+    test::ExpectTensorEqual<int32>(val, Constant_2x3<int32>(2));
+  }
+  {
+    BundleWriter writer(Env::Default(), Prefix("unaligned"));
+    TF_EXPECT_OK(writer.Add("a", Constant_2x3<float>(1)));
+    TF_EXPECT_OK(writer.Add("b", Constant_2x3<float>(2)));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  {
+    BundleReader reader(Env::Default(), Prefix("unaligned"));
+    TF_ASSERT_OK(reader.status());
+    Tensor val;
+    EXPECT_TRUE(reader.LookupMapped("a", &val));
+    // Stored right after "a", at an offset of 24 bytes.
+    EXPECT_FALSE(reader.LookupMapped("b", &val));
+    TF_ASSERT_OK(reader.Lookup("b", &val));
+    test::ExpectTensorEqual<float>(val, Constant_2x3<float>(2));
+  }
+}
+
 static void BM_BundleAlignment(::testing::benchmark::State& state) {
   {
     const int alignment = state.range(0);
@@ -16,10 +16,16 @@ limitations under the License.
 #include "tensorflow/core/util/work_sharder.h"
 
 #include <algorithm>
+#include <atomic>
+#include <cstdint>
 #include <functional>
 
 #include "xla/tsl/util/env_var.h"
+#include "tensorflow/core/lib/core/bits.h"
+#include "tensorflow/core/lib/hash/hash.h"
+#include "tensorflow/core/lib/monitoring/sampler.h"
 #include "tensorflow/core/platform/blocking_counter.h"
+#include "tensorflow/core/platform/env_time.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tsl/profiler/lib/traceme.h"
 
@@ -43,8 +49,125 @@ bool UseEigenParallelFor() {
   return result;
 }
 
+std::atomic<bool>& AdaptiveWorkSharding() {
+  static std::atomic<bool>* enabled = []() {
+    bool result = false;
+    if (!tsl::ReadBoolFromEnvVar("TF_ADAPTIVE_WORK_SHARDING",
+                                 /*default_val=*/false, &result)
+             .ok()) {
+      result = false;
+    }
+    return new std::atomic<bool>(result);
+  }();
+  return *enabled;
+}
+
+// The measured cost per unit of the Shard() calls with a given hinted cost per
+// unit and a given power of two of units. The table is lossy: calls whose keys
+// collide overwrite each other's cost, which is only a performance hint.
+struct MeasuredCost {
+  std::atomic<uint64_t> key{0};
+  std::atomic<int64_t> cost_per_unit{0};
+};
+
+constexpr int kNumMeasuredCosts = 1024;
+
+// A Shard() call measures the cost of its work if none was measured for its
+// key yet, and otherwise once every kMeasurementPeriod calls of its thread.
+constexpr int kMeasurementPeriod = 16;
+
+MeasuredCost& GetMeasuredCost(uint64_t key) {
+  static MeasuredCost* measured_costs = new MeasuredCost[kNumMeasuredCosts];
+  return measured_costs[key % kNumMeasuredCosts];
+}
+
+void RecordCostPerUnit(const char* source, int64_t cost_per_unit) {
+  static auto* cost_per_unit_sampler = monitoring::Sampler<1>::New(
+      {"/tensorflow/core/work_sharder_cost_per_unit",
+       "The hinted and the measured costs per unit of the adaptively sharded "
+       "work.",
+       "source"},
+      {monitoring::Buckets::Exponential(1, 4, 16)});
+  cost_per_unit_sampler->GetCell(source)->Add(cost_per_unit);
+}
+
+void ShardWithCost(int max_parallelism, thread::ThreadPool* workers,
+                   int64_t total, int64_t cost_per_unit,
+                   const std::function<void(int64_t, int64_t)>& work) {
+  if (UseEigenParallelFor() && max_parallelism >= workers->NumThreads()) {
+    tsl::profiler::TraceMe trace_me([=, num_threads = workers->NumThreads()]() {
+      return tsl::profiler::TraceMeEncode("ParallelFor",
+                                          {{"cost_per_unit", cost_per_unit},
+                                           {"total", total},
+                                           {"max_parallelism", max_parallelism},
+                                           {"num_threads", num_threads}});
+    });
+    workers->ParallelFor(total, cost_per_unit, work);
+    return;
+  }
+  Sharder::Do(
+      total, cost_per_unit, work,
+      [&workers](Sharder::Closure c) { workers->Schedule(c); },
+      max_parallelism);
+}
+
+// Shards the work with the cost per unit measured by the previous calls with
+// the same key, if any, and measures the cost of this call from time to time.
+void ShardAdaptively(int max_parallelism, thread::ThreadPool* workers,
+                     int64_t total, int64_t cost_per_unit,
+                     const std::function<void(int64_t, int64_t)>& work) {
+  static thread_local int num_calls = 0;
+  // Zero marks the unused entries.
+  const uint64_t key =
+      Hash64Combine(cost_per_unit, Log2Floor64(total)) | uint64_t{1};
+  MeasuredCost& measured_cost = GetMeasuredCost(key);
+  int64_t measured_cost_per_unit = 0;
+  if (measured_cost.key.load(std::memory_order_relaxed) == key) {
+    measured_cost_per_unit =
+        measured_cost.cost_per_unit.load(std::memory_order_relaxed);
+  }
+  const bool measure =
+      measured_cost_per_unit <= 0 || ++num_calls % kMeasurementPeriod == 0;
+  const int64_t chosen_cost_per_unit =
+      measured_cost_per_unit > 0 ? measured_cost_per_unit : cost_per_unit;
+  if (!measure) {
+    ShardWithCost(max_parallelism, workers, total, chosen_cost_per_unit, work);
+    return;
+  }
+
+  // The cost units are assumed to be nanoseconds, as in Sharder::Do().
+  std::atomic<int64_t> elapsed_nanos{0};
+  ShardWithCost(max_parallelism, workers, total, chosen_cost_per_unit,
+                [&work, &elapsed_nanos](int64_t start, int64_t limit) {
+                  const uint64_t start_nanos = EnvTime::NowNanos();
+                  work(start, limit);
+                  elapsed_nanos.fetch_add(EnvTime::NowNanos() - start_nanos,
+                                          std::memory_order_relaxed);
+                });
+  int64_t new_cost_per_unit =
+      std::max<int64_t>(1, elapsed_nanos.load(std::memory_order_relaxed) /
+                               total);
+  if (measured_cost_per_unit > 0) {
+    // Smooths the measurements, which vary with the load of the machine.
+    new_cost_per_unit = (3 * measured_cost_per_unit + new_cost_per_unit) / 4;
+  }
+  measured_cost.cost_per_unit.store(new_cost_per_unit,
+                                    std::memory_order_relaxed);
+  measured_cost.key.store(key, std::memory_order_relaxed);
+  RecordCostPerUnit("hinted", cost_per_unit);
+  RecordCostPerUnit("measured", new_cost_per_unit);
+}
+
 }  // namespace
 
+void SetAdaptiveWorkSharding(bool enabled) {
+  AdaptiveWorkSharding().store(enabled, std::memory_order_relaxed);
+}
+
+bool IsAdaptiveWorkShardingEnabled() {
+  return AdaptiveWorkSharding().load(std::memory_order_relaxed);
+}
+
 /* ABSL_CONST_INIT */ thread_local int per_thread_max_parallelism = 1000000;
 
 void SetPerThreadMaxParallelism(int max_parallelism) {
@@ -66,21 +189,11 @@ void Shard(int max_parallelism, thread::ThreadPool* workers, int64_t total,
     work(0, total);
     return;
   }
-  if (UseEigenParallelFor() && max_parallelism >= workers->NumThreads()) {
-    tsl::profiler::TraceMe trace_me([=, num_threads = workers->NumThreads()]() {
-      return tsl::profiler::TraceMeEncode("ParallelFor",
-                                          {{"cost_per_unit", cost_per_unit},
-                                           {"total", total},
-                                           {"max_parallelism", max_parallelism},
-                                           {"num_threads", num_threads}});
-    });
-    workers->ParallelFor(total, cost_per_unit, work);
+  if (IsAdaptiveWorkShardingEnabled()) {
+    ShardAdaptively(max_parallelism, workers, total, cost_per_unit, work);
     return;
   }
-  Sharder::Do(
-      total, cost_per_unit, work,
-      [&workers](Sharder::Closure c) { workers->Schedule(c); },
-      max_parallelism);
+  ShardWithCost(max_parallelism, workers, total, cost_per_unit, work);
 }
 
 // DEPRECATED: Prefer threadpool->ParallelFor with SchedulingStrategy, which
@@ -70,6 +70,14 @@ void Shard(int max_parallelism, thread::ThreadPool* workers, int64_t total,
 void SetPerThreadMaxParallelism(int max_parallelism);
 int GetPerThreadMaxParallelism();
 
+// Enables or disables the adaptive cost model of Shard(). When it is enabled,
+// Shard() measures the actual cost per unit of the work it runs, and uses it
+// instead of "cost_per_unit" in the later calls with the same "cost_per_unit"
+// and a similar "total". Its default is the value of the environment variable
+// TF_ADAPTIVE_WORK_SHARDING, which is false if unset.
+void SetAdaptiveWorkSharding(bool enabled);
+bool IsAdaptiveWorkShardingEnabled();
+
 // Helper to set and unset per-thread max parallelism.
 class ScopedPerThreadMaxParallelism {
  public:
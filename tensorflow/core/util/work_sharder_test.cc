@@ -93,6 +93,37 @@ TEST(Shard, OverflowTest) {
   }
 }
 
+TEST(Shard, Adaptive) {
+  SetAdaptiveWorkSharding(true);
+  thread::ThreadPool threads(Env::Default(), "test", 16);
+  for (auto total : {1, 7, 100, 1000}) {
+    for (auto maxp : {2, 4, 100}) {
+      ScopedPerThreadMaxParallelism s(maxp);
+      RunSharding(16, total, /*cost_per_unit=*/1003, maxp, &threads);
+    }
+  }
+
+  // The overestimated cost of the cheap work makes the first call shard it,
+  // and the measured cost makes the later calls run it inline.
+  const int64_t total = 1000;
+  const int64_t cost_per_unit = 1000007;
+  auto num_shards = [&]() {
+    std::atomic<int> num_shards(0);
+    std::atomic<int64_t> num_elements(0);
+    Shard(/*max_parallelism=*/4, &threads, total, cost_per_unit,
+          [&](int64_t start, int64_t limit) {
+            ++num_shards;
+            num_elements += limit - start;
+          });
+    EXPECT_EQ(num_elements.load(), total);
+    return num_shards.load();
+  };
+  EXPECT_EQ(num_shards(), 4);
+  EXPECT_EQ(num_shards(), 1);
+  SetAdaptiveWorkSharding(false);
+  EXPECT_EQ(num_shards(), 4);
+}
+
 void BM_Sharding(::testing::benchmark::State& state) {
   const int arg = state.range(0);
 
@@ -1595,7 +1595,6 @@ DTensorDevice::DTensorOperationToModule(
   FunctionLibraryDefinition* flib_def =
       tensorflow::unwrap(context)->FuncLibDef();
   DTensorOperationLoweringContext result;
-  result.graph = std::make_unique<tensorflow::Graph>(flib_def);
 
   const FunctionDef* function_def = doperation.function_def;
   // Output layouts must be inferred before cache
@@ -1606,7 +1605,7 @@ DTensorDevice::DTensorOperationToModule(
   {
     mutex_lock lock(mu_default_layout_);
     TF_RETURN_IF_ERROR(InferOutputLayouts(doperation, eager_attributes,
-                                          default_layout_, result.graph.get(),
+                                          default_layout_, *flib_def,
                                           &result.output_layouts));
 
     TF_ASSIGN_OR_RETURN(
@@ -1627,6 +1626,10 @@ DTensorDevice::DTensorOperationToModule(
               << ". DTensor is (re-)computing its SPMD transformation.";
   }
 
+  // The graph is only built on a cache miss, it is replaced by the lowered
+  // graph afterwards.
+  result.graph = std::make_unique<tensorflow::Graph>(flib_def);
+
   // It includes remote devices when the coordination service is enabled.
   result.tf_devices = tensorflow::unwrap(context)->ListAllTfDevices();
   DeviceSet device_set;
@@ -2547,11 +2550,25 @@ bool DTensorDevice::ShouldFastExecuteEagerPureOperation(
     const std::vector<TensorWithLayout*>& typed_inputs,
     const TFE_OpAttrs* attributes) {
   if (dtensor_operation.is_func() || !dtensor_operation.is_pure() ||
-      mesh.IsSingleDevice() || mesh.is_remote() ||
+      mesh.is_remote() ||
       // TODO(b/287529295): Disable this shortcut for TPU for now.
       mesh.is_tpu_mesh()) {
     return false;
   }
+  // The SPMD expansion of an op on a single device mesh is the op itself, so
+  // it runs as is on the device.
+  if (mesh.IsSingleDevice()) {
+    if (IsRelayoutOp(dtensor_operation) || default_layout_.has_value()) {
+      return false;
+    }
+    for (auto typed_input : typed_inputs) {
+      if (typed_input->tensor_type() != TensorType::kDense ||
+          typed_input->layout().mesh() != mesh) {
+        return false;
+      }
+    }
+    return true;
+  }
   if (IsRelayoutOp(dtensor_operation)) {
     auto layout = FetchLayoutFromAttributes(attributes, kQualifiedLayoutAttr);
     if (typed_inputs.empty()) {  // Missing Inputs.
@@ -2605,7 +2622,9 @@ void DTensorDevice::FastExecuteEagerPureOperation(
     const std::vector<TensorWithLayout*>& typed_inputs,
     const TFE_OpAttrs* attributes, std::vector<TensorHandlePtr>& outputs,
     TF_Status* status) {
-  std::string device_name = std::string{mesh.local_devices()[0]};
+  std::string device_name = mesh.IsSingleDevice()
+                                ? std::string{mesh.single_device()}
+                                : std::string{mesh.local_devices()[0]};
   std::vector<TFE_TensorHandle*> single_device_inputs;
   single_device_inputs.reserve(num_inputs);
   const char* operation_name = dtensor_operation.name;
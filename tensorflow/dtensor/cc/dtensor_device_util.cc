@@ -346,11 +346,15 @@ StatusOr<std::vector<std::vector<int64_t>>> GetAllTensorShapes(
 }
 
 tensorflow::Fprint128 TensorWithLayoutTf::CacheKey() const {
-  tensorflow::Fprint128 f = tensorflow::Fingerprint128(layout_.ToString());
-  // Use exact shape to compute the key.
-  for (const int64_t dim : local_shape_) {
-    f = FingerprintCat128(f, dim);
+  if (!layout_and_shape_fingerprint_.has_value()) {
+    tensorflow::Fprint128 f = tensorflow::Fingerprint128(layout_.ToString());
+    // Use exact shape to compute the key.
+    for (const int64_t dim : local_shape_) {
+      f = FingerprintCat128(f, dim);
+    }
+    layout_and_shape_fingerprint_ = f;
   }
+  tensorflow::Fprint128 f = *layout_and_shape_fingerprint_;
   if (const_value_node_->const_value().has_value()) {
     std::string serialized;
     SerializeToStringDeterministic(const_value_node_->const_value().value(),
@@ -727,9 +731,8 @@ StatusOr<bool> ExecutableManager<ExecutionFunctions>::ShouldFoldInput(
 Status InferOutputLayouts(const DTensorOperation& doperation,
                           const NameAttrList& attributes,
                           const std::optional<Layout>& default_layout,
-                          tensorflow::Graph* graph,
+                          const tensorflow::FunctionLibraryDefinition& flib_def,
                           std::vector<const Layout*>* output_layouts) {
-  tensorflow::Status status;
   tensorflow::NodeDef op_node_def;
   op_node_def.set_op(doperation.name);
   op_node_def.set_name("eager_operation");
@@ -737,13 +740,14 @@ Status InferOutputLayouts(const DTensorOperation& doperation,
   op_node_def.mutable_attr()->insert(attributes.attr().begin(),
                                      attributes.attr().end());
 
-  tensorflow::Node* op_node = graph->AddNode(op_node_def, &status);
-  TF_RETURN_IF_ERROR(status);
+  const OpDef* op_def = nullptr;
+  TF_RETURN_IF_ERROR(flib_def.LookUpOpDef(doperation.name, &op_def));
+  int num_outputs = 0;
+  TF_RETURN_IF_ERROR(NumOutputsForNode(op_node_def, *op_def, &num_outputs));
 
   output_layouts->clear();
-  output_layouts->reserve(op_node->num_outputs());
-  for (int output_index = 0; output_index < op_node->num_outputs();
-       ++output_index) {
+  output_layouts->reserve(num_outputs);
+  for (int output_index = 0; output_index < num_outputs; ++output_index) {
     const Layout* layout = nullptr;
     if (default_layout.has_value() && output_index == 0) {
       // Record the user's requested output layout. The scope currently only
@@ -752,7 +756,6 @@ Status InferOutputLayouts(const DTensorOperation& doperation,
     }
     output_layouts->push_back(layout);
   }
-  graph->RemoveNode(op_node);
   return absl::OkStatus();
 }
 
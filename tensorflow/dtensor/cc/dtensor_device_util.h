@@ -255,6 +255,11 @@ class TensorWithLayoutTf
   std::optional<TF_DataType> dtype_;
 
   std::unique_ptr<ConstValueNode> const_value_node_;
+
+  // The fingerprint of `layout_` and `local_shape_`, computed by the first
+  // call to CacheKey as the tensor is usually the input of several ops.
+  // CacheKey is only called under the lock of the DTensor device.
+  mutable std::optional<tensorflow::Fprint128> layout_and_shape_fingerprint_;
 };
 
 // Extension of TensorWithLayout which holds resource handle with layout.
@@ -580,10 +585,13 @@ StatusOr<std::vector<int64_t>> GetTensorShapeAsVector(
 // Returns the shape of a given tensor.
 StatusOr<std::vector<int64_t>> GetTensorShapeAsVector(TFE_TensorHandle* tensor);
 
+// Sets `output_layouts` to the layouts requested for the outputs of
+// `doperation`, or nullptr. The op or function is looked up in `flib_def`
+// without building a graph, as this runs before every cache lookup.
 Status InferOutputLayouts(const DTensorOperation& doperation,
                           const NameAttrList& attributes,
                           const std::optional<Layout>& default_layout,
-                          tensorflow::Graph* graph,
+                          const tensorflow::FunctionLibraryDefinition& flib_def,
                           std::vector<const Layout*>* output_layouts);
 // Creates a Graph with _Arg and _Retval nodes surrounding an
 // `operation_name`-type node.
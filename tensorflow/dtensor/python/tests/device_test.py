@@ -439,6 +439,23 @@ class DTensorDeviceTest(test_util.DTensorBaseTest, parameterized.TestCase):
     self.assertTrue(api.is_dtensor(b))
     self.assertEqual(api.fetch_layout(b).mesh, cpu0_mesh)
 
+  def testSingleDeviceMeshPureOps(self):
+    cpu0_mesh = Mesh.from_device("/job:localhost/replica:0/task:0/device:CPU:0")
+    with api.default_mesh(cpu0_mesh):
+      a = array_ops.ones(shape=(3, 3))
+      b = math_ops.add(a, a)
+      c = math_ops.matmul(b, a)
+      rows = array_ops.split(c, num_or_size_splits=3, axis=0)
+
+    for t in [b, c] + rows:
+      self.assertTrue(api.is_dtensor(t))
+      self.assertEqual(api.fetch_layout(t).mesh, cpu0_mesh)
+    self.assertAllClose(b.numpy(), np.full((3, 3), 2.0))
+    self.assertAllClose(c.numpy(), np.full((3, 3), 6.0))
+    self.assertLen(rows, 3)
+    for row in rows:
+      self.assertAllClose(row.numpy(), np.full((1, 3), 6.0))
+
   def testUnsupportedOpReplicatedInput(self):
     with api.default_mesh(self.mesh):
       t = array_ops.ones(shape=(8, 3))
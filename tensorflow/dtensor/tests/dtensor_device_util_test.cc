@@ -0,0 +1,114 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/dtensor/cc/dtensor_device_util.h"
+
+#include <optional>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/attr_value_util.h"
+#include "tensorflow/core/framework/function.h"
+#include "tensorflow/core/framework/function.pb.h"
+#include "tensorflow/core/framework/op.h"
+#include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/dtensor/cc/dtensor_operation.h"
+#include "tensorflow/dtensor/cc/tensor_layout.h"
+
+namespace tensorflow {
+namespace dtensor {
+namespace {
+
+REGISTER_OP("TwoOutputs").Output("a: float").Output("b: float");
+
+REGISTER_OP("ListOutputs").Output("out: N * float").Attr("N: int");
+
+class InferOutputLayoutsTest : public ::testing::Test {
+ protected:
+  InferOutputLayoutsTest()
+      : flib_def_(OpRegistry::Global(), FunctionDefLibrary()) {}
+
+  Layout ReplicatedLayout() {
+    return Layout::FromString(
+               "sharding_specs:unsharded, mesh:|x=2|0,1|0,1|"
+               "/job:localhost/task:0/device:CPU:0,"
+               "/job:localhost/task:0/device:CPU:1")
+        .value();
+  }
+
+  FunctionLibraryDefinition flib_def_;
+};
+
+TEST_F(InferOutputLayoutsTest, OneLayoutPerOutput) {
+  DTensorOperation op{"TwoOutputs", nullptr, {}, {}};
+  std::vector<const Layout*> output_layouts;
+  ASSERT_TRUE(InferOutputLayouts(op, NameAttrList(), std::nullopt, flib_def_,
+                                 &output_layouts)
+                  .ok());
+  ASSERT_EQ(output_layouts.size(), 2);
+  EXPECT_EQ(output_layouts[0], nullptr);
+  EXPECT_EQ(output_layouts[1], nullptr);
+}
+
+TEST_F(InferOutputLayoutsTest, ListOutputsUseAttributes) {
+  DTensorOperation op{"ListOutputs", nullptr, {}, {}};
+  NameAttrList attributes;
+  SetAttrValue(3, &(*attributes.mutable_attr())["N"]);
+  std::vector<const Layout*> output_layouts;
+  ASSERT_TRUE(InferOutputLayouts(op, attributes, std::nullopt, flib_def_,
+                                 &output_layouts)
+                  .ok());
+  EXPECT_EQ(output_layouts.size(), 3);
+}
+
+TEST_F(InferOutputLayoutsTest, DefaultLayoutAppliesToFirstOutput) {
+  DTensorOperation op{"TwoOutputs", nullptr, {}, {}};
+  const std::optional<Layout> default_layout = ReplicatedLayout();
+  std::vector<const Layout*> output_layouts;
+  ASSERT_TRUE(InferOutputLayouts(op, NameAttrList(), default_layout, flib_def_,
+                                 &output_layouts)
+                  .ok());
+  ASSERT_EQ(output_layouts.size(), 2);
+  EXPECT_EQ(output_layouts[0], &default_layout.value());
+  EXPECT_EQ(output_layouts[1], nullptr);
+}
+
+TEST_F(InferOutputLayoutsTest, FunctionOutputs) {
+  FunctionDef fdef = FunctionDefHelper::Create(
+      "TwoIdentities", {"x: float"}, {"a: float", "b: float"}, {},
+      {{{"i"}, "Identity", {"x"}, {{"T", DT_FLOAT}}}},
+      {{"a", "i:output:0"}, {"b", "i:output:0"}});
+  ASSERT_TRUE(flib_def_.AddFunctionDef(fdef).ok());
+
+  DTensorOperation op{"TwoIdentities", &fdef, {}, {}};
+  std::vector<const Layout*> output_layouts;
+  ASSERT_TRUE(InferOutputLayouts(op, NameAttrList(), std::nullopt, flib_def_,
+                                 &output_layouts)
+                  .ok());
+  EXPECT_EQ(output_layouts.size(), 2);
+}
+
+TEST_F(InferOutputLayoutsTest, UnknownOp) {
+  DTensorOperation op{"NotARegisteredOp", nullptr, {}, {}};
+  std::vector<const Layout*> output_layouts;
+  EXPECT_FALSE(InferOutputLayouts(op, NameAttrList(), std::nullopt, flib_def_,
+                                  &output_layouts)
+                   .ok());
+}
+
+}  // namespace
+}  // namespace dtensor
+}  // namespace tensorflow
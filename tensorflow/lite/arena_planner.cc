@@ -333,6 +333,50 @@ TfLiteStatus ArenaPlanner::PlanAllocations() {
   }
   // Note that graph outputs will never be scheduled for deallocation. We
   // could do that here for completeness, but it won't have any effect.
+
+  level_dealloc_node_.clear();
+  if (execute_node_levels_concurrently_ && !preserve_all_tensors_) {
+    // The nodes of a level may run in any order, so a tensor must outlive all
+    // the nodes of the levels up to the highest level of its readers. Two
+    // tensors which are both alive during a level then overlap at the last
+    // node of the levels up to that level, and don't share memory.
+    const std::vector<int> levels = GetNodeLevels(*graph_info_);
+    std::vector<int32_t> last_node_of_levels;
+    for (size_t i = 0; i < num_execution_nodes; ++i) {
+      if (static_cast<size_t>(levels[i]) >= last_node_of_levels.size()) {
+        last_node_of_levels.resize(levels[i] + 1, 0);
+      }
+      last_node_of_levels[levels[i]] = i;
+    }
+    for (size_t level = 1; level < last_node_of_levels.size(); ++level) {
+      last_node_of_levels[level] =
+          std::max(last_node_of_levels[level], last_node_of_levels[level - 1]);
+    }
+    std::vector<int> last_read_level(num_tensors, -1);
+    for (size_t i = 0; i < num_execution_nodes; ++i) {
+      TfLiteIntArray* node_inputs = graph_info_->node(i).inputs;
+      for (int j = 0; j < node_inputs->size; ++j) {
+        int tensor_index = node_inputs->data[j];
+        if (tensor_index == kTfLiteOptionalTensor) continue;
+        tensor_index = FindSharedTensor(tensor_index);
+        last_read_level[tensor_index] =
+            std::max(last_read_level[tensor_index], levels[i]);
+      }
+    }
+    for (size_t tensor_index = 0; tensor_index < num_tensors; ++tensor_index) {
+      if (dealloc_node_[tensor_index] == kNodeNotAssigned ||
+          last_read_level[tensor_index] < 0) {
+        continue;
+      }
+      dealloc_node_[tensor_index] =
+          std::max(dealloc_node_[tensor_index],
+                   last_node_of_levels[last_read_level[tensor_index]]);
+    }
+    level_dealloc_node_.resize(num_execution_nodes);
+    for (size_t i = 0; i < num_execution_nodes; ++i) {
+      level_dealloc_node_[i] = last_node_of_levels[levels[i]];
+    }
+  }
   return kTfLiteOk;
 }
 
@@ -355,7 +399,8 @@ TfLiteStatus ArenaPlanner::ExecuteAllocations(int first_node, int last_node) {
       alloc_node_[tensor_index] = i;
       nodes_to_tensors_[i].insert(tensor_index);
       if (!preserve_all_tensors_) {
-        dealloc_node_[tensor_index] = i;
+        dealloc_node_[tensor_index] =
+            i < level_dealloc_node_.size() ? level_dealloc_node_[i] : i;
       }
     }
   }
@@ -509,7 +554,8 @@ TfLiteStatus ArenaPlanner::CalculateAllocations(
     last_active_node_ = last_node;
     return kTfLiteOk;
   }
-  if (first_node < last_active_node_) {
+  const bool arena_reset = first_node < last_active_node_;
+  if (arena_reset) {
     arena_.ResetAllocs();
     last_active_node_ = first_node;
   } else {
@@ -518,6 +564,9 @@ TfLiteStatus ArenaPlanner::CalculateAllocations(
     arena_.PurgeActiveAllocs(first_node);
   }
   CreateTensorAllocationVector(tensors_allocated);
+  // The kTfLiteArenaRw tensors to allocate, in allocation order.
+  std::vector<int32_t> arena_tensors;
+  arena_tensors.reserve(tensors_allocated->size());
   // Vector of ids of already allocated tensors, ordered by offset.
   for (const auto& tensor_index : *tensors_allocated) {
     TfLiteTensor& tensor = tensors[tensor_index];
@@ -541,10 +590,7 @@ TfLiteStatus ArenaPlanner::CalculateAllocations(
       }
     }
     if (tensor.allocation_type == kTfLiteArenaRw) {
-      TF_LITE_ENSURE_STATUS(
-          arena_.Allocate(context_, tensor_alignment_, tensor.bytes,
-                          tensor_index, alloc_node_[tensor_index],
-                          dealloc_node_[tensor_index], &allocs_[tensor_index]));
+      arena_tensors.push_back(tensor_index);
     }
     // Check allocs_[].size to prevent from reallocation of persistent tensors.
     // Only allocate ArenaRwPersistent tensors which own their buffer.
@@ -559,10 +605,70 @@ TfLiteStatus ArenaPlanner::CalculateAllocations(
       }
     }
   }
+  if (minimize_arena_size_ && arena_reset) {
+    TF_LITE_ENSURE_STATUS(OrderToMinimizeArenaSize(&arena_tensors));
+  }
+  for (const auto& tensor_index : arena_tensors) {
+    TF_LITE_ENSURE_STATUS(arena_.Allocate(
+        context_, tensor_alignment_, tensors[tensor_index].bytes, tensor_index,
+        alloc_node_[tensor_index], dealloc_node_[tensor_index],
+        &allocs_[tensor_index]));
+  }
   last_active_node_ = last_node;
   return kTfLiteOk;
 }
 
+TfLiteStatus ArenaPlanner::OrderToMinimizeArenaSize(
+    std::vector<int32_t>* tensors_to_allocate) {
+  const TfLiteTensor* tensors = graph_info_->tensors();
+  const int64_t num_nodes = graph_info_->num_execution_nodes();
+  auto lifetime = [&](int idx) -> int64_t {
+    return std::min<int64_t>(dealloc_node_[idx], num_nodes) -
+           alloc_node_[idx] + 1;
+  };
+  // The tensors alive during the whole inference stay at the beginning of the
+  // arena, as in `CreateTensorAllocationVector`.
+  const auto others = std::find_if(
+      tensors_to_allocate->begin(), tensors_to_allocate->end(), [&](int idx) {
+        return alloc_node_[idx] != 0 || dealloc_node_[idx] != kNodeNotAssigned;
+      });
+  const auto num_first = others - tensors_to_allocate->begin();
+
+  std::vector<std::vector<int32_t>> orders(4, *tensors_to_allocate);
+  std::stable_sort(orders[1].begin() + num_first, orders[1].end(),
+                   [&](int idx1, int idx2) {
+                     return tensors[idx1].bytes * lifetime(idx1) >
+                            tensors[idx2].bytes * lifetime(idx2);
+                   });
+  std::stable_sort(orders[2].begin() + num_first, orders[2].end(),
+                   [&](int idx1, int idx2) {
+                     return lifetime(idx1) > lifetime(idx2);
+                   });
+  std::stable_sort(orders[3].begin() + num_first, orders[3].end(),
+                   [&](int idx1, int idx2) {
+                     return alloc_node_[idx1] < alloc_node_[idx2];
+                   });
+
+  size_t best_size = std::numeric_limits<size_t>::max();
+  int best_order = 0;
+  for (int i = 0; i < orders.size(); ++i) {
+    SimpleMemoryArena arena(kDefaultArenaAlignment);
+    ArenaAllocWithUsageInterval alloc;
+    for (const auto& tensor_index : orders[i]) {
+      TF_LITE_ENSURE_STATUS(arena.Allocate(
+          context_, tensor_alignment_, tensors[tensor_index].bytes,
+          tensor_index, alloc_node_[tensor_index], dealloc_node_[tensor_index],
+          &alloc));
+    }
+    if (arena.GetRequiredBufferSize() < best_size) {
+      best_size = arena.GetRequiredBufferSize();
+      best_order = i;
+    }
+  }
+  *tensors_to_allocate = std::move(orders[best_order]);
+  return kTfLiteOk;
+}
+
 bool AreTensorsAllocatedInSameArena(int32_t root_tensor_index,
                                     int32_t tensor_index,
                                     const TfLiteTensor* tensors) {
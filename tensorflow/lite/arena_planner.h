@@ -72,6 +72,22 @@ class ArenaPlanner : public MemoryPlanner {
   // Returns the base arena location for a given allocation type.
   std::intptr_t BasePointer(TfLiteAllocationType type);
 
+  // If `value` is true, the allocations are planned so that the nodes of each
+  // level of the execution plan, see `GetNodeLevels`, may be executed
+  // concurrently: a tensor is only deallocated after the last node of the
+  // levels up to the highest level of the nodes reading it. This must be set
+  // before `PlanAllocations` is called.
+  void SetExecuteNodeLevelsConcurrently(bool value) {
+    execute_node_levels_concurrently_ = value;
+  }
+
+  // If `value` is true, when all the tensors are allocated at once their
+  // offsets in the arena are calculated in a few orders: by size (the
+  // default), by size times lifetime, by lifetime and by allocation time.
+  // The order needing the smallest arena is kept, at the cost of planning
+  // the allocations once per order.
+  void SetMinimizeArenaSize(bool value) { minimize_arena_size_ = value; }
+
  private:
   // Check whether the input tensor's memory may be shared the output tensor.
   // tensor_changed: true if the output tensor modifies the tensor data. For
@@ -99,6 +115,13 @@ class ArenaPlanner : public MemoryPlanner {
   // `first_node` and `last_node`.
   std::vector<int32_t> GetTensorsToAllocate(int first_node, int last_node);
 
+  // Reorders the kTfLiteArenaRw tensors `tensors_to_allocate`, ordered by
+  // `CreateTensorAllocationVector` and about to be allocated in an empty
+  // arena_, into the order needing the smallest arena among the orders of
+  // `SetMinimizeArenaSize`.
+  TfLiteStatus OrderToMinimizeArenaSize(
+      std::vector<int32_t>* tensors_to_allocate);
+
   // Traverse the allocation queue and reserve space in the appropriate arena
   // for all tensors affected by ops in the interval [first_node, last_node].
   TfLiteStatus CalculateAllocations(int first_node, int last_node,
@@ -166,6 +189,17 @@ class ArenaPlanner : public MemoryPlanner {
 
   // Store number of references to each tensor.
   std::vector<int> refcounts_;
+
+  // See `SetExecuteNodeLevelsConcurrently`.
+  bool execute_node_levels_concurrently_ = false;
+
+  // See `SetMinimizeArenaSize`.
+  bool minimize_arena_size_ = false;
+
+  // If `execute_node_levels_concurrently_`, the last node of the levels up to
+  // the level of each node, which is when the node's temporaries can be
+  // deallocated.
+  std::vector<int32_t> level_dealloc_node_;
 };
 
 }  // namespace tflite
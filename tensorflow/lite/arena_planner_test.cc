@@ -1003,6 +1003,77 @@ TEST_F(ArenaPlannerTest, ComplexGraph) {
   EXPECT_EQ(GetOffset(8), 32);
 }
 
+TEST_F(ArenaPlannerTest, ConcurrentNodeLevels) {
+  TestGraph graph({0},
+                  {
+                      /* in, out, tmp */
+                      {{0}, {1}, {}},      // Level 0.
+                      {{0}, {2}, {}},      // Level 0.
+                      {{1}, {3}, {6}},     // Level 1.
+                      {{2}, {4}, {7}},     // Level 1.
+                      {{3, 4}, {5}, {}},   // Level 2.
+                  },
+                  {5});
+  graph_ = &graph;
+  context_.ReportError = ReportError;
+  planner_ = std::make_unique<ArenaPlanner>(
+      &context_, std::unique_ptr<GraphInfo>(new TestGraphInfo(&graph)),
+      /*preserve_all_tensors=*/false, kTensorAlignment);
+  planner_->SetExecuteNodeLevelsConcurrently(true);
+  CHECK(planner_->ResetAllocations() == kTfLiteOk);
+  CHECK(planner_->PlanAllocations() == kTfLiteOk);
+  Execute(0, graph.nodes().size() - 1);
+
+  auto overlap = [this](int a, int b) {
+    return GetOffset(a) < GetOffsetAfter(b) && GetOffset(b) < GetOffsetAfter(a);
+  };
+  // The tensors read or written by the nodes of each level don't share memory.
+  const std::vector<std::vector<int>> tensors_of_levels = {
+      {0, 1, 2}, {1, 2, 3, 4, 6, 7}, {3, 4, 5}};
+  for (const std::vector<int>& tensors : tensors_of_levels) {
+    for (int a : tensors) {
+      for (int b : tensors) {
+        if (a != b) {
+          EXPECT_FALSE(overlap(a, b)) << a << " " << b;
+        }
+      }
+    }
+  }
+}
+
+TEST_F(ArenaPlannerTest, MinimizeArenaSize) {
+  for (bool minimize_arena_size : {false, true}) {
+    TestGraph graph({},
+                    {
+                        /* in, out, tmp */
+                        {{}, {2}, {}, kTfLiteBuiltinAdd, kTfLiteInplaceOpNone},
+                        {{2}, {1}, {}, kTfLiteBuiltinAdd, kTfLiteInplaceOpNone},
+                        {{}, {3}, {}, kTfLiteBuiltinAdd, kTfLiteInplaceOpNone},
+                        {{1, 3},
+                         {4},
+                         {},
+                         kTfLiteBuiltinAdd,
+                         kTfLiteInplaceOpNone},
+                        {{4}, {}, {}, kTfLiteBuiltinAdd, kTfLiteInplaceOpNone},
+                    },
+                    {});
+    (*graph.tensors())[1].bytes = 32;
+    (*graph.tensors())[2].bytes = 32;
+    (*graph.tensors())[3].bytes = 16;
+    (*graph.tensors())[4].bytes = 28;
+    SetGraph(&graph);
+    planner_->SetMinimizeArenaSize(minimize_arena_size);
+    Execute(0, graph.nodes().size() - 1);
+
+    // By size, 2 goes at offset 0, 1 at 32 and 4 at 0, where 2 was, leaving
+    // 3 no room before 64. By size times lifetime, 1 goes at 0, 2 and 4 at 32
+    // and 3 at 60.
+    size_t arena_size, arena_persist_size;
+    planner_->GetAllocInfo(&arena_size, &arena_persist_size);
+    EXPECT_EQ(arena_size, minimize_arena_size ? 76 : 80);
+  }
+}
+
 TEST_F(ArenaPlannerTest, GraphWithIntermediates) {
   TestGraph graph({0, 1},
                   {
@@ -17,10 +17,12 @@ limitations under the License.
 
 #include <atomic>
 #include <map>
+#include <memory>
 #include <vector>
 
 #include "tensorflow/lite/core/async/async_kernel_internal.h"
 #include "tensorflow/lite/core/async/c/types.h"
+#include "tensorflow/lite/core/async/cpu_async_kernel.h"
 #include "tensorflow/lite/core/async/interop/c/types.h"
 #include "tensorflow/lite/core/c/c_api_types.h"
 #include "tensorflow/lite/core/c/common.h"
@@ -34,6 +36,8 @@ class AsyncSubgraphTestPeer;
 
 // AsyncSubgraph class manages to dispatch I/O information and
 // schedule executions to underlying delegate kernels.
+// If the subgraph isn't fully delegated to 1 backend with an async kernel, the
+// executions run on the CPU with `CpuAsyncKernel`.
 // TODO(b/191883048): Currently we require either `AllocateTensors` or
 // `EnsureTensorAllocation` called to ensure the backend kernels are prepared.
 // However, we don't need to allocate the CPU memory for input / output tensors.
@@ -190,6 +194,9 @@ class AsyncSubgraph {
   // Not owned.
   mutable TfLiteAsyncKernel* async_kernel_ = nullptr;
   TfLiteOpaqueNode* opaque_node_ = nullptr;
+
+  // The kernel used when no backend provides one.
+  std::unique_ptr<CpuAsyncKernel> cpu_async_kernel_;
 };
 
 }  // namespace async
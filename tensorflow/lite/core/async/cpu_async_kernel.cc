@@ -0,0 +1,283 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/core/async/cpu_async_kernel.h"
+
+#include <cstddef>
+#include <cstring>
+#include <mutex>  // NOLINT(build/c++11)
+#include <thread>  // NOLINT(build/c++11)
+#include <utility>
+#include <vector>
+
+#include "tensorflow/lite/core/async/c/types.h"
+#include "tensorflow/lite/core/async/interop/attribute_map_internal.h"
+#include "tensorflow/lite/core/async/interop/c/constants.h"
+#include "tensorflow/lite/core/async/interop/c/types.h"
+#include "tensorflow/lite/core/async/task_internal.h"
+#include "tensorflow/lite/core/c/c_api_types.h"
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/core/subgraph.h"
+#include "tensorflow/lite/minimal_logging.h"
+#include "tensorflow/lite/util.h"
+
+namespace tflite {
+namespace async {
+
+CpuAsyncKernel::CpuAsyncKernel(Subgraph* subgraph)
+    : subgraph_(subgraph),
+      supported_buffer_types_({kHostMemoryBufferType}),
+      supported_synchronizations_({kTfLiteSyncTypeNoSyncObj}) {}
+
+CpuAsyncKernel::~CpuAsyncKernel() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  cond_.notify_all();
+  if (worker_.joinable()) worker_.join();
+}
+
+TfLiteStatus CpuAsyncKernel::RegisterBuffer(TfLiteOpaqueContext* context,
+                                            TfLiteIoType io_type,
+                                            const TfLiteBackendBuffer* buffer,
+                                            const TfLiteAttributeMap* attrs,
+                                            TfLiteBufferHandle handle) {
+  const char* buffer_type = nullptr;
+  size_t bytes = 0;
+  if (!attrs->impl.GetAttr(kTfLiteBufferAttrKeyResourceTypeName,
+                           &buffer_type) ||
+      strcmp(buffer_type, kHostMemoryBufferType) != 0) {
+    TFLITE_LOG(TFLITE_LOG_ERROR, "Only %s buffers are supported.",
+               kHostMemoryBufferType);
+    return kTfLiteError;
+  }
+  if (!attrs->impl.GetAttr(kTfLiteBufferAttrKeySize, &bytes)) {
+    TFLITE_LOG(TFLITE_LOG_ERROR, "The size of the buffer is required.");
+    return kTfLiteError;
+  }
+  void* data = TfLiteBackendBufferGetPtr(buffer);
+  if (data == nullptr) return kTfLiteError;
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  return buffers_.insert({handle, {buffer, data, bytes}}).second ? kTfLiteOk
+                                                                 : kTfLiteError;
+}
+
+TfLiteStatus CpuAsyncKernel::RegisterBufferSlice(
+    TfLiteOpaqueContext* context, TfLiteBufferHandle buffer_pool,
+    const TfLiteAttributeMap* attrs, TfLiteBufferHandle handle) {
+  size_t offset = 0;
+  size_t bytes = 0;
+  attrs->impl.GetAttr(kTfLiteBufferAttrKeyOffset, &offset);
+  if (!attrs->impl.GetAttr(kTfLiteBufferAttrKeySize, &bytes)) {
+    TFLITE_LOG(TFLITE_LOG_ERROR, "The size of the buffer slice is required.");
+    return kTfLiteError;
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = buffers_.find(buffer_pool);
+  // Slices of slices aren't allowed.
+  if (it == buffers_.end() || it->second.buffer == nullptr ||
+      offset > it->second.bytes || bytes > it->second.bytes - offset) {
+    return kTfLiteError;
+  }
+  Buffer slice = {nullptr, static_cast<char*>(it->second.data) + offset,
+                  bytes};
+  return buffers_.insert({handle, slice}).second ? kTfLiteOk : kTfLiteError;
+}
+
+TfLiteStatus CpuAsyncKernel::UnregisterBuffer(TfLiteOpaqueContext* context,
+                                              TfLiteBufferHandle handle) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return buffers_.erase(handle) ? kTfLiteOk : kTfLiteError;
+}
+
+TfLiteAttributeMap CpuAsyncKernel::BufferRequirements(int tensor_index) const {
+  TfLiteAttributeMap requirements(kTfLiteAttrMapTypeBuffer);
+  requirements.impl.SetAttr(kTfLiteBufferAttrKeyResourceTypeName,
+                            kHostMemoryBufferType);
+  requirements.impl.SetAttr(kTfLiteBufferAttrKeyAlignment,
+                            static_cast<size_t>(kDefaultTensorAlignment));
+  requirements.impl.SetAttr(kTfLiteBufferAttrKeySize,
+                            subgraph_->tensor(tensor_index)->bytes);
+  return requirements;
+}
+
+bool CpuAsyncKernel::ReconcileRestrictions(
+    const TfLiteOpaqueContext* context, const TfLiteOpaqueNode* node,
+    int tensor_index, const TfLiteAttributeMap* user_provided_attributes,
+    TfLiteAttributeMap* merged, TfLiteAttributeMap* conflict) const {
+  const auto& attrs = user_provided_attributes->impl;
+  if (attrs.IsBufferAttributeMap()) {
+    return BufferRequirements(tensor_index)
+        .impl.ReconcileAttributes(&attrs, &merged->impl,
+                                  conflict ? &conflict->impl : nullptr);
+  }
+  if (attrs.IsSyncAttributeMap()) {
+    TfLiteAttributeMap requirements(kTfLiteAttrMapTypeSync);
+    requirements.impl.SetAttr(kTfLiteSynchronizationAttrKeyObjectTypeName,
+                              kTfLiteSyncTypeNoSyncObj);
+    return requirements.impl.ReconcileAttributes(
+        &attrs, &merged->impl, conflict ? &conflict->impl : nullptr);
+  }
+  return false;
+}
+
+TfLiteStatus CpuAsyncKernel::SetAttributes(TfLiteOpaqueContext* context,
+                                           TfLiteOpaqueNode* node,
+                                           int tensor_index,
+                                           const TfLiteAttributeMap* attrs) {
+  if (attrs->impl.IsBufferAttributeMap()) {
+    // The size is only known once the tensors are allocated, and is checked
+    // for every execution.
+    TfLiteAttributeMap requirements(kTfLiteAttrMapTypeBuffer);
+    requirements.impl.SetAttr(kTfLiteBufferAttrKeyResourceTypeName,
+                              kHostMemoryBufferType);
+    requirements.impl.SetAttr(kTfLiteBufferAttrKeyAlignment,
+                              static_cast<size_t>(kDefaultTensorAlignment));
+    return attrs->impl.CheckAttributeCoverage(&requirements.impl, nullptr)
+               ? kTfLiteOk
+               : kTfLiteError;
+  }
+  if (attrs->impl.IsSyncAttributeMap()) {
+    const char* sync_type = nullptr;
+    if (attrs->impl.GetAttr(kTfLiteSynchronizationAttrKeyObjectTypeName,
+                            &sync_type) &&
+        strcmp(sync_type, kTfLiteSyncTypeNoSyncObj) != 0) {
+      TFLITE_LOG(TFLITE_LOG_ERROR, "Only %s synchronizations are supported.",
+                 kTfLiteSyncTypeNoSyncObj);
+      return kTfLiteError;
+    }
+    return kTfLiteOk;
+  }
+  return kTfLiteError;
+}
+
+TfLiteStatus CpuAsyncKernel::SetBufferAttributes(
+    const TfLiteBackendBuffer* buffer, const TfLiteAttributeMap* attrs) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto& handle_and_buffer : buffers_) {
+    if (handle_and_buffer.second.buffer == buffer) {
+      attrs->impl.GetAttr(kTfLiteBufferAttrKeySize,
+                          &handle_and_buffer.second.bytes);
+      return kTfLiteOk;
+    }
+  }
+  return kTfLiteError;
+}
+
+TfLiteStatus CpuAsyncKernel::GetBufferAttributes(
+    const TfLiteBackendBuffer* buffer, TfLiteAttributeMap* attrs) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (const auto& handle_and_buffer : buffers_) {
+    if (handle_and_buffer.second.buffer == buffer) {
+      attrs->impl = interop::AttributeMap(kTfLiteAttrMapTypeBuffer);
+      attrs->impl.SetAttr(kTfLiteBufferAttrKeyResourceTypeName,
+                          kHostMemoryBufferType);
+      attrs->impl.SetAttr(kTfLiteBufferAttrKeySize,
+                          handle_and_buffer.second.bytes);
+      return kTfLiteOk;
+    }
+  }
+  return kTfLiteError;
+}
+
+TfLiteStatus CpuAsyncKernel::Prepare(TfLiteOpaqueContext* context,
+                                     TfLiteOpaqueNode* node) {
+  return subgraph_->AllocateTensors();
+}
+
+TfLiteStatus CpuAsyncKernel::Eval(TfLiteOpaqueContext* context,
+                                  TfLiteOpaqueNode* node,
+                                  TfLiteExecutionTask* task) {
+  std::vector<std::pair<int, Buffer>> bindings;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto* tensors : {&subgraph_->inputs(), &subgraph_->outputs()}) {
+      for (int tensor_index : *tensors) {
+        const TfLiteBufferHandle handle =
+            task->task->GetBufferHandle(tensor_index);
+        if (handle == kTfLiteNullBufferHandle) continue;
+        auto it = buffers_.find(handle);
+        if (it == buffers_.end()) {
+          TFLITE_LOG(TFLITE_LOG_ERROR, "Unknown buffer handle %d.", handle);
+          return kTfLiteError;
+        }
+        bindings.push_back({tensor_index, it->second});
+      }
+    }
+    TaskState& state = tasks_[task];
+    state.bindings = std::move(bindings);
+    state.done = false;
+    queue_.push_back(task);
+    if (!worker_.joinable()) {
+      worker_ = std::thread([this] { WorkerLoop(); });
+    }
+  }
+  cond_.notify_all();
+  return kTfLiteOk;
+}
+
+TfLiteStatus CpuAsyncKernel::Wait(TfLiteOpaqueContext* context,
+                                  TfLiteExecutionTask* task) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  auto it = tasks_.find(task);
+  if (it == tasks_.end()) return kTfLiteOk;
+  const TaskState& state = it->second;
+  cond_.wait(lock, [&state] { return state.done; });
+  return state.status;
+}
+
+TfLiteStatus CpuAsyncKernel::Finish(TfLiteOpaqueContext* context,
+                                    TfLiteExecutionTask* task) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  auto it = tasks_.find(task);
+  if (it == tasks_.end()) return kTfLiteOk;
+  const TaskState& state = it->second;
+  cond_.wait(lock, [&state] { return state.done; });
+  tasks_.erase(it);
+  return kTfLiteOk;
+}
+
+void CpuAsyncKernel::WorkerLoop() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    cond_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+    if (queue_.empty()) return;
+    TaskState& state = tasks_[queue_.front()];
+    queue_.pop_front();
+    // `Finish` doesn't remove the task before it's done.
+    lock.unlock();
+    const TfLiteStatus status = Run(state.bindings);
+    lock.lock();
+    state.status = status;
+    state.done = true;
+    cond_.notify_all();
+  }
+}
+
+TfLiteStatus CpuAsyncKernel::Run(
+    const std::vector<std::pair<int, Buffer>>& bindings) {
+  for (const auto& tensor_and_buffer : bindings) {
+    const Buffer& buffer = tensor_and_buffer.second;
+    TF_LITE_ENSURE_STATUS(subgraph_->SetCustomAllocationForTensor(
+        tensor_and_buffer.first, {buffer.data, buffer.bytes}));
+  }
+  // The sizes of the buffers are checked against the tensors.
+  return subgraph_->Invoke();
+}
+
+}  // namespace async
+}  // namespace tflite
@@ -0,0 +1,154 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_CORE_ASYNC_CPU_ASYNC_KERNEL_H_
+#define TENSORFLOW_LITE_CORE_ASYNC_CPU_ASYNC_KERNEL_H_
+
+#include <condition_variable>  // NOLINT(build/c++11)
+#include <cstddef>
+#include <deque>
+#include <map>
+#include <mutex>  // NOLINT(build/c++11)
+#include <thread>  // NOLINT(build/c++11)
+#include <utility>
+#include <vector>
+
+#include "tensorflow/lite/async/backend_async_kernel_interface.h"
+#include "tensorflow/lite/core/async/c/types.h"
+#include "tensorflow/lite/core/async/interop/c/types.h"
+#include "tensorflow/lite/core/c/c_api_types.h"
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/core/subgraph.h"
+
+namespace tflite {
+namespace async {
+
+// Buffer type name of caller owned host memory, i.e. the pointer wrapped in
+// the TfLiteBackendBuffer is the address of the data.
+inline constexpr char kHostMemoryBufferType[] = "host_memory";
+
+// An async kernel running a whole subgraph on the CPU (including any
+// synchronous delegate, e.g. XNNPACK), used by AsyncSubgraph when no backend
+// provides an async kernel.
+//
+// Buffers of host memory are registered once, and are bound to the input /
+// output tensors of a task without copies. Executions run in order on a
+// worker thread, so that the application can prepare the next inputs while
+// the current execution is running. Only `kTfLiteSyncTypeNoSyncObj` is
+// supported: inputs must be ready when the task is scheduled, and outputs are
+// ready when `Wait` returns.
+//
+// Buffers must be aligned to `kDefaultTensorAlignment`. The tensors for which
+// a task has no buffer handle keep their current memory, which is the last
+// buffer bound to them if any.
+//
+// WARNING: Experimental interface, subject to change.
+class CpuAsyncKernel : public delegates::BackendAsyncKernelInterface {
+ public:
+  // `subgraph` must outlive the kernel, and must not be invoked by other
+  // threads while tasks are running.
+  explicit CpuAsyncKernel(Subgraph* subgraph);
+  ~CpuAsyncKernel() override;
+
+  CpuAsyncKernel(const CpuAsyncKernel&) = delete;
+  CpuAsyncKernel& operator=(const CpuAsyncKernel&) = delete;
+
+  TfLiteStatus RegisterBuffer(TfLiteOpaqueContext* context,
+                              TfLiteIoType io_type,
+                              const TfLiteBackendBuffer* buffer,
+                              const TfLiteAttributeMap* attrs,
+                              TfLiteBufferHandle handle) override;
+  TfLiteStatus RegisterBufferSlice(TfLiteOpaqueContext* context,
+                                   TfLiteBufferHandle buffer_pool,
+                                   const TfLiteAttributeMap* attrs,
+                                   TfLiteBufferHandle handle) override;
+  TfLiteStatus UnregisterBuffer(TfLiteOpaqueContext* context,
+                                TfLiteBufferHandle handle) override;
+
+  const std::vector<const char*>& SupportedBufferTypes(
+      TfLiteIoType io_type) const override {
+    return supported_buffer_types_;
+  }
+  const std::vector<const char*>& SupportedSynchronizations(
+      TfLiteIoType io_type) const override {
+    return supported_synchronizations_;
+  }
+
+  bool ReconcileRestrictions(const TfLiteOpaqueContext* context,
+                             const TfLiteOpaqueNode* node, int tensor_index,
+                             const TfLiteAttributeMap* user_provided_attributes,
+                             TfLiteAttributeMap* merged,
+                             TfLiteAttributeMap* conflict) const override;
+  TfLiteStatus SetAttributes(TfLiteOpaqueContext* context,
+                             TfLiteOpaqueNode* node, int tensor_index,
+                             const TfLiteAttributeMap* attrs) override;
+  TfLiteStatus SetBufferAttributes(const TfLiteBackendBuffer* buffer,
+                                   const TfLiteAttributeMap* attrs) override;
+  TfLiteStatus GetBufferAttributes(const TfLiteBackendBuffer* buffer,
+                                   TfLiteAttributeMap* attrs) override;
+
+  TfLiteStatus Prepare(TfLiteOpaqueContext* context,
+                       TfLiteOpaqueNode* node) override;
+
+  TfLiteStatus Eval(TfLiteOpaqueContext* context, TfLiteOpaqueNode* node,
+                    TfLiteExecutionTask* task) override;
+  TfLiteStatus Wait(TfLiteOpaqueContext* context,
+                    TfLiteExecutionTask* task) override;
+  TfLiteStatus Finish(TfLiteOpaqueContext* context,
+                      TfLiteExecutionTask* task) override;
+
+ private:
+  struct Buffer {
+    // Not owned. Null for slices.
+    const TfLiteBackendBuffer* buffer;
+    void* data;
+    size_t bytes;
+  };
+
+  struct TaskState {
+    // The buffers bound to the tensors, resolved when the task is scheduled.
+    std::vector<std::pair<int, Buffer>> bindings;
+    bool done = true;
+    TfLiteStatus status = kTfLiteOk;
+  };
+
+  // Returns the attributes every buffer of `tensor_index` must have.
+  TfLiteAttributeMap BufferRequirements(int tensor_index) const;
+
+  // Runs the scheduled tasks until the kernel is destroyed.
+  void WorkerLoop();
+
+  // Binds the buffers of a task to their tensors and invokes the subgraph.
+  TfLiteStatus Run(const std::vector<std::pair<int, Buffer>>& bindings);
+
+  // Not owned.
+  Subgraph* subgraph_;
+
+  std::vector<const char*> supported_buffer_types_;
+  std::vector<const char*> supported_synchronizations_;
+
+  std::mutex mutex_;
+  std::condition_variable cond_;
+  std::map<TfLiteBufferHandle, Buffer> buffers_;
+  std::map<const TfLiteExecutionTask*, TaskState> tasks_;
+  std::deque<const TfLiteExecutionTask*> queue_;
+  bool stopping_ = false;
+  // Started by the first execution.
+  std::thread worker_;
+};
+
+}  // namespace async
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_CORE_ASYNC_CPU_ASYNC_KERNEL_H_
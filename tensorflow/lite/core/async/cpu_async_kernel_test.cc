@@ -0,0 +1,208 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/core/async/cpu_async_kernel.h"
+
+#include <cstddef>
+#include <cstdlib>
+#include <memory>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "tensorflow/lite/core/async/async_subgraph.h"
+#include "tensorflow/lite/core/async/c/types.h"
+#include "tensorflow/lite/core/async/interop/attribute_map_internal.h"
+#include "tensorflow/lite/core/async/interop/c/types.h"
+#include "tensorflow/lite/core/async/task_internal.h"
+#include "tensorflow/lite/core/c/builtin_op_data.h"
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/core/interpreter.h"
+#include "tensorflow/lite/core/kernels/builtin_op_kernels.h"
+#include "tensorflow/lite/util.h"
+
+namespace tflite {
+namespace async {
+namespace {
+
+constexpr int kNumElements = 4;
+constexpr size_t kBytes = kNumElements * sizeof(float);
+
+struct alignas(kDefaultTensorAlignment) AlignedBuffer {
+  float data[2 * kDefaultTensorAlignment / sizeof(float)];
+};
+
+class CpuAsyncKernelTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    // output = input_0 + input_1, without any delegate.
+    interpreter_ = std::make_unique<Interpreter>();
+    interpreter_->AddTensors(3);
+    interpreter_->SetInputs({0, 1});
+    interpreter_->SetOutputs({2});
+    TfLiteQuantizationParams quant;
+    for (int i = 0; i < 3; ++i) {
+      interpreter_->SetTensorParametersReadWrite(i, kTfLiteFloat32, "",
+                                                 {kNumElements}, quant);
+    }
+    auto* params =
+        reinterpret_cast<TfLiteAddParams*>(malloc(sizeof(TfLiteAddParams)));
+    params->activation = kTfLiteActNone;
+    params->pot_scale_int16 = false;
+    interpreter_->AddNodeWithParameters({0, 1}, {2}, nullptr, 0, params,
+                                        ops::builtin::Register_ADD());
+    ASSERT_EQ(interpreter_->AllocateTensors(), kTfLiteOk);
+    subgraph_ = std::make_unique<AsyncSubgraph>(interpreter_->subgraph(0));
+  }
+
+  void TearDown() override {
+    subgraph_.reset();
+    for (auto* buffer : backend_buffers_) TfLiteBackendBufferDelete(buffer);
+  }
+
+  TfLiteBufferHandle Register(TfLiteIoType io_type, float* data,
+                              size_t bytes) {
+    TfLiteBackendBuffer* buffer = TfLiteBackendBufferCreate();
+    TfLiteBackendBufferSetPtr(buffer, data);
+    backend_buffers_.push_back(buffer);
+    TfLiteAttributeMap attrs(kTfLiteAttrMapTypeBuffer);
+    attrs.impl.SetAttr(kTfLiteBufferAttrKeyResourceTypeName,
+                       kHostMemoryBufferType);
+    attrs.impl.SetAttr(kTfLiteBufferAttrKeySize, bytes);
+    TfLiteBufferHandle handle = kTfLiteNullBufferHandle;
+    EXPECT_EQ(subgraph_->RegisterBuffer(io_type, buffer, &attrs, &handle),
+              kTfLiteOk);
+    return handle;
+  }
+
+  std::unique_ptr<Interpreter> interpreter_;
+  std::unique_ptr<AsyncSubgraph> subgraph_;
+  std::vector<TfLiteBackendBuffer*> backend_buffers_;
+};
+
+TEST_F(CpuAsyncKernelTest, ReconcilesHostMemory) {
+  ASSERT_EQ(subgraph_->SupportedBufferTypes(kTfLiteIoTypeInput).size(), 1);
+  EXPECT_STREQ(subgraph_->SupportedBufferTypes(kTfLiteIoTypeInput)[0],
+               kHostMemoryBufferType);
+
+  TfLiteAttributeMap user_attrs(kTfLiteAttrMapTypeBuffer);
+  user_attrs.impl.SetAttr(kTfLiteBufferAttrKeyAlignment,
+                          static_cast<size_t>(128));
+  TfLiteAttributeMap merged(kTfLiteAttrMapTypeBuffer);
+  ASSERT_TRUE(
+      subgraph_->ReconcileRestrictions(0, &user_attrs, &merged, nullptr));
+  size_t alignment = 0;
+  size_t size = 0;
+  ASSERT_TRUE(merged.impl.GetAttr(kTfLiteBufferAttrKeyAlignment, &alignment));
+  ASSERT_TRUE(merged.impl.GetAttr(kTfLiteBufferAttrKeySize, &size));
+  EXPECT_EQ(alignment, 128);
+  EXPECT_EQ(size, kBytes);
+  EXPECT_EQ(subgraph_->SetAttributes(0, &merged), kTfLiteOk);
+
+  TfLiteAttributeMap other_attrs(kTfLiteAttrMapTypeBuffer);
+  other_attrs.impl.SetAttr(kTfLiteBufferAttrKeyResourceTypeName, "ahwb");
+  EXPECT_FALSE(
+      subgraph_->ReconcileRestrictions(0, &other_attrs, &merged, nullptr));
+  EXPECT_EQ(subgraph_->SetAttributes(0, &other_attrs), kTfLiteError);
+}
+
+TEST_F(CpuAsyncKernelTest, PipelinesTasksOnRegisteredBuffers) {
+  AlignedBuffer buffers[2][3];
+  TfLiteExecutionTask* tasks[2];
+  ASSERT_EQ(subgraph_->Prepare(), kTfLiteOk);
+  for (int t = 0; t < 2; ++t) {
+    tasks[t] = subgraph_->CreateTask();
+    for (int i = 0; i < 3; ++i) {
+      const TfLiteIoType io_type =
+          i < 2 ? kTfLiteIoTypeInput : kTfLiteIoTypeOutput;
+      ASSERT_EQ(tasks[t]->task->SetBufferHandle(
+                    i, Register(io_type, buffers[t][i].data, kBytes)),
+                kTfLiteOk);
+    }
+    for (int j = 0; j < kNumElements; ++j) {
+      buffers[t][0].data[j] = j;
+      buffers[t][1].data[j] = 10 * (t + 1);
+    }
+  }
+
+  // Both tasks are scheduled before waiting for the first one.
+  ASSERT_EQ(subgraph_->InvokeAsync(tasks[0]), kTfLiteOk);
+  ASSERT_EQ(subgraph_->InvokeAsync(tasks[1]), kTfLiteOk);
+  EXPECT_EQ(subgraph_->InvokeAsync(tasks[1]), kTfLiteError);
+  ASSERT_EQ(subgraph_->Wait(tasks[0]), kTfLiteOk);
+  ASSERT_EQ(subgraph_->Wait(tasks[1]), kTfLiteOk);
+  for (int t = 0; t < 2; ++t) {
+    for (int j = 0; j < kNumElements; ++j) {
+      EXPECT_EQ(buffers[t][2].data[j], j + 10 * (t + 1));
+    }
+  }
+  // The tensors use the buffers of the last task without copies.
+  EXPECT_EQ(interpreter_->tensor(0)->data.f, buffers[1][0].data);
+  EXPECT_EQ(interpreter_->tensor(2)->data.f, buffers[1][2].data);
+
+  // The inputs are updated in place for the next execution.
+  buffers[0][1].data[0] = 100;
+  ASSERT_EQ(subgraph_->InvokeAsync(tasks[0]), kTfLiteOk);
+  ASSERT_EQ(subgraph_->Wait(tasks[0]), kTfLiteOk);
+  EXPECT_EQ(buffers[0][2].data[0], 100);
+  EXPECT_EQ(subgraph_->Finish(tasks[0]), kTfLiteOk);
+  EXPECT_EQ(subgraph_->Finish(tasks[1]), kTfLiteOk);
+}
+
+TEST_F(CpuAsyncKernelTest, BindsBufferSlices) {
+  AlignedBuffer pool;
+  const TfLiteBufferHandle pool_handle =
+      Register(kTfLiteIoTypeOutput, pool.data, sizeof(pool.data));
+  auto register_slice = [&](size_t offset, size_t size) {
+    TfLiteAttributeMap attrs(kTfLiteAttrMapTypeBuffer);
+    attrs.impl.SetAttr(kTfLiteBufferAttrKeyOffset, offset);
+    attrs.impl.SetAttr(kTfLiteBufferAttrKeySize, size);
+    TfLiteBufferHandle handle = kTfLiteNullBufferHandle;
+    subgraph_->RegisterBufferSlice(pool_handle, &attrs, &handle);
+    return handle;
+  };
+  TfLiteBufferHandle slices[3];
+  for (int i = 0; i < 3; ++i) {
+    slices[i] = register_slice(i * kDefaultTensorAlignment / 2, kBytes);
+  }
+  // Past the end of the pool.
+  TfLiteAttributeMap attrs(kTfLiteAttrMapTypeBuffer);
+  attrs.impl.SetAttr(kTfLiteBufferAttrKeyOffset, sizeof(pool.data));
+  attrs.impl.SetAttr(kTfLiteBufferAttrKeySize, kBytes);
+  TfLiteBufferHandle handle;
+  EXPECT_EQ(subgraph_->RegisterBufferSlice(pool_handle, &attrs, &handle),
+            kTfLiteError);
+
+  for (int j = 0; j < kNumElements; ++j) {
+    pool.data[j] = j;
+    pool.data[j + kDefaultTensorAlignment / sizeof(float)] = 1;
+  }
+  TfLiteExecutionTask* task = subgraph_->CreateTask();
+  task->task->SetBufferHandle(0, slices[0]);
+  task->task->SetBufferHandle(1, slices[2]);
+  task->task->SetBufferHandle(2, slices[0]);
+  ASSERT_EQ(subgraph_->InvokeAsync(task), kTfLiteOk);
+  ASSERT_EQ(subgraph_->Wait(task), kTfLiteOk);
+  for (int j = 0; j < kNumElements; ++j) EXPECT_EQ(pool.data[j], j + 1);
+
+  // The second slice isn't aligned.
+  task->task->SetBufferHandle(2, slices[1]);
+  ASSERT_EQ(subgraph_->InvokeAsync(task), kTfLiteOk);
+  EXPECT_EQ(subgraph_->Wait(task), kTfLiteError);
+  EXPECT_EQ(subgraph_->Wait(task), kTfLiteError);
+  EXPECT_EQ(subgraph_->Finish(task), kTfLiteOk);
+}
+
+}  // namespace
+}  // namespace async
+}  // namespace tflite
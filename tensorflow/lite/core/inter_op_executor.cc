@@ -0,0 +1,117 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/core/inter_op_executor.h"
+
+#include <functional>
+#include <memory>
+#include <mutex>   // NOLINT(build/c++11)
+#include <thread>  // NOLINT(build/c++11)
+
+#include "tensorflow/lite/core/c/common.h"
+
+namespace tflite {
+
+InterOpExecutor::InterOpExecutor(int num_threads) {
+  if (num_threads < 1) num_threads = 1;
+  for (int i = 0; i < num_threads; ++i) {
+    workers_.push_back(std::make_unique<Worker>());
+  }
+  for (int i = 1; i < num_threads; ++i) {
+    threads_.emplace_back(&InterOpExecutor::ThreadMain, this, i);
+  }
+}
+
+InterOpExecutor::~InterOpExecutor() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    shutdown_ = true;
+  }
+  work_available_.notify_all();
+  for (std::thread& thread : threads_) {
+    thread.join();
+  }
+}
+
+void InterOpExecutor::RefreshContexts(const TfLiteContext& context) {
+  for (std::unique_ptr<Worker>& worker : workers_) {
+    worker->context = context;
+    worker->context.recommended_num_threads = 1;
+    worker->context.GetExternalContext = GetExternalContext;
+    worker->subgraph_context = &context;
+  }
+}
+
+TfLiteExternalContext* InterOpExecutor::GetExternalContext(
+    struct TfLiteContext* context, TfLiteExternalContextType type) {
+  Worker* worker = reinterpret_cast<Worker*>(context);
+  if (type == kTfLiteCpuBackendContext) {
+    return &worker->cpu_backend_context;
+  }
+  TfLiteContext* subgraph_context =
+      const_cast<TfLiteContext*>(worker->subgraph_context);
+  return subgraph_context->GetExternalContext(subgraph_context, type);
+}
+
+void InterOpExecutor::ParallelFor(
+    int n, const std::function<void(int worker, int i)>& fn) {
+  if (threads_.empty() || n <= 1) {
+    for (int i = 0; i < n; ++i) fn(0, i);
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    fn_ = &fn;
+    num_iterations_ = n;
+    next_iteration_ = 0;
+    num_iterations_done_ = 0;
+    ++generation_;
+  }
+  work_available_.notify_all();
+  RunIterations(0);
+  std::unique_lock<std::mutex> lock(mutex_);
+  work_done_.wait(lock,
+                  [this] { return num_iterations_done_ == num_iterations_; });
+  fn_ = nullptr;
+}
+
+void InterOpExecutor::RunIterations(int worker) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (fn_ != nullptr && next_iteration_ < num_iterations_) {
+    const int i = next_iteration_++;
+    const std::function<void(int, int)>& fn = *fn_;
+    lock.unlock();
+    fn(worker, i);
+    lock.lock();
+    if (++num_iterations_done_ == num_iterations_) {
+      work_done_.notify_one();
+    }
+  }
+}
+
+void InterOpExecutor::ThreadMain(int worker) {
+  int64_t generation = 0;
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      work_available_.wait(
+          lock, [&] { return shutdown_ || generation_ != generation; });
+      if (shutdown_) return;
+      generation = generation_;
+    }
+    RunIterations(worker);
+  }
+}
+
+}  // namespace tflite
@@ -0,0 +1,99 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_CORE_INTER_OP_EXECUTOR_H_
+#define TENSORFLOW_LITE_CORE_INTER_OP_EXECUTOR_H_
+
+#include <condition_variable>  // NOLINT(build/c++11)
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>   // NOLINT(build/c++11)
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/external_cpu_backend_context.h"
+
+namespace tflite {
+
+// Executes independent nodes of a subgraph concurrently.
+//
+// The executor owns `num_threads - 1` threads, the thread calling
+// `ParallelFor` being the remaining worker. Each worker has its own copy of
+// the subgraph's `TfLiteContext`, whose CPU backend context (and so the ruy
+// and gemmlowp contexts, which aren't thread-safe) is owned by the worker.
+//
+// WARNING: This is an experimental API and subject to change.
+class InterOpExecutor {
+ public:
+  explicit InterOpExecutor(int num_threads);
+  ~InterOpExecutor();
+  InterOpExecutor(const InterOpExecutor&) = delete;
+  InterOpExecutor& operator=(const InterOpExecutor&) = delete;
+
+  int num_threads() const { return static_cast<int>(workers_.size()); }
+
+  // Copies `context` into the contexts of the workers. The kernels executed
+  // on a worker use one thread each, since the workers are already running
+  // concurrently. Must be called whenever `context` changes.
+  void RefreshContexts(const TfLiteContext& context);
+
+  // Returns the context the nodes executed by `worker` are given.
+  TfLiteContext* context(int worker) { return &workers_[worker]->context; }
+
+  // Calls `fn(worker, i)` for every `i` in [0, n) on the workers, and returns
+  // once all the calls have returned.
+  void ParallelFor(int n, const std::function<void(int worker, int i)>& fn);
+
+ private:
+  struct Worker {
+    // Must be the first member: `GetExternalContext` gets the worker from
+    // the context.
+    TfLiteContext context;
+    // The context of the subgraph, given the external contexts other than the
+    // CPU backend one.
+    const TfLiteContext* subgraph_context = nullptr;
+    ExternalCpuBackendContext cpu_backend_context;
+  };
+
+  static TfLiteExternalContext* GetExternalContext(
+      struct TfLiteContext* context, TfLiteExternalContextType type);
+
+  // Runs the iterations of the current `ParallelFor` until there are none
+  // left.
+  void RunIterations(int worker);
+
+  void ThreadMain(int worker);
+
+  std::vector<std::unique_ptr<Worker>> workers_;
+  std::vector<std::thread> threads_;
+
+  std::mutex mutex_;
+  std::condition_variable work_available_;
+  std::condition_variable work_done_;
+  // Incremented by every `ParallelFor`, so that the threads know there's new
+  // work.
+  int64_t generation_ = 0;
+  bool shutdown_ = false;
+  // The current `ParallelFor`.
+  const std::function<void(int, int)>* fn_ = nullptr;
+  int num_iterations_ = 0;
+  int next_iteration_ = 0;
+  int num_iterations_done_ = 0;
+};
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_CORE_INTER_OP_EXECUTOR_H_
@@ -1003,6 +1003,10 @@ TfLiteStatus Subgraph::AllocateTensors() {
   // Profile "AllocateTensors" only when memory planning is needed.
   TFLITE_SCOPED_TAGGED_DEFAULT_PROFILE(profiler_.get(), "AllocateTensors");
 
+  invoke_node_levels_concurrently_ = false;
+  frozen_invocation_plan_.clear();
+  TF_LITE_ENSURE_STATUS(PlanNodeLevels());
+
   next_execution_plan_index_to_prepare_ = 0;
   next_execution_plan_index_to_plan_allocation_ = 0;
   next_original_execution_plan_index_to_prepare_ = 0;
@@ -1024,6 +1028,8 @@ TfLiteStatus Subgraph::AllocateTensors() {
   // index that uses the tensor.
   InitializeTensorReleaseMap();
 
+  PlanWeightStreaming();
+
   // Temporary tensors allocated during Prepare for nodes which are subsequently
   // delegated are not required and can be freed.
   if (!pre_delegation_execution_plan_.empty()) {
@@ -1189,6 +1195,24 @@ TfLiteStatus Subgraph::ResizeInputTensor(int tensor_index,
                  tensor_index < context_.tensors_size && tensor_index >= 0);
   TfLiteTensor* tensor = &context_.tensors[tensor_index];
 
+  // Round the dimension up to its bucket, see
+  // `InterpreterOptions::SetShapeBuckets`.
+  const int* dims = dims_data;
+  std::vector<int> bucketed_dims;
+  const int bucket_dimension =
+      options_ ? options_->GetShapeBucketDimension() : -1;
+  if (bucket_dimension >= 0 && bucket_dimension < rank &&
+      std::find(inputs_.begin(), inputs_.end(), tensor_index) !=
+          inputs_.end()) {
+    const std::vector<int>& bucket_sizes = options_->GetShapeBucketSizes();
+    bucketed_dims.assign(dims_data, dims_data + rank);
+    int& size = bucketed_dims[bucket_dimension];
+    auto bucket =
+        std::lower_bound(bucket_sizes.begin(), bucket_sizes.end(), size);
+    if (bucket != bucket_sizes.end()) size = *bucket;
+    dims = bucketed_dims.data();
+  }
+
   // Short-circuit the state change if the dimensions don't change, avoiding
   // unnecessary (re)allocations.
   //
@@ -1196,7 +1220,7 @@ TfLiteStatus Subgraph::ResizeInputTensor(int tensor_index,
   // the subgraph won't allocate memory for a dynamic tensor when its size
   // is equal to the original tensor size.
   if (tensor->data.raw != nullptr &&
-      EqualArrayAndTfLiteIntArray(tensor->dims, rank, dims_data)) {
+      EqualArrayAndTfLiteIntArray(tensor->dims, rank, dims)) {
     return kTfLiteOk;
   }
 
@@ -1205,7 +1229,7 @@ TfLiteStatus Subgraph::ResizeInputTensor(int tensor_index,
     TF_LITE_ENSURE_STATUS(UndoAllDelegates());
   }
   state_ = kStateUninvokable;
-  return ResizeTensorImpl(tensor, BuildTfLiteArray(rank, dims_data).release());
+  return ResizeTensorImpl(tensor, BuildTfLiteArray(rank, dims).release());
 }
 
 TfLiteStatus Subgraph::ResizeInputTensor(int tensor_index,
@@ -1393,7 +1417,7 @@ TfLiteStatus Subgraph::OpPrepare(const TfLiteRegistration& op_reg,
 
 // Invoke the operator represented by 'node'.
 TfLiteStatus Subgraph::OpInvoke(const TfLiteRegistration& op_reg,
-                                TfLiteNode* node) {
+                                TfLiteNode* node, TfLiteContext* context) {
   // Delegates that use the stable delegate API to iterate over the nodes and
   // registrations are presented with ABI stable 'TfLiteOperator'
   // pointers, as opposed to ABI unstable 'TfLiteRegistration' pointers, even
@@ -1412,22 +1436,22 @@ TfLiteStatus Subgraph::OpInvoke(const TfLiteRegistration& op_reg,
           &nodes_and_registration_[op_reg.registration_external->node_index]
                .second;
       if (referenced_registration->invoke == nullptr) return kTfLiteError;
-      return referenced_registration->invoke(&context_, node);
+      return referenced_registration->invoke(context, node);
     }
     if (op_reg.registration_external->invoke_with_data) {
       void* user_data = op_reg.registration_external->user_data;
       return op_reg.registration_external->invoke_with_data(
-          user_data, reinterpret_cast<TfLiteOpaqueContext*>(&context_),
+          user_data, reinterpret_cast<TfLiteOpaqueContext*>(context),
           reinterpret_cast<TfLiteOpaqueNode*>(node));
     }
     if (op_reg.registration_external->invoke) {
       return op_reg.registration_external->invoke(
-          reinterpret_cast<TfLiteOpaqueContext*>(&context_),
+          reinterpret_cast<TfLiteOpaqueContext*>(context),
           reinterpret_cast<TfLiteOpaqueNode*>(node));
     }
   }
   if (op_reg.invoke == nullptr) return kTfLiteError;
-  return op_reg.invoke(&context_, node);
+  return op_reg.invoke(context, node);
 }
 
 // Let 'op_reg' release any memory it might have allocated via 'OpInit'.
@@ -1557,12 +1581,18 @@ TfLiteStatus Subgraph::PrepareOpsAndTensors() {
 
   if (!memory_planner_) {
 #ifdef TFLITE_USE_SIMPLE_MEMORY_PLANNER
+    // The simple planner doesn't share memory between tensors.
     memory_planner_.reset(new SimplePlanner(&context_, CreateGraphInfo()));
 #else
-    memory_planner_ = std::make_unique<ArenaPlanner>(
+    auto arena_planner = std::make_unique<ArenaPlanner>(
         &context_, CreateGraphInfo(), ShouldPreserveAllTensors(),
         kDefaultTensorAlignment, subgraph_index_);
+    arena_planner->SetExecuteNodeLevelsConcurrently(
+        !execution_plan_levels_.empty());
+    arena_planner->SetMinimizeArenaSize(ShouldMinimizeArenaSize());
+    memory_planner_ = std::move(arena_planner);
 #endif
+    memory_planned_for_node_levels_ = !execution_plan_levels_.empty();
     memory_planner_->PlanAllocations();
   }
 
@@ -1634,6 +1664,12 @@ TfLiteStatus Subgraph::InvokeImpl() {
     ReportError("Non-persistent memory is not available.");
     return kTfLiteError;
   }
+  if (invoke_node_levels_concurrently_) {
+    return InvokeNodeLevelsConcurrently();
+  }
+  if (!frozen_invocation_plan_.empty() && profiler_ == nullptr) {
+    return InvokeFrozenPlan();
+  }
   TFLITE_SCOPED_TAGGED_DEFAULT_PROFILE(profiler_.get(), "Invoke");
 #ifdef TF_LITE_TENSORFLOW_PROFILER
   tensorflow::profiler::TraceMe* trace_subgraph =
@@ -1723,11 +1759,13 @@ TfLiteStatus Subgraph::InvokeImpl() {
 
     EnsureTensorsVectorCapacity();
     tensor_resized_since_op_invoke_ = false;
+    if (weight_streamer_) weight_streamer_->BeforeNode(execution_plan_index);
     if (auto s = OpInvoke(registration, &node); s != kTfLiteOk) {
       auto err = ReportOpError(&context_, node, registration, node_index,
                                "failed to invoke");
       return s == kTfLiteCancelled ? s : err;
     }
+    if (weight_streamer_) weight_streamer_->AfterNode(execution_plan_index);
 
     // Force execution prep for downstream ops if the latest op triggered the
     // resize of a dynamic tensor.
@@ -1758,9 +1796,204 @@ TfLiteStatus Subgraph::InvokeImpl() {
 #ifdef TF_LITE_TENSORFLOW_PROFILER
   tflite::OnTfLiteSubgraphInvokeEnd(trace_subgraph);
 #endif  // TF_LITE_TENSORFLOW_PROFILER
+  invoke_node_levels_concurrently_ = CanInvokeNodeLevelsConcurrently();
+  FreezeInvocationPlan();
   return status;
 }
 
+void Subgraph::FreezeInvocationPlan() {
+  frozen_invocation_plan_.clear();
+#ifndef TF_LITE_TENSORFLOW_PROFILER
+  if (invoke_node_levels_concurrently_ || profiler_ != nullptr ||
+      weight_streamer_ != nullptr ||
+      next_execution_plan_index_to_prepare_ != execution_plan_.size()) {
+    return;
+  }
+  // The data of the tensors of a delegate supporting buffer handles may have
+  // to be copied before each node, and dynamic tensors are allocated, and the
+  // following nodes prepared, while the nodes are invoked.
+  for (TfLiteDelegate* delegate : delegates_applied_) {
+    if (delegate->CopyFromBufferHandle != nullptr) return;
+  }
+  for (const TfLiteTensor& tensor : tensors_) {
+    if (tensor.allocation_type == kTfLiteDynamic ||
+        tensor.delegate != nullptr) {
+      return;
+    }
+  }
+
+  std::vector<FrozenNodeInvocation> plan;
+  plan.reserve(execution_plan_.size());
+  for (int node_index : execution_plan_) {
+    TfLiteNode& node = nodes_and_registration_[node_index].first;
+    const TfLiteRegistration* registration =
+        &nodes_and_registration_[node_index].second;
+    if (registration->registration_external) {
+      // Only the operators wrapping a `TfLiteRegistration` are invoked through
+      // a `TfLiteContext`.
+      const int referenced_node_index =
+          registration->registration_external->node_index;
+      if (referenced_node_index == -1) return;
+      registration = &nodes_and_registration_[referenced_node_index].second;
+    }
+    if (registration->invoke == nullptr) return;
+    // `InvokeImpl` checks that the inputs of each node have data.
+    for (int i = 0; i < node.inputs->size; ++i) {
+      const int tensor_index = node.inputs->data[i];
+      if (tensor_index == kTfLiteOptionalTensor) continue;
+      const TfLiteTensor& tensor = tensors_[tensor_index];
+      if (tensor.data.raw == nullptr && tensor.bytes > 0) return;
+    }
+    plan.push_back({registration->invoke, &node, node_index});
+  }
+  frozen_invocation_plan_ = std::move(plan);
+#endif  // TF_LITE_TENSORFLOW_PROFILER
+}
+
+TfLiteStatus Subgraph::InvokeFrozenPlan() {
+  EnsureTensorsVectorCapacity();
+  for (const FrozenNodeInvocation& invocation : frozen_invocation_plan_) {
+    if (check_cancelled_func_ != nullptr &&
+        check_cancelled_func_(cancellation_data_)) {
+      ReportError("Client requested cancel during Invoke()");
+      return kTfLiteError;
+    }
+    if (continue_invocation_ && !continue_invocation_->test_and_set()) {
+      // `Cancel` is called and cancellation flag is flipped.
+      ReportError("Client requested cancel during Invoke()");
+      return kTfLiteCancelled;
+    }
+    if (auto s = invocation.invoke(&context_, invocation.node);
+        s != kTfLiteOk) {
+      auto err = ReportOpError(
+          &context_, *invocation.node,
+          nodes_and_registration_[invocation.node_index].second,
+          invocation.node_index, "failed to invoke");
+      return s == kTfLiteCancelled ? s : err;
+    }
+  }
+  return kTfLiteOk;
+}
+
+TfLiteStatus Subgraph::PlanNodeLevels() {
+  if (NumInterOpThreads() < 2 || !CanExecuteNodeLevelsConcurrently()) {
+    execution_plan_levels_.clear();
+    return kTfLiteOk;
+  }
+  // Stable sorting the nodes by level keeps them in dependency order.
+  const std::vector<int> levels = GetNodeLevels(*CreateGraphInfo());
+  std::vector<int> order(execution_plan_.size());
+  for (int i = 0; i < order.size(); ++i) order[i] = i;
+  std::stable_sort(order.begin(), order.end(),
+                   [&](int a, int b) { return levels[a] < levels[b]; });
+  std::vector<int> execution_plan(order.size());
+  execution_plan_levels_.resize(order.size());
+  for (int i = 0; i < order.size(); ++i) {
+    execution_plan[i] = execution_plan_[order[i]];
+    execution_plan_levels_[i] = levels[order[i]];
+  }
+  if (execution_plan != execution_plan_) {
+    execution_plan_ = std::move(execution_plan);
+    // The allocations were planned for the previous order.
+    if (memory_planner_) {
+      TF_LITE_ENSURE_STATUS(memory_planner_->PlanAllocations());
+    }
+  }
+  return kTfLiteOk;
+}
+
+bool Subgraph::CanExecuteNodeLevelsConcurrently() const {
+  // The order in which variables are read and assigned isn't given by the
+  // data dependencies.
+  if (!variables_.empty()) return false;
+  for (int node_index : execution_plan_) {
+    const TfLiteNode& node = nodes_and_registration_[node_index].first;
+    const TfLiteRegistration& registration =
+        nodes_and_registration_[node_index].second;
+    // Delegate and custom kernels aren't required to be reentrant, and the
+    // control flow kernels may invoke the same subgraphs.
+    if (node.delegate != nullptr || node.might_have_side_effect ||
+        registration.builtin_code == kTfLiteBuiltinCustom ||
+        registration.builtin_code == kTfLiteBuiltinStablehloWhile ||
+        registration.builtin_code == kTfLiteBuiltinStablehloComposite) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool Subgraph::CanInvokeNodeLevelsConcurrently() const {
+  if (execution_plan_levels_.size() != execution_plan_.size() ||
+      !memory_planned_for_node_levels_ || execution_plan_.empty() ||
+      profiler_ != nullptr || weight_streamer_ != nullptr ||
+      next_execution_plan_index_to_prepare_ != execution_plan_.size()) {
+    return false;
+  }
+  // Dynamic tensors are allocated and the following nodes prepared while the
+  // nodes are invoked.
+  for (const TfLiteTensor& tensor : tensors_) {
+    if (tensor.allocation_type == kTfLiteDynamic ||
+        tensor.delegate != nullptr) {
+      return false;
+    }
+  }
+  return true;
+}
+
+TfLiteStatus Subgraph::InvokeNodeLevelsConcurrently() {
+  const int num_threads = NumInterOpThreads();
+  if (!inter_op_executor_ || inter_op_executor_->num_threads() != num_threads) {
+    inter_op_executor_ = std::make_unique<InterOpExecutor>(num_threads);
+  }
+  inter_op_executor_->RefreshContexts(context_);
+
+  std::vector<TfLiteStatus> statuses;
+  for (int begin = 0; begin < execution_plan_.size();) {
+    int end = begin + 1;
+    while (end < execution_plan_.size() &&
+           execution_plan_levels_[end] == execution_plan_levels_[begin]) {
+      ++end;
+    }
+
+    if (check_cancelled_func_ != nullptr &&
+        check_cancelled_func_(cancellation_data_)) {
+      ReportError("Client requested cancel during Invoke()");
+      return kTfLiteError;
+    }
+    if (continue_invocation_ && !continue_invocation_->test_and_set()) {
+      // `Cancel` is called and cancellation flag is flipped.
+      ReportError("Client requested cancel during Invoke()");
+      return kTfLiteCancelled;
+    }
+
+    statuses.assign(end - begin, kTfLiteOk);
+    if (end - begin == 1) {
+      // A node alone in its level can use all the threads of `context_`.
+      const int node_index = execution_plan_[begin];
+      statuses[0] = OpInvoke(nodes_and_registration_[node_index].second,
+                             &nodes_and_registration_[node_index].first);
+    } else {
+      inter_op_executor_->ParallelFor(end - begin, [&](int worker, int i) {
+        const int node_index = execution_plan_[begin + i];
+        statuses[i] = OpInvoke(nodes_and_registration_[node_index].second,
+                               &nodes_and_registration_[node_index].first,
+                               inter_op_executor_->context(worker));
+      });
+    }
+    for (int i = 0; i < statuses.size(); ++i) {
+      if (statuses[i] == kTfLiteOk) continue;
+      const int node_index = execution_plan_[begin + i];
+      auto err = ReportOpError(&context_,
+                               nodes_and_registration_[node_index].first,
+                               nodes_and_registration_[node_index].second,
+                               node_index, "failed to invoke");
+      return statuses[i] == kTfLiteCancelled ? statuses[i] : err;
+    }
+    begin = end;
+  }
+  return kTfLiteOk;
+}
+
 TfLiteStatus Subgraph::ResizeTensor(TfLiteContext* context,
                                     TfLiteTensor* tensor,
                                     TfLiteIntArray* new_size) {
@@ -1997,6 +2230,8 @@ TfLiteStatus Subgraph::SetExecutionPlan(const std::vector<int>& new_plan) {
                                   node_index < nodes_and_registration_.size());
   }
   execution_plan_ = new_plan;
+  invoke_node_levels_concurrently_ = false;
+  frozen_invocation_plan_.clear();
   return kTfLiteOk;
 }
 
@@ -2135,6 +2370,8 @@ TfLiteStatus Subgraph::UndoAllDelegates() {
   // Reset execution plan.
   execution_plan_ = pre_delegation_execution_plan_;
   pre_delegation_execution_plan_.clear();
+  invoke_node_levels_concurrently_ = false;
+  frozen_invocation_plan_.clear();
 
   // Handling FP16 delegation (if applies).
   //
@@ -2462,6 +2699,26 @@ void Subgraph::InitializeTensorReleaseMap() {
   }
 }
 
+void Subgraph::PlanWeightStreaming() {
+  if (!ShouldStreamMmappedWeights()) {
+    weight_streamer_.reset();
+    return;
+  }
+  std::vector<const TfLiteIntArray*> node_inputs;
+  node_inputs.reserve(execution_plan_.size());
+  for (int node_index : execution_plan_) {
+    node_inputs.push_back(nodes_and_registration_[node_index].first.inputs);
+  }
+  weight_streamer_ =
+      std::make_unique<WeightStreamer>(options_->GetWeightPrefetchWindow());
+  weight_streamer_->Plan(tensors_.data(), tensors_.size(), node_inputs);
+  if (weight_streamer_->num_weights() == 0) {
+    weight_streamer_.reset();
+    return;
+  }
+  weight_streamer_->ReleaseAll();
+}
+
 void Subgraph::MaybeReleaseDynamicTensors(const TfLiteNode& node,
                                           size_t node_index) {
   if (!ShouldReleaseDynamicTensors()) return;
@@ -35,7 +35,9 @@ limitations under the License.
 #include "tensorflow/lite/core/api/op_resolver.h"
 #include "tensorflow/lite/core/api/profiler.h"
 #include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/core/inter_op_executor.h"
 #include "tensorflow/lite/core/macros.h"
+#include "tensorflow/lite/core/weight_streamer.h"
 #include "tensorflow/lite/experimental/resource/initialization_status.h"
 #include "tensorflow/lite/experimental/resource/resource_base.h"
 #include "tensorflow/lite/graph_info.h"
@@ -481,6 +483,27 @@ class Subgraph {
     return (options_ && (options_->GetDynamicAllocationForLargeTensors() > 0));
   }
 
+  // WARNING: This is an experimental API and subject to change.
+  // True if the memory arena size should be minimized, see
+  // `InterpreterOptions::SetMinimizeArenaSize`.
+  bool ShouldMinimizeArenaSize() const {
+    return (options_ && options_->GetMinimizeArenaSize());
+  }
+
+  // WARNING: This is an experimental API and subject to change.
+  // The number of threads executing the independent nodes concurrently, see
+  // `InterpreterOptions::SetNumInterOpThreads`.
+  int NumInterOpThreads() const {
+    return options_ ? options_->GetNumInterOpThreads() : 1;
+  }
+
+  // WARNING: This is an experimental API and subject to change.
+  // True if the mmapped weights are streamed, see
+  // `InterpreterOptions::SetStreamMmappedWeights`.
+  bool ShouldStreamMmappedWeights() const {
+    return (options_ && options_->GetStreamMmappedWeights());
+  }
+
   // WARNING: This is an experimental API and subject to change.
   // Remove unused inputs of the subgraph. It checks usage of inputs and mark it
   // as kTfLiteOptionalTensor if the input is not used in graph execution.
@@ -686,7 +709,14 @@ class Subgraph {
   TfLiteStatus OpPrepare(const TfLiteRegistration& op_reg, TfLiteNode* node);
 
   // Invoke the operator represented by 'node'.
-  TfLiteStatus OpInvoke(const TfLiteRegistration& op_reg, TfLiteNode* node);
+  TfLiteStatus OpInvoke(const TfLiteRegistration& op_reg, TfLiteNode* node) {
+    return OpInvoke(op_reg, node, &context_);
+  }
+
+  // Invoke the operator represented by 'node', giving it `context`, which is
+  // either `context_` or a copy of it.
+  TfLiteStatus OpInvoke(const TfLiteRegistration& op_reg, TfLiteNode* node,
+                        TfLiteContext* context);
 
   // Call OpPrepare() for as many ops as possible, allocating memory for their
   // tensors. If an op containing dynamic tensors is found, preparation will be
@@ -727,6 +757,31 @@ class Subgraph {
   // Does not report invoke status through profiler.
   TfLiteStatus InvokeImpl();
 
+  // If the independent nodes of the subgraph can be executed concurrently,
+  // orders the execution plan by node level (see `GetNodeLevels`) and fills
+  // `execution_plan_levels_`. Otherwise clears `execution_plan_levels_`.
+  TfLiteStatus PlanNodeLevels();
+
+  // Returns true if no node of the execution plan has to be executed in plan
+  // order, e.g. because it has side effects or is delegated.
+  bool CanExecuteNodeLevelsConcurrently() const;
+
+  // Returns true if the subgraph, just invoked node by node, can be invoked
+  // by `InvokeNodeLevelsConcurrently` from now on.
+  bool CanInvokeNodeLevelsConcurrently() const;
+
+  // Invokes the nodes of each level of the execution plan concurrently on
+  // `inter_op_executor_`, once the nodes of the lower levels have returned.
+  TfLiteStatus InvokeNodeLevelsConcurrently();
+
+  // Fills `frozen_invocation_plan_` if the subgraph, just invoked node by
+  // node, can skip the checks done before invoking each node from now on.
+  // Clears it otherwise.
+  void FreezeInvocationPlan();
+
+  // Invokes the nodes of `frozen_invocation_plan_` in order.
+  TfLiteStatus InvokeFrozenPlan();
+
   // Allow a delegate to look at the graph and modify the graph to handle
   // parts of the graph themselves. After this is called, the graph may
   // contain new nodes that replace 1 more nodes.
@@ -938,6 +993,10 @@ class Subgraph {
   // last operation that uses the tensor as input.
   void InitializeTensorReleaseMap();
 
+  // Plans `weight_streamer_` for the execution plan if the mmapped weights
+  // are streamed, and releases the weights read while preparing the nodes.
+  void PlanWeightStreaming();
+
   // May allocate dynamic tensor memory of node outputs. It's used when
   // `EnsureDynamicTensorsAreReleased` or`UseDynamicAllocationForLargeTensors`
   // API is used.
@@ -1087,6 +1146,40 @@ class Subgraph {
 
   std::unique_ptr<MemoryPlanner> memory_planner_;
 
+  // The level of each node of the execution plan, ordered by level, if its
+  // levels are to be executed concurrently. Empty otherwise.
+  std::vector<int> execution_plan_levels_;
+
+  // Whether `memory_planner_` lets the nodes of a level of the execution plan
+  // be executed concurrently.
+  bool memory_planned_for_node_levels_ = false;
+
+  // Whether `Invoke` executes the nodes of each level concurrently. Only set
+  // once the subgraph has been invoked node by node after its tensors were
+  // allocated, which also initializes the state the kernels create lazily.
+  bool invoke_node_levels_concurrently_ = false;
+
+  // A node of the execution plan and the kernel function invoking it.
+  struct FrozenNodeInvocation {
+    TfLiteStatus (*invoke)(TfLiteContext* context, TfLiteNode* node);
+    TfLiteNode* node;
+    int node_index;
+  };
+
+  // The execution plan with the kernel functions resolved, when `Invoke`
+  // doesn't have to check the tensors of each node before invoking it: built
+  // after the subgraph has been invoked node by node, and cleared whenever the
+  // tensors are allocated again or the execution plan changes.
+  std::vector<FrozenNodeInvocation> frozen_invocation_plan_;
+
+  // Executes the nodes of a level concurrently, created on the first
+  // concurrent invocation.
+  std::unique_ptr<InterOpExecutor> inter_op_executor_;
+
+  // Streams the mmapped weights during `Invoke` if
+  // `ShouldStreamMmappedWeights()`, planned by `AllocateTensors`.
+  std::unique_ptr<WeightStreamer> weight_streamer_;
+
   // Maps tensor index to custom allocation for all applicable tensors.
   std::map<int, TfLiteCustomAllocation> custom_allocations_;
 
@@ -0,0 +1,147 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/core/weight_streamer.h"
+
+#if !defined(_WIN32)
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/lite/allocation.h"
+#include "tensorflow/lite/core/c/common.h"
+
+namespace tflite {
+namespace {
+
+size_t PageSize() {
+#if defined(MADV_DONTNEED)
+  static const size_t page_size = sysconf(_SC_PAGE_SIZE);
+  return page_size;
+#else
+  return 0;
+#endif
+}
+
+// Returns whether `tensor` is a constant read from a file mapping.
+bool IsMmappedWeight(const TfLiteTensor& tensor) {
+  if (tensor.allocation_type != kTfLiteMmapRo || tensor.data.raw == nullptr ||
+      tensor.bytes == 0 || tensor.allocation == nullptr) {
+    return false;
+  }
+  const Allocation* allocation =
+      reinterpret_cast<const Allocation*>(tensor.allocation);
+  if (allocation->type() != Allocation::Type::kMMap) return false;
+  const char* base = reinterpret_cast<const char*>(allocation->base());
+  return tensor.data.raw_const >= base &&
+         tensor.data.raw_const + tensor.bytes <= base + allocation->bytes();
+}
+
+void Advise(const std::vector<WeightStreamer::Region>& regions, int advice) {
+#if defined(MADV_DONTNEED)
+  for (const WeightStreamer::Region& region : regions) {
+    // Errors are ignored: the advice is only a hint.
+    madvise(const_cast<char*>(region.begin), region.size, advice);
+  }
+#endif
+}
+
+}  // namespace
+
+WeightStreamer::WeightStreamer(int prefetch_window)
+    : prefetch_window_(std::max(prefetch_window, 0)) {}
+
+void WeightStreamer::Plan(
+    const TfLiteTensor* tensors, size_t num_tensors,
+    const std::vector<const TfLiteIntArray*>& node_inputs) {
+  prefetch_.assign(node_inputs.size(), {});
+  release_.assign(node_inputs.size(), {});
+  num_weights_ = 0;
+  const size_t page_size = PageSize();
+  if (page_size == 0) return;
+
+  struct Use {
+    size_t bytes;
+    int first;
+    int last;
+  };
+  std::map<const char*, Use> uses;
+  for (int i = 0; i < node_inputs.size(); ++i) {
+    for (int j = 0; j < node_inputs[i]->size; ++j) {
+      const int tensor_index = node_inputs[i]->data[j];
+      if (tensor_index < 0 || tensor_index >= num_tensors) continue;
+      const TfLiteTensor& tensor = tensors[tensor_index];
+      if (!IsMmappedWeight(tensor)) continue;
+      auto [it, inserted] =
+          uses.try_emplace(tensor.data.raw_const, Use{tensor.bytes, i, i});
+      it->second.bytes = std::max(it->second.bytes, tensor.bytes);
+      it->second.last = i;
+    }
+  }
+
+  for (const auto& [data, use] : uses) {
+    const uintptr_t begin = reinterpret_cast<uintptr_t>(data);
+    const uintptr_t end = begin + use.bytes;
+    // The pages overlapping the weight are prefetched, and only the pages
+    // entirely within it released.
+    const uintptr_t outer_begin = begin / page_size * page_size;
+    const uintptr_t outer_end = (end + page_size - 1) / page_size * page_size;
+    prefetch_[use.first].push_back({reinterpret_cast<const char*>(outer_begin),
+                                    outer_end - outer_begin});
+    const uintptr_t inner_begin = (begin + page_size - 1) / page_size *
+                                  page_size;
+    const uintptr_t inner_end = end / page_size * page_size;
+    if (inner_begin < inner_end) {
+      release_[use.last].push_back({reinterpret_cast<const char*>(inner_begin),
+                                    inner_end - inner_begin});
+    }
+    ++num_weights_;
+  }
+}
+
+void WeightStreamer::BeforeNode(int execution_plan_index) const {
+#if defined(MADV_WILLNEED)
+  if (execution_plan_index >= prefetch_.size()) return;
+  const int first = execution_plan_index == 0
+                        ? 0
+                        : execution_plan_index + prefetch_window_;
+  const int last = std::min<int>(execution_plan_index + prefetch_window_,
+                                 prefetch_.size() - 1);
+  for (int i = first; i <= last; ++i) Advise(prefetch_[i], MADV_WILLNEED);
+#endif
+}
+
+void WeightStreamer::AfterNode(int execution_plan_index) const {
+#if defined(MADV_DONTNEED)
+  if (execution_plan_index >= release_.size()) return;
+  Advise(release_[execution_plan_index], MADV_DONTNEED);
+#endif
+}
+
+void WeightStreamer::ReleaseAll() const {
+#if defined(MADV_DONTNEED)
+  for (const std::vector<Region>& regions : release_) {
+    Advise(regions, MADV_DONTNEED);
+  }
+#endif
+}
+
+}  // namespace tflite
@@ -0,0 +1,91 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_CORE_WEIGHT_STREAMER_H_
+#define TENSORFLOW_LITE_CORE_WEIGHT_STREAMER_H_
+
+#include <cstddef>
+#include <vector>
+
+#include "tensorflow/lite/core/c/common.h"
+
+namespace tflite {
+
+// Streams the constant tensors of a subgraph mapped from the model file by an
+// `MMAPAllocation`, so that only the weights of the nodes being executed are
+// resident: the pages of the weights of a node are prefetched a few nodes
+// before it with `madvise(MADV_WILLNEED)`, and released after their last node
+// with `madvise(MADV_DONTNEED)`. Since the mappings are read-only and backed
+// by the file, a released page read again is faulted in from the file.
+//
+// Only the pages entirely within a weight are released, so that the weights
+// sharing a page with it aren't released before their last node. This does
+// nothing on the platforms without `madvise`.
+//
+// WARNING: This is an experimental API and subject to change.
+class WeightStreamer {
+ public:
+  // A page-aligned range of the mapped model file.
+  struct Region {
+    const char* begin;
+    size_t size;
+  };
+
+  // `prefetch_window` is the number of nodes whose weights are prefetched
+  // ahead of the node being executed.
+  explicit WeightStreamer(int prefetch_window);
+
+  // Plans the streaming of the mmapped constant tensors among `tensors` read
+  // by the nodes executed in order, whose inputs are `node_inputs`. A weight
+  // read by several tensors, e.g. a buffer shared by two constants, is
+  // released after the last node reading any of them.
+  void Plan(const TfLiteTensor* tensors, size_t num_tensors,
+            const std::vector<const TfLiteIntArray*>& node_inputs);
+
+  // Prefetches the weights of the nodes `execution_plan_index` (when it is
+  // the first node) to `execution_plan_index + prefetch_window`.
+  void BeforeNode(int execution_plan_index) const;
+
+  // Releases the weights last read by the node `execution_plan_index`.
+  void AfterNode(int execution_plan_index) const;
+
+  // Releases all the streamed weights, e.g. the ones read by the kernels and
+  // delegates while preparing the nodes, before the first node is executed.
+  void ReleaseAll() const;
+
+  // The regions prefetched before, and released after, the node
+  // `execution_plan_index`.
+  const std::vector<Region>& regions_first_read_by(
+      int execution_plan_index) const {
+    return prefetch_[execution_plan_index];
+  }
+  const std::vector<Region>& regions_last_read_by(
+      int execution_plan_index) const {
+    return release_[execution_plan_index];
+  }
+
+  // The number of distinct weights streamed.
+  size_t num_weights() const { return num_weights_; }
+
+ private:
+  int prefetch_window_;
+  size_t num_weights_ = 0;
+  // By execution plan index, the weights first and last read by the node.
+  std::vector<std::vector<Region>> prefetch_;
+  std::vector<std::vector<Region>> release_;
+};
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_CORE_WEIGHT_STREAMER_H_
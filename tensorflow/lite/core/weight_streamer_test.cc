@@ -0,0 +1,117 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/core/weight_streamer.h"
+
+#include <unistd.h>
+
+#include <cstddef>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "tensorflow/lite/allocation.h"
+#include "tensorflow/lite/array.h"
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/stderr_reporter.h"
+
+namespace tflite {
+namespace {
+
+TEST(WeightStreamerTest, StreamsTheMmappedWeightsOfEachNode) {
+  if (!MMAPAllocation::IsSupported()) GTEST_SKIP();
+  const size_t page_size = sysconf(_SC_PAGE_SIZE);
+  const std::string path = ::testing::TempDir() + "/weight_streamer_model";
+  {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    for (size_t i = 0; i < 4 * page_size; ++i) file.put(i % 251);
+  }
+  MMAPAllocation allocation(path.c_str(), DefaultErrorReporter());
+  ASSERT_TRUE(allocation.valid());
+  const char* base = reinterpret_cast<const char*>(allocation.base());
+
+  // Tensor 0 spans parts of 3 pages, tensor 1 is the last page and tensor 2
+  // shares the buffer of tensor 0. Tensor 3 isn't a constant.
+  TfLiteTensor tensors[4] = {};
+  auto set_weight = [&](TfLiteTensor& tensor, size_t offset, size_t bytes) {
+    tensor.allocation_type = kTfLiteMmapRo;
+    tensor.allocation = &allocation;
+    tensor.data.raw_const = base + offset;
+    tensor.bytes = bytes;
+  };
+  set_weight(tensors[0], 100, 2 * page_size);
+  set_weight(tensors[1], 3 * page_size, page_size);
+  set_weight(tensors[2], 100, page_size);
+  tensors[3].allocation_type = kTfLiteArenaRw;
+  std::vector<char> arena(16);
+  tensors[3].data.raw = arena.data();
+  tensors[3].bytes = arena.size();
+
+  IntArrayUniquePtr node_0 = BuildTfLiteArray({0, 1, 3});
+  IntArrayUniquePtr node_1 = BuildTfLiteArray({2, kTfLiteOptionalTensor});
+  IntArrayUniquePtr node_2 = BuildTfLiteArray({1, 3});
+
+  WeightStreamer streamer(/*prefetch_window=*/1);
+  streamer.Plan(tensors, 4, {node_0.get(), node_1.get(), node_2.get()});
+  EXPECT_EQ(streamer.num_weights(), 2);
+
+  ASSERT_EQ(streamer.regions_first_read_by(0).size(), 2);
+  EXPECT_EQ(streamer.regions_first_read_by(0)[0].begin, base);
+  EXPECT_EQ(streamer.regions_first_read_by(0)[0].size, 3 * page_size);
+  EXPECT_EQ(streamer.regions_first_read_by(0)[1].begin, base + 3 * page_size);
+  EXPECT_EQ(streamer.regions_first_read_by(0)[1].size, page_size);
+  EXPECT_TRUE(streamer.regions_first_read_by(1).empty());
+  EXPECT_TRUE(streamer.regions_first_read_by(2).empty());
+
+  // Only the page entirely within tensor 0 is released, after tensor 2 is
+  // read.
+  EXPECT_TRUE(streamer.regions_last_read_by(0).empty());
+  ASSERT_EQ(streamer.regions_last_read_by(1).size(), 1);
+  EXPECT_EQ(streamer.regions_last_read_by(1)[0].begin, base + page_size);
+  EXPECT_EQ(streamer.regions_last_read_by(1)[0].size, page_size);
+  ASSERT_EQ(streamer.regions_last_read_by(2).size(), 1);
+  EXPECT_EQ(streamer.regions_last_read_by(2)[0].begin, base + 3 * page_size);
+
+  // The released pages are read again from the file.
+  streamer.ReleaseAll();
+  for (int i = 0; i < 3; ++i) {
+    streamer.BeforeNode(i);
+    streamer.AfterNode(i);
+  }
+  for (size_t i = 0; i < 4 * page_size; ++i) {
+    ASSERT_EQ(static_cast<unsigned char>(base[i]), i % 251);
+  }
+}
+
+TEST(WeightStreamerTest, IgnoresWeightsNotMappedFromAFile) {
+  std::vector<char> buffer(64);
+  MemoryAllocation allocation(buffer.data(), buffer.size(),
+                              DefaultErrorReporter());
+  TfLiteTensor tensor = {};
+  tensor.allocation_type = kTfLiteMmapRo;
+  tensor.allocation = &allocation;
+  tensor.data.raw_const = reinterpret_cast<const char*>(allocation.base());
+  tensor.bytes = buffer.size();
+  IntArrayUniquePtr node = BuildTfLiteArray({0});
+
+  WeightStreamer streamer(/*prefetch_window=*/1);
+  streamer.Plan(&tensor, 1, {node.get()});
+  EXPECT_EQ(streamer.num_weights(), 0);
+  EXPECT_TRUE(streamer.regions_first_read_by(0).empty());
+}
+
+}  // namespace
+}  // namespace tflite
@@ -318,8 +318,11 @@ absl::Status InferenceContext::InitFromGpuModel(
                                  &create_info, &env->context()));
 
   gpu_info_ = env->device().GetInfo();
-  if (gpu_info_.opencl_info.IsCLVK() &&
-      gpu_info_.SupportsExtension("cl_khr_command_buffer")) {
+  // The whole inference is recorded once in a command buffer and replayed on
+  // each invocation, which removes the host overhead of enqueueing every
+  // kernel. Current PowerVR drivers have issues with big command buffers.
+  if (gpu_info_.SupportsExtension("cl_khr_command_buffer") &&
+      !gpu_info_.IsPowerVR()) {
     use_command_buffer_ = true;
   }
 
@@ -799,6 +802,8 @@ absl::Status InferenceContext::UpdateParams() {
   for (auto& node : nodes_) {
     RETURN_IF_ERROR(node.cl_operation.UpdateParams());
   }
+  // The arguments of the kernels are captured when they are recorded.
+  command_buffer_ = nullptr;
   return absl::OkStatus();
 }
 
@@ -822,6 +827,10 @@ absl::Status InferenceContext::SetTensor(const ValueId& tensor_id,
       }
     }
   }
+  if (!external_tensor_to_nodes_[tensor_id].empty()) {
+    // The commands recorded read or write the previous tensor.
+    command_buffer_ = nullptr;
+  }
   return absl::OkStatus();
 }
 
@@ -849,16 +858,33 @@ void InferenceContext::PrepareExternal() {
 }
 
 absl::Status InferenceContext::AddCommandBufferToQueue(CLCommandQueue* queue) {
-  if (command_buffer_ == nullptr) {
-    command_buffer_ = std::make_unique<CLCommandBuffer>();
-    RETURN_IF_ERROR(command_buffer_->Init(queue));
-    RETURN_IF_ERROR(AddToCommandBuffer(command_buffer_->GetCommandBuffer()));
-    RETURN_IF_ERROR(command_buffer_->Finalize());
+  // A command buffer is recorded for a queue and can only be enqueued to it.
+  if (command_buffer_ == nullptr || command_buffer_queue_ != queue->queue()) {
+    command_buffer_ = nullptr;
+    auto command_buffer = std::make_unique<CLCommandBuffer>();
+    RETURN_IF_ERROR(command_buffer->Init(queue));
+    RETURN_IF_ERROR(AddToCommandBuffer(command_buffer->GetCommandBuffer()));
+    RETURN_IF_ERROR(command_buffer->Finalize());
+    command_buffer_ = std::move(command_buffer);
+    command_buffer_queue_ = queue->queue();
   }
   RETURN_IF_ERROR(command_buffer_->Enqueue(queue));
   return absl::OkStatus();
 }
 
+absl::Status InferenceContext::AddNodesToQueue(CLCommandQueue* queue) {
+  int counter = 0;
+  for (auto& node : nodes_) {
+    RETURN_IF_ERROR(node.cl_operation.AddToQueue(queue));
+    counter++;
+    if (execution_hints_.flush_periodically &&
+        counter % execution_hints_.flush_period == 0) {
+      clFlush(queue->queue());
+    }
+  }
+  return absl::OkStatus();
+}
+
 void InferenceContext::FlushQueue(CLCommandQueue* queue) {
   if (!gpu_info_.opencl_info.IsCLVK()) {
     clFlush(queue->queue());
@@ -876,18 +902,18 @@ absl::Status InferenceContext::AddToQueue(CLCommandQueue* queue) {
     RETURN_IF_ERROR(
         queue->EnqueueEvent(&execution_hints_.prev_enqueue_start_point));
   }
-  if (use_command_buffer_) {
+  if (use_command_buffer_ && command_buffer_ == nullptr) {
+    // Drivers advertising cl_khr_command_buffer can still fail to record
+    // some kernels, in which case the kernels are enqueued one by one.
+    if (!AddCommandBufferToQueue(queue).ok()) {
+      use_command_buffer_ = false;
+      command_buffer_ = nullptr;
+      RETURN_IF_ERROR(AddNodesToQueue(queue));
+    }
+  } else if (use_command_buffer_) {
     RETURN_IF_ERROR(AddCommandBufferToQueue(queue));
   } else {
-    int counter = 0;
-    for (auto& node : nodes_) {
-      RETURN_IF_ERROR(node.cl_operation.AddToQueue(queue));
-      counter++;
-      if (execution_hints_.flush_periodically &&
-          counter % execution_hints_.flush_period == 0) {
-        clFlush(queue->queue());
-      }
-    }
+    RETURN_IF_ERROR(AddNodesToQueue(queue));
   }
   if (execution_hints_.need_flush) {
     clFlush(queue->queue());
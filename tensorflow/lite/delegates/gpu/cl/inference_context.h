@@ -157,7 +157,12 @@ class InferenceContext {
   absl::Status ClarifyTimeWithCommandBuffer(ProfilingCommandQueue* queue,
                                             ProfilingInfo* result);
 
+  // Enqueues the command buffer recording all the nodes, recording it on the
+  // first call and after the arguments of the kernels change.
   absl::Status AddCommandBufferToQueue(CLCommandQueue* queue);
+  // Enqueues the kernels of the nodes one by one, flushing the queue
+  // following `execution_hints_`.
+  absl::Status AddNodesToQueue(CLCommandQueue* queue);
 
   struct ExecutionHints {
     bool need_flush = false;
@@ -209,6 +214,8 @@ class InferenceContext {
 
   bool use_command_buffer_ = false;
   std::unique_ptr<CLCommandBuffer> command_buffer_ = nullptr;
+  // The queue `command_buffer_` was recorded for.
+  cl_command_queue command_buffer_queue_ = nullptr;
 
   GpuInfo gpu_info_;
 };
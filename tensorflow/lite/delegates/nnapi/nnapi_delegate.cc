@@ -6504,6 +6504,12 @@ void StatefulNnApiDelegate::StatefulNnApiDelegateConstructorImpl(
   delegate_data_.disallow_nnapi_cpu = options.disallow_nnapi_cpu;
   delegate_data_.max_number_delegated_partitions =
       options.max_number_delegated_partitions;
+  delegate_data_.use_partition_cost_model = options.use_partition_cost_model;
+  delegate_data_.partition_accelerator_speedup =
+      options.partition_accelerator_speedup;
+  delegate_data_.partition_transfer_cost_per_byte =
+      options.partition_transfer_cost_per_byte;
+  delegate_data_.partition_overhead = options.partition_overhead;
   delegate_data_.allow_fp16 = options.allow_fp16;
   delegate_data_.execution_priority = options.execution_priority;
   delegate_data_.max_compilation_timeout_duration_ns =
@@ -6580,6 +6586,12 @@ const StatefulNnApiDelegate::Options StatefulNnApiDelegate::GetOptions(
   options.disallow_nnapi_cpu = delegate_data->disallow_nnapi_cpu;
   options.max_number_delegated_partitions =
       delegate_data->max_number_delegated_partitions;
+  options.use_partition_cost_model = delegate_data->use_partition_cost_model;
+  options.partition_accelerator_speedup =
+      delegate_data->partition_accelerator_speedup;
+  options.partition_transfer_cost_per_byte =
+      delegate_data->partition_transfer_cost_per_byte;
+  options.partition_overhead = delegate_data->partition_overhead;
   options.allow_fp16 = delegate_data->allow_fp16;
   options.execution_priority = delegate_data->execution_priority;
   options.max_compilation_timeout_duration_ns =
@@ -7032,11 +7044,35 @@ TfLiteStatus StatefulNnApiDelegate::DoPrepare(TfLiteContext* context,
     return kTfLiteOk;
   }
 
-  TF_LITE_ENSURE_STATUS(
-      LimitDelegatedPartitions(delegate_options.max_number_delegated_partitions,
-                               std::vector<TfLiteDelegateParams>(
-                                   params_array, params_array + num_partitions),
-                               &nodes_to_delegate));
+  std::vector<TfLiteDelegateParams> partitions(params_array,
+                                               params_array + num_partitions);
+  if (delegate_options.use_partition_cost_model) {
+    delegates::PartitionCostModel cost_model;
+    cost_model.delegate_speedup =
+        delegate_options.partition_accelerator_speedup;
+    cost_model.transfer_cost_per_byte =
+        delegate_options.partition_transfer_cost_per_byte;
+    cost_model.partition_overhead = delegate_options.partition_overhead;
+    // Only the partitions worth delegating compete for the partition limit.
+    partitions.erase(
+        std::remove_if(partitions.begin(), partitions.end(),
+                       [&](const TfLiteDelegateParams& partition) {
+                         return !delegates::IsPartitionWorthDelegating(
+                             context, partition, cost_model);
+                       }),
+        partitions.end());
+    nodes_to_delegate.clear();
+    for (const TfLiteDelegateParams& partition : partitions) {
+      nodes_to_delegate.insert(nodes_to_delegate.end(),
+                               partition.nodes_to_replace->data,
+                               partition.nodes_to_replace->data +
+                                   partition.nodes_to_replace->size);
+    }
+  }
+
+  TF_LITE_ENSURE_STATUS(LimitDelegatedPartitions(
+      delegate_options.max_number_delegated_partitions, std::move(partitions),
+      &nodes_to_delegate));
 
   auto nodes_to_delegate_int_array = BuildTfLiteArray(nodes_to_delegate);
 
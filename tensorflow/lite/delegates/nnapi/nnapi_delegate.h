@@ -93,6 +93,26 @@ class StatefulNnApiDelegate : public TfLiteDelegate {
     // of number of nodes and selecting them until the limit is reached.
     int max_number_delegated_partitions = 3;
 
+    // If true, the partitions whose estimated latency on the accelerators,
+    // including the transfers of their inputs and outputs, isn't lower than
+    // the one of their nodes on CPU are left to the CPU. This avoids the
+    // small partitions between CPU nodes, whose transfers cost more than they
+    // save. The estimate is made by delegates::PartitionCostModel, with the
+    // parameters below, before applying max_number_delegated_partitions.
+    bool use_partition_cost_model = false;
+
+    // The ratio of the latency of the nodes on CPU to their latency on the
+    // accelerators, used if use_partition_cost_model is true.
+    float partition_accelerator_speedup = 4.0f;
+
+    // The latency of transferring a byte of the inputs or outputs of a
+    // partition, and the fixed latency of an execution of a partition, in
+    // multiply-accumulates on CPU. Used if use_partition_cost_model is true.
+    // The values depend on the device, and can be calibrated by timing the
+    // execution of a few models.
+    float partition_transfer_cost_per_byte = 1.0f;
+    float partition_overhead = 100000.0f;
+
     // allow fp32 computation to be run in fp16.
     bool allow_fp16 = false;
 
@@ -326,6 +346,12 @@ class StatefulNnApiDelegate : public TfLiteDelegate {
     // Maximum number of NNAPI partition to delegate. Zero or negative means
     // no limit. Copied from StatefulNnApiDelegate::Options
     int max_number_delegated_partitions;
+    // Options of the partition cost model. Copied from
+    // StatefulNnApiDelegate::Options
+    bool use_partition_cost_model;
+    float partition_accelerator_speedup;
+    float partition_transfer_cost_per_byte;
+    float partition_overhead;
     // allow fp32 computation to be run in fp16.
     bool allow_fp16;
     // Specifies the relative priority for executions of the model.
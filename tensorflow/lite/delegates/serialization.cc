@@ -20,6 +20,7 @@ limitations under the License.
 #include <fstream>
 #include <iostream>
 #else
+#include <dirent.h>
 #include <errno.h>
 #include <fcntl.h>
 #include <sys/file.h>
@@ -32,9 +33,12 @@ limitations under the License.
 #include <time.h>
 
 #include <algorithm>
+#include <atomic>
+#include <cstddef>
 #include <cstdint>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "tensorflow/lite/core/c/common.h"
@@ -46,6 +50,7 @@ namespace delegates {
 namespace {
 
 static const char kDelegatedNodesSuffix[] = "_dnodes";
+static const char kEntrySuffix[] = ".bin";
 
 // Farmhash Fingerprint
 inline uint64_t CombineFingerprints(uint64_t l, uint64_t h) {
@@ -69,10 +74,70 @@ inline std::string JoinPath(const std::string& path1,
 inline std::string GetFilePath(const std::string& cache_dir,
                                const std::string& model_token,
                                const uint64_t fingerprint) {
-  auto file_name = (model_token + "_" + std::to_string(fingerprint) + ".bin");
+  auto file_name =
+      (model_token + "_" + std::to_string(fingerprint) + kEntrySuffix);
   return JoinPath(cache_dir, file_name);
 }
 
+// Appends the size, type & shape of `tensor`, so that entries of graphs
+// resized to different shapes with the same number of bytes don't collide.
+void AppendTensorDetails(const TfLiteTensor& tensor,
+                         std::vector<int32_t>* data) {
+  data->push_back(tensor.bytes);
+  data->push_back(tensor.type);
+  if (tensor.dims == nullptr) {
+    data->push_back(-1);
+    return;
+  }
+  data->push_back(tensor.dims->size);
+  data->insert(data->end(), tensor.dims->data,
+               tensor.dims->data + tensor.dims->size);
+}
+
+#if !defined(_WIN32)
+// Removes the least recently used entries in `cache_dir` until they fit in
+// `max_bytes`, keeping the one at `keep_path`.
+void EnforceCacheSizeLimit(const std::string& cache_dir, size_t max_bytes,
+                           const std::string& keep_path) {
+  DIR* dir = opendir(cache_dir.c_str());
+  if (dir == nullptr) return;
+  // (modification time, size, path) of every entry.
+  std::vector<std::pair<std::pair<time_t, size_t>, std::string>> entries;
+  size_t total_bytes = 0;
+  const size_t suffix_size = strlen(kEntrySuffix);
+  while (const struct dirent* dir_entry = readdir(dir)) {
+    const std::string name = dir_entry->d_name;
+    if (name.size() <= suffix_size ||
+        name.compare(name.size() - suffix_size, suffix_size, kEntrySuffix) !=
+            0) {
+      continue;
+    }
+    std::string path = JoinPath(cache_dir, name);
+    struct stat file_stat;
+    if (stat(path.c_str(), &file_stat) < 0 || !S_ISREG(file_stat.st_mode)) {
+      continue;
+    }
+    total_bytes += file_stat.st_size;
+    if (path != keep_path) {
+      entries.push_back(
+          {{file_stat.st_mtime, static_cast<size_t>(file_stat.st_size)},
+           std::move(path)});
+    }
+  }
+  closedir(dir);
+
+  std::sort(entries.begin(), entries.end());
+  for (const auto& entry : entries) {
+    if (total_bytes <= max_bytes) break;
+    if (unlink(entry.second.c_str()) == 0) {
+      total_bytes -= entry.first.second;
+      TFLITE_LOG(TFLITE_LOG_INFO, "Evicted serialized data at %s",
+                 entry.second.c_str());
+    }
+  }
+}
+#endif  // !defined(_WIN32)
+
 }  // namespace
 
 std::string StrFingerprint(const void* data, const size_t num_bytes) {
@@ -82,19 +147,32 @@ std::string StrFingerprint(const void* data, const size_t num_bytes) {
 
 SerializationEntry::SerializationEntry(const std::string& cache_dir,
                                        const std::string& model_token,
-                                       const uint64_t fingerprint)
+                                       const uint64_t fingerprint,
+                                       const size_t max_cache_size_bytes)
     : cache_dir_(cache_dir),
       model_token_(model_token),
-      fingerprint_(fingerprint) {}
+      fingerprint_(fingerprint),
+      max_cache_size_bytes_(max_cache_size_bytes) {}
+
+std::string SerializationEntry::GetFilePath() const {
+  return ::tflite::delegates::GetFilePath(cache_dir_, model_token_,
+                                          fingerprint_);
+}
 
 TfLiteStatus SerializationEntry::SetData(TfLiteContext* context,
                                          const char* data,
                                          const size_t size) const {
-  auto filepath = GetFilePath(cache_dir_, model_token_, fingerprint_);
-  // Temporary file to write data to.
-  const std::string temp_filepath =
-      JoinPath(cache_dir_, (model_token_ + std::to_string(fingerprint_) +
-                            std::to_string(time(nullptr))));
+  auto filepath = GetFilePath();
+  // Temporary file to write data to, unique to this write so that concurrent
+  // writers of the same entry don't interleave their data.
+  static std::atomic<int> num_writes(0);
+  std::string temp_filename = model_token_ + std::to_string(fingerprint_) +
+                              std::to_string(time(nullptr)) + "_" +
+                              std::to_string(num_writes.fetch_add(1));
+#if !defined(_WIN32)
+  temp_filename += "_" + std::to_string(getpid());
+#endif  // !defined(_WIN32)
+  const std::string temp_filepath = JoinPath(cache_dir_, temp_filename);
 
 #if defined(_WIN32)
   std::ofstream out_file(temp_filepath.c_str(), std::ios_base::binary);
@@ -114,7 +192,7 @@ TfLiteStatus SerializationEntry::SetData(TfLiteContext* context,
 #else   // !defined(_WIN32)
   // This method only works on unix/POSIX systems.
   const int fd = open(temp_filepath.c_str(),
-                      O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, 0600);
+                      O_WRONLY | O_TRUNC | O_CREAT | O_CLOEXEC, 0600);
   if (fd < 0) {
     TF_LITE_KERNEL_LOG(context, "Failed to open for writing: %s",
                        temp_filepath.c_str());
@@ -152,6 +230,9 @@ TfLiteStatus SerializationEntry::SetData(TfLiteContext* context,
                        filepath.c_str(), std::strerror(errno));
     return kTfLiteDelegateDataWriteError;
   }
+  if (max_cache_size_bytes_ > 0) {
+    EnforceCacheSizeLimit(cache_dir_, max_cache_size_bytes_, filepath);
+  }
 #endif  // defined(_WIN32)
 
   TFLITE_LOG(TFLITE_LOG_INFO, "Wrote serialized data for model %s (%d B) to %s",
@@ -163,7 +244,7 @@ TfLiteStatus SerializationEntry::SetData(TfLiteContext* context,
 TfLiteStatus SerializationEntry::GetData(TfLiteContext* context,
                                          std::string* data) const {
   if (!data) return kTfLiteError;
-  auto filepath = GetFilePath(cache_dir_, model_token_, fingerprint_);
+  auto filepath = GetFilePath();
 
 #if defined(_WIN32)
   std::ifstream cache_stream(filepath,
@@ -196,6 +277,9 @@ TfLiteStatus SerializationEntry::GetData(TfLiteContext* context,
                        std::strerror(errno));
     return kTfLiteDelegateDataReadError;
   }
+  // Marks the entry as recently used for the size limit. Failing to do so
+  // only makes it more likely to be evicted.
+  if (max_cache_size_bytes_ > 0) futimens(fd, nullptr);
 
   struct stat file_stat;
   if (fstat(fd, &file_stat) < 0) {
@@ -253,18 +337,17 @@ SerializationEntry Serialization::GetEntryImpl(
   fingerprint = CombineFingerprints(fingerprint, custom_str_fingerprint);
 
   // Incorporate context details, if provided.
-  // A quick heuristic involving graph tensors to 'fingerprint' a
-  // tflite::Subgraph. We don't consider the execution plan, since it could be
-  // in flux if the delegate uses this method during
+  // A quick heuristic involving the sizes, types & shapes of graph tensors to
+  // 'fingerprint' a tflite::Subgraph. We don't consider the execution plan,
+  // since it could be in flux if the delegate uses this method during
   // ReplaceNodeSubsetsWithDelegateKernels (eg in kernel Init).
   if (context) {
     std::vector<int32_t> context_data;
     // Number of tensors can be large.
     const int tensors_to_consider = std::min<int>(context->tensors_size, 100);
-    context_data.reserve(1 + tensors_to_consider);
     context_data.push_back(context->tensors_size);
     for (int i = 0; i < tensors_to_consider; ++i) {
-      context_data.push_back(context->tensors[i].bytes);
+      AppendTensorDetails(context->tensors[i], &context_data);
     }
     const uint64_t context_fingerprint =
         ::util::Fingerprint64(reinterpret_cast<char*>(context_data.data()),
@@ -273,24 +356,22 @@ SerializationEntry Serialization::GetEntryImpl(
   }
 
   // Incorporate delegated partition details, if provided.
-  // A quick heuristic that considers the nodes & I/O tensor sizes to
-  // fingerprint TfLiteDelegateParams.
+  // A quick heuristic that considers the nodes & I/O tensor sizes, types &
+  // shapes to fingerprint TfLiteDelegateParams.
   if (delegate_params) {
     std::vector<int32_t> partition_data;
     auto* nodes = delegate_params->nodes_to_replace;
     auto* input_tensors = delegate_params->input_tensors;
     auto* output_tensors = delegate_params->output_tensors;
-    partition_data.reserve(nodes->size + input_tensors->size +
-                           output_tensors->size);
     partition_data.insert(partition_data.end(), nodes->data,
                           nodes->data + nodes->size);
     for (int i = 0; i < input_tensors->size; ++i) {
-      auto& tensor = context->tensors[input_tensors->data[i]];
-      partition_data.push_back(tensor.bytes);
+      AppendTensorDetails(context->tensors[input_tensors->data[i]],
+                          &partition_data);
     }
     for (int i = 0; i < output_tensors->size; ++i) {
-      auto& tensor = context->tensors[output_tensors->data[i]];
-      partition_data.push_back(tensor.bytes);
+      AppendTensorDetails(context->tensors[output_tensors->data[i]],
+                          &partition_data);
     }
     const uint64_t partition_fingerprint =
         ::util::Fingerprint64(reinterpret_cast<char*>(partition_data.data()),
@@ -300,7 +381,8 @@ SerializationEntry Serialization::GetEntryImpl(
 
   // Get a fingerprint-specific lock that is passed to the SerializationKey, to
   // ensure noone else gets access to an equivalent SerializationKey.
-  return SerializationEntry(cache_dir_, model_token_, fingerprint);
+  return SerializationEntry(cache_dir_, model_token_, fingerprint,
+                            max_cache_size_bytes_);
 }
 
 TfLiteStatus SaveDelegatedNodes(TfLiteContext* context,
@@ -15,6 +15,7 @@ limitations under the License.
 #ifndef TENSORFLOW_LITE_DELEGATES_SERIALIZATION_H_
 #define TENSORFLOW_LITE_DELEGATES_SERIALIZATION_H_
 
+#include <cstddef>
 #include <cstdint>
 #include <map>
 #include <string>
@@ -119,6 +120,12 @@ class SerializationEntry {
   //   kTfLiteError for unexpected error.
   TfLiteStatus GetData(TfLiteContext* context, std::string* data) const;
 
+  // Returns the path of the file storing the data of this entry, for
+  // delegates which map the data instead of reading it, e.g. the XNNPACK
+  // weight cache. Such files count towards the size limit of the caching
+  // directory, but aren't locked against concurrent eviction.
+  std::string GetFilePath() const;
+
   // Non-copyable.
   SerializationEntry(const SerializationEntry&) = delete;
   SerializationEntry& operator=(const SerializationEntry&) = delete;
@@ -127,7 +134,8 @@ class SerializationEntry {
  protected:
   SerializationEntry(const std::string& cache_dir,
                      const std::string& model_token,
-                     const uint64_t fingerprint_64);
+                     const uint64_t fingerprint_64,
+                     const size_t max_cache_size_bytes);
 
   // Caching directory.
   const std::string cache_dir_;
@@ -135,6 +143,8 @@ class SerializationEntry {
   const std::string model_token_;
   // For most applications, 64-bit fingerprints are enough.
   const uint64_t fingerprint_ = 0;
+  // Size limit of the caching directory, 0 if there is none.
+  const size_t max_cache_size_bytes_ = 0;
 };
 
 // Encapsulates all the data that clients can use to parametrize a Serialization
@@ -154,6 +164,11 @@ typedef struct SerializationParams {
   // On Android, `getCodeCacheDir()` is recommended.
   // Required.
   const char* cache_dir;
+  // Maximum total size of the data stored in `cache_dir`, for all the models.
+  // Writing an entry past it removes the least recently used entries. 0 means
+  // no limit. The limit isn't enforced on Windows.
+  // Optional.
+  size_t max_cache_size_bytes = 0;
 } SerializationParams;
 
 // Utility to enable caching abilities for delegates.
@@ -164,7 +179,9 @@ class Serialization {
  public:
   // Initialize a Serialization interface for applicable delegates.
   explicit Serialization(const SerializationParams& params)
-      : cache_dir_(params.cache_dir), model_token_(params.model_token) {}
+      : cache_dir_(params.cache_dir),
+        model_token_(params.model_token),
+        max_cache_size_bytes_(params.max_cache_size_bytes) {}
 
   // Generate a SerializationEntry that incorporates both `custom_key` &
   // `context` into its unique fingerprint.
@@ -199,6 +216,7 @@ class Serialization {
 
   const std::string cache_dir_;
   const std::string model_token_;
+  const size_t max_cache_size_bytes_;
 };
 
 // Helper for delegates to save their delegation decisions (which nodes to
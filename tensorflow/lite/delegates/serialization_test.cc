@@ -14,7 +14,13 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/lite/delegates/serialization.h"
 
+#if !defined(_WIN32)
+#include <sys/stat.h>
+#include <utime.h>
+#endif  // !defined(_WIN32)
+
 #include <cstdint>
+#include <cstdio>
 #include <string>
 #include <vector>
 
@@ -199,6 +205,51 @@ TEST_F(SerializationTest, KernelEntryFingerprint) {
           .GetFingerprint());
 }
 
+TEST_F(SerializationTest, ShapeFingerprint) {
+  const std::string model_token = "mobilenet";
+  const std::string dir = "/test/dir";
+  const std::string delegate = "xnnpack";
+  SerializationParams serialization_params = {model_token.c_str(), dir.c_str()};
+  Serialization serialization(serialization_params);
+
+  TfLiteContext context = GenerateTfLiteContext(/*num_tensors*/ 10);
+  TfLiteDelegateParams partition = GenerateTfLiteDelegateParams(
+      /*num_nodes=*/2, /*num_input_tensors=*/1, /*num_output_tensors=*/1);
+  TfLiteIntArray* dims = TfLiteIntArrayCreate(2);
+  owned_arrays_.push_back(dims);
+  dims->data[0] = 2;
+  dims->data[1] = 3;
+  // The input of the partition.
+  context.tensors[2].dims = dims;
+  const uint64_t ref_delegate_fingerprint =
+      serialization.GetEntryForDelegate(delegate, &context).GetFingerprint();
+  const uint64_t ref_kernel_fingerprint =
+      serialization.GetEntryForKernel(delegate, &context, &partition)
+          .GetFingerprint();
+
+  // Same number of bytes, different shape.
+  dims->data[0] = 3;
+  dims->data[1] = 2;
+  EXPECT_NE(
+      ref_delegate_fingerprint,
+      serialization.GetEntryForDelegate(delegate, &context).GetFingerprint());
+  EXPECT_NE(ref_kernel_fingerprint,
+            serialization.GetEntryForKernel(delegate, &context, &partition)
+                .GetFingerprint());
+
+  // Same shape, different type.
+  dims->data[0] = 2;
+  dims->data[1] = 3;
+  context.tensors[2].type = kTfLiteInt32;
+  EXPECT_NE(ref_kernel_fingerprint,
+            serialization.GetEntryForKernel(delegate, &context, &partition)
+                .GetFingerprint());
+  context.tensors[2].type = kTfLiteNoType;
+  EXPECT_EQ(ref_kernel_fingerprint,
+            serialization.GetEntryForKernel(delegate, &context, &partition)
+                .GetFingerprint());
+}
+
 TEST_F(SerializationTest, ModelTokenFingerprint) {
   std::string model_token1 = "model1";
   std::string model_token2 = "model2";
@@ -310,6 +361,51 @@ TEST_F(SerializationTest, SerializationData) {
   }
 }
 
+#if !defined(_WIN32)
+TEST_F(SerializationTest, CacheSizeLimit) {
+  const float value = 1.5;
+  const std::string model_token = "model1";
+  const std::string test_dir = getSerializationDir() + "/size_limit";
+  mkdir(test_dir.c_str(), 0700);
+  TfLiteContext context = GenerateTfLiteContext(/*num_tensors*/ 30);
+
+  SerializationParams serialization_params = {model_token.c_str(),
+                                              test_dir.c_str()};
+  // Room for two entries.
+  serialization_params.max_cache_size_bytes = 2 * sizeof(value);
+  Serialization serialization(serialization_params);
+  auto entry1 = serialization.GetEntryForDelegate("entry1", &context);
+  auto entry2 = serialization.GetEntryForDelegate("entry2", &context);
+  auto entry3 = serialization.GetEntryForDelegate("entry3", &context);
+  for (const auto* entry : {&entry1, &entry2, &entry3}) {
+    remove(entry->GetFilePath().c_str());
+  }
+
+  ASSERT_EQ(entry1.SetData(&context, reinterpret_cast<const char*>(&value),
+                           sizeof(value)),
+            kTfLiteOk);
+  ASSERT_EQ(entry2.SetData(&context, reinterpret_cast<const char*>(&value),
+                           sizeof(value)),
+            kTfLiteOk);
+  // Makes the first entry older than the second one, then reads it back.
+  struct utimbuf times = {1000, 1000};
+  ASSERT_EQ(utime(entry1.GetFilePath().c_str(), &times), 0);
+  times = {2000, 2000};
+  ASSERT_EQ(utime(entry2.GetFilePath().c_str(), &times), 0);
+  std::string read_back;
+  ASSERT_EQ(entry1.GetData(&context, &read_back), kTfLiteOk);
+
+  // The least recently used entry is removed.
+  ASSERT_EQ(entry3.SetData(&context, reinterpret_cast<const char*>(&value),
+                           sizeof(value)),
+            kTfLiteOk);
+  EXPECT_EQ(entry1.GetData(&context, &read_back), kTfLiteOk);
+  EXPECT_EQ(entry2.GetData(&context, &read_back),
+            kTfLiteDelegateDataNotFound);
+  EXPECT_EQ(entry3.GetData(&context, &read_back), kTfLiteOk);
+}
+#endif  // !defined(_WIN32)
+
 TEST_F(SerializationTest, CachingDelegatedNodes) {
   std::string model_token = "model1";
   std::string test_dir = getSerializationDir();
@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow/lite/delegates/utils.h"
 
 #include <algorithm>
+#include <cstddef>
 #include <cstdint>
 #include <cstring>
 #include <set>
@@ -23,6 +24,7 @@ limitations under the License.
 #include <vector>
 
 #include "tensorflow/lite/builtin_ops.h"
+#include "tensorflow/lite/c/builtin_op_data.h"
 #include "tensorflow/lite/c/c_api_types.h"
 #include "tensorflow/lite/c/common.h"
 #include "tensorflow/lite/context_util.h"
@@ -74,6 +76,95 @@ TfLiteStatus MarkSubgraphAsDelegationSkippable(const TfLiteContext* context,
       ->MarkSubgraphAsDelegationSkippable(subgraph_index);
 }
 
+namespace {
+
+// Returns the size of dimension `dim` of the input `input_index` of `node`,
+// counted from the end if negative, or 1 if it doesn't exist.
+int GetInputDim(TfLiteContext* context, const TfLiteNode* node,
+                int input_index, int dim) {
+  if (input_index >= node->inputs->size) return 1;
+  const int tensor_index = node->inputs->data[input_index];
+  if (tensor_index == kTfLiteOptionalTensor) return 1;
+  const TfLiteIntArray* dims = context->tensors[tensor_index].dims;
+  if (dims == nullptr) return 1;
+  if (dim < 0) dim += dims->size;
+  return dim >= 0 && dim < dims->size ? dims->data[dim] : 1;
+}
+
+// Returns the number of bytes of the non-constant `tensors`, transferred
+// between the CPU and the delegate at each invocation of a partition.
+size_t GetTransferredBytes(TfLiteContext* context,
+                           const TfLiteIntArray* tensors) {
+  size_t bytes = 0;
+  if (tensors == nullptr) return bytes;
+  for (int tensor_index : TfLiteIntArrayView(tensors)) {
+    if (tensor_index == kTfLiteOptionalTensor) continue;
+    const TfLiteTensor& tensor = context->tensors[tensor_index];
+    if (tensor.allocation_type == kTfLiteMmapRo) continue;
+    bytes += tensor.bytes;
+  }
+  return bytes;
+}
+
+}  // namespace
+
+float EstimateNodeCost(TfLiteContext* context, const TfLiteNode* node,
+                       const TfLiteRegistration* registration) {
+  float num_output_elements = 0;
+  for (int tensor_index : TfLiteIntArrayView(node->outputs)) {
+    if (tensor_index == kTfLiteOptionalTensor) continue;
+    num_output_elements += NumElements(&context->tensors[tensor_index]);
+  }
+  switch (registration->builtin_code) {
+    case kTfLiteBuiltinConv2d:
+      // The filter is [output_depth, height, width, input_depth].
+      return num_output_elements * GetInputDim(context, node, 1, 1) *
+             GetInputDim(context, node, 1, 2) *
+             GetInputDim(context, node, 1, 3);
+    case kTfLiteBuiltinDepthwiseConv2d:
+      // The filter is [1, height, width, output_depth].
+      return num_output_elements * GetInputDim(context, node, 1, 1) *
+             GetInputDim(context, node, 1, 2);
+    case kTfLiteBuiltinFullyConnected:
+      // The weights are [num_units, input_size].
+      return num_output_elements * GetInputDim(context, node, 1, -1);
+    case kTfLiteBuiltinBatchMatmul: {
+      const auto* params =
+          reinterpret_cast<const TfLiteBatchMatMulParams*>(node->builtin_data);
+      const bool adj_x = params != nullptr && params->adj_x;
+      return num_output_elements *
+             GetInputDim(context, node, 0, adj_x ? -2 : -1);
+    }
+    default:
+      return num_output_elements;
+  }
+}
+
+bool IsPartitionWorthDelegating(TfLiteContext* context,
+                                const TfLiteDelegateParams& partition,
+                                const PartitionCostModel& cost_model) {
+  float cpu_cost = 0;
+  for (int node_index : TfLiteIntArrayView(partition.nodes_to_replace)) {
+    TfLiteNode* node;
+    TfLiteRegistration* registration;
+    if (context->GetNodeAndRegistration(context, node_index, &node,
+                                        &registration) != kTfLiteOk) {
+      return false;
+    }
+    cpu_cost += cost_model.node_cost
+                    ? cost_model.node_cost(context, node, registration)
+                    : EstimateNodeCost(context, node, registration);
+  }
+  const size_t transferred_bytes =
+      GetTransferredBytes(context, partition.input_tensors) +
+      GetTransferredBytes(context, partition.output_tensors);
+  const float delegated_cost =
+      cpu_cost / cost_model.delegate_speedup +
+      transferred_bytes * cost_model.transfer_cost_per_byte +
+      cost_model.partition_overhead;
+  return delegated_cost < cpu_cost;
+}
+
 TfLiteStatus GraphPartitionHelper::PartitionImpl(
     std::set<std::string>* unsupported_nodes_info, int start_node_index,
     int end_node_index) {
@@ -138,6 +229,18 @@ std::vector<int> GraphPartitionHelper::GetNodesOfFirstNLargestPartitionsImpl(
   return ops_to_replace;
 }
 
+std::vector<int> GraphPartitionHelper::GetNodesOfPartitionsWorthDelegating(
+    const PartitionCostModel& cost_model) const {
+  std::vector<int> ops_to_replace;
+  for (const auto p : partitions_) {
+    if (!IsPartitionWorthDelegating(context_, *p, cost_model)) continue;
+    auto nodes = p->nodes_to_replace;
+    ops_to_replace.insert(ops_to_replace.end(), nodes->data,
+                          nodes->data + nodes->size);
+  }
+  return ops_to_replace;
+}
+
 TfLiteStatus GraphPartitionHelper::PrepareSupportedNodes(
     std::set<std::string>* unsupported_nodes_info, int start_node_index,
     int end_node_index) {
@@ -96,6 +96,37 @@ using IsNodeSupportedFn =
     std::function<bool(TfLiteContext*, TfLiteNode*, TfLiteRegistration*,
                        std::string* unsupported_details)>;
 
+// Returns a rough estimate of the cost of running `node` on CPU, in
+// multiply-accumulates: the number of elements of its outputs, times the size
+// of the reduction for the convolutions and the matrix multiplications.
+float EstimateNodeCost(TfLiteContext* context, const TfLiteNode* node,
+                       const TfLiteRegistration* registration);
+
+// A model of the latency of a delegated partition, in the unit of the node
+// costs, to leave to the CPU the partitions whose speedup doesn't pay for the
+// transfer of their inputs and outputs. The parameters depend on the
+// accelerator and can be calibrated by timing a few partitions on the device.
+struct PartitionCostModel {
+  // The ratio of the cost of the nodes on CPU to their cost on the delegate.
+  float delegate_speedup = 4.0f;
+  // The cost of transferring a byte of a non-constant input or output of a
+  // partition between the CPU and the delegate.
+  float transfer_cost_per_byte = 1.0f;
+  // The fixed cost of an invocation of a partition on the delegate.
+  float partition_overhead = 100000.0f;
+  // Returns the cost of a node on CPU, `EstimateNodeCost` if empty.
+  std::function<float(TfLiteContext*, const TfLiteNode*,
+                      const TfLiteRegistration*)>
+      node_cost;
+};
+
+// Returns whether running the nodes of `partition` on the delegate, including
+// the transfers of its inputs and outputs, is estimated by `cost_model` to be
+// faster than running them on CPU.
+bool IsPartitionWorthDelegating(TfLiteContext* context,
+                                const TfLiteDelegateParams& partition,
+                                const PartitionCostModel& cost_model);
+
 // A utility class to help model graph parition.
 // Note the class *needs* to be used in TfLiteDelegate::Prepare.
 class GraphPartitionHelper {
@@ -149,6 +180,12 @@ class GraphPartitionHelper {
     return GetNodesOfFirstNLargestPartitionsImpl(n, min_nodes_per_partition);
   }
 
+  // Returns a list of node indices of all nodes from the partitions that are
+  // worth delegating according to `cost_model`, see
+  // `IsPartitionWorthDelegating`.
+  std::vector<int> GetNodesOfPartitionsWorthDelegating(
+      const PartitionCostModel& cost_model) const;
+
   int num_total_nodes() const { return num_total_nodes_; }
   int num_supported_nodes() const { return num_supported_nodes_; }
   int num_partitions() const { return partitions_.size(); }
@@ -21,8 +21,10 @@ limitations under the License.
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
+#include "tensorflow/lite/builtin_ops.h"
 #include "tensorflow/lite/core/c/common.h"
 #include "tensorflow/lite/core/subgraph.h"
+#include "tensorflow/lite/util.h"
 
 namespace tflite {
 namespace delegates {
@@ -294,6 +296,67 @@ TEST(GraphPartitionHelper, CheckPartitionsWithSupportedNodeList) {
   EXPECT_THAT(nodes, testing::ElementsAreArray({0, 3, 7, 8, 2, 4, 9}));
 }
 
+TEST(GraphPartitionHelper, CheckPartitionsWorthDelegating) {
+  // The mocked TfLiteContext has 4 partitions: {1}, {0,3,7,8}, {2,4,9}, {5,6}.
+  MockTfLiteContext mocked_context;
+  // Each partition reads a float tensor of 100 elements, 20 for {2,4,9}.
+  std::vector<TfLiteTensor> tensors(2);
+  tensors[0].allocation_type = kTfLiteArenaRw;
+  tensors[0].bytes = 100 * sizeof(float);
+  tensors[1].allocation_type = kTfLiteArenaRw;
+  tensors[1].bytes = 20 * sizeof(float);
+  mocked_context.tensors = tensors.data();
+  for (int i = 0; i < mocked_context.num_delegate_params(); ++i) {
+    TfLiteDelegateParams& params = mocked_context.delegate_params()[i];
+    params.input_tensors = TfLiteIntArrayCreate(1);
+    params.input_tensors->data[0] = i == 2 ? 1 : 0;
+    params.output_tensors = TfLiteIntArrayCreate(0);
+  }
+  GraphPartitionHelper helper(&mocked_context, IsNodeSupported);
+  EXPECT_EQ(kTfLiteOk, helper.Partition(nullptr));
+
+  PartitionCostModel cost_model;
+  cost_model.node_cost = [](TfLiteContext*, const TfLiteNode*,
+                            const TfLiteRegistration*) { return 400.0f; };
+  cost_model.delegate_speedup = 4.0f;
+  cost_model.transfer_cost_per_byte = 1.0f;
+  cost_model.partition_overhead = 300.0f;
+  // Each delegated node saves 300, each partition costs 300 plus the transfer
+  // of its input: {1} and {5,6} are slower than on CPU.
+  EXPECT_THAT(helper.GetNodesOfPartitionsWorthDelegating(cost_model),
+              testing::ElementsAreArray({0, 3, 7, 8, 2, 4, 9}));
+
+  cost_model.partition_overhead = 0.0f;
+  cost_model.transfer_cost_per_byte = 0.5f;
+  EXPECT_THAT(helper.GetNodesOfPartitionsWorthDelegating(cost_model),
+              testing::ElementsAreArray({1, 0, 3, 7, 8, 2, 4, 9, 5, 6}));
+
+  cost_model.delegate_speedup = 1.0f;
+  EXPECT_TRUE(helper.GetNodesOfPartitionsWorthDelegating(cost_model).empty());
+}
+
+TEST(UtilsTest, EstimateNodeCostOfFullyConnected) {
+  std::vector<TfLiteTensor> tensors(3);
+  tensors[0].dims = ConvertVectorToTfLiteIntArray({2, 16});
+  tensors[1].dims = ConvertVectorToTfLiteIntArray({8, 16});
+  tensors[2].dims = ConvertVectorToTfLiteIntArray({2, 8});
+  TfLiteContext context;
+  context.tensors = tensors.data();
+  TfLiteNode node{};
+  node.inputs = ConvertVectorToTfLiteIntArray({0, 1, kTfLiteOptionalTensor});
+  node.outputs = ConvertVectorToTfLiteIntArray({2});
+  TfLiteRegistration registration{};
+
+  registration.builtin_code = kTfLiteBuiltinFullyConnected;
+  EXPECT_EQ(EstimateNodeCost(&context, &node, &registration), 2 * 8 * 16);
+  registration.builtin_code = kTfLiteBuiltinAdd;
+  EXPECT_EQ(EstimateNodeCost(&context, &node, &registration), 2 * 8);
+
+  TfLiteIntArrayFree(node.inputs);
+  TfLiteIntArrayFree(node.outputs);
+  for (TfLiteTensor& tensor : tensors) TfLiteIntArrayFree(tensor.dims);
+}
+
 }  // namespace
 }  // namespace delegates
 }  // namespace tflite
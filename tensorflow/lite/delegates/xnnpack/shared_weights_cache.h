@@ -0,0 +1,82 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_DELEGATES_XNNPACK_SHARED_WEIGHTS_CACHE_H_
+#define TENSORFLOW_LITE_DELEGATES_XNNPACK_SHARED_WEIGHTS_CACHE_H_
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+
+#include "tensorflow/lite/delegates/xnnpack/xnnpack_delegate.h"
+
+namespace tflite {
+namespace xnnpack {
+
+// A cache of the weights packed by the XNNPACK delegates of several
+// interpreters, e.g. interpreters built from one model to serve requests
+// concurrently, which then hold a single copy of the packed weights.
+//
+// Set it with `InterpreterOptions::SetXNNPackWeightsCache` in the options of
+// each `InterpreterBuilder`: the XNNPACK delegate applied by default to these
+// interpreters packs the weights into the cache the first time, and
+// soft-finalizes it once the first interpreter is prepared. The delegates of
+// the other interpreters then look up the same packed weights. The cache is
+// deleted when the last interpreter and the last reference to it are.
+//
+// The interpreters should be built from the same model: after the finalization,
+// the delegates can only look up the packed weights already in the cache, and
+// an interpreter of another model falls back to the builtin kernels.
+class SharedWeightsCache {
+ public:
+  // Creates a cache which can hold `size` bytes of packed weights before
+  // growing, or the default size if `size` is 0. Returns nullptr on error.
+  static std::shared_ptr<SharedWeightsCache> Create(size_t size = 0) {
+    TfLiteXNNPackDelegateWeightsCache* cache =
+        size == 0 ? TfLiteXNNPackDelegateWeightsCacheCreate()
+                  : TfLiteXNNPackDelegateWeightsCacheCreateWithSize(size);
+    if (cache == nullptr) return nullptr;
+    return std::shared_ptr<SharedWeightsCache>(new SharedWeightsCache(cache));
+  }
+
+  ~SharedWeightsCache() { TfLiteXNNPackDelegateWeightsCacheDelete(cache_); }
+
+  SharedWeightsCache(const SharedWeightsCache&) = delete;
+  SharedWeightsCache& operator=(const SharedWeightsCache&) = delete;
+
+  TfLiteXNNPackDelegateWeightsCache* get() const { return cache_; }
+
+  // Soft-finalizes the cache the first time it is called, once a delegate has
+  // packed its weights. Returns false on error.
+  bool Finalize() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!finalized_) {
+      finalized_ = TfLiteXNNPackDelegateWeightsCacheFinalizeSoft(cache_);
+    }
+    return finalized_;
+  }
+
+ private:
+  explicit SharedWeightsCache(TfLiteXNNPackDelegateWeightsCache* cache)
+      : cache_(cache) {}
+
+  TfLiteXNNPackDelegateWeightsCache* cache_;
+  std::mutex mutex_;
+  bool finalized_ = false;
+};
+
+}  // namespace xnnpack
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_DELEGATES_XNNPACK_SHARED_WEIGHTS_CACHE_H_
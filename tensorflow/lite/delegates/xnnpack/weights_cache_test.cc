@@ -21,8 +21,10 @@ limitations under the License.
 #include <gtest/gtest.h>
 #include "tensorflow/lite/core/interpreter_builder.h"
 #include "tensorflow/lite/delegates/xnnpack/conv_2d_tester.h"
+#include "tensorflow/lite/delegates/xnnpack/shared_weights_cache.h"
 #include "tensorflow/lite/delegates/xnnpack/xnnpack_delegate.h"
 #include "tensorflow/lite/interpreter.h"
+#include "tensorflow/lite/interpreter_options.h"
 #include "tensorflow/lite/mutable_op_resolver.h"
 
 namespace tflite {
@@ -43,6 +45,20 @@ class DummyOpResolver : public MutableOpResolver {
   static TfLiteStatus Invoke(TfLiteContext*, TfLiteNode*) { return kTfLiteOk; }
 };
 
+// Applies the XNNPACK delegate by default, like the builtin op resolver.
+class DummyOpResolverWithXNNPACK : public DummyOpResolver {
+ public:
+  DummyOpResolverWithXNNPACK() {
+    delegate_creators_.push_back([](TfLiteContext* context) {
+      TfLiteXNNPackDelegateOptions options =
+          TfLiteXNNPackDelegateOptionsDefault();
+      return std::unique_ptr<TfLiteDelegate, void (*)(TfLiteDelegate*)>(
+          TfLiteXNNPackDelegateCreateWithThreadpool(&options, context),
+          TfLiteXNNPackDelegateDelete);
+    });
+  }
+};
+
 TEST(XNNPACK_WEIGHTS_CACHE, WithSize) {
   std::vector<char> buffer = Conv2DTester().CreateTfLiteModel();
   const Model* model = GetModel(buffer.data());
@@ -178,6 +194,38 @@ TEST(XNNPACK_WEIGHTS_CACHE, SoftFinalization) {
   ASSERT_EQ(kTfLiteOk, interpreter2->Invoke());
 }
 
+TEST(XNNPACK_WEIGHTS_CACHE, SharedInInterpreterOptions) {
+  std::vector<char> buffer = Conv2DTester().CreateTfLiteModel();
+  const Model* model = GetModel(buffer.data());
+  DummyOpResolverWithXNNPACK resolver;
+
+  std::shared_ptr<SharedWeightsCache> weights_cache =
+      SharedWeightsCache::Create();
+  ASSERT_NE(weights_cache, nullptr);
+  InterpreterOptions options;
+  options.SetXNNPackWeightsCache(weights_cache);
+
+  // The first interpreter packs the weights and finalizes the cache, and the
+  // others reuse them.
+  std::vector<std::unique_ptr<Interpreter>> interpreters(3);
+  for (auto& interpreter : interpreters) {
+    ASSERT_EQ(kTfLiteOk, InterpreterBuilder(model, resolver,
+                                            DefaultErrorReporter(), &options)(
+                             &interpreter));
+    ASSERT_EQ(kTfLiteOk, interpreter->AllocateTensors());
+    EXPECT_EQ(1, interpreter->execution_plan().size());
+    ASSERT_EQ(kTfLiteOk, interpreter->Invoke());
+  }
+  // The cache is already finalized: finalizing it again is a no-op.
+  EXPECT_TRUE(weights_cache->Finalize());
+
+  // The interpreters keep the cache alive.
+  weights_cache.reset();
+  for (auto& interpreter : interpreters) {
+    ASSERT_EQ(kTfLiteOk, interpreter->Invoke());
+  }
+}
+
 // Dummy class to use with parameterized test.
 class WeightsCacheTest : public testing::TestWithParam<size_t> {};
 
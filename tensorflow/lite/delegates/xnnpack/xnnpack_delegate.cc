@@ -42,8 +42,10 @@ limitations under the License.
 #include "tensorflow/lite/core/c/common.h"
 #include "tensorflow/lite/core/subgraph.h"
 #include "tensorflow/lite/delegates/xnnpack/quantization_util.h"
+#include "tensorflow/lite/delegates/xnnpack/shared_weights_cache.h"
 #include "tensorflow/lite/delegates/xnnpack/weight_cache.h"
 #include "tensorflow/lite/kernels/cpu_backend_context.h"
+#include "tensorflow/lite/kernels/fused_elementwise_program.h"
 #include "tensorflow/lite/kernels/internal/compatibility.h"
 #include "tensorflow/lite/kernels/internal/tensor_ctypes.h"
 #include "tensorflow/lite/kernels/internal/utils/sparsity_format_converter.h"
@@ -537,6 +539,20 @@ class Delegate {
     delegate_.flags = GetXNNPackDelegateFlags();
     workspace_.reset(workspace);
 
+    // The delegate applied by default to an interpreter shares the packed
+    // weights with the other interpreters given the same cache in their
+    // options.
+    if (!options_.weights_cache && !options_.weight_cache_file_path &&
+        context != nullptr && context->impl_ != nullptr) {
+      const InterpreterOptions* interpreter_options =
+          reinterpret_cast<::tflite::Subgraph*>(context->impl_)->GetOptions();
+      if (interpreter_options != nullptr &&
+          interpreter_options->GetXNNPackWeightsCache() != nullptr) {
+        shared_weights_cache_ = interpreter_options->GetXNNPackWeightsCache();
+        options_.weights_cache = shared_weights_cache_->get();
+      }
+    }
+
     // If no weight cache is provided, add one when requested.
     if (!options_.weights_cache) {
       if (options_.weight_cache_file_path) {
@@ -729,6 +745,9 @@ class Delegate {
   std::unordered_set<int> static_unpack_nodes_;
   // Set of indices of tensors with unpacked static sparse weights.
   std::unordered_set<int> static_sparse_weights_;
+  // Mapping from the index of a FusedElementwise node to the scalar
+  // constants of its program, which XNNPACK reads while it runs.
+  std::unordered_map<int, std::vector<float>> fused_elementwise_constants_;
 #if !defined(__EMSCRIPTEN__) || defined(__EMSCRIPTEN_PTHREADS__)
   // Thread pool with smart-pointer for lifetime management.
   std::unique_ptr<pthreadpool, decltype(&pthreadpool_destroy)> threadpool_{
@@ -746,6 +765,11 @@ class Delegate {
   // If no weight cache is provided and a cache is set in the delegate options,
   // this will be used as a weight cache.
   MMapWeightCacheProvider weight_cache_provider_;
+
+  // The cache shared with the delegates of other interpreters, set in the
+  // options of the interpreter. Keeps the cache alive as long as the runtimes
+  // of this delegate refer to it.
+  std::shared_ptr<SharedWeightsCache> shared_weights_cache_;
 };
 
 class Subgraph {
@@ -1171,6 +1195,12 @@ class Subgraph {
         return kTfLiteError;
       }
     }
+    if (delegate->shared_weights_cache_ != nullptr &&
+        !delegate->shared_weights_cache_->Finalize()) {
+      TF_LITE_KERNEL_LOG(context,
+                         "XNNPack delegate failed to finalize shared cache.");
+      return kTfLiteError;
+    }
 
     if (enable_subgraph_reshaping) {
       xnn_status status = xnn_status_invalid_state;
@@ -2978,6 +3008,12 @@ class Subgraph {
           return VisitMediaPipeUnpoolingNode(
               subgraph, delegate, context, node_index, node, context->tensors,
               &pool_params, input_output_tensors);
+        } else if (strcmp(registration->custom_name,
+                          ::tflite::ops::custom::fused_elementwise::
+                              kFusedElementwise) == 0) {
+          return VisitFusedElementwiseNode(subgraph, delegate, context,
+                                           node_index, node, context->tensors,
+                                           input_output_tensors);
         } else if (strcmp(registration->custom_name, kOdmlSDPA) == 0) {
           return VisitScaledDotAttentionCompositeNode(
               subgraph, delegate, context, node_index, node, context->tensors,
@@ -3294,6 +3330,35 @@ class Subgraph {
       return kTfLiteError;
     }
 
+    // The dynamically quantized input_b is packed when the subgraph is
+    // created, so it must be constant, and it needs a scale per output channel
+    // of each of its batches.
+    const int32_t n = params->adj_y ? SizeOfDimension(&input_b, num_dims_b - 2)
+                                    : SizeOfDimension(&input_b, num_dims_b - 1);
+    int32_t batch_size_b = 1;
+    for (int i = 0; i < num_dims_b - 2; ++i) {
+      batch_size_b *= SizeOfDimension(&input_b, i);
+    }
+    if (dynamically_quantized) {
+      TF_LITE_ENSURE_STATUS(CheckTensorStaticAllocation(
+          logging_context, input_b, node->inputs->data[1],
+          BuiltinOperator_BATCH_MATMUL, node_index));
+      const TfLiteAffineQuantization* quant_params_b =
+          reinterpret_cast<const TfLiteAffineQuantization*>(
+              input_b.quantization.params);
+      const int num_scales = quant_params_b->scale->size;
+      if (num_scales != 1 && num_scales != n &&
+          num_scales != batch_size_b * n) {
+        TF_LITE_MAYBE_KERNEL_LOG(
+            logging_context,
+            "failed to delegate %s node #%d. unexpected number of "
+            "quantizations scales (expected %d, %d or 1, got %d)",
+            EnumNameBuiltinOperator(BuiltinOperator_BATCH_MATMUL), node_index,
+            batch_size_b * n, n, num_scales);
+        return kTfLiteError;
+      }
+    }
+
     // Create and attach the subgraph nodes.
     if (subgraph != nullptr) {
       const uint32_t flags = params->adj_y ? XNN_FLAG_TRANSPOSE_B : 0;
@@ -3302,39 +3367,24 @@ class Subgraph {
       // input `A` from `float32` to `int8`, and set up the quantization
       // parameters of the already-quantized input `B`.
       if (dynamically_quantized) {
-        // Compute some shapes and sizes.
-        const int32_t n = params->adj_y
-                              ? SizeOfDimension(&input_b, num_dims_b - 2)
-                              : SizeOfDimension(&input_b, num_dims_b - 1);
-        int32_t batch_size_b = 1;
-        for (int i = 0; i < num_dims_b - 2; ++i) {
-          batch_size_b *= SizeOfDimension(&input_b, i);
-        }
-
-        // Validate or create the quantization parameters for the per-channel
-        // quantized input_b. Note that we currently only expect the `B` tensor
-        // to be per-tensor quantized, and not per-channel (see b/332675940).
+        // Expand the per-tensor scale, or the per-channel scales shared by all
+        // the batches, to a scale per output channel of each batch of input_b.
         TfLiteAffineQuantization* quant_params_b =
             reinterpret_cast<TfLiteAffineQuantization*>(
                 input_b.quantization.params);
         if (quant_params_b->scale->size != batch_size_b * n) {
-          if (quant_params_b->scale->size != 1) {
-            TF_LITE_MAYBE_KERNEL_LOG(
-                logging_context,
-                "failed to delegate %s node #%d. unexpected number of "
-                "quantizations scales (expected %d or 1, got %d)",
-                EnumNameBuiltinOperator(BuiltinOperator_BATCH_MATMUL),
-                node_index, batch_size_b * n, quant_params_b->scale->size);
-            return kTfLiteError;
+          const int num_scales = quant_params_b->scale->size;
+          TfLiteFloatArray* scale = TfLiteFloatArrayCreate(batch_size_b * n);
+          TfLiteIntArray* zero_point = TfLiteIntArrayCreate(batch_size_b * n);
+          for (int i = 0; i < batch_size_b * n; ++i) {
+            scale->data[i] = quant_params_b->scale->data[i % num_scales];
+            zero_point->data[i] = quant_params_b->zero_point->data[
+                i % quant_params_b->zero_point->size];
           }
           TfLiteFloatArrayFree(quant_params_b->scale);
-          quant_params_b->scale = TfLiteFloatArrayCreate(batch_size_b * n);
-          std::fill_n(quant_params_b->scale->data, batch_size_b * n,
-                      input_b.params.scale);
+          quant_params_b->scale = scale;
           TfLiteIntArrayFree(quant_params_b->zero_point);
-          quant_params_b->zero_point = TfLiteIntArrayCreate(batch_size_b * n);
-          std::fill_n(quant_params_b->zero_point->data, batch_size_b * n,
-                      input_b.params.zero_point);
+          quant_params_b->zero_point = zero_point;
           quant_params_b->quantized_dimension =
               params->adj_y ? num_dims_b - 2 : num_dims_b - 1;
         }
@@ -6695,6 +6745,173 @@ class Subgraph {
     return kTfLiteOk;
   }
 
+  static TfLiteStatus VisitFusedElementwiseNode(
+      xnn_subgraph_t subgraph, const Delegate& delegate,
+      TfLiteContext* logging_context, int node_index, TfLiteNode* node,
+      const TfLiteTensor* tensors,
+      const std::unordered_map<int, uint32_t>& input_output_tensors) {
+    using ::tflite::ops::custom::fused_elementwise::Instruction;
+    using ::tflite::ops::custom::fused_elementwise::OpCode;
+    using ::tflite::ops::custom::fused_elementwise::Program;
+
+    Program program;
+    if (!::tflite::ops::custom::fused_elementwise::ParseProgram(
+            reinterpret_cast<const uint8_t*>(node->custom_initial_data),
+            node->custom_initial_data_size, node->inputs->size, &program)) {
+      TF_LITE_MAYBE_KERNEL_LOG(logging_context,
+                               "invalid FusedElementwise program in node #%d",
+                               node_index);
+      return kTfLiteError;
+    }
+    TF_LITE_ENSURE_EQ(logging_context, node->outputs->size, 1);
+    for (int i = 0; i < node->inputs->size; ++i) {
+      const TfLiteTensor& input_tensor = tensors[node->inputs->data[i]];
+      TF_LITE_ENSURE_STATUS(CheckTensorFloat32Type(
+          logging_context, input_tensor, node->inputs->data[i], node_index));
+      TF_LITE_ENSURE_STATUS(CheckTensorNonDynamicAllocation(
+          delegate, logging_context, input_tensor, node->inputs->data[i],
+          node_index));
+    }
+    const TfLiteTensor& output_tensor = tensors[node->outputs->data[0]];
+    TF_LITE_ENSURE_STATUS(CheckTensorFloat32Type(
+        logging_context, output_tensor, node->outputs->data[0], node_index));
+    TF_LITE_ENSURE_STATUS(CheckTensorNonDynamicAllocation(
+        delegate, logging_context, output_tensor, node->outputs->data[0],
+        node_index));
+    for (const Instruction& instruction : program.instructions) {
+      // XNNPACK has no exponential operator.
+      if (instruction.op == OpCode::kExp) {
+        TF_LITE_MAYBE_KERNEL_LOG(
+            logging_context,
+            "unsupported EXP instruction in FusedElementwise node #%d",
+            node_index);
+        return kTfLiteError;
+      }
+    }
+
+    if (subgraph != nullptr) {
+      const auto constants_it =
+          delegate.fused_elementwise_constants_.find(node_index);
+      TF_LITE_ENSURE(
+          logging_context,
+          constants_it != delegate.fused_elementwise_constants_.end());
+      const std::vector<float>& constants = constants_it->second;
+      TF_LITE_ENSURE_EQ(logging_context, constants.size(),
+                        program.constants.size());
+
+      // The instructions are defined as a chain of XNNPACK nodes connected by
+      // internal values.
+      std::vector<uint32_t> value_ids(program.num_values(),
+                                      XNN_INVALID_VALUE_ID);
+      for (int i = 0; i < program.num_inputs; ++i) {
+        value_ids[i] = input_output_tensors.at(node->inputs->data[i]);
+      }
+      for (int i = 0; i < constants.size(); ++i) {
+        TF_LITE_ENSURE_EQ(
+            logging_context, xnn_status_success,
+            xnn_define_tensor_value(subgraph, xnn_datatype_fp32,
+                                    /*num_dims=*/0, /*dims=*/nullptr,
+                                    &constants[i], XNN_INVALID_VALUE_ID,
+                                    /*flags=*/0,
+                                    &value_ids[program.num_inputs + i]));
+      }
+      const float inf = std::numeric_limits<float>::infinity();
+      for (int i = 0; i < program.instructions.size(); ++i) {
+        const Instruction& instruction = program.instructions[i];
+        uint32_t& output_id = value_ids[program.instruction_value(i)];
+        if (i == program.instructions.size() - 1) {
+          output_id = input_output_tensors.at(node->outputs->data[0]);
+        } else {
+          TF_LITE_ENSURE_EQ(
+              logging_context, xnn_status_success,
+              xnn_define_tensor_value(subgraph, xnn_datatype_fp32,
+                                      /*num_dims=*/0, /*dims=*/nullptr,
+                                      /*data=*/nullptr, XNN_INVALID_VALUE_ID,
+                                      /*flags=*/0, &output_id));
+        }
+        const uint32_t a = value_ids[instruction.lhs];
+        const uint32_t b =
+            instruction.rhs >= 0 ? value_ids[instruction.rhs] : 0;
+        xnn_status status = xnn_status_unsupported_parameter;
+        switch (instruction.op) {
+          case OpCode::kAdd:
+            status = xnn_define_add2(subgraph, -inf, inf, a, b, output_id,
+                                     /*flags=*/0);
+            break;
+          case OpCode::kSub:
+            status = xnn_define_subtract(subgraph, -inf, inf, a, b,
+                                         output_id, /*flags=*/0);
+            break;
+          case OpCode::kMul:
+            status = xnn_define_multiply2(subgraph, -inf, inf, a, b,
+                                          output_id, /*flags=*/0);
+            break;
+          case OpCode::kDiv:
+            status = xnn_define_divide(subgraph, -inf, inf, a, b, output_id,
+                                       /*flags=*/0);
+            break;
+          case OpCode::kMaximum:
+            status = xnn_define_maximum2(subgraph, a, b, output_id,
+                                         /*flags=*/0);
+            break;
+          case OpCode::kMinimum:
+            status = xnn_define_minimum2(subgraph, a, b, output_id,
+                                         /*flags=*/0);
+            break;
+          case OpCode::kSquaredDifference:
+            status = xnn_define_squared_difference(subgraph, a, b, output_id,
+                                                   /*flags=*/0);
+            break;
+          case OpCode::kAbs:
+            status = xnn_define_abs(subgraph, a, output_id, /*flags=*/0);
+            break;
+          case OpCode::kLogistic:
+            status = xnn_define_sigmoid(subgraph, a, output_id, /*flags=*/0);
+            break;
+          case OpCode::kNeg:
+            status = xnn_define_negate(subgraph, a, output_id, /*flags=*/0);
+            break;
+          case OpCode::kRelu:
+            status = xnn_define_clamp(subgraph, 0.0f, inf, a, output_id,
+                                      /*flags=*/0);
+            break;
+          case OpCode::kRelu6:
+            status = xnn_define_clamp(subgraph, 0.0f, 6.0f, a, output_id,
+                                      /*flags=*/0);
+            break;
+          case OpCode::kReluN1To1:
+            status = xnn_define_clamp(subgraph, -1.0f, 1.0f, a, output_id,
+                                      /*flags=*/0);
+            break;
+          case OpCode::kRsqrt:
+            status = xnn_define_reciprocal_square_root(subgraph, a, output_id,
+                                                       /*flags=*/0);
+            break;
+          case OpCode::kSqrt:
+            status =
+                xnn_define_square_root(subgraph, a, output_id, /*flags=*/0);
+            break;
+          case OpCode::kSquare:
+            status = xnn_define_square(subgraph, a, output_id, /*flags=*/0);
+            break;
+          case OpCode::kTanh:
+            status = xnn_define_tanh(subgraph, a, output_id, /*flags=*/0);
+            break;
+          case OpCode::kExp:
+            break;
+        }
+        if (status != xnn_status_success) {
+          TF_LITE_KERNEL_LOG(logging_context,
+                             "failed to delegate FusedElementwise node #%d",
+                             node_index);
+          return kTfLiteError;
+        }
+      }
+    }
+
+    return kTfLiteOk;
+  }
+
   static TfLiteStatus VisitScaledDotAttentionCompositeNode(
       xnn_subgraph_t subgraph, const Delegate& delegate,
       TfLiteContext* logging_context, int node_index, TfLiteNode* node,
@@ -7544,6 +7761,7 @@ TfLiteIntArray* Delegate::PrepareOpsToDelegate(TfLiteContext* context) {
   static_unpacked_data_.clear();
   static_unpack_nodes_.clear();
   static_sparse_weights_.clear();
+  fused_elementwise_constants_.clear();
   variable_holder_.ClearTensorIdToGlobalId();
 
   TfLiteIntArray* execution_plan = nullptr;
@@ -7654,6 +7872,21 @@ TfLiteIntArray* Delegate::PrepareOpsToDelegate(TfLiteContext* context) {
       }
     }
 
+    // Keep the constants of FusedElementwise programs for the subgraphs.
+    if (registration->builtin_code == kTfLiteBuiltinCustom &&
+        registration->custom_name != nullptr &&
+        strcmp(registration->custom_name,
+               ::tflite::ops::custom::fused_elementwise::kFusedElementwise) ==
+            0) {
+      ::tflite::ops::custom::fused_elementwise::Program program;
+      if (::tflite::ops::custom::fused_elementwise::ParseProgram(
+              reinterpret_cast<const uint8_t*>(node->custom_initial_data),
+              node->custom_initial_data_size, node->inputs->size, &program)) {
+        fused_elementwise_constants_[node_index] =
+            std::move(program.constants);
+      }
+    }
+
     // Record node_index as we need it to check if node is delegated or not.
     if (registration->builtin_code == kTfLiteBuiltinVarHandle) {
       variable_handles[node_index] = node->outputs->data[0];
@@ -23,9 +23,16 @@ namespace tflite {
 namespace ops {
 namespace custom {
 
+// The id of the `resource::PagedCacheBuffer` in the subgraph resources that
+// PAGED_KV_CACHE writes to and PAGED_SDPA reads from. Sequences sharing a
+// prefix are forked, and finished ones released, through this resource.
+inline constexpr int kPagedKVCacheResourceId = 44;
+
 TfLiteRegistration* Register_KV_CACHE();
 TfLiteRegistration* Register_EXTERNAL_KV_CACHE();
+TfLiteRegistration* Register_PAGED_KV_CACHE();
 TfLiteRegistration* Register_SDPA();
+TfLiteRegistration* Register_PAGED_SDPA();
 
 extern "C" void GenAIOpsRegisterer(::tflite::MutableOpResolver* resolver);
 
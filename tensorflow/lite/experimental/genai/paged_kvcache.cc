@@ -0,0 +1,216 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <cstddef>
+#include <cstdint>
+
+#include "flatbuffers/flexbuffers.h"
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/core/subgraph.h"
+#include "tensorflow/lite/experimental/genai/genai_ops.h"
+#include "tensorflow/lite/experimental/resource/paged_cache_buffer.h"
+#include "tensorflow/lite/experimental/resource/resource_base.h"
+#include "tensorflow/lite/kernels/internal/runtime_shape.h"
+#include "tensorflow/lite/kernels/internal/tensor_ctypes.h"
+#include "tensorflow/lite/kernels/kernel_util.h"
+
+namespace tflite {
+namespace ops {
+namespace custom {
+namespace llm {
+
+static const int kPositionTensor = 0;
+static const int kKeyTensor = 1;
+static const int kValueTensor = 2;
+static const int kSequenceTensor = 3;
+static const int kKVSequenceTensor = 0;
+static const int kRequiredNumDimensions = 4;
+static const int kDefaultMaxNumCacheEntries = 2048;
+static const int kDefaultNumTransformerLayers = 32;
+static const int kDefaultTransformerLayerId = 0;
+static const int kDefaultBlockSize = 16;
+
+struct OpData {
+  int num_layers;
+  int layer_index;
+  int max_num_entries;
+  int block_size;
+  int num_blocks;
+  // The cache buffer owned by the subgraph resources.
+  resource::PagedCacheBuffer* cache_buffer;
+  bool is_initialized;
+};
+
+void* PagedKVCacheInit(TfLiteContext* context, const char* buffer,
+                       size_t length) {
+  OpData* op_data = new OpData();
+  op_data->num_layers = -1;
+  op_data->layer_index = -1;
+  op_data->max_num_entries = -1;
+  op_data->block_size = -1;
+  op_data->num_blocks = -1;
+  op_data->cache_buffer = nullptr;
+  op_data->is_initialized = false;
+  return op_data;
+}
+
+TfLiteStatus PagedKVCachePrepare(TfLiteContext* context, TfLiteNode* node) {
+  // position, key, value, sequence
+  TF_LITE_ENSURE_EQ(context, NumInputs(node), 4);
+  // kv_sequence
+  TF_LITE_ENSURE_EQ(context, NumOutputs(node), 1);
+
+  OpData* op_data = reinterpret_cast<OpData*>(node->user_data);
+
+  if (!op_data->is_initialized) {
+    const uint8_t* buffer =
+        reinterpret_cast<const uint8_t*>(node->custom_initial_data);
+    const size_t length = node->custom_initial_data_size;
+    auto flexbuffer_map = flexbuffers::GetRoot(buffer, length).AsMap();
+    int32_t max_num_entries = flexbuffer_map["kv_cache_max"].AsInt32();
+    int32_t num_layers = flexbuffer_map["num_layers"].AsInt32();
+    int32_t layer_index = flexbuffer_map["layer_index"].AsInt32();
+    int32_t block_size = flexbuffer_map["block_size"].AsInt32();
+    int32_t num_blocks = flexbuffer_map["num_blocks"].AsInt32();
+    op_data->max_num_entries =
+        max_num_entries > 0 ? max_num_entries : kDefaultMaxNumCacheEntries;
+    op_data->num_layers =
+        num_layers > 0 ? num_layers : kDefaultNumTransformerLayers;
+    op_data->layer_index =
+        layer_index > 0 ? layer_index : kDefaultTransformerLayerId;
+    op_data->block_size = block_size > 0 ? block_size : kDefaultBlockSize;
+    // By default, enough blocks for one sequence of the maximum length.
+    op_data->num_blocks =
+        num_blocks > 0 ? num_blocks
+                       : (op_data->max_num_entries + op_data->block_size - 1) /
+                             op_data->block_size;
+    op_data->is_initialized = true;
+  }
+
+  const TfLiteTensor* position;
+  const TfLiteTensor* key;
+  const TfLiteTensor* value;
+  const TfLiteTensor* sequence;
+  TF_LITE_ENSURE_OK(context,
+                    GetInputSafe(context, node, kPositionTensor, &position));
+  TF_LITE_ENSURE_OK(context, GetInputSafe(context, node, kKeyTensor, &key));
+  TF_LITE_ENSURE_OK(context, GetInputSafe(context, node, kValueTensor, &value));
+  TF_LITE_ENSURE_OK(context,
+                    GetInputSafe(context, node, kSequenceTensor, &sequence));
+
+  TF_LITE_ENSURE_EQ(context, position->type, kTfLiteInt64);
+  TF_LITE_ENSURE_EQ(context, key->type, kTfLiteFloat32);
+  TF_LITE_ENSURE_EQ(context, value->type, kTfLiteFloat32);
+  TF_LITE_ENSURE_EQ(context, sequence->type, kTfLiteInt32);
+  TF_LITE_ENSURE_EQ(context, NumElements(sequence), 1);
+  // Ensure Positions correspond to KV sequence length.
+  TF_LITE_ENSURE(context, NumDimensions(position) == 1);
+  TF_LITE_ENSURE(
+      context, GetTensorShape(position).Dims(0) == GetTensorShape(key).Dims(1));
+  // Support only (B, S, N, H) for now.
+  TF_LITE_ENSURE(context, NumDimensions(key) == kRequiredNumDimensions);
+  // Enforce Batch == 1 for now.
+  TF_LITE_ENSURE(context, GetTensorShape(key).Dims(0) == 1);
+  TF_LITE_ENSURE(context, HaveSameShapes(key, value));
+  TF_LITE_ENSURE(context, op_data->layer_index < op_data->num_layers);
+
+  const int num_heads = key->dims->data[2];
+  const int head_dim = key->dims->data[3];
+  Subgraph* subgraph = reinterpret_cast<Subgraph*>(context->impl_);
+  auto& resources = subgraph->resources();
+  if (resources.count(kPagedKVCacheResourceId) == 0) {
+    auto* cbuffer = new resource::PagedCacheBuffer();
+    resources.emplace(kPagedKVCacheResourceId, cbuffer);
+    cbuffer->Initialize(op_data->num_layers, op_data->num_blocks,
+                        op_data->block_size, op_data->max_num_entries,
+                        num_heads, head_dim);
+    op_data->cache_buffer = cbuffer;
+  } else {
+    resource::ResourceBase* resourcePtr =
+        resources.at(kPagedKVCacheResourceId).get();
+    op_data->cache_buffer =
+        static_cast<resource::PagedCacheBuffer*>(resourcePtr);
+  }
+  TF_LITE_ENSURE(context, op_data->cache_buffer->IsInitialized());
+  // All the layers share the cache.
+  TF_LITE_ENSURE_EQ(context, op_data->cache_buffer->num_layers(),
+                    op_data->num_layers);
+  TF_LITE_ENSURE_EQ(context, op_data->cache_buffer->num_heads(), num_heads);
+  TF_LITE_ENSURE_EQ(context, op_data->cache_buffer->head_dim(), head_dim);
+
+  TfLiteTensor* kv_sequence;
+  TF_LITE_ENSURE_OK(context,
+                    GetOutputSafe(context, node, kKVSequenceTensor,
+                                  &kv_sequence));
+  kv_sequence->type = kTfLiteInt32;
+  TfLiteIntArray* kv_sequence_dims = TfLiteIntArrayCreate(1);
+  kv_sequence_dims->data[0] = 1;
+  return context->ResizeTensor(context, kv_sequence, kv_sequence_dims);
+}
+
+void PagedKVCacheFree(TfLiteContext* context, void* buffer) {
+  delete static_cast<OpData*>(buffer);
+}
+
+TfLiteStatus PagedKVCacheEval(TfLiteContext* context, TfLiteNode* node) {
+  const TfLiteTensor* position;
+  const TfLiteTensor* key;
+  const TfLiteTensor* value;
+  const TfLiteTensor* sequence;
+  TF_LITE_ENSURE_OK(context,
+                    GetInputSafe(context, node, kPositionTensor, &position));
+  TF_LITE_ENSURE_OK(context, GetInputSafe(context, node, kKeyTensor, &key));
+  TF_LITE_ENSURE_OK(context, GetInputSafe(context, node, kValueTensor, &value));
+  TF_LITE_ENSURE_OK(context,
+                    GetInputSafe(context, node, kSequenceTensor, &sequence));
+  TfLiteTensor* kv_sequence;
+  TF_LITE_ENSURE_OK(context,
+                    GetOutputSafe(context, node, kKVSequenceTensor,
+                                  &kv_sequence));
+  OpData* op_data = reinterpret_cast<OpData*>(node->user_data);
+
+  const int32_t sequence_id = sequence->data.i32[0];
+  RuntimeShape shape(GetTensorShape(key));
+  const int64_t num_slots = shape.Dims(1);
+  const int elements_in_one_entry = shape.Dims(2) * shape.Dims(3);
+  for (int64_t i = 0; i < num_slots; ++i) {
+    const int64_t slot_position = position->data.i64[i];
+    if (op_data->cache_buffer->WriteEntry(
+            sequence_id, op_data->layer_index, slot_position,
+            key->data.f + i * elements_in_one_entry,
+            value->data.f + i * elements_in_one_entry) != kTfLiteOk) {
+      TF_LITE_KERNEL_LOG(context,
+                         "Can not write position %d of sequence %d: it is "
+                         "past kv_cache_max or the cache is out of blocks",
+                         static_cast<int>(slot_position), sequence_id);
+      return kTfLiteError;
+    }
+  }
+  kv_sequence->data.i32[0] = sequence_id;
+  return kTfLiteOk;
+}
+
+}  // namespace llm
+
+TfLiteRegistration* Register_PAGED_KV_CACHE() {
+  static TfLiteRegistration r = {llm::PagedKVCacheInit, llm::PagedKVCacheFree,
+                                 llm::PagedKVCachePrepare,
+                                 llm::PagedKVCacheEval};
+  return &r;
+}
+
+}  // namespace custom
+}  // namespace ops
+}  // namespace tflite
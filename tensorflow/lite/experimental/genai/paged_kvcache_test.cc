@@ -0,0 +1,233 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "flatbuffers/flexbuffers.h"
+#include "tensorflow/lite/c/c_api_types.h"
+#include "tensorflow/lite/experimental/genai/genai_ops.h"
+#include "tensorflow/lite/experimental/resource/paged_cache_buffer.h"
+#include "tensorflow/lite/kernels/test_util.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+namespace tflite {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::FloatNear;
+using ::testing::Pointwise;
+
+class PagedCacheOpModel : public SingleOpModel {
+ public:
+  PagedCacheOpModel(const TensorData& pos_tensor, const TensorData& k_tensor,
+                    const TensorData& v_tensor, int max_num_entries,
+                    int block_size, int num_blocks) {
+    pos_ = AddInput(pos_tensor);
+    k_ = AddInput(k_tensor);
+    v_ = AddInput(v_tensor);
+    sequence_ = AddInput({TensorType_INT32, {1}});
+    kv_sequence_ = AddOutput(TensorType_INT32);
+
+    flexbuffers::Builder fbb;
+    fbb.Map([&]() {
+      fbb.Int("kv_cache_max", max_num_entries);
+      fbb.Int("num_layers", 1);
+      fbb.Int("block_size", block_size);
+      fbb.Int("num_blocks", num_blocks);
+    });
+    fbb.Finish();
+    SetCustomOp("Paged_KV_Cache", fbb.GetBuffer(),
+                ops::custom::Register_PAGED_KV_CACHE);
+    BuildInterpreter(
+        {GetShape(pos_), GetShape(k_), GetShape(v_), GetShape(sequence_)});
+  }
+
+  TfLiteStatus Run(int sequence, const std::vector<int64_t>& position,
+                   const std::vector<float>& key,
+                   const std::vector<float>& value) {
+    PopulateTensor(sequence_, {sequence});
+    PopulateTensor(pos_, position);
+    PopulateTensor(k_, key);
+    PopulateTensor(v_, value);
+    return Invoke();
+  }
+
+  std::vector<int> GetKVSequence() { return ExtractVector<int>(kv_sequence_); }
+
+  resource::PagedCacheBuffer* GetCacheBuffer() {
+    return static_cast<resource::PagedCacheBuffer*>(
+        interpreter_->primary_subgraph()
+            .resources()
+            .at(ops::custom::kPagedKVCacheResourceId)
+            .get());
+  }
+
+ protected:
+  int pos_;
+  int k_;
+  int v_;
+  int sequence_;
+  int kv_sequence_;
+};
+
+TEST(PagedCacheOpTest, WritesToBlocks) {
+  PagedCacheOpModel m({TensorType_INT64, {3}},
+                      {TensorType_FLOAT32, {1, 3, 1, 2}},
+                      {TensorType_FLOAT32, {1, 3, 1, 2}},
+                      /*max_num_entries=*/8, /*block_size=*/2,
+                      /*num_blocks=*/3);
+  resource::PagedCacheBuffer* cache_buffer = m.GetCacheBuffer();
+  EXPECT_EQ(cache_buffer->GetNumFreeBlocks(), 3);
+
+  ASSERT_EQ(m.Run(5, {0, 1, 2}, {1, 2, 3, 4, 5, 6}, {7, 8, 9, 10, 11, 12}),
+            kTfLiteOk);
+  EXPECT_THAT(m.GetKVSequence(), ElementsAre(5));
+  EXPECT_EQ(cache_buffer->GetNumEntries(5, 0), 3);
+  EXPECT_EQ(cache_buffer->GetNumFreeBlocks(), 1);
+  const float* keys = cache_buffer->GetKeys(5, 0, 0);
+  EXPECT_THAT(std::vector<float>(keys, keys + 4), ElementsAre(1, 2, 3, 4));
+  const float* values = cache_buffer->GetValues(5, 0, 1);
+  EXPECT_THAT(std::vector<float>(values, values + 2), ElementsAre(11, 12));
+
+  // A fork shares the prompt, and copies the block it writes to.
+  ASSERT_EQ(cache_buffer->ForkSequence(5, 6, 3), kTfLiteOk);
+  EXPECT_EQ(cache_buffer->GetNumFreeBlocks(), 1);
+  ASSERT_EQ(m.Run(6, {3, 4, 5}, {0, 0, 0, 0, 0, 0}, {0, 0, 0, 0, 0, 0}),
+            kTfLiteError);
+  cache_buffer->ReleaseSequence(6);
+  ASSERT_EQ(cache_buffer->ForkSequence(5, 6, 3), kTfLiteOk);
+  ASSERT_EQ(m.Run(6, {3, 3, 3}, {13, 14, 13, 14, 13, 14},
+                  {15, 16, 15, 16, 15, 16}),
+            kTfLiteOk);
+  EXPECT_THAT(m.GetKVSequence(), ElementsAre(6));
+  EXPECT_EQ(cache_buffer->GetNumFreeBlocks(), 0);
+  EXPECT_EQ(cache_buffer->GetNumEntries(5, 0), 3);
+  EXPECT_EQ(cache_buffer->GetNumEntries(6, 0), 4);
+  EXPECT_EQ(cache_buffer->GetKeys(6, 0, 0), cache_buffer->GetKeys(5, 0, 0));
+  keys = cache_buffer->GetKeys(6, 0, 1);
+  EXPECT_THAT(std::vector<float>(keys, keys + 4), ElementsAre(5, 6, 13, 14));
+  keys = cache_buffer->GetKeys(5, 0, 1);
+  EXPECT_THAT(std::vector<float>(keys, keys + 2), ElementsAre(5, 6));
+}
+
+class SDPAOpModel : public SingleOpModel {
+ public:
+  SDPAOpModel(const TensorData& q_tensor, const TensorData& kv_tensor,
+              const TensorData& mask_tensor) {
+    q_ = AddInput(q_tensor);
+    k_ = AddInput(kv_tensor);
+    v_ = AddInput(kv_tensor);
+    mask_ = AddInput(mask_tensor);
+    // SDPA doesn't resize its output.
+    output_ = AddOutput(q_tensor);
+    SetCustomOp("SDPA", {}, ops::custom::Register_SDPA);
+    BuildInterpreter(
+        {GetShape(q_), GetShape(k_), GetShape(v_), GetShape(mask_)});
+  }
+
+  std::vector<float> Run(const std::vector<float>& query,
+                         const std::vector<float>& key,
+                         const std::vector<float>& value,
+                         const std::vector<float>& mask) {
+    PopulateTensor(q_, query);
+    PopulateTensor(k_, key);
+    PopulateTensor(v_, value);
+    PopulateTensor(mask_, mask);
+    EXPECT_EQ(Invoke(), kTfLiteOk);
+    return ExtractVector<float>(output_);
+  }
+
+ protected:
+  int q_;
+  int k_;
+  int v_;
+  int mask_;
+  int output_;
+};
+
+class PagedSDPAOpModel : public SingleOpModel {
+ public:
+  // The cache must have been written before the op is prepared.
+  PagedSDPAOpModel(const TensorData& q_tensor, const TensorData& mask_tensor,
+                   std::unique_ptr<resource::PagedCacheBuffer> cache_buffer) {
+    q_ = AddInput(q_tensor);
+    kv_sequence_ = AddInput({TensorType_INT32, {1}});
+    mask_ = AddInput(mask_tensor);
+    // SDPA doesn't resize its output.
+    output_ = AddOutput(q_tensor);
+    SetCustomOp("Paged_SDPA", {}, ops::custom::Register_PAGED_SDPA);
+    BuildInterpreter({GetShape(q_), GetShape(kv_sequence_), GetShape(mask_)},
+                     /*num_threads=*/-1, /*allow_fp32_relax_to_fp16=*/false,
+                     /*apply_delegate=*/false,
+                     /*allocate_and_delegate=*/false);
+    interpreter_->primary_subgraph().resources().emplace(
+        ops::custom::kPagedKVCacheResourceId, std::move(cache_buffer));
+    AllocateAndDelegate(/*apply_delegate=*/false);
+  }
+
+  std::vector<float> Run(int sequence, const std::vector<float>& query,
+                         const std::vector<float>& mask) {
+    PopulateTensor(q_, query);
+    PopulateTensor(kv_sequence_, {sequence});
+    PopulateTensor(mask_, mask);
+    EXPECT_EQ(Invoke(), kTfLiteOk);
+    return ExtractVector<float>(output_);
+  }
+
+ protected:
+  int q_;
+  int kv_sequence_;
+  int mask_;
+  int output_;
+};
+
+TEST(PagedSDPAOpTest, MatchesSDPAOnWholeCache) {
+  // 2 heads of dimension 2, 3 positions written out of 4, in blocks of 2.
+  const std::vector<float> key = {1, 0, 0, 1, 2, 1, -1, 3, 0, 2, 1, 1,
+                                  0, 0, 0, 0};
+  const std::vector<float> value = {3, 1, 2, 0, -2, 4, 1, 1, 5, 2, 0, -1,
+                                    0, 0, 0, 0};
+  const std::vector<float> query = {1, 2, -1, 1};
+  const std::vector<float> mask = {0, 0, 0, -1e9};
+
+  auto cache_buffer = std::make_unique<resource::PagedCacheBuffer>();
+  ASSERT_EQ(cache_buffer->Initialize(/*num_layers=*/1, /*num_blocks=*/2,
+                                     /*block_size=*/2, /*max_num_entries=*/4,
+                                     /*num_heads=*/2, /*head_dim=*/2),
+            kTfLiteOk);
+  for (int position = 0; position < 3; ++position) {
+    ASSERT_EQ(cache_buffer->WriteEntry(/*sequence=*/0, /*layer=*/0, position,
+                                       key.data() + position * 4,
+                                       value.data() + position * 4),
+              kTfLiteOk);
+  }
+
+  SDPAOpModel sdpa({TensorType_FLOAT32, {1, 1, 2, 2}},
+                   {TensorType_FLOAT32, {1, 4, 2, 2}},
+                   {TensorType_FLOAT32, {1, 1, 1, 4}});
+  PagedSDPAOpModel paged_sdpa({TensorType_FLOAT32, {1, 1, 2, 2}},
+                              {TensorType_FLOAT32, {1, 1, 1, 4}},
+                              std::move(cache_buffer));
+  const std::vector<float> expected = sdpa.Run(query, key, value, mask);
+  EXPECT_THAT(paged_sdpa.Run(0, query, mask),
+              Pointwise(FloatNear(1e-5), expected));
+}
+
+}  // namespace
+}  // namespace tflite
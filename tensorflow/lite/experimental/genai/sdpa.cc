@@ -17,12 +17,17 @@ limitations under the License.
 
 #include <cstddef>
 #include <cstdint>
+#include <algorithm>
 #include <cstring>
 #include <limits>
 
 #include "flatbuffers/flexbuffers.h"
+#include "tensorflow/lite/array.h"
 #include "tensorflow/lite/c/c_api_types.h"
 #include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/core/subgraph.h"
+#include "tensorflow/lite/experimental/genai/genai_ops.h"
+#include "tensorflow/lite/experimental/resource/paged_cache_buffer.h"
 #include "tensorflow/lite/kernels/internal/common.h"
 #include "tensorflow/lite/kernels/internal/reference/add.h"
 #include "tensorflow/lite/kernels/internal/reference/batch_matmul.h"
@@ -43,6 +48,10 @@ static const int kQueryTensor = 0;
 static const int kKeyTensor = 1;
 static const int kValueTensor = 2;
 static const int kAttentionMaskTensor = 3;
+// The paged variant takes the sequence output by PAGED_KV_CACHE instead of the
+// key and value.
+static const int kPagedKVSequenceTensor = 1;
+static const int kPagedAttentionMaskTensor = 2;
 static const int kOutputTensor = 0;
 
 static const int kNumTempTensors = 10;
@@ -60,37 +69,34 @@ static const int kBroadcastVTempTensorIndex = 9;
 struct OpData {
   float scale;
   int scratch_tensor_index;
+  // Whether the key and value are read from the blocks of the paged KV cache.
+  bool paged;
+  int layer_index;
+  resource::PagedCacheBuffer* cache_buffer;
 };
 
 void* SDPAInit(TfLiteContext* context, const char* buffer, size_t length) {
   OpData* op_data = new OpData();
   op_data->scale = 0.0f;
+  op_data->paged = false;
+  op_data->layer_index = 0;
+  op_data->cache_buffer = nullptr;
   context->AddTensors(context, kNumTempTensors, &op_data->scratch_tensor_index);
   return op_data;
 }
 
+void* PagedSDPAInit(TfLiteContext* context, const char* buffer,
+                    size_t length) {
+  OpData* op_data =
+      reinterpret_cast<OpData*>(SDPAInit(context, buffer, length));
+  op_data->paged = true;
+  return op_data;
+}
+
 TfLiteStatus SDPAPrepare(TfLiteContext* context, TfLiteNode* node) {
-  TF_LITE_ENSURE_EQ(context, NumInputs(node), 4);
-  TF_LITE_ENSURE_EQ(context, NumOutputs(node), 1);
   OpData* op_data = reinterpret_cast<OpData*>(node->user_data);
-
-  const TfLiteTensor* q_tensor;
-  TF_LITE_ENSURE_OK(context,
-                    GetInputSafe(context, node, kQueryTensor, &q_tensor));
-  const TfLiteTensor* k_tensor;
-  TF_LITE_ENSURE_OK(context,
-                    GetInputSafe(context, node, kKeyTensor, &k_tensor));
-  const TfLiteTensor* v_tensor;
-  TF_LITE_ENSURE_OK(context,
-                    GetInputSafe(context, node, kValueTensor, &v_tensor));
-  const TfLiteTensor* mask_tensor;
-  TF_LITE_ENSURE_OK(
-      context, GetInputSafe(context, node, kAttentionMaskTensor, &mask_tensor));
-  TF_LITE_ENSURE_EQ(context, NumDimensions(q_tensor), NumDimensions(k_tensor));
-  TF_LITE_ENSURE_EQ(context, NumDimensions(k_tensor), NumDimensions(v_tensor));
-  TF_LITE_ENSURE_EQ(context, NumDimensions(v_tensor),
-                    NumDimensions(mask_tensor));
-  TF_LITE_ENSURE_EQ(context, NumDimensions(mask_tensor), 4);
+  TF_LITE_ENSURE_EQ(context, NumInputs(node), op_data->paged ? 3 : 4);
+  TF_LITE_ENSURE_EQ(context, NumOutputs(node), 1);
 
   // Get custom op params
   const uint8_t* buffer =
@@ -100,13 +106,69 @@ TfLiteStatus SDPAPrepare(TfLiteContext* context, TfLiteNode* node) {
   float scale = flexbuffer_map["scale"].AsFloat();
   op_data->scale = scale > 0.0f ? scale : 0.0f;
 
+  const TfLiteTensor* q_tensor;
+  TF_LITE_ENSURE_OK(context,
+                    GetInputSafe(context, node, kQueryTensor, &q_tensor));
+  const TfLiteTensor* mask_tensor;
+  // The shapes of the key and value: (B, S, N, H).
+  const TfLiteIntArray* k_dims;
+  const TfLiteIntArray* v_dims;
+  IntArrayUniquePtr paged_kv_dims;
+  if (op_data->paged) {
+    const TfLiteTensor* kv_sequence_tensor;
+    TF_LITE_ENSURE_OK(context,
+                      GetInputSafe(context, node, kPagedKVSequenceTensor,
+                                   &kv_sequence_tensor));
+    TF_LITE_ENSURE_EQ(context, kv_sequence_tensor->type, kTfLiteInt32);
+    TF_LITE_ENSURE_OK(context,
+                      GetInputSafe(context, node, kPagedAttentionMaskTensor,
+                                   &mask_tensor));
+    op_data->layer_index = flexbuffer_map["layer_index"].AsInt32();
+
+    // Created by the Prepare of PAGED_KV_CACHE, which comes first.
+    Subgraph* subgraph = reinterpret_cast<Subgraph*>(context->impl_);
+    auto& resources = subgraph->resources();
+    auto it = resources.find(kPagedKVCacheResourceId);
+    TF_LITE_ENSURE(context, it != resources.end());
+    op_data->cache_buffer =
+        static_cast<resource::PagedCacheBuffer*>(it->second.get());
+    TF_LITE_ENSURE(context, op_data->cache_buffer->IsInitialized());
+    TF_LITE_ENSURE(context, op_data->layer_index >= 0 &&
+                                op_data->layer_index <
+                                    op_data->cache_buffer->num_layers());
+    // Attends to all the positions a sequence can have, like SDPA given the
+    // whole KV cache. The mask hides the positions not written yet.
+    paged_kv_dims = BuildTfLiteArray<int>(
+        {1, op_data->cache_buffer->max_num_entries(),
+         op_data->cache_buffer->num_heads(),
+         op_data->cache_buffer->head_dim()});
+    k_dims = paged_kv_dims.get();
+    v_dims = paged_kv_dims.get();
+  } else {
+    const TfLiteTensor* k_tensor;
+    TF_LITE_ENSURE_OK(context,
+                      GetInputSafe(context, node, kKeyTensor, &k_tensor));
+    const TfLiteTensor* v_tensor;
+    TF_LITE_ENSURE_OK(context,
+                      GetInputSafe(context, node, kValueTensor, &v_tensor));
+    TF_LITE_ENSURE_OK(
+        context,
+        GetInputSafe(context, node, kAttentionMaskTensor, &mask_tensor));
+    k_dims = k_tensor->dims;
+    v_dims = v_tensor->dims;
+  }
+  TF_LITE_ENSURE_EQ(context, NumDimensions(q_tensor), k_dims->size);
+  TF_LITE_ENSURE_EQ(context, k_dims->size, v_dims->size);
+  TF_LITE_ENSURE_EQ(context, v_dims->size, NumDimensions(mask_tensor));
+  TF_LITE_ENSURE_EQ(context, NumDimensions(mask_tensor), 4);
+
   // If scale is not set, use sqrt(q_tensor->dims->data[3])
   if (op_data->scale == 0.0f)
     op_data->scale = 1 / sqrt(q_tensor->dims->data[3]);
 
   TfLiteIntArrayFree(node->temporaries);
   node->temporaries = TfLiteIntArrayCreate(kNumTempTensors);
-  bool mqa = k_tensor->dims->data[2] == 1;
+  bool mqa = k_dims->data[2] == 1;
 
   // Temp tensor for Transposed Q;
   {
@@ -142,11 +204,11 @@ TfLiteStatus SDPAPrepare(TfLiteContext* context, TfLiteNode* node) {
                                        &scratch_buffer));
     TfLiteIntArray* scratch_buffer_size = TfLiteIntArrayCreate(4);
     for (int i = 0; i < 4; ++i) {
-      scratch_buffer_size->data[i] = k_tensor->dims->data[i];
+      scratch_buffer_size->data[i] = k_dims->data[i];
     }
     // Swap to middle two dimensions.
-    scratch_buffer_size->data[1] = k_tensor->dims->data[2];
-    scratch_buffer_size->data[2] = k_tensor->dims->data[1];
+    scratch_buffer_size->data[1] = k_dims->data[2];
+    scratch_buffer_size->data[2] = k_dims->data[1];
 
     scratch_buffer->type = kTfLiteFloat32;
     scratch_buffer->allocation_type = kTfLiteArenaRw;
@@ -168,7 +230,7 @@ TfLiteStatus SDPAPrepare(TfLiteContext* context, TfLiteNode* node) {
     // mha/gqa: [permute_q[0], permute_q[1], permute_q[2], permute_k[2]]
     int matmul_out_shape[4] = {q_tensor->dims->data[0], q_tensor->dims->data[2],
                                q_tensor->dims->data[1],
-                               k_tensor->dims->data[1]};
+                               k_dims->data[1]};
     for (int i = 0; i < 4; ++i) {
       scratch_buffer_size->data[i] = matmul_out_shape[i];
     }
@@ -213,10 +275,10 @@ TfLiteStatus SDPAPrepare(TfLiteContext* context, TfLiteNode* node) {
                                        &scratch_buffer));
     TfLiteIntArray* scratch_buffer_size = TfLiteIntArrayCreate(4);
     // Swap to {0, 2, 3, 1} dimensions.
-    scratch_buffer_size->data[0] = v_tensor->dims->data[0];
-    scratch_buffer_size->data[1] = v_tensor->dims->data[2];
-    scratch_buffer_size->data[2] = v_tensor->dims->data[3];
-    scratch_buffer_size->data[3] = v_tensor->dims->data[1];
+    scratch_buffer_size->data[0] = v_dims->data[0];
+    scratch_buffer_size->data[1] = v_dims->data[2];
+    scratch_buffer_size->data[2] = v_dims->data[3];
+    scratch_buffer_size->data[3] = v_dims->data[1];
 
     scratch_buffer->type = kTfLiteFloat32;
     scratch_buffer->allocation_type = kTfLiteArenaRw;
@@ -239,7 +301,7 @@ TfLiteStatus SDPAPrepare(TfLiteContext* context, TfLiteNode* node) {
     scratch_buffer_size->data[0] = add_out_shape[0];
     scratch_buffer_size->data[1] = add_out_shape[1];
     scratch_buffer_size->data[2] = add_out_shape[2];
-    scratch_buffer_size->data[3] = v_tensor->dims->data[3];
+    scratch_buffer_size->data[3] = v_dims->data[3];
 
     scratch_buffer->type = kTfLiteFloat32;
     scratch_buffer->allocation_type = kTfLiteArenaRw;
@@ -262,8 +324,8 @@ TfLiteStatus SDPAPrepare(TfLiteContext* context, TfLiteNode* node) {
     else
       scratch_buffer_size = TfLiteIntArrayCreate(4);
     if (mqa) {
-      scratch_buffer_size->data[0] = k_tensor->dims->data[1];
-      scratch_buffer_size->data[1] = k_tensor->dims->data[3];
+      scratch_buffer_size->data[0] = k_dims->data[1];
+      scratch_buffer_size->data[1] = k_dims->data[3];
     } else {
       scratch_buffer_size->data[0] = q_tensor->dims->data[0];
       scratch_buffer_size->data[1] = q_tensor->dims->data[2];
@@ -292,8 +354,8 @@ TfLiteStatus SDPAPrepare(TfLiteContext* context, TfLiteNode* node) {
     else
       scratch_buffer_size = TfLiteIntArrayCreate(4);
     if (mqa) {
-      scratch_buffer_size->data[0] = v_tensor->dims->data[3];
-      scratch_buffer_size->data[1] = v_tensor->dims->data[1];
+      scratch_buffer_size->data[0] = v_dims->data[3];
+      scratch_buffer_size->data[1] = v_dims->data[1];
     } else {
       scratch_buffer_size->data[0] = add_out_shape[0];
       scratch_buffer_size->data[1] = add_out_shape[1];
@@ -318,10 +380,10 @@ TfLiteStatus SDPAPrepare(TfLiteContext* context, TfLiteNode* node) {
                                        &scratch_buffer));
     TfLiteIntArray* scratch_buffer_size = TfLiteIntArrayCreate(4);
 
-    scratch_buffer_size->data[0] = k_tensor->dims->data[0];
+    scratch_buffer_size->data[0] = k_dims->data[0];
     scratch_buffer_size->data[1] = q_tensor->dims->data[2];  // num_heads
-    scratch_buffer_size->data[2] = k_tensor->dims->data[1];
-    scratch_buffer_size->data[3] = k_tensor->dims->data[3];
+    scratch_buffer_size->data[2] = k_dims->data[1];
+    scratch_buffer_size->data[3] = k_dims->data[3];
 
     scratch_buffer->type = kTfLiteFloat32;
     scratch_buffer->allocation_type = kTfLiteArenaRw;
@@ -340,10 +402,10 @@ TfLiteStatus SDPAPrepare(TfLiteContext* context, TfLiteNode* node) {
                                        &scratch_buffer));
     TfLiteIntArray* scratch_buffer_size = TfLiteIntArrayCreate(4);
 
-    scratch_buffer_size->data[0] = v_tensor->dims->data[0];
+    scratch_buffer_size->data[0] = v_dims->data[0];
     scratch_buffer_size->data[1] = q_tensor->dims->data[2];  // num_heads
-    scratch_buffer_size->data[2] = v_tensor->dims->data[3];
-    scratch_buffer_size->data[3] = v_tensor->dims->data[1];
+    scratch_buffer_size->data[2] = v_dims->data[3];
+    scratch_buffer_size->data[3] = v_dims->data[1];
 
     scratch_buffer->type = kTfLiteFloat32;
     scratch_buffer->allocation_type = kTfLiteArenaRw;
@@ -358,6 +420,56 @@ void SDPAFree(TfLiteContext* context, void* buffer) {
   delete static_cast<OpData*>(buffer);
 }
 
+// Writes the keys of `layer` of `sequence` as a (1, N, S, H) tensor, S being
+// the maximum number of entries, with zeros past the written positions.
+void GatherPagedKeys(const resource::PagedCacheBuffer& cache_buffer,
+                     int sequence, int layer, float* output) {
+  const int num_heads = cache_buffer.num_heads();
+  const int head_dim = cache_buffer.head_dim();
+  const int block_size = cache_buffer.block_size();
+  const int max_num_entries = cache_buffer.max_num_entries();
+  const int num_entries = cache_buffer.GetNumEntries(sequence, layer);
+  for (int position = 0; position < num_entries; position += block_size) {
+    const float* block =
+        cache_buffer.GetKeys(sequence, layer, position / block_size);
+    const int num_block_entries = std::min(block_size, num_entries - position);
+    for (int i = 0; i < num_block_entries; ++i) {
+      for (int head = 0; head < num_heads; ++head) {
+        memcpy(output + (head * max_num_entries + position + i) * head_dim,
+               block + (i * num_heads + head) * head_dim,
+               head_dim * sizeof(float));
+      }
+    }
+  }
+  for (int head = 0; head < num_heads; ++head) {
+    memset(output + (head * max_num_entries + num_entries) * head_dim, 0,
+           (max_num_entries - num_entries) * head_dim * sizeof(float));
+  }
+}
+
+// Writes the values of `layer` of `sequence` as a (1, N, H, S) tensor, S being
+// the maximum number of entries, with zeros past the written positions.
+void GatherPagedValues(const resource::PagedCacheBuffer& cache_buffer,
+                       int sequence, int layer, float* output) {
+  const int num_heads = cache_buffer.num_heads();
+  const int head_dim = cache_buffer.head_dim();
+  const int block_size = cache_buffer.block_size();
+  const int max_num_entries = cache_buffer.max_num_entries();
+  const int num_entries = cache_buffer.GetNumEntries(sequence, layer);
+  memset(output, 0, num_heads * head_dim * max_num_entries * sizeof(float));
+  for (int position = 0; position < num_entries; position += block_size) {
+    const float* block =
+        cache_buffer.GetValues(sequence, layer, position / block_size);
+    const int num_block_entries = std::min(block_size, num_entries - position);
+    for (int i = 0; i < num_block_entries; ++i) {
+      const float* entry = block + i * num_heads * head_dim;
+      for (int j = 0; j < num_heads * head_dim; ++j) {
+        output[j * max_num_entries + position + i] = entry[j];
+      }
+    }
+  }
+}
+
 TfLiteStatus SDPAEval(TfLiteContext* context, TfLiteNode* node) {
   /*
   Simple implementation of Scaled Dot Product Attention.
@@ -369,6 +481,8 @@ TfLiteStatus SDPAEval(TfLiteContext* context, TfLiteNode* node) {
   head_dim = q[-1] = embedding_dim // num_q_heads
   Only support for FLOAT32 inputs for now.
   Only support static tensors for now (k/v[1] = max sequence length)
+  The paged variant takes the sequence output by PAGED_KV_CACHE instead of
+  key_proj and value_proj, and reads them from the blocks of the sequence.
   */
 
   const TfLiteTensor* query_tensor;
@@ -376,19 +490,26 @@ TfLiteStatus SDPAEval(TfLiteContext* context, TfLiteNode* node) {
                     GetInputSafe(context, node, kQueryTensor, &query_tensor));
   auto query_shape = GetTensorShape(query_tensor);
   auto query_data = GetTensorData<float>(query_tensor);
-  const TfLiteTensor* key_tensor;
-  TF_LITE_ENSURE_OK(context,
-                    GetInputSafe(context, node, kKeyTensor, &key_tensor));
-  auto key_shape = GetTensorShape(key_tensor);
-  auto key_data = GetTensorData<float>(key_tensor);
-  const TfLiteTensor* value_tensor;
-  TF_LITE_ENSURE_OK(context,
-                    GetInputSafe(context, node, kValueTensor, &value_tensor));
-  auto value_shape = GetTensorShape(value_tensor);
-  auto value_data = GetTensorData<float>(value_tensor);
+  OpData* op_data = reinterpret_cast<OpData*>(node->user_data);
+  const TfLiteTensor* key_tensor = nullptr;
+  const TfLiteTensor* value_tensor = nullptr;
+  const TfLiteTensor* kv_sequence_tensor = nullptr;
   const TfLiteTensor* attention_mask_tensor;
-  TF_LITE_ENSURE_OK(context, GetInputSafe(context, node, kAttentionMaskTensor,
-                                          &attention_mask_tensor));
+  if (op_data->paged) {
+    TF_LITE_ENSURE_OK(context,
+                      GetInputSafe(context, node, kPagedKVSequenceTensor,
+                                   &kv_sequence_tensor));
+    TF_LITE_ENSURE_OK(context,
+                      GetInputSafe(context, node, kPagedAttentionMaskTensor,
+                                   &attention_mask_tensor));
+  } else {
+    TF_LITE_ENSURE_OK(context,
+                      GetInputSafe(context, node, kKeyTensor, &key_tensor));
+    TF_LITE_ENSURE_OK(context,
+                      GetInputSafe(context, node, kValueTensor, &value_tensor));
+    TF_LITE_ENSURE_OK(context, GetInputSafe(context, node, kAttentionMaskTensor,
+                                            &attention_mask_tensor));
+  }
   auto attention_mask_shape = GetTensorShape(attention_mask_tensor);
   auto attention_mask_data = GetTensorData<float>(attention_mask_tensor);
   TfLiteTensor* output_tensor;
@@ -468,10 +589,10 @@ TfLiteStatus SDPAEval(TfLiteContext* context, TfLiteNode* node) {
   auto broadcast_v_out_shape = GetTensorShape(broadcast_v_out_tensor);
   auto broadcast_v_out_data = GetTensorData<float>(broadcast_v_out_tensor);
 
-  OpData* op_data = reinterpret_cast<OpData*>(node->user_data);
-
-  bool mqa = key_tensor->dims->data[2] == 1;
-  bool gqa = !mqa && (key_tensor->dims->data[2] != query_tensor->dims->data[2]);
+  // The number of key and value heads.
+  const int num_kv_heads = transpose_k_out_shape.Dims(1);
+  bool mqa = num_kv_heads == 1;
+  bool gqa = !mqa && (num_kv_heads != query_tensor->dims->data[2]);
 
   // scale * q
   float scale = op_data->scale;
@@ -493,15 +614,22 @@ TfLiteStatus SDPAEval(TfLiteContext* context, TfLiteNode* node) {
   reference_ops::Transpose(transpose_q_params, query_shape, query_data,
                            transpose_q_out_shape, transpose_q_out_data);
 
-  // permute k {0, 2, 1, 3}
-  tflite::TransposeParams transpose_k_params;
-  transpose_k_params.perm_count = 4;
-  transpose_k_params.perm[0] = 0;
-  transpose_k_params.perm[1] = 2;
-  transpose_k_params.perm[2] = 1;
-  transpose_k_params.perm[3] = 3;
-  reference_ops::Transpose(transpose_k_params, key_shape, key_data,
-                           transpose_k_out_shape, transpose_k_out_data);
+  if (op_data->paged) {
+    // Gather k from the blocks of the sequence, permuted {0, 2, 1, 3}.
+    GatherPagedKeys(*op_data->cache_buffer, kv_sequence_tensor->data.i32[0],
+                    op_data->layer_index, transpose_k_out_data);
+  } else {
+    // permute k {0, 2, 1, 3}
+    tflite::TransposeParams transpose_k_params;
+    transpose_k_params.perm_count = 4;
+    transpose_k_params.perm[0] = 0;
+    transpose_k_params.perm[1] = 2;
+    transpose_k_params.perm[2] = 1;
+    transpose_k_params.perm[3] = 3;
+    reference_ops::Transpose(transpose_k_params, GetTensorShape(key_tensor),
+                             GetTensorData<float>(key_tensor),
+                             transpose_k_out_shape, transpose_k_out_data);
+  }
 
   // broadcast k to match num_heads
   // broadcasting similar to torch.repeat_interleave
@@ -577,15 +705,22 @@ TfLiteStatus SDPAEval(TfLiteContext* context, TfLiteNode* node) {
   reference_ops::Softmax(softmax_params, add_out_shape, add_out_data,
                          add_out_shape, add_out_data);
 
-  // permute v {0, 2, 3, 1}
-  tflite::TransposeParams transpose_v_params;
-  transpose_v_params.perm_count = 4;
-  transpose_v_params.perm[0] = 0;
-  transpose_v_params.perm[1] = 2;
-  transpose_v_params.perm[2] = 3;
-  transpose_v_params.perm[3] = 1;
-  reference_ops::Transpose(transpose_v_params, value_shape, value_data,
-                           transpose_v_out_shape, transpose_v_out_data);
+  if (op_data->paged) {
+    // Gather v from the blocks of the sequence, permuted {0, 2, 3, 1}.
+    GatherPagedValues(*op_data->cache_buffer, kv_sequence_tensor->data.i32[0],
+                      op_data->layer_index, transpose_v_out_data);
+  } else {
+    // permute v {0, 2, 3, 1}
+    tflite::TransposeParams transpose_v_params;
+    transpose_v_params.perm_count = 4;
+    transpose_v_params.perm[0] = 0;
+    transpose_v_params.perm[1] = 2;
+    transpose_v_params.perm[2] = 3;
+    transpose_v_params.perm[3] = 1;
+    reference_ops::Transpose(transpose_v_params, GetTensorShape(value_tensor),
+                             GetTensorData<float>(value_tensor),
+                             transpose_v_out_shape, transpose_v_out_data);
+  }
 
   // broadcast v to match num_heads
   // broadcasting similar to torch.repeat_interleave
@@ -669,6 +804,12 @@ TfLiteRegistration* Register_SDPA() {
   return &r;
 }
 
+TfLiteRegistration* Register_PAGED_SDPA() {
+  static TfLiteRegistration r = {llm::PagedSDPAInit, llm::SDPAFree,
+                                 llm::SDPAPrepare, llm::SDPAEval};
+  return &r;
+}
+
 }  // namespace custom
 }  // namespace ops
 }  // namespace tflite
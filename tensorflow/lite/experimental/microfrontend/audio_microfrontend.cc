@@ -12,6 +12,10 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
 #include "flatbuffers/flexbuffers.h"  // from @flatbuffers
 #include "tensorflow/lite/c/c_api_types.h"
 #include "tensorflow/lite/c/common.h"
@@ -135,47 +139,37 @@ void GenerateFeatures(TfLiteAudioMicrofrontendParams* data,
                      data->state->window.step +
                  1;
   }
-  std::vector<std::vector<T>> frame_buffer(num_frames);
-
-  int frame_index = 0;
-  while (audio_size > 0) {
-    size_t num_samples_read;
-    struct FrontendOutput output = FrontendProcessSamples(
-        data->state, audio_data, audio_size, &num_samples_read);
-    audio_data += num_samples_read;
-    audio_size -= num_samples_read;
-
-    if (output.values != nullptr) {
-      frame_buffer[frame_index].reserve(output.size);
-      int i;
-      for (i = 0; i < output.size; ++i) {
-        frame_buffer[frame_index].push_back(static_cast<T>(output.values[i]) /
-                                            data->out_scale);
-      }
-      ++frame_index;
-    }
+  // The features of all the frames, computed in a single batch.
+  const int num_channels = data->state->filterbank.num_channels;
+  std::vector<uint16_t> features(num_frames * num_channels);
+  size_t num_samples_read;
+  num_frames = FrontendProcessFrames(data->state, audio_data, audio_size,
+                                     features.data(), num_frames,
+                                     &num_samples_read);
+  std::vector<T> frame_buffer(num_frames * num_channels);
+  for (int i = 0; i < frame_buffer.size(); ++i) {
+    frame_buffer[i] = static_cast<T>(features[i]) / data->out_scale;
   }
 
   int index = 0;
-  std::vector<T> pad(data->state->filterbank.num_channels, 0);
+  std::vector<T> pad(num_channels, 0);
   int anchor;
-  for (anchor = 0; anchor < frame_buffer.size(); anchor += data->frame_stride) {
+  for (anchor = 0; anchor < num_frames; anchor += data->frame_stride) {
     int frame;
     for (frame = anchor - data->left_context;
          frame <= anchor + data->right_context; ++frame) {
-      std::vector<T>* feature;
-      if (data->zero_padding && (frame < 0 || frame >= frame_buffer.size())) {
-        feature = &pad;
+      const T* feature;
+      if (data->zero_padding && (frame < 0 || frame >= num_frames)) {
+        feature = pad.data();
       } else if (frame < 0) {
-        feature = &frame_buffer[0];
-      } else if (frame >= frame_buffer.size()) {
-        feature = &frame_buffer[frame_buffer.size() - 1];
+        feature = frame_buffer.data();
+      } else if (frame >= num_frames) {
+        feature = frame_buffer.data() + (num_frames - 1) * num_channels;
       } else {
-        feature = &frame_buffer[frame];
-      }
-      for (auto f : *feature) {
-        filterbanks_flat[index++] = f;
+        feature = frame_buffer.data() + frame * num_channels;
       }
+      std::copy(feature, feature + num_channels, filterbanks_flat + index);
+      index += num_channels;
     }
   }
 }
@@ -14,21 +14,13 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/lite/experimental/microfrontend/lib/frontend.h"
 
+#include <string.h>
+
 #include "tensorflow/lite/experimental/microfrontend/lib/bits.h"
 
-struct FrontendOutput FrontendProcessSamples(struct FrontendState* state,
-                                             const int16_t* samples,
-                                             size_t num_samples,
-                                             size_t* num_samples_read) {
+// Computes the features of the window's output.
+static struct FrontendOutput ProcessWindowOutput(struct FrontendState* state) {
   struct FrontendOutput output;
-  output.values = NULL;
-  output.size = 0;
-
-  // Try to apply the window - if it fails, return and wait for more data.
-  if (!WindowProcessSamples(&state->window, samples, num_samples,
-                            num_samples_read)) {
-    return output;
-  }
 
   // Apply the FFT to the window's output (and scale it so that the fixed point
   // FFT can have as much resolution as possible).
@@ -64,6 +56,54 @@ struct FrontendOutput FrontendProcessSamples(struct FrontendState* state,
   return output;
 }
 
+struct FrontendOutput FrontendProcessSamples(struct FrontendState* state,
+                                             const int16_t* samples,
+                                             size_t num_samples,
+                                             size_t* num_samples_read) {
+  // Try to apply the window - if it fails, return and wait for more data.
+  if (!WindowProcessSamples(&state->window, samples, num_samples,
+                            num_samples_read)) {
+    struct FrontendOutput output;
+    output.values = NULL;
+    output.size = 0;
+    return output;
+  }
+  return ProcessWindowOutput(state);
+}
+
+size_t FrontendProcessFrames(struct FrontendState* state,
+                             const int16_t* samples, size_t num_samples,
+                             uint16_t* features, size_t max_num_frames,
+                             size_t* num_samples_read) {
+  const size_t num_channels = state->filterbank.num_channels;
+  size_t num_frames = 0;
+  *num_samples_read = 0;
+  while (num_frames < max_num_frames) {
+    struct FrontendOutput output;
+    size_t num_frame_samples_read;
+    if (state->window.input_used == 0 && num_samples >= state->window.size) {
+      // The whole window is in `samples`: apply the window to them in place
+      // rather than buffering them in the window's state.
+      WindowApply(&state->window, samples);
+      num_frame_samples_read = state->window.step;
+      output = ProcessWindowOutput(state);
+    } else {
+      output = FrontendProcessSamples(state, samples, num_samples,
+                                      &num_frame_samples_read);
+    }
+    samples += num_frame_samples_read;
+    num_samples -= num_frame_samples_read;
+    *num_samples_read += num_frame_samples_read;
+    if (output.values == NULL) {
+      break;
+    }
+    memcpy(features, output.values, num_channels * sizeof(*features));
+    features += num_channels;
+    ++num_frames;
+  }
+  return num_frames;
+}
+
 void FrontendReset(struct FrontendState* state) {
   WindowReset(&state->window);
   FftReset(&state->fft);
@@ -55,6 +55,21 @@ struct FrontendOutput FrontendProcessSamples(struct FrontendState* state,
                                              size_t num_samples,
                                              size_t* num_samples_read);
 
+// Processes the samples of up to `max_num_frames` frames, and writes the
+// features of each frame, `filterbank.num_channels` values, contiguously to
+// `features`. Returns the number of frames processed, and updates
+// num_samples_read to contain the number of samples that have been consumed
+// from the input array, as FrontendProcessSamples does.
+//
+// Unlike with FrontendProcessSamples, the samples of the frames available in
+// `samples` are read in place rather than buffered in the state, so the
+// samples of the next frames may not have been consumed: pass the remaining
+// samples on the next call.
+size_t FrontendProcessFrames(struct FrontendState* state,
+                             const int16_t* samples, size_t num_samples,
+                             uint16_t* features, size_t max_num_frames,
+                             size_t* num_samples_read);
+
 void FrontendReset(struct FrontendState* state);
 
 #ifdef __cplusplus
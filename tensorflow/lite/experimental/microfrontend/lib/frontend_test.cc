@@ -0,0 +1,163 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/experimental/microfrontend/lib/frontend.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "tensorflow/lite/experimental/microfrontend/lib/frontend_util.h"
+#include "tensorflow/lite/experimental/microfrontend/lib/window.h"
+
+namespace {
+
+constexpr int kSampleRate = 16000;
+
+// Returns deterministic audio of `num_samples` samples, a sine-like wave with
+// noise, loud enough to exercise all the stages of the frontend.
+std::vector<int16_t> MakeAudio(int num_samples) {
+  std::vector<int16_t> audio(num_samples);
+  uint32_t seed = 1;
+  for (int i = 0; i < num_samples; ++i) {
+    seed = seed * 1103515245 + 12345;
+    const int noise = static_cast<int>((seed >> 16) % 2001) - 1000;
+    const int wave = ((i % 80) < 40 ? (i % 40) : 40 - (i % 40)) * 500 - 10000;
+    audio[i] = static_cast<int16_t>(wave + noise);
+  }
+  return audio;
+}
+
+class FrontendTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    struct FrontendConfig config;
+    FrontendFillConfigWithDefaults(&config);
+    ASSERT_TRUE(FrontendPopulateState(&config, &reference_state_, kSampleRate));
+    ASSERT_TRUE(FrontendPopulateState(&config, &state_, kSampleRate));
+    num_channels_ = state_.filterbank.num_channels;
+  }
+
+  void TearDown() override {
+    FrontendFreeStateContents(&reference_state_);
+    FrontendFreeStateContents(&state_);
+  }
+
+  // Returns the features of `audio` computed one frame at a time.
+  std::vector<uint16_t> ProcessSamples(const std::vector<int16_t>& audio) {
+    std::vector<uint16_t> features;
+    const int16_t* samples = audio.data();
+    size_t num_samples = audio.size();
+    while (num_samples > 0) {
+      size_t num_samples_read;
+      struct FrontendOutput output = FrontendProcessSamples(
+          &reference_state_, samples, num_samples, &num_samples_read);
+      samples += num_samples_read;
+      num_samples -= num_samples_read;
+      if (output.values != nullptr) {
+        EXPECT_EQ(output.size, num_channels_);
+        features.insert(features.end(), output.values,
+                        output.values + output.size);
+      }
+    }
+    return features;
+  }
+
+  // Returns the features of `audio` computed by batches of at most
+  // `max_num_frames` frames, passing at most `max_num_samples` samples at a
+  // time, including the ones not consumed by the previous batch.
+  std::vector<uint16_t> ProcessFrames(const std::vector<int16_t>& audio,
+                                      size_t max_num_frames,
+                                      size_t max_num_samples) {
+    std::vector<uint16_t> features;
+    std::vector<uint16_t> batch(max_num_frames * num_channels_);
+    size_t offset = 0;
+    while (offset < audio.size()) {
+      const size_t num_samples =
+          std::min(max_num_samples, audio.size() - offset);
+      size_t num_samples_read;
+      const size_t num_frames =
+          FrontendProcessFrames(&state_, audio.data() + offset, num_samples,
+                                batch.data(), max_num_frames, &num_samples_read);
+      EXPECT_LE(num_frames, max_num_frames);
+      EXPECT_LE(num_samples_read, num_samples);
+      EXPECT_GT(num_samples_read, 0);
+      if (num_samples_read == 0) break;
+      offset += num_samples_read;
+      features.insert(features.end(), batch.begin(),
+                      batch.begin() + num_frames * num_channels_);
+    }
+    return features;
+  }
+
+  struct FrontendState reference_state_;
+  struct FrontendState state_;
+  size_t num_channels_;
+};
+
+TEST_F(FrontendTest, ProcessFramesMatchesProcessSamples) {
+  const std::vector<int16_t> audio = MakeAudio(kSampleRate);
+  const std::vector<uint16_t> expected = ProcessSamples(audio);
+  ASSERT_GT(expected.size(), 0);
+  EXPECT_EQ(ProcessFrames(audio, /*max_num_frames=*/1000, audio.size()),
+            expected);
+}
+
+TEST_F(FrontendTest, ProcessFramesResumesAfterPartialBatch) {
+  const std::vector<int16_t> audio = MakeAudio(kSampleRate);
+  const std::vector<uint16_t> expected = ProcessSamples(audio);
+  EXPECT_EQ(ProcessFrames(audio, /*max_num_frames=*/3, audio.size()),
+            expected);
+}
+
+TEST_F(FrontendTest, ProcessFramesResumesFromBufferedSamples) {
+  // The batches end with samples that are not a whole window, which are
+  // buffered in the state and completed by the next batches.
+  const std::vector<int16_t> audio = MakeAudio(kSampleRate);
+  const std::vector<uint16_t> expected = ProcessSamples(audio);
+  EXPECT_EQ(ProcessFrames(audio, /*max_num_frames=*/4, /*max_num_samples=*/999),
+            expected);
+}
+
+TEST_F(FrontendTest, ProcessFramesAfterProcessSamples) {
+  const std::vector<int16_t> audio = MakeAudio(kSampleRate);
+  const std::vector<uint16_t> expected = ProcessSamples(audio);
+  // The first samples are buffered in the state by FrontendProcessSamples,
+  // and the next windows start with them.
+  size_t num_samples_read;
+  struct FrontendOutput output =
+      FrontendProcessSamples(&state_, audio.data(), 100, &num_samples_read);
+  ASSERT_EQ(output.values, nullptr);
+  ASSERT_EQ(num_samples_read, 100);
+  const std::vector<uint16_t> features = ProcessFrames(
+      std::vector<int16_t>(audio.begin() + 100, audio.end()), 7, audio.size());
+  EXPECT_EQ(features, expected);
+}
+
+TEST_F(FrontendTest, WindowApplyMatchesWindowProcessSamples) {
+  const std::vector<int16_t> audio = MakeAudio(state_.window.size);
+  size_t num_samples_read;
+  ASSERT_TRUE(WindowProcessSamples(&reference_state_.window, audio.data(),
+                                   audio.size(), &num_samples_read));
+  WindowApply(&state_.window, audio.data());
+  EXPECT_EQ(state_.window.input_used, 0);
+  EXPECT_EQ(state_.window.max_abs_output_value,
+            reference_state_.window.max_abs_output_value);
+  EXPECT_TRUE(std::equal(state_.window.output,
+                         state_.window.output + state_.window.size,
+                         reference_state_.window.output));
+}
+
+}  // namespace
@@ -40,6 +40,10 @@ struct WindowState {
 int WindowProcessSamples(struct WindowState* state, const int16_t* samples,
                          size_t num_samples, size_t* num_samples_read);
 
+// Applies the window to the `size` samples of `input`, which aren't copied to
+// the state. Only valid when no samples are buffered (`input_used` is 0).
+void WindowApply(struct WindowState* state, const int16_t* input);
+
 void WindowReset(struct WindowState* state);
 
 #ifdef __cplusplus
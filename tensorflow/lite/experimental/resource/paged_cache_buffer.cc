@@ -0,0 +1,176 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/experimental/resource/paged_cache_buffer.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/lite/core/c/c_api_types.h"
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/kernels/internal/compatibility.h"
+
+namespace tflite {
+namespace resource {
+
+TfLiteStatus PagedCacheBuffer::Initialize(int num_layers, int num_blocks,
+                                          int block_size, int max_num_entries,
+                                          int num_heads, int head_dim) {
+  if (num_layers <= 0 || num_blocks <= 0 || block_size <= 0 ||
+      max_num_entries <= 0 || num_heads <= 0 || head_dim <= 0) {
+    return kTfLiteError;
+  }
+  num_layers_ = num_layers;
+  num_blocks_ = num_blocks;
+  block_size_ = block_size;
+  max_num_entries_ = max_num_entries;
+  num_heads_ = num_heads;
+  head_dim_ = head_dim;
+
+  const size_t buf_size = BlockOffset(num_blocks, 0);
+  keys_.reset(new float[buf_size]);
+  values_.reset(new float[buf_size]);
+  memset(keys_.get(), 0, sizeof(float) * buf_size);
+  memset(values_.get(), 0, sizeof(float) * buf_size);
+
+  ref_counts_.assign(num_blocks, 0);
+  free_blocks_.clear();
+  // Taken from the back, so that the blocks are used in order.
+  for (int block = num_blocks - 1; block >= 0; --block) {
+    free_blocks_.push_back(block);
+  }
+  sequences_.clear();
+  return kTfLiteOk;
+}
+
+size_t PagedCacheBuffer::GetMemoryUsage() {
+  return 2 * sizeof(float) * BlockOffset(num_blocks_, 0);
+}
+
+size_t PagedCacheBuffer::BlockOffset(int block, int layer) const {
+  const size_t block_elements =
+      static_cast<size_t>(block_size_) * num_heads_ * head_dim_;
+  return (static_cast<size_t>(block) * num_layers_ + layer) * block_elements;
+}
+
+int PagedCacheBuffer::TakeBlock() {
+  if (free_blocks_.empty()) return -1;
+  const int block = free_blocks_.back();
+  free_blocks_.pop_back();
+  ref_counts_[block] = 1;
+  return block;
+}
+
+void PagedCacheBuffer::ReleaseBlock(int block) {
+  if (--ref_counts_[block] == 0) free_blocks_.push_back(block);
+}
+
+TfLiteStatus PagedCacheBuffer::WriteEntry(int sequence, int layer,
+                                          int position, const float* key,
+                                          const float* value) {
+  if (layer < 0 || layer >= num_layers_ || position < 0 ||
+      position >= max_num_entries_) {
+    return kTfLiteError;
+  }
+  Sequence& seq = sequences_[sequence];
+  seq.num_entries.resize(num_layers_);
+
+  const int block_index = position / block_size_;
+  while (static_cast<int>(seq.blocks.size()) <= block_index) {
+    const int block = TakeBlock();
+    if (block < 0) return kTfLiteError;
+    seq.blocks.push_back(block);
+  }
+  int& block = seq.blocks[block_index];
+  if (ref_counts_[block] > 1) {
+    // Copy on write: the other sequences keep the shared block.
+    const int copy = TakeBlock();
+    if (copy < 0) return kTfLiteError;
+    const size_t block_elements = BlockOffset(1, 0);
+    memcpy(keys_.get() + BlockOffset(copy, 0),
+           keys_.get() + BlockOffset(block, 0), sizeof(float) * block_elements);
+    memcpy(values_.get() + BlockOffset(copy, 0),
+           values_.get() + BlockOffset(block, 0),
+           sizeof(float) * block_elements);
+    ReleaseBlock(block);
+    block = copy;
+  }
+
+  const int entry_size = num_heads_ * head_dim_;
+  const size_t offset =
+      BlockOffset(block, layer) + (position % block_size_) * entry_size;
+  memcpy(keys_.get() + offset, key, sizeof(float) * entry_size);
+  memcpy(values_.get() + offset, value, sizeof(float) * entry_size);
+  seq.num_entries[layer] = std::max(seq.num_entries[layer], position + 1);
+  return kTfLiteOk;
+}
+
+int PagedCacheBuffer::GetNumEntries(int sequence, int layer) const {
+  auto it = sequences_.find(sequence);
+  if (it == sequences_.end() || layer < 0 || layer >= num_layers_) return 0;
+  return it->second.num_entries[layer];
+}
+
+const float* PagedCacheBuffer::GetKeys(int sequence, int layer,
+                                       int block_index) const {
+  const Sequence& seq = sequences_.at(sequence);
+  TFLITE_DCHECK(block_index < static_cast<int>(seq.blocks.size()));
+  return keys_.get() + BlockOffset(seq.blocks[block_index], layer);
+}
+
+const float* PagedCacheBuffer::GetValues(int sequence, int layer,
+                                         int block_index) const {
+  const Sequence& seq = sequences_.at(sequence);
+  TFLITE_DCHECK(block_index < static_cast<int>(seq.blocks.size()));
+  return values_.get() + BlockOffset(seq.blocks[block_index], layer);
+}
+
+TfLiteStatus PagedCacheBuffer::ForkSequence(int parent, int child,
+                                            int num_entries) {
+  auto it = sequences_.find(parent);
+  if (it == sequences_.end() || sequences_.count(child) || num_entries < 0) {
+    return kTfLiteError;
+  }
+  const Sequence& parent_seq = it->second;
+  Sequence child_seq;
+  child_seq.num_entries.resize(num_layers_);
+  for (int layer = 0; layer < num_layers_; ++layer) {
+    child_seq.num_entries[layer] =
+        std::min(parent_seq.num_entries[layer], num_entries);
+  }
+  const int num_shared_blocks =
+      std::min<int>(parent_seq.blocks.size(),
+                    (num_entries + block_size_ - 1) / block_size_);
+  for (int i = 0; i < num_shared_blocks; ++i) {
+    const int block = parent_seq.blocks[i];
+    ++ref_counts_[block];
+    child_seq.blocks.push_back(block);
+  }
+  sequences_.emplace(child, std::move(child_seq));
+  return kTfLiteOk;
+}
+
+void PagedCacheBuffer::ReleaseSequence(int sequence) {
+  auto it = sequences_.find(sequence);
+  if (it == sequences_.end()) return;
+  for (int block : it->second.blocks) ReleaseBlock(block);
+  sequences_.erase(it);
+}
+
+}  // namespace resource
+}  // namespace tflite
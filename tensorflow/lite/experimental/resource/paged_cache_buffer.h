@@ -0,0 +1,115 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_EXPERIMENTAL_RESOURCE_PAGED_CACHE_BUFFER_H_
+#define TENSORFLOW_LITE_EXPERIMENTAL_RESOURCE_PAGED_CACHE_BUFFER_H_
+
+#include <cstddef>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/experimental/resource/resource_base.h"
+
+namespace tflite {
+namespace resource {
+
+/// WARNING: Experimental interface, subject to change.
+// A paged cache of the keys and values of the attention layers of a
+// transformer, for several sequences decoded at once.
+//
+// The memory is a pool of fixed size blocks, each holding the keys and the
+// values of `block_size` consecutive positions for all the layers. Every
+// sequence has a block table mapping its positions to blocks, which are only
+// taken from the pool as the sequence grows, so short sequences don't use the
+// memory of the longest one. Blocks are reference counted: a sequence forked
+// from another one shares the blocks of their common prefix, and a shared
+// block is copied the first time one of the sequences writes to it.
+class PagedCacheBuffer : public ResourceBase {
+ public:
+  PagedCacheBuffer() = default;
+  PagedCacheBuffer(const PagedCacheBuffer &) = delete;
+  PagedCacheBuffer &operator=(const PagedCacheBuffer &) = delete;
+
+  // Allocates `num_blocks` blocks of `block_size` positions. A sequence has
+  // at most `max_num_entries` positions, and an entry of a layer has
+  // `num_heads * head_dim` floats.
+  TfLiteStatus Initialize(int num_layers, int num_blocks, int block_size,
+                          int max_num_entries, int num_heads, int head_dim);
+  bool IsInitialized() override { return keys_ != nullptr; }
+  size_t GetMemoryUsage() override;
+
+  int num_layers() const { return num_layers_; }
+  int block_size() const { return block_size_; }
+  int max_num_entries() const { return max_num_entries_; }
+  int num_heads() const { return num_heads_; }
+  int head_dim() const { return head_dim_; }
+  int GetNumFreeBlocks() const { return free_blocks_.size(); }
+
+  // Writes the key and the value of `position` of `sequence` for `layer`,
+  // taking a block from the pool or copying a shared one as needed. Fails if
+  // `position` isn't smaller than `max_num_entries` or the pool is empty.
+  TfLiteStatus WriteEntry(int sequence, int layer, int position,
+                          const float *key, const float *value);
+
+  // Returns the number of positions of `sequence` written for `layer`, i.e.
+  // one more than the greatest written position.
+  int GetNumEntries(int sequence, int layer) const;
+
+  // Returns the keys or values of `layer` in the `block_index`-th block of
+  // `sequence`: `block_size` entries of `num_heads * head_dim` floats. The
+  // block must exist, i.e. `block_index * block_size` must be smaller than
+  // the number of entries of a layer.
+  const float *GetKeys(int sequence, int layer, int block_index) const;
+  const float *GetValues(int sequence, int layer, int block_index) const;
+
+  // Makes `child`, which must not exist, share the first `num_entries`
+  // positions of `parent`, e.g. a common prompt.
+  TfLiteStatus ForkSequence(int parent, int child, int num_entries);
+
+  // Returns the blocks of `sequence` to the pool unless other sequences still
+  // share them.
+  void ReleaseSequence(int sequence);
+
+ private:
+  struct Sequence {
+    std::vector<int> blocks;
+    // The number of entries of each layer.
+    std::vector<int> num_entries;
+  };
+
+  size_t BlockOffset(int block, int layer) const;
+  int TakeBlock();
+  void ReleaseBlock(int block);
+
+  int num_layers_ = 0;
+  int block_size_ = 0;
+  int max_num_entries_ = 0;
+  int num_heads_ = 0;
+  int head_dim_ = 0;
+  int num_blocks_ = 0;
+  // The pools, holding `num_layers * block_size * num_heads * head_dim` floats
+  // per block.
+  std::unique_ptr<float[]> keys_;
+  std::unique_ptr<float[]> values_;
+  std::vector<int> ref_counts_;
+  std::vector<int> free_blocks_;
+  std::unordered_map<int, Sequence> sequences_;
+};
+
+}  // namespace resource
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_EXPERIMENTAL_RESOURCE_PAGED_CACHE_BUFFER_H_
@@ -0,0 +1,109 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/experimental/resource/paged_cache_buffer.h"
+
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "tensorflow/lite/c/common.h"
+
+namespace tflite {
+namespace resource {
+
+TEST(PagedCacheBufferTest, TakesBlocksAsSequencesGrow) {
+  PagedCacheBuffer cache_buffer;
+  ASSERT_EQ(cache_buffer.Initialize(/*num_layers=*/2, /*num_blocks=*/4,
+                                    /*block_size=*/2, /*max_num_entries=*/6,
+                                    /*num_heads=*/1, /*head_dim=*/3),
+            kTfLiteOk);
+  EXPECT_EQ(cache_buffer.GetMemoryUsage(), 2 * 4 * 2 * 2 * 3 * sizeof(float));
+  EXPECT_EQ(cache_buffer.GetNumFreeBlocks(), 4);
+
+  const std::vector<float> key = {1, 2, 3};
+  const std::vector<float> value = {4, 5, 6};
+  ASSERT_EQ(cache_buffer.WriteEntry(0, 1, 0, key.data(), value.data()),
+            kTfLiteOk);
+  EXPECT_EQ(cache_buffer.GetNumFreeBlocks(), 3);
+  ASSERT_EQ(cache_buffer.WriteEntry(0, 1, 1, value.data(), key.data()),
+            kTfLiteOk);
+  EXPECT_EQ(cache_buffer.GetNumFreeBlocks(), 3);
+  ASSERT_EQ(cache_buffer.WriteEntry(0, 1, 2, key.data(), value.data()),
+            kTfLiteOk);
+  EXPECT_EQ(cache_buffer.GetNumFreeBlocks(), 2);
+  EXPECT_EQ(cache_buffer.GetNumEntries(0, 0), 0);
+  EXPECT_EQ(cache_buffer.GetNumEntries(0, 1), 3);
+  EXPECT_EQ(cache_buffer.GetNumEntries(1, 1), 0);
+
+  const float* keys = cache_buffer.GetKeys(0, 1, 0);
+  EXPECT_EQ(std::vector<float>(keys, keys + 6),
+            std::vector<float>({1, 2, 3, 4, 5, 6}));
+  const float* values = cache_buffer.GetValues(0, 1, 1);
+  EXPECT_EQ(std::vector<float>(values, values + 3), value);
+
+  // Past the maximum number of entries.
+  EXPECT_EQ(cache_buffer.WriteEntry(0, 1, 6, key.data(), value.data()),
+            kTfLiteError);
+  // Out of blocks.
+  ASSERT_EQ(cache_buffer.WriteEntry(1, 0, 3, key.data(), value.data()),
+            kTfLiteOk);
+  EXPECT_EQ(cache_buffer.GetNumFreeBlocks(), 0);
+  EXPECT_EQ(cache_buffer.WriteEntry(2, 0, 0, key.data(), value.data()),
+            kTfLiteError);
+
+  cache_buffer.ReleaseSequence(1);
+  EXPECT_EQ(cache_buffer.GetNumFreeBlocks(), 2);
+  EXPECT_EQ(cache_buffer.GetNumEntries(1, 0), 0);
+}
+
+TEST(PagedCacheBufferTest, ForkedSequencesShareBlocks) {
+  PagedCacheBuffer cache_buffer;
+  ASSERT_EQ(cache_buffer.Initialize(/*num_layers=*/1, /*num_blocks=*/4,
+                                    /*block_size=*/2, /*max_num_entries=*/8,
+                                    /*num_heads=*/1, /*head_dim=*/1),
+            kTfLiteOk);
+  for (int position = 0; position < 3; ++position) {
+    const float entry = position;
+    ASSERT_EQ(cache_buffer.WriteEntry(0, 0, position, &entry, &entry),
+              kTfLiteOk);
+  }
+  EXPECT_EQ(cache_buffer.GetNumFreeBlocks(), 2);
+
+  ASSERT_EQ(cache_buffer.ForkSequence(0, 1, 3), kTfLiteOk);
+  EXPECT_EQ(cache_buffer.ForkSequence(0, 1, 3), kTfLiteError);
+  EXPECT_EQ(cache_buffer.GetNumFreeBlocks(), 2);
+  EXPECT_EQ(cache_buffer.GetNumEntries(1, 0), 3);
+  EXPECT_EQ(cache_buffer.GetKeys(1, 0, 1), cache_buffer.GetKeys(0, 0, 1));
+
+  // Writing to the shared block copies it.
+  const float entry = 10;
+  ASSERT_EQ(cache_buffer.WriteEntry(1, 0, 3, &entry, &entry), kTfLiteOk);
+  EXPECT_EQ(cache_buffer.GetNumFreeBlocks(), 1);
+  EXPECT_EQ(cache_buffer.GetKeys(1, 0, 0), cache_buffer.GetKeys(0, 0, 0));
+  EXPECT_NE(cache_buffer.GetKeys(1, 0, 1), cache_buffer.GetKeys(0, 0, 1));
+  EXPECT_EQ(cache_buffer.GetKeys(1, 0, 1)[0], 2);
+  EXPECT_EQ(cache_buffer.GetKeys(1, 0, 1)[1], 10);
+  EXPECT_EQ(cache_buffer.GetNumEntries(0, 0), 3);
+  EXPECT_EQ(cache_buffer.GetNumEntries(1, 0), 4);
+
+  // The first block stays in use by the fork.
+  cache_buffer.ReleaseSequence(0);
+  EXPECT_EQ(cache_buffer.GetNumFreeBlocks(), 2);
+  EXPECT_EQ(cache_buffer.GetValues(1, 0, 0)[1], 1);
+  cache_buffer.ReleaseSequence(1);
+  EXPECT_EQ(cache_buffer.GetNumFreeBlocks(), 4);
+}
+
+}  // namespace resource
+}  // namespace tflite
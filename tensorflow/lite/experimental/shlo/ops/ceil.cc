@@ -19,10 +19,12 @@ limitations under the License.
 
 #include "absl/status/status.h"
 #include "tensorflow/lite/experimental/shlo/bf16.h"
+#include "tensorflow/lite/experimental/shlo/data_type.h"
 #include "tensorflow/lite/experimental/shlo/dispatch.h"
 #include "tensorflow/lite/experimental/shlo/f16.h"
 #include "tensorflow/lite/experimental/shlo/ops/unary_elementwise.h"
 #include "tensorflow/lite/experimental/shlo/ops/util.h"
+#include "tensorflow/lite/experimental/shlo/ops/vectorized_elementwise.h"
 #include "tensorflow/lite/experimental/shlo/tensor.h"
 
 namespace shlo_ref {
@@ -63,6 +65,10 @@ absl::Status Evaluate(CeilOp& op, const Tensor& input, Tensor& output) {
         input.quantized_per_tensor_element_type().StorageType(),
         input.quantized_per_tensor_element_type().ExpressedType(), ceil, input,
         output)
+  } else if (input.StorageType() == DataType::kF32) {
+    detail::EvaluateVectorizedF32([](const auto& v) { return v.ceil(); }, input,
+                                  output);
+    return absl::OkStatus();
   } else if (IsFloatTensor(input)) {
     DISPATCH_FLOAT(detail::EvaluateNoQuantization, input.tensor_element_type(),
                    ceil, input, output);
@@ -18,9 +18,11 @@ limitations under the License.
 #include <functional>
 
 #include "absl/status/status.h"
+#include "tensorflow/lite/experimental/shlo/data_type.h"
 #include "tensorflow/lite/experimental/shlo/dispatch.h"
 #include "tensorflow/lite/experimental/shlo/ops/binary_elementwise.h"
 #include "tensorflow/lite/experimental/shlo/ops/util.h"
+#include "tensorflow/lite/experimental/shlo/ops/vectorized_elementwise.h"
 #include "tensorflow/lite/experimental/shlo/tensor.h"
 
 namespace shlo_ref {
@@ -45,7 +47,10 @@ absl::Status Prepare(DivideOp& op, const Tensor& lhs, const Tensor& rhs,
 absl::Status Evaluate(DivideOp& op, const Tensor& lhs, const Tensor& rhs,
                       Tensor& output) {
   Divide divide;
-  if (IsIntTensor(lhs) || IsFloatTensor(lhs)) {
+  if (lhs.StorageType() == DataType::kF32) {
+    detail::EvaluateVectorizedF32(divide, lhs, rhs, output);
+    return absl::OkStatus();
+  } else if (IsIntTensor(lhs) || IsFloatTensor(lhs)) {
     // Note: all the arithmetic types share the same implementation.
     DISPATCH_INT_FLOAT(detail::EvaluateNoQuantization,
                        lhs.tensor_element_type(), divide, lhs, rhs, output);
@@ -22,6 +22,7 @@ limitations under the License.
 #include "tensorflow/lite/experimental/shlo/dispatch.h"
 #include "tensorflow/lite/experimental/shlo/ops/binary_elementwise.h"
 #include "tensorflow/lite/experimental/shlo/ops/util.h"
+#include "tensorflow/lite/experimental/shlo/ops/vectorized_elementwise.h"
 #include "tensorflow/lite/experimental/shlo/tensor.h"
 
 namespace shlo_ref {
@@ -58,6 +59,9 @@ absl::Status Evaluate(MultiplyOp& op, const Tensor& lhs, const Tensor& rhs,
     detail::EvaluateNoQuantization<DataType::kI1>(Multiply<DataType::kI1>(),
                                                   lhs, rhs, output);
     return absl::OkStatus();
+  } else if (lhs.StorageType() == DataType::kF32) {
+    detail::EvaluateVectorizedF32(Multiply<DataType::kF32>(), lhs, rhs, output);
+    return absl::OkStatus();
   } else if (IsIntTensor(lhs) || IsFloatTensor(lhs)) {
     // Note: all the arithmetic types share the same implementation.
     Multiply<DataType::kF32> multiply;
@@ -18,9 +18,11 @@ limitations under the License.
 #include <functional>
 
 #include "absl/status/status.h"
+#include "tensorflow/lite/experimental/shlo/data_type.h"
 #include "tensorflow/lite/experimental/shlo/dispatch.h"
 #include "tensorflow/lite/experimental/shlo/ops/unary_elementwise.h"
 #include "tensorflow/lite/experimental/shlo/ops/util.h"
+#include "tensorflow/lite/experimental/shlo/ops/vectorized_elementwise.h"
 #include "tensorflow/lite/experimental/shlo/tensor.h"
 
 namespace shlo_ref {
@@ -47,6 +49,9 @@ absl::Status Evaluate(NegateOp& op, const Tensor& input, Tensor& output) {
         input.quantized_per_tensor_element_type().StorageType(),
         input.quantized_per_tensor_element_type().ExpressedType(), negate,
         input, output)
+  } else if (input.StorageType() == DataType::kF32) {
+    detail::EvaluateVectorizedF32(negate, input, output);
+    return absl::OkStatus();
   } else if (IsSignedIntTensor(input) || IsFloatTensor(input)) {
     DISPATCH_INT_FLOAT(detail::EvaluateNoQuantization,
                        input.tensor_element_type(), negate, input, output);
@@ -0,0 +1,62 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_EXPERIMENTAL_SHLO_OPS_VECTORIZED_ELEMENTWISE_H_
+#define TENSORFLOW_LITE_EXPERIMENTAL_SHLO_OPS_VECTORIZED_ELEMENTWISE_H_
+
+#include "Eigen/Core"  // from @eigen_archive
+#include "tensorflow/lite/experimental/shlo/data_type.h"
+#include "tensorflow/lite/experimental/shlo/tensor.h"
+
+namespace shlo_ref {
+
+namespace detail {
+
+// The following functions evaluate elementwise ops on f32 tensors as Eigen
+// array expressions, which Eigen evaluates with the SIMD instructions of the
+// target. `func` takes and returns Eigen arrays, e.g. `std::minus<void>` or
+// `[](const auto& v) { return v.sqrt(); }`.
+//
+// Only use them for the ops whose vectorized implementation gives the same
+// results as the scalar one.
+
+template <class F>
+void EvaluateVectorizedF32(F&& func, const Tensor& input, Tensor& output) {
+  using Array = Eigen::Array<float, Eigen::Dynamic, 1>;
+  const Eigen::Index num_elements = input.NumElements();
+  const Eigen::Map<const Array> input_array(input.GetDataAs<DataType::kF32>(),
+                                            num_elements);
+  Eigen::Map<Array>(output.GetDataAs<DataType::kF32>(), num_elements) =
+      func(input_array);
+}
+
+template <class F>
+void EvaluateVectorizedF32(F&& func, const Tensor& lhs, const Tensor& rhs,
+                           Tensor& output) {
+  using Array = Eigen::Array<float, Eigen::Dynamic, 1>;
+  const Eigen::Index num_elements = lhs.NumElements();
+  const Eigen::Map<const Array> lhs_array(lhs.GetDataAs<DataType::kF32>(),
+                                          num_elements);
+  const Eigen::Map<const Array> rhs_array(rhs.GetDataAs<DataType::kF32>(),
+                                          num_elements);
+  Eigen::Map<Array>(output.GetDataAs<DataType::kF32>(), num_elements) =
+      func(lhs_array, rhs_array);
+}
+
+}  // namespace detail
+
+}  // namespace shlo_ref
+
+#endif  // TENSORFLOW_LITE_EXPERIMENTAL_SHLO_OPS_VECTORIZED_ELEMENTWISE_H_
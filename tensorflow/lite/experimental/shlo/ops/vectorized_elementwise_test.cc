@@ -0,0 +1,98 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/experimental/shlo/ops/vectorized_elementwise.h"
+
+#include <cmath>
+#include <functional>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "tensorflow/lite/experimental/shlo/data_type.h"
+#include "tensorflow/lite/experimental/shlo/shape.h"
+#include "tensorflow/lite/experimental/shlo/tensor.h"
+
+using testing::ElementsAreArray;
+
+namespace shlo_ref {
+namespace {
+
+// An odd number of elements, to evaluate both the SIMD packets and the
+// remaining elements.
+constexpr DimensionSize kNumElements = 37;
+
+std::vector<float> Iota(float begin, float step) {
+  std::vector<float> values(kNumElements);
+  for (int i = 0; i < kNumElements; ++i) values[i] = begin + i * step;
+  return values;
+}
+
+Tensor F32Tensor(std::vector<float>& values) {
+  return Tensor{.type = TensorType{.shape = Shape({kNumElements}),
+                                   .element_type = DataType::kF32},
+                .data = values.data()};
+}
+
+TEST(EvaluateVectorizedF32Test, UnaryMatchesScalarEvaluation) {
+  std::vector<float> input_data = Iota(-4.3f, 0.37f);
+  std::vector<float> output_data(kNumElements);
+  Tensor input = F32Tensor(input_data);
+  Tensor output = F32Tensor(output_data);
+
+  detail::EvaluateVectorizedF32([](const auto& v) { return v.floor(); }, input,
+                                output);
+
+  std::vector<float> expected_data(kNumElements);
+  for (int i = 0; i < kNumElements; ++i) {
+    expected_data[i] = std::floor(input_data[i]);
+  }
+  EXPECT_THAT(output_data, ElementsAreArray(expected_data));
+}
+
+TEST(EvaluateVectorizedF32Test, BinaryMatchesScalarEvaluation) {
+  std::vector<float> lhs_data = Iota(-4.3f, 0.37f);
+  std::vector<float> rhs_data = Iota(1.5f, 0.11f);
+  std::vector<float> output_data(kNumElements);
+  Tensor lhs = F32Tensor(lhs_data);
+  Tensor rhs = F32Tensor(rhs_data);
+  Tensor output = F32Tensor(output_data);
+
+  detail::EvaluateVectorizedF32(std::divides<void>(), lhs, rhs, output);
+
+  std::vector<float> expected_data(kNumElements);
+  for (int i = 0; i < kNumElements; ++i) {
+    expected_data[i] = lhs_data[i] / rhs_data[i];
+  }
+  EXPECT_THAT(output_data, ElementsAreArray(expected_data));
+}
+
+TEST(EvaluateVectorizedF32Test, OutputMayBeAnInput) {
+  std::vector<float> data = Iota(-4.3f, 0.37f);
+  const std::vector<float> input_data = data;
+  Tensor tensor = F32Tensor(data);
+
+  detail::EvaluateVectorizedF32(std::multiplies<void>(), tensor, tensor,
+                                tensor);
+
+  std::vector<float> expected_data(kNumElements);
+  for (int i = 0; i < kNumElements; ++i) {
+    expected_data[i] = input_data[i] * input_data[i];
+  }
+  EXPECT_THAT(data, ElementsAreArray(expected_data));
+}
+
+}  // namespace
+}  // namespace shlo_ref
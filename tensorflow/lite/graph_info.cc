@@ -289,4 +289,25 @@ TfLiteStatus PartitionGraphIntoIndependentNodeSubsets(
   return kTfLiteOk;
 }
 
+std::vector<int> GetNodeLevels(const GraphInfo& info) {
+  // The level of the node producing each tensor, -1 for the tensors which
+  // aren't produced by a node.
+  std::vector<int> tensor_levels(info.num_tensors(), -1);
+  std::vector<int> node_levels(info.num_execution_nodes());
+  for (size_t i = 0; i < info.num_execution_nodes(); ++i) {
+    const TfLiteNode& node = info.node(i);
+    int level = 0;
+    for (int tensor_index : TfLiteIntArrayView(node.inputs)) {
+      if (tensor_index == kTfLiteOptionalTensor) continue;
+      level = std::max(level, tensor_levels[tensor_index] + 1);
+    }
+    for (int tensor_index : TfLiteIntArrayView(node.outputs)) {
+      if (tensor_index == kTfLiteOptionalTensor) continue;
+      tensor_levels[tensor_index] = level;
+    }
+    node_levels[i] = level;
+  }
+  return node_levels;
+}
+
 }  // namespace tflite
@@ -156,6 +156,14 @@ TfLiteStatus PartitionGraphIntoIndependentNodeSubsets(
     std::vector<NodeSubset>* node_subsets, bool greedily,
     const ControlEdges* control_edges = nullptr);
 
+// Returns the level of each node of the execution plan of `info`: the nodes
+// which only read the graph inputs and constant tensors are at level 0, and
+// every other node is one level above the highest level of the nodes producing
+// its inputs. The nodes of a level don't depend on each other, so they may be
+// executed in any order once the nodes of the lower levels have been. The
+// function assumes that the nodes of `info` are in dependency order.
+std::vector<int> GetNodeLevels(const GraphInfo& info);
+
 }  // namespace tflite
 
 #endif  // TENSORFLOW_LITE_GRAPH_INFO_H_
@@ -19,8 +19,19 @@ limitations under the License.
 #ifndef TENSORFLOW_LITE_INTERPRETER_OPTIONS_H_
 #define TENSORFLOW_LITE_INTERPRETER_OPTIONS_H_
 
+#include <algorithm>
+#include <memory>
+#include <utility>
+#include <vector>
+
 namespace tflite {
 
+class KernelAutotuneCache;
+
+namespace xnnpack {
+class SharedWeightsCache;
+}  // namespace xnnpack
+
 /// Options class for `Interpreter`.
 /// WARNING: This is an experimental API and subject to change.
 class InterpreterOptions {
@@ -103,12 +114,162 @@ class InterpreterOptions {
     return experimental_cache_constant_cast_op_;
   }
 
+  /// Sets the sizes `ResizeInputTensor` rounds dimension `dimension` of the
+  /// subgraph inputs up to: a size is replaced by the smallest of
+  /// `bucket_sizes` not smaller than it, and sizes greater than all of them
+  /// are kept. Resizing an input within the bucket of its current size then
+  /// changes nothing, and the nodes aren't prepared nor the memory planned
+  /// again. The caller fills the first elements along `dimension` and pads
+  /// the rest, e.g. with zeros, and can read the rounded shape from the
+  /// tensor. Since the memory arena never shrinks, once the largest bucket
+  /// has been allocated the other buckets don't reallocate it.
+  ///
+  /// WARNING: This is an experimental API and subject to change.
+  void SetShapeBuckets(int dimension, std::vector<int> bucket_sizes) {
+    std::sort(bucket_sizes.begin(), bucket_sizes.end());
+    experimental_shape_bucket_dimension_ = dimension;
+    experimental_shape_bucket_sizes_ = std::move(bucket_sizes);
+  }
+
+  /// Returns the dimension rounded up by `SetShapeBuckets`, or -1.
+  ///
+  /// WARNING: This is an experimental API and subject to change.
+  int GetShapeBucketDimension() const {
+    return experimental_shape_bucket_dimension_;
+  }
+
+  /// Returns the sorted sizes set with `SetShapeBuckets`.
+  ///
+  /// WARNING: This is an experimental API and subject to change.
+  const std::vector<int>& GetShapeBucketSizes() const {
+    return experimental_shape_bucket_sizes_;
+  }
+
+  /// If `true`, the offsets of the tensors in the memory arena are planned in
+  /// a few orders besides the default one, by size, and the order needing
+  /// the smallest arena is kept. This makes `AllocateTensors` slower when all
+  /// the tensors are allocated at once.
+  ///
+  /// WARNING: This is an experimental API and subject to change.
+  void SetMinimizeArenaSize(bool value = true) {
+    experimental_minimize_arena_size_ = value;
+  }
+
+  /// Returns `true` if the memory arena size is minimized, see
+  /// `SetMinimizeArenaSize`.
+  ///
+  /// WARNING: This is an experimental API and subject to change.
+  bool GetMinimizeArenaSize() const {
+    return experimental_minimize_arena_size_;
+  }
+
+  /// Sets the number of threads executing the independent nodes of the
+  /// subgraphs concurrently, i.e. the nodes of a level of their execution
+  /// plans (see `GetNodeLevels` in tensorflow/lite/graph_info.h) once the
+  /// nodes of the lower levels have been executed. The nodes running
+  /// concurrently use one thread each. The execution plans are ordered by
+  /// level, and their memory is planned for this execution. A subgraph is
+  /// still executed node by node if it has delegated or custom nodes, nodes
+  /// which might have side effects, variables or dynamic tensors, or if a
+  /// profiler is set. A value smaller than 2 disables concurrent execution.
+  ///
+  /// WARNING: This is an experimental API and subject to change.
+  void SetNumInterOpThreads(int num_threads) {
+    experimental_num_inter_op_threads_ = num_threads;
+  }
+
+  /// Returns the number of threads executing independent nodes concurrently.
+  ///
+  /// WARNING: This is an experimental API and subject to change.
+  int GetNumInterOpThreads() const {
+    return experimental_num_inter_op_threads_;
+  }
+
+  /// Shares the weights packed by the XNNPACK delegate applied by default to
+  /// the interpreter with the other interpreters given the same
+  /// `weights_cache`, e.g. the interpreters built from one model to serve
+  /// requests concurrently. See
+  /// tensorflow/lite/delegates/xnnpack/shared_weights_cache.h.
+  ///
+  /// WARNING: This is an experimental API and subject to change.
+  void SetXNNPackWeightsCache(
+      std::shared_ptr<xnnpack::SharedWeightsCache> weights_cache) {
+    experimental_xnnpack_weights_cache_ = std::move(weights_cache);
+  }
+
+  /// Returns the cache set with `SetXNNPackWeightsCache`, or nullptr.
+  ///
+  /// WARNING: This is an experimental API and subject to change.
+  const std::shared_ptr<xnnpack::SharedWeightsCache>& GetXNNPackWeightsCache()
+      const {
+    return experimental_xnnpack_weights_cache_;
+  }
+
+  /// Makes the kernels with several implementations use the ones recorded in
+  /// `cache`, and time their implementations during the first invocations
+  /// to record the fastest one otherwise. The application saves the cache to
+  /// a file after a warmup invocation and loads it in the later runs. See
+  /// tensorflow/lite/kernels/kernel_autotune_cache.h.
+  ///
+  /// WARNING: This is an experimental API and subject to change.
+  void SetKernelAutotuneCache(std::shared_ptr<KernelAutotuneCache> cache) {
+    experimental_kernel_autotune_cache_ = std::move(cache);
+  }
+
+  /// Returns the cache set with `SetKernelAutotuneCache`, or nullptr.
+  ///
+  /// WARNING: This is an experimental API and subject to change.
+  const std::shared_ptr<KernelAutotuneCache>& GetKernelAutotuneCache() const {
+    return experimental_kernel_autotune_cache_;
+  }
+
+  /// If `true`, the constant tensors mapped from the model file are streamed
+  /// while the subgraphs are executed node by node, to lower the peak
+  /// resident memory of models larger than the memory available, at the cost
+  /// of reading the weights from the file at each invocation. The weights
+  /// read while preparing the nodes are released by `AllocateTensors`, the
+  /// weights of a node are prefetched `prefetch_window` nodes before it, and
+  /// released after the last node reading them. The weights copied by the
+  /// kernels or delegates, e.g. packed by XNNPACK, are resident anyway. See
+  /// tensorflow/lite/core/weight_streamer.h.
+  ///
+  /// WARNING: This is an experimental API and subject to change.
+  void SetStreamMmappedWeights(bool value = true, int prefetch_window = 1) {
+    experimental_stream_mmapped_weights_ = value;
+    experimental_weight_prefetch_window_ = prefetch_window;
+  }
+
+  /// Returns `true` if the mmapped weights are streamed, see
+  /// `SetStreamMmappedWeights`.
+  ///
+  /// WARNING: This is an experimental API and subject to change.
+  bool GetStreamMmappedWeights() const {
+    return experimental_stream_mmapped_weights_;
+  }
+
+  /// Returns the number of nodes whose streamed weights are prefetched ahead
+  /// of the node being executed.
+  ///
+  /// WARNING: This is an experimental API and subject to change.
+  int GetWeightPrefetchWindow() const {
+    return experimental_weight_prefetch_window_;
+  }
+
  private:
   bool experimental_preserve_all_tensors_ = false;
   bool experimental_ensure_dynamic_tensors_are_released_ = false;
   int experimental_optimize_memory_for_large_tensors_ = 0;
   bool experimental_disable_delegate_clustering_ = false;
   bool experimental_cache_constant_cast_op_ = false;
+  int experimental_num_inter_op_threads_ = 1;
+  bool experimental_minimize_arena_size_ = false;
+  int experimental_shape_bucket_dimension_ = -1;
+  std::vector<int> experimental_shape_bucket_sizes_;
+  std::shared_ptr<xnnpack::SharedWeightsCache>
+      experimental_xnnpack_weights_cache_;
+  std::shared_ptr<KernelAutotuneCache> experimental_kernel_autotune_cache_;
+  bool experimental_stream_mmapped_weights_ = false;
+  int experimental_weight_prefetch_window_ = 1;
 };
 
 }  // namespace tflite
@@ -20,6 +20,8 @@ limitations under the License.
 #include <stdlib.h>
 #include <string.h>
 
+#include <atomic>
+#include <chrono>  // NOLINT(build/c++11)
 #include <map>
 #include <memory>
 #include <string>
@@ -1172,6 +1174,194 @@ TEST(InterpreterTensorsCapacityTest, TestExceedHeadroom) {
   ASSERT_EQ(interpreter.AllocateTensors(), kTfLiteOk);
 }
 
+// Invokes two independent nodes, which each wait a little for the other to run
+// concurrently, and a node adding their outputs.
+TEST(InterpreterInterOpThreadsTest, InvokesIndependentNodesConcurrently) {
+  static std::atomic<int> num_running;
+  static std::atomic<int> max_num_running;
+  TfLiteRegistration branch = {nullptr, nullptr, nullptr, nullptr};
+  branch.invoke = [](TfLiteContext* context, TfLiteNode* node) {
+    const int running = ++num_running;
+    int max = max_num_running;
+    while (max < running &&
+           !max_num_running.compare_exchange_weak(max, running)) {
+    }
+    for (int i = 0; i < 100 && num_running < 2; ++i) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    const TfLiteTensor* input = &context->tensors[node->inputs->data[0]];
+    TfLiteTensor* output = &context->tensors[node->outputs->data[0]];
+    output->data.f[0] = input->data.f[0] + 1;
+    --num_running;
+    return kTfLiteOk;
+  };
+  TfLiteRegistration add = {nullptr, nullptr, nullptr, nullptr};
+  add.invoke = [](TfLiteContext* context, TfLiteNode* node) {
+    const TfLiteTensor* input1 = &context->tensors[node->inputs->data[0]];
+    const TfLiteTensor* input2 = &context->tensors[node->inputs->data[1]];
+    TfLiteTensor* output = &context->tensors[node->outputs->data[0]];
+    output->data.f[0] = input1->data.f[0] + input2->data.f[0];
+    return kTfLiteOk;
+  };
+
+  for (int num_inter_op_threads : {1, 2}) {
+    Interpreter interpreter;
+    InterpreterOptions options;
+    options.SetNumInterOpThreads(num_inter_op_threads);
+    ASSERT_EQ(interpreter.ApplyOptions(&options), kTfLiteOk);
+    ASSERT_EQ(interpreter.AddTensors(4), kTfLiteOk);
+    ASSERT_EQ(interpreter.SetInputs({0}), kTfLiteOk);
+    ASSERT_EQ(interpreter.SetOutputs({3}), kTfLiteOk);
+    TfLiteQuantizationParams quant;
+    for (int i = 0; i < 4; ++i) {
+      ASSERT_EQ(interpreter.SetTensorParametersReadWrite(i, kTfLiteFloat32, "",
+                                                         {1}, quant),
+                kTfLiteOk);
+    }
+    ASSERT_EQ(interpreter.AddNodeWithParameters({0}, {1}, nullptr, 0, nullptr,
+                                                &branch),
+              kTfLiteOk);
+    ASSERT_EQ(interpreter.AddNodeWithParameters({0}, {2}, nullptr, 0, nullptr,
+                                                &branch),
+              kTfLiteOk);
+    ASSERT_EQ(interpreter.AddNodeWithParameters({1, 2}, {3}, nullptr, 0,
+                                                nullptr, &add),
+              kTfLiteOk);
+    ASSERT_EQ(interpreter.AllocateTensors(), kTfLiteOk);
+
+    // The first invocation runs the nodes one by one.
+    for (int invocation = 0; invocation < 3; ++invocation) {
+      num_running = 0;
+      max_num_running = 0;
+      interpreter.typed_tensor<float>(0)[0] = invocation;
+      ASSERT_EQ(interpreter.Invoke(), kTfLiteOk);
+      EXPECT_EQ(interpreter.typed_tensor<float>(3)[0], 2 * (invocation + 1));
+      EXPECT_EQ(max_num_running,
+                num_inter_op_threads > 1 && invocation > 0 ? 2 : 1);
+    }
+  }
+}
+
+// Invokes a chain of nodes adding one to their input, which fail on negative
+// inputs, across a resize of the input.
+TEST(InterpreterFrozenInvocationPlanTest, InvokesAgainAfterResize) {
+  TfLiteRegistration increment = {nullptr, nullptr, nullptr, nullptr};
+  increment.prepare = [](TfLiteContext* context, TfLiteNode* node) {
+    const TfLiteTensor* input = &context->tensors[node->inputs->data[0]];
+    TfLiteTensor* output = &context->tensors[node->outputs->data[0]];
+    return context->ResizeTensor(context, output,
+                                 TfLiteIntArrayCopy(input->dims));
+  };
+  increment.invoke = [](TfLiteContext* context, TfLiteNode* node) {
+    const TfLiteTensor* input = &context->tensors[node->inputs->data[0]];
+    TfLiteTensor* output = &context->tensors[node->outputs->data[0]];
+    for (int i = 0; i < NumElements(input); ++i) {
+      if (input->data.f[i] < 0) return kTfLiteError;
+      output->data.f[i] = input->data.f[i] + 1;
+    }
+    return kTfLiteOk;
+  };
+
+  Interpreter interpreter;
+  ASSERT_EQ(interpreter.AddTensors(3), kTfLiteOk);
+  ASSERT_EQ(interpreter.SetInputs({0}), kTfLiteOk);
+  ASSERT_EQ(interpreter.SetOutputs({2}), kTfLiteOk);
+  TfLiteQuantizationParams quant;
+  for (int i = 0; i < 3; ++i) {
+    ASSERT_EQ(interpreter.SetTensorParametersReadWrite(i, kTfLiteFloat32, "",
+                                                       {1}, quant),
+              kTfLiteOk);
+  }
+  ASSERT_EQ(interpreter.AddNodeWithParameters({0}, {1}, nullptr, 0, nullptr,
+                                              &increment),
+            kTfLiteOk);
+  ASSERT_EQ(interpreter.AddNodeWithParameters({1}, {2}, nullptr, 0, nullptr,
+                                              &increment),
+            kTfLiteOk);
+  ASSERT_EQ(interpreter.AllocateTensors(), kTfLiteOk);
+
+  // The invocations after the first one use the frozen invocation plan.
+  for (int invocation = 0; invocation < 3; ++invocation) {
+    interpreter.typed_tensor<float>(0)[0] = invocation;
+    ASSERT_EQ(interpreter.Invoke(), kTfLiteOk);
+    EXPECT_EQ(interpreter.typed_tensor<float>(2)[0], invocation + 2);
+  }
+  interpreter.typed_tensor<float>(0)[0] = -1;
+  EXPECT_EQ(interpreter.Invoke(), kTfLiteError);
+
+  ASSERT_EQ(interpreter.ResizeInputTensor(0, {2}), kTfLiteOk);
+  ASSERT_EQ(interpreter.AllocateTensors(), kTfLiteOk);
+  for (int invocation = 0; invocation < 2; ++invocation) {
+    interpreter.typed_tensor<float>(0)[0] = invocation;
+    interpreter.typed_tensor<float>(0)[1] = 10;
+    ASSERT_EQ(interpreter.Invoke(), kTfLiteOk);
+    EXPECT_EQ(interpreter.typed_tensor<float>(2)[0], invocation + 2);
+    EXPECT_EQ(interpreter.typed_tensor<float>(2)[1], 12);
+  }
+}
+
+TEST(InterpreterShapeBucketsTest, RoundsInputDimensionUpToBucket) {
+  static int num_prepares;
+  TfLiteRegistration copy = {nullptr, nullptr, nullptr, nullptr};
+  copy.prepare = [](TfLiteContext* context, TfLiteNode* node) {
+    ++num_prepares;
+    const TfLiteTensor* input = &context->tensors[node->inputs->data[0]];
+    TfLiteTensor* output = &context->tensors[node->outputs->data[0]];
+    return context->ResizeTensor(context, output,
+                                 TfLiteIntArrayCopy(input->dims));
+  };
+  copy.invoke = [](TfLiteContext* context, TfLiteNode* node) {
+    const TfLiteTensor* input = &context->tensors[node->inputs->data[0]];
+    TfLiteTensor* output = &context->tensors[node->outputs->data[0]];
+    memcpy(output->data.raw, input->data.raw, input->bytes);
+    return kTfLiteOk;
+  };
+
+  auto dims = [](const TfLiteTensor* tensor) {
+    return std::vector<int>(tensor->dims->data,
+                            tensor->dims->data + tensor->dims->size);
+  };
+
+  num_prepares = 0;
+  Interpreter interpreter;
+  InterpreterOptions options;
+  options.SetShapeBuckets(1, {8, 4});
+  ASSERT_EQ(interpreter.ApplyOptions(&options), kTfLiteOk);
+  ASSERT_EQ(interpreter.AddTensors(2), kTfLiteOk);
+  ASSERT_EQ(interpreter.SetInputs({0}), kTfLiteOk);
+  ASSERT_EQ(interpreter.SetOutputs({1}), kTfLiteOk);
+  TfLiteQuantizationParams quant;
+  for (int i = 0; i < 2; ++i) {
+    ASSERT_EQ(interpreter.SetTensorParametersReadWrite(i, kTfLiteFloat32, "",
+                                                       {1, 1}, quant),
+              kTfLiteOk);
+  }
+  ASSERT_EQ(
+      interpreter.AddNodeWithParameters({0}, {1}, nullptr, 0, nullptr, &copy),
+      kTfLiteOk);
+
+  ASSERT_EQ(interpreter.ResizeInputTensor(0, {1, 3}), kTfLiteOk);
+  EXPECT_THAT(dims(interpreter.tensor(0)), ElementsAre(1, 4));
+  ASSERT_EQ(interpreter.AllocateTensors(), kTfLiteOk);
+  EXPECT_EQ(num_prepares, 1);
+
+  // A size in the same bucket leaves the interpreter invokable.
+  ASSERT_EQ(interpreter.ResizeInputTensor(0, {1, 2}), kTfLiteOk);
+  EXPECT_THAT(dims(interpreter.tensor(0)), ElementsAre(1, 4));
+  ASSERT_EQ(interpreter.Invoke(), kTfLiteOk);
+  EXPECT_EQ(num_prepares, 1);
+
+  ASSERT_EQ(interpreter.ResizeInputTensor(0, {1, 6}), kTfLiteOk);
+  EXPECT_THAT(dims(interpreter.tensor(0)), ElementsAre(1, 8));
+  ASSERT_EQ(interpreter.AllocateTensors(), kTfLiteOk);
+  EXPECT_EQ(num_prepares, 2);
+  EXPECT_THAT(dims(interpreter.tensor(1)), ElementsAre(1, 8));
+
+  // Sizes greater than the largest bucket are kept.
+  ASSERT_EQ(interpreter.ResizeInputTensor(0, {1, 9}), kTfLiteOk);
+  EXPECT_THAT(dims(interpreter.tensor(0)), ElementsAre(1, 9));
+}
+
 TEST_F(InterpreterTest, SubgraphNumbering) {
   EXPECT_THAT(interpreter_->subgraph(0)->GetSubgraphIndex(), 0);
   AddSubgraphs(2);
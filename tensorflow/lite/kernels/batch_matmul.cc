@@ -122,6 +122,19 @@ TfLiteStatus ResizeOutputTensor(TfLiteContext* context,
   return stat;
 }
 
+// Returns the scales of the output channels of a per-channel quantized RHS,
+// or nullptr if it's quantized per tensor.
+const TfLiteFloatArray* GetPerChannelScales(const TfLiteTensor* rhs) {
+  if (rhs->quantization.type != kTfLiteAffineQuantization) return nullptr;
+  const auto* quantization =
+      static_cast<const TfLiteAffineQuantization*>(rhs->quantization.params);
+  if (quantization == nullptr || quantization->scale == nullptr ||
+      quantization->scale->size <= 1) {
+    return nullptr;
+  }
+  return quantization->scale;
+}
+
 // Initializes temp tensors to store transposed operands.
 TfLiteStatus InitializeTemporaries(TfLiteContext* context, TfLiteNode* node,
                                    OpContext* op_context) {
@@ -351,6 +364,17 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
   TF_LITE_ENSURE(context, (lhs_data->type == kTfLiteFloat32 &&
                            rhs_data->type == kTfLiteInt8) ||
                               lhs_data->type == rhs_data->type);
+  // The hybrid kernel supports weights quantized per output channel.
+  const TfLiteFloatArray* channel_scales = GetPerChannelScales(rhs_data);
+  if (lhs_data->type == kTfLiteFloat32 && channel_scales != nullptr) {
+    const int rhs_rank = NumDimensions(rhs_data);
+    const int channel_dim = adj_y ? rhs_rank - 2 : rhs_rank - 1;
+    const auto* quantization = static_cast<const TfLiteAffineQuantization*>(
+        rhs_data->quantization.params);
+    TF_LITE_ENSURE_EQ(context, quantization->quantized_dimension, channel_dim);
+    TF_LITE_ENSURE_EQ(context, channel_scales->size,
+                      SizeOfDimension(rhs_data, channel_dim));
+  }
   // Support dimensions between 2 and 5, inclusive.
   TF_LITE_ENSURE(context, NumDimensions(lhs_data) >= 2);
   TF_LITE_ENSURE(context, NumDimensions(lhs_data) <= 5);
@@ -483,9 +507,16 @@ TfLiteStatus EvalHybrid(TfLiteContext* context, TfLiteNode* node, OpData* data,
                                     input_size, quant_data, scaling_factors_ptr,
                                     input_offset_ptr,
                                     params->asymmetric_quantize_inputs);
-  for (int b = 0; b < num_batches_to_quantize; ++b) {
-    // Incorporate scaling of the filter.
-    scaling_factors_ptr[b] *= filter->params.scale;
+  // `filter` may be a transposed copy of the RHS, which holds the per-channel
+  // scales, if any. They are applied to the output channels once the products
+  // are computed.
+  const TfLiteTensor* rhs = GetInput(context, node, kInputRHSTensor);
+  const TfLiteFloatArray* filter_channel_scales = GetPerChannelScales(rhs);
+  if (filter_channel_scales == nullptr) {
+    for (int b = 0; b < num_batches_to_quantize; ++b) {
+      // Incorporate scaling of the filter.
+      scaling_factors_ptr[b] *= filter->params.scale;
+    }
   }
 
   RuntimeShape output_shape = GetTensorShape(output);
@@ -506,6 +537,12 @@ TfLiteStatus EvalHybrid(TfLiteContext* context, TfLiteNode* node, OpData* data,
         input_offset_ptr, row_sums_ptr, GetTensorShape(output),
         GetTensorData<float>(output), &(data->compute_row_sums));
   }
+  if (filter_channel_scales != nullptr) {
+    const int num_channels = filter_channel_scales->size;
+    tensor_utils::VectorBatchVectorCwiseProduct(
+        filter_channel_scales->data, num_channels, GetTensorData<float>(output),
+        output_size / num_channels, GetTensorData<float>(output));
+  }
 
   return kTfLiteOk;
 }
@@ -463,6 +463,11 @@ class HybridBatchMatMulOpModel : public SingleOpModel {
     AllocateAndDelegate(true);
   }
 
+  void SetPerChannelWeights(const std::vector<float>& data) {
+    PerChannelSymmetricQuantizeAndPopulate(rhs_id_, data);
+    AllocateAndDelegate(true);
+  }
+
   void SetInput(const std::vector<float>& f) { PopulateTensor(lhs_id_, f); }
   std::vector<float> GetOutput() { return ExtractVector<float>(output_id_); }
   std::vector<int> GetOutputShape() { return GetTensorShape(output_id_); }
@@ -746,6 +751,49 @@ TEST_P(HybridAsymmetricBatchMatMulOpTest, QuantizedInt8BroadcastWeights) {
   EXPECT_THAT(m.GetOutputShape(), ElementsAreArray({2, 2, 3}));
 }
 
+TEST_P(HybridAsymmetricBatchMatMulOpTest, QuantizedInt8PerChannelWeights) {
+  // The second output channel has a range 10 times bigger than the others.
+  HybridBatchMatMulOpModel m(
+      /*units=*/3, /*batches=*/2,
+      /*lhs=*/{TensorType_FLOAT32, {2, 2, 10}},
+      /*rhs=*/
+      {TensorType_INT8, {10, 3}, 0, 0, 0, 0, /*per_channel_quantization=*/true,
+       /*per_channel_quantization_scales=*/{10.0 / 127.0, 1.0, 10.0 / 127.0},
+       /*per_channel_quantization_offsets=*/{0, 0, 0}, /*channel_index=*/1});
+
+  m.SetPerChannelWeights({
+      1,  10,  -1,   //
+      2,  20,  -2,   //
+      3,  30,  -3,   //
+      4,  40,  -4,   //
+      5,  50,  -5,   //
+      6,  60,  -6,   //
+      7,  70,  -7,   //
+      8,  80,  -8,   //
+      9,  90,  -9,   //
+      10, 100, -10,
+  });
+
+  m.SetInput({
+      1,  2,  3,  4,  5,  6,  7,  8,   -9,  -10,  // batch 0, 0
+      1,  2,  3,  4,  5,  6,  7,  -8,  9,   -10,  // batch 0, 1
+      11, 12, 13, 14, 15, 16, 17, 18,  -19, -20,  // batch 1, 0
+      11, 12, 13, 14, 15, 16, 17, -18, 19,  -20,  // batch 1, 1
+  });
+
+  ASSERT_EQ(m.Invoke(), kTfLiteOk);
+
+  EXPECT_THAT(m.GetOutput(), ElementsAreArray(ArrayFloatNear(
+                                 {
+                                     23, 230, -23,     //
+                                     57, 570, -57,     //
+                                     193, 1930, -193,  //
+                                     247, 2470, -247,  //
+                                 },
+                                 /*max_abs_error=*/10.f)));
+  EXPECT_THAT(m.GetOutputShape(), ElementsAreArray({2, 2, 3}));
+}
+
 TEST_P(HybridAsymmetricBatchMatMulOpTest, QuantizedInt8BroadcastBigWeights) {
   HybridBatchMatMulOpModel m(
       /*units=*/9, /*batches=*/2,
@@ -18,6 +18,7 @@ limitations under the License.
 
 #include <cstdint>
 #include <memory>
+#include <string>
 #include <vector>
 
 // Only use multi-threaded Eigen if ruy is disabled.
@@ -27,6 +28,8 @@ limitations under the License.
 
 #include "tensorflow/lite/core/c/builtin_op_data.h"
 #include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/core/subgraph.h"
+#include "tensorflow/lite/interpreter_options.h"
 #include "tensorflow/lite/kernels/cpu_backend_context.h"
 #if defined(TFLITE_WITH_MULTITHREADED_EIGEN)
 #include "tensorflow/lite/kernels/eigen_support.h"
@@ -44,8 +47,10 @@ limitations under the License.
 #include "tensorflow/lite/kernels/internal/tensor.h"
 #include "tensorflow/lite/kernels/internal/tensor_ctypes.h"
 #include "tensorflow/lite/kernels/internal/tensor_utils.h"
+#include "tensorflow/lite/kernels/kernel_autotune_cache.h"
 #include "tensorflow/lite/kernels/kernel_util.h"
 #include "tensorflow/lite/kernels/padding.h"
+#include "tensorflow/lite/profiling/time.h"
 #include "tensorflow/lite/util.h"
 
 namespace tflite {
@@ -69,6 +74,13 @@ enum KernelType {
 
 const int kTensorNotAllocated = -1;
 
+// The float implementations of kMultithreadOptimized chosen by autotuning.
+enum FloatConvVariant {
+  kIm2colGemmVariant = 0,
+  kEigenVariant = 1,
+  kNumFloatConvVariants,
+};
+
 static constexpr size_t kMaxIm2colBufferSizeMobile = 1024 * 1024 * 1024;  // 1GB
 
 struct OpData {
@@ -123,6 +135,11 @@ struct OpData {
   int32_t groups = 1;
 
   TfLiteType quantized_bias_type = kTfLiteNoType;
+
+  // Set while the float implementations are timed, see SetUpAutotuning.
+  std::unique_ptr<KernelVariantTuner> autotuner;
+  std::shared_ptr<KernelAutotuneCache> autotune_cache;
+  std::string autotune_key;
 };
 
 inline PaddingType RuntimePaddingType(TfLitePadding padding) {
@@ -207,7 +224,9 @@ bool IsIm2ColRequired(const TfLiteTensor* input, TfLiteConvParams* params,
       if (input->type == kTfLiteUInt8 ||  //
           input->type == kTfLiteInt8 ||   //
           input->type == kTfLiteInt16 ||  // quantized.
-          !data->supports_multithreaded_kernel) {
+          !data->supports_multithreaded_kernel ||
+          // Both float implementations are run while autotuning.
+          data->autotuner != nullptr) {
         return true;
       } else {
         return false;
@@ -326,6 +345,64 @@ static TfLiteStatus AllocateTemporaryTensorsIfRequired(
   return kTfLiteOk;
 }
 
+// Returns the key of the float implementation of a convolution in the kernel
+// autotune cache.
+std::string AutotuneKey(const TfLiteContext* context,
+                        const TfLiteConvParams* params,
+                        const TfLiteTensor* input, const TfLiteTensor* filter) {
+  std::string key = "CONV_2D";
+  for (const TfLiteIntArray* dims : {input->dims, filter->dims}) {
+    key += ':';
+    for (int i = 0; i < dims->size; ++i) {
+      if (i > 0) key += 'x';
+      key += std::to_string(dims->data[i]);
+    }
+  }
+  key += ":s" + std::to_string(params->stride_height) + "x" +
+         std::to_string(params->stride_width);
+  key += params->padding == kTfLitePaddingSame ? ":same" : ":valid";
+  key += ":t" + std::to_string(context->recommended_num_threads);
+  return key;
+}
+
+// When the interpreter has a kernel autotune cache, makes a float convolution
+// supporting both the Eigen and the im2col + GEMM implementations use the one
+// recorded in the cache. If there is none, both are timed during the first
+// evaluations, which need the temporaries of both, and the fastest one is
+// recorded.
+void SetUpAutotuning(TfLiteContext* context, const TfLiteConvParams* params,
+                     const TfLiteTensor* input, const TfLiteTensor* filter,
+                     OpData* data) {
+  data->autotuner.reset();
+  if (!data->supports_multithreaded_kernel || input->type != kTfLiteFloat32 ||
+      data->groups != 1 || context->impl_ == nullptr) {
+    return;
+  }
+  const InterpreterOptions* options =
+      reinterpret_cast<Subgraph*>(context->impl_)->GetOptions();
+  if (options == nullptr || !options->GetKernelAutotuneCache()) return;
+  data->autotune_cache = options->GetKernelAutotuneCache();
+  data->autotune_key = AutotuneKey(context, params, input, filter);
+  const int variant = data->autotune_cache->Lookup(data->autotune_key);
+  if (variant == kIm2colGemmVariant) {
+    data->supports_multithreaded_kernel = false;
+  } else if (variant != kEigenVariant) {
+    data->autotuner =
+        std::make_unique<KernelVariantTuner>(kNumFloatConvVariants);
+  }
+}
+
+// Records the time of an evaluation while autotuning, and the fastest
+// implementation once all of them have been timed.
+void RecordAutotuningRun(OpData* data, uint64_t micros) {
+  data->autotuner->RecordRun(micros);
+  if (!data->autotuner->done()) return;
+  const int variant = data->autotuner->BestVariant();
+  data->autotune_cache->Record(data->autotune_key, variant);
+  data->supports_multithreaded_kernel = variant == kEigenVariant;
+  data->autotuner.reset();
+}
+
 TfLiteStatus Prepare(KernelType kernel_type, TfLiteContext* context,
                      TfLiteNode* node) {
   auto* params = reinterpret_cast<TfLiteConvParams*>(node->builtin_data);
@@ -442,6 +519,7 @@ TfLiteStatus Prepare(KernelType kernel_type, TfLiteContext* context,
       (params->dilation_width_factor == 1) &&
       (params->dilation_height_factor == 1) &&
       (filter->allocation_type != kTfLiteArenaRw) && !IsDynamicTensor(filter);
+  SetUpAutotuning(context, params, input, filter, data);
 
   int channels_in = filter->dims->data[3];
   int channels_out = filter->dims->data[0];
@@ -469,6 +547,8 @@ TfLiteStatus Prepare(KernelType kernel_type, TfLiteContext* context,
   TF_LITE_ENSURE_STATUS(AllocateTemporaryTensorsIfRequired(
       context, node, is_hybrid, data->is_hybrid_per_channel, kernel_type,
       im2col_bytes));
+  // Without im2col, only the Eigen implementation is supported.
+  if (data->im2col_oversized) data->autotuner.reset();
 
   TF_LITE_ENSURE(context, has_bias);
 
@@ -696,6 +776,15 @@ void EvalQuantized(TfLiteContext* context, TfLiteNode* node,
     effective_kernel_type = kReference;
   }
 
+  const bool autotuning = data->autotuner != nullptr;
+  uint64_t start_micros = 0;
+  if (autotuning) {
+    effective_kernel_type =
+        data->autotuner->NextVariant() == kEigenVariant ? kMultithreadOptimized
+                                                        : kGenericOptimized;
+    start_micros = profiling::time::NowMicros();
+  }
+
   ConvParams op_params;
   op_params.padding_type = PaddingType::kSame;
   op_params.padding_values.width = data->padding.width;
@@ -983,13 +1072,15 @@ void EvalFloat(TfLiteContext* context, TfLiteNode* node,
       } else {
         filter_data = GetTensorData<float>(filter);
       }
+      // The im2col tensor is only allocated for the other implementation
+      // while autotuning.
       multithreaded_ops::Conv(
           *eigen_support::GetThreadPoolDevice(context), op_params,
           GetTensorShape(input), GetTensorData<float>(input),
           GetTensorShape(filter), filter_data, GetTensorShape(bias),
           GetTensorData<float>(bias), GetTensorShape(output),
           GetTensorData<float>(output), GetTensorShape(im2col),
-          GetTensorData<float>(im2col));
+          autotuning ? nullptr : GetTensorData<float>(im2col));
       break;
 #else   // !defined(TFLITE_WITH_MULTITHREADED_EIGEN)
       // See Register_CONV_2D: we should never be here when TFLITE_WITH_RUY
@@ -999,6 +1090,9 @@ void EvalFloat(TfLiteContext* context, TfLiteNode* node,
 #endif  // defined(TFLITE_WITH_MULTITHREADED_EIGEN)
     }
   }
+  if (autotuning) {
+    RecordAutotuningRun(data, profiling::time::NowMicros() - start_micros);
+  }
 }
 
 template <KernelType kernel_type>
@@ -25,6 +25,8 @@ limitations under the License.
 #include <gtest/gtest.h>
 #include "absl/memory/memory.h"
 #include "tensorflow/lite/core/interpreter.h"
+#include "tensorflow/lite/interpreter_options.h"
+#include "tensorflow/lite/kernels/kernel_autotune_cache.h"
 #include "tensorflow/lite/kernels/test_util.h"
 #include "tensorflow/lite/schema/schema_generated.h"
 #include "tensorflow/lite/string_type.h"
@@ -2214,6 +2216,96 @@ TEST_P(QuantizedConvolutionOpTest, SimpleTestExplicitQuantizedOp) {
                              }));
 }
 
+#ifndef TFLITE_WITH_RUY
+// The convolution of SimpleTestFloat32 on an interpreter autotuning its
+// kernels.
+class AutotunedConvolutionOpModel : public SingleOpModel {
+ public:
+  explicit AutotunedConvolutionOpModel(
+      std::shared_ptr<KernelAutotuneCache> cache) {
+    input_ = AddInput({TensorType_FLOAT32, {2, 2, 4, 1}});
+    // The multithreaded kernel requires a constant filter.
+    filter_ = AddConstInput<float>({TensorType_FLOAT32, {3, 2, 2, 1}},
+                                   {
+                                       1, 2, 3, 4,    // first 2x2 filter
+                                       -1, 1, -1, 1,  // second 2x2 filter
+                                       -1, -1, 1, 1,  // third 2x2 filter
+                                   });
+    bias_ = AddInput({TensorType_FLOAT32, {3}});
+    output_ = AddOutput({TensorType_FLOAT32, {}});
+    SetBuiltinOp(BuiltinOperator_CONV_2D, BuiltinOptions_Conv2DOptions,
+                 CreateConv2DOptions(builder_, Padding_VALID, 2, 2,
+                                     ActivationFunctionType_NONE)
+                     .Union());
+    resolver_ = std::make_unique<SingleOpResolver>(
+        BuiltinOperator_CONV_2D,
+        ops::builtin::Register_CONVOLUTION_MULTITHREADED_OPT());
+    BuildInterpreter({GetShape(input_), GetShape(filter_), GetShape(bias_)},
+                     /*num_threads=*/2, /*allow_fp32_relax_to_fp16=*/false,
+                     /*apply_delegate=*/false,
+                     /*allocate_and_delegate=*/false);
+    InterpreterOptions options;
+    options.SetKernelAutotuneCache(std::move(cache));
+    interpreter_->ApplyOptions(&options);
+    AllocateAndDelegate(/*apply_delegate=*/false);
+  }
+
+  std::vector<float> Run() {
+    PopulateTensor<float>(input_, {
+                                      // First batch
+                                      1, 1, 1, 1,  // row = 1
+                                      2, 2, 2, 2,  // row = 2
+                                      // Second batch
+                                      1, 2, 3, 4,  // row = 1
+                                      1, 2, 3, 4,  // row = 2
+                                  });
+    PopulateTensor<float>(bias_, {1, 2, 3});
+    EXPECT_EQ(Invoke(), kTfLiteOk);
+    return ExtractVector<float>(output_);
+  }
+
+ protected:
+  int input_;
+  int filter_;
+  int bias_;
+  int output_;
+};
+
+constexpr char kAutotuneKey[] = "CONV_2D:2x2x4x1:3x2x2x1:s2x2:valid:t2";
+const std::vector<float>* const kAutotunedConvOutput =
+    new std::vector<float>({
+        18, 2, 5,  // first batch, left
+        18, 2, 5,  // first batch, right
+        17, 4, 3,  // second batch, left
+        37, 4, 3,  // second batch, right
+    });
+
+TEST(ConvolutionOpAutotuneTest, RecordsTheFastestFloatVariant) {
+  auto cache = std::make_shared<KernelAutotuneCache>();
+  AutotunedConvolutionOpModel m(cache);
+  // Both variants run twice.
+  for (int run = 0; run < 4; ++run) {
+    EXPECT_EQ(cache->size(), 0);
+    EXPECT_THAT(m.Run(), ElementsAreArray(*kAutotunedConvOutput));
+  }
+  EXPECT_EQ(cache->size(), 1);
+  const int variant = cache->Lookup(kAutotuneKey);
+  EXPECT_TRUE(variant == 0 || variant == 1);
+  EXPECT_THAT(m.Run(), ElementsAreArray(*kAutotunedConvOutput));
+}
+
+TEST(ConvolutionOpAutotuneTest, UsesTheCachedFloatVariant) {
+  for (int variant : {0, 1}) {
+    auto cache = std::make_shared<KernelAutotuneCache>();
+    cache->Record(kAutotuneKey, variant);
+    AutotunedConvolutionOpModel m(cache);
+    EXPECT_THAT(m.Run(), ElementsAreArray(*kAutotunedConvOutput));
+    EXPECT_EQ(cache->size(), 1);
+    EXPECT_EQ(cache->Lookup(kAutotuneKey), variant);
+  }
+}
+#endif  // TFLITE_WITH_RUY
+
 INSTANTIATE_TEST_SUITE_P(
     ConvolutionOpTest, ConvolutionOpTest,
     ::testing::ValuesIn(SingleOpTest::GetKernelTags(*kKernelMap)));
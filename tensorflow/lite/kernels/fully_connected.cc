@@ -19,8 +19,10 @@ limitations under the License.
 #include <cstddef>
 #include <cstdint>
 #include <memory>
+#include <utility>
 #include <vector>
 
+#include "tensorflow/lite/array.h"
 #include "tensorflow/lite/core/c/builtin_op_data.h"
 #include "tensorflow/lite/core/c/c_api_types.h"
 #include "tensorflow/lite/core/c/common.h"
@@ -140,6 +142,19 @@ enum KernelType {
   kLegacyPie,  // Legacy path used by the PIE team and related clients.
 };
 
+// Block-sparse copy of a dense constant filter, in the format the converter
+// emits for 1 x `block_size` blocks: the rows are dense, and each row lists
+// the column indices of its non-zero blocks.
+struct BlockSparseFilter {
+  TfLiteSparsity sparsity;
+  TfLiteDimensionMetadata dim_metadata[kDimMetadataSizeBlockSparse];
+  IntArrayUniquePtr segments;
+  IntArrayUniquePtr indices;
+  // The non-zero blocks, row by row.
+  std::vector<float> float_values;
+  std::vector<int8_t> int8_values;
+};
+
 struct OpData {
   // The scaling factor from input to output (aka the 'real multiplier') can
   // be represented as a fixed point multiplier plus a left shift.
@@ -160,6 +175,10 @@ struct OpData {
   // Used for 4bit hybrid
   std::unique_ptr<optimized_4bit::OpData4Bit> op_data_4bit = nullptr;
   TfLiteType quantized_bias_type = kTfLiteNoType;
+  // Set by the optimized kernel when a dense constant filter is sparse enough
+  // to run the block-sparse kernels.
+  std::unique_ptr<BlockSparseFilter> block_sparse_filter;
+  bool filter_sparsity_analyzed = false;
 };
 
 constexpr int kInputTensor = 0;
@@ -353,6 +372,97 @@ TfLiteStatus PrepareImpl4Bit(TfLiteContext* context, TfLiteNode* node,
                           cols);
 }
 
+// Minimum fraction of zero blocks for which the block-sparse kernels are used
+// on a dense filter. Below it, the dense kernels are usually faster.
+constexpr float kMinBlockSparseFilterSparsity = 0.7f;
+
+// Builds in `sparse` and `values` the block-sparse encoding of a dense `rows`
+// x `cols` filter with 1 x `block_size` blocks. Returns false if the filter has
+// too few zero blocks.
+template <typename T>
+bool BuildBlockSparseFilter(const T* filter_data, int rows, int cols,
+                            int block_size, BlockSparseFilter* sparse,
+                            std::vector<T>* values) {
+  const int blocks_per_row = cols / block_size;
+  const int num_blocks = rows * blocks_per_row;
+  auto is_zero_block = [&](int block) {
+    const T* begin = filter_data + block * block_size;
+    return std::all_of(begin, begin + block_size,
+                       [](T value) { return value == 0; });
+  };
+  int num_zero_blocks = 0;
+  for (int block = 0; block < num_blocks; ++block) {
+    num_zero_blocks += is_zero_block(block);
+  }
+  if (num_zero_blocks < kMinBlockSparseFilterSparsity * num_blocks) {
+    return false;
+  }
+
+  sparse->segments = BuildTfLiteArray<int>(rows + 1);
+  sparse->indices = BuildTfLiteArray<int>(num_blocks - num_zero_blocks);
+  values->reserve((num_blocks - num_zero_blocks) * block_size);
+  int num_non_zero_blocks = 0;
+  sparse->segments->data[0] = 0;
+  for (int row = 0; row < rows; ++row) {
+    for (int col = 0; col < blocks_per_row; ++col) {
+      const int block = row * blocks_per_row + col;
+      if (is_zero_block(block)) continue;
+      sparse->indices->data[num_non_zero_blocks++] = col;
+      const T* begin = filter_data + block * block_size;
+      values->insert(values->end(), begin, begin + block_size);
+    }
+    sparse->segments->data[row + 1] = num_non_zero_blocks;
+  }
+
+  sparse->dim_metadata[0] = {kTfLiteDimDense, rows, nullptr, nullptr};
+  sparse->dim_metadata[1] = {kTfLiteDimSparseCSR, blocks_per_row,
+                             sparse->segments.get(), sparse->indices.get()};
+  sparse->dim_metadata[2] = {kTfLiteDimDense, block_size, nullptr, nullptr};
+  sparse->sparsity.traversal_order = nullptr;
+  sparse->sparsity.block_map = nullptr;
+  sparse->sparsity.dim_metadata = sparse->dim_metadata;
+  sparse->sparsity.dim_metadata_size = kDimMetadataSizeBlockSparse;
+  return true;
+}
+
+// Converts a dense constant filter to the block-sparse format when the
+// optimized kernels support it: 1x4 blocks for float32, and 1x16 blocks for
+// int8 with symmetric filter quantization. The filter is only read once, as
+// its values never change.
+void AnalyzeFilterSparsity(const TfLiteTensor* input,
+                           const TfLiteTensor* filter,
+                           const TfLiteTensor* output, OpData* data) {
+  if (data->filter_sparsity_analyzed) return;
+  data->filter_sparsity_analyzed = true;
+  if (filter->sparsity != nullptr || !IsConstantTensor(filter) ||
+      filter->data.raw == nullptr) {
+    return;
+  }
+  const int rows = filter->dims->data[0];
+  const int cols = filter->dims->data[1];
+  auto sparse = std::make_unique<BlockSparseFilter>();
+  bool use_block_sparse = false;
+  if (input->type == kTfLiteFloat32 && filter->type == kTfLiteFloat32 &&
+      output->type == kTfLiteFloat32 && cols % 4 == 0) {
+    use_block_sparse = BuildBlockSparseFilter(
+        GetTensorData<float>(filter), rows, cols, /*block_size=*/4,
+        sparse.get(), &sparse->float_values);
+  } else if (input->type == kTfLiteInt8 && filter->type == kTfLiteInt8 &&
+             output->type == kTfLiteInt8 && filter->params.zero_point == 0 &&
+             cols % 16 == 0) {
+    use_block_sparse = BuildBlockSparseFilter(
+        GetTensorData<int8_t>(filter), rows, cols, /*block_size=*/16,
+        sparse.get(), &sparse->int8_values);
+  }
+  if (use_block_sparse) {
+    TFLITE_LOG(tflite::TFLITE_LOG_VERBOSE,
+               "Using block-sparse kernels for a %dx%d fully-connected "
+               "filter with %d non-zero blocks.",
+               rows, cols, sparse->indices->size);
+    data->block_sparse_filter = std::move(sparse);
+  }
+}
+
 TfLiteStatus PrepareImpl(TfLiteContext* context, TfLiteNode* node,
                          KernelType kernel_type) {
   auto* params =
@@ -629,6 +739,11 @@ TfLiteStatus PrepareImpl(TfLiteContext* context, TfLiteNode* node,
     }
   }
 
+  if (kernel_type == kGenericOptimized && !is_hybrid &&
+      params->weights_format == kTfLiteFullyConnectedWeightsFormatDefault) {
+    AnalyzeFilterSparsity(input, filter, output, data);
+  }
+
   // Resize output.
   return UpdateOutputSize(context, params, input, output, batch_size, num_units,
                           filter->dims->data[1]);
@@ -1415,6 +1530,18 @@ TfLiteStatus EvalQuantized(TfLiteContext* context, TfLiteNode* node,
                 context, "Unsupported sparse fully-connected weight format.");
             return kTfLiteError;
           }
+        } else if (data->block_sparse_filter) {
+          const BlockSparseFilter& sparse = *data->block_sparse_filter;
+          optimized_ops::FullyConnectedSparseWeight1x16(
+              sparse.sparsity, op_params, GetTensorShape(input),
+              GetTensorData<int8_t>(input), GetTensorShape(filter),
+              sparse.int8_values.data(),
+              is_per_channel ? data->per_channel_output_multiplier.data()
+                             : nullptr,
+              is_per_channel ? data->per_channel_output_shift.data() : nullptr,
+              GetTensorShape(bias), GetTensorData<int32_t>(bias),
+              GetTensorShape(output), GetTensorData<int8_t>(output),
+              CpuBackendContext::GetFromContext(context));
         } else {
           is_per_channel ? FullyConnectedPerChannelInt8<kernel_type>(
                                data, input, filter, bias, output,
@@ -1608,6 +1735,15 @@ TfLiteStatus EvalFloat(TfLiteContext* context, TfLiteNode* node,
         return kTfLiteError;
       }
 
+    } else if (data->block_sparse_filter) {
+      const BlockSparseFilter& sparse = *data->block_sparse_filter;
+      optimized_ops::FullyConnectedSparseWeight1x4(
+          sparse.sparsity, op_params, GetTensorShape(input),
+          GetTensorData<float>(input), GetTensorShape(filter),
+          sparse.float_values.data(), GetTensorShape(bias),
+          GetTensorData<float>(bias), GetTensorShape(output),
+          GetTensorData<float>(output),
+          CpuBackendContext::GetFromContext(context));
     } else {
       op_params.lhs_cacheable = IsConstantTensor(filter);
       op_params.rhs_cacheable = IsConstantTensor(input);
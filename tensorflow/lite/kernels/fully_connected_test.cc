@@ -2470,5 +2470,102 @@ INSTANTIATE_TEST_SUITE_P(
     SparseQuantizedFullyConnectedOpTest, SparseQuantizedFullyConnectedOpTest,
     ::testing::ValuesIn(SingleOpTest::GetKernelTags(*kKernelMapNoPie)));
 
+// Dense weights in a constant tensor, which the optimized kernel converts to
+// the block-sparse format when enough of their blocks are zero.
+template <typename T, typename BiasType>
+class ConstWeightsFullyConnectedOpModel : public SingleOpModel {
+ public:
+  ConstWeightsFullyConnectedOpModel(TfLiteRegistration* registration,
+                                    const TensorData& input,
+                                    const TensorData& weights,
+                                    const std::vector<T>& weights_data,
+                                    const TensorData& bias,
+                                    const TensorData& output) {
+    input_ = AddInput(input);
+    weights_ = AddConstInput(weights, weights_data.data(), weights_data.size());
+    bias_ = AddInput(bias);
+    output_ = AddOutput(output);
+    SetBuiltinOp(
+        BuiltinOperator_FULLY_CONNECTED, BuiltinOptions_FullyConnectedOptions,
+        CreateFullyConnectedOptions(builder_, ActivationFunctionType_RELU)
+            .Union());
+    resolver_ = std::make_unique<SingleOpResolver>(
+        BuiltinOperator_FULLY_CONNECTED, registration);
+    BuildInterpreter({GetShape(input_), GetShape(weights_), GetShape(bias_)});
+  }
+  void SetBias(const std::vector<BiasType>& data) {
+    PopulateTensor(bias_, data);
+  }
+  void SetInput(const std::vector<T>& data) { PopulateTensor(input_, data); }
+  std::vector<T> GetOutput() { return ExtractVector<T>(output_); }
+  std::vector<int> GetOutputShape() { return GetTensorShape(output_); }
+
+ protected:
+  int input_;
+  int weights_;
+  int bias_;
+  int output_;
+};
+
+class BlockSparseDenseWeightsFullyConnectedOpTest : public SingleOpTest {
+ protected:
+  const std::map<string, TfLiteRegistration*>& GetKernelMap() override {
+    return *kKernelMapNoPie;
+  }
+};
+
+TEST_P(BlockSparseDenseWeightsFullyConnectedOpTest, Float1x4Blocks) {
+  // 7 of the 9 blocks are zero.
+  ConstWeightsFullyConnectedOpModel<float, float> m(
+      GetRegistration(), /*input=*/{TensorType_FLOAT32, {2, 12}},
+      /*weights=*/{TensorType_FLOAT32, {3, 12}},
+      {
+          1, 2, 3, 4, 0, 0, 0, 0, 0, 0, 0, 0,  // u = 0
+          0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,  // u = 1
+          0, 0, 0, 0, 0, 0, 0, 0, 1, 2, 3, 4,  // u = 2
+      },
+      /*bias=*/{TensorType_FLOAT32, {3}}, /*output=*/{TensorType_FLOAT32});
+  m.SetBias({1, 2, 3});
+  m.SetInput({
+      1, 2, 3, 4, 5, 6, 7, 8,  -9, -10, 11,  12,  // b = 0
+      1, 2, 3, 4, 5, 6, 7, -8, 9,  -10, -11, 12,  // b = 1
+  });
+
+  ASSERT_EQ(m.Invoke(), kTfLiteOk);
+
+  EXPECT_THAT(m.GetOutputShape(), ElementsAre(2, 3));
+  EXPECT_THAT(m.GetOutput(), ElementsAre(31, 2, 55, 31, 2, 7));
+}
+
+TEST_P(BlockSparseDenseWeightsFullyConnectedOpTest, Int81x16Blocks) {
+  // 3 of the 4 blocks are zero.
+  std::vector<int8_t> weights_data(2 * 32, 0);
+  const std::vector<int8_t> block = {1, 2, 3,  4,  -1, -2, -3, -4,
+                                     1, 2, 3,  4,  -4, -3, -2, -1};
+  std::copy(block.begin(), block.end(), weights_data.begin());
+  ConstWeightsFullyConnectedOpModel<int8_t, int32_t> m(
+      GetRegistration(), /*input=*/{TensorType_INT8, {2, 32}, 0, 0, 1},
+      /*weights=*/{TensorType_INT8, {2, 32}, 0, 0, 1}, weights_data,
+      /*bias=*/{TensorType_INT32, {2}, 0, 0, 1},
+      /*output=*/{TensorType_INT8, {}, 0, 0, 1});
+  m.SetBias({1, 2});
+  std::vector<int8_t> input(2 * 32, 1);
+  for (int i = 0; i < 16; ++i) {
+    input[i] = i % 4 + 1;        // b = 0
+    input[32 + i] = 4 - i % 4;  // b = 1
+  }
+  m.SetInput(input);
+
+  ASSERT_EQ(m.Invoke(), kTfLiteOk);
+
+  EXPECT_THAT(m.GetOutputShape(), ElementsAre(2, 2));
+  EXPECT_THAT(m.GetOutput(), ElementsAre(11, 2, 0, 2));
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    BlockSparseDenseWeightsFullyConnectedOpTest,
+    BlockSparseDenseWeightsFullyConnectedOpTest,
+    ::testing::ValuesIn(SingleOpTest::GetKernelTags(*kKernelMapNoPie)));
+
 }  // namespace
 }  // namespace tflite
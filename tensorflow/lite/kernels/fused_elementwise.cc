@@ -0,0 +1,286 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include <stddef.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "Eigen/Core"  // from @eigen_archive
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/kernels/cpu_backend_context.h"
+#include "tensorflow/lite/kernels/cpu_backend_threadpool.h"
+#include "tensorflow/lite/kernels/fused_elementwise_program.h"
+#include "tensorflow/lite/kernels/internal/tensor_ctypes.h"
+#include "tensorflow/lite/kernels/kernel_util.h"
+
+namespace tflite {
+namespace ops {
+namespace custom {
+namespace fused_elementwise {
+
+// The number of elements evaluated at a time: the intermediate values of a
+// tile stay in the L1 cache instead of being written to full tensors.
+constexpr int kTileSize = 512;
+// The minimum number of elements evaluated by a thread.
+constexpr int kMinElementsPerThread = 32 * 1024;
+
+struct OpData {
+  std::vector<uint8_t> options;
+  Program program;
+};
+
+using ConstArrayMap = Eigen::Map<const Eigen::ArrayXf>;
+using ArrayMap = Eigen::Map<Eigen::ArrayXf>;
+
+void EvalInstruction(OpCode op, const float* lhs, const float* rhs, int size,
+                     float* result) {
+  const ConstArrayMap a(lhs, size);
+  ArrayMap out(result, size);
+  switch (op) {
+    case OpCode::kAdd:
+      out = a + ConstArrayMap(rhs, size);
+      break;
+    case OpCode::kSub:
+      out = a - ConstArrayMap(rhs, size);
+      break;
+    case OpCode::kMul:
+      out = a * ConstArrayMap(rhs, size);
+      break;
+    case OpCode::kDiv:
+      out = a / ConstArrayMap(rhs, size);
+      break;
+    case OpCode::kMaximum:
+      out = a.max(ConstArrayMap(rhs, size));
+      break;
+    case OpCode::kMinimum:
+      out = a.min(ConstArrayMap(rhs, size));
+      break;
+    case OpCode::kSquaredDifference:
+      out = (a - ConstArrayMap(rhs, size)).square();
+      break;
+    case OpCode::kAbs:
+      out = a.abs();
+      break;
+    case OpCode::kExp:
+      out = a.exp();
+      break;
+    case OpCode::kLogistic:
+      out = a.logistic();
+      break;
+    case OpCode::kNeg:
+      out = -a;
+      break;
+    case OpCode::kRelu:
+      out = a.max(0.0f);
+      break;
+    case OpCode::kRelu6:
+      out = a.max(0.0f).min(6.0f);
+      break;
+    case OpCode::kReluN1To1:
+      out = a.max(-1.0f).min(1.0f);
+      break;
+    case OpCode::kRsqrt:
+      out = a.rsqrt();
+      break;
+    case OpCode::kSqrt:
+      out = a.sqrt();
+      break;
+    case OpCode::kSquare:
+      out = a.square();
+      break;
+    case OpCode::kTanh:
+      out = a.tanh();
+      break;
+  }
+}
+
+// Evaluates `program` on the elements [begin, end) of the output, one tile at
+// a time. An input is either a full tensor or a scalar broadcast to the
+// output.
+void EvalProgram(const Program& program, const float* const* inputs,
+                 const bool* is_scalar_input, int64_t begin, int64_t end,
+                 float* output) {
+  // The scalar values are broadcast once to a tile, then each instruction
+  // but the last has a tile for its result.
+  const int num_values = program.num_values();
+  std::vector<float> scratch(num_values * kTileSize);
+  std::vector<float*> tiles(num_values, nullptr);
+  for (int i = 0; i < num_values; ++i) {
+    tiles[i] = scratch.data() + i * kTileSize;
+  }
+  for (int i = 0; i < program.num_inputs; ++i) {
+    if (is_scalar_input[i]) {
+      std::fill_n(tiles[i], kTileSize, inputs[i][0]);
+    }
+  }
+  for (int i = 0; i < program.constants.size(); ++i) {
+    std::fill_n(tiles[program.num_inputs + i], kTileSize,
+                program.constants[i]);
+  }
+
+  std::vector<const float*> values(num_values, nullptr);
+  for (int i = 0; i < program.num_inputs + program.constants.size(); ++i) {
+    values[i] = tiles[i];
+  }
+  const int num_instructions = program.instructions.size();
+  for (int64_t tile_begin = begin; tile_begin < end; tile_begin += kTileSize) {
+    const int size = std::min<int64_t>(kTileSize, end - tile_begin);
+    for (int i = 0; i < program.num_inputs; ++i) {
+      if (!is_scalar_input[i]) values[i] = inputs[i] + tile_begin;
+    }
+    for (int i = 0; i < num_instructions; ++i) {
+      const Instruction& instruction = program.instructions[i];
+      const int value = program.instruction_value(i);
+      float* result = i == num_instructions - 1 ? output + tile_begin
+                                                : tiles[value];
+      EvalInstruction(instruction.op, values[instruction.lhs],
+                      instruction.rhs >= 0 ? values[instruction.rhs] : nullptr,
+                      size, result);
+      values[value] = result;
+    }
+  }
+}
+
+struct EvalProgramTask : cpu_backend_threadpool::Task {
+  EvalProgramTask(const Program* program, const float* const* inputs,
+                  const bool* is_scalar_input, int64_t begin, int64_t end,
+                  float* output)
+      : program(program),
+        inputs(inputs),
+        is_scalar_input(is_scalar_input),
+        begin(begin),
+        end(end),
+        output(output) {}
+  void Run() override {
+    EvalProgram(*program, inputs, is_scalar_input, begin, end, output);
+  }
+
+ private:
+  const Program* program;
+  const float* const* inputs;
+  const bool* is_scalar_input;
+  int64_t begin;
+  int64_t end;
+  float* output;
+};
+
+void* Init(TfLiteContext* context, const char* buffer, size_t length) {
+  auto* op_data = new OpData();
+  const uint8_t* buffer_t = reinterpret_cast<const uint8_t*>(buffer);
+  if (buffer_t != nullptr) {
+    op_data->options.assign(buffer_t, buffer_t + length);
+  }
+  return op_data;
+}
+
+void Free(TfLiteContext* context, void* buffer) {
+  delete reinterpret_cast<OpData*>(buffer);
+}
+
+TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
+  OpData* op_data = reinterpret_cast<OpData*>(node->user_data);
+  TF_LITE_ENSURE_EQ(context, NumOutputs(node), 1);
+  TF_LITE_ENSURE(context, NumInputs(node) >= 1);
+  if (!ParseProgram(op_data->options.data(), op_data->options.size(),
+                    NumInputs(node), &op_data->program)) {
+    TF_LITE_KERNEL_LOG(context, "Invalid %s program.", kFusedElementwise);
+    return kTfLiteError;
+  }
+
+  // The non-scalar inputs all have the shape of the output.
+  const TfLiteTensor* shape_input = nullptr;
+  for (int i = 0; i < NumInputs(node); ++i) {
+    const TfLiteTensor* input;
+    TF_LITE_ENSURE_OK(context, GetInputSafe(context, node, i, &input));
+    TF_LITE_ENSURE_TYPES_EQ(context, input->type, kTfLiteFloat32);
+    if (NumElements(input) == 1) continue;
+    if (shape_input == nullptr) {
+      shape_input = input;
+    } else {
+      TF_LITE_ENSURE(context, HaveSameShapes(input, shape_input));
+    }
+  }
+  if (shape_input == nullptr) {
+    TF_LITE_ENSURE_OK(context, GetInputSafe(context, node, 0, &shape_input));
+  }
+  TfLiteTensor* output;
+  TF_LITE_ENSURE_OK(context, GetOutputSafe(context, node, 0, &output));
+  TF_LITE_ENSURE_TYPES_EQ(context, output->type, kTfLiteFloat32);
+  return context->ResizeTensor(context, output,
+                               TfLiteIntArrayCopy(shape_input->dims));
+}
+
+TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
+  const OpData* op_data = reinterpret_cast<OpData*>(node->user_data);
+  TfLiteTensor* output;
+  TF_LITE_ENSURE_OK(context, GetOutputSafe(context, node, 0, &output));
+  const int64_t num_elements = NumElements(output);
+  if (num_elements == 0) return kTfLiteOk;
+
+  const int num_inputs = NumInputs(node);
+  std::vector<const float*> inputs(num_inputs);
+  // std::vector<bool> doesn't expose its data.
+  std::unique_ptr<bool[]> is_scalar_input(new bool[num_inputs]);
+  for (int i = 0; i < num_inputs; ++i) {
+    const TfLiteTensor* input;
+    TF_LITE_ENSURE_OK(context, GetInputSafe(context, node, i, &input));
+    inputs[i] = GetTensorData<float>(input);
+    is_scalar_input[i] = NumElements(input) == 1 && num_elements != 1;
+  }
+  float* output_data = GetTensorData<float>(output);
+
+  CpuBackendContext* cpu_backend_context =
+      CpuBackendContext::GetFromContext(context);
+  const int thread_count = std::max<int64_t>(
+      1, std::min<int64_t>(cpu_backend_context->max_num_threads(),
+                           num_elements / kMinElementsPerThread));
+  if (thread_count == 1) {
+    EvalProgram(op_data->program, inputs.data(), is_scalar_input.get(), 0,
+                num_elements, output_data);
+    return kTfLiteOk;
+  }
+  // The threads evaluate whole tiles.
+  const int64_t num_tiles = (num_elements + kTileSize - 1) / kTileSize;
+  std::vector<EvalProgramTask> tasks;
+  tasks.reserve(thread_count);
+  int64_t start_tile = 0;
+  for (int i = 0; i < thread_count; ++i) {
+    const int64_t end_tile =
+        start_tile + (num_tiles - start_tile) / (thread_count - i);
+    tasks.emplace_back(&op_data->program, inputs.data(), is_scalar_input.get(),
+                       start_tile * kTileSize,
+                       std::min(end_tile * kTileSize, num_elements),
+                       output_data);
+    start_tile = end_tile;
+  }
+  cpu_backend_threadpool::Execute(tasks.size(), tasks.data(),
+                                  cpu_backend_context);
+  return kTfLiteOk;
+}
+
+}  // namespace fused_elementwise
+
+TfLiteRegistration* Register_FUSED_ELEMENTWISE() {
+  static TfLiteRegistration r = {
+      fused_elementwise::Init, fused_elementwise::Free,
+      fused_elementwise::Prepare, fused_elementwise::Eval};
+  return &r;
+}
+
+}  // namespace custom
+}  // namespace ops
+}  // namespace tflite
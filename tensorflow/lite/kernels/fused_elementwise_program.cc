@@ -0,0 +1,154 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/kernels/fused_elementwise_program.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "flatbuffers/flexbuffers.h"  // from @flatbuffers
+
+namespace tflite {
+namespace ops {
+namespace custom {
+namespace fused_elementwise {
+namespace {
+
+struct OpCodeName {
+  OpCode op;
+  const char* name;
+};
+
+constexpr OpCodeName kOpCodeNames[] = {
+    {OpCode::kAdd, "ADD"},
+    {OpCode::kSub, "SUB"},
+    {OpCode::kMul, "MUL"},
+    {OpCode::kDiv, "DIV"},
+    {OpCode::kMaximum, "MAXIMUM"},
+    {OpCode::kMinimum, "MINIMUM"},
+    {OpCode::kSquaredDifference, "SQUARED_DIFFERENCE"},
+    {OpCode::kAbs, "ABS"},
+    {OpCode::kExp, "EXP"},
+    {OpCode::kLogistic, "LOGISTIC"},
+    {OpCode::kNeg, "NEG"},
+    {OpCode::kRelu, "RELU"},
+    {OpCode::kRelu6, "RELU6"},
+    {OpCode::kReluN1To1, "RELU_N1_TO_1"},
+    {OpCode::kRsqrt, "RSQRT"},
+    {OpCode::kSqrt, "SQRT"},
+    {OpCode::kSquare, "SQUARE"},
+    {OpCode::kTanh, "TANH"},
+};
+
+bool GetOpCode(const std::string& name, OpCode* op) {
+  for (const OpCodeName& op_name : kOpCodeNames) {
+    if (name == op_name.name) {
+      *op = op_name.op;
+      return true;
+    }
+  }
+  return false;
+}
+
+const char* GetOpCodeName(OpCode op) {
+  for (const OpCodeName& op_name : kOpCodeNames) {
+    if (op == op_name.op) return op_name.name;
+  }
+  return "";
+}
+
+}  // namespace
+
+bool IsUnary(OpCode op) {
+  switch (op) {
+    case OpCode::kAdd:
+    case OpCode::kSub:
+    case OpCode::kMul:
+    case OpCode::kDiv:
+    case OpCode::kMaximum:
+    case OpCode::kMinimum:
+    case OpCode::kSquaredDifference:
+      return false;
+    default:
+      return true;
+  }
+}
+
+bool ParseProgram(const uint8_t* buffer, size_t length, int num_inputs,
+                  Program* program) {
+  *program = Program();
+  program->num_inputs = num_inputs;
+  if (buffer == nullptr || length == 0) return false;
+  const flexbuffers::Map& m = flexbuffers::GetRoot(buffer, length).AsMap();
+  const flexbuffers::Vector constants = m["constants"].AsVector();
+  const flexbuffers::Vector ops = m["ops"].AsVector();
+  const flexbuffers::Vector lhs = m["lhs"].AsVector();
+  const flexbuffers::Vector rhs = m["rhs"].AsVector();
+  if (ops.size() == 0 || lhs.size() != ops.size() ||
+      rhs.size() != ops.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < constants.size(); ++i) {
+    program->constants.push_back(constants[i].AsFloat());
+  }
+  for (size_t i = 0; i < ops.size(); ++i) {
+    Instruction instruction;
+    if (!GetOpCode(ops[i].AsString().str(), &instruction.op)) return false;
+    instruction.lhs = lhs[i].AsInt32();
+    instruction.rhs = rhs[i].AsInt32();
+    // The operands are values computed before the instruction.
+    const int value = program->instruction_value(i);
+    if (instruction.lhs < 0 || instruction.lhs >= value) return false;
+    if (IsUnary(instruction.op) ? instruction.rhs != -1
+                                : instruction.rhs < 0 ||
+                                      instruction.rhs >= value) {
+      return false;
+    }
+    program->instructions.push_back(instruction);
+  }
+  return true;
+}
+
+std::vector<uint8_t> SerializeProgram(const Program& program) {
+  flexbuffers::Builder fbb;
+  fbb.Map([&]() {
+    fbb.Vector("constants", [&]() {
+      for (float constant : program.constants) fbb.Float(constant);
+    });
+    fbb.Vector("ops", [&]() {
+      for (const Instruction& instruction : program.instructions) {
+        fbb.String(GetOpCodeName(instruction.op));
+      }
+    });
+    fbb.Vector("lhs", [&]() {
+      for (const Instruction& instruction : program.instructions) {
+        fbb.Int(instruction.lhs);
+      }
+    });
+    fbb.Vector("rhs", [&]() {
+      for (const Instruction& instruction : program.instructions) {
+        fbb.Int(instruction.rhs);
+      }
+    });
+  });
+  fbb.Finish();
+  return fbb.GetBuffer();
+}
+
+}  // namespace fused_elementwise
+}  // namespace custom
+}  // namespace ops
+}  // namespace tflite
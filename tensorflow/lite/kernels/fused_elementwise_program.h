@@ -0,0 +1,97 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_KERNELS_FUSED_ELEMENTWISE_PROGRAM_H_
+#define TENSORFLOW_LITE_KERNELS_FUSED_ELEMENTWISE_PROGRAM_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace tflite {
+namespace ops {
+namespace custom {
+namespace fused_elementwise {
+
+// The custom code of the op computing a chain of elementwise float ops,
+// formed by the converter, in a single pass over its inputs.
+inline constexpr char kFusedElementwise[] = "FusedElementwise";
+
+// The custom options of the op are a flexbuffer map describing the
+// expression DAG of the chain as a program:
+//   "constants": vector of floats, the scalar constants of the chain.
+//   "ops": vector of strings, the op code of each instruction, e.g. "TANH".
+//   "lhs", "rhs": vectors of ints, the operands of each instruction, -1 for
+//     the right operand of a unary instruction.
+// The values of the program are the inputs of the op, then the constants,
+// then the results of the instructions in order. An operand is the index of
+// an input, a constant or a previous instruction, and the result of the last
+// instruction is the output of the op.
+enum class OpCode {
+  kAdd,
+  kSub,
+  kMul,
+  kDiv,
+  kMaximum,
+  kMinimum,
+  kSquaredDifference,
+  kAbs,
+  kExp,
+  kLogistic,
+  kNeg,
+  kRelu,
+  kRelu6,
+  kReluN1To1,
+  kRsqrt,
+  kSqrt,
+  kSquare,
+  kTanh,
+};
+
+struct Instruction {
+  OpCode op;
+  int lhs;
+  int rhs;
+};
+
+struct Program {
+  int num_inputs = 0;
+  std::vector<float> constants;
+  std::vector<Instruction> instructions;
+
+  int num_values() const {
+    return num_inputs + constants.size() + instructions.size();
+  }
+  // The index of the value computed by the instruction `i`.
+  int instruction_value(int i) const {
+    return num_inputs + constants.size() + i;
+  }
+};
+
+bool IsUnary(OpCode op);
+
+// Parses and validates the program of an op with `num_inputs` inputs from
+// its custom options. Returns false if the program is invalid.
+bool ParseProgram(const uint8_t* buffer, size_t length, int num_inputs,
+                  Program* program);
+
+// Serializes `program` in the format of the custom options.
+std::vector<uint8_t> SerializeProgram(const Program& program);
+
+}  // namespace fused_elementwise
+}  // namespace custom
+}  // namespace ops
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_KERNELS_FUSED_ELEMENTWISE_PROGRAM_H_
@@ -0,0 +1,151 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "tensorflow/lite/kernels/fused_elementwise_program.h"
+#include "tensorflow/lite/kernels/test_util.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+namespace tflite {
+
+namespace ops {
+namespace custom {
+
+TfLiteRegistration* Register_FUSED_ELEMENTWISE();
+
+}  // namespace custom
+}  // namespace ops
+
+namespace {
+
+using ::testing::ElementsAreArray;
+using ops::custom::fused_elementwise::Instruction;
+using ops::custom::fused_elementwise::OpCode;
+using ops::custom::fused_elementwise::Program;
+using ops::custom::fused_elementwise::SerializeProgram;
+
+class FusedElementwiseOpModel : public SingleOpModel {
+ public:
+  FusedElementwiseOpModel(const std::vector<std::vector<int>>& input_shapes,
+                          const Program& program, bool allocate = true) {
+    for (const std::vector<int>& shape : input_shapes) {
+      inputs_.push_back(AddInput({TensorType_FLOAT32, shape}));
+    }
+    output_ = AddOutput(TensorType_FLOAT32);
+    SetCustomOp("FusedElementwise", SerializeProgram(program),
+                ops::custom::Register_FUSED_ELEMENTWISE);
+    BuildInterpreter(input_shapes, /*num_threads=*/-1,
+                     /*allow_fp32_relax_to_fp16=*/false,
+                     /*apply_delegate=*/true, allocate);
+  }
+
+  int input(int i) const { return inputs_[i]; }
+  TfLiteStatus AllocateTensors() { return interpreter_->AllocateTensors(); }
+  std::vector<float> GetOutput() { return ExtractVector<float>(output_); }
+  std::vector<int> GetOutputShape() { return GetTensorShape(output_); }
+
+ private:
+  std::vector<int> inputs_;
+  int output_;
+};
+
+// 0.5 * x * (1 + tanh(sqrt(2 / pi) * (x + 0.044715 * x^3))), as converted
+// from the tanh approximation of GELU.
+Program GeluProgram() {
+  Program program;
+  program.num_inputs = 1;
+  program.constants = {0.044715f, 0.7978845608f, 1.0f, 0.5f};
+  // The values 1 to 4 are the constants.
+  program.instructions = {
+      {OpCode::kMul, 0, 0},    // 5
+      {OpCode::kMul, 5, 0},    // 6
+      {OpCode::kMul, 6, 1},    // 7
+      {OpCode::kAdd, 0, 7},    // 8
+      {OpCode::kMul, 8, 2},    // 9
+      {OpCode::kTanh, 9, -1},  // 10
+      {OpCode::kAdd, 10, 3},   // 11
+      {OpCode::kMul, 11, 0},   // 12
+      {OpCode::kMul, 12, 4},   // 13
+  };
+  return program;
+}
+
+float Gelu(float x) {
+  return 0.5f * x *
+         (1.0f + std::tanh(0.7978845608f * (x + 0.044715f * x * x * x)));
+}
+
+TEST(FusedElementwiseOpTest, Gelu) {
+  FusedElementwiseOpModel m({{2, 3}}, GeluProgram());
+  const std::vector<float> input = {-3.0f, -1.0f, -0.5f, 0.0f, 0.5f, 2.0f};
+  m.PopulateTensor<float>(m.input(0), input);
+  ASSERT_EQ(m.Invoke(), kTfLiteOk);
+
+  std::vector<float> expected;
+  for (float x : input) expected.push_back(Gelu(x));
+  EXPECT_THAT(m.GetOutputShape(), ElementsAreArray({2, 3}));
+  EXPECT_THAT(m.GetOutput(), ElementsAreArray(ArrayFloatNear(expected)));
+}
+
+TEST(FusedElementwiseOpTest, SpansSeveralTiles) {
+  const int size = 5000;
+  FusedElementwiseOpModel m({{size}}, GeluProgram());
+  std::vector<float> input(size);
+  std::vector<float> expected(size);
+  for (int i = 0; i < size; ++i) {
+    input[i] = (i - size / 2) * 0.002f;
+    expected[i] = Gelu(input[i]);
+  }
+  m.PopulateTensor<float>(m.input(0), input);
+  ASSERT_EQ(m.Invoke(), kTfLiteOk);
+  EXPECT_THAT(m.GetOutput(), ElementsAreArray(ArrayFloatNear(expected)));
+}
+
+TEST(FusedElementwiseOpTest, BroadcastsScalarInputs) {
+  // relu6(x * scale - y)
+  Program program;
+  program.num_inputs = 3;
+  program.instructions = {
+      {OpCode::kMul, 0, 1},
+      {OpCode::kSub, 3, 2},
+      {OpCode::kRelu6, 4, -1},
+  };
+  FusedElementwiseOpModel m({{1, 4}, {1}, {1, 4}}, program);
+  m.PopulateTensor<float>(m.input(0), {-1.0f, 1.0f, 2.0f, 5.0f});
+  m.PopulateTensor<float>(m.input(1), {2.0f});
+  m.PopulateTensor<float>(m.input(2), {0.0f, 1.0f, 1.0f, 1.0f});
+  ASSERT_EQ(m.Invoke(), kTfLiteOk);
+  EXPECT_THAT(m.GetOutputShape(), ElementsAreArray({1, 4}));
+  EXPECT_THAT(m.GetOutput(),
+              ElementsAreArray(ArrayFloatNear({0.0f, 1.0f, 3.0f, 6.0f})));
+}
+
+TEST(FusedElementwiseOpTest, RejectsOperandsComputedLater) {
+  Program program;
+  program.num_inputs = 1;
+  program.instructions = {
+      {OpCode::kAdd, 0, 2},
+      {OpCode::kTanh, 1, -1},
+  };
+  FusedElementwiseOpModel m({{4}}, program, /*allocate=*/false);
+  EXPECT_NE(m.AllocateTensors(), kTfLiteOk);
+}
+
+}  // namespace
+}  // namespace tflite
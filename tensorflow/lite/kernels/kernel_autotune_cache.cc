@@ -0,0 +1,123 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/kernels/kernel_autotune_cache.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <mutex>  // NOLINT(build/c++11)
+#include <sstream>
+#include <string>
+
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/minimal_logging.h"
+
+namespace tflite {
+namespace {
+
+// First line of the cache files, changed when the keys of a kernel change so
+// that the variants of older files are not used.
+constexpr char kFileHeader[] = "tflite_kernel_autotune_cache 1";
+
+}  // namespace
+
+TfLiteStatus KernelAutotuneCache::LoadFromFile(const std::string& path) {
+  std::ifstream file(path);
+  if (!file) return kTfLiteOk;
+  std::string line;
+  if (!std::getline(file, line) || line != kFileHeader) {
+    TFLITE_LOG(TFLITE_LOG_WARNING,
+               "Ignoring the kernel autotuning cache %s of an unknown format.",
+               path.c_str());
+    return kTfLiteError;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  // Each line is the variant, a space and the key.
+  while (std::getline(file, line)) {
+    std::istringstream entry(line);
+    int variant;
+    std::string key;
+    if (!(entry >> variant) || variant < 0 || entry.get() != ' ' ||
+        !std::getline(entry, key) || key.empty()) {
+      continue;
+    }
+    variants_[key] = variant;
+  }
+  return kTfLiteOk;
+}
+
+TfLiteStatus KernelAutotuneCache::SaveToFile(const std::string& path) const {
+  // Written next to `path` and renamed, so that a concurrent load never reads
+  // a partial file.
+  const std::string tmp_path = path + ".tmp";
+  {
+    std::ofstream file(tmp_path, std::ios::trunc);
+    if (!file) {
+      TFLITE_LOG(TFLITE_LOG_ERROR, "Could not write %s.", tmp_path.c_str());
+      return kTfLiteError;
+    }
+    file << kFileHeader << '\n';
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& [key, variant] : variants_) {
+      file << variant << ' ' << key << '\n';
+    }
+    if (!file.flush()) {
+      TFLITE_LOG(TFLITE_LOG_ERROR, "Could not write %s.", tmp_path.c_str());
+      return kTfLiteError;
+    }
+  }
+  if (std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+    TFLITE_LOG(TFLITE_LOG_ERROR, "Could not rename %s to %s.",
+               tmp_path.c_str(), path.c_str());
+    std::remove(tmp_path.c_str());
+    return kTfLiteError;
+  }
+  return kTfLiteOk;
+}
+
+int KernelAutotuneCache::Lookup(const std::string& key) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = variants_.find(key);
+  return it == variants_.end() ? -1 : it->second;
+}
+
+void KernelAutotuneCache::Record(const std::string& key, int variant) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  variants_[key] = variant;
+}
+
+size_t KernelAutotuneCache::size() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return variants_.size();
+}
+
+KernelVariantTuner::KernelVariantTuner(int num_variants,
+                                       int num_runs_per_variant)
+    : runs_per_variant_(std::max(num_runs_per_variant, 1)),
+      times_(std::max(num_variants, 1), UINT64_MAX) {}
+
+void KernelVariantTuner::RecordRun(uint64_t micros) {
+  uint64_t& time = times_[NextVariant()];
+  time = std::min(time, micros);
+  ++num_runs_;
+}
+
+int KernelVariantTuner::BestVariant() const {
+  return std::min_element(times_.begin(), times_.end()) - times_.begin();
+}
+
+}  // namespace tflite
@@ -0,0 +1,97 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_KERNELS_KERNEL_AUTOTUNE_CACHE_H_
+#define TENSORFLOW_LITE_KERNELS_KERNEL_AUTOTUNE_CACHE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>  // NOLINT(build/c++11)
+#include <string>
+#include <vector>
+
+#include "tensorflow/lite/core/c/common.h"
+
+namespace tflite {
+
+// The kernel variants chosen by autotuning, e.g. the Eigen or the im2col +
+// GEMM implementation of a float CONV_2D, keyed by a description of the op
+// and its shapes built by the kernel. A cache is set on the interpreter with
+// `InterpreterOptions::SetKernelAutotuneCache`: kernels with several variants
+// use the variant of the cache when there is one, and otherwise time their
+// variants during the first invocations and record the fastest.
+//
+// Since the fastest variant depends on the device, the cache is meant to be
+// saved to a file on the device after a warmup invocation, and loaded in the
+// later runs.
+//
+// This class is thread-safe, and can be shared by several interpreters.
+//
+// WARNING: Experimental interface, subject to change.
+class KernelAutotuneCache {
+ public:
+  KernelAutotuneCache() = default;
+  KernelAutotuneCache(const KernelAutotuneCache&) = delete;
+  KernelAutotuneCache& operator=(const KernelAutotuneCache&) = delete;
+
+  // Adds the variants saved in `path` by `SaveToFile`, replacing the ones
+  // with the same keys. A missing file is not an error, so that the first
+  // run of an application can start with an empty cache.
+  TfLiteStatus LoadFromFile(const std::string& path);
+
+  // Writes all the variants to `path`.
+  TfLiteStatus SaveToFile(const std::string& path) const;
+
+  // Returns the variant recorded for `key`, or -1 if there is none.
+  int Lookup(const std::string& key) const;
+
+  void Record(const std::string& key, int variant);
+
+  size_t size() const;
+
+ private:
+  mutable std::mutex mutex_;
+  std::map<std::string, int> variants_;
+};
+
+// Chooses the fastest of the `num_variants` variants of a kernel by running
+// each of them in turn `num_runs_per_variant` times, and keeping the
+// shortest time of each. More than one run per variant excludes the one-time
+// costs of the first runs, e.g. packing the weights.
+class KernelVariantTuner {
+ public:
+  explicit KernelVariantTuner(int num_variants, int num_runs_per_variant = 2);
+
+  // Returns whether all the runs have been timed.
+  bool done() const { return num_runs_ == times_.size() * runs_per_variant_; }
+
+  // Returns the variant to run next. Requires `!done()`.
+  int NextVariant() const { return num_runs_ % times_.size(); }
+
+  // Records the time of a run of `NextVariant()`.
+  void RecordRun(uint64_t micros);
+
+  // Returns the fastest variant. Requires `done()`.
+  int BestVariant() const;
+
+ private:
+  size_t runs_per_variant_;
+  size_t num_runs_ = 0;
+  std::vector<uint64_t> times_;
+};
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_KERNELS_KERNEL_AUTOTUNE_CACHE_H_
@@ -0,0 +1,81 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/kernels/kernel_autotune_cache.h"
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+#include <gtest/gtest.h>
+#include "tensorflow/lite/core/c/common.h"
+
+namespace tflite {
+namespace {
+
+std::string TempPath(const std::string& name) {
+  return ::testing::TempDir() + "/" + name;
+}
+
+TEST(KernelAutotuneCacheTest, SavesAndLoadsVariants) {
+  const std::string path = TempPath("kernel_autotune_cache");
+  std::remove(path.c_str());
+
+  KernelAutotuneCache cache;
+  // A missing file is an empty cache.
+  ASSERT_EQ(cache.LoadFromFile(path), kTfLiteOk);
+  EXPECT_EQ(cache.size(), 0);
+  EXPECT_EQ(cache.Lookup("CONV_2D:1x8x8x3"), -1);
+
+  cache.Record("CONV_2D:1x8x8x3", 1);
+  cache.Record("CONV_2D:1x16x16x3 with spaces", 0);
+  cache.Record("CONV_2D:1x8x8x3", 0);
+  EXPECT_EQ(cache.Lookup("CONV_2D:1x8x8x3"), 0);
+  ASSERT_EQ(cache.SaveToFile(path), kTfLiteOk);
+
+  KernelAutotuneCache loaded;
+  loaded.Record("FULLY_CONNECTED:1x4", 1);
+  ASSERT_EQ(loaded.LoadFromFile(path), kTfLiteOk);
+  EXPECT_EQ(loaded.size(), 3);
+  EXPECT_EQ(loaded.Lookup("CONV_2D:1x8x8x3"), 0);
+  EXPECT_EQ(loaded.Lookup("CONV_2D:1x16x16x3 with spaces"), 0);
+  EXPECT_EQ(loaded.Lookup("FULLY_CONNECTED:1x4"), 1);
+}
+
+TEST(KernelAutotuneCacheTest, RejectsUnknownFormat) {
+  const std::string path = TempPath("kernel_autotune_cache_unknown");
+  {
+    std::ofstream file(path, std::ios::trunc);
+    file << "0 CONV_2D:1x8x8x3\n";
+  }
+  KernelAutotuneCache cache;
+  EXPECT_EQ(cache.LoadFromFile(path), kTfLiteError);
+  EXPECT_EQ(cache.size(), 0);
+}
+
+TEST(KernelVariantTunerTest, PicksTheFastestVariant) {
+  KernelVariantTuner tuner(/*num_variants=*/3, /*num_runs_per_variant=*/2);
+  // The first run of each variant is slowed down by one-time costs.
+  const uint64_t times[] = {100, 500, 90, 60, 40, 50};
+  for (int run = 0; run < 6; ++run) {
+    ASSERT_FALSE(tuner.done());
+    EXPECT_EQ(tuner.NextVariant(), run % 3);
+    tuner.RecordRun(times[run]);
+  }
+  ASSERT_TRUE(tuner.done());
+  EXPECT_EQ(tuner.BestVariant(), 1);
+}
+
+}  // namespace
+}  // namespace tflite
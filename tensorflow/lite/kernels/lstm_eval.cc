@@ -69,6 +69,27 @@ void MatrixBatchVectorMultiplyAccumulate(
   }
 }
 
+// Computes the products of the input weights of a gate with the `n_rows`
+// input vectors of a whole sequence in a single matrix multiplication, plus
+// `gate_bias` if it isn't null.
+void PrecomputeInputProjectionFloat(const float* input_to_gate_weights,
+                                    const float* gate_bias, const float* input,
+                                    int n_rows, int n_cell, int n_input,
+                                    float* projection,
+                                    CpuBackendContext* cpu_backend_context) {
+  tflite::FullyConnectedParams float_fc_params;
+  float_fc_params.float_activation_min = std::numeric_limits<float>::lowest();
+  float_fc_params.float_activation_max = std::numeric_limits<float>::max();
+  float_fc_params.lhs_cacheable = true;
+  float_fc_params.rhs_cacheable = false;
+
+  tflite::optimized_ops::FullyConnected(
+      float_fc_params, tflite::RuntimeShape({n_rows, n_input}), input,
+      tflite::RuntimeShape({n_cell, n_input}), input_to_gate_weights,
+      tflite::RuntimeShape({n_cell}), gate_bias,
+      tflite::RuntimeShape({n_rows, n_cell}), projection, cpu_backend_context);
+}
+
 void ComputeRowSums(
     int32_t* input_to_input_row_sums, int32_t* input_to_forget_row_sums,
     int32_t* input_to_cell_row_sums, int32_t* input_to_output_row_sums,
@@ -171,6 +192,7 @@ inline float GetTensorScale(const TfLiteTensor* tensor) {
 // Input vectors (to LSTM):    | Size:                | Optional?
 //   input                     | n_input              |
 //   aux_input                 | n_aux_input          | y (bidir LSTM)
+//   input_projection          | n_cell               | y (precomputed)
 // Input vectors (persistent states):
 //   output_state              | n_output             |
 //   cell_state                | n_cell               |
@@ -189,9 +211,13 @@ inline float GetTensorScale(const TfLiteTensor* tensor) {
 //   activation                                 - activation to use.
 //   is_input_all_zeros, is_aux_input_all_zeros - if input vectors are all zero.
 //   use_layer_norm                             - if doing layer norm LSTM.
+//
+// If `input_projection` isn't null, it holds W_input * input, plus the bias
+// without layer norm, and `input` and `input_to_gate_weights` aren't read.
 inline void CalculateLstmGateFloat(
     const float* input, const float* input_to_gate_weights,
-    const float* aux_input, const float* aux_input_to_gate_weights,
+    const float* input_projection, const float* aux_input,
+    const float* aux_input_to_gate_weights,
     const float* output_state, const float* recurrent_to_gate_weights,
     const float* cell_state, const float* cell_to_gate_weights,
     const float* layer_norm_coefficients, const float* gate_bias,
@@ -205,15 +231,17 @@ inline void CalculateLstmGateFloat(
 
   // Initialize scratch buffers with bias for regular lstm or initialize with
   // zero for layer norm lstm.
-  if (use_layer_norm) {
+  if (input_projection != nullptr) {
+    std::copy_n(input_projection, n_cell * n_batch, gate);
+  } else if (use_layer_norm) {
     std::fill_n(gate, n_cell * n_batch, 0.0f);
   } else {
     tensor_utils::VectorBatchVectorAssign(gate_bias, n_cell, n_batch, gate);
   }
   // For each batch and cell: compute input_weight * input.
-  // Skip if input is all zeros.
+  // Skip if input is all zeros or if the product is precomputed.
   float* accumulation_buffer = gate;
-  if (!is_input_all_zeros) {
+  if (input_projection == nullptr && !is_input_all_zeros) {
     MatrixBatchVectorMultiplyAccumulate(input_to_gate_weights, input,
                                         accumulation_buffer, output, n_cell,
                                         n_input, n_batch, context);
@@ -863,6 +891,9 @@ void CalculateLstmOutputInteger8x8_8(
 //   cell_layer_norm_coefficients_ptr   - optional
 //   output_layer_norm_coefficients_ptr - optional
 //
+// Precomputed input projections of size 'n_batch * n_cell' per gate:
+//   input_projection_ptr              - optional
+//
 // The pointers to the cell and output state and the output are updated.
 //
 // The pointers input_ptr, aux_input_ptr, and output_ptr point to data aligned
@@ -875,12 +906,19 @@ void CalculateLstmOutputInteger8x8_8(
 // for bidirectional LSTMs with merge_outputs. In this case, the batched
 // operations cannot be used since they assume that the batched outputs are
 // contiguous, and we manually loop over the batched outputs.
+//
+// If input_projection_ptr isn't null, it holds the products of the input
+// weights of the input (unless CIFG), forget, cell and output gates with the
+// input, in that order and input_projection_gate_stride apart, and the input
+// weights aren't read.
 // LINT.IfChange
 inline void LstmStepFloat(
     const float* input_ptr, const float* input_to_input_weights_ptr,
     const float* input_to_forget_weights_ptr,
     const float* input_to_cell_weights_ptr,
-    const float* input_to_output_weights_ptr, const float* aux_input_ptr,
+    const float* input_to_output_weights_ptr,
+    const float* input_projection_ptr, int input_projection_gate_stride,
+    const float* aux_input_ptr,
     const float* aux_input_to_input_weights_ptr,
     const float* aux_input_to_forget_weights_ptr,
     const float* aux_input_to_cell_weights_ptr,
@@ -918,8 +956,25 @@ inline void LstmStepFloat(
   float* output_gate_scratch = scratch3;
   float* accumulation_scratch_buffer = scratch4;
 
+  // Name the precomputed input projections of the gates.
+  const float* input_gate_projection = nullptr;
+  const float* forget_gate_projection = nullptr;
+  const float* cell_gate_projection = nullptr;
+  const float* output_gate_projection = nullptr;
+  if (input_projection_ptr != nullptr) {
+    const float* projection = input_projection_ptr;
+    if (!use_cifg) {
+      input_gate_projection = projection;
+      projection += input_projection_gate_stride;
+    }
+    forget_gate_projection = projection;
+    cell_gate_projection = projection + input_projection_gate_stride;
+    output_gate_projection = projection + 2 * input_projection_gate_stride;
+  }
+
   // Check if inputs are all zeros so we can skip some computations.
   const bool is_input_all_zeros =
+      input_projection_ptr == nullptr &&
       tensor_utils::IsZeroVector(input_ptr, n_batch * n_input);
   const bool is_aux_input_all_zeros =
       (aux_input_ptr == nullptr ||
@@ -928,8 +983,8 @@ inline void LstmStepFloat(
   if (!use_cifg) {
     // Calculate the input gate. (If not CIFG.)
     CalculateLstmGateFloat(
-        input_ptr, input_to_input_weights_ptr, aux_input_ptr,
-        aux_input_to_input_weights_ptr, output_state_ptr,
+        input_ptr, input_to_input_weights_ptr, input_gate_projection,
+        aux_input_ptr, aux_input_to_input_weights_ptr, output_state_ptr,
         recurrent_to_input_weights_ptr,
 
         cell_state_ptr, cell_to_input_weights_ptr,
@@ -941,8 +996,8 @@ inline void LstmStepFloat(
   }
   // Calculate the forget gate.
   CalculateLstmGateFloat(
-      input_ptr, input_to_forget_weights_ptr, aux_input_ptr,
-      aux_input_to_forget_weights_ptr, output_state_ptr,
+      input_ptr, input_to_forget_weights_ptr, forget_gate_projection,
+      aux_input_ptr, aux_input_to_forget_weights_ptr, output_state_ptr,
       recurrent_to_forget_weights_ptr,
 
       cell_state_ptr, cell_to_forget_weights_ptr,
@@ -953,8 +1008,8 @@ inline void LstmStepFloat(
       recurrent_to_forget_is_diag, context);
   // Calculate the cell update gate.
   CalculateLstmGateFloat(
-      input_ptr, input_to_cell_weights_ptr, aux_input_ptr,
-      aux_input_to_cell_weights_ptr, output_state_ptr,
+      input_ptr, input_to_cell_weights_ptr, cell_gate_projection,
+      aux_input_ptr, aux_input_to_cell_weights_ptr, output_state_ptr,
       recurrent_to_cell_weights_ptr,
 
       /*cell_state=*/nullptr,
@@ -969,8 +1024,8 @@ inline void LstmStepFloat(
                       params->cell_clip);
   // Calculate output gate.
   CalculateLstmGateFloat(
-      input_ptr, input_to_output_weights_ptr, aux_input_ptr,
-      aux_input_to_output_weights_ptr, output_state_ptr,
+      input_ptr, input_to_output_weights_ptr, output_gate_projection,
+      aux_input_ptr, aux_input_to_output_weights_ptr, output_state_ptr,
       recurrent_to_output_weights_ptr,
 
       cell_state_ptr, cell_to_output_weights_ptr,
@@ -1819,7 +1874,7 @@ TfLiteStatus EvalFloat(
     TfLiteTensor* cell_state, TfLiteTensor* output,
     bool recurrent_to_input_is_diag, bool recurrent_to_forget_is_diag,
     bool recurrent_to_cell_is_diag, bool recurrent_to_output_is_diag,
-    CpuBackendContext* context) {
+    CpuBackendContext* context, TfLiteTensor* input_projection_scratch) {
   TF_LITE_ASSERT(input->dims->size >= 2 && input->dims->size <= 3);
 
   int max_time, n_batch;
@@ -1864,6 +1919,40 @@ TfLiteStatus EvalFloat(
     accumulation_scratch_buffer = scratch_buffer_ptr + 4 * n_cell * n_batch;
   }
 
+  // Multiply the input weights with the inputs of all the time steps at once,
+  // the products don't depend on the state. The rows of the projections of a
+  // gate follow the order of the rows of the input.
+  float* input_projection = nullptr;
+  const int input_projection_gate_stride = max_time * n_batch * n_cell;
+  if (input_projection_scratch != nullptr) {
+    input_projection = GetTensorData<float>(input_projection_scratch);
+    float* gate_projection = input_projection;
+    auto precompute_gate_projection =
+        [&](const TfLiteTensor* input_to_gate_weights,
+            const TfLiteTensor* gate_bias,
+            const TfLiteTensor* layer_norm_coefficients) {
+          // With layer norm, the bias is added after the normalization.
+          PrecomputeInputProjectionFloat(
+              GetTensorData<float>(input_to_gate_weights),
+              layer_norm_coefficients == nullptr
+                  ? GetTensorData<float>(gate_bias)
+                  : nullptr,
+              GetTensorData<float>(input), max_time * n_batch, n_cell, n_input,
+              gate_projection, context);
+          gate_projection += input_projection_gate_stride;
+        };
+    if (!use_cifg) {
+      precompute_gate_projection(input_to_input_weights, input_gate_bias,
+                                 input_layer_norm_coefficients);
+    }
+    precompute_gate_projection(input_to_forget_weights, forget_gate_bias,
+                               forget_layer_norm_coefficients);
+    precompute_gate_projection(input_to_cell_weights, cell_gate_bias,
+                               cell_layer_norm_coefficients);
+    precompute_gate_projection(input_to_output_weights, output_gate_bias,
+                               output_layer_norm_coefficients);
+  }
+
   const int output_batch_leading_dim =
       output->dims->data[output->dims->size - 1];
   if (time_major) {
@@ -1875,6 +1964,9 @@ TfLiteStatus EvalFloat(
       // backwards.
       const int t_rel = forward_sequence ? t : max_time - t - 1;
       const float* input_ptr = GetTensorData<float>(input) + t_rel * input_step;
+      const float* input_projection_ptr =
+          input_projection ? input_projection + t_rel * n_batch * n_cell
+                           : nullptr;
       const float* aux_input_ptr = nullptr;
       if (aux_input) {
         aux_input_ptr = GetTensorData<float>(aux_input) + t_rel * input_step;
@@ -1886,7 +1978,8 @@ TfLiteStatus EvalFloat(
           input_ptr, GetTensorData<float>(input_to_input_weights),
           GetTensorData<float>(input_to_forget_weights),
           GetTensorData<float>(input_to_cell_weights),
-          GetTensorData<float>(input_to_output_weights), aux_input_ptr,
+          GetTensorData<float>(input_to_output_weights), input_projection_ptr,
+          input_projection_gate_stride, aux_input_ptr,
           GetTensorData<float>(aux_input_to_input_weights),
           GetTensorData<float>(aux_input_to_forget_weights),
           GetTensorData<float>(aux_input_to_cell_weights),
@@ -1926,6 +2019,9 @@ TfLiteStatus EvalFloat(
         const int time_offset = b * max_time + t_rel;
         const float* input_ptr =
             GetTensorData<float>(input) + time_offset * input_step;
+        const float* input_projection_ptr =
+            input_projection ? input_projection + time_offset * n_cell
+                             : nullptr;
         const float* aux_input_ptr = nullptr;
         if (aux_input) {
           aux_input_ptr =
@@ -1949,7 +2045,8 @@ TfLiteStatus EvalFloat(
             input_ptr, GetTensorData<float>(input_to_input_weights),
             GetTensorData<float>(input_to_forget_weights),
             GetTensorData<float>(input_to_cell_weights),
-            GetTensorData<float>(input_to_output_weights), aux_input_ptr,
+            GetTensorData<float>(input_to_output_weights),
+            input_projection_ptr, input_projection_gate_stride, aux_input_ptr,
             GetTensorData<float>(aux_input_to_input_weights),
             GetTensorData<float>(aux_input_to_forget_weights),
             GetTensorData<float>(aux_input_to_cell_weights),
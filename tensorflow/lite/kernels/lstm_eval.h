@@ -95,6 +95,11 @@ struct IntegerLstmParameter {
   int32_t intermediate_zp[12];
 };
 
+// If `input_projection_scratch` isn't null, the products of the input weights
+// with the inputs of all the time steps are computed upfront in it, with a
+// matrix multiplication per gate instead of one per gate and time step. It
+// must hold (use_cifg ? 3 : 4) * max_time * n_batch * n_cell floats. The
+// auxiliary input, if any, is still multiplied at each time step.
 TfLiteStatus EvalFloat(
     const TfLiteTensor* input, const TfLiteTensor* input_to_input_weights,
     const TfLiteTensor* input_to_forget_weights,
@@ -124,7 +129,8 @@ TfLiteStatus EvalFloat(
     TfLiteTensor* cell_state, TfLiteTensor* output,
     bool recurrent_to_input_is_diag, bool recurrent_to_forget_is_diag,
     bool recurrent_to_cell_is_diag, bool recurrent_to_output_is_diag,
-    CpuBackendContext* context);
+    CpuBackendContext* context,
+    TfLiteTensor* input_projection_scratch = nullptr);
 
 TfLiteStatus EvalHybrid(
     const TfLiteTensor* input, const TfLiteTensor* input_to_input_weights,
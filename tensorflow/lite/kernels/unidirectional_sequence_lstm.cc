@@ -42,6 +42,9 @@ struct OpData {
   // The scratch tensor index.
   int scratch_tensor_index;
   bool compute_row_sums = false;
+  // If the float kernel multiplies the input weights with the inputs of all
+  // the time steps at once.
+  bool use_input_projection = false;
 
   bool recurrent_to_input_is_diag = false;
   bool recurrent_to_forget_is_diag = false;
@@ -407,6 +410,10 @@ enum TemporaryTensor {
   kNumTemporaryTensors = 12,
 };
 
+// The float kernel reuses the second temporary tensor for the precomputed
+// input projections.
+constexpr int kInputProjection = 1;
+
 void* Init(TfLiteContext* context, const char* buffer, size_t length) {
   auto* op_data = new OpData();
   context->AddTensors(context, kNumTemporaryTensors,
@@ -919,6 +926,8 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
           node->builtin_data);
   const bool time_major = params->time_major;
   const int n_batch = time_major ? input->dims->data[1] : input->dims->data[0];
+  const int max_time =
+      time_major ? input->dims->data[0] : input->dims->data[1];
   const int n_input = input->dims->data[2];
 
   const TfLiteTensor* input_to_output_weights;
@@ -990,7 +999,11 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
   } else if (is_integer) {
     node->temporaries = TfLiteIntArrayCreate(6);
   } else {
-    node->temporaries = TfLiteIntArrayCreate(1);
+    // A single frame gains nothing from precomputing its input projections.
+    op_data->use_input_projection =
+        input_to_output_weights->type == kTfLiteFloat32 && max_time > 1;
+    node->temporaries =
+        TfLiteIntArrayCreate(op_data->use_input_projection ? 2 : 1);
   }
   node->temporaries->data[kScratchBuffer] =
       scratch_tensor_index + kScratchBuffer;
@@ -1019,6 +1032,29 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
   TF_LITE_ENSURE_OK(context, context->ResizeTensor(context, scratch_buffer,
                                                    scratch_buffer_size));
 
+  if (op_data->use_input_projection) {
+    // Allocate a temporary tensor to store the products of the input weights
+    // of each gate with the inputs of all the time steps.
+    node->temporaries->data[kInputProjection] =
+        scratch_tensor_index + kInputProjection;
+    TfLiteTensor* input_projection;
+    TF_LITE_ENSURE_OK(context, GetTemporarySafe(context, node, kInputProjection,
+                                                &input_projection));
+    input_projection->type = kTfLiteFloat32;
+    input_projection->allocation_type = kTfLiteArenaRw;
+    const int num_gates = use_cifg ? 3 : 4;
+    int input_projection_dims[2] = {num_gates * max_time * n_batch, n_cell};
+    if (!TfLiteIntArrayEqualsArray(input_projection->dims, 2,
+                                   input_projection_dims)) {
+      TfLiteIntArray* input_projection_size = TfLiteIntArrayCreate(2);
+      input_projection_size->data[0] = input_projection_dims[0];
+      input_projection_size->data[1] = input_projection_dims[1];
+      TF_LITE_ENSURE_OK(context,
+                        context->ResizeTensor(context, input_projection,
+                                              input_projection_size));
+    }
+  }
+
   if (IsHybridOp(input, input_to_output_weights)) {
     op_data->compute_row_sums = true;
     // Allocate temporary tensors to store quantized values of input,
@@ -1366,6 +1402,12 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
       TfLiteTensor* scratch_buffer;
       TF_LITE_ENSURE_OK(context, GetTemporarySafe(context, node, kScratchBuffer,
                                                   &scratch_buffer));
+      TfLiteTensor* input_projection = nullptr;
+      if (op_data->use_input_projection) {
+        TF_LITE_ENSURE_OK(context,
+                          GetTemporarySafe(context, node, kInputProjection,
+                                           &input_projection));
+      }
       return lstm_eval::EvalFloat(
           input, input_to_input_weights, input_to_forget_weights,
           input_to_cell_weights, input_to_output_weights,
@@ -1392,7 +1434,7 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
           (recurrent_to_cell_weights->dims->size == 1),
           /*recurrent_to_output_is_diag=*/
           (recurrent_to_output_weights->dims->size == 1),
-          CpuBackendContext::GetFromContext(context));
+          CpuBackendContext::GetFromContext(context), input_projection);
     }
     case kTfLiteUInt8:
     case kTfLiteInt8: {
@@ -160,6 +160,9 @@ class SimpleMemoryArena {
 
   size_t GetBufferSize() const { return underlying_buffer_.GetSize(); }
 
+  // The size the buffer will have once the allocations are committed.
+  size_t GetRequiredBufferSize() const { return high_water_mark_; }
+
   std::intptr_t BasePointer() const {
     return reinterpret_cast<std::intptr_t>(underlying_buffer_.GetPtr());
   }
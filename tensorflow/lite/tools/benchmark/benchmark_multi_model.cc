@@ -0,0 +1,484 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/tools/benchmark/benchmark_multi_model.h"
+
+#include <stddef.h>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>  // NOLINT(build/c++11)
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>  // NOLINT(build/c++11)
+#include <random>
+#include <string>
+#include <thread>  // NOLINT(build/c++11)
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/util/stats_calculator.h"
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/profiling/time.h"
+#include "tensorflow/lite/tools/benchmark/benchmark_model.h"
+#include "tensorflow/lite/tools/benchmark/benchmark_params.h"
+#include "tensorflow/lite/tools/benchmark/benchmark_tflite_model.h"
+#include "tensorflow/lite/tools/benchmark/benchmark_utils.h"
+#include "tensorflow/lite/tools/command_line_flags.h"
+#include "tensorflow/lite/tools/logging.h"
+
+namespace tflite {
+namespace benchmark {
+namespace {
+
+struct RequestTiming {
+  int64_t arrival_us;
+  int64_t start_us;
+  int64_t end_us;
+};
+
+// The arrival times of the requests of a model, waiting for an interpreter.
+class RequestQueue {
+ public:
+  void Push(int64_t arrival_us) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      arrivals_.push_back(arrival_us);
+    }
+    cond_.notify_one();
+  }
+
+  // No more requests are pushed after `Close`.
+  void Close() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      closed_ = true;
+    }
+    cond_.notify_all();
+  }
+
+  // Waits for a request, and returns false once the queue is closed and
+  // empty.
+  bool Pop(int64_t* arrival_us) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cond_.wait(lock, [this] { return closed_ || !arrivals_.empty(); });
+    if (arrivals_.empty()) return false;
+    *arrival_us = arrivals_.front();
+    arrivals_.pop_front();
+    return true;
+  }
+
+ private:
+  std::mutex mutex_;
+  std::condition_variable cond_;
+  std::deque<int64_t> arrivals_;
+  bool closed_ = false;
+};
+
+// Returns the nearest-rank `percentile` of the sorted `values`.
+int64_t Percentile(const std::vector<int64_t>& values, int percentile) {
+  if (values.empty()) return 0;
+  const size_t rank = (values.size() * percentile + 99) / 100;
+  return values[std::max<size_t>(rank, 1) - 1];
+}
+
+double AverageServiceTime(const RequestTiming* begin,
+                          const RequestTiming* end) {
+  if (begin == end) return 0;
+  double sum = 0;
+  for (const RequestTiming* timing = begin; timing != end; ++timing) {
+    sum += timing->end_us - timing->start_us;
+  }
+  return sum / (end - begin);
+}
+
+}  // namespace
+
+// A `BenchmarkTfLiteModel` whose interpreter serves the requests of a model.
+class BenchmarkMultiModel::ServedInterpreter : public BenchmarkTfLiteModel {
+ public:
+  explicit ServedInterpreter(BenchmarkParams params)
+      : BenchmarkTfLiteModel(std::move(params)) {}
+
+  TfLiteStatus Prepare() {
+    TF_LITE_ENSURE_STATUS(BenchmarkTfLiteModel::ValidateParams());
+    TF_LITE_ENSURE_STATUS(Init());
+    return PrepareInputData();
+  }
+
+  TfLiteStatus Serve() {
+    TF_LITE_ENSURE_STATUS(ResetInputsAndOutputs());
+    return RunImpl();
+  }
+
+  int64_t ModelFileSize() { return MayGetModelFileSize(); }
+
+  // The timings of the requests served during the last regular run.
+  std::vector<RequestTiming> timings;
+};
+
+BenchmarkParams BenchmarkMultiModel::DefaultParams() {
+  BenchmarkParams default_params = BenchmarkTfLiteModel::DefaultParams();
+  default_params.AddParam("graphs", BenchmarkParam::Create<std::string>(""));
+  default_params.AddParam("model_mix", BenchmarkParam::Create<std::string>(""));
+  default_params.AddParam("num_interpreters_per_model",
+                          BenchmarkParam::Create<int32_t>(1));
+  default_params.AddParam("request_rate", BenchmarkParam::Create<float>(-1.0f));
+  default_params.AddParam("arrival_distribution",
+                          BenchmarkParam::Create<std::string>("poisson"));
+  return default_params;
+}
+
+BenchmarkMultiModel::BenchmarkMultiModel(BenchmarkParams params)
+    : BenchmarkTfLiteModel(std::move(params)) {}
+
+BenchmarkMultiModel::~BenchmarkMultiModel() = default;
+
+std::vector<Flag> BenchmarkMultiModel::GetFlags() {
+  std::vector<Flag> flags = BenchmarkTfLiteModel::GetFlags();
+  std::vector<Flag> specific_flags = {
+      CreateFlag<std::string>(
+          "graphs", &params_,
+          "comma-separated list of the TFLite models to serve concurrently. "
+          "The other flags of benchmark_model apply to all the interpreters."),
+      CreateFlag<std::string>(
+          "model_mix", &params_,
+          "comma-separated list of the relative shares of the requests sent "
+          "to each model of --graphs, e.g. '3,1'. By default, the models get "
+          "the same share. Only used with --request_rate."),
+      CreateFlag<int32_t>("num_interpreters_per_model", &params_,
+                          "number of interpreters serving the requests of "
+                          "each model concurrently, each on its own thread"),
+      CreateFlag<float>(
+          "request_rate", &params_,
+          "number of requests arriving per second, for all the models. If not "
+          "positive, each interpreter serves requests back to back."),
+      CreateFlag<std::string>(
+          "arrival_distribution", &params_,
+          "distribution of the times between two requests: 'poisson' for "
+          "exponentially distributed times, 'uniform' for a constant time.")};
+  flags.insert(flags.end(), specific_flags.begin(), specific_flags.end());
+  return flags;
+}
+
+void BenchmarkMultiModel::LogParams() {
+  BenchmarkTfLiteModel::LogParams();
+  const bool verbose = params_.Get<bool>("verbose");
+  LOG_BENCHMARK_PARAM(std::string, "graphs", "Graphs", /*verbose*/ true);
+  LOG_BENCHMARK_PARAM(std::string, "model_mix", "Model mix", verbose);
+  LOG_BENCHMARK_PARAM(int32_t, "num_interpreters_per_model",
+                      "Num interpreters per model", verbose);
+  LOG_BENCHMARK_PARAM(float, "request_rate", "Requests per second", verbose);
+  LOG_BENCHMARK_PARAM(std::string, "arrival_distribution",
+                      "Request arrival distribution", verbose);
+}
+
+TfLiteStatus BenchmarkMultiModel::ValidateParams() {
+  // --graph and the op profiling aren't used: the interpreters validate the
+  // parameters of `BenchmarkTfLiteModel`.
+  TF_LITE_ENSURE_STATUS(BenchmarkModel::ValidateParams());
+
+  graphs_.clear();
+  model_mix_.clear();
+  if (!util::SplitAndParse(params_.Get<std::string>("graphs"), ',',
+                           &graphs_) ||
+      graphs_.empty()) {
+    TFLITE_LOG(ERROR) << "Please specify the TF Lite models to serve with "
+                         "--graphs";
+    return kTfLiteError;
+  }
+  const std::string model_mix = params_.Get<std::string>("model_mix");
+  if (model_mix.empty()) {
+    model_mix_.assign(graphs_.size(), 1.0f);
+  } else if (!util::SplitAndParse(model_mix, ',', &model_mix_) ||
+             model_mix_.size() != graphs_.size() ||
+             std::any_of(model_mix_.begin(), model_mix_.end(),
+                         [](float share) { return share < 0; }) ||
+             std::all_of(model_mix_.begin(), model_mix_.end(),
+                         [](float share) { return share == 0; })) {
+    TFLITE_LOG(ERROR) << "--model_mix should have a non-negative share for "
+                         "each of the "
+                      << graphs_.size() << " models, but is '" << model_mix
+                      << "'.";
+    return kTfLiteError;
+  }
+  if (params_.Get<int32_t>("num_interpreters_per_model") < 1) {
+    TFLITE_LOG(ERROR) << "--num_interpreters_per_model should be positive.";
+    return kTfLiteError;
+  }
+  const std::string distribution =
+      params_.Get<std::string>("arrival_distribution");
+  if (distribution != "poisson" && distribution != "uniform") {
+    TFLITE_LOG(ERROR) << "--arrival_distribution should be 'poisson' or "
+                         "'uniform', but is '"
+                      << distribution << "'.";
+    return kTfLiteError;
+  }
+  return kTfLiteOk;
+}
+
+TfLiteStatus BenchmarkMultiModel::Init() {
+  // The interpreters are created again for each run, e.g. with other
+  // performance options.
+  interpreters_.clear();
+  const int num_interpreters_per_model =
+      params_.Get<int32_t>("num_interpreters_per_model");
+  for (const std::string& graph : graphs_) {
+    for (int i = 0; i < num_interpreters_per_model; ++i) {
+      BenchmarkParams params = BenchmarkTfLiteModel::DefaultParams();
+      params.Set(params_);
+      params.Set<std::string>("graph", graph);
+      auto interpreter = std::make_unique<ServedInterpreter>(std::move(params));
+      if (interpreter->Prepare() != kTfLiteOk) {
+        TFLITE_LOG(ERROR) << "Failed to create an interpreter for " << graph;
+        return kTfLiteError;
+      }
+      interpreters_.push_back(std::move(interpreter));
+    }
+  }
+  isolated_service_us_.assign(graphs_.size(), {});
+  model_stats_.clear();
+  throughput_per_second_ = 0;
+  return kTfLiteOk;
+}
+
+uint64_t BenchmarkMultiModel::ComputeInputBytes() {
+  // The average input size of a request.
+  const int num_interpreters_per_model =
+      params_.Get<int32_t>("num_interpreters_per_model");
+  double total_share = 0;
+  double input_bytes = 0;
+  for (int m = 0; m < graphs_.size(); ++m) {
+    total_share += model_mix_[m];
+    input_bytes +=
+        model_mix_[m] *
+        interpreters_[m * num_interpreters_per_model]->ComputeInputBytes();
+  }
+  return static_cast<uint64_t>(input_bytes / total_share);
+}
+
+int64_t BenchmarkMultiModel::MayGetModelFileSize() {
+  // Called before `Init`, the models are opened for their size only.
+  int64_t total_size = 0;
+  for (const std::string& graph : graphs_) {
+    BenchmarkParams params = BenchmarkTfLiteModel::DefaultParams();
+    params.Set<std::string>("graph", graph);
+    const int64_t size = ServedInterpreter(std::move(params)).ModelFileSize();
+    if (size < 0) return -1;
+    total_size += size;
+  }
+  return total_size;
+}
+
+TfLiteStatus BenchmarkMultiModel::RunImpl() {
+  for (auto& interpreter : interpreters_) {
+    TF_LITE_ENSURE_STATUS(interpreter->Serve());
+  }
+  return kTfLiteOk;
+}
+
+tensorflow::Stat<int64_t> BenchmarkMultiModel::Run(
+    int min_num_times, float min_secs, float max_secs, RunType run_type,
+    TfLiteStatus* invoke_status) {
+  if (run_type == WARMUP) {
+    return RunIsolated(min_num_times, min_secs, max_secs, invoke_status);
+  }
+  return RunConcurrently(min_num_times, min_secs, max_secs, invoke_status);
+}
+
+tensorflow::Stat<int64_t> BenchmarkMultiModel::RunIsolated(
+    int min_num_times, float min_secs, float max_secs,
+    TfLiteStatus* invoke_status) {
+  tensorflow::Stat<int64_t> run_stats;
+  TFLITE_LOG(INFO) << "Warming up the " << interpreters_.size()
+                   << " interpreters one at a time for at least "
+                   << min_num_times << " iterations and at least " << min_secs
+                   << " seconds but terminate if exceeding " << max_secs
+                   << " seconds.";
+  const int num_interpreters_per_model =
+      params_.Get<int32_t>("num_interpreters_per_model");
+  int64_t now_us = profiling::time::NowMicros();
+  const int64_t min_finish_us = now_us + static_cast<int64_t>(min_secs * 1.e6f);
+  const int64_t max_finish_us = now_us + static_cast<int64_t>(max_secs * 1.e6f);
+  *invoke_status = kTfLiteOk;
+  for (int run = 0; (run < min_num_times || now_us < min_finish_us) &&
+                    now_us <= max_finish_us;
+       run++) {
+    for (int i = 0; i < interpreters_.size(); ++i) {
+      const int64_t start_us = profiling::time::NowMicros();
+      TfLiteStatus status = interpreters_[i]->Serve();
+      if (status != kTfLiteOk) *invoke_status = status;
+      const int64_t service_us = profiling::time::NowMicros() - start_us;
+      run_stats.UpdateStat(service_us);
+      isolated_service_us_[i / num_interpreters_per_model].UpdateStat(
+          service_us);
+    }
+    now_us = profiling::time::NowMicros();
+  }
+  return run_stats;
+}
+
+tensorflow::Stat<int64_t> BenchmarkMultiModel::RunConcurrently(
+    int min_num_times, float min_secs, float max_secs,
+    TfLiteStatus* invoke_status) {
+  const int num_interpreters_per_model =
+      params_.Get<int32_t>("num_interpreters_per_model");
+  const float request_rate = params_.Get<float>("request_rate");
+  const bool closed_loop = request_rate <= 0;
+  TFLITE_LOG(INFO) << "Serving requests with " << interpreters_.size()
+                   << " concurrent interpreters for at least " << min_num_times
+                   << " requests and at least " << min_secs
+                   << " seconds but terminate if exceeding " << max_secs
+                   << " seconds.";
+
+  const int64_t begin_us = profiling::time::NowMicros();
+  const int64_t min_finish_us =
+      begin_us + static_cast<int64_t>(min_secs * 1.e6f);
+  const int64_t max_finish_us =
+      begin_us + static_cast<int64_t>(max_secs * 1.e6f);
+  auto keep_going = [&](int num_requests, int64_t now_us) {
+    return (num_requests < min_num_times || now_us < min_finish_us) &&
+           now_us <= max_finish_us;
+  };
+
+  std::vector<RequestQueue> queues(graphs_.size());
+  std::atomic<int> num_started_requests(0);
+  std::atomic<bool> failed(false);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < interpreters_.size(); ++i) {
+    ServedInterpreter* interpreter = interpreters_[i].get();
+    RequestQueue* queue = &queues[i / num_interpreters_per_model];
+    interpreter->timings.clear();
+    threads.emplace_back([&, interpreter, queue] {
+      auto serve = [&](int64_t arrival_us) {
+        const int64_t start_us = profiling::time::NowMicros();
+        if (interpreter->Serve() != kTfLiteOk) failed = true;
+        interpreter->timings.push_back(
+            {arrival_us, start_us,
+             static_cast<int64_t>(profiling::time::NowMicros())});
+      };
+      if (closed_loop) {
+        // The next request arrives as soon as the previous one is served.
+        while (keep_going(num_started_requests++,
+                          profiling::time::NowMicros())) {
+          serve(profiling::time::NowMicros());
+        }
+      } else {
+        int64_t arrival_us;
+        while (queue->Pop(&arrival_us)) serve(arrival_us);
+      }
+    });
+  }
+
+  if (!closed_loop) {
+    std::mt19937 random_engine(std::random_device{}());
+    std::discrete_distribution<int> choose_model(model_mix_.begin(),
+                                                 model_mix_.end());
+    std::exponential_distribution<double> poisson_gap_secs(request_rate);
+    const bool poisson =
+        params_.Get<std::string>("arrival_distribution") == "poisson";
+    // Requests are timed from their scheduled arrival, so that a late
+    // dispatch counts as queueing.
+    double arrival_us = begin_us;
+    for (int request = 0; keep_going(request, profiling::time::NowMicros());
+         ++request) {
+      util::SleepForSeconds((arrival_us - profiling::time::NowMicros()) * 1e-6);
+      queues[choose_model(random_engine)].Push(
+          static_cast<int64_t>(arrival_us));
+      const double gap_secs =
+          poisson ? poisson_gap_secs(random_engine) : 1.0 / request_rate;
+      arrival_us += 1e6 * gap_secs;
+    }
+    for (RequestQueue& queue : queues) queue.Close();
+  }
+  for (std::thread& thread : threads) thread.join();
+  const int64_t end_us = profiling::time::NowMicros();
+  *invoke_status = failed ? kTfLiteError : kTfLiteOk;
+
+  tensorflow::Stat<int64_t> run_stats;
+  model_stats_.assign(graphs_.size(), {});
+  int64_t num_requests = 0;
+  for (int m = 0; m < graphs_.size(); ++m) {
+    std::vector<RequestTiming> timings;
+    for (int i = 0; i < num_interpreters_per_model; ++i) {
+      const auto& served = interpreters_[m * num_interpreters_per_model + i];
+      timings.insert(timings.end(), served->timings.begin(),
+                     served->timings.end());
+    }
+    std::sort(timings.begin(), timings.end(),
+              [](const RequestTiming& a, const RequestTiming& b) {
+                return a.arrival_us < b.arrival_us;
+              });
+    ModelStats& stats = model_stats_[m];
+    stats.graph = graphs_[m];
+    stats.num_requests = timings.size();
+    if (!isolated_service_us_[m].empty()) {
+      stats.avg_isolated_service_us = isolated_service_us_[m].avg();
+    }
+    num_requests += timings.size();
+    if (timings.empty()) continue;
+    std::vector<int64_t> latencies;
+    double queueing_us = 0;
+    for (const RequestTiming& timing : timings) {
+      latencies.push_back(timing.end_us - timing.arrival_us);
+      run_stats.UpdateStat(latencies.back());
+      queueing_us += timing.start_us - timing.arrival_us;
+    }
+    std::sort(latencies.begin(), latencies.end());
+    stats.latency_p50_us = Percentile(latencies, 50);
+    stats.latency_p90_us = Percentile(latencies, 90);
+    stats.latency_p99_us = Percentile(latencies, 99);
+    stats.avg_queueing_us = queueing_us / timings.size();
+    const RequestTiming* first = timings.data();
+    const RequestTiming* last = first + timings.size();
+    stats.avg_service_us = AverageServiceTime(first, last);
+    const size_t tenth = std::max<size_t>(timings.size() / 10, 1);
+    const double early_service_us = AverageServiceTime(first, first + tenth);
+    if (early_service_us > 0) {
+      stats.service_drift =
+          AverageServiceTime(last - tenth, last) / early_service_us;
+    }
+  }
+  throughput_per_second_ =
+      end_us > begin_us ? num_requests * 1e6 / (end_us - begin_us) : 0;
+  LogModelStats();
+  return run_stats;
+}
+
+void BenchmarkMultiModel::LogModelStats() const {
+  for (const ModelStats& stats : model_stats_) {
+    const double slowdown =
+        stats.avg_isolated_service_us > 0
+            ? stats.avg_service_us / stats.avg_isolated_service_us
+            : 0;
+    TFLITE_LOG(INFO) << stats.graph << ": requests=" << stats.num_requests
+                     << " latency (us): p50=" << stats.latency_p50_us
+                     << " p90=" << stats.latency_p90_us
+                     << " p99=" << stats.latency_p99_us
+                     << " queueing (avg)=" << stats.avg_queueing_us
+                     << " service (avg)=" << stats.avg_service_us;
+    TFLITE_LOG(INFO) << stats.graph
+                     << ": contention slowdown=" << slowdown
+                     << " (isolated service (avg)="
+                     << stats.avg_isolated_service_us
+                     << " us), service drift=" << stats.service_drift;
+  }
+  TFLITE_LOG(INFO) << "Aggregate throughput: " << throughput_per_second_
+                   << " requests/s";
+}
+
+}  // namespace benchmark
+}  // namespace tflite
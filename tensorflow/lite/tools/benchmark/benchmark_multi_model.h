@@ -0,0 +1,129 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_TOOLS_BENCHMARK_BENCHMARK_MULTI_MODEL_H_
+#define TENSORFLOW_LITE_TOOLS_BENCHMARK_BENCHMARK_MULTI_MODEL_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/util/stats_calculator.h"
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/tools/benchmark/benchmark_model.h"
+#include "tensorflow/lite/tools/benchmark/benchmark_params.h"
+#include "tensorflow/lite/tools/benchmark/benchmark_tflite_model.h"
+#include "tensorflow/lite/tools/command_line_flags.h"
+
+namespace tflite {
+namespace benchmark {
+
+// Benchmarks a mix of TFLite models served concurrently, to reproduce the
+// conditions of production where several interpreters share the cores and
+// the memory of the device.
+//
+// Each model of --graphs is served by --num_interpreters_per_model
+// interpreters, each running on its own thread and created with the
+// parameters of `BenchmarkTfLiteModel` (threads, delegates, ...). Requests
+// arrive at --request_rate requests per second, with exponential
+// ("poisson") or constant ("uniform") inter-arrival times, are dispatched to
+// the models in the proportions of --model_mix, and are queued until an
+// interpreter of their model is available. Without a request rate, each
+// interpreter serves requests back to back.
+//
+// The warmup runs invoke the interpreters one at a time, giving the service
+// time of each model without contention. The regular runs then report for
+// each model the percentiles of the latency of the requests (queueing and
+// service time), and how much slower the interpreters are than during
+// warmup, as well as the aggregate throughput. The latency of all the
+// requests is reported to the listeners as the inference time, so that
+// `BenchmarkPerformanceOptions` can sweep the performance options of the
+// interpreters.
+class BenchmarkMultiModel : public BenchmarkTfLiteModel {
+ public:
+  // The statistics of the requests served for a model during the last run.
+  struct ModelStats {
+    std::string graph;
+    int64_t num_requests = 0;
+    // Percentiles of the time from the arrival of a request to the end of
+    // its invocation.
+    int64_t latency_p50_us = 0;
+    int64_t latency_p90_us = 0;
+    int64_t latency_p99_us = 0;
+    double avg_queueing_us = 0;
+    double avg_service_us = 0;
+    // The average invocation time of the interpreters during warmup, when
+    // they run one at a time.
+    double avg_isolated_service_us = 0;
+    // The average invocation time of the last tenth of the requests over the
+    // one of the first tenth, greater than 1 e.g. when the device throttles.
+    double service_drift = 1;
+  };
+
+  explicit BenchmarkMultiModel(BenchmarkParams params = DefaultParams());
+  ~BenchmarkMultiModel() override;
+
+  static BenchmarkParams DefaultParams();
+
+  std::vector<Flag> GetFlags() override;
+  void LogParams() override;
+  TfLiteStatus ValidateParams() override;
+  uint64_t ComputeInputBytes() override;
+  TfLiteStatus Init() override;
+  TfLiteStatus RunImpl() override;
+
+  const std::vector<ModelStats>& model_stats() const { return model_stats_; }
+  // The requests served per second during the last regular run.
+  double throughput_per_second() const { return throughput_per_second_; }
+
+  using BenchmarkTfLiteModel::Run;
+
+ protected:
+  TfLiteStatus PrepareInputData() override { return kTfLiteOk; }
+  TfLiteStatus ResetInputsAndOutputs() override { return kTfLiteOk; }
+  int64_t MayGetModelFileSize() override;
+
+  tensorflow::Stat<int64_t> Run(int min_num_times, float min_secs,
+                                float max_secs, RunType run_type,
+                                TfLiteStatus* invoke_status) override;
+
+ private:
+  class ServedInterpreter;
+
+  // Invokes the interpreters one at a time.
+  tensorflow::Stat<int64_t> RunIsolated(int min_num_times, float min_secs,
+                                        float max_secs,
+                                        TfLiteStatus* invoke_status);
+  // Invokes the interpreters concurrently, and computes `model_stats_`.
+  tensorflow::Stat<int64_t> RunConcurrently(int min_num_times, float min_secs,
+                                            float max_secs,
+                                            TfLiteStatus* invoke_status);
+  void LogModelStats() const;
+
+  std::vector<std::string> graphs_;
+  std::vector<float> model_mix_;
+  // The interpreters of the model `m` are the ones `m * n` to `m * n + n - 1`
+  // with `n` = --num_interpreters_per_model.
+  std::vector<std::unique_ptr<ServedInterpreter>> interpreters_;
+  std::vector<tensorflow::Stat<int64_t>> isolated_service_us_;
+  std::vector<ModelStats> model_stats_;
+  double throughput_per_second_ = 0;
+};
+
+}  // namespace benchmark
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_TOOLS_BENCHMARK_BENCHMARK_MULTI_MODEL_H_
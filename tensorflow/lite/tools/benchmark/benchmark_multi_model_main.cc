@@ -0,0 +1,46 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include <cstdlib>
+#include <cstring>
+
+#include "tensorflow/lite/tools/benchmark/benchmark_multi_model.h"
+#include "tensorflow/lite/tools/benchmark/benchmark_performance_options.h"
+#include "tensorflow/lite/tools/logging.h"
+
+namespace tflite {
+namespace benchmark {
+
+int Main(int argc, char** argv) {
+  TFLITE_LOG(INFO) << "STARTING!";
+  BenchmarkMultiModel benchmark;
+  // The performance options are swept only when they are listed, otherwise
+  // the interpreters are run once with the parameters given.
+  for (int i = 1; i < argc; ++i) {
+    if (strncmp(argv[i], "--perf_options_list", 19) == 0) {
+      BenchmarkPerformanceOptions all_options_benchmark(&benchmark);
+      all_options_benchmark.Run(argc, argv);
+      return EXIT_SUCCESS;
+    }
+  }
+  if (benchmark.Run(argc, argv) != kTfLiteOk) {
+    TFLITE_LOG(ERROR) << "Benchmarking failed.";
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
+}  // namespace benchmark
+}  // namespace tflite
+
+int main(int argc, char** argv) { return tflite::benchmark::Main(argc, argv); }
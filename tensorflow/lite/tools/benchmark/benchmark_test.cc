@@ -34,6 +34,7 @@ limitations under the License.
 #include "tensorflow/lite/interpreter.h"
 #include "tensorflow/lite/string_util.h"
 #include "tensorflow/lite/testing/util.h"
+#include "tensorflow/lite/tools/benchmark/benchmark_multi_model.h"
 #include "tensorflow/lite/tools/benchmark/benchmark_performance_options.h"
 #include "tensorflow/lite/tools/benchmark/benchmark_tflite_model.h"
 #include "tensorflow/lite/tools/command_line_flags.h"
@@ -546,6 +547,56 @@ TEST(BenchmarkTest, RunWithUseCaching) {
   EXPECT_EQ(kTfLiteOk, status);
 }
 
+BenchmarkParams CreateMultiModelParams() {
+  BenchmarkParams params = BenchmarkMultiModel::DefaultParams();
+  params.Set<int32_t>("num_runs", 20);
+  params.Set<float>("min_secs", 0.0f);
+  params.Set<float>("max_secs", 150.0f);
+  params.Set<std::string>("graphs",
+                          *g_fp32_model_path + "," + *g_int8_model_path);
+  params.Set<int32_t>("num_interpreters_per_model", 2);
+  return params;
+}
+
+TEST(BenchmarkTest, MultiModelServesEachModel) {
+  ASSERT_THAT(g_fp32_model_path, testing::NotNull());
+  ASSERT_THAT(g_int8_model_path, testing::NotNull());
+
+  BenchmarkMultiModel benchmark(CreateMultiModelParams());
+  ScopedCommandlineArgs scoped_argv(
+      {"--request_rate=1000", "--model_mix=3,1"});
+  EXPECT_EQ(kTfLiteOk, benchmark.Run(scoped_argv.argc(), scoped_argv.argv()));
+
+  ASSERT_EQ(benchmark.model_stats().size(), 2);
+  for (const BenchmarkMultiModel::ModelStats& stats : benchmark.model_stats()) {
+    EXPECT_GT(stats.num_requests, 0);
+    EXPECT_LE(stats.latency_p50_us, stats.latency_p90_us);
+    EXPECT_LE(stats.latency_p90_us, stats.latency_p99_us);
+  }
+  EXPECT_EQ(benchmark.model_stats()[0].graph, *g_fp32_model_path);
+  EXPECT_GT(benchmark.throughput_per_second(), 0);
+}
+
+TEST(BenchmarkTest, MultiModelWithInvalidModelMixFails) {
+  ASSERT_THAT(g_fp32_model_path, testing::NotNull());
+  ASSERT_THAT(g_int8_model_path, testing::NotNull());
+
+  BenchmarkMultiModel benchmark(CreateMultiModelParams());
+  ScopedCommandlineArgs scoped_argv({"--model_mix=1"});
+  EXPECT_EQ(kTfLiteError,
+            benchmark.Run(scoped_argv.argc(), scoped_argv.argv()));
+}
+
+TEST(BenchmarkTest, DoesntCrashMultiModelPerfOptions) {
+  ASSERT_THAT(g_fp32_model_path, testing::NotNull());
+  ASSERT_THAT(g_int8_model_path, testing::NotNull());
+
+  BenchmarkMultiModel benchmark(CreateMultiModelParams());
+  BenchmarkPerformanceOptions all_options_benchmark(&benchmark);
+  ScopedCommandlineArgs scoped_argv({"--perf_options_list=cpu"});
+  all_options_benchmark.Run(scoped_argv.argc(), scoped_argv.argv());
+}
+
 class MaxDurationWorksTestListener : public BenchmarkListener {
   void OnBenchmarkEnd(const BenchmarkResults& results) override {
     const int64_t num_actual_runs = results.inference_time_us().count();
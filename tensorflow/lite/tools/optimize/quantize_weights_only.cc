@@ -0,0 +1,294 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/tools/optimize/quantize_weights_only.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "flatbuffers/flatbuffer_builder.h"  // from @flatbuffers
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/str_join.h"
+#include "tensorflow/lite/c/c_api_types.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+#include "tensorflow/lite/schema/schema_utils.h"
+#include "tensorflow/lite/tools/optimize/quantization_utils.h"
+
+namespace tflite {
+namespace optimize {
+
+namespace {
+
+struct Consumer {
+  OperatorT* op;
+  BuiltinOperator builtin_code;
+  // The index of the tensor among the inputs of the op.
+  int input_index;
+};
+
+// Returns the index of the input of the operators `builtin_code` whose
+// weights are quantized to `type`, or -1 if their weights are kept in float.
+int GetWeightsInputIndex(BuiltinOperator builtin_code, WeightOnlyType type) {
+  switch (builtin_code) {
+    case BuiltinOperator_FULLY_CONNECTED:
+      return 1;
+    case BuiltinOperator_CONV_2D:
+      // Only FULLY_CONNECTED has hybrid kernels for int4 weights.
+      return type == WeightOnlyType::kInt8 ? 1 : -1;
+    default:
+      return -1;
+  }
+}
+
+bool IsFloatTensor(const SubGraphT* subgraph, int tensor_index) {
+  return tensor_index >= 0 && tensor_index < subgraph->tensors.size() &&
+         subgraph->tensors[tensor_index]->type == TensorType_FLOAT32;
+}
+
+// Returns whether the weights `tensor_index` read by `consumers` can be
+// quantized. `buffer_uses` is the number of tensors of the model using each
+// buffer.
+bool IsQuantizableWeight(const ModelT* model, const SubGraphT* subgraph,
+                         int tensor_index,
+                         const std::vector<Consumer>& consumers,
+                         const std::vector<int>& buffer_uses,
+                         const WeightOnlyQuantizationOptions& options) {
+  const TensorT* tensor = subgraph->tensors[tensor_index].get();
+  if (tensor->type != TensorType_FLOAT32 || tensor->shape.size() < 2 ||
+      tensor->buffer <= 0 || tensor->buffer >= model->buffers.size() ||
+      buffer_uses[tensor->buffer] != 1) {
+    return false;
+  }
+  uint64_t num_elements;
+  if (utils::NumElements(*tensor, &num_elements) != kTfLiteOk ||
+      num_elements < options.weights_min_num_elements ||
+      model->buffers[tensor->buffer]->data.size() !=
+          num_elements * sizeof(float)) {
+    return false;
+  }
+  if (std::find(subgraph->outputs.begin(), subgraph->outputs.end(),
+                tensor_index) != subgraph->outputs.end()) {
+    return false;
+  }
+  // The weights are read by the hybrid kernels only, which dequantize the
+  // outputs of the products to float.
+  for (const Consumer& consumer : consumers) {
+    if (consumer.input_index !=
+            GetWeightsInputIndex(consumer.builtin_code, options.type) ||
+        !IsFloatTensor(subgraph, consumer.op->inputs[0]) ||
+        consumer.op->outputs.empty() ||
+        !IsFloatTensor(subgraph, consumer.op->outputs[0])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Quantizes `tensor` symmetrically along its first dimension, its output
+// channels, and computes the error of the quantization.
+absl::Status QuantizeWeight(ModelT* model, TensorT* tensor,
+                            WeightOnlyType type,
+                            WeightQuantizationError* error) {
+  const std::vector<uint8_t>& buffer = model->buffers[tensor->buffer]->data;
+  const float* weights = reinterpret_cast<const float*>(buffer.data());
+  const int num_elements = buffer.size() / sizeof(float);
+  const int num_channels = tensor->shape[0];
+  if (num_channels <= 0 || num_elements % num_channels != 0) {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Invalid shape of the weights %s", tensor->name));
+  }
+  const int channel_size = num_elements / num_channels;
+  const int max_value = type == WeightOnlyType::kInt4 ? 7 : 127;
+
+  std::vector<float> scales(num_channels);
+  std::vector<int8_t> quantized(num_elements);
+  error->channel_max_abs_error.assign(num_channels, 0);
+  double sum_squared_weights = 0;
+  double sum_squared_errors = 0;
+  for (int c = 0; c < num_channels; ++c) {
+    const float* channel = weights + c * channel_size;
+    float half_range = 0;
+    for (int i = 0; i < channel_size; ++i) {
+      half_range = std::max(half_range, std::abs(channel[i]));
+    }
+    scales[c] = half_range / max_value;
+    const float scale_inv = half_range == 0 ? 0 : max_value / half_range;
+    for (int i = 0; i < channel_size; ++i) {
+      const int value = static_cast<int>(std::round(channel[i] * scale_inv));
+      const int8_t q = std::min(max_value, std::max(-max_value, value));
+      quantized[c * channel_size + i] = q;
+      const float abs_error = std::abs(channel[i] - q * scales[c]);
+      error->channel_max_abs_error[c] =
+          std::max(error->channel_max_abs_error[c], abs_error);
+      sum_squared_weights += channel[i] * channel[i];
+      sum_squared_errors += abs_error * abs_error;
+    }
+    error->max_abs_error =
+        std::max(error->max_abs_error, error->channel_max_abs_error[c]);
+  }
+  error->rms_error = std::sqrt(sum_squared_errors / num_elements);
+  error->sqnr_db =
+      sum_squared_errors == 0
+          ? std::numeric_limits<float>::infinity()
+          : 10 * std::log10(sum_squared_weights / sum_squared_errors);
+
+  std::vector<uint8_t> data;
+  TensorType output_type;
+  if (type == WeightOnlyType::kInt4) {
+    // Two values per byte, the first one in the low nibble.
+    data.assign((num_elements + 1) / 2, 0);
+    for (int i = 0; i < num_elements; ++i) {
+      const uint8_t nibble = static_cast<uint8_t>(quantized[i]) & 0x0F;
+      data[i / 2] |= i % 2 == 0 ? nibble : nibble << 4;
+    }
+    output_type = TensorType_INT4;
+  } else {
+    data.assign(quantized.begin(), quantized.end());
+    output_type = TensorType_INT8;
+  }
+  error->tensor_name = tensor->name;
+  error->type = output_type;
+  if (utils::AddQuantizationParams(
+          scales, std::vector<int64_t>(num_channels, 0),
+          /*quantized_dimension=*/0, data.data(), data.size(), output_type,
+          model, tensor, /*error_reporter=*/nullptr) != kTfLiteOk) {
+    return absl::InternalError("AddQuantizationParams failed");
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace
+
+absl::Status QuantizeWeightsOnly(flatbuffers::FlatBufferBuilder* builder,
+                                 const Model* input_model,
+                                 const WeightOnlyQuantizationOptions& options,
+                                 std::vector<WeightQuantizationError>* report) {
+  std::unique_ptr<ModelT> model(input_model->UnPack());
+  if (report != nullptr) report->clear();
+
+  // A buffer shared with another tensor is kept in float for the other one.
+  std::vector<int> buffer_uses(model->buffers.size());
+  for (const std::unique_ptr<SubGraphT>& subgraph : model->subgraphs) {
+    for (const std::unique_ptr<TensorT>& tensor : subgraph->tensors) {
+      if (tensor->buffer < buffer_uses.size()) ++buffer_uses[tensor->buffer];
+    }
+  }
+
+  bool quantized_fully_connected = false;
+  bool quantized_conv_2d = false;
+  for (int subgraph_index = 0; subgraph_index < model->subgraphs.size();
+       ++subgraph_index) {
+    SubGraphT* subgraph = model->subgraphs[subgraph_index].get();
+
+    // The tensors in the order of their first use, to quantize the weights
+    // deterministically.
+    std::vector<int> tensors;
+    absl::flat_hash_map<int, std::vector<Consumer>> consumers;
+    for (const std::unique_ptr<OperatorT>& op : subgraph->operators) {
+      const BuiltinOperator builtin_code =
+          GetBuiltinCode(model->operator_codes[op->opcode_index].get());
+      for (int i = 0; i < op->inputs.size(); ++i) {
+        const int tensor_index = op->inputs[i];
+        if (tensor_index < 0) continue;
+        std::vector<Consumer>& tensor_consumers = consumers[tensor_index];
+        if (tensor_consumers.empty()) tensors.push_back(tensor_index);
+        tensor_consumers.push_back({op.get(), builtin_code, i});
+      }
+    }
+
+    for (int tensor_index : tensors) {
+      const std::vector<Consumer>& tensor_consumers = consumers[tensor_index];
+      if (!IsQuantizableWeight(model.get(), subgraph, tensor_index,
+                               tensor_consumers, buffer_uses, options)) {
+        continue;
+      }
+      WeightQuantizationError error;
+      error.subgraph_index = subgraph_index;
+      absl::Status status =
+          QuantizeWeight(model.get(), subgraph->tensors[tensor_index].get(),
+                         options.type, &error);
+      if (!status.ok()) return status;
+
+      for (const Consumer& consumer : tensor_consumers) {
+        error.consumers.push_back(
+            EnumNameBuiltinOperator(consumer.builtin_code));
+        if (consumer.builtin_code == BuiltinOperator_FULLY_CONNECTED) {
+          // Use the updated hybrid scheme, as `QuantizeWeights` does.
+          if (FullyConnectedOptionsT* fully_connected_options =
+                  consumer.op->builtin_options.AsFullyConnectedOptions()) {
+            fully_connected_options->asymmetric_quantize_inputs = true;
+          }
+          quantized_fully_connected = true;
+        } else {
+          quantized_conv_2d = true;
+        }
+      }
+      if (report != nullptr) report->push_back(std::move(error));
+    }
+  }
+
+  // The first versions of the hybrid kernels with per channel weights.
+  for (std::unique_ptr<OperatorCodeT>& op_code : model->operator_codes) {
+    const BuiltinOperator builtin_code = GetBuiltinCode(op_code.get());
+    if (builtin_code == BuiltinOperator_FULLY_CONNECTED &&
+        quantized_fully_connected) {
+      op_code->version = std::max(op_code->version, 12);
+    } else if (builtin_code == BuiltinOperator_CONV_2D && quantized_conv_2d) {
+      op_code->version = std::max(op_code->version, 5);
+    }
+  }
+
+  flatbuffers::Offset<Model> output_model_location =
+      Model::Pack(*builder, model.get());
+  FinishModelBuffer(*builder, output_model_location);
+  return absl::OkStatus();
+}
+
+std::string FormatWeightQuantizationReport(
+    const std::vector<WeightQuantizationError>& report) {
+  std::vector<const WeightQuantizationError*> errors;
+  for (const WeightQuantizationError& error : report) errors.push_back(&error);
+  std::stable_sort(errors.begin(), errors.end(),
+                   [](const WeightQuantizationError* a,
+                      const WeightQuantizationError* b) {
+                     return a->sqnr_db < b->sqnr_db;
+                   });
+
+  std::string table = absl::StrFormat(
+      "%-40s %-5s %-20s %12s %12s %9s %14s\n", "tensor", "type", "consumers",
+      "max_abs_err", "rms_err", "sqnr_db", "worst_channel");
+  for (const WeightQuantizationError* error : errors) {
+    const auto worst_channel =
+        std::max_element(error->channel_max_abs_error.begin(),
+                         error->channel_max_abs_error.end());
+    absl::StrAppendFormat(
+        &table, "%-40s %-5s %-20s %12.6g %12.6g %9.2f %14d\n",
+        error->tensor_name, EnumNameTensorType(error->type),
+        absl::StrJoin(error->consumers, ","), error->max_abs_error,
+        error->rms_error, error->sqnr_db,
+        worst_channel - error->channel_max_abs_error.begin());
+  }
+  return table;
+}
+
+}  // namespace optimize
+}  // namespace tflite
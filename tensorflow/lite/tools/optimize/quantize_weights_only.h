@@ -0,0 +1,80 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_TOOLS_OPTIMIZE_QUANTIZE_WEIGHTS_ONLY_H_
+#define TENSORFLOW_LITE_TOOLS_OPTIMIZE_QUANTIZE_WEIGHTS_ONLY_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "flatbuffers/flatbuffer_builder.h"  // from @flatbuffers
+#include "absl/status/status.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+namespace tflite {
+namespace optimize {
+
+// The type of the weights quantized by `QuantizeWeightsOnly`.
+enum class WeightOnlyType { kInt8, kInt4 };
+
+struct WeightOnlyQuantizationOptions {
+  WeightOnlyType type = WeightOnlyType::kInt4;
+  // Weights with fewer elements are kept in float.
+  uint64_t weights_min_num_elements = 1024;
+};
+
+// The error of the quantization of a weight tensor, computed from its float
+// values and its dequantized values.
+struct WeightQuantizationError {
+  int subgraph_index = 0;
+  std::string tensor_name;
+  // The operators reading the tensor, e.g. "FULLY_CONNECTED".
+  std::vector<std::string> consumers;
+  TensorType type = TensorType_INT8;
+  float max_abs_error = 0;
+  float rms_error = 0;
+  // The signal to quantization noise ratio, in dB.
+  float sqnr_db = 0;
+  // The maximum absolute error of each output channel.
+  std::vector<float> channel_max_abs_error;
+};
+
+// Quantizes the weights of a float model without calibration data: the
+// weights of the FULLY_CONNECTED operators (and of the CONV_2D operators for
+// int8) are quantized symmetrically per output channel, while the activations
+// stay in float and are quantized on the fly by the hybrid kernels.
+//
+// The int4 weights are packed two per byte, the layout read by the 4-bit
+// FULLY_CONNECTED kernels. The weights read by other operators, or outputs of
+// a subgraph, are kept in float.
+//
+// If `report` isn't null, it receives the error of each quantized weight
+// tensor, to find the layers whose accuracy suffers from the quantization.
+//
+// WARNING: This is an experimental API and subject to change.
+absl::Status QuantizeWeightsOnly(flatbuffers::FlatBufferBuilder* builder,
+                                 const Model* input_model,
+                                 const WeightOnlyQuantizationOptions& options,
+                                 std::vector<WeightQuantizationError>* report);
+
+// Formats `report` as a table with a line per weight tensor, sorted by
+// decreasing relative error.
+std::string FormatWeightQuantizationReport(
+    const std::vector<WeightQuantizationError>& report);
+
+}  // namespace optimize
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_TOOLS_OPTIMIZE_QUANTIZE_WEIGHTS_ONLY_H_
@@ -0,0 +1,72 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "flatbuffers/flatbuffer_builder.h"  // from @flatbuffers
+#include "absl/status/status.h"
+#include "tensorflow/lite/core/model_builder.h"
+#include "tensorflow/lite/tools/optimize/model_utils.h"
+#include "tensorflow/lite/tools/optimize/quantize_weights_only.h"
+
+// Quantizes the weights of a float model to int4 or int8 without calibration
+// data, and prints the quantization error of each weight tensor.
+//
+// Note: This is a private API, subject to change.
+int main(int argc, char** argv) {
+  if (argc < 4 || argc > 5) {
+    printf(
+        "Wrong number of arguments. Example: quantize_weights_only_main "
+        "${input} ${output} ${int4|int8} [${weights_min_num_elements}]\n");
+    return 1;
+  }
+
+  tflite::optimize::WeightOnlyQuantizationOptions options;
+  const std::string type = argv[3];
+  if (type == "int4") {
+    options.type = tflite::optimize::WeightOnlyType::kInt4;
+  } else if (type == "int8") {
+    options.type = tflite::optimize::WeightOnlyType::kInt8;
+  } else {
+    printf("Only supports int4 and int8 weights\n");
+    return 1;
+  }
+  if (argc == 5) options.weights_min_num_elements = std::atoll(argv[4]);
+
+  std::unique_ptr<tflite::FlatBufferModel> model =
+      tflite::FlatBufferModel::BuildFromFile(argv[1]);
+  if (!model) {
+    printf("Failed to read the model %s\n", argv[1]);
+    return 1;
+  }
+  flatbuffers::FlatBufferBuilder builder;
+  std::vector<tflite::optimize::WeightQuantizationError> report;
+  const absl::Status status = tflite::optimize::QuantizeWeightsOnly(
+      &builder, model->GetModel(), options, &report);
+  if (!status.ok()) {
+    printf("Failed to quantize the model: %s\n",
+           std::string(status.message()).c_str());
+    return 1;
+  }
+  tflite::optimize::utils::WriteFile(argv[2], builder.GetBufferPointer(),
+                                     builder.GetSize());
+  const std::string table =
+      tflite::optimize::FormatWeightQuantizationReport(report);
+  printf("%s", table.c_str());
+  return 0;
+}
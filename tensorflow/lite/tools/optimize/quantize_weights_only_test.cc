@@ -0,0 +1,267 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/tools/optimize/quantize_weights_only.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "flatbuffers/flatbuffer_builder.h"  // from @flatbuffers
+#include "tensorflow/lite/schema/schema_generated.h"
+#include "tensorflow/lite/schema/schema_utils.h"
+
+namespace tflite {
+namespace optimize {
+namespace {
+
+constexpr int kNumChannels = 8;
+constexpr int kChannelSize = 32;
+
+int AddTensor(ModelT* model, const std::string& name,
+              const std::vector<int32_t>& shape,
+              const std::vector<float>& data = {}) {
+  SubGraphT* subgraph = model->subgraphs[0].get();
+  auto tensor = std::make_unique<TensorT>();
+  tensor->name = name;
+  tensor->shape = shape;
+  tensor->type = TensorType_FLOAT32;
+  if (!data.empty()) {
+    auto buffer = std::make_unique<BufferT>();
+    buffer->data.resize(data.size() * sizeof(float));
+    std::memcpy(buffer->data.data(), data.data(), buffer->data.size());
+    tensor->buffer = model->buffers.size();
+    model->buffers.push_back(std::move(buffer));
+  }
+  subgraph->tensors.push_back(std::move(tensor));
+  return subgraph->tensors.size() - 1;
+}
+
+void AddOperator(ModelT* model, BuiltinOperator builtin_code,
+                 const std::vector<int32_t>& inputs,
+                 const std::vector<int32_t>& outputs) {
+  int opcode_index = 0;
+  while (opcode_index < model->operator_codes.size() &&
+         GetBuiltinCode(model->operator_codes[opcode_index].get()) !=
+             builtin_code) {
+    ++opcode_index;
+  }
+  if (opcode_index == model->operator_codes.size()) {
+    auto op_code = std::make_unique<OperatorCodeT>();
+    op_code->builtin_code = builtin_code;
+    op_code->deprecated_builtin_code =
+        static_cast<int8_t>(std::min<int>(builtin_code, 127));
+    op_code->version = 1;
+    model->operator_codes.push_back(std::move(op_code));
+  }
+  auto op = std::make_unique<OperatorT>();
+  op->opcode_index = opcode_index;
+  op->inputs = inputs;
+  op->outputs = outputs;
+  if (builtin_code == BuiltinOperator_FULLY_CONNECTED) {
+    op->builtin_options.Set(FullyConnectedOptionsT());
+  } else if (builtin_code == BuiltinOperator_CONV_2D) {
+    Conv2DOptionsT options;
+    options.stride_w = 1;
+    options.stride_h = 1;
+    op->builtin_options.Set(std::move(options));
+  } else if (builtin_code == BuiltinOperator_ADD) {
+    op->builtin_options.Set(AddOptionsT());
+  }
+  model->subgraphs[0]->operators.push_back(std::move(op));
+}
+
+std::unique_ptr<ModelT> CreateEmptyModel() {
+  auto model = std::make_unique<ModelT>();
+  model->version = 3;
+  model->buffers.push_back(std::make_unique<BufferT>());
+  model->subgraphs.push_back(std::make_unique<SubGraphT>());
+  return model;
+}
+
+std::vector<float> CreateWeights(int size) {
+  std::vector<float> weights(size);
+  for (int i = 0; i < size; ++i) {
+    // Channels of different ranges.
+    weights[i] = std::sin(i * 0.37f) * (1 + i / kChannelSize);
+  }
+  return weights;
+}
+
+// Returns a model computing a FULLY_CONNECTED of float weights
+// [kNumChannels, kChannelSize].
+std::unique_ptr<ModelT> CreateFullyConnectedModel(
+    const std::vector<float>& weights) {
+  std::unique_ptr<ModelT> model = CreateEmptyModel();
+  const int input = AddTensor(model.get(), "input", {1, kChannelSize});
+  const int filter = AddTensor(model.get(), "filter",
+                               {kNumChannels, kChannelSize}, weights);
+  const int bias = AddTensor(model.get(), "bias", {kNumChannels},
+                             std::vector<float>(kNumChannels, 0.5f));
+  const int output = AddTensor(model.get(), "output", {1, kNumChannels});
+  AddOperator(model.get(), BuiltinOperator_FULLY_CONNECTED,
+              {input, filter, bias}, {output});
+  model->subgraphs[0]->inputs = {input};
+  model->subgraphs[0]->outputs = {output};
+  return model;
+}
+
+std::unique_ptr<ModelT> Quantize(
+    const ModelT& float_model, const WeightOnlyQuantizationOptions& options,
+    std::vector<WeightQuantizationError>* report) {
+  flatbuffers::FlatBufferBuilder float_builder;
+  FinishModelBuffer(float_builder, Model::Pack(float_builder, &float_model));
+  flatbuffers::FlatBufferBuilder builder;
+  EXPECT_TRUE(QuantizeWeightsOnly(&builder,
+                                  GetModel(float_builder.GetBufferPointer()),
+                                  options, report)
+                  .ok());
+  return std::unique_ptr<ModelT>(
+      GetModel(builder.GetBufferPointer())->UnPack());
+}
+
+TEST(QuantizeWeightsOnlyTest, PacksFullyConnectedWeightsToInt4PerChannel) {
+  const std::vector<float> weights =
+      CreateWeights(kNumChannels * kChannelSize);
+  WeightOnlyQuantizationOptions options;
+  options.type = WeightOnlyType::kInt4;
+  options.weights_min_num_elements = 0;
+  std::vector<WeightQuantizationError> report;
+  std::unique_ptr<ModelT> model =
+      Quantize(*CreateFullyConnectedModel(weights), options, &report);
+
+  const SubGraphT* subgraph = model->subgraphs[0].get();
+  const TensorT* filter = subgraph->tensors[1].get();
+  ASSERT_EQ(filter->type, TensorType_INT4);
+  ASSERT_EQ(filter->quantization->scale.size(), kNumChannels);
+  EXPECT_EQ(filter->quantization->quantized_dimension, 0);
+  EXPECT_THAT(filter->quantization->zero_point, testing::Each(0));
+  const std::vector<uint8_t>& data = model->buffers[filter->buffer]->data;
+  ASSERT_EQ(data.size(), kNumChannels * kChannelSize / 2);
+
+  // The bias and the activations stay in float.
+  EXPECT_EQ(subgraph->tensors[0]->type, TensorType_FLOAT32);
+  EXPECT_EQ(subgraph->tensors[2]->type, TensorType_FLOAT32);
+  EXPECT_TRUE(subgraph->operators[0]
+                  ->builtin_options.AsFullyConnectedOptions()
+                  ->asymmetric_quantize_inputs);
+  EXPECT_GE(model->operator_codes[0]->version, 12);
+
+  float max_abs_error = 0;
+  for (int c = 0; c < kNumChannels; ++c) {
+    const float scale = filter->quantization->scale[c];
+    for (int i = 0; i < kChannelSize; ++i) {
+      const int index = c * kChannelSize + i;
+      const int8_t q = index % 2 == 0
+                           ? static_cast<int8_t>(data[index / 2] << 4) >> 4
+                           : static_cast<int8_t>(data[index / 2]) >> 4;
+      EXPECT_LE(std::abs(q), 7);
+      EXPECT_NEAR(q * scale, weights[index], scale / 2 + 1e-6);
+      max_abs_error =
+          std::max(max_abs_error, std::abs(q * scale - weights[index]));
+    }
+  }
+
+  ASSERT_EQ(report.size(), 1);
+  EXPECT_EQ(report[0].tensor_name, "filter");
+  EXPECT_EQ(report[0].type, TensorType_INT4);
+  EXPECT_THAT(report[0].consumers, testing::ElementsAre("FULLY_CONNECTED"));
+  EXPECT_NEAR(report[0].max_abs_error, max_abs_error, 1e-6);
+  EXPECT_EQ(report[0].channel_max_abs_error.size(), kNumChannels);
+  EXPECT_GT(report[0].rms_error, 0);
+  EXPECT_GT(report[0].sqnr_db, 10);
+}
+
+TEST(QuantizeWeightsOnlyTest, QuantizesConvWeightsToInt8Only) {
+  std::unique_ptr<ModelT> float_model = CreateEmptyModel();
+  const int input = AddTensor(float_model.get(), "input", {1, 4, 4, 8});
+  const int filter =
+      AddTensor(float_model.get(), "filter", {kNumChannels, 1, 1, 8},
+                CreateWeights(kNumChannels * 8));
+  const int output = AddTensor(float_model.get(), "output", {1, 4, 4, 8});
+  AddOperator(float_model.get(), BuiltinOperator_CONV_2D,
+              {input, filter, -1}, {output});
+  float_model->subgraphs[0]->inputs = {input};
+  float_model->subgraphs[0]->outputs = {output};
+
+  WeightOnlyQuantizationOptions options;
+  options.weights_min_num_elements = 0;
+  options.type = WeightOnlyType::kInt4;
+  std::vector<WeightQuantizationError> report;
+  std::unique_ptr<ModelT> model = Quantize(*float_model, options, &report);
+  EXPECT_EQ(model->subgraphs[0]->tensors[filter]->type, TensorType_FLOAT32);
+  EXPECT_TRUE(report.empty());
+
+  options.type = WeightOnlyType::kInt8;
+  model = Quantize(*float_model, options, &report);
+  const TensorT* quantized_filter = model->subgraphs[0]->tensors[filter].get();
+  EXPECT_EQ(quantized_filter->type, TensorType_INT8);
+  EXPECT_EQ(quantized_filter->quantization->scale.size(), kNumChannels);
+  EXPECT_EQ(model->buffers[quantized_filter->buffer]->data.size(),
+            kNumChannels * 8);
+  EXPECT_GE(model->operator_codes[0]->version, 5);
+  ASSERT_EQ(report.size(), 1);
+  EXPECT_EQ(report[0].type, TensorType_INT8);
+}
+
+TEST(QuantizeWeightsOnlyTest, KeepsWeightsReadByOtherOperatorsInFloat) {
+  std::unique_ptr<ModelT> float_model =
+      CreateFullyConnectedModel(CreateWeights(kNumChannels * kChannelSize));
+  const int sum = AddTensor(float_model.get(), "sum",
+                            {kNumChannels, kChannelSize});
+  AddOperator(float_model.get(), BuiltinOperator_ADD, {1, 1}, {sum});
+  float_model->subgraphs[0]->outputs.push_back(sum);
+
+  WeightOnlyQuantizationOptions options;
+  options.weights_min_num_elements = 0;
+  std::vector<WeightQuantizationError> report;
+  std::unique_ptr<ModelT> model = Quantize(*float_model, options, &report);
+  EXPECT_EQ(model->subgraphs[0]->tensors[1]->type, TensorType_FLOAT32);
+  EXPECT_TRUE(report.empty());
+}
+
+TEST(QuantizeWeightsOnlyTest, KeepsSmallWeightsInFloat) {
+  // 256 weights, fewer than the default minimum.
+  std::unique_ptr<ModelT> model =
+      Quantize(*CreateFullyConnectedModel(
+                   CreateWeights(kNumChannels * kChannelSize)),
+               WeightOnlyQuantizationOptions(), /*report=*/nullptr);
+  EXPECT_EQ(model->subgraphs[0]->tensors[1]->type, TensorType_FLOAT32);
+}
+
+TEST(QuantizeWeightsOnlyTest, FormatsTheWorstWeightsFirst) {
+  WeightQuantizationError accurate;
+  accurate.tensor_name = "accurate";
+  accurate.sqnr_db = 40;
+  accurate.channel_max_abs_error = {0.1, 0.2};
+  WeightQuantizationError inaccurate;
+  inaccurate.tensor_name = "inaccurate";
+  inaccurate.sqnr_db = 12;
+  inaccurate.channel_max_abs_error = {0.1, 0.2};
+
+  const std::string table =
+      FormatWeightQuantizationReport({accurate, inaccurate});
+  EXPECT_LT(table.find("\ninaccurate "), table.find("\naccurate "));
+}
+
+}  // namespace
+}  // namespace optimize
+}  // namespace tflite
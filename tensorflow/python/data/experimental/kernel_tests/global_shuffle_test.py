@@ -137,6 +137,21 @@ class GlobalShuffleTest(test_base.DatasetTestBase, parameterized.TestCase):
     else:
       self.assertEqual(first_epoch, second_epoch)
 
+  @combinations.generate(
+      combinations.times(
+          test_base.default_test_combinations(),
+          combinations.combine(dataset_range=[1, 10, 100], block_size=[1, 8])))
+  def testBlockShuffle(self, dataset_range: int, block_size: int):
+    dataset = dataset_ops.Dataset.range(dataset_range)
+    dataset = global_shuffle_op._global_shuffle(
+        dataset, seed=42, block_size=block_size)
+    output = self.getDatasetOutput(dataset, requires_initialization=True)
+    self.assertCountEqual(output, list(range(dataset_range)))
+    # Consecutive outputs come from the same block until it is exhausted.
+    blocks = [x // block_size for x in output]
+    changes = sum(1 for a, b in zip(blocks, blocks[1:]) if a != b)
+    self.assertEqual(changes, len(set(blocks)) - 1)
+
   @combinations.generate(test_base.default_test_combinations())
   def testEmptyDataset(self):
     dataset = dataset_ops.Dataset.range(0)
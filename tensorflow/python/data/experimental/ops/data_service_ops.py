@@ -39,6 +39,7 @@ from tensorflow.python.saved_model import nested_structure_coder
 from tensorflow.python.util.tf_export import tf_export
 
 COMPRESSION_AUTO = "AUTO"
+COMPRESSION_COLUMNAR = "COLUMNAR"
 COMPRESSION_NONE = None
 _PARALLEL_EPOCHS = "parallel_epochs"
 _DISTRIBUTED_EPOCH = "distributed_epoch"
@@ -183,7 +184,9 @@ def _validate_job_name(job_name) -> None:
 
 
 def _validate_compression(compression) -> None:
-  valid_compressions = [COMPRESSION_AUTO, COMPRESSION_NONE]
+  valid_compressions = [
+      COMPRESSION_AUTO, COMPRESSION_COLUMNAR, COMPRESSION_NONE
+  ]
   if compression not in valid_compressions:
     raise ValueError(f"Invalid `compression` argument: {compression}. "
                      f"Must be one of {valid_compressions}.")
@@ -193,10 +196,13 @@ def _get_compression_proto(
     compression) -> data_service_pb2.DataServiceMetadata.Compression:
   if compression == COMPRESSION_AUTO:
     return data_service_pb2.DataServiceMetadata.COMPRESSION_SNAPPY
+  if compression == COMPRESSION_COLUMNAR:
+    return data_service_pb2.DataServiceMetadata.COMPRESSION_COLUMNAR
   if compression == COMPRESSION_NONE:
     return data_service_pb2.DataServiceMetadata.COMPRESSION_OFF
-  raise ValueError(f"Invalid `compression` argument: {compression}. "
-                   f"Must be one of {[COMPRESSION_AUTO, COMPRESSION_NONE]}.")
+  raise ValueError(
+      f"Invalid `compression` argument: {compression}. Must be one of "
+      f"{[COMPRESSION_AUTO, COMPRESSION_COLUMNAR, COMPRESSION_NONE]}.")
 
 
 def _to_tensor(dataset_id) -> tensor.Tensor:
@@ -492,7 +498,9 @@ def _distribute(
       at runtime.
     compression: How to compress the dataset's elements before transferring them
       over the network. "AUTO" leaves the decision of how to compress up to the
-      tf.data service runtime. `None` indicates not to compress.
+      tf.data service runtime. "COLUMNAR" compresses each component with a codec
+      chosen for its dtype, which suits numeric and categorical features.
+      `None` indicates not to compress.
     cross_trainer_cache: (Optional.) If a `CrossTrainerCache` object is
       provided, dataset iteration will be shared across concurrently running
       trainers. See
@@ -751,7 +759,9 @@ def distribute(
       at runtime.
     compression: How to compress the dataset's elements before transferring them
       over the network. "AUTO" leaves the decision of how to compress up to the
-      tf.data service runtime. `None` indicates not to compress.
+      tf.data service runtime. "COLUMNAR" compresses each component with a codec
+      chosen for its dtype, which suits numeric and categorical features.
+      `None` indicates not to compress.
     cross_trainer_cache: (Optional.) If a `CrossTrainerCache` object is
       provided, dataset iteration will be shared across concurrently running
       trainers. See
@@ -799,7 +809,9 @@ def _register_dataset(
     dataset: A `tf.data.Dataset` to register with the tf.data service.
     compression: How to compress the dataset's elements before transferring them
       over the network. "AUTO" leaves the decision of how to compress up to the
-      tf.data service runtime. `None` indicates not to compress.
+      tf.data service runtime. "COLUMNAR" compresses each component with a codec
+      chosen for its dtype, which suits numeric and categorical features.
+      `None` indicates not to compress.
     dataset_id: (Optional.) By default, tf.data service generates a unique
       (string) ID for each registered dataset. If a `dataset_id` is provided, it
       will use the specified ID. If a dataset with a matching ID already exists,
@@ -829,6 +841,10 @@ def _register_dataset(
     dataset = dataset.map(
         lambda *x: compression_ops.compress(x),
         num_parallel_calls=dataset_ops.AUTOTUNE)
+  elif compression == COMPRESSION_COLUMNAR:
+    dataset = dataset.map(
+        lambda *x: compression_ops.compress(x, codec="columnar"),
+        num_parallel_calls=dataset_ops.AUTOTUNE)
   dataset = dataset._apply_debug_options()  # pylint: disable=protected-access
 
   metadata = data_service_pb2.DataServiceMetadata(
@@ -885,8 +901,9 @@ def register_dataset(
     dataset: A `tf.data.Dataset` to register with the tf.data service.
     compression: (Optional.) How to compress the dataset's elements before
       transferring them over the network. "AUTO" leaves the decision of how to
-      compress up to the tf.data service runtime. `None` indicates not to
-      compress.
+      compress up to the tf.data service runtime. "COLUMNAR" compresses each
+      component with a codec chosen for its dtype, which suits numeric and
+      categorical features. `None` indicates not to compress.
     dataset_id: (Optional.) By default, tf.data service generates a unique
       (string) ID for each registered dataset. If a `dataset_id` is provided, it
       will use the specified ID. If a dataset with a matching ID already exists,
@@ -28,6 +28,7 @@ def _global_shuffle(  # pylint: disable=unused-private-name
     input_dataset: dataset_ops.DatasetV2,
     seed: Optional[Union[int, tensor.Tensor]] = None,
     reshuffle_each_iteration: bool = True,
+    block_size: int = 1,
     name: Optional[str] = None) -> dataset_ops.DatasetV2:
   """Globally shuffles the elements of `input_dataset`.
 
@@ -50,6 +51,12 @@ def _global_shuffle(  # pylint: disable=unused-private-name
     reshuffle_each_iteration: A boolean, which if True, indicates that a
       different shuffle order should be generated for each iteration of the
       dataset. (Defaults to `True`.)
+    block_size: If greater than 1, shuffles the order of blocks of
+      `block_size` consecutive elements and the order of the elements within
+      each block, instead of shuffling all elements. For file-based inputs
+      such as `TFRecordDataset`, consecutive elements are read from the same
+      file blocks, which makes reads mostly sequential at the cost of some
+      randomness. (Defaults to 1.)
     name: (Optional.) A name for the tf.data operation.
 
   Returns:
@@ -64,6 +71,7 @@ def _global_shuffle(  # pylint: disable=unused-private-name
       input_dataset,
       seed=seed,
       reshuffle_each_iteration=reshuffle_each_iteration,
+      block_size=block_size,
       name=name)
 
 
@@ -75,6 +83,7 @@ class _GlobalShuffleDataset(dataset_ops.UnaryUnchangedStructureDataset):
       input_dataset: dataset_ops.DatasetV2,
       seed: Optional[Union[int, tensor.Tensor]] = None,
       reshuffle_each_iteration: bool = True,
+      block_size: int = 1,
       name: Optional[str] = None):
 
     options = options_lib.Options()
@@ -87,6 +96,7 @@ class _GlobalShuffleDataset(dataset_ops.UnaryUnchangedStructureDataset):
     self._input_dataset = input_dataset
     self._seed, self._seed2 = random_seed.get_seed(seed)
     self._reshuffle_each_iteration = reshuffle_each_iteration
+    self._block_size = block_size
     self._name = name
     variant_tensor = ged_ops.global_shuffle_dataset(
         self._input_dataset._variant_tensor,  # pylint: disable=protected-access
@@ -94,5 +104,6 @@ class _GlobalShuffleDataset(dataset_ops.UnaryUnchangedStructureDataset):
         seed2=self._seed2,
         seed_generator=gen_dataset_ops.dummy_seed_generator(),
         reshuffle_each_iteration=self._reshuffle_each_iteration,
+        block_size=self._block_size,
         **self._common_args)
     super().__init__(input_dataset, variant_tensor)
@@ -84,6 +84,33 @@ class SampleFromDatasetsTest(test_base.DatasetTestBase, parameterized.TestCase):
 
       self.assertLess(self._chi2(probs, freqs / num_samples), 1e-2)
 
+  @combinations.generate(
+      combinations.times(test_base.default_test_combinations(),
+                         combinations.combine(weights=["list", None])))
+  def testSampleFromManyDatasets(self, weights):
+    # With many inputs and constant weights, inputs are selected using an alias
+    # table.
+    num_samples = 20000
+    classes = 300
+    probs = self._normalize(np.random.random_sample((classes,)) + 0.5)
+    if weights is None:
+      probs = np.full([classes], 1. / classes)
+    dataset = dataset_ops.Dataset.sample_from_datasets(
+        [dataset_ops.Dataset.from_tensors(i).repeat() for i in range(classes)],
+        None if weights is None else list(probs),
+        seed=1619)
+    dataset = dataset.take(num_samples)
+
+    next_element = self.getNext(dataset, requires_initialization=True)
+    freqs = np.zeros([classes])
+    for _ in range(num_samples):
+      freqs[self.evaluate(next_element())] += 1
+    with self.assertRaises(errors.OutOfRangeError):
+      self.evaluate(next_element())
+
+    # The expected chi-squared statistic is (classes - 1) / num_samples.
+    self.assertLess(self._chi2(probs, freqs / num_samples), 3e-2)
+
   @combinations.generate(
       combinations.times(test_base.default_test_combinations(),
                          _weights_type_combinations()))
@@ -505,12 +505,23 @@ class ThreadingOptions(options_lib.OptionsBase):
       "The value 0 can be used to indicate that the threadpool size should be "
       "determined at runtime based on the number of available CPU cores.")
 
+  numa_node = options_lib.create_option(
+      name="numa_node",
+      ty=int,
+      docstring=
+      "If set, the dataset threads are pinned to the given NUMA node, and the "
+      "dataset buffers are allocated from memory local to that node. Set it to "
+      "the NUMA node of the device consuming the dataset. Ignored if NUMA is "
+      "not supported.")
+
   def _to_proto(self):
     pb = dataset_options_pb2.ThreadingOptions()
     if self.max_intra_op_parallelism is not None:
       pb.max_intra_op_parallelism = self.max_intra_op_parallelism
     if self.private_threadpool_size is not None:
       pb.private_threadpool_size = self.private_threadpool_size
+    if self.numa_node is not None:
+      pb.numa_node = self.numa_node
     return pb
 
   def _from_proto(self, pb):
@@ -518,6 +529,8 @@ class ThreadingOptions(options_lib.OptionsBase):
       self.max_intra_op_parallelism = pb.max_intra_op_parallelism
     if pb.WhichOneof("optional_private_threadpool_size") is not None:
       self.private_threadpool_size = pb.private_threadpool_size
+    if pb.WhichOneof("optional_numa_node") is not None:
+      self.numa_node = pb.numa_node
 
 
 @tf_export("data.Options")
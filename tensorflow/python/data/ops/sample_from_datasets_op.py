@@ -14,6 +14,8 @@
 # ==============================================================================
 """The implementation of `tf.data.Dataset.sample_from_datasets`."""
 
+import numpy as np
+
 from tensorflow.python.data.ops import dataset_ops
 from tensorflow.python.data.ops import directed_interleave_op
 from tensorflow.python.data.ops import map_op
@@ -25,6 +27,37 @@ from tensorflow.python.ops import gen_stateless_random_ops
 from tensorflow.python.ops import math_ops
 from tensorflow.python.types import data as data_types
 
+# With at least this many inputs and constant weights, inputs are selected
+# using an alias table. It takes constant time per element, whereas sampling
+# from the logits takes time linear in the number of inputs.
+_ALIAS_TABLE_MIN_NUM_DATASETS = 256
+
+
+def _alias_table(weights):
+  """Builds Vose's alias table for sampling indices in proportion to `weights`.
+
+  Args:
+    weights: A sequence of non-negative weights, not all zero.
+
+  Returns:
+    A tuple `(prob, alias)` of arrays. Index `i` is drawn uniformly, and kept
+    with probability `prob[i]`, or replaced by `alias[i]` otherwise.
+  """
+  scaled = np.asarray(weights, dtype=np.float64)
+  scaled = scaled * len(scaled) / scaled.sum()
+  prob = np.ones(len(scaled), dtype=np.float64)
+  alias = np.arange(len(scaled), dtype=np.int64)
+  small = [i for i, p in enumerate(scaled) if p < 1.0]
+  large = [i for i, p in enumerate(scaled) if p >= 1.0]
+  while small and large:
+    s, l = small.pop(), large.pop()
+    prob[s] = scaled[s]
+    alias[s] = l
+    scaled[l] += scaled[s] - 1.0
+    (small if scaled[l] < 1.0 else large).append(l)
+  # Leftover entries are 1 up to rounding errors and keep `prob` 1.
+  return prob, alias
+
 
 def _sample_from_datasets(datasets,  # pylint: disable=unused-private-name
                           weights=None,
@@ -44,9 +77,11 @@ def _sample_from_datasets(datasets,  # pylint: disable=unused-private-name
     raise ValueError("Invalid `datasets`. `datasets` should not be empty.")
 
   if not isinstance(weights, data_types.DatasetV2):
+    static_weights = None
     if weights is None:
       # Select inputs with uniform probability.
       logits = [[1.0] * len(datasets)]
+      static_weights = [1.0] * len(datasets)
 
     else:
       if isinstance(weights, tensor.Tensor):
@@ -65,6 +100,7 @@ def _sample_from_datasets(datasets,  # pylint: disable=unused-private-name
       # input.
       if not isinstance(weights, tensor.Tensor):
         datasets, weights = _skip_datasets_with_zero_weight(datasets, weights)
+        static_weights = weights
       weights = ops.convert_to_tensor(weights, name="weights")
       if weights.dtype not in (dtypes.float32, dtypes.float64):
         raise TypeError(f"Invalid `weights`. `weights` type must be either "
@@ -87,11 +123,29 @@ def _sample_from_datasets(datasets,  # pylint: disable=unused-private-name
               logits, 1, seed=seed),
           axis=[0, 1])
 
+    select_dataset_fn = select_dataset_constant_logits
+    if (static_weights is not None and
+        len(datasets) >= _ALIAS_TABLE_MIN_NUM_DATASETS):
+      prob, alias = _alias_table(static_weights)
+      num_datasets = len(datasets)
+
+      def select_dataset_alias_table(seed):
+        uniform = gen_stateless_random_ops.stateless_random_uniform(
+            [2], seed=seed, dtype=dtypes.float64)
+        index = math_ops.minimum(
+            math_ops.cast(uniform[0] * num_datasets, dtypes.int64),
+            num_datasets - 1)
+        return array_ops.where_v2(
+            uniform[1] < array_ops.gather(prob, index), index,
+            array_ops.gather(alias, index))
+
+      select_dataset_fn = select_dataset_alias_table
+
     selector_input = map_op._MapDataset(  # pylint: disable=protected-access
         dataset_ops.Dataset.random(
             seed=seed,
             rerandomize_each_iteration=rerandomize_each_iteration).batch(2),
-        select_dataset_constant_logits,
+        select_dataset_fn,
         use_inter_op_parallelism=False)
 
   else:  # isinstance(weights, DatasetV2)
@@ -223,6 +223,41 @@ class DebugIdentityV2OpTest(dumping_callback_test_lib.DumpingCallbackTestBase):
         with self.assertRaises(StopIteration):
           next(graph_trace_iter)
 
+  def testSamplingPeriodTracesTheSampledExecutionsAndTheInfsAndNans(self):
+    curt_health = debug_event_pb2.TensorDebugMode.CURT_HEALTH
+
+    @def_function.function
+    def write_debug_trace(x):
+      gen_debug_ops.debug_identity_v2(
+          gen_debug_ops.debug_numeric_summary_v2(
+              x,
+              tensor_id=1,
+              tensor_debug_mode=curt_health,
+              output_dtype=dtypes.float64),
+          tfdbg_context_id="deadbeaf",
+          op_name="Identity",
+          output_slot=0,
+          tensor_debug_mode=curt_health,
+          debug_urls=["file://%s" % self.dump_root],
+          sampling_period=3)
+      return x + 1.0
+
+    # The executions 0 and 3 are sampled, and the execution 4 has an infinity.
+    for x in ([1.0, 2.0],) * 4 + ([1.0, np.inf],):
+      write_debug_trace(constant_op.constant(x, dtype=dtypes.float32))
+    self.writer.FlushExecutionFiles()
+
+    with debug_events_reader.DebugEventsReader(self.dump_root) as reader:
+      graph_trace_iter = reader.graph_execution_traces_iterators()[0]
+      values = []
+      for _ in range(3):
+        trace = next(graph_trace_iter).debug_event.graph_execution_trace
+        self.assertEqual(trace.op_name, "Identity")
+        values.append(tensor_util.MakeNdarray(trace.tensor_proto).tolist())
+      self.assertAllEqual(values, [[1, 0], [1, 0], [1, 1]])
+      with self.assertRaises(StopIteration):
+        next(graph_trace_iter)
+
 
 class DebugIdentityV2OpUninitializedWriterTest(
     dumping_callback_test_lib.DumpingCallbackTestBase):
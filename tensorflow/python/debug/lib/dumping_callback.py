@@ -84,13 +84,15 @@ class _DumpingCallback(object):
                tensor_debug_mode,
                circular_buffer_size,
                op_regex,
-               tensor_dtypes):
+               tensor_dtypes,
+               sampling_period=1):
     self._dump_root = dump_root
     self._tfdbg_run_id = _get_tfdbg_run_id()
     self._tensor_debug_mode = tensor_debug_mode
     self._circular_buffer_size = circular_buffer_size
     self._op_regex = op_regex
     self._tensor_dtypes = tensor_dtypes
+    self._sampling_period = sampling_period
 
     self._hostname = socket.gethostname()
     # A list of source-file paths.
@@ -154,6 +156,10 @@ class _DumpingCallback(object):
   def circular_buffer_size(self):
     return self._circular_buffer_size
 
+  @property
+  def sampling_period(self):
+    return self._sampling_period
+
   def get_writer(self):
     """Get the debug events writer for the currently configured dump root."""
     if not self._writer:
@@ -362,6 +368,7 @@ class _DumpingCallback(object):
           "name": debug_identity_name,
           "circular_buffer_size": self._circular_buffer_size,
           "tfdbg_run_id": self._tfdbg_run_id,
+          "sampling_period": self._sampling_period,
       }
       if tensor_debug_mode == debug_event_pb2.TensorDebugMode.NO_TENSOR:
         if (not self._should_dump_tensor(op_type, tensor.dtype) or
@@ -674,7 +681,8 @@ def enable_dump_debug_info(dump_root,
                            tensor_debug_mode=DEFAULT_TENSOR_DEBUG_MODE,
                            circular_buffer_size=1000,
                            op_regex=None,
-                           tensor_dtypes=None):
+                           tensor_dtypes=None,
+                           sampling_period=1):
   """Enable dumping debugging information from a TensorFlow program.
 
   The debugging information is dumped to a directory on the file system
@@ -700,7 +708,7 @@ def enable_dump_debug_info(dump_root,
   Calling this method more than once with different `tensor_debug_mode`s
   leads to a `ValueError`.
   Calling this method more than once with different `circular_buffer_size`s
-  leads to a `ValueError`.
+  or `sampling_period`s leads to a `ValueError`.
   Calling this method with a different `dump_root` abolishes the
   previously-enabled `dump_root`.
 
@@ -780,6 +788,12 @@ def enable_dump_debug_info(dump_root,
         dumping. Examples:
         - `tensor_dtype=lambda dtype: dtype.is_integer`.
       This filter operates in a logical AND relation with `op_regex`.
+    sampling_period: Trace only one execution out of `sampling_period` of each
+      instrumented tensor computed inside `tf.function`s, to reduce the
+      overhead of the dumping on long-running programs. The traces of the
+      "CURT_HEALTH", "CONCISE_HEALTH" and "FULL_HEALTH" modes counting
+      infinities or NaNs are written regardless of the sampling. Expected to
+      be a positive integer. The default of 1 traces every execution.
   Returns:
     A DebugEventsWriter instance used by the dumping callback. The caller
     may use its flushing methods, including `FlushNonExecutionFiles()` and
@@ -820,7 +834,18 @@ def enable_dump_debug_info(dump_root,
       tensor_dtypes = [
           dtypes.as_dtype(dtype_item) for dtype_item in tensor_dtypes]
 
+  if not isinstance(sampling_period, int) or sampling_period < 1:
+    raise ValueError(
+        "sampling_period is expected to be a positive integer, "
+        "but received %s" % (sampling_period,))
+
   if hasattr(_state, "dumping_callback"):
+    if _state.dumping_callback.sampling_period != sampling_period:
+      raise ValueError(
+          "There is already a dumping callback configured with a different "
+          "sampling period (%d). Therefore the newly requested sampling "
+          "period (%d) will not be honored." %
+          (_state.dumping_callback.sampling_period, sampling_period))
     if _state.dumping_callback.circular_buffer_size != circular_buffer_size:
       raise ValueError(
           "There is already a dumping callback configured with a different "
@@ -841,7 +866,8 @@ def enable_dump_debug_info(dump_root,
                                                tensor_debug_mode,
                                                circular_buffer_size,
                                                op_regex,
-                                               tensor_dtypes)
+                                               tensor_dtypes,
+                                               sampling_period)
     op_callbacks.add_op_callback(_state.dumping_callback.callback)
     function_lib.CONCRETE_FUNCTION_CALLBACKS.append(
         _state.dumping_callback.function_callback)
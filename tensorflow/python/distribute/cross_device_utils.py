@@ -379,6 +379,23 @@ class CollectiveReplicaLauncher(object):
           timeout=options.timeout_seconds,
           ordering_token=ordering_token)
 
+  def _batch_all_reduce(
+      self,
+      input_tensors: List[core.TensorLike],
+      options: collective_util.Options) -> List[core.Tensor]:
+    """All-reduce a list of dense tensors with a single collective."""
+    instance_key = self._next_instance_key()
+    ordering_token = self._get_ordering_token()
+    with ops.device(self._device):
+      return collective_ops.batch_all_reduce_v2(
+          input_tensors,
+          self._group_size,
+          self._group_key,
+          instance_key,
+          communication_hint=options.implementation.value,
+          timeout=options.timeout_seconds,
+          ordering_token=ordering_token)
+
   def _all_gather(self, input_tensor: core.TensorLike,
                   options: Optional[collective_util.Options]) -> core.Tensor:
     """All-gather a dense tensor.
@@ -426,10 +443,14 @@ class CollectiveReplicaLauncher(object):
     outputs = []
     for pack in input_tensor_packs:
       if context.executing_eagerly():
-        # We don't batch in eager as it sometimes makes the performance worse
-        # due the concat/split ops.
-        for input_tensor in pack:
-          outputs.append(self.all_reduce(input_tensor, None, options))
+        # We don't concat/split in eager as it sometimes makes the performance
+        # worse. Packs of a single dtype are instead reduced by one fused op
+        # that packs the tensors in the runtime.
+        if len(pack) > 1 and len(set(t.dtype for t in pack)) == 1:
+          outputs.extend(self._batch_all_reduce(pack, options))
+        else:
+          for input_tensor in pack:
+            outputs.append(self.all_reduce(input_tensor, None, options))
       else:
         # TODO(b/169168846): inserts a parallel all_gather to verify packings
         # are the same on each replica.
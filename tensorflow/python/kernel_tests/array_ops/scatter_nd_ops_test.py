@@ -759,6 +759,17 @@ class ScatterNdTest(test.TestCase, parameterized.TestCase):
     val = self.evaluate(self.scatter_nd(indices, values, shape))
     self.assertAllClose([np.sum(values)], val)
 
+  def testScatterNdManyRepeatedSlicesAdd(self):
+    indices = np.random.randint(0, 4, size=[50000, 2]) * [1, 2]
+    values = np.random.randn(50000, 3)
+    shape = [4, 8, 3]
+    expected = np.zeros(shape)
+    np.add.at(expected, (indices[:, 0], indices[:, 1]), values)
+    val = self.evaluate(
+        self.scatter_nd(constant_op.constant(indices, dtypes.int32), values,
+                        shape))
+    self.assertAllClose(expected, val)
+
   def testSmokeScatterNdBatch2DSliceDim2(self):
     indices = array_ops.zeros([3, 5, 2], dtype=dtypes.int32)
     values = array_ops.zeros([3, 5, 7])
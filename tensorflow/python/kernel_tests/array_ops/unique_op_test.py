@@ -17,6 +17,7 @@
 import numpy as np
 
 from tensorflow.python.framework import dtypes
+from tensorflow.python.framework import ops
 from tensorflow.python.framework import test_util
 from tensorflow.python.ops import array_ops
 from tensorflow.python.ops import gen_array_ops
@@ -313,6 +314,36 @@ class UniqueWithCountsTest(test.TestCase):
     self.assertAllEqual(tf_idx, true_idx)
     self.assertAllEqual(tf_count, true_count)
 
+  def _testLargeInputMatchesCpu(self, x, out_idx):
+    with ops.device('/device:CPU:0'):
+      cpu = self.evaluate(array_ops.unique_with_counts(x, out_idx=out_idx))
+    with ops.device('/device:GPU:0'):
+      gpu = self.evaluate(array_ops.unique_with_counts(x, out_idx=out_idx))
+      gpu_y, gpu_idx = self.evaluate(array_ops.unique(x, out_idx=out_idx))
+    for cpu_output, gpu_output in zip(cpu, gpu):
+      self.assertAllEqual(cpu_output, gpu_output)
+    self.assertAllEqual(gpu_y, cpu[0])
+    self.assertAllEqual(gpu_idx, cpu[1])
+
+  @test_util.run_gpu_only
+  def testLargeInputOnGpu(self):
+    # The GPU kernel uses a hash table instead of sorting integer inputs of at
+    # least 1 << 20 elements, it must give the same outputs in the same order.
+    size = (1 << 20) + 7
+    for dtype in [np.int32, np.int64]:
+      for out_idx in [dtypes.int32, dtypes.int64]:
+        with self.subTest(dtype=dtype, out_idx=out_idx):
+          # Duplicates, with some negative values.
+          self._testLargeInputMatchesCpu(
+              np.random.randint(-1000, 50000, size=size).astype(dtype),
+              out_idx)
+          # All unique.
+          self._testLargeInputMatchesCpu(
+              np.random.permutation(size).astype(dtype), out_idx)
+          # A single value.
+          self._testLargeInputMatchesCpu(
+              np.full(size, 3, dtype=dtype), out_idx)
+
 
 if __name__ == '__main__':
   test.main()
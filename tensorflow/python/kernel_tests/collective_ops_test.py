@@ -615,6 +615,55 @@ class AllReduceWithSubdivisionsTest(test.TestCase, parameterized.TestCase):
       self.assertAllClose(result, [2.], rtol=1e-5, atol=1e-5)
 
 
+@combinations.generate(
+    combinations.times(combinations.combine(mode='eager'), device_combination))
+class BatchAllReduceTest(test.TestCase, parameterized.TestCase):
+
+  def setUp(self):
+    _setup_context()
+    super().setUp()
+
+  def testReduce(self, device, communication):
+    dev0 = '/device:%s:0' % device
+    dev1 = '/device:%s:1' % device
+
+    tokens = {}
+    for dev in [dev0, dev1]:
+      with ops.device(dev):
+        tokens[dev] = create_ordering_token()
+
+    @def_function.function
+    def run_batch_all_reduce():
+      collectives = []
+      for i, dev in enumerate([dev0, dev1]):
+        with ops.device(dev):
+          inputs = [
+              constant_op.constant([1., 2.]) * (i + 1),
+              constant_op.constant([[3.]]) * (i + 1),
+              array_ops.zeros([0, 2]),
+              constant_op.constant(4., shape=[2, 3]) * (i + 1),
+          ]
+          collectives.append(
+              _collective_ops.batch_all_reduce_v2(
+                  inputs,
+                  group_size=2,
+                  group_key=1,
+                  instance_key=1,
+                  merge_op='Add',
+                  final_op='Div',
+                  ordering_token=tokens[dev],
+                  communication_hint=communication))
+      return collectives
+
+    for results in run_batch_all_reduce():
+      self.assertLen(results, 4)
+      self.assertAllClose(results[0], [1.5, 3.], rtol=1e-5, atol=1e-5)
+      self.assertAllClose(results[1], [[4.5]], rtol=1e-5, atol=1e-5)
+      self.assertEqual(results[2].shape, [0, 2])
+      self.assertAllClose(
+          results[3], [[6., 6., 6.], [6., 6., 6.]], rtol=1e-5, atol=1e-5)
+
+
 @combinations.generate(
     combinations.combine(required_physical_gpus=2, mode='eager'))
 class XlaTest(test.TestCase, parameterized.TestCase):
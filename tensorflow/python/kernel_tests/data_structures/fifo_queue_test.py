@@ -1624,6 +1624,90 @@ class FIFOQueueParallelTests(test.TestCase):
 
       self.assertAllEqual(elems, dequeued_elems)
 
+  def testEnqueueManyAndDequeueManyWithoutBlocking(self):
+    with self.cached_session():
+      q = data_flow_ops.FIFOQueue(10, (dtypes_lib.int32, dtypes_lib.float32),
+                                  ((), (2,)))
+      enqueue_op = q.enqueue_many(([1, 2, 3, 4, 5],
+                                   [[1.0, 1.5], [2.0, 2.5], [3.0, 3.5],
+                                    [4.0, 4.5], [5.0, 5.5]]))
+      dequeued_2_t = q.dequeue_many(2)
+      dequeued_3_t = q.dequeue_many(3)
+      size_t = q.size()
+
+      self.evaluate(enqueue_op)
+      self.assertEqual(5, self.evaluate(size_t))
+      ints, floats = self.evaluate(dequeued_2_t)
+      self.assertAllEqual([1, 2], ints)
+      self.assertAllEqual([[1.0, 1.5], [2.0, 2.5]], floats)
+      ints, floats = self.evaluate(dequeued_3_t)
+      self.assertAllEqual([3, 4, 5], ints)
+      self.assertAllEqual([[3.0, 3.5], [4.0, 4.5], [5.0, 5.5]], floats)
+      self.assertEqual(0, self.evaluate(size_t))
+
+  def testEnqueueManyQueuesBehindBlockedEnqueueMany(self):
+    # We need each thread to keep its own device stack or the device scopes
+    # won't be properly nested.
+    ops.get_default_graph().switch_to_thread_local()
+    with self.cached_session():
+      q = data_flow_ops.FIFOQueue(4, dtypes_lib.float32, ())
+      elems = [10.0, 20.0, 30.0, 40.0]
+      enqueue_op = q.enqueue_many((elems,))
+      first_blocking_enqueue_op = q.enqueue_many(([50.0, 60.0],))
+      second_blocking_enqueue_op = q.enqueue_many(([70.0],))
+      dequeued_t = q.dequeue_many(7)
+
+      self.evaluate(enqueue_op)
+
+      def first_blocking_enqueue():
+        self.evaluate(first_blocking_enqueue_op)
+
+      def second_blocking_enqueue():
+        # Runs after the first enqueue has blocked.
+        # TODO(mrry): Figure out how to do this without sleeping.
+        time.sleep(0.1)
+        self.evaluate(second_blocking_enqueue_op)
+
+      first_thread = self.checkedThread(target=first_blocking_enqueue)
+      second_thread = self.checkedThread(target=second_blocking_enqueue)
+      first_thread.start()
+      second_thread.start()
+      time.sleep(0.2)
+      # The second enqueue can't overtake the first one once the queue has
+      # room again.
+      self.assertAllEqual(elems + [50.0, 60.0, 70.0],
+                          self.evaluate(dequeued_t))
+      first_thread.join()
+      second_thread.join()
+
+  def testEnqueueManyCompletesBlockedDequeueMany(self):
+    # We need each thread to keep its own device stack or the device scopes
+    # won't be properly nested.
+    ops.get_default_graph().switch_to_thread_local()
+    with self.cached_session():
+      q = data_flow_ops.FIFOQueue(10, dtypes_lib.int32, ())
+      first_enqueue_op = q.enqueue(1)
+      second_enqueue_op = q.enqueue_many(([2, 3, 4, 5],))
+      blocking_dequeued_t = q.dequeue_many(3)
+      dequeued_t = q.dequeue_many(2)
+
+      self.evaluate(first_enqueue_op)
+      blocking_dequeued = []
+
+      def blocking_dequeue():
+        blocking_dequeued.extend(self.evaluate(blocking_dequeued_t).tolist())
+
+      thread = self.checkedThread(target=blocking_dequeue)
+      thread.start()
+      # The enqueue should run after the dequeue has blocked.
+      # TODO(mrry): Figure out how to do this without sleeping.
+      time.sleep(0.1)
+      self.evaluate(second_enqueue_op)
+      thread.join()
+      self.assertAllEqual([1, 2, 3], blocking_dequeued)
+      # The rest of the batch is left for the next dequeue.
+      self.assertAllEqual([4, 5], self.evaluate(dequeued_t))
+
   def testDequeueEnqueueFail(self):
     with self.cached_session() as session:
       q = data_flow_ops.FIFOQueue(10, [dtypes_lib.int32], shapes=[()])
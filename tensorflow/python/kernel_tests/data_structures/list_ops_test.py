@@ -432,6 +432,31 @@ class ListOpsTest(test_util.TensorFlowTestCase, parameterized.TestCase):
     dl_length = list_ops.tensor_list_length(dl)
     self.assertAllEqual(self.evaluate(dl_length), 3)
 
+  def testSetItemInReservedListKeepsReadValues(self):
+
+    @def_function.function
+    def f():
+      l = list_ops.tensor_list_reserve(
+          element_dtype=dtypes.float32, element_shape=[16], num_elements=3)
+      for i in range(3):
+        l = list_ops.tensor_list_set_item(l, i, array_ops.fill([16], float(i)))
+      t = list_ops.tensor_list_stack(l, element_dtype=dtypes.float32)
+      g = list_ops.tensor_list_gather(l, [1, 2], element_dtype=dtypes.float32)
+      e = list_ops.tensor_list_get_item(l, 2, element_dtype=dtypes.float32)
+      # Overwriting the elements must not change the tensors read before.
+      with ops.control_dependencies([t, g, e]):
+        l = list_ops.tensor_list_set_item(l, 1, array_ops.fill([16], 5.0))
+        l = list_ops.tensor_list_set_item(l, 2, array_ops.fill([16], 6.0))
+      t2 = list_ops.tensor_list_stack(l, element_dtype=dtypes.float32)
+      return t, g, e, t2
+
+    t, g, e, t2 = self.evaluate(f())
+    expected = np.repeat([[0.0], [1.0], [2.0]], 16, axis=1)
+    self.assertAllEqual(t, expected)
+    self.assertAllEqual(g, expected[1:])
+    self.assertAllEqual(e, expected[2])
+    self.assertAllEqual(t2, np.repeat([[0.0], [5.0], [6.0]], 16, axis=1))
+
   def _testGatherWithUninitializedTensors(self):
     l = list_ops.tensor_list_reserve(
         element_dtype=dtypes.float32, element_shape=[], num_elements=3)
@@ -195,6 +195,28 @@ class HistogramFixedWidthTest(test.TestCase):
     )
     self.assertAllEqual(hist, [1, 1])
 
+  def test_large_input(self):
+    # Large enough to be counted in several blocks on CPU.
+    values = self.rng.normal(size=200000).astype(np.float32)
+    value_range = [-2.0, 2.0]
+    for nbins in [3, 1000]:
+      expected, _ = np.histogram(
+          np.clip(values, -2.0, 2.0), bins=nbins, range=value_range)
+      hist = histogram_ops.histogram_fixed_width(
+          values, value_range, nbins=nbins)
+      # np.histogram computes the bins differently, so they may disagree on
+      # values rounded to the edge of a bin.
+      self.assertAllClose(expected, self.evaluate(hist), atol=20)
+      self.assertEqual(values.size, np.sum(self.evaluate(hist)))
+
+  def test_large_input_with_nan(self):
+    values = self.rng.normal(size=200000).astype(np.float32)
+    values[123456] = np.nan
+    with self.assertRaisesRegex(errors.InvalidArgumentError,
+                                "must not contain NaN"):
+      self.evaluate(
+          histogram_ops.histogram_fixed_width(values, [-2.0, 2.0], nbins=10))
+
 
 if __name__ == '__main__':
   test.main()
@@ -116,6 +116,23 @@ class BincountTest(test_util.TensorFlowTestCase):
             self.evaluate(bincount_ops.bincount(arr, None)),
             np.bincount(arr, weights))
 
+  def test_random_large_input(self):
+    num_samples = 200000
+    with self.session():
+      np.random.seed(42)
+      # Few bins per value, then many more bins than values.
+      for num_bins in [100, 10000000]:
+        arr = np.random.randint(0, num_bins, num_samples)
+        weights = np.random.random(num_samples)
+        self.assertAllClose(
+            self.evaluate(bincount_ops.bincount(arr, weights,
+                                                minlength=num_bins)),
+            np.bincount(arr, weights, minlength=num_bins))
+        self.assertAllEqual(
+            self.evaluate(bincount_ops.bincount(arr, minlength=num_bins,
+                                                binary_output=True)),
+            np.bincount(arr, minlength=num_bins) > 0)
+
   @test_util.run_gpu_only
   @test_util.disable_xla("Bincount is deterministic with XLA")
   def test_bincount_determinism_error(self):
@@ -311,6 +311,19 @@ class SumReductionTest(BaseReductionTest):
           self.assertAllClose(sum_y, tf_out_sum_y)
           self.assertAllClose(sum_xz, tf_out_sum_xz)
 
+  def testFloat32ColumnSumAccuracy(self):
+    # Many rows of narrow columns, as in the moments of a batch of features.
+    np.random.seed(0)
+    for size_y in [3, 8, 64, 1000]:
+      arr = np.random.uniform(0, 1, [(1 << 22) // size_y, size_y]).astype(
+          np.float32)
+      col_sum = np.sum(arr.astype(np.float64), axis=0)
+      col_mean = np.mean(arr.astype(np.float64), axis=0)
+      tf_col_sum = self.evaluate(math_ops.reduce_sum(arr, 0))
+      tf_col_mean = self.evaluate(math_ops.reduce_mean(arr, 0))
+      self.assertAllClose(col_sum, tf_col_sum, rtol=1e-5, atol=0)
+      self.assertAllClose(col_mean, tf_col_mean, rtol=1e-5, atol=0)
+
   @test_util.run_deprecated_v1
   def testFloat32BFloat16(self):
     for dtype in [dtypes.float32, dtypes.bfloat16]:
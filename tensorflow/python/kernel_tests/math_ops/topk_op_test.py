@@ -207,6 +207,53 @@ class TopKTest(test.TestCase):
         3, [[0.2, 0.3, 0.4], [0.2, 0.4, 0.3]], [[2, 1, 3], [3, 1, 2]],
         sorted=False)
 
+  def _validateStreamingTopK(
+      self, inputs, k, sorted=True
+  ):  # pylint: disable=redefined-builtin
+    # Rows of at least 1 << 16 columns with k at most 1/8 of them are split
+    # into blocks on CPU. The top k are the NaNs first, then the largest
+    # values, and equal values are ordered by index.
+    expected_indices = np.array([
+        np.lexsort((np.arange(row.size), -np.nan_to_num(row), ~np.isnan(row)))
+        for row in inputs
+    ])[:, :k]
+    with ops.device("/device:CPU:0"):
+      values, indices = self.evaluate(nn_ops.top_k(inputs, k, sorted=sorted))
+    if not sorted:
+      self.assertAllEqual(indices, np.sort(indices, axis=1))
+      expected_indices = np.sort(expected_indices, axis=1)
+    self.assertAllEqual(expected_indices, indices)
+    self.assertAllEqual(np.take_along_axis(inputs, indices, axis=1), values)
+
+  def testStreamingTopKTies(self):
+    for dtype in [np.int32, np.float32]:
+      inputs = np.random.randint(0, 50, size=(3, 1 << 17)).astype(dtype)
+      for sorted_ in [True, False]:
+        with self.subTest(dtype=dtype, sorted=sorted_):
+          self._validateStreamingTopK(inputs, 37, sorted=sorted_)
+
+  def testStreamingTopKLargeK(self):
+    num_cols = 1 << 16
+    inputs = np.random.permutation(num_cols * 2).reshape(2, num_cols)
+    inputs = (inputs // 3).astype(np.float32)
+    # The largest k of the split rows.
+    for sorted_ in [True, False]:
+      with self.subTest(sorted=sorted_):
+        self._validateStreamingTopK(inputs, num_cols // 8, sorted=sorted_)
+    # The smallest k of the rows that are not split gives the same top k.
+    self._validateStreamingTopK(inputs, num_cols // 8 + 1)
+
+  def testStreamingTopKNan(self):
+    num_cols = 1 << 17
+    inputs = np.random.uniform(size=(3, num_cols)).astype(np.float32)
+    # A few NaNs, more NaNs than k, and only NaNs.
+    inputs[0, np.random.choice(num_cols, 5, replace=False)] = np.nan
+    inputs[1, np.random.choice(num_cols, 100, replace=False)] = np.nan
+    inputs[2, :] = np.nan
+    for sorted_ in [True, False]:
+      with self.subTest(sorted=sorted_):
+        self._validateStreamingTopK(inputs, 20, sorted=sorted_)
+
   def testTop3Vector(self):
     inputs = [3, 6, 15, 18, 6, 12, 1, 17, 3, 0, 4, 19, 1, 6]
     self._validateTopK(inputs, 3, [19, 18, 17], [11, 3, 7])
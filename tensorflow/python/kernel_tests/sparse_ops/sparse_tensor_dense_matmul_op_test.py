@@ -238,6 +238,19 @@ class SparseTensorDenseMatMulTest(test.TestCase):
     self._testLarge(np.complex64)
     self._testLarge(np.complex128)
 
+  # Tests products large enough to be multiplied by rows in parallel on CPU.
+  def testManyNonzerosAndColumns(self):
+    np.random.seed(127)  # Repeatable results
+    for np_dtype in [np.float32, np.complex64]:
+      x = _maybe_complex(np.random.rand(500, 300).astype(np_dtype))
+      x[np.abs(x) < 0.7] = 0
+      y = _maybe_complex(np.random.randn(300, 400).astype(np_dtype))
+      self._testMatmul(x, y, adjoint_a=False, adjoint_b=False)
+      self._testMatmul(x.transpose(), y, adjoint_a=True, adjoint_b=False)
+      self._testMatmul(x, y.transpose(), adjoint_a=False, adjoint_b=True)
+      self._testMatmul(
+          x.transpose(), y.transpose(), adjoint_a=True, adjoint_b=True)
+
   # Tests random sized matrices.
   def testFloatRandom(self):
     np.random.seed(127)  # Repeatable results
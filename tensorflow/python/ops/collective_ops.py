@@ -41,8 +41,10 @@ def all_reduce(t,
       independent subdivision should begin.  Use [0] if no subdivision should
       be done.
     communication_hint: preferred collective communication.  The implementation
-      may fall back to another mechanism.  Options include `auto`, `ring`, and
-      `nccl`.
+      may fall back to another mechanism.  Options include `auto`, `ring`,
+      `hierarchical`, and `nccl`.  `hierarchical` reduces within each task
+      before reducing across tasks, and applies to CPU groups that span
+      several tasks with the same number of devices each.
     timeout: a float. If set to a non zero, set a completion timeout to detect
       staleness.  If the timer goes off, a DeadlineExceededError is raised.  The
       timeout value in seconds. This feature is experimental.
@@ -102,6 +104,8 @@ def all_reduce_v2(t,
                   timeout=0,
                   ordering_token=None,
                   max_subdivs_per_device=-1,
+                  compression='none',
+                  num_backup_workers=0,
                   name=None):
   """Reduces tensors collectively, across devices.
 
@@ -117,8 +121,10 @@ def all_reduce_v2(t,
     final_op: string naming the unary Op to be applied to each fully reduced
       value.  Can be 'Id' for no operation.
     communication_hint: preferred collective communication.  The implementation
-      may fall back to another mechanism.  Options include `auto`, `ring`, and
-      `nccl`.
+      may fall back to another mechanism.  Options include `auto`, `ring`,
+      `hierarchical`, and `nccl`.  `hierarchical` reduces within each task
+      before reducing across tasks, and applies to CPU groups that span
+      several tasks with the same number of devices each.
     timeout: a float. If set to a non zero, set a completion timeout to detect
       staleness.  If the timer goes off, a DeadlineExceededError is raised.  The
       timeout value in seconds. This feature is experimental.
@@ -132,6 +138,17 @@ def all_reduce_v2(t,
       parallelize processing of each per-device tensor. Setting to -1 disables
       subdivision and reverts to previous behavior of not sub-dividing tensor.
       Setting to 0 uses sytem defaults.
+    compression: wire format for the chunks exchanged between devices.  One of
+      `none`, `bf16` or `fp16`.  `bf16` and `fp16` halve the bytes sent for
+      float32 reductions on CPU devices at the cost of precision; otherwise the
+      option is ignored.  This feature is experimental.
+    num_backup_workers: the number of group members whose contributions may be
+      left out of the reduction when they arrive last.  The reduction then
+      completes once the other contributions have arrived, a `Div` final op
+      divides by the number of contributions used, and every member receives
+      the same result.  Applies to CPU groups; the member with rank 0 gathers
+      the contributions and must not be among the stragglers.  This feature is
+      experimental.
     name: name of the Op.
 
   Returns:
@@ -154,6 +171,77 @@ def all_reduce_v2(t,
       is_stateless=False,
       ordering_token=ordering_token,
       max_subdivs_per_device=max_subdivs_per_device,
+      compression=compression,
+      num_backup_workers=num_backup_workers,
+      name=name)
+
+
+def batch_all_reduce_v2(inputs,
+                        group_size,
+                        group_key,
+                        instance_key,
+                        merge_op='Add',
+                        final_op='Id',
+                        communication_hint='auto',
+                        timeout=0,
+                        ordering_token=None,
+                        max_subdivs_per_device=-1,
+                        compression='none',
+                        num_backup_workers=0,
+                        name=None):
+  """Reduces lists of tensors collectively, across devices.
+
+  Equivalent to calling `all_reduce_v2` on each of `inputs`, but packs the
+  tensors into one buffer and reduces it with a single collective, which is
+  cheaper for many small tensors, e.g. gradients.
+
+  Args:
+    inputs: a non-empty list of tensors of the same dtype to be reduced.  Every
+      member of the group must pass tensors of the same shapes in the same
+      order.
+    group_size: an int32 tensor. The total number of tensors to be collectively
+      reduced.  Each must reside on a different device.  Should be a positive
+      integer.
+    group_key: an int32 tensor identifying the group of devices.
+    instance_key: an int32 tensor identifying the participating group of Ops.
+    merge_op: string naming the binary Op to be applied to compute each partial
+      reduction.
+    final_op: string naming the unary Op to be applied to each fully reduced
+      value.  Can be 'Id' for no operation.
+    communication_hint: preferred collective communication.  See
+      `all_reduce_v2`.
+    timeout: a float. If set to a non zero, set a completion timeout to detect
+      staleness.  If the timer goes off, a DeadlineExceededError is raised.  The
+      timeout value in seconds. This feature is experimental.
+    ordering_token: a resource tensor on the same device as the op to order
+      the collectives in a per-device manner by auto control dependency.
+    max_subdivs_per_device: see `all_reduce_v2`.
+    compression: see `all_reduce_v2`.
+    num_backup_workers: see `all_reduce_v2`.
+    name: name of the Op.
+
+  Returns:
+    A list with the reduced value of each of `inputs`.
+  """
+  if ordering_token is not None:
+    ordering_token = [ordering_token]
+  else:
+    ordering_token = []
+
+  return gen_collective_ops.collective_batch_reduce_v2(
+      inputs,
+      group_size=group_size,
+      group_key=group_key,
+      instance_key=instance_key,
+      merge_op=merge_op,
+      final_op=final_op,
+      communication_hint=communication_hint.lower(),
+      timeout_seconds=timeout,
+      is_stateless=False,
+      ordering_token=ordering_token,
+      max_subdivs_per_device=max_subdivs_per_device,
+      compression=compression,
+      num_backup_workers=num_backup_workers,
       name=name)
 
 
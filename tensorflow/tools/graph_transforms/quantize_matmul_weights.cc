@@ -0,0 +1,132 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/kernels/weight_only_quantization.h"
+#include "tensorflow/tools/graph_transforms/transform_utils.h"
+
+namespace tensorflow {
+namespace graph_transforms {
+
+// Replaces float MatMuls with large constant weights by
+// _WeightOnlyQuantizedMatMul ops, with the weights stored as 4 or 8-bit
+// integers and a scale for each group of group_size rows of each column. The
+// activations stay float, so this shrinks the weights and the memory traffic
+// of the MatMul without calibrating any ranges.
+Status QuantizeMatMulWeights(const GraphDef& input_graph_def,
+                             const TransformFuncContext& context,
+                             GraphDef* output_graph_def) {
+  int32_t bits;
+  TF_RETURN_IF_ERROR(context.GetOneInt32Parameter("bits", 4, &bits));
+  if (bits != 4 && bits != 8) {
+    return errors::InvalidArgument("bits must be 4 or 8, got ", bits);
+  }
+  int64_t group_size;
+  TF_RETURN_IF_ERROR(
+      context.GetOneInt64Parameter("group_size", 128, &group_size));
+  if (group_size <= 0) {
+    return errors::InvalidArgument("group_size must be positive, got ",
+                                   group_size);
+  }
+  int64_t minimum_size;
+  TF_RETURN_IF_ERROR(
+      context.GetOneInt64Parameter("minimum_size", 1024, &minimum_size));
+
+  GraphDef replaced_graph_def;
+  TF_RETURN_IF_ERROR(ReplaceMatchingOpTypes(
+      input_graph_def,  // clang-format off
+      {"MatMul",           // matmul_node
+        {
+          {"*"},           // input_node
+          {"Const"},       // weights_node
+        }
+      },  // clang-format on
+      [bits, group_size, minimum_size](
+          const NodeMatch& match, const std::set<string>& input_nodes,
+          const std::set<string>& output_nodes,
+          std::vector<NodeDef>* new_nodes) {
+        const NodeDef& matmul_node = match.node;
+        const NodeDef& input_node = match.inputs[0].node;
+        const NodeDef& weights_node = match.inputs[1].node;
+        new_nodes->push_back(input_node);
+
+        // Keep the original nodes if the weights are used elsewhere, or the
+        // MatMul isn't a plain float one.
+        const Tensor weights = GetNodeTensorAttr(weights_node, "value");
+        if (output_nodes.count(weights_node.name()) ||
+            !matmul_node.attr().count("T") ||
+            matmul_node.attr().at("T").type() != DT_FLOAT ||
+            weights.dtype() != DT_FLOAT || weights.dims() != 2 ||
+            weights.NumElements() < minimum_size) {
+          new_nodes->insert(new_nodes->end(), {weights_node, matmul_node});
+          return OkStatus();
+        }
+        bool transpose_a = false;
+        bool transpose_b = false;
+        TryGetNodeAttr(matmul_node, "transpose_a", &transpose_a);
+        TryGetNodeAttr(matmul_node, "transpose_b", &transpose_b);
+
+        // The packed weights are stored as [K, N].
+        Tensor kn_weights = weights;
+        if (transpose_b) {
+          kn_weights = Tensor(DT_FLOAT, TensorShape({weights.dim_size(1),
+                                                     weights.dim_size(0)}));
+          kn_weights.matrix<float>() =
+              weights.matrix<float>().shuffle(Eigen::array<int, 2>{1, 0});
+        }
+        Tensor packed;
+        Tensor scales;
+        TF_RETURN_IF_ERROR(QuantizeWeightsPerGroup(kn_weights, bits, group_size,
+                                                   &packed, &scales));
+
+        NodeDef packed_node;
+        packed_node.set_op("Const");
+        packed_node.set_name(weights_node.name() + "_packed");
+        SetNodeAttr("dtype", DT_UINT8, &packed_node);
+        SetNodeTensorAttr<uint8_t>("value", packed, &packed_node);
+        new_nodes->push_back(packed_node);
+
+        NodeDef scales_node;
+        scales_node.set_op("Const");
+        scales_node.set_name(weights_node.name() + "_scales");
+        SetNodeAttr("dtype", DT_FLOAT, &scales_node);
+        SetNodeTensorAttr<float>("value", scales, &scales_node);
+        new_nodes->push_back(scales_node);
+
+        NodeDef quantized_node;
+        quantized_node.set_op("_WeightOnlyQuantizedMatMul");
+        quantized_node.set_name(matmul_node.name());
+        quantized_node.set_device(matmul_node.device());
+        AddNodeInput(matmul_node.input(0), &quantized_node);
+        AddNodeInput(packed_node.name(), &quantized_node);
+        AddNodeInput(scales_node.name(), &quantized_node);
+        for (int i = 2; i < matmul_node.input_size(); ++i) {
+          AddNodeInput(matmul_node.input(i), &quantized_node);
+        }
+        SetNodeAttr("bits", bits, &quantized_node);
+        SetNodeAttr("group_size", group_size, &quantized_node);
+        SetNodeAttr("transpose_a", transpose_a, &quantized_node);
+        new_nodes->push_back(quantized_node);
+        return OkStatus();
+      },
+      {}, &replaced_graph_def));
+  *output_graph_def = replaced_graph_def;
+  return OkStatus();
+}
+
+REGISTER_GRAPH_TRANSFORM("quantize_matmul_weights", QuantizeMatMulWeights);
+
+}  // namespace graph_transforms
+}  // namespace tensorflow
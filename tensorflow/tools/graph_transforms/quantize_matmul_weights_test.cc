@@ -0,0 +1,131 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/cc/ops/const_op.h"
+#include "tensorflow/cc/ops/standard_ops.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/public/session.h"
+#include "tensorflow/tools/graph_transforms/transform_utils.h"
+
+namespace tensorflow {
+namespace graph_transforms {
+
+// Declare here, so we don't need a public header.
+Status QuantizeMatMulWeights(const GraphDef& input_graph_def,
+                             const TransformFuncContext& context,
+                             GraphDef* output_graph_def);
+
+class QuantizeMatMulWeightsTest : public ::testing::Test {
+ protected:
+  void TestQuantizeMatMulWeights(const string& bits, bool transpose_a,
+                                 bool transpose_b) {
+    auto root = tensorflow::Scope::NewRootScope();
+    using namespace ::tensorflow::ops;  // NOLINT(build/namespaces)
+
+    Tensor input_data(DT_FLOAT, transpose_a ? TensorShape({40, 3})
+                                            : TensorShape({3, 40}));
+    input_data.flat<float>().setRandom();
+    Output input_op =
+        Const(root.WithOpName("input_op"), Input::Initializer(input_data));
+    Tensor weights_data(DT_FLOAT, transpose_b ? TensorShape({9, 40})
+                                              : TensorShape({40, 9}));
+    weights_data.flat<float>().setRandom();
+    Output weights_op =
+        Const(root.WithOpName("weights_op"), Input::Initializer(weights_data));
+    Output matmul_op = MatMul(
+        root.WithOpName("matmul_op"), input_op, weights_op,
+        MatMul::TransposeA(transpose_a).TransposeB(transpose_b));
+    Output output_op = Identity(root.WithOpName("output"), matmul_op);
+    GraphDef original_graph_def;
+    TF_ASSERT_OK(root.ToGraphDef(&original_graph_def));
+
+    TransformFuncContext context;
+    context.output_names = {"output"};
+    context.params["bits"] = {bits};
+    context.params["group_size"] = {"16"};
+    context.params["minimum_size"] = {"16"};
+    GraphDef quantized_graph_def;
+    TF_ASSERT_OK(QuantizeMatMulWeights(original_graph_def, context,
+                                       &quantized_graph_def));
+
+    std::map<string, const NodeDef*> node_lookup;
+    MapNamesToNodes(quantized_graph_def, &node_lookup);
+    ASSERT_EQ(1, node_lookup.count("matmul_op"));
+    EXPECT_EQ("_WeightOnlyQuantizedMatMul", node_lookup.at("matmul_op")->op());
+    EXPECT_EQ(0, node_lookup.count("weights_op"));
+    ASSERT_EQ(1, node_lookup.count("weights_op_packed"));
+    EXPECT_EQ(DT_UINT8,
+              node_lookup.at("weights_op_packed")->attr().at("dtype").type());
+
+    std::unique_ptr<Session> original_session(NewSession(SessionOptions()));
+    TF_ASSERT_OK(original_session->Create(original_graph_def));
+    std::vector<Tensor> original_outputs;
+    TF_ASSERT_OK(original_session->Run({}, {"output"}, {}, &original_outputs));
+
+    std::unique_ptr<Session> quantized_session(NewSession(SessionOptions()));
+    TF_ASSERT_OK(quantized_session->Create(quantized_graph_def));
+    std::vector<Tensor> quantized_outputs;
+    TF_ASSERT_OK(
+        quantized_session->Run({}, {"output"}, {}, &quantized_outputs));
+
+    // Each of the 40 weights in [-1, 1] is off by at most half a step, 1 / 7
+    // or 1 / 127, and the activations are in [-1, 1].
+    test::ExpectTensorNear<float>(original_outputs[0], quantized_outputs[0],
+                                  bits == "4" ? 40 / 14.0 : 40 / 254.0);
+  }
+};
+
+TEST_F(QuantizeMatMulWeightsTest, Int4) {
+  TestQuantizeMatMulWeights("4", false, false);
+}
+
+TEST_F(QuantizeMatMulWeightsTest, Int8) {
+  TestQuantizeMatMulWeights("8", false, false);
+}
+
+TEST_F(QuantizeMatMulWeightsTest, Transposed) {
+  TestQuantizeMatMulWeights("4", true, true);
+}
+
+TEST_F(QuantizeMatMulWeightsTest, KeepsSmallWeights) {
+  auto root = tensorflow::Scope::NewRootScope();
+  using namespace ::tensorflow::ops;  // NOLINT(build/namespaces)
+  Tensor input_data(DT_FLOAT, TensorShape({1, 2}));
+  test::FillValues<float>(&input_data, {1.0f, 2.0f});
+  Output input_op =
+      Const(root.WithOpName("input_op"), Input::Initializer(input_data));
+  Tensor weights_data(DT_FLOAT, TensorShape({2, 2}));
+  test::FillValues<float>(&weights_data, {1.0f, 2.0f, 3.0f, 4.0f});
+  Output weights_op =
+      Const(root.WithOpName("weights_op"), Input::Initializer(weights_data));
+  Output matmul_op = MatMul(root.WithOpName("output"), input_op, weights_op);
+  GraphDef original_graph_def;
+  TF_ASSERT_OK(root.ToGraphDef(&original_graph_def));
+
+  TransformFuncContext context;
+  context.output_names = {"output"};
+  GraphDef quantized_graph_def;
+  TF_ASSERT_OK(
+      QuantizeMatMulWeights(original_graph_def, context, &quantized_graph_def));
+  std::map<string, const NodeDef*> node_lookup;
+  MapNamesToNodes(quantized_graph_def, &node_lookup);
+  EXPECT_EQ("MatMul", node_lookup.at("output")->op());
+  EXPECT_EQ(1, node_lookup.count("weights_op"));
+}
+
+}  // namespace graph_transforms
+}  // namespace tensorflow
@@ -0,0 +1,101 @@
+# Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+"""Runs the C++ benchmarks of a suite and diffs them against a baseline.
+
+The benchmarks of the test binaries, registered with test_benchmark.h, are
+run pinned to a set of CPUs, with repetitions giving a confidence interval of
+their times. The results are written in a JSON of a stable schema, and the
+benchmarks whose interval moved above the one of the baseline fail the run:
+
+  bazel run //tensorflow/tools/test:matmul_regression_benchmark -- \\
+      --output_json=/tmp/matmul.json --baseline_json=/tmp/matmul_old.json
+"""
+
+import json
+import os
+import sys
+
+from absl import app
+from absl import flags
+
+from tensorflow.tools.test import benchmark_regression_lib
+
+FLAGS = flags.FLAGS
+
+flags.DEFINE_string("suite", "", "Name of the suite of benchmarks.")
+flags.DEFINE_multi_string("benchmark_binaries", [],
+                          "Test binaries whose benchmarks are run.")
+flags.DEFINE_string("benchmark_filter", "all",
+                    "Regular expression selecting the benchmarks to run.")
+flags.DEFINE_integer("repetitions", 10,
+                     "Number of measures of each benchmark.")
+flags.DEFINE_float("min_time", None,
+                   "Minimum time in seconds of each repetition.")
+flags.DEFINE_string(
+    "cpus", "",
+    "CPUs the benchmarks are pinned to, e.g. 0-3,8. Defaults to the CPUs the "
+    "runner is allowed on.")
+flags.DEFINE_string(
+    "output_json", "",
+    "File the results are written to. Defaults to the undeclared outputs "
+    "of the test, or the standard output.")
+flags.DEFINE_string("baseline_json", "",
+                    "Results of a previous run the benchmarks are diffed "
+                    "against.")
+flags.DEFINE_float(
+    "regression_threshold", 0.05,
+    "Relative change of the mean time under which a benchmark is unchanged.")
+flags.DEFINE_enum("metric", "cpu_time_ns", ["cpu_time_ns", "real_time_ns"],
+                  "Time the benchmarks are diffed on.")
+
+
+def main(unused_args):
+  cpus = benchmark_regression_lib.parse_cpus(FLAGS.cpus)
+  results = benchmark_regression_lib.run_suite(
+      FLAGS.suite,
+      FLAGS.benchmark_binaries,
+      FLAGS.benchmark_filter,
+      FLAGS.repetitions,
+      cpus,
+      min_time=FLAGS.min_time)
+  content = json.dumps(results, indent=2, sort_keys=True)
+
+  output_json = FLAGS.output_json
+  if not output_json and "TEST_UNDECLARED_OUTPUTS_DIR" in os.environ:
+    output_json = os.path.join(os.environ["TEST_UNDECLARED_OUTPUTS_DIR"],
+                               "%s.json" % (FLAGS.suite or "benchmarks"))
+  if output_json:
+    with open(output_json, "w") as f:
+      f.write(content)
+    print("Results written to: %s" % output_json)
+  else:
+    print(content)
+
+  if not FLAGS.baseline_json:
+    return
+  with open(FLAGS.baseline_json) as f:
+    baseline = json.load(f)
+  diffs = benchmark_regression_lib.compare(
+      baseline,
+      results,
+      threshold=FLAGS.regression_threshold,
+      metric=FLAGS.metric)
+  print(benchmark_regression_lib.format_diffs(diffs))
+  if any(diff["status"] == "regression" for diff in diffs):
+    sys.exit(1)
+
+
+if __name__ == "__main__":
+  app.run(main)
@@ -0,0 +1,263 @@
+# Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+"""Library running the C++ benchmarks of a suite and diffing them."""
+
+import json
+import math
+import os
+import subprocess
+import tempfile
+
+# The version of the schema of the results, bumped on incompatible changes.
+SCHEMA_VERSION = 1
+
+# The number of threads of the pools of the benchmarks, set to the number of
+# pinned CPUs so that the results don't depend on the machine.
+_THREAD_ENV_VARS = ("OMP_NUM_THREADS", "TF_NUM_INTEROP_THREADS",
+                    "TF_NUM_INTRAOP_THREADS")
+
+_NANOS_PER_UNIT = {"ns": 1, "us": 1e3, "ms": 1e6, "s": 1e9}
+
+# The two-sided 95% critical values of the Student t distribution, by degrees
+# of freedom.
+_T_CRITICAL_VALUES = ((1, 12.706), (2, 4.303), (3, 3.182), (4, 2.776),
+                      (5, 2.571), (6, 2.447), (7, 2.365), (8, 2.306),
+                      (9, 2.262), (10, 2.228), (15, 2.131), (20, 2.086),
+                      (30, 2.042), (60, 2.000), (120, 1.980))
+
+_METRICS = ("real_time_ns", "cpu_time_ns")
+
+
+def t_critical_value(degrees_of_freedom):
+  """Returns the 95% critical value, rounding the degrees of freedom down."""
+  value = _T_CRITICAL_VALUES[0][1]
+  for dof, critical_value in _T_CRITICAL_VALUES:
+    if dof <= degrees_of_freedom:
+      value = critical_value
+  return value
+
+
+def summarize(samples):
+  """Returns the mean of `samples` with its 95% confidence interval."""
+  n = len(samples)
+  mean = sum(samples) / n
+  if n < 2:
+    return {"mean": mean, "stddev": 0.0, "ci_low": mean, "ci_high": mean}
+  stddev = math.sqrt(sum((x - mean)**2 for x in samples) / (n - 1))
+  half_width = t_critical_value(n - 1) * stddev / math.sqrt(n)
+  return {
+      "mean": mean,
+      "stddev": stddev,
+      "ci_low": mean - half_width,
+      "ci_high": mean + half_width
+  }
+
+
+def parse_benchmark_output(content, prefix=""):
+  """Parses the JSON output of a google benchmark binary.
+
+  Args:
+    content: The JSON written with --benchmark_out_format=json.
+    prefix: Prepended to the names of the benchmarks.
+
+  Returns:
+    A tuple (context, benchmarks), where context is the description of the
+    machine by the benchmark library and benchmarks the summaries of the
+    repetitions of each benchmark, sorted by name.
+  """
+  output = json.loads(content)
+  runs = {}
+  for run in output.get("benchmarks", []):
+    # The aggregates computed by the library are recomputed with the
+    # intervals.
+    if run.get("run_type", "iteration") != "iteration":
+      continue
+    if run.get("error_occurred"):
+      continue
+    name = prefix + run.get("run_name", run["name"])
+    nanos_per_unit = _NANOS_PER_UNIT[run.get("time_unit", "ns")]
+    samples = runs.setdefault(name, {
+        "iterations": 0,
+        "real_time_ns": [],
+        "cpu_time_ns": []
+    })
+    samples["iterations"] += run["iterations"]
+    samples["real_time_ns"].append(run["real_time"] * nanos_per_unit)
+    samples["cpu_time_ns"].append(run["cpu_time"] * nanos_per_unit)
+  benchmarks = []
+  for name in sorted(runs):
+    samples = runs[name]
+    benchmark = {
+        "name": name,
+        "repetitions": len(samples["real_time_ns"]),
+        "iterations": samples["iterations"],
+    }
+    for metric in _METRICS:
+      benchmark[metric] = summarize(samples[metric])
+    benchmarks.append(benchmark)
+  return output.get("context", {}), benchmarks
+
+
+def parse_cpus(cpus):
+  """Parses a list of CPUs such as "0-3,8", or returns the allowed ones."""
+  if not cpus:
+    return sorted(os.sched_getaffinity(0))
+  result = set()
+  for part in cpus.split(","):
+    first, _, last = part.partition("-")
+    result.update(range(int(first), int(last or first) + 1))
+  return sorted(result)
+
+
+def pinned_environment(cpus):
+  """Returns the environment of the benchmarks pinned to `cpus`."""
+  env = dict(os.environ)
+  for var in _THREAD_ENV_VARS:
+    env[var] = str(len(cpus))
+  return env
+
+
+def list_benchmarks(binary, benchmark_filter):
+  """Returns the names of the benchmarks of `binary` matching the filter."""
+  output = subprocess.check_output([
+      binary,
+      "--benchmark_filter=%s" % benchmark_filter,
+      "--benchmark_list_tests=true",
+  ], universal_newlines=True)
+  return [line.strip() for line in output.splitlines() if line.strip()]
+
+
+def run_benchmarks(binary, benchmark_filter, repetitions, cpus,
+                   min_time=None):
+  """Runs the benchmarks of `binary` pinned to `cpus`.
+
+  Args:
+    binary: The path of a test binary defining benchmarks, e.g. a
+      tf_cc_test.
+    benchmark_filter: The regular expression selecting the benchmarks.
+    repetitions: The number of times each benchmark is measured.
+    cpus: The CPUs the benchmarks run on.
+    min_time: The minimum time in seconds of each repetition, or None for the
+      default of the library.
+
+  Returns:
+    A tuple (context, benchmarks) as returned by parse_benchmark_output.
+  """
+  with tempfile.NamedTemporaryFile(suffix=".json") as output_file:
+    args = [
+        binary,
+        "--benchmark_filter=%s" % benchmark_filter,
+        "--benchmark_repetitions=%d" % repetitions,
+        "--benchmark_out=%s" % output_file.name,
+        "--benchmark_out_format=json",
+    ]
+    if min_time is not None:
+      args.append("--benchmark_min_time=%g" % min_time)
+    subprocess.check_call(
+        args,
+        env=pinned_environment(cpus),
+        preexec_fn=lambda: os.sched_setaffinity(0, cpus))
+    with open(output_file.name) as f:
+      content = f.read()
+  return parse_benchmark_output(
+      content, prefix=os.path.basename(binary) + ".")
+
+
+def run_suite(suite, binaries, benchmark_filter, repetitions, cpus,
+              min_time=None):
+  """Runs the benchmarks of `binaries` and returns the results of the suite."""
+  results = {
+      "schema_version": SCHEMA_VERSION,
+      "suite": suite,
+      "environment": {
+          "cpus": cpus,
+          "env": {var: str(len(cpus)) for var in _THREAD_ENV_VARS},
+          "binaries": [os.path.basename(binary) for binary in binaries],
+      },
+      "benchmarks": [],
+  }
+  for binary in binaries:
+    if not list_benchmarks(binary, benchmark_filter):
+      continue
+    context, benchmarks = run_benchmarks(binary, benchmark_filter,
+                                         repetitions, cpus, min_time)
+    results["environment"].setdefault("context", context)
+    results["benchmarks"].extend(benchmarks)
+  results["benchmarks"].sort(key=lambda benchmark: benchmark["name"])
+  return results
+
+
+def compare(baseline, current, threshold=0.05, metric="cpu_time_ns"):
+  """Diffs the results of a suite against its baseline.
+
+  A benchmark regressed if its confidence interval is above the one of the
+  baseline and its mean grew by more than `threshold`, and conversely for
+  the improvements.
+
+  Args:
+    baseline: The results of the suite used as reference.
+    current: The results of the suite to check.
+    threshold: The relative change of the mean under which the benchmarks
+      are unchanged.
+    metric: "cpu_time_ns" or "real_time_ns".
+
+  Returns:
+    The list of the diffs of the benchmarks, sorted by name.
+
+  Raises:
+    ValueError: If the results have different schema versions.
+  """
+  if baseline.get("schema_version") != current.get("schema_version"):
+    raise ValueError(
+        "Cannot compare results of schema versions %s and %s" %
+        (baseline.get("schema_version"), current.get("schema_version")))
+  baseline_benchmarks = {b["name"]: b for b in baseline["benchmarks"]}
+  current_benchmarks = {b["name"]: b for b in current["benchmarks"]}
+  diffs = []
+  for name in sorted(set(baseline_benchmarks) | set(current_benchmarks)):
+    diff = {"name": name}
+    if name not in current_benchmarks:
+      diff["status"] = "missing"
+    elif name not in baseline_benchmarks:
+      diff["status"] = "new"
+    else:
+      old = baseline_benchmarks[name][metric]
+      new = current_benchmarks[name][metric]
+      change = (new["mean"] - old["mean"]) / old["mean"] if old["mean"] else 0
+      diff["baseline_mean"] = old["mean"]
+      diff["current_mean"] = new["mean"]
+      diff["change"] = change
+      if new["ci_low"] > old["ci_high"] and change > threshold:
+        diff["status"] = "regression"
+      elif new["ci_high"] < old["ci_low"] and change < -threshold:
+        diff["status"] = "improvement"
+      else:
+        diff["status"] = "unchanged"
+    diffs.append(diff)
+  return diffs
+
+
+def format_diffs(diffs):
+  """Returns a table of the diffs of the benchmarks which changed."""
+  lines = []
+  for diff in diffs:
+    if diff["status"] == "unchanged":
+      continue
+    if "change" in diff:
+      lines.append("%-12s %+7.1f%%  %s" %
+                   (diff["status"], 100 * diff["change"], diff["name"]))
+    else:
+      lines.append("%-12s %8s  %s" % (diff["status"], "", diff["name"]))
+  return "\n".join(lines)
@@ -0,0 +1,126 @@
+# Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+"""Tests for benchmark_regression_lib."""
+
+import json
+
+from tensorflow.python.platform import googletest
+from tensorflow.tools.test import benchmark_regression_lib
+
+
+def _benchmark_output(name, cpu_times, time_unit="ns"):
+  runs = [{
+      "name": name,
+      "run_name": name,
+      "run_type": "iteration",
+      "repetition_index": i,
+      "iterations": 100,
+      "real_time": cpu_time,
+      "cpu_time": cpu_time,
+      "time_unit": time_unit,
+  } for i, cpu_time in enumerate(cpu_times)]
+  runs.append({
+      "name": name + "_mean",
+      "run_name": name,
+      "run_type": "aggregate",
+      "aggregate_name": "mean",
+      "iterations": 100,
+      "real_time": 0,
+      "cpu_time": 0,
+      "time_unit": time_unit,
+  })
+  return json.dumps({"context": {"num_cpus": 8}, "benchmarks": runs})
+
+
+def _results(benchmarks):
+  return {
+      "schema_version": benchmark_regression_lib.SCHEMA_VERSION,
+      "benchmarks": benchmarks,
+  }
+
+
+class BenchmarkRegressionLibTest(googletest.TestCase):
+
+  def testSummarize(self):
+    summary = benchmark_regression_lib.summarize([9.0, 10.0, 11.0])
+    self.assertEqual(summary["mean"], 10.0)
+    self.assertEqual(summary["stddev"], 1.0)
+    # t(2) * 1 / sqrt(3).
+    self.assertAlmostEqual(summary["ci_high"] - summary["mean"], 2.484, 3)
+    self.assertAlmostEqual(summary["mean"] - summary["ci_low"], 2.484, 3)
+
+  def testSummarizeSingleSample(self):
+    summary = benchmark_regression_lib.summarize([5.0])
+    self.assertEqual(summary["ci_low"], 5.0)
+    self.assertEqual(summary["ci_high"], 5.0)
+
+  def testTCriticalValueRoundsDown(self):
+    self.assertEqual(benchmark_regression_lib.t_critical_value(12), 2.228)
+    self.assertEqual(benchmark_regression_lib.t_critical_value(1000), 1.980)
+
+  def testParseBenchmarkOutput(self):
+    context, benchmarks = benchmark_regression_lib.parse_benchmark_output(
+        _benchmark_output("BM_MatMul/8", [1.0, 2.0, 3.0], time_unit="us"),
+        prefix="matmul_op_test.")
+    self.assertEqual(context, {"num_cpus": 8})
+    self.assertLen(benchmarks, 1)
+    benchmark = benchmarks[0]
+    self.assertEqual(benchmark["name"], "matmul_op_test.BM_MatMul/8")
+    self.assertEqual(benchmark["repetitions"], 3)
+    self.assertEqual(benchmark["iterations"], 300)
+    self.assertEqual(benchmark["cpu_time_ns"]["mean"], 2000.0)
+    self.assertEqual(benchmark["real_time_ns"]["stddev"], 1000.0)
+
+  def testParseCpus(self):
+    self.assertEqual(benchmark_regression_lib.parse_cpus("0-3,8"),
+                     [0, 1, 2, 3, 8])
+    self.assertEqual(benchmark_regression_lib.parse_cpus("2"), [2])
+
+  def testCompare(self):
+
+    def benchmark(name, cpu_times):
+      return benchmark_regression_lib.parse_benchmark_output(
+          _benchmark_output(name, cpu_times))[1][0]
+
+    baseline = _results([
+        benchmark("BM_Faster", [100.0, 101.0, 99.0]),
+        benchmark("BM_Noisy", [100.0, 150.0, 50.0]),
+        benchmark("BM_Removed", [100.0]),
+        benchmark("BM_Slower", [100.0, 101.0, 99.0]),
+    ])
+    current = _results([
+        benchmark("BM_Added", [100.0]),
+        benchmark("BM_Faster", [80.0, 81.0, 79.0]),
+        benchmark("BM_Noisy", [120.0, 170.0, 70.0]),
+        benchmark("BM_Slower", [120.0, 121.0, 119.0]),
+    ])
+    diffs = benchmark_regression_lib.compare(baseline, current)
+    self.assertEqual([(diff["name"], diff["status"]) for diff in diffs],
+                     [("BM_Added", "new"), ("BM_Faster", "improvement"),
+                      ("BM_Noisy", "unchanged"), ("BM_Removed", "missing"),
+                      ("BM_Slower", "regression")])
+    self.assertAlmostEqual(diffs[4]["change"], 0.2)
+    self.assertIn("BM_Slower", benchmark_regression_lib.format_diffs(diffs))
+    self.assertNotIn("BM_Noisy", benchmark_regression_lib.format_diffs(diffs))
+
+  def testCompareRejectsOtherSchemaVersions(self):
+    current = _results([])
+    baseline = dict(current, schema_version=0)
+    with self.assertRaises(ValueError):
+      benchmark_regression_lib.compare(baseline, current)
+
+
+if __name__ == "__main__":
+  googletest.main()
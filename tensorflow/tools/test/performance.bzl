@@ -58,6 +58,48 @@ def tf_cc_logged_benchmark(
         **kwargs
     )
 
+# Create a target running the benchmarks of TensorFlow C++ tests (tf_cc_*_test)
+# pinned to CPUs, and failing if they regressed from the baseline when given.
+def tf_cc_regression_benchmark(
+        name = None,
+        targets = [],
+        benchmark_filter = "all",
+        repetitions = 10,
+        cpus = "",
+        baseline = None,
+        tags = [],
+        **kwargs):
+    if not name:
+        fail("Must provide a name")
+    if not targets:
+        fail("Must provide targets")
+
+    all_tags = tags + ["benchmark-test", "local", "manual", "regression-test"]
+    args = [
+        "--suite=" + name,
+        "--benchmark_filter=" + benchmark_filter,
+        "--repetitions=%d" % repetitions,
+        "--cpus=" + cpus,
+    ] + ["--benchmark_binaries=$(rootpath %s)" % target for target in targets]
+    data = list(targets)
+    if baseline:
+        args.append("--baseline_json=$(rootpath %s)" % baseline)
+        data.append(baseline)
+
+    tf_py_strict_test(
+        name = name,
+        tags = all_tags,
+        size = "large",
+        srcs = ["//tensorflow/tools/test:benchmark_regression.py"],
+        args = args,
+        data = data,
+        main = "//tensorflow/tools/test:benchmark_regression.py",
+        deps = [
+            "//tensorflow/tools/test:benchmark_regression_main_lib",
+        ],
+        **kwargs
+    )
+
 def add_benchmark_tag_to_kwargs(kwargs):
     """Adds the `benchmark-test` tag to the kwargs, if not already present.
 
@@ -15,12 +15,31 @@ limitations under the License.
 
 #include "tsl/lib/io/buffered_inputstream.h"
 
+#include <cstring>
+
 #include "absl/status/status.h"
 #include "tsl/lib/io/random_inputstream.h"
 
 namespace tsl {
 namespace io {
 
+namespace {
+
+// Appends the bytes in [begin, end) to `result`, except the '\r' characters.
+template <typename StringType>
+void AppendWithoutCarriageReturns(const char* begin, const char* end,
+                                  StringType* result) {
+  while (begin != end) {
+    const char* cr =
+        static_cast<const char*>(std::memchr(begin, '\r', end - begin));
+    const char* piece_end = cr != nullptr ? cr : end;
+    result->append(begin, piece_end - begin);
+    begin = cr != nullptr ? cr + 1 : end;
+  }
+}
+
+}  // namespace
+
 BufferedInputStream::BufferedInputStream(InputStreamInterface* input_stream,
                                          size_t buffer_bytes,
                                          bool owns_input_stream)
@@ -61,32 +80,31 @@ absl::Status BufferedInputStream::ReadLineHelper(StringType* result,
                                                  bool include_eol) {
   result->clear();
   absl::Status s;
-  size_t start_pos = pos_;
   while (true) {
     if (pos_ == limit_) {
-      result->append(buf_.data() + start_pos, pos_ - start_pos);
       // Get more data into buffer
       s = FillBuffer();
       if (limit_ == 0) {
         break;
       }
-      start_pos = pos_;
-    }
-    char c = buf_[pos_];
-    if (c == '\n') {
-      result->append(buf_.data() + start_pos, pos_ - start_pos);
-      if (include_eol) {
-        result->append(1, c);
-      }
-      pos_++;
-      return absl::OkStatus();
     }
+    // memchr scans the buffer many bytes at a time, which is much faster than
+    // checking the bytes one by one on long lines.
+    const char* begin = buf_.data() + pos_;
+    const char* end = buf_.data() + limit_;
+    const char* eol =
+        static_cast<const char*>(std::memchr(begin, '\n', end - begin));
     // We don't append '\r' to *result
-    if (c == '\r') {
-      result->append(buf_.data() + start_pos, pos_ - start_pos);
-      start_pos = pos_ + 1;
+    AppendWithoutCarriageReturns(begin, eol != nullptr ? eol : end, result);
+    if (eol == nullptr) {
+      pos_ = limit_;
+      continue;
     }
-    pos_++;
+    if (include_eol) {
+      result->append(1, '\n');
+    }
+    pos_ = eol - buf_.data() + 1;
+    return absl::OkStatus();
   }
   if (absl::IsOutOfRange(s) && !result->empty()) {
     return absl::OkStatus();
@@ -240,11 +258,15 @@ absl::Status BufferedInputStream::SkipLine() {
         break;
       }
     }
-    char c = buf_[pos_++];
     skipped = true;
-    if (c == '\n') {
-      return absl::OkStatus();
+    const char* eol = static_cast<const char*>(
+        std::memchr(buf_.data() + pos_, '\n', limit_ - pos_));
+    if (eol == nullptr) {
+      pos_ = limit_;
+      continue;
     }
+    pos_ = eol - buf_.data() + 1;
+    return absl::OkStatus();
   }
   if (absl::IsOutOfRange(s) && skipped) {
     return absl::OkStatus();
@@ -17,6 +17,8 @@ limitations under the License.
 
 #include <limits.h>
 
+#include <utility>
+
 #include "tsl/lib/hash/crc32c.h"
 #include "tsl/lib/io/buffered_inputstream.h"
 #include "tsl/lib/io/compression.h"
@@ -102,6 +104,7 @@ inline const char* GetChecksumErrorSuffix(uint64 offset) {
 // a reminder about the file format is added, because TFRecord files
 // contain no explicit format marker.
 absl::Status RecordReader::ReadChecksummed(uint64 offset, size_t n,
+                                           bool verify_checksum,
                                            tstring* result) {
   if (n >= SIZE_MAX - sizeof(uint32)) {
     return errors::DataLoss("record size too large",
@@ -120,10 +123,12 @@ absl::Status RecordReader::ReadChecksummed(uint64 offset, size_t n,
     }
   }
 
-  const uint32 masked_crc = core::DecodeFixed32(result->data() + n);
-  if (crc32c::Unmask(masked_crc) != crc32c::Value(result->data(), n)) {
-    return errors::DataLoss("corrupted record at ", offset,
-                            GetChecksumErrorSuffix(offset));
+  if (verify_checksum) {
+    const uint32 masked_crc = core::DecodeFixed32(result->data() + n);
+    if (crc32c::Unmask(masked_crc) != crc32c::Value(result->data(), n)) {
+      return errors::DataLoss("corrupted record at ", offset,
+                              GetChecksumErrorSuffix(offset));
+    }
   }
   result->resize(n);
   return absl::OkStatus();
@@ -149,7 +154,8 @@ absl::Status RecordReader::GetMetadata(Metadata* md) {
     tstring record;
     while (true) {
       // Read header, containing size of data.
-      absl::Status s = ReadChecksummed(offset, sizeof(uint64), &record);
+      absl::Status s = ReadChecksummed(offset, sizeof(uint64),
+                                       /*verify_checksum=*/true, &record);
       if (!s.ok()) {
         if (errors::IsOutOfRange(s)) {
           // We should reach out of range when the record file is complete.
@@ -201,7 +207,8 @@ absl::Status RecordReader::ReadRecord(uint64* offset, tstring* record) {
   TF_RETURN_IF_ERROR(PositionInputStream(*offset));
 
   // Read header data.
-  absl::Status s = ReadChecksummed(*offset, sizeof(uint64), record);
+  absl::Status s = ReadChecksummed(*offset, sizeof(uint64),
+                                   /*verify_checksum=*/true, record);
   if (!s.ok()) {
     last_read_failed_ = true;
     return s;
@@ -209,7 +216,8 @@ absl::Status RecordReader::ReadRecord(uint64* offset, tstring* record) {
   const uint64 length = core::DecodeFixed64(record->data());
 
   // Read data
-  s = ReadChecksummed(*offset + kHeaderSize, length, record);
+  s = ReadChecksummed(*offset + kHeaderSize, length, options_.verify_checksum,
+                      record);
   if (!s.ok()) {
     last_read_failed_ = true;
     if (errors::IsOutOfRange(s)) {
@@ -232,7 +240,8 @@ absl::Status RecordReader::SkipRecords(uint64* offset, int num_to_skip,
   tstring record;
   *num_skipped = 0;
   for (int i = 0; i < num_to_skip; ++i) {
-    s = ReadChecksummed(*offset, sizeof(uint64), &record);
+    s = ReadChecksummed(*offset, sizeof(uint64), /*verify_checksum=*/true,
+                        &record);
     if (!s.ok()) {
       last_read_failed_ = true;
       return s;
@@ -256,6 +265,68 @@ absl::Status RecordReader::SkipRecords(uint64* offset, int num_to_skip,
   return absl::OkStatus();
 }
 
+MemmappedRecordReader::MemmappedRecordReader(
+    std::shared_ptr<ReadOnlyMemoryRegion> region,
+    const RecordReaderOptions& options)
+    : region_(std::move(region)),
+      data_(static_cast<const char*>(region_->data())),
+      size_(region_->length()),
+      verify_checksum_(options.verify_checksum) {}
+
+absl::Status MemmappedRecordReader::ReadHeader(uint64 offset, uint64* length) {
+  if (offset >= size_) {
+    return errors::OutOfRange("eof", GetChecksumErrorSuffix(offset));
+  }
+  if (size_ - offset < RecordReader::kHeaderSize) {
+    return errors::DataLoss("truncated record at ", offset,
+                            GetChecksumErrorSuffix(offset));
+  }
+  const char* header = data_ + offset;
+  const uint32 masked_crc = core::DecodeFixed32(header + sizeof(uint64));
+  if (crc32c::Unmask(masked_crc) != crc32c::Value(header, sizeof(uint64))) {
+    return errors::DataLoss("corrupted record at ", offset,
+                            GetChecksumErrorSuffix(offset));
+  }
+  *length = core::DecodeFixed64(header);
+  // Checked separately to avoid overflowing `offset + record size`.
+  if (*length > size_ - offset - RecordReader::kHeaderSize ||
+      size_ - offset - RecordReader::kHeaderSize - *length <
+          RecordReader::kFooterSize) {
+    return errors::DataLoss("truncated record at ", offset);
+  }
+  return absl::OkStatus();
+}
+
+absl::Status MemmappedRecordReader::ReadRecord(uint64* offset,
+                                               absl::string_view* record) {
+  uint64 length;
+  TF_RETURN_IF_ERROR(ReadHeader(*offset, &length));
+  const char* payload = data_ + *offset + RecordReader::kHeaderSize;
+  if (verify_checksum_) {
+    const uint32 masked_crc = core::DecodeFixed32(payload + length);
+    if (crc32c::Unmask(masked_crc) != crc32c::Value(payload, length)) {
+      return errors::DataLoss("corrupted record at ", *offset,
+                              GetChecksumErrorSuffix(*offset));
+    }
+  }
+  *record = absl::string_view(payload, length);
+  *offset += RecordReader::kHeaderSize + length + RecordReader::kFooterSize;
+  return absl::OkStatus();
+}
+
+absl::Status MemmappedRecordReader::SkipRecords(uint64* offset,
+                                                int num_to_skip,
+                                                int* num_skipped) {
+  *num_skipped = 0;
+  for (int i = 0; i < num_to_skip; ++i) {
+    uint64 length;
+    TF_RETURN_IF_ERROR(ReadHeader(*offset, &length));
+    *offset += RecordReader::kHeaderSize + length + RecordReader::kFooterSize;
+    (*num_skipped)++;
+  }
+  return absl::OkStatus();
+}
+
 SequentialRecordReader::SequentialRecordReader(
     RandomAccessFile* file, const RecordReaderOptions& options)
     : underlying_(file, options), offset_(0) {}
@@ -16,6 +16,9 @@ limitations under the License.
 #ifndef TENSORFLOW_TSL_LIB_IO_RECORD_READER_H_
 #define TENSORFLOW_TSL_LIB_IO_RECORD_READER_H_
 
+#include <memory>
+
+#include "absl/strings/string_view.h"
 #include "tsl/lib/io/inputstream_interface.h"
 #include "tsl/platform/errors.h"
 #include "tsl/platform/stringpiece.h"
@@ -30,6 +33,7 @@ limitations under the License.
 
 namespace tsl {
 class RandomAccessFile;
+class ReadOnlyMemoryRegion;
 
 namespace io {
 
@@ -46,6 +50,11 @@ struct RecordReaderOptions {
   // compressed files.) Consider using SequentialRecordReader.
   int64_t buffer_size = 0;
 
+  // If false, the CRC of record payloads is not verified. The CRC of the
+  // length header is always verified, so that a corrupted length cannot make
+  // the reader run past the end of the record.
+  bool verify_checksum = true;
+
   static RecordReaderOptions CreateRecordReaderOptions(
       const string& compression_type);
 
@@ -115,7 +124,8 @@ class RecordReader {
   absl::Status GetMetadata(Metadata* md);
 
  private:
-  absl::Status ReadChecksummed(uint64 offset, size_t n, tstring* result);
+  absl::Status ReadChecksummed(uint64 offset, size_t n, bool verify_checksum,
+                               tstring* result);
   absl::Status PositionInputStream(uint64 offset);
 
   RecordReaderOptions options_;
@@ -128,6 +138,46 @@ class RecordReader {
   void operator=(const RecordReader&) = delete;
 };
 
+// Interface to read uncompressed TFRecord files from a memory-mapped region
+// without copying. The records returned by `ReadRecord()` are views into the
+// mapping, and remain valid for as long as `region()` is alive.
+//
+// Note: this class is not thread safe; external synchronization required.
+class MemmappedRecordReader {
+ public:
+  // `region` must hold the contents of an uncompressed TFRecord file. Only
+  // `RecordReaderOptions::verify_checksum` is used from `options`.
+  explicit MemmappedRecordReader(
+      std::shared_ptr<ReadOnlyMemoryRegion> region,
+      const RecordReaderOptions& options = RecordReaderOptions());
+
+  // Sets *record to a view of the record at "*offset" and updates *offset to
+  // point to the offset of the next record. Returns OK on success,
+  // OUT_OF_RANGE for end of file, or something else for an error.
+  absl::Status ReadRecord(uint64* offset, absl::string_view* record);
+
+  // Same as `RecordReader::SkipRecords()`.
+  absl::Status SkipRecords(uint64* offset, int num_to_skip, int* num_skipped);
+
+  // The mapping that backs the records returned by `ReadRecord()`.
+  const std::shared_ptr<ReadOnlyMemoryRegion>& region() const {
+    return region_;
+  }
+
+ private:
+  // Reads and validates the header of the record at `offset`, and returns the
+  // length of its payload in `*length`.
+  absl::Status ReadHeader(uint64 offset, uint64* length);
+
+  const std::shared_ptr<ReadOnlyMemoryRegion> region_;
+  const char* const data_;
+  const uint64 size_;
+  const bool verify_checksum_;
+
+  MemmappedRecordReader(const MemmappedRecordReader&) = delete;
+  void operator=(const MemmappedRecordReader&) = delete;
+};
+
 // High-level interface to read TFRecord files.
 //
 // Note: this class is not thread safe; external synchronization required.
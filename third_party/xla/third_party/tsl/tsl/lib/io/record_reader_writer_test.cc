@@ -267,6 +267,138 @@ TEST(RecordReaderWriterTest, TestMalformedInput) {
   }
 }
 
+// Writes `records` to `fname`, then flips the last byte of the payload of
+// the record at index `corrupt_index` (if non-negative).
+void WriteRecordsAndCorrupt(const string& fname,
+                            const std::vector<string>& records,
+                            int corrupt_index) {
+  Env* env = Env::Default();
+  string contents;
+  {
+    std::unique_ptr<WritableFile> file;
+    TF_CHECK_OK(env->NewWritableFile(fname, &file));
+    io::RecordWriter writer(file.get());
+    for (const string& record : records) {
+      TF_CHECK_OK(writer.WriteRecord(record));
+    }
+    TF_CHECK_OK(writer.Close());
+    TF_CHECK_OK(file->Close());
+  }
+  if (corrupt_index < 0) return;
+  TF_CHECK_OK(ReadFileToString(env, fname, &contents));
+  size_t offset = 0;
+  for (int i = 0; i <= corrupt_index; ++i) {
+    offset += io::RecordReader::kHeaderSize + records[i].size() +
+              io::RecordReader::kFooterSize;
+  }
+  contents[offset - io::RecordReader::kFooterSize - 1] ^= 1;
+  TF_CHECK_OK(WriteStringToFile(env, fname, contents));
+}
+
+TEST(RecordReaderWriterTest, TestSkipChecksumVerification) {
+  string fname = testing::TmpDir() + "/record_reader_writer_skip_crc_test";
+  WriteRecordsAndCorrupt(fname, {"abc", "defg"}, /*corrupt_index=*/1);
+
+  std::unique_ptr<RandomAccessFile> read_file;
+  TF_CHECK_OK(Env::Default()->NewRandomAccessFile(fname, &read_file));
+  {
+    io::RecordReader reader(read_file.get());
+    uint64 offset = 0;
+    tstring record;
+    TF_CHECK_OK(reader.ReadRecord(&offset, &record));
+    EXPECT_EQ(error::DATA_LOSS, reader.ReadRecord(&offset, &record).code());
+  }
+  {
+    io::RecordReaderOptions options;
+    options.verify_checksum = false;
+    io::RecordReader reader(read_file.get(), options);
+    uint64 offset = 0;
+    tstring record;
+    TF_CHECK_OK(reader.ReadRecord(&offset, &record));
+    EXPECT_EQ("abc", record);
+    TF_CHECK_OK(reader.ReadRecord(&offset, &record));
+    EXPECT_EQ("deff", record);
+  }
+}
+
+TEST(RecordReaderWriterTest, TestMemmapped) {
+  string fname = testing::TmpDir() + "/record_reader_writer_memmapped_test";
+  WriteRecordsAndCorrupt(fname, {"abc", "", "defg", "hij"},
+                         /*corrupt_index=*/-1);
+
+  std::unique_ptr<ReadOnlyMemoryRegion> region;
+  TF_CHECK_OK(Env::Default()->NewReadOnlyMemoryRegionFromFile(fname, &region));
+  io::MemmappedRecordReader reader(std::move(region));
+  const char* begin = static_cast<const char*>(reader.region()->data());
+  const char* end = begin + reader.region()->length();
+
+  uint64 offset = 0;
+  absl::string_view record;
+  TF_CHECK_OK(reader.ReadRecord(&offset, &record));
+  EXPECT_EQ("abc", record);
+  // The record is a view into the mapping.
+  EXPECT_GE(record.data(), begin);
+  EXPECT_LE(record.data() + record.size(), end);
+  TF_CHECK_OK(reader.ReadRecord(&offset, &record));
+  EXPECT_EQ("", record);
+
+  int num_skipped;
+  TF_CHECK_OK(reader.SkipRecords(&offset, 1, &num_skipped));
+  EXPECT_EQ(1, num_skipped);
+  TF_CHECK_OK(reader.ReadRecord(&offset, &record));
+  EXPECT_EQ("hij", record);
+  EXPECT_EQ(error::OUT_OF_RANGE, reader.ReadRecord(&offset, &record).code());
+  EXPECT_EQ(offset, reader.region()->length());
+}
+
+TEST(RecordReaderWriterTest, TestMemmappedChecksum) {
+  string fname =
+      testing::TmpDir() + "/record_reader_writer_memmapped_crc_test";
+  WriteRecordsAndCorrupt(fname, {"abc", "defg"}, /*corrupt_index=*/0);
+
+  for (bool verify_checksum : {true, false}) {
+    std::unique_ptr<ReadOnlyMemoryRegion> region;
+    TF_CHECK_OK(
+        Env::Default()->NewReadOnlyMemoryRegionFromFile(fname, &region));
+    io::RecordReaderOptions options;
+    options.verify_checksum = verify_checksum;
+    io::MemmappedRecordReader reader(std::move(region), options);
+    uint64 offset = 0;
+    absl::string_view record;
+    absl::Status s = reader.ReadRecord(&offset, &record);
+    if (verify_checksum) {
+      EXPECT_EQ(error::DATA_LOSS, s.code());
+      EXPECT_EQ("corrupted record at 0 (Is this even a TFRecord file?)",
+                s.message());
+    } else {
+      TF_CHECK_OK(s);
+      EXPECT_EQ("abb", record);
+      TF_CHECK_OK(reader.ReadRecord(&offset, &record));
+      EXPECT_EQ("defg", record);
+    }
+  }
+}
+
+TEST(RecordReaderWriterTest, TestMemmappedTruncated) {
+  Env* env = Env::Default();
+  string fname =
+      testing::TmpDir() + "/record_reader_writer_memmapped_truncated_test";
+  WriteRecordsAndCorrupt(fname, {"abcdefgh"}, /*corrupt_index=*/-1);
+  string contents;
+  TF_CHECK_OK(ReadFileToString(env, fname, &contents));
+  contents.resize(contents.size() - 1);
+  TF_CHECK_OK(WriteStringToFile(env, fname, contents));
+
+  std::unique_ptr<ReadOnlyMemoryRegion> region;
+  TF_CHECK_OK(env->NewReadOnlyMemoryRegionFromFile(fname, &region));
+  io::MemmappedRecordReader reader(std::move(region));
+  uint64 offset = 0;
+  absl::string_view record;
+  absl::Status s = reader.ReadRecord(&offset, &record);
+  EXPECT_EQ(error::DATA_LOSS, s.code());
+  EXPECT_EQ("truncated record at 0", s.message());
+}
+
 TEST(RecordReaderWriterTest, TestSnappy) {
   Env* env = Env::Default();
   string fname = testing::TmpDir() + "/record_reader_writer_snappy_test";
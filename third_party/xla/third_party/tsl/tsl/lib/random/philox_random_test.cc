@@ -69,6 +69,34 @@ TEST(PhiloxRandomTest, SkipMatchTest) {
   }
 }
 
+// This test checks that generating a batch of samples is equivalent to
+// generating them one at a time, including across a carry of the counter.
+TEST(PhiloxRandomTest, GenerateBatchMatchTest) {
+  constexpr int kBatchSize = 8;
+  const uint64 test_seed = GetTestSeed();
+  for (uint64 skip : {uint64{0}, uint64{0xfffffffd}, ~uint64{0} - 2}) {
+    PhiloxRandom batch_gen(test_seed);
+    batch_gen.Skip(skip);
+    PhiloxRandom gen = batch_gen;
+
+    PhiloxRandom::ResultType batch[kBatchSize];
+    for (int iteration = 0; iteration < 2; ++iteration) {
+      batch_gen.GenerateBatch<kBatchSize>(batch);
+      for (int i = 0; i < kBatchSize; ++i) {
+        const PhiloxRandom::ResultType expected = gen();
+        for (int j = 0; j < PhiloxRandom::kResultElementCount; ++j) {
+          ASSERT_EQ(expected[j], batch[i][j]);
+        }
+      }
+    }
+    const PhiloxRandom::ResultType expected = gen();
+    const PhiloxRandom::ResultType next = batch_gen();
+    for (int j = 0; j < PhiloxRandom::kResultElementCount; ++j) {
+      ASSERT_EQ(expected[j], next[j]);
+    }
+  }
+}
+
 }  // namespace
 }  // namespace random
 }  // namespace tsl
@@ -75,8 +75,11 @@ class UniformDistribution<Generator, Eigen::half> {
   typedef Eigen::half ResultElementType;
 
   PHILOX_DEVICE_INLINE
-  ResultType operator()(Generator* gen) {
-    typename Generator::ResultType sample = (*gen)();
+  ResultType operator()(Generator* gen) { return FromSample((*gen)()); }
+
+  // Returns the results computed from one invocation of the generator.
+  PHILOX_DEVICE_INLINE
+  ResultType FromSample(const typename Generator::ResultType& sample) {
     ResultType result;
     for (int i = 0; i < kResultElementCount; ++i) {
       result[i] = Uint16ToHalf(sample[i]);  // Truncate the upper 16 bits.
@@ -99,8 +102,11 @@ class UniformDistribution<Generator, bfloat16> {
   typedef bfloat16 ResultElementType;
 
   PHILOX_DEVICE_INLINE
-  ResultType operator()(Generator* gen) {
-    typename Generator::ResultType sample = (*gen)();
+  ResultType operator()(Generator* gen) { return FromSample((*gen)()); }
+
+  // Returns the results computed from one invocation of the generator.
+  PHILOX_DEVICE_INLINE
+  ResultType FromSample(const typename Generator::ResultType& sample) {
     ResultType result;
     for (int i = 0; i < kResultElementCount; ++i) {
       result[i] = Uint16ToGfloat16(sample[i]);
@@ -123,8 +129,11 @@ class UniformDistribution<Generator, float> {
   typedef float ResultElementType;
 
   PHILOX_DEVICE_INLINE
-  ResultType operator()(Generator* gen) {
-    typename Generator::ResultType sample = (*gen)();
+  ResultType operator()(Generator* gen) { return FromSample((*gen)()); }
+
+  // Returns the results computed from one invocation of the generator.
+  PHILOX_DEVICE_INLINE
+  ResultType FromSample(const typename Generator::ResultType& sample) {
     ResultType result;
     for (int i = 0; i < kResultElementCount; ++i) {
       result[i] = Uint32ToFloat(sample[i]);
@@ -147,8 +156,11 @@ class UniformDistribution<Generator, double> {
   typedef double ResultElementType;
 
   PHILOX_DEVICE_INLINE
-  ResultType operator()(Generator* gen) {
-    typename Generator::ResultType sample = (*gen)();
+  ResultType operator()(Generator* gen) { return FromSample((*gen)()); }
+
+  // Returns the results computed from one invocation of the generator.
+  PHILOX_DEVICE_INLINE
+  ResultType FromSample(const typename Generator::ResultType& sample) {
     ResultType result;
     for (int i = 0; i < kResultElementCount; ++i) {
       result[i] = Uint64ToDouble(sample[2 * i], sample[2 * i + 1]);
@@ -175,8 +187,11 @@ class UniformDistribution<Generator, int32> {
       : lo_(lo), range_(static_cast<uint32>(hi) - static_cast<uint32>(lo)) {}
 
   PHILOX_DEVICE_INLINE
-  ResultType operator()(Generator* gen) {
-    typename Generator::ResultType sample = (*gen)();
+  ResultType operator()(Generator* gen) { return FromSample((*gen)()); }
+
+  // Returns the results computed from one invocation of the generator.
+  PHILOX_DEVICE_INLINE
+  ResultType FromSample(const typename Generator::ResultType& sample) {
     ResultType result;
     for (int i = 0; i < kResultElementCount; ++i) {
       result[i] = SignedAdd(lo_, sample[i] % range_);
@@ -210,8 +225,11 @@ class UniformDistribution<Generator, int64_t> {
       : lo_(lo), range_(static_cast<uint64>(hi) - static_cast<uint64>(lo)) {}
 
   PHILOX_DEVICE_INLINE
-  ResultType operator()(Generator* gen) {
-    typename Generator::ResultType sample = (*gen)();
+  ResultType operator()(Generator* gen) { return FromSample((*gen)()); }
+
+  // Returns the results computed from one invocation of the generator.
+  PHILOX_DEVICE_INLINE
+  ResultType FromSample(const typename Generator::ResultType& sample) {
     ResultType result;
     for (int i = 0; i < kResultElementCount; ++i) {
       auto bits = sample[2 * i] | static_cast<uint64>(sample[2 * i + 1]) << 32;
@@ -248,8 +266,11 @@ class UniformFullIntDistribution32 {
   typedef IntType ResultElementType;
 
   PHILOX_DEVICE_INLINE
-  ResultType operator()(Generator* gen) {
-    typename Generator::ResultType sample = (*gen)();
+  ResultType operator()(Generator* gen) { return FromSample((*gen)()); }
+
+  // Returns the results computed from one invocation of the generator.
+  PHILOX_DEVICE_INLINE
+  ResultType FromSample(const typename Generator::ResultType& sample) {
     ResultType result;
     for (int i = 0; i < kResultElementCount; ++i) {
       result[i] = sample[i];
@@ -272,8 +293,11 @@ class UniformFullIntDistribution64 {
   typedef IntType ResultElementType;
 
   PHILOX_DEVICE_INLINE
-  ResultType operator()(Generator* gen) {
-    typename Generator::ResultType sample = (*gen)();
+  ResultType operator()(Generator* gen) { return FromSample((*gen)()); }
+
+  // Returns the results computed from one invocation of the generator.
+  PHILOX_DEVICE_INLINE
+  ResultType FromSample(const typename Generator::ResultType& sample) {
     ResultType result;
     for (int i = 0; i < kResultElementCount; ++i) {
       result[i] = sample[2 * i] | static_cast<uint64>(sample[2 * i + 1]) << 32;
@@ -392,8 +416,11 @@ class NormalDistribution<Generator, Eigen::half> {
   typedef Eigen::half ResultElementType;
 
   PHILOX_DEVICE_INLINE
-  ResultType operator()(Generator* gen) {
-    typename Generator::ResultType sample = (*gen)();
+  ResultType operator()(Generator* gen) { return FromSample((*gen)()); }
+
+  // Returns the results computed from one invocation of the generator.
+  PHILOX_DEVICE_INLINE
+  ResultType FromSample(const typename Generator::ResultType& sample) {
     ResultType result;
     for (int i = 0; i < kResultElementCount; i += 2) {
       float f[2];
@@ -419,8 +446,11 @@ class NormalDistribution<Generator, bfloat16> {
   typedef bfloat16 ResultElementType;
 
   PHILOX_DEVICE_INLINE
-  ResultType operator()(Generator* gen) {
-    typename Generator::ResultType sample = (*gen)();
+  ResultType operator()(Generator* gen) { return FromSample((*gen)()); }
+
+  // Returns the results computed from one invocation of the generator.
+  PHILOX_DEVICE_INLINE
+  ResultType FromSample(const typename Generator::ResultType& sample) {
     ResultType result;
     static_assert(kResultElementCount % 2 == 0,
                   "kResultElementCount should be an even number");
@@ -449,8 +479,11 @@ class NormalDistribution<Generator, float> {
   typedef float ResultElementType;
 
   PHILOX_DEVICE_INLINE
-  ResultType operator()(Generator* gen) {
-    typename Generator::ResultType sample = (*gen)();
+  ResultType operator()(Generator* gen) { return FromSample((*gen)()); }
+
+  // Returns the results computed from one invocation of the generator.
+  PHILOX_DEVICE_INLINE
+  ResultType FromSample(const typename Generator::ResultType& sample) {
     ResultType result;
     for (int i = 0; i < kResultElementCount; i += 2) {
       BoxMullerFloat(sample[i], sample[i + 1], &result[i], &result[i + 1]);
@@ -473,8 +506,11 @@ class NormalDistribution<Generator, double> {
   typedef double ResultElementType;
 
   PHILOX_DEVICE_INLINE
-  ResultType operator()(Generator* gen) {
-    typename Generator::ResultType sample = (*gen)();
+  ResultType operator()(Generator* gen) { return FromSample((*gen)()); }
+
+  // Returns the results computed from one invocation of the generator.
+  PHILOX_DEVICE_INLINE
+  ResultType FromSample(const typename Generator::ResultType& sample) {
     ResultType result;
     for (int i = 0; i < kResultElementCount; i += 2) {
       const int i2 = 2 * i;
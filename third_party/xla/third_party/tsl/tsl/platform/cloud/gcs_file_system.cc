@@ -41,6 +41,7 @@ limitations under the License.
 #endif
 #include "absl/base/macros.h"
 #include "json/json.h"
+#include "tsl/platform/blocking_counter.h"
 #include "tsl/platform/cloud/curl_http_request.h"
 #include "tsl/platform/cloud/file_block_cache.h"
 #include "tsl/platform/cloud/google_auth_provider.h"
@@ -73,6 +74,8 @@ constexpr char kStorageHost[] = "storage.googleapis.com";
 constexpr char kBucketMetadataLocationKey[] = "location";
 constexpr size_t kReadAppendableFileBufferSize = 1024 * 1024;  // In bytes.
 constexpr int kGetChildrenDefaultPageSize = 1000;
+// The maximum number of source objects of a compose request.
+constexpr size_t kMaxComposeSources = 32;
 // The HTTP response code "308 Resume Incomplete".
 constexpr uint64 HTTP_CODE_RESUME_INCOMPLETE = 308;
 // The HTTP response code "412 Precondition Failed".
@@ -350,11 +353,20 @@ class BufferedGcsRandomAccessFile : public RandomAccessFile {
   // Initialize the reader. Provided read_fn should be thread safe.
   BufferedGcsRandomAccessFile(const string& filename, uint64 buffer_size,
                               ReadFn read_fn)
+      : BufferedGcsRandomAccessFile(filename, buffer_size, buffer_size,
+                                    std::move(read_fn)) {}
+
+  // Initialize a reader whose buffer starts at `min_buffer_size` bytes, and
+  // doubles up to `buffer_size` bytes while the reads are sequential.
+  BufferedGcsRandomAccessFile(const string& filename, uint64 buffer_size,
+                              uint64 min_buffer_size, ReadFn read_fn)
       : filename_(filename),
         read_fn_(std::move(read_fn)),
         buffer_size_(buffer_size),
+        min_buffer_size_(std::min(min_buffer_size, buffer_size)),
         buffer_start_(0),
-        buffer_end_is_past_eof_(false) {}
+        buffer_end_is_past_eof_(false),
+        current_buffer_size_(min_buffer_size_) {}
 
   absl::Status Name(absl::string_view* result) const override {
     *result = filename_;
@@ -381,7 +393,7 @@ class BufferedGcsRandomAccessFile : public RandomAccessFile {
       bool consumed_buffer_to_eof =
           offset + copy_size >= buffer_end && buffer_end_is_past_eof_;
       if (copy_size < n && !consumed_buffer_to_eof) {
-        absl::Status status = FillBuffer(offset + copy_size);
+        absl::Status status = FillBuffer(offset + copy_size, n - copy_size);
         if (!status.ok() && !absl::IsOutOfRange(status)) {
           // Empty the buffer to avoid caching bad reads.
           buffer_.resize(0);
@@ -404,12 +416,20 @@ class BufferedGcsRandomAccessFile : public RandomAccessFile {
   }
 
  private:
-  absl::Status FillBuffer(uint64 start) const
+  // Fills the buffer from `start` with at least `min_size` bytes.
+  absl::Status FillBuffer(uint64 start, size_t min_size) const
       TF_EXCLUSIVE_LOCKS_REQUIRED(buffer_mutex_) {
+    // A streaming reader gets larger buffers, a seek starts over.
+    if (!buffer_.empty() && start == buffer_start_ + buffer_.size()) {
+      current_buffer_size_ = std::min(2 * current_buffer_size_, buffer_size_);
+    } else {
+      current_buffer_size_ = min_buffer_size_;
+    }
+    const uint64 fill_size = std::max<uint64>(current_buffer_size_, min_size);
     buffer_start_ = start;
-    buffer_.resize(buffer_size_);
+    buffer_.resize(fill_size);
     absl::string_view str_piece;
-    absl::Status status = read_fn_(filename_, buffer_start_, buffer_size_,
+    absl::Status status = read_fn_(filename_, buffer_start_, fill_size,
                                    &str_piece, &(buffer_[0]));
     buffer_end_is_past_eof_ = absl::IsOutOfRange(status);
     buffer_.resize(str_piece.size());
@@ -422,9 +442,12 @@ class BufferedGcsRandomAccessFile : public RandomAccessFile {
   // The implementation of the read operation (provided by the GCSFileSystem).
   const ReadFn read_fn_;
 
-  // Size of buffer that we read from GCS each time we send a request.
+  // Maximum size of buffer that we read from GCS each time we send a request.
   const uint64 buffer_size_;
 
+  // Size of the buffer after a seek.
+  const uint64 min_buffer_size_;
+
   // Mutex for buffering operations that can be accessed from multiple threads.
   // The following members are mutable in order to provide a const Read.
   mutable mutex buffer_mutex_;
@@ -434,6 +457,8 @@ class BufferedGcsRandomAccessFile : public RandomAccessFile {
 
   mutable bool buffer_end_is_past_eof_ TF_GUARDED_BY(buffer_mutex_);
 
+  mutable uint64 current_buffer_size_ TF_GUARDED_BY(buffer_mutex_);
+
   mutable string buffer_ TF_GUARDED_BY(buffer_mutex_);
 };
 
@@ -462,6 +487,12 @@ typedef std::function<absl::Status(const string& fname, const string& bucket,
                                    const string& object, int64_t* generation)>
     GenerationGetter;
 
+// Function object declaration with params needed to upload the chunks of the
+// parallel composite uploads.
+typedef std::function<absl::Status(const string& bucket, const string& object,
+                                   absl::string_view data)>
+    ChunkUploader;
+
 /// \brief GCS-based implementation of a writeable file.
 ///
 /// Since GCS objects are immutable, this implementation writes to a local
@@ -532,9 +563,27 @@ class GcsWritableFile : public WritableFile {
 
   ~GcsWritableFile() override {
     Close().IgnoreError();
+    if (parallel_chunk_size_ > 0) AbandonParallelUpload();
     std::remove(tmp_content_filename_.c_str());
   }
 
+  /// \brief Uploads the chunks of `chunk_size` bytes of the file to temporary
+  /// objects as soon as they are appended, on `thread_pool`, and composes them
+  /// into the object on close.
+  ///
+  /// Up to `max_chunks_in_flight` chunks are uploaded at once, Append() waits
+  /// for an upload to finish beyond. The whole file is still written to the
+  /// local tmp file, and uploaded from it instead if a chunk upload fails or
+  /// if the file is flushed before close.
+  void EnableParallelUpload(uint64 chunk_size, int max_chunks_in_flight,
+                            thread::ThreadPool* thread_pool,
+                            ChunkUploader chunk_uploader) {
+    parallel_chunk_size_ = chunk_size;
+    max_chunks_in_flight_ = std::max(max_chunks_in_flight, 1);
+    upload_thread_pool_ = thread_pool;
+    chunk_uploader_ = std::move(chunk_uploader);
+  }
+
   absl::Status Append(absl::string_view data) override {
     TF_RETURN_IF_ERROR(CheckWritable());
     VLOG(3) << "Append: " << GetGcsPath() << " size " << data.length();
@@ -544,13 +593,15 @@ class GcsWritableFile : public WritableFile {
       return errors::Internal(
           "Could not append to the internal temporary file.");
     }
+    if (parallel_chunk_size_ > 0) AppendToChunks(data);
     return absl::OkStatus();
   }
 
   absl::Status Close() override {
     VLOG(3) << "Close:" << GetGcsPath();
     if (outfile_.is_open()) {
-      absl::Status sync_status = Sync();
+      absl::Status sync_status =
+          parallel_chunk_size_ > 0 ? SyncParallelUpload() : Sync();
       if (sync_status.ok()) {
         outfile_.close();
       }
@@ -575,6 +626,9 @@ class GcsWritableFile : public WritableFile {
     if (!sync_needed_) {
       return absl::OkStatus();
     }
+    // The object must contain the data written so far, which the chunks
+    // don't, so the whole file is uploaded from now on.
+    if (parallel_chunk_size_ > 0) AbandonParallelUpload();
     absl::Status status = SyncImpl();
     VLOG(3) << "Sync finished " << GetGcsPath();
     if (status.ok()) {
@@ -663,6 +717,167 @@ class GcsWritableFile : public WritableFile {
     return upload_status;
   }
 
+  /// Appends `data` to the chunk being filled, and starts the upload of the
+  /// chunks that are full.
+  void AppendToChunks(absl::string_view data) {
+    absl::Status chunks_status;
+    {
+      mutex_lock l(chunks_mu_);
+      chunks_status = chunks_status_;
+    }
+    if (!chunks_status.ok()) {
+      LOG(WARNING) << "Parallel upload to " << GetGcsPath()
+                   << " failed, uploading the whole file on close instead: "
+                   << chunks_status;
+      AbandonParallelUpload();
+      return;
+    }
+    while (!data.empty()) {
+      const size_t size = std::min<size_t>(
+          data.size(), parallel_chunk_size_ - current_chunk_.size());
+      current_chunk_.append(data.data(), size);
+      data.remove_prefix(size);
+      if (current_chunk_.size() == parallel_chunk_size_) StartChunkUpload();
+    }
+  }
+
+  /// Returns the name of the temporary object of the next chunk.
+  string AddChunkObject() {
+    chunk_objects_.push_back(
+        strings::StrCat(io::Dirname(object_), "/.tmpparallel/",
+                        io::Basename(object_), ".", chunk_objects_.size()));
+    return chunk_objects_.back();
+  }
+
+  /// Starts the upload of `current_chunk_` to a new temporary object, once
+  /// fewer than `max_chunks_in_flight_` chunks are being uploaded.
+  void StartChunkUpload() {
+    const string chunk_object = AddChunkObject();
+    auto chunk = std::make_shared<string>(std::move(current_chunk_));
+    current_chunk_.clear();
+    mutex_lock l(chunks_mu_);
+    while (chunks_in_flight_ >= max_chunks_in_flight_) {
+      chunks_cv_.wait(l);
+    }
+    ++chunks_in_flight_;
+    upload_thread_pool_->Schedule([this, chunk_object, chunk]() {
+      absl::Status status = chunk_uploader_(bucket_, chunk_object, *chunk);
+      mutex_lock l(chunks_mu_);
+      chunks_status_.Update(status);
+      --chunks_in_flight_;
+      chunks_cv_.notify_all();
+    });
+  }
+
+  /// Waits for the chunk uploads in flight, and returns their first error.
+  absl::Status WaitForChunkUploads() {
+    mutex_lock l(chunks_mu_);
+    while (chunks_in_flight_ > 0) {
+      chunks_cv_.wait(l);
+    }
+    return chunks_status_;
+  }
+
+  /// Uploads the last chunk and composes the chunks into the object. If this
+  /// fails, falls back to the upload of the whole file.
+  absl::Status SyncParallelUpload() {
+    TF_RETURN_IF_ERROR(CheckWritable());
+    if (!sync_needed_) {
+      return absl::OkStatus();
+    }
+    // The files smaller than a chunk are uploaded with a single request.
+    if (chunk_objects_.empty()) return Sync();
+    absl::Status status = ComposeChunks();
+    if (status.ok()) {
+      sync_needed_ = false;
+      DeleteChunkObjects();
+      parallel_chunk_size_ = 0;
+      return absl::OkStatus();
+    }
+    LOG(WARNING) << "Parallel upload to " << GetGcsPath()
+                 << " failed, uploading the whole file instead: " << status;
+    return Sync();
+  }
+
+  absl::Status ComposeChunks() {
+    outfile_.flush();
+    if (!outfile_.good()) {
+      return errors::Internal(
+          "Could not write to the internal temporary file.");
+    }
+    TF_RETURN_IF_ERROR(WaitForChunkUploads());
+    if (!current_chunk_.empty()) {
+      TF_RETURN_IF_ERROR(
+          chunk_uploader_(bucket_, AddChunkObject(), current_chunk_));
+      current_chunk_.clear();
+    }
+    // A compose request has a limited number of sources, so the chunks past
+    // the first ones are appended to the object by the following requests.
+    for (size_t i = 0; i < chunk_objects_.size();) {
+      string sources;
+      if (i > 0) sources = strings::StrCat("{'name': '", object_, "'}");
+      for (size_t num_sources = i > 0 ? 1 : 0;
+           num_sources < kMaxComposeSources && i < chunk_objects_.size();
+           ++num_sources, ++i) {
+        strings::StrAppend(&sources, sources.empty() ? "" : ",",
+                           "{'name': '", chunk_objects_[i], "'}");
+      }
+      TF_RETURN_IF_ERROR(ComposeObjects(sources));
+    }
+    // Erase the file from the file cache on every successful write.
+    file_cache_erase_();
+    return absl::OkStatus();
+  }
+
+  /// Writes the composition of the `sources` JSON objects to the object.
+  absl::Status ComposeObjects(const string& sources) {
+    VLOG(3) << "ComposeObjects: " << sources << " to " << GetGcsPath();
+    return RetryingUtils::CallWithRetries(
+        [&sources, this]() {
+          std::unique_ptr<HttpRequest> request;
+          TF_RETURN_IF_ERROR(filesystem_->CreateHttpRequest(&request));
+
+          request->SetUri(strings::StrCat(kGcsUriBase, "b/", bucket_, "/o/",
+                                          request->EscapeString(object_),
+                                          "/compose"));
+
+          const string request_body =
+              strings::StrCat("{'sourceObjects': [", sources, "]}");
+          request->SetTimeouts(timeouts_->connect, timeouts_->idle,
+                               timeouts_->metadata);
+          request->AddHeader("content-type", "application/json");
+          request->SetPostFromBuffer(request_body.c_str(), request_body.size());
+          TF_RETURN_WITH_CONTEXT_IF_ERROR(request->Send(),
+                                          " when composing to ", GetGcsPath());
+          return absl::OkStatus();
+        },
+        retry_config_);
+  }
+
+  /// Stops the parallel upload and deletes its temporary objects.
+  void AbandonParallelUpload() {
+    WaitForChunkUploads().IgnoreError();
+    DeleteChunkObjects();
+    current_chunk_.clear();
+    parallel_chunk_size_ = 0;
+  }
+
+  void DeleteChunkObjects() {
+    for (const string& chunk_object : chunk_objects_) {
+      const string chunk_object_path = GetGcsPathWithObject(chunk_object);
+      absl::Status status = RetryingUtils::DeleteWithRetries(
+          [&chunk_object_path, this]() {
+            return filesystem_->DeleteFile(chunk_object_path, nullptr);
+          },
+          retry_config_);
+      if (!status.ok() && !absl::IsNotFound(status)) {
+        LOG(WARNING) << "Could not delete the temporary object "
+                     << chunk_object_path << ": " << status;
+      }
+    }
+    chunk_objects_.clear();
+  }
+
   absl::Status CheckWritable() const {
     if (!outfile_.is_open()) {
       return errors::FailedPrecondition(
@@ -783,6 +998,20 @@ class GcsWritableFile : public WritableFile {
   const ObjectUploader object_uploader_;
   const StatusPoller status_poller_;
   const GenerationGetter generation_getter_;
+
+  // The chunk size of the parallel upload, or 0 if it is disabled.
+  uint64 parallel_chunk_size_ = 0;
+  int max_chunks_in_flight_ = 1;
+  thread::ThreadPool* upload_thread_pool_ = nullptr;  // Not owned.
+  ChunkUploader chunk_uploader_;
+  // The data appended since the last full chunk.
+  string current_chunk_;
+  // The temporary objects of the chunks, in the order of the file.
+  std::vector<string> chunk_objects_;
+  mutex chunks_mu_;
+  condition_variable chunks_cv_;
+  int chunks_in_flight_ TF_GUARDED_BY(chunks_mu_) = 0;
+  absl::Status chunks_status_ TF_GUARDED_BY(chunks_mu_);
 };
 
 class GcsReadOnlyMemoryRegion : public ReadOnlyMemoryRegion {
@@ -978,6 +1207,22 @@ GcsFileSystem::GcsFileSystem(bool make_default_cache) {
     compose_append_ = false;
   }
 
+  int32 readahead_parallelism;
+  if (GetEnvVar(kReadaheadParallelism, strings::safe_strto32,
+                &readahead_parallelism)) {
+    SetReadaheadParallelism(readahead_parallelism);
+  }
+
+  uint64 parallel_upload_chunk_size_mb;
+  if (GetEnvVar(kParallelUploadChunkSize, strings::safe_strtou64,
+                &parallel_upload_chunk_size_mb)) {
+    int32 parallel_upload_threads = kDefaultParallelUploadThreads;
+    GetEnvVar(kParallelUploadThreads, strings::safe_strto32,
+              &parallel_upload_threads);
+    SetParallelUpload(parallel_upload_chunk_size_mb * 1024 * 1024,
+                      parallel_upload_threads);
+  }
+
   retry_config_ = GetGcsRetryConfig();
 }
 
@@ -1046,14 +1291,18 @@ absl::Status GcsFileSystem::NewRandomAccessFile(
       return absl::OkStatus();
     }));
   } else {
+    // The read buffer only adapts to the access pattern with readahead.
+    const uint64 min_buffer_size = readahead_parallelism_ > 1
+                                       ? readahead_min_buffer_size_
+                                       : block_size_;
     result->reset(new BufferedGcsRandomAccessFile(
-        fname, block_size_,
+        fname, block_size_, min_buffer_size,
         [this, bucket, object](const string& fname, uint64 offset, size_t n,
                                absl::string_view* result, char* scratch) {
           *result = absl::string_view();
           size_t bytes_transferred;
-          TF_RETURN_IF_ERROR(
-              LoadBufferFromGCS(fname, offset, n, scratch, &bytes_transferred));
+          TF_RETURN_IF_ERROR(LoadBufferFromGCSInParallel(
+              fname, offset, n, scratch, &bytes_transferred));
           *result = absl::string_view(scratch, bytes_transferred);
           if (bytes_transferred < n) {
             return errors::OutOfRange("EOF reached, ", result->size(),
@@ -1066,6 +1315,31 @@ absl::Status GcsFileSystem::NewRandomAccessFile(
   return absl::OkStatus();
 }
 
+void GcsFileSystem::SetReadaheadParallelism(int parallelism,
+                                            size_t min_buffer_size) {
+  readahead_parallelism_ = std::max(parallelism, 1);
+  readahead_min_buffer_size_ = std::max<size_t>(min_buffer_size, 1);
+  readahead_thread_pool_.reset();
+  if (readahead_parallelism_ > 1) {
+    readahead_thread_pool_ = std::make_unique<thread::ThreadPool>(
+        Env::Default(), "gcs_readahead", readahead_parallelism_ - 1);
+  }
+  VLOG(1) << "GCS readahead parallelism = " << readahead_parallelism_ << " ; "
+          << "min buffer size = " << readahead_min_buffer_size_;
+}
+
+void GcsFileSystem::SetParallelUpload(size_t chunk_size, int num_threads) {
+  parallel_upload_chunk_size_ = chunk_size;
+  parallel_upload_threads_ = std::max(num_threads, 1);
+  upload_thread_pool_.reset();
+  if (parallel_upload_chunk_size_ > 0) {
+    upload_thread_pool_ = std::make_unique<thread::ThreadPool>(
+        Env::Default(), "gcs_upload", parallel_upload_threads_);
+  }
+  VLOG(1) << "GCS parallel upload chunk size = " << parallel_upload_chunk_size_
+          << " ; threads = " << parallel_upload_threads_;
+}
+
 void GcsFileSystem::ResetFileBlockCache(size_t block_size_bytes,
                                         size_t max_bytes,
                                         uint64 max_staleness_secs) {
@@ -1154,6 +1428,108 @@ absl::Status GcsFileSystem::LoadBufferFromGCS(const string& fname,
   return absl::OkStatus();
 }
 
+absl::Status GcsFileSystem::LoadBufferFromGCSInParallel(
+    const string& fname, size_t offset, size_t n, char* buffer,
+    size_t* bytes_transferred) {
+  const size_t max_ranges = std::min<size_t>(
+      readahead_parallelism_,
+      (n + readahead_min_buffer_size_ - 1) / readahead_min_buffer_size_);
+  if (max_ranges <= 1) {
+    return LoadBufferFromGCS(fname, offset, n, buffer, bytes_transferred);
+  }
+  *bytes_transferred = 0;
+
+  string bucket, object;
+  TF_RETURN_IF_ERROR(ParseGcsPath(fname, false, &bucket, &object));
+
+  profiler::TraceMe activity([fname]() {
+    return absl::StrCat("LoadBufferFromGCSInParallel ", fname);
+  });
+
+  // The ranges past the end of the file are empty.
+  const size_t range_size = (n + max_ranges - 1) / max_ranges;
+  const size_t num_ranges = (n + range_size - 1) / range_size;
+  std::vector<std::unique_ptr<HttpRequest>> requests(num_ranges);
+  for (size_t i = 0; i < num_ranges; ++i) {
+    const size_t range_offset = i * range_size;
+    const size_t range_n = std::min(range_size, n - range_offset);
+    TF_RETURN_WITH_CONTEXT_IF_ERROR(CreateHttpRequest(&requests[i]),
+                                    "when reading gs://", bucket, "/", object);
+    HttpRequest* request = requests[i].get();
+    request->SetUri(strings::StrCat("https://", kStorageHost, "/", bucket, "/",
+                                    request->EscapeString(object)));
+    request->SetRange(offset + range_offset,
+                      offset + range_offset + range_n - 1);
+    request->SetResultBufferDirect(buffer + range_offset, range_n);
+    request->SetTimeouts(timeouts_.connect, timeouts_.idle, timeouts_.read);
+    if (stats_ != nullptr) {
+      stats_->RecordBlockLoadRequest(fname, offset + range_offset);
+    }
+  }
+
+  std::vector<absl::Status> statuses(num_ranges);
+  BlockingCounter counter(num_ranges - 1);
+  for (size_t i = 1; i < num_ranges; ++i) {
+    readahead_thread_pool_->Schedule([&requests, &statuses, &counter, i]() {
+      statuses[i] = requests[i]->Send();
+      counter.DecrementCount();
+    });
+  }
+  statuses[0] = requests[0]->Send();
+  counter.Wait();
+
+  size_t bytes_read = 0;
+  for (size_t i = 0; i < num_ranges; ++i) {
+    TF_RETURN_WITH_CONTEXT_IF_ERROR(statuses[i], " when reading gs://", bucket,
+                                    "/", object);
+    const size_t range_bytes =
+        requests[i]->GetResultBufferDirectBytesTransferred();
+    if (stats_ != nullptr) {
+      stats_->RecordBlockRetrieved(fname, offset + i * range_size,
+                                   range_bytes);
+    }
+    throttle_.RecordResponse(range_bytes);
+    if (range_bytes > 0 && bytes_read != i * range_size) {
+      return errors::Internal(strings::Printf(
+          "File contents are inconsistent for file: %s @ %lu.", fname.c_str(),
+          offset + bytes_read));
+    }
+    bytes_read += range_bytes;
+  }
+  *bytes_transferred = bytes_read;
+  VLOG(1) << "Successful read of gs://" << bucket << "/" << object << " @ "
+          << offset << " of size: " << bytes_read << " in " << num_ranges
+          << " ranges";
+
+  if (bytes_read < n) {
+    // Check stat cache to see if we encountered an interrupted read.
+    GcsFileStat stat;
+    if (stat_cache_->Lookup(fname, &stat) &&
+        offset + bytes_read < stat.base.length) {
+      return errors::Internal(strings::Printf(
+          "File contents are inconsistent for file: %s @ %lu.", fname.c_str(),
+          offset));
+    }
+  }
+  return absl::OkStatus();
+}
+
+absl::Status GcsFileSystem::UploadObjectFromBuffer(const string& bucket,
+                                                   const string& object,
+                                                   absl::string_view data) {
+  std::unique_ptr<HttpRequest> request;
+  TF_RETURN_IF_ERROR(CreateHttpRequest(&request));
+
+  request->SetUri(strings::StrCat(kGcsUploadUriBase, "b/", bucket,
+                                  "/o?uploadType=media&name=",
+                                  request->EscapeString(object)));
+  request->SetTimeouts(timeouts_.connect, timeouts_.idle, timeouts_.write);
+  request->SetPostFromBuffer(data.data(), data.size());
+  TF_RETURN_WITH_CONTEXT_IF_ERROR(request->Send(), " when uploading gs://",
+                                  bucket, "/", object);
+  return absl::OkStatus();
+}
+
 /// Initiates a new upload session.
 absl::Status GcsFileSystem::CreateNewUploadSession(
     uint64 start_offset, const std::string& object_to_upload,
@@ -1349,11 +1725,25 @@ absl::Status GcsFileSystem::NewWritableFile(
     return absl::OkStatus();
   };
 
-  result->reset(new GcsWritableFile(
+  auto file = std::make_unique<GcsWritableFile>(
       bucket, object, this, &timeouts_,
       [this, fname]() { ClearFileCaches(fname); }, retry_config_,
       compose_append_, session_creator, object_uploader, status_poller,
-      generation_getter));
+      generation_getter);
+  if (parallel_upload_chunk_size_ > 0) {
+    file->EnableParallelUpload(
+        parallel_upload_chunk_size_, parallel_upload_threads_,
+        upload_thread_pool_.get(),
+        [this](const string& bucket, const string& object,
+               absl::string_view data) {
+          return RetryingUtils::CallWithRetries(
+              [&bucket, &object, data, this]() {
+                return UploadObjectFromBuffer(bucket, object, data);
+              },
+              retry_config_);
+        });
+  }
+  *result = std::move(file);
   return absl::OkStatus();
 }
 
@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_TSL_PLATFORM_CLOUD_GCS_FILE_SYSTEM_H_
 #define TENSORFLOW_TSL_PLATFORM_CLOUD_GCS_FILE_SYSTEM_H_
 
+#include <memory>
 #include <string>
 #include <unordered_set>
 #include <utility>
@@ -32,6 +33,7 @@ limitations under the License.
 #include "tsl/platform/file_system.h"
 #include "tsl/platform/retrying_file_system.h"
 #include "tsl/platform/status.h"
+#include "tsl/platform/threadpool.h"
 
 namespace tsl {
 
@@ -62,6 +64,21 @@ constexpr size_t kDefaultMaxCacheSize = 0;
 // will be evicted on the next read.
 constexpr char kMaxStaleness[] = "GCS_READ_CACHE_MAX_STALENESS";
 constexpr uint64 kDefaultMaxStaleness = 0;
+// The environment variable that sets the number of concurrent range requests
+// issued by the reads that bypass the block cache. With more than one request,
+// the read buffer of a file also starts at kReadaheadMinBufferSize and doubles
+// for sequential reads up to the block size.
+constexpr char kReadaheadParallelism[] = "GCS_READAHEAD_PARALLELISM";
+constexpr size_t kReadaheadMinBufferSize = 1024 * 1024;
+// The environment variable that enables the parallel composite uploads of the
+// new files: the full chunks of this size are uploaded to temporary objects
+// while the file is written, and composed into the file on close. 0 disables
+// them.
+constexpr char kParallelUploadChunkSize[] = "GCS_PARALLEL_UPLOAD_CHUNK_SIZE_MB";
+// The environment variable that sets the number of threads uploading the
+// chunks, which is also the number of chunks of a file uploaded at once.
+constexpr char kParallelUploadThreads[] = "GCS_PARALLEL_UPLOAD_THREADS";
+constexpr int kDefaultParallelUploadThreads = 8;
 
 // Helper function to extract an environment variable and convert it into a
 // value of type T.
@@ -290,6 +307,28 @@ class GcsFileSystem : public FileSystem {
   void ResetFileBlockCache(size_t block_size_bytes, size_t max_bytes,
                            uint64 max_staleness_secs);
 
+  /// \brief Sets the number of concurrent range requests of the reads that
+  /// bypass the block cache, see kReadaheadParallelism.
+  ///
+  /// `min_buffer_size` is the initial size of the read buffers, and the
+  /// minimum size of a range request. This must not be called while the files
+  /// of the file system are read.
+  void SetReadaheadParallelism(
+      int parallelism, size_t min_buffer_size = kReadaheadMinBufferSize);
+
+  int readahead_parallelism() const { return readahead_parallelism_; }
+
+  /// \brief Sets the chunk size and the number of threads of the parallel
+  /// composite uploads, see kParallelUploadChunkSize.
+  ///
+  /// A file being written holds up to `num_threads + 1` chunks in memory. This
+  /// must not be called while files of the file system are written.
+  void SetParallelUpload(size_t chunk_size, int num_threads);
+
+  size_t parallel_upload_chunk_size() const {
+    return parallel_upload_chunk_size_;
+  }
+
  protected:
   virtual std::unique_ptr<FileBlockCache> MakeFileBlockCache(
       size_t block_size, size_t max_bytes, uint64 max_staleness);
@@ -415,6 +454,19 @@ class GcsFileSystem : public FileSystem {
   // Clear all the caches related to the file with name `filename`.
   void ClearFileCaches(const string& fname);
 
+  /// Loads file contents like LoadBufferFromGCS, split into up to
+  /// `readahead_parallelism_` range requests of at least
+  /// `readahead_min_buffer_size_` bytes sent concurrently. The requests are
+  /// created, and admitted by the throttle, on the calling thread.
+  absl::Status LoadBufferFromGCSInParallel(const string& fname, size_t offset,
+                                           size_t n, char* buffer,
+                                           size_t* bytes_transferred);
+
+  /// Uploads `data` to a new object with a single request.
+  absl::Status UploadObjectFromBuffer(const string& bucket,
+                                      const string& object,
+                                      absl::string_view data);
+
   mutex mu_;
   std::unique_ptr<AuthProvider> auth_provider_ TF_GUARDED_BY(mu_);
   std::shared_ptr<HttpRequest::Factory> http_request_factory_;
@@ -430,6 +482,17 @@ class GcsFileSystem : public FileSystem {
       TF_GUARDED_BY(block_cache_lock_);
 
   bool cache_enabled_;
+
+  int readahead_parallelism_ = 1;
+  size_t readahead_min_buffer_size_ = kReadaheadMinBufferSize;
+  // Sends the range requests of LoadBufferFromGCSInParallel but the first.
+  std::unique_ptr<thread::ThreadPool> readahead_thread_pool_;
+
+  size_t parallel_upload_chunk_size_ = 0;
+  int parallel_upload_threads_ = kDefaultParallelUploadThreads;
+  // Uploads the chunks of the parallel composite uploads.
+  std::unique_ptr<thread::ThreadPool> upload_thread_pool_;
+
   std::unique_ptr<GcsDnsCache> dns_cache_;
   GcsThrottle throttle_;
 
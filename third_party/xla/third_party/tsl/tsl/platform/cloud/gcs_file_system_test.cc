@@ -383,6 +383,83 @@ TEST(GcsFileSystemTest, NewRandomAccessFile_Buffered_Growing) {
   EXPECT_EQ("0123456789", result);
 }
 
+TEST(GcsFileSystemTest, NewRandomAccessFile_Buffered_ParallelReadahead) {
+  std::vector<HttpRequest*> requests({
+      new FakeHttpRequest(
+          "Uri: https://storage.googleapis.com/bucket/random_access.txt\n"
+          "Auth Token: fake_token\n"
+          "Range: 0-3\n"
+          "Timeouts: 5 1 20\n",
+          "0123"),
+      new FakeHttpRequest(
+          "Uri: https://storage.googleapis.com/bucket/random_access.txt\n"
+          "Auth Token: fake_token\n"
+          "Range: 4-7\n"
+          "Timeouts: 5 1 20\n",
+          "4567"),
+      new FakeHttpRequest(
+          "Uri: https://storage.googleapis.com/bucket/random_access.txt\n"
+          "Auth Token: fake_token\n"
+          "Range: 8-11\n"
+          "Timeouts: 5 1 20\n",
+          "89ab"),
+      new FakeHttpRequest(
+          "Uri: https://storage.googleapis.com/bucket/random_access.txt\n"
+          "Auth Token: fake_token\n"
+          "Range: 12-19\n"
+          "Timeouts: 5 1 20\n",
+          "cdefghij"),
+      new FakeHttpRequest(
+          "Uri: https://storage.googleapis.com/bucket/random_access.txt\n"
+          "Auth Token: fake_token\n"
+          "Range: 20-27\n"
+          "Timeouts: 5 1 20\n",
+          "klmn"),
+      new FakeHttpRequest(
+          "Uri: https://storage.googleapis.com/bucket/random_access.txt\n"
+          "Auth Token: fake_token\n"
+          "Range: 2-5\n"
+          "Timeouts: 5 1 20\n",
+          "2345"),
+  });
+  GcsFileSystem fs(
+      std::unique_ptr<AuthProvider>(new FakeAuthProvider),
+      std::unique_ptr<HttpRequest::Factory>(
+          new FakeHttpRequestFactory(&requests)),
+      std::unique_ptr<ZoneProvider>(new FakeZoneProvider), 16 /* block size */,
+      0 /* max bytes */, 0 /* max staleness */, 0 /* stat cache max age */,
+      0 /* stat cache max entries */, 0 /* matching paths cache max age */,
+      0 /* matching paths cache max entries */, kTestRetryConfig,
+      kTestTimeoutConfig, *kAllowedLocationsDefault,
+      nullptr /* gcs additional header */, false /* compose append */);
+  fs.SetReadaheadParallelism(2, 4 /* min buffer size */);
+
+  std::unique_ptr<RandomAccessFile> file;
+  TF_EXPECT_OK(
+      fs.NewRandomAccessFile("gs://bucket/random_access.txt", nullptr, &file));
+
+  char scratch[4];
+  absl::string_view result;
+
+  // The first read fills the smallest buffer.
+  TF_EXPECT_OK(file->Read(0, sizeof(scratch), &result, scratch));
+  EXPECT_EQ("0123", result);
+
+  // The sequential reads double the buffer, which is read in two ranges.
+  TF_EXPECT_OK(file->Read(4, sizeof(scratch), &result, scratch));
+  EXPECT_EQ("4567", result);
+  TF_EXPECT_OK(file->Read(8, sizeof(scratch), &result, scratch));
+  EXPECT_EQ("89ab", result);
+
+  // The second range is cut short by the end of the file.
+  TF_EXPECT_OK(file->Read(12, sizeof(scratch), &result, scratch));
+  EXPECT_EQ("cdef", result);
+
+  // A seek starts over with the smallest buffer.
+  TF_EXPECT_OK(file->Read(2, sizeof(scratch), &result, scratch));
+  EXPECT_EQ("2345", result);
+}
+
 TEST(GcsFileSystemTest, NewRandomAccessFile_Buffered_ReadBackwards) {
   // Go backwards in the file. It should trigger a new read.
   std::vector<HttpRequest*> requests(
@@ -995,6 +1072,90 @@ TEST(GcsFileSystemTest, NewWritableFile) {
   TF_EXPECT_OK(wfile->Close());
 }
 
+TEST(GcsFileSystemTest, NewWritableFile_ParallelUpload) {
+  std::vector<HttpRequest*> requests({
+      // The full chunks are uploaded while the file is written, the last one
+      // on close.
+      new FakeHttpRequest(
+          "Uri: https://www.googleapis.com/upload/storage/v1/b/bucket/o?"
+          "uploadType=media&name=path%2F.tmpparallel%2Fwriteable.0\n"
+          "Auth Token: fake_token\n"
+          "Timeouts: 5 1 30\n"
+          "Post body: 0123\n",
+          ""),
+      new FakeHttpRequest(
+          "Uri: https://www.googleapis.com/upload/storage/v1/b/bucket/o?"
+          "uploadType=media&name=path%2F.tmpparallel%2Fwriteable.1\n"
+          "Auth Token: fake_token\n"
+          "Timeouts: 5 1 30\n"
+          "Post body: 4567\n",
+          ""),
+      new FakeHttpRequest(
+          "Uri: https://www.googleapis.com/upload/storage/v1/b/bucket/o?"
+          "uploadType=media&name=path%2F.tmpparallel%2Fwriteable.2\n"
+          "Auth Token: fake_token\n"
+          "Timeouts: 5 1 30\n"
+          "Post body: 89\n",
+          ""),
+      // Compose the chunks into the object.
+      new FakeHttpRequest("Uri: "
+                          "https://www.googleapis.com/storage/v1/b/bucket/o/"
+                          "path%2Fwriteable/compose\n"
+                          "Auth Token: fake_token\n"
+                          "Timeouts: 5 1 10\n"
+                          "Header content-type: application/json\n"
+                          "Post body: {'sourceObjects': ["
+                          "{'name': 'path/.tmpparallel/writeable.0'},"
+                          "{'name': 'path/.tmpparallel/writeable.1'},"
+                          "{'name': 'path/.tmpparallel/writeable.2'}]}\n",
+                          ""),
+      // Delete the temporary objects.
+      new FakeHttpRequest("Uri: "
+                          "https://www.googleapis.com/storage/v1/b/bucket/o/"
+                          "path%2F.tmpparallel%2Fwriteable.0\n"
+                          "Auth Token: fake_token\n"
+                          "Timeouts: 5 1 10\n"
+                          "Delete: yes\n",
+                          ""),
+      new FakeHttpRequest("Uri: "
+                          "https://www.googleapis.com/storage/v1/b/bucket/o/"
+                          "path%2F.tmpparallel%2Fwriteable.1\n"
+                          "Auth Token: fake_token\n"
+                          "Timeouts: 5 1 10\n"
+                          "Delete: yes\n",
+                          ""),
+      new FakeHttpRequest("Uri: "
+                          "https://www.googleapis.com/storage/v1/b/bucket/o/"
+                          "path%2F.tmpparallel%2Fwriteable.2\n"
+                          "Auth Token: fake_token\n"
+                          "Timeouts: 5 1 10\n"
+                          "Delete: yes\n",
+                          ""),
+  });
+  GcsFileSystem fs(
+      std::unique_ptr<AuthProvider>(new FakeAuthProvider),
+      std::unique_ptr<HttpRequest::Factory>(
+          new FakeHttpRequestFactory(&requests)),
+      std::unique_ptr<ZoneProvider>(new FakeZoneProvider), 8 /* block size */,
+      8 /* max bytes */, 0 /* max staleness */, 3600 /* stat cache max age */,
+      0 /* stat cache max entries */, 0 /* matching paths cache max age */,
+      0 /* matching paths cache max entries */, kTestRetryConfig,
+      kTestTimeoutConfig, *kAllowedLocationsDefault,
+      nullptr /* gcs additional header */, false /* compose append */);
+  // A single upload thread keeps the order of the requests deterministic.
+  fs.SetParallelUpload(4 /* chunk size */, 1 /* num threads */);
+
+  std::unique_ptr<WritableFile> wfile;
+  TF_EXPECT_OK(
+      fs.NewWritableFile("gs://bucket/path/writeable", nullptr, &wfile));
+  TF_EXPECT_OK(wfile->Append("012345"));
+  TF_EXPECT_OK(wfile->Append("6789"));
+  int64_t pos;
+  TF_EXPECT_OK(wfile->Tell(&pos));
+  EXPECT_EQ(10, pos);
+  TF_EXPECT_OK(wfile->Close());
+}
+
 TEST(GcsFileSystemTest, NewWritableFile_ResumeUploadSucceeds) {
   std::vector<HttpRequest*> requests(
       {new FakeHttpRequest(
@@ -35,6 +35,7 @@ limitations under the License.
 #include <thread>
 #include <vector>
 
+#include "tsl/platform/default/io_uring_file_system.h"
 #include "tsl/platform/default/posix_file_system.h"
 #include "tsl/platform/env.h"
 #include "tsl/platform/load_library.h"
@@ -251,6 +252,7 @@ class PosixEnv : public Env {
 REGISTER_FILE_SYSTEM("", PosixFileSystem);
 REGISTER_FILE_SYSTEM("file", LocalPosixFileSystem);
 REGISTER_FILE_SYSTEM("ram", RamFileSystem);
+REGISTER_FILE_SYSTEM("uring", IoUringFileSystem);
 
 Env* Env::Default() {
   static Env* default_env = new PosixEnv;
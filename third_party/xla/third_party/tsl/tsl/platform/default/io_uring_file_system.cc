@@ -0,0 +1,343 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tsl/platform/default/io_uring_file_system.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#if defined(__linux__) && defined(__NR_io_uring_setup) && \
+    __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#define TSL_IO_URING_SUPPORTED 1
+#endif
+
+#include "tsl/platform/errors.h"
+#include "tsl/platform/logging.h"
+#include "tsl/platform/status.h"
+
+namespace tsl {
+
+using ::tsl::errors::IOError;
+
+namespace {
+
+// The size of the chunks the large reads are split into.
+constexpr size_t kReadChunkSize = 256 * 1024;
+// The maximum number of chunks in flight for a thread.
+constexpr unsigned kQueueDepth = 64;
+
+// Reads `n` bytes at `offset` with pread() like PosixRandomAccessFile, and
+// sets `bytes_read` to the number of bytes read.
+absl::Status PreadFully(const string& filename, int fd, uint64 offset,
+                        size_t n, char* dst, size_t* bytes_read) {
+  *bytes_read = 0;
+  while (n > 0) {
+    // Some platforms, notably macs, throw EINVAL if pread is asked to read
+    // more than fits in a 32-bit integer.
+    const size_t requested_read_length =
+        std::min<size_t>(n, static_cast<size_t>(INT32_MAX));
+    ssize_t r =
+        pread(fd, dst, requested_read_length, static_cast<off_t>(offset));
+    if (r > 0) {
+      dst += r;
+      n -= r;
+      offset += r;
+      *bytes_read += r;
+    } else if (r == 0) {
+      return absl::Status(absl::StatusCode::kOutOfRange,
+                          "Read less bytes than requested");
+    } else if (errno != EINTR && errno != EAGAIN) {
+      return IOError(filename, errno);
+    }
+  }
+  return absl::OkStatus();
+}
+
+struct ReadChunk {
+  uint64 offset;
+  size_t size;
+  char* dst;
+};
+
+#if defined(TSL_IO_URING_SUPPORTED)
+// A minimal io_uring, only used by the thread that owns it, which reads
+// batches of chunks with the raw system calls.
+class IoUring {
+ public:
+  // Returns the ring of the calling thread, or nullptr if io_uring isn't
+  // available, e.g. on old kernels or in sandboxes.
+  static IoUring* ForCurrentThread() {
+    thread_local std::unique_ptr<IoUring> ring = Create();
+    return ring.get();
+  }
+
+  ~IoUring() {
+    if (sqes_ != MAP_FAILED) munmap(sqes_, sqes_size_);
+    if (cq_ring_ != MAP_FAILED && cq_ring_ != sq_ring_) {
+      munmap(cq_ring_, cq_ring_size_);
+    }
+    if (sq_ring_ != MAP_FAILED) munmap(sq_ring_, sq_ring_size_);
+    close(fd_);
+  }
+
+  // Reads the `chunks` of `fd`, at most kQueueDepth, and sets `results` to
+  // the number of bytes read for each chunk, or to a negated errno. The
+  // chunks the kernel didn't accept are reported as -ECANCELED.
+  void Read(int fd, const std::vector<ReadChunk>& chunks,
+            std::vector<int>* results) {
+    const unsigned count = chunks.size();
+    iovecs_.resize(count);
+    results->assign(count, -ECANCELED);
+
+    // Only this thread writes the tail of the submission queue.
+    unsigned tail = *sq_tail_;
+    for (unsigned i = 0; i < count; ++i, ++tail) {
+      iovecs_[i].iov_base = chunks[i].dst;
+      iovecs_[i].iov_len = chunks[i].size;
+      const unsigned index = tail & sq_mask_;
+      io_uring_sqe* sqe = &sqes_[index];
+      memset(sqe, 0, sizeof(*sqe));
+      sqe->opcode = IORING_OP_READV;
+      sqe->fd = fd;
+      sqe->addr = reinterpret_cast<uint64_t>(&iovecs_[i]);
+      sqe->len = 1;
+      sqe->off = chunks[i].offset;
+      sqe->user_data = i;
+      sq_array_[index] = index;
+    }
+    __atomic_store_n(sq_tail_, tail, __ATOMIC_RELEASE);
+
+    unsigned submitted = 0;
+    while (submitted < count) {
+      const int r = syscall(__NR_io_uring_enter, fd_, count - submitted, 0, 0,
+                            nullptr, 0);
+      if (r > 0) {
+        submitted += r;
+      } else if (r == 0 || errno != EINTR) {
+        break;
+      }
+    }
+    if (submitted < count) {
+      // Drops the entries the kernel didn't consume.
+      __atomic_store_n(sq_tail_, __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE),
+                       __ATOMIC_RELEASE);
+    }
+
+    // The kernel writes to the buffers until the reads complete, so this
+    // waits for all of them.
+    unsigned completed = 0;
+    while (completed < submitted) {
+      unsigned head = *cq_head_;
+      const unsigned cq_tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+      if (head == cq_tail) {
+        const int r = syscall(__NR_io_uring_enter, fd_, 0, 1,
+                              IORING_ENTER_GETEVENTS, nullptr, 0);
+        if (r < 0 && errno != EINTR) {
+          LOG(FATAL) << "io_uring_enter() failed with reads in flight: "
+                     << strerror(errno);
+        }
+        continue;
+      }
+      for (; head != cq_tail; ++head) {
+        const io_uring_cqe& cqe = cqes_[head & cq_mask_];
+        (*results)[cqe.user_data] = cqe.res;
+        ++completed;
+      }
+      __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+    }
+  }
+
+ private:
+  explicit IoUring(int fd) : fd_(fd) {}
+
+  static std::unique_ptr<IoUring> Create() {
+    io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    const int fd = syscall(__NR_io_uring_setup, kQueueDepth, &params);
+    if (fd < 0) {
+      LOG_FIRST_N(WARNING, 1) << "io_uring is not available, reading with "
+                              << "pread() instead: " << strerror(errno);
+      return nullptr;
+    }
+    std::unique_ptr<IoUring> ring(new IoUring(fd));
+    if (!ring->Map(params)) {
+      LOG_FIRST_N(WARNING, 1) << "Could not map the io_uring, reading with "
+                              << "pread() instead: " << strerror(errno);
+      return nullptr;
+    }
+    return ring;
+  }
+
+  bool Map(const io_uring_params& params) {
+    sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cq_ring_size_ =
+        params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    const bool single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+    if (single_mmap) {
+      sq_ring_size_ = cq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+    }
+    sq_ring_ = mmap(nullptr, sq_ring_size_, PROT_READ | PROT_WRITE,
+                    MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_SQ_RING);
+    if (sq_ring_ == MAP_FAILED) return false;
+    cq_ring_ = single_mmap
+                   ? sq_ring_
+                   : mmap(nullptr, cq_ring_size_, PROT_READ | PROT_WRITE,
+                          MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_CQ_RING);
+    if (cq_ring_ == MAP_FAILED) return false;
+    sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+    void* sqes = mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_SQES);
+    if (sqes == MAP_FAILED) return false;
+    sqes_ = static_cast<io_uring_sqe*>(sqes);
+
+    char* sq = static_cast<char*>(sq_ring_);
+    sq_head_ = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+    sq_tail_ = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+    sq_mask_ = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+    sq_array_ = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+    char* cq = static_cast<char*>(cq_ring_);
+    cq_head_ = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+    cq_tail_ = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+    cq_mask_ = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+    cqes_ = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+    return true;
+  }
+
+  const int fd_;
+  void* sq_ring_ = MAP_FAILED;
+  size_t sq_ring_size_ = 0;
+  void* cq_ring_ = MAP_FAILED;
+  size_t cq_ring_size_ = 0;
+  io_uring_sqe* sqes_ = static_cast<io_uring_sqe*>(MAP_FAILED);
+  size_t sqes_size_ = 0;
+
+  unsigned* sq_head_ = nullptr;
+  unsigned* sq_tail_ = nullptr;
+  unsigned sq_mask_ = 0;
+  unsigned* sq_array_ = nullptr;
+  unsigned* cq_head_ = nullptr;
+  unsigned* cq_tail_ = nullptr;
+  unsigned cq_mask_ = 0;
+  io_uring_cqe* cqes_ = nullptr;
+
+  // The buffers of the reads in flight.
+  std::vector<iovec> iovecs_;
+};
+#endif  // TSL_IO_URING_SUPPORTED
+
+// A random access file whose large reads are batches of io_uring reads.
+class IoUringRandomAccessFile : public RandomAccessFile {
+ public:
+  IoUringRandomAccessFile(const string& filename, int fd)
+      : filename_(filename), fd_(fd) {}
+
+  ~IoUringRandomAccessFile() override {
+    if (close(fd_) < 0) {
+      LOG(ERROR) << "close() failed: " << strerror(errno);
+    }
+  }
+
+  absl::Status Name(absl::string_view* result) const override {
+    *result = filename_;
+    return absl::OkStatus();
+  }
+
+  absl::Status Read(uint64 offset, size_t n, absl::string_view* result,
+                    char* scratch) const override {
+    size_t bytes_read = 0;
+    absl::Status s;
+#if defined(TSL_IO_URING_SUPPORTED)
+    IoUring* ring =
+        n >= 2 * kReadChunkSize ? IoUring::ForCurrentThread() : nullptr;
+    if (ring != nullptr) {
+      s = ReadWithIoUring(ring, offset, n, scratch, &bytes_read);
+      *result = absl::string_view(scratch, bytes_read);
+      return s;
+    }
+#endif
+    s = PreadFully(filename_, fd_, offset, n, scratch, &bytes_read);
+    *result = absl::string_view(scratch, bytes_read);
+    return s;
+  }
+
+ private:
+#if defined(TSL_IO_URING_SUPPORTED)
+  // Reads the chunks of the range by batches of kQueueDepth. The chunks the
+  // ring didn't read entirely, e.g. short reads or errors, are completed with
+  // pread(), which also reports the end of the file.
+  absl::Status ReadWithIoUring(IoUring* ring, uint64 offset, size_t n,
+                               char* scratch, size_t* bytes_read) const {
+    std::vector<ReadChunk> chunks;
+    std::vector<int> results;
+    *bytes_read = 0;
+    while (*bytes_read < n) {
+      chunks.clear();
+      for (size_t pos = *bytes_read; pos < n && chunks.size() < kQueueDepth;
+           pos += kReadChunkSize) {
+        chunks.push_back(
+            {offset + pos, std::min(kReadChunkSize, n - pos), scratch + pos});
+      }
+      ring->Read(fd_, chunks, &results);
+      for (size_t i = 0; i < chunks.size(); ++i) {
+        const ReadChunk& chunk = chunks[i];
+        size_t chunk_bytes_read = std::max(results[i], 0);
+        if (chunk_bytes_read < chunk.size) {
+          size_t rest_bytes_read;
+          absl::Status s = PreadFully(
+              filename_, fd_, chunk.offset + chunk_bytes_read,
+              chunk.size - chunk_bytes_read, chunk.dst + chunk_bytes_read,
+              &rest_bytes_read);
+          *bytes_read += chunk_bytes_read + rest_bytes_read;
+          if (!s.ok()) return s;
+        } else {
+          *bytes_read += chunk_bytes_read;
+        }
+      }
+    }
+    return absl::OkStatus();
+  }
+#endif
+
+  const string filename_;
+  const int fd_;
+};
+
+}  // namespace
+
+absl::Status IoUringFileSystem::NewRandomAccessFile(
+    const string& fname, TransactionToken* token,
+    std::unique_ptr<RandomAccessFile>* result) {
+  string translated_fname = TranslateName(fname);
+  int fd = open(translated_fname.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return IOError(fname, errno);
+  }
+  result->reset(new IoUringRandomAccessFile(translated_fname, fd));
+  return absl::OkStatus();
+}
+
+}  // namespace tsl
@@ -0,0 +1,49 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_TSL_PLATFORM_DEFAULT_IO_URING_FILE_SYSTEM_H_
+#define TENSORFLOW_TSL_PLATFORM_DEFAULT_IO_URING_FILE_SYSTEM_H_
+
+#include <memory>
+
+#include "tsl/platform/default/posix_file_system.h"
+#include "tsl/platform/env.h"
+
+namespace tsl {
+
+// The local file system of the "uring://" scheme.
+//
+// Its random access files split the large reads, such as the read-ahead of
+// the buffered input streams and record readers, into chunks submitted
+// together to an io_uring of the reading thread. A single thread then keeps a
+// deep queue of requests at the device instead of one blocking pread. The
+// small reads, the reads on platforms without io_uring and all the other
+// operations are the ones of the POSIX file system.
+class IoUringFileSystem : public LocalPosixFileSystem {
+ public:
+  IoUringFileSystem() {}
+
+  ~IoUringFileSystem() override {}
+
+  TF_USE_FILESYSTEM_METHODS_WITH_NO_TRANSACTION_SUPPORT;
+
+  absl::Status NewRandomAccessFile(
+      const string& filename, TransactionToken* token,
+      std::unique_ptr<RandomAccessFile>* result) override;
+};
+
+}  // namespace tsl
+
+#endif  // TENSORFLOW_TSL_PLATFORM_DEFAULT_IO_URING_FILE_SYSTEM_H_
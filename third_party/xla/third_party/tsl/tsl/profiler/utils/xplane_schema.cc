@@ -339,6 +339,11 @@ const StatTypeMap& GetStatTypeMap() {
       {"dropped_traces", kDroppedTraces},
       {"cuda_graph_id", kCudaGraphId},
       {"cuda_graph_details", kCudaGraphDetails},
+      // Hardware counters.
+      {"cpu_cycles", kCpuCycles},
+      {"cpu_instructions", kCpuInstructions},
+      {"llc_misses", kLlcMisses},
+      {"dram_bytes", kDramBytes},
   });
   DCHECK_EQ(stat_type_map->size(), kNumStatTypes);
   return *stat_type_map;
@@ -324,7 +324,12 @@ enum StatType {
   kDroppedTraces,
   kCudaGraphId,
   kCudaGraphDetails,
-  kLastStatType = kCudaGraphDetails,
+  // Hardware counters read around the computation of the host ops.
+  kCpuCycles,
+  kCpuInstructions,
+  kLlcMisses,
+  kDramBytes,
+  kLastStatType = kDramBytes,
 };
 
 enum MegaScaleStatType : uint8_t {
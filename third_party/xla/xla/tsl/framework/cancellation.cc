@@ -16,8 +16,9 @@ limitations under the License.
 #include "xla/tsl/framework/cancellation.h"
 
 #include <forward_list>
+#include <utility>
+#include <vector>
 
-#include "absl/memory/memory.h"
 #include "tsl/platform/errors.h"
 #include "tsl/platform/logging.h"
 #include "tsl/platform/status.h"
@@ -43,28 +44,38 @@ void CancellationManager::StartCancel() {
 }
 
 void CancellationManager::StartCancelWithStatus(const absl::Status& status) {
-  gtl::FlatMap<CancellationToken, CallbackConfiguration> callbacks_to_run;
+  std::vector<CallbackConfiguration> callbacks_to_run;
   std::forward_list<CancellationManager*> children_to_cancel;
   Notification* cancelled_notification = nullptr;
   {
     mutex_lock l(mu_);
-    if (is_cancelled_.load(std::memory_order_relaxed) || is_cancelling_) {
+    if (is_cancelled_.load(std::memory_order_relaxed) ||
+        is_cancelling_.load(std::memory_order_relaxed)) {
       return;
     }
-    is_cancelling_ = true;
-    if (state_) {
-      std::swap(state_->callbacks, callbacks_to_run);
+    // Any callback registered after this point sees `is_cancelling_` under
+    // the lock of its shard, and isn't registered.
+    is_cancelling_.store(true, std::memory_order_release);
+    State* state = state_.load(std::memory_order_relaxed);
+    if (state) {
+      for (CallbackShard& shard : state->callback_shards) {
+        mutex_lock shard_lock(shard.mu);
+        for (auto& key_and_value : shard.callbacks) {
+          callbacks_to_run.push_back(std::move(key_and_value.second));
+        }
+        shard.callbacks.clear();
+      }
 
       // Remove all children from the list of children.
-      CancellationManager* child = state_->first_child;
+      CancellationManager* child = state->first_child;
       while (child != nullptr) {
         children_to_cancel.push_front(child);
         child->is_removed_from_parent_ = true;
         child = child->next_sibling_;
       }
-      state_->first_child = nullptr;
+      state->first_child = nullptr;
 
-      cancelled_notification = &state_->cancelled_notification;
+      cancelled_notification = &state->cancelled_notification;
     }
   }
   // We call these callbacks without holding mu_, so that concurrent
@@ -72,8 +83,7 @@ void CancellationManager::StartCancelWithStatus(const absl::Status& status) {
   // not block. The callbacks remain valid because any concurrent call
   // to DeregisterCallback will block until the
   // cancelled_notification_ is notified.
-  for (auto key_and_value : callbacks_to_run) {
-    CallbackConfiguration& config = key_and_value.second;
+  for (CallbackConfiguration& config : callbacks_to_run) {
     if (!status.ok() && config.log_error) {
       LOG(WARNING) << "Cancellation callback \"" << config.name
                    << "\" is triggered due to a "
@@ -87,8 +97,8 @@ void CancellationManager::StartCancelWithStatus(const absl::Status& status) {
   }
   {
     mutex_lock l(mu_);
-    is_cancelling_ = false;
     is_cancelled_.store(true, std::memory_order_release);
+    is_cancelling_.store(false, std::memory_order_release);
   }
   if (cancelled_notification) {
     cancelled_notification->Notify();
@@ -108,60 +118,76 @@ bool CancellationManager::RegisterCallbackWithErrorLogging(
       token, CallbackConfiguration{callback, std::string(callback_name), true});
 }
 
+CancellationManager::State* CancellationManager::GetOrCreateState() {
+  State* state = state_.load(std::memory_order_acquire);
+  if (state) {
+    return state;
+  }
+  mutex_lock l(mu_);
+  state = state_.load(std::memory_order_relaxed);
+  if (!state && !is_cancelled_.load(std::memory_order_relaxed) &&
+      !is_cancelling_.load(std::memory_order_relaxed)) {
+    // A state created after StartCancel() has read `state_` would never be
+    // notified.
+    state = new State();
+    state_.store(state, std::memory_order_release);
+  }
+  return state;
+}
+
 bool CancellationManager::RegisterCallbackConfig(CancellationToken token,
                                                  CallbackConfiguration config) {
   DCHECK_LT(token, next_cancellation_token_) << "Invalid cancellation token";
-  mutex_lock l(mu_);
-  bool should_register = !is_cancelled_ && !is_cancelling_;
+  State* state = GetOrCreateState();
+  if (!state) {
+    return false;
+  }
+  CallbackShard& shard = GetCallbackShard(state, token);
+  mutex_lock l(shard.mu);
+  bool should_register = !IsCancellingOrCancelled();
   if (should_register) {
-    if (!state_) {
-      state_ = absl::make_unique<State>();
-    }
-    std::swap(state_->callbacks[token], config);
+    std::swap(shard.callbacks[token], config);
   }
   return should_register;
 }
 
 bool CancellationManager::DeregisterCallback(CancellationToken token) {
-  mu_.lock();
-  if (is_cancelled_) {
-    mu_.unlock();
-    return false;
-  } else if (is_cancelling_) {
-    Notification* cancelled_notification =
-        state_ ? &state_->cancelled_notification : nullptr;
-    mu_.unlock();
+  State* state = state_.load(std::memory_order_acquire);
+  if (!state) {
+    return !IsCancellingOrCancelled();
+  }
+  CallbackShard& shard = GetCallbackShard(state, token);
+  shard.mu.lock();
+  if (is_cancelling_.load(std::memory_order_acquire)) {
+    shard.mu.unlock();
     // Wait for all of the cancellation callbacks to be called. This
     // wait ensures that the caller of DeregisterCallback does not
     // return immediately and free objects that may be used in the
     // execution of any currently pending callbacks in StartCancel.
-    if (cancelled_notification) {
-      cancelled_notification->WaitForNotification();
-    }
+    state->cancelled_notification.WaitForNotification();
+    return false;
+  } else if (is_cancelled_.load(std::memory_order_acquire)) {
+    shard.mu.unlock();
     return false;
   } else {
-    if (state_) {
-      state_->callbacks.erase(token);
-    }
-    mu_.unlock();
+    shard.callbacks.erase(token);
+    shard.mu.unlock();
     return true;
   }
 }
 
 bool CancellationManager::RegisterChild(CancellationManager* child) {
+  State* state = GetOrCreateState();
   mutex_lock l(mu_);
-  if (is_cancelled_.load(std::memory_order_relaxed) || is_cancelling_) {
+  if (!state || is_cancelled_.load(std::memory_order_relaxed) ||
+      is_cancelling_.load(std::memory_order_relaxed)) {
     child->is_removed_from_parent_ = true;
     return true;
   }
 
-  if (!state_) {
-    state_ = absl::make_unique<State>();
-  }
-
   // Push `child` onto the front of the list of children.
-  CancellationManager* current_head = state_->first_child;
-  state_->first_child = child;
+  CancellationManager* current_head = state->first_child;
+  state->first_child = child;
   child->prev_sibling_ = nullptr;
   child->next_sibling_ = current_head;
   if (current_head) {
@@ -176,14 +202,15 @@ void CancellationManager::DeregisterChild(CancellationManager* child) {
   Notification* cancelled_notification = nullptr;
   {
     mutex_lock l(mu_);
+    State* state = state_.load(std::memory_order_relaxed);
     if (!child->is_removed_from_parent_) {
       // Remove the child from this manager's list of children.
-      DCHECK(state_);
+      DCHECK(state);
 
       if (child->prev_sibling_ == nullptr) {
         // The child was at the head of the list.
-        DCHECK_EQ(state_->first_child, child);
-        state_->first_child = child->next_sibling_;
+        DCHECK_EQ(state->first_child, child);
+        state->first_child = child->next_sibling_;
       } else {
         child->prev_sibling_->next_sibling_ = child->next_sibling_;
       }
@@ -194,8 +221,8 @@ void CancellationManager::DeregisterChild(CancellationManager* child) {
 
       child->is_removed_from_parent_ = true;
     }
-    if (is_cancelling_) {
-      cancelled_notification = &state_->cancelled_notification;
+    if (is_cancelling_.load(std::memory_order_relaxed)) {
+      cancelled_notification = &state->cancelled_notification;
     }
   }
 
@@ -208,13 +235,16 @@ void CancellationManager::DeregisterChild(CancellationManager* child) {
 }
 
 bool CancellationManager::TryDeregisterCallback(CancellationToken token) {
-  mutex_lock lock(mu_);
-  if (is_cancelled_ || is_cancelling_) {
+  State* state = state_.load(std::memory_order_acquire);
+  if (!state) {
+    return !IsCancellingOrCancelled();
+  }
+  CallbackShard& shard = GetCallbackShard(state, token);
+  mutex_lock lock(shard.mu);
+  if (IsCancellingOrCancelled()) {
     return false;
   } else {
-    if (state_) {
-      state_->callbacks.erase(token);
-    }
+    shard.callbacks.erase(token);
     return true;
   }
 }
@@ -223,16 +253,13 @@ CancellationManager::~CancellationManager() {
   if (parent_) {
     parent_->DeregisterChild(this);
   }
-  if (state_) {
+  State* state = state_.load(std::memory_order_acquire);
+  if (state) {
     StartCancel();
+    delete state;
   }
 }
 
-bool CancellationManager::IsCancelling() {
-  mutex_lock lock(mu_);
-  return is_cancelling_;
-}
-
 absl::Status RegisterCancellationCallback(
     CancellationManager* cancellation_manager, CancelCallback callback,
     std::function<void()>* deregister_fn) {
@@ -17,8 +17,11 @@ limitations under the License.
 #define XLA_TSL_FRAMEWORK_CANCELLATION_H_
 
 #include <atomic>
+#include <cstdint>
 #include <functional>
 
+#include "absl/base/optimization.h"
+#include "absl/container/flat_hash_map.h"
 #include "tsl/lib/gtl/flatmap.h"
 #include "tsl/platform/hash.h"
 #include "tsl/platform/mutex.h"
@@ -158,7 +161,9 @@ class CancellationManager {
   bool TryDeregisterCallback(CancellationToken token);
 
   // Returns true iff cancellation is in progress.
-  bool IsCancelling();
+  bool IsCancelling() {
+    return is_cancelling_.load(std::memory_order_acquire);
+  }
 
  private:
   struct CallbackConfiguration {
@@ -167,22 +172,51 @@ class CancellationManager {
     bool log_error = false;
   };
 
+  // The callbacks are partitioned by token into shards with their own lock,
+  // so that the concurrent registrations of the kernels and RPCs of a step
+  // don't contend on `mu_`.
+  static constexpr int kNumCallbackShards = 8;
+
+  struct ABSL_CACHELINE_ALIGNED CallbackShard {
+    mutex mu;
+    absl::flat_hash_map<CancellationToken, CallbackConfiguration> callbacks
+        TF_GUARDED_BY(mu);
+  };
+
   struct State {
     Notification cancelled_notification;
-    gtl::FlatMap<CancellationToken, CallbackConfiguration> callbacks;
+    CallbackShard callback_shards[kNumCallbackShards];
 
     // If this CancellationManager has any children, this member points to the
     // head of a doubly-linked list of its children.
     CancellationManager* first_child = nullptr;  // Not owned.
   };
 
+  static CallbackShard& GetCallbackShard(State* state,
+                                         CancellationToken token) {
+    return state->callback_shards[static_cast<uint64_t>(token) %
+                                  kNumCallbackShards];
+  }
+
+  // Returns true if StartCancel() has been called, even if the cancellation
+  // is still in progress. `is_cancelling_` is read first, as StartCancel()
+  // sets `is_cancelled_` before it clears `is_cancelling_`.
+  bool IsCancellingOrCancelled() {
+    return is_cancelling_.load(std::memory_order_acquire) ||
+           is_cancelled_.load(std::memory_order_acquire);
+  }
+
+  // Returns the state of this manager, creating it if needed. Returns nullptr
+  // if the state doesn't exist and StartCancel() has been called.
+  State* GetOrCreateState();
+
   bool RegisterCallbackConfig(CancellationToken token,
                               CallbackConfiguration config);
 
   bool RegisterChild(CancellationManager* child);
   void DeregisterChild(CancellationManager* child);
 
-  bool is_cancelling_;
+  std::atomic_bool is_cancelling_;
   std::atomic_bool is_cancelled_;
   std::atomic<CancellationToken> next_cancellation_token_;
 
@@ -201,8 +235,12 @@ class CancellationManager {
   CancellationManager* next_sibling_ TF_GUARDED_BY(parent_->mu_) =
       nullptr;  // Not owned.
 
+  // Guards the cancellation, the creation of `state_` and the list of
+  // children. The callbacks are guarded by the locks of their shards.
   mutex mu_;
-  std::unique_ptr<State> state_ TF_GUARDED_BY(mu_);
+  // Owned. Created on first use and never reset until destruction, so that
+  // it can be read without holding `mu_`.
+  std::atomic<State*> state_{nullptr};
 };
 
 // Registers the given cancellation callback, returning a function that can be
@@ -16,6 +16,7 @@ limitations under the License.
 #include "xla/tsl/framework/cancellation.h"
 
 #include <algorithm>
+#include <atomic>
 #include <memory>
 #include <numeric>
 #include <random>
@@ -221,6 +222,39 @@ TEST(Cancellation, TryDeregisterDuringCancel) {
   cancel_complete.WaitForNotification();
 }
 
+TEST(Cancellation, ConcurrentRegisterDeregisterAndCancel) {
+  constexpr int kNumThreads = 8;
+  constexpr int kNumCallbacksPerThread = 1000;
+  CancellationManager manager;
+  std::vector<std::atomic<int>> num_calls(kNumThreads * kNumCallbacksPerThread);
+  std::vector<std::atomic<bool>> deregistered(num_calls.size());
+  {
+    thread::ThreadPool w(Env::Default(), "test", kNumThreads + 1);
+    for (int i = 0; i < kNumThreads; ++i) {
+      w.Schedule([&, i]() {
+        for (int j = 0; j < kNumCallbacksPerThread; ++j) {
+          const int index = i * kNumCallbacksPerThread + j;
+          CancellationToken token = manager.get_cancellation_token();
+          if (manager.RegisterCallback(token, [&num_calls, index]() {
+                num_calls[index].fetch_add(1);
+              })) {
+            deregistered[index] = manager.DeregisterCallback(token);
+            // A callback that couldn't be deregistered has already run.
+            EXPECT_EQ(num_calls[index].load(), deregistered[index] ? 0 : 1);
+          } else {
+            deregistered[index] = true;
+          }
+        }
+      });
+    }
+    w.Schedule([&]() { manager.StartCancel(); });
+  }
+  EXPECT_TRUE(manager.IsCancelled());
+  for (size_t i = 0; i < num_calls.size(); ++i) {
+    EXPECT_EQ(num_calls[i].load(), deregistered[i] ? 0 : 1);
+  }
+}
+
 TEST(Cancellation, Parent_CancelManyChildren) {
   CancellationManager parent;
   std::vector<std::unique_ptr<CancellationManager>> children;
@@ -14,7 +14,11 @@ limitations under the License.
 ==============================================================================*/
 #include "xla/tsl/framework/serving_device_selector_policies.h"
 
+#include <algorithm>
 #include <atomic>
+#include <cstdint>
+#include <deque>
+#include <limits>
 
 #include "absl/strings/string_view.h"
 #include "xla/tsl/framework/serving_device_selector.h"
@@ -28,4 +32,50 @@ int RoundRobinPolicy::SelectDevice(
   return ordinal_.fetch_add(1, std::memory_order_relaxed) % num_devices;
 }
 
+namespace {
+
+int64_t PendingWorkNs(
+    const std::deque<ServingDeviceSelector::DeviceState::ProgramInfo>&
+        programs) {
+  int64_t pending_work_ns = 0;
+  for (const auto& program : programs) {
+    int64_t execution_time_ns = 0;
+    if (program.execution_info != nullptr) {
+      execution_time_ns =
+          program.execution_info->MaybeGetValidTime(program.prefetch_results);
+    }
+    pending_work_ns += std::max<int64_t>(execution_time_ns, 1);
+  }
+  return pending_work_ns;
+}
+
+}  // namespace
+
+int LeastLoadedPolicy::SelectDevice(
+    absl::string_view program_fingerprint,
+    const ServingDeviceSelector::DeviceStates& device_states) {
+  const int num_devices = device_states.states.size();
+  const int start = ordinal_.fetch_add(1, std::memory_order_relaxed) %
+                    num_devices;
+  int selected_device = start;
+  int64_t min_pending_work_ns = std::numeric_limits<int64_t>::max();
+  for (int i = 0; i < num_devices; ++i) {
+    const int device = (start + i) % num_devices;
+    const ServingDeviceSelector::DeviceState& state =
+        device_states.states[device];
+    int64_t pending_work_ns = 0;
+    for (const auto& programs : state.enqueued_programs) {
+      pending_work_ns += PendingWorkNs(programs);
+    }
+    for (const auto& programs : state.scheduled_programs) {
+      pending_work_ns += PendingWorkNs(programs);
+    }
+    if (pending_work_ns < min_pending_work_ns) {
+      min_pending_work_ns = pending_work_ns;
+      selected_device = device;
+    }
+  }
+  return selected_device;
+}
+
 }  // namespace tsl
@@ -23,6 +23,7 @@ namespace tsl {
 
 enum class ServingDeviceSelectorPolicy {
   kRoundRobin,
+  kLeastLoaded,
 };
 
 class RoundRobinPolicy : public ServingDeviceSelector::Policy {
@@ -37,6 +38,22 @@ class RoundRobinPolicy : public ServingDeviceSelector::Policy {
   std::atomic<uint64_t> ordinal_;
 };
 
+// Selects the device with the least pending work: the sum of the average
+// execution times of the programs enqueued and scheduled on it, counting at
+// least 1 ns per program so that the numbers of in-flight programs decide
+// until execution times are known. The ties are broken round-robin.
+class LeastLoadedPolicy : public ServingDeviceSelector::Policy {
+ public:
+  LeastLoadedPolicy() : ordinal_(0) {}
+
+  int SelectDevice(
+      absl::string_view program_fingerprint,
+      const ServingDeviceSelector::DeviceStates& device_states) override;
+
+ private:
+  std::atomic<uint64_t> ordinal_;
+};
+
 }  // namespace tsl
 
 #endif  // XLA_TSL_FRAMEWORK_SERVING_DEVICE_SELECTOR_POLICIES_H_